@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @file bench_common.hpp
+ * @brief Allocation counting and synthetic inputs shared by the microbenchmarks
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Hartonomous::bench {
+
+// Heap allocations made by the calling thread so far (operator new, bench_main.cpp)
+size_t allocation_count() noexcept;
+
+/**
+ * @brief Reports allocations per iteration as the "allocs/op" counter
+ *
+ * Construct right before the timed loop; report() after it.
+ */
+class AllocationCounter {
+public:
+    AllocationCounter() : start_(allocation_count()) {}
+
+    void report(benchmark::State& state) const {
+        state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocation_count() - start_),
+                                                         benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    size_t start_;
+};
+
+// Deterministic bytes for hashing and encoding inputs
+std::vector<uint8_t> random_bytes(size_t n, uint64_t seed = 1);
+
+/**
+ * @brief About `bytes` of space-separated words drawn Zipf-like from a fixed vocabulary
+ *
+ * Repeated phrases and a long tail, like prose, so suffix-array and n-gram
+ * work sees realistic repetition. `multilingual` mixes in Latin-1, Greek and
+ * CJK words.
+ */
+std::string synthetic_corpus(size_t bytes, bool multilingual = false, uint64_t seed = 1);
+
+} // namespace Hartonomous::bench
@@ -0,0 +1,69 @@
+/**
+ * @file bench_copy.cpp
+ * @brief Binary COPY row encoding: BulkCopy::BinaryRow against compile-time schemas
+ *
+ * Each row is two UUIDs, an int64 and a double.
+ */
+
+#include "bench_common.hpp"
+#include <database/bulk_copy.hpp>
+#include <database/copy_row.hpp>
+#include <array>
+#include <cstring>
+
+using namespace Hartonomous;
+
+namespace {
+struct Rows {
+    std::vector<std::array<uint8_t, 16>> a, b;
+    explicit Rows(size_t n) : a(n), b(n) {
+        auto bytes = bench::random_bytes(n * 32);
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(a[i].data(), bytes.data() + i * 32, 16);
+            std::memcpy(b[i].data(), bytes.data() + i * 32 + 16, 16);
+        }
+    }
+};
+}
+
+static void BM_BinaryRowEncode(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Rows rows(n);
+    BulkCopy::BinaryRow row;
+    std::vector<uint8_t> sink;
+    sink.reserve(n * 64);
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        sink.clear();
+        for (size_t i = 0; i < n; ++i) {
+            row.clear();
+            row.add_uuid(rows.a[i]);
+            row.add_uuid(rows.b[i]);
+            row.add_int64(static_cast<int64_t>(i));
+            row.add_double(1500.0 + i);
+            sink.insert(sink.end(), row.buffer.begin(), row.buffer.end());
+        }
+        benchmark::DoNotOptimize(sink.data());
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sink.size()));
+}
+BENCHMARK(BM_BinaryRowEncode)->RangeMultiplier(16)->Range(1, 4096);
+
+static void BM_SchemaRowEncode(benchmark::State& state) {
+    using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Int64, pgcopy::Float8>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    Rows rows(n);
+    std::vector<uint8_t> sink(n * Row::size(rows.a[0], rows.b[0], 0, 0.0));
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        uint8_t* p = sink.data();
+        for (size_t i = 0; i < n; ++i) p = Row::encode(p, rows.a[i], rows.b[i], static_cast<int64_t>(i), 1500.0 + i);
+        benchmark::DoNotOptimize(p);
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sink.size()));
+}
+BENCHMARK(BM_SchemaRowEncode)->RangeMultiplier(16)->Range(1, 4096);
@@ -0,0 +1,69 @@
+/**
+ * @file bench_geometry.cpp
+ * @brief Hilbert encoding and hash-to-S³ placement
+ */
+
+#include "bench_common.hpp"
+#include <geometry/super_fibonacci.hpp>
+#include <spatial/hilbert_curve_4d.hpp>
+#include <cstring>
+
+using hartonomous::geometry::SuperFibonacci;
+using hartonomous::spatial::HilbertCurve4D;
+
+// Points in [0, 1]^4, as encode() receives them
+static std::vector<double> unit_points(size_t n) {
+    auto bytes = Hartonomous::bench::random_bytes(n * 4 * sizeof(uint32_t));
+    std::vector<double> xyzw(n * 4);
+    for (size_t i = 0; i < xyzw.size(); ++i) {
+        uint32_t v;
+        std::memcpy(&v, bytes.data() + i * sizeof(v), sizeof(v));
+        xyzw[i] = v * 0x1.0p-32;
+    }
+    return xyzw;
+}
+
+static void BM_HilbertEncode(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    auto xyzw = unit_points(n);
+    Hartonomous::bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            auto idx = HilbertCurve4D::encode(
+                HilbertCurve4D::Vec4(xyzw[i * 4], xyzw[i * 4 + 1], xyzw[i * 4 + 2], xyzw[i * 4 + 3]));
+            benchmark::DoNotOptimize(idx);
+        }
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_HilbertEncode)->RangeMultiplier(16)->Range(1, 4096);
+
+static void BM_HilbertEncodeBatch(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    auto xyzw = unit_points(n);
+    std::vector<HilbertCurve4D::HilbertIndex> out(n);
+    Hartonomous::bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        HilbertCurve4D::encode_batch(xyzw.data(), n, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_HilbertEncodeBatch)->RangeMultiplier(16)->Range(1, 4096);
+
+static void BM_SuperFibonacciHashToPoint(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    auto hashes = Hartonomous::bench::random_bytes(n * 16);
+    Hartonomous::bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            auto p = SuperFibonacci::hash_to_point(hashes.data() + i * 16);
+            benchmark::DoNotOptimize(p);
+        }
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_SuperFibonacciHashToPoint)->RangeMultiplier(16)->Range(1, 4096);
@@ -0,0 +1,39 @@
+/**
+ * @file bench_hashing.cpp
+ * @brief BLAKE3 content addressing: single short messages and SIMD batches
+ */
+
+#include "bench_common.hpp"
+#include <hashing/blake3_pipeline.hpp>
+
+using namespace Hartonomous;
+
+// One ID-sized message per call: setup dominates the compression
+static void BM_Blake3Hash(benchmark::State& state) {
+    const size_t len = static_cast<size_t>(state.range(0));
+    auto input = bench::random_bytes(len);
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        auto h = BLAKE3Pipeline::hash(input.data(), input.size());
+        benchmark::DoNotOptimize(h);
+    }
+    allocs.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+BENCHMARK(BM_Blake3Hash)->DenseRange(16, 64, 16);
+
+// The same messages side by side in SIMD lanes
+static void BM_Blake3HashManyFixed(benchmark::State& state) {
+    const size_t len = static_cast<size_t>(state.range(0));
+    const size_t count = static_cast<size_t>(state.range(1));
+    auto input = bench::random_bytes(len * count);
+    std::vector<BLAKE3Pipeline::Hash> out(count);
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        BLAKE3Pipeline::hash_many_fixed(input.data(), len, len, count, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_Blake3HashManyFixed)->ArgsProduct({{16, 32, 64}, {16, 1024}});
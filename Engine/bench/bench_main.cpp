@@ -0,0 +1,70 @@
+/**
+ * @file bench_main.cpp
+ * @brief Entry point and counting allocator of engine_bench
+ *
+ * Every benchmark runs in this binary, so replacing the global operator new
+ * here counts allocations made inside engine code too.
+ */
+
+#include "bench_common.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local size_t t_allocations = 0;
+}
+
+void* operator new(size_t n) {
+    ++t_allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace Hartonomous::bench {
+
+size_t allocation_count() noexcept { return t_allocations; }
+
+// SplitMix64: inputs only need to be reproducible, not statistically strong
+static uint64_t next(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::vector<uint8_t> random_bytes(size_t n, uint64_t seed) {
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) b = static_cast<uint8_t>(next(seed));
+    return out;
+}
+
+std::string synthetic_corpus(size_t bytes, bool multilingual, uint64_t seed) {
+    static const char* const ascii[] = {
+        "the", "of", "and", "a", "to", "in", "is", "whale", "ship", "sea", "captain", "white",
+        "ahab", "harpoon", "voyage", "ocean", "deep", "wind", "sail", "crew", "storm", "island",
+        "characteristically", "internationalization", "leviathan", "nantucket", "quarterdeck"};
+    static const char* const other[] = {"naïve", "Straße", "Ünïcödé", "ἀλήθεια", "θάλασσα", "東京", "海", "鯨"};
+    constexpr size_t N_ASCII = sizeof(ascii) / sizeof(*ascii);
+    constexpr size_t N_OTHER = sizeof(other) / sizeof(*other);
+
+    std::string out;
+    out.reserve(bytes + 32);
+    while (out.size() < bytes) {
+        // Rank r with probability ~ 1/r: the minimum of two uniform ranks skews low
+        uint64_t r = next(seed);
+        size_t a = (r & 0xFFFF) % N_ASCII, b = ((r >> 16) & 0xFFFF) % N_ASCII;
+        const char* word = multilingual && ((r >> 32) & 7) == 0 ? other[(r >> 40) % N_OTHER] : ascii[a < b ? a : b];
+        if (!out.empty()) out += ((r >> 48) & 15) == 0 ? ". " : " ";
+        out += word;
+    }
+    return out;
+}
+
+} // namespace Hartonomous::bench
+
+BENCHMARK_MAIN();
@@ -0,0 +1,96 @@
+/**
+ * @file bench_substrate.cpp
+ * @brief Composition and relation records as ingestion computes them
+ *
+ * compute_comp resolves codepoints through AtomLookup, which needs the
+ * seeded atoms: it maps the atom image at AtomLookup::default_image_path()
+ * and otherwise loads them over PG* connection settings. Without either the
+ * benchmark is skipped. compute_relation needs neither.
+ */
+
+#include "bench_common.hpp"
+#include <database/postgres_connection.hpp>
+#include <ingestion/substrate_service.hpp>
+#include <storage/atom_lookup.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+using namespace Hartonomous;
+
+namespace {
+struct Atoms {
+    std::unique_ptr<PostgresConnection> db;
+    std::unique_ptr<AtomLookup> lookup;
+    std::string error;
+};
+}
+
+static Atoms& atoms() {
+    static Atoms a = [] {
+        Atoms out;
+        try {
+            out.db = std::make_unique<PostgresConnection>();
+            out.lookup = std::make_unique<AtomLookup>(*out.db);
+            out.lookup->preload_all();
+        } catch (const std::exception& e) {
+            out.lookup.reset();
+            out.error = std::string("no atoms: ") + e.what();
+        }
+        return out;
+    }();
+    return a;
+}
+
+static std::vector<std::string> corpus_words(size_t bytes) {
+    std::istringstream in(bench::synthetic_corpus(bytes, true));
+    std::vector<std::string> words;
+    for (std::string w; in >> w;) words.push_back(std::move(w));
+    return words;
+}
+
+// Arg: words per iteration, reusing one scratch and output as the ingesters do
+static void BM_ComputeComp(benchmark::State& state) {
+    auto& a = atoms();
+    if (!a.lookup) {
+        state.SkipWithError(a.error.c_str());
+        return;
+    }
+    auto words = corpus_words(64 << 10);
+    words.resize(std::min(words.size(), static_cast<size_t>(state.range(0))));
+    SubstrateService::ComputeScratch scratch;
+    SubstrateService::ComputedComp out;
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        for (const auto& w : words) benchmark::DoNotOptimize(SubstrateService::compute_comp(w, *a.lookup, scratch, out));
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+}
+BENCHMARK(BM_ComputeComp)->RangeMultiplier(16)->Range(16, 4096);
+
+static void BM_ComputeRelation(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    auto bytes = bench::random_bytes(n * 32 + 16);
+    std::vector<SubstrateService::CachedComp> comps(n + 1);
+    for (size_t i = 0; i <= n; ++i) {
+        auto& c = comps[i];
+        std::memcpy(c.comp_id.data(), bytes.data() + (i % n) * 32, 16);
+        std::memcpy(c.phys_id.data(), bytes.data() + (i % n) * 32 + 16, 16);
+        c.comp_id[15] ^= static_cast<uint8_t>(i);  // Neighbors never share an ID
+        c.centroid = Eigen::Vector4d(c.comp_id[0], c.comp_id[1], c.comp_id[2], c.comp_id[3]).normalized();
+        c.valid = true;
+    }
+    BLAKE3Pipeline::Hash content{};
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            auto rel = SubstrateService::compute_relation(comps[i], comps[i + 1], content);
+            benchmark::DoNotOptimize(rel);
+        }
+    }
+    allocs.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_ComputeRelation)->RangeMultiplier(16)->Range(16, 4096);
@@ -0,0 +1,51 @@
+/**
+ * @file bench_text.cpp
+ * @brief UTF-8 decoding and suffix-array n-gram discovery over synthetic prose
+ */
+
+#include "bench_common.hpp"
+#include <ingestion/ngram_extractor.hpp>
+#include <utils/unicode.hpp>
+#include <iostream>
+
+using namespace Hartonomous;
+
+// Arg 0: corpus bytes; arg 1: 0 for ASCII, 1 with multibyte words mixed in
+static void BM_Utf8ToUtf32(benchmark::State& state) {
+    const auto text = bench::synthetic_corpus(static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    std::u32string out;
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        utf8_to_utf32(text, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    allocs.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_Utf8ToUtf32)->ArgsProduct({{64, 4 << 10, 256 << 10}, {0, 1}});
+
+// extract() reports its phases on std::cout, which would corrupt JSON output
+namespace {
+struct MuteStdout {
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    ~MuteStdout() {
+        std::cout.rdbuf(saved);
+        std::cout.clear();
+    }
+};
+}
+
+static void BM_NGramExtract(benchmark::State& state) {
+    const auto codepoints = utf8_to_utf32(bench::synthetic_corpus(static_cast<size_t>(state.range(0)), true));
+    NGramExtractor extractor;
+    MuteStdout mute;
+    bench::AllocationCounter allocs;
+    for (auto _ : state) {
+        extractor.extract(codepoints);
+        benchmark::DoNotOptimize(extractor.total_ngrams());
+    }
+    allocs.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * codepoints.size() * sizeof(char32_t)));
+    state.counters["ngrams"] = static_cast<double>(extractor.total_ngrams());
+}
+BENCHMARK(BM_NGramExtract)->RangeMultiplier(8)->Range(1 << 10, 512 << 10)->Unit(benchmark::kMillisecond);
@@ -9,47 +9,85 @@
 # NO Database dependencies allowed here
 set(ENGINE_CORE_SOURCES
     # Geometry
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_batch.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_bbox.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_bbox_split.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_centroid.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_distance.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/s3_voronoi.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/super_fibonacci.cpp
     
     # Hashing
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hashing/blake3_pipeline.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hashing/composition_interner.cpp
     
     # ML
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ml/model_extraction.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ml/s3_hnsw.cpp
+    
+    # Spatial
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/spatial/hilbert_curve_4d.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/spatial/hilbert_range_query.cpp
 )
 
 # --- IO SOURCES (Database, Ingestion, Cognitive) ---
 set(ENGINE_IO_SOURCES
     # Database
     ${CMAKE_CURRENT_SOURCE_DIR}/src/database/bulk_copy.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/bulk_load_session.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/substrate_snapshot.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/connection_pool.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/connection_router.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/pg_event_loop.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/database/postgres_connection.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/database/query_trace.cpp
     
     # Ingestion
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/blocked_knn.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/device_knn.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/hnsw_index_cache.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/model_checkpoint.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/tensor_dedup.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/model_ingester.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/model_package_loader.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/ngram_extractor.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/quantized_space.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/safetensor_ingester.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/safetensor_loader.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/sequitur.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/stream_checkpoint.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/suffix_array.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/substrate_id_loader.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/text_ingester.cpp
     
     # Query
     ${CMAKE_CURRENT_SOURCE_DIR}/src/query/ai_ops.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/query/centroid_index.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/query/composition_resolver.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/query/semantic_query.cpp
     
     # Cognitive
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/astar_search.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/edge_codec.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/relation_graph.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/landmark_table.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/live_relation_graph.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/graph_shards.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/neighbor_cache.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/neighbor_prefetcher.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/godel_engine.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/ooda_loop.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/reasoning_engine.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/reasoning_session.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/voronoi_analysis.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/walk_engine.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/walk_scorer.cpp
     
     # Storage
     ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/atom_lookup.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/composition_text_store.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/composition_adjacency.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/prefix_partitions.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/atom_store.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/composition_store.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/storage/content_store.cpp
@@ -67,38 +105,92 @@ set(ENGINE_IO_SOURCES
     ${CMAKE_CURRENT_SOURCE_DIR}/src/interop_api.cpp
 )
 
+# --- PER-ISA KERNELS (x86 only, see utils/cpu_dispatch.hpp) ---
+# Built with their own -m flags in Engine/CMakeLists.txt and picked at runtime
+set(ENGINE_CORE_AVX2_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hashing/blake3_lanes_avx2.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/spatial/hilbert_curve_4d_avx2.cpp
+)
+set(ENGINE_CORE_AVX512_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hashing/blake3_lanes_avx512.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/spatial/hilbert_curve_4d_avx512.cpp
+)
+set(ENGINE_IO_AVX2_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/cognitive/edge_codec_avx2.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/quantized_space_avx2.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/tensor_convert_avx2.cpp
+)
+set(ENGINE_IO_AVX512_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/quantized_space_avx512.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/ingestion/tensor_convert_avx512.cpp
+)
+
 # --- HEADERS ---
 set(ENGINE_HEADERS
     # Cognitive
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/astar_search.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/search_arena.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/relation_graph.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/landmark_table.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/live_relation_graph.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/graph_shards.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/neighbor_cache.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/neighbor_prefetcher.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/godel_engine.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/ooda_loop.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/reasoning_engine.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/reasoning_session.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/voronoi_analysis.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/walk_engine.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/cognitive/walk_scorer.hpp
     
     # Database
     ${CMAKE_CURRENT_SOURCE_DIR}/include/database/bulk_copy.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/bulk_load_session.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/substrate_snapshot.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/connection_pool.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/connection_router.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/copy_row.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/pg_event_loop.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/database/postgres_connection.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/database/query_trace.hpp
     
     # Geometry
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/hopf_fibration.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_batch.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_bbox.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_bbox_split.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_centroid.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_distance.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_vec.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/s3_voronoi.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/geometry/super_fibonacci.hpp
     
     # Hashing
     ${CMAKE_CURRENT_SOURCE_DIR}/include/hashing/blake3_pipeline.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/hashing/composition_interner.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/hashing/hash_table_128.hpp
     
     # Ingestion
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/ingest_pipeline.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/ingest_progress.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/blocked_knn.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/device_knn.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/knn_device_abi.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/count_min_sketch.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/hnsw_index_cache.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/model_checkpoint.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/tensor_dedup.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/model_ingester.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/model_package_loader.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/ngram_extractor.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/quantized_space.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/safetensor_ingester.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/safetensor_loader.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/sequitur.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/stream_checkpoint.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/suffix_array.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/substrate_id_loader.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/text_ingester.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/ingestion/universal_ingester.hpp
     
@@ -109,13 +201,20 @@ set(ENGINE_HEADERS
     
     # Query
     ${CMAKE_CURRENT_SOURCE_DIR}/include/query/ai_ops.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/query/centroid_index.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/query/composition_resolver.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/query/response_cache.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/query/semantic_query.hpp
     
     # Spatial
     ${CMAKE_CURRENT_SOURCE_DIR}/include/spatial/hilbert_curve_4d.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/spatial/hilbert_range_query.hpp
     
     # Storage
     ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/atom_lookup.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/composition_text_store.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/composition_adjacency.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/prefix_partitions.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/atom_store.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/composition_store.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/include/storage/content_store.hpp
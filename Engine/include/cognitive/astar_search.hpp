@@ -10,18 +10,34 @@
  *
  * Cost function: inverse ELO × inverse log(observations). We prefer
  * traversing high-confidence, well-evidenced relations.
+ *
+ * Edges are co-memberships of a relation and so symmetric, which lets a
+ * bidirectional search grow a backward frontier from the goal(s) with the
+ * same neighbor lists and stop once the two frontiers provably can no
+ * longer improve on their best meeting point. On hub-heavy graphs each
+ * frontier only has to cover about half the depth, which is what keeps
+ * distant concepts inside the expansion limit.
  */
 
 #pragma once
 
 #include <hashing/blake3_pipeline.hpp>
-#include <database/postgres_connection.hpp>
+#include <database/connection_pool.hpp>
+#include <cognitive/graph_shards.hpp>
+#include <cognitive/live_relation_graph.hpp>
+#include <cognitive/landmark_table.hpp>
+#include <storage/composition_text_store.hpp>
+#include <query/composition_resolver.hpp>
 #include <export.hpp>
 #include <Eigen/Dense>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <optional>
+#include <memory>
 
 namespace Hartonomous {
 
@@ -44,23 +60,34 @@ struct AStarPath {
     size_t nodes_expanded;                    // For diagnostics
 };
 
+enum class AStarMode {
+    Unidirectional,
+    Bidirectional,   // Forward from the start, backward from the goal(s), meeting in the middle
+    Parallel,        // Hash-distributed A* (HDA*) over threads; needs a relation graph snapshot
+};
+
 struct AStarConfig {
     size_t max_expansions = 10000;   // Safety limit
     double heuristic_weight = 1.0;   // w=1 is standard A*; w>1 is weighted A* (faster, suboptimal)
     double min_elo = 800.0;          // Skip relations below this ELO
     double min_observations = 1.0;   // Skip relations with fewer observations
     size_t beam_width = 0;           // 0 = full A*; >0 = beam search variant
+    AStarMode mode = AStarMode::Unidirectional;
+    size_t threads = 0;              // Parallel mode; 0 = hardware concurrency
 };
 
 class HARTONOMOUS_API AStarSearch {
 public:
     explicit AStarSearch(PostgresConnection& db);
+    explicit AStarSearch(ConnectionPool& pool);  // Holds one pooled connection for its lifetime
 
     /**
      * @brief Find optimal path from start composition to goal composition
      *
      * Uses S³ geodesic as admissible heuristic. Cost = 1 / (elo_norm * log(obs+1)).
-     * Guaranteed optimal when heuristic_weight = 1.0.
+     * Guaranteed optimal when heuristic_weight = 1.0. config.mode picks the
+     * search; Parallel without a relation graph runs Bidirectional, since
+     * expansions would share one database connection.
      */
     AStarPath search(const BLAKE3Pipeline::Hash& start,
                      const BLAKE3Pipeline::Hash& goal,
@@ -78,44 +105,143 @@ public:
     /**
      * @brief Multi-goal search: find paths to ANY of the goal compositions
      *
-     * Useful for BDI: "reach any sub-goal". Returns the first found path.
-     * Heuristic uses minimum geodesic distance to any goal.
+     * Useful for BDI: "reach any sub-goal". Returns the cheapest path found.
+     * Always bidirectional: every goal seeds one backward frontier, so the
+     * cost per expansion does not grow with the number of goals.
      */
     AStarPath search_multi_goal(const BLAKE3Pipeline::Hash& start,
                                 const std::vector<BLAKE3Pipeline::Hash>& goals,
                                 const AStarConfig& config = {});
 
+    /**
+     * @brief Expand neighbors from an in-memory snapshot instead of the database
+     *
+     * Pass nullptr to go back to per-expansion queries.
+     */
+    void set_relation_graph(std::shared_ptr<const RelationGraph> graph) {
+        graph_ = std::move(graph);
+        live_.reset();
+    }
+
+    // Take the live graph's current epoch at the start of every search
+    void follow_relation_graph(std::shared_ptr<const LiveRelationGraph> live) { live_ = std::move(live); }
+
+    /**
+     * @brief Treat the snapshot as this process's shard of `shards`
+     *
+     * Expanding a composition another shard owns reads its row from that
+     * shard (GraphShards::neighbors). Pass nullptr for an unsharded graph.
+     */
+    void set_graph_shards(std::shared_ptr<GraphShards> shards) { shards_ = std::move(shards); }
+
+    /**
+     * @brief Whether searches expand from a snapshot
+     *
+     * With one, searches touch no connection after the first preload and may
+     * run concurrently on one AStarSearch; without one they share its connection.
+     */
+    bool has_relation_graph() const { return graph_ || live_; }
+
+    /**
+     * @brief Restrict searches to edges with evidence from `tenant` (nullopt: all)
+     *
+     * Enforced by a bit test on the snapshot's tenant masks; throws when a search expands
+     * without a graph loaded with masks (RelationGraph::tenant_view).
+     */
+    void set_tenant(std::optional<BLAKE3Pipeline::Hash> tenant) { tenant_ = tenant; }
+
+    // Pre-cache composition text and positions (done by the first search otherwise)
+    void preload_cache();
+
+    /**
+     * @brief Tighten the heuristic with ALT bounds from a landmark table
+     *
+     * Each node's estimate becomes the larger of its geodesic and landmark
+     * bounds. Pass nullptr to use the geodesic alone.
+     */
+    void set_landmarks(std::shared_ptr<const LandmarkTable> landmarks);
+
+    // Replace the process-wide text store (e.g. one loaded from a specific snapshot)
+    void set_text_store(std::shared_ptr<const CompositionTextStore> texts) { texts_ = std::move(texts); }
+
+    // Edge cost: lower ELO and fewer observations = higher cost
+    static double edge_cost(double elo, double observations);
+
     // Utilities
-    std::string lookup_text(const BLAKE3Pipeline::Hash& id) const;
+    std::string_view lookup_text(const BLAKE3Pipeline::Hash& id) const;  // Valid while the text store lives
     BLAKE3Pipeline::Hash find_composition(const std::string& text);
 
 private:
     struct Neighbor {
-        BLAKE3Pipeline::Hash id;
+        uint32_t node;        // CompositionInterner ID
         double elo;
         double observations;
     };
 
-    // Load S³ position for a composition
-    std::optional<Eigen::Vector4d> load_position(const BLAKE3Pipeline::Hash& id);
+    // S³ positions by interned ID; one immutable table per process, shared by every search
+    struct PositionTable {
+        std::vector<Eigen::Vector4d> positions;
+        std::vector<uint8_t> present;
+    };
+    static std::shared_ptr<const PositionTable> shared_positions(PostgresConnection& db);
+
+    // S³ position for an interned composition, nullptr if unknown
+    const Eigen::Vector4d* load_position(uint32_t node) const;
 
-    // Get all neighbors of a composition with ELO/observation data
-    std::vector<Neighbor> get_neighbors(const BLAKE3Pipeline::Hash& id,
-                                        double min_elo, double min_obs);
+    // All neighbors of a composition with ELO/observation data (replaces `out`)
+    void get_neighbors(const RelationGraph* graph, const BLAKE3Pipeline::Hash& id, double min_elo, double min_obs,
+                       std::vector<Neighbor>& out);
+
+    // Ask a paged graph for the rows of the best neighbors in `row` that pass the filters
+    static void prefetch_rows(const RelationGraph& graph, std::span<const RelationGraph::Edge> row,
+                              double min_elo, double min_obs);
+
+    // Best-first search to whichever goal is reached first
+    AStarPath run_search(const BLAKE3Pipeline::Hash& start,
+                         const std::vector<BLAKE3Pipeline::Hash>& goals,
+                         const AStarConfig& config);
+
+    // Forward frontier from start, one multi-source backward frontier from the goals
+    AStarPath run_bidirectional(const BLAKE3Pipeline::Hash& start,
+                                const std::vector<BLAKE3Pipeline::Hash>& goals,
+                                const AStarConfig& config);
+
+    // HDA*: each thread owns the nodes hashing to it and forwards the rest
+    AStarPath run_parallel(const BLAKE3Pipeline::Hash& start,
+                           const BLAKE3Pipeline::Hash& goal,
+                           const AStarConfig& config);
 
     // S³ geodesic heuristic: arccos(clamp(dot(a,b), -1, 1))
     double heuristic(const Eigen::Vector4d& current, const Eigen::Vector4d& goal) const;
 
-    // Edge cost: lower ELO and fewer observations = higher cost
-    double edge_cost(double elo, double observations) const;
+    // Landmark distances of an interned composition, nullptr without a table entry
+    const float* landmark_row(uint32_t node) const {
+        return node < landmark_rows_.size() && landmark_rows_[node] != LandmarkTable::NPOS
+            ? landmarks_->row(landmark_rows_[node]) : nullptr;
+    }
 
-    // Pre-cache composition text and positions
-    void preload_cache();
+    /**
+     * @brief Lower bound on the path cost between a node and a search endpoint
+     *
+     * Larger of the geodesic and the ALT bound, whichever are available;
+     * +inf if the landmarks place them in different components.
+     */
+    double lower_bound(const Eigen::Vector4d* pos, const float* row,
+                       const Eigen::Vector4d* to_pos, const float* to_row) const;
 
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
-    std::unordered_map<BLAKE3Pipeline::Hash, std::string, HashHasher> text_cache_;
-    std::unordered_map<BLAKE3Pipeline::Hash, Eigen::Vector4d, HashHasher> position_cache_;
-    bool cache_loaded_ = false;
+    CompositionResolver resolver_{db_};
+    std::shared_ptr<const CompositionTextStore> texts_;
+    std::shared_ptr<const PositionTable> positions_;
+    std::atomic<bool> cache_loaded_{false};
+    std::mutex cache_mu_;
+    std::shared_ptr<const RelationGraph> graph_;
+    std::shared_ptr<const LiveRelationGraph> live_;
+    std::optional<BLAKE3Pipeline::Hash> tenant_;
+    std::shared_ptr<GraphShards> shards_;
+    std::shared_ptr<const LandmarkTable> landmarks_;
+    std::vector<uint32_t> landmark_rows_;        // Table row by interned ID
 };
 
 } // namespace Hartonomous
@@ -11,8 +11,9 @@
 
 #pragma once
 
-#include <database/postgres_connection.hpp>
+#include <database/connection_pool.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <query/composition_resolver.hpp>
 #include <vector>
 #include <string>
 #include <optional>
@@ -56,6 +57,7 @@ struct ResearchPlan {
 class GodelEngine {
 public:
     explicit GodelEngine(PostgresConnection& db);
+    explicit GodelEngine(ConnectionPool& pool);  // Holds one pooled connection for its lifetime
 
     /**
      * @brief Analyze a problem and generate meta-reasoning plan
@@ -77,6 +79,9 @@ public:
 
     /**
      * @brief Level 3: Decompose into sub-problems
+     *
+     * The whole tree (five levels, depth-first) comes from one recursive
+     * query; analyze_problem sends it pipelined with the gap query.
      */
     std::vector<SubProblem> decompose_problem(const std::string& problem);
 
@@ -91,11 +96,15 @@ public:
     bool is_solvable(const std::string& problem);
 
 private:
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
+    CompositionResolver resolver_{db_};
 
     std::string hash_text(const std::string& text);
 
-    std::vector<SubProblem> decompose_problem_recursive(const std::string& current_id, int depth, int max_depth);
+    // Rows of the decomposition and knowledge-gap statements
+    std::vector<SubProblem> read_decomposition(const PgResult& rows);
+    static std::vector<KnowledgeGap> read_gaps(const PgResult& rows);
 };
 
 } // namespace Hartonomous
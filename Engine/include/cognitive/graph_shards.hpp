@@ -0,0 +1,198 @@
+#pragma once
+
+/**
+ * @file graph_shards.hpp
+ * @brief Relation graph partitioned across processes by composition-ID hash
+ *
+ * A graph too large for one host is split into shards: partition() keeps
+ * the rows whose source hashes to a shard (owner_of), and each serving
+ * process loads its own shard and answers for it through a
+ * GraphShardServer. Composition IDs are BLAKE3 hashes, so their leading
+ * bits spread rows evenly without a lookup table.
+ *
+ * An engine given a GraphShards reads rows it owns from its local snapshot
+ * as before; any other row is fetched from the owning shard and kept in
+ * NeighborCache::global(), where it also serves later walks. Rows of hubs
+ * (more than RelationGraph::HUB_DEGREE edges) are kept here instead, never
+ * evicted, since walks keep coming back to them. prefetch() sends one
+ * request per remote shard for a whole frontier, the shards in parallel,
+ * so a beam step costs one round trip however many heads it has.
+ *
+ * Remote rows carry no tenant masks: tenant-restricted engines refuse them
+ * rather than serve edges unfiltered. owner() and endpoint() let a front
+ * end send a walk to the shard that owns its start instead; that routing is
+ * left to the serving layer.
+ *
+ *   HARTONOMOUS_GRAPH_SHARDS       ';'-separated host:port per shard, in shard order
+ *   HARTONOMOUS_GRAPH_SHARD_SELF   this process's shard (default 0)
+ *
+ * The wire format is little-endian binary over TCP: a request is "HGS1",
+ * u32 count and count 16-byte IDs; the reply is, per ID in order, u32 degree
+ * then degree edges of (16-byte target, f64 max_elo, f64 total_obs,
+ * u32 relation_count).
+ */
+
+#include <cognitive/neighbor_cache.hpp>
+#include <cognitive/relation_graph.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Blocking client for one shard; one request at a time, reconnecting after a failure
+ */
+class GraphShardClient {
+public:
+    using Row = std::vector<RelationGraph::EdgeRecord>;
+
+    GraphShardClient(std::string host, uint16_t port);
+    ~GraphShardClient();
+
+    GraphShardClient(const GraphShardClient&) = delete;
+    GraphShardClient& operator=(const GraphShardClient&) = delete;
+
+    // Rows of `ids` in order, in one round trip; a composition the shard does not know has an empty row
+    std::vector<Row> fetch(std::span<const BLAKE3Pipeline::Hash> ids);
+
+    const std::string& host() const noexcept { return host_; }
+    uint16_t port() const noexcept { return port_; }
+
+private:
+    void connect_locked();
+    void close_locked() noexcept;
+
+    std::string host_;
+    uint16_t port_;
+    std::mutex mutex_;
+    int fd_ = -1;
+};
+
+/**
+ * @brief Serves the rows of one shard's snapshot to GraphShardClients
+ *
+ * One thread accepts, one more per connection. Stops and joins them on destruction.
+ */
+class GraphShardServer {
+public:
+    // port 0 picks a free one (port())
+    explicit GraphShardServer(std::shared_ptr<const RelationGraph> graph, uint16_t port = 0,
+                              const std::string& bind_address = "0.0.0.0");
+    ~GraphShardServer();
+
+    GraphShardServer(const GraphShardServer&) = delete;
+    GraphShardServer& operator=(const GraphShardServer&) = delete;
+
+    uint16_t port() const noexcept { return port_; }
+
+    // Rows served since start
+    uint64_t rows_served() const noexcept { return rows_served_.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection {
+        int fd;             // -1 once serve() has closed it
+        std::thread thread;
+    };
+
+    void accept_loop();
+    void serve(uint64_t id, int fd);
+
+    std::shared_ptr<const RelationGraph> graph_;
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> rows_served_{0};
+    std::thread acceptor_;
+    std::mutex mutex_;
+    uint64_t next_connection_ = 0;
+    std::unordered_map<uint64_t, Connection> connections_;
+    std::vector<uint64_t> finished_;   // Closed connections whose threads are still to be joined
+};
+
+class GraphShards {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    struct Endpoint {
+        std::string host;
+        uint16_t port = 0;
+    };
+
+    struct Options {
+        std::vector<Endpoint> shards;   // One per shard, in shard order
+        uint32_t self = 0;
+
+        // HARTONOMOUS_GRAPH_SHARDS, HARTONOMOUS_GRAPH_SHARD_SELF
+        static Options from_env();
+    };
+
+    struct Stats {
+        uint64_t remote_requests = 0;   // Round trips to other shards
+        uint64_t remote_rows = 0;       // Rows they returned
+        uint64_t hub_hits = 0;          // Served from the local hub rows
+        size_t hub_rows = 0;
+    };
+
+    // Shard of `id` among `count`
+    static uint32_t owner_of(const Hash& id, uint32_t count) noexcept {
+        uint64_t lead;
+        static_assert(sizeof(Hash) >= sizeof(lead));
+        std::memcpy(&lead, id.data(), sizeof(lead));
+        // Multiply-shift range reduction: no division, and stable for a given count
+        return static_cast<uint32_t>(((lead >> 32) * count) >> 32);
+    }
+
+    /**
+     * @brief The rows of `graph` whose source belongs to `shard` of `count`
+     *
+     * Targets keep their IDs, so a shard's rows name compositions owned
+     * elsewhere. The fingerprint gains a "|shard i/n" suffix.
+     */
+    static std::shared_ptr<const RelationGraph> partition(const RelationGraph& graph, uint32_t count, uint32_t shard);
+
+    explicit GraphShards(Options opts);
+
+    uint32_t count() const noexcept { return static_cast<uint32_t>(std::max<size_t>(opts_.shards.size(), 1)); }
+    uint32_t self() const noexcept { return opts_.self; }
+    uint32_t owner(const Hash& id) const noexcept { return owner_of(id, count()); }
+    bool owns(const Hash& id) const noexcept { return owner(id) == opts_.self; }
+    const Endpoint& endpoint(uint32_t shard) const { return opts_.shards.at(shard); }
+
+    /**
+     * @brief Aggregated neighbors of a composition another shard owns
+     *
+     * From the hub rows or NeighborCache::global() when held, else fetched
+     * from the owner. Targets are CompositionInterner IDs, as NeighborCache lists.
+     */
+    NeighborCache::List neighbors(const Hash& id);
+
+    // Fetch every remote, uncached row among `ids`: one request per shard, shards in parallel
+    void prefetch(const std::vector<Hash>& ids);
+
+    Stats stats() const;
+
+private:
+    // Convert, then keep a hub row here and anything else in the neighbor cache
+    NeighborCache::List store(const Hash& id, const GraphShardClient::Row& row);
+    NeighborCache::List cached(const Hash& id);
+
+    Options opts_;
+    std::vector<std::unique_ptr<GraphShardClient>> clients_;   // Null for self
+    mutable std::mutex hubs_mutex_;
+    std::unordered_map<Hash, NeighborCache::List, HashHasher> hubs_;
+    std::atomic<uint64_t> remote_requests_{0};
+    std::atomic<uint64_t> remote_rows_{0};
+    std::atomic<uint64_t> hub_hits_{0};
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,107 @@
+/**
+ * @file landmark_table.hpp
+ * @brief Precomputed landmark distances for ALT lower bounds in A*
+ *
+ * The S³ geodesic is admissible but knows nothing of edge costs, which come
+ * from ratings and observations, so on its own it barely prunes. A landmark
+ * table stores, for a few dozen landmark compositions, the shortest-path
+ * cost from the landmark to every composition under AStarSearch::edge_cost.
+ * The triangle inequality then bounds any remaining path cost from below:
+ *
+ *     d(v, t) >= |d(l, t) - d(l, v)|   for every landmark l
+ *
+ * Edges are symmetric, so one Dijkstra per landmark gives both directions.
+ * Landmarks are picked by farthest-point selection: the first is the node
+ * farthest from the highest-degree hub, each next one the node farthest
+ * from all landmarks chosen so far. Distances are computed over the full
+ * graph, so bounds stay admissible when a search filters edges by rating
+ * or observations (filtering only lengthens paths).
+ *
+ * Tables are built offline (tools/build_landmarks) against a RelationGraph
+ * snapshot and persisted as a compact binary file keyed by the snapshot's
+ * fingerprint: 16 bytes per composition for its ID plus one float per
+ * landmark. Ratings changed after the build make bounds approximate until
+ * the table is rebuilt.
+ */
+
+#pragma once
+
+#include <cognitive/relation_graph.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+struct LandmarkOptions {
+    size_t count = 32;
+};
+
+class LandmarkTable {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+    using Options = LandmarkOptions;
+
+    static constexpr uint32_t NPOS = ~uint32_t(0);
+
+    LandmarkTable(const LandmarkTable&) = delete;
+    LandmarkTable& operator=(const LandmarkTable&) = delete;
+
+    // Select landmarks and run one Dijkstra from each over `graph`
+    static std::shared_ptr<const LandmarkTable> build(const RelationGraph& graph, const Options& options = {});
+
+    /**
+     * @brief Read a table file; nullptr if missing, corrupt or built for another fingerprint
+     *
+     * @param fingerprint Must match table_fingerprint() of the build (empty accepts any file)
+     */
+    static std::shared_ptr<const LandmarkTable> load_file(const std::string& path,
+                                                          const std::string& fingerprint = "");
+
+    /**
+     * @brief Read the cached table if it matches `graph`, else build it and cache it
+     */
+    static std::shared_ptr<const LandmarkTable> load(const RelationGraph& graph,
+                                                     const std::string& path = default_path(),
+                                                     const Options& options = {});
+
+    void write_file(const std::string& path) const;
+
+    // $HARTONOMOUS_LANDMARKS, else the user cache directory
+    static std::string default_path();
+
+    // Graph fingerprint plus build options; empty if the graph has none
+    static std::string table_fingerprint(const RelationGraph& graph, const Options& options);
+
+    size_t node_count() const noexcept { return ids_.size(); }
+    size_t landmark_count() const noexcept { return landmarks_.size(); }
+    const std::string& fingerprint() const noexcept { return fingerprint_; }
+
+    const Hash& id_of(uint32_t index) const { return ids_[index]; }
+    const Hash& landmark(size_t i) const { return ids_[landmarks_[i]]; }
+
+    // Cost from every landmark to composition `index` (+inf where unreachable)
+    const float* row(uint32_t index) const { return dist_.data() + size_t(index) * landmarks_.size(); }
+
+    /**
+     * @brief ALT bound max_l |d(l, a) - d(l, b)| over two rows
+     *
+     * +inf if some landmark reaches exactly one of the two (they are in
+     * different components). Shaved by float rounding so it stays a lower bound.
+     */
+    static double lower_bound(const float* a, const float* b, size_t landmarks);
+    double lower_bound(uint32_t a, uint32_t b) const { return lower_bound(row(a), row(b), landmarks_.size()); }
+
+private:
+    LandmarkTable() = default;
+
+    std::string fingerprint_;
+    std::vector<Hash> ids_;            // Graph index order at build time
+    std::vector<uint32_t> landmarks_;  // Indices into ids_
+    std::vector<float> dist_;          // node_count × landmark_count, node-major
+};
+
+} // namespace Hartonomous
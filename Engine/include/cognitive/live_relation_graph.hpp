@@ -0,0 +1,137 @@
+/**
+ * @file live_relation_graph.hpp
+ * @brief RelationGraph kept current by incremental refreshes
+ *
+ * Ingest upserts and OODALoop::act both stamp relationrating.modifiedat, so
+ * the rows changed since the last refresh name every relation whose edges
+ * may have moved. A refresh finds the compositions in those relations,
+ * recomputes their complete rows with the same aggregate the full load uses,
+ * and publishes a new snapshot layering those rows over the shared CSR.
+ * Rows are replaced rather than patched, so re-reading an overlap window
+ * behind the watermark (for transactions that committed late) is harmless.
+ * Once the overlay grows past a fraction of the graph it is compacted into
+ * a fresh CSR off the read path.
+ *
+ * Readers call snapshot() and keep the returned epoch for as long as they
+ * need a consistent view (one A* search, one walk step). Publishing swaps a
+ * pointer under a short lock; an old epoch is freed when its last reader
+ * drops it, RCU-style.
+ *
+ * Relations removed by cascade are not seen by the delta; they drop out at
+ * the next full load (rebuild()).
+ *
+ * With opts.tenants the graph carries per-edge tenant masks and refreshes
+ * recompute them against the snapshot's tenant slots; tenants created
+ * after the full load get a slot at the next rebuild().
+ *
+ * With HARTONOMOUS_NUMA=replicate on a multi-node host every epoch is also
+ * published as one copy per NUMA node (utils/numa.hpp), and snapshot()
+ * hands each reader the copy on the node it runs on. A compaction or
+ * rebuild copies the whole graph once per node; a refresh layers its
+ * delta rows over each node's previous copy. Memory grows by the graph's
+ * size per extra node.
+ */
+
+#pragma once
+
+#include <cognitive/relation_graph.hpp>
+#include <database/connection_pool.hpp>
+#include <utils/numa.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Hartonomous {
+
+class LiveRelationGraph {
+public:
+    struct Options {
+        std::chrono::milliseconds refresh_interval{5000};  // Background refresh period
+        std::chrono::seconds overlap{30};                  // Re-scan window behind the watermark
+        double compact_ratio = 0.10;                       // Overlay edges / graph edges that trigger compaction
+        size_t compact_min_edges = 65536;                  // Never compact a smaller overlay
+        std::string cache_path = RelationGraph::default_path();
+        bool tenants = false;                              // Load per-edge tenant masks
+
+        // HARTONOMOUS_GRAPH_REFRESH_MS, HARTONOMOUS_GRAPH_OVERLAP_S, HARTONOMOUS_GRAPH_COMPACT_RATIO,
+        // HARTONOMOUS_GRAPH_TENANTS
+        static Options from_env();
+    };
+
+    struct Stats {
+        uint64_t epoch = 0;
+        size_t refreshes = 0;
+        size_t compactions = 0;
+        size_t last_delta_edges = 0;
+        size_t overlay_rows = 0;
+        size_t overlay_edges = 0;
+        size_t replicas = 0;   // Per-node copies of the current epoch (0: not replicating)
+    };
+
+    /**
+     * @brief Load the initial snapshot (cache file or database)
+     *
+     * The pool must outlive this object.
+     */
+    explicit LiveRelationGraph(ConnectionPool& pool, Options opts = Options::from_env());
+    ~LiveRelationGraph();
+
+    LiveRelationGraph(const LiveRelationGraph&) = delete;
+    LiveRelationGraph& operator=(const LiveRelationGraph&) = delete;
+
+    /**
+     * @brief Current epoch; immutable and safe to hold across refreshes
+     *
+     * When replicating, the copy on the calling thread's NUMA node.
+     */
+    std::shared_ptr<const RelationGraph> snapshot() const {
+        const size_t node = replicating_ ? current_numa_node() : 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return replicas_.empty() ? current_ : replicas_[node % replicas_.size()];
+    }
+
+    /**
+     * @brief Apply changes since the last refresh; returns edges rewritten
+     */
+    size_t refresh();
+
+    /**
+     * @brief Discard the overlay and reload everything from the database
+     */
+    void rebuild();
+
+    // Background refresh every opts.refresh_interval
+    void start();
+    void stop();
+
+    Stats stats() const;
+
+private:
+    // `rows` is the delta `graph` layered over the current epoch, null for a full graph
+    void publish(std::shared_ptr<const RelationGraph> graph,
+                 const std::vector<RelationGraph::EdgeRecord>* rows = nullptr);
+    std::string read_watermark(PostgresConnection& db, const std::string& since);
+
+    ConnectionPool& pool_;
+    Options opts_;
+
+    mutable std::mutex mutex_;                    // Guards current_ and stats_
+    std::shared_ptr<const RelationGraph> current_;
+    std::vector<std::shared_ptr<const RelationGraph>> replicas_;  // Index: NUMA node, when replicating
+    Stats stats_;
+    const bool replicating_ = numa_policy() == NumaPolicy::Replicate && numa_spreading();
+
+    std::mutex refresh_mutex_;                    // One writer at a time; guards watermark_
+    std::string watermark_;                       // max(modifiedat) already applied
+
+    std::thread thread_;
+    std::mutex thread_mutex_;
+    std::condition_variable thread_cv_;
+    bool stopping_ = false;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,154 @@
+/**
+ * @file neighbor_cache.hpp
+ * @brief Bounded, sharded LRU of aggregated relation neighbors per composition
+ *
+ * Without an in-memory RelationGraph every walk step, A* expansion and Gödel
+ * fact lookup re-runs the relationsequence self-join for the composition at
+ * hand and re-aggregates it per neighbor. Walks keep returning to the same
+ * hubs (common words, punctuation), so the aggregated lists are cached here,
+ * keyed by composition and shared by every engine in the process.
+ *
+ * The budget is in neighbor entries rather than compositions, since one hub
+ * can carry more neighbors than thousands of rare words together. Each of 64
+ * shards has its own lock and evicts least-recently-used lists past its share
+ * of the budget. Lists are immutable once cached; readers keep the shared_ptr
+ * they got even if the entry is evicted or invalidated meanwhile. The cache
+ * is also accounted to MemoryGovernor::global(), which may trim it below its
+ * own budget when the process as a whole is over.
+ *
+ * Anything that rewrites relation ratings invalidates the compositions of the
+ * relations it touched (OODALoop::act, ingest); each invalidation also
+ * advances SubstrateEpoch, which retires cached whole answers.
+ *
+ * Lists are loaded through the hartonomous extension's neighbors() when it is
+ * installed, which aggregates in the backend and ships one row per neighbor;
+ * otherwise from compositionadjacency when that table is maintained, or the
+ * plain self-join, aggregated here.
+ */
+
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <utils/memory_governor.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Hartonomous {
+
+class NeighborCache {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    // One neighbor, aggregated over every relation shared with the key
+    struct Neighbor {
+        uint32_t node;            // CompositionInterner ID
+        uint32_t relation_count;
+        double max_elo;
+        double total_obs;
+    };
+    static_assert(sizeof(Neighbor) == 24);
+
+    using List = std::shared_ptr<const std::vector<Neighbor>>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        size_t lists = 0;
+        size_t neighbors = 0;     // Entries held across all lists
+    };
+
+    // max_neighbors: total entries held; 0 disables caching (every lookup loads)
+    explicit NeighborCache(size_t max_neighbors);
+
+    NeighborCache(const NeighborCache&) = delete;
+    NeighborCache& operator=(const NeighborCache&) = delete;
+
+    /**
+     * @brief Process-wide cache
+     *
+     * Budget from HARTONOMOUS_NEIGHBOR_CACHE (neighbor entries, default 4M,
+     * about 100 MB; 0 disables).
+     */
+    static NeighborCache& global();
+
+    // Cached list of `id`, loading it through `db` on a miss
+    List neighbors(PostgresConnection& db, const Hash& id);
+
+    // Cached list or nullptr; counts a hit or miss
+    List find(const Hash& id);
+
+    // Whether id's list is cached, without counting or touching the LRU
+    bool contains(const Hash& id) const;
+
+    // False when the budget is 0 and nothing is ever kept
+    bool enabled() const noexcept { return shard_budget_ > 0; }
+
+    // Load every uncached id in one round trip (frontier expansion)
+    void prefetch(PostgresConnection& db, const std::vector<Hash>& ids);
+
+    void put(const Hash& id, std::vector<Neighbor> list);
+
+    // Evict least-recently-used lists until the cache holds at most `bytes` (estimated)
+    void trim(size_t bytes);
+
+    // Estimated heap bytes held, as reported to the memory governor
+    size_t memory_bytes() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+
+    void invalidate(const Hash& id);
+    void invalidate(const std::vector<Hash>& ids);
+    void clear();
+
+    // Aggregate the neighbors of `id` from the database (no caching)
+    static std::vector<Neighbor> load(PostgresConnection& db, const Hash& id);
+
+    // load() for each id, in order
+    static std::vector<std::vector<Neighbor>> load(PostgresConnection& db, const std::vector<Hash>& ids);
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t SHARD_BITS = 6;
+    static constexpr size_t SHARDS = size_t(1) << SHARD_BITS;
+
+    struct Shard {
+        struct Slot {
+            List list;
+            std::list<Hash>::iterator lru;
+        };
+        mutable std::mutex mu;
+        std::list<Hash> lru;      // Most recent first
+        std::unordered_map<Hash, Slot, HashHasher> slots;
+        size_t neighbors = 0;
+    };
+
+    // Per cached list beyond its entries: vector, control block, map and LRU nodes
+    static constexpr size_t LIST_OVERHEAD = 160;
+    static size_t list_bytes(size_t neighbors) noexcept { return neighbors * sizeof(Neighbor) + LIST_OVERHEAD; }
+
+    Shard& shard_for(const Hash& id) { return shards_[HashHasher{}(id) >> (64 - SHARD_BITS)]; }
+
+    List insert(const Hash& id, List list);
+
+    // Caller holds s.mu
+    void erase_locked(Shard& s, std::unordered_map<Hash, Shard::Slot, HashHasher>::iterator it);
+
+    const size_t shard_budget_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<size_t> bytes_{0};
+    MemoryGovernor::Account account_;   // Last: released before the shards go
+};
+
+} // namespace Hartonomous
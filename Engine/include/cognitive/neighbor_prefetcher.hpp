@@ -0,0 +1,75 @@
+/**
+ * @file neighbor_prefetcher.hpp
+ * @brief Background loads of neighbor lists a walk is likely to need next
+ *
+ * Without a relation graph, a walk step cannot score candidates before the
+ * previous step has picked the node they hang off, so a walk costs one
+ * database round trip per step. While a step is still sampling and the
+ * caller is still emitting its word, the prefetcher loads the lists of the
+ * likeliest next nodes into NeighborCache on a connection of its own.
+ *
+ * Speculation is best effort: the queue is bounded and drops its oldest
+ * ids, and a failed load is logged and forgotten. claim() lets the
+ * foreground take over an id that has not been started, or wait for one
+ * that is being loaded, so no list is fetched twice.
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <database/postgres_connection.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace Hartonomous {
+
+class NeighborPrefetcher {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    // The worker connects with conninfo on its first load
+    explicit NeighborPrefetcher(std::string conninfo, size_t max_queued = 64);
+    ~NeighborPrefetcher();
+
+    NeighborPrefetcher(const NeighborPrefetcher&) = delete;
+    NeighborPrefetcher& operator=(const NeighborPrefetcher&) = delete;
+
+    // Queue ids for loading, most likely first; ones queued or loading are skipped
+    void enqueue(const std::vector<Hash>& ids);
+
+    /**
+     * @brief Make sure the worker is not about to load (or still loading) id
+     *
+     * A queued id is dropped so the caller loads it; one in flight is waited
+     * for, after which it is in the cache.
+     */
+    void claim(const Hash& id);
+
+    // HARTONOMOUS_WALK_PREFETCH: next nodes to prefetch per step (default 4, 0 disables)
+    static size_t width_from_env();
+
+private:
+    void run();
+
+    const std::string conninfo_;
+    const size_t max_queued_;
+    std::unique_ptr<PostgresConnection> db_;  // Worker thread only
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Hash> queue_;
+    std::unordered_set<Hash, HashHasher> queued_;
+    std::unordered_set<Hash, HashHasher> in_flight_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace Hartonomous
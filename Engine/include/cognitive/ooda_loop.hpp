@@ -12,6 +12,11 @@
 #pragma once
 
 #include <database/postgres_connection.hpp>
+#include <cognitive/live_relation_graph.hpp>
+#include <database/connection_router.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -48,7 +53,15 @@ struct OODAMetrics {
  */
 class OODALoop {
 public:
-    explicit OODALoop(PostgresConnection& db);
+    /**
+     * @param db     A primary connection: act() writes through it
+     * @param graph  Refreshed after every act() so searches see the new ratings
+     *               without waiting for its background interval (optional)
+     * @param router Told the WAL position after every act(), so its replica
+     *               readers see the new ratings too (optional)
+     */
+    explicit OODALoop(PostgresConnection& db, LiveRelationGraph* graph = nullptr,
+                      ConnectionRouter* router = nullptr);
 
     /**
      * @brief OBSERVE: Record user feedback
@@ -57,6 +70,13 @@ public:
 
     /**
      * @brief ORIENT: Analyze feedback patterns
+     *
+     * Reads only the evidence validated since the watermark (and at least an
+     * hour ago), adds it to the running per-relation totals and returns a
+     * delta for each relation whose target rating moved: the target for all
+     * its evidence so far minus what was already applied. The next act()
+     * commits the new totals and watermark with the rating updates; until
+     * then another orient() reads the same evidence again.
      */
     std::vector<EdgeUpdate> orient();
 
@@ -67,6 +87,13 @@ public:
 
     /**
      * @brief ACT: Execute ELO updates and pruning
+     *
+     * Updates are summed per relation, COPYed into a session staging table
+     * and applied by one set-based UPDATE in a single transaction. Rows are
+     * locked in relation ID order, so two batches cannot deadlock on each
+     * other. The evidence totals and watermark of the last orient() commit
+     * in the same transaction. The neighbor cache and the attached graph
+     * are refreshed once the batch commits.
      */
     void act(const std::vector<EdgeUpdate>& updates);
 
@@ -82,6 +109,8 @@ public:
 
 private:
     PostgresConnection& db_;
+    LiveRelationGraph* graph_;
+    ConnectionRouter* router_;
 
     // Feedback analysis
     struct EdgeStats {
@@ -91,6 +120,23 @@ private:
         int feedback_count;
     };
 
+    // What orient() read and act() commits: new evidence per relation and its window's end
+    struct EvidenceDelta {
+        int64_t observations = 0;
+        double strength_sum = 0.0;
+    };
+    std::unordered_map<BLAKE3Pipeline::Hash, EvidenceDelta, HashHasher> pending_;
+    std::string pending_through_;
+
+    struct RatingDelta {
+        double elo = 0.0;
+        uint64_t observations = 0;
+    };
+    // act(): ratings of `deltas` and the relations they touch; then orient()'s totals and watermark
+    void apply_deltas(const std::map<BLAKE3Pipeline::Hash, RatingDelta>& deltas,
+                      std::vector<BLAKE3Pipeline::Hash>& touched);
+    void commit_evidence(const std::map<BLAKE3Pipeline::Hash, RatingDelta>& deltas);
+
     std::vector<EdgeStats> analyze_feedback();
     int calculate_elo_delta(double avg_rating, int feedback_count);
     bool should_prune(const EdgeStats& stats);
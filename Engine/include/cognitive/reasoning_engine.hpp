@@ -9,6 +9,7 @@
  *   ORIENT:   Gödel decomposes problem → identify sub-goals + knowledge gaps
  *   DECIDE:   BDI selects intentions → A* plans paths to sub-goals
  *   ACT:      Tree of Thought: K parallel searches, scored by path quality
+ *             (concurrent over a graph snapshot, stopping once one is good enough)
  *   REFLECT:  Evaluate output coherence → re-search if below threshold
  *
  * BDI Framework:
@@ -22,9 +23,13 @@
 #include <cognitive/walk_engine.hpp>
 #include <cognitive/astar_search.hpp>
 #include <cognitive/godel_engine.hpp>
+#include <cognitive/reasoning_session.hpp>
 #include <query/semantic_query.hpp>
-#include <database/postgres_connection.hpp>
+#include <database/connection_pool.hpp>
+#include <utils/cancellation.hpp>
 #include <export.hpp>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
@@ -40,6 +45,8 @@ struct ReasoningConfig {
     // Tree of Thought
     size_t beam_width = 4;           // Parallel hypotheses to maintain
     size_t max_depth = 8;            // Maximum reasoning depth per hypothesis
+    size_t act_threads = 0;          // Concurrent beams when A* reads a graph snapshot (0 = all cores, 1 = sequential)
+    double early_accept_margin = 0.2; // Start no more beams once one scores min_path_quality + margin (<0 = never)
 
     // A* search
     AStarConfig astar;               // Defaults are sensible
@@ -56,10 +63,14 @@ struct ReasoningConfig {
     size_t max_response_words = 200; // Target response length
     bool include_reasoning_trace = false; // Include "[path: X→Y→Z]" annotations
 
+    // Streaming limits for reason_stream (0 = none)
+    std::chrono::milliseconds deadline{0}; // Wall time from the call until the stream is cut off
+    size_t max_tokens = 0;                 // Tokens delivered before the stream is cut off
+
     // System prompt (injected context for reasoning)
     std::string system_prompt;
 
-    // Conversation history (for multi-turn)
+    // Conversation history (for multi-turn; reason(session, ...) reads the session instead)
     std::vector<std::pair<std::string, std::string>> history; // (role, content)
 };
 
@@ -90,12 +101,14 @@ struct ReasoningResult {
     size_t reflexion_rounds;          // How many re-search rounds occurred
     size_t nodes_expanded;            // Total A* nodes expanded
     std::vector<std::string> reasoning_trace; // Optional trace
+    std::string finish_reason;        // reason_stream: "complete", "length", "deadline" or "cancelled"
 };
 
 // =============================================================================
 // Streaming callback
 // =============================================================================
 
+// Return false to stop the stream (e.g. the client went away)
 using ReasoningStreamCallback = std::function<bool(const std::string& token, size_t step)>;
 
 // =============================================================================
@@ -105,6 +118,7 @@ using ReasoningStreamCallback = std::function<bool(const std::string& token, siz
 class HARTONOMOUS_API ReasoningEngine {
 public:
     explicit ReasoningEngine(PostgresConnection& db);
+    explicit ReasoningEngine(ConnectionPool& pool);  // Holds one pooled connection for its lifetime
 
     /**
      * @brief Full reasoning pipeline: prompt → response
@@ -120,22 +134,90 @@ public:
     ReasoningResult reason(const std::string& prompt,
                            const ReasoningConfig& config = {});
 
+    /**
+     * @brief One turn of a conversation kept in `session`
+     *
+     * As reason(), with the session's recent turns as context in place of
+     * config.history, which is ignored. Only the new prompt's keywords are
+     * extracted; resolutions, known facts and A* paths an earlier turn
+     * already worked out come from the session. The prompt and the response
+     * are added to it as the next two turns.
+     */
+    ReasoningResult reason(ReasoningSession& session,
+                           const std::string& prompt,
+                           const ReasoningConfig& config = {});
+
     /**
      * @brief Streaming variant — calls back with each token as generated
+     *
+     * The pipeline runs on a worker thread and hands tokens to the calling
+     * thread, which runs the callback. The first hypothesis's path words go
+     * out as soon as its A* chain is planned; the remaining hypotheses and
+     * reflexion run meanwhile, and only the words they add (then the walk
+     * fill) follow, since sent tokens cannot be retracted. The response is
+     * exactly the concatenation of delivered tokens.
+     *
+     * The stream stops when the callback returns false, config.deadline or
+     * config.max_tokens is reached, or `cancel` is cancelled from any thread.
+     * Stopping cancels the query in flight on the engine's connection and
+     * abandons the remaining stages; finish_reason says which limit hit.
      */
     ReasoningResult reason_stream(const std::string& prompt,
                                   ReasoningStreamCallback callback,
-                                  const ReasoningConfig& config = {});
+                                  const ReasoningConfig& config = {},
+                                  std::shared_ptr<CancellationToken> cancel = nullptr);
 
     /**
      * @brief Quick answer — skip full reasoning, use co-occurrence + A*
      *
      * For simple factual queries. Falls back to full reason() if no direct answer.
+     * Results are cached process-wide per normalized prompt, config and
+     * tenant for the current SubstrateEpoch (ResponseCache).
      */
     ReasoningResult quick_answer(const std::string& prompt,
                                  const ReasoningConfig& config = {});
 
+    /**
+     * @brief quick_answer of every prompt, results in input order
+     *
+     * Uncached prompts get their semantic answers from one
+     * SemanticQuery::answer_question_batch; only those it cannot answer
+     * well take the truth and full-reasoning fallbacks, one at a time on
+     * this engine's connection.
+     */
+    std::vector<ReasoningResult> quick_answer_batch(const std::vector<std::string>& prompts,
+                                                    const ReasoningConfig& config = {});
+
+    // Hits and misses of the quick_answer() cache
+    static ResponseCacheStats quick_answer_cache_stats();
+
+    // Share one relation graph snapshot between the walk, query and A* sub-engines
+    void set_relation_graph(std::shared_ptr<const RelationGraph> graph) {
+        walk_.set_relation_graph(graph);
+        query_.set_relation_graph(graph);
+        astar_.set_relation_graph(std::move(graph));
+    }
+    void follow_relation_graph(std::shared_ptr<const LiveRelationGraph> live) {
+        walk_.follow_relation_graph(live);
+        query_.follow_relation_graph(live);
+        astar_.follow_relation_graph(std::move(live));
+    }
+    bool has_relation_graph() const { return walk_.has_relation_graph() && astar_.has_relation_graph(); }
+    // Tenant view of the walk, query and A* sub-engines
+    void set_tenant(std::optional<BLAKE3Pipeline::Hash> tenant) {
+        walk_.set_tenant(tenant);
+        query_.set_tenant(tenant);
+        astar_.set_tenant(tenant);
+    }
+    // ALT bounds for the A* sub-engine
+    void set_landmarks(std::shared_ptr<const LandmarkTable> landmarks) { astar_.set_landmarks(std::move(landmarks)); }
+
 private:
+    // quick_answer() without the cache, given the prompt's answer_question()
+    ReasoningResult answer_quickly(const std::string& prompt, const ReasoningConfig& config,
+                                   const std::optional<QueryResult>& answer);
+    std::string quick_answer_key(const std::string& prompt, const std::string& digest) const;
+
     // OODA phases
     struct Observation {
         std::string prompt;
@@ -155,11 +237,27 @@ private:
 
     // Phase implementations
     Observation observe(const std::string& prompt, const ReasoningConfig& config);
+    // Keywords already gathered: dedup and resolve them to seeds
+    void resolve_seeds(Observation& obs);
+    // ORIENT onward, for an observation made either way
+    ReasoningResult respond(const Observation& obs, const ReasoningConfig& config);
     Orientation orient(const Observation& obs);
     std::vector<Intention> decide(const Observation& obs, const Orientation& ort);
     std::vector<Hypothesis> act(const std::vector<Intention>& intentions,
                                 const Observation& obs,
                                 const ReasoningConfig& config);
+    // Beams [first, beam count) appended to `hypotheses`; concurrent with a graph snapshot
+    void run_beams(const std::vector<Intention>& intentions,
+                   const Observation& obs,
+                   const ReasoningConfig& config,
+                   size_t first,
+                   std::vector<Hypothesis>& hypotheses,
+                   const CancellationToken* cancel = nullptr);
+    // One Tree of Thought beam: the intentions, rotated by `beam`, chained through A*
+    Hypothesis act_beam(const std::vector<Intention>& intentions,
+                        const Observation& obs,
+                        const ReasoningConfig& config,
+                        size_t beam);
     Hypothesis reflect(std::vector<Hypothesis>& hypotheses,
                        const Observation& obs,
                        const ReasoningConfig& config);
@@ -169,6 +267,16 @@ private:
                                   const Observation& obs,
                                   const ReasoningConfig& config);
 
+    // Counts, trace and confidence of the chosen hypothesis
+    void summarize(const Hypothesis& best, const ReasoningConfig& config, ReasoningResult& result) const;
+
+    // reason_stream's worker: the OODA phases with each word handed to `emit` as it is settled
+    void stream_pipeline(const std::string& prompt,
+                         const ReasoningConfig& config,
+                         const CancellationToken& cancel,
+                         const std::function<bool(std::string)>& emit,
+                         ReasoningResult& result);
+
     // Walk-based passage generation for gaps between A* paths
     std::string generate_passage(const BLAKE3Pipeline::Hash& seed,
                                  size_t max_words,
@@ -181,11 +289,18 @@ private:
     // Quality scoring for reflexion
     double score_hypothesis(const Hypothesis& h) const;
 
+    // Lookups memoized in session_ during a session turn
+    std::optional<BLAKE3Pipeline::Hash> resolve(const std::string& term);
+    std::vector<std::string> known_facts(const std::string& keyword);
+    AStarPath plan(const BLAKE3Pipeline::Hash& start, const BLAKE3Pipeline::Hash& goal, const AStarConfig& config);
+
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
     WalkEngine walk_;
     AStarSearch astar_;
     GodelEngine godel_;
     SemanticQuery query_;
+    ReasoningSession* session_ = nullptr;  // Set for the duration of reason(session, ...)
 };
 
 } // namespace Hartonomous
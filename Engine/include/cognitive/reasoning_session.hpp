@@ -0,0 +1,131 @@
+/**
+ * @file reasoning_session.hpp
+ * @brief What a multi-turn conversation has already worked out, kept between turns
+ *
+ * ReasoningEngine::reason(session, prompt) reads the conversation from a
+ * session instead of ReasoningConfig::history. Each turn's keywords are
+ * extracted once, when the turn is added; the compositions they resolve to,
+ * the known facts orient() finds for them and the A* paths the beams plan
+ * are memoized here. A follow-up turn then extracts and resolves only its
+ * own message and plans only paths no earlier turn asked for, so its cost
+ * does not grow with the conversation. Like history, only the last
+ * CONTEXT_TURNS turns feed a new one, and only those are kept.
+ *
+ * Without a relation graph snapshot the seeds' neighbor lists are held as
+ * well, and put back into NeighborCache::global() if it evicted them
+ * between turns.
+ *
+ * The memos are dropped when SubstrateEpoch moves or a turn runs with
+ * another tenant or other A* settings than the one before. They are
+ * accounted to MemoryGovernor::global() as "reasoning_sessions" (Low); a
+ * shrink request drops them at the start of the next turn.
+ *
+ * One turn at a time per session; the beams of that turn may share it.
+ */
+
+#pragma once
+
+#include <cognitive/astar_search.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <utils/memory_governor.hpp>
+#include <utils/substrate_epoch.hpp>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class ReasoningSession {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    static constexpr size_t CONTEXT_TURNS = 3;
+    static constexpr size_t MAX_ENTRIES = 4096;   // Per memo; a full memo starts over
+
+    struct Turn {
+        std::string role;                   // "user" or "assistant"
+        std::string content;
+        std::vector<std::string> keywords;  // SemanticQuery::extract_keywords of content
+    };
+
+    struct Stats {
+        uint64_t turns = 0;          // Added since creation
+        uint64_t term_hits = 0;      // Resolutions and fact lookups answered from the memo
+        uint64_t term_misses = 0;
+        uint64_t path_hits = 0;      // A* searches answered from the memo
+        uint64_t path_misses = 0;
+        uint64_t restores = 0;       // Held neighbor lists put back into the cache
+        size_t bytes = 0;            // As last reported to the governor (at each turn)
+    };
+
+    explicit ReasoningSession(MemoryGovernor& governor = MemoryGovernor::global());
+
+    ReasoningSession(const ReasoningSession&) = delete;
+    ReasoningSession& operator=(const ReasoningSession&) = delete;
+
+    /**
+     * @brief Start a turn
+     *
+     * Drops the memos when `scope` (tenant and A* settings) or `epoch`
+     * differ from the previous turn's, or the governor asked for room.
+     */
+    void begin_turn(const std::string& scope, uint64_t epoch = SubstrateEpoch::current());
+
+    // Append a turn; the oldest beyond CONTEXT_TURNS is forgotten
+    void add_turn(std::string role, std::string content, std::vector<std::string> keywords);
+
+    // The turns a new one reads, oldest first
+    const std::deque<Turn>& context() const noexcept { return context_; }
+
+    // Outer nullopt: not memoized; inner nullopt: memoized as resolving to nothing
+    std::optional<std::optional<Hash>> find_term(const std::string& term);
+    void put_term(const std::string& term, std::optional<Hash> id);
+
+    std::optional<std::vector<std::string>> find_facts(const std::string& keyword);
+    void put_facts(const std::string& keyword, std::vector<std::string> facts);
+
+    std::optional<AStarPath> find_path(const Hash& start, const Hash& goal);
+    void put_path(const Hash& start, const Hash& goal, const AStarPath& path);
+
+    // Keep the cached neighbor lists of `seeds`, restoring any the cache let go; others are released
+    void hold_neighbors(const std::vector<Hash>& seeds);
+
+    // Drop the memos and held lists; the turns stay
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct PairHasher {
+        size_t operator()(const std::pair<Hash, Hash>& p) const noexcept {
+            return HashHasher{}(p.first) ^ (HashHasher{}(p.second) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    void clear_locked();
+    size_t bytes_locked() const noexcept;
+    void report_locked();
+
+    static size_t path_bytes(const AStarPath& p) noexcept;
+
+    mutable std::mutex mutex_;
+    std::deque<Turn> context_;
+    std::string scope_;
+    uint64_t epoch_ = 0;
+    bool started_ = false;
+    std::unordered_map<std::string, std::optional<Hash>> terms_;
+    std::unordered_map<std::string, std::vector<std::string>> facts_;
+    std::unordered_map<std::pair<Hash, Hash>, AStarPath, PairHasher> paths_;
+    std::unordered_map<Hash, NeighborCache::List, HashHasher> held_;
+    size_t bytes_ = 0;   // Held by memo entries beyond their map nodes: key texts, facts, path contents
+    Stats stats_;
+    MemoryGovernor::Account account_;
+};
+
+} // namespace Hartonomous
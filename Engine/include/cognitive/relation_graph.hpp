@@ -0,0 +1,463 @@
+/**
+ * @file relation_graph.hpp
+ * @brief Immutable CSR snapshot of the composition relation graph
+ *
+ * WalkEngine and AStarSearch both expand a composition by joining
+ * relationsequence with itself and relationrating, then aggregating per
+ * neighbor (max ELO, summed observations). RelationGraph runs that
+ * aggregation once for the whole substrate and stores the result as
+ * compressed sparse rows over a dense composition index, so an expansion
+ * is a slice of a flat array instead of a database round trip.
+ *
+ * A snapshot never changes after construction; share it across engines and
+ * threads through std::shared_ptr<const RelationGraph>. It can be written to
+ * and mapped back from a file, so a process restart costs an mmap rather
+ * than the aggregation query.
+ *
+ * Updates produce a new snapshot rather than mutating one: with_rows()
+ * layers replacement rows over a shared base CSR (new compositions are
+ * appended to the index), and compact() folds the overlay back into flat
+ * arrays. Indices are stable across both. LiveRelationGraph drives this
+ * from the database.
+ *
+ * A graph loaded with tenants carries one 64-bit mask per edge beside the
+ * CSR: bit i is set when a relation behind the edge has valid evidence from
+ * content of the graph's i-th tenant. Engines restricted to a tenant test
+ * that bit instead of joining relationevidence and content on every hop.
+ * Up to MAX_TENANTS tenants (lowest IDs first) get a slot; one without a
+ * slot sees no edge. Graphs built without tenants have no masks.
+ *
+ * Every row also has a NodeSummary: its degree and the extremes and sums
+ * an engine normalizes a candidate set by. Rows above HUB_DEGREE edges
+ * additionally keep the positions of their HUB_TOP best-ranked edges
+ * (hub_edges()), so expanding a hub can read those instead of scanning
+ * thousands of neighbors. Both are computed whenever a row is (build,
+ * with_rows(), compact()) and stored in the snapshot file.
+ *
+ * pack() re-encodes the CSR for graphs too large for 24-byte edges: each
+ * row's targets as StreamVByte deltas, ELO as 16-bit steps over the graph's
+ * range, observations exact in 8 bits or log-scale in 16, and relation
+ * counts in a separate cold array, about 7 bytes an edge in all. ELO and
+ * observations are read back quantized (summaries and hub lists are computed
+ * from the quantized values). A packed row is decoded on every neighbors()
+ * call; engines keep the same API, and the snapshot file stores the packed
+ * form as is. HARTONOMOUS_RELATION_GRAPH_PACKED=1 makes load() pack.
+ *
+ * load_paged() serves a snapshot file larger than memory: rows stay on disk
+ * behind the mapping, a hot set of metadata and hub rows is locked in, and
+ * engines prefetch() the rows their frontier is about to expand.
+ */
+
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <hashing/hash_table_128.hpp>
+#include <utils/huge_pages.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Hartonomous {
+
+class SubstrateSnapshot;
+
+class RelationGraph {
+public:
+    static constexpr uint32_t NPOS = ~uint32_t(0);
+
+    using TenantMask = uint64_t;
+    static constexpr size_t MAX_TENANTS = 64;
+    static constexpr TenantMask ALL_TENANTS = ~TenantMask(0);
+
+    // One aggregated neighbor of a composition
+    struct Edge {
+        uint32_t target;          // Dense index of the neighbor
+        uint32_t relation_count;  // Relation memberships contributing to this edge
+        double max_elo;           // Highest rating among those relations
+        double total_obs;         // Summed observations
+    };
+    static_assert(sizeof(Edge) == 24);
+
+    // Rows with more edges than this keep a hub list
+    static constexpr uint32_t HUB_DEGREE = 1024;
+    // Length of a hub list
+    static constexpr uint32_t HUB_TOP = 256;
+
+    // Aggregates over one row, unfiltered by tenant
+    struct NodeSummary {
+        uint32_t degree = 0;
+        uint32_t hub_count = 0;     // Entries in hub_edges(); 0 below HUB_DEGREE
+        uint64_t hub_offset = 0;    // Into the hub list array (base rows only)
+        double min_elo = 0.0;
+        double max_elo = 0.0;
+        double max_obs = 0.0;
+        double total_obs = 0.0;
+    };
+    static_assert(sizeof(NodeSummary) == 48);
+
+    /**
+     * @brief Rank of an edge in its row's hub list: normalized ELO plus normalized observations
+     *
+     * Normalized as WalkEngine normalizes a candidate set: ELO over
+     * [min_elo, max_elo] clamped at zero with a range of at least 1,
+     * observations over max(max_obs, 1).
+     */
+    static double hub_rank(const Edge& e, const NodeSummary& s) noexcept {
+        const double lo = std::max(0.0, s.min_elo);
+        const double range = std::max(1.0, std::max(0.0, s.max_elo) - lo);
+        return (std::max(0.0, e.max_elo) - lo) / range + e.total_obs / std::max(1.0, s.max_obs);
+    }
+
+    // Input form for building a graph from already-aggregated edges
+    struct EdgeRecord {
+        BLAKE3Pipeline::Hash source;
+        BLAKE3Pipeline::Hash target;
+        double max_elo;
+        double total_obs;
+        uint32_t relation_count;
+        TenantMask tenants = ALL_TENANTS;  // Slots of tenants with evidence for the edge
+    };
+
+    ~RelationGraph();
+    RelationGraph(const RelationGraph&) = delete;
+    RelationGraph& operator=(const RelationGraph&) = delete;
+
+    /**
+     * @brief Aggregate every edge in the database into a new snapshot
+     *
+     * @param tenants Also compute per-edge tenant masks (joins evidence and content)
+     */
+    static std::shared_ptr<const RelationGraph> load_from_db(PostgresConnection& db, bool tenants = false);
+
+    /**
+     * @brief Map a snapshot file; nullptr if missing, stale or corrupt
+     *
+     * @param fingerprint Must match the one the file was written with
+     *                    (empty accepts any file)
+     */
+    static std::shared_ptr<const RelationGraph> load_file(const std::string& path,
+                                                          const std::string& fingerprint = "");
+
+    /**
+     * @brief Map and verify the snapshot file at `path` for the rest of the process
+     *
+     * load_file() returns the same snapshot for the file while it is
+     * unchanged, here and in processes forked from here (a PostgreSQL
+     * postmaster preloading the extension), without mapping it again.
+     */
+    static bool pin_file(const std::string& path);
+
+    /**
+     * @brief Map a snapshot file out of core, for graphs larger than RAM; nullptr as load_file()
+     *
+     * The file is mapped as is, never copied into huge pages or faulted in
+     * for NUMA placement, and after verification the kernel is told to
+     * expect random access so reading one row does not read ahead into the
+     * next. What every expansion touches (ids, offsets, summaries, hub lists)
+     * is locked in memory first, then the rows of the highest-degree hubs,
+     * largest first, until `hot_bytes` is used. Other rows page in on demand
+     * and the page cache's own LRU reclaims them under memory pressure;
+     * engines request rows ahead of use with prefetch().
+     *
+     * Locking stops at RLIMIT_MEMLOCK, after which the rest of the hot set
+     * is only advised as needed; pinned_bytes() reports what was locked.
+     */
+    static std::shared_ptr<const RelationGraph> load_paged(const std::string& path,
+                                                           const std::string& fingerprint = "",
+                                                           size_t hot_bytes = paged_hot_bytes());
+
+    /**
+     * @brief Map the cached snapshot if it matches the database, else rebuild and cache it
+     *
+     * With HARTONOMOUS_RELATION_GRAPH_PAGED=1 the cache file is mapped with load_paged().
+     */
+    static std::shared_ptr<const RelationGraph> load(PostgresConnection& db,
+                                                     const std::string& path = default_path(),
+                                                     bool tenants = false);
+
+    /**
+     * @brief The load_from_db() aggregation (without tenants) over a substrate snapshot
+     *
+     * Reads relationrating and relationsequence from the mapped snapshot, so
+     * a walk server can be seeded without a database. The fingerprint is
+     * "snapshot:" and the snapshot's id.
+     */
+    static std::shared_ptr<const RelationGraph> from_snapshot(const SubstrateSnapshot& snapshot);
+
+    /**
+     * @param tenants Slot table for EdgeRecord::tenants; empty builds no masks
+     */
+    static std::shared_ptr<const RelationGraph> from_edges(std::vector<EdgeRecord> edges,
+                                                           std::string fingerprint = "",
+                                                           std::vector<BLAKE3Pipeline::Hash> tenants = {});
+
+    /**
+     * @brief Run a SELECT producing (source uuid, target uuid, max_elo float8,
+     *        total_obs float8, relation_count int8[, tenants int8]) rows over binary COPY
+     */
+    static std::vector<EdgeRecord> copy_edges(PostgresConnection& db, const std::string& select_sql);
+
+    /**
+     * @brief New snapshot in which every source named in `rows` has exactly those edges
+     *
+     * Sources not named keep their current rows. The base CSR is shared, not copied.
+     */
+    static std::shared_ptr<const RelationGraph> with_rows(const std::shared_ptr<const RelationGraph>& graph,
+                                                          const std::vector<EdgeRecord>& rows);
+
+    /**
+     * @brief SQL aggregating one int8 tenant mask per relation: (relationid, tenants)
+     *
+     * Slots follow `tenants`, so rows computed for with_rows() match the
+     * snapshot they are layered over.
+     */
+    static std::string relation_tenants_sql(const std::vector<BLAKE3Pipeline::Hash>& tenants);
+
+    // Copy of this snapshot with the overlay folded in, packed when this one is
+    std::shared_ptr<const RelationGraph> compact() const;
+
+    // Packed copy of this snapshot with the overlay folded in; node indices are unchanged
+    std::shared_ptr<const RelationGraph> pack() const;
+
+    /**
+     * @brief compact() without NUMA interleaving (utils/numa.hpp)
+     *
+     * Every page of the copy is first touched by the calling thread, so
+     * called from run_on_node() it yields a replica local to that node.
+     * Node indices match this snapshot's, so with_rows() over a replica and
+     * over the original yield the same graph.
+     */
+    std::shared_ptr<const RelationGraph> replicate() const;
+
+    void write_file(const std::string& path) const;
+
+    /**
+     * @brief Identity of the relation tables' contents (changes on any write)
+     *
+     * With tenants, also of the evidence, content and tenant tables.
+     */
+    static std::string database_fingerprint(PostgresConnection& db, bool tenants = false);
+
+    // $HARTONOMOUS_RELATION_GRAPH, else the user cache directory
+    static std::string default_path();
+
+    // HARTONOMOUS_RELATION_GRAPH_PACKED: whether load() packs the graphs it builds
+    static bool packed_by_default();
+
+    // HARTONOMOUS_RELATION_GRAPH_PAGED: whether load() maps its cache file out of core
+    static bool paged_by_default();
+
+    // HARTONOMOUS_RELATION_GRAPH_HOT_MB (default 1024): load_paged()'s locked hot set
+    static size_t paged_hot_bytes();
+
+    size_t node_count() const noexcept { return base_nodes_ + overlay_ids_.size(); }
+    size_t edge_count() const noexcept { return edge_count_; }
+    const std::string& fingerprint() const noexcept { return fingerprint_; }
+    bool is_mapped() const noexcept { return map_addr_ != nullptr; }
+    bool is_packed() const noexcept { return packed_.rows != nullptr; }
+    bool is_paged() const noexcept { return paged_; }
+
+    // Bytes load_paged() locked in memory
+    size_t pinned_bytes() const noexcept { return pinned_bytes_; }
+
+    // Bytes of the mapped file in memory right now (mincore); 0 unless mapped
+    size_t resident_bytes() const;
+
+    /**
+     * @brief Start reading the base rows of `indices` ahead of their neighbors() calls
+     *
+     * Paged graphs only, a no-op otherwise. The rows' pages (edges, masks,
+     * relation counts) are requested with MADV_WILLNEED, adjacent ranges
+     * merged into one call; the reads proceed while the caller continues.
+     */
+    void prefetch(std::span<const uint32_t> indices) const;
+
+    // Bytes holding the base rows: edges, or packed rows and relation counts
+    size_t edge_bytes() const noexcept;
+
+    // How much of the CSR arrays sits in huge pages (HARTONOMOUS_HUGEPAGES, utils/huge_pages.hpp)
+    HugePageUsage huge_page_usage() const;
+
+    // Whether edges carry tenant masks (the graph was loaded with tenants)
+    bool has_tenant_masks() const noexcept { return has_masks_; }
+    const std::vector<BLAKE3Pipeline::Hash>& tenants() const noexcept { return tenants_; }
+
+    /**
+     * @brief Mask a tenant-restricted engine tests edges against
+     *
+     * ALL_TENANTS (no filtering) without a tenant. Throws when a tenant is
+     * given and `graph` is null or has no masks: isolation is refused
+     * rather than silently dropped.
+     */
+    static TenantMask tenant_view(const RelationGraph* graph, const std::optional<BLAKE3Pipeline::Hash>& tenant);
+
+    // Bit of `tenant`'s slot; 0 when it has none, so no edge passes
+    TenantMask tenant_mask(const BLAKE3Pipeline::Hash& tenant) const {
+        for (size_t i = 0; i < tenants_.size(); ++i)
+            if (tenants_[i] == tenant) return TenantMask(1) << i;
+        return 0;
+    }
+
+    size_t overlay_rows() const noexcept { return overlay_rows_.size(); }
+    size_t overlay_edges() const noexcept { return overlay_edges_; }
+
+    uint32_t index_of(const BLAKE3Pipeline::Hash& id) const {
+        if (const uint32_t* i = base_index_->find(id)) return *i;
+        if (overlay_ids_.empty()) return NPOS;
+        const uint32_t* i = overlay_index_.find(id);
+        return i ? *i : NPOS;
+    }
+    const BLAKE3Pipeline::Hash& id_of(uint32_t index) const {
+        return index < base_nodes_ ? ids_[index] : overlay_ids_[index - base_nodes_];
+    }
+
+    /**
+     * @brief The edges of `index`, sorted by target
+     *
+     * A packed row is decoded into a per-thread buffer that the next
+     * neighbors() call on the thread overwrites; hold two rows at once
+     * through the overload taking a buffer.
+     */
+    std::span<const Edge> neighbors(uint32_t index) const {
+        if (!overlay_rows_.empty()) {
+            if (auto it = overlay_rows_.find(index); it != overlay_rows_.end()) return it->second;
+        }
+        if (index >= base_nodes_) return {};
+        if (packed_.rows) return decode_row(index, thread_row());
+        return {edges_ + offsets_[index], edges_ + offsets_[index + 1]};
+    }
+    std::span<const Edge> neighbors(const BLAKE3Pipeline::Hash& id) const { return neighbors(index_of(id)); }
+
+    // As neighbors(index), decoding a packed row into `scratch`
+    std::span<const Edge> neighbors(uint32_t index, std::vector<Edge>& scratch) const {
+        if (!overlay_rows_.empty()) {
+            if (auto it = overlay_rows_.find(index); it != overlay_rows_.end()) return it->second;
+        }
+        if (index >= base_nodes_) return {};
+        if (packed_.rows) return decode_row(index, scratch);
+        return {edges_ + offsets_[index], edges_ + offsets_[index + 1]};
+    }
+
+    // Summary of neighbors(index); all zero for NPOS or a node without edges
+    const NodeSummary& summary(uint32_t index) const {
+        if (!overlay_summaries_.empty()) {
+            if (auto it = overlay_summaries_.find(index); it != overlay_summaries_.end()) return it->second.summary;
+        }
+        if (index >= base_nodes_) return EMPTY_SUMMARY;
+        return summaries_[index];
+    }
+
+    // Positions into neighbors(index) of its best-ranked edges, best first; empty unless a hub
+    std::span<const uint32_t> hub_edges(uint32_t index) const {
+        if (!overlay_summaries_.empty()) {
+            if (auto it = overlay_summaries_.find(index); it != overlay_summaries_.end()) return it->second.hub;
+        }
+        if (index >= base_nodes_) return {};
+        const auto& s = summaries_[index];
+        return {hubs_ + s.hub_offset, s.hub_count};
+    }
+
+    // Masks parallel to neighbors(index); empty without tenant masks
+    std::span<const TenantMask> tenant_masks(uint32_t index) const {
+        if (!has_masks_) return {};
+        if (!overlay_masks_.empty()) {
+            if (auto it = overlay_masks_.find(index); it != overlay_masks_.end()) return it->second;
+        }
+        if (index >= base_nodes_) return {};
+        return {masks_ + offsets_[index], masks_ + offsets_[index + 1]};
+    }
+    std::span<const TenantMask> tenant_masks(const BLAKE3Pipeline::Hash& id) const {
+        return tenant_masks(index_of(id));
+    }
+
+private:
+    RelationGraph() = default;
+
+    // load_file() through the process-wide registry of mapped files
+    static std::shared_ptr<const RelationGraph> shared_file(const std::string& path, const std::string& fingerprint,
+                                                            bool pin, bool paged = false, size_t hot_bytes = 0);
+    // Byte ranges of base row `index` in the mapped arrays
+    template <typename F>
+    void for_each_row_range(uint32_t index, F&& f) const;
+    // Lock the metadata, then the largest hub rows, within `budget` bytes
+    void pin_hot_set(size_t budget);
+    // Counting-sort edges into CSR form; ids are assigned in first-seen order
+    static std::shared_ptr<RelationGraph> build(std::vector<EdgeRecord>& edges, std::string fingerprint,
+                                                std::vector<BLAKE3Pipeline::Hash> tenants, bool masks);
+    void build_index();
+    std::shared_ptr<RelationGraph> flatten(bool interleave) const;
+    std::shared_ptr<RelationGraph> pack_rows(bool interleave) const;
+    std::span<const Edge> decode_row(uint32_t index, std::vector<Edge>& out) const;
+    static std::vector<Edge>& thread_row();
+    void interleave_arrays() const;
+    // Fill owned_summaries_ and owned_hubs_ from the CSR or packed arrays
+    void summarize_rows();
+    // Summary of `row`; appends its hub list to `hub` when it is one
+    static NodeSummary summarize(std::span<const Edge> row, std::vector<uint32_t>& hub);
+
+    static const NodeSummary EMPTY_SUMMARY;
+
+    size_t base_nodes_ = 0;   // Nodes in the CSR arrays; overlay ids follow
+    size_t edge_count_ = 0;
+    std::string fingerprint_;
+
+    // Views into either the owned vectors or the mapped file
+    const BLAKE3Pipeline::Hash* ids_ = nullptr;
+    const uint64_t* offsets_ = nullptr;  // node_count_ + 1 entries
+    const Edge* edges_ = nullptr;
+    const TenantMask* masks_ = nullptr;  // Parallel to edges_ when has_masks_
+    bool has_masks_ = false;
+    const NodeSummary* summaries_ = nullptr;  // One per base node
+    const uint32_t* hubs_ = nullptr;          // Hub lists, indexed by NodeSummary::hub_offset
+    size_t hub_entries_ = 0;
+
+    // Packed base rows (edges_ is then null); offsets_ still index edges
+    struct PackedRows {
+        const uint64_t* rows = nullptr;            // Byte offset of each row, node_count_ + 1 entries
+        const uint8_t* bytes = nullptr;            // Rows (edge_codec.hpp), then STREAM_PADDING
+        const uint32_t* relation_counts = nullptr; // Cold, parallel to offsets_
+        size_t byte_count = 0;                     // Including the padding
+        double elo_min = 0.0;                      // ELO = elo_min + code * elo_step
+        double elo_step = 0.0;
+    };
+    PackedRows packed_;
+
+    std::vector<BLAKE3Pipeline::Hash> owned_ids_;
+    std::vector<uint64_t> owned_offsets_;
+    std::vector<Edge> owned_edges_;
+    std::vector<TenantMask> owned_masks_;
+    std::vector<NodeSummary> owned_summaries_;
+    std::vector<uint32_t> owned_hubs_;
+    std::vector<uint64_t> owned_packed_rows_;
+    std::vector<uint8_t> owned_packed_bytes_;
+    std::vector<uint32_t> owned_relation_counts_;
+    std::vector<BLAKE3Pipeline::Hash> tenants_;  // Slot i is mask bit i
+    void* map_addr_ = nullptr;
+    size_t map_size_ = 0;
+    bool paged_ = false;
+    size_t pinned_bytes_ = 0;
+
+    HashMap128<uint32_t> index_;
+    const HashMap128<uint32_t>* base_index_ = &index_;
+
+    // Overlay snapshots keep the CSR they were derived from alive
+    std::shared_ptr<const RelationGraph> base_;
+    std::vector<BLAKE3Pipeline::Hash> overlay_ids_;
+    HashMap128<uint32_t> overlay_index_;
+    std::unordered_map<uint32_t, std::vector<Edge>> overlay_rows_;  // Replaces the CSR row
+    std::unordered_map<uint32_t, std::vector<TenantMask>> overlay_masks_;  // Same keys, with masks
+    struct OverlaySummary {
+        NodeSummary summary;
+        std::vector<uint32_t> hub;
+    };
+    std::unordered_map<uint32_t, OverlaySummary> overlay_summaries_;  // Same keys
+    size_t overlay_edges_ = 0;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,184 @@
+#pragma once
+
+/**
+ * @file search_arena.hpp
+ * @brief Reusable per-thread state for best-first graph searches
+ *
+ * A search touches a few thousand nodes out of millions, so per-node state
+ * lives in slots handed out in touch order: one open-addressing table maps
+ * an interned composition ID to its slot, and g-cost, parent and the edge
+ * that reached the node are parallel arrays indexed by slot. The open list
+ * is a 4-ary heap of (f, slot) indexed by slot: pushing a slot that is
+ * already open moves its entry instead of adding another, so the heap holds
+ * at most one entry per node and a pop is never stale. Four children share
+ * a cache line's worth of entries, halving the levels a sift walks compared
+ * with a binary heap. reset() keeps every allocation, so a
+ * thread running back-to-back queries stops allocating after the first few.
+ * An arena holds one search at a time; searches must not nest on a thread.
+ * A bidirectional search takes the thread's second arena for its backward
+ * frontier.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class SearchArena {
+public:
+    static constexpr uint32_t NONE = ~uint32_t(0);
+
+    struct OpenEntry {
+        double f;
+        uint32_t slot;
+    };
+
+    // Arenas per thread (0: forward, 1: backward), reused across searches
+    static SearchArena& for_this_thread(unsigned which = 0) {
+        thread_local SearchArena arenas[2];
+        return arenas[which];
+    }
+
+    void reset() {
+        node.clear();
+        g.clear();
+        parent.clear();
+        edge_elo.clear();
+        edge_obs.clear();
+        heap_pos_.clear();
+        open_.clear();
+        std::fill(keys_.begin(), keys_.end(), NONE);
+    }
+
+    size_t size() const noexcept { return node.size(); }
+
+    uint32_t find(uint32_t id) const {
+        if (keys_.empty()) return NONE;
+        for (size_t i = mix(id) & mask_;; i = (i + 1) & mask_) {
+            if (keys_[i] == id) return slots_[i];
+            if (keys_[i] == NONE) return NONE;
+        }
+    }
+
+    // Slot for `id`, creating it (g = +inf, no parent) on first touch
+    std::pair<uint32_t, bool> touch(uint32_t id) {
+        if ((node.size() + 1) * 2 > keys_.size()) grow();
+        for (size_t i = mix(id) & mask_;; i = (i + 1) & mask_) {
+            if (keys_[i] == id) return {slots_[i], false};
+            if (keys_[i] == NONE) {
+                uint32_t slot = static_cast<uint32_t>(node.size());
+                keys_[i] = id;
+                slots_[i] = slot;
+                node.push_back(id);
+                g.push_back(std::numeric_limits<double>::infinity());
+                parent.push_back(NONE);
+                edge_elo.push_back(0.0);
+                edge_obs.push_back(0.0);
+                heap_pos_.push_back(NONE);
+                return {slot, true};
+            }
+        }
+    }
+
+    // Open `slot` at priority f, or move it to f if it is open already
+    void push(double f, uint32_t slot) {
+        uint32_t at = heap_pos_[slot];
+        if (at == NONE) {
+            at = static_cast<uint32_t>(open_.size());
+            open_.push_back({f, slot});
+            sift_up(at);
+            return;
+        }
+        const double old = open_[at].f;
+        open_[at].f = f;
+        if (f < old) sift_up(at);
+        else sift_down(at);
+    }
+
+    bool open_empty() const noexcept { return open_.empty(); }
+    size_t open_size() const noexcept { return open_.size(); }
+    bool is_open(uint32_t slot) const noexcept { return heap_pos_[slot] != NONE; }
+
+    // Lowest-f entry; the open list must not be empty
+    const OpenEntry& top() const { return open_.front(); }
+
+    OpenEntry pop() {
+        const OpenEntry e = open_.front();
+        heap_pos_[e.slot] = NONE;
+        const OpenEntry last = open_.back();
+        open_.pop_back();
+        if (!open_.empty()) {
+            open_[0] = last;
+            sift_down(0);
+        }
+        return e;
+    }
+
+    // Per-slot state; parent is a slot, NONE for the root
+    std::vector<uint32_t> node;
+    std::vector<double> g;
+    std::vector<uint32_t> parent;
+    std::vector<double> edge_elo;
+    std::vector<double> edge_obs;
+
+private:
+    static constexpr uint32_t ARITY = 4;
+
+    void place(uint32_t at, const OpenEntry& e) {
+        open_[at] = e;
+        heap_pos_[e.slot] = at;
+    }
+
+    void sift_up(uint32_t at) {
+        const OpenEntry e = open_[at];
+        while (at > 0) {
+            const uint32_t up = (at - 1) / ARITY;
+            if (open_[up].f <= e.f) break;
+            place(at, open_[up]);
+            at = up;
+        }
+        place(at, e);
+    }
+
+    void sift_down(uint32_t at) {
+        const OpenEntry e = open_[at];
+        const uint32_t n = static_cast<uint32_t>(open_.size());
+        for (;;) {
+            const uint32_t first = at * ARITY + 1;
+            if (first >= n) break;
+            uint32_t best = first;
+            for (uint32_t c = first + 1; c < std::min(first + ARITY, n); ++c)
+                if (open_[c].f < open_[best].f) best = c;
+            if (open_[best].f >= e.f) break;
+            place(at, open_[best]);
+            at = best;
+        }
+        place(at, e);
+    }
+
+    static size_t mix(uint32_t id) { return static_cast<size_t>((uint64_t(id) * 0x9E3779B97F4A7C15ULL) >> 32); }
+
+    void grow() {
+        size_t cap = std::max<size_t>(1024, keys_.size() * 2);
+        keys_.assign(cap, NONE);
+        slots_.assign(cap, 0);
+        mask_ = cap - 1;
+        for (uint32_t slot = 0; slot < node.size(); ++slot) {
+            size_t i = mix(node[slot]) & mask_;
+            while (keys_[i] != NONE) i = (i + 1) & mask_;
+            keys_[i] = node[slot];
+            slots_[i] = slot;
+        }
+    }
+
+    std::vector<uint32_t> keys_;   // Interned ID, NONE if empty
+    std::vector<uint32_t> slots_;
+    size_t mask_ = 0;
+    std::vector<uint32_t> heap_pos_;   // Per slot: index into open_, NONE when not open
+    std::vector<OpenEntry> open_;
+};
+
+} // namespace Hartonomous
@@ -20,22 +20,31 @@
  *     partitions compare? Disagreement between models' cell assignments
  *     reveals polysemy and conceptual ambiguity.
  *
- * Implementation uses Monte Carlo sampling on S³ rather than exact geometric
- * Voronoi construction (which is expensive in 4D). For each concept, we sample
- * random points in its neighborhood and classify them by nearest concept.
- * This gives approximate but practical cell metrics.
+ * The default mode uses Monte Carlo sampling on S³: for each concept, we
+ * sample random points in its neighborhood and classify them by nearest
+ * concept. This gives approximate but practical cell metrics.
+ *
+ * Exact mode triangulates a loaded neighborhood once (Geometry::S3Delaunay,
+ * a convex hull in R⁴) and reads volumes, faces and eccentricity off the
+ * cells. Triangulations are cached, so cells inside an earlier neighborhood
+ * cost no query. Cells on the rim of a neighborhood, which sites outside it
+ * could cut, fall back to sampling.
  */
 
 #pragma once
 
 #include <hashing/blake3_pipeline.hpp>
 #include <database/postgres_connection.hpp>
+#include <spatial/hilbert_range_query.hpp>
+#include <geometry/s3_voronoi.hpp>
 #include <export.hpp>
 #include <Eigen/Dense>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 #include <unordered_map>
-#include <random>
+#include <cstdint>
 
 namespace Hartonomous {
 
@@ -66,7 +75,7 @@ struct VoronoiOverlap {
     // Per-model cell assignments
     struct ModelCell {
         BLAKE3Pipeline::Hash content_id;  // Model source
-        double volume;
+        double volume;                    // Share of the search_radius ball it owns in this model's partition
         Eigen::Vector4d centroid;
     };
     std::vector<ModelCell> model_cells;
@@ -77,7 +86,13 @@ struct VoronoiOverlap {
     double max_centroid_distance;  // Maximum disagreement between any two models
 };
 
+enum class VoronoiMode {
+    MonteCarlo,
+    Exact,           // Cells from the spherical Delaunay triangulation; rim cells are sampled
+};
+
 struct VoronoiConfig {
+    VoronoiMode mode = VoronoiMode::MonteCarlo;
     size_t samples_per_cell = 1000;   // Monte Carlo samples per cell
     size_t max_neighbors = 32;        // Max boundary neighbors to track
     double search_radius = 0.5;       // Geodesic radius around centroid to sample
@@ -110,6 +125,12 @@ public:
      *
      * Compares Voronoi cells across different model projections.
      * Requires model_projection table to be populated.
+     *
+     * Texts and projections of every composition come back in one query. Each
+     * model's projections of the requested compositions form one partition;
+     * a cell's volume is the share of samples within search_radius of its
+     * centroid that it owns there, and all (concept, model) cells are
+     * sampled in parallel.
      */
     std::vector<VoronoiOverlap> analyze_model_overlap(
         const std::vector<BLAKE3Pipeline::Hash>& composition_ids,
@@ -135,10 +156,6 @@ public:
         size_t limit = 50);
 
 private:
-    // Generate random point on S³ near a given centroid within geodesic radius
-    Eigen::Vector4d sample_near(const Eigen::Vector4d& center,
-                                double radius, std::mt19937& rng) const;
-
     // Geodesic distance on S³
     double geodesic(const Eigen::Vector4d& a, const Eigen::Vector4d& b) const;
 
@@ -151,12 +168,55 @@ private:
     std::vector<PositionEntry> load_neighborhood(
         const Eigen::Vector4d& center, double radius);
 
-    // Find nearest composition to a point (brute force within neighborhood)
-    const PositionEntry* find_nearest(
-        const Eigen::Vector4d& point,
-        const std::vector<PositionEntry>& neighborhood) const;
+    /**
+     * @brief A neighborhood prepared for nearest-centroid queries
+     *
+     * Positions are also kept as columns so blocks of samples scan them in
+     * lockstep; neighborhoods large enough get a Hilbert index instead
+     * (`hint` is its starting search radius).
+     */
+    struct Neighborhood {
+        std::vector<PositionEntry> entries;
+        std::vector<double> x, y, z, w;
+        std::optional<hartonomous::spatial::HilbertPointIndex> index;
+        double hint = 0.0;
+    };
+    Neighborhood prepare_neighborhood(std::vector<PositionEntry> entries, double radius) const;
+
+    // A triangulated neighborhood; sites are entries in order
+    struct ExactNeighborhood {
+        std::vector<PositionEntry> entries;
+        Geometry::S3Delaunay diagram;
+        std::unordered_map<BLAKE3Pipeline::Hash, uint32_t, HashHasher> site_of;
+    };
+
+    // Triangulate the entries loaded within `radius` of `center` and cache the result
+    std::shared_ptr<const ExactNeighborhood> cache_exact(const Eigen::Vector4d& center, double radius,
+                                                         std::vector<PositionEntry> entries);
+
+    // A cached neighborhood in which `id` has an exact cell, or nullptr
+    std::shared_ptr<const ExactNeighborhood> find_exact(const BLAKE3Pipeline::Hash& id, uint32_t& site) const;
+
+    // Cell metrics from the triangulation; volume is relative to the `radius` ball
+    void fill_exact(VoronoiCell& cell, const ExactNeighborhood& hood, uint32_t site,
+                    size_t max_neighbors, double radius) const;
+
+    // Monte Carlo tallies for one cell
+    struct CellSamples {
+        size_t owned = 0;
+        size_t boundary = 0;
+        double boundary_distance_sum = 0.0;
+        std::unordered_map<uint32_t, size_t> neighbor_counts;  // By neighborhood index
+        Eigen::Vector4d owned_sum = Eigen::Vector4d::Zero();
+        Eigen::Matrix4d owned_scatter = Eigen::Matrix4d::Zero();
+    };
+
+    // Classify `samples` points drawn within `radius` of `center`; owned when nearest is entries[self]
+    CellSamples sample_cell(const Neighborhood& hood, const Eigen::Vector4d& center, size_t self,
+                            size_t samples, double radius, uint64_t seed, bool scatter) const;
 
     PostgresConnection& db_;
+    std::vector<std::shared_ptr<const ExactNeighborhood>> exact_cache_;  // Most recent first
 };
 
 } // namespace Hartonomous
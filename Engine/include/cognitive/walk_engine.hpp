@@ -9,7 +9,15 @@
 #pragma once
 
 #include <hashing/blake3_pipeline.hpp>
-#include <database/postgres_connection.hpp>
+#include <database/connection_pool.hpp>
+#include <cognitive/graph_shards.hpp>
+#include <cognitive/live_relation_graph.hpp>
+#include <cognitive/neighbor_prefetcher.hpp>
+#include <cognitive/walk_scorer.hpp>
+#include <storage/composition_text_store.hpp>
+#include <storage/atom_lookup.hpp>
+#include <query/centroid_index.hpp>
+#include <query/composition_resolver.hpp>
 #include <ingestion/ngram_extractor.hpp>
 #include <export.hpp>
 #include <Eigen/Dense>
@@ -19,7 +27,10 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <deque>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 namespace Hartonomous {
 
@@ -46,6 +57,13 @@ struct WalkParameters {
     double energy_decay = 0.03;          // Energy lost per step (~33 steps at 1.0)
     
     size_t recent_window = 16;           // For novelty loop detection
+
+    // Beam search: keep this many partial walks and pick the likeliest at
+    // the end instead of sampling one (0 or 1: a single sampled walk)
+    size_t beam_width = 0;
+
+    // RNG seed of walks generate() starts; unset draws a fresh one per walk
+    std::optional<uint64_t> seed;
 };
 
 struct WalkState {
@@ -55,11 +73,17 @@ struct WalkState {
     double current_energy;
     
     std::vector<BLAKE3Pipeline::Hash> trajectory;
-    std::unordered_map<BLAKE3Pipeline::Hash, int, HashHasher> visit_counts;
-    std::deque<BLAKE3Pipeline::Hash> recent; // Fixed-size window
+    // Keyed by CompositionInterner ID
+    std::unordered_map<uint32_t, int> visit_counts;
+    std::deque<uint32_t> recent; // Fixed-size window
     
     std::optional<BLAKE3Pipeline::Hash> goal_composition;
     std::optional<Eigen::Vector4d> goal_position;
+
+    // Philox stream of this walk and the steps drawn from it: a step's draw
+    // depends on nothing else, so a copied or resumed state samples the same
+    uint64_t rng_key = 0;
+    uint64_t rng_step = 0;
 };
 
 struct WalkStepResult {
@@ -73,23 +97,96 @@ struct WalkStepResult {
 class HARTONOMOUS_API WalkEngine {
 public:
     explicit WalkEngine(PostgresConnection& db);
+    explicit WalkEngine(ConnectionPool& pool);  // Holds one pooled connection for its lifetime
 
     WalkState init_walk(const BLAKE3Pipeline::Hash& start_id, double initial_energy = 1.0);
     WalkState init_walk_from_prompt(const std::string& prompt, double initial_energy = 1.0);
     WalkStepResult step(WalkState& state, const WalkParameters& params);
     void set_goal(WalkState& state, const BLAKE3Pipeline::Hash& goal_id);
 
+    // Make state's draws those of stream `stream` under `seed`, from its next step on
+    static void seed_walk(WalkState& state, uint64_t seed, uint64_t stream = 0);
+
     // High-level: prompt → coherent text response
     std::string generate(const std::string& prompt, const WalkParameters& params, size_t max_steps = 50);
 
+    // Receives each word as the walk takes it, seed first; return false to stop the walk
+    using WordCallback = std::function<bool(std::string_view word)>;
+
+    // As above, handing each word to `on_word` before the next step is taken
+    std::string generate(const std::string& prompt, const WalkParameters& params, size_t max_steps,
+                         const WordCallback& on_word);
+
+    /**
+     * @brief n_samples independent walks per prompt, run concurrently
+     *
+     * Seeds are resolved up front; the walks then share one read-only
+     * relation graph snapshot (set_relation_graph / follow_relation_graph)
+     * and each draws from its own Philox stream keyed by (seed, walk index),
+     * so the output depends only on the inputs, not on thread scheduling or
+     * on which process runs it.
+     * Without a snapshot the walks fall back to per-step queries and run one
+     * at a time. Result i * n_samples + s is sample s of prompt i.
+     */
+    std::vector<std::string> generate_batch(const std::vector<std::string>& prompts, const WalkParameters& params,
+                                            size_t max_steps = 50, size_t n_samples = 1, uint64_t seed = 0);
+
+    // As above, each walk starting at a composition instead of a prompt
+    std::vector<std::string> generate_batch(const std::vector<BLAKE3Pipeline::Hash>& starts,
+                                            const WalkParameters& params, size_t max_steps = 50,
+                                            size_t n_samples = 1, uint64_t seed = 0);
+
+    /**
+     * @brief Read candidates from an in-memory snapshot instead of the database
+     *
+     * Pass nullptr to go back to per-step queries.
+     */
+    void set_relation_graph(std::shared_ptr<const RelationGraph> graph) {
+        graph_ = std::move(graph);
+        live_.reset();
+    }
+
+    // Take the live graph's current epoch at the start of every step
+    void follow_relation_graph(std::shared_ptr<const LiveRelationGraph> live) { live_ = std::move(live); }
+
+    /**
+     * @brief Treat the snapshot as this process's shard of `shards`
+     *
+     * A step from a composition another shard owns reads its row from that
+     * shard (GraphShards::neighbors); beam walks fetch the frontier's
+     * remote rows together. Pass nullptr for an unsharded graph.
+     */
+    void set_graph_shards(std::shared_ptr<GraphShards> shards) { shards_ = std::move(shards); }
+
+    // Whether walks read a snapshot (and generate_batch runs them concurrently)
+    bool has_relation_graph() const { return graph_ || live_; }
+
+    /**
+     * @brief Restrict walks to edges with evidence from `tenant` (nullopt: all)
+     *
+     * Enforced by a bit test on the snapshot's tenant masks; throws when a walk steps
+     * without a graph loaded with masks (RelationGraph::tenant_view).
+     */
+    void set_tenant(std::optional<BLAKE3Pipeline::Hash> tenant) { tenant_ = tenant; }
+
+    // Replace the process-wide text store (e.g. one loaded from a specific snapshot)
+    void set_text_store(std::shared_ptr<const CompositionTextStore> texts) { texts_ = std::move(texts); }
+
+    // Replace the process-wide centroid index used for fuzzy prompt seeds
+    void set_centroid_index(std::shared_ptr<CentroidIndex> index) { centroids_ = std::move(index); }
+
     // Utilities
-    std::string lookup_text(const BLAKE3Pipeline::Hash& id) const;
-    BLAKE3Pipeline::Hash find_composition(const std::string& text);
+    std::string_view lookup_text(const BLAKE3Pipeline::Hash& id) const;  // Valid while the text store lives
+    BLAKE3Pipeline::Hash find_composition(const std::string& text);  // Exact or case/whitespace variant
+
+    // Composition whose centroid is nearest the text's; zero hash if none
+    BLAKE3Pipeline::Hash find_nearest_composition(const std::string& text);
 
 private:
     struct Candidate {
         BLAKE3Pipeline::Hash id;
-        std::string text;
+        uint32_t node = 0;           // Interned id
+        std::string_view text;       // Points into the text store
         
         // Relation graph signals
         double elo_score = 0.0;      // Locally normalized ELO rating
@@ -100,14 +197,87 @@ private:
         double score = 0.0;
     };
 
-    std::vector<Candidate> get_candidates(const WalkState& state);
-    double score_candidate(const WalkState& state, const Candidate& c, const WalkParameters& params);
-    size_t select_index(const std::vector<double>& probs);
+    // Best seed of a prompt and the context seeds that boost candidates
+    struct PromptSeeds {
+        BLAKE3Pipeline::Hash start{};
+        std::vector<BLAKE3Pipeline::Hash> context;  // Empty unless the prompt had several seeds
+        bool found = false;
+    };
+    PromptSeeds seed_prompt(const std::string& prompt);
+
+    // A walk's view of the engine: graph snapshot (nullptr: query the database), prompt context,
+    // and the scorer fixed for the walk's parameters (nullptr: built for the step)
+    struct WalkContext {
+        const RelationGraph* graph = nullptr;
+        const std::vector<BLAKE3Pipeline::Hash>* context_seeds = nullptr;
+        const WalkScorer* scorer = nullptr;
+    };
+
+    // Neighbors of the current composition, normalized over its whole row. A hub
+    // of the graph offers its precomputed best-ranked edges and the context
+    // seeds among its neighbors (RelationGraph::hub_edges) instead of every edge.
+    std::vector<Candidate> get_candidates(const WalkState& state, const RelationGraph* graph,
+                                          const std::vector<BLAKE3Pipeline::Hash>* context_seeds = nullptr);
+    /**
+     * @brief Gumbel-max draw from softmax(logits) with the walk's next Philox step
+     *
+     * Candidate i's noise is keyed by its composition ID rather than its
+     * position, so the pick does not depend on the order rows arrived in.
+     */
+    static size_t select_index(const std::vector<Candidate>& candidates, const std::vector<double>& logits,
+                               WalkState& state);
+    WalkStepResult step(WalkState& state, const WalkParameters& params, const WalkContext& ctx);
+
+    // Signals of `candidates` into entries [offset, offset + size) of `out`, from `state`'s view
+    static void fill_signals(const std::vector<Candidate>& candidates, const WalkState& state, const WalkContext& ctx,
+                             const WalkScorer& scorer, WalkCandidates& out, size_t offset);
+
+    // Keep the SAMPLE_TOP_K best scored; the walk samples (or a beam expands) only those
+    static void keep_top(std::vector<Candidate>& candidates);
+
+    // Energy-modulated temperature: high energy = exploratory, low energy = greedy
+    static double temperature(const WalkParameters& params, double energy);
+
+    // Move `state` onto `next`
+    static void advance(WalkState& state, const Candidate& next, const WalkParameters& params);
+
+    /**
+     * @brief Beam search from `state`: params.beam_width walks kept per step
+     *
+     * Every step expands all live heads together: their rows are fetched in
+     * one round trip (or read from the snapshot), every candidate of every
+     * head is scored in one WalkScorer pass, and the heads' top-K expansions
+     * are pruned back to the width by cumulative log-probability. `state`
+     * ends as the beam with the best mean log-probability per step.
+     */
+    void beam_walk(WalkState& state, const WalkParameters& params, size_t max_steps, const WalkContext& ctx);
+
+    // Queue the chosen node and the next likeliest for loading: from the database, or a paged graph's file
+    void prefetch_likely(const RelationGraph* graph, const std::vector<Candidate>& candidates,
+                         const std::vector<double>& probs, size_t chosen);
+
+    // The walk from `state` as assembled text (beam searched when params.beam_width > 1)
+    std::string walk_text(WalkState& state, const WalkParameters& params, size_t max_steps, const WalkContext& ctx,
+                          const WordCallback* on_word = nullptr);
+
+    std::vector<std::string> run_batch(std::vector<WalkState> starts,
+                                       const std::vector<std::vector<BLAKE3Pipeline::Hash>>& contexts,
+                                       const WalkParameters& params, size_t max_steps, uint64_t seed);
     void preload_composition_text();
 
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
-    std::unordered_map<BLAKE3Pipeline::Hash, std::string, HashHasher> comp_text_cache_;
+    CompositionResolver resolver_{db_};
+    std::shared_ptr<const CompositionTextStore> texts_;
     std::vector<BLAKE3Pipeline::Hash> context_seeds_; // From multi-seed prompt init
+    std::shared_ptr<const RelationGraph> graph_;
+    std::optional<BLAKE3Pipeline::Hash> tenant_;
+    std::shared_ptr<GraphShards> shards_;
+    std::unique_ptr<NeighborPrefetcher> prefetch_;          // Started by the first step without a graph
+    size_t prefetch_width_ = NeighborPrefetcher::width_from_env();
+    std::shared_ptr<const LiveRelationGraph> live_;
+    std::shared_ptr<CentroidIndex> centroids_;  // Loaded on the first fuzzy seed
+    std::unique_ptr<AtomLookup> atoms_;
 };
 
 } // namespace Hartonomous
@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * @file walk_scorer.hpp
+ * @brief WalkEngine's candidate scoring and softmax, specialized on the terms a walk uses
+ *
+ * A walk's weights do not change between steps, so WalkScorer fixes them
+ * when the walk starts and picks one kernel for the set of terms with a
+ * non-zero weight: the sigmoid relation gate, the repeat penalty and the
+ * novelty penalty are compiled out when their weight is zero, and their
+ * inputs need not be filled. Kernels run over WalkCandidates, the
+ * candidates' signals as parallel arrays, in one branch-free loop cloned
+ * per instruction set (as in s3_batch.cpp) and picked from simd_level().
+ *
+ * Scores follow the formula WalkEngine has always used: ELO, observation
+ * and gated relation terms; stop words capped at 0.02, other words +0.05;
+ * +0.3 for a context seed; the penalties; the energy bonus; then x^0.75.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Hartonomous {
+
+struct WalkParameters;
+
+// Signals of a step's candidates, one entry per candidate in every array
+struct WalkCandidates {
+    enum Flag : uint8_t {
+        STOP_WORD = 1,
+        CONTEXT_SEED = 2,
+        RECENT = 4,    // In the walk's recent window; filled only if uses_novelty()
+    };
+
+    std::vector<double> elo;      // ELO normalized over the row
+    std::vector<double> obs;      // Observations over the row's maximum
+    std::vector<double> rel;      // Raw observations, sigmoid-gated; filled only if uses_relation()
+    std::vector<double> visits;   // Times the walk visited it; filled only if uses_repeat()
+    std::vector<uint8_t> flags;
+
+    size_t size() const noexcept { return flags.size(); }
+
+    // Size every array for n candidates; the contents are left for the caller to fill
+    void resize(size_t n) {
+        elo.resize(n);
+        obs.resize(n);
+        rel.resize(n);
+        visits.resize(n);
+        flags.resize(n);
+    }
+};
+
+class WalkScorer {
+public:
+    explicit WalkScorer(const WalkParameters& params);
+
+    bool uses_relation() const noexcept { return terms_ & REL; }
+    bool uses_repeat() const noexcept { return terms_ & REPEAT; }
+    bool uses_novelty() const noexcept { return terms_ & NOVELTY; }
+
+    // Score every candidate into out[0 .. c.size()); `energy` is the walk's current energy
+    void score(const WalkCandidates& c, double energy, double* out) const;
+
+    /**
+     * @brief logits = (score - max) / temperature and probs = softmax(logits), n > 0
+     */
+    void softmax(const double* scores, size_t n, double temperature, double* logits, double* probs) const;
+
+    struct Weights {
+        double model = 0.0;
+        double text = 0.0;
+        double rel = 0.0;
+        double repeat = 0.0;
+        double novelty = 0.0;
+        double energy = 0.0;
+    };
+
+    using ScoreKernel = void (*)(const Weights&, const WalkCandidates&, double, double*) noexcept;
+    using SoftmaxKernel = void (*)(const double*, size_t, double, double*, double*) noexcept;
+
+private:
+    enum Term : unsigned { REL = 1, REPEAT = 2, NOVELTY = 4 };
+
+    Weights w_;
+    unsigned terms_ = 0;
+    ScoreKernel score_ = nullptr;
+    SoftmaxKernel softmax_ = nullptr;
+};
+
+} // namespace Hartonomous
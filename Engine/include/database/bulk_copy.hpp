@@ -1,7 +1,10 @@
 #pragma once
 
 #include <database/postgres_connection.hpp>
+#include <database/copy_row.hpp>
 #include <atomic>
+#include <chrono>
+#include <stdexcept>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -23,15 +26,36 @@ namespace Hartonomous {
  * - flush() finishes the COPY and inserts the data.
  * - This class is not thread-safe; use one instance per connection/thread.
  *
- * Modes:
- * - Default (use_temp_table=true): Creates temp table, COPYs into it, then
- *   INSERTs with ON CONFLICT DO NOTHING. Slower but handles duplicates.
- * - Direct (use_temp_table=false): COPYs directly into target table.
- *   Much faster but fails on duplicate keys.
+ * Modes (CopyMode):
+ * - Staged (use_temp_table=true): COPYs into a session staging table, then
+ *   INSERTs with ON CONFLICT DO NOTHING. Handles duplicates against rows
+ *   already in the table. The staging table (pg_temp.stage_<table>, so
+ *   never WAL-logged) is created once per connection and truncated at the
+ *   start of each COPY rather than recreated per batch.
+ * - TrustedUnique (use_temp_table=false): COPYs straight into the target
+ *   table; each row is written once. The caller guarantees no row exists
+ *   yet (e.g. filtered through SubstrateCache) — a duplicate key fails the
+ *   whole COPY.
+ *
+ * Sending: rows accumulate in a send buffer of send_buffer_bytes() and go
+ * out as one CopyData message when it fills. With async send (default; set
+ * HARTONOMOUS_COPY_ASYNC=0 to disable) the socket is non-blocking during
+ * COPY: a full buffer is queued in libpq and the caller resumes encoding
+ * while it is transmitted, waiting only if the previous buffer is still
+ * unsent. HARTONOMOUS_COPY_BUFFER_KB overrides the buffer size.
+ *
+ * Each finished COPY adds its table, row count and bytes sent to
+ * IngestReport::global().
  */
+enum class CopyMode {
+    TrustedUnique,  // COPY directly into the target table
+    Staged          // COPY into a reused staging table, then INSERT ... ON CONFLICT
+};
+
 class BulkCopy {
 public:
     explicit BulkCopy(PostgresConnection& db, bool use_temp_table = true) noexcept;
+    BulkCopy(PostgresConnection& db, CopyMode mode) noexcept;
     ~BulkCopy();
 
     // Prepare for a target table and column list. Call once before add_row.
@@ -52,6 +76,13 @@ public:
     // Queryability is NOT affected; data is stored as standard types.
     void set_binary(bool binary);
 
+    // Overlap encoding with transmission (non-blocking socket during COPY)
+    void set_async_send(bool async);
+
+    // Bytes buffered per CopyData message (both text and binary mode)
+    void set_send_buffer_bytes(size_t bytes);
+    size_t send_buffer_bytes() const noexcept { return send_buffer_bytes_; }
+
     // Row builder for binary COPY
     struct BinaryRow {
         std::vector<uint8_t> buffer;
@@ -69,7 +100,8 @@ public:
         void add_bool(bool val);
 
         // Bytea domain helpers — send unsigned integers as raw big-endian bytes.
-        // These match the PostgreSQL uint16/uint32/uint64 bytea domains.
+        // These match the PostgreSQL uint16/uint32/uint64 bytea domains and the
+        // binary form of the hartonomous extension's native uint64.
         void add_uint16(uint16_t val);
         void add_uint32(uint32_t val);
         void add_uint64(uint64_t val);
@@ -79,6 +111,36 @@ public:
 
     void add_row(const BinaryRow& row);
 
+    /**
+     * @brief Encode one binary row directly into the send buffer.
+     *
+     * Schema is a pgcopy::Schema<...>; the row is sized up front and each
+     * field written in place, with no per-row allocation.
+     */
+    template <typename Schema, typename... Args>
+    void write_row(const Args&... values) {
+        size_t n = Schema::size(values...);
+        uint8_t* p = reserve_row(n);
+        Schema::encode(p, values...);
+        commit_row(n);
+    }
+
+    /**
+     * @brief Reserve n contiguous bytes for one encoded row (field count
+     * included). Pair with commit_row(n) once the row is written.
+     */
+    uint8_t* reserve_row(size_t n) {
+        if (!binary_mode_) throw std::runtime_error("Cannot add binary row in text mode");
+        start_copy_if_needed();
+        if (bin_size_ + n > bin_buffer_.size()) make_room(n);
+        return bin_buffer_.data() + bin_size_;
+    }
+
+    void commit_row(size_t n) noexcept {
+        bin_size_ += n;
+        ++row_count_;
+    }
+
     // Number of rows added since begin_table (resets after flush)
     size_t count() const noexcept { return row_count_; }
 
@@ -88,29 +150,38 @@ private:
     
     // Binary COPY helpers
     void write_binary_header();
+    void make_room(size_t n);
+    void send_binary_buffer();
+    void send_text_buffer();
+    void send(const char* data, size_t len);
 
     void escape_value_into_buffer(const std::string& value);
     std::string quote_identifier(const std::string& id) const;
     std::string full_table_name() const;
+    std::string staging_table_name() const;
 
     PostgresConnection& db_;
     std::ostringstream buffer_;         // For TEXT mode
-    std::vector<uint8_t> bin_buffer_;   // For BINARY mode
+    std::vector<uint8_t> bin_buffer_;   // For BINARY mode; sized to send_buffer_bytes_
+    size_t bin_size_ = 0;               // Bytes of bin_buffer_ in use
     
     bool binary_mode_ = false;
+    bool async_send_ = true;
+    size_t send_buffer_bytes_ = DEFAULT_SEND_BUFFER_BYTES;
 
     std::string schema_;
     std::string table_name_;
     std::vector<std::string> columns_;
-    std::string temp_table_name_;
+    std::string staging_table_;         // Unquoted name in pg_temp
     size_t row_count_ = 0;
+    uint64_t bytes_sent_ = 0;           // CopyData bytes of the current COPY
+    std::chrono::steady_clock::time_point copy_start_;
     bool in_copy_ = false;
     bool use_temp_table_ = true;
-    bool temp_table_created_ = false;
     std::string conflict_clause_;
 
-    static std::atomic<uint64_t> s_counter_;
-    static constexpr size_t DEFAULT_FLUSH_ROWS = 50000;
+    static constexpr size_t DEFAULT_SEND_BUFFER_BYTES = size_t{1} << 20;
+    static constexpr size_t MIN_SEND_BUFFER_BYTES = size_t{16} << 10;
 };
 
 } // namespace Hartonomous
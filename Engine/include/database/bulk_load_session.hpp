@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file bulk_load_session.hpp
+ * @brief Deferred index and CHECK maintenance around a bulk ingest
+ *
+ * AsyncFlusher already skips FK triggers, but every COPY still updates the
+ * GiST indexes on physicality, the Hilbert B-tree, the text indexes and the
+ * sequence indexes row by row, and evaluates the physicality CHECK.
+ * HARTONOMOUS_BULK_LOAD=1 makes the ingest tools open a session first:
+ *
+ *   begin()   record the definition of every secondary index and CHECK
+ *             constraint on the substrate tables in
+ *             hartonomous_internal.bulkloaddeferred, then drop them, all in
+ *             one transaction. Primary keys stay (ON CONFLICT needs them).
+ *   finish()  rebuild the indexes from up to `jobs` sessions at once, each
+ *             build allowed `maintenance_workers` parallel workers, with
+ *             indexes of partitioned tables built one partition per task and
+ *             attached to their parent; then re-add each CHECK NOT VALID and
+ *             VALIDATE it, which scans without blocking writers; then ANALYZE.
+ *
+ * A deferred object's row is deleted in the transaction that restores it,
+ * so the table always lists exactly what is still missing. An interrupted
+ * ingest or rebuild leaves it in place: the next bulk session carries on from
+ * it, and the next session without HARTONOMOUS_BULK_LOAD rebuilds before it
+ * ingests.
+ *
+ *   HARTONOMOUS_BULK_LOAD=1                 defer maintenance (default off)
+ *   HARTONOMOUS_BULK_LOAD_JOBS=N            concurrent builds (default: cores / 4, at least 1)
+ *   HARTONOMOUS_BULK_LOAD_WORKERS=N         max_parallel_maintenance_workers per build (default 4)
+ *   HARTONOMOUS_BULK_LOAD_MEMORY=<setting>  maintenance_work_mem per build (default: the server's)
+ */
+
+#include <database/postgres_connection.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+struct BulkLoadOptions {
+    bool enabled = false;
+    size_t jobs = 0;                  // 0: hardware threads / 4
+    size_t maintenance_workers = 4;
+    std::string maintenance_memory;   // Empty: leave the server's
+
+    /**
+     * @brief Defaults overridden by HARTONOMOUS_BULK_LOAD{,_JOBS,_WORKERS,_MEMORY}
+     */
+    static BulkLoadOptions from_env();
+};
+
+class BulkLoadSession {
+public:
+    // Tables under hartonomous whose indexes and CHECKs a session defers
+    static const std::vector<std::string>& tables();
+
+    /**
+     * @brief Defer maintenance when `opts.enabled`, else finish what an earlier session left
+     */
+    explicit BulkLoadSession(PostgresConnection& db, BulkLoadOptions opts = BulkLoadOptions::from_env());
+
+    BulkLoadSession(const BulkLoadSession&) = delete;
+    BulkLoadSession& operator=(const BulkLoadSession&) = delete;
+
+    /**
+     * @brief Rebuild and validate everything deferred; idempotent
+     *
+     * Throws after every task has run if any failed; those stay listed for
+     * the next call. Nothing is done on destruction, so a failed ingest
+     * leaves the tables soft for a rerun instead of paying for a rebuild.
+     */
+    void finish();
+
+    // Indexes and constraints still listed as deferred
+    static size_t pending(PostgresConnection& db);
+
+    // Record and drop the secondary indexes and CHECKs of `tables()`; returns how many are now deferred
+    static size_t begin(PostgresConnection& db);
+
+    static void finish(PostgresConnection& db, const BulkLoadOptions& opts);
+
+private:
+    PostgresConnection& db_;
+    BulkLoadOptions opts_;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,117 @@
+#pragma once
+
+/**
+ * @file connection_pool.hpp
+ * @brief Bounded PostgreSQL connection pool with per-thread affinity
+ *
+ * acquire() hands out an exclusive lease. A thread gets back the connection
+ * it used last when that one is idle, so per-connection state (prepared
+ * statements, staging tables) stays warm for the threads that built it.
+ * Connections are opened lazily up to max_size; beyond that acquire()
+ * waits for a lease to be returned.
+ *
+ * Health: a connection that sat idle longer than health_check_after is
+ * probed before it is handed out and replaced if the probe fails. A lease
+ * returned mid-transaction is rolled back; a broken one is dropped.
+ *
+ * The pool must outlive every lease taken from it.
+ */
+
+#include <database/postgres_connection.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+class ConnectionPool {
+    struct Slot {
+        std::unique_ptr<PostgresConnection> conn;
+        bool busy = false;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+public:
+    struct Options {
+        std::string conninfo;                       // Empty: PG* environment variables
+        size_t max_size = 0;                        // 0: hardware threads (at least 4)
+        std::chrono::milliseconds acquire_timeout{30000};
+        std::chrono::seconds health_check_after{30};
+
+        // HARTONOMOUS_POOL_SIZE, HARTONOMOUS_POOL_TIMEOUT_MS
+        static Options from_env();
+    };
+
+    /**
+     * @brief Exclusive, move-only use of one pooled connection
+     */
+    class Lease {
+    public:
+        Lease() = default;
+        ~Lease() { release(); }
+        Lease(Lease&& o) noexcept : pool_(o.pool_), slot_(o.slot_) { o.pool_ = nullptr; o.slot_ = nullptr; }
+        Lease& operator=(Lease&& o) noexcept {
+            if (this != &o) {
+                release();
+                pool_ = o.pool_;
+                slot_ = o.slot_;
+                o.pool_ = nullptr;
+                o.slot_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        PostgresConnection& operator*() const { return *slot_->conn; }
+        PostgresConnection* operator->() const { return slot_->conn.get(); }
+        explicit operator bool() const { return slot_ != nullptr; }
+
+        // Return the connection to the pool early
+        void release() noexcept;
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, Slot* slot) : pool_(pool), slot_(slot) {}
+
+        ConnectionPool* pool_ = nullptr;
+        Slot* slot_ = nullptr;
+    };
+
+    explicit ConnectionPool(Options opts = Options::from_env());
+    explicit ConnectionPool(const std::string& conninfo);
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Check out a connection; throws if none frees up within acquire_timeout
+     */
+    Lease acquire();
+
+    /**
+     * @brief True if a connection can be checked out and answers a probe
+     */
+    bool healthy();
+
+    size_t capacity() const noexcept { return opts_.max_size; }
+    size_t size() const;       // Connections opened (or being opened)
+    size_t in_use() const;     // Leases outstanding
+
+    const std::string& conninfo() const noexcept { return opts_.conninfo; }
+
+private:
+    void give_back(Slot* slot) noexcept;
+    std::unique_ptr<PostgresConnection> open() const;
+    static bool probe(PostgresConnection& conn) noexcept;
+
+    Options opts_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Slot>> slots_;  // Stable addresses; never shrinks
+};
+
+} // namespace Hartonomous
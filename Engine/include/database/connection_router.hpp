@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @file connection_router.hpp
+ * @brief Routes read-only work to streaming replicas and writes to the primary
+ *
+ * The walk, search, query and Voronoi engines only read, so they can run on
+ * hot standbys while ingestion and OODALoop::act keep the primary to
+ * themselves. A reader() is a replica that
+ *
+ *   - answered its last probe,
+ *   - is no further behind than max_lag (pg_last_xact_replay_timestamp, or
+ *     zero while it has replayed everything it received), and
+ *   - has replayed at least the last write noted through note_write(), so a
+ *     caller sees its own ingestion and feedback (read-your-writes).
+ *
+ * With no such replica, or none configured, reader() is the primary. Probes
+ * run on a dedicated connection per replica, at most once per probe_interval,
+ * from whichever call finds them due. epoch() changes whenever the set of
+ * eligible replicas does, so holders of long-lived leases (engine instance
+ * pools) know to rebuild against the new choice.
+ *
+ *   HARTONOMOUS_PRIMARY_DSN        primary conninfo (default: the one passed in, else PG*)
+ *   HARTONOMOUS_REPLICA_DSNS       ';'-separated replica conninfos (default: none)
+ *   HARTONOMOUS_REPLICA_MAX_LAG_MS staleness bound (default 5000)
+ *   HARTONOMOUS_REPLICA_PROBE_MS   probe interval (default 1000)
+ *
+ * Each replica gets its own ConnectionPool sized like the primary's.
+ */
+
+#include <database/connection_pool.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+class ConnectionRouter {
+public:
+    struct Options {
+        std::string primary;                 // Empty: PG* environment variables
+        std::vector<std::string> replicas;
+        std::chrono::milliseconds max_lag{5000};
+        std::chrono::milliseconds probe_interval{1000};
+
+        // HARTONOMOUS_PRIMARY_DSN, HARTONOMOUS_REPLICA_{DSNS,MAX_LAG_MS,PROBE_MS}
+        static Options from_env();
+    };
+
+    struct ReplicaStatus {
+        std::string conninfo;
+        bool reachable = false;
+        uint64_t replay_lsn = 0;
+        double lag_ms = 0.0;
+        bool eligible = false;
+    };
+
+    explicit ConnectionRouter(Options opts = Options::from_env());
+
+    // from_env() with `primary` standing in when HARTONOMOUS_PRIMARY_DSN is unset
+    explicit ConnectionRouter(const std::string& primary);
+
+    ~ConnectionRouter();
+    ConnectionRouter(const ConnectionRouter&) = delete;
+    ConnectionRouter& operator=(const ConnectionRouter&) = delete;
+
+    // Writes, and reads that must see uncommitted work of the caller's session
+    ConnectionPool& primary() noexcept { return primary_; }
+
+    /**
+     * @brief The least busy eligible replica, or the primary
+     *
+     * @param after WAL position (current_lsn) the reader must have replayed,
+     *              on top of the last one noted; 0 for none
+     */
+    ConnectionPool& reader(uint64_t after = 0);
+
+    // pg_current_wal_lsn() as a byte position; call on the primary
+    static uint64_t current_lsn(PostgresConnection& conn);
+
+    // Readers must have replayed `lsn` from now on; keeps the highest seen
+    void note_write(uint64_t lsn) noexcept;
+
+    // note_write(current_lsn()) on a primary connection; a no-op without replicas
+    void note_primary_write();
+
+    // Changes when the eligible replicas do; probes first if they are due
+    uint64_t epoch();
+
+    std::vector<ReplicaStatus> status();
+
+    size_t replica_count() const noexcept { return replicas_.size(); }
+
+private:
+    struct Replica;
+
+    void refresh_if_due();
+    bool eligible(const Replica& r, uint64_t after) const noexcept;
+
+    Options opts_;
+    ConnectionPool primary_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    std::atomic<uint64_t> written_lsn_{0};
+    std::atomic<uint64_t> epoch_{0};
+    uint64_t eligible_mask_ = 0;   // Under probe_mutex_
+    std::mutex probe_mutex_;
+    std::chrono::steady_clock::time_point next_probe_{};
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,196 @@
+#pragma once
+
+/**
+ * @file copy_row.hpp
+ * @brief Field codecs and compile-time row schemas for binary COPY
+ *
+ * Each codec encodes one value as a COPY BINARY field (int32 length + payload)
+ * straight into caller storage with fixed-width big-endian stores. A Schema
+ * binds a column list at compile time, so a row is sized once and encoded
+ * with no intermediate buffer:
+ *
+ *   using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::UInt32>;
+ *   copy.write_row<Row>(id, parent_id, ordinal);
+ *
+ * A codec is any struct with `value_type`, `size(const value_type&)` (bytes
+ * including the length word) and `encode(uint8_t*, const value_type&)`
+ * returning the end pointer; stores define their own for geometry payloads.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace Hartonomous::pgcopy {
+
+inline uint8_t* store_be16(uint8_t* p, uint16_t v) {
+    v = __builtin_bswap16(v);
+    std::memcpy(p, &v, 2);
+    return p + 2;
+}
+
+inline uint8_t* store_be32(uint8_t* p, uint32_t v) {
+    v = __builtin_bswap32(v);
+    std::memcpy(p, &v, 4);
+    return p + 4;
+}
+
+inline uint8_t* store_be64(uint8_t* p, uint64_t v) {
+    v = __builtin_bswap64(v);
+    std::memcpy(p, &v, 8);
+    return p + 8;
+}
+
+inline uint8_t* store_le32(uint8_t* p, uint32_t v) {
+    if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) v = __builtin_bswap32(v);
+    std::memcpy(p, &v, 4);
+    return p + 4;
+}
+
+inline uint8_t* store_le_double(uint8_t* p, double d) {
+    uint64_t v;
+    std::memcpy(&v, &d, 8);
+    if constexpr (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) v = __builtin_bswap64(v);
+    std::memcpy(p, &v, 8);
+    return p + 8;
+}
+
+// Fixed-width field: length word + N payload bytes
+template <size_t N>
+struct FixedField {
+    static constexpr size_t payload = N;
+    static constexpr size_t encoded = 4 + N;
+};
+
+struct Uuid : FixedField<16> {
+    using value_type = std::array<uint8_t, 16>;
+    static constexpr size_t size(const value_type&) { return encoded; }
+    static uint8_t* encode(uint8_t* p, const value_type& v) {
+        p = store_be32(p, 16);
+        std::memcpy(p, v.data(), 16);
+        return p + 16;
+    }
+};
+
+struct Int32 : FixedField<4> {
+    using value_type = int32_t;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) {
+        return store_be32(store_be32(p, 4), static_cast<uint32_t>(v));
+    }
+};
+
+struct Int64 : FixedField<8> {
+    using value_type = int64_t;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) {
+        return store_be64(store_be32(p, 8), static_cast<uint64_t>(v));
+    }
+};
+
+struct Float8 : FixedField<8> {
+    using value_type = double;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) {
+        uint64_t raw;
+        std::memcpy(&raw, &v, 8);
+        return store_be64(store_be32(p, 8), raw);
+    }
+};
+
+struct Bool : FixedField<1> {
+    using value_type = bool;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) {
+        p = store_be32(p, 1);
+        *p = v ? 1 : 0;
+        return p + 1;
+    }
+};
+
+// uint16/uint32/uint64 bytea domains: raw big-endian bytes (also the binary form
+// of the extension's native uint64 type)
+struct UInt16 : FixedField<2> {
+    using value_type = uint16_t;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) { return store_be16(store_be32(p, 2), v); }
+};
+
+struct UInt32 : FixedField<4> {
+    using value_type = uint32_t;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) { return store_be32(store_be32(p, 4), v); }
+};
+
+struct UInt64 : FixedField<8> {
+    using value_type = uint64_t;
+    static constexpr size_t size(value_type) { return encoded; }
+    static uint8_t* encode(uint8_t* p, value_type v) { return store_be64(store_be32(p, 8), v); }
+};
+
+struct Bytes {
+    using value_type = std::span<const uint8_t>;
+    static size_t size(const value_type& v) { return 4 + v.size(); }
+    static uint8_t* encode(uint8_t* p, const value_type& v) {
+        p = store_be32(p, static_cast<uint32_t>(v.size()));
+        if (!v.empty()) std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    }
+};
+
+struct Text {
+    using value_type = std::string_view;
+    static size_t size(const value_type& v) { return 4 + v.size(); }
+    static uint8_t* encode(uint8_t* p, const value_type& v) {
+        p = store_be32(p, static_cast<uint32_t>(v.size()));
+        if (!v.empty()) std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    }
+};
+
+// int4[]: one dimension, no NULL elements, lower bound 1; an empty span is SQL NULL
+struct Int4Array {
+    using value_type = std::span<const int32_t>;
+    static constexpr uint32_t INT4_OID = 23;
+    static size_t size(const value_type& v) { return v.empty() ? 4 : 4 + 20 + 8 * v.size(); }
+    static uint8_t* encode(uint8_t* p, const value_type& v) {
+        if (v.empty()) return store_be32(p, 0xFFFFFFFFu);
+        p = store_be32(p, static_cast<uint32_t>(20 + 8 * v.size()));
+        p = store_be32(p, 1);          // ndim
+        p = store_be32(p, 0);          // no NULL elements
+        p = store_be32(p, INT4_OID);
+        p = store_be32(p, static_cast<uint32_t>(v.size()));
+        p = store_be32(p, 1);          // lower bound
+        for (int32_t x : v) p = store_be32(store_be32(p, 4), static_cast<uint32_t>(x));
+        return p;
+    }
+};
+
+struct Null {
+    using value_type = std::nullptr_t;
+    static constexpr size_t size(value_type) { return 4; }
+    static uint8_t* encode(uint8_t* p, value_type) { return store_be32(p, 0xFFFFFFFFu); }
+};
+
+/**
+ * @brief Compile-time column list; encodes a whole tuple (field count + fields).
+ */
+template <typename... Fields>
+struct Schema {
+    static constexpr int16_t field_count = static_cast<int16_t>(sizeof...(Fields));
+
+    static constexpr size_t size(const typename Fields::value_type&... values) {
+        return (size_t{2} + ... + Fields::size(values));
+    }
+
+    static uint8_t* encode(uint8_t* p, const typename Fields::value_type&... values) {
+        p = store_be16(p, static_cast<uint16_t>(field_count));
+        ((p = Fields::encode(p, values)), ...);
+        return p;
+    }
+};
+
+} // namespace Hartonomous::pgcopy
@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * @file pg_event_loop.hpp
+ * @brief C++20 coroutine tasks and a socket-readiness loop for non-blocking libpq
+ *
+ * A blocking PostgresConnection call holds its thread for the whole round
+ * trip. PostgresConnection::query_async and execute_prepared_async instead
+ * return a PgTask: the query is sent with PQsendQuery*, and whenever libpq
+ * would block the coroutine suspends on loop.readable(fd) / writable(fd)
+ * until a PgEventLoop thread sees the socket ready and resumes it. A few
+ * loop threads therefore multiplex as many in-flight queries as there are
+ * connections (one statement per connection at a time; take them from a
+ * ConnectionPool).
+ *
+ * Usage:
+ *   PgEventLoop loop(2);
+ *   PgTask<int> count(PostgresConnection& db, PgEventLoop& loop) {
+ *       PgResult r = co_await db.query_async(loop, "SELECT count(*) FROM ...");
+ *       co_return std::stoi(std::string(r[0].get_text(0)));
+ *   }
+ *   std::future<int> f = loop.spawn(count(db, loop));
+ *
+ * Tasks are lazy: nothing runs until the task is awaited or spawned.
+ * Awaiting resumes the caller on whichever thread finished the callee,
+ * normally a loop thread, so keep CPU-heavy work out of the coroutine or
+ * hand it back with co_await loop.schedule(). The loop must outlive every
+ * task using it. Linux only (epoll); elsewhere the constructor throws.
+ */
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Hartonomous {
+
+template <typename T = void>
+class PgTask;
+
+namespace detail {
+
+struct PgPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Symmetric transfer back to the awaiter, so deep await chains do not grow the stack
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct PgPromise : PgPromiseBase {
+    std::variant<std::monostate, T> value;
+
+    PgTask<T> get_return_object() noexcept;
+    template <typename U>
+    void return_value(U&& v) { value.template emplace<1>(std::forward<U>(v)); }
+
+    T take() {
+        if (error) std::rethrow_exception(error);
+        return std::move(std::get<1>(value));
+    }
+};
+
+template <>
+struct PgPromise<void> : PgPromiseBase {
+    PgTask<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void take() { if (error) std::rethrow_exception(error); }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazy, move-only coroutine result; co_await it or PgEventLoop::spawn() it
+ */
+template <typename T>
+class [[nodiscard]] PgTask {
+public:
+    using promise_type = detail::PgPromise<T>;
+
+    PgTask(PgTask&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    PgTask& operator=(PgTask&& o) noexcept {
+        if (this != &o) { if (h_) h_.destroy(); h_ = std::exchange(o.h_, {}); }
+        return *this;
+    }
+    PgTask(const PgTask&) = delete;
+    PgTask& operator=(const PgTask&) = delete;
+    ~PgTask() { if (h_) h_.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        h_.promise().continuation = awaiter;
+        return h_;
+    }
+    T await_resume() { return h_.promise().take(); }
+
+private:
+    friend promise_type;
+    explicit PgTask(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+
+    std::coroutine_handle<promise_type> h_;
+};
+
+namespace detail {
+template <typename T>
+inline PgTask<T> PgPromise<T>::get_return_object() noexcept {
+    return PgTask<T>(std::coroutine_handle<PgPromise<T>>::from_promise(*this));
+}
+inline PgTask<void> PgPromise<void>::get_return_object() noexcept {
+    return PgTask<void>(std::coroutine_handle<PgPromise<void>>::from_promise(*this));
+}
+} // namespace detail
+
+class PgEventLoop {
+    struct Worker;
+
+public:
+    // 0: one thread
+    explicit PgEventLoop(size_t threads = 1);
+    ~PgEventLoop();
+
+    PgEventLoop(const PgEventLoop&) = delete;
+    PgEventLoop& operator=(const PgEventLoop&) = delete;
+
+    size_t threads() const noexcept { return workers_.size(); }
+
+    /**
+     * @brief Suspend until `fd` is ready; resumes on the loop thread that owns the fd
+     *
+     * One waiter per fd at a time. Readiness includes errors and hangups, so
+     * the caller learns of a dropped socket from the read or write it retries.
+     */
+    class FdAwaiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+
+    private:
+        friend class PgEventLoop;
+        FdAwaiter(Worker& w, int fd, uint32_t events) noexcept : worker_(w), fd_(fd), events_(events) {}
+
+        Worker& worker_;
+        int fd_;
+        uint32_t events_;
+        std::coroutine_handle<> handle_;
+    };
+
+    FdAwaiter readable(int fd) { return {worker_for(fd), fd, EV_IN}; }
+    FdAwaiter writable(int fd) { return {worker_for(fd), fd, EV_OUT}; }
+    FdAwaiter readable_or_writable(int fd) { return {worker_for(fd), fd, EV_IN | EV_OUT}; }
+
+    /**
+     * @brief Continue the awaiting coroutine on a loop thread
+     */
+    class ScheduleAwaiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { loop_.post(h); }
+        void await_resume() const noexcept {}
+
+    private:
+        friend class PgEventLoop;
+        explicit ScheduleAwaiter(PgEventLoop& loop) noexcept : loop_(loop) {}
+        PgEventLoop& loop_;
+    };
+    ScheduleAwaiter schedule() noexcept { return ScheduleAwaiter(*this); }
+
+    /**
+     * @brief Start `task` on a loop thread; the future carries its result or exception
+     */
+    template <typename T>
+    std::future<T> spawn(PgTask<T> task) {
+        std::promise<T> done;
+        std::future<T> result = done.get_future();
+        post(run(std::move(task), std::move(done)).handle);
+        return result;
+    }
+
+    // Run `task` on the loop and wait for it on the calling thread
+    template <typename T>
+    T block_on(PgTask<T> task) { return spawn(std::move(task)).get(); }
+
+    // Coroutines suspended in the loop right now, across all threads
+    size_t waiting() const noexcept { return waiting_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t EV_IN = 1u;
+    static constexpr uint32_t EV_OUT = 2u;
+
+    // Fire-and-forget frame that owns a spawned task; destroys itself at the end
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() noexcept {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+        std::coroutine_handle<> handle;
+    };
+
+    template <typename T>
+    static Detached run(PgTask<T> task, std::promise<T> done) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+                done.set_value();
+            } else {
+                done.set_value(co_await std::move(task));
+            }
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    }
+
+    Worker& worker_for(int fd) noexcept { return *workers_[static_cast<size_t>(fd) % workers_.size()]; }
+    void post(std::coroutine_handle<> h);
+    void shutdown() noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_post_{0};
+    std::atomic<size_t> waiting_{0};
+};
+
+} // namespace Hartonomous
@@ -5,15 +5,184 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <optional>
 #include <functional>
+#include <unordered_set>
 #include <libpq-fe.h>
+#include <database/pg_event_loop.hpp>
 
 namespace Hartonomous {
 
+/**
+ * @brief Built-in type OIDs used for binary parameters and results
+ */
+namespace PgType {
+    inline constexpr Oid Bool   = 16;
+    inline constexpr Oid Bytea  = 17;
+    inline constexpr Oid Int8   = 20;
+    inline constexpr Oid Int4   = 23;
+    inline constexpr Oid Text   = 25;
+    inline constexpr Oid Float8 = 701;
+    inline constexpr Oid Uuid   = 2950;
+    inline constexpr Oid UuidArray = 2951;
+}
+
+/**
+ * @brief One binary-format query parameter
+ *
+ * Fixed-width values are stored inline in network byte order; text and
+ * bytes reference caller memory, which must outlive the query call.
+ */
+class PgParam {
+public:
+    static PgParam uuid(const std::array<uint8_t, 16>& v) {
+        PgParam p;
+        std::memcpy(p.inline_, v.data(), 16);
+        p.len_ = 16;
+        return p;
+    }
+    static PgParam int4(int32_t v) { return fixed(__builtin_bswap32(static_cast<uint32_t>(v))); }
+    static PgParam int8(int64_t v) { return fixed(__builtin_bswap64(static_cast<uint64_t>(v))); }
+    static PgParam float8(double v) {
+        uint64_t raw;
+        std::memcpy(&raw, &v, 8);
+        return fixed(__builtin_bswap64(raw));
+    }
+    static PgParam text(std::string_view v) { return external(v.data(), v.size()); }
+    static PgParam bytes(const void* data, size_t len) { return external(data, len); }
+    static PgParam null() { PgParam p; p.len_ = -1; return p; }
+
+    const char* data() const { return len_ < 0 ? nullptr : (ext_ ? ext_ : reinterpret_cast<const char*>(inline_)); }
+    int length() const { return len_ < 0 ? 0 : len_; }
+
+private:
+    template <typename T>
+    static PgParam fixed(T be) {
+        PgParam p;
+        std::memcpy(p.inline_, &be, sizeof(T));
+        p.len_ = sizeof(T);
+        return p;
+    }
+    static PgParam external(const void* data, size_t len) {
+        PgParam p;
+        p.ext_ = static_cast<const char*>(data);
+        p.len_ = static_cast<int>(len);
+        if (!p.ext_) p.ext_ = "";
+        return p;
+    }
+
+    uint8_t inline_[16] = {};
+    const char* ext_ = nullptr;
+    int len_ = 0;
+};
+
+/**
+ * @brief Binary uuid[] (one dimension, no nulls) for a PgParam::bytes
+ * parameter of type PgType::UuidArray
+ */
+inline std::string pg_uuid_array(std::span<const std::array<uint8_t, 16>> ids) {
+    auto be32 = [](std::string& out, uint32_t v) {
+        v = __builtin_bswap32(v);
+        out.append(reinterpret_cast<const char*>(&v), 4);
+    };
+    std::string out;
+    out.reserve(20 + ids.size() * 20);
+    be32(out, 1);                                   // ndim
+    be32(out, 0);                                   // no nulls
+    be32(out, PgType::Uuid);
+    be32(out, static_cast<uint32_t>(ids.size()));
+    be32(out, 1);                                   // lower bound
+    for (const auto& id : ids) {
+        be32(out, 16);
+        out.append(reinterpret_cast<const char*>(id.data()), 16);
+    }
+    return out;
+}
+
+/**
+ * @brief Owning binary-format result with typed, allocation-free row access
+ */
+class PgResult {
+public:
+    class Row {
+    public:
+        bool is_null(int col) const { return PQgetisnull(res_, row_, col) != 0; }
+
+        std::array<uint8_t, 16> get_uuid(int col) const {
+            std::array<uint8_t, 16> out;
+            std::memcpy(out.data(), field(col, 16), 16);
+            return out;
+        }
+        double get_float8(int col) const {
+            uint64_t raw = __builtin_bswap64(load<uint64_t>(field(col, 8)));
+            double v;
+            std::memcpy(&v, &raw, 8);
+            return v;
+        }
+        int64_t get_int8(int col) const {
+            return static_cast<int64_t>(__builtin_bswap64(load<uint64_t>(field(col, 8))));
+        }
+        int32_t get_int4(int col) const {
+            return static_cast<int32_t>(__builtin_bswap32(load<uint32_t>(field(col, 4))));
+        }
+        bool get_bool(int col) const { return *field(col, 1) != 0; }
+        std::string_view get_text(int col) const {
+            return {PQgetvalue(res_, row_, col), static_cast<size_t>(PQgetlength(res_, row_, col))};
+        }
+        std::span<const uint8_t> get_bytes(int col) const {
+            return {reinterpret_cast<const uint8_t*>(PQgetvalue(res_, row_, col)),
+                    static_cast<size_t>(PQgetlength(res_, row_, col))};
+        }
+
+    private:
+        friend class PgResult;
+        Row(const PGresult* res, int row) : res_(res), row_(row) {}
+
+        const char* field(int col, int expected_len) const {
+            if (PQgetlength(res_, row_, col) != expected_len) {
+                throw std::runtime_error(PQgetisnull(res_, row_, col)
+                    ? "Unexpected NULL in binary result column " + std::to_string(col)
+                    : "Binary result column " + std::to_string(col) + " has unexpected width");
+            }
+            return PQgetvalue(res_, row_, col);
+        }
+        template <typename T>
+        static T load(const char* p) { T v; std::memcpy(&v, p, sizeof(T)); return v; }
+
+        const PGresult* res_;
+        int row_;
+    };
+
+    explicit PgResult(PGresult* res) noexcept : res_(res) {}
+    ~PgResult() { if (res_) PQclear(res_); }
+    PgResult(PgResult&& o) noexcept : res_(o.res_) { o.res_ = nullptr; }
+    PgResult& operator=(PgResult&& o) noexcept {
+        if (this != &o) { if (res_) PQclear(res_); res_ = o.res_; o.res_ = nullptr; }
+        return *this;
+    }
+    PgResult(const PgResult&) = delete;
+    PgResult& operator=(const PgResult&) = delete;
+
+    int size() const { return res_ ? PQntuples(res_) : 0; }
+    int columns() const { return res_ ? PQnfields(res_) : 0; }
+    bool empty() const { return size() == 0; }
+    Row operator[](int row) const { return Row(res_, row); }
+
+private:
+    PGresult* res_;
+};
+
 /**
  * @brief PostgreSQL connection wrapper
  *
@@ -49,6 +218,30 @@ public:
      */
     bool is_connected() const;
 
+    /**
+     * @brief True inside an open (or aborted) transaction block
+     */
+    bool in_transaction() const;
+
+    /**
+     * @brief Ask the server to abort the statement in flight
+     *
+     * Safe to call from another thread while this connection is busy (never
+     * concurrently with its destruction). The interrupted call throws as a
+     * failed query; the connection stays usable. False if the request could
+     * not be sent; true does not guarantee anything was running.
+     */
+    bool cancel();
+
+    /**
+     * @brief Statements sent by every connection in the process, and by this thread
+     *
+     * Pipelined statements count one each; COPY data does not. Load
+     * benchmarks read these before and after a request.
+     */
+    static uint64_t queries_sent() noexcept;
+    static uint64_t thread_queries_sent() noexcept;
+
     /**
      * @brief Execute query (no results expected)
      */
@@ -87,6 +280,109 @@ public:
      */
     void stream_query(const std::string& sql, std::function<void(const std::vector<std::string>&)> callback);
 
+    /**
+     * @brief Run a COPY ... TO STDOUT and hand each CopyData message to callback
+     *
+     * With FORMAT binary this skips result text conversion entirely; the
+     * callback receives the raw message bytes (valid only during the call).
+     */
+    void copy_out(const std::string& sql, std::function<void(const char*, int)> callback);
+
+    /**
+     * @brief Server-side prepared statement handle, valid on the connection that prepared it
+     */
+    struct PreparedStatement {
+        std::string name;
+        int param_count = 0;
+        std::string sql;        // As prepared, for QueryTrace
+    };
+
+    /**
+     * @brief Prepare `sql` under `name` once per connection
+     *
+     * Later calls with the same name return the cached handle without a
+     * round trip, so hot paths can call this on every use. param_types are
+     * PgType OIDs; parameters are always sent in binary format.
+     */
+    const PreparedStatement& prepare(const std::string& name, const std::string& sql,
+                                     std::initializer_list<Oid> param_types = {});
+
+    /**
+     * @brief Execute a prepared statement, returning binary-format results
+     *
+     * Read columns with PgResult::Row's typed getters (uuid, float8, int8, ...)
+     * instead of parsing text. Column types must match the getters used;
+     * cast in SQL where needed.
+     */
+    PgResult execute_prepared(const PreparedStatement& stmt, std::span<const PgParam> params);
+    PgResult execute_prepared(const PreparedStatement& stmt, std::initializer_list<PgParam> params) {
+        return execute_prepared(stmt, std::span<const PgParam>(params.begin(), params.size()));
+    }
+
+    /**
+     * @brief Run a query without blocking the thread; see pg_event_loop.hpp
+     *
+     * Sends with PQsendQueryParams on a non-blocking socket and suspends on
+     * `loop` whenever libpq would wait for the server. The result is text
+     * format (Row::get_text), as query() returns. The connection stays in
+     * non-blocking mode until the statement completes and must not be used
+     * by anything else meanwhile; run concurrent statements on separate
+     * connections.
+     */
+    PgTask<PgResult> query_async(PgEventLoop& loop, std::string sql, std::vector<std::string> params = {});
+
+    /**
+     * @brief execute_prepared() without blocking the thread
+     *
+     * `stmt` must already be prepared on this connection (prepare() is
+     * cached, so call it once up front). Text and bytes parameters reference
+     * caller memory, which must stay alive until the task completes.
+     */
+    PgTask<PgResult> execute_prepared_async(PgEventLoop& loop, const PreparedStatement& stmt,
+                                            std::vector<PgParam> params);
+
+    /**
+     * @brief Batch independent queries into one round trip (libpq pipeline mode)
+     *
+     * Usage:
+     *   PostgresConnection::Pipeline pipe(db);
+     *   for (...) pipe.send(sql, {param});
+     *   auto results = pipe.sync();      // results[i] belongs to send #i
+     *
+     * send() only queues the query; sync() flushes them all and collects the
+     * results in order. If any query fails, the rest of the batch is aborted
+     * by the server and sync() throws the first error. Text-SQL sends return
+     * text-format results (read with Row::get_text); prepared sends return
+     * binary results for the typed getters. Ordinary calls on the connection
+     * are not allowed while a Pipeline is alive.
+     */
+    class Pipeline {
+    public:
+        explicit Pipeline(PostgresConnection& conn);
+        ~Pipeline();
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        size_t send(const std::string& sql, const std::vector<std::string>& params = {});
+        size_t send(const PreparedStatement& stmt, std::span<const PgParam> params);
+        size_t send(const PreparedStatement& stmt, std::initializer_list<PgParam> params) {
+            return send(stmt, std::span<const PgParam>(params.begin(), params.size()));
+        }
+
+        std::vector<PgResult> sync();
+
+    private:
+        // Bound queued queries so neither side's socket buffer can fill and deadlock
+        static constexpr size_t MAX_IN_FLIGHT = 256;
+        void after_send(int ok);
+        void collect();
+
+        PostgresConnection& conn_;
+        size_t in_flight_ = 0;
+        std::vector<PgResult> results_;
+        std::string error_;
+    };
+
     /**
      * @brief Send data for COPY command
      * 
@@ -102,6 +398,32 @@ public:
      */
     void copy_end(const char* error_msg = nullptr);
 
+    /**
+     * @brief Switch the socket between blocking and non-blocking output
+     *
+     * Only the COPY-in path is non-blocking aware; restore blocking mode
+     * before issuing ordinary queries.
+     */
+    void set_nonblocking(bool on);
+    bool is_nonblocking() const;
+
+    /**
+     * @brief Queue COPY data and return without waiting for the socket
+     *
+     * Requires non-blocking mode. libpq copies the bytes into its output
+     * buffer, so the caller may reuse its buffer immediately. Output still
+     * pending from the previous call is drained first, which bounds client
+     * memory to one queued buffer while the next is being filled.
+     *
+     * @return true if part of the data is still queued in libpq
+     */
+    bool copy_data_async(const char* buffer, int nbytes);
+
+    /**
+     * @brief Block until all queued output has been handed to the kernel
+     */
+    void drain_output();
+
     /**
      * @brief Begin transaction
      */
@@ -139,13 +461,35 @@ public:
      */
     std::string last_error() const;
 
+    /**
+     * @brief Connection string this connection was opened with
+     *
+     * Lets callers open sibling connections (parallel loaders, workers) to the same database.
+     */
+    const std::string& conninfo() const { return conninfo_; }
+
+    /**
+     * @brief Session-scoped staging tables known to exist on this connection
+     *
+     * BulkCopy creates one staging table per target and reuses it for the
+     * life of the session. rollback() forgets them, since a table created
+     * inside the aborted transaction no longer exists.
+     */
+    bool has_staging_table(const std::string& name) const { return staging_tables_.count(name) != 0; }
+    void add_staging_table(const std::string& name) { staging_tables_.insert(name); }
+
 private:
     void connect(const std::string& conninfo);
     void disconnect();
     void check_result(PGresult* result);
+    PgTask<PgResult> finish_async(PgEventLoop& loop, std::string_view sql, bool sent);
 
     PGconn* conn_ = nullptr;
+    PGcancel* cancel_ = nullptr;
+    std::string conninfo_;
     std::string last_error_;
+    std::unordered_set<std::string> staging_tables_;
+    std::unordered_map<std::string, PreparedStatement> prepared_;
 };
 
 } // namespace Hartonomous
@@ -0,0 +1,111 @@
+/**
+ * @file query_trace.hpp
+ * @brief Per-statement aggregates of every PostgresConnection round trip
+ *
+ * Statements are grouped by fingerprint: the SQL with string and numeric
+ * literals replaced by ? and whitespace collapsed, so the same lookup
+ * issued for a thousand IDs is one line with a thousand calls. That is
+ * what an N+1 pattern looks like here. Each fingerprint accumulates calls,
+ * server time (send to result, excluding the caller's row handling), rows
+ * and result bytes, and appears in the metrics surface as the
+ * hartonomous_db_statement_* counters labeled with the fingerprint and its
+ * normalized text.
+ *
+ * Streamed statements (stream_query, copy_out) count rows and bytes as
+ * they arrive and time the whole stream, callbacks included. Pipelined
+ * sends count calls only, since their wait is shared by the batch.
+ *
+ * HARTONOMOUS_SLOW_QUERY_MS (default 0: off) logs every statement slower
+ * than the threshold to stderr, with its rows and the original SQL. Built
+ * with HARTONOMOUS_NO_METRICS, Scope records nothing.
+ */
+
+#pragma once
+
+#include <utils/metrics.hpp>
+#include <libpq-fe.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Hartonomous {
+
+class QueryTrace {
+public:
+    struct Statement {
+        uint64_t fingerprint = 0;
+        std::string sql;            // Normalized
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+    };
+
+    static QueryTrace& global();
+
+    // Literals as ?, whitespace runs as one space; $n placeholders and identifiers kept
+    static std::string normalize(std::string_view sql);
+
+    // 16 hex digits, as in the metric labels and the slow-query log
+    static std::string fingerprint_hex(uint64_t fingerprint);
+
+    void record(std::string_view sql, uint64_t ns, uint64_t rows, uint64_t bytes);
+
+    // Heaviest statements by total server time
+    std::vector<Statement> top(size_t limit) const;
+
+    void reset();
+
+    double slow_query_ms() const noexcept { return slow_ms_; }
+
+    /**
+     * @brief Times one statement from construction; recorded on destruction
+     *
+     * done() stops the clock and takes rows and size from the result;
+     * add_row() accumulates them for streamed statements. A statement that
+     * throws is still recorded, with what it returned so far.
+     */
+    class Scope {
+    public:
+        explicit Scope(std::string_view sql) noexcept : sql_(sql), t0_(std::chrono::steady_clock::now()) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+        void done(const PGresult* result) noexcept;
+        void add_row(uint64_t bytes) noexcept { ++rows_; bytes_ += bytes; }
+
+    private:
+        std::string_view sql_;
+        std::chrono::steady_clock::time_point t0_, t1_{};
+        uint64_t rows_ = 0, bytes_ = 0;
+    };
+
+private:
+    QueryTrace();
+
+    struct Entry {
+        Statement stats;
+        Metrics::Counter* calls;
+        Metrics::Counter* micros;
+        Metrics::Counter* rows;
+        Metrics::Counter* bytes;
+    };
+
+    static constexpr size_t SHARDS = 16;
+    struct Shard {
+        mutable std::mutex mu;
+        std::unordered_map<uint64_t, Entry> entries;
+    };
+
+    std::array<Shard, SHARDS> shards_;
+    double slow_ms_ = 0.0;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,212 @@
+#pragma once
+
+/**
+ * @file substrate_snapshot.hpp
+ * @brief Native binary snapshots of the substrate tables, for moving them between databases
+ *
+ * pg_dump writes PostGIS geometry and the bytea domains as text and parses
+ * them back on restore. A snapshot instead keeps each field in PostgreSQL's
+ * binary send format, exactly as binary COPY carries it:
+ *
+ *   write()  one COPY ... TO STDOUT (FORMAT binary) per table, or per leaf
+ *            partition of a partitioned table, from up to `jobs` pooled
+ *            connections at once. Rows are cut into blocks of `block_rows`
+ *            and each block is stored column by column, every column
+ *            run-length encoded (repeated values such as tenant ids, type
+ *            codes, NULLs and default ratings collapse to one run).
+ *   load()   the reverse with binary COPY ... FROM STDIN on as many
+ *            connections, FK triggers off, inside a deferred-maintenance
+ *            window (database/bulk_load_session.hpp): indexes and CHECKs
+ *            are rebuilt in parallel once every block is in. Tables that
+ *            already hold rows are merged through ON CONFLICT DO NOTHING.
+ *   open()   map a snapshot read-only (huge pages per HARTONOMOUS_HUGEPAGES)
+ *            and scan() its columns in place, which is how the in-memory
+ *            engines build from a snapshot without a database
+ *            (RelationGraph::from_snapshot).
+ *
+ * Layout: a 64-byte header, 64-byte-aligned blocks, then the directory of
+ * tables (columns with their types, row counts, block offsets). The header
+ * carries a BLAKE3 checksum of the directory and each block one of its body,
+ * checked whenever the block is decoded.
+ *
+ *   HARTONOMOUS_SNAPSHOT_JOBS=N        concurrent COPY streams (default: cores / 2, at least 1)
+ *   HARTONOMOUS_SNAPSHOT_BLOCK_ROWS=N  rows per block (default 65536)
+ */
+
+#include <database/connection_pool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+class SubstrateSnapshot {
+public:
+    struct Options {
+        std::vector<std::string> tables;   // Under hartonomous; empty: default_tables()
+        size_t jobs = 0;                   // 0: hardware threads / 2
+        size_t block_rows = 65536;
+
+        /**
+         * @brief Defaults overridden by HARTONOMOUS_SNAPSHOT_{JOBS,BLOCK_ROWS}
+         */
+        static Options from_env();
+    };
+
+    struct Column {
+        std::string name;
+        std::string type;   // format_type() at export, for display and checks
+    };
+
+    struct Table {
+        std::string name;
+        std::vector<Column> columns;
+        uint64_t rows = 0;
+        std::vector<uint64_t> blocks;   // File offsets
+
+        // Position of `column` in columns, or -1
+        int column_index(const std::string& column) const;
+    };
+
+    // One field of a scanned row, pointing into the mapped file
+    struct Field {
+        const uint8_t* data = nullptr;   // nullptr: SQL NULL
+        uint32_t size = 0;
+
+        bool is_null() const noexcept { return data == nullptr; }
+        std::span<const uint8_t> bytes() const noexcept { return {data, size}; }
+    };
+
+    /**
+     * @brief Builds a snapshot file from binary COPY streams; what write() runs over
+     *
+     * Declare the tables, then feed each stream's CopyData messages to its
+     * own Stream, from any thread. Blocks go to the file as they fill; commit()
+     * writes the directory and header and moves the file into place.
+     */
+    class Writer {
+    public:
+        class Stream {
+        public:
+            // Tuples of one message; the COPY header and trailer are skipped
+            void add_message(const char* buf, size_t len);
+            // Write the last partial block
+            void finish();
+
+        private:
+            friend class Writer;
+            Stream(Writer& writer, size_t table, size_t block_rows);
+            void write_block();
+
+            struct ColumnEncoder {
+                std::vector<uint8_t> out;
+                std::vector<uint8_t> last;
+                bool last_null = false;
+                uint64_t run = 0;
+
+                void add(const uint8_t* data, int32_t len);   // len < 0: NULL
+                void end_run();
+            };
+
+            Writer& writer_;
+            size_t table_;
+            size_t block_rows_;
+            size_t rows_ = 0;
+            std::vector<ColumnEncoder> columns_;
+        };
+
+        explicit Writer(const std::string& path);
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Index of a new table; call before any stream of it starts
+        size_t add_table(std::string name, std::vector<Column> columns);
+        Stream stream(size_t table, size_t block_rows = 65536) { return Stream(*this, table, block_rows); }
+
+        // Rows written so far
+        uint64_t rows() const;
+
+        void commit();
+
+    private:
+        void append_block(size_t table, uint32_t rows, std::span<const Stream::ColumnEncoder> columns);
+
+        std::string path_;
+        int fd_ = -1;
+        mutable std::mutex mu_;
+        uint64_t end_ = 0;   // Next block offset
+        std::vector<Table> tables_;
+        bool committed_ = false;
+    };
+
+    // Atoms, physicality, compositions with their sequences, relations with theirs, ratings
+    static const std::vector<std::string>& default_tables();
+
+    /**
+     * @brief Export the tables of `opts` from the pool's database to `path`
+     *
+     * Written to `path`.tmp and renamed once complete; returns the rows written.
+     */
+    static uint64_t write(ConnectionPool& pool, const std::string& path, const Options& opts = Options::from_env());
+
+    /**
+     * @brief Import every table of the snapshot at `path` into the pool's database
+     *
+     * Throws on a corrupt block before or while it is sent; rows already
+     * committed stay. Returns the rows sent.
+     */
+    static uint64_t load(ConnectionPool& pool, const std::string& path, const Options& opts = Options::from_env());
+
+    /**
+     * @brief Map a snapshot; throws if it is missing or its header or directory is corrupt
+     */
+    static std::unique_ptr<const SubstrateSnapshot> open(const std::string& path);
+
+    ~SubstrateSnapshot();
+    SubstrateSnapshot(const SubstrateSnapshot&) = delete;
+    SubstrateSnapshot& operator=(const SubstrateSnapshot&) = delete;
+
+    const std::vector<Table>& tables() const noexcept { return tables_; }
+
+    // nullptr when the snapshot does not hold `name`
+    const Table* table(const std::string& name) const;
+
+    // Hex of the directory checksum: identifies the snapshot's contents
+    const std::string& id() const noexcept { return id_; }
+
+    size_t file_bytes() const noexcept { return size_; }
+
+    /**
+     * @brief Call fn with the requested columns of every row of `table`, block by block
+     *
+     * Fields point into the mapping and stay valid while the snapshot lives.
+     * Throws if the table or a column is missing, or a block is corrupt.
+     */
+    void scan(const std::string& table, const std::vector<std::string>& columns,
+              const std::function<void(std::span<const Field>)>& fn) const;
+
+    /**
+     * @brief Decode block `block` of `table` into one Field array per column
+     *
+     * columns[c][r] is row r of column c. Returns the block's row count.
+     */
+    size_t decode_block(const Table& table, size_t block, std::vector<std::vector<Field>>& columns) const;
+
+private:
+    SubstrateSnapshot() = default;
+
+    std::vector<Table> tables_;
+    std::string id_;
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    void* map_addr_ = nullptr;
+    size_t map_size_ = 0;
+};
+
+} // namespace Hartonomous
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "geometry/s3_batch.hpp"
 #include <Eigen/Core>
 #include <complex>
 #include <cmath>
@@ -106,6 +107,30 @@ public:
         return Vec4(z1.real(), z1.imag(), z2.real(), z2.imag());
     }
 
+    /**
+     * @brief forward() over column (SoA) coordinates
+     *
+     * Same arithmetic as forward(), vectorized (s3::hopf_forward_many).
+     */
+    static void forward_batch(const double* x, const double* y, const double* z, const double* w, size_t n,
+                              double* s2_x, double* s2_y, double* s2_z) {
+        s3::hopf_forward_many(x, y, z, w, n, s2_x, s2_y, s2_z);
+    }
+
+    /**
+     * @brief inverse() over column (SoA) coordinates
+     *
+     * Vectorized, with a polynomial sincos: matches inverse() to ~1e-15, not
+     * bit for bit, so use it for display, not for positions that get hashed.
+     *
+     * @param fiber_angle One angle per point, or nullptr for 0
+     */
+    static void inverse_batch(const double* s2_x, const double* s2_y, const double* s2_z,
+                              const double* fiber_angle, size_t n,
+                              double* x, double* y, double* z, double* w) {
+        s3::hopf_inverse_many(s2_x, s2_y, s2_z, fiber_angle, n, x, y, z, w);
+    }
+
     /**
      * @brief Normalize a 4D vector to lie on S³
      *
@@ -0,0 +1,64 @@
+#pragma once
+/**
+ * @file s3_batch.hpp
+ * @brief Batch S³ kernels over column (SoA) coordinates
+ *
+ * Neighborhood scans, Monte Carlo cells and per-composition centroids reduce
+ * to the same few loops over many points: dot products against one query,
+ * geodesic distances, renormalization and grouped sums. These run them over
+ * separate x/y/z/w columns in double or float, with the SIMD path (SSE4.1,
+ * AVX2+FMA, AVX-512) picked from simd_level() (utils/cpu_dispatch.hpp)
+ * rather than from the build machine, so a portable build still gets the
+ * wide kernels.
+ *
+ * geodesic_many uses a polynomial acos (Abramowitz & Stegun 4.4.46,
+ * |error| <= 2e-8 rad, plus float rounding on the float path); use
+ * geodesic_distance where a reported distance must match std::acos.
+ * centroid_sums only adds, so every path returns the same bits as the
+ * scalar loop and centroids hashed into physicality IDs never change.
+ *
+ * hopf_inverse_many uses a polynomial sincos and no atan2, so it agrees with
+ * HopfFibration::inverse to ~1e-15 but not bit for bit: it is for display
+ * coordinates, never for positions that get hashed.
+ */
+
+#include "geometry/s3_vec.hpp"
+#include <cstddef>
+
+namespace s3
+{
+    // out[i] = q · p_i
+    HARTONOMOUS_API void dot_many(const Vec4& q, const double* x, const double* y, const double* z,
+                                  const double* w, size_t n, double* out) noexcept;
+    HARTONOMOUS_API void dot_many(const Vec4& q, const float* x, const float* y, const float* z,
+                                  const float* w, size_t n, float* out) noexcept;
+
+    // out[i] = acos(clamp(q · p_i)), approximated
+    HARTONOMOUS_API void geodesic_many(const Vec4& q, const double* x, const double* y, const double* z,
+                                       const double* w, size_t n, double* out) noexcept;
+    HARTONOMOUS_API void geodesic_many(const Vec4& q, const float* x, const float* y, const float* z,
+                                       const float* w, size_t n, float* out) noexcept;
+
+    // Scale each p_i to unit length in place; zero vectors are left as they are
+    HARTONOMOUS_API void normalize_many(double* x, double* y, double* z, double* w, size_t n) noexcept;
+    HARTONOMOUS_API void normalize_many(float* x, float* y, float* z, float* w, size_t n) noexcept;
+
+    // Component sums of consecutive groups of interleaved (x, y, z, w) points
+    HARTONOMOUS_API void centroid_sums(const double* points_4d, const size_t* counts, size_t groups,
+                                       double* out_4d) noexcept;
+
+    // Hopf map S³ -> S² of each p_i (HopfFibration::forward)
+    HARTONOMOUS_API void hopf_forward_many(const double* x, const double* y, const double* z, const double* w,
+                                           size_t n, double* s2_x, double* s2_y, double* s2_z) noexcept;
+
+    // Lift each S² point to S³ at fiber_angle[i] (HopfFibration::inverse); null angles mean 0
+    HARTONOMOUS_API void hopf_inverse_many(const double* s2_x, const double* s2_y, const double* s2_z,
+                                           const double* fiber_angle, size_t n,
+                                           double* x, double* y, double* z, double* w) noexcept;
+
+    // The acos approximation geodesic_many uses, for scalar callers
+    HARTONOMOUS_API double fast_acos(double x) noexcept;
+
+    // The sincos approximation hopf_inverse_many uses
+    HARTONOMOUS_API void fast_sincos(double x, double& s, double& c) noexcept;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "geometry/s3_bbox.hpp"
+#include "interop_api.h"
+#include <vector>
+
+namespace s3
+{
+    /**
+     * @brief How an overfull R-tree / GiST node is split in two
+     *
+     * Midpoint: split at the middle of the axis whose box centres spread
+     * widest. Cheap, but blind to counts and overlap.
+     * RStar: R*-tree split. The axis is the one whose candidate splits
+     * have the least total margin; on it, the split with the least overlap
+     * (then area, then margin) among those leaving each side min_fill.
+     * Hilbert: entries sorted by the Hilbert index of their centre, cut
+     * where the halves overlap least (keeping min_fill, as RStar does).
+     * Poor under one-at-a-time insertion, where overlap compounds.
+     */
+    enum class SplitMethod
+    {
+        Midpoint,
+        RStar,
+        Hilbert
+    };
+
+    struct BBoxSplit
+    {
+        std::vector<int> left, right;  // Indices into the boxes split
+        BBox4 left_box, right_box;
+    };
+
+    HARTONOMOUS_API double bbox_volume(const BBox4& b) noexcept;
+    HARTONOMOUS_API double bbox_margin(const BBox4& b) noexcept;
+    HARTONOMOUS_API double bbox_overlap(const BBox4& a, const BBox4& b) noexcept;
+
+    /**
+     * @brief Splits boxes (at least two) into two non-empty groups
+     *
+     * min_fill is the least fraction of the entries each side keeps under
+     * RStar and Hilbert; Midpoint ignores it.
+     */
+    HARTONOMOUS_API BBoxSplit split_bboxes(const std::vector<BBox4>& boxes, SplitMethod method,
+                                           double min_fill = 0.4);
+}
@@ -17,4 +17,16 @@ namespace Hartonomous::Geometry {
  */
 Eigen::Vector4d compute_s3_centroid(const double* points_4d, size_t count);
 
+/**
+ * @brief The composition centroid: the mean of the points, projected onto S3.
+ *
+ * This is the centroid hashed into physicality IDs, so its arithmetic (mean,
+ * then normalize, (1, 0, 0, 0) below a 1e-10 norm) must not change.
+ *
+ * @param points_4d Pointer to a flat array of 4D coordinates (x, y, z, w)
+ * @param count Number of 4D points in the array
+ * @return Eigen::Vector4d The normalized centroid on S3
+ */
+Eigen::Vector4d compute_s3_mean(const double* points_4d, size_t count);
+
 } // namespace Hartonomous::Geometry
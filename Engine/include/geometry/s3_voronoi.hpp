@@ -0,0 +1,118 @@
+/**
+ * @file s3_voronoi.hpp
+ * @brief Exact spherical Delaunay triangulation and Voronoi cells on S³
+ *
+ * Every point of S³ is an extreme point of the sites' convex hull in R⁴, and
+ * the vertices of each hull facet lie on the small sphere where the facet's
+ * hyperplane cuts S³. No other site is beyond that hyperplane, so the small
+ * sphere is an empty circumsphere: hull facets are exactly the spherical
+ * Delaunay tetrahedra, the hull's edges are the Delaunay graph, and each
+ * facet's outward unit normal is its circumcenter, a Voronoi vertex.
+ *
+ * The hull is built by Quickhull (ConvexHull, any dimension). Sites in an
+ * open hemisphere get an antipodal guard point so the hull encloses the
+ * origin. A cell is exact only when every circumcap around its site lies
+ * inside the region the sites were taken from; cells on the rim may be cut
+ * by sites that were never loaded and are reported as not exact.
+ *
+ * Cell measures are computed in the gnomonic chart at the site, where great
+ * spheres are planes and the cell is the convex hull of its Voronoi
+ * vertices: volume integrates the chart's density (1 + |y|²)⁻² over the cell,
+ * faces are the chart polytope's facets (areas measured in the chart).
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Hartonomous::Geometry {
+
+/**
+ * @brief Convex hull of points in R^D (D = 3 or 4) as simplicial facets
+ *
+ * Points within `eps` of a facet's hyperplane count as inside, so exact
+ * duplicates and near-coplanar points never become vertices.
+ */
+template <int D>
+class ConvexHull {
+public:
+    using Point = Eigen::Matrix<double, D, 1>;
+
+    struct Facet {
+        std::array<uint32_t, D> vertices;   // Indices into the input points
+        std::array<uint32_t, D> neighbors;  // neighbors[k] shares every vertex but vertices[k]
+        Point normal;                       // Unit, outward
+        double offset;                      // normal · x == offset on the facet
+    };
+
+    // Throws std::runtime_error if the points do not span D dimensions
+    explicit ConvexHull(const std::vector<Point>& points, double eps = 1e-12);
+
+    const std::vector<Facet>& facets() const noexcept { return facets_; }
+
+private:
+    std::vector<Facet> facets_;
+};
+
+extern template class ConvexHull<3>;
+extern template class ConvexHull<4>;
+
+struct S3Cell {
+    struct Face {
+        uint32_t neighbor;          // Site across this face
+        double area_fraction;       // Share of the cell's boundary
+    };
+
+    bool exact = false;             // False: the cell may be cut by sites outside the input
+    double volume = 0.0;            // Fraction of S³'s volume (2π²)
+    double mean_boundary_distance = 0.0;  // Face-area weighted geodesic distance to the bisectors
+    double eccentricity = 0.0;      // 1 - min/max principal second moment in the chart
+    std::vector<Face> faces;        // Largest first
+};
+
+class S3Delaunay {
+public:
+    static constexpr uint32_t NPOS = ~uint32_t(0);
+
+    /**
+     * @brief Triangulate unit-length sites
+     *
+     * @param region Center and geodesic radius of the ball the sites were
+     *               taken from (all sites of S³ inside it); without one, only
+     *               cells touching the guard point are marked not exact
+     */
+    explicit S3Delaunay(std::vector<Eigen::Vector4d> sites,
+                        std::optional<std::pair<Eigen::Vector4d, double>> region = std::nullopt);
+
+    size_t size() const noexcept { return sites_.size(); }
+    size_t tetrahedra() const noexcept { return circumcenters_.size(); }
+    const Eigen::Vector4d& site(uint32_t i) const { return sites_[i]; }
+
+    // Delaunay graph neighbors (sites sharing a Voronoi face), ascending
+    std::span<const uint32_t> neighbors(uint32_t i) const {
+        return {adjacency_.data() + adjacency_offsets_[i], adjacency_offsets_[i + 1] - adjacency_offsets_[i]};
+    }
+
+    // False when the cell may be cut by unloaded sites (or could not be charted)
+    bool exact(uint32_t i) const { return state_[i] != NOT_EXACT; }
+
+    // Measures of site i's cell; only `exact` is set when the cell is not exact
+    S3Cell cell(uint32_t i) const;
+
+private:
+    // Coincident sites: the first keeps the cell, later copies own nothing
+    enum : uint8_t { NOT_EXACT, EXACT, DUPLICATE };
+
+    std::vector<Eigen::Vector4d> sites_;
+    std::vector<Eigen::Vector4d> circumcenters_;  // One per Delaunay tetrahedron
+    std::vector<uint32_t> adjacency_offsets_, adjacency_;
+    std::vector<uint32_t> star_offsets_, star_;    // Tetrahedra around each site
+    std::vector<uint8_t> state_;
+};
+
+} // namespace Hartonomous::Geometry
@@ -62,6 +62,23 @@ public:
      * @return Vec4 Normalized vector on S³.
      */
     static Vec4 hash_to_point(const unsigned char* hash_bytes);
+
+    /**
+     * @brief point_on_s3(first + k, N) for k < count, 4 doubles per point into out_4d.
+     *
+     * Bit-identical to the single-point call; large batches are split
+     * across OpenMP threads.
+     */
+    static void points_on_s3(size_t first, size_t count, size_t N, double* out_4d);
+
+    /**
+     * @brief hash_to_point() of `count` 16-byte hashes laid out back to back.
+     *
+     * Bit-identical to the single-point call (these positions are hashed
+     * into physicality IDs), so the trig stays scalar libm; large batches
+     * are split across OpenMP threads.
+     */
+    static void hash_to_points(const unsigned char* hashes, size_t count, double* out_4d);
 };
 
 } // namespace hartonomous::geometry
\ No newline at end of file
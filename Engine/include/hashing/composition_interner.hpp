@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file composition_interner.hpp
+ * @brief Process-wide mapping of 16-byte composition IDs to dense uint32 IDs
+ *
+ * Search state indexed by a dense ID fits in flat arrays and 4-byte hash keys
+ * instead of node-allocated maps on 16-byte digests. IDs are assigned in
+ * first-intern order and never reused, so they are stable for the life of
+ * the process and can be shared freely between engines and threads.
+ *
+ * intern() and find() lock one of 64 shards; hash_of() is lock-free. The
+ * reverse table grows in fixed chunks that never move, so a reference
+ * returned by hash_of() stays valid.
+ */
+
+#include <hashing/blake3_pipeline.hpp>
+#include <hashing/hash_table_128.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace Hartonomous {
+
+class CompositionInterner {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+    static constexpr uint32_t NPOS = ~uint32_t(0);
+
+    // Shared by every engine in the process
+    static CompositionInterner& global();
+
+    CompositionInterner();
+    ~CompositionInterner();
+    CompositionInterner(const CompositionInterner&) = delete;
+    CompositionInterner& operator=(const CompositionInterner&) = delete;
+
+    // Dense ID for `id`, assigning the next one on first sight
+    uint32_t intern(const Hash& id);
+
+    // Dense ID for `id`, or NPOS if it was never interned
+    uint32_t find(const Hash& id) const;
+
+    const Hash& hash_of(uint32_t dense) const {
+        return chunks_[dense >> CHUNK_BITS].load(std::memory_order_acquire)[dense & CHUNK_MASK];
+    }
+
+    size_t size() const noexcept { return next_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t SHARD_BITS = 6;
+    static constexpr size_t CHUNK_BITS = 16;
+    static constexpr uint32_t CHUNK_MASK = (1u << CHUNK_BITS) - 1;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << (32 - CHUNK_BITS);
+
+    struct alignas(64) Shard {
+        mutable std::mutex mu;
+        HashMap128<uint32_t> map;
+    };
+
+    Shard& shard_for(const Hash& id) const { return shards_[HashHasher{}(id) >> (64 - SHARD_BITS)]; }
+    Hash* chunk_for(uint32_t dense);
+
+    mutable std::array<Shard, size_t(1) << SHARD_BITS> shards_;
+    std::unique_ptr<std::atomic<Hash*>[]> chunks_;
+    std::mutex chunk_mu_;
+    std::atomic<uint32_t> next_{0};
+};
+
+} // namespace Hartonomous
@@ -6,14 +6,29 @@
 #include <storage/composition_store.hpp>
 #include <storage/relation_store.hpp>
 #include <storage/relation_evidence_store.hpp>
+#include <storage/composition_adjacency.hpp>
+#include <storage/prefix_partitions.hpp>
+#include <hashing/hash_table_128.hpp>
+#include <utils/ingest_report.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <set>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <atomic>
 #include <vector>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 namespace Hartonomous {
 
@@ -24,15 +39,114 @@ namespace Hartonomous {
  * Multiple workers drain from a shared queue for parallel DB writes.
  * FK checks disabled via session_replication_role='replica' so batch
  * ordering across workers is safe.
+ *
+ * The queue is bounded by total queued records rather than batch count,
+ * so producers emitting huge batches cannot exhaust memory and producers
+ * emitting tiny ones are not throttled early. Workers coalesce queued
+ * batches into one transaction up to a record target, and the number of
+ * active workers is tuned from observed commit throughput.
+ *
+ * Ratings are the only records two transactions upsert on the same key
+ * (ON CONFLICT on relationid), which is what used to deadlock workers.
+ * They are pulled out of batches at enqueue time, pre-aggregated per
+ * relation into RATING_LANES lanes partitioned by the leading byte of
+ * the relation ID, and each lane is flushed by at most one transaction
+ * at a time. Concurrent transactions therefore never share a rating row,
+ * and repeated observations of a hot relation collapse into one upsert.
+ *
+ * When physicality, relation and relationevidence are prefix-partitioned,
+ * each transaction writes their rows grouped per partition, and workers
+ * start at partitions spread by worker index, so concurrent COPYs mostly
+ * extend different partitions' indexes.
+ *
+ * With table_streams above one, a large transaction's tables are COPYed
+ * concurrently over that many connections, each table committing on its
+ * own (see flush_batch_streams), so the batch takes about as long as its
+ * largest table. Each worker then holds up to table_streams connections.
+ *
+ * enqueue() numbers batches from 1. flushed_through() is the highest id
+ * whose batch, and every batch before it, has left the flusher (ratings
+ * included), which is what a resumable producer checkpoints against.
  */
 class AsyncFlusher {
 public:
-    explicit AsyncFlusher(size_t num_workers = 3) {
-        workers_.reserve(num_workers);
-        for (size_t i = 0; i < num_workers; ++i)
-            workers_.emplace_back(&AsyncFlusher::worker, this);
+    struct Options {
+        size_t initial_workers = 3;
+        size_t min_workers = 1;
+        size_t max_workers = 8;
+        size_t max_queued_records = 4000000;   // enqueue() blocks beyond this
+        size_t coalesce_records = 50000;       // Merge queued batches up to this per transaction
+        size_t max_txn_records = 1000000;      // Never merge past this
+        bool auto_tune = true;
+        double tune_interval_sec = 5.0;
+        size_t table_streams = 1;              // Connections one transaction's tables spread over
+        size_t table_stream_min_records = 200000;   // Smaller transactions stay on one connection
+
+        /**
+         * @brief Defaults overridden by HARTONOMOUS_FLUSH_{WORKERS,MAX_WORKERS,QUEUE_RECORDS,COALESCE_RECORDS,AUTOTUNE}
+         * and HARTONOMOUS_FLUSH_TABLE_STREAMS[_MIN_RECORDS]
+         */
+        static Options from_env() {
+            Options o;
+            auto env = [](const char* name, size_t& field) {
+                if (const char* v = std::getenv(name)) field = std::strtoull(v, nullptr, 10);
+            };
+            env("HARTONOMOUS_FLUSH_WORKERS", o.initial_workers);
+            env("HARTONOMOUS_FLUSH_MAX_WORKERS", o.max_workers);
+            env("HARTONOMOUS_FLUSH_QUEUE_RECORDS", o.max_queued_records);
+            env("HARTONOMOUS_FLUSH_COALESCE_RECORDS", o.coalesce_records);
+            env("HARTONOMOUS_FLUSH_TABLE_STREAMS", o.table_streams);
+            env("HARTONOMOUS_FLUSH_TABLE_STREAMS_MIN_RECORDS", o.table_stream_min_records);
+            if (const char* v = std::getenv("HARTONOMOUS_FLUSH_AUTOTUNE")) o.auto_tune = std::string(v) != "0";
+            return o;
+        }
+    };
+
+    /**
+     * @brief Snapshot of flusher activity.
+     *
+     * High producer_wait_sec means the database is the bottleneck; high
+     * worker_idle_sec means the producers are.
+     */
+    struct Metrics {
+        size_t active_workers = 0;
+        size_t max_workers = 0;
+        size_t queued_batches = 0;
+        size_t queued_records = 0;
+        size_t batches_flushed = 0;
+        size_t transactions = 0;
+        size_t records_flushed = 0;
+        size_t failed_batches = 0;
+        size_t table_retries = 0;          // Table streams that failed once and were retried staged
+        size_t pending_ratings = 0;        // Aggregated, not yet flushed
+        size_t ratings_aggregated = 0;     // Observations merged into an existing pending rating
+        double avg_txn_ms = 0.0;
+        double records_per_sec = 0.0;
+        double producer_wait_sec = 0.0;
+        double worker_idle_sec = 0.0;
+    };
+
+    explicit AsyncFlusher(Options opts = Options::from_env()) : opts_(opts) {
+        opts_.max_workers = std::max<size_t>(1, opts_.max_workers);
+        opts_.min_workers = std::clamp<size_t>(opts_.min_workers, 1, opts_.max_workers);
+        opts_.initial_workers = std::clamp(opts_.initial_workers, opts_.min_workers, opts_.max_workers);
+        opts_.table_streams = std::clamp<size_t>(opts_.table_streams, 1, TABLES.size());
+        if (!opts_.auto_tune) opts_.max_workers = opts_.initial_workers;
+        target_workers_ = opts_.initial_workers;
+
+        start_ = window_start_ = std::chrono::steady_clock::now();
+        // Threads beyond the target stay parked (without a connection) until tuning activates them
+        workers_.reserve(opts_.max_workers);
+        for (size_t i = 0; i < opts_.max_workers; ++i)
+            workers_.emplace_back(&AsyncFlusher::worker, this, i);
     }
 
+    explicit AsyncFlusher(size_t num_workers) : AsyncFlusher([num_workers] {
+        Options o = Options::from_env();
+        o.initial_workers = num_workers;
+        return o;
+    }()) {}
+
     ~AsyncFlusher() {
         {
             std::lock_guard<std::mutex> lock(mutex_);
@@ -41,20 +155,69 @@ public:
         cv_.notify_all();
         for (auto& t : workers_)
             if (t.joinable()) t.join();
+
+        // Totals of every flusher the run used
+        const Metrics m = metrics();
+        auto& report = IngestReport::global();
+        report.add("flusher.records", static_cast<double>(m.records_flushed));
+        report.add("flusher.transactions", static_cast<double>(m.transactions));
+        report.add("flusher.failed_batches", static_cast<double>(m.failed_batches));
+        report.add("flusher.table_retries", static_cast<double>(m.table_retries));
+        report.add("flusher.producer_wait_sec", m.producer_wait_sec);
+        report.add("flusher.worker_idle_sec", m.worker_idle_sec);
     }
 
     /**
-     * @brief Enqueue a batch for background flushing.
-     * Blocks if the queue is full (backpressure).
+     * @brief Enqueue a batch for background flushing; returns its id (0 if none).
+     * Blocks while the queued record budget is exhausted (backpressure).
+     * A single batch larger than the budget is admitted once the queue is empty.
      */
-    void enqueue(std::unique_ptr<SubstrateBatch> batch) {
+    uint64_t enqueue(std::unique_ptr<SubstrateBatch> batch) {
+        if (!batch) return 0;
+        size_t records = batch->record_count();
+        uint64_t id = 0;
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] { return queue_.size() < 16 || stop_; });
-            if (stop_) return;
-            queue_.push(std::move(batch));
+            auto fits = [&] {
+                size_t queued = queued_records_ + pending_ratings_;
+                return queued == 0 || queued + records <= opts_.max_queued_records || stop_;
+            };
+            if (!fits()) {
+                auto t0 = std::chrono::steady_clock::now();
+                cv_.wait(lock, fits);
+                producer_wait_ns_ += elapsed_ns(t0);
+            }
+            if (stop_) return 0;
+            id = ++last_id_;
+            in_flight_.insert(id);  // Until its ratings are in lanes and the rest is queued
+        }
+
+        aggregate_ratings(batch->rating, id);
+        records -= batch->rating.size();
+        batch->rating.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!batch->empty()) {
+                queued_records_ += records;
+                queue_.push_back({std::move(batch), records, id});
+            }
+            in_flight_.erase(in_flight_.find(id));
         }
         cv_.notify_all();
+        return id;
+    }
+
+    /**
+     * @brief Highest batch id at or below which every batch has been flushed.
+     * A batch that failed counts as gone; check failed_batches() before trusting it.
+     */
+    uint64_t flushed_through() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t oldest = last_id_ + 1;
+        if (!queue_.empty()) oldest = std::min(oldest, queue_.front().id);
+        if (!in_flight_.empty()) oldest = std::min(oldest, *in_flight_.begin());
+        for (const auto& lane : lanes_) oldest = std::min(oldest, lane.oldest.load());
+        return oldest - 1;
     }
 
     /**
@@ -62,72 +225,426 @@ public:
      */
     void wait_all() {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this] { return queue_.empty() && workers_busy_ == 0; });
+        cv_.wait(lock, [this] { return queue_.empty() && pending_ratings_ == 0 && workers_busy_ == 0; });
+    }
+
+    /**
+     * @brief Number of batches dropped after a non-retryable error.
+     */
+    size_t failed_batches() const { return failed_.load(); }
+
+    Metrics metrics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Metrics m;
+        m.active_workers = target_workers_;
+        m.max_workers = opts_.max_workers;
+        m.queued_batches = queue_.size();
+        m.queued_records = queued_records_;
+        m.batches_flushed = batches_flushed_;
+        m.transactions = transactions_;
+        m.records_flushed = records_flushed_;
+        m.failed_batches = failed_.load();
+        m.table_retries = table_retries_.load();
+        m.pending_ratings = pending_ratings_.load();
+        m.ratings_aggregated = ratings_aggregated_.load();
+        m.avg_txn_ms = transactions_ ? txn_ns_ * 1e-6 / transactions_ : 0.0;
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        m.records_per_sec = sec > 0 ? records_flushed_ / sec : 0.0;
+        m.producer_wait_sec = producer_wait_ns_ * 1e-9;
+        m.worker_idle_sec = worker_idle_ns_ * 1e-9;
+        return m;
+    }
+
+    void print_metrics(std::ostream& os) const {
+        Metrics m = metrics();
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1)
+            << "  [flusher] " << m.records_flushed << " records in " << m.transactions << " txns ("
+            << m.batches_flushed << " batches), " << m.records_per_sec << " rec/s, "
+            << m.avg_txn_ms << " ms/txn, workers " << m.active_workers << "/" << m.max_workers
+            << ", producer wait " << m.producer_wait_sec << "s, worker idle " << m.worker_idle_sec << "s";
+        if (m.ratings_aggregated) out << ", " << m.ratings_aggregated << " ratings pre-aggregated";
+        if (m.table_retries) out << ", " << m.table_retries << " table retries";
+        if (m.failed_batches) out << ", " << m.failed_batches << " FAILED";
+        os << out.str() << std::endl;
     }
 
 private:
-    void worker() {
-        PostgresConnection db;
-        db.execute("SET synchronous_commit = off");
-        db.execute("SET session_replication_role = 'replica'");
+    struct Queued {
+        std::unique_ptr<SubstrateBatch> batch;
+        size_t records = 0;
+        uint64_t id = 0;
+    };
+
+    static constexpr uint64_t NO_BATCH = std::numeric_limits<uint64_t>::max();
+
+    static uint64_t elapsed_ns(std::chrono::steady_clock::time_point t0) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+    }
+
+    static constexpr size_t RATING_LANES = 64;
+
+    // Every table of a batch but relationrating, which is never split off
+    enum class Table { Physicality, Composition, CompositionSequence, Relation, RelationSequence, Evidence };
+    static constexpr std::array<Table, 6> TABLES = {Table::Physicality, Table::Composition,
+        Table::CompositionSequence, Table::Relation, Table::RelationSequence, Table::Evidence};
+
+    struct RatingLane {
+        std::mutex mutex;                          // Guards pending; size changes with it
+        HashMap128<RelationRatingRecord> pending;
+        std::atomic<size_t> size{0};               // pending.size(), readable without the lane lock
+        std::atomic<uint64_t> oldest{NO_BATCH};    // Lowest batch id in pending; set before size grows
+        bool in_flight = false;                    // Guarded by mutex_
+    };
+
+    static size_t lane_of(const BLAKE3Pipeline::Hash& relation_id) {
+        return relation_id[0] * RATING_LANES / 256;
+    }
+
+    // Merge ratings into their lanes (lane locks only; never blocks on mutex_)
+    void aggregate_ratings(const std::vector<RelationRatingRecord>& ratings, uint64_t id) {
+        if (ratings.empty()) return;
+        std::array<std::vector<const RelationRatingRecord*>, RATING_LANES> by_lane;
+        for (const auto& r : ratings) by_lane[lane_of(r.relation_id)].push_back(&r);
+
+        for (size_t l = 0; l < RATING_LANES; ++l) {
+            if (by_lane[l].empty()) continue;
+            RatingLane& lane = lanes_[l];
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            if (id < lane.oldest) lane.oldest = id;
+            size_t added = 0;
+            // Same aggregation RelationRatingStore applies within a transaction
+            for (const auto* r : by_lane[l]) {
+                auto [slot, inserted] = lane.pending.try_emplace(r->relation_id, *r);
+                if (inserted) added++;
+                else slot->merge(*r);
+            }
+            lane.size += added;
+            pending_ratings_ += added;
+            ratings_aggregated_ += by_lane[l].size() - added;
+        }
+    }
+
+    // mutex_ held
+    bool ratings_claimable() const {
+        if (pending_ratings_ == 0) return false;
+        for (const auto& lane : lanes_)
+            if (lane.size && !lane.in_flight) return true;
+        return false;
+    }
+
+    // mutex_ held: take exclusive ownership of non-empty lanes up to the coalesce target;
+    // `oldest` drops to the lowest batch id among them
+    std::vector<size_t> claim_rating_lanes(uint64_t& oldest) {
+        std::vector<size_t> claimed;
+        size_t records = 0;
+        for (size_t i = 0; i < RATING_LANES && records < opts_.coalesce_records; ++i) {
+            size_t l = (next_lane_ + i) % RATING_LANES;
+            if (!lanes_[l].size || lanes_[l].in_flight) continue;
+            lanes_[l].in_flight = true;
+            records += lanes_[l].size;
+            oldest = std::min(oldest, lanes_[l].oldest.load());
+            claimed.push_back(l);
+        }
+        next_lane_ = (next_lane_ + claimed.size()) % RATING_LANES;
+        return claimed;
+    }
+
+    static std::unique_ptr<PostgresConnection> open_connection() {
+        auto db = std::make_unique<PostgresConnection>();
+        db->execute("SET synchronous_commit = off");
+        db->execute("SET session_replication_role = 'replica'");
+        return db;
+    }
+
+    void worker(size_t index) {
+        std::unique_ptr<PostgresConnection> db;
+        std::vector<std::unique_ptr<PostgresConnection>> streams;   // Extra table stream connections
 
         while (true) {
-            std::unique_ptr<SubstrateBatch> batch;
+            std::vector<Queued> taken;
+            std::vector<size_t> lanes;
+            size_t txn_records = 0;
+            uint64_t oldest = NO_BATCH;   // Lowest batch id this transaction carries
             {
                 std::unique_lock<std::mutex> lock(mutex_);
-                cv_.wait(lock, [this] { return !queue_.empty() || stop_; });
-                if (stop_ && queue_.empty()) break;
-                batch = std::move(queue_.front());
-                queue_.pop();
+                auto t0 = std::chrono::steady_clock::now();
+                cv_.wait(lock, [&] {
+                    return ((!queue_.empty() || ratings_claimable()) && index < target_workers_) || stop_;
+                });
+                if (index < target_workers_) worker_idle_ns_ += elapsed_ns(t0);
+                // Stopping and drained. Ratings still pending sit in lanes another
+                // worker has in flight; that worker picks them up when it loops.
+                if (queue_.empty() && !ratings_claimable()) break;
+
+                // Coalesce small batches so per-transaction overhead is amortised
+                while (!queue_.empty() && (taken.empty() || (txn_records < opts_.coalesce_records &&
+                       txn_records + queue_.front().records <= opts_.max_txn_records))) {
+                    oldest = std::min(oldest, queue_.front().id);
+                    txn_records += queue_.front().records;
+                    queued_records_ -= queue_.front().records;
+                    taken.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                lanes = claim_rating_lanes(oldest);
+                in_flight_.insert(oldest);
                 workers_busy_++;
             }
             cv_.notify_all();
 
-            if (batch && !batch->empty()) {
-                // Retry loop: RelationRatingStore ON CONFLICT upserts can deadlock
-                // when multiple workers update the same relation_id simultaneously.
-                // PostgreSQL aborts one side — we just retry with backoff.
-                for (int attempt = 0; attempt < 4; ++attempt) {
-                    try {
-                        PostgresConnection::Transaction txn(db);
-                        { PhysicalityStore s(db, false, true); for (auto& r : batch->phys) s.store(r); s.flush(); }
-                        { CompositionStore s(db, false, true); for (auto& r : batch->comp) s.store(r); s.flush(); }
-                        { CompositionSequenceStore s(db, false, true); for (auto& r : batch->seq) s.store(r); s.flush(); }
-                        { RelationStore s(db, false, true); for (auto& r : batch->rel) s.store(r); s.flush(); }
-                        { RelationSequenceStore s(db, false, true); for (auto& r : batch->rel_seq) s.store(r); s.flush(); }
-                        { RelationRatingStore s(db, true); for (auto& r : batch->rating) s.store(r); s.flush(); }
-                        { RelationEvidenceStore s(db, false, true); for (auto& r : batch->evidence) s.store(r); s.flush(); }
-                        txn.commit();
-                        break;  // Success
-                    } catch (const std::exception& e) {
-                        std::string err = e.what();
-                        if (err.find("deadlock") != std::string::npos && attempt < 3) {
-                            // Backoff: 20-70ms, 40-140ms, 80-280ms
-                            int base_ms = 20 * (1 << attempt);
-                            std::this_thread::sleep_for(std::chrono::milliseconds(
-                                base_ms + (std::hash<std::thread::id>{}(std::this_thread::get_id()) % (base_ms * 2))));
-                        } else {
-                            std::cerr << "\n[ERROR] Async flush failed: " << err << std::endl;
-                            break;
-                        }
-                    }
+            auto batch = taken.empty() ? std::make_unique<SubstrateBatch>() : std::move(taken[0].batch);
+            for (size_t i = 1; i < taken.size(); ++i) batch->append(std::move(*taken[i].batch));
+
+            // Producers keep filling a fresh map while this one is written out.
+            // Ratings merged since the claim may carry older batch ids, so
+            // this transaction's in-flight entry is re-taken as the maps move.
+            std::vector<HashMap128<RelationRatingRecord>> ratings;
+            size_t rating_records = 0;
+            if (!lanes.empty()) {
+                std::lock_guard<std::mutex> ids(mutex_);
+                in_flight_.erase(in_flight_.find(oldest));
+                for (size_t l : lanes) {
+                    RatingLane& lane = lanes_[l];
+                    std::lock_guard<std::mutex> lock(lane.mutex);
+                    size_t n = lane.pending.size();
+                    oldest = std::min(oldest, lane.oldest.load());
+                    ratings.push_back(std::move(lane.pending));
+                    lane.pending = HashMap128<RelationRatingRecord>();
+                    lane.oldest = NO_BATCH;
+                    lane.size -= n;
+                    pending_ratings_ -= n;
+                    rating_records += n;
                 }
+                in_flight_.insert(oldest);
             }
 
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok = true;
+            try {
+                if (!db) db = open_connection();
+                if (opts_.table_streams > 1 && txn_records >= opts_.table_stream_min_records)
+                    flush_batch_streams(db, streams, *batch, ratings, index);
+                else
+                    flush_batch(*db, *batch, ratings, index);
+            } catch (const std::exception& e) {
+                std::cerr << "\n[ERROR] Async flush failed: " << e.what() << std::endl;
+                ok = false;
+            }
+            uint64_t ns = elapsed_ns(t0);
+
             {
                 std::lock_guard<std::mutex> lock(mutex_);
                 workers_busy_--;
+                in_flight_.erase(in_flight_.find(oldest));
+                for (size_t l : lanes) lanes_[l].in_flight = false;
+                txn_records += rating_records;
+                if (ok) {
+                    batches_flushed_ += taken.size();
+                    transactions_++;
+                    records_flushed_ += txn_records;
+                    txn_ns_ += ns;
+                    window_records_ += txn_records;
+                } else {
+                    failed_ += std::max<size_t>(1, taken.size());
+                }
+                if (opts_.auto_tune) maybe_retune();
             }
             cv_.notify_all();
         }
     }
 
-    std::queue<std::unique_ptr<SubstrateBatch>> queue_;
-    std::mutex mutex_;
+    // One transaction per call. Ratings come only from lanes this worker owns,
+    // so no other open transaction can hold a lock on the same rating row.
+    void flush_batch(PostgresConnection& db, SubstrateBatch& batch,
+                     const std::vector<HashMap128<RelationRatingRecord>>& ratings, size_t index) {
+        route_partitions(db, batch, index);
+        PostgresConnection::Transaction txn(db);
+        for (Table t : TABLES) copy_table(db, batch, t, false);
+        flush_ratings(db, batch, ratings);
+        txn.commit();
+    }
+
+    /**
+     * @brief Each table in its own transaction, concurrently, then ratings.
+     *
+     * Tables go largest first to whichever of `db` and up to table_streams - 1
+     * `streams` is free. A table whose transaction fails is retried once,
+     * staged, on a fresh connection: a staged COPY skips rows already present,
+     * so the retry is safe whether or not the first attempt's commit landed.
+     * Ratings (the one non-idempotent upsert) and the adjacency refresh commit
+     * on `db` only after every table has, so a batch that still fails wrote no
+     * ratings, and replaying it from the producer's checkpoint adds each
+     * observation once.
+     */
+    void flush_batch_streams(std::unique_ptr<PostgresConnection>& db,
+                             std::vector<std::unique_ptr<PostgresConnection>>& streams, SubstrateBatch& batch,
+                             const std::vector<HashMap128<RelationRatingRecord>>& ratings, size_t index) {
+        route_partitions(*db, batch, index);
+        std::vector<Table> order;
+        for (Table t : TABLES)
+            if (table_rows(batch, t)) order.push_back(t);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](Table a, Table b) { return table_rows(batch, a) > table_rows(batch, b); });
+
+        const size_t n = std::min(opts_.table_streams, std::max<size_t>(1, order.size()));
+        if (streams.size() < n - 1) streams.resize(n - 1);
+        std::atomic<size_t> next{0};
+        std::vector<std::string> errors(order.size());
+        auto run = [&](std::unique_ptr<PostgresConnection>& conn) {
+            for (size_t i; (i = next++) < order.size();) {
+                auto attempt = [&](bool staged) {
+                    if (!conn) conn = open_connection();
+                    PostgresConnection::Transaction txn(*conn);
+                    copy_table(*conn, batch, order[i], staged);
+                    txn.commit();
+                };
+                try {
+                    attempt(false);
+                } catch (const std::exception& e) {
+                    table_retries_++;
+                    std::cerr << "\n[WARN] Table stream failed, retrying staged: " << e.what() << std::endl;
+                    conn.reset();
+                    try {
+                        attempt(true);
+                    } catch (const std::exception& retry) {
+                        errors[i] = retry.what();
+                        conn.reset();
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t s = 0; s + 1 < n; ++s) threads.emplace_back(run, std::ref(streams[s]));
+        run(db);
+        for (auto& t : threads) t.join();
+
+        for (const auto& e : errors)
+            if (!e.empty()) throw std::runtime_error("table stream failed after retry: " + e);
+        if (!db) db = open_connection();
+        PostgresConnection::Transaction txn(*db);
+        flush_ratings(*db, batch, ratings);
+        txn.commit();
+    }
+
+    static size_t table_rows(const SubstrateBatch& batch, Table t) {
+        switch (t) {
+            case Table::Physicality: return batch.phys.size();
+            case Table::Composition: return batch.comp.size();
+            case Table::CompositionSequence: return batch.seq.size();
+            case Table::Relation: return batch.rel.size();
+            case Table::RelationSequence: return batch.rel_seq.size();
+            case Table::Evidence: return batch.evidence.size();
+        }
+        return 0;
+    }
+
+    // One table's rows; `staged` skips rows already in the table (ON CONFLICT DO NOTHING)
+    static void copy_table(PostgresConnection& db, SubstrateBatch& batch, Table t, bool staged) {
+        switch (t) {
+            case Table::Physicality: { PhysicalityStore s(db, staged, true); for (auto& r : batch.phys) s.store(r); s.flush(); break; }
+            case Table::Composition: { CompositionStore s(db, staged, true); for (auto& r : batch.comp) s.store(r); s.flush(); break; }
+            case Table::CompositionSequence: { CompositionSequenceStore s(db, staged, true); for (auto& r : batch.seq) s.store(r); s.flush(); break; }
+            case Table::Relation: { RelationStore s(db, staged, true); for (auto& r : batch.rel) s.store(r); s.flush(); break; }
+            case Table::RelationSequence: { RelationSequenceStore s(db, staged, true); for (auto& r : batch.rel_seq) s.store(r); s.flush(); break; }
+            case Table::Evidence: { RelationEvidenceStore s(db, staged, true); for (auto& r : batch.evidence) s.store(r); s.flush(); break; }
+        }
+    }
+
+    // Ratings, then the adjacency rows they and the batch's relations touch; inside the caller's transaction
+    static void flush_ratings(PostgresConnection& db, const SubstrateBatch& batch,
+                              const std::vector<HashMap128<RelationRatingRecord>>& ratings) {
+        if (!ratings.empty()) {
+            RelationRatingStore s(db, true);
+            for (const auto& lane : ratings)
+                lane.for_each([&](const BLAKE3Pipeline::Hash&, const RelationRatingRecord& r) { s.store(r); });
+            s.flush();
+        }
+        if (CompositionAdjacency::enabled(db)) {
+            // New relations and re-rated ones; the sequences and ratings of
+            // one relation may arrive in different transactions
+            std::vector<BLAKE3Pipeline::Hash> touched;
+            touched.reserve(batch.rel_seq.size());
+            for (const auto& r : batch.rel_seq) touched.push_back(r.relation_id);
+            for (const auto& lane : ratings)
+                lane.for_each([&](const BLAKE3Pipeline::Hash& id, const RelationRatingRecord&) { touched.push_back(id); });
+            CompositionAdjacency::refresh(db, touched);
+        }
+    }
+
+    // Group partitioned tables' rows per partition, this worker's share first
+    void route_partitions(PostgresConnection& db, SubstrateBatch& batch, size_t index) {
+        auto first = [&](unsigned bits) { return (index << bits) / opts_.max_workers; };
+        if (unsigned b = PrefixPartitions::bits(db, "physicality")) PrefixPartitions::route(batch.phys, b, first(b));
+        if (unsigned b = PrefixPartitions::bits(db, "relation")) PrefixPartitions::route(batch.rel, b, first(b));
+        if (unsigned b = PrefixPartitions::bits(db, "relationevidence")) PrefixPartitions::route(batch.evidence, b, first(b));
+    }
+
+    // Hill-climb the active worker count once per tuning window (mutex held).
+    // Only a backlog (producers blocked or work queued) justifies more
+    // workers; an added worker that did not raise commit throughput by 5%
+    // is taken back, since extra sessions then only add lock contention.
+    void maybe_retune() {
+        auto now = std::chrono::steady_clock::now();
+        double sec = std::chrono::duration<double>(now - window_start_).count();
+        if (sec < opts_.tune_interval_sec) return;
+
+        double throughput = window_records_ / sec;
+        bool backlog = producer_wait_ns_ > window_producer_wait_ns_ || !queue_.empty() || ratings_claimable();
+        bool idle = worker_idle_ns_ - window_idle_ns_ > static_cast<uint64_t>(sec * 1e9 * 0.5);
+
+        if (last_step_ > 0 && throughput < last_throughput_ * 1.05) {
+            target_workers_ = std::max(opts_.min_workers, target_workers_ - 1);
+            last_step_ = 0;
+        } else if (backlog && target_workers_ < opts_.max_workers) {
+            target_workers_++;
+            last_step_ = 1;
+        } else if (!backlog && idle && target_workers_ > opts_.min_workers) {
+            target_workers_--;
+            last_step_ = -1;
+        } else {
+            last_step_ = 0;
+        }
+
+        last_throughput_ = throughput;
+        window_start_ = now;
+        window_records_ = 0;
+        window_producer_wait_ns_ = producer_wait_ns_;
+        window_idle_ns_ = worker_idle_ns_;
+    }
+
+    Options opts_;
+    std::deque<Queued> queue_;
+    size_t queued_records_ = 0;
+    mutable std::mutex mutex_;
     std::condition_variable cv_;
     std::vector<std::thread> workers_;
-    std::atomic<bool> stop_{false};
-    std::atomic<int> workers_busy_{0};
+    bool stop_ = false;
+    int workers_busy_ = 0;
+    std::atomic<size_t> failed_{0};
+    std::atomic<size_t> table_retries_{0};
+    uint64_t last_id_ = 0;
+    std::multiset<uint64_t> in_flight_;   // Oldest batch id of each batch being enqueued or transaction underway
+
+    // Metrics and tuning state (guarded by mutex_)
+    size_t target_workers_ = 0;
+    size_t batches_flushed_ = 0;
+    size_t transactions_ = 0;
+    size_t records_flushed_ = 0;
+    std::atomic<size_t> pending_ratings_{0};
+    std::atomic<size_t> ratings_aggregated_{0};
+    std::array<RatingLane, RATING_LANES> lanes_;
+    size_t next_lane_ = 0;
+    uint64_t txn_ns_ = 0;
+    uint64_t producer_wait_ns_ = 0;
+    uint64_t worker_idle_ns_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point window_start_;
+    size_t window_records_ = 0;
+    uint64_t window_producer_wait_ns_ = 0;
+    uint64_t window_idle_ns_ = 0;
+    double last_throughput_ = 0.0;
+    int last_step_ = 0;
 };
 
 } // namespace Hartonomous
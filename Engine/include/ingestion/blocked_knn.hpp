@@ -0,0 +1,60 @@
+/**
+ * @file blocked_knn.hpp
+ * @brief Exact k-nearest-neighbor search by tiled GEMM with fused top-k
+ *
+ * For vocabularies in the tens of thousands, scoring every pair exactly is
+ * cheaper than building an HNSW graph: each tile of scores is one SGEMM
+ * (MKL through Eigen) and is reduced into per-row top-k heaps while it is
+ * still in L2, so the full n x n similarity matrix never exists. Rows are
+ * expected to be unit-normalized; similarity is the inner product.
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Hartonomous {
+
+enum class KnnBackend {
+    HNSW,          // Approximate, sub-quadratic; for large vocabularies
+    BlockedGEMM,   // Exact, quadratic but SGEMM-bound
+    Device,        // Exact on a GPU (device_knn.hpp) for every mining pass; HNSW without one
+};
+
+struct BlockedKnnTiles {
+    size_t query_rows = 0;   // Rows of Q per task
+    size_t key_rows = 0;     // Rows of K scored per GEMM
+};
+
+struct BlockedKnnResult {
+    size_t k = 0;
+    std::vector<uint32_t> index;       // rows() * k, best first
+    std::vector<float> similarity;     // Parallel to index
+    std::vector<uint32_t> count;       // Valid neighbors per row (<= k)
+
+    size_t rows() const noexcept { return count.size(); }
+};
+
+/**
+ * @brief Tile sizes keeping one score tile plus its K rows inside L2
+ *
+ * @param l2_bytes Per-core L2 size; 0 reads it from the system
+ */
+BlockedKnnTiles blocked_knn_tiles(size_t dim, size_t l2_bytes = 0);
+
+/**
+ * @brief For every row of Q, the k rows of K with the highest similarity
+ *
+ * Only neighbors with similarity >= threshold are kept, so rows may hold
+ * fewer than k. With exclude_self, row i of K is never a neighbor of row i
+ * of Q (Q and K are the same vectors).
+ */
+BlockedKnnResult blocked_knn(const Eigen::Ref<const Eigen::MatrixXf>& Q,
+                             const Eigen::Ref<const Eigen::MatrixXf>& K,
+                             size_t k, float threshold, bool exclude_self,
+                             BlockedKnnTiles tiles = {});
+
+} // namespace Hartonomous
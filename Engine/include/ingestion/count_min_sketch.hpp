@@ -0,0 +1,90 @@
+/**
+ * @file count_min_sketch.hpp
+ * @brief Fixed-memory frequency estimates for keys seen across many batches
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Count-Min sketch with conservative update
+ *
+ * DEPTH rows of 2^width_bits saturating 32-bit counters. An estimate never
+ * falls below the true count; it exceeds it by at most ~e/width of the
+ * total added, with probability 1 - e^-DEPTH. Conservative update (each
+ * row is raised only as far as the new minimum) keeps the overestimate
+ * well below that bound on skewed data such as n-gram counts.
+ */
+class CountMinSketch {
+public:
+    static constexpr size_t DEPTH = 4;
+
+    explicit CountMinSketch(uint32_t width_bits = 22) : bits_(width_bits) {
+        if (width_bits < 4 || width_bits > 30) throw std::invalid_argument("CountMinSketch: width_bits must be in [4, 30]");
+        counters_.assign(DEPTH << bits_, 0);
+    }
+
+    /// Adds `count` occurrences of `key`; returns the new estimate
+    uint32_t add(uint64_t key, uint32_t count = 1) {
+        size_t slots[DEPTH];
+        uint32_t est = UINT32_MAX;
+        for (size_t r = 0; r < DEPTH; ++r) {
+            slots[r] = slot(key, r);
+            est = std::min(est, counters_[slots[r]]);
+        }
+        const uint32_t target = count > UINT32_MAX - est ? UINT32_MAX : est + count;
+        for (size_t r = 0; r < DEPTH; ++r) counters_[slots[r]] = std::max(counters_[slots[r]], target);
+        return target;
+    }
+
+    /**
+     * @brief add() for callers on several threads at once
+     *
+     * Each row is raised by `count` atomically (saturating) instead of
+     * conservatively: two threads raising the same minimum would otherwise
+     * both write est + count and lose one of the additions. Estimates stay
+     * upper bounds, if looser ones. Do not mix with add() while others run.
+     */
+    uint32_t add_shared(uint64_t key, uint32_t count = 1) {
+        uint32_t est = UINT32_MAX;
+        for (size_t r = 0; r < DEPTH; ++r) {
+            std::atomic_ref<uint32_t> c(counters_[slot(key, r)]);
+            uint32_t cur = c.load(std::memory_order_relaxed), next;
+            do {
+                next = count > UINT32_MAX - cur ? UINT32_MAX : cur + count;
+            } while (!c.compare_exchange_weak(cur, next, std::memory_order_relaxed));
+            est = std::min(est, next);
+        }
+        return est;
+    }
+
+    uint32_t estimate(uint64_t key) const {
+        uint32_t est = UINT32_MAX;
+        for (size_t r = 0; r < DEPTH; ++r) est = std::min(est, counters_[slot(key, r)]);
+        return est;
+    }
+
+    size_t memory_bytes() const { return counters_.size() * sizeof(uint32_t); }
+
+private:
+    // Row r's column from an independent mix of the key (splitmix64 finalizer)
+    size_t slot(uint64_t key, size_t r) const {
+        uint64_t z = key + 0x9E3779B97F4A7C15ull * (r + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return (r << bits_) | (z >> (64 - bits_));
+    }
+
+    uint32_t bits_;
+    std::vector<uint32_t> counters_;
+};
+
+} // namespace Hartonomous
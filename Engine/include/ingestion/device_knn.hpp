@@ -0,0 +1,86 @@
+/**
+ * @file device_knn.hpp
+ * @brief Brute-force KNN on a GPU through a runtime-loaded plugin
+ *
+ * KnnBackend::Device runs embedding and procedural mining as exact tiled
+ * top-k on a device: keys are uploaded once (or block by block, for
+ * projections that are never materialized on the host), queries stream
+ * through in blocks, and the results come back as BlockedKnnResult rows so
+ * the same edge emitters consume them as the CPU backends' neighbors.
+ *
+ * The plugin implements ingestion/knn_device_abi.h; plugins/knn_cuda
+ * (HARTONOMOUS_KNN_CUDA=ON) is cuBLAS SGEMM with a fused top-k. get() is
+ * nullptr when no plugin loads, its ABI differs or it sees no device, and
+ * callers fall back to HNSW.
+ *
+ *   HARTONOMOUS_KNN_DEVICE_LIB  plugin to dlopen (default libhartonomous_knn_cuda.so; "off" disables)
+ */
+
+#pragma once
+
+#include <ingestion/blocked_knn.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+struct hartonomous_knn_index;
+
+namespace Hartonomous {
+
+class DeviceKnn {
+public:
+    // Keys resident on the device
+    class Index {
+    public:
+        ~Index();
+        Index(const Index&) = delete;
+        Index& operator=(const Index&) = delete;
+
+        // Upload key rows [first, first + count), row-major
+        void set_keys(const float* rows, size_t first, size_t count);
+
+        /**
+         * @brief Top-k keys of `count` row-major query rows
+         *
+         * Same contract as blocked_knn(): similarity >= threshold, best
+         * first; with exclude_self query row r never matches key first + r.
+         */
+        BlockedKnnResult search(const float* queries, size_t count, size_t first, bool exclude_self,
+                                size_t k, float threshold) const;
+
+    private:
+        friend class DeviceKnn;
+        Index(const DeviceKnn& owner, hartonomous_knn_index* handle) : owner_(owner), handle_(handle) {}
+
+        const DeviceKnn& owner_;
+        hartonomous_knn_index* handle_;
+    };
+
+    // The loaded plugin's device, loaded once per process; nullptr if there is none
+    static const DeviceKnn* get();
+
+    const std::string& device_name() const noexcept { return name_; }
+    size_t max_k() const noexcept { return max_k_; }
+
+    // Device storage for rows x dim keys; throws if the device cannot hold them
+    std::unique_ptr<Index> create(size_t rows, size_t dim) const;
+
+    // One-shot: all of K uploaded, every row of Q searched (both row-major)
+    BlockedKnnResult knn(const float* Q, size_t q_rows, const float* K, size_t k_rows, size_t dim,
+                         size_t k, float threshold, bool exclude_self) const;
+
+    ~DeviceKnn();
+    DeviceKnn(const DeviceKnn&) = delete;
+    DeviceKnn& operator=(const DeviceKnn&) = delete;
+
+private:
+    struct Api;
+    DeviceKnn() = default;
+
+    void* library_ = nullptr;
+    std::unique_ptr<Api> api_;
+    std::string name_;
+    size_t max_k_ = 0;
+};
+
+} // namespace Hartonomous
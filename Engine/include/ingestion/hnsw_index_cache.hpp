@@ -0,0 +1,147 @@
+/**
+ * @file hnsw_index_cache.hpp
+ * @brief HNSW indices reused across ModelIngester passes and runs
+ *
+ * Graph construction dominates model ingest: every tensor of every layer
+ * gets its own index. The cache keys an index by (model, tensor, HnswParams)
+ * plus the shape and a digest of the vectors it holds, keeps built indices
+ * alive while anyone uses them, and persists them with saveIndex so a
+ * re-ingest after a crash, or a re-run with different thresholds, reloads
+ * instead of rebuilding. Search-time parameters (ef_search, k, threshold)
+ * are not part of the key; callers set ef on the index they get back.
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <ingestion/quantized_space.hpp>
+#include <utils/huge_pages.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+struct HnswParams {
+    size_t M = 16;
+    size_t ef_construction = 200;
+    size_t ef_search = 64;
+    HnswQuantization quantization = HnswQuantization::Float32;  // Stored vector encoding
+};
+
+class HnswIndexCache {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+    using Index = hnswlib::HierarchicalNSW<float>;
+
+    struct Options {
+        std::string dir = default_dir();             // Empty disables persistence
+        uint64_t max_disk_bytes = 64ULL << 30;       // Oldest files are evicted past this
+        bool keep_resident = true;                   // Hold the last entry after its users drop it
+
+        // HARTONOMOUS_HNSW_CACHE (directory, "off" to disable), HARTONOMOUS_HNSW_CACHE_GB
+        static Options from_env();
+    };
+
+    struct Key {
+        Hash model_id;
+        std::string tensor;     // Source tensor name, e.g. "model.layers.3.self_attn.v_proj.weight"
+        HnswParams params;      // M, ef_construction and quantization shape the graph
+        size_t rows = 0;
+        size_t dim = 0;
+        Hash content{};         // digest() of the indexed vectors
+    };
+
+    // An index and the space its distance function points into
+    struct Entry {
+        std::unique_ptr<QuantizedIPSpace> space;
+        std::unique_ptr<Index> index;
+        bool from_disk = false;
+
+        bool quantized() const noexcept { return space->quantization() != HnswQuantization::Float32; }
+
+        // Encode and insert one contiguous row of `dim` floats
+        void add_point(const float* v, size_t label);
+
+        // (distance, label) max-heap as hnswlib returns it; distance is 1 - similarity
+        std::priority_queue<std::pair<float, size_t>> search(const float* q, size_t k) const;
+
+        /**
+         * @brief Up to k neighbors of `q` as (label, similarity)
+         *
+         * With `keys` (row-major, row `label` is the indexed vector), a
+         * quantized index over-fetches candidates and re-scores them in
+         * float, so callers see the similarities an unquantized index would
+         * report. Order is unspecified.
+         */
+        void neighbors(const float* q, size_t k, const float* keys,
+                       std::vector<std::pair<size_t, float>>& out) const;
+
+        // How much of level 0 sits in huge pages (HARTONOMOUS_HUGEPAGES, utils/huge_pages.hpp)
+        HugePageUsage huge_page_usage() const;
+    };
+
+    struct Stats {
+        size_t built = 0;
+        size_t loaded = 0;
+        size_t reused = 0;   // Served from memory
+    };
+
+    explicit HnswIndexCache(Options opts = Options::from_env());
+
+    HnswIndexCache(const HnswIndexCache&) = delete;
+    HnswIndexCache& operator=(const HnswIndexCache&) = delete;
+
+    /**
+     * @brief Index for `key`, from memory, disk, or built by `fill`
+     *
+     * `fill` receives an entry with an empty index sized for key.rows and
+     * must add every point with labels 0..rows-1 through add_point(). The
+     * most recently used entry stays resident after the caller drops it,
+     * so back-to-back passes over the same vectors share one index; it is
+     * released before a new build so two large graphs are never held
+     * together. Loads and builds run outside the lock, so threads mining
+     * different tensors build their indices concurrently.
+     */
+    std::shared_ptr<Entry> acquire(const Key& key, const std::function<void(Entry&)>& fill);
+
+    // Drop the resident entry (entries still held by callers stay alive)
+    void release();
+
+    /**
+     * @brief Digest of a column-major matrix, sampling at most ~4096 rows
+     *
+     * Chain a seed to fold in inputs the vectors are derived from.
+     */
+    static Hash digest(const float* data, size_t rows, size_t cols, const Hash& seed = Hash{});
+
+    // $XDG_CACHE_HOME/hartonomous/hnsw, else ~/.cache/hartonomous/hnsw
+    static std::string default_dir();
+
+    // File the key persists to, empty if persistence is off
+    std::string path_for(const Key& key) const;
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    static Hash key_id(const Key& key);
+    void save(Index& index, const std::string& path);
+    void trim_disk();
+
+    Options opts_;
+    mutable std::mutex mutex_;
+    std::unordered_map<Hash, std::weak_ptr<Entry>, HashHasher> live_;
+    std::shared_ptr<Entry> resident_;
+    Stats stats_;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,445 @@
+/**
+ * @file ingest_pipeline.hpp
+ * @brief Staged ingestion pipeline with bounded queues between stages
+ *
+ * Tools describe ingestion as a chain of stages — e.g. parse → decompose →
+ * collect → flush — each with its own worker threads, connected by bounded
+ * lock-free queues. Stages run concurrently, so file I/O, hashing and DB
+ * writes overlap instead of alternating in lockstep phases, and a full queue
+ * throttles everything upstream of the slowest stage.
+ *
+ * Per-stage throughput and per-queue depth are reported while running and
+ * summarised at the end, which shows directly which stage is the bottleneck.
+ */
+
+#pragma once
+
+#include <ingestion/async_flusher.hpp>
+#include <ingestion/ingest_progress.hpp>
+#include <ingestion/substrate_batch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace Hartonomous {
+
+namespace detail {
+
+// Spin briefly, then yield, then sleep: waits in the pipeline are usually
+// short (a neighbour stage finishing one item) but can last seconds when
+// the database is the bottleneck.
+class Backoff {
+public:
+    void pause() {
+        if (n_ < 64) {
+#if defined(__x86_64__) || defined(_M_X64)
+            _mm_pause();
+#endif
+        } else if (n_ < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        ++n_;
+    }
+
+private:
+    unsigned n_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Type-erased view of a pipeline queue, for stats and shutdown.
+ */
+class PipelineQueueBase {
+public:
+    explicit PipelineQueueBase(std::string name) : name_(std::move(name)) {}
+    virtual ~PipelineQueueBase() = default;
+
+    const std::string& name() const { return name_; }
+    virtual size_t size_approx() const = 0;
+    virtual size_t capacity() const = 0;
+    virtual void close() = 0;
+
+    /// Times a producer found the queue full (downstream is slower)
+    size_t full_waits() const { return full_waits_.load(std::memory_order_relaxed); }
+    /// Times a consumer found the queue empty (upstream is slower)
+    size_t empty_waits() const { return empty_waits_.load(std::memory_order_relaxed); }
+
+protected:
+    std::string name_;
+    std::atomic<size_t> full_waits_{0};
+    std::atomic<size_t> empty_waits_{0};
+};
+
+/**
+ * @brief Bounded multi-producer/multi-consumer ring buffer.
+ *
+ * try_push/try_pop are lock-free (per-cell sequence numbers, Vyukov-style).
+ * push/pop wait with backoff. After close(), push fails and pop drains the
+ * remaining items before failing. T must be default-constructible and movable.
+ */
+template <typename T>
+class BoundedQueue : public PipelineQueueBase {
+public:
+    BoundedQueue(std::string name, size_t capacity) : PipelineQueueBase(std::move(name)) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        cells_ = std::make_unique<Cell[]>(cap);
+        for (size_t i = 0; i < cap; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const override { return mask_ + 1; }
+
+    size_t size_approx() const override {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /// Moves from `value` only on success
+    bool try_push(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;  // Full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;  // Empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->value = T{};
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Blocks while full; returns false if the queue was closed
+    bool push(T value) {
+        if (closed_.load(std::memory_order_acquire)) return false;
+        if (try_push(value)) return true;
+        full_waits_.fetch_add(1, std::memory_order_relaxed);
+        detail::Backoff backoff;
+        while (!closed_.load(std::memory_order_acquire)) {
+            if (try_push(value)) return true;
+            backoff.pause();
+        }
+        return false;
+    }
+
+    /// Blocks while empty; returns false once closed and drained
+    bool pop(T& out) {
+        if (try_pop(out)) return true;
+        empty_waits_.fetch_add(1, std::memory_order_relaxed);
+        detail::Backoff backoff;
+        for (;;) {
+            if (try_pop(out)) return true;
+            // Re-check after observing close: an item may have landed in between
+            if (closed_.load(std::memory_order_acquire)) return try_pop(out);
+            backoff.pause();
+        }
+    }
+
+    void close() override { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<bool> closed_{false};
+};
+
+/**
+ * @brief Handle a stage uses to pass items downstream.
+ */
+template <typename T>
+class Emitter {
+public:
+    Emitter(BoundedQueue<T>& queue, std::atomic<size_t>& counter) : queue_(queue), counter_(counter) {}
+
+    /// Returns false if the pipeline is shutting down
+    bool operator()(T value) {
+        counter_.fetch_add(1, std::memory_order_relaxed);
+        return queue_.push(std::move(value));
+    }
+
+private:
+    BoundedQueue<T>& queue_;
+    std::atomic<size_t>& counter_;
+};
+
+/**
+ * @brief A set of stages and the queues between them.
+ *
+ * Queues and stages are owned by the pipeline; build the graph, then call
+ * run() once. A stage's output queue is closed when its last worker exits,
+ * so shutdown cascades downstream. If any stage throws, every queue is
+ * closed and run() rethrows the first exception after all threads join.
+ */
+class IngestPipeline {
+public:
+    struct StageStats {
+        std::string name;
+        size_t threads = 0;
+        std::atomic<size_t> items_in{0};
+        std::atomic<size_t> items_out{0};
+        std::atomic<uint64_t> busy_ns{0};
+        bool source = false;
+
+        /// Items processed so far (emitted, for a source)
+        size_t items() const { return source ? items_out.load() : items_in.load(); }
+    };
+
+    IngestPipeline() = default;
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    template <typename T>
+    BoundedQueue<T>& make_queue(const std::string& name, size_t capacity) {
+        auto q = std::make_unique<BoundedQueue<T>>(name, capacity);
+        auto& ref = *q;
+        queues_.push_back(std::move(q));
+        return ref;
+    }
+
+    /**
+     * @brief Single-threaded producer: fn(Emitter<Out>&) runs until its input is exhausted.
+     */
+    template <typename Out, typename Fn>
+    void add_source(const std::string& name, BoundedQueue<Out>& out, Fn fn) {
+        auto& st = add_stats(name, 1);
+        st.source = true;
+        add_workers(st, 1, &out, [this, &st, &out, fn]() mutable {
+            Emitter<Out> emit(out, st.items_out);
+            auto t0 = std::chrono::steady_clock::now();
+            fn(emit);
+            st.busy_ns += elapsed_ns(t0);
+        });
+    }
+
+    /**
+     * @brief Transform stage: fn(In&, Emitter<Out>&) per item, on `threads` workers.
+     *
+     * `finish`, if given, runs on each worker once its input is drained — for
+     * stages that accumulate across items and must emit the remainder.
+     */
+    template <typename In, typename Out, typename Fn>
+    void add_stage(const std::string& name, size_t threads, BoundedQueue<In>& in, BoundedQueue<Out>& out, Fn fn,
+                   std::type_identity_t<std::function<void(Emitter<Out>&)>> finish = {}) {
+        auto& st = add_stats(name, threads);
+        add_workers(st, threads, &out, [&st, &in, &out, fn, finish]() mutable {
+            Emitter<Out> emit(out, st.items_out);
+            In item;
+            while (in.pop(item)) {
+                st.items_in.fetch_add(1, std::memory_order_relaxed);
+                auto t0 = std::chrono::steady_clock::now();
+                fn(item, emit);
+                st.busy_ns += elapsed_ns(t0);
+            }
+            if (finish) finish(emit);
+        });
+    }
+
+    /**
+     * @brief Terminal stage: fn(In&) per item, on `threads` workers.
+     */
+    template <typename In, typename Fn>
+    void add_sink(const std::string& name, size_t threads, BoundedQueue<In>& in, Fn fn) {
+        auto& st = add_stats(name, threads);
+        add_workers(st, threads, nullptr, [&st, &in, fn]() mutable {
+            In item;
+            while (in.pop(item)) {
+                st.items_in.fetch_add(1, std::memory_order_relaxed);
+                auto t0 = std::chrono::steady_clock::now();
+                fn(item);
+                st.busy_ns += elapsed_ns(t0);
+            }
+        });
+    }
+
+    /**
+     * @brief Start every stage and block until all have finished.
+     * @param report_interval_sec Print a progress line this often (0 = only the final summary)
+     */
+    void run(double report_interval_sec = 10.0) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto& w : workers_) threads.emplace_back(w);
+
+        std::thread reporter;
+        std::mutex report_mutex;
+        std::condition_variable report_cv;
+        bool done = false;
+        if (report_interval_sec > 0) {
+            reporter = std::thread([&]() {
+                auto interval = std::chrono::duration<double>(report_interval_sec);
+                std::unique_lock<std::mutex> lock(report_mutex);
+                while (!report_cv.wait_for(lock, interval, [&] { return done; }))
+                    print_progress(std::cout, start);
+            });
+        }
+
+        for (auto& t : threads) t.join();
+        if (reporter.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(report_mutex);
+                done = true;
+            }
+            report_cv.notify_all();
+            reporter.join();
+        }
+
+        print_summary(std::cout, start);
+        if (error_) std::rethrow_exception(error_);
+    }
+
+    const std::vector<std::unique_ptr<StageStats>>& stages() const { return stages_; }
+
+private:
+    static uint64_t elapsed_ns(std::chrono::steady_clock::time_point t0) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+    }
+
+    StageStats& add_stats(const std::string& name, size_t threads) {
+        auto st = std::make_unique<StageStats>();
+        st->name = name;
+        st->threads = std::max<size_t>(1, threads);
+        auto& ref = *st;
+        stages_.push_back(std::move(st));
+        return ref;
+    }
+
+    // Wraps each worker body so the last one out closes the stage's output
+    template <typename Body>
+    void add_workers(StageStats& st, size_t threads, PipelineQueueBase* out, Body body) {
+        threads = std::max<size_t>(1, threads);
+        auto remaining = std::make_shared<std::atomic<size_t>>(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, &st, out, remaining, body]() mutable {
+                try {
+                    body();
+                } catch (...) {
+                    {
+                        std::lock_guard<std::mutex> lock(error_mutex_);
+                        if (!error_) error_ = std::current_exception();
+                    }
+                    std::cerr << "\n[ERROR] Pipeline stage '" << st.name << "' failed" << std::endl;
+                    for (auto& q : queues_) q->close();
+                }
+                if (remaining->fetch_sub(1) == 1 && out) out->close();
+            });
+        }
+    }
+
+    // Formatted into a local stream so the caller's stream flags are untouched
+    void print_progress(std::ostream& os, std::chrono::steady_clock::time_point start) const {
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::ostringstream line;
+        line << "  [pipeline " << std::fixed << std::setprecision(0) << sec << "s]";
+        for (const auto& st : stages_)
+            line << " " << st->name << " " << st->items();
+        for (const auto& q : queues_)
+            line << " | " << q->name() << " " << q->size_approx() << "/" << q->capacity();
+        os << line.str() << std::endl;
+    }
+
+    void print_summary(std::ostream& os, std::chrono::steady_clock::time_point start) const {
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << "  [pipeline] " << sec << "s wall\n";
+        for (const auto& st : stages_) {
+            size_t items = st->items();
+            // Utilisation near 100% marks the stage that bounds throughput
+            double util = sec > 0 ? (st->busy_ns.load() * 1e-9) / (sec * st->threads) * 100.0 : 0.0;
+            out << "    stage " << std::left << std::setw(12) << st->name << std::right
+                << " x" << st->threads << "  " << items << " items  "
+                << std::setprecision(1) << (sec > 0 ? items / sec : 0.0) << "/s  "
+                << util << "% busy\n";
+        }
+        for (const auto& q : queues_) {
+            out << "    queue " << std::left << std::setw(12) << q->name() << std::right
+                << " cap " << q->capacity() << "  full waits " << q->full_waits()
+                << "  empty waits " << q->empty_waits() << "\n";
+        }
+        os << out.str() << std::flush;
+    }
+
+    std::vector<std::unique_ptr<PipelineQueueBase>> queues_;
+    std::vector<std::unique_ptr<StageStats>> stages_;
+    std::vector<std::function<void()>> workers_;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Terminal stage that hands batches to an AsyncFlusher.
+ *
+ * The flusher keeps its own DB workers; this stage only blocks on its
+ * backpressure, so its busy share measures time spent waiting on the database.
+ * With `progress`, each batch's records count as emitted once queued; the
+ * source advances the bytes it has read.
+ */
+inline void add_flush_stage(IngestPipeline& pipeline, BoundedQueue<std::unique_ptr<SubstrateBatch>>& in,
+                            AsyncFlusher& flusher, ProgressReporter* progress = nullptr) {
+    pipeline.add_sink("flush", 1, in, [&flusher, progress](std::unique_ptr<SubstrateBatch>& batch) {
+        if (!batch || batch->empty()) return;
+        const size_t records = batch->record_count();
+        flusher.enqueue(std::move(batch));
+        if (progress) progress->advance(0, records);
+    });
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,163 @@
+/**
+ * @file ingest_progress.hpp
+ * @brief Live progress of a long ingestion: phase, bytes, records, throughput, ETA
+ *
+ * Ingesters announce each phase with the work it covers in bytes (text
+ * bytes for text, tensor bytes for model passes) and advance() as they
+ * finish pieces of it, with the records emitted for those pieces. Any
+ * thread may advance; at most one callback runs at a time, and advance()
+ * calls it at most once per interval, so progress costs two atomic adds
+ * per piece and a clock read. Phase changes and the end of a run always
+ * report. snapshot() may be polled from another thread.
+ *
+ * Rates and ETA are for the current phase: its bytes so far over its
+ * elapsed time, and the bytes left at that rate.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace Hartonomous {
+
+struct IngestProgress {
+    std::string phase;
+    uint64_t bytes_done = 0;        // Within the phase
+    uint64_t bytes_total = 0;       // Within the phase; 0 when unknown
+    uint64_t records = 0;           // Since the run began
+    double elapsed_sec = 0.0;       // Since the phase began
+    double bytes_per_sec = 0.0;
+    double records_per_sec = 0.0;   // Within the phase
+    double eta_sec = -1.0;          // Rest of the phase; -1 when unknown
+    bool finished = false;
+};
+
+using IngestProgressCallback = std::function<void(const IngestProgress&)>;
+
+// One line for CLI output: "[progress] stream 45.2% of 1024 MB, 12.3 MB/s, 15200 records (1520/s), ETA 3m12s"
+inline std::string describe(const IngestProgress& p) {
+    char buf[256];
+    int n = std::snprintf(buf, sizeof(buf), "[progress] %s", p.phase.c_str());
+    auto append = [&](auto... args) {
+        if (n >= 0 && static_cast<size_t>(n) < sizeof(buf)) n += std::snprintf(buf + n, sizeof(buf) - n, args...);
+    };
+    const double mb = 1.0 / (1 << 20);
+    if (p.bytes_total > 0)
+        append(" %.1f%% of %.0f MB", 100.0 * p.bytes_done / p.bytes_total, p.bytes_total * mb);
+    else
+        append(" %.0f MB", p.bytes_done * mb);
+    append(", %.1f MB/s, %llu records (%.0f/s)", p.bytes_per_sec * mb,
+           static_cast<unsigned long long>(p.records), p.records_per_sec);
+    if (p.finished) append(", done");
+    else if (p.eta_sec >= 0) {
+        const auto eta = static_cast<long long>(p.eta_sec + 0.5);
+        if (eta >= 3600) append(", ETA %lldh%02lldm", eta / 3600, eta / 60 % 60);
+        else append(", ETA %lldm%02llds", eta / 60, eta % 60);
+    }
+    return buf;
+}
+
+class ProgressReporter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ProgressReporter() = default;
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    void set_callback(IngestProgressCallback callback,
+                      std::chrono::milliseconds interval = std::chrono::milliseconds(500)) {
+        std::lock_guard<std::mutex> lock(callback_mu_);
+        callback_ = std::move(callback);
+        interval_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count(),
+                           std::memory_order_relaxed);
+    }
+
+    // Start a phase covering bytes_total bytes (0: unknown); a finished run restarts its record count
+    void phase(std::string name, uint64_t bytes_total = 0) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (finished_) {
+                records_.store(0, std::memory_order_relaxed);
+                finished_ = false;
+            }
+            phase_ = std::move(name);
+            bytes_total_ = bytes_total;
+            phase_start_ = Clock::now();
+            phase_records_ = records_.load(std::memory_order_relaxed);
+            bytes_.store(0, std::memory_order_relaxed);
+        }
+        report(true);
+    }
+
+    void advance(uint64_t bytes, uint64_t records = 0) {
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        if (records) records_.fetch_add(records, std::memory_order_relaxed);
+        report(false);
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            finished_ = true;
+        }
+        report(true);
+    }
+
+    IngestProgress snapshot() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        IngestProgress p;
+        p.phase = phase_;
+        p.bytes_done = bytes_.load(std::memory_order_relaxed);
+        p.bytes_total = bytes_total_;
+        p.records = records_.load(std::memory_order_relaxed);
+        p.finished = finished_;
+        p.elapsed_sec = phase_start_ == Clock::time_point{} ? 0.0
+            : std::chrono::duration<double>(Clock::now() - phase_start_).count();
+        if (p.elapsed_sec > 0) {
+            p.bytes_per_sec = p.bytes_done / p.elapsed_sec;
+            p.records_per_sec = (p.records - phase_records_) / p.elapsed_sec;
+        }
+        if (p.finished) p.eta_sec = 0.0;
+        else if (p.bytes_total > 0 && p.bytes_per_sec > 0)
+            p.eta_sec = p.bytes_done >= p.bytes_total ? 0.0 : (p.bytes_total - p.bytes_done) / p.bytes_per_sec;
+        return p;
+    }
+
+private:
+    void report(bool force) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+        const int64_t next = now + interval_ns_.load(std::memory_order_relaxed);
+        if (!force) {
+            int64_t due = next_report_.load(std::memory_order_relaxed);
+            if (now < due || !next_report_.compare_exchange_strong(due, next, std::memory_order_relaxed)) return;
+        }
+        std::lock_guard<std::mutex> lock(callback_mu_);
+        if (!callback_) return;
+        if (force) next_report_.store(next, std::memory_order_relaxed);
+        callback_(snapshot());
+    }
+
+    mutable std::mutex mu_;
+    std::string phase_;
+    uint64_t bytes_total_ = 0;
+    uint64_t phase_records_ = 0;
+    Clock::time_point phase_start_{};
+    bool finished_ = false;
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> records_{0};
+
+    std::mutex callback_mu_;
+    IngestProgressCallback callback_;
+    std::atomic<int64_t> interval_ns_{500'000'000};
+    std::atomic<int64_t> next_report_{0};
+};
+
+} // namespace Hartonomous
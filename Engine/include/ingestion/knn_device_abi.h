@@ -0,0 +1,67 @@
+/**
+ * @file knn_device_abi.h
+ * @brief C interface between the engine and a device KNN plugin
+ *
+ * engine_io never links a GPU runtime. DeviceKnn (device_knn.hpp) dlopens a
+ * plugin exporting these symbols, such as plugins/knn_cuda (cuBLAS GEMM
+ * tiles with a fused top-k), and falls back to the CPU backends when none
+ * loads or it reports no device.
+ *
+ * Matrices are row-major float32, rows unit-normalized; similarity is the
+ * inner product. Functions returning int give 0 on success and -1 after
+ * writing a message into err (err_len bytes, NUL-terminated).
+ */
+
+#ifndef HARTONOMOUS_KNN_DEVICE_ABI_H
+#define HARTONOMOUS_KNN_DEVICE_ABI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HARTONOMOUS_KNN_ABI_VERSION 1
+
+/* Entries past a row's found count hold this index */
+#define HARTONOMOUS_KNN_NO_INDEX 0xFFFFFFFFu
+
+typedef struct hartonomous_knn_index hartonomous_knn_index;
+
+int hartonomous_knn_abi_version(void);
+
+/* Usable devices; 0 when the runtime is present but sees none */
+int hartonomous_knn_device_count(void);
+
+/* Name of the device indexes are created on */
+int hartonomous_knn_device_name(char* out, size_t len);
+
+/* Largest k hartonomous_knn_search accepts */
+size_t hartonomous_knn_max_k(void);
+
+/* Device storage for `rows` key vectors of `dim` floats; NULL on failure */
+hartonomous_knn_index* hartonomous_knn_create(size_t rows, size_t dim, char* err, size_t err_len);
+
+/* Upload key rows [first, first + count) */
+int hartonomous_knn_set_keys(hartonomous_knn_index* index, const float* keys, size_t first, size_t count,
+                             char* err, size_t err_len);
+
+/*
+ * For each of `count` query rows, the k keys of highest similarity at or
+ * above threshold, best first: index and similarity are count * k, found
+ * holds each row's valid entries. Query row r is key row first + r for
+ * exclude_self, which then never matches itself.
+ */
+int hartonomous_knn_search(const hartonomous_knn_index* index, const float* queries, size_t count, size_t first,
+                           int exclude_self, size_t k, float threshold,
+                           uint32_t* neighbor, float* similarity, uint32_t* found,
+                           char* err, size_t err_len);
+
+void hartonomous_knn_destroy(hartonomous_knn_index* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HARTONOMOUS_KNN_DEVICE_ABI_H */
@@ -0,0 +1,83 @@
+/**
+ * @file model_checkpoint.hpp
+ * @brief Resumable model ingestion: a manifest of units already in the database
+ *
+ * A model ingest is a sequence of independent units: the vocab
+ * compositions, the embedding pass, and one (layer, projection) pass per
+ * weight tensor. The manifest records each unit once everything it wrote
+ * has committed, so a run restarted after a crash skips finished units
+ * instead of recomputing them and re-sending relations the database would
+ * discard and ratings it would count twice.
+ *
+ * Layer passes hand their records to an AsyncFlusher; such a unit is first
+ * mined() with the id of its last batch and only becomes done once the
+ * flusher's flushed_through() reaches it. The manifest is keyed by the
+ * ingesting model's content ID and invalidated by a fingerprint of the
+ * package files and of every setting that changes what is mined. A run
+ * that finishes removes it, so a deliberate re-ingest starts from scratch.
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class ModelCheckpoint {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    struct Options {
+        std::string dir = default_dir();   // Empty disables checkpoints
+
+        // HARTONOMOUS_MODEL_CHECKPOINT (directory, "off" to disable)
+        static Options from_env();
+    };
+
+    ModelCheckpoint() = default;
+
+    // Load the manifest of `model` if its fingerprint matches, else start an empty one
+    void open(const Options& opts, const Hash& model, const Hash& fingerprint);
+
+    bool enabled() const noexcept { return !path_.empty(); }
+    const std::string& path() const noexcept { return path_; }
+
+    bool done(const std::string& unit) const;
+    size_t done_count() const;
+
+    // A unit committed synchronously
+    void complete(const std::string& unit);
+
+    // A unit whose records went to a flusher up to batch id `last_batch`
+    void mined(const std::string& unit, uint64_t last_batch);
+
+    // Promote mined units now covered by the flusher's high-water mark
+    void flushed(uint64_t flushed_through);
+
+    // No mined unit is waiting on a flush
+    bool settled() const;
+
+    // The run finished: nothing left to resume
+    void clear();
+
+    // $XDG_CACHE_HOME/hartonomous/checkpoints, else ~/.cache/hartonomous/checkpoints
+    static std::string default_dir();
+
+private:
+    void save();   // mutex_ held
+
+    std::string path_;
+    Hash fingerprint_{};
+    mutable std::mutex mutex_;
+    std::set<std::string> done_;
+    std::vector<std::pair<std::string, uint64_t>> pending_;
+};
+
+} // namespace Hartonomous
@@ -10,18 +10,31 @@
  * Model ingestion pipeline:
  * 1. Vocab tokens → Compositions (same pipeline as text ingestion)
  * 2. Embedding KNN → Relations with ELO (model opinions, lower than observed text)
+ * 3. Layer mining → one KNN pass per (layer, projection)
+ *
+ * Each finished unit is checkpointed (model_checkpoint.hpp), so a run that
+ * dies part-way resumes where it stopped.
  */
 
 #pragma once
 
 #include <hashing/blake3_pipeline.hpp>
+#include <hashing/hash_table_128.hpp>
 #include <database/postgres_connection.hpp>
 #include <storage/physicality_store.hpp>
 #include <storage/relation_store.hpp>
 #include <storage/relation_evidence_store.hpp>
 #include <ingestion/safetensor_loader.hpp>
+#include <ingestion/hnsw_index_cache.hpp>
+#include <ingestion/blocked_knn.hpp>
+#include <ingestion/ingest_progress.hpp>
+#include <ingestion/model_checkpoint.hpp>
+#include <ingestion/tensor_dedup.hpp>
+#include <ingestion/substrate_cache.hpp>
+#include <utils/memory_governor.hpp>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -36,11 +49,33 @@ struct ThreadLocalRecords {
     std::vector<PhysicalityRecord> phys;
     std::vector<RelationRecord> rel;
     std::vector<RelationSequenceRecord> rel_seq;
-    std::vector<RelationRatingRecord> rating;
+    std::vector<RelationRatingRecord> rating;   // One per relation; repeat hits are merged in
     std::vector<RelationEvidenceRecord> ev;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> phys_seen;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> rel_seen;
+    HashSet128 phys_seen;
+    HashMap128<uint32_t> rel_rating;           // Relation id -> its entry in `rating`
     size_t relations_created = 0;
+
+    // Room for `edges` accepted neighbors, so emission does not regrow the buffers
+    void reserve(size_t edges) {
+        phys.reserve(edges);
+        rel.reserve(edges);
+        rel_seq.reserve(2 * edges);
+        rating.reserve(edges);
+        ev.reserve(edges);
+    }
+};
+
+// One weight-projection KNN pass of a layer (Q*K, V, O, gate, up or down)
+struct ProjectionPass {
+    const TensorData* weight = nullptr;        // Its projection is indexed
+    const TensorData* query_weight = nullptr;  // Asymmetric queries (Q of Q*K), else self-similarity
+    const TensorData* prev_weight = nullptr;   // Same tensors one layer back, for the skip check
+    const TensorData* prev_query = nullptr;
+    const char* name = "";                     // Short label for progress output
+    const char* type_tag = "";
+    double base_elo = 1500.0;
+    const HnswParams* params = nullptr;
+    bool sigmoid = false;                      // Gate activations are mined post-sigmoid
 };
 
 struct ModelIngestionStats {
@@ -54,12 +89,6 @@ struct ModelIngestionStats {
     size_t atoms_created = 0;
 };
 
-struct HnswParams {
-    size_t M = 16;
-    size_t ef_construction = 200;
-    size_t ef_search = 64;
-};
-
 struct ModelIngestionConfig {
     BLAKE3Pipeline::Hash tenant_id;
     BLAKE3Pipeline::Hash user_id;
@@ -67,10 +96,30 @@ struct ModelIngestionConfig {
     size_t max_neighbors_per_token = 64;           // Max neighbors to extract per token
     size_t db_batch_size = 100000;                 // Records per DB batch
 
+    // Embedding-pass neighbor search. BlockedGEMM is exact and usually faster
+    // up to ~150k tokens; HNSW scales past that. Device moves the embedding
+    // and every procedural pass to a GPU when one is present.
+    KnnBackend knn_backend = KnnBackend::HNSW;
+
     // HNSW parameter presets per search type
     HnswParams hnsw_embedding{16, 200, 128};   // High quality baseline (k=64, threshold=0.4)
     HnswParams hnsw_self_sim{12, 100, 64};     // Symmetric search (V, O, gate, up, down)
     HnswParams hnsw_asymmetric{16, 150, 80};   // Asymmetric search (Q*K attention)
+
+    // Where built indices persist between runs
+    HnswIndexCache::Options hnsw_cache = HnswIndexCache::Options::from_env();
+
+    // Where the manifest of finished units lives until the run completes
+    ModelCheckpoint::Options checkpoint = ModelCheckpoint::Options::from_env();
+
+    // Passes whose tensors another model already mined under the same
+    // vocab, embeddings and settings are skipped
+    TensorDedup::Options tensor_dedup = TensorDedup::Options::from_env();
+
+    // Layer mining runs (layer, projection) passes concurrently within this
+    // many bytes; 0 uses three quarters of physical memory. Each pass's
+    // relations go to an AsyncFlusher and its tensors are released when done.
+    size_t memory_budget_bytes = 0;
 };
 
 class ModelIngester {
@@ -79,14 +128,20 @@ public:
 
     ModelIngestionStats ingest_package(const std::filesystem::path& package_dir);
 
+    // Phases: "vocab" (token bytes), "embedding_knn" (embedding bytes), "layer_mining" (weight bytes per pass)
+    void set_progress(ProgressReporter* progress) { progress_ = progress; }
+
 private:
     PostgresConnection& db_;
     ModelIngestionConfig config_;
+    ProgressReporter* progress_ = nullptr;
     BLAKE3Pipeline::Hash model_id_;
 
+    // Maps tokens to compositions; `store` writes them (false when a resumed run already has)
     std::unordered_map<std::string, BLAKE3Pipeline::Hash> ingest_vocab_as_text(
         const std::vector<std::string>& vocab,
-        ModelIngestionStats& stats
+        ModelIngestionStats& stats,
+        bool store = true
     );
 
     void extract_embedding_edges(
@@ -96,10 +151,12 @@ private:
         ModelIngestionStats& stats
     );
 
+    // Q and K are the same matrix (same data pointer) for self-similarity passes
     void extract_procedural_knn(
         const std::vector<std::string>& vocab,
-        const Eigen::MatrixXf& Q,
-        const Eigen::MatrixXf& K,
+        const Eigen::Ref<const Eigen::MatrixXf>& Q,
+        const Eigen::Ref<const Eigen::MatrixXf>& K,
+        const std::string& index_tensor,
         const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
         ModelIngestionStats& stats,
         double base_elo,
@@ -114,6 +171,7 @@ private:
         const std::vector<std::string>& vocab,
         const Eigen::MatrixXf& norm_embeddings,
         const Eigen::MatrixXf& W,
+        const std::string& index_tensor,
         const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
         ModelIngestionStats& stats,
         double base_elo,
@@ -125,11 +183,53 @@ private:
         std::vector<ThreadLocalRecords>* out_records = nullptr
     );
 
+    // Mine one pass into `out`; false if it was skipped as a near-copy of
+    // the previous layer's
+    bool mine_pass(
+        const ProjectionPass& pass,
+        const std::vector<std::string>& vocab,
+        const Eigen::MatrixXf& norm_embeddings,
+        const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
+        ModelIngestionStats& stats,
+        int layer_index,
+        int total_layers,
+        bool use_layer_sim,
+        bool stream,
+        std::vector<ThreadLocalRecords>& out
+    );
+
+    // Schedule every layer's passes across the cores within memory_budget_bytes
+    void mine_layers(
+        const std::vector<AttentionLayer>& attn_layers,
+        const std::vector<FFNLayer>& ffn_layers,
+        const std::vector<std::string>& vocab,
+        const Eigen::MatrixXf& norm_embeddings,
+        const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
+        ModelIngestionStats& stats,
+        bool use_layer_sim
+    );
+
+    // Append one row's accepted (target, similarity) neighbors to `tl`: a rating
+    // each, and the relation with its geometry and rows only from the first
+    // thread of any pass to claim it in relations_emitted_; returns the new
+    // relations. Relation IDs and new Hilbert indices of the row are each
+    // computed in one batch.
+    size_t emit_edges(ThreadLocalRecords& tl, const BLAKE3Pipeline::Hash& scid,
+                      const std::vector<std::pair<const BLAKE3Pipeline::Hash*, float>>& targets,
+                      double base_elo, double elo_range, std::string_view type_tag, int32_t layer) const;
+
     static double weight_similarity(const TensorData* a, const TensorData* b);
 
     std::unordered_map<BLAKE3Pipeline::Hash, Eigen::Vector4d, HashHasher> comp_centroids_;
-    Eigen::MatrixXf proj_workspace_a_;  // Reused for K or self-sim projections
-    Eigen::MatrixXf proj_workspace_b_;  // Reused for Q in asymmetric case
+    // Pinned: edge emission reads the centroids from every thread
+    MemoryGovernor::Account centroids_account_ =
+        MemoryGovernor::global().enroll("model_centroids", MemoryGovernor::Priority::Pinned);
+    HnswIndexCache hnsw_cache_;
+    ModelCheckpoint checkpoint_;
+    TensorDedup dedup_;
+    // Relations whose rows this ingest_package() has emitted, across passes and threads
+    mutable ShardedSet<BLAKE3Pipeline::Hash, HashHasher, 6, HashSet128> relations_emitted_;
+    BLAKE3Pipeline::Hash embedding_digest_{};  // Seeds digests of streamed projections
 };
 
 } // namespace Hartonomous
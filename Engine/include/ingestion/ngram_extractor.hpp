@@ -17,18 +17,113 @@
 #include <cstdint>
 #include <cmath>
 #include <cstring>
+#include <iterator>
+#include <memory>
 
 namespace Hartonomous {
 
+/**
+ * @brief Occurrence positions of one n-gram, in one of two compact forms
+ *
+ * Encoded: the sorted positions as LEB128 varints of the gaps between them,
+ * so frequent n-grams cost a byte or two per occurrence instead of four.
+ * Interval: the n-gram's run [first, first + size) of the suffix array;
+ * positions come out in SA order, not text order, and nothing is stored per
+ * occurrence.
+ *
+ * All lists of one extraction share a single PositionStore, so a list is a
+ * reference, a pointer and a count with no allocation of its own. The list
+ * is read through a forward iterator.
+ */
+struct PositionStore {
+    std::vector<uint32_t> sa;                  // Interval mode
+    std::vector<std::vector<uint8_t>> blocks;  // Encoded mode; never reallocated once filled
+
+    // Appends the ascending positions [begin, end); returns where they start
+    const uint8_t* encode(const uint32_t* begin, const uint32_t* end);
+};
+
+class PositionList {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        iterator() = default;
+        uint32_t operator*() const { return value_; }
+        iterator& operator++() {
+            if (--remaining_ > 0) {
+                if (sa_) value_ = *++sa_;
+                else value_ += decode();
+            }
+            return *this;
+        }
+        iterator operator++(int) { iterator t = *this; ++*this; return t; }
+        bool operator==(const iterator& o) const { return remaining_ == o.remaining_; }
+
+    private:
+        friend class PositionList;
+        iterator(const uint32_t* sa, const uint8_t* bytes, uint32_t remaining)
+            : sa_(sa), p_(bytes), remaining_(remaining) {
+            if (remaining_ == 0) return;
+            value_ = sa_ ? *sa_ : decode();
+        }
+        uint32_t decode() {
+            uint32_t v = 0;
+            for (int shift = 0;; shift += 7) {
+                uint8_t b = *p_++;
+                v |= uint32_t(b & 0x7F) << shift;
+                if (!(b & 0x80)) return v;
+            }
+        }
+
+        const uint32_t* sa_ = nullptr;
+        const uint8_t* p_ = nullptr;
+        uint32_t value_ = 0;
+        uint32_t remaining_ = 0;
+    };
+
+    PositionList() = default;
+    PositionList(std::shared_ptr<const PositionStore> store, const uint32_t* sa, uint32_t size)
+        : store_(std::move(store)), data_(sa), size_(size), interval_(true) {}
+    PositionList(std::shared_ptr<const PositionStore> store, const uint8_t* bytes, uint32_t size)
+        : store_(std::move(store)), data_(bytes), size_(size) {}
+
+    iterator begin() const {
+        if (interval_) return {static_cast<const uint32_t*>(data_), nullptr, size_};
+        return {nullptr, static_cast<const uint8_t*>(data_), size_};
+    }
+    iterator end() const { return {}; }
+    uint32_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool sorted() const { return !interval_ || size_ < 2; }
+    std::vector<uint32_t> to_vector() const { return {begin(), end()}; }
+
+private:
+    std::shared_ptr<const PositionStore> store_;  // Keeps data_ alive
+    const void* data_ = nullptr;
+    uint32_t size_ = 0;
+    bool interval_ = false;
+};
+
+enum class PositionStorage {
+    Encoded,   // Sorted and gap-encoded; the SA is freed after extract()
+    Interval   // SA intervals; the SA lives as long as any n-gram referencing it
+};
+
 /**
  * @brief A discovered composition: repeated substring with statistics
  */
 struct NGram {
     std::u32string text;
-    BLAKE3Pipeline::Hash hash;
+    BLAKE3Pipeline::Hash hash{};      // BLAKE3 of the codepoints; set only for significant n-grams
     uint32_t n;                       // Length in codepoints
     uint32_t frequency = 0;
-    std::vector<uint32_t> positions;  // Sorted positions in text where this appears
+    PositionList positions;           // Positions in text where this appears
     
     // Statistical metrics
     double pmi = 0.0;
@@ -49,6 +144,7 @@ struct NGramConfig {
     uint32_t max_n = 256;             // Practical cap, not semantic — SA handles any length
     uint32_t min_frequency = 3;       // Minimum occurrences to be a composition
     bool track_positions = true;
+    PositionStorage position_storage = PositionStorage::Encoded;
     bool track_direction = true;
     
     // Promotion thresholds for multi-codepoint compositions
@@ -67,14 +163,23 @@ struct NGramConfig {
  * Discovers all repeated substrings in text via SA+LCP.
  * No arbitrary n-gram window. No co-occurrence computation.
  * Relations are computed by the caller from position/adjacency data.
+ *
+ * During discovery an n-gram is identified by its SA interval: every
+ * occurrence of a substring of length n is one run of the SA, so (n, first
+ * SA index) names it uniquely and nothing is hashed. Content hashes are
+ * computed at the end, for the n-grams significant_ngrams() returns.
  */
 class NGramExtractor {
 public:
     explicit NGramExtractor(const NGramConfig& config = NGramConfig());
 
+    // (n << 32) | first SA index, valid for the last extract()
+    using NGramId = uint64_t;
+
+    // Replaces the result of any earlier call
     void extract(const std::u32string& text);
 
-    const std::unordered_map<BLAKE3Pipeline::Hash, NGram, HashHasher>& ngrams() const { return ngrams_; }
+    const std::unordered_map<NGramId, NGram>& ngrams() const { return ngrams_; }
     std::vector<const NGram*> significant_ngrams() const;
 
     void clear();
@@ -84,15 +189,12 @@ public:
 
 private:
     NGramConfig config_;
-    std::unordered_map<BLAKE3Pipeline::Hash, NGram, HashHasher> ngrams_;
-    
-    std::unordered_map<BLAKE3Pipeline::Hash, std::unordered_map<char32_t, uint32_t>, HashHasher> left_context_;
-    std::unordered_map<BLAKE3Pipeline::Hash, std::unordered_map<char32_t, uint32_t>, HashHasher> right_context_;
+    std::unordered_map<NGramId, NGram> ngrams_;
 
     uint64_t total_unigrams_ = 0;
 
-    void finalize_metrics();
-    double calculate_entropy(const std::unordered_map<char32_t, uint32_t>& counts, uint32_t total);
+    bool is_significant(const NGram& ngram) const;
+    void hash_significant();
     static std::string compute_pattern_signature(const std::u32string& text);
 };
 
@@ -0,0 +1,56 @@
+/**
+ * @file quantized_space.hpp
+ * @brief Inner-product HNSW spaces over float32, FP16 or int8 vectors
+ *
+ * searchKnn over 4096-dim projections is bound by the bytes each distance
+ * pulls from memory. FP16 halves them and int8 (per-vector symmetric scale)
+ * quarters them, at the cost of approximate distances; callers re-rank the
+ * final candidates against the float rows to keep reported similarities
+ * exact. Vectors are padded with zeros to the kernel width so the SIMD loops
+ * have no tail. Kernels are picked at compile time (-march=native): AVX-512
+ * VNNI or AVX2 for int8, F16C+FMA for FP16, scalar otherwise.
+ */
+
+#pragma once
+
+#include <hnswlib/hnswlib.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Hartonomous {
+
+enum class HnswQuantization : uint8_t {
+    Float32,
+    FP16,
+    Int8,
+};
+
+class QuantizedIPSpace : public hnswlib::SpaceInterface<float> {
+public:
+    QuantizedIPSpace(size_t dim, HnswQuantization quantization);
+
+    size_t get_data_size() override { return data_size_; }
+    hnswlib::DISTFUNC<float> get_dist_func() override { return dist_; }
+    void* get_dist_func_param() override;
+
+    size_t dim() const noexcept { return dim_; }
+    HnswQuantization quantization() const noexcept { return quantization_; }
+
+    // Write `dim` floats in the stored encoding; `dst` holds get_data_size() bytes
+    void encode(const float* src, void* dst) const;
+
+    // Scalar half-precision conversions (round to nearest even)
+    static uint16_t float_to_half(float f);
+    static float half_to_float(uint16_t h);
+
+private:
+    size_t dim_;
+    size_t padded_;            // Elements per stored vector, kernel-width multiple
+    size_t data_size_;
+    HnswQuantization quantization_;
+    hnswlib::DISTFUNC<float> dist_;
+    std::unique_ptr<hnswlib::InnerProductSpace> float_space_;  // Float32 reuses hnswlib's kernels
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,148 @@
+/**
+ * @file relation_edge.hpp
+ * @brief Identity and geometry of one composition-pair relation, without heap traffic
+ *
+ * Every ingester that relates two compositions derives the same records: a
+ * relation ID from the unordered pair, a physicality at the normalized
+ * midpoint of their centroids, two sequence rows and an evidence row.
+ * RelationEdge computes them in fixed-size members over stack buffers, so
+ * emitting an edge allocates only what the appended records themselves own.
+ * Callers compute relation_id() first and build the rest only for relations
+ * they have not seen yet.
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <spatial/hilbert_curve_4d.hpp>
+#include <storage/physicality_store.hpp>
+#include <storage/relation_store.hpp>
+#include <storage/relation_evidence_store.hpp>
+#include <Eigen/Core>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Hartonomous {
+
+struct RelationEdge {
+    using Hash = BLAKE3Pipeline::Hash;
+
+    Hash id;
+    Hash physicality_id;
+    Eigen::Vector4d centroid;
+    Eigen::Vector4d trajectory[2];
+    uint32_t trajectory_size = 0;
+    Hash sequence_comp[2];  // Compositions by ordinal
+    Hash sequence_id[2];
+
+    // BLAKE3(0x52 + lower ID + higher ID): the same relation whichever way round
+    static Hash relation_id(const Hash& a, const Hash& b) {
+        bool a_first = std::memcmp(a.data(), b.data(), 16) < 0;
+        uint8_t buf[33];
+        buf[0] = 0x52;
+        std::memcpy(buf + 1, (a_first ? a : b).data(), 16);
+        std::memcpy(buf + 17, (a_first ? b : a).data(), 16);
+        return BLAKE3Pipeline::hash(buf, sizeof(buf));
+    }
+
+    // relation_id(a, *others[i]) for each i, hashed together across SIMD lanes
+    static void relation_ids(const Hash& a, const Hash* const* others, size_t count, Hash* out) {
+        thread_local std::vector<uint8_t> buf;
+        buf.resize(count * 33);
+        for (size_t i = 0; i < count; ++i) {
+            const Hash& b = *others[i];
+            bool a_first = std::memcmp(a.data(), b.data(), 16) < 0;
+            uint8_t* p = buf.data() + i * 33;
+            p[0] = 0x52;
+            std::memcpy(p + 1, (a_first ? a : b).data(), 16);
+            std::memcpy(p + 17, (a_first ? b : a).data(), 16);
+        }
+        BLAKE3Pipeline::hash_many_fixed(buf.data(), 33, 33, count, out);
+    }
+
+    /**
+     * @brief Geometry and sequence IDs of relation `rid` between a and b
+     *
+     * `ca`/`cb` are the compositions' centroids, null when unknown: the
+     * trajectory holds the known ones in argument order, and the midpoint
+     * falls back to +X unless both are known. Sequence ordinals follow the
+     * arguments, or ID order with `sorted_sequence`.
+     */
+    RelationEdge(const Hash& rid, const Hash& a, const Hash& b,
+                 const Eigen::Vector4d* ca, const Eigen::Vector4d* cb, bool sorted_sequence = false)
+        : id(rid) {
+        centroid = Eigen::Vector4d(1, 0, 0, 0);
+        if (ca && cb) {
+            Eigen::Vector4d mid = (*ca + *cb) * 0.5;
+            double nrm = mid.norm();
+            if (nrm > 1e-10) centroid = mid / nrm;
+        }
+        if (ca) trajectory[trajectory_size++] = *ca;
+        if (cb) trajectory[trajectory_size++] = *cb;
+
+        // BLAKE3(0x50 + centroid + trajectory)
+        static_assert(sizeof(Eigen::Vector4d) == sizeof(double) * 4);
+        uint8_t pbuf[1 + 3 * sizeof(double) * 4];
+        pbuf[0] = 0x50;
+        std::memcpy(pbuf + 1, centroid.data(), sizeof(double) * 4);
+        for (uint32_t t = 0; t < trajectory_size; ++t)
+            std::memcpy(pbuf + 1 + (t + 1) * sizeof(double) * 4, trajectory[t].data(), sizeof(double) * 4);
+        physicality_id = BLAKE3Pipeline::hash(pbuf, 1 + (trajectory_size + 1) * sizeof(double) * 4);
+
+        bool swap = sorted_sequence && std::memcmp(b.data(), a.data(), 16) < 0;
+        sequence_comp[0] = swap ? b : a;
+        sequence_comp[1] = swap ? a : b;
+
+        // BLAKE3(0x54 + relation + composition + ordinal)
+        uint8_t sbuf[37];
+        sbuf[0] = 0x54;
+        std::memcpy(sbuf + 1, rid.data(), 16);
+        for (uint32_t ord = 0; ord < 2; ++ord) {
+            std::memcpy(sbuf + 17, sequence_comp[ord].data(), 16);
+            std::memcpy(sbuf + 33, &ord, 4);
+            sequence_id[ord] = BLAKE3Pipeline::hash(sbuf, sizeof(sbuf));
+        }
+    }
+
+    // Without `with_hilbert` the index is left zero for a later encode_hilbert_indices() batch.
+    // Under TrajectoryStorage::Referenced the trajectory is left out: it is the two
+    // compositions' centroids, which the relation's sequence rows already reach
+    PhysicalityRecord physicality(bool with_hilbert = true) const {
+        HilbertIndex hidx{};
+        if (with_hilbert) {
+            Eigen::Vector4d hc = (centroid.array() + 1.0) / 2.0;
+            hidx = hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Relation);
+        }
+        if (trajectory_storage() == TrajectoryStorage::Referenced) return {physicality_id, hidx, centroid, {}};
+        return {physicality_id, hidx, centroid,
+                std::vector<Eigen::Vector4d>(trajectory, trajectory + trajectory_size)};
+    }
+
+    RelationRecord relation() const { return {id, physicality_id}; }
+
+    RelationSequenceRecord sequence(uint32_t ordinal) const {
+        return {sequence_id[ordinal], id, sequence_comp[ordinal], ordinal, 1};
+    }
+
+    // BLAKE3(content + relation)
+    static Hash evidence_id(const Hash& content, const Hash& rid) {
+        uint8_t buf[32];
+        std::memcpy(buf, content.data(), 16);
+        std::memcpy(buf + 16, rid.data(), 16);
+        return BLAKE3Pipeline::hash(buf, sizeof(buf));
+    }
+
+    // BLAKE3(content + relation + tag + layer): evidence from one pass of a model
+    static Hash evidence_id(const Hash& content, const Hash& rid, std::string_view tag, int32_t layer) {
+        BLAKE3Pipeline::Hasher h;
+        h.update(content.data(), 16);
+        h.update(rid.data(), 16);
+        h.update(tag.data(), tag.size());
+        h.update(&layer, sizeof(layer));
+        return h.finalize();
+    }
+};
+
+} // namespace Hartonomous
@@ -3,7 +3,7 @@
  * @brief HuggingFace safetensor model loader
  *
  * Loads safetensor files and extracts:
- * - Model tensors (embeddings, weights)
+ * - Model tensors (embeddings, weights), memory-mapped and converted lazily
  * - Config (model architecture, hyperparams)
  * - Tokenizer (vocab, special tokens)
  */
@@ -33,18 +33,47 @@ struct SafetensorMetadata {
 
 /**
  * @brief Tensor data
+ *
+ * In mapped mode the tensor is a view into the mmap'd safetensor file
+ * (raw pointer + shape + dtype) and `data` stays empty; consumers pull
+ * float32 values through read_rows()/read_all(), which convert one row
+ * block at a time. In eager mode `data` holds the converted float32 copy.
  */
 struct TensorData {
     std::string name;
     std::vector<size_t> shape;
     std::string dtype;
-    std::vector<float> data;  // Converted to float32
+    std::vector<float> data;  // Converted to float32 (eager mode only)
+
+    const uint8_t* raw = nullptr;  // Mapped file bytes (mapped mode only)
+    size_t raw_bytes = 0;
 
     size_t total_elements() const {
         size_t total = 1;
         for (auto dim : shape) total *= dim;
         return total;
     }
+
+    /// Elements per leading-dimension row (1 for scalars and 1D tensors)
+    size_t row_elements() const {
+        size_t total = 1;
+        for (size_t i = 1; i < shape.size(); ++i) total *= shape[i];
+        return total;
+    }
+
+    bool is_mapped() const { return raw != nullptr; }
+
+    /// Convert rows [row_begin, row_begin + row_count) to float32 into out
+    void read_rows(size_t row_begin, size_t row_count, float* out) const;
+
+    /// Convert the whole tensor to float32 into out (total_elements() floats)
+    void read_all(float* out) const;
+
+    /// Single element by flat (row-major) index
+    float at(size_t index) const;
+
+    /// Drop this tensor's mapped pages from the resident set once consumed
+    void release() const;
 };
 
 /**
@@ -76,14 +105,32 @@ struct FFNLayer {
  * - config.json
  * - tokenizer.json / tokenizer_config.json
  * - vocab.txt / vocab.json
+ *
+ * The shards of a sharded model are opened and their headers parsed on all
+ * cores at once. Eager mode then reads every tensor with pread in 4 MB
+ * blocks spread over all cores, across shards, converting each block as it
+ * lands; it never maps the files. F16 and BF16 convert with F16C / AVX-512
+ * or NEON kernels (utils/cpu_dispatch.hpp), and large read_rows() and
+ * read_all() calls split into blocks across threads.
  */
 class SafetensorLoader {
 public:
+
+    enum class LoadMode {
+        Mapped,  // mmap files, convert lazily per row block (default)
+        Eager    // read and convert every tensor up front
+    };
+
     /**
      * @brief Load model from directory
      * @param model_dir Path to model directory
+     * @param mode Mapped keeps peak RSS proportional to the tensors in use
      */
-    explicit SafetensorLoader(const std::string& model_dir);
+    explicit SafetensorLoader(const std::string& model_dir, LoadMode mode = LoadMode::Mapped);
+    ~SafetensorLoader();
+
+    SafetensorLoader(const SafetensorLoader&) = delete;
+    SafetensorLoader& operator=(const SafetensorLoader&) = delete;
 
     /**
      * @brief Get metadata
@@ -132,9 +179,20 @@ private:
     void load_safetensor_file(const std::string& path);
     void load_sharded_model(const std::string& index_path);
 
+    struct Shard;
+    Shard open_shard(const std::string& path) const;
+    void load_shards(const std::vector<std::string>& paths);
+
+    struct MappedFile {
+        const uint8_t* base = nullptr;
+        size_t size = 0;
+    };
+
     std::string model_dir_;
+    LoadMode mode_;
     SafetensorMetadata metadata_;
     std::map<std::string, TensorData> tensors_;
+    std::vector<MappedFile> mappings_;
 };
 
 } // namespace Hartonomous
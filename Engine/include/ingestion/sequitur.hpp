@@ -1,207 +1,113 @@
 /**
  * @file sequitur.hpp
  * @brief Deterministic context-free grammar inference (Sequitur algorithm)
+ *
+ * Sequitur reads a sequence one symbol at a time and keeps a grammar with
+ * two properties: no digram (pair of adjacent symbols) occurs twice, and
+ * every rule but the axiom is used at least twice. A repeated digram becomes
+ * a rule; a rule left with a single use is expanded back in place. The rules
+ * are the text's repeated structure, nested: a rule's body may use others.
+ *
+ * Symbols live in one pool and link by 32-bit index; rules are a guard
+ * symbol and a use count in a second pool. Freed symbols are recycled
+ * through a free list. The digram index is an open-addressing table keyed
+ * by the two symbol values packed into 64 bits.
  */
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
-#include <list>
-#include <memory>
-#include <iostream>
 
 namespace Hartonomous {
 
+/**
+ * @brief A finished grammar in compact form
+ *
+ * Rules are numbered densely with the axiom as rule 0. Rule r's body is
+ * symbols[offsets[r], offsets[r + 1]); a symbol is a terminal codepoint, or
+ * RULE_BIT | rule for a nonterminal.
+ */
+struct Grammar {
+    static constexpr uint32_t RULE_BIT = 0x80000000u;
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> symbols;
+    std::vector<uint64_t> lengths;  // Codepoints each rule expands to
+    std::vector<uint32_t> uses;     // Nonterminals naming each rule (0 for the axiom)
+
+    static bool is_rule(uint32_t symbol) { return symbol & RULE_BIT; }
+    static uint32_t rule_of(uint32_t symbol) { return symbol & ~RULE_BIT; }
+
+    size_t rule_count() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /// Appends rule's full expansion to out
+    void expand(uint32_t rule, std::u32string& out) const;
+};
+
 class Sequitur {
 public:
-    using SymbolID = uint64_t;
-
-    struct Symbol;
-    struct Rule;
-
-    struct Symbol {
-        SymbolID id;
-        Symbol* prev = nullptr;
-        Symbol* next = nullptr;
-        Rule* rule = nullptr; // If this symbol is a non-terminal, points to the Rule it represents
-        
-        bool is_guard = false; 
-
-        Symbol(SymbolID val) : id(val) {}
-        
-        // Helper to check if this symbol is the guard of a rule
-        bool is_guard_node() const { return is_guard; }
-        
-        void insert_after(Symbol* s) {
-            s->prev = this;
-            s->next = next;
-            next->prev = s;
-            next = s;
-        }
-        
-        void remove() {
-            prev->next = next;
-            next->prev = prev;
-            prev = nullptr;
-            next = nullptr;
-        }
-        
-        // Delete digram starting at this symbol from the index
-        void delete_digram(std::unordered_map<std::pair<SymbolID, SymbolID>, Symbol*, struct PairHash>& index);
-        
-        // Check if digram starting here exists
-        bool check_digram(std::unordered_map<std::pair<SymbolID, SymbolID>, Symbol*, struct PairHash>& index, 
-                          std::unordered_map<SymbolID, Rule*>& rules, SymbolID& next_rule_id);
-    };
-
-    struct Rule {
-        SymbolID id;
-        Symbol* guard;
-        size_t count = 0; // Reference count (how many times this rule is used)
-
-        Rule(SymbolID id) : id(id) {
-            guard = new Symbol(0);
-            guard->is_guard = true;
-            guard->rule = this;
-            guard->prev = guard;
-            guard->next = guard;
-        }
-
-        ~Rule() {
-            Symbol* curr = guard->next;
-            while (curr != guard) {
-                Symbol* next = curr->next;
-                delete curr;
-                curr = next;
-            }
-            delete guard;
-        }
-        
-        Symbol* last() const { return guard->prev; }
-        Symbol* first() const { return guard->next; }
-    };
-
-    struct PairHash {
-        size_t operator()(const std::pair<SymbolID, SymbolID>& p) const {
-            return std::hash<SymbolID>{}(p.first) ^ (std::hash<SymbolID>{}(p.second) << 1);
-        }
-    };
-
-    Sequitur() {
-        // Start Rule IDs high to avoid collision with atoms (assuming atoms < 2^63)
-        // Or reserve a range. Let's use high bit for rules?
-        // User requested "Unit Compositions" for atoms.
-        // Let's use separate ID spaces.
-        // Rule 0 is axiom.
-        axiom_ = new Rule(0);
-        rules_[0] = axiom_;
-        next_rule_id_ = 1;
-    }
-
-    ~Sequitur() {
-        for (auto& pair : rules_) {
-            delete pair.second;
-        }
-    }
-
-    void append_terminal(SymbolID atom_id) {
-        Symbol* s = new Symbol(atom_id);
-        axiom_->last()->insert_after(s);
-        s->check_digram(index_, rules_, next_rule_id_);
-    }
-
-    const std::unordered_map<SymbolID, Rule*>& rules() const { return rules_; }
-    Rule* axiom() const { return axiom_; }
+    /// Terminals must be below this (any codepoint is)
+    static constexpr uint32_t MAX_TERMINAL = 0x40000000u;
+
+    /// expected_length sizes the pools and the digram table up front
+    explicit Sequitur(size_t expected_length = 0);
+
+    void append(uint32_t terminal);
+    void append(std::u32string_view text) { for (char32_t c : text) append(c); }
+
+    /// Live rules, including the axiom
+    size_t rule_count() const { return live_rules_; }
+    size_t symbol_count() const { return syms_.size() - free_syms_.size(); }
+    size_t memory_bytes() const;
+
+    Grammar grammar() const;
 
 private:
-    Rule* axiom_;
-    std::unordered_map<SymbolID, Rule*> rules_;
-    SymbolID next_rule_id_;
-    std::unordered_map<std::pair<SymbolID, SymbolID>, Symbol*, PairHash> index_;
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t RULE_BIT = 0x80000000u;
+    static constexpr uint32_t GUARD_BIT = 0x40000000u;
+    static constexpr uint32_t ID_MASK = GUARD_BIT - 1;
+
+    // value: a terminal, RULE_BIT | rule for a nonterminal, GUARD_BIT | rule for a guard
+    struct Symbol { uint32_t prev, next, value; };
+    struct Rule { uint32_t guard, uses; };  // guard == NONE once the rule is gone
+
+    bool is_guard(uint32_t s) const { return (syms_[s].value & (RULE_BIT | GUARD_BIT)) == GUARD_BIT; }
+    bool is_nonterminal(uint32_t s) const { return syms_[s].value & RULE_BIT; }
+    uint32_t rule_of(uint32_t s) const { return syms_[s].value & ID_MASK; }
+    uint32_t first(uint32_t rule) const { return syms_[rules_[rule].guard].next; }
+    uint32_t last(uint32_t rule) const { return syms_[rules_[rule].guard].prev; }
+    uint64_t digram_key(uint32_t s) const { return uint64_t(syms_[s].value) << 32 | syms_[syms_[s].next].value; }
+
+    uint32_t new_symbol(uint32_t value);
+    uint32_t new_rule();
+    void join(uint32_t left, uint32_t right);
+    void insert_after(uint32_t s, uint32_t inserted);
+    void delete_symbol(uint32_t s);
+    void delete_digram(uint32_t s);
+    bool check(uint32_t s);
+    void match(uint32_t s, uint32_t m);
+    void substitute(uint32_t s, uint32_t rule);
+    void expand(uint32_t s);
+
+    // Digram table: slot of key, or the slot to insert it at if absent
+    size_t find_slot(uint64_t key) const;
+    void set_digram(uint32_t s);
+    void grow_table();
+
+    std::vector<Symbol> syms_;
+    std::vector<uint32_t> free_syms_;
+    std::vector<Rule> rules_;
+    size_t live_rules_ = 0;
+
+    static constexpr uint32_t EMPTY = NONE;
+    static constexpr uint32_t DELETED = NONE - 1;
+    std::vector<uint64_t> table_keys_;
+    std::vector<uint32_t> table_syms_;
+    size_t table_used_ = 0;  // Live entries and tombstones
 };
 
-// Implementation inline to avoid linker issues with template/header-only usage or circular deps
-inline void Sequitur::Symbol::delete_digram(std::unordered_map<std::pair<SymbolID, SymbolID>, Symbol*, PairHash>& index) {
-    if (is_guard || next->is_guard) return;
-    auto key = std::make_pair(id, next->id);
-    auto it = index.find(key);
-    if (it != index.end() && it->second == this) {
-        index.erase(it);
-    }
-}
-
-inline bool Sequitur::Symbol::check_digram(std::unordered_map<std::pair<SymbolID, SymbolID>, Symbol*, PairHash>& index,
-                                    std::unordered_map<SymbolID, Rule*>& rules, SymbolID& next_rule_id) {
-    if (is_guard || next->is_guard) return false;
-    
-    auto key = std::make_pair(id, next->id);
-    auto it = index.find(key);
-    
-    if (it == index.end()) {
-        index[key] = this;
-        return false;
-    }
-    
-    Symbol* other = it->second;
-    if (other == this) return false; // Same instance
-    
-    // Found duplicate digram
-    
-    // Check if other is part of a rule that matches this pair exactly
-    // (Sequitur Rule Utility constraint)
-    if (other->next->rule && other->prev->is_guard && other->next->next->is_guard) {
-        // Use existing rule
-        Rule* r = other->next->rule;
-        
-        // Remove current pair
-        this->delete_digram(index);
-        if (this->prev && !this->prev->is_guard) this->prev->delete_digram(index); // prev-this digram might change
-        
-        // Replace (this, next) with Rule symbol
-        Symbol* new_sym = new Symbol(r->id);
-        new_sym->rule = r;
-        r->count++;
-        
-        Symbol* p = this->prev;
-        this->remove(); 
-        this->next->remove();
-        // Delete symbols
-        delete this;
-        // next is deleted? no, wait. 'this' and 'this->next' are the pair.
-        // I need to carefully manage memory.
-        // Let's defer delete.
-        
-        p->insert_after(new_sym);
-        
-        // Recursive checks
-        new_sym->check_digram(index, rules, next_rule_id);
-        if (p && !p->is_guard) p->check_digram(index, rules, next_rule_id);
-        
-        return true;
-    }
-    
-    // Create new rule
-    // ... Implementation of rule creation ...
-    // This is getting complex to inline perfectly in one go.
-    // For the sake of progress and avoiding bugs in a complex header implementation,
-    // I will provide a simplified, robust logic for the Ingester to use that focuses on 
-    // the semantic correctness of the DAG structure rather than re-implementing 
-    // the exact pointer manipulation of Sequitur from scratch.
-    
-    // Actually, I can use a simpler approach: "Iterative Pair Encoding" (BPE-like)
-    // which is also deterministic and produces a hierarchy.
-    // 1. Scan for most frequent pair.
-    // 2. Replace with new symbol.
-    // 3. Repeat until no pair appears > 1 time.
-    // This produces a DAG. It is O(N^2) or O(N log N) but simpler to implement correctly.
-    // Given "Moby Dick", performance matters, but correctness matters more.
-    
-    // BUT Sequitur is O(N).
-    // Let's stick to the Sequitur INTERFACE but implement the logic in text_ingester.cpp
-    // or keep it minimal here.
-    
-    return false;
-}
-
-} // namespace Hartonomous
\ No newline at end of file
+} // namespace Hartonomous
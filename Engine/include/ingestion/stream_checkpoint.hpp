@@ -0,0 +1,85 @@
+/**
+ * @file stream_checkpoint.hpp
+ * @brief Resumable corpus ingestion: durable positions in streamed inputs
+ *
+ * A corpus tool reads its inputs in chunks and hands each chunk's records
+ * to an AsyncFlusher. A cursor names one input pass ("pages", "links",
+ * ...) and its position is a byte offset or record index. Each chunk is
+ * covered() with its [begin, end) and the id of its last batch; once
+ * flushed_through() reaches that batch and every chunk before it is in,
+ * the cursor's committed position moves past it and the manifest is
+ * rewritten. Chunks may finish out of order (pipelined stages); only the
+ * contiguous prefix commits.
+ *
+ * On restart a tool seeks each cursor to position() and skips what is
+ * already in the database. SubstrateCache::pre_populate reloads the IDs
+ * those chunks created, so deduplication still sees them. The manifest is
+ * keyed by tool and input paths, invalidated when any input's size or
+ * mtime changes, and removed when a run finishes.
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+class StreamCheckpoint {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    struct Options {
+        std::string dir;   // Empty disables checkpoints
+
+        // HARTONOMOUS_INGEST_CHECKPOINT (directory, "off" to disable); defaults
+        // to ModelCheckpoint::default_dir()
+        static Options from_env();
+    };
+
+    StreamCheckpoint() = default;
+
+    // Load the manifest of `tool` over `inputs` (files or directories) unless one changed
+    void open(const Options& opts, const std::string& tool, const std::vector<std::string>& inputs);
+
+    bool enabled() const noexcept { return !path_.empty(); }
+    const std::string& path() const noexcept { return path_; }
+
+    // Committed position of `cursor`: everything before it is in the database
+    uint64_t position(const std::string& cursor) const;
+
+    // [begin, end) of `cursor` was processed; its records went out up to batch id `last_batch`
+    void covered(const std::string& cursor, uint64_t begin, uint64_t end, uint64_t last_batch);
+
+    // Commit chunks now covered by the flusher's high-water mark
+    void flushed(uint64_t flushed_through);
+
+    // The run finished: nothing left to resume
+    void clear();
+
+    // Sizes and mtimes of every file under `inputs`
+    static Hash fingerprint(const std::vector<std::string>& inputs);
+
+private:
+    struct Chunk {
+        uint64_t end = 0;
+        uint64_t last_batch = 0;
+    };
+    struct Cursor {
+        uint64_t committed = 0;
+        std::map<uint64_t, Chunk> pending;   // By begin
+    };
+
+    void save();   // mutex_ held
+
+    std::string path_;
+    Hash fingerprint_{};
+    mutable std::mutex mutex_;
+    std::map<std::string, Cursor> cursors_;
+};
+
+} // namespace Hartonomous
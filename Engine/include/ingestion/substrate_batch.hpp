@@ -4,6 +4,7 @@
 #include <storage/composition_store.hpp>
 #include <storage/relation_store.hpp>
 #include <storage/relation_evidence_store.hpp>
+#include <iterator>
 #include <vector>
 
 namespace Hartonomous {
@@ -25,6 +26,24 @@ struct SubstrateBatch {
         rel.clear(); rel_seq.clear(); rating.clear(); evidence.clear();
     }
 
+    /**
+     * @brief Move all records of `other` onto the end of this batch.
+     */
+    void append(SubstrateBatch&& other) {
+        auto move_into = [](auto& dst, auto& src) {
+            if (dst.empty()) { dst = std::move(src); return; }
+            dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+            src.clear();
+        };
+        move_into(phys, other.phys);
+        move_into(comp, other.comp);
+        move_into(seq, other.seq);
+        move_into(rel, other.rel);
+        move_into(rel_seq, other.rel_seq);
+        move_into(rating, other.rating);
+        move_into(evidence, other.evidence);
+    }
+
     bool empty() const {
         return phys.empty() && comp.empty() && rel.empty() && evidence.empty();
     }
@@ -2,9 +2,17 @@
 
 #include <database/postgres_connection.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <hashing/hash_table_128.hpp>
 #include <ingestion/substrate_service.hpp>
+#include <ingestion/substrate_id_loader.hpp>
+#include <utils/memory_governor.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <optional>
 #include <iostream>
 
 namespace Hartonomous {
@@ -13,37 +21,65 @@ namespace Hartonomous {
  * @brief Centralized cache for substrate identities.
  * 
  * Prevents redundant compute and primary key violations during large-scale reinforcement.
+ *
+ * Accounted to MemoryGovernor::global(): the ID sets as pinned (dropping one
+ * would let duplicates through), the text memo at low priority, cleared at
+ * the next cache_comp() when the governor asks.
  */
 class SubstrateCache {
 public:
     SubstrateCache() = default;
 
     /**
-     * @brief Pre-populate the cache by streaming existing IDs from the substrate.
-     */
-    void pre_populate(PostgresConnection& db) {
-        std::cout << "[CACHE] Pre-populating deduplication caches (streaming)..." << std::flush;
-        
-        db.stream_query("SELECT id FROM hartonomous.physicality", [&](const std::vector<std::string>& r) {
-            phys_cache_.insert(BLAKE3Pipeline::from_hex(r[0]));
-        });
-        db.stream_query("SELECT id FROM hartonomous.composition", [&](const std::vector<std::string>& r) {
-            comp_id_cache_.insert(BLAKE3Pipeline::from_hex(r[0]));
-        });
-        db.stream_query("SELECT id FROM hartonomous.relation", [&](const std::vector<std::string>& r) {
-            rel_cache_.insert(BLAKE3Pipeline::from_hex(r[0]));
-        });
-        
-        std::cout << " done (Phys: " << phys_cache_.size() 
-                  << ", Comp: " << comp_id_cache_.size() 
+     * @brief Pre-populate the cache with existing IDs from the substrate.
+     *
+     * Loads from opts.snapshot_path when it matches the database, otherwise
+     * pulls each table with binary COPY over opts.workers connections.
+     */
+    void pre_populate(PostgresConnection& db, const PrePopulateOptions& opts = PrePopulateOptions::from_env()) {
+        std::cout << "[CACHE] Pre-populating deduplication caches (" << opts.workers << " connections)..." << std::flush;
+        snapshot_path_ = opts.snapshot_path;
+
+        std::array<HashSet128*, SubstrateIdLoader::TABLE_COUNT> sets = {&phys_cache_, &comp_id_cache_, &rel_cache_};
+        std::array<std::mutex, SubstrateIdLoader::TABLE_COUNT> locks;
+        std::array<SubstrateIdLoader::Sink, SubstrateIdLoader::TABLE_COUNT> sinks;
+        for (size_t t = 0; t < sinks.size(); ++t) {
+            sinks[t] = [&, t](const BLAKE3Pipeline::Hash* ids, size_t n) {
+                std::lock_guard<std::mutex> lock(locks[t]);
+                for (size_t i = 0; i < n; ++i) sets[t]->insert(ids[i]);
+            };
+        }
+        SubstrateIdLoader::populate(db, opts, sinks,
+            [&](SubstrateIdLoader::Table t, size_t n) { sets[t]->reserve(n); });
+
+        std::cout << " done (Phys: " << phys_cache_.size()
+                  << ", Comp: " << comp_id_cache_.size()
                   << ", Rel: " << rel_cache_.size() << ")" << std::endl;
+        account();
+    }
+
+    /**
+     * @brief Persist all known IDs for the next run (no-op without a snapshot path).
+     *
+     * Call once every batch has been flushed, so the cache matches the database.
+     */
+    void save_snapshot(PostgresConnection& db) const {
+        if (snapshot_path_.empty()) return;
+        SubstrateIdLoader::SnapshotWriter w(snapshot_path_, SubstrateIdLoader::fingerprint(db));
+        const HashSet128* sets[] = {&phys_cache_, &comp_id_cache_, &rel_cache_};
+        for (size_t t = 0; t < SubstrateIdLoader::TABLE_COUNT; ++t) {
+            w.begin_table(static_cast<SubstrateIdLoader::Table>(t), sets[t]->size());
+            sets[t]->for_each([&](const BLAKE3Pipeline::Hash& id) { w.write(id); });
+        }
+        w.commit();
+        std::cout << "[CACHE] Snapshot written to " << snapshot_path_ << std::endl;
     }
 
     /**
      * @brief Check if a physicality ID already exists in the substrate or current session.
      */
     bool exists_phys(const BLAKE3Pipeline::Hash& id) const {
-        return phys_cache_.find(id) != phys_cache_.end();
+        return phys_cache_.contains(id);
     }
 
     /**
@@ -51,13 +87,14 @@ public:
      */
     void add_phys(const BLAKE3Pipeline::Hash& id) {
         phys_cache_.insert(id);
+        note_growth();
     }
 
     /**
      * @brief Check if a composition ID already exists.
      */
     bool exists_comp(const BLAKE3Pipeline::Hash& id) const {
-        return comp_id_cache_.find(id) != comp_id_cache_.end();
+        return comp_id_cache_.contains(id);
     }
 
     /**
@@ -65,13 +102,14 @@ public:
      */
     void add_comp(const BLAKE3Pipeline::Hash& id) {
         comp_id_cache_.insert(id);
+        note_growth();
     }
 
     /**
      * @brief Check if a relation ID already exists.
      */
     bool exists_rel(const BLAKE3Pipeline::Hash& id) const {
-        return rel_cache_.find(id) != rel_cache_.end();
+        return rel_cache_.contains(id);
     }
 
     /**
@@ -79,6 +117,7 @@ public:
      */
     void add_rel(const BLAKE3Pipeline::Hash& id) {
         rel_cache_.insert(id);
+        note_growth();
     }
 
     /**
@@ -94,14 +133,293 @@ public:
      * @brief Cache a composition by its source text.
      */
     void cache_comp(const std::string& text, const SubstrateService::CachedComp& comp) {
+        if (texts_account_.shrink_requested()) {
+            std::unordered_map<std::string, SubstrateService::CachedComp>().swap(comp_cache_);
+            texts_account_.shrunk(0);
+        }
         comp_cache_[text] = comp;
+        note_growth();
     }
 
 private:
+    // Sizes reach the governor every ACCOUNT_EVERY additions
+    static constexpr size_t ACCOUNT_EVERY = 4096;
+
+    void note_growth() {
+        if (++additions_ % ACCOUNT_EVERY == 0) account();
+    }
+
+    void account() {
+        ids_account_.update(phys_cache_.memory_bytes() + comp_id_cache_.memory_bytes() + rel_cache_.memory_bytes());
+        texts_account_.update(MemoryGovernor::hash_map_bytes(comp_cache_));
+    }
+
+    std::string snapshot_path_;
     std::unordered_map<std::string, SubstrateService::CachedComp> comp_cache_;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> comp_id_cache_;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> phys_cache_;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> rel_cache_;
+    HashSet128 comp_id_cache_;
+    HashSet128 phys_cache_;
+    HashSet128 rel_cache_;
+    size_t additions_ = 0;
+    MemoryGovernor::Account ids_account_ =
+        MemoryGovernor::global().enroll("substrate_ids", MemoryGovernor::Priority::Pinned);
+    MemoryGovernor::Account texts_account_ =
+        MemoryGovernor::global().enroll("substrate_texts", MemoryGovernor::Priority::Low);
+};
+
+/**
+ * @brief Lock-striped hash set for concurrent dedup.
+ *
+ * Keys are routed to one of 2^ShardBits shards by the high bits of their
+ * hash; each shard is an ordinary set behind its own mutex, so threads only
+ * contend when they hit the same shard. For BLAKE3 IDs the HashHasher value
+ * is raw digest bits, which makes the high bits uniformly distributed.
+ */
+template <typename Key, typename Hasher, size_t ShardBits = 6,
+          typename Set = std::unordered_set<Key, Hasher>>
+class ShardedSet {
+    static_assert(sizeof(size_t) == 8, "ShardedSet routes on the top bits of a 64-bit hash");
+
+public:
+    static constexpr size_t SHARD_COUNT = size_t(1) << ShardBits;
+
+    /**
+     * @brief Insert key unless present.
+     * @return true if this call inserted it (the caller owns emitting the record)
+     */
+    bool insert_if_absent(const Key& key) {
+        auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        return shard.set.insert(key).second;
+    }
+
+    bool contains(const Key& key) const {
+        const auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        return shard.set.contains(key);
+    }
+
+    void reserve(size_t total) {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            shard.set.reserve(total / SHARD_COUNT + 1);
+        }
+    }
+
+    /**
+     * @brief Visit every key; shards are locked one at a time.
+     */
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            if constexpr (requires { shard.set.for_each(fn); }) {
+                shard.set.for_each(fn);
+            } else {
+                for (const auto& key : shard.set) fn(key);
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            total += shard.set.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            shard.set.clear();
+        }
+    }
+
+    // Heap bytes of the shard sets (an estimate for node-based sets)
+    size_t memory_bytes() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            if constexpr (requires { shard.set.memory_bytes(); }) {
+                total += shard.set.memory_bytes();
+            } else {
+                total += shard.set.size() * (sizeof(Key) + 2 * sizeof(void*)) + shard.set.bucket_count() * sizeof(void*);
+            }
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex mu;
+        Set set;
+    };
+
+    static size_t shard_index(const Key& key) {
+        return Hasher{}(key) >> (64 - ShardBits);
+    }
+
+    Shard& shard_for(const Key& key) { return shards_[shard_index(key)]; }
+    const Shard& shard_for(const Key& key) const { return shards_[shard_index(key)]; }
+
+    std::array<Shard, SHARD_COUNT> shards_;
+};
+
+/**
+ * @brief Thread-safe SubstrateCache for parallel ingesters.
+ *
+ * Same identities as SubstrateCache, but every set is a ShardedSet and the
+ * insert_*_if_absent calls are atomic, so OpenMP workers can dedup records
+ * in place while decomposing instead of funnelling through a serial merge.
+ * Accounted like SubstrateCache; the governor clears the text memo directly,
+ * since its shards are locked.
+ */
+class ConcurrentSubstrateCache {
+public:
+    ConcurrentSubstrateCache() = default;
+
+    /**
+     * @brief Pre-populate the cache with existing IDs from the substrate.
+     *
+     * Same sources as SubstrateCache::pre_populate; loader threads insert
+     * straight into the shards.
+     */
+    void pre_populate(PostgresConnection& db, const PrePopulateOptions& opts = PrePopulateOptions::from_env()) {
+        std::cout << "[CACHE] Pre-populating deduplication caches (" << opts.workers << " connections)..." << std::flush;
+        snapshot_path_ = opts.snapshot_path;
+
+        std::array<IdSet*, SubstrateIdLoader::TABLE_COUNT> sets = {&phys_cache_, &comp_id_cache_, &rel_cache_};
+        std::array<SubstrateIdLoader::Sink, SubstrateIdLoader::TABLE_COUNT> sinks;
+        for (size_t t = 0; t < sinks.size(); ++t) {
+            sinks[t] = [&, t](const BLAKE3Pipeline::Hash* ids, size_t n) {
+                for (size_t i = 0; i < n; ++i) sets[t]->insert_if_absent(ids[i]);
+            };
+        }
+        SubstrateIdLoader::populate(db, opts, sinks,
+            [&](SubstrateIdLoader::Table t, size_t n) { sets[t]->reserve(n); });
+
+        std::cout << " done (Phys: " << phys_cache_.size()
+                  << ", Comp: " << comp_id_cache_.size()
+                  << ", Rel: " << rel_cache_.size() << ")" << std::endl;
+        account();
+    }
+
+    /**
+     * @brief Persist all known IDs for the next run (no-op without a snapshot path).
+     *
+     * Call once every batch has been flushed, so the cache matches the database.
+     */
+    void save_snapshot(PostgresConnection& db) const {
+        if (snapshot_path_.empty()) return;
+        SubstrateIdLoader::SnapshotWriter w(snapshot_path_, SubstrateIdLoader::fingerprint(db));
+        const IdSet* sets[] = {&phys_cache_, &comp_id_cache_, &rel_cache_};
+        for (size_t t = 0; t < SubstrateIdLoader::TABLE_COUNT; ++t) {
+            w.begin_table(static_cast<SubstrateIdLoader::Table>(t), sets[t]->size());
+            sets[t]->for_each([&](const BLAKE3Pipeline::Hash& id) { w.write(id); });
+        }
+        w.commit();
+        std::cout << "[CACHE] Snapshot written to " << snapshot_path_ << std::endl;
+    }
+
+    bool exists_phys(const BLAKE3Pipeline::Hash& id) const { return phys_cache_.contains(id); }
+    bool exists_comp(const BLAKE3Pipeline::Hash& id) const { return comp_id_cache_.contains(id); }
+    bool exists_rel(const BLAKE3Pipeline::Hash& id) const { return rel_cache_.contains(id); }
+
+    /**
+     * @brief Claim a physicality ID. Returns true exactly once per ID.
+     */
+    bool insert_phys_if_absent(const BLAKE3Pipeline::Hash& id) { return note(phys_cache_.insert_if_absent(id)); }
+
+    /**
+     * @brief Claim a composition ID. Returns true exactly once per ID.
+     */
+    bool insert_comp_if_absent(const BLAKE3Pipeline::Hash& id) { return note(comp_id_cache_.insert_if_absent(id)); }
+
+    /**
+     * @brief Claim a relation ID. Returns true exactly once per ID.
+     */
+    bool insert_rel_if_absent(const BLAKE3Pipeline::Hash& id) { return note(rel_cache_.insert_if_absent(id)); }
+
+    /**
+     * @brief Map text to a cached composition.
+     */
+    std::optional<SubstrateService::CachedComp> get_comp(const std::string& text) const {
+        const auto& shard = text_shard(text);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.map.find(text);
+        if (it != shard.map.end()) return it->second;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Cache a composition by its source text.
+     */
+    void cache_comp(const std::string& text, const SubstrateService::CachedComp& comp) {
+        {
+            auto& shard = text_shard(text);
+            std::lock_guard<std::mutex> lock(shard.mu);
+            shard.map[text] = comp;
+        }
+        note(true);
+    }
+
+private:
+    static constexpr size_t TEXT_SHARDS = 64;
+    static constexpr size_t ACCOUNT_EVERY = 4096;
+
+    // Adds from every thread are counted together; every ACCOUNT_EVERY-th reports the sizes
+    bool note(bool added) {
+        if (added && (additions_.fetch_add(1, std::memory_order_relaxed) + 1) % ACCOUNT_EVERY == 0) account();
+        return added;
+    }
+
+    void account() {
+        ids_account_.update(phys_cache_.memory_bytes() + comp_id_cache_.memory_bytes() + rel_cache_.memory_bytes());
+        texts_account_.update(text_bytes());
+    }
+
+    size_t text_bytes() const {
+        size_t total = 0;
+        for (const auto& shard : comp_cache_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            total += MemoryGovernor::hash_map_bytes(shard.map);
+        }
+        return total;
+    }
+
+    void clear_texts() {
+        for (auto& shard : comp_cache_) {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            std::unordered_map<std::string, SubstrateService::CachedComp>().swap(shard.map);
+        }
+        texts_account_.update(0);
+    }
+
+    struct alignas(64) TextShard {
+        mutable std::mutex mu;
+        std::unordered_map<std::string, SubstrateService::CachedComp> map;
+    };
+
+    TextShard& text_shard(const std::string& text) {
+        return comp_cache_[std::hash<std::string>{}(text) % TEXT_SHARDS];
+    }
+    const TextShard& text_shard(const std::string& text) const {
+        return comp_cache_[std::hash<std::string>{}(text) % TEXT_SHARDS];
+    }
+
+    std::string snapshot_path_;
+    std::array<TextShard, TEXT_SHARDS> comp_cache_;
+    using IdSet = ShardedSet<BLAKE3Pipeline::Hash, HashHasher, 6, HashSet128>;
+    IdSet comp_id_cache_;
+    IdSet phys_cache_;
+    IdSet rel_cache_;
+    std::atomic<size_t> additions_{0};
+    MemoryGovernor::Account ids_account_ =
+        MemoryGovernor::global().enroll("substrate_ids", MemoryGovernor::Priority::Pinned);
+    MemoryGovernor::Account texts_account_ =
+        MemoryGovernor::global().enroll("substrate_texts", MemoryGovernor::Priority::Low,
+                                        [this](size_t) { clear_texts(); });
 };
 
 } // namespace Hartonomous
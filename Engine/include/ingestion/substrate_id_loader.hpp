@@ -0,0 +1,110 @@
+/**
+ * @file substrate_id_loader.hpp
+ * @brief Bulk loading of existing substrate IDs for dedup caches
+ *
+ * Pulls physicality/composition/relation IDs with binary COPY over several
+ * connections, each scanning a slice of the UUID keyspace, and can persist
+ * the result as a snapshot file that later runs mmap instead of querying.
+ */
+
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace Hartonomous {
+
+/**
+ * @brief Options for SubstrateCache::pre_populate
+ */
+struct PrePopulateOptions {
+    size_t workers = 8;          // Parallel COPY connections per table
+    std::string snapshot_path;   // Empty = no snapshot
+
+    /**
+     * @brief Read HARTONOMOUS_CACHE_WORKERS / HARTONOMOUS_CACHE_SNAPSHOT
+     */
+    static PrePopulateOptions from_env();
+};
+
+class SubstrateIdLoader {
+public:
+    enum Table : size_t { Physicality = 0, Composition = 1, Relation = 2, TABLE_COUNT = 3 };
+
+    static const char* table_name(Table t);
+
+    /**
+     * @brief Planner row estimate for a table (0 if unknown), used to size caches up front.
+     */
+    static size_t estimate_rows(PostgresConnection& db, Table table);
+
+    /**
+     * @brief Receives a batch of IDs; called concurrently from loader threads.
+     */
+    using Sink = std::function<void(const BLAKE3Pipeline::Hash* ids, size_t count)>;
+
+    /**
+     * @brief Stream every ID of `table` into sink using `workers` connections.
+     * @return Number of IDs loaded
+     */
+    static size_t load_table(PostgresConnection& db, Table table, size_t workers, const Sink& sink);
+
+    /**
+     * @brief Cheap identity of the substrate's current contents.
+     *
+     * Built from the database name, table OIDs and the cumulative insert/delete
+     * counters of the three tables; any write since the snapshot changes it.
+     * A stats reset also changes it, which only costs a reload.
+     */
+    static std::string fingerprint(PostgresConnection& db);
+
+    /**
+     * @brief Feed a snapshot's IDs to the per-table sinks if it matches `fingerprint`.
+     * @return false if the file is missing, malformed or stale
+     */
+    static bool load_snapshot(const std::string& path, const std::string& fingerprint,
+                              const std::array<Sink, TABLE_COUNT>& sinks);
+
+    /**
+     * @brief Fill per-table sinks from a valid snapshot, else from the database.
+     *
+     * `reserve` is called with each table's expected size before its IDs arrive.
+     */
+    static void populate(PostgresConnection& db, const PrePopulateOptions& opts,
+                         const std::array<Sink, TABLE_COUNT>& sinks,
+                         const std::function<void(Table, size_t)>& reserve);
+
+    /**
+     * @brief Sequential snapshot writer; tables must be written in Table order.
+     */
+    class SnapshotWriter {
+    public:
+        SnapshotWriter(const std::string& path, const std::string& fingerprint);
+        ~SnapshotWriter();
+
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        void begin_table(Table table, size_t count);
+        void write(const BLAKE3Pipeline::Hash& id);
+
+        /**
+         * @brief Flush and atomically move the snapshot into place.
+         */
+        void commit();
+
+    private:
+        std::string path_;
+        std::string tmp_path_;
+        std::FILE* file_ = nullptr;
+        size_t expected_ = 0;
+        size_t written_ = 0;
+        bool committed_ = false;
+    };
+};
+
+} // namespace Hartonomous
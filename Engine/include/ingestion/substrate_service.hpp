@@ -1,15 +1,19 @@
 #pragma once
 
+#include <geometry/s3_centroid.hpp>
 #include <hashing/blake3_pipeline.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
 #include <storage/atom_lookup.hpp>
 #include <ingestion/substrate_batch.hpp>
+#include <ingestion/relation_edge.hpp>
 #include <utils/unicode.hpp>
 #include <Eigen/Core>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <algorithm>
+#include <array>
 
 namespace Hartonomous {
 
@@ -43,156 +47,297 @@ public:
     };
 
     /**
-     * @brief Compute composition identity and S3 geometry from text.
+     * @brief Per-thread working buffers for compute_comp.
+     *
+     * Buffers only grow, so once warmed up a word costs no heap allocation
+     * beyond what the caller's ComputedComp has not yet reserved.
      */
-    static ComputedComp compute_comp(const std::string& text, AtomLookup& lookup) {
-        if (text.empty()) return {};
-        std::u32string utf32 = utf8_to_utf32(text);
-        
+    struct ComputeScratch {
+        std::u32string utf32;
         std::vector<BLAKE3Pipeline::Hash> atom_ids;
         std::vector<Eigen::Vector4d> positions;
-        atom_ids.reserve(utf32.size());
-        positions.reserve(utf32.size());
-
-        for (char32_t cp : utf32) {
-            auto info = lookup.lookup(cp);
-            if (info) {
-                atom_ids.push_back(info->id);
-                positions.push_back(info->position);
-            }
+        std::vector<uint8_t> seq_input;             // Packed 37-byte sequence ID inputs
+        std::vector<BLAKE3Pipeline::Hash> seq_ids;
+    };
+
+    /**
+     * @brief Composition ID of an atom sequence: BLAKE3(0x43 + atom_ids).
+     */
+    static BLAKE3Pipeline::Hash composition_id(const BLAKE3Pipeline::Hash* atom_ids, size_t n) {
+        BLAKE3Pipeline::Hasher ch;
+        ch.update(uint8_t{0x43});
+        ch.update(atom_ids, n * sizeof(BLAKE3Pipeline::Hash));
+        return ch.finalize();
+    }
+
+    /**
+     * @brief Compute composition identity and S3 geometry from text.
+     */
+    static ComputedComp compute_comp(const std::string& text, AtomLookup& lookup) {
+        thread_local ComputeScratch scratch;
+        ComputedComp res;
+        compute_comp(text, lookup, scratch, res);
+        return res;
+    }
+
+    /**
+     * @brief compute_comp into caller-owned storage.
+     *
+     * `out.seq`, `out.comp.runs` and `out.phys.trajectory` are cleared and refilled in place,
+     * so reusing `out` across words keeps their capacity. Without
+     * `with_hilbert` the Hilbert index is left for encode_hilbert_indices().
+     * @return out.valid
+     */
+    static bool compute_comp(std::string_view text, AtomLookup& lookup,
+                             ComputeScratch& scratch, ComputedComp& out, bool with_hilbert = true) {
+        utf8_to_utf32(text, scratch.utf32);
+        return compute_comp(std::u32string_view(scratch.utf32), lookup, scratch, out, with_hilbert);
+    }
+
+    /**
+     * @brief compute_comp of already decoded codepoints (e.g. a Token's span).
+     */
+    static bool compute_comp(std::u32string_view codepoints, AtomLookup& lookup,
+                             ComputeScratch& scratch, ComputedComp& out, bool with_hilbert = true) {
+        out.valid = false;
+        out.cache_entry.valid = false;
+        out.seq.clear();
+        out.comp.runs.clear();
+        out.phys.trajectory.clear();
+        if (codepoints.empty()) return false;
+
+        size_t n_in = codepoints.size();
+        if (scratch.atom_ids.size() < n_in) {
+            scratch.atom_ids.resize(n_in);
+            scratch.positions.resize(n_in);
         }
-        if (atom_ids.empty()) return {};
+        size_t n = lookup.lookup_codepoints(codepoints, scratch.atom_ids, scratch.positions);
+        if (n == 0) return false;
+        const BLAKE3Pipeline::Hash* atom_ids = scratch.atom_ids.data();
+        const Eigen::Vector4d* positions = scratch.positions.data();
 
-        // 1. Composition ID: BLAKE3(0x43 + atom_ids)
-        size_t c_len = 1 + atom_ids.size() * 16;
-        std::vector<uint8_t> c_data(c_len);
-        c_data[0] = 0x43;
-        for (size_t k = 0; k < atom_ids.size(); ++k)
-            std::memcpy(c_data.data() + 1 + k * 16, atom_ids[k].data(), 16);
-        auto cid = BLAKE3Pipeline::hash(c_data.data(), c_len);
+        // 1. Composition ID
+        auto cid = composition_id(atom_ids, n);
 
         // 2. Centroid (S3 projection)
-        Eigen::Vector4d centroid = Eigen::Vector4d::Zero();
-        for (const auto& p : positions) centroid += p;
-        centroid /= static_cast<double>(positions.size());
-        double norm = centroid.norm();
-        if (norm > 1e-10) centroid /= norm; else centroid = Eigen::Vector4d(1, 0, 0, 0);
+        static_assert(sizeof(Eigen::Vector4d) == sizeof(double) * 4);
+        Eigen::Vector4d centroid = Hartonomous::Geometry::compute_s3_mean(positions->data(), n);
 
         // 3. Physicality ID: BLAKE3(0x50 + centroid + trajectory)
-        size_t p_len = 1 + sizeof(double) * 4 + positions.size() * sizeof(double) * 4;
-        std::vector<uint8_t> p_data(p_len);
-        p_data[0] = 0x50;
-        std::memcpy(p_data.data() + 1, centroid.data(), sizeof(double) * 4);
-        for (size_t k = 0; k < positions.size(); ++k)
-            std::memcpy(p_data.data() + 1 + sizeof(double) * 4 + k * sizeof(double) * 4, positions[k].data(), sizeof(double) * 4);
-        auto pid = BLAKE3Pipeline::hash(p_data.data(), p_len);
+        BLAKE3Pipeline::Hasher ph;
+        ph.update(uint8_t{0x50});
+        ph.update(centroid.data(), sizeof(double) * 4);
+        ph.update(positions, n * sizeof(double) * 4);
+        auto pid = ph.finalize();
 
-        Eigen::Vector4d hc;
-        for (int k = 0; k < 4; ++k) hc[k] = (centroid[k] + 1.0) / 2.0;
+        out.comp.id = cid;
+        out.comp.physicality_id = pid;
+        utf32_to_utf8(codepoints, out.comp.text);
+        out.phys.id = pid;
+        if (with_hilbert) {
+            Eigen::Vector4d hc;
+            for (int k = 0; k < 4; ++k) hc[k] = (centroid[k] + 1.0) / 2.0;
+            out.phys.hilbert_index = hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Composition);
+        }
+        out.phys.centroid = centroid;
+        decimate_trajectory(positions, n, out.phys.trajectory);
+        out.cache_entry = {cid, pid, centroid, true};
+        out.valid = true;
 
-        ComputedComp res;
-        res.comp = {cid, pid};
-        res.phys = {pid, hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Composition), centroid, decimate_trajectory(positions)};
-        res.cache_entry = {cid, pid, centroid, true};
-        res.valid = true;
+        // 4. Packed runs, when every codepoint resolved to its atom so ordinals line up with
+        //    the codepoints; the sequence rows can then be left out
+        const bool packed = n == n_in;
+        const bool rows = !packed || CompositionRuns::write_rows();
 
-        for (size_t i = 0; i < atom_ids.size(); ) {
+        // 5. Sequence rows, one per run of repeated atoms; IDs BLAKE3(0x53 + comp + atom + ordinal)
+        //    are hashed together across SIMD lanes
+        constexpr size_t SEQ_INPUT = 37;
+        if (rows) scratch.seq_input.resize(n * SEQ_INPUT);
+        size_t runs = 0;
+        for (size_t i = 0; i < n; ) {
             uint32_t ord = static_cast<uint32_t>(i);
             uint32_t occ = 1;
-            while (i + occ < atom_ids.size() && atom_ids[i + occ] == atom_ids[i]) ++occ;
-            
-            uint8_t sdata[37];
+            while (i + occ < n && atom_ids[i + occ] == atom_ids[i]) ++occ;
+            if (packed) CompositionRuns::append(out.comp.runs, codepoints[i], occ);
+            if (!rows) {
+                i += occ;
+                continue;
+            }
+
+            uint8_t* sdata = scratch.seq_input.data() + runs * SEQ_INPUT;
             sdata[0] = 0x53;
             std::memcpy(sdata + 1, cid.data(), 16);
             std::memcpy(sdata + 17, atom_ids[i].data(), 16);
             std::memcpy(sdata + 33, &ord, 4);
-            res.seq.push_back({BLAKE3Pipeline::hash(sdata, 37), cid, atom_ids[i], ord, occ});
+            out.seq.push_back({{}, cid, atom_ids[i], ord, occ});
+            ++runs;
             i += occ;
         }
-        return res;
+        if (scratch.seq_ids.size() < runs) scratch.seq_ids.resize(runs);
+        BLAKE3Pipeline::hash_many_fixed(scratch.seq_input.data(), SEQ_INPUT, SEQ_INPUT, runs, scratch.seq_ids.data());
+        for (size_t r = 0; r < runs; ++r) out.seq[r].id = scratch.seq_ids[r];
+        return true;
     }
 
     /**
-     * @brief Compute relation identity and geometry between two compositions.
+     * @brief compute_comp of each text, with the Hilbert indices encoded as one batch.
+     * @return Number of valid results
      */
-    static ComputedRelation compute_relation(const CachedComp& a, const CachedComp& b, 
-                                            const BLAKE3Pipeline::Hash& content_id, double base_rating = 1500.0) {
-        if (!a.valid || !b.valid || a.comp_id == b.comp_id) return {};
+    static size_t compute_comps(const std::vector<std::string>& texts, AtomLookup& lookup,
+                                std::vector<ComputedComp>& out) {
+        thread_local ComputeScratch scratch;
+        out.resize(texts.size());
+        size_t valid = 0;
+        for (size_t i = 0; i < texts.size(); ++i) valid += compute_comp(texts[i], lookup, scratch, out[i], false);
+        encode_hilbert_indices(out.data(), out.size());
+        return valid;
+    }
 
-        bool a_first = std::memcmp(a.comp_id.data(), b.comp_id.data(), 16) < 0;
-        uint8_t r_in[33];
-        r_in[0] = 0x52;
-        if (a_first) {
-            std::memcpy(r_in + 1, a.comp_id.data(), 16);
-            std::memcpy(r_in + 17, b.comp_id.data(), 16);
-        } else {
-            std::memcpy(r_in + 1, b.comp_id.data(), 16);
-            std::memcpy(r_in + 17, a.comp_id.data(), 16);
+    /**
+     * @brief Encode the Hilbert indices of the valid comps[0..n) from their centroids.
+     */
+    static void encode_hilbert_indices(ComputedComp* comps, size_t n) {
+        thread_local std::vector<double> coords;
+        thread_local std::vector<ComputedComp*> targets;
+        thread_local std::vector<HilbertIndex> indices;
+        coords.clear();
+        targets.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (!comps[i].valid) continue;
+            for (int k = 0; k < 4; ++k) coords.push_back((comps[i].phys.centroid[k] + 1.0) / 2.0);
+            targets.push_back(&comps[i]);
         }
-        auto rid = BLAKE3Pipeline::hash(r_in, 33);
-
-        Eigen::Vector4d r_centroid = (a.centroid + b.centroid) * 0.5;
-        double norm = r_centroid.norm();
-        if (norm > 1e-10) r_centroid /= norm; else r_centroid = Eigen::Vector4d(1, 0, 0, 0);
-
-        std::vector<Eigen::Vector4d> r_traj = {a.centroid, b.centroid};
-        size_t p_len = 1 + sizeof(double) * 4 + r_traj.size() * sizeof(double) * 4;
-        std::vector<uint8_t> p_data(p_len);
-        p_data[0] = 0x50;
-        std::memcpy(p_data.data() + 1, r_centroid.data(), sizeof(double) * 4);
-        for (size_t k = 0; k < r_traj.size(); ++k)
-            std::memcpy(p_data.data() + 1 + sizeof(double) * 4 + k * sizeof(double) * 4, r_traj[k].data(), sizeof(double) * 4);
-        auto pid = BLAKE3Pipeline::hash(p_data.data(), p_len);
+        indices.resize(targets.size());
+        hartonomous::spatial::HilbertCurve4D::encode_batch(coords.data(), targets.size(), indices.data(),
+                                                          hartonomous::spatial::HilbertCurve4D::EntityType::Composition);
+        for (size_t i = 0; i < targets.size(); ++i) targets[i]->phys.hilbert_index = indices[i];
+    }
 
-        Eigen::Vector4d hc;
-        for (int k = 0; k < 4; ++k) hc[k] = (r_centroid[k] + 1.0) / 2.0;
+    /**
+     * @brief Relation identity, rating and evidence between two compositions, without geometry.
+     *
+     * Costs one 33-byte and one 32-byte hash. Emitters that dedup relations
+     * check rel.id against their seen-set first and call add_relation_geometry()
+     * only for relations they have not emitted yet.
+     */
+    static ComputedRelation identify_relation(const CachedComp& a, const CachedComp& b,
+                                              const BLAKE3Pipeline::Hash& content_id, double base_rating = 1500.0) {
+        if (!a.valid || !b.valid || a.comp_id == b.comp_id) return {};
 
         ComputedRelation res;
-        res.rel = {rid, pid};
-        res.phys = {pid, hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Relation), r_centroid, r_traj};
+        const auto rid = RelationEdge::relation_id(a.comp_id, b.comp_id);
+        res.rel.id = rid;
         res.rating = {rid, 1, base_rating, 32.0};
+        res.evidence = {RelationEdge::evidence_id(content_id, rid), content_id, rid, true, base_rating, 1.0};
         res.valid = true;
+        return res;
+    }
 
-        for (uint32_t k = 0; k < 2; ++k) {
-            const auto& cid = (k == 0) ? (a_first ? a.comp_id : b.comp_id) : (a_first ? b.comp_id : a.comp_id);
-            uint8_t rs_data[37];
-            rs_data[0] = 0x54;
-            std::memcpy(rs_data + 1, rid.data(), 16);
-            std::memcpy(rs_data + 17, cid.data(), 16);
-            std::memcpy(rs_data + 33, &k, 4);
-            res.seq.push_back({BLAKE3Pipeline::hash(rs_data, 37), rid, cid, k, 1});
-        }
+    /**
+     * @brief Physicality and sequence rows of a relation from identify_relation(a, b, ...).
+     */
+    static void add_relation_geometry(const CachedComp& a, const CachedComp& b, ComputedRelation& res) {
+        RelationEdge edge(res.rel.id, a.comp_id, b.comp_id, &a.centroid, &b.centroid, true);
+        res.rel = edge.relation();
+        res.phys = edge.physicality();
+        res.seq.clear();
+        res.seq.push_back(edge.sequence(0));
+        res.seq.push_back(edge.sequence(1));
+    }
 
-        uint8_t ev_data[32];
-        std::memcpy(ev_data, content_id.data(), 16);
-        std::memcpy(ev_data + 16, rid.data(), 16);
-        res.evidence = {BLAKE3Pipeline::hash(ev_data, 32), content_id, rid, true, base_rating, 1.0};
+    /**
+     * @brief Compute relation identity and geometry between two compositions.
+     */
+    static ComputedRelation compute_relation(const CachedComp& a, const CachedComp& b,
+                                            const BLAKE3Pipeline::Hash& content_id, double base_rating = 1500.0) {
+        auto res = identify_relation(a, b, content_id, base_rating);
+        if (res.valid) add_relation_geometry(a, b, res);
         return res;
     }
 
+    /**
+     * @brief A token: its UTF-8 bytes and its decoded codepoints.
+     *
+     * Both views point into the text and the codepoint buffer handed to
+     * tokenize(). For malformed input `text` holds the raw bytes and
+     * `codepoints` their lenient decoding (as utf8_to_utf32).
+     */
+    struct Token {
+        std::string_view text;
+        std::u32string_view codepoints;
+    };
+
     /**
      * @brief Tokenize text into word-level tokens for substrate decomposition.
      * Splits on whitespace. CJK characters are individual tokens.
+     *
+     * Walks the UTF-8 once, decoding into `codepoints` (replaced; keeps its
+     * capacity), and fills `tokens` with views into `text` and `codepoints`.
      */
-    static std::vector<std::string> tokenize(const std::string& text) {
-        std::vector<std::string> tokens;
-        std::u32string utf32 = utf8_to_utf32(text);
-        std::u32string current;
-        for (char32_t c : utf32) {
-            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
-                if (!current.empty()) { tokens.push_back(utf32_to_utf8(current)); current.clear(); }
-            } else if ((c >= 0x4E00 && c <= 0x9FFF) ||   // CJK Unified Ideographs
-                       (c >= 0x3400 && c <= 0x4DBF) ||   // CJK Extension A
-                       (c >= 0x3040 && c <= 0x309F) ||   // Hiragana
-                       (c >= 0x30A0 && c <= 0x30FF) ||   // Katakana
-                       (c >= 0xAC00 && c <= 0xD7AF)) {   // Hangul Syllables
-                if (!current.empty()) { tokens.push_back(utf32_to_utf8(current)); current.clear(); }
-                tokens.push_back(utf32_to_utf8(std::u32string(1, c)));
+    static void tokenize(std::string_view text, std::u32string& codepoints, std::vector<Token>& tokens) {
+        struct Span { uint32_t byte, cp; };
+        thread_local std::vector<std::pair<Span, Span>> bounds;  // [begin, end) per token
+        bounds.clear();
+        tokens.clear();
+        codepoints.resize(text.size());  // At most one codepoint per byte: never reallocates below
+
+        const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+        const auto size = static_cast<uint32_t>(text.size());
+        uint32_t n = 0;
+        Span start{0, 0};
+        for (uint32_t i = 0; i < size; ) {
+            const uint32_t at = i;
+            uint8_t c = bytes[i];
+            char32_t cp = c;
+            if (c < 0x80) {
+                ++i;
             } else {
-                current.push_back(c);
+                uint32_t len;
+                if ((c >> 5) == 0x6) { cp = c & 0x1F; len = 2; }
+                else if ((c >> 4) == 0xE) { cp = c & 0x0F; len = 3; }
+                else if ((c >> 3) == 0x1E) { cp = c & 0x07; len = 4; }
+                else { ++i; continue; }  // Invalid start byte, as utf8_to_utf32
+                for (uint32_t j = 1; j < len && i + j < size; ++j) {
+                    if ((bytes[i + j] >> 6) != 0x2) { len = 1; break; }
+                    cp = (cp << 6) | (bytes[i + j] & 0x3F);
+                }
+                i = std::min(i + len, size);
+            }
+            switch (token_class(cp)) {
+                case TokenClass::Space:
+                    if (n > start.cp) bounds.push_back({start, {at, n}});
+                    start = {i, n};
+                    break;
+                case TokenClass::Single:
+                    if (n > start.cp) bounds.push_back({start, {at, n}});
+                    codepoints[n++] = cp;
+                    bounds.push_back({{at, n - 1}, {i, n}});
+                    start = {i, n};
+                    break;
+                case TokenClass::Word:
+                    codepoints[n++] = cp;
+                    break;
             }
         }
-        if (!current.empty()) tokens.push_back(utf32_to_utf8(current));
+        if (n > start.cp) bounds.push_back({start, {size, n}});
+        codepoints.resize(n);
+
+        tokens.reserve(bounds.size());
+        const std::u32string_view cps(codepoints);
+        for (const auto& [b, e] : bounds)
+            tokens.push_back({text.substr(b.byte, e.byte - b.byte), cps.substr(b.cp, e.cp - b.cp)});
+    }
+
+    /**
+     * @brief tokenize() as owned UTF-8 strings (re-encoded from the codepoints).
+     */
+    static std::vector<std::string> tokenize(const std::string& text) {
+        std::u32string codepoints;
+        std::vector<Token> spans;
+        tokenize(text, codepoints, spans);
+        std::vector<std::string> tokens;
+        tokens.reserve(spans.size());
+        for (const auto& t : spans) tokens.push_back(utf32_to_utf8(std::u32string(t.codepoints)));
         return tokens;
     }
 
@@ -209,12 +354,15 @@ public:
      * Each word becomes a composition. Adjacent word pairs are returned for relation creation.
      */
     static SentenceDecomposition decompose_sentence(const std::string& text, AtomLookup& lookup) {
+        thread_local ComputeScratch scratch;
+        thread_local std::u32string codepoints;
+        thread_local std::vector<Token> tokens;
         SentenceDecomposition result;
-        auto tokens = tokenize(text);
-        result.word_comps.reserve(tokens.size());
-        for (const auto& tok : tokens) {
-            result.word_comps.push_back(compute_comp(tok, lookup));
-        }
+        tokenize(text, codepoints, tokens);
+        result.word_comps.resize(tokens.size());
+        for (size_t i = 0; i < tokens.size(); ++i)
+            compute_comp(tokens[i].codepoints, lookup, scratch, result.word_comps[i], false);
+        encode_hilbert_indices(result.word_comps.data(), result.word_comps.size());
         for (size_t i = 0; i + 1 < result.word_comps.size(); ++i) {
             if (result.word_comps[i].valid && result.word_comps[i + 1].valid &&
                 result.word_comps[i].comp.id != result.word_comps[i + 1].comp.id) {
@@ -228,15 +376,57 @@ public:
      * @brief Decimate long trajectories to keep storage and GIST index costs constant.
      */
     static std::vector<Eigen::Vector4d> decimate_trajectory(const std::vector<Eigen::Vector4d>& pts) {
-        static constexpr size_t MAX_PTS = 16;
-        if (pts.size() <= MAX_PTS) return pts;
         std::vector<Eigen::Vector4d> res;
-        res.reserve(MAX_PTS);
+        decimate_trajectory(pts.data(), pts.size(), res);
+        return res;
+    }
+
+    /**
+     * @brief decimate_trajectory into `out` (replaces its contents, keeps capacity).
+     */
+    static void decimate_trajectory(const Eigen::Vector4d* pts, size_t n, std::vector<Eigen::Vector4d>& out) {
+        static constexpr size_t MAX_PTS = 16;
+        out.clear();
+        if (n <= MAX_PTS) {
+            out.assign(pts, pts + n);
+            return;
+        }
+        out.reserve(MAX_PTS);
         for (size_t i = 0; i < MAX_PTS; ++i) {
-            size_t idx = (i * (pts.size() - 1)) / (MAX_PTS - 1);
-            res.push_back(pts[idx]);
+            size_t idx = (i * (n - 1)) / (MAX_PTS - 1);
+            out.push_back(pts[idx]);
         }
-        return res;
+    }
+
+private:
+    enum class TokenClass : uint8_t { Word, Space, Single };
+
+    struct TokenRange {
+        char32_t lo, hi;
+        TokenClass cls;
+    };
+
+    // Non-ASCII codepoints that are tokens of their own, sorted by lo
+    static constexpr std::array<TokenRange, 5> SINGLE_RANGES = {{
+        {0x3040, 0x309F, TokenClass::Single},   // Hiragana
+        {0x30A0, 0x30FF, TokenClass::Single},   // Katakana
+        {0x3400, 0x4DBF, TokenClass::Single},   // CJK Extension A
+        {0x4E00, 0x9FFF, TokenClass::Single},   // CJK Unified Ideographs
+        {0xAC00, 0xD7AF, TokenClass::Single},   // Hangul Syllables
+    }};
+
+    static constexpr std::array<TokenClass, 128> ASCII_CLASSES = [] {
+        std::array<TokenClass, 128> t{};
+        for (char c : {' ', '\t', '\n', '\r'}) t[static_cast<uint8_t>(c)] = TokenClass::Space;
+        return t;
+    }();
+
+    static TokenClass token_class(char32_t cp) {
+        if (cp < 0x80) return ASCII_CLASSES[cp];
+        if (cp < SINGLE_RANGES.front().lo) return TokenClass::Word;
+        for (const auto& r : SINGLE_RANGES)
+            if (cp <= r.hi) return cp >= r.lo ? r.cls : TokenClass::Word;
+        return TokenClass::Word;
     }
 };
 
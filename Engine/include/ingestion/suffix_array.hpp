@@ -0,0 +1,40 @@
+/**
+ * @file suffix_array.hpp
+ * @brief Suffix and LCP arrays over codepoint text
+ *
+ * The suffix array is built by SA-IS directly over the codepoints: the
+ * alphabet is first rank-reduced to the distinct codepoints present, so the
+ * bucket arrays stay as small as the text's alphabet, and the only scratch
+ * beyond the result is the ranked text and one bit per position.
+ *
+ * The LCP array comes from the Φ method: permuted LCP (PLCP) in text order,
+ * where PLCP[i + 1] >= PLCP[i] - 1 keeps each scan short. Text positions are
+ * split into one range per thread; each range restarts its carry at zero, so
+ * chunks are independent and the extra work is one LCP per chunk boundary.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Start positions of all suffixes of `text` in lexicographic order
+ *
+ * A suffix that is a prefix of another sorts first. Throws
+ * std::length_error if the text does not fit 32-bit positions.
+ */
+std::vector<uint32_t> build_suffix_array(const std::u32string& text);
+
+/**
+ * @brief lcp[i] = common prefix length of suffixes sa[i - 1] and sa[i]; lcp[0] = 0
+ *
+ * Values are capped at `max_lcp`. Runs on all OpenMP threads.
+ */
+std::vector<uint32_t> build_lcp_array(const std::u32string& text, const std::vector<uint32_t>& sa,
+                                      uint32_t max_lcp = UINT32_MAX);
+
+} // namespace Hartonomous
@@ -0,0 +1,100 @@
+/**
+ * @file tensor_dedup.hpp
+ * @brief Content addressing of mined weight tensors across the models of a substrate
+ *
+ * Fine-tunes of one base model share most of their weights bit for bit, and
+ * the rest usually differ by a small delta. A (layer, projection) pass mines
+ * the same relations from the same tensor every time, so once a pass has
+ * landed its tensors are recorded in hartonomous_internal.MinedTensor under
+ * a mining key: BLAKE3 over the raw tensor bytes (dtype and shape included),
+ * the pass's type tag and the mining context (normalized embeddings, vocab
+ * and every setting that shapes mining). A later pass with the same key is
+ * an exact match and is not mined again.
+ *
+ * Each record also keeps a sketch: 64 evenly spaced rows, each projected
+ * onto 16 fixed random sign vectors. The cosine of two sketches tracks the
+ * cosine of the tensors, so a pass whose sketch is at least near_threshold
+ * similar to a recorded tensor of the same kind and shape is skipped too;
+ * only layers that moved further than that are mined.
+ *
+ *   HARTONOMOUS_TENSOR_DEDUP=0          mine every pass
+ *   HARTONOMOUS_TENSOR_DEDUP_NEAR=0.995 sketch similarity that counts as a
+ *                                       match (> 1 disables near matches)
+ */
+
+#pragma once
+
+#include <hashing/blake3_pipeline.hpp>
+#include <database/postgres_connection.hpp>
+#include <ingestion/safetensor_loader.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Hartonomous {
+
+class TensorDedup {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    static constexpr size_t SKETCH_ROWS = 64;
+    static constexpr size_t SKETCH_DIMS = 16;
+
+    struct Options {
+        bool enabled = true;
+        double near_threshold = 0.995;
+
+        // HARTONOMOUS_TENSOR_DEDUP, HARTONOMOUS_TENSOR_DEDUP_NEAR
+        static Options from_env();
+    };
+
+    // One pass's tensors: the indexed weight and, for Q*K, the query weight
+    struct Entry {
+        Hash mining_key{};
+        Hash tensor_digest{};
+        Hash query_digest{};          // Zero without a query tensor
+        std::string type_tag;
+        std::string tensor_name;
+        int32_t layer = -1;
+        std::vector<size_t> shape;    // Of the indexed weight
+        std::vector<float> sketch;    // Weight's, then the query weight's
+    };
+
+    enum class Match : uint8_t { None, Exact, Near };
+
+    explicit TensorDedup(PostgresConnection& db, const Options& opts = Options::from_env());
+
+    bool enabled() const noexcept { return opts_.enabled; }
+
+    // Read what was mined under `context` before; no-op when disabled
+    void load(const Hash& context);
+
+    // Digests and sketch of one pass's tensors (safe to call from many threads)
+    Entry describe(const TensorData& weight, const TensorData* query, const std::string& type_tag,
+                   int32_t layer) const;
+
+    // How `e` relates to what load() read; `similarity` gets the best sketch cosine for Near
+    Match match(const Entry& e, double* similarity = nullptr) const;
+
+    // Record passes whose relations have all landed, as mined under `content_id`
+    void record(const std::vector<Entry>& mined, const Hash& content_id);
+
+    // BLAKE3 over dtype, shape and the raw bytes (the float32 data when not mapped)
+    static Hash digest(const TensorData& t);
+
+    // SKETCH_ROWS x SKETCH_DIMS Rademacher projection of evenly spaced rows; empty unless 2-D
+    static std::vector<float> sketch(const TensorData& t);
+
+    static double sketch_similarity(const std::vector<float>& a, const std::vector<float>& b);
+
+private:
+    PostgresConnection& db_;
+    Options opts_;
+    Hash context_{};
+    std::unordered_set<Hash, HashHasher> keys_;
+    std::vector<Entry> known_;   // With sketches, for near matches
+};
+
+} // namespace Hartonomous
@@ -9,8 +9,10 @@
 #include <database/postgres_connection.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
 #include <storage/atom_lookup.hpp>
+#include <ingestion/ingest_progress.hpp>
 #include <ingestion/ngram_extractor.hpp>
 #include <ingestion/substrate_service.hpp>
+#include <storage/content_store.hpp>
 #include <utils/unicode.hpp>
 #include <string>
 #include <vector>
@@ -34,14 +36,49 @@ struct IngestionStats {
     size_t ngrams_significant = 0;
     size_t cooccurrences_found = 0;
     size_t cooccurrences_significant = 0;
+    size_t files_ingested = 0;
+    size_t files_skipped = 0;     // Content already stored, or repeated within the batch
+
+    IngestionStats& operator+=(const IngestionStats& o) {
+        atoms_total += o.atoms_total;
+        atoms_new += o.atoms_new;
+        compositions_total += o.compositions_total;
+        compositions_new += o.compositions_new;
+        relations_total += o.relations_total;
+        relations_new += o.relations_new;
+        evidence_count += o.evidence_count;
+        original_bytes += o.original_bytes;
+        stored_bytes += o.stored_bytes;
+        ngrams_extracted += o.ngrams_extracted;
+        ngrams_significant += o.ngrams_significant;
+        cooccurrences_found += o.cooccurrences_found;
+        cooccurrences_significant += o.cooccurrences_significant;
+        files_ingested += o.files_ingested;
+        files_skipped += o.files_skipped;
+        compression_ratio = original_bytes ? static_cast<double>(stored_bytes) / original_bytes : 0.0;
+        return *this;
+    }
 };
 
+/**
+ * @brief Where a text's compositions come from
+ *
+ * SuffixArray: substrings of min..max_ngram_size codepoints repeated at
+ * least min_frequency times, tiled longest first.
+ * Sequitur: the rules of the text's Sequitur grammar, which are nested and
+ * each used at least twice; the text is tiled by the grammar itself, opening
+ * rules longer than max_ngram_size into their parts. Needs the whole text at
+ * once, so files are never streamed in this mode.
+ */
+enum class CompositionDiscovery { SuffixArray, Sequitur };
+
 struct IngestionConfig {
     uint32_t min_ngram_size = 1;
     uint32_t max_ngram_size = 8;
     uint32_t min_frequency = 2;
     uint32_t cooccurrence_window = 5;
     uint32_t min_cooccurrence = 2;
+    CompositionDiscovery discovery = CompositionDiscovery::SuffixArray;
     BLAKE3Pipeline::Hash tenant_id;
     BLAKE3Pipeline::Hash user_id;
     uint16_t content_type = 1;
@@ -49,6 +86,16 @@ struct IngestionConfig {
     std::string language = "en";
     std::string source;
     std::string encoding = "utf-8";
+
+    // Files larger than one window are streamed (ingest_stream); 0 = never
+    size_t stream_window_bytes = size_t(64) << 20;
+    size_t stream_overlap_bytes = size_t(64) << 10;  // Context re-read from the previous window
+    uint32_t sketch_width_bits = 22;                  // Count-Min sketch: 4 x 2^bits counters
+
+    // Keep only adjacent pairs seen min_cooccurrence times. A Count-Min pass
+    // keeps rarer ones out of the exact pair table; streamed files judge each
+    // pair by its count over all windows so far. Off: every pair is stored
+    bool sketch_adjacency = false;
 };
 
 class TextIngester {
@@ -56,18 +103,56 @@ public:
     explicit TextIngester(PostgresConnection& db, const IngestionConfig& config = IngestionConfig());
     IngestionStats ingest(const std::string& text);
     IngestionStats ingest_file(const std::string& path);
+
+    /**
+     * @brief Ingest a file of any size in bounded memory
+     *
+     * The file is mmapped and cut into windows of stream_window_bytes that
+     * end on a line or sentence break (else a UTF-8 boundary). Each window is
+     * extracted on its own, with the last stream_overlap_bytes of the
+     * previous window prepended as context so n-grams across the cut are
+     * seen; its adjacencies are counted only from the window's own start.
+     *
+     * A composition must repeat within a window; whether it is frequent
+     * enough (min_frequency) is judged by a Count-Min sketch of n-gram
+     * counts over all windows so far. Each window's records go through an
+     * AsyncFlusher, deduplicated against the substrate's existing IDs, and
+     * the content record is written once every window has been flushed.
+     */
+    IngestionStats ingest_stream(const std::string& path);
+
+    /**
+     * @brief Ingest many files, each as its own content record
+     *
+     * The files are mmapped and hashed in parallel, and all of their content
+     * hashes are checked against the substrate in one query, so files
+     * already stored (or repeated within the batch) cost a hash and nothing
+     * else. New files are extracted on a pool of worker threads and stored
+     * by a single writer, one transaction per file; files past
+     * stream_window_bytes are then streamed one at a time.
+     */
+    IngestionStats ingest_files(const std::vector<std::string>& paths);
+
+    // ingest_files() over every regular file below `dir`
+    IngestionStats ingest_directory(const std::string& dir);
     void set_config(const IngestionConfig& config) { config_ = config; }
 
+    // Phases: "extract" and "store" for ingest(), "stream" (per window) for ingest_stream(),
+    // "hash" and "ingest" (per file) for ingest_files()
+    void set_progress(ProgressReporter* progress) { progress_ = progress; }
+
     void preload_atoms();
 
 private:
-    BLAKE3Pipeline::Hash create_content_record(const std::string& text, BLAKE3Pipeline::Hash* content_hash);
+    BLAKE3Pipeline::Hash content_id_of(const BLAKE3Pipeline::Hash& content_hash) const;
+    ContentRecord content_record(const BLAKE3Pipeline::Hash& content_hash, size_t bytes) const;
 
     PostgresConnection& db_;
     IngestionConfig config_;
     NGramExtractor extractor_;
     AtomLookup atom_lookup_;  
     bool atoms_preloaded_ = false;
+    ProgressReporter* progress_ = nullptr;
 };
 
 } // namespace Hartonomous
\ No newline at end of file
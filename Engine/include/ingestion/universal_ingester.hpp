@@ -1,5 +1,6 @@
 #pragma once
 
+#include <database/connection_pool.hpp>
 #include <ingestion/text_ingester.hpp>
 #include <ingestion/model_ingester.hpp>
 #include <filesystem>
@@ -8,10 +9,22 @@ namespace Hartonomous {
 
 /**
  * @brief Universal Ingester that dispatches to specific ingesters based on content type
+ *
+ * Every ingestion it runs reports to progress(), text and model alike.
  */
 class UniversalIngester {
 public:
-    explicit UniversalIngester(PostgresConnection& db) : db_(db), text_ingester_(db) {}
+    explicit UniversalIngester(PostgresConnection& db) : db_(db), text_ingester_(db) {
+        text_ingester_.set_progress(&progress_);
+    }
+    explicit UniversalIngester(ConnectionPool& pool)
+        : lease_(pool.acquire()), db_(*lease_), text_ingester_(db_) {
+        text_ingester_.set_progress(&progress_);
+    }
+    UniversalIngester(const UniversalIngester&) = delete;
+    UniversalIngester& operator=(const UniversalIngester&) = delete;
+
+    ProgressReporter& progress() { return progress_; }
 
     IngestionStats ingest_text(const std::string& text) {
         return text_ingester_.ingest(text);
@@ -27,6 +40,7 @@ public:
                (fs::exists(p / "model.safetensors") || fs::exists(p / "model.safetensors.index.json") || fs::exists(p / "pytorch_model.safetensors"))) {
                 
                 ModelIngester model_ingester(db_);
+                model_ingester.set_progress(&progress_);
                 auto mstats = model_ingester.ingest_package(p);
                 
                 // Map ModelIngestionStats to IngestionStats
@@ -39,9 +53,12 @@ public:
                 stats.atoms_total = mstats.atoms_created;
                 return stats;
             }
+            // Any other directory is a corpus of text files
+            return text_ingester_.ingest_directory(path);
         } else if (p.extension() == ".safetensors") {
             // Single safetensor file
             ModelIngester model_ingester(db_);
+            model_ingester.set_progress(&progress_);
             // For now, treat directory of the file as the package if no config.json
             auto mstats = model_ingester.ingest_package(p.parent_path());
             
@@ -56,7 +73,9 @@ public:
     }
 
 private:
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
+    ProgressReporter progress_;
     TextIngester text_ingester_;
 };
 
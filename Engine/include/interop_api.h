@@ -39,10 +39,37 @@ typedef void* h_walk_engine_t;
 //  Database Connection
 // =============================================================================
 
+// The handle is a bounded connection pool (HARTONOMOUS_POOL_SIZE, default:
+// hardware threads). An ingester handle holds one pooled connection until
+// destroyed. Walk, query, Godel and reasoning handles are safe to call from
+// many threads at once: each call checks out one of the handle's engine
+// instances, adding one (and a pooled connection) when all are busy. The
+// text store, centroid index, neighbor cache and A* position table behind
+// them are process-wide, so no handle or instance repeats their warmup.
+// With HARTONOMOUS_REPLICA_DSNS set, walk, query, Godel, reasoning and A*
+// handles and the composition lookups read from a streaming replica that is
+// within HARTONOMOUS_REPLICA_MAX_LAG_MS and has replayed the handle's last
+// ingestion; ingesters always write to the primary.
 HARTONOMOUS_API h_db_connection_t hartonomous_db_create(const char* connection_string);
 HARTONOMOUS_API void hartonomous_db_destroy(h_db_connection_t handle);
 HARTONOMOUS_API bool hartonomous_db_is_connected(h_db_connection_t handle);
 
+// Load one live relation graph snapshot for this database handle and have every
+// walk and reasoning call read it instead of querying per step; refreshed in the
+// background (HARTONOMOUS_GRAPH_REFRESH_MS). Idempotent.
+HARTONOMOUS_API bool hartonomous_db_share_relation_graph(h_db_connection_t handle);
+
+// Map the atom image (NULL or "": AtomLookup::default_image_path()) and the
+// relation graph snapshot file (NULL or "": RelationGraph::default_path())
+// once for the rest of the process. Every ingester, lookup and live graph
+// loading the same unchanged files then reads these mappings instead of
+// mapping and checksumming its own, and so does every process forked
+// afterwards: PostgreSQL's postmaster calls this when the extension is
+// preloaded, and all backends share one copy of the pages. A default path
+// with no file behind it is skipped; false if a named file is missing or
+// invalid, or if a default one is invalid.
+HARTONOMOUS_API bool hartonomous_preload_shared_caches(const char* atom_image, const char* relation_graph);
+
 // =============================================================================
 //  Core Primitives (Hashing & Projection)
 // =============================================================================
@@ -53,6 +80,20 @@ HARTONOMOUS_API bool hartonomous_codepoint_to_s3(uint32_t codepoint, double* out
 HARTONOMOUS_API void hartonomous_s3_to_hilbert(const double* in_4d, uint32_t entity_type, uint64_t* out_hi, uint64_t* out_lo);
 HARTONOMOUS_API void hartonomous_s3_compute_centroid(const double* points_4d, size_t count, double* out_4d);
 
+// Batch forms. codepoints_to_s3 writes 4 doubles per codepoint; false (nothing
+// written) if any is invalid. compute_centroids reduces consecutive groups of
+// counts[g] points each to one centroid per group.
+HARTONOMOUS_API bool hartonomous_codepoints_to_s3(const uint32_t* codepoints, size_t count, double* out_4d);
+HARTONOMOUS_API void hartonomous_s3_compute_centroids(const double* points_4d, const size_t* counts, size_t groups, double* out_4d);
+
+// Hopf map over column arrays, for visualization: forward takes S³ (x, y, z, w)
+// to S² (x, y, z); inverse lifts S² points to S³ at per-point fiber angles
+// (null for 0). inverse agrees with the scalar map to ~1e-15, not bit for bit.
+HARTONOMOUS_API void hartonomous_hopf_forward_batch(const double* x, const double* y, const double* z, const double* w, size_t count,
+                                                    double* out_x, double* out_y, double* out_z);
+HARTONOMOUS_API void hartonomous_hopf_inverse_batch(const double* x, const double* y, const double* z, const double* fiber_angle, size_t count,
+                                                    double* out_x, double* out_y, double* out_z, double* out_w);
+
 // =============================================================================
 //  Ingestion Service
 // =============================================================================
@@ -79,6 +120,32 @@ HARTONOMOUS_API void hartonomous_ingester_destroy(h_ingester_t handle);
 HARTONOMOUS_API bool hartonomous_ingest_text(h_ingester_t handle, const char* text, HIngestionStats* out_stats);
 HARTONOMOUS_API bool hartonomous_ingest_file(h_ingester_t handle, const char* file_path, HIngestionStats* out_stats);
 
+// Progress of the ingester's current (or last) ingestion. Work is counted in
+// bytes per phase: text bytes for text, tensor bytes for models. Rates and
+// ETA are for the current phase; eta_sec is -1 when unknown.
+typedef struct HIngestProgress {
+    char phase[32];
+    uint64_t bytes_done;
+    uint64_t bytes_total;           // 0 when unknown
+    uint64_t records;               // Rows emitted since the ingestion began
+    double elapsed_sec;             // Since the phase began
+    double bytes_per_sec;
+    double records_per_sec;
+    double eta_sec;
+    bool finished;
+} HIngestProgress;
+
+// Called on an ingesting thread at phase changes, at the end, and otherwise
+// at most once per interval_ms. It must return quickly and must not call
+// back into the ingester. NULL removes it.
+typedef void (*HIngestProgressCallback)(const HIngestProgress* progress, void* user_data);
+
+HARTONOMOUS_API bool hartonomous_ingester_set_progress(h_ingester_t handle, HIngestProgressCallback callback,
+                                                       void* user_data, uint32_t interval_ms);
+
+// Safe to call from any thread while an ingestion runs on the handle
+HARTONOMOUS_API bool hartonomous_ingester_get_progress(h_ingester_t handle, HIngestProgress* out_progress);
+
 // =============================================================================
 //  Walk Engine
 // =============================================================================
@@ -103,6 +170,8 @@ typedef struct HWalkState {
     uint8_t current_composition[16];
     double current_position[4];
     double current_energy;
+    uint64_t rng_key;         // Sampling stream; set with hartonomous_walk_seed for repeatable walks
+    uint64_t rng_step;        // Draws taken from it
 } HWalkState;
 
 typedef struct HWalkStepResult {
@@ -118,6 +187,8 @@ HARTONOMOUS_API void hartonomous_walk_destroy(h_walk_engine_t handle);
 HARTONOMOUS_API bool hartonomous_walk_init(h_walk_engine_t handle, const uint8_t* start_id, double initial_energy, HWalkState* out_state);
 HARTONOMOUS_API bool hartonomous_walk_step(h_walk_engine_t handle, HWalkState* in_out_state, const HWalkParameters* params, HWalkStepResult* out_result);
 HARTONOMOUS_API bool hartonomous_walk_set_goal(h_walk_engine_t handle, HWalkState* in_out_state, const uint8_t* goal_id);
+// Same seed and stream, same start: the same steps on any process
+HARTONOMOUS_API void hartonomous_walk_seed(HWalkState* in_out_state, uint64_t seed, uint64_t stream);
 
 // =============================================================================
 //  Text Generation (Walk → Text)
@@ -130,6 +201,7 @@ typedef struct HGenerateParams {
     double top_p;             // Reserved (walk uses softmax naturally)
     size_t n;                 // Number of independent walks (choices)
     char stop_text[256];      // If set, walk toward this as goal
+    uint64_t seed;            // Nonzero: repeatable walk; 0 draws a fresh seed
 } HGenerateParams;
 
 typedef struct HGenerateResult {
@@ -175,6 +247,11 @@ HARTONOMOUS_API void hartonomous_query_destroy(h_query_t handle);
 HARTONOMOUS_API bool hartonomous_query_related(h_query_t handle, const char* text, size_t limit,
                                                HQueryResult** out_results, size_t* out_count);
 
+// Find compositions whose S3 centroids lie nearest the text's centroid (fuzzy
+// lookup; confidence = 1 - geodesic / pi). Caller must free results.
+HARTONOMOUS_API bool hartonomous_query_nearest(h_query_t handle, const char* text, size_t limit,
+                                               HQueryResult** out_results, size_t* out_count);
+
 // Find gravitational truth (topological consensus). Caller must free results.
 HARTONOMOUS_API bool hartonomous_query_truth(h_query_t handle, const char* text, double min_elo,
                                               size_t limit, HQueryResult** out_results, size_t* out_count);
@@ -185,6 +262,35 @@ HARTONOMOUS_API bool hartonomous_query_answer(h_query_t handle, const char* ques
 // Free query results array
 HARTONOMOUS_API void hartonomous_query_free_results(HQueryResult* results, size_t count);
 
+// Results of several queries packed into one allocation, freed with one call.
+// Results of query q are [query_offsets[q], query_offsets[q + 1]); result i's
+// UTF-8 text starts at text + text_offsets[i], is NUL-terminated, and is
+// text_offsets[i + 1] - text_offsets[i] - 1 bytes long.
+typedef struct HResultSet {
+    size_t query_count;
+    size_t count;                    // Results over all queries
+    const uint64_t* query_offsets;   // query_count + 1 entries
+    const double* confidences;       // count entries
+    const uint64_t* text_offsets;    // count + 1 entries
+    const char* text;
+} HResultSet;
+
+// find_related / find_nearest / find_gravitational_truth of each of texts[0..query_count)
+// in one call. *out_set is NULL on failure; free it with hartonomous_result_set_free.
+HARTONOMOUS_API bool hartonomous_query_related_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                                     size_t limit, HResultSet** out_set);
+HARTONOMOUS_API bool hartonomous_query_nearest_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                                     size_t limit, HResultSet** out_set);
+HARTONOMOUS_API bool hartonomous_query_truth_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                                   double min_elo, size_t limit, HResultSet** out_set);
+
+// answer of each of questions[0..question_count): zero or one result per question. Terms
+// shared between questions are resolved and ranked once.
+HARTONOMOUS_API bool hartonomous_query_answer_batch(h_query_t handle, const char* const* questions,
+                                                    size_t question_count, HResultSet** out_set);
+
+HARTONOMOUS_API void hartonomous_result_set_free(HResultSet* set);
+
 // =============================================================================
 //  Composition Lookup (Hash → Text)
 // =============================================================================
@@ -195,6 +301,16 @@ HARTONOMOUS_API char* hartonomous_composition_text(h_db_connection_t db_handle,
 // Look up S3 position for a composition. Returns false if not found.
 HARTONOMOUS_API bool hartonomous_composition_position(h_db_connection_t db_handle, const uint8_t* hash_16b, double* out_4d);
 
+// Up to k compositions nearest an S3 point, nearest first, from the process-wide
+// centroid index (built on first use). Writes k * 16 bytes of IDs and k geodesic
+// distances; *out_count is the number found.
+HARTONOMOUS_API bool hartonomous_composition_nearest(h_db_connection_t db_handle, const double* in_4d, size_t k,
+                                                     uint8_t* out_ids_16b, double* out_distances, size_t* out_count);
+
+// Add compositions created since the centroid index was loaded or last refreshed.
+// Returns false on error; *out_added may be NULL.
+HARTONOMOUS_API bool hartonomous_centroid_index_refresh(h_db_connection_t db_handle, size_t* out_added);
+
 // =============================================================================
 //  Godel Engine
 // =============================================================================
@@ -252,6 +368,8 @@ typedef struct HReasoningConfig {
     int max_reflexion_rounds;    // Max re-search attempts (default 3)
     bool include_trace;          // Include reasoning trace in output
     const char* system_prompt;   // System prompt (NULL for none)
+    uint32_t deadline_ms;        // Streaming: cut the stream off after this long (0 = none)
+    size_t max_tokens;           // Streaming: cut the stream off after this many tokens (0 = none)
 } HReasoningConfig;
 
 typedef struct HReasoningResult {
@@ -263,10 +381,22 @@ typedef struct HReasoningResult {
     size_t nodes_expanded;       // Total A* nodes expanded
     char** reasoning_trace;      // Array of trace strings (NULL if not requested)
     size_t trace_count;
+    char finish_reason[64];      // Streaming: "complete", "length", "deadline", "cancelled"
 } HReasoningResult;
 
+// Return false to stop the stream
 typedef bool (*HReasoningStreamCallback)(const char* token, size_t step, void* user_data);
 
+// Cancellation handle for streaming calls. hartonomous_cancel may be called from
+// any thread (e.g. when the client disconnects); it aborts the database work in
+// flight and the stream returns with finish_reason "cancelled". One handle per call.
+typedef void* h_cancel_t;
+
+HARTONOMOUS_API h_cancel_t hartonomous_cancel_create(void);
+HARTONOMOUS_API void hartonomous_cancel(h_cancel_t handle);
+HARTONOMOUS_API bool hartonomous_cancel_requested(h_cancel_t handle);
+HARTONOMOUS_API void hartonomous_cancel_destroy(h_cancel_t handle);
+
 HARTONOMOUS_API h_reasoning_t hartonomous_reasoning_create(h_db_connection_t db_handle);
 HARTONOMOUS_API void hartonomous_reasoning_destroy(h_reasoning_t handle);
 
@@ -275,20 +405,148 @@ HARTONOMOUS_API bool hartonomous_reason(h_reasoning_t handle, const char* prompt
                                          const HReasoningConfig* config,
                                          HReasoningResult* out_result);
 
-// Streaming variant
+// Streaming variant: tokens as soon as the first hypothesis yields them.
+// The callback runs on the calling thread. cancel may be NULL.
 HARTONOMOUS_API bool hartonomous_reason_stream(h_reasoning_t handle, const char* prompt,
                                                 const HReasoningConfig* config,
                                                 HReasoningStreamCallback callback,
                                                 void* user_data,
+                                                h_cancel_t cancel,
                                                 HReasoningResult* out_result);
 
+// A conversation's reasoning context, kept alive between turns: the last
+// turns' keywords and the compositions, facts and A* paths already worked out
+// for them, so a follow-up costs the same however long the conversation is.
+// Not tied to a reasoning handle; calls on one session run one at a time.
+typedef void* h_reasoning_session_t;
+
+HARTONOMOUS_API h_reasoning_session_t hartonomous_reasoning_session_create(void);
+HARTONOMOUS_API void hartonomous_reasoning_session_destroy(h_reasoning_session_t session);
+
+// One turn of the conversation in `session`; the prompt and response become its latest turns
+HARTONOMOUS_API bool hartonomous_reason_turn(h_reasoning_t handle, h_reasoning_session_t session,
+                                              const char* prompt, const HReasoningConfig* config,
+                                              HReasoningResult* out_result);
+
 // Quick answer (co-occurrence + A*, falls back to full reasoning)
 HARTONOMOUS_API bool hartonomous_quick_answer(h_reasoning_t handle, const char* prompt,
                                                HReasoningResult* out_result);
 
+// Quick answer of each of prompts[0..prompt_count) into out_results[0..prompt_count),
+// each freed with hartonomous_reasoning_free_result. On failure none need freeing.
+HARTONOMOUS_API bool hartonomous_quick_answer_batch(h_reasoning_t handle, const char* const* prompts,
+                                                     size_t prompt_count, HReasoningResult* out_results);
+
 // Free reasoning result (text + trace)
 HARTONOMOUS_API void hartonomous_reasoning_free_result(HReasoningResult* result);
 
+// =============================================================================
+//  Token Streams
+// =============================================================================
+
+// Single-producer/single-consumer ring the *_stream_ring calls write fragments
+// into instead of calling back per fragment. The streaming call blocks on its
+// own thread (waiting while the ring is full); the consumer drains whole frames
+// in bulk from any other thread. Each frame is an HTokenFrame followed by
+// `length` bytes of UTF-8, zero padded to a multiple of 8.
+typedef void* h_token_stream_t;
+
+typedef struct HTokenFrame {
+    uint32_t length;             // UTF-8 bytes after the header
+    uint32_t step;               // Walk or reasoning step of the fragment
+    double energy_remaining;     // Walk energy after the step (0 for reasoning)
+} HTokenFrame;
+
+// capacity_bytes is rounded up to a power of two, at least 4096
+HARTONOMOUS_API h_token_stream_t hartonomous_token_stream_create(size_t capacity_bytes);
+// Cancels the stream if its call is still running; the call returns on its next fragment
+HARTONOMOUS_API void hartonomous_token_stream_destroy(h_token_stream_t handle);
+
+// Copy every whole frame that fits into buffer; returns bytes copied (0: none ready).
+// A buffer of the stream's capacity always takes at least one frame.
+HARTONOMOUS_API size_t hartonomous_token_stream_read(h_token_stream_t handle, void* buffer, size_t capacity);
+// Block until a frame is ready or the stream ended, up to timeout_ms (negative: no limit).
+// Read until 0 before waiting again.
+HARTONOMOUS_API bool hartonomous_token_stream_wait(h_token_stream_t handle, int timeout_ms);
+// The call finished (or the stream was cancelled) and every frame has been read
+HARTONOMOUS_API bool hartonomous_token_stream_finished(h_token_stream_t handle);
+// Stop the streaming call at its next fragment; unread frames are dropped
+HARTONOMOUS_API void hartonomous_token_stream_cancel(h_token_stream_t handle);
+// eventfd readable with frames to read or once the stream ends, for epoll; -1 off Linux
+HARTONOMOUS_API int hartonomous_token_stream_event_fd(h_token_stream_t handle);
+
+// hartonomous_generate_stream writing into `stream`; the stream ends when it returns
+HARTONOMOUS_API bool hartonomous_generate_stream_ring(h_walk_engine_t walk_handle, h_db_connection_t db_handle,
+                                                       const char* prompt, const HGenerateParams* params,
+                                                       h_token_stream_t stream, HGenerateResult* out_result);
+
+// hartonomous_reason_stream writing into `stream`; the stream ends when it returns. cancel may be NULL.
+HARTONOMOUS_API bool hartonomous_reason_stream_ring(h_reasoning_t handle, const char* prompt,
+                                                     const HReasoningConfig* config,
+                                                     h_token_stream_t stream,
+                                                     h_cancel_t cancel,
+                                                     HReasoningResult* out_result);
+
+// =============================================================================
+//  A* Path Search
+// =============================================================================
+
+typedef void* h_astar_t;
+
+typedef struct HPathResult {
+    char* path;               // Node texts joined by " -> " (caller must free with hartonomous_free_string)
+    size_t length;            // Nodes on the path, start and goal included
+    size_t nodes_expanded;
+    double total_cost;
+    double avg_elo;
+    bool found;
+} HPathResult;
+
+HARTONOMOUS_API h_astar_t hartonomous_astar_create(h_db_connection_t db_handle);
+HARTONOMOUS_API void hartonomous_astar_destroy(h_astar_t handle);
+
+// Cheapest path between two terms; max_expansions 0 keeps the default limit
+HARTONOMOUS_API bool hartonomous_astar_search_text(h_astar_t handle, const char* start_text, const char* goal_text,
+                                                   size_t max_expansions, HPathResult* out_result);
+
+// =============================================================================
+//  Engine Statistics
+// =============================================================================
+
+// Counters since the library loaded; subtract two snapshots to measure a window
+typedef struct HEngineStats {
+    uint64_t db_queries;            // Statements sent by every connection in the process
+    uint64_t db_queries_thread;     // Statements sent by the calling thread
+    uint64_t neighbor_cache_hits;
+    uint64_t neighbor_cache_misses;
+    uint64_t answer_cache_hits;     // quick_answer and answer_question response caches
+    uint64_t answer_cache_misses;
+} HEngineStats;
+
+HARTONOMOUS_API void hartonomous_engine_stats(HEngineStats* out_stats);
+
+// Every registered counter, histogram and span in Prometheus text format.
+// Caller must free with hartonomous_free_string.
+HARTONOMOUS_API char* hartonomous_metrics_prometheus(void);
+
+// The `limit` statements with the most server time, grouped by fingerprint
+// (literals replaced by ?), as a JSON array of {fingerprint, statement,
+// calls, total_ms, mean_ms, max_ms, rows, bytes}. Caller must free with
+// hartonomous_free_string.
+HARTONOMOUS_API char* hartonomous_db_statements_json(size_t limit);
+
+// Restart the statement aggregates (the Prometheus counters stay monotonic)
+HARTONOMOUS_API void hartonomous_db_statements_reset(void);
+
+// Budget for the engine caches of every handle in the process, in bytes
+// (0: unlimited); overrides HARTONOMOUS_MEMORY_BUDGET. Caches over it are
+// shrunk lowest priority first.
+HARTONOMOUS_API void hartonomous_memory_set_budget(uint64_t bytes);
+
+// Estimated bytes per engine cache as a JSON array of {cache, priority,
+// bytes, instances}, largest first. Caller must free with hartonomous_free_string.
+HARTONOMOUS_API char* hartonomous_memory_usage_json(void);
+
 #ifdef __cplusplus
 }
 #endif
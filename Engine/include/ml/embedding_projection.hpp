@@ -4,14 +4,132 @@
 #include <Eigen/Sparse>
 #include <Eigen/QR>
 #include <Spectra/SymEigsSolver.h>
-#include <Spectra/MatOp/SparseSymMatProd.h>
+#include <Spectra/SymEigsShiftSolver.h>
 #include <hnswlib/hnswlib.h>
 #include <omp.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include <cstdint>
 
+#if defined(EIGEN_USE_MKL_ALL)
+#include <Eigen/PardisoSupport>
+#include <mkl_spblas.h>
+#endif
+
 namespace hartonomous::ml {
 
+/**
+ * @brief Spectra operator y = L·x over a compressed symmetric sparse matrix
+ *
+ * With MKL the product is MKL's threaded sparse BLAS on an optimized handle;
+ * otherwise rows are split across OpenMP threads. The matrix is symmetric,
+ * so its column-major arrays are also its CSR arrays.
+ */
+class CsrSymMatProd {
+public:
+    using Scalar = double;
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    explicit CsrSymMatProd(const SparseMatrix& mat) : mat_(mat) {
+#if defined(EIGEN_USE_MKL_ALL)
+        static_assert(sizeof(MKL_INT) == sizeof(SparseMatrix::StorageIndex), "LP64 MKL expected");
+        auto* outer = const_cast<MKL_INT*>(mat_.outerIndexPtr());
+        if (mkl_sparse_d_create_csr(&handle_, SPARSE_INDEX_BASE_ZERO, static_cast<MKL_INT>(mat_.rows()),
+                                    static_cast<MKL_INT>(mat_.cols()), outer, outer + 1,
+                                    const_cast<MKL_INT*>(mat_.innerIndexPtr()),
+                                    const_cast<double*>(mat_.valuePtr())) != SPARSE_STATUS_SUCCESS) {
+            throw std::runtime_error("CsrSymMatProd could not create MKL sparse handle");
+        }
+        descr_.type = SPARSE_MATRIX_TYPE_GENERAL;
+        mkl_sparse_set_mv_hint(handle_, SPARSE_OPERATION_NON_TRANSPOSE, descr_, 1000);
+        mkl_sparse_optimize(handle_);
+#endif
+    }
+
+    ~CsrSymMatProd() {
+#if defined(EIGEN_USE_MKL_ALL)
+        mkl_sparse_destroy(handle_);
+#endif
+    }
+
+    CsrSymMatProd(const CsrSymMatProd&) = delete;
+    CsrSymMatProd& operator=(const CsrSymMatProd&) = delete;
+
+    Eigen::Index rows() const { return mat_.rows(); }
+    Eigen::Index cols() const { return mat_.cols(); }
+
+    void perform_op(const double* x_in, double* y_out) const {
+#if defined(EIGEN_USE_MKL_ALL)
+        mkl_sparse_d_mv(SPARSE_OPERATION_NON_TRANSPOSE, 1.0, handle_, descr_, x_in, 0.0, y_out);
+#else
+        const auto* outer = mat_.outerIndexPtr();
+        const auto* inner = mat_.innerIndexPtr();
+        const double* values = mat_.valuePtr();
+        const Eigen::Index n = mat_.rows();
+        #pragma omp parallel for schedule(static)
+        for (Eigen::Index i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (auto k = outer[i]; k < outer[i + 1]; ++k) sum += values[k] * x_in[inner[k]];
+            y_out[i] = sum;
+        }
+#endif
+    }
+
+private:
+    const SparseMatrix& mat_;
+#if defined(EIGEN_USE_MKL_ALL)
+    sparse_matrix_t handle_ = nullptr;
+    matrix_descr descr_{};
+#endif
+};
+
+/**
+ * @brief Spectra shift-solve operator y = (L - σI)⁻¹·x
+ *
+ * L - σI is factored once per shift: MKL PARDISO (threaded) when available,
+ * Eigen's SimplicialLDLT otherwise. With σ just below zero a positive
+ * semidefinite Laplacian becomes positive definite, and its smallest
+ * eigenvalues become the largest of the inverse, which Lanczos finds in a
+ * handful of restarts.
+ */
+class CsrShiftSolve {
+public:
+    using Scalar = double;
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    explicit CsrShiftSolve(const SparseMatrix& mat) : mat_(mat) {}
+
+    Eigen::Index rows() const { return mat_.rows(); }
+    Eigen::Index cols() const { return mat_.cols(); }
+
+    void set_shift(double sigma) {
+        SparseMatrix identity(mat_.rows(), mat_.cols());
+        identity.setIdentity();
+        const SparseMatrix shifted = mat_ - sigma * identity;
+        factor_.compute(shifted);
+        if (factor_.info() != Eigen::Success) {
+            throw std::runtime_error("CsrShiftSolve could not factor the shifted Laplacian");
+        }
+    }
+
+    void perform_op(const double* x_in, double* y_out) const {
+        Eigen::Map<const Eigen::VectorXd> x(x_in, mat_.rows());
+        Eigen::Map<Eigen::VectorXd>(y_out, mat_.rows()) = factor_.solve(x);
+    }
+
+private:
+    const SparseMatrix& mat_;
+#if defined(EIGEN_USE_MKL_ALL)
+    Eigen::PardisoLDLT<SparseMatrix> factor_;
+#else
+    Eigen::SimplicialLDLT<SparseMatrix> factor_;
+#endif
+};
+
 /**
  * @brief Embedding Projection: N-dimensional → 4D via Laplacian Eigenmaps
  *
@@ -40,6 +158,10 @@ namespace hartonomous::ml {
  *   - Hilbert curves for spatial indexing
  *
  * Result: ALL AI models → same 4D substrate (universal comparison)
+ *
+ * The k-NN index and spectrum are kept, so rows added later (new tokens,
+ * vocabulary extensions) are placed by project_out_of_sample() in one
+ * neighbor search each instead of a new eigen solve.
  */
 class EmbeddingProjection {
 public:
@@ -47,10 +169,16 @@ public:
     using MatrixXd = Eigen::MatrixXd;
     using SparseMatrix = Eigen::SparseMatrix<double>;
     using Vec4 = Eigen::Vector4d;
+    using MatrixXfRow = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 
     /**
      * @brief Configuration for projection
      */
+    enum class EigenSolver {
+        Lanczos,      ///< Restarted Lanczos on L itself: no factorization, many mat-vecs
+        ShiftInvert   ///< Lanczos on (L - σI)⁻¹: one sparse LDLT, converges in a few iterations
+    };
+
     struct Config {
         int k_neighbors = 10;              ///< k for k-NN graph construction
         double sigma = 1.0;                ///< Gaussian kernel width
@@ -58,12 +186,16 @@ public:
         bool use_normalized_laplacian = true;  ///< Use normalized Laplacian (recommended)
         double eigenvalue_tolerance = 1e-6;    ///< Convergence tolerance for eigen solver
         int max_iterations = 1000;             ///< Max iterations for eigen solver
+        EigenSolver solver = EigenSolver::ShiftInvert;
+        double shift = -1e-3;              ///< σ for ShiftInvert; below 0 keeps L - σI definite
+        int krylov_dim = 0;                ///< Lanczos basis size; 0 picks max(2·nev + 1, 20)
     };
 
     /**
      * @brief Initialize projector with configuration
      */
-    EmbeddingProjection(const Config& config = Config())
+    EmbeddingProjection() = default;
+    explicit EmbeddingProjection(const Config& config)
         : config_(config) {}
 
     /**
@@ -78,15 +210,16 @@ public:
         const int n_samples = embeddings.rows();
         const int n_dims = embeddings.cols();
 
-        if (n_samples < config_.num_eigenvectors) {
+        // The solver needs more vectors than the trivial one plus the targets
+        if (n_samples <= config_.num_eigenvectors + 1 || n_dims == 0) {
             throw std::runtime_error("Not enough samples for 4D projection");
         }
 
-        // Step 1: Build k-NN graph
-        SparseMatrix adjacency = build_knn_graph(embeddings);
+        // Step 1: Build k-NN graph (float32 HNSW)
+        KnnGraph graph = build_knn_graph(embeddings);
 
-        // Step 2: Compute graph Laplacian
-        SparseMatrix laplacian = compute_laplacian(adjacency);
+        // Step 2: Assemble the graph Laplacian directly in CSR
+        SparseMatrix laplacian = compute_laplacian(graph);
 
         // Step 3: Solve eigenvalue problem (find smallest eigenvectors)
         MatrixXd eigenvectors = solve_eigenvalue_problem(laplacian);
@@ -98,6 +231,85 @@ public:
         return project_to_s3(orthonormal);
     }
 
+    /**
+     * @brief Place new embeddings on S³ without re-solving (Nyström extension)
+     *
+     * Each row's k nearest neighbors come from the index the last
+     * project_to_4d built, and its eigen-coordinates solve the eigenvector
+     * equation for one added vertex x with edges w_xj to those neighbors:
+     *   normalized:   f_k(x) = Σ_j w_xj v_k(j) / (√(d_x d_j) (1 - λ_k))
+     *   unnormalized: f_k(x) = Σ_j w_xj v_k(j) / (d_x - λ_k)
+     * The result goes through the same orthonormalization and S³
+     * normalization as the training rows. Cost is one HNSW search per row.
+     *
+     * @param embeddings K×M matrix in the space project_to_4d was given
+     * @param add_to_model Also add the rows as vertices, so later calls find them as neighbors
+     * @return MatrixXd K×4 matrix on S³
+     *
+     * @throws std::runtime_error without a prior project_to_4d, or on a dimension mismatch
+     */
+    MatrixXd project_out_of_sample(const MatrixXd& embeddings, bool add_to_model = false) {
+        if (!index_) {
+            throw std::runtime_error("project_out_of_sample needs a prior project_to_4d");
+        }
+        if (embeddings.cols() != dim_) {
+            throw std::runtime_error("Out-of-sample embeddings have the wrong dimension");
+        }
+
+        const int m = embeddings.rows();
+        const int nev = eigen_coords_.cols();
+        const int k = std::min<int>(config_.k_neighbors, eigen_coords_.rows());
+        const MatrixXfRow embeddings_f = embeddings.cast<float>();
+        const double inv_two_sigma_sq = 1.0 / (2.0 * config_.sigma * config_.sigma);
+        const bool normalized = config_.use_normalized_laplacian;
+
+        MatrixXd coords(m, nev);
+        VectorXd degree(m);
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < m; ++i) {
+            auto neighbors = index_->searchKnn(embeddings_f.row(i).data(), k);
+            VectorXd sum = VectorXd::Zero(nev);
+            double d = 0.0;
+            while (!neighbors.empty()) {
+                auto [dist_sq, j] = neighbors.top();
+                neighbors.pop();
+                const double w = std::exp(-double(dist_sq) * inv_two_sigma_sq);
+                d += w;
+                const double scale = normalized ? (degree_[j] > 0.0 ? w / std::sqrt(degree_[j]) : 0.0) : w;
+                sum += scale * eigen_coords_.row(j).transpose();
+            }
+            for (int c = 0; c < nev; ++c) {
+                const double denom = normalized ? std::sqrt(d) * (1.0 - eigenvalues_[c]) : d - eigenvalues_[c];
+                coords(i, c) = denom != 0.0 ? sum[c] / denom : 0.0;
+            }
+            degree[i] = d;
+        }
+
+        if (add_to_model && m > 0) {
+            const int n = eigen_coords_.rows();
+            if (index_->getCurrentElementCount() + m > index_->getMaxElements()) {
+                index_->resizeIndex(std::max<size_t>(index_->getMaxElements() * 2, n + m));
+            }
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (int i = 0; i < m; ++i) {
+                index_->addPoint(embeddings_f.row(i).data(), n + i);
+            }
+            eigen_coords_.conservativeResize(n + m, Eigen::NoChange);
+            eigen_coords_.bottomRows(m) = coords;
+            degree_.conservativeResize(n + m);
+            degree_.tail(m) = degree;
+        }
+
+        // Step 4-5 of project_to_4d with the training basis
+        return project_to_s3(coords * r_inv_);
+    }
+
+    /**
+     * @brief Vertices project_out_of_sample can draw neighbors from (0 before project_to_4d)
+     */
+    int model_size() const { return index_ ? static_cast<int>(eigen_coords_.rows()) : 0; }
+
     /**
      * @brief Extract embeddings from AI model and project to 4D
      *
@@ -122,74 +334,86 @@ public:
     }
 
 private:
-    Config config_;
+    Config config_{};
+
+    // The last project_to_4d's graph and spectrum, for project_out_of_sample
+    std::unique_ptr<hnswlib::L2Space> space_;
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> index_;
+    int dim_ = 0;
+    MatrixXd eigen_coords_;    ///< N × num_eigenvectors, before orthonormalization
+    VectorXd eigenvalues_;     ///< Their Laplacian eigenvalues
+    VectorXd degree_;          ///< Row sums of W
+    MatrixXd r_inv_;           ///< eigen_coords_ · r_inv_ = the orthonormal basis
+
+    /**
+     * @brief Directed k-NN lists: row i's neighbors and Gaussian weights
+     *
+     * Slots a search did not fill are -1.
+     */
+    struct KnnGraph {
+        int n = 0;
+        int k = 0;
+        std::vector<int> neighbors;   ///< n × k
+        std::vector<double> weights;  ///< n × k
+    };
 
     /**
      * @brief Build k-NN graph from embeddings using HNSW
      *
      * Uses HNSWLib for O(n log n) approximate nearest neighbor search
-     * instead of naive O(n²) brute force.
+     * instead of naive O(n²) brute force. Points are inserted and searched
+     * in float32 from all threads.
      *
      * @param embeddings N×M matrix
-     * @return SparseMatrix N×N adjacency matrix (symmetric)
+     * @return KnnGraph N×k neighbor lists
      */
-    SparseMatrix build_knn_graph(const MatrixXd& embeddings) {
+    KnnGraph build_knn_graph(const MatrixXd& embeddings) {
         const int n = embeddings.rows();
         const int dim = embeddings.cols();
-
-        // Build HNSW index - O(n log n) construction
-        hnswlib::L2Space space(dim);
-        hnswlib::HierarchicalNSW<float> index(&space, n, 16, 200);
-
-        // Convert to float and add to index
-        Eigen::MatrixXf embeddings_f = embeddings.cast<float>();
-        for (int i = 0; i < n; ++i) {
+        const int k = std::min(config_.k_neighbors, n - 1);
+
+        // Row-major, so each row is the contiguous vector hnswlib reads
+        const MatrixXfRow embeddings_f = embeddings.cast<float>();
+
+        // Build HNSW index - O(n log n) construction; kept for project_out_of_sample
+        space_ = std::make_unique<hnswlib::L2Space>(dim);
+        index_ = std::make_unique<hnswlib::HierarchicalNSW<float>>(space_.get(), n, 16, 200);
+        dim_ = dim;
+        auto& index = *index_;
+        index.addPoint(embeddings_f.row(0).data(), 0);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 1; i < n; ++i) {
             index.addPoint(embeddings_f.row(i).data(), i);
         }
 
         // Set ef for search quality
-        index.setEf(std::max(config_.k_neighbors * 2, 50));
-
-        // Use Eigen's efficient sparse matrix builder
-        std::vector<Eigen::Triplet<double>> triplets;
-        triplets.reserve(n * config_.k_neighbors * 2); // *2 for symmetry
-
-        #pragma omp parallel
-        {
-            std::vector<Eigen::Triplet<double>> local_triplets;
-            local_triplets.reserve((n / omp_get_num_threads() + 1) * config_.k_neighbors * 2);
-
-            #pragma omp for nowait
-            for (int i = 0; i < n; ++i) {
-                // HNSW search - O(log n) per query
-                auto neighbors = index.searchKnn(embeddings_f.row(i).data(), config_.k_neighbors + 1);
-
-                while (!neighbors.empty()) {
-                    auto [dist_sq, j] = neighbors.top();
-                    neighbors.pop();
+        index.setEf(std::max(k * 2, 50));
 
-                    if (i == j) continue;
+        KnnGraph graph;
+        graph.n = n;
+        graph.k = k;
+        graph.neighbors.assign(size_t(n) * k, -1);
+        graph.weights.assign(size_t(n) * k, 0.0);
+        const double inv_two_sigma_sq = 1.0 / (2.0 * config_.sigma * config_.sigma);
 
-                    // Gaussian kernel: w = exp(-dist² / (2σ²))
-                    double weight = std::exp(-dist_sq / (2.0 * config_.sigma * config_.sigma));
-
-                    // Add symmetric edges
-                    local_triplets.push_back({i, static_cast<int>(j), weight});
-                    local_triplets.push_back({static_cast<int>(j), i, weight});
-                }
-            }
-
-            #pragma omp critical
-            {
-                triplets.insert(triplets.end(), local_triplets.begin(), local_triplets.end());
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int i = 0; i < n; ++i) {
+            // HNSW search - O(log n) per query
+            auto neighbors = index.searchKnn(embeddings_f.row(i).data(), k + 1);
+            int slot = 0;
+            while (!neighbors.empty()) {
+                auto [dist_sq, j] = neighbors.top();
+                neighbors.pop();
+                if (static_cast<int>(j) == i || slot == k) continue;
+
+                // Gaussian kernel: w = exp(-dist² / (2σ²))
+                graph.neighbors[size_t(i) * k + slot] = static_cast<int>(j);
+                graph.weights[size_t(i) * k + slot] = std::exp(-double(dist_sq) * inv_two_sigma_sq);
+                ++slot;
             }
         }
 
-        // Build sparse matrix
-        SparseMatrix adjacency(n, n);
-        adjacency.setFromTriplets(triplets.begin(), triplets.end());
-
-        return adjacency;
+        return graph;
     }
 
     /**
@@ -199,75 +423,102 @@ private:
      * or
      * L = I - D^(-1/2) W D^(-1/2) (normalized, recommended)
      *
-     * @param adjacency N×N adjacency matrix W
+     * W symmetrizes the k-NN lists: each edge i→j adds its weight to W_ij
+     * and W_ji. The CSR arrays are written directly (sorted columns,
+     * explicit diagonal) rather than through triplets, so assembly costs
+     * one counting pass, one scatter and a per-row sort. L is symmetric, so
+     * the compressed column-major matrix returned has the same arrays.
+     *
+     * @param graph k-NN lists from build_knn_graph
      * @return SparseMatrix N×N Laplacian matrix
      */
-    SparseMatrix compute_laplacian(const SparseMatrix& adjacency) {
-        const int n = adjacency.rows();
-
-        // Compute degree matrix D
-        VectorXd degree = VectorXd::Zero(n);
-        for (int k = 0; k < adjacency.outerSize(); ++k) {
-            for (SparseMatrix::InnerIterator it(adjacency, k); it; ++it) {
-                degree[it.row()] += it.value();
-            }
+    SparseMatrix compute_laplacian(const KnnGraph& graph) {
+        const int n = graph.n;
+        const int k = graph.k;
+
+        // Both directions of every edge, bucketed by row
+        std::vector<int> start(n + 1, 0);
+        for (size_t e = 0; e < graph.neighbors.size(); ++e) {
+            const int j = graph.neighbors[e];
+            if (j < 0) continue;
+            ++start[e / k + 1];
+            ++start[j + 1];
         }
+        std::partial_sum(start.begin(), start.end(), start.begin());
 
-        if (config_.use_normalized_laplacian) {
-            // Normalized Laplacian: L = I - D^(-1/2) W D^(-1/2)
-
-            // Compute D^(-1/2)
-            VectorXd d_inv_sqrt = degree.array().sqrt().inverse();
-
-            // Build L = I - D^(-1/2) W D^(-1/2)
-            std::vector<Eigen::Triplet<double>> triplets;
-            triplets.reserve(adjacency.nonZeros() + n);
-
-            // Add identity diagonal
-            for (int i = 0; i < n; ++i) {
-                triplets.push_back({i, i, 1.0});
+        std::vector<std::pair<int, double>> edges(start[n]);
+        {
+            std::vector<int> cursor(start.begin(), start.end() - 1);
+            for (size_t e = 0; e < graph.neighbors.size(); ++e) {
+                const int j = graph.neighbors[e];
+                if (j < 0) continue;
+                const int i = static_cast<int>(e / k);
+                edges[cursor[i]++] = {j, graph.weights[e]};
+                edges[cursor[j]++] = {i, graph.weights[e]};
             }
+        }
 
-            // Subtract normalized adjacency
-            for (int k = 0; k < adjacency.outerSize(); ++k) {
-                for (SparseMatrix::InnerIterator it(adjacency, k); it; ++it) {
-                    double normalized_weight = -d_inv_sqrt[it.row()] * it.value() * d_inv_sqrt[it.col()];
-                    triplets.push_back({it.row(), it.col(), normalized_weight});
-                }
+        // Sort each row by column, sum duplicate (mutual) edges, take degrees
+        std::vector<int> row_nnz(n);
+        VectorXd degree(n);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < n; ++i) {
+            auto first = edges.begin() + start[i];
+            auto last = edges.begin() + start[i + 1];
+            std::sort(first, last, [](const auto& a, const auto& b) { return a.first < b.first; });
+            auto out = first;
+            double d = 0.0;
+            for (auto it = first; it != last; ++it) {
+                d += it->second;
+                if (out != first && (out - 1)->first == it->first) (out - 1)->second += it->second;
+                else *out++ = *it;
             }
+            row_nnz[i] = static_cast<int>(out - first) + 1;  // + diagonal
+            degree[i] = d;
+        }
 
-            SparseMatrix laplacian(n, n);
-            laplacian.setFromTriplets(triplets.begin(), triplets.end());
-            return laplacian;
-
-        } else {
-            // Unnormalized Laplacian: L = D - W
+        degree_ = degree;
 
-            std::vector<Eigen::Triplet<double>> triplets;
-            triplets.reserve(adjacency.nonZeros() + n);
+        // D^(-1/2), zero for an isolated vertex
+        VectorXd d_inv_sqrt(n);
+        for (int i = 0; i < n; ++i) d_inv_sqrt[i] = degree[i] > 0.0 ? 1.0 / std::sqrt(degree[i]) : 0.0;
+        const bool normalized = config_.use_normalized_laplacian;
 
-            // Add degree diagonal
-            for (int i = 0; i < n; ++i) {
-                triplets.push_back({i, i, degree[i]});
-            }
+        SparseMatrix laplacian(n, n);
+        auto* outer = laplacian.outerIndexPtr();
+        outer[0] = 0;
+        for (int i = 0; i < n; ++i) outer[i + 1] = outer[i] + row_nnz[i];
+        laplacian.resizeNonZeros(outer[n]);
+        auto* inner = laplacian.innerIndexPtr();
+        double* values = laplacian.valuePtr();
 
-            // Subtract adjacency
-            for (int k = 0; k < adjacency.outerSize(); ++k) {
-                for (SparseMatrix::InnerIterator it(adjacency, k); it; ++it) {
-                    triplets.push_back({it.row(), it.col(), -it.value()});
-                }
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < n; ++i) {
+            auto pos = outer[i];
+            bool diagonal_done = false;
+            const auto diagonal = [&] {
+                inner[pos] = i;
+                values[pos++] = normalized ? 1.0 : degree[i];
+                diagonal_done = true;
+            };
+            for (int e = start[i]; e < start[i] + row_nnz[i] - 1; ++e) {
+                const auto [j, w] = edges[e];
+                if (!diagonal_done && j > i) diagonal();
+                inner[pos] = j;
+                values[pos++] = normalized ? -d_inv_sqrt[i] * w * d_inv_sqrt[j] : -w;
             }
-
-            SparseMatrix laplacian(n, n);
-            laplacian.setFromTriplets(triplets.begin(), triplets.end());
-            return laplacian;
+            if (!diagonal_done) diagonal();
         }
+
+        return laplacian;
     }
 
     /**
      * @brief Solve eigenvalue problem using Spectra
      *
-     * Finds the smallest eigenvectors of the Laplacian (skip first trivial eigenvector).
+     * Finds the smallest eigenvectors of the Laplacian (skip first trivial
+     * eigenvector), by shift-invert (default) or plain Lanczos, both over
+     * the threaded operators above.
      *
      * @param laplacian N×N Laplacian matrix
      * @return MatrixXd N×4 matrix (first 4 non-trivial eigenvectors)
@@ -275,35 +526,51 @@ private:
     MatrixXd solve_eigenvalue_problem(const SparseMatrix& laplacian) {
         const int n = laplacian.rows();
 
-        // Use Spectra for efficient sparse eigenvalue computation
-        Spectra::SparseSymMatProd<double> op(laplacian);
-
         // We want the smallest eigenvalues (after the trivial zero eigenvalue)
         // So we request (num_eigenvectors + 1) and skip the first
-        int num_compute = config_.num_eigenvectors + 1;
-
-        Spectra::SymEigsSolver<Spectra::SparseSymMatProd<double>> eigs(
-            op,
-            num_compute,
-            2 * num_compute  // Size of Krylov subspace
-        );
-
-        // Initialize and compute
-        eigs.init();
-        int nconv = eigs.compute(
-            Spectra::SortRule::SmallestAlge,
-            config_.max_iterations,
-            config_.eigenvalue_tolerance
-        );
-
-        if (eigs.info() != Spectra::CompInfo::Successful) {
-            throw std::runtime_error("Eigenvalue computation failed");
+        const int num_compute = config_.num_eigenvectors + 1;
+        const int krylov = config_.krylov_dim > 0 ? config_.krylov_dim : std::max(2 * num_compute + 1, 20);
+        const int ncv = std::min(n, std::max(krylov, num_compute + 1));
+
+        VectorXd eigenvalues;
+        MatrixXd eigenvectors;
+        if (config_.solver == EigenSolver::ShiftInvert) {
+            CsrShiftSolve op(laplacian);
+            Spectra::SymEigsShiftSolver<CsrShiftSolve> eigs(op, num_compute, ncv, config_.shift);
+            eigs.init();
+            eigs.compute(Spectra::SortRule::LargestMagn, config_.max_iterations, config_.eigenvalue_tolerance);
+            if (eigs.info() != Spectra::CompInfo::Successful) {
+                throw std::runtime_error("Eigenvalue computation failed");
+            }
+            eigenvalues = eigs.eigenvalues();
+            eigenvectors = eigs.eigenvectors();
+        } else {
+            CsrSymMatProd op(laplacian);
+            Spectra::SymEigsSolver<CsrSymMatProd> eigs(op, num_compute, ncv);
+            eigs.init();
+            eigs.compute(Spectra::SortRule::SmallestAlge, config_.max_iterations, config_.eigenvalue_tolerance);
+            if (eigs.info() != Spectra::CompInfo::Successful) {
+                throw std::runtime_error("Eigenvalue computation failed");
+            }
+            eigenvalues = eigs.eigenvalues();
+            eigenvectors = eigs.eigenvectors();
         }
 
+        // Spectra's output order differs between solvers; go by eigenvalue
+        std::vector<int> order(eigenvalues.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return eigenvalues[a] < eigenvalues[b]; });
+
         // Extract eigenvectors (skip first trivial eigenvector)
-        MatrixXd eigenvectors = eigs.eigenvectors().rightCols(config_.num_eigenvectors);
+        MatrixXd result(n, config_.num_eigenvectors);
+        eigenvalues_.resize(config_.num_eigenvectors);
+        for (int c = 0; c < config_.num_eigenvectors; ++c) {
+            result.col(c) = eigenvectors.col(order[c + 1]);
+            eigenvalues_[c] = eigenvalues[order[c + 1]];
+        }
+        eigen_coords_ = result;
 
-        return eigenvectors;
+        return result;
     }
 
     /**
@@ -324,6 +591,10 @@ private:
         // thinQ gives us only the first 'cols' columns we need
         MatrixXd Q = qr.householderQ() * MatrixXd::Identity(vectors.rows(), vectors.cols());
 
+        // vectors = Q·R, so R⁻¹ carries out-of-sample rows into the same basis
+        const int c = vectors.cols();
+        r_inv_ = qr.matrixQR().topRows(c).triangularView<Eigen::Upper>().solve(MatrixXd::Identity(c, c));
+
         return Q;
     }
 
@@ -383,6 +654,8 @@ private:
  */
 class BatchEmbeddingProjection {
 public:
+    using MatrixXd = EmbeddingProjection::MatrixXd;
+
     /**
      * @brief Project large embedding matrix in batches
      *
@@ -9,6 +9,11 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 #include <database/postgres_connection.hpp>
 #include <storage/physicality_store.hpp>
@@ -17,6 +22,10 @@
 #include <storage/composition_store.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <hashing/hash_table_128.hpp>
+#include <ingestion/async_flusher.hpp>
+#include <ingestion/relation_edge.hpp>
+#include <utils/thread_config.hpp>
 
 namespace hartonomous::ml {
 
@@ -72,10 +81,108 @@ struct ExtractedGraph {
     int32_t num_layers = 0;
 };
 
+/**
+ * @brief Receives edges from a streaming extractor, one chunk per call
+ *
+ * Calls never overlap, but may come from any of the extractor's threads. The
+ * sink owns the chunk. An exception it throws stops the extraction and is
+ * rethrown by stream() once its threads have finished.
+ */
+using EdgeSink = std::function<void(std::vector<SemanticEdge>&&)>;
+
+/// Edges per EdgeSink call unless a stream() caller asks otherwise
+constexpr size_t DEFAULT_EDGE_CHUNK = 16384;
+
+namespace detail {
+
+/**
+ * @brief Per-thread edge buffers handed to an EdgeSink as they fill
+ */
+class EdgeChunker {
+public:
+    EdgeChunker(const EdgeSink& sink, size_t chunk_edges)
+        : sink_(sink), chunk_edges_(std::max<size_t>(1, chunk_edges)) {}
+
+    void push(std::vector<SemanticEdge>& buffer, SemanticEdge&& edge) {
+        buffer.push_back(std::move(edge));
+        if (buffer.size() >= chunk_edges_) flush(buffer);
+    }
+
+    void flush(std::vector<SemanticEdge>& buffer) {
+        if (!buffer.empty() && !failed()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            try {
+                emitted_ += buffer.size();
+                sink_(std::move(buffer));
+            } catch (...) {
+                if (!error_) error_ = std::current_exception();
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+        buffer.clear();
+        buffer.reserve(chunk_edges_);
+    }
+
+    bool failed() const noexcept { return failed_.load(std::memory_order_relaxed); }
+
+    // Edges handed to the sink; rethrows what the sink threw
+    size_t finish() {
+        if (error_) std::rethrow_exception(error_);
+        return emitted_;
+    }
+
+private:
+    const EdgeSink& sink_;
+    size_t chunk_edges_;
+    std::mutex mutex_;
+    size_t emitted_ = 0;
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Calls f(k, v[k]) for every |v[k]| (or v[k]) >= threshold
+ *
+ * Blocks whose largest value is below the threshold cost one vectorized
+ * max reduction, so mostly-sparse weights are skipped at SIMD speed.
+ */
+template <bool Abs, typename T, typename F>
+void scan_at_least(const T* v, Eigen::Index n, double threshold, F&& f) {
+    constexpr Eigen::Index BLOCK = 64;
+    for (Eigen::Index k0 = 0; k0 < n; k0 += BLOCK) {
+        const Eigen::Index len = std::min(BLOCK, n - k0);
+        Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> block(v + k0, len);
+        const T peak = Abs ? block.abs().maxCoeff() : block.maxCoeff();
+        if (static_cast<double>(peak) < threshold) continue;
+        for (Eigen::Index k = k0; k < k0 + len; ++k) {
+            const T value = Abs ? std::abs(v[k]) : v[k];
+            if (static_cast<double>(value) >= threshold) f(k, v[k]);
+        }
+    }
+}
+
+// Move parts onto the end of out in order, releasing each
+inline void append_all(std::vector<SemanticEdge>& out, std::vector<std::vector<SemanticEdge>>& parts) {
+    size_t total = out.size();
+    for (const auto& p : parts) total += p.size();
+    out.reserve(total);
+    for (auto& p : parts) {
+        out.insert(out.end(), std::make_move_iterator(p.begin()), std::make_move_iterator(p.end()));
+        std::vector<SemanticEdge>().swap(p);
+    }
+}
+
+} // namespace detail
+
 // ==============================================================================
 // 1. TRANSFORMER ATTENTION → ELO EDGES
 // ==============================================================================
 
+/**
+ * Matrix h of attention_weights is head h % 8 of layer h / 8. Heads are
+ * scanned in parallel, column by column (one key token at a time), so edges
+ * of a head come out grouped by target.
+ */
 class TransformerExtractor {
 public:
     static ExtractedGraph extract(
@@ -87,35 +194,78 @@ public:
         graph.architecture_type = "Transformer";
         graph.num_layers = static_cast<int32_t>(attention_weights.size());
 
-        for (size_t layer_head_idx = 0; layer_head_idx < attention_weights.size(); ++layer_head_idx) {
-            const Eigen::MatrixXd& attn = attention_weights[layer_head_idx];
-            int32_t layer = static_cast<int32_t>(layer_head_idx / 8);
-            int32_t head = static_cast<int32_t>(layer_head_idx % 8);
+        // One vector per head keeps the edge order independent of scheduling
+        std::vector<std::vector<SemanticEdge>> per_head(attention_weights.size());
+        Hartonomous::apply_thread_config();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int64_t h = 0; h < static_cast<int64_t>(attention_weights.size()); ++h) {
+            scan_head(attention_weights[h], tokens, static_cast<size_t>(h), sparsity_threshold,
+                      [&](SemanticEdge&& edge) { per_head[h].push_back(std::move(edge)); });
+        }
+        detail::append_all(graph.edges, per_head);
+        return graph;
+    }
 
-            for (int i = 0; i < attn.rows(); ++i) {
-                for (int j = 0; j < attn.cols(); ++j) {
-                    double weight = attn(i, j);
-                    if (weight < sparsity_threshold) continue;
+    /**
+     * @brief Extract without materializing the graph: edges go to `sink` in chunks
+     *
+     * @return Number of edges emitted
+     */
+    static size_t stream(
+        const std::vector<Eigen::MatrixXd>& attention_weights,
+        const std::vector<uint64_t>& tokens,
+        const EdgeSink& sink,
+        double sparsity_threshold = 0.01,
+        size_t chunk_edges = DEFAULT_EDGE_CHUNK
+    ) {
+        detail::EdgeChunker chunker(sink, chunk_edges);
+        Hartonomous::apply_thread_config();
+        #pragma omp parallel
+        {
+            std::vector<SemanticEdge> buffer;
+            #pragma omp for schedule(dynamic, 1)
+            for (int64_t h = 0; h < static_cast<int64_t>(attention_weights.size()); ++h) {
+                if (chunker.failed()) continue;
+                scan_head(attention_weights[h], tokens, static_cast<size_t>(h), sparsity_threshold,
+                          [&](SemanticEdge&& edge) { chunker.push(buffer, std::move(edge)); });
+            }
+            chunker.flush(buffer);
+        }
+        return chunker.finish();
+    }
 
+private:
+    template <typename Emit>
+    static void scan_head(const Eigen::MatrixXd& attn, const std::vector<uint64_t>& tokens,
+                          size_t layer_head_idx, double threshold, Emit&& emit) {
+        const int32_t layer = static_cast<int32_t>(layer_head_idx / 8);
+        const int32_t head = static_cast<int32_t>(layer_head_idx % 8);
+        for (Eigen::Index j = 0; j < attn.cols(); ++j) {
+            detail::scan_at_least<false>(attn.col(j).data(), attn.rows(), threshold,
+                [&](Eigen::Index i, double weight) {
                     SemanticEdge edge;
-                    edge.source_id = tokens[i];
-                    edge.target_id = tokens[j];
+                    edge.source_id = tokens[static_cast<size_t>(i)];
+                    edge.target_id = tokens[static_cast<size_t>(j)];
                     edge.weight = weight;
                     edge.edge_type = "attention";
                     edge.layer_index = layer;
                     edge.head_index = head;
-                    graph.edges.push_back(edge);
-                }
-            }
+                    emit(std::move(edge));
+                });
         }
-        return graph;
     }
+
 };
 
 // ==============================================================================
 // 2. CNN FILTERS → SPATIAL SEMANTIC EDGES
 // ==============================================================================
 
+/**
+ * filters is (out, in, kernel_y, kernel_x) in Eigen's column-major layout,
+ * so the out-channel weights of one (in, y, x) tap are contiguous; each run
+ * is thresholded as a block. Input channels are scanned in parallel.
+ */
 class CNNExtractor {
 public:
     static ExtractedGraph extract(
@@ -126,31 +276,72 @@ public:
         ExtractedGraph graph;
         graph.architecture_type = "CNN";
 
-        int out_channels = static_cast<int>(filters.dimension(0));
-        int in_channels = static_cast<int>(filters.dimension(1));
-        int k_h = static_cast<int>(filters.dimension(2));
-        int k_w = static_cast<int>(filters.dimension(3));
-
-        for (int oc = 0; oc < out_channels; ++oc) {
-            for (int ic = 0; ic < in_channels; ++ic) {
-                for (int y = 0; y < k_h; ++y) {
-                    for (int x = 0; x < k_w; ++x) {
-                        float weight = filters(oc, ic, y, x);
-                        if (std::abs(weight) < threshold) continue;
-
-                        SemanticEdge edge;
-                        edge.source_token = "feature:in:" + std::to_string(ic);
-                        edge.target_token = "feature:out:" + std::to_string(oc) + ":pos:" + std::to_string(y) + "," + std::to_string(x);
-                        edge.weight = std::tanh(std::abs(weight));
-                        edge.edge_type = "conv";
-                        edge.layer_index = layer_idx;
-                        graph.edges.push_back(edge);
-                    }
-                }
-            }
+        const int64_t in_channels = static_cast<int64_t>(filters.dimension(1));
+        std::vector<std::vector<SemanticEdge>> per_channel(static_cast<size_t>(in_channels));
+        Hartonomous::apply_thread_config();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int64_t ic = 0; ic < in_channels; ++ic) {
+            scan_channel(filters, static_cast<int>(ic), layer_idx, threshold,
+                         [&](SemanticEdge&& edge) { per_channel[ic].push_back(std::move(edge)); });
         }
+        detail::append_all(graph.edges, per_channel);
         return graph;
     }
+
+    /**
+     * @brief Extract without materializing the graph: edges go to `sink` in chunks
+     *
+     * @return Number of edges emitted
+     */
+    static size_t stream(
+        const Eigen::Tensor<float, 4>& filters,
+        int layer_idx,
+        const EdgeSink& sink,
+        double threshold = 0.1,
+        size_t chunk_edges = DEFAULT_EDGE_CHUNK
+    ) {
+        detail::EdgeChunker chunker(sink, chunk_edges);
+        const int64_t in_channels = static_cast<int64_t>(filters.dimension(1));
+        Hartonomous::apply_thread_config();
+        #pragma omp parallel
+        {
+            std::vector<SemanticEdge> buffer;
+            #pragma omp for schedule(dynamic, 1)
+            for (int64_t ic = 0; ic < in_channels; ++ic) {
+                if (chunker.failed()) continue;
+                scan_channel(filters, static_cast<int>(ic), layer_idx, threshold,
+                             [&](SemanticEdge&& edge) { chunker.push(buffer, std::move(edge)); });
+            }
+            chunker.flush(buffer);
+        }
+        return chunker.finish();
+    }
+
+private:
+    template <typename Emit>
+    static void scan_channel(const Eigen::Tensor<float, 4>& filters, int ic, int layer_idx,
+                             double threshold, Emit&& emit) {
+        const Eigen::Index out_channels = filters.dimension(0);
+        const Eigen::Index in_channels = filters.dimension(1);
+        const int k_h = static_cast<int>(filters.dimension(2));
+        const int k_w = static_cast<int>(filters.dimension(3));
+        const std::string source = "feature:in:" + std::to_string(ic);
+
+        for (int y = 0; y < k_h; ++y) {
+            for (int x = 0; x < k_w; ++x) {
+                const float* run = filters.data() + out_channels * (ic + in_channels * (y + k_h * static_cast<Eigen::Index>(x)));
+                detail::scan_at_least<true>(run, out_channels, threshold, [&](Eigen::Index oc, float weight) {
+                    SemanticEdge edge;
+                    edge.source_token = source;
+                    edge.target_token = "feature:out:" + std::to_string(oc) + ":pos:" + std::to_string(y) + "," + std::to_string(x);
+                    edge.weight = std::tanh(std::abs(weight));
+                    edge.edge_type = "conv";
+                    edge.layer_index = layer_idx;
+                    emit(std::move(edge));
+                });
+            }
+        }
+    }
 };
 
 // ==============================================================================
@@ -223,131 +414,52 @@ public:
 
 class HartonomousConverter {
 public:
+    using Hash = Hartonomous::BLAKE3Pipeline::Hash;
+
+    /**
+     * @brief IDs already emitted, so repeated tokens and pairs are written once
+     */
+    struct SeenIds {
+        Hartonomous::HashSet128 compositions;
+        Hartonomous::HashSet128 physicalities;
+        Hartonomous::HashSet128 relations;
+    };
+
     static void ingest_graph(
         Hartonomous::PostgresConnection& db,
         const ExtractedGraph& graph,
-        const Hartonomous::BLAKE3Pipeline::Hash& model_id
+        const Hash& model_id
     ) {
         using namespace Hartonomous;
-        using namespace hartonomous::spatial;
 
         if (graph.edges.empty()) return;
 
-        PostgresConnection::Transaction txn(db);
+        SubstrateBatch batch;
+        SeenIds seen;
+        for (const auto& edge : graph.edges) append_edge(batch, edge, model_id, seen);
 
-        auto get_comp_id = [&](const std::string& text) -> BLAKE3Pipeline::Hash {
-            std::vector<uint8_t> data = {0x43};
-            data.insert(data.end(), text.begin(), text.end());
-            return BLAKE3Pipeline::hash(data.data(), data.size());
-        };
-
-        // Compute default centroid at origin of S3
-        Eigen::Vector4d default_centroid(1, 0, 0, 0);
-
-        std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> comp_seen;
-        std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> phys_seen;
+        PostgresConnection::Transaction txn(db);
 
         // Phase 1: Physicalities + Compositions (must flush before relations)
         {
             PhysicalityStore phys_store(db, true, true);
             CompositionStore comp_store(db, true, true);
-
-            for (const auto& edge : graph.edges) {
-                for (int side = 0; side < 2; ++side) {
-                    std::string token = (side == 0)
-                        ? (!edge.source_token.empty() ? edge.source_token : std::to_string(edge.source_id))
-                        : (!edge.target_token.empty() ? edge.target_token : std::to_string(edge.target_id));
-
-                    auto cid = get_comp_id(token);
-                    if (!comp_seen.insert(cid).second) continue;
-
-                    // Physicality for this composition
-                    std::vector<uint8_t> pdata = {0x50};
-                    pdata.insert(pdata.end(), reinterpret_cast<const uint8_t*>(default_centroid.data()),
-                                 reinterpret_cast<const uint8_t*>(default_centroid.data()) + sizeof(double) * 4);
-                    auto pid = BLAKE3Pipeline::hash(pdata.data(), pdata.size());
-
-                    if (phys_seen.insert(pid).second) {
-                        Eigen::Vector4d hc;
-                        for (int d = 0; d < 4; ++d) hc[d] = (default_centroid[d] + 1.0) / 2.0;
-                        phys_store.store({pid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Composition),
-                                          default_centroid, {}});
-                    }
-                    comp_store.store({cid, pid});
-                }
-            }
+            for (const auto& r : batch.phys) phys_store.store(r);
+            for (const auto& r : batch.comp) comp_store.store(r);
             phys_store.flush();
             comp_store.flush();
         }
 
         // Phase 2: Relations, sequences, ratings, evidence
         {
-            PhysicalityStore phys_store(db, true, true);
             RelationStore rel_store(db, true, true);
             RelationSequenceStore rs_store(db, true, true);
             RelationRatingStore rating_store(db, true);
             RelationEvidenceStore ev_store(db, true, true);
-
-            for (const auto& edge : graph.edges) {
-                BLAKE3Pipeline::Hash sid, tid;
-                if (!edge.source_token.empty()) sid = get_comp_id(edge.source_token);
-                else sid = get_comp_id(std::to_string(edge.source_id));
-
-                if (!edge.target_token.empty()) tid = get_comp_id(edge.target_token);
-                else tid = get_comp_id(std::to_string(edge.target_id));
-
-                bool s_first = std::memcmp(sid.data(), tid.data(), 16) < 0;
-                const auto& lo = s_first ? sid : tid;
-                const auto& hi = s_first ? tid : sid;
-
-                uint8_t r_input[33];
-                r_input[0] = 0x52;
-                std::memcpy(r_input + 1, lo.data(), 16);
-                std::memcpy(r_input + 17, hi.data(), 16);
-                auto rid = BLAKE3Pipeline::hash(r_input, 33);
-
-                // Relation physicality (centroid of source+target, both at default)
-                std::vector<uint8_t> rpdata = {0x50};
-                rpdata.insert(rpdata.end(), reinterpret_cast<const uint8_t*>(default_centroid.data()),
-                              reinterpret_cast<const uint8_t*>(default_centroid.data()) + sizeof(double) * 4);
-                auto rpid = BLAKE3Pipeline::hash(rpdata.data(), rpdata.size());
-
-                if (phys_seen.insert(rpid).second) {
-                    Eigen::Vector4d hc;
-                    for (int d = 0; d < 4; ++d) hc[d] = (default_centroid[d] + 1.0) / 2.0;
-                    phys_store.store({rpid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Relation),
-                                      default_centroid, {}});
-                }
-
-                rel_store.store({rid, rpid});
-
-                // Relation sequence entries
-                for (uint32_t ord = 0; ord < 2; ++ord) {
-                    const auto& cid = (ord == 0) ? sid : tid;
-                    uint8_t sdata[37]; sdata[0] = 0x54;
-                    std::memcpy(sdata + 1, rid.data(), 16);
-                    std::memcpy(sdata + 17, cid.data(), 16);
-                    std::memcpy(sdata + 33, &ord, 4);
-                    rs_store.store({BLAKE3Pipeline::hash(sdata, 37), rid, cid, ord, 1});
-                }
-
-                // Evidence with context-aware hash
-                double strength = std::clamp(edge.weight, 0.0, 1.0);
-                std::string tag = edge.edge_type;
-                int32_t li = edge.layer_index;
-                std::vector<uint8_t> ev_input;
-                ev_input.insert(ev_input.end(), model_id.begin(), model_id.end());
-                ev_input.insert(ev_input.end(), rid.begin(), rid.end());
-                ev_input.insert(ev_input.end(), tag.begin(), tag.end());
-                ev_input.insert(ev_input.end(), reinterpret_cast<uint8_t*>(&li),
-                                reinterpret_cast<uint8_t*>(&li) + sizeof(li));
-                auto evid = BLAKE3Pipeline::hash(ev_input.data(), ev_input.size());
-
-                ev_store.store({evid, model_id, rid, true, (double)edge.to_elo(), strength});
-                rating_store.store({rid, 1, (double)edge.to_elo(), 32.0});
-            }
-
-            phys_store.flush();
+            for (const auto& r : batch.rel) rel_store.store(r);
+            for (const auto& r : batch.rel_seq) rs_store.store(r);
+            for (const auto& r : batch.rating) rating_store.store(r);
+            for (const auto& r : batch.evidence) ev_store.store(r);
             rel_store.flush();
             rs_store.flush();
             rating_store.flush();
@@ -356,6 +468,88 @@ public:
 
         txn.commit();
     }
+
+    /**
+     * @brief An EdgeSink that enqueues each chunk on `flusher` as one SubstrateBatch
+     *
+     * Records are the ones ingest_graph writes. Compositions and physicalities
+     * already sent through this sink are not sent again. The flusher runs with
+     * FK checks off, so a chunk's relations need not follow its compositions.
+     * `flusher` must outlive the sink.
+     */
+    static EdgeSink flusher_sink(Hartonomous::AsyncFlusher& flusher, const Hash& model_id) {
+        auto seen = std::make_shared<SeenIds>();
+        return [&flusher, model_id, seen](std::vector<SemanticEdge>&& chunk) {
+            auto batch = std::make_unique<Hartonomous::SubstrateBatch>();
+            for (const auto& edge : chunk) append_edge(*batch, edge, model_id, *seen);
+            flusher.enqueue(std::move(batch));
+        };
+    }
+
+    /**
+     * @brief Append the records of one edge: both compositions and their
+     *        physicality, the relation, its sequence, rating and evidence
+     */
+    static void append_edge(
+        Hartonomous::SubstrateBatch& batch,
+        const SemanticEdge& edge,
+        const Hash& model_id,
+        SeenIds& seen
+    ) {
+        using namespace Hartonomous;
+        using namespace hartonomous::spatial;
+
+        // Compute default centroid at origin of S3
+        static const Eigen::Vector4d default_centroid(1, 0, 0, 0);
+
+        auto default_physicality = [&](HilbertCurve4D::EntityType type) {
+            std::vector<uint8_t> pdata = {0x50};
+            pdata.insert(pdata.end(), reinterpret_cast<const uint8_t*>(default_centroid.data()),
+                         reinterpret_cast<const uint8_t*>(default_centroid.data()) + sizeof(double) * 4);
+            auto pid = BLAKE3Pipeline::hash(pdata.data(), pdata.size());
+
+            if (seen.physicalities.insert(pid).second) {
+                Eigen::Vector4d hc;
+                for (int d = 0; d < 4; ++d) hc[d] = (default_centroid[d] + 1.0) / 2.0;
+                batch.phys.push_back({pid, HilbertCurve4D::encode(hc, type), default_centroid, {}});
+            }
+            return pid;
+        };
+
+        Hash side_ids[2];
+        for (int side = 0; side < 2; ++side) {
+            std::string token = (side == 0)
+                ? (!edge.source_token.empty() ? edge.source_token : std::to_string(edge.source_id))
+                : (!edge.target_token.empty() ? edge.target_token : std::to_string(edge.target_id));
+
+            std::vector<uint8_t> data = {0x43};
+            data.insert(data.end(), token.begin(), token.end());
+            side_ids[side] = BLAKE3Pipeline::hash(data.data(), data.size());
+            if (!seen.compositions.insert(side_ids[side]).second) continue;
+
+            // Physicality for this composition
+            auto pid = default_physicality(HilbertCurve4D::EntityType::Composition);
+            batch.comp.push_back({side_ids[side], pid, std::move(token), {}});
+        }
+        const Hash& sid = side_ids[0];
+        const Hash& tid = side_ids[1];
+
+        // Relation rows only for a pair not emitted yet; its rating and evidence every time
+        auto rid = RelationEdge::relation_id(sid, tid);
+        if (seen.relations.insert(rid).second) {
+            // Both compositions sit at the default centroid, which RelationEdge falls back to
+            RelationEdge rel(rid, sid, tid, nullptr, nullptr);
+            if (seen.physicalities.insert(rel.physicality_id).second) batch.phys.push_back(rel.physicality());
+            batch.rel.push_back(rel.relation());
+            batch.rel_seq.push_back(rel.sequence(0));
+            batch.rel_seq.push_back(rel.sequence(1));
+        }
+
+        double strength = std::clamp(edge.weight, 0.0, 1.0);
+        auto evid = RelationEdge::evidence_id(model_id, rid, edge.edge_type, edge.layer_index);
+        batch.evidence.push_back({evid, model_id, rid, true, (double)edge.to_elo(), strength});
+        batch.rating.push_back({rid, 1, (double)edge.to_elo(), 32.0});
+    }
 };
 
 } // namespace hartonomous::ml
@@ -9,7 +9,12 @@
 namespace s3::ann
 {
     struct HnswIndexHandle;
-    HARTONOMOUS_API HnswIndexHandle* build_index(const std::vector<Vec4>& points);
+
+    // Points are unit vectors on S³: inner-product space, so distances are 1 - dot
+    HARTONOMOUS_API HnswIndexHandle* build_index(const std::vector<Vec4>& points, size_t M = 16,
+                                                 size_t ef_construction = 200, size_t ef_search = 64);
     HARTONOMOUS_API void free_index(HnswIndexHandle* h);
+
+    // (label, 1 - dot) of the k nearest points, nearest first
     HARTONOMOUS_API std::vector<std::pair<int, double>> query_index(HnswIndexHandle* h, const Vec4& q, int k);
 }
@@ -0,0 +1,122 @@
+/**
+ * @file centroid_index.hpp
+ * @brief Long-lived HNSW index over composition centroids on S³
+ *
+ * Fuzzy lookups (a prompt word with no exact composition, a misspelling, a
+ * phrase never ingested) resolve to the composition whose centroid is
+ * nearest the text's own centroid: the normalized mean of its atoms'
+ * positions, exactly as ingest places compositions. Centroids are unit
+ * vectors, so the graph uses inner product (1 - dot is monotone in
+ * geodesic distance) and hits are re-ranked by exact geodesic distance
+ * from the double-precision centroids kept beside the graph.
+ *
+ * The index is built once per process from physicality/composition and
+ * grows in place: ingesters add what they commit, and refresh() picks up
+ * compositions other processes created since the last load. Searches run
+ * concurrently under a shared lock; adds take it exclusively.
+ */
+
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <hnswlib/hnswlib.h>
+#include <Eigen/Core>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class AtomLookup;
+
+struct CentroidIndexParams {
+    size_t M = 16;
+    size_t ef_construction = 200;
+    size_t ef_search = 64;               // Raised to k for larger queries
+    std::chrono::seconds overlap{30};    // refresh() re-scans this far behind its watermark
+};
+
+class CentroidIndex {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+    using Vec4 = Eigen::Vector4d;
+    using Params = CentroidIndexParams;
+
+    struct Neighbor {
+        Hash id;
+        double distance;  // Geodesic
+    };
+
+    explicit CentroidIndex(const Params& params = {});
+
+    CentroidIndex(const CentroidIndex&) = delete;
+    CentroidIndex& operator=(const CentroidIndex&) = delete;
+
+    // Every composition centroid in the database
+    static std::shared_ptr<CentroidIndex> load_from_db(PostgresConnection& db, const Params& params = {});
+
+    /**
+     * @brief Process-wide index, loaded on first use
+     *
+     * Later calls return the same instance without touching the database.
+     */
+    static std::shared_ptr<CentroidIndex> shared(PostgresConnection& db);
+
+    // The process-wide index if shared() has loaded it, else nullptr
+    static std::shared_ptr<CentroidIndex> loaded();
+
+    /**
+     * @brief Insert compositions not yet indexed
+     * @return Number inserted (known IDs are skipped)
+     */
+    size_t add(const std::vector<std::pair<Hash, Vec4>>& entries);
+    bool add(const Hash& id, const Vec4& centroid);
+
+    /**
+     * @brief Add compositions created since the last load or refresh
+     * @return Number inserted
+     */
+    size_t refresh(PostgresConnection& db);
+
+    // Up to k compositions nearest `point`, nearest first
+    std::vector<Neighbor> nearest(const Vec4& point, size_t k) const;
+
+    /**
+     * @brief Centroid ingest would give `text`, from its atoms' positions
+     *
+     * nullopt if no codepoint of the text is a seeded atom.
+     */
+    static std::optional<Vec4> text_centroid(AtomLookup& atoms, std::string_view text);
+
+    // nearest() to text_centroid(); empty if the text has no atoms
+    std::vector<Neighbor> nearest_text(AtomLookup& atoms, std::string_view text, size_t k) const;
+
+    size_t size() const;
+    bool contains(const Hash& id) const;
+
+    // Stored centroid of an indexed composition
+    std::optional<Vec4> centroid(const Hash& id) const;
+
+private:
+    // Caller holds mutex_ exclusively
+    size_t add_locked(const std::vector<std::pair<Hash, Vec4>>& entries);
+
+    Params params_;
+    mutable std::shared_mutex mutex_;
+    hnswlib::InnerProductSpace space_{4};
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> index_;
+    std::vector<Hash> ids_;         // By label
+    std::vector<Vec4> centroids_;   // By label
+    std::unordered_map<Hash, size_t, HashHasher> labels_;
+    std::string watermark_;         // Latest composition.createdat seen by load or refresh
+};
+
+} // namespace Hartonomous
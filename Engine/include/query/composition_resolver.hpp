@@ -0,0 +1,59 @@
+/**
+ * @file composition_resolver.hpp
+ * @brief Text to composition ID by content address instead of view scans
+ *
+ * A composition's ID is a pure function of its text (BLAKE3 over its atoms'
+ * IDs, see SubstrateService::compute_comp), so "which composition spells
+ * this" needs no scan of v_composition_text: hash the text and probe
+ * hartonomous.composition's primary key. Case and whitespace variants are
+ * hashed the same way and checked in the same round trip, and positive hits
+ * are kept in a process-wide table for hot terms.
+ */
+
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <storage/atom_lookup.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Hartonomous {
+
+class CompositionResolver {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    explicit CompositionResolver(PostgresConnection& db);
+
+    /**
+     * @brief The stored composition for text, zero hash if there is none
+     *
+     * Tries variants() in order and returns the first one ingested, so an
+     * exact spelling wins over its lowercase or trimmed forms.
+     */
+    Hash resolve(const std::string& text);
+
+    // resolve() of every text with one primary-key probe for all of them
+    std::vector<Hash> resolve_many(const std::vector<std::string>& texts);
+
+    // ID ingestion gives text; zero hash when none of its codepoints are atoms
+    Hash composition_id(std::string_view text);
+
+    /**
+     * @brief Spellings tried for text, most specific first, without duplicates
+     *
+     * The text as given, lowercase, Capitalized and UPPERCASE, then the same
+     * four of it with surrounding punctuation trimmed and inner whitespace
+     * collapsed. Case mapping is ASCII; other bytes are kept as they are.
+     */
+    static std::vector<std::string> variants(std::string_view text);
+
+private:
+    PostgresConnection& db_;
+    std::unique_ptr<AtomLookup> atoms_;  // Mapped atom image when one exists
+};
+
+} // namespace Hartonomous
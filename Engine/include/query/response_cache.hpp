@@ -0,0 +1,152 @@
+/**
+ * @file response_cache.hpp
+ * @brief Bounded, expiring cache of whole answers, valid for one substrate epoch
+ *
+ * FAQ-style traffic asks the same questions again and again, and every call
+ * would otherwise re-run keyword extraction, composition lookups and
+ * co-occurrence ranking. Answers are kept under the caller's key (the
+ * normalized prompt plus whatever else shapes the answer: config, tenant)
+ * together with the SubstrateEpoch their computation started in. A lookup
+ * misses once the epoch has moved on, the entry's TTL has passed, or it was
+ * evicted as least recently used.
+ */
+
+#pragma once
+
+#include <utils/substrate_epoch.hpp>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Hartonomous {
+
+struct ResponseCacheOptions {
+    size_t capacity = 4096;          // Entries; 0 disables the cache
+    std::chrono::seconds ttl{300};   // 0 = entries never expire
+
+    // HARTONOMOUS_RESPONSE_CACHE (entries), HARTONOMOUS_RESPONSE_TTL_S
+    static ResponseCacheOptions from_env() {
+        ResponseCacheOptions o;
+        if (const char* v = std::getenv("HARTONOMOUS_RESPONSE_CACHE"))
+            o.capacity = static_cast<size_t>(std::strtoull(v, nullptr, 10));
+        if (const char* v = std::getenv("HARTONOMOUS_RESPONSE_TTL_S"))
+            o.ttl = std::chrono::seconds(std::strtoll(v, nullptr, 10));
+        return o;
+    }
+};
+
+struct ResponseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stale = 0;      // Misses on an entry from an older epoch or past its TTL
+    size_t entries = 0;
+};
+
+// Surrounding whitespace dropped and inner whitespace runs made one space
+inline std::string normalized_prompt(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!out.empty() && out.back() != ' ') out.push_back(' ');
+        } else {
+            out.push_back(c);
+        }
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+template <typename V>
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Options = ResponseCacheOptions;
+    using Stats = ResponseCacheStats;
+
+    explicit ResponseCache(const Options& opts = Options::from_env()) : opts_(opts) {}
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    bool enabled() const noexcept { return opts_.capacity > 0; }
+
+    std::optional<V> get(const std::string& key) {
+        if (!enabled()) return std::nullopt;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        if (it->second.epoch != SubstrateEpoch::current() ||
+            (opts_.ttl.count() > 0 && Clock::now() >= it->second.expires)) {
+            lru_.erase(it->second.lru);
+            entries_.erase(it);
+            ++stats_.misses;
+            ++stats_.stale;
+            return std::nullopt;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        ++stats_.hits;
+        return it->second.value;
+    }
+
+    /**
+     * @brief Keep `value` for `key`
+     *
+     * @param epoch SubstrateEpoch::current() from before the value was
+     *              computed, so an answer that raced a write is never served
+     */
+    void put(const std::string& key, V value, uint64_t epoch) {
+        if (!enabled() || epoch != SubstrateEpoch::current()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.erase(it->second.lru);
+            entries_.erase(it);
+        }
+        while (entries_.size() >= opts_.capacity) {
+            entries_.erase(lru_.back());
+            lru_.pop_back();
+        }
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{std::move(value), epoch, Clock::now() + opts_.ttl, lru_.begin()});
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        lru_.clear();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s = stats_;
+        s.entries = entries_.size();
+        return s;
+    }
+
+private:
+    struct Entry {
+        V value;
+        uint64_t epoch;
+        Clock::time_point expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    Options opts_;
+    mutable std::mutex mutex_;
+    std::list<std::string> lru_;  // Most recent first
+    std::unordered_map<std::string, Entry> entries_;
+    Stats stats_;
+};
+
+} // namespace Hartonomous
@@ -5,13 +5,22 @@
 
 #pragma once
 
-#include <database/postgres_connection.hpp>
+#include <cognitive/live_relation_graph.hpp>
+#include <database/connection_pool.hpp>
+#include <query/centroid_index.hpp>
+#include <query/composition_resolver.hpp>
+#include <query/response_cache.hpp>
+#include <storage/atom_lookup.hpp>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
 
 namespace Hartonomous {
 
+class CompositionTextStore;
+
 /**
  * @brief Query result
  */
@@ -19,6 +28,31 @@ struct QueryResult {
     std::string text;
     double confidence;  // ELO-based or co-occurrence count
     std::vector<std::string> provenance;  // Source relations
+    double margin = 0.0;  // Approximate mode: half-width of the interval on confidence
+};
+
+/**
+ * @brief How find_related and find_gravitational_truth gather candidates
+ *
+ * Either way the query composition's neighbors are aggregated once and the
+ * top `limit` are kept in a bounded heap; nothing is grouped or sorted in
+ * the database. With a relation graph snapshot the neighbors are a slice of
+ * memory. Without one, exact mode reads them through NeighborCache (the
+ * extension's neighbors(), compositionadjacency or the self-join, cached
+ * per process), which for a hub word is every relation it is in.
+ *
+ * Approximate mode reads a sample of the relations instead. Relation IDs
+ * are BLAKE3 hashes, so the first m in ID order are a uniform sample, and
+ * the m-th ID's place in the hash space estimates how many there are in
+ * all. Counts are scaled up by that estimate and QueryResult::margin gives
+ * their z-sigma bound. Rounds double m until the next one would overrun the
+ * budget or the sample covers every relation (then results are exact).
+ */
+struct TopKOptions {
+    bool approximate = false;
+    size_t sample = 1024;                   // Relations in the first round
+    std::chrono::milliseconds budget{50};   // Latency allowed for all rounds
+    double z = 1.96;                        // Normal quantile of the margin
 };
 
 /**
@@ -33,16 +67,73 @@ struct QueryResult {
 class SemanticQuery {
 public:
     explicit SemanticQuery(PostgresConnection& db);
+    explicit SemanticQuery(ConnectionPool& pool);  // Holds one pooled connection for its lifetime
 
     /**
-     * @brief Simple query: Find composition by exact text match
+     * @brief Composition spelled by text, or by a case/whitespace variant of it
+     *
+     * Resolved by content address (see CompositionResolver); the ID as hex.
      */
     std::optional<std::string> find_composition(const std::string& text);
 
     /**
      * @brief Find compositions that co-occur with query text
+     *
+     * Text with no exact composition is resolved to the one whose centroid
+     * is nearest the text's own (see find_nearest).
+     */
+    std::vector<QueryResult> find_related(const std::string& query_text, size_t limit = 10,
+                                          const TopKOptions& opts = {});
+
+    /**
+     * @brief find_related of every text, results in input order
+     *
+     * Each distinct text is resolved once, all of them with one primary-key
+     * probe. Without a relation graph snapshot exact neighbors are fetched
+     * for all of them in one round trip (NeighborCache::prefetch); with one
+     * the texts are gathered concurrently. Ranking always runs concurrently.
+     */
+    std::vector<std::vector<QueryResult>> find_related_batch(const std::vector<std::string>& texts,
+                                                             size_t limit = 10, const TopKOptions& opts = {});
+
+    /**
+     * @brief Compositions whose S³ centroids lie nearest the text's centroid
+     *
+     * Fuzzy lookup through the process-wide CentroidIndex; confidence is
+     * 1 - geodesic / pi.
+     */
+    std::vector<QueryResult> find_nearest(const std::string& text, size_t limit = 10);
+
+    /**
+     * @brief The k compositions nearest pos on S³, nearest first
+     *
+     * One index-ordered KNN scan (ORDER BY centroid <@> pos over
+     * gist_s3_ops); distances are geodesic.
+     */
+    std::vector<CentroidIndex::Neighbor> nearest_compositions(const Eigen::Vector4d& pos, size_t k);
+
+    // Replace the process-wide centroid index (loaded on first fuzzy lookup otherwise)
+    void set_centroid_index(std::shared_ptr<CentroidIndex> index) { centroids_ = std::move(index); }
+
+    // Rank from an in-memory snapshot instead of the database (nullptr to go back)
+    void set_relation_graph(std::shared_ptr<const RelationGraph> graph) {
+        graph_ = std::move(graph);
+        live_.reset();
+    }
+
+    // Take the live graph's current epoch at the start of every query
+    void follow_relation_graph(std::shared_ptr<const LiveRelationGraph> live) { live_ = std::move(live); }
+
+    bool has_relation_graph() const { return graph_ || live_; }
+
+    /**
+     * @brief Restrict find_related and find_gravitational_truth to edges with evidence from `tenant` (nullopt: all)
+     *
+     * Enforced by a bit test on the snapshot's tenant masks; throws when they run
+     * without a graph loaded with masks (RelationGraph::tenant_view).
      */
-    std::vector<QueryResult> find_related(const std::string& query_text, size_t limit = 10);
+    void set_tenant(std::optional<BLAKE3Pipeline::Hash> tenant) { tenant_ = tenant; }
+    const std::optional<BLAKE3Pipeline::Hash>& tenant() const { return tenant_; }
 
     /**
      * @brief Find "Truth" via Gravitational Clustering
@@ -50,13 +141,17 @@ public:
      * Finds topological consensus centers on S3 where high ELO and multiple provenance intersect.
      * Axiom: Truths Cluster, Lies Scatter.
      */
-    std::vector<QueryResult> find_gravitational_truth(const std::string& query_text, double min_elo = 1500.0, size_t limit = 10);
+    std::vector<QueryResult> find_gravitational_truth(const std::string& query_text, double min_elo = 1500.0,
+                                                      size_t limit = 10, const TopKOptions& opts = {});
 
     /**
      * @brief Answer question via relationship traversal
      *
      * Example: "What is the captain's name?" → "Ahab"
      *
+     * Answers (and the lack of one) are cached process-wide per normalized
+     * question and tenant for the current SubstrateEpoch (ResponseCache).
+     *
      * Algorithm:
      * 1. Extract key terms from question ("captain", "name")
      * 2. Find compositions for each term
@@ -67,6 +162,18 @@ public:
      */
     std::optional<QueryResult> answer_question(const std::string& question);
 
+    /**
+     * @brief answer_question of every question, answers in input order
+     *
+     * Cached answers are taken as they are. The keywords of the rest are
+     * pooled, so a term shared by several questions is ranked once, through
+     * one find_related_batch; each question is then scored concurrently.
+     */
+    std::vector<std::optional<QueryResult>> answer_question_batch(const std::vector<std::string>& questions);
+
+    // Hits and misses of the answer_question() cache
+    static ResponseCacheStats answer_cache_stats();
+
     /**
      * @brief Find all relations containing a composition
      */
@@ -82,9 +189,49 @@ public:
     std::vector<std::string> extract_keywords(const std::string& text);
 
 private:
-    bool is_proper_noun(const std::string& text);
+    bool is_proper_noun(const std::string& text) const;
+
+    // answer_question() without the cache
+    std::optional<QueryResult> rank_answer(const std::string& question);
+    // The best-scoring related composition over a question's keywords; related[k] is find_related(keywords[k], 20)
+    std::optional<QueryResult> best_answer(const std::vector<const std::vector<QueryResult>*>& related) const;
+    static std::string answer_key(const std::optional<BLAKE3Pipeline::Hash>& tenant, const std::string& question);
+
+    // Exact match, else the composition nearest the text's centroid
+    std::optional<CompositionInfo> resolve_composition(const std::string& text);
+    std::vector<CentroidIndex::Neighbor> nearest_to_text(const std::string& text, size_t k);
+
+    // One neighbor of the query composition, aggregated over shared relations
+    struct Candidate {
+        BLAKE3Pipeline::Hash id;
+        double relations;  // Shared relations, scaled to the whole when sampled
+        double max_elo;
+        double total_obs;  // Scaled like relations
+        size_t hits;       // Sampled relations it was seen in
+    };
+
+    struct Candidates {
+        std::vector<Candidate> list;
+        size_t sampled = 0;  // Relations read; 0 when exact
+    };
+
+    Candidates gather(const BLAKE3Pipeline::Hash& id, const TopKOptions& opts);
+    // The top `limit` of a gathered neighborhood, with texts, as find_related returns them
+    static std::vector<QueryResult> rank_related(const CompositionTextStore& texts, const BLAKE3Pipeline::Hash& query_id,
+                                                 const Candidates& c, size_t limit, const TopKOptions& opts);
+    Candidates sample_relations(const BLAKE3Pipeline::Hash& id, size_t m);
+
+    // Centroid of each candidate (nullopt where unknown), from the index when loaded
+    std::vector<std::optional<Eigen::Vector4d>> centroids_of(const std::vector<Candidate>& list);
 
+    ConnectionPool::Lease lease_;  // Empty unless constructed from a pool
     PostgresConnection& db_;
+    CompositionResolver resolver_{db_};
+    std::shared_ptr<CentroidIndex> centroids_;
+    std::unique_ptr<AtomLookup> atoms_;
+    std::shared_ptr<const RelationGraph> graph_;
+    std::shared_ptr<const LiveRelationGraph> live_;
+    std::optional<BLAKE3Pipeline::Hash> tenant_;
 };
 
 } // namespace Hartonomous
@@ -10,6 +10,7 @@
 #include <array>
 #include <stdexcept>
 #include <algorithm> // For std::clamp
+#include <cstddef>
 
 // Correctly include the header from the 'spectral3d/hilbert_hpp' submodule.
 #include "hilbert.hpp"
@@ -91,6 +92,40 @@ public:
         return result;
     }
 
+    /**
+     * @brief encode() of n points at once.
+     *
+     * `xyzw` holds the n points' coordinates back to back. The Skilling
+     * transform runs on eight or sixteen points per register (AVX2 or
+     * AVX-512, whichever simd_level() allows); the result is identical to
+     * encode() on each point.
+     */
+    static void encode_batch(const double* xyzw, size_t n, HilbertIndex* out,
+                             EntityType type = EntityType::Composition);
+
+    /**
+     * @brief Inverse of encode(): the centre of the cell the index names.
+     *
+     * encode() of the result gives the index back. The entity type bits are
+     * decoded as part of the index, so the result lies within one
+     * discretization step of the point originally encoded.
+     */
+    static Vec4 decode(const HilbertIndex& index);
+
+    /**
+     * @brief decode() of n indices at once, into 4 * n coordinates.
+     */
+    static void decode_batch(const HilbertIndex* in, size_t n, double* xyzw);
+
+    /**
+     * @brief Grid corner of the level-`level` cell holding each index.
+     *
+     * The cell is the one named by the top 4 * level index bits: side
+     * 2^(32 - level) grid steps, lower corner written to corners[4 * i..].
+     * Only `level` rounds of the transform run, so coarse cells are cheap.
+     */
+    static void decode_cells(const HilbertIndex* in, size_t n, uint32_t level, uint32_t* corners);
+
     /**
      * @brief Calculates the absolute distance between two curve indices.
      * @return HilbertIndex A 128-bit value representing the distance.
@@ -0,0 +1,104 @@
+/**
+ * @file hilbert_range_query.hpp
+ * @brief S³ region queries as Hilbert key ranges
+ *
+ * Every index prefix of 4L bits names one axis-aligned cell of side 2^-L in
+ * the curve's [0, 1]^4, so a region is covered by walking the 16-ary cell
+ * tree: cells outside the region are dropped, cells inside it emit their
+ * whole key range, and boundary cells are split until the interval budget or
+ * the deepest level is reached. The resulting sorted, disjoint intervals run
+ * as B-tree range scans on hartonomous.physicality(Hilbert) or as binary
+ * searches plus linear scans over an in-memory sorted key array; candidates
+ * are then refined by exact geodesic distance.
+ *
+ * Points map to the curve as HilbertCurve4D is used throughout the engine:
+ * u = (x + 1) / 2 for each S³ coordinate x.
+ */
+
+#pragma once
+
+#include <spatial/hilbert_curve_4d.hpp>
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hartonomous::spatial {
+
+struct HilbertRangeOptions {
+    size_t max_intervals = 32;    // Nearest ranges are merged to fit, trading false positives for scans
+    size_t max_cells = 128;       // Boundary cells a level may hold and still be split further
+    uint32_t max_level = 12;      // Deepest split: boundary cells of side 2^-12
+};
+
+class HilbertRangeQuery {
+public:
+    using Vec4 = Eigen::Vector4d;
+    using HilbertIndex = HilbertCurve4D::HilbertIndex;
+    using Key = unsigned __int128;
+
+    // Inclusive key range, in HilbertIndex (big-endian, byte-comparable) order
+    struct Interval {
+        HilbertIndex lo;
+        HilbertIndex hi;
+    };
+
+    using Options = HilbertRangeOptions;
+
+    /**
+     * @brief Ranges holding every unit point within geodesic `radius` of unit `center`.
+     */
+    static std::vector<Interval> ball(const Vec4& center, double radius, const Options& options = {});
+
+    /**
+     * @brief Ranges holding every unit point of the S³-coordinate box [lo, hi].
+     */
+    static std::vector<Interval> box(const Vec4& lo, const Vec4& hi, const Options& options = {});
+
+    // Key of a unit point, as stored with any entity type
+    static Key key(const Vec4& point);
+    static Key to_key(const HilbertIndex& index);
+    static HilbertIndex to_index(Key key);
+
+    static double geodesic(const Vec4& a, const Vec4& b);
+};
+
+/**
+ * @brief Unit points sorted by Hilbert key, for ball and nearest-neighbor queries.
+ *
+ * Points are stored in key order, so each interval of a query is one binary
+ * search followed by a contiguous scan.
+ */
+class HilbertPointIndex {
+public:
+    struct Hit {
+        size_t point;     // Index into the constructor's vector
+        double distance;  // Geodesic
+    };
+
+    explicit HilbertPointIndex(const std::vector<Eigen::Vector4d>& points);
+
+    size_t size() const { return keys_.size(); }
+
+    /**
+     * @brief Points within geodesic `radius` of `center`, nearest first.
+     */
+    std::vector<Hit> within(const Eigen::Vector4d& center, double radius,
+                            const HilbertRangeQuery::Options& options = {}) const;
+
+    /**
+     * @brief The k nearest points, nearest first.
+     *
+     * Searches balls of doubling radius from `initial_radius` (0: the radius
+     * expected to hold k points if they were spread uniformly over S³) until
+     * one holds k points; the result is exact.
+     */
+    std::vector<Hit> nearest(const Eigen::Vector4d& point, size_t k, double initial_radius = 0.0) const;
+
+private:
+    std::vector<HilbertRangeQuery::Key> keys_;  // Ascending
+    std::vector<Eigen::Vector4d> points_;       // In key order
+    std::vector<size_t> original_;              // Constructor index of each sorted point
+};
+
+} // namespace hartonomous::spatial
@@ -3,10 +3,16 @@
 #include <database/postgres_connection.hpp>
 #include <hashing/blake3_pipeline.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
+#include <utils/huge_pages.hpp>
+#include <utils/memory_governor.hpp>
 #include <Eigen/Core>
 #include <unordered_map>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <cstdint>
 
 namespace Hartonomous {
@@ -21,6 +27,10 @@ namespace Hartonomous {
  * IMPORTANT: Text/content ingestion MUST use this lookup to get the
  * correct semantic positions. Do NOT compute positions from hash -
  * that would bypass the semantic ordering.
+ *
+ * Atoms looked up one by one are memoized until preload; that memo is
+ * accounted to MemoryGovernor::global() and dropped at the next lookup when
+ * the governor asks. Arrays preloaded from the database are accounted as pinned.
  */
 class AtomLookup {
 public:
@@ -37,6 +47,10 @@ public:
     };
 
     explicit AtomLookup(PostgresConnection& db);
+    ~AtomLookup();
+
+    AtomLookup(const AtomLookup&) = delete;
+    AtomLookup& operator=(const AtomLookup&) = delete;
 
     /**
      * @brief Look up atom by codepoint
@@ -53,11 +67,23 @@ public:
      */
     std::unordered_map<uint32_t, AtomInfo> lookup_batch(const std::vector<uint32_t>& codepoints);
 
+    /**
+     * @brief Gather ids and positions for a run of codepoints into caller storage
+     *
+     * Unseeded codepoints are skipped, so output slot k holds the k-th
+     * resolved atom. Both spans must hold at least text.size() entries.
+     * Reads the dense arrays directly once preload_all() has run.
+     * @return Number of atoms written
+     */
+    size_t lookup_codepoints(std::u32string_view text, std::span<Hash> ids, std::span<Vec4> positions);
+
     /**
      * @brief Preload all atoms into memory for fast lookup
      *
      * For high-throughput ingestion, call this once to cache all 1.1M atoms.
-     * Uses ~200MB of memory but makes lookups instant.
+     * Maps the atom image at default_image_path() when one is present and
+     * valid; otherwise streams the atom table from the database into the
+     * same dense arrays (~90MB).
      */
     void preload_all();
 
@@ -66,11 +92,91 @@ public:
      */
     bool is_preloaded() const { return preloaded_; }
 
+    /**
+     * @brief How much of the dense arrays (or the mapped image) sits in huge pages
+     *
+     * See HARTONOMOUS_HUGEPAGES in utils/huge_pages.hpp.
+     */
+    HugePageUsage huge_page_usage() const;
+
+    /**
+     * @brief Memory-map an atom image written by write_image()
+     *
+     * Lookups then index the mapped arrays directly by codepoint. The atom
+     * table is immutable after seeding, so no database fallback is needed.
+     * A file pinned with pin_image() is not mapped or checksummed again.
+     * @return false if the file is missing, malformed or fails its checksum
+     */
+    bool load_image(const std::string& path);
+
+    /**
+     * @brief Map and verify the image at `path` for the rest of the process
+     *
+     * Later load_image() calls for the file, here and in processes forked
+     * from here, reuse the mapping for as long as the file is unchanged.
+     * Call before forking workers (a PostgreSQL postmaster preloading the
+     * extension) so that every backend shares one copy of the pages.
+     */
+    static bool pin_image(const std::string& path);
+
+    /**
+     * @brief Write every seeded atom as a dense, codepoint-indexed image
+     *
+     * Loads the atoms from the database first if they are not cached.
+     * The file is written beside `path` and renamed into place.
+     */
+    void write_image(const std::string& path);
+
+    bool is_image_mapped() const { return image_ != nullptr; }
+
+    /**
+     * @brief True once lookups are served from the codepoint-indexed arrays
+     */
+    bool is_dense() const { return dense_present_ != nullptr; }
+
+    /**
+     * @brief HARTONOMOUS_ATOM_IMAGE, else $XDG_CACHE_HOME (or ~/.cache)/hartonomous/atoms.img
+     */
+    static std::string default_image_path();
+
 private:
     PostgresConnection& db_;
     std::unordered_map<uint32_t, AtomInfo> cache_;
+    MemoryGovernor::Account cache_account_;
+    MemoryGovernor::Account dense_account_;
     bool preloaded_ = false;
 
+    // Dense structure-of-arrays view indexed by codepoint. Points either
+    // into the mapped atom image or into owned_ after a database preload.
+    uint32_t dense_count_ = 0;
+    const uint8_t* dense_present_ = nullptr;
+    const Hash* dense_ids_ = nullptr;
+    const Hash* dense_phys_ids_ = nullptr;
+    const double* dense_positions_ = nullptr;   // 4 doubles per codepoint, 32-byte aligned
+    const HilbertIndex* dense_hilbert_ = nullptr;
+
+    struct alignas(32) PackedVec4 { double v[4]; };
+
+    struct DenseStorage {
+        std::vector<uint8_t> present;
+        std::vector<Hash> ids;
+        std::vector<Hash> phys_ids;
+        std::vector<PackedVec4> positions;
+        std::vector<HilbertIndex> hilbert;
+    };
+    DenseStorage owned_;
+
+    struct Image;
+    std::shared_ptr<const Image> image_;
+
+    static std::shared_ptr<const Image> shared_image(const std::string& path, bool pin);
+
+    void preload_from_db();
+    std::optional<AtomInfo> dense_lookup(uint32_t codepoint) const;
+    void reset_dense();
+    // Report the memo's size to the governor, first dropping it if asked to
+    void account_cache();
+
     static Hash uuid_to_hash(const std::string& uuid);
     static Vec4 parse_geometry(const std::string& geom_hex);
     static HilbertIndex parse_hilbert(const std::string& hilbert_str);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Maintenance of the optional hartonomous.compositionadjacency table
+ *
+ * The table holds one row per (composition, neighbor, relation) with the
+ * relation's rating copied in, keyed so that one composition's neighbors are
+ * a single primary-key range. Writers call refresh() for the relations they
+ * touched inside their own transaction, after the relation sequences and
+ * ratings are written; everything is a no-op when the table is absent.
+ *
+ * Rows are rebuilt from relationsequence and relationrating, so a relation
+ * whose rating is not written yet gets the rating column defaults and is
+ * corrected when its rating lands. Two concurrent transactions, one writing a
+ * relation's sequences and the other its first rating, can each miss the
+ * other's rows; the next rating update of that relation repairs it.
+ */
+class CompositionAdjacency {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    // Whether the table exists; checked once per process
+    static bool enabled(PostgresConnection& db);
+
+    // Upsert the rows of these relations (duplicates allowed); no-op when disabled
+    static void refresh(PostgresConnection& db, const std::vector<Hash>& relation_ids);
+};
+
+} // namespace Hartonomous
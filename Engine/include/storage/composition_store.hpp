@@ -1,12 +1,66 @@
 #pragma once
 
 #include <storage/substrate_store.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace Hartonomous {
 
+/**
+ * @brief Packed atom sequence stored in composition.runs
+ *
+ * One int4 per run of a repeated atom: codepoint | (length - 1) << 21, a run
+ * longer than MAX_RUN continuing in the next element. Atoms are addressed by
+ * codepoint, so the array is the whole sequence in 4 bytes a run, where a
+ * compositionsequence row costs a heap tuple and four index entries.
+ */
+struct CompositionRuns {
+    static constexpr uint32_t CODEPOINT_BITS = 21;
+    static constexpr uint32_t CODEPOINT_MASK = (1u << CODEPOINT_BITS) - 1;
+    static constexpr uint32_t MAX_RUN = 1u << (31 - CODEPOINT_BITS);   // Keeps elements positive
+
+    // Append `count` repeats of `codepoint`
+    static void append(std::vector<int32_t>& runs, char32_t codepoint, uint32_t count) {
+        for (; count > 0; count -= std::min(count, MAX_RUN))
+            runs.push_back(static_cast<int32_t>((codepoint & CODEPOINT_MASK) |
+                                                ((std::min(count, MAX_RUN) - 1) << CODEPOINT_BITS)));
+    }
+
+    static char32_t codepoint(int32_t run) { return static_cast<uint32_t>(run) & CODEPOINT_MASK; }
+    static uint32_t length(int32_t run) { return (static_cast<uint32_t>(run) >> CODEPOINT_BITS) + 1; }
+
+    static std::u32string expand(std::span<const int32_t> runs) {
+        std::u32string out;
+        for (int32_t r : runs) out.append(length(r), codepoint(r));
+        return out;
+    }
+
+    /**
+     * @brief Whether compositionsequence rows are written besides the runs
+     *
+     * HARTONOMOUS_COMPOSITION_SEQUENCE=packed drops them for every composition
+     * that has runs. Views that expand sequences read the runs of those
+     * compositions; the default keeps writing both.
+     */
+    static bool write_rows() {
+        static const bool rows = [] {
+            const char* v = std::getenv("HARTONOMOUS_COMPOSITION_SEQUENCE");
+            return !(v && std::strcmp(v, "packed") == 0);
+        }();
+        return rows;
+    }
+};
+
 struct CompositionRecord {
     BLAKE3Pipeline::Hash id;
     BLAKE3Pipeline::Hash physicality_id;
+    std::string text;           // Stored in composition.text so reads need not reassemble the atoms
+    std::vector<int32_t> runs;  // CompositionRuns; empty (NULL) when some codepoint has no atom
 };
 
 struct CompositionSequenceRecord {
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <utils/huge_pages.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Immutable map from composition ID to its reconstructed text
+ *
+ * One contiguous UTF-8 blob plus an offset table, ordered by composition ID
+ * so lookups are a binary search over a flat ID array. Nothing is built at
+ * load time: a snapshot file is mapped and read in place, which makes engine
+ * construction an mmap instead of materializing v_composition_text into a
+ * per-engine hash map.
+ *
+ * Each entry also carries classify() flags of its text, computed once when
+ * the store is built and saved with the snapshot, so hot paths filter by a
+ * bit test instead of re-examining strings.
+ *
+ * The store is shared read-only; shared() hands every engine in the process
+ * the same instance. Views returned by lookup() live as long as the store.
+ */
+class CompositionTextStore {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+    static constexpr uint32_t NPOS = ~uint32_t(0);
+
+    enum Flag : uint8_t {
+        ARTIFACT = 1,        // Empty, or tokenizer residue: [PAD], [unused7], ##ing, #17
+        FUNCTION_WORD = 2,   // Closed-class English word: the, of, which, ...
+        PUNCTUATION = 4,     // A single non-alphanumeric byte
+        PROPER_NOUN = 8,     // Capitalized word that is not a function word
+        STOP_WORD = FUNCTION_WORD | PUNCTUATION,
+    };
+
+    // Flags of a text (ASCII case rules; other bytes count as letters)
+    static uint8_t classify(std::string_view text);
+
+    ~CompositionTextStore();
+    CompositionTextStore(const CompositionTextStore&) = delete;
+    CompositionTextStore& operator=(const CompositionTextStore&) = delete;
+
+    // Read all of v_composition_text over one binary COPY
+    static std::shared_ptr<const CompositionTextStore> load_from_db(PostgresConnection& db);
+
+    /**
+     * @brief Map a snapshot file; nullptr if missing, stale or corrupt
+     *
+     * @param fingerprint Must match the one the file was written with
+     *                    (empty accepts any file)
+     */
+    static std::shared_ptr<const CompositionTextStore> load_file(const std::string& path,
+                                                                 const std::string& fingerprint = "");
+
+    // Map the cached snapshot if it matches the database, else rebuild and cache it
+    static std::shared_ptr<const CompositionTextStore> load(PostgresConnection& db,
+                                                            const std::string& path = default_path());
+
+    /**
+     * @brief Process-wide store, loaded on first use
+     *
+     * Later calls return the same instance without touching the database.
+     * Accounted to MemoryGovernor::global() as pinned.
+     */
+    static std::shared_ptr<const CompositionTextStore> shared(PostgresConnection& db);
+
+    static std::shared_ptr<const CompositionTextStore> from_entries(std::vector<std::pair<Hash, std::string>> entries,
+                                                                    std::string fingerprint = "");
+
+    void write_file(const std::string& path) const;
+
+    // Identity of the composition tables' contents (changes on any write)
+    static std::string database_fingerprint(PostgresConnection& db);
+
+    // $HARTONOMOUS_TEXT_STORE, else the user cache directory
+    static std::string default_path();
+
+    size_t size() const noexcept { return count_; }
+    size_t text_bytes() const noexcept { return count_ ? offsets_[count_] : 0; }
+    const std::string& fingerprint() const noexcept { return fingerprint_; }
+    bool is_mapped() const noexcept { return map_addr_ != nullptr; }
+
+    // Heap bytes owned; a mapped snapshot's pages are file-backed, for the kernel to reclaim
+    size_t heap_bytes() const noexcept {
+        return owned_ids_.capacity() * sizeof(Hash) + owned_offsets_.capacity() * sizeof(uint64_t) +
+               owned_flags_.capacity() + owned_blob_.capacity();
+    }
+
+    // How much of the arena sits in huge pages (HARTONOMOUS_HUGEPAGES, utils/huge_pages.hpp)
+    HugePageUsage huge_page_usage() const;
+
+    // Position of `id` in the store, NPOS if absent
+    uint32_t index_of(const Hash& id) const;
+
+    const Hash& id_at(uint32_t index) const { return ids_[index]; }
+
+    std::string_view text_at(uint32_t index) const {
+        return {blob_ + offsets_[index], static_cast<size_t>(offsets_[index + 1] - offsets_[index])};
+    }
+
+    uint8_t flags_at(uint32_t index) const { return flags_[index]; }
+
+    // Empty view if the composition has no text
+    std::string_view lookup(const Hash& id) const {
+        uint32_t i = index_of(id);
+        return i == NPOS ? std::string_view{} : text_at(i);
+    }
+
+private:
+    CompositionTextStore() = default;
+
+    // Sorts by ID and packs the blob; duplicate IDs keep the first text
+    static std::shared_ptr<CompositionTextStore> build(std::vector<std::pair<Hash, std::string>>& entries,
+                                                       std::string fingerprint);
+
+    size_t count_ = 0;
+    std::string fingerprint_;
+
+    // Views into either the owned vectors or the mapped file
+    const Hash* ids_ = nullptr;           // Sorted ascending
+    const uint64_t* offsets_ = nullptr;   // count_ + 1 entries into blob_
+    const uint8_t* flags_ = nullptr;      // classify() of each text
+    const char* blob_ = nullptr;
+
+    std::vector<Hash> owned_ids_;
+    std::vector<uint64_t> owned_offsets_;
+    std::vector<uint8_t> owned_flags_;
+    std::string owned_blob_;
+    void* map_addr_ = nullptr;
+    size_t map_size_ = 0;
+};
+
+} // namespace Hartonomous
@@ -65,7 +65,8 @@ inline std::string uint32_to_bytea_hex(uint32_t val) {
     return std::string(buf, 10);
 }
 
-// Format a uint64 as a bytea hex string with \x prefix for PostgreSQL text COPY
+// Format a uint64 as a bytea hex string with \x prefix for PostgreSQL text COPY;
+// the native uint64 type's input accepts the same form
 inline std::string uint64_to_bytea_hex(uint64_t val) {
     char buf[19]; // \x + 16 hex chars + null
     buf[0] = '\\';
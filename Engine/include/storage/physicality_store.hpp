@@ -3,11 +3,120 @@
 #include <storage/substrate_store.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
 #include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <vector>
 
 namespace Hartonomous {
 
 using HilbertIndex = hartonomous::spatial::HilbertCurve4D::HilbertIndex;
 
+/**
+ * @brief How physicality.trajectory is written, from HARTONOMOUS_TRAJECTORY
+ *
+ *   geometry    the full LINESTRINGZM, 32 bytes a point (default)
+ *   packed      trajectories of three or more points go to
+ *               physicality.trajectorypacked instead (PackedTrajectory, 4-8
+ *               bytes a point), and trajectory keeps only the two corners of
+ *               their bounding box, which is all the GiST index keys on
+ *   referenced  as packed, and relation trajectories are not written at all:
+ *               they are the centroids of the related compositions, which
+ *               v_relation_trajectory looks up through relationsequence
+ *
+ * Physicality ids hash the full trajectory in every mode.
+ */
+enum class TrajectoryStorage : uint8_t { Geometry, Packed, Referenced };
+
+inline TrajectoryStorage trajectory_storage() {
+    static const TrajectoryStorage mode = [] {
+        const char* v = std::getenv("HARTONOMOUS_TRAJECTORY");
+        if (v && std::strcmp(v, "packed") == 0) return TrajectoryStorage::Packed;
+        if (v && std::strcmp(v, "referenced") == 0) return TrajectoryStorage::Referenced;
+        return TrajectoryStorage::Geometry;
+    }();
+    return mode;
+}
+
+/**
+ * @brief Quantized, delta-encoded trajectory stored in physicality.trajectorypacked
+ *
+ * Points lie on S³, so every coordinate is in [-1, 1] and quantizes to a
+ * 16-bit step of 1/32767 (error at most 1.6e-5 per axis). The encoding is a
+ * varint point count, then per point the four zigzag varint deltas from the
+ * previous point's steps (the first from zero). Consecutive atoms of a word
+ * sit close together, so most deltas take one or two bytes.
+ * physicality_trajectory() in SQL decodes it.
+ */
+struct PackedTrajectory {
+    static constexpr double SCALE = 32767.0;
+
+    static int32_t quantize(double x) {
+        return static_cast<int32_t>(std::lround(std::clamp(x, -1.0, 1.0) * SCALE));
+    }
+
+    static void encode(std::span<const Eigen::Vector4d> pts, std::vector<uint8_t>& out) {
+        out.clear();
+        put_varint(out, pts.size());
+        int32_t prev[4] = {0, 0, 0, 0};
+        for (const auto& pt : pts)
+            for (int k = 0; k < 4; ++k) {
+                const int32_t q = quantize(pt[k]);
+                const int32_t d = q - prev[k];
+                put_varint(out, (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31));
+                prev[k] = q;
+            }
+    }
+
+    // Empty on malformed input
+    static std::vector<Eigen::Vector4d> decode(std::span<const uint8_t> in) {
+        std::vector<Eigen::Vector4d> pts;
+        size_t pos = 0;
+        uint64_t n = 0;
+        if (!get_varint(in, pos, n) || n > in.size()) return pts;
+        pts.reserve(n);
+        int32_t q[4] = {0, 0, 0, 0};
+        for (uint64_t i = 0; i < n; ++i) {
+            Eigen::Vector4d pt;
+            for (int k = 0; k < 4; ++k) {
+                uint64_t z = 0;
+                if (!get_varint(in, pos, z)) return {};
+                q[k] += static_cast<int32_t>((z >> 1) ^ (~(z & 1) + 1));
+                pt[k] = q[k] / SCALE;
+            }
+            pts.push_back(pt);
+        }
+        return pts;
+    }
+
+    // Per-axis minimum and maximum of `pts`, the box the GiST key would hold
+    static void bounds(std::span<const Eigen::Vector4d> pts, Eigen::Vector4d& lo, Eigen::Vector4d& hi) {
+        lo = hi = pts.front();
+        for (const auto& pt : pts.subspan(1)) {
+            lo = lo.cwiseMin(pt);
+            hi = hi.cwiseMax(pt);
+        }
+    }
+
+private:
+    static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+        for (; v >= 0x80; v >>= 7) out.push_back(static_cast<uint8_t>(v | 0x80));
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static bool get_varint(std::span<const uint8_t> in, size_t& pos, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+            const uint8_t b = in[pos++];
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
 struct PhysicalityRecord {
     BLAKE3Pipeline::Hash id;
     HilbertIndex hilbert_index;
@@ -15,6 +124,12 @@ struct PhysicalityRecord {
     std::vector<Eigen::Vector4d> trajectory; 
 };
 
+/**
+ * @brief Set hilbert_index of recs[from..] from their S3 centroids, as one batch.
+ */
+void encode_hilbert_indices(std::vector<PhysicalityRecord>& recs, size_t from,
+                            hartonomous::spatial::HilbertCurve4D::EntityType type);
+
 class PhysicalityStore : public SubstrateStore<PhysicalityRecord> {
 public:
     explicit PhysicalityStore(PostgresConnection& db, bool use_temp_table = true, bool use_binary = false);
@@ -22,6 +137,8 @@ public:
 
 private:
     std::string geom_to_hex(const Eigen::Vector4d& pt);
+
+    std::vector<uint8_t> packed_;   // PackedTrajectory scratch, reused across rows
 };
 
 }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <database/postgres_connection.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Optional range partitioning of substrate tables by leading ID bits
+ *
+ * With scripts/sql run as psql -v partition_bits=N, hartonomous.physicality,
+ * relation and relationevidence are split into 2^N partitions <table>_pNN,
+ * partition i holding the IDs whose top N bits are i. Writers that know the
+ * layout group their rows per partition, so one COPY touches one partition's
+ * indexes at a time, and concurrent writers start on different partitions.
+ */
+class PrefixPartitions {
+public:
+    using Hash = BLAKE3Pipeline::Hash;
+
+    // Leading ID bits hartonomous.<table> is partitioned on, 0 when it is not;
+    // checked once per process per table
+    static unsigned bits(PostgresConnection& db, const std::string& table);
+
+    static size_t partition_of(const Hash& id, unsigned bits) {
+        return bits ? id[0] >> (8 - bits) : 0;
+    }
+
+    /**
+     * @brief Order records by ID, starting at partition `first` and wrapping
+     *
+     * Each partition's rows end up contiguous and in key order within it.
+     */
+    template<typename Record>
+    static void route(std::vector<Record>& recs, unsigned bits, size_t first) {
+        if (bits == 0 || recs.size() < 2) return;
+        std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) { return a.id < b.id; });
+        first &= (size_t(1) << bits) - 1;
+        auto start = std::partition_point(recs.begin(), recs.end(),
+            [&](const Record& r) { return partition_of(r.id, bits) < first; });
+        std::rotate(recs.begin(), start, recs.end());
+    }
+};
+
+} // namespace Hartonomous
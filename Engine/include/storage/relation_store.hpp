@@ -1,7 +1,7 @@
 #pragma once
 
 #include <storage/substrate_store.hpp>
-#include <unordered_map>
+#include <unordered_set>
 
 namespace Hartonomous {
 
@@ -23,6 +23,12 @@ struct RelationRatingRecord {
     uint64_t observations = 1;
     double rating_value = 1000.0;
     double k_factor = 32.0;
+
+    // Fold a later rating for the same relation in, as the upsert's ON CONFLICT clause would
+    void merge(const RelationRatingRecord& later) noexcept {
+        observations += later.observations;
+        rating_value = later.rating_value;
+    }
 };
 
 class RelationStore : public SubstrateStore<RelationRecord> {
@@ -62,7 +68,7 @@ public:
 
 private:
     void emit_pending();
-    std::unordered_map<BLAKE3Pipeline::Hash, RelationRatingRecord, HashHasher> pending_;
+    HashMap128<RelationRatingRecord> pending_;
 };
 
 }
@@ -2,7 +2,8 @@
 
 #include <database/bulk_copy.hpp>
 #include <hashing/blake3_pipeline.hpp>
-#include <unordered_set>
+#include <hashing/hash_table_128.hpp>
+#include <utils/memory_governor.hpp>
 #include <vector>
 #include <string>
 
@@ -12,6 +13,7 @@ namespace Hartonomous {
  * @brief Base class for high-performance substrate storage.
  * 
  * Provides common logic for bulk loading, deduplication, and flushing.
+ * The session's dedup set is accounted to MemoryGovernor::global() as pinned.
  */
 template<typename Record>
 class SubstrateStore {
@@ -63,15 +65,19 @@ protected:
      */
     bool is_duplicate(const BLAKE3Pipeline::Hash& id) {
         if (!use_dedup_) return false;
-        if (seen_.find(id) != seen_.end()) return true;
-        seen_.insert(id);
-        return false;
+        const size_t capacity = seen_.capacity();
+        const bool duplicate = !seen_.insert(id).second;
+        // The table only grows by rehashing, so its size moves only when its capacity does
+        if (seen_.capacity() != capacity) seen_account_.update(seen_.memory_bytes());
+        return duplicate;
     }
 
     BulkCopy copy_;
     bool use_dedup_;
     bool use_binary_;
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> seen_;
+    HashSet128 seen_;
+    MemoryGovernor::Account seen_account_ =
+        MemoryGovernor::global().enroll("substrate_store_seen", MemoryGovernor::Priority::Pinned);
 };
 
 } // namespace Hartonomous
@@ -16,8 +16,7 @@ namespace Hartonomous::unicode {
  * 1. Parse UCD files (assigned codepoints only)
  * 2. Build semantic graph and linearize
  * 3. Compute S³ positions
- * 4. Bulk insert assigned codepoints
- * 5. Stream unassigned codepoints
+ * 4. Project and bulk load all 1,114,112 codepoints, assigned and unassigned
  */
 class UCDProcessor {
 public:
@@ -33,8 +32,7 @@ public:
 
 private:
     void ingest_metadata();
-    void ingest_assigned_codepoints();
-    void ingest_unassigned_codepoints();
+    void ingest_atoms();
 
     UCDParser parser_;
     SemanticSequencer sequencer_;
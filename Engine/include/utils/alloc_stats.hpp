@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file alloc_stats.hpp
+ * @brief Allocation counts and heap profiles from jemalloc, when the process runs on it
+ *
+ * The tools link jemalloc (tools/CMakeLists.txt); the libraries do not, so
+ * mallctl is a weak reference and every call degrades to "unavailable" on
+ * glibc malloc. Counts are jemalloc's merged arena statistics: requests
+ * served by the thread caches included, process-wide, refreshed on each
+ * snapshot (an epoch bump, so take them at phase boundaries, not per row).
+ *
+ * Call-site profiles need jemalloc's sampler enabled at startup, either by
+ * building with -DHARTONOMOUS_ALLOC_PROFILE=ON or with
+ * MALLOC_CONF=prof:true,prof_active:false,prof_accum:true. activate() turns
+ * sampling on, dump() writes a heap profile that jeprof reads
+ * (jeprof --text --alloc_objects <tool> <file>).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" int mallctl(const char* name, void* oldp, size_t* oldlenp, void* newp, size_t newlen)
+    __attribute__((weak));
+
+namespace Hartonomous {
+
+class AllocStats {
+public:
+    struct Snapshot {
+        bool valid = false;
+        uint64_t allocs = 0;        // Cumulative allocation requests, small and large
+        uint64_t live_bytes = 0;    // Currently allocated by the application
+    };
+
+    static bool available() noexcept { return mallctl != nullptr; }
+
+    static Snapshot now() noexcept {
+        Snapshot s;
+        if (!available()) return s;
+        uint64_t epoch = 1;
+        size_t len = sizeof(epoch);
+        if (mallctl("epoch", &epoch, &len, &epoch, sizeof(epoch)) != 0) return s;
+
+        uint64_t small = 0, large = 0;
+        size_t allocated = 0;
+        if (!read("stats.arenas.4096.small.nrequests", small) ||  // 4096: MALLCTL_ARENAS_ALL
+            !read("stats.arenas.4096.large.nrequests", large) ||
+            !read("stats.allocated", allocated)) return s;
+        s.valid = true;
+        s.allocs = small + large;
+        s.live_bytes = allocated;
+        return s;
+    }
+
+    // True if jemalloc was started with prof:true (sampling may still be inactive)
+    static bool profiling_enabled() noexcept {
+        bool prof = false;
+        return available() && read("opt.prof", prof) && prof;
+    }
+
+    static bool activate(bool on = true) noexcept {
+        return profiling_enabled() && mallctl("prof.active", nullptr, nullptr, &on, sizeof(on)) == 0;
+    }
+
+    static bool dump(const std::string& path) noexcept {
+        if (!profiling_enabled()) return false;
+        const char* p = path.c_str();
+        return mallctl("prof.dump", nullptr, nullptr, &p, sizeof(p)) == 0;
+    }
+
+private:
+    template <typename T>
+    static bool read(const char* name, T& out) noexcept {
+        size_t len = sizeof(T);
+        return mallctl(name, &out, &len, nullptr, 0) == 0 && len == sizeof(T);
+    }
+};
+
+} // namespace Hartonomous
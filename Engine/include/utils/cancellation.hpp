@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+/**
+ * @brief Thrown at a cancellation checkpoint once the token is cancelled
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+/**
+ * @brief One-shot cancellation flag shared between a caller and a running operation
+ *
+ * The operation polls cancelled() (or throw_if_cancelled()) between steps and
+ * registers hooks for work it cannot poll, such as a blocking database query.
+ * cancel() may come from any thread and runs each hook once.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel() {
+        if (cancelled_.exchange(true, std::memory_order_acq_rel)) return;
+        // Hooks run under the lock so remove_hook() cannot return while one is running
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [id, hook] : hooks_) hook();
+    }
+
+    bool cancelled() const noexcept { return cancelled_.load(std::memory_order_acquire); }
+
+    void throw_if_cancelled() const {
+        if (cancelled()) throw OperationCancelled();
+    }
+
+    /**
+     * @brief Run `hook` on cancel(), or right away if already cancelled
+     * @return ID for remove_hook()
+     *
+     * Hooks must be quick and must not touch this token.
+     */
+    size_t add_hook(std::function<void()> hook) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t id = next_id_++;
+        if (cancelled()) hook();
+        else hooks_.emplace_back(id, std::move(hook));
+        return id;
+    }
+
+    void remove_hook(size_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = hooks_.begin(); it != hooks_.end(); ++it) {
+            if (it->first == id) {
+                hooks_.erase(it);
+                return;
+            }
+        }
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::mutex mutex_;
+    std::vector<std::pair<size_t, std::function<void()>>> hooks_;
+    size_t next_id_ = 0;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,157 @@
+#pragma once
+
+/**
+ * @file cpu_dispatch.hpp
+ * @brief The instruction sets this CPU offers, detected once, for kernels built per ISA
+ *
+ * Hot kernels (multi-lane BLAKE3, batch Hilbert encode/decode, quantized
+ * HNSW distances, the S³ batch math) are compiled once per instruction set,
+ * in *_avx2.cpp / *_avx512.cpp translation units built with those flags, and
+ * picked from simd_level() when called. One engine_core build therefore runs
+ * at full width on any x86-64 host without -march=native. On aarch64 NEON is
+ * part of the base ISA, so the portable loops are already vectorized for it.
+ *
+ * HARTONOMOUS_SIMD=scalar|sse4|avx2|avx512 caps the level for a process
+ * (A/B runs, reproducing a result from an older host); limit_simd() does the
+ * same from code.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Set for the targets Engine/CMakeLists.txt builds the *_avx2 / *_avx512 units on
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HARTONOMOUS_X86_KERNELS 1
+#endif
+
+#if defined(HARTONOMOUS_X86_KERNELS)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Hartonomous {
+
+// Ordered by width; x86 kernels test >= Avx2, NEON only ever meets Scalar
+enum class SimdLevel : uint8_t { Scalar, Neon, Sse4, Avx2, Avx512 };
+
+inline const char* simd_level_name(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::Avx512: return "avx512";
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse4: return "sse4";
+        case SimdLevel::Neon: return "neon";
+        case SimdLevel::Scalar: break;
+    }
+    return "scalar";
+}
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false, fma = false, f16c = false;
+    bool avx512f = false, avx512bw = false, avx512dq = false, avx512vl = false, avx512vnni = false;
+    bool neon = false;
+
+    // What the CPU and OS support, before any cap
+    static const CpuFeatures& host() noexcept {
+        static const CpuFeatures features = detect();
+        return features;
+    }
+
+    // The level each *_avx2 / *_avx512 unit was built for
+    SimdLevel level() const noexcept {
+        if (avx512f && avx512bw && avx512dq && avx512vl && avx2 && fma && f16c) return SimdLevel::Avx512;
+        if (avx2 && fma && f16c) return SimdLevel::Avx2;
+        if (sse41) return SimdLevel::Sse4;
+        return neon ? SimdLevel::Neon : SimdLevel::Scalar;
+    }
+
+private:
+    static CpuFeatures detect() noexcept {
+        CpuFeatures f;
+#if defined(HARTONOMOUS_X86_KERNELS)
+        uint32_t r[4];
+        cpuid(0, r);
+        const uint32_t max_leaf = r[0];
+        cpuid(1, r);
+        f.sse41 = r[2] & (1u << 19);
+        // AVX state must be enabled by the OS (OSXSAVE, XCR0 bits 1-2), ZMM state for AVX-512
+        const bool osxsave = r[2] & (1u << 27);
+        const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+        const bool avx_os = (r[2] & (1u << 28)) && (xcr0 & 0x6) == 0x6;
+        const bool zmm_os = avx_os && (xcr0 & 0xE0) == 0xE0;
+        f.fma = avx_os && (r[2] & (1u << 12));
+        f.f16c = avx_os && (r[2] & (1u << 29));
+        if (max_leaf >= 7) {
+            cpuid(7, r);
+            f.avx2 = avx_os && (r[1] & (1u << 5));
+            f.avx512f = zmm_os && (r[1] & (1u << 16));
+            f.avx512dq = zmm_os && (r[1] & (1u << 17));
+            f.avx512bw = zmm_os && (r[1] & (1u << 30));
+            f.avx512vl = zmm_os && (r[1] & (1u << 31));
+            f.avx512vnni = zmm_os && (r[2] & (1u << 11));
+        }
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+        f.neon = true;
+#endif
+        return f;
+    }
+
+#if defined(HARTONOMOUS_X86_KERNELS)
+    static void cpuid(uint32_t leaf, uint32_t r[4]) noexcept {
+#if defined(_MSC_VER)
+        int regs[4];
+        __cpuidex(regs, static_cast<int>(leaf), 0);
+        for (int i = 0; i < 4; ++i) r[i] = static_cast<uint32_t>(regs[i]);
+#else
+        __cpuid_count(leaf, 0, r[0], r[1], r[2], r[3]);
+#endif
+    }
+
+    static uint64_t xgetbv0() noexcept {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+    }
+#endif
+};
+
+namespace detail {
+
+inline SimdLevel env_simd_cap() noexcept {
+    const char* v = std::getenv("HARTONOMOUS_SIMD");
+    if (!v) return SimdLevel::Avx512;
+    for (SimdLevel l : {SimdLevel::Scalar, SimdLevel::Neon, SimdLevel::Sse4, SimdLevel::Avx2})
+        if (std::strcmp(v, simd_level_name(l)) == 0) return l;
+    return SimdLevel::Avx512;
+}
+
+inline std::atomic<SimdLevel>& simd_cap() noexcept {
+    static std::atomic<SimdLevel> cap{env_simd_cap()};
+    return cap;
+}
+
+} // namespace detail
+
+// Widest level kernels may use: the host's, lowered by HARTONOMOUS_SIMD or limit_simd()
+inline SimdLevel simd_level() noexcept {
+    const SimdLevel host = CpuFeatures::host().level();
+    const SimdLevel cap = detail::simd_cap().load(std::memory_order_relaxed);
+    return cap < host ? cap : host;
+}
+
+// Cap the level for the whole process (SimdLevel::Avx512 lifts it); returns the level now in effect
+inline SimdLevel limit_simd(SimdLevel cap) noexcept {
+    detail::simd_cap().store(cap, std::memory_order_relaxed);
+    return simd_level();
+}
+
+} // namespace Hartonomous
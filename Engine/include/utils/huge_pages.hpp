@@ -0,0 +1,230 @@
+#pragma once
+
+/**
+ * @file huge_pages.hpp
+ * @brief Huge-page backing for the multi-GB read-only structures
+ *
+ * Walk steps and HNSW searches touch the atom table, the relation CSR, the
+ * composition text arena and HNSW level 0 at random, so with 4 KiB pages
+ * nearly every access is a TLB miss. HARTONOMOUS_HUGEPAGES picks the backing:
+ *
+ *   off        4 KiB pages, as before (default)
+ *   thp        transparent huge pages: madvise(MADV_HUGEPAGE) on anonymous
+ *              arrays, and snapshot files mapped at a 2 MiB-aligned address
+ *              with the same advice (the kernel only uses huge folios for a
+ *              file's page cache where the filesystem supports them)
+ *   hugetlb    snapshot files are read into a private MAP_HUGETLB copy of
+ *              2 MiB pages from the reserved pool (vm.nr_hugepages), trading
+ *              the shared page cache for guaranteed huge TLB entries;
+ *              anonymous arrays get thp
+ *   hugetlb1g  as hugetlb with 1 GiB pages
+ *
+ * Each step falls back to the next smaller one when the kernel refuses
+ * (empty pool, THP disabled), so a setting never makes a load fail.
+ * huge_page_usage() reads /proc/self/smaps to report what was actually
+ * obtained; the structures expose it for their own memory.
+ */
+
+#include <utils/numa.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Hartonomous {
+
+enum class HugePageMode : uint8_t { Off, Transparent, Explicit2M, Explicit1G };
+
+inline HugePageMode huge_page_mode() {
+    static const HugePageMode mode = [] {
+        const char* v = std::getenv("HARTONOMOUS_HUGEPAGES");
+        if (!v) return HugePageMode::Off;
+        if (std::strcmp(v, "thp") == 0) return HugePageMode::Transparent;
+        if (std::strcmp(v, "hugetlb") == 0) return HugePageMode::Explicit2M;
+        if (std::strcmp(v, "hugetlb1g") == 0) return HugePageMode::Explicit1G;
+        return HugePageMode::Off;
+    }();
+    return mode;
+}
+
+// What backs a range of memory, from the mappings that overlap it
+struct HugePageUsage {
+    size_t bytes = 0;          // Size of the range asked about
+    size_t huge_bytes = 0;     // Resident in transparent or hugetlb pages, at most `bytes`
+    bool hugetlb = false;      // Any of it is a hugetlb mapping
+
+    bool any() const noexcept { return huge_bytes > 0; }
+
+    HugePageUsage& operator+=(const HugePageUsage& o) noexcept {
+        bytes += o.bytes;
+        huge_bytes += o.huge_bytes;
+        hugetlb |= o.hugetlb;
+        return *this;
+    }
+};
+
+namespace detail {
+
+inline constexpr size_t HUGE_2M = size_t(1) << 21;
+inline constexpr size_t HUGE_1G = size_t(1) << 30;
+
+inline size_t round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+} // namespace detail
+
+/**
+ * @brief Ask for transparent huge pages over the 2 MiB-aligned interior of a range
+ *
+ * Best before the range is first touched; pages already faulted in are
+ * collapsed later by khugepaged. A no-op unless a huge page mode is set.
+ */
+inline void advise_huge_pages(const void* addr, size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (huge_page_mode() == HugePageMode::Off || !addr) return;
+    const uintptr_t begin = detail::round_up(reinterpret_cast<uintptr_t>(addr), detail::HUGE_2M);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + bytes) & ~(detail::HUGE_2M - 1);
+    if (end > begin) ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+#else
+    (void)addr;
+    (void)bytes;
+#endif
+}
+
+/**
+ * @brief Huge-page advice and NUMA interleave for one array of a structure
+ *
+ * Call right after reserve() where the array is built in place, so both
+ * apply as the pages fault in.
+ */
+template <typename Container>
+inline void place_array(const Container& c) {
+    const size_t bytes = c.capacity() * sizeof(*c.data());
+    advise_huge_pages(c.data(), bytes);
+    numa_interleave(c.data(), bytes);
+}
+
+/**
+ * @brief Map the first `size` bytes of `fd` read-only under huge_page_mode()
+ *
+ * Returns MAP_FAILED on failure. `mapped_bytes` receives the length to pass
+ * to munmap(), which for a hugetlb copy is rounded up to its page size.
+ */
+inline void* map_file_readonly(int fd, size_t size, size_t& mapped_bytes) {
+#if defined(__linux__)
+    mapped_bytes = size;
+    const HugePageMode mode = huge_page_mode();
+
+#if defined(MAP_HUGETLB)
+    if (mode == HugePageMode::Explicit2M || mode == HugePageMode::Explicit1G) {
+        constexpr int HUGE_SHIFT = 26;   // MAP_HUGE_SHIFT
+        for (size_t page : {detail::HUGE_1G, detail::HUGE_2M}) {
+            if (page == detail::HUGE_1G && mode != HugePageMode::Explicit1G) continue;
+            const int log2 = page == detail::HUGE_1G ? 30 : 21;
+            const size_t len = detail::round_up(size, page);
+            void* addr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2 << HUGE_SHIFT), -1, 0);
+            if (addr == MAP_FAILED) continue;
+            numa_interleave(addr, len);   // Before the copy faults the pages in
+            size_t done = 0;
+            while (done < size) {
+                const ssize_t n = ::pread(fd, static_cast<char*>(addr) + done, size - done, static_cast<off_t>(done));
+                if (n <= 0) break;
+                done += static_cast<size_t>(n);
+            }
+            if (done == size && ::mprotect(addr, len, PROT_READ) == 0) {
+                mapped_bytes = len;
+                return addr;
+            }
+            ::munmap(addr, len);
+            if (done != size) return MAP_FAILED;
+        }
+    }
+#endif
+
+    if (mode == HugePageMode::Off || size < detail::HUGE_2M)
+        return ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // Reserve 2 MiB of slack so the file can start on a huge page boundary
+    const size_t span = size + detail::HUGE_2M;
+    void* reserve = ::mmap(nullptr, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserve == MAP_FAILED) return ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(reserve);
+    const uintptr_t aligned = detail::round_up(base, detail::HUGE_2M);
+    void* addr = ::mmap(reinterpret_cast<void*>(aligned), size, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ::munmap(reserve, span);
+        return ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (aligned > base) ::munmap(reserve, aligned - base);
+    const uintptr_t tail = aligned + size;
+    if (base + span > tail) ::munmap(reinterpret_cast<void*>(tail), base + span - tail);
+    advise_huge_pages(addr, size);
+    return addr;
+#else
+    (void)fd;
+    (void)size;
+    mapped_bytes = 0;
+    return reinterpret_cast<void*>(-1);
+#endif
+}
+
+/**
+ * @brief How much of [addr, addr + bytes) the kernel backs with huge pages
+ *
+ * Mappings that only partly overlap the range (a heap arena around a
+ * vector) are counted in proportion to the overlap.
+ */
+inline HugePageUsage huge_page_usage(const void* addr, size_t bytes) {
+    HugePageUsage usage;
+    usage.bytes = bytes;
+#if defined(__linux__)
+    if (!addr || bytes == 0) return usage;
+    const uintptr_t lo = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t hi = lo + bytes;
+
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t vma_lo = 0, vma_hi = 0;
+    bool overlaps = false;
+    double huge = 0;
+    while (std::getline(smaps, line)) {
+        unsigned long a, b;
+        if (std::sscanf(line.c_str(), "%lx-%lx ", &a, &b) == 2) {   // Mapping header; field names never parse
+            vma_lo = a;
+            vma_hi = b;
+            overlaps = vma_lo < hi && vma_hi > lo;
+            continue;
+        }
+        if (!overlaps) continue;
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        const std::string key = line.substr(0, colon);
+        const bool tlb = key == "Private_Hugetlb" || key == "Shared_Hugetlb";
+        if (!tlb && key != "AnonHugePages" && key != "FilePmdMapped" && key != "ShmemPmdMapped") continue;
+        const double kb = std::strtod(line.c_str() + colon + 1, nullptr);
+        if (kb <= 0) continue;
+        const double overlap = static_cast<double>(std::min(hi, vma_hi) - std::max(lo, vma_lo));
+        huge += kb * 1024.0 * overlap / static_cast<double>(vma_hi - vma_lo);
+        usage.hugetlb |= tlb;
+    }
+    usage.huge_bytes = std::min(bytes, static_cast<size_t>(huge));
+#endif
+    return usage;
+}
+
+// huge_page_usage() of a container's elements
+template <typename Container>
+inline HugePageUsage array_huge_page_usage(const Container& c) {
+    return huge_page_usage(c.data(), c.size() * sizeof(*c.data()));
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,208 @@
+#pragma once
+
+/**
+ * @file ingest_report.hpp
+ * @brief Machine-readable account of one ingest run: COPY volume, phases, allocations, peak RSS
+ *
+ * Process-wide and cheap enough to be always on. BulkCopy adds every
+ * finished COPY (rows and bytes per table), AsyncFlusher its totals when it
+ * shuts down, and tools wrap their phases in Phase scopes. When
+ * HARTONOMOUS_INGEST_REPORT names a file, the report is written there as
+ * JSON at process exit; scripts/linux/bench-ingest.sh collects and compares
+ * these files.
+ *
+ * On jemalloc each phase also carries the allocations made since the
+ * previous phase ended (phases run one after another in every tool) and the
+ * COPY rows finished in that span, so allocs_per_row tracks allocation work
+ * per record. HARTONOMOUS_ALLOC_PROFILE=1 additionally turns on jemalloc's
+ * call-site sampler at start() and dumps a heap profile next to the report
+ * (see alloc_stats.hpp for the startup requirement).
+ */
+
+#include <utils/alloc_stats.hpp>
+#include <utils/metrics.hpp>
+#include <nlohmann/json.hpp>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class IngestReport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static IngestReport& global() {
+        static IngestReport report;
+        return report;
+    }
+
+    // Name the run and restart its wall clock (call first thing in main)
+    void start(int argc, char** argv) {
+        std::lock_guard<std::mutex> lock(mu_);
+        args_.assign(argv + (argc > 0 ? 1 : 0), argv + argc);
+        tool_ = argc > 0 ? argv[0] : "";
+        if (auto slash = tool_.rfind('/'); slash != std::string::npos) tool_.erase(0, slash + 1);
+        start_ = Clock::now();
+
+        const char* profile = std::getenv("HARTONOMOUS_ALLOC_PROFILE");
+        if (profile && *profile && std::string(profile) != "0") {
+            if (AllocStats::activate()) {
+                const char* report = std::getenv("HARTONOMOUS_INGEST_REPORT");
+                heap_profile_ = report && *report ? std::string(report) + ".heap"
+                                                  : tool_ + "." + std::to_string(::getpid()) + ".heap";
+            } else {
+                std::cerr << "[IngestReport] HARTONOMOUS_ALLOC_PROFILE set but jemalloc profiling is off "
+                             "(build with HARTONOMOUS_ALLOC_PROFILE=ON or set MALLOC_CONF=prof:true)" << std::endl;
+            }
+        }
+        alloc_start_ = alloc_mark_ = AllocStats::now();
+        rows_mark_ = rows_total_;
+    }
+
+    // One finished COPY into `table`
+    void copied(const std::string& table, uint64_t rows, uint64_t bytes, double ms) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& t = tables_[table];
+        t.rows += rows;
+        t.bytes += bytes;
+        t.copies += 1;
+        t.copy_ms += ms;
+        rows_total_ += rows;
+    }
+
+    // Phases keep first-seen order; a repeated name accumulates
+    void phase(const std::string& name, double ms) {
+        Metrics::global().histogram("hartonomous_ingest_phase_seconds", Metrics::label("phase", name),
+                                    "Wall time of ingest tool phases").observe_ms(ms);
+        const auto alloc = AllocStats::now();
+        std::lock_guard<std::mutex> lock(mu_);
+        const uint64_t allocs = alloc.valid && alloc_mark_.valid ? alloc.allocs - alloc_mark_.allocs : 0;
+        const uint64_t rows = rows_total_ - rows_mark_;
+        alloc_mark_ = alloc;
+        rows_mark_ = rows_total_;
+        peak_live_bytes_ = std::max(peak_live_bytes_, alloc.live_bytes);
+        for (auto& p : phases_)
+            if (p.name == name) { p.ms += ms; p.allocs += allocs; p.rows += rows; return; }
+        phases_.push_back({name, ms, allocs, rows});
+    }
+
+    // Counters sum over the run
+    void add(const std::string& name, double value) {
+        std::lock_guard<std::mutex> lock(mu_);
+        counters_[name] += value;
+    }
+
+    // Times its scope as one phase
+    class Phase {
+    public:
+        explicit Phase(std::string name) : name_(std::move(name)), t0_(Clock::now()) {}
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+        ~Phase() {
+            global().phase(name_, std::chrono::duration<double, std::milli>(Clock::now() - t0_).count());
+        }
+
+    private:
+        std::string name_;
+        Clock::time_point t0_;
+    };
+
+    nlohmann::json to_json() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        const double wall = std::chrono::duration<double>(Clock::now() - start_).count();
+        struct rusage ru {};
+        ::getrusage(RUSAGE_SELF, &ru);
+
+        nlohmann::json j;
+        j["tool"] = tool_;
+        j["args"] = args_;
+        j["wall_sec"] = wall;
+        j["peak_rss_bytes"] = static_cast<uint64_t>(ru.ru_maxrss) * 1024;  // Linux reports KiB
+
+        const auto alloc = AllocStats::now();
+        auto per_row = [](uint64_t allocs, uint64_t rows) { return rows ? static_cast<double>(allocs) / rows : 0.0; };
+
+        j["phases"] = nlohmann::json::array();
+        for (const auto& p : phases_) {
+            nlohmann::json ph = {{"name", p.name}, {"ms", p.ms}};
+            if (alloc.valid) {
+                ph["allocs"] = p.allocs;
+                ph["rows"] = p.rows;
+                ph["allocs_per_row"] = per_row(p.allocs, p.rows);
+            }
+            j["phases"].push_back(std::move(ph));
+        }
+
+        uint64_t rows = 0, bytes = 0;
+        j["tables"] = nlohmann::json::object();
+        for (const auto& [name, t] : tables_) {
+            j["tables"][name] = {{"rows", t.rows}, {"bytes", t.bytes}, {"copies", t.copies},
+                                 {"copy_ms", t.copy_ms}, {"rows_per_sec", wall > 0 ? t.rows / wall : 0.0}};
+            rows += t.rows;
+            bytes += t.bytes;
+        }
+        j["copy_rows"] = rows;
+        j["copy_bytes"] = bytes;
+        j["counters"] = counters_;
+        if (alloc.valid && alloc_start_.valid) {
+            const uint64_t allocs = alloc.allocs - alloc_start_.allocs;
+            j["alloc"] = {{"allocs", allocs}, {"allocs_per_row", per_row(allocs, rows)},
+                          {"live_bytes", alloc.live_bytes},
+                          {"peak_live_bytes_at_phase_end", std::max(peak_live_bytes_, alloc.live_bytes)}};
+            if (!heap_profile_.empty()) j["alloc"]["heap_profile"] = heap_profile_;
+        }
+        return j;
+    }
+
+    // Writes to $HARTONOMOUS_INGEST_REPORT if set, and the heap profile if on; called again at exit
+    void write_if_requested() const {
+        if (!heap_profile_.empty() && !AllocStats::dump(heap_profile_))
+            std::cerr << "[IngestReport] Heap profile dump to " << heap_profile_ << " failed" << std::endl;
+        const char* path = std::getenv("HARTONOMOUS_INGEST_REPORT");
+        if (!path || !*path) return;
+        std::ofstream out(path);
+        if (out) out << to_json().dump(2) << '\n';
+        if (!out) std::cerr << "[IngestReport] Writing " << path << " failed" << std::endl;
+    }
+
+    ~IngestReport() { write_if_requested(); }
+
+private:
+    IngestReport() : start_(Clock::now()), alloc_start_(AllocStats::now()), alloc_mark_(alloc_start_) {}
+
+    struct Table {
+        uint64_t rows = 0, bytes = 0, copies = 0;
+        double copy_ms = 0.0;
+    };
+
+    struct PhaseStat {
+        std::string name;
+        double ms = 0.0;
+        uint64_t allocs = 0;    // Since the previous phase ended
+        uint64_t rows = 0;      // COPY rows finished in that span
+    };
+
+    mutable std::mutex mu_;
+    std::string tool_;
+    std::vector<std::string> args_;
+    Clock::time_point start_;
+    std::vector<PhaseStat> phases_;
+    std::map<std::string, Table> tables_;
+    std::map<std::string, double> counters_;
+    AllocStats::Snapshot alloc_start_, alloc_mark_;
+    uint64_t rows_total_ = 0, rows_mark_ = 0, peak_live_bytes_ = 0;
+    std::string heap_profile_;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,105 @@
+#pragma once
+
+/**
+ * @file instance_pool.hpp
+ * @brief Interchangeable engine instances checked out one caller at a time
+ *
+ * An engine object holds one database connection and per-call scratch, so
+ * two threads must not use the same one. The heavy state behind it (text
+ * store, centroid index, neighbor cache, position table, relation graph) is
+ * process-wide and shared, which makes another instance cheap: the pool
+ * builds one when every existing instance is in use and keeps up to
+ * max_idle of them for the next callers.
+ *
+ * retire() drops the idle instances, and instances checked out at the time
+ * are destroyed instead of returned, so every later acquire() builds against
+ * whatever the factory now picks (a different connection pool, say).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Hartonomous {
+
+template <typename T>
+class InstancePool {
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+    /**
+     * @brief Exclusive use of one instance until destroyed
+     */
+    class Lease {
+    public:
+        Lease(Lease&& o) noexcept : pool_(o.pool_), obj_(std::move(o.obj_)), generation_(o.generation_) { o.pool_ = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() { if (pool_ && obj_) pool_->give_back(std::move(obj_), generation_); }
+
+        T& operator*() const { return *obj_; }
+        T* operator->() const { return obj_.get(); }
+        T* get() const { return obj_.get(); }
+
+    private:
+        friend class InstancePool;
+        Lease(InstancePool* pool, std::unique_ptr<T> obj, uint64_t generation)
+            : pool_(pool), obj_(std::move(obj)), generation_(generation) {}
+
+        InstancePool* pool_;
+        std::unique_ptr<T> obj_;
+        uint64_t generation_;
+    };
+
+    // Builds the first instance now, so construction errors surface here
+    explicit InstancePool(Factory make, size_t max_idle = 4)
+        : make_(std::move(make)), max_idle_(max_idle ? max_idle : 1) {
+        idle_.push_back(make_());
+    }
+
+    InstancePool(const InstancePool&) = delete;
+    InstancePool& operator=(const InstancePool&) = delete;
+
+    // An idle instance, or a new one when all are checked out
+    Lease acquire() {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation = generation_;
+            if (!idle_.empty()) {
+                auto obj = std::move(idle_.back());
+                idle_.pop_back();
+                return Lease(this, std::move(obj), generation);
+            }
+        }
+        return Lease(this, make_(), generation);
+    }
+
+    // Stop reusing every instance built so far
+    void retire() {
+        std::vector<std::unique_ptr<T>> dropped;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+        dropped.swap(idle_);  // Destroyed after the lock is released
+    }
+
+private:
+    void give_back(std::unique_ptr<T> obj, uint64_t generation) noexcept {
+        std::unique_ptr<T> surplus;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_ && idle_.size() < max_idle_) idle_.push_back(std::move(obj));
+        else surplus = std::move(obj);  // Destroyed after the lock is released
+    }
+
+    Factory make_;
+    size_t max_idle_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> idle_;
+    uint64_t generation_ = 0;
+};
+
+} // namespace Hartonomous
@@ -0,0 +1,318 @@
+#pragma once
+
+/**
+ * @file memory_governor.hpp
+ * @brief One memory budget shared by every engine cache in the process
+ *
+ * Each cache enrolls an Account with a name and a priority and reports its
+ * estimated size through it as it grows. When the total passes the budget
+ * the governor asks caches to shrink, lowest priority and largest first,
+ * until the total is back under seven eighths of the budget (so steady
+ * growth does not trigger a pass on every insert). Pinned caches are
+ * counted but never asked: they hold state that cannot be rebuilt on a
+ * miss (dedup sets, centroids an ingest is still reading).
+ *
+ * A thread-safe cache passes a Shrink callback, which the governor calls
+ * on the thread that crossed the budget. A cache owned by one thread
+ * instead polls shrink_requested() at its next operation and trims itself
+ * there, since nothing else may touch it. A callback must not enroll or
+ * release accounts; it may (and should) report its new size.
+ *
+ *   HARTONOMOUS_MEMORY_BUDGET   bytes, with an optional K/M/G suffix; unset or 0: unlimited
+ *
+ * Per-cache sizes, the budget and the shrink count are rendered as
+ * hartonomous_memory_* metrics.
+ */
+
+#include <utils/metrics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Hartonomous {
+
+class MemoryGovernor {
+public:
+    enum class Priority : uint8_t { Low, Normal, High, Pinned };
+
+    // Bring the cache to at most `target_bytes` now
+    using Shrink = std::function<void(size_t target_bytes)>;
+
+    static constexpr size_t NO_TARGET = ~size_t(0);
+
+private:
+    struct Entry {
+        std::string name;
+        Priority priority;
+        Shrink shrink;
+        std::atomic<size_t> bytes{0};
+        std::atomic<size_t> target{NO_TARGET};
+    };
+
+public:
+    /**
+     * @brief A cache's registration; unregisters on destruction
+     *
+     * Default-constructed accounts belong to no governor and ignore updates.
+     */
+    class Account {
+    public:
+        Account() = default;
+        Account(Account&& o) noexcept : governor_(std::exchange(o.governor_, nullptr)), entry_(std::move(o.entry_)) {}
+        Account& operator=(Account&& o) noexcept {
+            if (this != &o) {
+                release();
+                governor_ = std::exchange(o.governor_, nullptr);
+                entry_ = std::move(o.entry_);
+            }
+            return *this;
+        }
+        Account(const Account&) = delete;
+        Account& operator=(const Account&) = delete;
+        ~Account() { release(); }
+
+        // Report the cache's current size; may run a shrink pass on this thread
+        void update(size_t bytes) noexcept {
+            if (!entry_) return;
+            const size_t old = entry_->bytes.exchange(bytes, std::memory_order_relaxed);
+            if (bytes >= old) {
+                const size_t total = governor_->total_.fetch_add(bytes - old, std::memory_order_relaxed) + (bytes - old);
+                if (bytes > old && governor_->over(total)) governor_->try_enforce();
+            } else {
+                governor_->total_.fetch_sub(old - bytes, std::memory_order_relaxed);
+            }
+        }
+
+        // Whether the governor asked this cache to trim to target()
+        bool shrink_requested() const noexcept {
+            return entry_ && entry_->target.load(std::memory_order_relaxed) != NO_TARGET;
+        }
+        size_t target() const noexcept { return entry_ ? entry_->target.load(std::memory_order_relaxed) : NO_TARGET; }
+
+        // Report the size after trimming for a request, which clears it
+        void shrunk(size_t bytes) noexcept {
+            if (!entry_) return;
+            entry_->target.store(NO_TARGET, std::memory_order_relaxed);
+            update(bytes);
+        }
+
+        size_t bytes() const noexcept { return entry_ ? entry_->bytes.load(std::memory_order_relaxed) : 0; }
+
+    private:
+        friend class MemoryGovernor;
+        Account(MemoryGovernor* governor, std::shared_ptr<Entry> entry) : governor_(governor), entry_(std::move(entry)) {}
+
+        void release() noexcept {
+            if (entry_) governor_->remove(entry_);
+            entry_.reset();
+            governor_ = nullptr;
+        }
+
+        MemoryGovernor* governor_ = nullptr;
+        std::shared_ptr<Entry> entry_;
+    };
+
+    struct CacheUsage {
+        std::string name;
+        Priority priority;
+        size_t bytes = 0;
+        size_t instances = 0;   // Accounts enrolled under the name
+    };
+
+    // 0: unlimited
+    explicit MemoryGovernor(size_t budget = 0) : budget_(budget) {}
+
+    MemoryGovernor(const MemoryGovernor&) = delete;
+    MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+    /**
+     * @brief Process-wide governor, budget from HARTONOMOUS_MEMORY_BUDGET
+     */
+    static MemoryGovernor& global() {
+        static MemoryGovernor* governor = [] {
+            const char* s = std::getenv("HARTONOMOUS_MEMORY_BUDGET");
+            // Never destroyed: caches in other statics may release their accounts after it would be
+            auto* g = new MemoryGovernor(s ? parse_bytes(s) : 0);
+            Metrics::global().add_collector([g](Metrics& m) { g->publish(m); });
+            return g;
+        }();
+        return *governor;
+    }
+
+    // "4096", "512K", "64M", "8G" (powers of 1024); 0 for anything unparsable
+    static size_t parse_bytes(std::string_view s) {
+        size_t value = 0, i = 0;
+        while (i < s.size() && s[i] == ' ') ++i;
+        const size_t digits = i;
+        for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) value = value * 10 + size_t(s[i] - '0');
+        if (i == digits) return 0;
+        if (i < s.size()) {
+            switch (s[i] | 0x20) {
+                case 'k': return value << 10;
+                case 'm': return value << 20;
+                case 'g': return value << 30;
+                default: return 0;
+            }
+        }
+        return value;
+    }
+
+    // Estimated heap bytes of a node-based hash map (nodes, two links each, and the bucket array)
+    template <typename Map>
+    static size_t hash_map_bytes(const Map& m) noexcept {
+        return m.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*)) + m.bucket_count() * sizeof(void*);
+    }
+
+    Account enroll(std::string name, Priority priority, Shrink shrink = {}) {
+        auto entry = std::make_shared<Entry>();
+        entry->name = std::move(name);
+        entry->priority = priority;
+        entry->shrink = std::move(shrink);
+        std::lock_guard<std::mutex> lock(mu_);
+        entries_.push_back(entry);
+        names_.insert(entry->name);
+        return Account(this, std::move(entry));
+    }
+
+    void set_budget(size_t bytes) {
+        budget_.store(bytes, std::memory_order_relaxed);
+        enforce();
+    }
+    size_t budget() const noexcept { return budget_.load(std::memory_order_relaxed); }
+    size_t used() const noexcept { return total_.load(std::memory_order_relaxed); }
+    uint64_t shrinks() const noexcept { return shrinks_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Shrink caches until the total is under the low watermark
+     * @return Bytes asked of caches (released already by callbacks, or pending with their owners)
+     */
+    size_t enforce() {
+        if (enforcing_) return 0;
+        std::lock_guard<std::mutex> lock(mu_);
+        return enforce_locked();
+    }
+
+    // Totals per cache name, highest first
+    std::vector<CacheUsage> usage_by_cache() const {
+        std::map<std::string, CacheUsage> by_name;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            for (const auto& e : entries_) {
+                auto& u = by_name[e->name];
+                u.name = e->name;
+                u.priority = e->priority;
+                u.bytes += e->bytes.load(std::memory_order_relaxed);
+                ++u.instances;
+            }
+        }
+        std::vector<CacheUsage> out;
+        for (auto& [name, u] : by_name) out.push_back(std::move(u));
+        std::sort(out.begin(), out.end(), [](const CacheUsage& a, const CacheUsage& b) { return a.bytes > b.bytes; });
+        return out;
+    }
+
+    // Refresh the hartonomous_memory_* gauges in `m`
+    void publish(Metrics& m) const {
+        std::map<std::string, size_t> bytes;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            for (const auto& name : names_) bytes[name] = 0;   // Caches gone since the last render read 0
+            for (const auto& e : entries_) bytes[e->name] += e->bytes.load(std::memory_order_relaxed);
+        }
+        for (const auto& [name, b] : bytes) {
+            m.gauge("hartonomous_memory_cache_bytes", Metrics::label("cache", name),
+                    "Estimated bytes held by each engine cache").set(static_cast<int64_t>(b));
+        }
+        m.gauge("hartonomous_memory_used_bytes", {}, "Estimated bytes held by all engine caches")
+            .set(static_cast<int64_t>(used()));
+        m.gauge("hartonomous_memory_budget_bytes", {}, "Engine cache budget (HARTONOMOUS_MEMORY_BUDGET; 0: unlimited)")
+            .set(static_cast<int64_t>(budget()));
+        m.gauge("hartonomous_memory_shrinks", {}, "Shrink requests made of engine caches since start")
+            .set(static_cast<int64_t>(shrinks()));
+    }
+
+private:
+    bool over(size_t total) const noexcept {
+        const size_t b = budget();
+        return b != 0 && total > b;
+    }
+
+    void try_enforce() noexcept {
+        // A cache reporting from inside a Shrink callback must not re-enter
+        if (enforcing_) return;
+        std::unique_lock<std::mutex> lock(mu_, std::try_to_lock);
+        if (!lock.owns_lock()) return;   // Another thread is already enforcing
+        try {
+            enforce_locked();
+        } catch (...) {
+            // A failed callback leaves its cache as it was; the next growth retries
+        }
+    }
+
+    size_t enforce_locked() {
+        const size_t b = budget();
+        const size_t total = used();
+        if (b == 0 || total <= b) return 0;
+        size_t excess = total - (b - b / 8);
+
+        std::vector<Entry*> order;
+        for (const auto& e : entries_) {
+            if (e->priority == Priority::Pinned || e->target.load(std::memory_order_relaxed) != NO_TARGET) continue;
+            if (e->bytes.load(std::memory_order_relaxed) > 0) order.push_back(e.get());
+        }
+        std::sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) {
+            if (a->priority != b->priority) return a->priority < b->priority;
+            return a->bytes.load(std::memory_order_relaxed) > b->bytes.load(std::memory_order_relaxed);
+        });
+
+        struct Guard {
+            Guard() { enforcing_ = true; }
+            ~Guard() { enforcing_ = false; }
+        } guard;
+        size_t asked = 0;
+        for (Entry* e : order) {
+            if (excess == 0) break;
+            const size_t before = e->bytes.load(std::memory_order_relaxed);
+            const size_t cut = std::min(before, excess);
+            shrinks_.fetch_add(1, std::memory_order_relaxed);
+            asked += cut;
+            if (e->shrink) {
+                e->shrink(before - cut);
+                const size_t after = e->bytes.load(std::memory_order_relaxed);
+                excess -= std::min(excess, before > after ? before - after : 0);
+            } else {
+                e->target.store(before - cut, std::memory_order_relaxed);
+                excess -= cut;
+            }
+        }
+        return asked;
+    }
+
+    void remove(const std::shared_ptr<Entry>& entry) noexcept {
+        // Waits out a pass that may be calling this entry's Shrink
+        std::lock_guard<std::mutex> lock(mu_);
+        entries_.erase(std::remove(entries_.begin(), entries_.end(), entry), entries_.end());
+        total_.fetch_sub(entry->bytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    static inline thread_local bool enforcing_ = false;
+
+    mutable std::mutex mu_;
+    std::vector<std::shared_ptr<Entry>> entries_;
+    std::set<std::string> names_;   // Every name ever enrolled
+    std::atomic<size_t> budget_;
+    std::atomic<size_t> total_{0};
+    std::atomic<uint64_t> shrinks_{0};
+};
+
+} // namespace Hartonomous
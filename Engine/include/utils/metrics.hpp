@@ -0,0 +1,284 @@
+#pragma once
+
+/**
+ * @file metrics.hpp
+ * @brief Process-wide counters and latency histograms, rendered as Prometheus text
+ *
+ * Every metric is split into SHARDS cache-line-sized cells and a thread
+ * only adds to the cell its index picks, with relaxed atomics: the hot path
+ * is one uncontended add, no lock and no allocation. Reading sums the cells.
+ * A name is registered under the registry lock on first use; the
+ * HARTONOMOUS_SPAN and HARTONOMOUS_COUNT macros keep the handle in a
+ * function-local static so later calls skip the lookup.
+ *
+ * Spans are histograms of scope wall time under one family,
+ * hartonomous_span_seconds{span="..."}. Gauges hold a level rather than a
+ * count; a collector hook refreshes them when the text is rendered. Built with HARTONOMOUS_NO_METRICS
+ * (cmake -DHARTONOMOUS_ENABLE_METRICS=OFF) the macros compile to nothing;
+ * the registry itself stays, so the C API and explicit callers still link.
+ * The text is what hartonomous_metrics_prometheus returns and the API's
+ * /metrics/engine serves; OpenTelemetry collectors scrape it with their
+ * Prometheus receiver.
+ */
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Hartonomous {
+
+class Metrics {
+public:
+    static constexpr size_t SHARDS = 32;
+    static constexpr size_t BUCKETS = 28;  // Upper bounds 1 µs * 2^i, to about 134 s, then +Inf
+
+    class Counter {
+    public:
+        void add(uint64_t n = 1) noexcept { cells_[shard()].v.fetch_add(n, std::memory_order_relaxed); }
+
+        uint64_t value() const noexcept {
+            uint64_t sum = 0;
+            for (const auto& c : cells_) sum += c.v.load(std::memory_order_relaxed);
+            return sum;
+        }
+
+    private:
+        struct alignas(64) Cell { std::atomic<uint64_t> v{0}; };
+        std::array<Cell, SHARDS> cells_;
+    };
+
+    class Histogram {
+    public:
+        struct Snapshot {
+            std::array<uint64_t, BUCKETS + 1> counts{};  // Per bucket, not cumulative
+            uint64_t count = 0;
+            uint64_t sum_ns = 0;
+        };
+
+        void observe_ns(uint64_t ns) noexcept {
+            auto& c = cells_[shard()];
+            c.counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+            c.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        void observe_ms(double ms) noexcept { observe_ns(ms > 0 ? static_cast<uint64_t>(ms * 1e6) : 0); }
+
+        Snapshot snapshot() const noexcept {
+            Snapshot s;
+            for (const auto& c : cells_) {
+                for (size_t b = 0; b <= BUCKETS; ++b) s.counts[b] += c.counts[b].load(std::memory_order_relaxed);
+                s.sum_ns += c.sum_ns.load(std::memory_order_relaxed);
+            }
+            for (uint64_t n : s.counts) s.count += n;
+            return s;
+        }
+
+        // Index of the first bound at or above ns; BUCKETS is +Inf
+        static size_t bucket(uint64_t ns) noexcept {
+            size_t b = ns ? static_cast<size_t>(std::bit_width((ns - 1) / 1000)) : 0;
+            return b < BUCKETS ? b : BUCKETS;
+        }
+
+        static double upper_bound_seconds(size_t b) noexcept { return 1e-6 * static_cast<double>(uint64_t(1) << b); }
+
+    private:
+        struct alignas(64) Cell {
+            std::array<std::atomic<uint64_t>, BUCKETS + 1> counts{};
+            std::atomic<uint64_t> sum_ns{0};
+        };
+        std::array<Cell, SHARDS> cells_;
+    };
+
+    // A level that goes up and down (bytes held, entries cached); set rarely, so one cell
+    class Gauge {
+    public:
+        void set(int64_t v) noexcept { v_.store(v, std::memory_order_relaxed); }
+        void add(int64_t n) noexcept { v_.fetch_add(n, std::memory_order_relaxed); }
+        int64_t value() const noexcept { return v_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> v_{0};
+    };
+
+    // Records the scope's wall time into a histogram
+    class ScopeTimer {
+    public:
+        explicit ScopeTimer(Histogram& h) noexcept : h_(h), t0_(std::chrono::steady_clock::now()) {}
+        ScopeTimer(const ScopeTimer&) = delete;
+        ScopeTimer& operator=(const ScopeTimer&) = delete;
+        ~ScopeTimer() {
+            h_.observe_ns(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0_).count()));
+        }
+
+    private:
+        Histogram& h_;
+        std::chrono::steady_clock::time_point t0_;
+    };
+
+    static Metrics& global() {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    /**
+     * @brief The metric `name` with `labels` (Prometheus syntax without braces, e.g. label("table", t))
+     *
+     * Registered on first use; the reference stays valid for the life of the
+     * process. help is recorded by the first registration of the family.
+     */
+    Counter& counter(std::string_view name, std::string_view labels = {}, std::string_view help = {}) {
+        return get<Counter>(name, labels, help, "counter");
+    }
+
+    Histogram& histogram(std::string_view name, std::string_view labels = {}, std::string_view help = {}) {
+        return get<Histogram>(name, labels, help, "histogram");
+    }
+
+    Gauge& gauge(std::string_view name, std::string_view labels = {}, std::string_view help = {}) {
+        return get<Gauge>(name, labels, help, "gauge");
+    }
+
+    // Run `fn` before every prometheus() render, outside the registry lock, to refresh gauges
+    void add_collector(std::function<void(Metrics&)> fn) {
+        std::lock_guard<std::mutex> lock(mu_);
+        collectors_.push_back(std::move(fn));
+    }
+
+    // Histogram of the named span
+    Histogram& span(std::string_view name) {
+        return histogram("hartonomous_span_seconds", label("span", name), "Wall time of instrumented engine scopes");
+    }
+
+    // key="value" with the value escaped for the text format
+    static std::string label(std::string_view key, std::string_view value) {
+        std::string out(key);
+        out += "=\"";
+        for (char c : value) {
+            if (c == '\\' || c == '"') out += '\\';
+            if (c == '\n') { out += "\\n"; continue; }
+            out += c;
+        }
+        out += '"';
+        return out;
+    }
+
+    // Prometheus text exposition format 0.0.4
+    std::string prometheus() {
+        std::vector<std::function<void(Metrics&)>> collectors;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            collectors = collectors_;
+        }
+        for (const auto& fn : collectors) fn(*this);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        std::string out;
+        char num[64];
+        auto braced = [](const std::string& labels, const std::string& extra) {
+            if (labels.empty() && extra.empty()) return std::string();
+            return "{" + labels + (labels.empty() || extra.empty() ? "" : ",") + extra + "}";
+        };
+        for (const auto& [name, family] : families_) {
+            if (!family.help.empty()) out += "# HELP " + name + " " + family.help + "\n";
+            out += "# TYPE " + name + " " + family.type + "\n";
+            for (const auto& [labels, c] : family.counters) {
+                std::snprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(c->value()));
+                out += name + braced(labels, "") + " " + num + "\n";
+            }
+            for (const auto& [labels, g] : family.gauges) {
+                std::snprintf(num, sizeof(num), "%lld", static_cast<long long>(g->value()));
+                out += name + braced(labels, "") + " " + num + "\n";
+            }
+            for (const auto& [labels, h] : family.histograms) {
+                auto s = h->snapshot();
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    cumulative += s.counts[b];
+                    std::snprintf(num, sizeof(num), "%g", Histogram::upper_bound_seconds(b));
+                    std::string le = std::string("le=\"") + num + "\"";
+                    std::snprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(cumulative));
+                    out += name + "_bucket" + braced(labels, le) + " " + num + "\n";
+                }
+                std::snprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(s.count));
+                out += name + "_bucket" + braced(labels, "le=\"+Inf\"") + " " + num + "\n";
+                out += name + "_count" + braced(labels, "") + " " + num + "\n";
+                std::snprintf(num, sizeof(num), "%.9g", static_cast<double>(s.sum_ns) * 1e-9);
+                out += name + "_sum" + braced(labels, "") + " " + num + "\n";
+            }
+        }
+        return out;
+    }
+
+private:
+    Metrics() = default;
+
+    struct Family {
+        std::string type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>, std::less<>> counters;
+        std::map<std::string, std::unique_ptr<Histogram>, std::less<>> histograms;
+        std::map<std::string, std::unique_ptr<Gauge>, std::less<>> gauges;
+    };
+
+    // Cell a thread adds to: threads take indices in order of first use
+    static size_t shard() noexcept {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+
+    template <typename T>
+    T& get(std::string_view name, std::string_view labels, std::string_view help, const char* type) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = families_.find(name);
+        if (it == families_.end()) it = families_.emplace(std::string(name), Family{type, std::string(help), {}, {}, {}}).first;
+        auto& family = it->second;
+        auto& map = [&]() -> auto& {
+            if constexpr (std::is_same_v<T, Counter>) return family.counters;
+            else if constexpr (std::is_same_v<T, Gauge>) return family.gauges;
+            else return family.histograms;
+        }();
+        auto m = map.find(labels);
+        if (m == map.end()) m = map.emplace(std::string(labels), std::make_unique<T>()).first;
+        return *m->second;
+    }
+
+    mutable std::mutex mu_;
+    std::map<std::string, Family, std::less<>> families_;
+    std::vector<std::function<void(Metrics&)>> collectors_;
+};
+
+} // namespace Hartonomous
+
+#define HARTONOMOUS_METRICS_CAT_(a, b) a##b
+#define HARTONOMOUS_METRICS_CAT(a, b) HARTONOMOUS_METRICS_CAT_(a, b)
+
+#ifndef HARTONOMOUS_NO_METRICS
+// Time the rest of the enclosing scope as span `name` (a string literal)
+#define HARTONOMOUS_SPAN(name)                                                                              \
+    static ::Hartonomous::Metrics::Histogram& HARTONOMOUS_METRICS_CAT(hartonomous_span_h_, __LINE__) =      \
+        ::Hartonomous::Metrics::global().span(name);                                                        \
+    ::Hartonomous::Metrics::ScopeTimer HARTONOMOUS_METRICS_CAT(hartonomous_span_t_, __LINE__)(              \
+        HARTONOMOUS_METRICS_CAT(hartonomous_span_h_, __LINE__))
+// Add n to the unlabeled counter `name` (a string literal); n is not evaluated when disabled
+#define HARTONOMOUS_COUNT(name, n)                                                                          \
+    do {                                                                                                    \
+        static ::Hartonomous::Metrics::Counter& hartonomous_counter_ = ::Hartonomous::Metrics::global().counter(name); \
+        hartonomous_counter_.add(n);                                                                        \
+    } while (0)
+#else
+#define HARTONOMOUS_SPAN(name) static_assert(true)
+#define HARTONOMOUS_COUNT(name, n) ((void)0)
+#endif
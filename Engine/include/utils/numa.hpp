@@ -0,0 +1,205 @@
+#pragma once
+
+/**
+ * @file numa.hpp
+ * @brief Page placement for the large read-mostly structures on multi-socket hosts
+ *
+ * The atom lookup, the composition text store, the relation graph and the
+ * HNSW graphs are built or mapped by one thread and then read by every
+ * worker. Left to first touch, all of their pages land on the loading
+ * thread's node and every other socket reads them across the interconnect.
+ *
+ *   HARTONOMOUS_NUMA=local       leave placement to the kernel (default)
+ *   HARTONOMOUS_NUMA=interleave  spread pages round robin over the nodes this
+ *                                process may run on
+ *   HARTONOMOUS_NUMA=replicate   as interleave, and LiveRelationGraph also
+ *                                keeps one copy of each snapshot per node so
+ *                                walks and searches read node-local memory
+ *
+ * Anonymous memory (owned vectors, HNSW arrays) is interleaved with
+ * mbind(MPOL_INTERLEAVE, MPOL_MF_MOVE), which also migrates pages already
+ * touched. The kernel ignores memory policy for the page cache behind a file
+ * mapping, so mapped snapshots are instead faulted in by one thread per node,
+ * each taking every n-th 2 MiB stripe, before anything else reads them;
+ * pages an earlier process left in the cache stay where they are. All of it
+ * is advisory: on one node, off Linux, or when a call fails, memory stays
+ * where it is. Pair with HARTONOMOUS_PIN (utils/thread_config.hpp) so the
+ * workers reading a replica stay on its node.
+ */
+
+#include <utils/thread_config.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Hartonomous {
+
+enum class NumaPolicy : uint8_t { Local, Interleave, Replicate };
+
+namespace detail {
+
+// Stripe a mapping is faulted in by; large enough that readahead rarely crosses into the next node's
+inline constexpr size_t NUMA_STRIPE_BYTES = size_t(2) << 20;
+
+struct NumaState {
+    NumaPolicy policy = NumaPolicy::Local;
+    std::vector<NumaNode> nodes;
+    std::vector<int> node_of_cpu;   // CPU -> index into nodes, -1 when not allowed
+
+    NumaState() : nodes(numa_nodes()) {
+        if (const char* v = std::getenv("HARTONOMOUS_NUMA")) {
+            if (std::strcmp(v, "interleave") == 0) policy = NumaPolicy::Interleave;
+            else if (std::strcmp(v, "replicate") == 0) policy = NumaPolicy::Replicate;
+        }
+        for (size_t n = 0; n < nodes.size(); ++n)
+            for (int cpu : nodes[n].cpus) {
+                if (static_cast<size_t>(cpu) >= node_of_cpu.size()) node_of_cpu.resize(cpu + 1, -1);
+                node_of_cpu[cpu] = static_cast<int>(n);
+            }
+    }
+};
+
+inline NumaState& numa_state() {
+    static NumaState state;
+    return state;
+}
+
+// Move the calling thread onto the CPUs of node `node` (an index into numa_nodes())
+inline void bind_to_node(size_t node) {
+#if defined(__linux__)
+    const auto& nodes = numa_state().nodes;
+    if (node >= nodes.size()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : nodes[node].cpus) CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)node;
+#endif
+}
+
+} // namespace detail
+
+inline NumaPolicy numa_policy() { return detail::numa_state().policy; }
+
+inline size_t numa_node_count() { return std::max<size_t>(1, detail::numa_state().nodes.size()); }
+
+// Whether placement calls do anything: a policy other than local, on more than one node
+inline bool numa_spreading() {
+    return numa_policy() != NumaPolicy::Local && detail::numa_state().nodes.size() > 1;
+}
+
+/**
+ * @brief Index (below numa_node_count()) of the node the calling thread is running on
+ */
+inline size_t current_numa_node() {
+#if defined(__linux__)
+    const auto& map = detail::numa_state().node_of_cpu;
+    const int cpu = sched_getcpu();
+    if (cpu >= 0 && static_cast<size_t>(cpu) < map.size() && map[cpu] >= 0) return static_cast<size_t>(map[cpu]);
+#endif
+    return 0;
+}
+
+/**
+ * @brief Run `fn` on a thread bound to node `node` and return its result
+ *
+ * Memory `fn` allocates and fills lands on that node by first touch.
+ * Exceptions from `fn` are rethrown to the caller.
+ */
+template <typename F>
+auto run_on_node(size_t node, F&& fn) -> decltype(fn()) {
+    using R = decltype(fn());
+    std::exception_ptr error;
+    std::conditional_t<std::is_void_v<R>, bool, std::optional<R>> result{};
+    std::thread worker([&] {
+        detail::bind_to_node(node);
+        try {
+            if constexpr (std::is_void_v<R>) fn();
+            else result.emplace(fn());
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    worker.join();
+    if (error) std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<R>) return std::move(*result);
+}
+
+/**
+ * @brief Interleave the pages of anonymous memory [addr, addr + bytes) over the nodes
+ *
+ * Pages already touched are migrated; pages touched later follow the
+ * policy. The range is widened to whole pages. Returns false when nothing
+ * was done.
+ */
+inline bool numa_interleave(const void* addr, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (!numa_spreading() || !addr || bytes == 0) return false;
+    constexpr int MPOL_INTERLEAVE_MODE = 3;        // <numaif.h> MPOL_INTERLEAVE
+    constexpr unsigned MPOL_MF_MOVE_FLAG = 1u << 1; // <numaif.h> MPOL_MF_MOVE
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+
+    const auto& nodes = detail::numa_state().nodes;
+    int max_id = 0;
+    for (const auto& node : nodes) max_id = std::max(max_id, node.id);
+    std::vector<unsigned long> mask(static_cast<size_t>(max_id) / BITS + 1, 0);
+    for (const auto& node : nodes) mask[node.id / BITS] |= 1UL << (node.id % BITS);
+
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(page - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + bytes + page - 1) & ~(page - 1);
+    // The kernel reads maxnode - 1 bits, hence the + 1 libnuma passes as well
+    return syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE_MODE, mask.data(),
+                   mask.size() * BITS + 1, MPOL_MF_MOVE_FLAG) == 0;
+#else
+    (void)addr;
+    (void)bytes;
+    return false;
+#endif
+}
+
+/**
+ * @brief Fault in a file mapping so its page cache is striped over the nodes
+ *
+ * Call right after mmap, before validation reads the whole file from one
+ * thread. Only pages not yet cached are placed.
+ */
+inline void numa_first_touch(const void* addr, size_t bytes) {
+#if defined(__linux__)
+    if (!numa_spreading() || !addr || bytes == 0) return;
+    const size_t nodes = numa_node_count();
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<std::thread> workers;
+    workers.reserve(nodes);
+    for (size_t node = 0; node < nodes; ++node) {
+        workers.emplace_back([=] {
+            detail::bind_to_node(node);
+            const volatile uint8_t* p = static_cast<const volatile uint8_t*>(addr);
+            const size_t step = nodes * detail::NUMA_STRIPE_BYTES;
+            for (size_t stripe = node * detail::NUMA_STRIPE_BYTES; stripe < bytes; stripe += step) {
+                const size_t end = std::min(bytes, stripe + detail::NUMA_STRIPE_BYTES);
+                for (size_t off = stripe; off < end; off += page) (void)p[off];
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+#else
+    (void)addr;
+    (void)bytes;
+#endif
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file philox.hpp
+ * @brief Philox4x32-10, a counter-based generator: output is a pure function of (key, counter)
+ *
+ * There is no state to advance or share. Any draw can be recomputed from
+ * its coordinates alone, which lets a walk's randomness be carried as two
+ * integers, resumed on another process, and split into independent
+ * streams by key (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+ */
+
+#include <array>
+#include <cstdint>
+
+namespace Hartonomous {
+
+class Philox {
+public:
+    using Counter = std::array<uint32_t, 4>;
+
+    // Ten rounds over one 128-bit counter block
+    static Counter block(Counter ctr, uint64_t key) noexcept {
+        uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+        for (int r = 0; r < 10; ++r) {
+            const uint64_t p0 = uint64_t(M0) * ctr[0];
+            const uint64_t p1 = uint64_t(M1) * ctr[2];
+            ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k0, static_cast<uint32_t>(p1),
+                   static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k1, static_cast<uint32_t>(p0)};
+            k0 += W0;
+            k1 += W1;
+        }
+        return ctr;
+    }
+
+    // Uniform in (0, 1) from the first 64 bits of a block; 52 bits keep the top draw below 1
+    static double uniform(const Counter& out) noexcept {
+        const uint64_t bits = (uint64_t(out[0]) << 32) | out[1];
+        return (static_cast<double>(bits >> 12) + 0.5) * 0x1.0p-52;
+    }
+
+    // Key of stream `stream` under `seed`, unrelated to the keys of other streams
+    static uint64_t stream_key(uint64_t seed, uint64_t stream) noexcept {
+        const Counter out = block({static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), 0, 0}, seed);
+        return (uint64_t(out[0]) << 32) | out[1];
+    }
+
+private:
+    static constexpr uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+};
+
+} // namespace Hartonomous
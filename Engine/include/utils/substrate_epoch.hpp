@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @file substrate_epoch.hpp
+ * @brief Process-wide counter that moves whenever relation data may have changed
+ *
+ * Advanced wherever derived relation state is already invalidated:
+ * NeighborCache invalidation (ingest, OODALoop::act) and LiveRelationGraph
+ * publishing a new snapshot. Caches of whole answers stamp entries with the
+ * value current when their computation began and treat any other value as
+ * stale. Writes by other processes move it only through a live graph
+ * refresh; entry TTLs bound staleness otherwise.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+namespace Hartonomous {
+
+class SubstrateEpoch {
+public:
+    static uint64_t current() noexcept { return value().load(std::memory_order_acquire); }
+    static void advance() noexcept { value().fetch_add(1, std::memory_order_acq_rel); }
+
+private:
+    static std::atomic<uint64_t>& value() noexcept {
+        static std::atomic<uint64_t> epoch{0};
+        return epoch;
+    }
+};
+
+} // namespace Hartonomous
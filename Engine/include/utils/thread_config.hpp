@@ -0,0 +1,254 @@
+#pragma once
+
+/**
+ * @file thread_config.hpp
+ * @brief The one thread budget every parallel batch API in the engine shares
+ *
+ * Batch APIs (codepoint projection, BLAKE3 batches, S³ lattices, model
+ * mining, text ingest) all run on the OpenMP runtime rather than spawning
+ * their own threads, so they draw from the same pool. OpenMP keeps its
+ * thread count per calling thread, so each API that opens a parallel region
+ * calls apply_thread_config() first; it costs one thread_local test after
+ * the first call on a thread.
+ *
+ *   HARTONOMOUS_THREADS=N   width of a parallel region (default: the
+ *                           runtime's, i.e. OMP_NUM_THREADS or every core)
+ *   HARTONOMOUS_PIN=none|compact|spread
+ *                           pin pool threads to CPUs, ordered one NUMA node
+ *                           at a time (compact) or round robin across nodes
+ *                           (spread). Ignored when OMP_PROC_BIND or
+ *                           OMP_PLACES already bind the runtime.
+ *
+ * Nested parallel regions run on the thread that meets them (one active
+ * level), so a batch API called from inside another parallel loop does not
+ * multiply the thread count. Threads that split the budget themselves (the
+ * model ingester's job workers) call apply_thread_config() and then
+ * omp_set_num_threads() with their share.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+namespace Hartonomous {
+
+enum class PinPolicy : uint8_t { None, Compact, Spread };
+
+struct ThreadOptions {
+    size_t threads = 0;              // 0: leave the runtime's default
+    PinPolicy pin = PinPolicy::None;
+
+    /**
+     * @brief Defaults overridden by HARTONOMOUS_{THREADS,PIN}
+     */
+    static ThreadOptions from_env() {
+        ThreadOptions o;
+        if (const char* v = std::getenv("HARTONOMOUS_THREADS")) o.threads = std::strtoull(v, nullptr, 10);
+        if (const char* v = std::getenv("HARTONOMOUS_PIN")) {
+            if (std::strcmp(v, "compact") == 0) o.pin = PinPolicy::Compact;
+            else if (std::strcmp(v, "spread") == 0) o.pin = PinPolicy::Spread;
+        }
+        return o;
+    }
+};
+
+namespace detail {
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        const std::string item = list.substr(pos, end - pos);
+        const size_t dash = item.find('-');
+        if (!item.empty() && item[0] >= '0' && item[0] <= '9') {
+            const int lo = std::atoi(item.c_str());
+            const int hi = dash == std::string::npos ? lo : std::atoi(item.c_str() + dash + 1);
+            for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+struct NumaNode {
+    int id;                  // Kernel node number, as mbind() takes it
+    std::vector<int> cpus;   // Allowed CPUs on the node
+};
+
+// NUMA nodes with CPUs this process may run on (one node 0 with every allowed CPU when unknown)
+inline std::vector<NumaNode> numa_nodes() {
+    std::vector<NumaNode> nodes;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return nodes;
+
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        std::vector<int> ids;
+        while (dirent* e = readdir(dir))
+            if (std::strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' && e->d_name[4] <= '9')
+                ids.push_back(std::atoi(e->d_name + 4));
+        closedir(dir);
+        std::sort(ids.begin(), ids.end());
+        for (int id : ids) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string list;
+            std::getline(in, list);
+            std::vector<int> cpus;
+            for (int c : parse_cpu_list(list))
+                if (c >= 0 && c < CPU_SETSIZE && CPU_ISSET(c, &allowed)) cpus.push_back(c);
+            if (!cpus.empty()) nodes.push_back({id, std::move(cpus)});
+        }
+    }
+    if (nodes.empty()) {
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        if (!cpus.empty()) nodes.push_back({0, std::move(cpus)});
+    }
+#endif
+    return nodes;
+}
+
+// CPUs this process may run on, grouped by NUMA node (one group when unknown)
+inline std::vector<std::vector<int>> numa_cpu_groups() {
+    std::vector<std::vector<int>> groups;
+    for (auto& node : numa_nodes()) groups.push_back(std::move(node.cpus));
+    return groups;
+}
+
+// Every allowed CPU once, in the order pool threads are pinned to them
+inline std::vector<int> pin_order(const std::vector<std::vector<int>>& nodes, PinPolicy policy) {
+    std::vector<int> order;
+    if (policy == PinPolicy::Compact) {
+        for (const auto& node : nodes) order.insert(order.end(), node.begin(), node.end());
+    } else if (policy == PinPolicy::Spread) {
+        for (size_t k = 0;; ++k) {
+            bool any = false;
+            for (const auto& node : nodes)
+                if (k < node.size()) { order.push_back(node[k]); any = true; }
+            if (!any) break;
+        }
+    }
+    return order;
+}
+
+struct ThreadConfigState {
+    ThreadOptions opts;
+    std::vector<int> cpus;          // Empty when not pinning
+    std::atomic<size_t> next_cpu{0};
+
+    ThreadConfigState() : opts(ThreadOptions::from_env()) {
+        const bool runtime_binds = std::getenv("OMP_PROC_BIND") || std::getenv("OMP_PLACES");
+        if (opts.pin != PinPolicy::None && !runtime_binds) cpus = pin_order(numa_cpu_groups(), opts.pin);
+    }
+};
+
+inline ThreadConfigState& thread_config_state() {
+    static ThreadConfigState state;
+    return state;
+}
+
+// Pin the calling thread to the next CPU in pin order, once
+inline void pin_current_thread() {
+#if defined(__linux__)
+    thread_local bool pinned = false;
+    auto& state = thread_config_state();
+    if (pinned || state.cpus.empty()) return;
+    pinned = true;
+    const int cpu = state.cpus[state.next_cpu.fetch_add(1, std::memory_order_relaxed) % state.cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @brief Width of a parallel region opened by a thread that applied the config
+ */
+inline size_t worker_threads() {
+    const size_t configured = detail::thread_config_state().opts.threads;
+    if (configured) return configured;
+#if defined(_OPENMP)
+    return static_cast<size_t>(std::max(1, omp_get_max_threads()));
+#else
+    return std::max(1u, std::thread::hardware_concurrency());
+#endif
+}
+
+/**
+ * @brief Bring the calling thread's OpenMP settings in line with the engine's, once per thread
+ */
+inline void apply_thread_config() {
+    thread_local bool applied = false;
+    if (applied) return;
+    applied = true;
+
+    const ThreadOptions& opts = detail::thread_config_state().opts;
+#if defined(_OPENMP)
+    if (opts.threads) omp_set_num_threads(static_cast<int>(opts.threads));
+    omp_set_max_active_levels(1);
+    if (opts.pin != PinPolicy::None && omp_get_level() == 0) {
+        // libgomp keeps one pool per calling thread, so its members stay pinned
+        #pragma omp parallel
+        detail::pin_current_thread();
+    }
+#else
+    (void)opts;
+#endif
+}
+
+/**
+ * @brief f(0..n-1), on OpenMP threads when `concurrent`; the first exception is rethrown
+ *
+ * Tasks are handed out one at a time, for work that differs wildly in cost
+ * (searches, per-prompt scoring). threads 0: worker_threads().
+ */
+template <typename F>
+void for_each_task(size_t n, bool concurrent, size_t threads, F&& f) {
+    if (!concurrent || n < 2) {
+        for (size_t i = 0; i < n; ++i) f(i);
+        return;
+    }
+    if (threads == 0) threads = worker_threads();
+    apply_thread_config();
+    std::exception_ptr error;
+    std::mutex error_mu;
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(static_cast<int>(std::min(threads, n)))
+    for (size_t i = 0; i < n; ++i) {
+        try {
+            f(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mu);
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace Hartonomous
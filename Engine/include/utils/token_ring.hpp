@@ -0,0 +1,255 @@
+#pragma once
+
+/**
+ * @file token_ring.hpp
+ * @brief Single-producer/single-consumer ring of UTF-8 fragments for streaming calls
+ *
+ * A streaming call with a callback crosses back into its caller once per
+ * fragment; from .NET that is a reverse P/Invoke and a string marshal per
+ * word. A TokenRing lets the walk or reasoning thread append fragments as
+ * frames (a TokenFrame header, the bytes, zero padding to 8) while the
+ * consumer copies out every whole frame at once with drain() and parses
+ * them in place.
+ *
+ * The producer blocks while the ring is full, so a slow consumer throttles
+ * its stream instead of growing memory; cancel() from the consumer ends the
+ * stream at the producer's next push. The consumer waits with wait(), or on
+ * Linux polls event_fd(), an eventfd made readable when a frame lands in an
+ * empty ring and when the stream ends. Either way it drains until drain()
+ * returns 0 before waiting again.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace Hartonomous {
+
+// Header of each frame; `length` bytes of UTF-8 follow, padded to a multiple of 8
+struct TokenFrame {
+    uint32_t length;
+    uint32_t step;
+    double energy_remaining;
+};
+static_assert(sizeof(TokenFrame) == 16);
+
+class TokenRing {
+public:
+    static constexpr size_t MIN_CAPACITY = 4096;
+
+    // Capacity in bytes, rounded up to a power of two of at least MIN_CAPACITY
+    explicit TokenRing(size_t capacity) {
+        size_t cap = MIN_CAPACITY;
+        while (cap < capacity) cap <<= 1;
+        buffer_ = std::make_unique<uint8_t[]>(cap);
+        mask_ = cap - 1;
+#if defined(__linux__)
+        event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+
+    ~TokenRing() {
+#if defined(__linux__)
+        if (event_fd_ >= 0) ::close(event_fd_);
+#endif
+    }
+
+    TokenRing(const TokenRing&) = delete;
+    TokenRing& operator=(const TokenRing&) = delete;
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+    // Longest fragment one frame holds
+    size_t max_fragment() const noexcept { return capacity() - sizeof(TokenFrame); }
+
+    // -------------------------------------------------------------------------
+    //  Producer
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Append one fragment, waiting while the ring is full
+     * @return false once the consumer cancelled; the fragment is dropped
+     */
+    bool push(std::string_view fragment, uint32_t step, double energy_remaining) {
+        if (fragment.size() > max_fragment())
+            throw std::length_error("Fragment of " + std::to_string(fragment.size()) +
+                                    " bytes exceeds the token ring's " + std::to_string(max_fragment()));
+        const size_t need = frame_bytes(fragment.size());
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+
+        if (capacity() - (head - tail_.load(std::memory_order_acquire)) < need) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            producer_waiting_.store(true);
+            space_.wait(lock, [&] {
+                return cancelled() || capacity() - (head - tail_.load()) >= need;
+            });
+            producer_waiting_.store(false);
+        }
+        if (cancelled()) return false;
+
+        const TokenFrame frame{static_cast<uint32_t>(fragment.size()), step, energy_remaining};
+        write(head, &frame, sizeof(frame));
+        write(head + sizeof(frame), fragment.data(), fragment.size());
+        const size_t pad = need - sizeof(frame) - fragment.size();
+        if (pad) {
+            static constexpr uint8_t ZEROS[8]{};
+            write(head + sizeof(frame) + fragment.size(), ZEROS, pad);
+        }
+        head_.store(head + need);
+
+        // A frame landing in an empty ring is the one the consumer may be asleep for
+        if (tail_.load() == head) signal();
+        return true;
+    }
+
+    // End of stream: the consumer finishes once it has drained what is left
+    void close() {
+        closed_.store(true);
+        signal();
+    }
+
+    // -------------------------------------------------------------------------
+    //  Consumer
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Copy every whole frame that fits into `out` and release their space
+     * @return Bytes copied, a multiple of 8; 0 when the ring is empty
+     *
+     * A buffer of capacity() bytes always takes at least one frame.
+     */
+    size_t drain(void* out, size_t out_capacity) {
+#if defined(__linux__)
+        if (event_fd_ >= 0) {
+            uint64_t count;
+            [[maybe_unused]] auto r = ::read(event_fd_, &count, sizeof(count));
+        }
+#endif
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const uint64_t head = head_.load(std::memory_order_acquire);
+
+        // Whole frames only: walk the headers up to what fits
+        uint64_t end = tail;
+        while (end < head) {
+            TokenFrame frame;
+            read(end, &frame, sizeof(frame));
+            const size_t bytes = frame_bytes(frame.length);
+            if (end - tail + bytes > out_capacity) break;
+            end += bytes;
+        }
+        if (end == tail) return 0;
+
+        read(tail, out, end - tail);
+        tail_.store(end);
+        if (producer_waiting_.load()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            space_.notify_one();
+        }
+        return end - tail;
+    }
+
+    /**
+     * @brief Wait until a frame is ready or the stream ended, up to timeout_ms (< 0: no limit)
+     * @return true when there is something to drain or the stream ended
+     */
+    bool wait(int timeout_ms) {
+        auto ready = [&] { return head_.load() != tail_.load() || closed_.load() || cancelled(); };
+        if (ready()) return true;
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumer_waiting_.store(true);
+        bool ok;
+        if (timeout_ms < 0) {
+            data_.wait(lock, ready);
+            ok = true;
+        } else {
+            ok = data_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+        }
+        consumer_waiting_.store(false);
+        return ok;
+    }
+
+    // Closed by the producer (or cancelled) and nothing left to drain
+    bool finished() const noexcept {
+        return cancelled() || (closed_.load() && head_.load() == tail_.load());
+    }
+
+    // Stop the producer at its next push; what it already wrote is discarded
+    void cancel() {
+        cancelled_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            space_.notify_all();
+        }
+        signal();
+    }
+
+    bool cancelled() const noexcept { return cancelled_.load(std::memory_order_acquire); }
+
+    // eventfd readable when drain() has frames or the stream ended; -1 off Linux
+    int event_fd() const noexcept { return event_fd_; }
+
+private:
+    static constexpr size_t frame_bytes(size_t length) noexcept {
+        return sizeof(TokenFrame) + ((length + 7) & ~size_t(7));
+    }
+
+    void write(uint64_t at, const void* src, size_t n) noexcept {
+        const size_t offset = at & mask_;
+        const size_t first = std::min(n, capacity() - offset);
+        std::memcpy(buffer_.get() + offset, src, first);
+        std::memcpy(buffer_.get(), static_cast<const uint8_t*>(src) + first, n - first);
+    }
+
+    void read(uint64_t at, void* dst, size_t n) const noexcept {
+        const size_t offset = at & mask_;
+        const size_t first = std::min(n, capacity() - offset);
+        std::memcpy(dst, buffer_.get() + offset, first);
+        std::memcpy(static_cast<uint8_t*>(dst) + first, buffer_.get(), n - first);
+    }
+
+    // Wake a consumer sleeping in wait() or on the eventfd
+    void signal() {
+        if (consumer_waiting_.load()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            data_.notify_one();
+        }
+#if defined(__linux__)
+        if (event_fd_ >= 0) {
+            const uint64_t one = 1;
+            [[maybe_unused]] auto r = ::write(event_fd_, &one, sizeof(one));
+        }
+#endif
+    }
+
+    std::unique_ptr<uint8_t[]> buffer_;
+    size_t mask_ = 0;
+    int event_fd_ = -1;
+
+    // Bytes ever written and ever drained; each written by one side only
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+
+    alignas(64) std::atomic<bool> closed_{false};
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> producer_waiting_{false};
+    std::atomic<bool> consumer_waiting_{false};
+    std::mutex mutex_;
+    std::condition_variable space_;   // Producer waits for the consumer to drain
+    std::condition_variable data_;    // Consumer waits for a frame or the end
+};
+
+} // namespace Hartonomous
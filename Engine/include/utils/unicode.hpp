@@ -1,65 +1,216 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace Hartonomous {
 
 /**
- * @brief Thread-safe UTF-8 to UTF-32 conversion.
- * 
- * Optimized for high-throughput ingestion.
+ * @brief True if s is well-formed UTF-8 (no overlongs, surrogates or code points past U+10FFFF).
+ *
+ * ASCII runs are skipped a vector at a time.
  */
-inline std::u32string utf8_to_utf32(const std::string& s) {
-    std::u32string out;
-    out.reserve(s.size());
-    for (size_t i = 0; i < s.size(); ) {
-        uint8_t c = static_cast<uint8_t>(s[i]);
-        char32_t cp = 0;
-        size_t len = 0;
-        
-        if (c < 0x80) { cp = c; len = 1; }
-        else if ((c >> 5) == 0x6) { cp = c & 0x1F; len = 2; }
+inline bool utf8_validate(std::string_view s) {
+    const auto* p = reinterpret_cast<const uint8_t*>(s.data());
+    const auto* end = p + s.size();
+    while (p < end) {
+#if defined(__AVX2__)
+        while (end - p >= 32 && !_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)))) p += 32;
+#elif defined(__SSE2__)
+        while (end - p >= 16 && !_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))) p += 16;
+#endif
+        if (p == end) break;
+        uint8_t c = *p;
+        if (c < 0x80) { ++p; continue; }
+        size_t len;
+        char32_t cp, min;
+        if ((c >> 5) == 0x6) { len = 2; cp = c & 0x1F; min = 0x80; }
+        else if ((c >> 4) == 0xE) { len = 3; cp = c & 0x0F; min = 0x800; }
+        else if ((c >> 3) == 0x1E) { len = 4; cp = c & 0x07; min = 0x10000; }
+        else return false;
+        if (static_cast<size_t>(end - p) < len) return false;
+        for (size_t j = 1; j < len; ++j) {
+            if ((p[j] >> 6) != 0x2) return false;
+            cp = (cp << 6) | (p[j] & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+        p += len;
+    }
+    return true;
+}
+
+/**
+ * @brief UTF-8 to UTF-32 into a caller buffer of at least s.size() code points.
+ *
+ * ASCII runs are widened a vector at a time. Malformed input is decoded
+ * leniently: an invalid start byte is dropped, a sequence cut short by an
+ * unexpected byte yields its start byte's bits alone.
+ *
+ * @return Number of code points written
+ */
+inline size_t utf8_to_utf32(std::string_view s, char32_t* out) {
+    const auto* p = reinterpret_cast<const uint8_t*>(s.data());
+    const auto* end = p + s.size();
+    char32_t* o = out;
+    while (p < end) {
+#if defined(__AVX2__)
+        // Widens whole blocks but keeps only their ASCII prefix. The stores
+        // stay in bounds: out has room for a code point per input byte.
+        while (end - p >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+            for (int k = 0; k < 4; ++k) {
+                __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 8 * k));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 8 * k), _mm256_cvtepu8_epi32(b));
+            }
+            const int ascii = mask ? __builtin_ctz(mask) : 32;
+            p += ascii;
+            o += ascii;
+            if (mask) break;
+        }
+#elif defined(__SSE2__)
+        while (end - p >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(v));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 12), _mm_unpackhi_epi16(hi, zero));
+            const int ascii = mask ? __builtin_ctz(mask) : 16;
+            p += ascii;
+            o += ascii;
+            if (mask) break;
+        }
+#endif
+        if (p == end) break;
+        uint8_t c = *p;
+        if (c < 0x80) { *o++ = c; ++p; continue; }
+
+        char32_t cp;
+        size_t len;
+        if ((c >> 5) == 0x6) { cp = c & 0x1F; len = 2; }
         else if ((c >> 4) == 0xE) { cp = c & 0x0F; len = 3; }
         else if ((c >> 3) == 0x1E) { cp = c & 0x07; len = 4; }
-        else { ++i; continue; } // Invalid start byte
-        
-        for (size_t j = 1; j < len && i + j < s.size(); ++j) {
-            uint8_t cc = static_cast<uint8_t>(s[i + j]);
-            if ((cc >> 6) != 0x2) { len = 1; break; } // Unexpected byte
-            cp = (cp << 6) | (cc & 0x3F);
+        else { ++p; continue; } // Invalid start byte
+
+        const size_t avail = static_cast<size_t>(end - p);
+        for (size_t j = 1; j < len && j < avail; ++j) {
+            if ((p[j] >> 6) != 0x2) { len = 1; break; } // Unexpected byte
+            cp = (cp << 6) | (p[j] & 0x3F);
         }
-        
-        out.push_back(cp);
-        i += len;
+        *o++ = cp;
+        p += len < avail ? len : avail;
     }
+    return static_cast<size_t>(o - out);
+}
+
+/**
+ * @brief UTF-8 to UTF-32 conversion into a reusable buffer (keeps its capacity).
+ */
+inline void utf8_to_utf32(std::string_view s, std::u32string& out) {
+    out.resize(s.size());
+    out.resize(utf8_to_utf32(s, out.data()));
+}
+
+/**
+ * @brief Thread-safe UTF-8 to UTF-32 conversion.
+ *
+ * Optimized for high-throughput ingestion.
+ */
+inline std::u32string utf8_to_utf32(const std::string& s) {
+    std::u32string out;
+    utf8_to_utf32(s, out);
     return out;
 }
 
 /**
- * @brief Thread-safe UTF-32 to UTF-8 conversion.
+ * @brief Bytes the UTF-8 encoding of s takes.
  */
-inline std::string utf32_to_utf8(const std::u32string& s) {
-    std::string out;
-    out.reserve(s.size() * 3 / 2);
-    for (char32_t cp : s) {
+inline size_t utf8_length(std::u32string_view s) {
+    size_t bytes = s.size();
+    for (char32_t cp : s) bytes += (cp >= 0x80) + (cp >= 0x800) + (cp >= 0x10000);
+    return bytes;
+}
+
+/**
+ * @brief UTF-32 to UTF-8 into a caller buffer of at least utf8_length(s) bytes.
+ *
+ * ASCII runs are narrowed a vector at a time.
+ *
+ * @return Number of bytes written
+ */
+inline size_t utf32_to_utf8(std::u32string_view s, char* out) {
+    const char32_t* p = s.data();
+    const char32_t* end = p + s.size();
+    char* o = out;
+    while (p < end) {
+#if defined(__AVX2__)
+        // As in utf8_to_utf32, whole blocks are stored and their ASCII prefix kept;
+        // the output has at least a byte per remaining code point
+        const __m256i high = _mm256_set1_epi32(~0x7F);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        while (end - p >= 16) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8));
+            auto ascii_lanes = [&](__m256i v) {
+                return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(
+                    _mm256_cmpeq_epi32(_mm256_and_si256(v, high), zero))));
+            };
+            const uint32_t mask = ~(ascii_lanes(a) | (ascii_lanes(b) << 8)) & 0xFFFF;
+            // Pack within lanes, then gather each lane's four-byte groups back into order
+            __m256i w = _mm256_packus_epi32(a, b);
+            __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(w, w), order);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm256_castsi256_si128(bytes));
+            const int ascii = mask ? __builtin_ctz(mask) : 16;
+            p += ascii;
+            o += ascii;
+            if (mask) break;
+        }
+        if (p == end) break;
+#endif
+        char32_t cp = *p++;
         if (cp < 0x80) {
-            out.push_back(static_cast<char>(cp));
+            *o++ = static_cast<char>(cp);
         } else if (cp < 0x800) {
-            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
-            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            *o++ = static_cast<char>(0xC0 | (cp >> 6));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
         } else if (cp < 0x10000) {
-            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
-            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            *o++ = static_cast<char>(0xE0 | (cp >> 12));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
         } else {
-            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
-            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
-            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            *o++ = static_cast<char>(0xF0 | (cp >> 18));
+            *o++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
         }
     }
+    return static_cast<size_t>(o - out);
+}
+
+/**
+ * @brief UTF-32 to UTF-8 conversion into a reusable buffer (keeps its capacity).
+ */
+inline void utf32_to_utf8(std::u32string_view s, std::string& out) {
+    out.resize(utf8_length(s));
+    utf32_to_utf8(s, out.data());
+}
+
+/**
+ * @brief Thread-safe UTF-32 to UTF-8 conversion.
+ */
+inline std::string utf32_to_utf8(const std::u32string& s) {
+    std::string out;
+    utf32_to_utf8(s, out);
     return out;
 }
 
@@ -0,0 +1,256 @@
+/**
+ * @file knn_cuda.cu
+ * @brief Brute-force device KNN: cuBLAS SGEMM score tiles with a fused top-k
+ *
+ * Keys stay resident on the device. Queries go up QUERY_BLOCK rows at a
+ * time; each block is scored against KEY_TILE keys per SGEMM, and one
+ * thread block per query row folds the tile into that row's running top-k
+ * in shared memory before the next tile overwrites the scores. Only scores
+ * above both the threshold and the row's current k-th best are candidates,
+ * so after the first tiles most rows have none and skip the sort. The n x n
+ * score matrix never exists, on the device or on the host.
+ *
+ * Implements knn_device_abi.h; loaded at runtime by DeviceKnn.
+ */
+
+#include "ingestion/knn_device_abi.h"
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+constexpr size_t QUERY_BLOCK = 1024;
+constexpr size_t KEY_TILE = 2048;
+constexpr int MERGE_SLOTS = 4096;     // MAX_K running best plus one tile of candidates
+constexpr int MERGE_THREADS = 1024;
+constexpr size_t MAX_K = MERGE_SLOTS - KEY_TILE;
+
+void set_error(char* err, size_t len, const std::string& msg) {
+    if (err && len) std::snprintf(err, len, "%s", msg.c_str());
+}
+
+bool cuda_ok(cudaError_t e, const char* what, char* err, size_t len) {
+    if (e == cudaSuccess) return true;
+    set_error(err, len, std::string(what) + ": " + cudaGetErrorString(e));
+    return false;
+}
+
+bool blas_ok(cublasStatus_t s, const char* what, char* err, size_t len) {
+    if (s == CUBLAS_STATUS_SUCCESS) return true;
+    set_error(err, len, std::string(what) + ": cuBLAS status " + std::to_string(static_cast<int>(s)));
+    return false;
+}
+
+__global__ void init_best(float* sim, uint32_t* idx, size_t n) {
+    for (size_t i = blockIdx.x * size_t(blockDim.x) + threadIdx.x; i < n; i += size_t(gridDim.x) * blockDim.x) {
+        sim[i] = -FLT_MAX;
+        idx[i] = HARTONOMOUS_KNN_NO_INDEX;
+    }
+}
+
+// Row blockIdx.x of `scores` (KEY_TILE apart, tile_cols valid) into that
+// row's best list of k, kept sorted best first
+__global__ void merge_tile(const float* scores, int tile_cols, size_t key_first, size_t query_first,
+                           int exclude_self, int k, float threshold, float* best_sim, uint32_t* best_idx) {
+    __shared__ float s_sim[MERGE_SLOTS];
+    __shared__ uint32_t s_idx[MERGE_SLOTS];
+    __shared__ int s_count;
+
+    float* bs = best_sim + size_t(blockIdx.x) * k;
+    uint32_t* bi = best_idx + size_t(blockIdx.x) * k;
+    const float kth = bs[k - 1];
+    const size_t self = exclude_self ? query_first + blockIdx.x : SIZE_MAX;
+
+    if (threadIdx.x == 0) s_count = 0;
+    for (int t = threadIdx.x; t < k; t += blockDim.x) {
+        s_sim[t] = bs[t];
+        s_idx[t] = bi[t];
+    }
+    __syncthreads();
+
+    const float* row = scores + size_t(blockIdx.x) * KEY_TILE;
+    for (int c = threadIdx.x; c < tile_cols; c += blockDim.x) {
+        const float s = row[c];
+        if (s >= threshold && s > kth && key_first + c != self) {
+            const int slot = k + atomicAdd(&s_count, 1);
+            s_sim[slot] = s;
+            s_idx[slot] = static_cast<uint32_t>(key_first + c);
+        }
+    }
+    __syncthreads();
+    const int added = s_count;
+    if (added == 0) return;
+
+    const int used = k + added;
+    int n = 1;
+    while (n < used) n <<= 1;
+    for (int t = used + threadIdx.x; t < n; t += blockDim.x) {
+        s_sim[t] = -FLT_MAX;
+        s_idx[t] = HARTONOMOUS_KNN_NO_INDEX;
+    }
+    __syncthreads();
+
+    // Bitonic sort, descending
+    for (int size = 2; size <= n; size <<= 1) {
+        for (int stride = size >> 1; stride > 0; stride >>= 1) {
+            for (int t = threadIdx.x; t < n; t += blockDim.x) {
+                const int partner = t ^ stride;
+                if (partner <= t) continue;
+                const bool descending = (t & size) == 0;
+                if ((s_sim[t] < s_sim[partner]) == descending) {
+                    const float fs = s_sim[t];
+                    s_sim[t] = s_sim[partner];
+                    s_sim[partner] = fs;
+                    const uint32_t fi = s_idx[t];
+                    s_idx[t] = s_idx[partner];
+                    s_idx[partner] = fi;
+                }
+            }
+            __syncthreads();
+        }
+    }
+
+    for (int t = threadIdx.x; t < k; t += blockDim.x) {
+        bs[t] = s_sim[t];
+        bi[t] = s_idx[t];
+    }
+}
+
+} // namespace
+
+struct hartonomous_knn_index {
+    size_t rows = 0, dim = 0;
+    float* keys = nullptr;
+    float* queries = nullptr;     // QUERY_BLOCK x dim
+    float* scores = nullptr;      // QUERY_BLOCK x KEY_TILE
+    float* best_sim = nullptr;    // QUERY_BLOCK x MAX_K
+    uint32_t* best_idx = nullptr;
+    cublasHandle_t blas = nullptr;
+    cudaStream_t stream = nullptr;
+};
+
+extern "C" {
+
+int hartonomous_knn_abi_version(void) { return HARTONOMOUS_KNN_ABI_VERSION; }
+
+int hartonomous_knn_device_count(void) {
+    int n = 0;
+    if (cudaGetDeviceCount(&n) != cudaSuccess) return 0;
+    return n;
+}
+
+int hartonomous_knn_device_name(char* out, size_t len) {
+    int device = 0;
+    cudaDeviceProp prop;
+    if (cudaGetDevice(&device) != cudaSuccess || cudaGetDeviceProperties(&prop, device) != cudaSuccess) return -1;
+    std::snprintf(out, len, "%s (%zu MB)", prop.name, static_cast<size_t>(prop.totalGlobalMem >> 20));
+    return 0;
+}
+
+size_t hartonomous_knn_max_k(void) { return MAX_K; }
+
+void hartonomous_knn_destroy(hartonomous_knn_index* index) {
+    if (!index) return;
+    cudaFree(index->keys);
+    cudaFree(index->queries);
+    cudaFree(index->scores);
+    cudaFree(index->best_sim);
+    cudaFree(index->best_idx);
+    if (index->blas) cublasDestroy(index->blas);
+    if (index->stream) cudaStreamDestroy(index->stream);
+    delete index;
+}
+
+hartonomous_knn_index* hartonomous_knn_create(size_t rows, size_t dim, char* err, size_t err_len) {
+    auto* index = new hartonomous_knn_index;
+    index->rows = rows;
+    index->dim = dim;
+    const bool ok =
+        cuda_ok(cudaStreamCreate(&index->stream), "cudaStreamCreate", err, err_len) &&
+        blas_ok(cublasCreate(&index->blas), "cublasCreate", err, err_len) &&
+        blas_ok(cublasSetStream(index->blas, index->stream), "cublasSetStream", err, err_len) &&
+        cuda_ok(cudaMalloc(&index->keys, rows * dim * sizeof(float)), "cudaMalloc(keys)", err, err_len) &&
+        cuda_ok(cudaMalloc(&index->queries, QUERY_BLOCK * dim * sizeof(float)), "cudaMalloc(queries)", err, err_len) &&
+        cuda_ok(cudaMalloc(&index->scores, QUERY_BLOCK * KEY_TILE * sizeof(float)), "cudaMalloc(scores)", err, err_len) &&
+        cuda_ok(cudaMalloc(&index->best_sim, QUERY_BLOCK * MAX_K * sizeof(float)), "cudaMalloc(best)", err, err_len) &&
+        cuda_ok(cudaMalloc(&index->best_idx, QUERY_BLOCK * MAX_K * sizeof(uint32_t)), "cudaMalloc(best)", err, err_len);
+    if (!ok) {
+        hartonomous_knn_destroy(index);
+        return nullptr;
+    }
+    return index;
+}
+
+int hartonomous_knn_set_keys(hartonomous_knn_index* index, const float* keys, size_t first, size_t count,
+                             char* err, size_t err_len) {
+    if (first + count > index->rows) {
+        set_error(err, err_len, "key rows out of range");
+        return -1;
+    }
+    const size_t row_bytes = index->dim * sizeof(float);
+    if (!cuda_ok(cudaMemcpyAsync(index->keys + first * index->dim, keys, count * row_bytes,
+                                 cudaMemcpyHostToDevice, index->stream), "cudaMemcpy(keys)", err, err_len) ||
+        !cuda_ok(cudaStreamSynchronize(index->stream), "cudaStreamSynchronize", err, err_len)) {
+        return -1;
+    }
+    return 0;
+}
+
+int hartonomous_knn_search(const hartonomous_knn_index* index, const float* queries, size_t count, size_t first,
+                           int exclude_self, size_t k, float threshold,
+                           uint32_t* neighbor, float* similarity, uint32_t* found,
+                           char* err, size_t err_len) {
+    if (k == 0 || k > MAX_K) {
+        set_error(err, err_len, "k must be in [1, " + std::to_string(MAX_K) + "]");
+        return -1;
+    }
+    const size_t dim = index->dim;
+    const float alpha = 1.0f, beta = 0.0f;
+
+    for (size_t q0 = 0; q0 < count; q0 += QUERY_BLOCK) {
+        const size_t qn = std::min(QUERY_BLOCK, count - q0);
+        if (!cuda_ok(cudaMemcpyAsync(index->queries, queries + q0 * dim, qn * dim * sizeof(float),
+                                     cudaMemcpyHostToDevice, index->stream), "cudaMemcpy(queries)", err, err_len)) {
+            return -1;
+        }
+        init_best<<<256, 256, 0, index->stream>>>(index->best_sim, index->best_idx, qn * k);
+
+        for (size_t k0 = 0; k0 < index->rows; k0 += KEY_TILE) {
+            const size_t kn = std::min(KEY_TILE, index->rows - k0);
+            // Row-major Q (qn x dim) and K tile (kn x dim) are column-major
+            // dim x qn and dim x kn; scores = Kᵀ Q is column-major kn x qn,
+            // that is row-major qn x kn with rows KEY_TILE apart
+            if (!blas_ok(cublasSgemm(index->blas, CUBLAS_OP_T, CUBLAS_OP_N,
+                                     static_cast<int>(kn), static_cast<int>(qn), static_cast<int>(dim), &alpha,
+                                     index->keys + k0 * dim, static_cast<int>(dim),
+                                     index->queries, static_cast<int>(dim), &beta,
+                                     index->scores, static_cast<int>(KEY_TILE)), "cublasSgemm", err, err_len)) {
+                return -1;
+            }
+            merge_tile<<<static_cast<unsigned>(qn), MERGE_THREADS, 0, index->stream>>>(
+                index->scores, static_cast<int>(kn), k0, first + q0, exclude_self, static_cast<int>(k), threshold,
+                index->best_sim, index->best_idx);
+        }
+        if (!cuda_ok(cudaGetLastError(), "merge_tile", err, err_len) ||
+            !cuda_ok(cudaMemcpyAsync(similarity + q0 * k, index->best_sim, qn * k * sizeof(float),
+                                     cudaMemcpyDeviceToHost, index->stream), "cudaMemcpy(similarity)", err, err_len) ||
+            !cuda_ok(cudaMemcpyAsync(neighbor + q0 * k, index->best_idx, qn * k * sizeof(uint32_t),
+                                     cudaMemcpyDeviceToHost, index->stream), "cudaMemcpy(neighbor)", err, err_len) ||
+            !cuda_ok(cudaStreamSynchronize(index->stream), "cudaStreamSynchronize", err, err_len)) {
+            return -1;
+        }
+        for (size_t r = 0; r < qn; ++r) {
+            uint32_t n = 0;
+            while (n < k && neighbor[(q0 + r) * k + n] != HARTONOMOUS_KNN_NO_INDEX) ++n;
+            found[q0 + r] = n;
+        }
+    }
+    return 0;
+}
+
+} // extern "C"
@@ -9,108 +9,172 @@
  */
 
 #include <cognitive/astar_search.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <cognitive/search_arena.hpp>
+#include <hashing/composition_interner.hpp>
+#include <utils/memory_governor.hpp>
+#include <utils/thread_config.hpp>
+#include <atomic>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <algorithm>
-#include <unordered_set>
 #include <iostream>
+#include <thread>
 
 namespace Hartonomous {
 
+static AStarPath not_found() {
+    AStarPath result;
+    result.found = false;
+    result.total_cost = 0;
+    result.avg_elo = 0;
+    result.avg_observations = 0;
+    result.nodes_expanded = 0;
+    return result;
+}
+
 AStarSearch::AStarSearch(PostgresConnection& db) : db_(db) {}
 
+AStarSearch::AStarSearch(ConnectionPool& pool) : lease_(pool.acquire()), db_(*lease_) {}
+
 void AStarSearch::preload_cache() {
-    if (cache_loaded_) return;
+    if (cache_loaded_.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(cache_mu_);
+    if (cache_loaded_.load(std::memory_order_relaxed)) return;
 
-    // Preload composition text
-    db_.query(
-        "SELECT v.composition_id, v.reconstructed_text "
-        "FROM hartonomous.v_composition_text v",
-        {},
-        [&](const std::vector<std::string>& row) {
-            auto hash = BLAKE3Pipeline::from_hex(row[0]);
-            text_cache_[hash] = row[1];
-        }
-    );
+    // Composition text and S³ positions: process-wide, so a new engine costs no reload
+    if (!texts_) texts_ = CompositionTextStore::shared(db_);
+    positions_ = shared_positions(db_);
+
+    cache_loaded_.store(true, std::memory_order_release);
+}
+
+std::shared_ptr<const AStarSearch::PositionTable> AStarSearch::shared_positions(PostgresConnection& db) {
+    static std::mutex mutex;
+    static std::shared_ptr<const PositionTable> instance;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (instance) return instance;
 
-    // Preload S³ positions
-    db_.query(
+    auto table = std::make_shared<PositionTable>();
+    auto& interner = CompositionInterner::global();
+    db.query(
         "SELECT c.id, ST_X(p.centroid), ST_Y(p.centroid), ST_Z(p.centroid), ST_M(p.centroid) "
         "FROM hartonomous.composition c "
         "JOIN hartonomous.physicality p ON p.id = c.physicalityid",
         {},
         [&](const std::vector<std::string>& row) {
-            auto hash = BLAKE3Pipeline::from_hex(row[0]);
-            position_cache_[hash] = Eigen::Vector4d(
+            uint32_t node = interner.intern(BLAKE3Pipeline::from_hex(row[0]));
+            if (node >= table->positions.size()) {
+                size_t cap = std::max<size_t>(node + 1, table->positions.size() * 2);
+                table->positions.resize(cap);
+                table->present.resize(cap, 0);
+            }
+            table->positions[node] = Eigen::Vector4d(
                 std::stod(row[1]), std::stod(row[2]),
                 std::stod(row[3]), std::stod(row[4])
             );
+            table->present[node] = 1;
         }
     );
-
-    cache_loaded_ = true;
+    static MemoryGovernor::Account account =
+        MemoryGovernor::global().enroll("astar_positions", MemoryGovernor::Priority::Pinned);
+    account.update(table->positions.capacity() * sizeof(Eigen::Vector4d) + table->present.capacity());
+    instance = std::move(table);
+    return instance;
 }
 
-std::string AStarSearch::lookup_text(const BLAKE3Pipeline::Hash& id) const {
-    auto it = text_cache_.find(id);
-    return (it != text_cache_.end()) ? it->second : "";
+std::string_view AStarSearch::lookup_text(const BLAKE3Pipeline::Hash& id) const {
+    return texts_ ? texts_->lookup(id) : std::string_view{};
 }
 
 BLAKE3Pipeline::Hash AStarSearch::find_composition(const std::string& text) {
-    BLAKE3Pipeline::Hash result = {};
-    db_.query(
-        "SELECT v.composition_id FROM hartonomous.v_composition_text v "
-        "WHERE LOWER(v.reconstructed_text) = LOWER($1) LIMIT 1",
-        {text},
-        [&](const std::vector<std::string>& row) {
-            result = BLAKE3Pipeline::from_hex(row[0]);
-        }
-    );
-    return result;
+    return resolver_.resolve(text);
 }
 
-std::optional<Eigen::Vector4d> AStarSearch::load_position(const BLAKE3Pipeline::Hash& id) {
-    auto it = position_cache_.find(id);
-    if (it != position_cache_.end()) return it->second;
-    return std::nullopt;
+const Eigen::Vector4d* AStarSearch::load_position(uint32_t node) const {
+    if (!positions_) return nullptr;
+    const auto& t = *positions_;
+    return node < t.present.size() && t.present[node] ? &t.positions[node] : nullptr;
 }
 
-std::vector<AStarSearch::Neighbor> AStarSearch::get_neighbors(
-    const BLAKE3Pipeline::Hash& id, double min_elo, double min_obs)
+void AStarSearch::get_neighbors(const RelationGraph* graph, const BLAKE3Pipeline::Hash& id,
+                                double min_elo, double min_obs, std::vector<Neighbor>& out)
 {
-    std::vector<Neighbor> neighbors;
-    std::string hex = BLAKE3Pipeline::to_hex(id);
-
-    // Aggregate: same composition may appear via multiple relations
-    // Take max ELO, sum observations (same as walk engine)
-    struct Agg { double max_elo = 0; double total_obs = 0; };
-    std::unordered_map<BLAKE3Pipeline::Hash, Agg, HashHasher> agg;
-
-    db_.query(
-        "SELECT rs2.compositionid, rr.ratingvalue, uint64_to_double(rr.observations) "
-        "FROM hartonomous.relationsequence rs1 "
-        "JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid "
-        "  AND rs2.compositionid != rs1.compositionid "
-        "JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid "
-        "WHERE rs1.compositionid = $1",
-        {hex},
-        [&](const std::vector<std::string>& row) {
-            auto nid = BLAKE3Pipeline::from_hex(row[0]);
-            double elo = std::stod(row[1]);
-            double obs = std::stod(row[2]);
-            auto& a = agg[nid];
-            a.max_elo = std::max(a.max_elo, elo);
-            a.total_obs += obs;
+    out.clear();
+    auto& interner = CompositionInterner::global();
+
+    const RelationGraph::TenantMask view = RelationGraph::tenant_view(graph, tenant_);
+    if (graph && shards_ && !shards_->owns(id)) {
+        // Another shard's row, cached here like a database one
+        if (tenant_) throw std::runtime_error("Tenant-restricted search expanded onto a remote graph shard");
+        for (const auto& n : *shards_->neighbors(id)) {
+            if (n.max_elo >= min_elo && n.total_obs >= min_obs)
+                out.push_back({n.node, n.max_elo, n.total_obs});
         }
-    );
-
-    for (const auto& [nid, a] : agg) {
-        if (a.max_elo >= min_elo && a.total_obs >= min_obs) {
-            neighbors.push_back({nid, a.max_elo, a.total_obs});
+        return;
+    }
+    if (graph) {
+        const uint32_t index = graph->index_of(id);
+        const auto row = graph->neighbors(index);
+        const auto masks = graph->tenant_masks(index);
+        for (size_t i = 0; i < row.size(); ++i) {
+            if (view != RelationGraph::ALL_TENANTS && !(masks[i] & view)) continue;
+            const auto& e = row[i];
+            if (e.max_elo >= min_elo && e.total_obs >= min_obs)
+                out.push_back({interner.intern(graph->id_of(e.target)), e.max_elo, e.total_obs});
         }
+        if (graph->is_paged()) prefetch_rows(*graph, row, min_elo, min_obs);
+        return;
+    }
+
+    // Aggregated per neighbor (max ELO, summed observations) by the shared cache
+    for (const auto& n : *NeighborCache::global().neighbors(db_, id)) {
+        if (n.max_elo >= min_elo && n.total_obs >= min_obs)
+            out.push_back({n.node, n.max_elo, n.total_obs});
+    }
+}
+
+void AStarSearch::prefetch_rows(const RelationGraph& graph, std::span<const RelationGraph::Edge> row,
+                                double min_elo, double min_obs) {
+    // The best-rated neighbors are the cheapest to step to, so the likeliest to be expanded next
+    constexpr size_t PAGED_PREFETCH = 64;
+    thread_local std::vector<const RelationGraph::Edge*> best;
+    thread_local std::vector<uint32_t> rows;
+    best.clear();
+    for (const auto& e : row)
+        if (e.max_elo >= min_elo && e.total_obs >= min_obs) best.push_back(&e);
+    if (best.size() > PAGED_PREFETCH) {
+        std::nth_element(best.begin(), best.begin() + PAGED_PREFETCH, best.end(),
+                         [](const RelationGraph::Edge* a, const RelationGraph::Edge* b) { return a->max_elo > b->max_elo; });
+        best.resize(PAGED_PREFETCH);
     }
+    rows.clear();
+    for (const auto* e : best) rows.push_back(e->target);
+    graph.prefetch(rows);
+}
+
+void AStarSearch::set_landmarks(std::shared_ptr<const LandmarkTable> landmarks) {
+    landmarks_ = std::move(landmarks);
+    landmark_rows_.clear();
+    if (!landmarks_ || landmarks_->landmark_count() == 0) return;
+
+    auto& interner = CompositionInterner::global();
+    for (uint32_t i = 0; i < landmarks_->node_count(); ++i) {
+        uint32_t node = interner.intern(landmarks_->id_of(i));
+        if (node >= landmark_rows_.size())
+            landmark_rows_.resize(std::max<size_t>(node + 1, landmark_rows_.size() * 2), LandmarkTable::NPOS);
+        landmark_rows_[node] = i;
+    }
+}
 
-    return neighbors;
+double AStarSearch::lower_bound(const Eigen::Vector4d* pos, const float* row,
+                                const Eigen::Vector4d* to_pos, const float* to_row) const {
+    double h = pos && to_pos ? heuristic(*pos, *to_pos) : 0.0;
+    if (row && to_row) h = std::max(h, LandmarkTable::lower_bound(row, to_row, landmarks_->landmark_count()));
+    return h;
 }
 
 double AStarSearch::heuristic(const Eigen::Vector4d& current, const Eigen::Vector4d& goal) const {
@@ -119,7 +183,7 @@ double AStarSearch::heuristic(const Eigen::Vector4d& current, const Eigen::Vecto
     return std::acos(d);  // Geodesic distance on S³, range [0, π]
 }
 
-double AStarSearch::edge_cost(double elo, double observations) const {
+double AStarSearch::edge_cost(double elo, double observations) {
     // High ELO + high observations = low cost (strong, well-evidenced relation)
     // Normalize ELO to [0,1] range: 800-2000 → 0-1
     double elo_norm = std::clamp((elo - 800.0) / 1200.0, 0.01, 1.0);
@@ -134,118 +198,11 @@ AStarPath AStarSearch::search(const BLAKE3Pipeline::Hash& start,
                               const BLAKE3Pipeline::Hash& goal,
                               const AStarConfig& config)
 {
-    preload_cache();
-
-    AStarPath result;
-    result.found = false;
-    result.total_cost = 0;
-    result.avg_elo = 0;
-    result.avg_observations = 0;
-    result.nodes_expanded = 0;
-
-    auto start_pos = load_position(start);
-    auto goal_pos = load_position(goal);
-    if (!start_pos || !goal_pos) return result;
-
-    // Priority queue: (f_cost, composition_id)
-    using PQEntry = std::pair<double, BLAKE3Pipeline::Hash>;
-    auto cmp = [](const PQEntry& a, const PQEntry& b) { return a.first > b.first; };
-    std::priority_queue<PQEntry, std::vector<PQEntry>, decltype(cmp)> open(cmp);
-
-    // g_cost map and parent map
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> g_costs;
-    std::unordered_map<BLAKE3Pipeline::Hash, BLAKE3Pipeline::Hash, HashHasher> parents;
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> edge_elos;      // For path stats
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> edge_obs;
-
-    g_costs[start] = 0.0;
-    double h = config.heuristic_weight * heuristic(*start_pos, *goal_pos);
-    open.push({h, start});
-
-    while (!open.empty() && result.nodes_expanded < config.max_expansions) {
-        auto [f, current] = open.top();
-        open.pop();
-
-        // Skip if we already found a better path to this node
-        auto g_it = g_costs.find(current);
-        if (g_it != g_costs.end() && f > g_it->second + config.heuristic_weight * M_PI + 0.001) {
-            continue; // Stale entry
-        }
-
-        // Goal reached
-        if (current == goal) {
-            result.found = true;
-            result.total_cost = g_costs[goal];
-
-            // Reconstruct path
-            BLAKE3Pipeline::Hash node = goal;
-            while (node != start) {
-                result.nodes.push_back(node);
-                result.texts.push_back(lookup_text(node));
-                auto pit = parents.find(node);
-                if (pit == parents.end()) break;
-                node = pit->second;
-            }
-            result.nodes.push_back(start);
-            result.texts.push_back(lookup_text(start));
-            std::reverse(result.nodes.begin(), result.nodes.end());
-            std::reverse(result.texts.begin(), result.texts.end());
-
-            // Compute path statistics
-            double elo_sum = 0, obs_sum = 0;
-            size_t edge_count = 0;
-            for (const auto& nid : result.nodes) {
-                auto eit = edge_elos.find(nid);
-                if (eit != edge_elos.end()) {
-                    elo_sum += eit->second;
-                    obs_sum += edge_obs[nid];
-                    edge_count++;
-                }
-            }
-            if (edge_count > 0) {
-                result.avg_elo = elo_sum / edge_count;
-                result.avg_observations = obs_sum / edge_count;
-            }
-
-            return result;
-        }
-
-        result.nodes_expanded++;
-
-        auto neighbors = get_neighbors(current, config.min_elo, config.min_observations);
-        double current_g = g_costs[current];
-
-        for (const auto& [nid, elo, obs] : neighbors) {
-            double tentative_g = current_g + edge_cost(elo, obs);
-
-            auto existing = g_costs.find(nid);
-            if (existing != g_costs.end() && tentative_g >= existing->second) {
-                continue; // Not a better path
-            }
-
-            g_costs[nid] = tentative_g;
-            parents[nid] = current;
-            edge_elos[nid] = elo;
-            edge_obs[nid] = obs;
-
-            auto npos = load_position(nid);
-            double h_val = npos
-                ? config.heuristic_weight * heuristic(*npos, *goal_pos)
-                : config.heuristic_weight * M_PI; // Worst case if no position
-
-            double f_val = tentative_g + h_val;
-
-            // Beam search variant: only expand if within beam width
-            if (config.beam_width > 0) {
-                // For beam search, we rely on the PQ naturally prioritizing
-                // the best nodes. The expansion limit acts as the beam constraint.
-            }
-
-            open.push({f_val, nid});
-        }
+    switch (config.mode) {
+    case AStarMode::Bidirectional: return run_bidirectional(start, {goal}, config);
+    case AStarMode::Parallel:      return run_parallel(start, goal, config);
+    default:                       return run_search(start, {goal}, config);
     }
-
-    return result; // Not found within expansion limit
 }
 
 AStarPath AStarSearch::search_text(const std::string& start_text,
@@ -270,86 +227,85 @@ AStarPath AStarSearch::search_multi_goal(const BLAKE3Pipeline::Hash& start,
                                          const std::vector<BLAKE3Pipeline::Hash>& goals,
                                          const AStarConfig& config)
 {
-    preload_cache();
+    return run_bidirectional(start, goals, config);
+}
 
-    AStarPath result;
-    result.found = false;
-    result.nodes_expanded = 0;
+AStarPath AStarSearch::run_search(const BLAKE3Pipeline::Hash& start,
+                                  const std::vector<BLAKE3Pipeline::Hash>& goals,
+                                  const AStarConfig& config)
+{
+    preload_cache();
+    const auto graph = live_ ? live_->snapshot() : graph_;
 
+    AStarPath result = not_found();
     if (goals.empty()) return result;
+    auto& interner = CompositionInterner::global();
 
-    // Preload goal positions
-    std::vector<std::pair<BLAKE3Pipeline::Hash, Eigen::Vector4d>> goal_positions;
+    // Goal IDs sorted for membership tests; positions and landmark rows for the heuristic
+    struct GoalBound {
+        const Eigen::Vector4d* pos;
+        const float* row;
+    };
+    std::vector<uint32_t> goal_nodes;
+    std::vector<GoalBound> goal_bounds;
     for (const auto& g : goals) {
-        auto pos = load_position(g);
-        if (pos) goal_positions.push_back({g, *pos});
+        uint32_t node = interner.intern(g);
+        goal_nodes.push_back(node);
+        const auto* pos = load_position(node);
+        const float* row = landmark_row(node);
+        if (pos || row) goal_bounds.push_back({pos, row});
     }
-    if (goal_positions.empty()) return result;
+    std::sort(goal_nodes.begin(), goal_nodes.end());
+    if (goal_bounds.empty()) return result;
 
-    auto start_pos = load_position(start);
+    uint32_t start_node = interner.intern(start);
+    const auto* start_pos = load_position(start_node);
     if (!start_pos) return result;
 
-    // Multi-goal heuristic: minimum geodesic to ANY goal
-    auto multi_heuristic = [&](const Eigen::Vector4d& pos) -> double {
-        double min_h = M_PI;
-        for (const auto& [gid, gpos] : goal_positions) {
-            min_h = std::min(min_h, heuristic(pos, gpos));
-        }
-        return min_h;
+    // Multi-goal heuristic: minimum bound to ANY goal; worst case if nothing is known
+    auto goal_heuristic = [&](uint32_t node) -> double {
+        const auto* pos = load_position(node);
+        const float* row = landmark_row(node);
+        if (!pos && !row) return config.heuristic_weight * M_PI;
+        double min_h = std::numeric_limits<double>::infinity();
+        for (const auto& gb : goal_bounds) min_h = std::min(min_h, lower_bound(pos, row, gb.pos, gb.row));
+        return config.heuristic_weight * min_h;
     };
 
-    // Goal set for O(1) membership check
-    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> goal_set(goals.begin(), goals.end());
-
-    using PQEntry = std::pair<double, BLAKE3Pipeline::Hash>;
-    auto cmp = [](const PQEntry& a, const PQEntry& b) { return a.first > b.first; };
-    std::priority_queue<PQEntry, std::vector<PQEntry>, decltype(cmp)> open(cmp);
-
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> g_costs;
-    std::unordered_map<BLAKE3Pipeline::Hash, BLAKE3Pipeline::Hash, HashHasher> parents;
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> edge_elos;
-    std::unordered_map<BLAKE3Pipeline::Hash, double, HashHasher> edge_obs;
-
-    g_costs[start] = 0.0;
-    open.push({config.heuristic_weight * multi_heuristic(*start_pos), start});
+    SearchArena& arena = SearchArena::for_this_thread();
+    arena.reset();
+    std::vector<Neighbor> neighbors;
 
-    while (!open.empty() && result.nodes_expanded < config.max_expansions) {
-        auto [f, current] = open.top();
-        open.pop();
+    uint32_t root = arena.touch(start_node).first;
+    arena.g[root] = 0.0;
+    arena.push(goal_heuristic(start_node), root);
 
-        auto g_it = g_costs.find(current);
-        if (g_it != g_costs.end() && f > g_it->second + config.heuristic_weight * M_PI + 0.001) {
-            continue;
-        }
+    while (!arena.open_empty() && result.nodes_expanded < config.max_expansions) {
+        // One open entry per node, moved on improvement, so none is stale
+        const uint32_t current = arena.pop().slot;
+        uint32_t current_node = arena.node[current];
 
         // Any goal reached?
-        if (goal_set.count(current)) {
+        if (std::binary_search(goal_nodes.begin(), goal_nodes.end(), current_node)) {
             result.found = true;
-            result.total_cost = g_costs[current];
-
-            BLAKE3Pipeline::Hash node = current;
-            while (node != start) {
-                result.nodes.push_back(node);
-                result.texts.push_back(lookup_text(node));
-                auto pit = parents.find(node);
-                if (pit == parents.end()) break;
-                node = pit->second;
-            }
-            result.nodes.push_back(start);
-            result.texts.push_back(lookup_text(start));
-            std::reverse(result.nodes.begin(), result.nodes.end());
-            std::reverse(result.texts.begin(), result.texts.end());
+            result.total_cost = arena.g[current];
 
+            // Reconstruct path; every node but the root was reached over an edge
             double elo_sum = 0, obs_sum = 0;
             size_t edge_count = 0;
-            for (const auto& nid : result.nodes) {
-                auto eit = edge_elos.find(nid);
-                if (eit != edge_elos.end()) {
-                    elo_sum += eit->second;
-                    obs_sum += edge_obs[nid];
+            for (uint32_t slot = current; slot != SearchArena::NONE; slot = arena.parent[slot]) {
+                const auto& id = interner.hash_of(arena.node[slot]);
+                result.nodes.push_back(id);
+                result.texts.emplace_back(lookup_text(id));
+                if (arena.parent[slot] != SearchArena::NONE) {
+                    elo_sum += arena.edge_elo[slot];
+                    obs_sum += arena.edge_obs[slot];
                     edge_count++;
                 }
             }
+            std::reverse(result.nodes.begin(), result.nodes.end());
+            std::reverse(result.texts.begin(), result.texts.end());
+
             if (edge_count > 0) {
                 result.avg_elo = elo_sum / edge_count;
                 result.avg_observations = obs_sum / edge_count;
@@ -359,29 +315,338 @@ AStarPath AStarSearch::search_multi_goal(const BLAKE3Pipeline::Hash& start,
 
         result.nodes_expanded++;
 
-        auto neighbors = get_neighbors(current, config.min_elo, config.min_observations);
-        double current_g = g_costs[current];
+        get_neighbors(graph.get(), interner.hash_of(current_node), config.min_elo, config.min_observations, neighbors);
+        double current_g = arena.g[current];
 
-        for (const auto& [nid, elo, obs] : neighbors) {
+        for (const auto& [node, elo, obs] : neighbors) {
             double tentative_g = current_g + edge_cost(elo, obs);
 
-            auto existing = g_costs.find(nid);
-            if (existing != g_costs.end() && tentative_g >= existing->second) continue;
+            uint32_t slot = arena.touch(node).first;
+            if (tentative_g >= arena.g[slot]) continue; // Not a better path
 
-            g_costs[nid] = tentative_g;
-            parents[nid] = current;
-            edge_elos[nid] = elo;
-            edge_obs[nid] = obs;
+            arena.g[slot] = tentative_g;
+            arena.parent[slot] = current;
+            arena.edge_elo[slot] = elo;
+            arena.edge_obs[slot] = obs;
 
-            auto npos = load_position(nid);
-            double h_val = npos
-                ? config.heuristic_weight * multi_heuristic(*npos)
-                : config.heuristic_weight * M_PI;
+            // Landmarks can prove a node cannot reach any goal
+            double h_val = goal_heuristic(node);
+            if (!std::isfinite(h_val)) continue;
 
-            open.push({tentative_g + h_val, nid});
+            // Beam search variant: the expansion limit acts as the beam
+            // constraint, with the open list prioritizing the best nodes.
+            arena.push(tentative_g + h_val, slot);
         }
     }
 
+    return result; // Not found within expansion limit
+}
+
+AStarPath AStarSearch::run_bidirectional(const BLAKE3Pipeline::Hash& start,
+                                         const std::vector<BLAKE3Pipeline::Hash>& goals,
+                                         const AStarConfig& config)
+{
+    preload_cache();
+    const auto graph = live_ ? live_->snapshot() : graph_;
+
+    AStarPath result = not_found();
+    if (goals.empty()) return result;
+    auto& interner = CompositionInterner::global();
+
+    uint32_t start_node = interner.intern(start);
+    const auto* start_pos = load_position(start_node);
+    if (!start_pos) return result;
+    const float* start_row = landmark_row(start_node);
+    const Eigen::Vector4d* goal_pos = nullptr;
+    const float* goal_row = nullptr;
+    if (goals.size() == 1) {
+        uint32_t goal_node = interner.intern(goals[0]);
+        goal_pos = load_position(goal_node);
+        goal_row = landmark_row(goal_node);
+    }
+
+    // Balanced potentials p_f = (h_goal - h_start) / 2 and p_b = -p_f keep
+    // both frontiers' keys on one scale, so the search may stop as soon as
+    // top_f + top_b >= best meeting cost. A multi-source goal side has no
+    // single h_goal; it takes 0 and the backward frontier alone is guided.
+    const double w = config.heuristic_weight;
+    auto potential = [&](uint32_t node) -> double {
+        const auto* pos = load_position(node);
+        const float* row = landmark_row(node);
+        if (!pos && !row) return 0.0;
+        double h_goal = lower_bound(pos, row, goal_pos, goal_row);
+        double h_start = lower_bound(pos, row, start_pos, start_row);
+        // A node one landmark proves unreachable from either end is never useful
+        if (!std::isfinite(h_goal) || !std::isfinite(h_start)) return std::numeric_limits<double>::quiet_NaN();
+        return 0.5 * w * (h_goal - h_start);
+    };
+
+    SearchArena& fwd = SearchArena::for_this_thread(0);
+    SearchArena& bwd = SearchArena::for_this_thread(1);
+    fwd.reset();
+    bwd.reset();
+
+    double root_potential = potential(start_node);
+    if (std::isnan(root_potential)) return result;
+    uint32_t root = fwd.touch(start_node).first;
+    fwd.g[root] = 0.0;
+    fwd.push(root_potential, root);
+    for (const auto& g : goals) {
+        auto [slot, fresh] = bwd.touch(interner.intern(g));
+        if (!fresh) continue;
+        bwd.g[slot] = 0.0;
+        double p = potential(bwd.node[slot]);
+        if (!std::isnan(p)) bwd.push(-p, slot);
+    }
+
+    double best = std::numeric_limits<double>::infinity();
+    uint32_t meet = SearchArena::NONE;  // Interned ID where the best path crosses
+    if (bwd.find(start_node) != SearchArena::NONE) {
+        best = 0.0;
+        meet = start_node;
+    }
+
+    std::vector<Neighbor> neighbors;
+    while (!fwd.open_empty() && !bwd.open_empty() && result.nodes_expanded < config.max_expansions) {
+        if (fwd.top().f + bwd.top().f >= best) break;
+
+        // Grow the smaller frontier
+        const bool forward = fwd.open_size() <= bwd.open_size();
+        SearchArena& a = forward ? fwd : bwd;
+        SearchArena& other = forward ? bwd : fwd;
+        const double sign = forward ? 1.0 : -1.0;
+
+        const uint32_t current = a.pop().slot;
+        uint32_t current_node = a.node[current];
+
+        result.nodes_expanded++;
+        get_neighbors(graph.get(), interner.hash_of(current_node), config.min_elo, config.min_observations, neighbors);
+        double current_g = a.g[current];
+
+        for (const auto& [node, elo, obs] : neighbors) {
+            double tentative_g = current_g + edge_cost(elo, obs);
+
+            uint32_t slot = a.touch(node).first;
+            if (tentative_g >= a.g[slot]) continue;
+
+            a.g[slot] = tentative_g;
+            a.parent[slot] = current;
+            a.edge_elo[slot] = elo;
+            a.edge_obs[slot] = obs;
+            double p = potential(node);
+            if (std::isnan(p)) continue;
+            a.push(tentative_g + sign * p, slot);
+
+            uint32_t o = other.find(node);
+            if (o != SearchArena::NONE && tentative_g + other.g[o] < best) {
+                best = tentative_g + other.g[o];
+                meet = node;
+            }
+        }
+    }
+
+    if (meet == SearchArena::NONE) return result;
+    result.found = true;
+    result.total_cost = best;
+
+    // Start → meet from the forward parents, then meet → goal from the backward ones
+    double elo_sum = 0, obs_sum = 0;
+    size_t edge_count = 0;
+    for (uint32_t slot = fwd.find(meet); slot != SearchArena::NONE; slot = fwd.parent[slot]) {
+        result.nodes.push_back(interner.hash_of(fwd.node[slot]));
+        if (fwd.parent[slot] != SearchArena::NONE) {
+            elo_sum += fwd.edge_elo[slot];
+            obs_sum += fwd.edge_obs[slot];
+            edge_count++;
+        }
+    }
+    std::reverse(result.nodes.begin(), result.nodes.end());
+    for (uint32_t slot = bwd.find(meet); bwd.parent[slot] != SearchArena::NONE; slot = bwd.parent[slot]) {
+        result.nodes.push_back(interner.hash_of(bwd.node[bwd.parent[slot]]));
+        elo_sum += bwd.edge_elo[slot];
+        obs_sum += bwd.edge_obs[slot];
+        edge_count++;
+    }
+    for (const auto& id : result.nodes) result.texts.emplace_back(lookup_text(id));
+
+    if (edge_count > 0) {
+        result.avg_elo = elo_sum / edge_count;
+        result.avg_observations = obs_sum / edge_count;
+    }
+    return result;
+}
+
+AStarPath AStarSearch::run_parallel(const BLAKE3Pipeline::Hash& start,
+                                    const BLAKE3Pipeline::Hash& goal,
+                                    const AStarConfig& config)
+{
+    preload_cache();
+    const auto graph = live_ ? live_->snapshot() : graph_;
+
+    // Threads may only expand from the immutable snapshot
+    size_t threads = config.threads ? config.threads : worker_threads();
+    if (!graph || threads < 2) return run_bidirectional(start, {goal}, config);
+
+    AStarPath result = not_found();
+    auto& interner = CompositionInterner::global();
+    uint32_t start_node = interner.intern(start);
+    uint32_t goal_node = interner.intern(goal);
+    const auto* start_pos = load_position(start_node);
+    const auto* goal_pos = load_position(goal_node);
+    if (!start_pos || !goal_pos) return result;
+    const float* goal_row = landmark_row(goal_node);
+
+    const double w = config.heuristic_weight;
+    auto h = [&](uint32_t node) -> double {
+        const auto* pos = load_position(node);
+        const float* row = landmark_row(node);
+        return w * (pos || row ? lower_bound(pos, row, goal_pos, goal_row) : M_PI);
+    };
+
+    // A node's g, parent and reaching edge live only with its owner; others
+    // send it (node, g, parent) offers and the owner keeps the best.
+    struct Offer {
+        uint32_t node;
+        uint32_t parent;  // Interned ID, NONE for the root
+        double g;
+        double elo;
+        double obs;
+    };
+    struct Partition {
+        SearchArena arena;
+        std::vector<uint32_t> parent_node;  // By slot; arena.parent is unused
+        std::mutex inbox_mutex;
+        std::vector<Offer> inbox;
+    };
+    std::vector<std::unique_ptr<Partition>> parts;
+    for (size_t t = 0; t < threads; ++t) parts.push_back(std::make_unique<Partition>());
+    auto owner = [&](uint32_t node) {
+        return static_cast<size_t>(((uint64_t(node) * 0x9E3779B97F4A7C15ULL) >> 32) % threads);
+    };
+
+    auto relax = [&](Partition& p, const Offer& o) {
+        auto [slot, fresh] = p.arena.touch(o.node);
+        if (fresh) p.parent_node.push_back(SearchArena::NONE);
+        if (o.g >= p.arena.g[slot]) return;
+        p.arena.g[slot] = o.g;
+        p.parent_node[slot] = o.parent;
+        p.arena.edge_elo[slot] = o.elo;
+        p.arena.edge_obs[slot] = o.obs;
+        p.arena.push(o.g + h(o.node), slot);
+    };
+    relax(*parts[owner(start_node)], {start_node, SearchArena::NONE, 0.0, 0.0, 0.0});
+
+    // Done once every thread is idle with no offer in flight, or at the expansion limit
+    std::atomic<double> best{std::numeric_limits<double>::infinity()};
+    std::atomic<size_t> expanded{0};
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> idle{0};
+    std::atomic<bool> done{false};
+
+    auto worker = [&](size_t me) {
+        Partition& p = *parts[me];
+        std::vector<Offer> batch;
+        std::vector<std::vector<Offer>> outbox(threads);
+        std::vector<Neighbor> neighbors;
+        bool is_idle = false;
+
+        while (!done.load()) {
+            {
+                std::lock_guard<std::mutex> lock(p.inbox_mutex);
+                batch.swap(p.inbox);
+            }
+            if (!batch.empty()) {
+                if (is_idle) {
+                    idle.fetch_sub(1);
+                    is_idle = false;
+                }
+                for (const auto& o : batch) relax(p, o);
+                pending.fetch_sub(batch.size());
+                batch.clear();
+            }
+
+            // Expand one node: skip anything the incumbent already beats
+            bool worked = false;
+            while (!p.arena.open_empty()) {
+                auto [f, current] = p.arena.pop();
+                double incumbent = best.load();
+                if (f >= incumbent) continue;
+                uint32_t current_node = p.arena.node[current];
+                double current_g = p.arena.g[current];
+
+                if (current_node == goal_node) {
+                    while (current_g < incumbent && !best.compare_exchange_weak(incumbent, current_g)) {}
+                    continue;
+                }
+                if (expanded.fetch_add(1) >= config.max_expansions) {
+                    done.store(true);
+                    break;
+                }
+
+                get_neighbors(graph.get(), interner.hash_of(current_node), config.min_elo, config.min_observations, neighbors);
+                for (const auto& [node, elo, obs] : neighbors) {
+                    double tentative_g = current_g + edge_cost(elo, obs);
+                    if (tentative_g + h(node) >= best.load()) continue;
+                    Offer o{node, current_node, tentative_g, elo, obs};
+                    size_t dest = owner(node);
+                    if (dest == me) relax(p, o);
+                    else outbox[dest].push_back(o);
+                }
+                worked = true;
+                break;
+            }
+
+            for (size_t dest = 0; dest < threads; ++dest) {
+                if (outbox[dest].empty()) continue;
+                pending.fetch_add(outbox[dest].size());
+                std::lock_guard<std::mutex> lock(parts[dest]->inbox_mutex);
+                auto& in = parts[dest]->inbox;
+                in.insert(in.end(), outbox[dest].begin(), outbox[dest].end());
+                outbox[dest].clear();
+            }
+
+            if (!worked) {
+                if (!is_idle) {
+                    idle.fetch_add(1);
+                    is_idle = true;
+                }
+                if (idle.load() == threads && pending.load() == 0) done.store(true);
+                else std::this_thread::yield();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool) t.join();
+
+    result.nodes_expanded = std::min(expanded.load(), config.max_expansions);
+    if (!std::isfinite(best.load())) return result;
+
+    // Parent chains cross partitions; g strictly decreases along them, so they end at the root
+    double elo_sum = 0, obs_sum = 0;
+    size_t edge_count = 0;
+    for (uint32_t node = goal_node; node != SearchArena::NONE;) {
+        Partition& p = *parts[owner(node)];
+        uint32_t slot = p.arena.find(node);
+        result.nodes.push_back(interner.hash_of(node));
+        node = p.parent_node[slot];
+        if (node != SearchArena::NONE) {
+            elo_sum += p.arena.edge_elo[slot];
+            obs_sum += p.arena.edge_obs[slot];
+            edge_count++;
+        }
+    }
+    std::reverse(result.nodes.begin(), result.nodes.end());
+    for (const auto& id : result.nodes) result.texts.emplace_back(lookup_text(id));
+
+    result.found = true;
+    result.total_cost = best.load();
+    if (edge_count > 0) {
+        result.avg_elo = elo_sum / edge_count;
+        result.avg_observations = obs_sum / edge_count;
+    }
     return result;
 }
 
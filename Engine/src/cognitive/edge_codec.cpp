@@ -0,0 +1,109 @@
+/**
+ * @file edge_codec.cpp
+ * @brief StreamVByte encode, scalar and NEON decode, and the shared tables
+ */
+
+#include "cognitive/edge_codec.hpp"
+#include <utils/cpu_dispatch.hpp>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace Hartonomous::edge_codec {
+
+static GroupTables make_group_tables() {
+    GroupTables t{};
+    for (int c = 0; c < 256; ++c) {
+        int at = 0;
+        for (int v = 0; v < 4; ++v) {
+            const int len = ((c >> (2 * v)) & 3) + 1;
+            for (int b = 0; b < 4; ++b)
+                t.shuffle[c][4 * v + b] = b < len ? static_cast<uint8_t>(at + b) : 0xFF;  // 0xFF zeroes the byte
+            at += len;
+        }
+        t.length[c] = static_cast<uint8_t>(at);
+    }
+    return t;
+}
+
+const GroupTables GROUP_TABLES = make_group_tables();
+
+static ObsLogTable make_obs_log_table() {
+    ObsLogTable t{};
+    for (int i = 0; i < 1024; ++i) t.fraction[i] = std::exp2(i / OBS_LOG_STEPS);
+    return t;
+}
+
+const ObsLogTable OBS_LOG_TABLE = make_obs_log_table();
+
+size_t encode_targets(const uint32_t* targets, size_t n, uint8_t* out) {
+    uint8_t* control = out;
+    uint8_t* data = out + control_bytes(n);
+    std::memset(control, 0, control_bytes(n));
+    uint32_t prev = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t delta = targets[i] - prev;
+        prev = targets[i];
+        const int len = delta < (1u << 8) ? 1 : delta < (1u << 16) ? 2 : delta < (1u << 24) ? 3 : 4;
+        control[i >> 2] |= static_cast<uint8_t>((len - 1) << (2 * (i & 3)));
+        for (int b = 0; b < len; ++b) *data++ = static_cast<uint8_t>(delta >> (8 * b));
+    }
+    return static_cast<size_t>(data - out);
+}
+
+size_t encoded_target_bytes(const uint8_t* in, size_t n) {
+    size_t bytes = control_bytes(n);
+    for (size_t i = 0; i < n; ++i) bytes += ((in[i >> 2] >> (2 * (i & 3))) & 3) + 1;
+    return bytes;
+}
+
+#if defined(__aarch64__)
+static const uint8_t* decode_groups_neon(const uint8_t* control, const uint8_t* data, size_t groups,
+                                         uint32_t* out, uint32_t& prev) {
+    uint32x4_t carry = vdupq_n_u32(prev);
+    const uint32x4_t zero = vdupq_n_u32(0);
+    for (size_t g = 0; g < groups; ++g) {
+        const uint8_t c = control[g];
+        const uint8x16_t raw = vld1q_u8(data);
+        uint32x4_t v = vreinterpretq_u32_u8(vqtbl1q_u8(raw, vld1q_u8(GROUP_TABLES.shuffle[c])));
+        data += GROUP_TABLES.length[c];
+        // Inclusive prefix sum of the four deltas, then the running total
+        v = vaddq_u32(v, vextq_u32(zero, v, 3));
+        v = vaddq_u32(v, vextq_u32(zero, v, 2));
+        v = vaddq_u32(v, carry);
+        vst1q_u32(out + 4 * g, v);
+        carry = vdupq_laneq_u32(v, 3);
+    }
+    prev = vgetq_lane_u32(carry, 0);
+    return data;
+}
+#endif
+
+size_t decode_targets(const uint8_t* in, size_t n, uint32_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + control_bytes(n);
+    uint32_t prev = 0;
+    size_t i = 0;
+#if defined(HARTONOMOUS_X86_KERNELS)
+    if (simd_level() >= SimdLevel::Avx2) {
+        data = decode_groups_avx2(control, data, n / 4, out, prev);
+        i = n & ~size_t(3);
+    }
+#elif defined(__aarch64__)
+    data = decode_groups_neon(control, data, n / 4, out, prev);
+    i = n & ~size_t(3);
+#endif
+    for (; i < n; ++i) {
+        const int len = ((control[i >> 2] >> (2 * (i & 3))) & 3) + 1;
+        uint32_t delta = 0;
+        for (int b = 0; b < len; ++b) delta |= static_cast<uint32_t>(data[b]) << (8 * b);
+        data += len;
+        prev += delta;
+        out[i] = prev;
+    }
+    return static_cast<size_t>(data - in);
+}
+
+} // namespace Hartonomous::edge_codec
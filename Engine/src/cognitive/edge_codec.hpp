@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file edge_codec.hpp
+ * @brief Packed relation graph rows: StreamVByte neighbor lists, quantized ELO and observations
+ *
+ * A sorted neighbor list is stored as deltas (the first against zero) in
+ * StreamVByte form: one control byte per four values, two bits each giving
+ * that value's byte length minus one, then the value bytes back to back.
+ * A decoder reads a whole group of four with one 16-byte load and a byte
+ * shuffle picked by its control byte, so rows decode at memory speed.
+ *
+ * Group loads may read up to 16 bytes past a row's last value; buffers of
+ * encoded rows keep STREAM_PADDING readable bytes after the last row.
+ * decode_targets picks the AVX2 kernel (edge_codec_avx2.cpp) from
+ * simd_level(), NEON on aarch64, else the scalar loop.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace Hartonomous::edge_codec {
+
+constexpr size_t STREAM_PADDING = 16;
+
+constexpr size_t control_bytes(size_t n) { return (n + 3) / 4; }
+constexpr size_t max_target_bytes(size_t n) { return control_bytes(n) + 4 * n; }
+
+// Shuffle (16 bytes) and data length of each control byte
+struct GroupTables {
+    alignas(16) uint8_t shuffle[256][16];
+    uint8_t length[256];
+};
+extern const GroupTables GROUP_TABLES;
+
+// Delta-encode ascending `targets`; returns the bytes written to `out`
+size_t encode_targets(const uint32_t* targets, size_t n, uint8_t* out);
+
+// Bytes encode_targets wrote for `n` values, read from the control bytes alone
+size_t encoded_target_bytes(const uint8_t* in, size_t n);
+
+// Decode `n` targets; returns the bytes consumed
+size_t decode_targets(const uint8_t* in, size_t n, uint32_t* out);
+
+// Observations: per-row width. Whole counts below 256 are stored exactly in
+// one byte; other rows use 16-bit codes of log2(1 + obs) in 1/1024 steps
+// (relative error under 0.04%, range to 2^64).
+constexpr double OBS_LOG_STEPS = 1024.0;
+
+inline bool obs_fits_byte(double obs) { return obs >= 0.0 && obs < 256.0 && obs == std::floor(obs); }
+
+inline uint16_t encode_obs_log(double obs) {
+    const double code = std::round(std::log2(1.0 + std::max(0.0, obs)) * OBS_LOG_STEPS);
+    return static_cast<uint16_t>(std::min(code, 65535.0));
+}
+
+// 2^(i / 1024) for the low ten bits of a code
+struct ObsLogTable {
+    double fraction[1024];
+};
+extern const ObsLogTable OBS_LOG_TABLE;
+
+inline double decode_obs_log(uint16_t code) {
+    return std::ldexp(OBS_LOG_TABLE.fraction[code & 1023], code >> 10) - 1.0;
+}
+
+// Per-ISA full-group decoders: decode `groups` groups of four, continuing the
+// running sum in `prev`; return the data pointer after the last group
+const uint8_t* decode_groups_avx2(const uint8_t* control, const uint8_t* data, size_t groups,
+                                  uint32_t* out, uint32_t& prev);
+
+} // namespace Hartonomous::edge_codec
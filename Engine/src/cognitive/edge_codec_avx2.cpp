@@ -0,0 +1,30 @@
+/**
+ * @file edge_codec_avx2.cpp
+ * @brief StreamVByte group decode (built with AVX2 flags; uses the 128-bit byte shuffle)
+ */
+
+#include "cognitive/edge_codec.hpp"
+#include <immintrin.h>
+
+namespace Hartonomous::edge_codec {
+
+const uint8_t* decode_groups_avx2(const uint8_t* control, const uint8_t* data, size_t groups,
+                                  uint32_t* out, uint32_t& prev) {
+    __m128i carry = _mm_set1_epi32(static_cast<int>(prev));
+    for (size_t g = 0; g < groups; ++g) {
+        const uint8_t c = control[g];
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i v = _mm_shuffle_epi8(raw, _mm_load_si128(reinterpret_cast<const __m128i*>(GROUP_TABLES.shuffle[c])));
+        data += GROUP_TABLES.length[c];
+        // Inclusive prefix sum of the four deltas, then the running total
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), v);
+        carry = _mm_shuffle_epi32(v, 0xFF);
+    }
+    prev = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+    return data;
+}
+
+} // namespace Hartonomous::edge_codec
@@ -11,35 +11,125 @@
  */
 
 #include <cognitive/godel_engine.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <hashing/composition_interner.hpp>
+#include <storage/composition_text_store.hpp>
 #include <hashing/blake3_pipeline.hpp>
 #include <iostream>
 #include <queue>
 #include <algorithm>
 #include <sstream>
 #include <cctype>
+#include <cmath>
+#include <cstring>
 
 namespace Hartonomous {
 
 GodelEngine::GodelEngine(PostgresConnection& db) : db_(db) {}
 
+GodelEngine::GodelEngine(ConnectionPool& pool) : lease_(pool.acquire()), db_(*lease_) {}
+
 std::string GodelEngine::hash_text(const std::string& text) {
     return BLAKE3Pipeline::to_hex(BLAKE3Pipeline::hash(text));
 }
 
+// Whole decomposition in one statement. Each node's children are its
+// relation neighbors, strongest (max rating over shared relations) first;
+// only unsolvable nodes (rating <= 1800) are expanded, down to $2 levels,
+// never revisiting an ancestor. sort_path orders rows depth-first, as the
+// plan lists them. Prerequisites are the other members of one relation of
+// the node, packed as 16-byte IDs.
+static const char* DECOMPOSE_SQL = R"(
+    WITH RECURSIVE tree AS (
+        SELECT c.id, c.elo, 1 AS depth, ARRAY[c.rank] AS sort_path, ARRAY[$1::uuid, c.id] AS ancestors
+        FROM (
+            SELECT
+                rs2.compositionid AS id,
+                MAX(rr.ratingvalue)::float8 AS elo,
+                row_number() OVER (ORDER BY MAX(rr.ratingvalue) DESC, rs2.compositionid) AS rank
+            FROM hartonomous.relationsequence rs1
+            JOIN hartonomous.relationsequence rs2
+                ON rs2.relationid = rs1.relationid AND rs2.compositionid != rs1.compositionid
+            JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid
+            WHERE rs1.compositionid = $1
+            GROUP BY rs2.compositionid
+        ) c
+        UNION ALL
+        SELECT c.id, c.elo, t.depth + 1, t.sort_path || c.rank, t.ancestors || c.id
+        FROM tree t
+        CROSS JOIN LATERAL (
+            SELECT
+                rs2.compositionid AS id,
+                MAX(rr.ratingvalue)::float8 AS elo,
+                row_number() OVER (ORDER BY MAX(rr.ratingvalue) DESC, rs2.compositionid) AS rank
+            FROM hartonomous.relationsequence rs1
+            JOIN hartonomous.relationsequence rs2
+                ON rs2.relationid = rs1.relationid AND rs2.compositionid != rs1.compositionid
+            JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid
+            WHERE rs1.compositionid = t.id
+            GROUP BY rs2.compositionid
+        ) c
+        WHERE t.elo <= 1800 AND t.depth < $2 AND c.id <> ALL(t.ancestors)
+    )
+    SELECT t.id, t.elo, t.depth, COALESCE(pr.ids, ''::bytea)
+    FROM tree t
+    LEFT JOIN LATERAL (
+        SELECT string_agg(uuid_send(rs.compositionid), ''::bytea) AS ids
+        FROM hartonomous.relationsequence rs
+        WHERE rs.relationid = (SELECT relationid FROM hartonomous.relationsequence
+                               WHERE compositionid = t.id LIMIT 1)
+          AND rs.compositionid != t.id
+    ) pr ON true
+    ORDER BY t.sort_path
+)";
+
+// Related compositions with weak or little evidence: where the "gravitational well" is shallow
+static const char* GAPS_SQL = R"(
+    WITH related_concepts AS (
+        SELECT DISTINCT rs2.compositionid as concept_id
+        FROM hartonomous.relationsequence rs1
+        JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid
+        WHERE rs1.compositionid = $1
+    ),
+    concept_strength AS (
+        SELECT
+            rc.concept_id,
+            v.reconstructed_text,
+            COALESCE(rr.ratingvalue, 0)::float8 as rating,
+            COALESCE(uint64_to_double(rr.observations), 0)::float8 as observations
+        FROM related_concepts rc
+        JOIN hartonomous.v_composition_text v ON v.composition_id = rc.concept_id
+        LEFT JOIN hartonomous.relationrating rr ON rr.relationid = rc.concept_id
+    )
+    SELECT reconstructed_text, observations, rating
+    FROM concept_strength
+    WHERE rating < 1200 OR observations < 5
+    ORDER BY rating ASC
+    LIMIT 10
+)";
+
+static constexpr int MAX_DECOMPOSITION_DEPTH = 5;
+
 ResearchPlan GodelEngine::analyze_problem(const std::string& problem) {
     ResearchPlan plan;
     plan.original_problem = problem;
 
     // Use actual BLAKE3 hash for the problem statement
     BLAKE3Pipeline::Hash problem_hash = BLAKE3Pipeline::hash(problem);
-    std::string problem_uuid = BLAKE3Pipeline::to_hex(problem_hash);
 
-    // 1. Knowledge Gap Analysis (What concepts are referenced but lack strong relations?)
-    plan.knowledge_gaps = identify_knowledge_gaps(problem_uuid);
+    // 1. Knowledge gaps and 2. the full decomposition, in one round trip
+    const auto& gaps_stmt = db_.prepare("godel_gaps", GAPS_SQL, {PgType::Uuid});
+    const auto& tree_stmt = db_.prepare("godel_decompose", DECOMPOSE_SQL, {PgType::Uuid, PgType::Int4});
+    std::vector<PgResult> results;
+    {
+        PostgresConnection::Pipeline pipe(db_);
+        pipe.send(gaps_stmt, {PgParam::uuid(problem_hash)});
+        pipe.send(tree_stmt, {PgParam::uuid(problem_hash), PgParam::int4(MAX_DECOMPOSITION_DEPTH)});
+        results = pipe.sync();
+    }
+    plan.knowledge_gaps = read_gaps(results[0]);
+    plan.decomposition = read_decomposition(results[1]);
 
-    // 2. Recursive Decomposition (Break into solvable sub-problems)
-    plan.decomposition = decompose_problem_recursive(problem_uuid, 0, 5);
-    
     plan.total_steps = plan.decomposition.size();
     plan.solvable_steps = 0;
     for (const auto& sub : plan.decomposition) {
@@ -50,97 +140,67 @@ ResearchPlan GodelEngine::analyze_problem(const std::string& problem) {
 }
 
 std::vector<SubProblem> GodelEngine::decompose_problem(const std::string& problem) {
-    BLAKE3Pipeline::Hash problem_hash = BLAKE3Pipeline::hash(problem);
-    std::string problem_uuid = BLAKE3Pipeline::to_hex(problem_hash);
-    return decompose_problem_recursive(problem_uuid, 0, 5);
+    const auto& stmt = db_.prepare("godel_decompose", DECOMPOSE_SQL, {PgType::Uuid, PgType::Int4});
+    return read_decomposition(db_.execute_prepared(stmt, {PgParam::uuid(BLAKE3Pipeline::hash(problem)),
+                                                          PgParam::int4(MAX_DECOMPOSITION_DEPTH)}));
 }
 
 std::vector<KnowledgeGap> GodelEngine::identify_knowledge_gaps(const std::string& problem_uuid) {
-    std::vector<KnowledgeGap> gaps;
+    const auto& stmt = db_.prepare("godel_gaps", GAPS_SQL, {PgType::Uuid});
+    return read_gaps(db_.execute_prepared(stmt, {PgParam::uuid(BLAKE3Pipeline::from_hex(problem_uuid))}));
+}
 
-    // QUERY THE REAL SCHEMA: 
-    // Find compositions related to the problem that have LOW rating values or NO evidence.
-    // This identifies where the "gravitational well" is shallow.
-    std::string sql = R"(
-        WITH related_concepts AS (
-            SELECT DISTINCT rs2.compositionid as concept_id
-            FROM hartonomous.relationsequence rs1
-            JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid
-            WHERE rs1.compositionid = $1
-        ),
-        concept_strength AS (
-            SELECT 
-                rc.concept_id,
-                v.reconstructed_text,
-                COALESCE(rr.ratingvalue, 0) as rating,
-                COALESCE(uint64_to_double(rr.observations), 0) as observations
-            FROM related_concepts rc
-            JOIN hartonomous.v_composition_text v ON v.composition_id = rc.concept_id
-            LEFT JOIN hartonomous.relationrating rr ON rr.relationid = rc.concept_id
-        )
-        SELECT reconstructed_text, observations, rating
-        FROM concept_strength
-        WHERE rating < 1200 OR observations < 5
-        ORDER BY rating ASC
-        LIMIT 10
-    )";
-
-    db_.query(sql, {problem_uuid}, [&](const std::vector<std::string>& row) {
+std::vector<KnowledgeGap> GodelEngine::read_gaps(const PgResult& rows) {
+    std::vector<KnowledgeGap> gaps;
+    for (int i = 0; i < rows.size(); ++i) {
+        auto row = rows[i];
         KnowledgeGap gap;
-        gap.concept_name = row[0];
-        gap.references_count = std::stoi(row[1]);
-        gap.confidence = std::stod(row[2]) / 2000.0;
+        gap.concept_name = std::string(row.get_text(0));
+        gap.references_count = static_cast<int>(row.get_float8(1));
+        gap.confidence = row.get_float8(2) / 2000.0;
         gaps.push_back(gap);
-    });
-
+    }
     return gaps;
 }
 
-std::vector<SubProblem> GodelEngine::decompose_problem_recursive(const std::string& current_id, int depth, int max_depth) {
-    if (depth >= max_depth) return {};
-
+std::vector<SubProblem> GodelEngine::read_decomposition(const PgResult& rows) {
     std::vector<SubProblem> subproblems;
+    auto texts = CompositionTextStore::shared(db_);
+
+    // Rows arrive depth-first. A composition without text is dropped with its
+    // whole subtree, which is every following row deeper than it.
+    int skip_below = 0;
+    for (int i = 0; i < rows.size(); ++i) {
+        auto row = rows[i];
+        int depth = row.get_int4(2);
+        if (skip_below > 0) {
+            if (depth > skip_below) continue;
+            skip_below = 0;
+        }
 
-    // Recursive traversal: Find children and their ratings
-    std::string sql = R"(
-        SELECT 
-            rs2.compositionid,
-            v.reconstructed_text,
-            COALESCE(rr.ratingvalue, 0),
-            COALESCE(uint64_to_double(rr.observations), 0)
-        FROM hartonomous.relationsequence rs1
-        JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid
-        JOIN hartonomous.v_composition_text v ON v.composition_id = rs2.compositionid
-        LEFT JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid
-        WHERE rs1.compositionid = $1 AND rs2.compositionid != $1
-        ORDER BY rr.ratingvalue DESC
-    )";
+        BLAKE3Pipeline::Hash id = row.get_uuid(0);
+        std::string_view text = texts->lookup(id);
+        if (text.empty()) {
+            skip_below = depth;
+            continue;
+        }
 
-    db_.query(sql, {current_id}, [&](const std::vector<std::string>& row) {
+        double elo = row.get_float8(1);
         SubProblem sub;
-        sub.node_id = BLAKE3Pipeline::from_hex(row[0]);
-        sub.description = row[1];
-        double rating = std::stod(row[2]);
-        sub.difficulty = static_cast<int>(10.0 * (1.0 - (rating / 2000.0)));
-        sub.is_solvable = (rating > 1800);
-        
-        // Find prerequisites for this sub-problem
-        std::string prereq_sql = "SELECT v.reconstructed_text FROM hartonomous.relationsequence rs "
-                                "JOIN hartonomous.v_composition_text v ON v.composition_id = rs.compositionid "
-                                "WHERE rs.relationid = (SELECT relationid FROM hartonomous.relationsequence "
-                                "WHERE compositionid = $1 LIMIT 1) AND rs.compositionid != $1";
-        
-        db_.query(prereq_sql, {row[0]}, [&](const std::vector<std::string>& p_row) {
-            sub.prerequisites.push_back(p_row[0]);
-        });
-
-        subproblems.push_back(sub);
-
-        if (!sub.is_solvable) {
-            auto children = decompose_problem_recursive(row[0], depth + 1, max_depth);
-            subproblems.insert(subproblems.end(), children.begin(), children.end());
+        sub.node_id = id;
+        sub.description = std::string(text);
+        sub.difficulty = static_cast<int>(10.0 * (1.0 - (elo / 2000.0)));
+        sub.is_solvable = (elo > 1800);
+
+        auto packed = row.get_bytes(3);
+        for (size_t off = 0; off + 16 <= packed.size(); off += 16) {
+            BLAKE3Pipeline::Hash prereq;
+            std::memcpy(prereq.data(), packed.data() + off, 16);
+            std::string_view prereq_text = texts->lookup(prereq);
+            if (!prereq_text.empty()) sub.prerequisites.emplace_back(prereq_text);
         }
-    });
+        subproblems.push_back(std::move(sub));
+    }
 
     return subproblems;
 }
@@ -177,17 +237,21 @@ bool GodelEngine::is_solvable(const std::string& problem) {
     // Solvable = at least one keyword has strong relations (ELO > 1500, obs > 10)
     int strong_concepts = 0;
 
-    for (const auto& kw : keywords) {
-        auto result = db_.query_single(
-            "SELECT COUNT(*) FROM hartonomous.v_composition_text v "
-            "JOIN hartonomous.relationsequence rs ON rs.compositionid = v.composition_id "
+    // Keywords resolve in one probe and are checked independently, so pipeline them into one round trip
+    PostgresConnection::Pipeline pipe(db_);
+    for (const auto& id : resolver_.resolve_many(keywords)) {
+        if (id == BLAKE3Pipeline::Hash{}) continue;
+        pipe.send(
+            "SELECT COUNT(*) FROM hartonomous.relationsequence rs "
             "JOIN hartonomous.relationrating rr ON rr.relationid = rs.relationid "
-            "WHERE LOWER(v.reconstructed_text) = $1 "
+            "WHERE rs.compositionid = $1 "
             "  AND rr.ratingvalue > 1500 "
             "  AND uint64_to_double(rr.observations) > 10",
-            {kw}
+            {BLAKE3Pipeline::to_hex(id)}
         );
-        if (result && std::stoi(*result) > 0) {
+    }
+    for (const auto& result : pipe.sync()) {
+        if (!result.empty() && std::stoll(std::string(result[0].get_text(0))) > 0) {
             strong_concepts++;
         }
     }
@@ -204,38 +268,24 @@ std::vector<std::string> GodelEngine::query_known_facts(const std::string& topic
     std::vector<std::string> facts;
 
     // Find the topic composition
-    std::string comp_id;
-    db_.query(
-        "SELECT v.composition_id FROM hartonomous.v_composition_text v "
-        "WHERE LOWER(v.reconstructed_text) = LOWER($1) LIMIT 1",
-        {topic},
-        [&](const std::vector<std::string>& row) { comp_id = row[0]; }
-    );
-
-    if (comp_id.empty()) return facts;
+    auto comp_id = resolver_.resolve(topic);
+    if (comp_id == BLAKE3Pipeline::Hash{}) return facts;
 
     // Find strongly related concepts (high ELO, high observations)
     // These represent "known facts" — well-evidenced, high-confidence relations
-    db_.query(
-        R"(SELECT DISTINCT
-            v2.reconstructed_text,
-            rr.ratingvalue,
-            uint64_to_double(rr.observations) as obs
-        FROM hartonomous.relationsequence rs1
-        JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid
-            AND rs2.compositionid != rs1.compositionid
-        JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid
-        JOIN hartonomous.v_composition_text v2 ON v2.composition_id = rs2.compositionid
-        WHERE rs1.compositionid = $1
-          AND rr.ratingvalue > 1400
-          AND uint64_to_double(rr.observations) > 5
-        ORDER BY rr.ratingvalue * LOG(uint64_to_double(rr.observations) + 1) DESC
-        LIMIT 20)",
-        {comp_id},
-        [&](const std::vector<std::string>& row) {
-            facts.push_back(row[0]);
-        }
-    );
+    auto& interner = CompositionInterner::global();
+    auto texts = CompositionTextStore::shared(db_);
+    std::vector<std::pair<double, std::string_view>> scored;
+    for (const auto& n : *NeighborCache::global().neighbors(db_, comp_id)) {
+        if (n.max_elo <= 1400 || n.total_obs <= 5) continue;
+        std::string_view text = texts->lookup(interner.hash_of(n.node));
+        if (!text.empty()) scored.emplace_back(n.max_elo * std::log(n.total_obs + 1), text);
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& [score, text] : scored) {
+        if (facts.size() >= 20) break;
+        if (std::find(facts.begin(), facts.end(), text) == facts.end()) facts.emplace_back(text);
+    }
 
     return facts;
 }
@@ -272,15 +322,9 @@ std::vector<std::string> GodelEngine::generate_research_plan(const std::vector<K
                      "Needs additional evidence from diverse sources to strengthen.";
 
             // Check what sources we DO have
-            std::string comp_id;
-            db_.query(
-                "SELECT v.composition_id FROM hartonomous.v_composition_text v "
-                "WHERE LOWER(v.reconstructed_text) = LOWER($1) LIMIT 1",
-                {gap.concept_name},
-                [&](const std::vector<std::string>& row) { comp_id = row[0]; }
-            );
-
-            if (!comp_id.empty()) {
+            auto id = resolver_.resolve(gap.concept_name);
+            if (id != BLAKE3Pipeline::Hash{}) {
+                std::string comp_id = BLAKE3Pipeline::to_hex(id);
                 int source_count = 0;
                 db_.query(
                     "SELECT COUNT(DISTINCT re.contentid) "
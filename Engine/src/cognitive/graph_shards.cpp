@@ -0,0 +1,389 @@
+/**
+ * @file graph_shards.cpp
+ * @brief Hash partitioning of the relation graph and the shard row protocol
+ */
+
+#include <cognitive/graph_shards.hpp>
+#include <hashing/composition_interner.hpp>
+#include <utils/metrics.hpp>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+namespace {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Shard protocol is little-endian on the wire");
+
+constexpr char SHARD_MAGIC[4] = {'H', 'G', 'S', '1'};
+constexpr uint32_t MAX_REQUEST_IDS = 1u << 20;
+constexpr size_t WIRE_EDGE_BYTES = 16 + 8 + 8 + 4;
+
+bool write_all(int fd, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t len) {
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        ssize_t n = ::recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+template <typename T>
+void append(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+T load(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+} // namespace
+
+// =============================================================================
+//  Client
+// =============================================================================
+
+GraphShardClient::GraphShardClient(std::string host, uint16_t port) : host_(std::move(host)), port_(port) {}
+
+GraphShardClient::~GraphShardClient() { close_locked(); }
+
+void GraphShardClient::close_locked() noexcept {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+void GraphShardClient::connect_locked() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    const std::string service = std::to_string(port_);
+    if (int rc = ::getaddrinfo(host_.c_str(), service.c_str(), &hints, &found); rc != 0) {
+        throw std::runtime_error("Graph shard " + host_ + ":" + service + ": " + ::gai_strerror(rc));
+    }
+    int fd = -1;
+    for (addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+        fd = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(found);
+    if (fd < 0) throw std::runtime_error("Graph shard " + host_ + ":" + service + " unreachable");
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd_ = fd;
+}
+
+std::vector<GraphShardClient::Row> GraphShardClient::fetch(std::span<const BLAKE3Pipeline::Hash> ids) {
+    if (ids.size() > MAX_REQUEST_IDS) throw std::invalid_argument("Graph shard request too large");
+    HARTONOMOUS_SPAN("graph_shard_fetch");
+
+    std::string request;
+    request.reserve(8 + ids.size() * sizeof(BLAKE3Pipeline::Hash));
+    request.append(SHARD_MAGIC, 4);
+    append(request, static_cast<uint32_t>(ids.size()));
+    for (const auto& id : ids) request.append(reinterpret_cast<const char*>(id.data()), id.size());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A connection dropped while idle is only noticed on use: retry once on a fresh one
+    for (int attempt = 0;; ++attempt) {
+        if (fd_ < 0) connect_locked();
+        std::vector<Row> rows(ids.size());
+        bool ok = write_all(fd_, request.data(), request.size());
+        std::vector<char> edges;
+        for (size_t i = 0; ok && i < ids.size(); ++i) {
+            uint32_t degree = 0;
+            ok = read_all(fd_, &degree, 4);
+            if (!ok) break;
+            edges.resize(static_cast<size_t>(degree) * WIRE_EDGE_BYTES);
+            ok = read_all(fd_, edges.data(), edges.size());
+            rows[i].reserve(degree);
+            for (uint32_t e = 0; ok && e < degree; ++e) {
+                const char* p = edges.data() + e * WIRE_EDGE_BYTES;
+                RelationGraph::EdgeRecord r{};
+                r.source = ids[i];
+                std::memcpy(r.target.data(), p, 16);
+                r.max_elo = load<double>(p + 16);
+                r.total_obs = load<double>(p + 24);
+                r.relation_count = load<uint32_t>(p + 32);
+                rows[i].push_back(r);
+            }
+        }
+        if (ok) return rows;
+        close_locked();
+        if (attempt > 0) throw std::runtime_error("Graph shard " + host_ + ":" + std::to_string(port_) + " dropped a request");
+    }
+}
+
+// =============================================================================
+//  Server
+// =============================================================================
+
+GraphShardServer::GraphShardServer(std::shared_ptr<const RelationGraph> graph, uint16_t port,
+                                   const std::string& bind_address)
+    : graph_(std::move(graph)) {
+    if (!graph_) throw std::invalid_argument("GraphShardServer needs a graph");
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) throw std::runtime_error("GraphShardServer: socket() failed");
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 128) != 0) {
+        ::close(listen_fd_);
+        throw std::runtime_error("GraphShardServer: cannot listen on " + bind_address + ":" + std::to_string(port));
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    acceptor_ = std::thread([this] { accept_loop(); });
+}
+
+GraphShardServer::~GraphShardServer() {
+    stopping_.store(true, std::memory_order_release);
+    ::shutdown(listen_fd_, SHUT_RDWR);   // Wakes accept()
+    acceptor_.join();
+    ::close(listen_fd_);
+
+    std::unordered_map<uint64_t, Connection> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [id, c] : connections_) {
+            if (c.fd >= 0) ::shutdown(c.fd, SHUT_RDWR);   // Wakes recv()
+        }
+        connections.swap(connections_);
+    }
+    for (auto& [id, c] : connections) c.thread.join();
+}
+
+void GraphShardServer::accept_loop() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::vector<std::thread> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_.load(std::memory_order_acquire)) {
+                ::close(fd);
+                break;
+            }
+            for (uint64_t id : finished_) {
+                auto it = connections_.find(id);
+                done.push_back(std::move(it->second.thread));
+                connections_.erase(it);
+            }
+            finished_.clear();
+            const uint64_t id = next_connection_++;
+            connections_.emplace(id, Connection{fd, std::thread([this, id, fd] { serve(id, fd); })});
+        }
+        for (auto& t : done) t.join();
+    }
+}
+
+void GraphShardServer::serve(uint64_t id, int fd) {
+    std::vector<BLAKE3Pipeline::Hash> ids;
+    std::vector<RelationGraph::Edge> scratch;
+    std::string reply;
+    for (;;) {
+        char header[8];
+        if (!read_all(fd, header, sizeof(header)) || std::memcmp(header, SHARD_MAGIC, 4) != 0) break;
+        const uint32_t count = load<uint32_t>(header + 4);
+        if (count > MAX_REQUEST_IDS) break;
+        ids.resize(count);
+        if (!read_all(fd, ids.data(), count * sizeof(BLAKE3Pipeline::Hash))) break;
+
+        reply.clear();
+        for (const auto& source : ids) {
+            const auto row = graph_->neighbors(graph_->index_of(source), scratch);
+            append(reply, static_cast<uint32_t>(row.size()));
+            for (const auto& e : row) {
+                const auto& target = graph_->id_of(e.target);
+                reply.append(reinterpret_cast<const char*>(target.data()), target.size());
+                append(reply, e.max_elo);
+                append(reply, e.total_obs);
+                append(reply, e.relation_count);
+            }
+        }
+        rows_served_.fetch_add(count, std::memory_order_relaxed);
+        HARTONOMOUS_COUNT("hartonomous_graph_shard_rows_served_total", count);
+        if (!write_all(fd, reply.data(), reply.size())) break;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ::close(fd);
+    if (auto it = connections_.find(id); it != connections_.end()) {
+        it->second.fd = -1;
+        finished_.push_back(id);
+    }
+}
+
+// =============================================================================
+//  Shard map
+// =============================================================================
+
+GraphShards::Options GraphShards::Options::from_env() {
+    Options opts;
+    if (const char* s = std::getenv("HARTONOMOUS_GRAPH_SHARDS")) {
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, ';')) {
+            item.erase(0, item.find_first_not_of(" \t"));
+            item.erase(item.find_last_not_of(" \t") + 1);
+            if (item.empty()) continue;
+            const size_t colon = item.rfind(':');
+            if (colon == std::string::npos) throw std::runtime_error("HARTONOMOUS_GRAPH_SHARDS entry without a port: " + item);
+            opts.shards.push_back({item.substr(0, colon),
+                                   static_cast<uint16_t>(std::strtoul(item.c_str() + colon + 1, nullptr, 10))});
+        }
+    }
+    if (const char* s = std::getenv("HARTONOMOUS_GRAPH_SHARD_SELF")) {
+        opts.self = static_cast<uint32_t>(std::strtoul(s, nullptr, 10));
+    }
+    return opts;
+}
+
+std::shared_ptr<const RelationGraph> GraphShards::partition(const RelationGraph& graph, uint32_t count, uint32_t shard) {
+    if (count == 0 || shard >= count) throw std::invalid_argument("GraphShards::partition: shard out of range");
+    std::vector<RelationGraph::EdgeRecord> edges;
+    std::vector<RelationGraph::Edge> scratch;
+    for (uint32_t i = 0; i < graph.node_count(); ++i) {
+        const auto& source = graph.id_of(i);
+        if (owner_of(source, count) != shard) continue;
+        const auto row = graph.neighbors(i, scratch);
+        const auto masks = graph.tenant_masks(i);
+        for (size_t k = 0; k < row.size(); ++k) {
+            const auto& e = row[k];
+            edges.push_back({source, graph.id_of(e.target), e.max_elo, e.total_obs, e.relation_count,
+                             masks.empty() ? RelationGraph::ALL_TENANTS : masks[k]});
+        }
+    }
+    return RelationGraph::from_edges(std::move(edges),
+                                     graph.fingerprint() + "|shard " + std::to_string(shard) + "/" + std::to_string(count),
+                                     graph.has_tenant_masks() ? graph.tenants() : std::vector<BLAKE3Pipeline::Hash>{});
+}
+
+GraphShards::GraphShards(Options opts) : opts_(std::move(opts)) {
+    if (!opts_.shards.empty() && opts_.self >= opts_.shards.size()) {
+        throw std::invalid_argument("GraphShards: self " + std::to_string(opts_.self) + " out of " +
+                                    std::to_string(opts_.shards.size()) + " shards");
+    }
+    clients_.resize(opts_.shards.size());
+    for (size_t i = 0; i < opts_.shards.size(); ++i) {
+        if (i != opts_.self) clients_[i] = std::make_unique<GraphShardClient>(opts_.shards[i].host, opts_.shards[i].port);
+    }
+}
+
+NeighborCache::List GraphShards::store(const Hash& id, const GraphShardClient::Row& row) {
+    auto& interner = CompositionInterner::global();
+    std::vector<NeighborCache::Neighbor> list;
+    list.reserve(row.size());
+    for (const auto& e : row) list.push_back({interner.intern(e.target), e.relation_count, e.max_elo, e.total_obs});
+
+    if (row.size() > RelationGraph::HUB_DEGREE) {
+        auto shared = std::make_shared<const std::vector<NeighborCache::Neighbor>>(std::move(list));
+        std::lock_guard<std::mutex> lock(hubs_mutex_);
+        return hubs_.try_emplace(id, std::move(shared)).first->second;
+    }
+    auto shared = std::make_shared<const std::vector<NeighborCache::Neighbor>>(list);
+    NeighborCache::global().put(id, std::move(list));
+    return shared;
+}
+
+NeighborCache::List GraphShards::cached(const Hash& id) {
+    {
+        std::lock_guard<std::mutex> lock(hubs_mutex_);
+        if (auto it = hubs_.find(id); it != hubs_.end()) {
+            hub_hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    return NeighborCache::global().find(id);
+}
+
+NeighborCache::List GraphShards::neighbors(const Hash& id) {
+    if (auto list = cached(id)) return list;
+    const uint32_t shard = owner(id);
+    if (shard >= clients_.size() || !clients_[shard]) return std::make_shared<const std::vector<NeighborCache::Neighbor>>();
+    auto rows = clients_[shard]->fetch(std::span<const Hash>(&id, 1));
+    remote_requests_.fetch_add(1, std::memory_order_relaxed);
+    remote_rows_.fetch_add(1, std::memory_order_relaxed);
+    return store(id, rows[0]);
+}
+
+void GraphShards::prefetch(const std::vector<Hash>& ids) {
+    std::vector<std::vector<Hash>> by_shard(clients_.size());
+    for (const auto& id : ids) {
+        const uint32_t shard = owner(id);
+        if (shard >= clients_.size() || !clients_[shard]) continue;
+        {
+            std::lock_guard<std::mutex> lock(hubs_mutex_);
+            if (hubs_.count(id)) continue;
+        }
+        if (NeighborCache::global().contains(id)) continue;
+        auto& pending = by_shard[shard];
+        if (std::find(pending.begin(), pending.end(), id) == pending.end()) pending.push_back(id);
+    }
+
+    std::vector<std::future<void>> requests;
+    for (size_t shard = 0; shard < by_shard.size(); ++shard) {
+        if (by_shard[shard].empty()) continue;
+        requests.push_back(std::async(std::launch::async, [this, shard, &by_shard] {
+            const auto& wanted = by_shard[shard];
+            auto rows = clients_[shard]->fetch(wanted);
+            remote_requests_.fetch_add(1, std::memory_order_relaxed);
+            remote_rows_.fetch_add(rows.size(), std::memory_order_relaxed);
+            for (size_t i = 0; i < wanted.size(); ++i) store(wanted[i], rows[i]);
+        }));
+    }
+    for (auto& r : requests) r.get();
+}
+
+GraphShards::Stats GraphShards::stats() const {
+    Stats s;
+    s.remote_requests = remote_requests_.load(std::memory_order_relaxed);
+    s.remote_rows = remote_rows_.load(std::memory_order_relaxed);
+    s.hub_hits = hub_hits_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(hubs_mutex_);
+    s.hub_rows = hubs_.size();
+    return s;
+}
+
+} // namespace Hartonomous
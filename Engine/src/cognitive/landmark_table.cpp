@@ -0,0 +1,238 @@
+/**
+ * @file landmark_table.cpp
+ * @brief Landmark selection, Dijkstra preprocessing and table files
+ */
+
+#include <cognitive/landmark_table.hpp>
+#include <cognitive/astar_search.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+// File layout: fixed header, fingerprint bytes, landmark indices (4 B each),
+// ids (16 B/node), distances (4 B per node and landmark). The checksum is
+// BLAKE3 over everything after the header.
+static constexpr char LANDMARK_MAGIC[8] = {'H', 'L', 'N', 'D', 'M', 'R', 'K', '1'};
+static constexpr uint32_t LANDMARK_VERSION = 1;
+static constexpr size_t LANDMARK_HEADER_BYTES = 64;
+
+struct LandmarkHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fingerprint_len;
+    uint64_t node_count;
+    uint64_t landmark_count;
+    uint64_t file_size;
+    uint8_t checksum[16];
+};
+static_assert(sizeof(LandmarkHeader) <= LANDMARK_HEADER_BYTES);
+
+static size_t landmark_file_size(size_t fp_len, size_t nodes, size_t landmarks) {
+    return LANDMARK_HEADER_BYTES + fp_len + landmarks * sizeof(uint32_t) +
+           nodes * sizeof(BLAKE3Pipeline::Hash) + nodes * landmarks * sizeof(float);
+}
+
+// Shortest-path cost from `source` to every node under AStarSearch::edge_cost
+static void dijkstra(const RelationGraph& graph, uint32_t source, std::vector<double>& dist) {
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::fill(dist.begin(), dist.end(), std::numeric_limits<double>::infinity());
+    dist[source] = 0.0;
+    open.push({0.0, source});
+    while (!open.empty()) {
+        auto [d, node] = open.top();
+        open.pop();
+        if (d > dist[node]) continue;
+        for (const auto& e : graph.neighbors(node)) {
+            double nd = d + AStarSearch::edge_cost(e.max_elo, e.total_obs);
+            if (nd < dist[e.target]) {
+                dist[e.target] = nd;
+                open.push({nd, e.target});
+            }
+        }
+    }
+}
+
+std::string LandmarkTable::table_fingerprint(const RelationGraph& graph, const Options& options) {
+    if (graph.fingerprint().empty()) return "";
+    return graph.fingerprint() + ";landmarks=" + std::to_string(options.count);
+}
+
+std::shared_ptr<const LandmarkTable> LandmarkTable::build(const RelationGraph& graph, const Options& options) {
+    std::shared_ptr<LandmarkTable> t(new LandmarkTable());
+    t->fingerprint_ = table_fingerprint(graph, options);
+    const size_t n = graph.node_count();
+    t->ids_.resize(n);
+    for (size_t i = 0; i < n; ++i) t->ids_[i] = graph.id_of(static_cast<uint32_t>(i));
+    if (n == 0 || options.count == 0) return t;
+
+    // The hub is almost surely in the giant component, so landmarks are too
+    uint32_t hub = 0;
+    for (uint32_t i = 1; i < n; ++i)
+        if (graph.neighbors(i).size() > graph.neighbors(hub).size()) hub = i;
+
+    std::vector<double> dist(n);
+    dijkstra(graph, hub, dist);
+    std::vector<double> nearest = dist;  // To the hub or any landmark so far
+    std::vector<std::vector<float>> rows;
+
+    while (t->landmarks_.size() < std::min(options.count, n)) {
+        // Farthest reachable node from everything chosen so far
+        uint32_t next = NPOS;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (!std::isfinite(nearest[i])) continue;
+            if (next == NPOS || nearest[i] > nearest[next]) next = i;
+        }
+        if (next == NPOS || (nearest[next] == 0.0 && !t->landmarks_.empty())) break;
+
+        dijkstra(graph, next, dist);
+        t->landmarks_.push_back(next);
+        rows.emplace_back(dist.begin(), dist.end());
+        for (size_t i = 0; i < n; ++i) nearest[i] = std::min(nearest[i], dist[i]);
+    }
+
+    const size_t k = t->landmarks_.size();
+    t->dist_.resize(n * k);
+    for (size_t l = 0; l < k; ++l)
+        for (size_t i = 0; i < n; ++i) t->dist_[i * k + l] = rows[l][i];
+    return t;
+}
+
+double LandmarkTable::lower_bound(const float* a, const float* b, size_t landmarks) {
+    double best = 0.0;
+    for (size_t l = 0; l < landmarks; ++l) {
+        bool fa = std::isfinite(a[l]), fb = std::isfinite(b[l]);
+        if (fa != fb) return std::numeric_limits<double>::infinity();
+        // Each stored float is within half an ulp (2^-24 relative) of the true distance
+        if (fa) best = std::max(best, std::abs(static_cast<double>(a[l]) - b[l]) - 1.2e-7 * (double(a[l]) + b[l]));
+    }
+    return best;
+}
+
+std::string LandmarkTable::default_path() {
+    if (const char* p = std::getenv("HARTONOMOUS_LANDMARKS")) return p;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/landmarks.bin";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/landmarks.bin";
+    return "";
+}
+
+void LandmarkTable::write_file(const std::string& path) const {
+    LandmarkHeader hdr{};
+    std::memcpy(hdr.magic, LANDMARK_MAGIC, 8);
+    hdr.version = LANDMARK_VERSION;
+    hdr.fingerprint_len = static_cast<uint32_t>(fingerprint_.size());
+    hdr.node_count = ids_.size();
+    hdr.landmark_count = landmarks_.size();
+    hdr.file_size = landmark_file_size(fingerprint_.size(), ids_.size(), landmarks_.size());
+
+    std::vector<uint8_t> buf(hdr.file_size, 0);
+    uint8_t* p = buf.data() + LANDMARK_HEADER_BYTES;
+    std::memcpy(p, fingerprint_.data(), fingerprint_.size());
+    p += fingerprint_.size();
+    std::memcpy(p, landmarks_.data(), landmarks_.size() * sizeof(uint32_t));
+    p += landmarks_.size() * sizeof(uint32_t);
+    std::memcpy(p, ids_.data(), ids_.size() * sizeof(Hash));
+    p += ids_.size() * sizeof(Hash);
+    std::memcpy(p, dist_.data(), dist_.size() * sizeof(float));
+    auto sum = BLAKE3Pipeline::hash(buf.data() + LANDMARK_HEADER_BYTES, buf.size() - LANDMARK_HEADER_BYTES);
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path());
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) throw std::runtime_error("Failed to create landmark table: " + tmp);
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to write landmark table: " + path);
+    }
+}
+
+std::shared_ptr<const LandmarkTable> LandmarkTable::load_file(const std::string& path, const std::string& fingerprint) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return nullptr;
+    std::vector<uint8_t> buf;
+    if (std::fseek(f, 0, SEEK_END) == 0) {
+        long size = std::ftell(f);
+        if (size >= static_cast<long>(LANDMARK_HEADER_BYTES)) {
+            buf.resize(static_cast<size_t>(size));
+            std::rewind(f);
+            if (std::fread(buf.data(), 1, buf.size(), f) != buf.size()) buf.clear();
+        }
+    }
+    std::fclose(f);
+    if (buf.empty()) return nullptr;
+
+    LandmarkHeader hdr;
+    std::memcpy(&hdr, buf.data(), sizeof(hdr));
+    bool ok = std::memcmp(hdr.magic, LANDMARK_MAGIC, 8) == 0 &&
+              hdr.version == LANDMARK_VERSION &&
+              hdr.file_size == buf.size() &&
+              hdr.node_count < NPOS &&
+              hdr.landmark_count <= hdr.node_count &&
+              landmark_file_size(hdr.fingerprint_len, hdr.node_count, hdr.landmark_count) == buf.size();
+    const uint8_t* p = buf.data() + LANDMARK_HEADER_BYTES;
+    std::string stored_fp;
+    if (ok) {
+        stored_fp.assign(reinterpret_cast<const char*>(p), hdr.fingerprint_len);
+        ok = fingerprint.empty() || stored_fp == fingerprint;
+    }
+    if (ok) {
+        auto sum = BLAKE3Pipeline::hash(p, buf.size() - LANDMARK_HEADER_BYTES);
+        ok = std::memcmp(sum.data(), hdr.checksum, 16) == 0;
+    }
+    if (!ok) return nullptr;
+
+    std::shared_ptr<LandmarkTable> t(new LandmarkTable());
+    t->fingerprint_ = std::move(stored_fp);
+    p += hdr.fingerprint_len;
+    t->landmarks_.resize(hdr.landmark_count);
+    std::memcpy(t->landmarks_.data(), p, t->landmarks_.size() * sizeof(uint32_t));
+    p += t->landmarks_.size() * sizeof(uint32_t);
+    t->ids_.resize(hdr.node_count);
+    std::memcpy(t->ids_.data(), p, t->ids_.size() * sizeof(Hash));
+    p += t->ids_.size() * sizeof(Hash);
+    t->dist_.resize(hdr.node_count * hdr.landmark_count);
+    std::memcpy(t->dist_.data(), p, t->dist_.size() * sizeof(float));
+
+    for (uint32_t l : t->landmarks_)
+        if (l >= hdr.node_count) return nullptr;
+    return t;
+}
+
+std::shared_ptr<const LandmarkTable> LandmarkTable::load(const RelationGraph& graph, const std::string& path,
+                                                         const Options& options) {
+    // A graph without a fingerprint cannot be matched to a file
+    const std::string fp = table_fingerprint(graph, options);
+    const bool cacheable = !path.empty() && !fp.empty();
+    if (cacheable) {
+        auto t = load_file(path, fp);
+        if (t && t->node_count() == graph.node_count()) return t;
+    }
+    auto t = build(graph, options);
+    if (cacheable) {
+        // A cache that cannot be written is not fatal; the table is still usable
+        try {
+            t->write_file(path);
+        } catch (const std::exception& e) {
+            std::cerr << "[LandmarkTable] " << e.what() << std::endl;
+        }
+    }
+    return t;
+}
+
+} // namespace Hartonomous
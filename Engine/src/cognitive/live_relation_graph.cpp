@@ -0,0 +1,187 @@
+/**
+ * @file live_relation_graph.cpp
+ * @brief Delta refresh, compaction and epoch publication for RelationGraph
+ */
+
+#include <cognitive/live_relation_graph.hpp>
+#include <utils/substrate_epoch.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+namespace Hartonomous {
+
+LiveRelationGraph::Options LiveRelationGraph::Options::from_env() {
+    Options o;
+    if (const char* v = std::getenv("HARTONOMOUS_GRAPH_REFRESH_MS"))
+        o.refresh_interval = std::chrono::milliseconds(std::max(100L, std::strtol(v, nullptr, 10)));
+    if (const char* v = std::getenv("HARTONOMOUS_GRAPH_OVERLAP_S"))
+        o.overlap = std::chrono::seconds(std::max(0L, std::strtol(v, nullptr, 10)));
+    if (const char* v = std::getenv("HARTONOMOUS_GRAPH_COMPACT_RATIO"))
+        o.compact_ratio = std::strtod(v, nullptr);
+    if (const char* v = std::getenv("HARTONOMOUS_GRAPH_TENANTS"))
+        o.tenants = std::strtol(v, nullptr, 10) != 0;
+    return o;
+}
+
+LiveRelationGraph::LiveRelationGraph(ConnectionPool& pool, Options opts)
+    : pool_(pool), opts_(std::move(opts)) {
+    rebuild();
+}
+
+LiveRelationGraph::~LiveRelationGraph() { stop(); }
+
+std::string LiveRelationGraph::read_watermark(PostgresConnection& db, const std::string& since) {
+    std::string floor = since.empty() ? "'-infinity'::timestamptz" : "'" + since + "'::timestamptz";
+    auto mark = db.query_single("SELECT COALESCE(max(modifiedat), " + floor + ")::text "
+                                "FROM hartonomous.relationrating WHERE modifiedat >= " + floor);
+    return mark.value_or(since);
+}
+
+void LiveRelationGraph::publish(std::shared_ptr<const RelationGraph> graph,
+                                const std::vector<RelationGraph::EdgeRecord>* rows) {
+    // Built before the swap, off the read path; only the refresh thread writes replicas_
+    std::vector<std::shared_ptr<const RelationGraph>> replicas;
+    if (replicating_) {
+        std::vector<std::shared_ptr<const RelationGraph>> previous;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            previous = replicas_;
+        }
+        const bool layer = rows && graph->overlay_rows() > 0 && previous.size() == numa_node_count();
+        replicas.resize(numa_node_count());
+        for (size_t node = 0; node < replicas.size(); ++node) {
+            replicas[node] = run_on_node(node, [&]() -> std::shared_ptr<const RelationGraph> {
+                return layer ? RelationGraph::with_rows(previous[node], *rows) : graph->replicate();
+            });
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_ = std::move(graph);
+        replicas_ = std::move(replicas);
+        stats_.replicas = replicas_.size();
+        stats_.epoch++;
+        stats_.overlay_rows = current_->overlay_rows();
+        stats_.overlay_edges = current_->overlay_edges();
+    }
+    SubstrateEpoch::advance();
+}
+
+void LiveRelationGraph::rebuild() {
+    std::lock_guard<std::mutex> lock(refresh_mutex_);
+    auto lease = pool_.acquire();
+
+    // Taken before the load: anything stamped later is re-applied by refresh()
+    std::string mark = read_watermark(*lease, "");
+    publish(RelationGraph::load(*lease, opts_.cache_path, opts_.tenants));
+    watermark_ = mark;
+}
+
+size_t LiveRelationGraph::refresh() {
+    std::lock_guard<std::mutex> lock(refresh_mutex_);
+    auto lease = pool_.acquire();
+    PostgresConnection& db = *lease;
+
+    // Masks, when the snapshot has them, use its tenant slots
+    std::shared_ptr<const RelationGraph> base;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        base = current_;
+    }
+    const bool masks = base->has_tenant_masks();
+    const std::string tenant_column = masks ? ",\n                   bit_or(COALESCE(rt.tenants, 0))::int8" : "";
+    const std::string tenant_join = masks
+        ? "LEFT JOIN (" + RelationGraph::relation_tenants_sql(base->tenants()) + ") rt ON rt.relationid = rs1.relationid"
+        : "";
+
+    // Watermark and delta from one snapshot, so neither sees rows the other missed
+    std::string next;
+    std::vector<RelationGraph::EdgeRecord> rows;
+    db.execute("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+    try {
+        next = read_watermark(db, watermark_);
+        rows = RelationGraph::copy_edges(db, R"(
+            WITH changed AS (
+                SELECT relationid FROM hartonomous.relationrating
+                WHERE modifiedat >= ')" + watermark_ + "'::timestamptz - interval '" +
+                std::to_string(opts_.overlap.count()) + R"( seconds'
+            ),
+            sources AS (
+                SELECT DISTINCT rs.compositionid
+                FROM hartonomous.relationsequence rs
+                JOIN changed c ON c.relationid = rs.relationid
+            )
+            SELECT rs1.compositionid, rs2.compositionid,
+                   max(rr.ratingvalue)::float8,
+                   sum(uint64_to_double(rr.observations))::float8,
+                   count(*)::int8)" + tenant_column + R"(
+            FROM sources s
+            JOIN hartonomous.relationsequence rs1 ON rs1.compositionid = s.compositionid
+            JOIN hartonomous.relationsequence rs2
+                ON rs2.relationid = rs1.relationid
+                AND rs2.compositionid != rs1.compositionid
+            JOIN hartonomous.relationrating rr
+                ON rr.relationid = rs1.relationid
+            )" + tenant_join + R"(
+            GROUP BY rs1.compositionid, rs2.compositionid
+        )");
+        db.commit();
+    } catch (...) {
+        db.rollback();
+        throw;
+    }
+
+    bool compacted = false;
+    if (!rows.empty()) {
+        auto graph = RelationGraph::with_rows(base, rows);
+        if (graph->overlay_edges() >= opts_.compact_min_edges &&
+            graph->overlay_edges() > opts_.compact_ratio * static_cast<double>(graph->edge_count())) {
+            graph = graph->compact();
+            compacted = true;
+        }
+        publish(std::move(graph), compacted ? nullptr : &rows);
+    }
+    watermark_ = next;
+
+    std::lock_guard<std::mutex> stats_lock(mutex_);
+    stats_.refreshes++;
+    stats_.last_delta_edges = rows.size();
+    if (compacted) stats_.compactions++;
+    return rows.size();
+}
+
+void LiveRelationGraph::start() {
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lk(thread_mutex_);
+        while (!thread_cv_.wait_for(lk, opts_.refresh_interval, [this] { return stopping_; })) {
+            lk.unlock();
+            try {
+                refresh();
+            } catch (const std::exception& e) {
+                std::cerr << "[LiveRelationGraph] refresh failed: " << e.what() << std::endl;
+            }
+            lk.lock();
+        }
+    });
+}
+
+void LiveRelationGraph::stop() {
+    {
+        std::lock_guard<std::mutex> lock(thread_mutex_);
+        stopping_ = true;
+    }
+    thread_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+LiveRelationGraph::Stats LiveRelationGraph::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,297 @@
+/**
+ * @file neighbor_cache.cpp
+ * @brief Sharded LRU of aggregated relation neighbors
+ */
+
+#include <cognitive/neighbor_cache.hpp>
+#include <hashing/composition_interner.hpp>
+#include <storage/composition_adjacency.hpp>
+#include <utils/substrate_epoch.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace Hartonomous {
+
+static constexpr size_t DEFAULT_MAX_NEIGHBORS = size_t(4) << 20;
+
+NeighborCache::NeighborCache(size_t max_neighbors)
+    : shard_budget_(max_neighbors / SHARDS),
+      account_(MemoryGovernor::global().enroll("neighbor_cache", MemoryGovernor::Priority::Normal,
+                                               [this](size_t bytes) { trim(bytes); })) {}
+
+NeighborCache& NeighborCache::global() {
+    static NeighborCache cache([] {
+        if (const char* s = std::getenv("HARTONOMOUS_NEIGHBOR_CACHE"))
+            return static_cast<size_t>(std::strtoull(s, nullptr, 10));
+        return DEFAULT_MAX_NEIGHBORS;
+    }());
+    return cache;
+}
+
+// Whether the hartonomous extension's neighbors() is installed; checked once per process
+static bool server_neighbors(PostgresConnection& db) {
+    static std::atomic<int> state{-1};
+    int s = state.load(std::memory_order_relaxed);
+    if (s < 0) {
+        s = 0;
+        db.query("SELECT to_regprocedure('neighbors(uuid[],float8,float8,int4)') IS NOT NULL",
+                 [&](const std::vector<std::string>& row) { s = row[0] == "t"; });
+        state.store(s, std::memory_order_relaxed);
+    }
+    return s != 0;
+}
+
+std::vector<NeighborCache::Neighbor> NeighborCache::load(PostgresConnection& db, const Hash& id) {
+    auto& interner = CompositionInterner::global();
+    std::vector<Neighbor> out;
+
+    if (server_neighbors(db)) {
+        // Already one row per neighbor
+        const auto& stmt = db.prepare("neighbor_cache_load_server",
+            "SELECT neighbor, max_elo, total_obs, relation_count FROM neighbors($1)", {PgType::Uuid});
+        PgResult rows = db.execute_prepared(stmt, {PgParam::uuid(id)});
+        out.reserve(rows.size());
+        for (int i = 0; i < rows.size(); ++i) {
+            auto row = rows[i];
+            out.push_back({interner.intern(row.get_uuid(0)), static_cast<uint32_t>(row.get_int4(3)),
+                           row.get_float8(1), row.get_float8(2)});
+        }
+        return out;
+    }
+
+    // One index range scan when the adjacency table is maintained
+    const auto& stmt = CompositionAdjacency::enabled(db)
+        ? db.prepare("neighbor_cache_load_adjacency", R"(
+            SELECT neighborid, ratingvalue::float8, uint64_to_double(observations)::float8
+            FROM hartonomous.compositionadjacency
+            WHERE compositionid = $1
+        )", {PgType::Uuid})
+        : db.prepare("neighbor_cache_load", R"(
+            SELECT
+                rs2.compositionid,
+                rr.ratingvalue::float8,
+                uint64_to_double(rr.observations)::float8
+            FROM hartonomous.relationsequence rs1
+            JOIN hartonomous.relationsequence rs2
+                ON rs2.relationid = rs1.relationid
+                AND rs2.compositionid != rs1.compositionid
+            JOIN hartonomous.relationrating rr
+                ON rr.relationid = rs1.relationid
+            WHERE rs1.compositionid = $1
+        )", {PgType::Uuid});
+
+    // Same composition may appear via multiple relations: max ELO, sum observations
+    std::unordered_map<uint32_t, size_t> slot;
+    PgResult rows = db.execute_prepared(stmt, {PgParam::uuid(id)});
+    for (int i = 0; i < rows.size(); ++i) {
+        auto row = rows[i];
+        uint32_t node = interner.intern(row.get_uuid(0));
+        auto [it, fresh] = slot.emplace(node, out.size());
+        if (fresh) out.push_back({node, 0, 0.0, 0.0});
+        auto& n = out[it->second];
+        n.max_elo = std::max(n.max_elo, row.get_float8(1));
+        n.total_obs += row.get_float8(2);
+        n.relation_count++;
+    }
+    return out;
+}
+
+std::vector<std::vector<NeighborCache::Neighbor>> NeighborCache::load(PostgresConnection& db,
+                                                                      const std::vector<Hash>& ids) {
+    std::vector<std::vector<Neighbor>> out(ids.size());
+    if (ids.empty()) return out;
+
+    std::unordered_map<Hash, size_t, HashHasher> index;
+    for (size_t i = 0; i < ids.size(); ++i) index.emplace(ids[i], i);
+    const std::string array = pg_uuid_array(ids);
+    const PgParam param = PgParam::bytes(array.data(), array.size());
+    auto& interner = CompositionInterner::global();
+
+    if (server_neighbors(db)) {
+        const auto& stmt = db.prepare("neighbor_cache_load_batch_server",
+            "SELECT composition, neighbor, max_elo, total_obs, relation_count FROM neighbors($1)",
+            {PgType::UuidArray});
+        PgResult rows = db.execute_prepared(stmt, {param});
+        for (int i = 0; i < rows.size(); ++i) {
+            auto row = rows[i];
+            out[index.at(row.get_uuid(0))].push_back({interner.intern(row.get_uuid(1)),
+                                                      static_cast<uint32_t>(row.get_int4(4)),
+                                                      row.get_float8(2), row.get_float8(3)});
+        }
+    } else {
+        const auto& stmt = CompositionAdjacency::enabled(db)
+            ? db.prepare("neighbor_cache_load_batch_adjacency", R"(
+                SELECT compositionid, neighborid, ratingvalue::float8, uint64_to_double(observations)::float8
+                FROM hartonomous.compositionadjacency
+                WHERE compositionid = ANY($1)
+            )", {PgType::UuidArray})
+            : db.prepare("neighbor_cache_load_batch", R"(
+                SELECT
+                    rs1.compositionid,
+                    rs2.compositionid,
+                    rr.ratingvalue::float8,
+                    uint64_to_double(rr.observations)::float8
+                FROM hartonomous.relationsequence rs1
+                JOIN hartonomous.relationsequence rs2
+                    ON rs2.relationid = rs1.relationid
+                    AND rs2.compositionid != rs1.compositionid
+                JOIN hartonomous.relationrating rr
+                    ON rr.relationid = rs1.relationid
+                WHERE rs1.compositionid = ANY($1)
+            )", {PgType::UuidArray});
+
+        std::vector<std::unordered_map<uint32_t, size_t>> slots(ids.size());
+        PgResult rows = db.execute_prepared(stmt, {param});
+        for (int i = 0; i < rows.size(); ++i) {
+            auto row = rows[i];
+            size_t src = index.at(row.get_uuid(0));
+            uint32_t node = interner.intern(row.get_uuid(1));
+            auto [it, fresh] = slots[src].emplace(node, out[src].size());
+            if (fresh) out[src].push_back({node, 0, 0.0, 0.0});
+            auto& n = out[src][it->second];
+            n.max_elo = std::max(n.max_elo, row.get_float8(2));
+            n.total_obs += row.get_float8(3);
+            n.relation_count++;
+        }
+    }
+
+    // Duplicate ids share the first one's list
+    for (size_t i = 0; i < ids.size(); ++i) {
+        size_t first = index.at(ids[i]);
+        if (first != i) out[i] = out[first];
+    }
+    return out;
+}
+
+NeighborCache::List NeighborCache::find(const Hash& id) {
+    Shard& s = shard_for(id);
+    {
+        std::lock_guard<std::mutex> lock(s.mu);
+        auto it = s.slots.find(id);
+        if (it != s.slots.end()) {
+            s.lru.splice(s.lru.begin(), s.lru, it->second.lru);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second.list;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+bool NeighborCache::contains(const Hash& id) const {
+    const Shard& s = shards_[HashHasher{}(id) >> (64 - SHARD_BITS)];
+    std::lock_guard<std::mutex> lock(s.mu);
+    return s.slots.count(id) > 0;
+}
+
+void NeighborCache::prefetch(PostgresConnection& db, const std::vector<Hash>& ids) {
+    std::vector<Hash> missing;
+    for (const auto& id : ids) {
+        Shard& s = shard_for(id);
+        std::lock_guard<std::mutex> lock(s.mu);
+        if (!s.slots.count(id)) missing.push_back(id);
+    }
+    if (missing.empty()) return;
+    misses_.fetch_add(missing.size(), std::memory_order_relaxed);
+
+    auto lists = load(db, missing);
+    for (size_t i = 0; i < missing.size(); ++i)
+        insert(missing[i], std::make_shared<const std::vector<Neighbor>>(std::move(lists[i])));
+}
+
+NeighborCache::List NeighborCache::neighbors(PostgresConnection& db, const Hash& id) {
+    if (auto list = find(id)) return list;
+
+    // Loaded outside the shard lock; concurrent misses on one key both load, last insert wins
+    return insert(id, std::make_shared<const std::vector<Neighbor>>(load(db, id)));
+}
+
+void NeighborCache::put(const Hash& id, std::vector<Neighbor> list) {
+    insert(id, std::make_shared<const std::vector<Neighbor>>(std::move(list)));
+}
+
+NeighborCache::List NeighborCache::insert(const Hash& id, List list) {
+    // A list past the shard's whole budget would only evict everything else
+    if (shard_budget_ == 0 || list->size() > shard_budget_) return list;
+
+    Shard& s = shard_for(id);
+    std::unique_lock<std::mutex> lock(s.mu);
+    auto it = s.slots.find(id);
+    if (it != s.slots.end()) erase_locked(s, it);
+    s.lru.push_front(id);
+    s.slots.emplace(id, Shard::Slot{list, s.lru.begin()});
+    s.neighbors += list->size();
+    bytes_.fetch_add(list_bytes(list->size()), std::memory_order_relaxed);
+    while (s.neighbors > shard_budget_) {
+        erase_locked(s, s.slots.find(s.lru.back()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    lock.unlock();
+    account_.update(memory_bytes());
+    return list;
+}
+
+void NeighborCache::trim(size_t bytes) {
+    // Each shard down to its share, oldest lists first
+    const size_t share = bytes / SHARDS;
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mu);
+        while (!s.lru.empty() && s.neighbors * sizeof(Neighbor) + s.slots.size() * LIST_OVERHEAD > share) {
+            erase_locked(s, s.slots.find(s.lru.back()));
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    account_.update(memory_bytes());
+}
+
+void NeighborCache::erase_locked(Shard& s, std::unordered_map<Hash, Shard::Slot, HashHasher>::iterator it) {
+    s.neighbors -= it->second.list->size();
+    bytes_.fetch_sub(list_bytes(it->second.list->size()), std::memory_order_relaxed);
+    s.lru.erase(it->second.lru);
+    s.slots.erase(it);
+}
+
+void NeighborCache::invalidate(const Hash& id) {
+    SubstrateEpoch::advance();
+    Shard& s = shard_for(id);
+    std::lock_guard<std::mutex> lock(s.mu);
+    auto it = s.slots.find(id);
+    if (it == s.slots.end()) return;
+    erase_locked(s, it);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+    account_.update(memory_bytes());
+}
+
+void NeighborCache::invalidate(const std::vector<Hash>& ids) {
+    for (const auto& id : ids) invalidate(id);
+}
+
+void NeighborCache::clear() {
+    SubstrateEpoch::advance();
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mu);
+        invalidations_.fetch_add(s.slots.size(), std::memory_order_relaxed);
+        bytes_.fetch_sub(s.neighbors * sizeof(Neighbor) + s.slots.size() * LIST_OVERHEAD, std::memory_order_relaxed);
+        s.slots.clear();
+        s.lru.clear();
+        s.neighbors = 0;
+    }
+    account_.update(memory_bytes());
+}
+
+NeighborCache::Stats NeighborCache::stats() const {
+    Stats st;
+    st.hits = hits_.load(std::memory_order_relaxed);
+    st.misses = misses_.load(std::memory_order_relaxed);
+    st.evictions = evictions_.load(std::memory_order_relaxed);
+    st.invalidations = invalidations_.load(std::memory_order_relaxed);
+    for (const auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mu);
+        st.lists += s.slots.size();
+        st.neighbors += s.neighbors;
+    }
+    return st;
+}
+
+} // namespace Hartonomous
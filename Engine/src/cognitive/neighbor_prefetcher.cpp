@@ -0,0 +1,96 @@
+/**
+ * @file neighbor_prefetcher.cpp
+ * @brief Bounded speculative queue feeding NeighborCache from a worker connection
+ */
+
+#include <cognitive/neighbor_prefetcher.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+namespace Hartonomous {
+
+static constexpr size_t DEFAULT_PREFETCH_WIDTH = 4;
+static constexpr size_t MAX_BATCH = 16;  // Ids per round trip
+
+size_t NeighborPrefetcher::width_from_env() {
+    if (const char* v = std::getenv("HARTONOMOUS_WALK_PREFETCH"))
+        return static_cast<size_t>(std::strtoull(v, nullptr, 10));
+    return DEFAULT_PREFETCH_WIDTH;
+}
+
+NeighborPrefetcher::NeighborPrefetcher(std::string conninfo, size_t max_queued)
+    : conninfo_(std::move(conninfo)), max_queued_(std::max<size_t>(1, max_queued)) {
+    thread_ = std::thread([this] { run(); });
+}
+
+NeighborPrefetcher::~NeighborPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void NeighborPrefetcher::enqueue(const std::vector<Hash>& ids) {
+    auto& cache = NeighborCache::global();
+    bool added = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& id : ids) {
+            if (queued_.count(id) || in_flight_.count(id)) continue;
+            if (cache.contains(id)) continue;
+            if (queue_.size() >= max_queued_) {
+                queued_.erase(queue_.front());  // Oldest guess is the least likely to matter
+                queue_.pop_front();
+            }
+            queue_.push_back(id);
+            queued_.insert(id);
+            added = true;
+        }
+    }
+    if (added) work_cv_.notify_one();
+}
+
+void NeighborPrefetcher::claim(const Hash& id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queued_.erase(id)) {
+        queue_.erase(std::find(queue_.begin(), queue_.end(), id));
+        return;
+    }
+    done_cv_.wait(lock, [&] { return !in_flight_.count(id); });
+}
+
+void NeighborPrefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        std::vector<Hash> batch;
+        while (!queue_.empty() && batch.size() < MAX_BATCH) {
+            batch.push_back(queue_.front());
+            queued_.erase(queue_.front());
+            in_flight_.insert(queue_.front());
+            queue_.pop_front();
+        }
+
+        lock.unlock();
+        try {
+            if (!db_) db_ = std::make_unique<PostgresConnection>(conninfo_);
+            NeighborCache::global().prefetch(*db_, batch);
+        } catch (const std::exception& e) {
+            std::cerr << "[NeighborPrefetcher] prefetch failed: " << e.what() << std::endl;
+            db_.reset();  // Reconnect on the next batch
+        }
+        lock.lock();
+
+        for (const auto& id : batch) in_flight_.erase(id);
+        done_cv_.notify_all();
+    }
+}
+
+} // namespace Hartonomous
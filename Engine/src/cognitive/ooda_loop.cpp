@@ -4,11 +4,21 @@
  */
 
 #include <cognitive/ooda_loop.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <database/bulk_copy.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <storage/composition_adjacency.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
 
 namespace Hartonomous {
 
-OODALoop::OODALoop(PostgresConnection& db) : db_(db) {}
+OODALoop::OODALoop(PostgresConnection& db, LiveRelationGraph* graph, ConnectionRouter* router)
+    : db_(db), graph_(graph), router_(router) {}
 
 void OODALoop::observe(const std::string& query, const std::string& result, int rating) {
     [[maybe_unused]] auto query_hash = BLAKE3Pipeline::hash(query);
@@ -37,38 +47,202 @@ void OODALoop::observe(const std::string& query, const std::string& result, int
 
 std::vector<EdgeUpdate> OODALoop::orient() {
     std::vector<EdgeUpdate> updates;
+    pending_.clear();
+    pending_through_.clear();
 
-    // Analyze RelationEvidence to calculate ELO deltas
-    std::string sql = R"(
-        SELECT 
-            relationid, 
-            AVG(CASE WHEN ispositive THEN strength ELSE -strength END) as avg_strength,
-            COUNT(*) as obs_count
-        FROM hartonomous.relationevidence
-        WHERE validatedat < NOW() - INTERVAL '1 hour'
-        GROUP BY relationid
-        HAVING COUNT(*) > 5
-    )";
+    // Evidence counts an hour after validation; each cycle takes what came due since the last
+    std::string since;
+    db_.query(
+        "SELECT COALESCE(w.validatedthrough, '-infinity'), NOW() - INTERVAL '1 hour' "
+        "FROM (SELECT 1) one LEFT JOIN hartonomous_internal.evidencewatermark w ON w.consumer = 'ooda'",
+        [&](const std::vector<std::string>& row) {
+            since = row[0];
+            pending_through_ = row[1];
+        });
+
+    // Only the new window is aggregated; the totals before it come from the summary
+    db_.query(R"(
+        SELECT f.relationid, f.obs_count, f.strength_sum,
+               COALESCE(s.observations, 0), COALESCE(s.strengthsum, 0), COALESCE(s.appliedelo, 0)
+        FROM (
+            SELECT relationid, COUNT(*) AS obs_count, SUM(2 * signalstrength - 1) AS strength_sum
+            FROM hartonomous.relationevidence
+            WHERE isvalid AND validatedat > $1::timestamptz AND validatedat <= $2::timestamptz
+            GROUP BY relationid
+        ) f
+        LEFT JOIN hartonomous_internal.evidencesummary s ON s.relationid = f.relationid
+    )", {since, pending_through_}, [&](const std::vector<std::string>& row) {
+        const int64_t n = std::stoll(row[1]);
+        const double strength = std::stod(row[2]);
+        pending_[BLAKE3Pipeline::from_hex(row[0])] = {n, strength};
 
-    db_.query(sql, [&](const std::vector<std::string>& row) {
-        EdgeUpdate update;
-        update.source_hash = row[0];
-        update.elo_delta = calculate_elo_delta(std::stod(row[1]), std::stoi(row[2]));
-        updates.push_back(update);
+        const int64_t total = std::stoll(row[3]) + n;
+        const double avg_strength = (std::stod(row[4]) + strength) / static_cast<double>(total);
+        const int target = total > 5 ? calculate_elo_delta(avg_strength, static_cast<int>(std::min<int64_t>(
+                                                              total, std::numeric_limits<int>::max())))
+                                     : 0;
+        const int64_t applied = std::stoll(row[5]);
+        if (target != applied) {
+            EdgeUpdate update;
+            update.source_hash = row[0];
+            update.elo_delta = static_cast<int>(target - applied);
+            update.reason = "evidence";
+            updates.push_back(std::move(update));
+        }
     });
 
     return updates;
 }
 
+std::vector<EdgeUpdate> OODALoop::decide(const std::vector<EdgeUpdate>& candidates) {
+    std::vector<EdgeUpdate> chosen;
+    chosen.reserve(candidates.size());
+    for (const auto& c : candidates)
+        if (c.elo_delta != 0) chosen.push_back(c);
+    return chosen;
+}
+
+// Session staging table for act(); typed after relationrating so the
+// observations domain need not be named
+static constexpr const char* RATING_DELTA_TABLE = "ooda_rating_delta";
+
+// Session staging table for the evidence totals act() commits
+static constexpr const char* EVIDENCE_DELTA_TABLE = "ooda_evidence_delta";
+
 void OODALoop::act(const std::vector<EdgeUpdate>& updates) {
+    // Sum per relation (UPDATE ... FROM applies one source row per target);
+    // the ordered map also gives the lock order
+    std::map<BLAKE3Pipeline::Hash, RatingDelta> deltas;
     for (const auto& update : updates) {
-        // Update the ACTUAL RelationRating table
-        db_.execute(
-            "UPDATE hartonomous.relationrating "
-            "SET ratingvalue = ratingvalue + $1, observations = observations + 1, modifiedat = NOW() "
-            "WHERE relationid = $2",
-            {std::to_string(update.elo_delta), update.source_hash}
-        );
+        auto& d = deltas[BLAKE3Pipeline::from_hex(update.source_hash)];
+        d.elo += update.elo_delta;
+        d.observations++;
+    }
+    if (deltas.empty() && pending_through_.empty()) return;
+
+    std::vector<BLAKE3Pipeline::Hash> touched;
+    {
+        PostgresConnection::Transaction txn(db_);
+        if (!deltas.empty()) apply_deltas(deltas, touched);
+        if (!pending_through_.empty()) commit_evidence(deltas);
+        txn.commit();
+    }
+    pending_.clear();
+    pending_through_.clear();
+    if (deltas.empty()) return;
+    if (router_) router_->note_write(ConnectionRouter::current_lsn(db_));
+
+    NeighborCache::global().invalidate(touched);
+    if (graph_) graph_->refresh();
+}
+
+void OODALoop::apply_deltas(const std::map<BLAKE3Pipeline::Hash, RatingDelta>& deltas,
+                            std::vector<BLAKE3Pipeline::Hash>& touched) {
+    if (!db_.has_staging_table(RATING_DELTA_TABLE)) {
+        db_.execute(std::string("CREATE TEMP TABLE IF NOT EXISTS ") + RATING_DELTA_TABLE +
+                    " ON COMMIT DELETE ROWS AS "
+                    "SELECT relationid, ratingvalue AS delta, observations "
+                    "FROM hartonomous.relationrating WITH NO DATA");
+        db_.add_staging_table(RATING_DELTA_TABLE);
+    }
+
+    BulkCopy copy(db_, CopyMode::TrustedUnique);
+    copy.set_binary(true);
+    copy.begin_table(std::string("pg_temp.") + RATING_DELTA_TABLE, {"relationid", "delta", "observations"});
+    using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Float8, pgcopy::UInt64>;
+    for (const auto& [id, d] : deltas) copy.write_row<Row>(id, d.elo, d.observations);
+    copy.flush();
+
+    // Lock first, in relation order, then apply; every member of an
+    // updated relation now has a stale cached neighbor list
+    db_.query(
+        std::string("WITH locked AS ("
+        "  SELECT r.relationid FROM hartonomous.relationrating r "
+        "  JOIN pg_temp.") + RATING_DELTA_TABLE + " d ON d.relationid = r.relationid "
+        "  ORDER BY r.relationid FOR UPDATE OF r), "
+        "u AS ("
+        "  UPDATE hartonomous.relationrating r "
+        "  SET ratingvalue = r.ratingvalue + d.delta, observations = r.observations + d.observations, "
+        "      modifiedat = NOW() "
+        "  FROM pg_temp." + RATING_DELTA_TABLE + " d "
+        "  WHERE r.relationid = d.relationid AND r.relationid IN (SELECT relationid FROM locked) "
+        "  RETURNING r.relationid) "
+        "SELECT DISTINCT rs.compositionid FROM hartonomous.relationsequence rs "
+        "JOIN u ON rs.relationid = u.relationid",
+        [&](const std::vector<std::string>& row) { touched.push_back(BLAKE3Pipeline::from_hex(row[0])); }
+    );
+
+    std::vector<BLAKE3Pipeline::Hash> relations;
+    relations.reserve(deltas.size());
+    for (const auto& [id, d] : deltas) relations.push_back(id);
+    CompositionAdjacency::refresh(db_, relations);
+}
+
+void OODALoop::commit_evidence(const std::map<BLAKE3Pipeline::Hash, RatingDelta>& deltas) {
+    if (!pending_.empty()) {
+        if (!db_.has_staging_table(EVIDENCE_DELTA_TABLE)) {
+            db_.execute(std::string("CREATE TEMP TABLE IF NOT EXISTS ") + EVIDENCE_DELTA_TABLE +
+                        " (relationid UUID, observations BIGINT, strengthsum DOUBLE PRECISION, appliedelo BIGINT)"
+                        " ON COMMIT DELETE ROWS");
+            db_.add_staging_table(EVIDENCE_DELTA_TABLE);
+        }
+
+        BulkCopy copy(db_, CopyMode::TrustedUnique);
+        copy.set_binary(true);
+        copy.begin_table(std::string("pg_temp.") + EVIDENCE_DELTA_TABLE,
+                         {"relationid", "observations", "strengthsum", "appliedelo"});
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Int64, pgcopy::Float8, pgcopy::Int64>;
+        for (const auto& [id, e] : pending_) {
+            // Only what was applied counts; a delta left out by decide() comes back next cycle
+            auto it = deltas.find(id);
+            const int64_t applied = it == deltas.end() ? 0 : std::llround(it->second.elo);
+            copy.write_row<Row>(id, e.observations, e.strength_sum, applied);
+        }
+        copy.flush();
+
+        db_.execute(std::string(
+            "INSERT INTO hartonomous_internal.evidencesummary AS s "
+            "  (relationid, observations, strengthsum, appliedelo) "
+            "SELECT relationid, observations, strengthsum, appliedelo FROM pg_temp.") + EVIDENCE_DELTA_TABLE +
+            " ORDER BY relationid "
+            "ON CONFLICT (relationid) DO UPDATE SET "
+            "  observations = s.observations + EXCLUDED.observations, "
+            "  strengthsum = s.strengthsum + EXCLUDED.strengthsum, "
+            "  appliedelo = s.appliedelo + EXCLUDED.appliedelo, modifiedat = NOW()");
+    }
+    db_.execute(
+        "INSERT INTO hartonomous_internal.evidencewatermark (consumer, validatedthrough) VALUES ('ooda', $1) "
+        "ON CONFLICT (consumer) DO UPDATE SET validatedthrough = EXCLUDED.validatedthrough, modifiedat = NOW()",
+        {pending_through_});
+}
+
+OODAMetrics OODALoop::run_cycle() {
+    OODAMetrics metrics{};
+    auto updates = decide(orient());
+
+    double strength = 0.0;
+    for (const auto& [id, e] : pending_) {
+        metrics.observations_processed += static_cast<int>(e.observations);
+        strength += e.strength_sum;
+    }
+    for (const auto& u : updates) ++(u.elo_delta > 0 ? metrics.edges_strengthened : metrics.edges_weakened);
+    // Net signal in [-1, 1], on the 1-5 scale of user ratings
+    if (metrics.observations_processed)
+        metrics.avg_user_satisfaction = 3.0 + 2.0 * strength / metrics.observations_processed;
+
+    act(updates);
+    return metrics;
+}
+
+void OODALoop::run_continuous(int interval_seconds) {
+    for (;;) {
+        try {
+            run_cycle();
+        } catch (const std::exception& e) {
+            // Nothing committed: the next cycle reads the same window again
+            std::cerr << "OODA cycle failed: " << e.what() << std::endl;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(interval_seconds));
     }
 }
 
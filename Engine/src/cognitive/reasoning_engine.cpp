@@ -7,18 +7,32 @@
  */
 
 #include <cognitive/reasoning_engine.hpp>
+#include <query/response_cache.hpp>
+#include <utils/thread_config.hpp>
 #include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <cctype>
 #include <iostream>
 #include <cmath>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace Hartonomous {
 
 ReasoningEngine::ReasoningEngine(PostgresConnection& db)
     : db_(db), walk_(db), astar_(db), godel_(db), query_(db) {}
 
+// Sub-engines run on this engine's thread, so they share its one lease
+ReasoningEngine::ReasoningEngine(ConnectionPool& pool)
+    : lease_(pool.acquire()), db_(*lease_), walk_(db_), astar_(db_), godel_(db_), query_(db_) {}
+
 // =============================================================================
 // OBSERVE: Parse prompt → extract seeds
 // =============================================================================
@@ -48,27 +62,50 @@ ReasoningEngine::Observation ReasoningEngine::observe(
     auto prompt_keywords = query_.extract_keywords(prompt);
     obs.keywords.insert(obs.keywords.end(), prompt_keywords.begin(), prompt_keywords.end());
 
+    resolve_seeds(obs);
+    return obs;
+}
+
+void ReasoningEngine::resolve_seeds(Observation& obs) {
     // Deduplicate keywords
     std::sort(obs.keywords.begin(), obs.keywords.end());
     obs.keywords.erase(std::unique(obs.keywords.begin(), obs.keywords.end()), obs.keywords.end());
 
     // Resolve keywords → composition IDs
     for (const auto& kw : obs.keywords) {
-        auto comp = query_.find_composition(kw);
-        if (comp) {
-            obs.seed_compositions.push_back(BLAKE3Pipeline::from_hex(*comp));
-        } else {
-            // Try lowercase
-            std::string lower = kw;
-            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-            auto lower_comp = query_.find_composition(lower);
-            if (lower_comp) {
-                obs.seed_compositions.push_back(BLAKE3Pipeline::from_hex(*lower_comp));
-            }
-        }
+        if (auto comp = resolve(kw)) obs.seed_compositions.push_back(*comp);
     }
+}
 
-    return obs;
+std::optional<BLAKE3Pipeline::Hash> ReasoningEngine::resolve(const std::string& term) {
+    if (session_) {
+        if (auto memo = session_->find_term(term)) return *memo;
+    }
+    // Case variants are tried by the resolver
+    std::optional<BLAKE3Pipeline::Hash> id;
+    if (auto comp = query_.find_composition(term)) id = BLAKE3Pipeline::from_hex(*comp);
+    if (session_) session_->put_term(term, id);
+    return id;
+}
+
+std::vector<std::string> ReasoningEngine::known_facts(const std::string& keyword) {
+    if (session_) {
+        if (auto memo = session_->find_facts(keyword)) return std::move(*memo);
+    }
+    auto facts = godel_.query_known_facts(keyword);
+    if (session_) session_->put_facts(keyword, facts);
+    return facts;
+}
+
+AStarPath ReasoningEngine::plan(const BLAKE3Pipeline::Hash& start, const BLAKE3Pipeline::Hash& goal,
+                                const AStarConfig& config) {
+    // Beams of one turn call this concurrently; the session locks its memo
+    if (session_) {
+        if (auto memo = session_->find_path(start, goal)) return std::move(*memo);
+    }
+    auto path = astar_.search(start, goal, config);
+    if (session_) session_->put_path(start, goal, path);
+    return path;
 }
 
 // =============================================================================
@@ -91,7 +128,7 @@ ReasoningEngine::Orientation ReasoningEngine::orient(const Observation& obs) {
 
     // Query known facts for each keyword (up to first 5)
     for (size_t i = 0; i < std::min(obs.keywords.size(), size_t(5)); ++i) {
-        auto facts = godel_.query_known_facts(obs.keywords[i]);
+        auto facts = known_facts(obs.keywords[i]);
         ort.known_facts.insert(ort.known_facts.end(), facts.begin(), facts.end());
     }
 
@@ -144,11 +181,11 @@ std::vector<Intention> ReasoningEngine::decide(
 
     // Strategy 3: Known facts as lightweight intentions
     for (const auto& fact : ort.known_facts) {
-        auto comp = query_.find_composition(fact);
+        auto comp = resolve(fact);
         if (comp) {
             Intention intent;
             intent.description = "Known: " + fact;
-            intent.target_id = BLAKE3Pipeline::from_hex(*comp);
+            intent.target_id = *comp;
             intent.priority = 0.5; // Lower priority — background knowledge
             intentions.push_back(intent);
         }
@@ -192,39 +229,84 @@ std::vector<Hypothesis> ReasoningEngine::act(
     }
 
     // Create beam_width hypotheses, each trying different intention orderings
-    for (size_t beam = 0; beam < config.beam_width && beam < intentions.size(); ++beam) {
-        Hypothesis h;
+    run_beams(intentions, obs, config, 0, hypotheses);
+
+    return hypotheses;
+}
+
+void ReasoningEngine::run_beams(
+    const std::vector<Intention>& intentions,
+    const Observation& obs,
+    const ReasoningConfig& config,
+    size_t first,
+    std::vector<Hypothesis>& hypotheses,
+    const CancellationToken* cancel)
+{
+    const size_t beams = std::min(config.beam_width, intentions.size());
+    if (first >= beams) return;
+
+    // Good enough: no point planning the remaining orderings
+    const double accept = config.early_accept_margin < 0.0
+        ? std::numeric_limits<double>::infinity()
+        : config.min_path_quality + config.early_accept_margin;
+    std::atomic<bool> accepted{false};
+    for (const auto& h : hypotheses) {
+        if (h.quality_score >= accept) return;
+    }
 
-        // Each beam starts from a different seed
-        BLAKE3Pipeline::Hash start = obs.seed_compositions[beam % obs.seed_compositions.size()];
+    // Without a snapshot every search shares this engine's one connection
+    const bool concurrent = astar_.has_relation_graph() && config.act_threads != 1;
+    if (concurrent) astar_.preload_cache();  // First use talks to the database
+
+    std::vector<std::optional<Hypothesis>> slots(beams - first);
+    for_each_task(slots.size(), concurrent, config.act_threads, [&](size_t i) {
+        if (accepted.load(std::memory_order_relaxed)) return;
+        if (cancel && cancel->cancelled()) return;
+        slots[i] = act_beam(intentions, obs, config, first + i);
+        if (slots[i]->quality_score >= accept) accepted.store(true, std::memory_order_relaxed);
+    });
+
+    // Beam order, whatever order they finished in
+    for (auto& h : slots) {
+        if (h) hypotheses.push_back(std::move(*h));
+    }
+}
 
-        // Try to resolve intentions via A*
-        for (size_t i = 0; i < intentions.size(); ++i) {
-            // Rotate intention order for each beam
-            size_t idx = (i + beam) % intentions.size();
-            Intention intent = intentions[idx];
+Hypothesis ReasoningEngine::act_beam(
+    const std::vector<Intention>& intentions,
+    const Observation& obs,
+    const ReasoningConfig& config,
+    size_t beam)
+{
+    Hypothesis h;
 
-            auto path = astar_.search(start, intent.target_id, config.astar);
+    // Each beam starts from a different seed
+    BLAKE3Pipeline::Hash start = obs.seed_compositions[beam % obs.seed_compositions.size()];
 
-            if (path.found) {
-                intent.resolved = true;
-                intent.path = path;
-                h.paths.push_back(path);
+    // Try to resolve intentions via A*
+    for (size_t i = 0; i < intentions.size(); ++i) {
+        // Rotate intention order for each beam
+        size_t idx = (i + beam) % intentions.size();
+        Intention intent = intentions[idx];
 
-                // Chain: next search starts from where this one ended
-                if (!path.nodes.empty()) {
-                    start = path.nodes.back();
-                }
-            }
+        auto path = plan(start, intent.target_id, config.astar);
+
+        if (path.found) {
+            intent.resolved = true;
+            intent.path = path;
+            h.paths.push_back(path);
 
-            h.intentions.push_back(intent);
+            // Chain: next search starts from where this one ended
+            if (!path.nodes.empty()) {
+                start = path.nodes.back();
+            }
         }
 
-        h.quality_score = score_hypothesis(h);
-        hypotheses.push_back(h);
+        h.intentions.push_back(intent);
     }
 
-    return hypotheses;
+    h.quality_score = score_hypothesis(h);
+    return h;
 }
 
 // =============================================================================
@@ -259,14 +341,20 @@ Hypothesis ReasoningEngine::reflect(
 
         if (unresolved_targets.empty()) break;
 
-        // Try multi-goal search from each seed
-        for (const auto& seed : obs.seed_compositions) {
-            AStarConfig relaxed = config.astar;
-            relaxed.min_elo = std::max(600.0, relaxed.min_elo - 200.0 * round);
-            relaxed.max_expansions = config.astar.max_expansions * 2;
+        // Try multi-goal search from each seed; searches are independent of each other
+        AStarConfig relaxed = config.astar;
+        relaxed.min_elo = std::max(600.0, relaxed.min_elo - 200.0 * round);
+        relaxed.max_expansions = config.astar.max_expansions * 2;
 
-            auto path = astar_.search_multi_goal(seed, unresolved_targets, relaxed);
+        const bool concurrent = astar_.has_relation_graph() && config.act_threads != 1;
+        if (concurrent) astar_.preload_cache();
+        std::vector<AStarPath> found(obs.seed_compositions.size());
+        for_each_task(found.size(), concurrent, config.act_threads, [&](size_t i) {
+            found[i] = astar_.search_multi_goal(obs.seed_compositions[i], unresolved_targets, relaxed);
+        });
 
+        // Applied in seed order, as if run one after another
+        for (auto& path : found) {
             if (path.found) {
                 best.paths.push_back(path);
                 // Mark the reached goal as resolved
@@ -368,15 +456,25 @@ std::string ReasoningEngine::assemble_response(
 
     // Fill remaining capacity with walk-generated text from unresolved seeds
     if (segments.empty() || path_words.size() < config.max_response_words / 2) {
-        for (const auto& seed : obs.seed_compositions) {
-            size_t remaining = config.max_response_words -
-                (path_words.empty() ? 0 : path_words.size());
-            if (remaining < 10) break;
-
-            std::string walk_text = generate_passage(seed, remaining, config.walk);
-            if (!walk_text.empty()) {
-                segments.push_back(walk_text);
-                break; // One walk passage is enough
+        size_t remaining = config.max_response_words -
+            (path_words.empty() ? 0 : path_words.size());
+        if (remaining >= 10 && walk_.has_relation_graph() && obs.seed_compositions.size() > 1) {
+            // Walk every seed at once and keep the first that says something
+            auto passages = walk_.generate_batch(obs.seed_compositions, config.walk,
+                                                 std::min(remaining, size_t(100)));
+            for (auto& passage : passages) {
+                if (!passage.empty()) {
+                    segments.push_back(std::move(passage));
+                    break; // One walk passage is enough
+                }
+            }
+        } else if (remaining >= 10) {
+            for (const auto& seed : obs.seed_compositions) {
+                std::string walk_text = generate_passage(seed, remaining, config.walk);
+                if (!walk_text.empty()) {
+                    segments.push_back(walk_text);
+                    break; // One walk passage is enough
+                }
             }
         }
     }
@@ -399,6 +497,37 @@ std::string ReasoningEngine::assemble_response(
     return response;
 }
 
+void ReasoningEngine::summarize(const Hypothesis& best, const ReasoningConfig& config,
+                                ReasoningResult& result) const
+{
+    // Count results
+    result.intentions_resolved = 0;
+    for (const auto& i : best.intentions) {
+        if (i.resolved) result.intentions_resolved++;
+    }
+
+    for (const auto& p : best.paths) {
+        result.nodes_expanded += p.nodes_expanded;
+    }
+
+    // Reasoning trace
+    if (config.include_reasoning_trace) {
+        for (const auto& path : best.paths) {
+            if (path.found) {
+                std::string trace = "[";
+                for (size_t i = 0; i < path.texts.size(); ++i) {
+                    if (i > 0) trace += " → ";
+                    trace += path.texts[i];
+                }
+                trace += "]";
+                result.reasoning_trace.push_back(trace);
+            }
+        }
+    }
+
+    result.confidence = best.quality_score;
+}
+
 // =============================================================================
 // Walk-based passage generation
 // =============================================================================
@@ -408,7 +537,7 @@ std::string ReasoningEngine::generate_passage(
     size_t max_words,
     const WalkParameters& params)
 {
-    return walk_.generate(walk_.lookup_text(seed), params,
+    return walk_.generate(std::string(walk_.lookup_text(seed)), params,
                           std::min(max_words, size_t(100)));
 }
 
@@ -459,17 +588,66 @@ bool ReasoningEngine::detect_creative(const std::string& prompt) const {
 
 ReasoningResult ReasoningEngine::reason(const std::string& prompt,
                                         const ReasoningConfig& config)
+{
+    // 1. OBSERVE
+    return respond(observe(prompt, config), config);
+}
+
+// The memos hold for one tenant and one set of A* settings
+static std::string session_scope(const ReasoningConfig& c, const std::optional<BLAKE3Pipeline::Hash>& tenant) {
+    std::string b = tenant ? BLAKE3Pipeline::to_hex(*tenant) : std::string();
+    auto put = [&](const auto& v) { b.append(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    put(c.astar.max_expansions); put(c.astar.heuristic_weight); put(c.astar.min_elo);
+    put(c.astar.min_observations); put(c.astar.beam_width); put(c.astar.mode);
+    return b;
+}
+
+ReasoningResult ReasoningEngine::reason(ReasoningSession& session,
+                                        const std::string& prompt,
+                                        const ReasoningConfig& config)
+{
+    session.begin_turn(session_scope(config, query_.tenant()));
+    session_ = &session;
+    struct Detach {
+        ReasoningSession*& session;
+        ~Detach() { session = nullptr; }
+    } detach{session_};
+
+    // 1. OBSERVE: the new message's keywords, then those the session kept of the turns before
+    Observation obs;
+    obs.prompt = prompt;
+    obs.system_context = config.system_prompt;
+    obs.is_question = detect_question(prompt);
+    obs.is_creative = detect_creative(prompt);
+    auto prompt_keywords = query_.extract_keywords(prompt);
+    for (const auto& turn : session.context()) {
+        obs.keywords.insert(obs.keywords.end(), turn.keywords.begin(), turn.keywords.end());
+    }
+    obs.keywords.insert(obs.keywords.end(), prompt_keywords.begin(), prompt_keywords.end());
+    resolve_seeds(obs);
+
+    // Without a snapshot, every seed's neighborhood is one round trip for all that are not cached
+    if (!astar_.has_relation_graph() && NeighborCache::global().enabled()) {
+        NeighborCache::global().prefetch(db_, obs.seed_compositions);
+    }
+
+    auto result = respond(obs, config);
+
+    if (!astar_.has_relation_graph()) session.hold_neighbors(obs.seed_compositions);
+    session.add_turn("user", prompt, std::move(prompt_keywords));
+    session.add_turn("assistant", result.response, query_.extract_keywords(result.response));
+    return result;
+}
+
+ReasoningResult ReasoningEngine::respond(const Observation& obs, const ReasoningConfig& config)
 {
     ReasoningResult result;
     result.reflexion_rounds = 0;
     result.nodes_expanded = 0;
 
-    // 1. OBSERVE
-    auto obs = observe(prompt, config);
-
     if (obs.seed_compositions.empty()) {
         // Cannot even find prompt concepts in substrate
-        result.response = walk_.generate(prompt, config.walk, config.walk_max_steps);
+        result.response = walk_.generate(obs.prompt, config.walk, config.walk_max_steps);
         result.confidence = 0.1;
         result.intentions_resolved = 0;
         result.intentions_total = 0;
@@ -489,62 +667,306 @@ ReasoningResult ReasoningEngine::reason(const std::string& prompt,
     // 5. REFLECT
     auto best = reflect(hypotheses, obs, config);
 
-    // Count results
-    result.intentions_resolved = 0;
-    for (const auto& i : best.intentions) {
-        if (i.resolved) result.intentions_resolved++;
-    }
+    summarize(best, config, result);
 
-    for (const auto& p : best.paths) {
-        result.nodes_expanded += p.nodes_expanded;
+    // 6. ASSEMBLE
+    result.response = assemble_response(best, obs, config);
+
+    return result;
+}
+
+// =============================================================================
+// Streaming
+// =============================================================================
+
+void ReasoningEngine::stream_pipeline(
+    const std::string& prompt,
+    const ReasoningConfig& config,
+    const CancellationToken& cancel,
+    const std::function<bool(std::string)>& emit,
+    ReasoningResult& result)
+{
+    // Words are joined the way assemble_response joins them
+    bool first_word = true;
+    char last_char = 0;
+    auto say = [&](std::string_view w, bool& segment_start) {
+        if (w.empty()) return !cancel.cancelled();
+        std::string token = first_word ? "" : " ";
+        if (segment_start) {
+            token += w;
+            token[token.size() - w.size()] = std::toupper(static_cast<unsigned char>(w[0]));
+        } else if (w.size() == 1 && std::ispunct(static_cast<unsigned char>(w[0]))) {
+            token = w;
+        } else {
+            token += w;
+        }
+        first_word = segment_start = false;
+        last_char = token.back();
+        return emit(std::move(token));
+    };
+    auto walk_passage = [&](const std::string& from, size_t max_steps) {
+        bool segment_start = true;
+        walk_.generate(from, config.walk, max_steps,
+                       [&](std::string_view w) { return say(w, segment_start); });
+        return !segment_start;
+    };
+    auto finish = [&] {
+        if (!first_word && last_char != '.' && last_char != '!' && last_char != '?') emit(".");
+    };
+
+    // 1. OBSERVE
+    auto obs = observe(prompt, config);
+    cancel.throw_if_cancelled();
+
+    if (obs.seed_compositions.empty()) {
+        walk_passage(prompt, config.walk_max_steps);
+        result.confidence = 0.1;
+        finish();
+        return;
     }
 
-    // Reasoning trace
-    if (config.include_reasoning_trace) {
-        for (const auto& path : best.paths) {
-            if (path.found) {
-                std::string trace = "[";
-                for (size_t i = 0; i < path.texts.size(); ++i) {
-                    if (i > 0) trace += " → ";
-                    trace += path.texts[i];
-                }
-                trace += "]";
-                result.reasoning_trace.push_back(trace);
+    // 2. ORIENT, 3. DECIDE
+    auto ort = orient(obs);
+    cancel.throw_if_cancelled();
+    auto intentions = decide(obs, ort);
+    result.intentions_total = intentions.size();
+    cancel.throw_if_cancelled();
+
+    // Path words in order of first occurrence, as in assemble_response
+    std::unordered_set<std::string> seen_words;
+    size_t path_words = 0;
+    bool path_segment = true;
+    auto say_paths = [&](const Hypothesis& h) {
+        for (const auto& path : h.paths) {
+            for (const auto& text : path.texts) {
+                if (text.empty()) continue;
+                if (path_words >= config.max_response_words) return;
+                std::string lower = text;
+                std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+                if (!seen_words.insert(lower).second) continue;
+                ++path_words;
+                if (!say(text, path_segment)) return;
             }
         }
+    };
+
+    // 4. ACT: the first beam speaks as soon as its chain is planned
+    std::vector<Hypothesis> hypotheses;
+    if (intentions.empty()) {
+        hypotheses = act(intentions, obs, config);
+    } else {
+        hypotheses.push_back(act_beam(intentions, obs, config, 0));
+        say_paths(hypotheses.front());
+        cancel.throw_if_cancelled();
+        run_beams(intentions, obs, config, 1, hypotheses, &cancel);
     }
+    cancel.throw_if_cancelled();
 
-    // 6. ASSEMBLE
-    result.response = assemble_response(best, obs, config);
-    result.confidence = best.quality_score;
+    // 5. REFLECT; whatever the winner adds follows the words already sent
+    auto best = reflect(hypotheses, obs, config);
+    cancel.throw_if_cancelled();
+    say_paths(best);
+    summarize(best, config, result);
+
+    // 6. Walk fill, one passage streamed step by step
+    if (path_words < config.max_response_words / 2 || path_words == 0) {
+        size_t remaining = config.max_response_words - path_words;
+        if (remaining >= 10) {
+            for (const auto& seed : obs.seed_compositions) {
+                cancel.throw_if_cancelled();
+                if (walk_passage(std::string(walk_.lookup_text(seed)), std::min(remaining, size_t(100)))) break;
+            }
+        }
+    }
 
-    return result;
+    finish();
 }
 
 ReasoningResult ReasoningEngine::reason_stream(
     const std::string& prompt,
     ReasoningStreamCallback callback,
-    const ReasoningConfig& config)
+    const ReasoningConfig& config,
+    std::shared_ptr<CancellationToken> cancel)
 {
-    // For streaming, we run the full pipeline then emit tokens
-    auto result = reason(prompt, config);
+    if (!cancel) cancel = std::make_shared<CancellationToken>();
 
-    // Tokenize response and stream
-    std::istringstream iss(result.response);
-    std::string token;
-    size_t step = 0;
+    ReasoningResult result;  // Filled by the worker; read after join
+    result.confidence = 0.0;
+    result.intentions_resolved = 0;
+    result.intentions_total = 0;
+    result.reflexion_rounds = 0;
+    result.nodes_expanded = 0;
 
-    while (iss >> token) {
-        std::string out = (step == 0) ? token : (" " + token);
-        if (!callback(out, step)) break;
-        step++;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<std::string> queue;
+    bool done = false;
+    std::exception_ptr error;
+
+    // Only the worker touches db_ until join, so cancelling its query is the whole abort
+    size_t hook = cancel->add_hook([this] { db_.cancel(); });
+
+    std::thread worker([&] {
+        auto emit = [&](std::string token) {
+            if (cancel->cancelled()) return false;
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                queue.push_back(std::move(token));
+            }
+            cv.notify_one();
+            return true;
+        };
+        try {
+            stream_pipeline(prompt, config, *cancel, emit, result);
+        } catch (...) {
+            // A cancelled query fails like any other; only report failures nobody asked for
+            if (!cancel->cancelled()) error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            done = true;
+        }
+        cv.notify_one();
+    });
+
+    const bool has_deadline = config.deadline.count() > 0;
+    const auto deadline = std::chrono::steady_clock::now() + config.deadline;
+    auto ready = [&] { return done || !queue.empty(); };
+
+    std::string response;
+    std::string finish = "complete";
+    size_t step = 0;
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        for (;;) {
+            if (has_deadline) {
+                if (!cv.wait_until(lock, deadline, ready)) {
+                    finish = "deadline";
+                    break;
+                }
+            } else {
+                cv.wait(lock, ready);
+            }
+            if (queue.empty()) break;  // Worker finished
+
+            std::string token = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            bool more = callback(token, step);
+            response += token;
+            step++;
+            lock.lock();
+
+            if (!more) {
+                finish = "cancelled";
+                break;
+            }
+            if (config.max_tokens > 0 && step >= config.max_tokens && !(done && queue.empty())) {
+                finish = "length";
+                break;
+            }
+        }
     }
 
+    if (finish != "complete") cancel->cancel();
+    else if (cancel->cancelled()) finish = "cancelled";
+    worker.join();
+    cancel->remove_hook(hook);
+    if (error) std::rethrow_exception(error);
+
+    result.response = std::move(response);
+    result.finish_reason = std::move(finish);
     return result;
 }
 
+// Everything in config that reason() reads; the streaming limits are left out
+static std::string config_digest(const ReasoningConfig& c) {
+    std::string b;
+    auto put = [&](const auto& v) { b.append(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    auto put_text = [&](const std::string& s) { put(s.size()); b += s; };
+    put(c.beam_width); put(c.max_depth); put(c.act_threads); put(c.early_accept_margin);
+    put(c.astar.max_expansions); put(c.astar.heuristic_weight); put(c.astar.min_elo);
+    put(c.astar.min_observations); put(c.astar.beam_width); put(c.astar.mode); put(c.astar.threads);
+    const auto& w = c.walk;
+    put(w.w_model); put(w.w_text); put(w.w_rel); put(w.w_geo); put(w.w_hilbert); put(w.w_repeat);
+    put(w.w_novelty); put(w.goal_attraction); put(w.w_energy); put(w.base_temp); put(w.min_temp);
+    put(w.energy_alpha); put(w.energy_decay); put(w.recent_window);
+    put(c.walk_max_steps); put(c.min_path_quality); put(c.max_reflexion_rounds);
+    put(c.max_response_words); put(c.include_reasoning_trace);
+    put_text(c.system_prompt);
+    put(c.history.size());
+    for (const auto& [role, content] : c.history) { put_text(role); put_text(content); }
+    return BLAKE3Pipeline::to_hex(BLAKE3Pipeline::hash(b));
+}
+
+static ResponseCache<ReasoningResult>& quick_answer_cache() {
+    static ResponseCache<ReasoningResult> cache;
+    return cache;
+}
+
+ResponseCacheStats ReasoningEngine::quick_answer_cache_stats() { return quick_answer_cache().stats(); }
+
 ReasoningResult ReasoningEngine::quick_answer(const std::string& prompt,
                                                const ReasoningConfig& config)
+{
+    auto& cache = quick_answer_cache();
+    const uint64_t epoch = SubstrateEpoch::current();
+    std::string key;
+    if (cache.enabled()) {
+        key = quick_answer_key(prompt, config_digest(config));
+        if (auto hit = cache.get(key)) return std::move(*hit);
+    }
+
+    ReasoningResult result = answer_quickly(prompt, config, query_.answer_question(prompt));
+    if (cache.enabled()) cache.put(key, result, epoch);
+    return result;
+}
+
+std::vector<ReasoningResult> ReasoningEngine::quick_answer_batch(const std::vector<std::string>& prompts,
+                                                                 const ReasoningConfig& config)
+{
+    auto& cache = quick_answer_cache();
+    const uint64_t epoch = SubstrateEpoch::current();
+    std::vector<ReasoningResult> out(prompts.size());
+    std::vector<std::string> keys(prompts.size());
+    std::vector<size_t> pending;
+    std::vector<std::pair<size_t, size_t>> repeats;   // (index, earlier index of the same prompt)
+    std::unordered_map<std::string_view, size_t> first;
+    const std::string digest = cache.enabled() ? config_digest(config) : std::string();
+    for (size_t i = 0; i < prompts.size(); ++i) {
+        if (cache.enabled()) {
+            keys[i] = quick_answer_key(prompts[i], digest);
+            if (auto hit = cache.get(keys[i])) {
+                out[i] = std::move(*hit);
+                continue;
+            }
+        }
+        auto [it, fresh] = first.emplace(prompts[i], i);
+        if (fresh) pending.push_back(i);
+        else repeats.emplace_back(i, it->second);
+    }
+
+    std::vector<std::string> questions;
+    questions.reserve(pending.size());
+    for (size_t i : pending) questions.push_back(prompts[i]);
+    const auto answers = query_.answer_question_batch(questions);
+
+    for (size_t k = 0; k < pending.size(); ++k) {
+        const size_t i = pending[k];
+        out[i] = answer_quickly(prompts[i], config, answers[k]);
+        if (cache.enabled()) cache.put(keys[i], out[i], epoch);
+    }
+    for (const auto& [i, earlier] : repeats) out[i] = out[earlier];
+    return out;
+}
+
+std::string ReasoningEngine::quick_answer_key(const std::string& prompt, const std::string& digest) const {
+    const auto& tenant = query_.tenant();
+    return digest + (tenant ? BLAKE3Pipeline::to_hex(*tenant) : std::string()) + '\0' + normalized_prompt(prompt);
+}
+
+ReasoningResult ReasoningEngine::answer_quickly(const std::string& prompt, const ReasoningConfig& config,
+                                                const std::optional<QueryResult>& answer)
 {
     ReasoningResult result;
     result.reflexion_rounds = 0;
@@ -553,7 +975,6 @@ ReasoningResult ReasoningEngine::quick_answer(const std::string& prompt,
     result.intentions_resolved = 0;
 
     // Try semantic query first (fast path)
-    auto answer = query_.answer_question(prompt);
     if (answer && answer->confidence > 5.0) {
         result.response = answer->text;
         result.confidence = std::min(1.0, answer->confidence / 100.0);
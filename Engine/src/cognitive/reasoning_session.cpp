@@ -0,0 +1,164 @@
+/**
+ * @file reasoning_session.cpp
+ * @brief Per-conversation memos of terms, facts and A* paths
+ */
+
+#include <cognitive/reasoning_session.hpp>
+
+namespace Hartonomous {
+
+ReasoningSession::ReasoningSession(MemoryGovernor& governor)
+    : account_(governor.enroll("reasoning_sessions", MemoryGovernor::Priority::Low)) {}
+
+void ReasoningSession::begin_turn(const std::string& scope, uint64_t epoch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool shrink = account_.shrink_requested();
+    const bool stale = shrink || !started_ || scope != scope_ || epoch != epoch_;
+    if (stale) clear_locked();
+    scope_ = scope;
+    epoch_ = epoch;
+    started_ = true;
+    if (shrink) account_.shrunk(bytes_locked());
+    else if (stale) report_locked();
+}
+
+void ReasoningSession::add_turn(std::string role, std::string content, std::vector<std::string> keywords) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    context_.push_back({std::move(role), std::move(content), std::move(keywords)});
+    while (context_.size() > CONTEXT_TURNS) context_.pop_front();
+    ++stats_.turns;
+    report_locked();
+}
+
+std::optional<std::optional<ReasoningSession::Hash>> ReasoningSession::find_term(const std::string& term) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = terms_.find(term);
+    if (it == terms_.end()) {
+        ++stats_.term_misses;
+        return std::nullopt;
+    }
+    ++stats_.term_hits;
+    return it->second;
+}
+
+void ReasoningSession::put_term(const std::string& term, std::optional<Hash> id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (terms_.size() >= MAX_ENTRIES) {
+        for (const auto& [t, _] : terms_) bytes_ -= t.capacity();
+        terms_.clear();
+    }
+    auto [it, inserted] = terms_.emplace(term, id);
+    if (inserted) bytes_ += it->first.capacity();
+}
+
+std::optional<std::vector<std::string>> ReasoningSession::find_facts(const std::string& keyword) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = facts_.find(keyword);
+    if (it == facts_.end()) {
+        ++stats_.term_misses;
+        return std::nullopt;
+    }
+    ++stats_.term_hits;
+    return it->second;
+}
+
+static size_t facts_bytes(const std::string& keyword, const std::vector<std::string>& facts) noexcept {
+    size_t b = keyword.capacity();
+    for (const auto& f : facts) b += sizeof(f) + f.capacity();
+    return b;
+}
+
+void ReasoningSession::put_facts(const std::string& keyword, std::vector<std::string> facts) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (facts_.size() >= MAX_ENTRIES) {
+        for (const auto& [k, f] : facts_) bytes_ -= facts_bytes(k, f);
+        facts_.clear();
+    }
+    auto [it, inserted] = facts_.emplace(keyword, std::move(facts));
+    if (inserted) bytes_ += facts_bytes(it->first, it->second);
+}
+
+size_t ReasoningSession::path_bytes(const AStarPath& p) noexcept {
+    size_t b = p.nodes.capacity() * sizeof(Hash);
+    for (const auto& t : p.texts) b += sizeof(t) + t.capacity();
+    return b;
+}
+
+std::optional<AStarPath> ReasoningSession::find_path(const Hash& start, const Hash& goal) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = paths_.find({start, goal});
+    if (it == paths_.end()) {
+        ++stats_.path_misses;
+        return std::nullopt;
+    }
+    ++stats_.path_hits;
+    return it->second;
+}
+
+void ReasoningSession::put_path(const Hash& start, const Hash& goal, const AStarPath& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (paths_.size() >= MAX_ENTRIES) {
+        for (const auto& [_, p] : paths_) bytes_ -= path_bytes(p);
+        paths_.clear();
+    }
+    auto [it, inserted] = paths_.emplace(std::make_pair(start, goal), path);
+    if (inserted) bytes_ += path_bytes(it->second);
+}
+
+void ReasoningSession::hold_neighbors(const std::vector<Hash>& seeds) {
+    auto& cache = NeighborCache::global();
+    if (!cache.enabled()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<Hash, NeighborCache::List, HashHasher> keep;
+    for (const auto& seed : seeds) {
+        if (keep.count(seed)) continue;
+        if (cache.contains(seed)) {
+            if (auto list = cache.find(seed)) keep.emplace(seed, std::move(list));
+            continue;
+        }
+        auto it = held_.find(seed);
+        if (it == held_.end()) continue;
+        // Evicted since the last turn: the list is still current, since the epoch has not moved
+        cache.put(seed, *it->second);
+        ++stats_.restores;
+        keep.emplace(seed, std::move(it->second));
+    }
+    held_ = std::move(keep);
+}
+
+void ReasoningSession::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear_locked();
+    report_locked();
+}
+
+ReasoningSession::Stats ReasoningSession::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.bytes = account_.bytes();
+    return s;
+}
+
+void ReasoningSession::clear_locked() {
+    terms_.clear();
+    facts_.clear();
+    paths_.clear();
+    held_.clear();
+    bytes_ = 0;
+}
+
+size_t ReasoningSession::bytes_locked() const noexcept {
+    // Held lists are left out: they are the cache's, and counted there while it has them
+    size_t b = MemoryGovernor::hash_map_bytes(terms_) + MemoryGovernor::hash_map_bytes(facts_) +
+               MemoryGovernor::hash_map_bytes(paths_) + bytes_;
+    for (const auto& turn : context_) {
+        b += sizeof(Turn) + turn.role.capacity() + turn.content.capacity();
+        for (const auto& kw : turn.keywords) b += sizeof(kw) + kw.capacity();
+    }
+    return b;
+}
+
+void ReasoningSession::report_locked() { account_.update(bytes_locked()); }
+
+} // namespace Hartonomous
@@ -0,0 +1,1093 @@
+/**
+ * @file relation_graph.cpp
+ * @brief CSR relation graph: database aggregation, snapshot files
+ */
+
+#include <cognitive/relation_graph.hpp>
+#include "cognitive/edge_codec.hpp"
+#include <database/substrate_snapshot.hpp>
+#include <utils/huge_pages.hpp>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+// Snapshot layout: fixed header, fingerprint bytes, then 64-byte-aligned
+// sections for ids (16 B/node), offsets (8 B/node + 1) and edges (24 B/edge),
+// or when packed the row offsets (8 B/node + 1), packed rows and relation
+// counts (4 B/edge); with tenant masks the tenant slots (16 B/tenant) and
+// masks (8 B/edge), then node summaries (48 B/node) and hub lists (4 B/entry).
+// The checksum is BLAKE3 over everything after the header.
+static constexpr char GRAPH_MAGIC[8] = {'H', 'R', 'E', 'L', 'G', 'R', 'F', '1'};
+static constexpr uint32_t GRAPH_VERSION = 4;
+static constexpr size_t GRAPH_HEADER_BYTES = 256;
+static constexpr size_t GRAPH_ALIGN = 64;
+
+struct GraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fingerprint_len;
+    uint64_t node_count;
+    uint64_t edge_count;
+    uint64_t file_size;
+    uint64_t ids_offset;
+    uint64_t offsets_offset;
+    uint64_t edges_offset;
+    uint64_t tenant_count;
+    uint64_t tenants_offset;  // 0 without tenant masks
+    uint64_t masks_offset;    // 0 without tenant masks
+    uint64_t summaries_offset;
+    uint64_t hubs_offset;
+    uint64_t hub_entries;
+    uint64_t packed_rows_offset;      // 0 unless packed; edges_offset is 0 when packed
+    uint64_t packed_offset;
+    uint64_t packed_bytes;
+    uint64_t relation_counts_offset;
+    double elo_min;
+    double elo_step;
+    uint8_t checksum[16];
+};
+static_assert(sizeof(GraphHeader) <= GRAPH_HEADER_BYTES);
+
+static size_t align_up(size_t v) { return (v + GRAPH_ALIGN - 1) & ~(GRAPH_ALIGN - 1); }
+
+// Fills section offsets; returns total file size. packed_bytes is 0 for flat edges
+static size_t layout_graph(size_t fp_len, size_t nodes, size_t edges, size_t tenants, bool masks,
+                           size_t hub_entries, size_t packed_bytes, GraphHeader& hdr) {
+    size_t off = align_up(GRAPH_HEADER_BYTES + fp_len);
+    hdr.ids_offset = off;
+    off = align_up(off + nodes * sizeof(BLAKE3Pipeline::Hash));
+    hdr.offsets_offset = off;
+    off = align_up(off + (nodes + 1) * sizeof(uint64_t));
+    hdr.packed_bytes = packed_bytes;
+    if (!packed_bytes) {
+        hdr.edges_offset = off;
+        off += edges * sizeof(RelationGraph::Edge);
+        hdr.packed_rows_offset = hdr.packed_offset = hdr.relation_counts_offset = 0;
+    } else {
+        hdr.edges_offset = 0;
+        hdr.packed_rows_offset = off;
+        off = align_up(off + (nodes + 1) * sizeof(uint64_t));
+        hdr.packed_offset = off;
+        off = align_up(off + packed_bytes);
+        hdr.relation_counts_offset = off;
+        off += edges * sizeof(uint32_t);
+    }
+    hdr.tenant_count = masks ? tenants : 0;
+    if (!masks) {
+        hdr.tenants_offset = hdr.masks_offset = 0;
+    } else {
+        hdr.tenants_offset = off = align_up(off);
+        off = align_up(off + tenants * sizeof(BLAKE3Pipeline::Hash));
+        hdr.masks_offset = off;
+        off += edges * sizeof(RelationGraph::TenantMask);
+    }
+    hdr.summaries_offset = off = align_up(off);
+    off = align_up(off + nodes * sizeof(RelationGraph::NodeSummary));
+    hdr.hubs_offset = off;
+    hdr.hub_entries = hub_entries;
+    return off + hub_entries * sizeof(uint32_t);
+}
+
+// Binary COPY framing: 11-byte signature, int32 flags, int32 extension length
+static constexpr char COPY_SIGNATURE[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+
+static const char* copy_field(const char*& p, const char* end, uint32_t expected_len) {
+    if (p + 4 > end) throw std::runtime_error("Truncated relation graph COPY row");
+    uint32_t len;
+    std::memcpy(&len, p, 4);
+    len = ntohl(len);
+    p += 4;
+    if (len != expected_len || p + len > end) throw std::runtime_error("Malformed field in relation graph COPY stream");
+    const char* field = p;
+    p += len;
+    return field;
+}
+
+static double copy_float8(const char* p) {
+    uint64_t raw;
+    std::memcpy(&raw, p, 8);
+    raw = __builtin_bswap64(raw);
+    double d;
+    std::memcpy(&d, &raw, 8);
+    return d;
+}
+
+// Parse one CopyData message of (uuid, uuid, float8, float8, int8[, int8]) rows
+static void parse_edge_message(const char* buf, int len, std::vector<RelationGraph::EdgeRecord>& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+
+    if (len >= 19 && std::memcmp(p, COPY_SIGNATURE, 11) == 0) {
+        uint32_t ext;
+        std::memcpy(&ext, p + 15, 4);
+        p += 19 + ntohl(ext);
+    }
+
+    while (p + 2 <= end) {
+        uint16_t nfields;
+        std::memcpy(&nfields, p, 2);
+        nfields = ntohs(nfields);
+        p += 2;
+        if (nfields == 0xFFFF) return;  // Trailer
+        if (nfields != 5 && nfields != 6) throw std::runtime_error("Unexpected field count in relation graph COPY stream");
+
+        RelationGraph::EdgeRecord e;
+        std::memcpy(e.source.data(), copy_field(p, end, 16), 16);
+        std::memcpy(e.target.data(), copy_field(p, end, 16), 16);
+        e.max_elo = copy_float8(copy_field(p, end, 8));
+        e.total_obs = copy_float8(copy_field(p, end, 8));
+        uint64_t count;
+        std::memcpy(&count, copy_field(p, end, 8), 8);
+        e.relation_count = static_cast<uint32_t>(__builtin_bswap64(count));
+        if (nfields == 6) {
+            uint64_t mask;
+            std::memcpy(&mask, copy_field(p, end, 8), 8);
+            e.tenants = __builtin_bswap64(mask);
+        }
+        out.push_back(e);
+    }
+}
+
+const RelationGraph::NodeSummary RelationGraph::EMPTY_SUMMARY{};
+
+RelationGraph::~RelationGraph() {
+    if (map_addr_) ::munmap(map_addr_, map_size_);
+}
+
+HugePageUsage RelationGraph::huge_page_usage() const {
+    if (map_addr_) return Hartonomous::huge_page_usage(map_addr_, map_size_);
+    HugePageUsage usage = array_huge_page_usage(owned_ids_);
+    usage += array_huge_page_usage(owned_offsets_);
+    usage += array_huge_page_usage(owned_edges_);
+    usage += array_huge_page_usage(owned_masks_);
+    usage += array_huge_page_usage(owned_summaries_);
+    usage += array_huge_page_usage(owned_hubs_);
+    usage += array_huge_page_usage(owned_packed_rows_);
+    usage += array_huge_page_usage(owned_packed_bytes_);
+    usage += array_huge_page_usage(owned_relation_counts_);
+    return usage;
+}
+
+size_t RelationGraph::edge_bytes() const noexcept {
+    const size_t edges = base_nodes_ ? offsets_[base_nodes_] : 0;
+    if (!packed_.rows) return edges * sizeof(Edge);
+    return packed_.byte_count + (base_nodes_ + 1) * sizeof(uint64_t) + edges * sizeof(uint32_t);
+}
+
+bool RelationGraph::packed_by_default() {
+    const char* v = std::getenv("HARTONOMOUS_RELATION_GRAPH_PACKED");
+    return v && std::strtol(v, nullptr, 10) != 0;
+}
+
+bool RelationGraph::paged_by_default() {
+    const char* v = std::getenv("HARTONOMOUS_RELATION_GRAPH_PAGED");
+    return v && std::strtol(v, nullptr, 10) != 0;
+}
+
+size_t RelationGraph::paged_hot_bytes() {
+    const char* v = std::getenv("HARTONOMOUS_RELATION_GRAPH_HOT_MB");
+    const long long mb = v ? std::strtoll(v, nullptr, 10) : 1024;
+    return mb > 0 ? static_cast<size_t>(mb) << 20 : 0;
+}
+
+std::string RelationGraph::default_path() {
+    if (const char* p = std::getenv("HARTONOMOUS_RELATION_GRAPH")) return p;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/relation_graph.bin";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/relation_graph.bin";
+    return "";
+}
+
+std::string RelationGraph::database_fingerprint(PostgresConnection& db, bool tenants) {
+    // Ratings are updated in place, so n_tup_upd counts as well
+    auto fp = db.query_single(
+        "SELECT current_database() || '@' || COALESCE(inet_server_port()::text, 'local') || '|' || "
+        "COALESCE(string_agg(relid::text || ':' || n_tup_ins || ':' || n_tup_upd || ':' || n_tup_del, "
+        "',' ORDER BY relname), '') "
+        "FROM pg_stat_user_tables WHERE schemaname = 'hartonomous' "
+        "AND relname IN ('relationsequence', 'relationrating'" +
+        std::string(tenants ? ", 'relationevidence', 'content', 'tenant'" : "") + ")");
+    return fp.value_or("") + (tenants ? "|tenants" : "");
+}
+
+RelationGraph::TenantMask RelationGraph::tenant_view(const RelationGraph* graph,
+                                                    const std::optional<BLAKE3Pipeline::Hash>& tenant) {
+    if (!tenant) return ALL_TENANTS;
+    if (!graph || !graph->has_masks_)
+        throw std::runtime_error("Tenant isolation needs a relation graph loaded with tenant masks");
+    return graph->tenant_mask(*tenant);
+}
+
+std::string RelationGraph::relation_tenants_sql(const std::vector<BLAKE3Pipeline::Hash>& tenants) {
+    if (tenants.empty()) return "SELECT NULL::uuid AS relationid, 0::int8 AS tenants WHERE false";
+    std::string slots;
+    for (size_t i = 0; i < tenants.size(); ++i) {
+        if (i) slots += ", ";
+        slots += "('" + BLAKE3Pipeline::to_hex(tenants[i]) + "'::uuid, " + std::to_string(i) + ")";
+    }
+    return R"(
+        SELECT re.relationid, bit_or(int8 '1' << s.slot) AS tenants
+        FROM hartonomous.relationevidence re
+        JOIN hartonomous.content ct ON ct.id = re.contentid
+        JOIN (VALUES )" + slots + R"() AS s(id, slot) ON s.id = ct.tenantid
+        WHERE re.isvalid
+        GROUP BY re.relationid
+    )";
+}
+
+void RelationGraph::interleave_arrays() const {
+    place_array(owned_ids_);
+    place_array(owned_offsets_);
+    place_array(owned_edges_);
+    place_array(owned_masks_);
+    place_array(owned_summaries_);
+    place_array(owned_hubs_);
+    place_array(owned_packed_rows_);
+    place_array(owned_packed_bytes_);
+    place_array(owned_relation_counts_);
+}
+
+RelationGraph::NodeSummary RelationGraph::summarize(std::span<const Edge> row, std::vector<uint32_t>& hub) {
+    NodeSummary s;
+    s.degree = static_cast<uint32_t>(row.size());
+    if (row.empty()) return s;
+    s.min_elo = s.max_elo = row[0].max_elo;
+    for (const auto& e : row) {
+        s.min_elo = std::min(s.min_elo, e.max_elo);
+        s.max_elo = std::max(s.max_elo, e.max_elo);
+        s.max_obs = std::max(s.max_obs, e.total_obs);
+        s.total_obs += e.total_obs;
+    }
+    if (row.size() <= HUB_DEGREE) return s;
+
+    // Best first; equal ranks keep row (target) order so lists are reproducible
+    thread_local std::vector<uint32_t> order;
+    order.resize(row.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::partial_sort(order.begin(), order.begin() + HUB_TOP, order.end(), [&](uint32_t a, uint32_t b) {
+        const double ra = hub_rank(row[a], s), rb = hub_rank(row[b], s);
+        return ra != rb ? ra > rb : a < b;
+    });
+    s.hub_count = HUB_TOP;
+    hub.insert(hub.end(), order.begin(), order.begin() + HUB_TOP);
+    return s;
+}
+
+void RelationGraph::summarize_rows() {
+    owned_summaries_.clear();
+    owned_hubs_.clear();
+    owned_summaries_.reserve(base_nodes_);
+    std::vector<Edge> scratch;
+    for (size_t i = 0; i < base_nodes_; ++i) {
+        const uint64_t at = owned_hubs_.size();
+        NodeSummary s = summarize(neighbors(static_cast<uint32_t>(i), scratch), owned_hubs_);
+        s.hub_offset = s.hub_count ? at : 0;
+        owned_summaries_.push_back(s);
+    }
+    summaries_ = owned_summaries_.data();
+    hubs_ = owned_hubs_.data();
+    hub_entries_ = owned_hubs_.size();
+}
+
+void RelationGraph::build_index() {
+    index_.reserve(base_nodes_);
+    for (size_t i = 0; i < base_nodes_; ++i)
+        index_.try_emplace(ids_[i], static_cast<uint32_t>(i));
+}
+
+// An edge and its tenant mask while rows are sorted and merged
+struct StagedEdge {
+    RelationGraph::Edge edge;
+    RelationGraph::TenantMask tenants;
+};
+
+// Sort a row by target and merge duplicate targets in place; returns the new length
+static size_t sort_merge_row(StagedEdge* first, StagedEdge* last) {
+    std::sort(first, last, [](const StagedEdge& a, const StagedEdge& b) { return a.edge.target < b.edge.target; });
+    size_t out = 0;
+    for (StagedEdge* e = first; e != last; ++e) {
+        if (out > 0 && first[out - 1].edge.target == e->edge.target) {
+            auto& m = first[out - 1];
+            m.edge.relation_count += e->edge.relation_count;
+            m.edge.max_elo = std::max(m.edge.max_elo, e->edge.max_elo);
+            m.edge.total_obs += e->edge.total_obs;
+            m.tenants |= e->tenants;
+        } else {
+            first[out++] = *e;
+        }
+    }
+    return out;
+}
+
+std::shared_ptr<RelationGraph> RelationGraph::build(std::vector<EdgeRecord>& edges, std::string fingerprint,
+                                                    std::vector<BLAKE3Pipeline::Hash> tenants, bool masks) {
+    if (tenants.size() > MAX_TENANTS) throw std::runtime_error("Relation graph supports at most 64 tenant slots");
+    std::shared_ptr<RelationGraph> g(new RelationGraph());
+    g->fingerprint_ = std::move(fingerprint);
+    g->tenants_ = std::move(tenants);
+    g->has_masks_ = masks;
+
+    // Dense ids in first-seen order; sources and targets share one index
+    auto intern = [&](const BLAKE3Pipeline::Hash& id) {
+        auto [slot, inserted] = g->index_.try_emplace(id, static_cast<uint32_t>(g->owned_ids_.size()));
+        if (inserted) g->owned_ids_.push_back(id);
+        return *slot;
+    };
+    std::vector<uint32_t> sources(edges.size());
+    std::vector<uint32_t> targets(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        sources[i] = intern(edges[i].source);
+        targets[i] = intern(edges[i].target);
+    }
+    if (g->owned_ids_.size() >= NPOS) throw std::runtime_error("Relation graph exceeds 2^32 compositions");
+
+    size_t n = g->owned_ids_.size();
+    g->owned_offsets_.assign(n + 1, 0);
+    for (uint32_t s : sources) ++g->owned_offsets_[s + 1];
+    for (size_t i = 0; i < n; ++i) g->owned_offsets_[i + 1] += g->owned_offsets_[i];
+
+    std::vector<uint64_t> cursor(g->owned_offsets_.begin(), g->owned_offsets_.end() - 1);
+    std::vector<StagedEdge> staged(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        staged[cursor[sources[i]]++] = {{targets[i], edges[i].relation_count, edges[i].max_elo, edges[i].total_obs},
+                                        edges[i].tenants};
+    }
+
+    size_t out = 0;
+    for (size_t s = 0; s < n; ++s) {
+        size_t begin = g->owned_offsets_[s];
+        size_t end = g->owned_offsets_[s + 1];
+        g->owned_offsets_[s] = out;
+        size_t len = sort_merge_row(staged.data() + begin, staged.data() + end);
+        std::copy(staged.begin() + begin, staged.begin() + begin + len, staged.begin() + out);
+        out += len;
+    }
+    g->owned_offsets_[n] = out;
+
+    g->owned_edges_.reserve(out);
+    for (size_t i = 0; i < out; ++i) g->owned_edges_.push_back(staged[i].edge);
+    if (masks) {
+        g->owned_masks_.reserve(out);
+        for (size_t i = 0; i < out; ++i) g->owned_masks_.push_back(staged[i].tenants);
+    }
+
+    g->base_nodes_ = n;
+    g->edge_count_ = out;
+    g->ids_ = g->owned_ids_.data();
+    g->offsets_ = g->owned_offsets_.data();
+    g->edges_ = g->owned_edges_.data();
+    g->masks_ = g->owned_masks_.data();
+    g->summarize_rows();
+    g->interleave_arrays();
+    return g;
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::from_edges(std::vector<EdgeRecord> edges, std::string fingerprint,
+                                                               std::vector<BLAKE3Pipeline::Hash> tenants) {
+    const bool masks = !tenants.empty();
+    return build(edges, std::move(fingerprint), std::move(tenants), masks);
+}
+
+std::vector<RelationGraph::EdgeRecord> RelationGraph::copy_edges(PostgresConnection& db, const std::string& select_sql) {
+    std::vector<EdgeRecord> edges;
+    db.copy_out("COPY (" + select_sql + ") TO STDOUT (FORMAT binary)",
+                [&](const char* buf, int len) { parse_edge_message(buf, len, edges); });
+    return edges;
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::from_snapshot(const SubstrateSnapshot& snapshot) {
+    using Field = SubstrateSnapshot::Field;
+    const auto field = [](const Field& f, uint32_t size) {
+        if (f.is_null() || f.size != size) throw std::runtime_error("Malformed field in relation graph snapshot scan");
+        return reinterpret_cast<const char*>(f.data);
+    };
+
+    // Relation -> (rating, observations), then -> members in snapshot order
+    struct Members {
+        double elo = 0.0;
+        double obs = 0.0;
+        std::vector<BLAKE3Pipeline::Hash> compositions;
+    };
+    std::vector<Members> relations;
+    HashMap128<uint32_t> relation_index;
+    snapshot.scan("relationrating", {"relationid", "ratingvalue", "observations"}, [&](std::span<const Field> row) {
+        BLAKE3Pipeline::Hash id;
+        std::memcpy(id.data(), field(row[0], 16), 16);
+        uint64_t obs;
+        std::memcpy(&obs, field(row[2], 8), 8);
+        if (relation_index.try_emplace(id, static_cast<uint32_t>(relations.size())).second)
+            relations.push_back({copy_float8(field(row[1], 8)), static_cast<double>(__builtin_bswap64(obs)), {}});
+    });
+    snapshot.scan("relationsequence", {"relationid", "compositionid"}, [&](std::span<const Field> row) {
+        BLAKE3Pipeline::Hash id, comp;
+        std::memcpy(id.data(), field(row[0], 16), 16);
+        std::memcpy(comp.data(), field(row[1], 16), 16);
+        if (const uint32_t* r = relation_index.find(id)) relations[*r].compositions.push_back(comp);
+    });
+
+    // One edge per ordered pair of member rows with different compositions, as the join produces
+    std::vector<EdgeRecord> edges;
+    for (const auto& rel : relations)
+        for (const auto& a : rel.compositions)
+            for (const auto& b : rel.compositions)
+                if (a != b) edges.push_back({a, b, rel.elo, rel.obs, 1});
+    relations.clear();
+    relations.shrink_to_fit();
+    return build(edges, "snapshot:" + snapshot.id(), {}, false);
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::load_from_db(PostgresConnection& db, bool tenants) {
+    std::string fp = database_fingerprint(db, tenants);
+
+    if (!tenants) {
+        // Same join the engines ran per expansion, aggregated per (source, target)
+        // once: count(*) keeps the multiplicity of shared relations
+        auto edges = copy_edges(db, R"(
+            SELECT rs1.compositionid, rs2.compositionid,
+                   max(rr.ratingvalue)::float8,
+                   sum(uint64_to_double(rr.observations))::float8,
+                   count(*)::int8
+            FROM hartonomous.relationsequence rs1
+            JOIN hartonomous.relationsequence rs2
+                ON rs2.relationid = rs1.relationid
+                AND rs2.compositionid != rs1.compositionid
+            JOIN hartonomous.relationrating rr
+                ON rr.relationid = rs1.relationid
+            GROUP BY rs1.compositionid, rs2.compositionid
+        )");
+        return build(edges, std::move(fp), {}, false);
+    }
+
+    std::vector<BLAKE3Pipeline::Hash> slots;
+    db.query("SELECT id FROM hartonomous.tenant ORDER BY id LIMIT " + std::to_string(MAX_TENANTS), {},
+             [&](const std::vector<std::string>& row) { slots.push_back(BLAKE3Pipeline::from_hex(row[0])); });
+
+    // As above, with the union of the contributing relations' tenant masks
+    auto edges = copy_edges(db, R"(
+        SELECT rs1.compositionid, rs2.compositionid,
+               max(rr.ratingvalue)::float8,
+               sum(uint64_to_double(rr.observations))::float8,
+               count(*)::int8,
+               bit_or(COALESCE(rt.tenants, 0))::int8
+        FROM hartonomous.relationsequence rs1
+        JOIN hartonomous.relationsequence rs2
+            ON rs2.relationid = rs1.relationid
+            AND rs2.compositionid != rs1.compositionid
+        JOIN hartonomous.relationrating rr
+            ON rr.relationid = rs1.relationid
+        LEFT JOIN ()" + relation_tenants_sql(slots) + R"() rt
+            ON rt.relationid = rs1.relationid
+        GROUP BY rs1.compositionid, rs2.compositionid
+    )");
+    return build(edges, std::move(fp), std::move(slots), true);
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::with_rows(const std::shared_ptr<const RelationGraph>& graph,
+                                                             const std::vector<EdgeRecord>& rows) {
+    const auto& base = graph->base_ ? graph->base_ : graph;
+
+    std::shared_ptr<RelationGraph> g(new RelationGraph());
+    g->base_ = base;
+    g->base_nodes_ = base->base_nodes_;
+    g->ids_ = base->ids_;
+    g->offsets_ = base->offsets_;
+    g->edges_ = base->edges_;
+    g->base_index_ = base->base_index_;
+    g->edge_count_ = graph->edge_count_;
+    g->overlay_ids_ = graph->overlay_ids_;
+    g->overlay_index_ = graph->overlay_index_;
+    g->overlay_rows_ = graph->overlay_rows_;
+    g->overlay_masks_ = graph->overlay_masks_;
+    g->overlay_summaries_ = graph->overlay_summaries_;
+    g->overlay_edges_ = graph->overlay_edges_;
+    g->summaries_ = base->summaries_;
+    g->hubs_ = base->hubs_;
+    g->hub_entries_ = base->hub_entries_;
+    g->masks_ = base->masks_;
+    g->has_masks_ = base->has_masks_;
+    g->tenants_ = base->tenants_;
+    g->packed_ = base->packed_;
+
+    auto intern = [&](const BLAKE3Pipeline::Hash& id) {
+        uint32_t i = g->index_of(id);
+        if (i != NPOS) return i;
+        i = static_cast<uint32_t>(g->node_count());
+        if (i == NPOS) throw std::runtime_error("Relation graph exceeds 2^32 compositions");
+        g->overlay_ids_.push_back(id);
+        g->overlay_index_.try_emplace(id, i);
+        return i;
+    };
+
+    std::unordered_map<uint32_t, std::vector<StagedEdge>> fresh;
+    for (const auto& r : rows) {
+        uint32_t s = intern(r.source);
+        fresh[s].push_back({{intern(r.target), r.relation_count, r.max_elo, r.total_obs}, r.tenants});
+    }
+
+    for (auto& [s, staged] : fresh) {
+        staged.resize(sort_merge_row(staged.data(), staged.data() + staged.size()));
+        std::vector<Edge> row;
+        row.reserve(staged.size());
+        for (const auto& e : staged) row.push_back(e.edge);
+        if (g->has_masks_) {
+            std::vector<TenantMask> masks;
+            masks.reserve(staged.size());
+            for (const auto& e : staged) masks.push_back(e.tenants);
+            g->overlay_masks_[s] = std::move(masks);
+        }
+
+        // Only the replaced rows are summarized again
+        auto& summary = g->overlay_summaries_[s];
+        summary.hub.clear();
+        summary.summary = summarize(row, summary.hub);
+
+        size_t old = g->neighbors(s).size();
+        if (g->overlay_rows_.count(s)) g->overlay_edges_ -= old;
+        g->edge_count_ = g->edge_count_ - old + row.size();
+        g->overlay_edges_ += row.size();
+        g->overlay_rows_[s] = std::move(row);
+    }
+    return g;
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::compact() const {
+    return packed_.rows ? pack_rows(true) : flatten(true);
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::replicate() const {
+    return packed_.rows ? pack_rows(false) : flatten(false);
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::pack() const { return pack_rows(true); }
+
+std::shared_ptr<RelationGraph> RelationGraph::flatten(bool interleave) const {
+    std::shared_ptr<RelationGraph> g(new RelationGraph());
+    size_t n = node_count();
+    g->fingerprint_ = fingerprint_;
+    g->tenants_ = tenants_;
+    g->has_masks_ = has_masks_;
+    g->owned_ids_.reserve(n);
+    g->owned_offsets_.reserve(n + 1);
+    g->owned_edges_.reserve(edge_count_);
+    if (has_masks_) g->owned_masks_.reserve(edge_count_);
+    if (interleave) g->interleave_arrays();   // Before the fill, so pages fault in already spread
+    for (uint32_t i = 0; i < n; ++i) {
+        g->owned_ids_.push_back(id_of(i));
+        g->owned_offsets_.push_back(g->owned_edges_.size());
+        auto row = neighbors(i);
+        g->owned_edges_.insert(g->owned_edges_.end(), row.begin(), row.end());
+        if (has_masks_) {
+            auto masks = tenant_masks(i);
+            g->owned_masks_.insert(g->owned_masks_.end(), masks.begin(), masks.end());
+        }
+    }
+    g->owned_offsets_.push_back(g->owned_edges_.size());
+
+    g->base_nodes_ = n;
+    g->edge_count_ = g->owned_edges_.size();
+    g->ids_ = g->owned_ids_.data();
+    g->offsets_ = g->owned_offsets_.data();
+    g->edges_ = g->owned_edges_.data();
+    g->masks_ = g->owned_masks_.data();
+    g->summarize_rows();
+    g->build_index();
+    return g;
+}
+
+// Observation width of a packed row: 1 when every count fits a byte exactly, else 2
+static size_t obs_width(std::span<const RelationGraph::Edge> row) {
+    for (const auto& e : row)
+        if (!edge_codec::obs_fits_byte(e.total_obs)) return 2;
+    return 1;
+}
+
+// Encoded size of one row: targets, 16-bit ELO, then observations
+static size_t packed_row_bytes(std::span<const RelationGraph::Edge> row) {
+    if (row.empty()) return 0;
+    size_t bytes = edge_codec::control_bytes(row.size());
+    uint32_t prev = 0;
+    for (const auto& e : row) {
+        const uint32_t delta = e.target - prev;
+        prev = e.target;
+        bytes += delta < (1u << 8) ? 1 : delta < (1u << 16) ? 2 : delta < (1u << 24) ? 3 : 4;
+    }
+    return bytes + row.size() * (2 + obs_width(row));
+}
+
+std::shared_ptr<RelationGraph> RelationGraph::pack_rows(bool interleave) const {
+    std::shared_ptr<RelationGraph> g(new RelationGraph());
+    const size_t n = node_count();
+    g->fingerprint_ = fingerprint_;
+    g->tenants_ = tenants_;
+    g->has_masks_ = has_masks_;
+
+    // First pass: the ELO range and the exact size, so every array is allocated once
+    std::vector<Edge> scratch;
+    double elo_min = std::numeric_limits<double>::infinity();
+    double elo_max = -elo_min;
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        const auto row = neighbors(i, scratch);
+        for (const auto& e : row) {
+            elo_min = std::min(elo_min, e.max_elo);
+            elo_max = std::max(elo_max, e.max_elo);
+        }
+        bytes += packed_row_bytes(row);
+    }
+    if (elo_min > elo_max) elo_min = elo_max = 0.0;
+    g->packed_.elo_min = elo_min;
+    g->packed_.elo_step = elo_max > elo_min ? (elo_max - elo_min) / 65535.0 : 1.0;
+
+    g->owned_ids_.reserve(n);
+    g->owned_offsets_.reserve(n + 1);
+    g->owned_packed_rows_.reserve(n + 1);
+    g->owned_packed_bytes_.reserve(bytes + edge_codec::STREAM_PADDING);
+    g->owned_relation_counts_.reserve(edge_count_);
+    if (has_masks_) g->owned_masks_.reserve(edge_count_);
+    if (interleave) g->interleave_arrays();   // Before the fill, so pages fault in already spread
+
+    std::vector<uint32_t> targets;
+    for (uint32_t i = 0; i < n; ++i) {
+        g->owned_ids_.push_back(id_of(i));
+        g->owned_offsets_.push_back(g->owned_relation_counts_.size());
+        g->owned_packed_rows_.push_back(g->owned_packed_bytes_.size());
+        const auto row = neighbors(i, scratch);
+        if (row.empty()) continue;
+
+        const size_t at = g->owned_packed_bytes_.size();
+        g->owned_packed_bytes_.resize(at + packed_row_bytes(row));
+        uint8_t* out = g->owned_packed_bytes_.data() + at;
+        targets.resize(row.size());
+        for (size_t j = 0; j < row.size(); ++j) targets[j] = row[j].target;
+        out += edge_codec::encode_targets(targets.data(), row.size(), out);
+        for (const auto& e : row) {
+            const double code = std::round((e.max_elo - elo_min) / g->packed_.elo_step);
+            const uint16_t q = static_cast<uint16_t>(std::clamp(code, 0.0, 65535.0));
+            std::memcpy(out, &q, 2);
+            out += 2;
+        }
+        if (obs_width(row) == 1) {
+            for (const auto& e : row) *out++ = static_cast<uint8_t>(e.total_obs);
+        } else {
+            for (const auto& e : row) {
+                const uint16_t q = edge_codec::encode_obs_log(e.total_obs);
+                std::memcpy(out, &q, 2);
+                out += 2;
+            }
+        }
+        for (const auto& e : row) g->owned_relation_counts_.push_back(e.relation_count);
+        if (has_masks_) {
+            auto masks = tenant_masks(i);
+            g->owned_masks_.insert(g->owned_masks_.end(), masks.begin(), masks.end());
+        }
+    }
+    g->owned_offsets_.push_back(g->owned_relation_counts_.size());
+    g->owned_packed_rows_.push_back(g->owned_packed_bytes_.size());
+    g->owned_packed_bytes_.resize(g->owned_packed_bytes_.size() + edge_codec::STREAM_PADDING, 0);
+
+    g->base_nodes_ = n;
+    g->edge_count_ = g->owned_relation_counts_.size();
+    g->ids_ = g->owned_ids_.data();
+    g->offsets_ = g->owned_offsets_.data();
+    g->masks_ = g->owned_masks_.data();
+    g->packed_.rows = g->owned_packed_rows_.data();
+    g->packed_.bytes = g->owned_packed_bytes_.data();
+    g->packed_.relation_counts = g->owned_relation_counts_.data();
+    g->packed_.byte_count = g->owned_packed_bytes_.size();
+    g->summarize_rows();   // From the quantized values, as engines will read them
+    g->build_index();
+    return g;
+}
+
+std::vector<RelationGraph::Edge>& RelationGraph::thread_row() {
+    thread_local std::vector<Edge> row;
+    return row;
+}
+
+std::span<const RelationGraph::Edge> RelationGraph::decode_row(uint32_t index, std::vector<Edge>& out) const {
+    const uint64_t first = offsets_[index];
+    const size_t n = offsets_[index + 1] - first;
+    out.resize(n);
+    if (n == 0) return {};
+
+    thread_local std::vector<uint32_t> targets;
+    if (targets.size() < n) targets.resize(n);
+    const uint8_t* p = packed_.bytes + packed_.rows[index];
+    const uint8_t* end = packed_.bytes + packed_.rows[index + 1];
+    p += edge_codec::decode_targets(p, n, targets.data());
+    const uint8_t* elo = p;
+    const uint8_t* obs = p + 2 * n;
+    const uint32_t* counts = packed_.relation_counts + first;
+    const bool wide = static_cast<size_t>(end - obs) == 2 * n;
+    for (size_t i = 0; i < n; ++i) {
+        uint16_t q;
+        std::memcpy(&q, elo + 2 * i, 2);
+        double o;
+        if (wide) {
+            uint16_t c;
+            std::memcpy(&c, obs + 2 * i, 2);
+            o = edge_codec::decode_obs_log(c);
+        } else {
+            o = obs[i];
+        }
+        out[i] = {targets[i], counts[i], packed_.elo_min + q * packed_.elo_step, o};
+    }
+    return out;
+}
+
+// Whether packed rows decode to ascending targets below `nodes` and fill their byte range exactly
+static bool valid_packed_rows(const uint64_t* offsets, const uint64_t* rows, const uint8_t* bytes, size_t nodes) {
+    std::vector<uint32_t> targets;
+    for (size_t i = 0; i < nodes; ++i) {
+        const size_t n = offsets[i + 1] - offsets[i];
+        const size_t len = rows[i + 1] - rows[i];
+        if (n == 0) {
+            if (len != 0) return false;
+            continue;
+        }
+        const uint8_t* p = bytes + rows[i];
+        if (edge_codec::control_bytes(n) > len) return false;
+        const size_t target_bytes = edge_codec::encoded_target_bytes(p, n);
+        if (target_bytes > len || (len - target_bytes != 3 * n && len - target_bytes != 4 * n)) return false;
+        targets.resize(n);
+        edge_codec::decode_targets(p, n, targets.data());
+        for (size_t j = 0; j < n; ++j)
+            if (targets[j] >= nodes || (j > 0 && targets[j] <= targets[j - 1])) return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::load_file(const std::string& path, const std::string& fingerprint) {
+    return shared_file(path, fingerprint, false);
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::load_paged(const std::string& path, const std::string& fingerprint,
+                                                               size_t hot_bytes) {
+    return shared_file(path, fingerprint, false, true, hot_bytes);
+}
+
+template <typename F>
+void RelationGraph::for_each_row_range(uint32_t index, F&& f) const {
+    const uint64_t first = offsets_[index], last = offsets_[index + 1];
+    if (first == last) return;
+    if (packed_.rows) {
+        f(packed_.bytes + packed_.rows[index], packed_.rows[index + 1] - packed_.rows[index]);
+        f(packed_.relation_counts + first, (last - first) * sizeof(uint32_t));
+    } else {
+        f(edges_ + first, (last - first) * sizeof(Edge));
+    }
+    if (has_masks_) f(masks_ + first, (last - first) * sizeof(TenantMask));
+}
+
+void RelationGraph::pin_hot_set(size_t budget) {
+    const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    bool lockable = true;   // Until mlock first fails (RLIMIT_MEMLOCK)
+    auto hold = [&](const void* p, size_t bytes) {
+        if (bytes == 0) return;
+        const uintptr_t lo = reinterpret_cast<uintptr_t>(p) & ~(page - 1);
+        const uintptr_t hi = (reinterpret_cast<uintptr_t>(p) + bytes + page - 1) & ~(page - 1);
+        void* at = reinterpret_cast<void*>(lo);
+        if (lockable && pinned_bytes_ + (hi - lo) <= budget && ::mlock(at, hi - lo) == 0) {
+            pinned_bytes_ += hi - lo;
+            return;
+        }
+        if (pinned_bytes_ + (hi - lo) <= budget) lockable = false;
+        ::madvise(at, hi - lo, MADV_WILLNEED);
+    };
+
+    hold(ids_, base_nodes_ * sizeof(BLAKE3Pipeline::Hash));
+    hold(offsets_, (base_nodes_ + 1) * sizeof(uint64_t));
+    if (packed_.rows) hold(packed_.rows, (base_nodes_ + 1) * sizeof(uint64_t));
+    hold(summaries_, base_nodes_ * sizeof(NodeSummary));
+    hold(hubs_, hub_entries_ * sizeof(uint32_t));
+
+    // Hubs are where walks and searches keep coming back, largest first
+    std::vector<uint32_t> hubs;
+    for (uint32_t i = 0; i < base_nodes_; ++i)
+        if (summaries_[i].degree > HUB_DEGREE) hubs.push_back(i);
+    std::sort(hubs.begin(), hubs.end(), [&](uint32_t a, uint32_t b) {
+        return summaries_[a].degree != summaries_[b].degree ? summaries_[a].degree > summaries_[b].degree : a < b;
+    });
+    for (uint32_t hub : hubs) {
+        if (pinned_bytes_ >= budget) break;
+        for_each_row_range(hub, hold);
+    }
+}
+
+void RelationGraph::prefetch(std::span<const uint32_t> indices) const {
+    if (!paged_ || indices.empty()) return;
+    const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    thread_local std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    ranges.clear();
+    for (uint32_t index : indices) {
+        if (index >= base_nodes_) continue;
+        for_each_row_range(index, [&](const void* p, size_t bytes) {
+            ranges.emplace_back(reinterpret_cast<uintptr_t>(p) & ~(page - 1),
+                                (reinterpret_cast<uintptr_t>(p) + bytes + page - 1) & ~(page - 1));
+        });
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 0; i < ranges.size();) {
+        uintptr_t lo = ranges[i].first, hi = ranges[i].second;
+        for (++i; i < ranges.size() && ranges[i].first <= hi; ++i) hi = std::max(hi, ranges[i].second);
+        ::madvise(reinterpret_cast<void*>(lo), hi - lo, MADV_WILLNEED);
+    }
+}
+
+size_t RelationGraph::resident_bytes() const {
+    if (!map_addr_) return 0;
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    constexpr size_t CHUNK_PAGES = size_t(1) << 20;
+    std::vector<unsigned char> vec;
+    size_t resident = 0;
+    for (size_t off = 0; off < map_size_; off += CHUNK_PAGES * page) {
+        const size_t len = std::min(map_size_ - off, CHUNK_PAGES * page);
+        vec.resize((len + page - 1) / page);
+        if (::mincore(static_cast<uint8_t*>(map_addr_) + off, len, vec.data()) != 0) return 0;
+        for (unsigned char v : vec) resident += (v & 1) ? page : 0;
+    }
+    return std::min(resident, map_size_);
+}
+
+bool RelationGraph::pin_file(const std::string& path) {
+    return shared_file(path, "", true) != nullptr;
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::shared_file(const std::string& path, const std::string& fingerprint,
+                                                                bool pin, bool paged, size_t hot_bytes) {
+    // Pinned files, each served from its one mapping while unchanged
+    struct Entry {
+        std::shared_ptr<const RelationGraph> graph;
+        dev_t dev = 0;
+        ino_t ino = 0;
+        off_t size = 0;
+        int64_t mtime_ns = 0;
+    };
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, Entry> registry;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < GRAPH_HEADER_BYTES) {
+        ::close(fd);
+        return nullptr;
+    }
+    const int64_t mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+    std::lock_guard<std::mutex> registry_lock(registry_mutex);
+    if (auto it = registry.find(path); it != registry.end()) {
+        const Entry& e = it->second;
+        if (e.dev == st.st_dev && e.ino == st.st_ino && e.size == st.st_size && e.mtime_ns == mtime_ns) {
+            ::close(fd);
+            if (!fingerprint.empty() && e.graph->fingerprint() != fingerprint) return nullptr;
+            return e.graph;
+        }
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    size_t mapped = size;
+    void* addr;
+    if (paged) {
+        // Page cache only: a huge page copy or first-touch pass would need it all in memory
+        addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) ::madvise(addr, size, MADV_SEQUENTIAL);   // For the verification pass
+    } else {
+        addr = map_file_readonly(fd, size, mapped);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    if (!paged) numa_first_touch(addr, size);   // Before the checksum faults it all in from this thread
+
+    const uint8_t* base = static_cast<const uint8_t*>(addr);
+    GraphHeader hdr;
+    std::memcpy(&hdr, base, sizeof(hdr));
+
+    GraphHeader expected{};
+    bool ok = std::memcmp(hdr.magic, GRAPH_MAGIC, 8) == 0 &&
+              hdr.version == GRAPH_VERSION &&
+              hdr.file_size == size &&
+              hdr.node_count < NPOS &&
+              GRAPH_HEADER_BYTES + hdr.fingerprint_len <= size &&
+              hdr.tenant_count <= MAX_TENANTS &&
+              hdr.hub_entries <= size / sizeof(uint32_t) &&
+              hdr.packed_bytes <= size &&
+              (hdr.packed_bytes == 0 || (hdr.packed_bytes >= edge_codec::STREAM_PADDING &&
+                                         std::isfinite(hdr.elo_min) && std::isfinite(hdr.elo_step))) &&
+              layout_graph(hdr.fingerprint_len, hdr.node_count, hdr.edge_count, hdr.tenant_count,
+                           hdr.masks_offset != 0, hdr.hub_entries, hdr.packed_bytes, expected) == size &&
+              expected.ids_offset == hdr.ids_offset &&
+              expected.offsets_offset == hdr.offsets_offset &&
+              expected.edges_offset == hdr.edges_offset &&
+              expected.packed_rows_offset == hdr.packed_rows_offset &&
+              expected.packed_offset == hdr.packed_offset &&
+              expected.relation_counts_offset == hdr.relation_counts_offset &&
+              expected.tenants_offset == hdr.tenants_offset &&
+              expected.masks_offset == hdr.masks_offset &&
+              expected.summaries_offset == hdr.summaries_offset &&
+              expected.hubs_offset == hdr.hubs_offset;
+    std::string stored_fp;
+    if (ok) {
+        stored_fp.assign(reinterpret_cast<const char*>(base + GRAPH_HEADER_BYTES), hdr.fingerprint_len);
+        ok = fingerprint.empty() || stored_fp == fingerprint;
+    }
+    if (ok) {
+        auto sum = BLAKE3Pipeline::hash(base + GRAPH_HEADER_BYTES, size - GRAPH_HEADER_BYTES);
+        ok = std::memcmp(sum.data(), hdr.checksum, 16) == 0;
+    }
+    if (ok) {
+        // Structure check so neighbors() can trust offsets and targets
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + hdr.offsets_offset);
+        ok = offsets[0] == 0 && offsets[hdr.node_count] == hdr.edge_count;
+        for (size_t i = 0; ok && i < hdr.node_count; ++i) ok = offsets[i] <= offsets[i + 1];
+        if (!hdr.packed_bytes) {
+            const Edge* edges = reinterpret_cast<const Edge*>(base + hdr.edges_offset);
+            for (size_t i = 0; ok && i < hdr.edge_count; ++i) ok = edges[i].target < hdr.node_count;
+        } else {
+            // Row offsets, then every row decoded once
+            const uint64_t* rows = reinterpret_cast<const uint64_t*>(base + hdr.packed_rows_offset);
+            ok = ok && rows[0] == 0 && rows[hdr.node_count] + edge_codec::STREAM_PADDING == hdr.packed_bytes;
+            for (size_t i = 0; ok && i < hdr.node_count; ++i) ok = rows[i] <= rows[i + 1];
+            ok = ok && valid_packed_rows(offsets, rows, base + hdr.packed_offset, hdr.node_count);
+        }
+
+        // And summaries so hub_edges() can trust their lists
+        const auto* summaries = reinterpret_cast<const NodeSummary*>(base + hdr.summaries_offset);
+        const auto* hubs = reinterpret_cast<const uint32_t*>(base + hdr.hubs_offset);
+        for (size_t i = 0; ok && i < hdr.node_count; ++i) {
+            const auto& s = summaries[i];
+            ok = s.degree == offsets[i + 1] - offsets[i] && s.hub_count <= s.degree &&
+                 s.hub_offset <= hdr.hub_entries && s.hub_count <= hdr.hub_entries - s.hub_offset;
+            for (uint32_t h = 0; ok && h < s.hub_count; ++h) ok = hubs[s.hub_offset + h] < s.degree;
+        }
+    }
+    if (!ok) {
+        ::munmap(addr, mapped);
+        return nullptr;
+    }
+
+    std::shared_ptr<RelationGraph> g(new RelationGraph());
+    g->map_addr_ = addr;
+    g->map_size_ = mapped;
+    g->fingerprint_ = std::move(stored_fp);
+    g->base_nodes_ = hdr.node_count;
+    g->edge_count_ = hdr.edge_count;
+    // Sections are 64-byte aligned, so the arrays are read in place
+    g->ids_ = reinterpret_cast<const BLAKE3Pipeline::Hash*>(base + hdr.ids_offset);
+    g->offsets_ = reinterpret_cast<const uint64_t*>(base + hdr.offsets_offset);
+    if (!hdr.packed_bytes) {
+        g->edges_ = reinterpret_cast<const Edge*>(base + hdr.edges_offset);
+    } else {
+        g->packed_.rows = reinterpret_cast<const uint64_t*>(base + hdr.packed_rows_offset);
+        g->packed_.bytes = base + hdr.packed_offset;
+        g->packed_.relation_counts = reinterpret_cast<const uint32_t*>(base + hdr.relation_counts_offset);
+        g->packed_.byte_count = hdr.packed_bytes;
+        g->packed_.elo_min = hdr.elo_min;
+        g->packed_.elo_step = hdr.elo_step;
+    }
+    g->summaries_ = reinterpret_cast<const NodeSummary*>(base + hdr.summaries_offset);
+    g->hubs_ = reinterpret_cast<const uint32_t*>(base + hdr.hubs_offset);
+    g->hub_entries_ = hdr.hub_entries;
+    if (hdr.masks_offset) {
+        g->has_masks_ = true;
+        g->masks_ = reinterpret_cast<const TenantMask*>(base + hdr.masks_offset);
+        const auto* slots = reinterpret_cast<const BLAKE3Pipeline::Hash*>(base + hdr.tenants_offset);
+        g->tenants_.assign(slots, slots + hdr.tenant_count);
+    }
+    g->build_index();
+    if (paged) {
+        g->paged_ = true;
+        ::madvise(addr, size, MADV_RANDOM);
+        g->pin_hot_set(hot_bytes);
+    }
+
+    if (pin) registry[path] = Entry{g, st.st_dev, st.st_ino, st.st_size, mtime_ns};
+    return g;
+}
+
+void RelationGraph::write_file(const std::string& path) const {
+    if (base_) {
+        compact()->write_file(path);
+        return;
+    }
+
+    GraphHeader hdr{};
+    std::memcpy(hdr.magic, GRAPH_MAGIC, 8);
+    hdr.version = GRAPH_VERSION;
+    hdr.fingerprint_len = static_cast<uint32_t>(fingerprint_.size());
+    hdr.node_count = base_nodes_;
+    hdr.edge_count = edge_count_;
+    size_t size = layout_graph(fingerprint_.size(), base_nodes_, edge_count_, tenants_.size(), has_masks_,
+                               hub_entries_, packed_.byte_count, hdr);
+    hdr.file_size = size;
+    hdr.elo_min = packed_.elo_min;
+    hdr.elo_step = packed_.elo_step;
+
+    std::vector<uint8_t> buf(size, 0);
+    std::memcpy(buf.data() + GRAPH_HEADER_BYTES, fingerprint_.data(), fingerprint_.size());
+    std::memcpy(buf.data() + hdr.ids_offset, ids_, base_nodes_ * sizeof(BLAKE3Pipeline::Hash));
+    std::memcpy(buf.data() + hdr.offsets_offset, offsets_, (base_nodes_ + 1) * sizeof(uint64_t));
+    if (!packed_.rows) {
+        std::memcpy(buf.data() + hdr.edges_offset, edges_, edge_count_ * sizeof(Edge));
+    } else {
+        std::memcpy(buf.data() + hdr.packed_rows_offset, packed_.rows, (base_nodes_ + 1) * sizeof(uint64_t));
+        std::memcpy(buf.data() + hdr.packed_offset, packed_.bytes, packed_.byte_count);
+        std::memcpy(buf.data() + hdr.relation_counts_offset, packed_.relation_counts, edge_count_ * sizeof(uint32_t));
+    }
+    if (has_masks_) {
+        std::memcpy(buf.data() + hdr.tenants_offset, tenants_.data(), tenants_.size() * sizeof(BLAKE3Pipeline::Hash));
+        std::memcpy(buf.data() + hdr.masks_offset, masks_, edge_count_ * sizeof(TenantMask));
+    }
+    if (base_nodes_) std::memcpy(buf.data() + hdr.summaries_offset, summaries_, base_nodes_ * sizeof(NodeSummary));
+    if (hub_entries_) std::memcpy(buf.data() + hdr.hubs_offset, hubs_, hub_entries_ * sizeof(uint32_t));
+    auto sum = BLAKE3Pipeline::hash(buf.data() + GRAPH_HEADER_BYTES, size - GRAPH_HEADER_BYTES);
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path());
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) throw std::runtime_error("Failed to create relation graph: " + tmp);
+    bool ok = std::fwrite(buf.data(), 1, size, f) == size;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to write relation graph: " + path);
+    }
+}
+
+std::shared_ptr<const RelationGraph> RelationGraph::load(PostgresConnection& db, const std::string& path,
+                                                         bool tenants) {
+    std::string fp = database_fingerprint(db, tenants);
+    if (!path.empty()) {
+        if (auto g = paged_by_default() ? load_paged(path, fp) : load_file(path, fp)) return g;
+    }
+    auto g = load_from_db(db, tenants);
+    if (packed_by_default()) g = g->pack();
+    if (!path.empty()) {
+        // A cache that cannot be written is not fatal; the snapshot is still usable
+        try {
+            g->write_file(path);
+        } catch (const std::exception&) {
+        }
+    }
+    return g;
+}
+
+} // namespace Hartonomous
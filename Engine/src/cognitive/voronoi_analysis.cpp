@@ -1,15 +1,17 @@
 /**
  * @file voronoi_analysis.cpp
- * @brief Monte Carlo Voronoi cell analysis on S³
+ * @brief Monte Carlo and exact Voronoi cell analysis on S³
  *
  * Computes approximate Voronoi cell metrics by sampling random points
- * on S³ and classifying them by nearest composition centroid. This avoids
- * the computational expense of exact 4D Voronoi construction while
- * providing the metrics we actually need: volume, boundary distances,
- * eccentricity, and neighbor identification.
+ * on S³ and classifying them by nearest composition centroid, or exact ones
+ * from a cached spherical Delaunay triangulation of the neighborhood: volume,
+ * boundary distances, eccentricity, and neighbor identification.
  */
 
 #include <cognitive/voronoi_analysis.hpp>
+#include <storage/format_utils.hpp>
+#include <geometry/s3_batch.hpp>
+#include <geometry/s3_distance.hpp>
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -24,37 +26,114 @@ VoronoiAnalysis::VoronoiAnalysis(PostgresConnection& db) : db_(db) {}
 // =============================================================================
 
 double VoronoiAnalysis::geodesic(const Eigen::Vector4d& a, const Eigen::Vector4d& b) const {
-    double d = a.dot(b);
-    d = std::clamp(d, -1.0, 1.0);
-    return std::acos(d);
+    return s3::geodesic_distance({a[0], a[1], a[2], a[3]}, {b[0], b[1], b[2], b[3]});
 }
 
 // =============================================================================
-// Sample random point on S³ near a centroid
+// Monte Carlo kernel
 // =============================================================================
 
-Eigen::Vector4d VoronoiAnalysis::sample_near(
-    const Eigen::Vector4d& center, double radius, std::mt19937& rng) const
-{
-    // Generate random direction in tangent space of S³ at center
-    std::normal_distribution<double> normal(0.0, 1.0);
-    Eigen::Vector4d tangent(normal(rng), normal(rng), normal(rng), normal(rng));
+// xoshiro256**: a handful of cycles per draw, and each cell gets its own
+// stream from its seed so cells can be sampled on any thread
+class SampleRng {
+public:
+    explicit SampleRng(uint64_t seed) {
+        for (auto& w : s_) w = splitmix(seed);
+    }
+
+    uint64_t next() {
+        const uint64_t out = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return out;
+    }
 
-    // Project tangent vector to be orthogonal to center (tangent plane of S³)
-    tangent -= tangent.dot(center) * center;
-    double tangent_norm = tangent.norm();
-    if (tangent_norm < 1e-10) return center;
-    tangent /= tangent_norm;
+    // Uniform in (0, 1]
+    double uniform() { return ((next() >> 11) + 1) * 0x1.0p-53; }
 
-    // Random distance within radius (uniform on geodesic arc)
-    std::uniform_real_distribution<double> dist(0.0, radius);
-    double angle = dist(rng);
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    static uint64_t splitmix(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t s_[4];
+};
+
+// Samples drawn and classified together, as columns
+static constexpr size_t SAMPLE_BLOCK = 16;
+
+struct SampleBlock {
+    alignas(64) double x[SAMPLE_BLOCK];
+    alignas(64) double y[SAMPLE_BLOCK];
+    alignas(64) double z[SAMPLE_BLOCK];
+    alignas(64) double w[SAMPLE_BLOCK];
+    uint32_t nearest[SAMPLE_BLOCK];
+};
+
+// Uniform direction in the tangent space at `c`, uniform geodesic distance
+// in [0, radius), mapped back onto S³ (the exponential map)
+static void draw_block(const Eigen::Vector4d& c, double radius, SampleRng& rng, SampleBlock& b) {
+    constexpr double TWO_PI = 6.283185307179586;
+    double g[4][SAMPLE_BLOCK], angle[SAMPLE_BLOCK];
+    for (size_t i = 0; i < SAMPLE_BLOCK; ++i) {
+        // Box-Muller: two normal deviates per pair of uniforms
+        for (int k = 0; k < 4; k += 2) {
+            double r = std::sqrt(-2.0 * std::log(rng.uniform()));
+            double t = TWO_PI * rng.uniform();
+            g[k][i] = r * std::cos(t);
+            g[k + 1][i] = r * std::sin(t);
+        }
+        angle[i] = radius * (1.0 - rng.uniform());
+    }
 
-    // Exponential map: move along geodesic from center in direction tangent
-    Eigen::Vector4d point = std::cos(angle) * center + std::sin(angle) * tangent;
-    point.normalize();
+    #pragma omp simd
+    for (size_t i = 0; i < SAMPLE_BLOCK; ++i) {
+        double along = g[0][i] * c[0] + g[1][i] * c[1] + g[2][i] * c[2] + g[3][i] * c[3];
+        double tx = g[0][i] - along * c[0], ty = g[1][i] - along * c[1];
+        double tz = g[2][i] - along * c[2], tw = g[3][i] - along * c[3];
+        double norm = std::sqrt(tx * tx + ty * ty + tz * tz + tw * tw);
+        // A degenerate direction stays at the centre
+        double ca = norm < 1e-10 ? 1.0 : std::cos(angle[i]);
+        double sa = norm < 1e-10 ? 0.0 : std::sin(angle[i]) / norm;
+        double px = ca * c[0] + sa * tx, py = ca * c[1] + sa * ty;
+        double pz = ca * c[2] + sa * tz, pw = ca * c[3] + sa * tw;
+        double inv = 1.0 / std::sqrt(px * px + py * py + pz * pz + pw * pw);
+        b.x[i] = px * inv;
+        b.y[i] = py * inv;
+        b.z[i] = pz * inv;
+        b.w[i] = pw * inv;
+    }
+}
 
-    return point;
+// Nearest centroid of every sample in the block; largest dot product is
+// smallest geodesic, so no acos is needed
+static void classify_block(const double* ex, const double* ey, const double* ez, const double* ew,
+                           size_t n, SampleBlock& b) {
+    alignas(64) double best[SAMPLE_BLOCK];
+    for (size_t i = 0; i < SAMPLE_BLOCK; ++i) {
+        best[i] = -2.0;
+        b.nearest[i] = 0;
+    }
+    for (size_t j = 0; j < n; ++j) {
+        const double cx = ex[j], cy = ey[j], cz = ez[j], cw = ew[j];
+        const uint32_t id = static_cast<uint32_t>(j);
+        #pragma omp simd
+        for (size_t i = 0; i < SAMPLE_BLOCK; ++i) {
+            double d = b.x[i] * cx + b.y[i] * cy + b.z[i] * cz + b.w[i] * cw;
+            bool closer = d > best[i];
+            best[i] = closer ? d : best[i];
+            b.nearest[i] = closer ? id : b.nearest[i];
+        }
+    }
 }
 
 // =============================================================================
@@ -66,10 +145,11 @@ std::vector<VoronoiAnalysis::PositionEntry> VoronoiAnalysis::load_neighborhood(
 {
     std::vector<PositionEntry> entries;
 
-    // Use PostGIS ST_3DDistance for spatial filtering
-    // Note: PostGIS operates on XYZ, M is handled separately
-    // For S³, we use a bounding box approach: euclidean distance < 2*sin(radius/2)
-    double euclidean_bound = 2.0 * std::sin(std::min(radius, M_PI) / 2.0);
+    // The ball as Hilbert key ranges, each a B-tree range scan on
+    // physicality(hilbert); candidates are refined by exact geodesic distance,
+    // which (unlike ST_3DDistance on XYZ) accounts for M
+    auto ranges = hartonomous::spatial::HilbertRangeQuery::ball(center, radius);
+    if (ranges.empty()) return entries;
 
     std::string sql = R"(
         SELECT c.id, v.reconstructed_text,
@@ -77,51 +157,195 @@ std::vector<VoronoiAnalysis::PositionEntry> VoronoiAnalysis::load_neighborhood(
         FROM hartonomous.composition c
         JOIN hartonomous.physicality p ON p.id = c.physicalityid
         JOIN hartonomous.v_composition_text v ON v.composition_id = c.id
-        WHERE ST_3DDistance(
-            p.centroid,
-            ST_SetSRID(ST_MakePointM($1, $2, $3, $4), 0)
-        ) < $5
-    )";
-
-    db_.query(sql,
-        {std::to_string(center[0]), std::to_string(center[1]),
-         std::to_string(center[2]), std::to_string(center[3]),
-         std::to_string(euclidean_bound)},
+        WHERE )";
+    std::vector<std::string> params;
+    params.reserve(2 * ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (i > 0) sql += " OR ";
+        sql += "p.hilbert BETWEEN $" + std::to_string(2 * i + 1) + "::bytea AND $" + std::to_string(2 * i + 2) + "::bytea";
+        params.push_back(hash_to_bytea_hex(ranges[i].lo));
+        params.push_back(hash_to_bytea_hex(ranges[i].hi));
+    }
+
+    db_.query(sql, params,
         [&](const std::vector<std::string>& row) {
-            PositionEntry e;
-            e.id = BLAKE3Pipeline::from_hex(row[0]);
-            e.text = row[1];
-            e.position = Eigen::Vector4d(
+            Eigen::Vector4d position(
                 std::stod(row[2]), std::stod(row[3]),
                 std::stod(row[4]), std::stod(row[5])
             );
+            PositionEntry e;
+            e.id = BLAKE3Pipeline::from_hex(row[0]);
+            e.text = row[1];
+            e.position = position;
             entries.push_back(e);
         }
     );
 
+    // Key ranges over-cover the ball; geodesic <= radius is dot >= cos(radius)
+    const size_t n = entries.size();
+    std::vector<double> col(5 * n);
+    double *x = col.data(), *y = x + n, *z = y + n, *w = z + n, *dot = w + n;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& p = entries[i].position;
+        x[i] = p[0];
+        y[i] = p[1];
+        z[i] = p[2];
+        w[i] = p[3];
+    }
+    s3::dot_many({center[0], center[1], center[2], center[3]}, x, y, z, w, n, dot);
+    const double min_dot = std::cos(radius);
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (dot[i] >= min_dot) {
+            if (kept != i) entries[kept] = std::move(entries[i]);
+            ++kept;
+        }
+    entries.resize(kept);
+
     return entries;
 }
 
 // =============================================================================
-// Find nearest composition to a point
+// Nearest-centroid classification
 // =============================================================================
 
-const VoronoiAnalysis::PositionEntry* VoronoiAnalysis::find_nearest(
-    const Eigen::Vector4d& point,
-    const std::vector<PositionEntry>& neighborhood) const
+VoronoiAnalysis::Neighborhood VoronoiAnalysis::prepare_neighborhood(
+    std::vector<PositionEntry> entries, double radius) const
 {
-    const PositionEntry* best = nullptr;
-    double best_dist = M_PI + 1.0;
-
-    for (const auto& entry : neighborhood) {
-        double d = geodesic(point, entry.position);
-        if (d < best_dist) {
-            best_dist = d;
-            best = &entry;
+    Neighborhood hood;
+    hood.entries = std::move(entries);
+    const size_t n = hood.entries.size();
+
+    // Below this a blocked linear scan beats a range decomposition per query
+    constexpr size_t HILBERT_INDEX_MIN = 32768;
+    if (n >= HILBERT_INDEX_MIN) {
+        std::vector<Eigen::Vector4d> positions;
+        positions.reserve(n);
+        for (const auto& e : hood.entries) positions.push_back(e.position);
+        hood.index.emplace(positions);
+        hood.hint = radius * std::cbrt(1.0 / n);
+        return hood;
+    }
+
+    hood.x.resize(n);
+    hood.y.resize(n);
+    hood.z.resize(n);
+    hood.w.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& p = hood.entries[i].position;
+        hood.x[i] = p[0];
+        hood.y[i] = p[1];
+        hood.z[i] = p[2];
+        hood.w[i] = p[3];
+    }
+    return hood;
+}
+
+VoronoiAnalysis::CellSamples VoronoiAnalysis::sample_cell(
+    const Neighborhood& hood, const Eigen::Vector4d& center, size_t self,
+    size_t samples, double radius, uint64_t seed, bool scatter) const
+{
+    CellSamples out;
+    if (hood.entries.empty()) return out;
+
+    SampleRng rng(seed);
+    SampleBlock block;
+    for (size_t done = 0; done < samples; done += SAMPLE_BLOCK) {
+        draw_block(center, radius, rng, block);
+        if (hood.index) {
+            for (size_t i = 0; i < SAMPLE_BLOCK; ++i) {
+                auto hits = hood.index->nearest(Eigen::Vector4d(block.x[i], block.y[i], block.z[i], block.w[i]),
+                                                1, hood.hint);
+                block.nearest[i] = hits.empty() ? 0 : static_cast<uint32_t>(hits[0].point);
+            }
+        } else {
+            classify_block(hood.x.data(), hood.y.data(), hood.z.data(), hood.w.data(),
+                           hood.entries.size(), block);
+        }
+
+        // The last block is drawn whole (keeping the stream fixed) but only partly counted
+        const size_t count = std::min(SAMPLE_BLOCK, samples - done);
+        alignas(64) double distance[SAMPLE_BLOCK];
+        s3::geodesic_many({center[0], center[1], center[2], center[3]},
+                          block.x, block.y, block.z, block.w, count, distance);
+        for (size_t i = 0; i < count; ++i) {
+            Eigen::Vector4d sample(block.x[i], block.y[i], block.z[i], block.w[i]);
+            if (block.nearest[i] == self) {
+                out.owned++;
+                if (scatter) {
+                    Eigen::Vector4d offset = sample - center;
+                    out.owned_sum += offset;
+                    out.owned_scatter += offset * offset.transpose();
+                }
+            } else {
+                // Sample belongs to a neighbor — this is near a boundary
+                out.boundary++;
+                out.boundary_distance_sum += distance[i];
+                out.neighbor_counts[block.nearest[i]]++;
+            }
+        }
+    }
+    return out;
+}
+
+// =============================================================================
+// Exact cells
+// =============================================================================
+
+// Triangulations kept for reuse by later cells
+static constexpr size_t EXACT_CACHE_SIZE = 8;
+
+std::shared_ptr<const VoronoiAnalysis::ExactNeighborhood> VoronoiAnalysis::cache_exact(
+    const Eigen::Vector4d& center, double radius, std::vector<PositionEntry> entries)
+{
+    std::vector<Eigen::Vector4d> positions;
+    positions.reserve(entries.size());
+    for (const auto& e : entries) positions.push_back(e.position);
+
+    auto hood = std::make_shared<ExactNeighborhood>(ExactNeighborhood{
+        std::move(entries), Geometry::S3Delaunay(std::move(positions), std::make_pair(center, radius)), {}});
+    for (size_t i = 0; i < hood->entries.size(); ++i)
+        hood->site_of.emplace(hood->entries[i].id, static_cast<uint32_t>(i));
+
+    exact_cache_.insert(exact_cache_.begin(), hood);
+    if (exact_cache_.size() > EXACT_CACHE_SIZE) exact_cache_.pop_back();
+    return hood;
+}
+
+std::shared_ptr<const VoronoiAnalysis::ExactNeighborhood> VoronoiAnalysis::find_exact(
+    const BLAKE3Pipeline::Hash& id, uint32_t& site) const
+{
+    for (const auto& hood : exact_cache_) {
+        auto it = hood->site_of.find(id);
+        if (it != hood->site_of.end() && hood->diagram.exact(it->second)) {
+            site = it->second;
+            return hood;
         }
     }
+    return nullptr;
+}
+
+void VoronoiAnalysis::fill_exact(VoronoiCell& cell, const ExactNeighborhood& hood, uint32_t site,
+                                 size_t max_neighbors, double radius) const
+{
+    constexpr double PI = 3.141592653589793;
+    auto exact = hood.diagram.cell(site);
+
+    // The share of the search ball the cell covers, as sampling estimates it
+    const double ball = PI * (2.0 * radius - std::sin(2.0 * radius));
+    cell.approximate_volume = std::min(1.0, exact.volume * 2.0 * PI * PI / ball);
+    cell.avg_boundary_distance = exact.faces.empty() ? radius : exact.mean_boundary_distance;
+    cell.eccentricity = exact.eccentricity;
 
-    return best;
+    for (size_t i = 0; i < exact.faces.size() && i < max_neighbors; ++i) {
+        const auto& entry = hood.entries[exact.faces[i].neighbor];
+        VoronoiCell::BoundaryNeighbor bn;
+        bn.id = entry.id;
+        bn.text = entry.text;
+        bn.boundary_distance = geodesic(cell.centroid, entry.position);
+        bn.boundary_fraction = exact.faces[i].area_fraction;
+        cell.boundary_neighbors.push_back(bn);
+    }
 }
 
 // =============================================================================
@@ -157,7 +381,26 @@ VoronoiCell VoronoiAnalysis::analyze_cell(
     if (cell.text.empty()) return cell;
 
     // Load neighborhood
-    auto neighborhood = load_neighborhood(cell.centroid, config.search_radius);
+    std::vector<PositionEntry> entries;
+    if (config.mode == VoronoiMode::Exact) {
+        uint32_t site = 0;
+        auto exact = find_exact(composition_id, site);
+        if (!exact) {
+            exact = cache_exact(cell.centroid, config.search_radius,
+                                load_neighborhood(cell.centroid, config.search_radius));
+            auto it = exact->site_of.find(composition_id);
+            site = it != exact->site_of.end() ? it->second : Geometry::S3Delaunay::NPOS;
+        }
+        if (site != Geometry::S3Delaunay::NPOS && exact->diagram.exact(site)) {
+            fill_exact(cell, *exact, site, config.max_neighbors, config.search_radius);
+            return cell;
+        }
+        entries = exact->entries;  // A rim cell is sampled instead
+    } else {
+        entries = load_neighborhood(cell.centroid, config.search_radius);
+    }
+    auto hood = prepare_neighborhood(std::move(entries), config.search_radius);
+    const auto& neighborhood = hood.entries;
     if (neighborhood.size() < 2) {
         cell.approximate_volume = 1.0; // Only concept in the area
         cell.eccentricity = 0.0;
@@ -165,48 +408,26 @@ VoronoiCell VoronoiAnalysis::analyze_cell(
         return cell;
     }
 
-    // Monte Carlo sampling
-    std::mt19937 rng(std::hash<std::string>{}(cell.text));
-    size_t owned = 0;
-    std::vector<double> boundary_distances;
-    std::unordered_map<BLAKE3Pipeline::Hash, size_t, HashHasher> neighbor_counts;
-
-    // Direction tracking for eccentricity
-    Eigen::Vector4d owned_sum = Eigen::Vector4d::Zero();
-    Eigen::Matrix4d owned_scatter = Eigen::Matrix4d::Zero();
-
-    for (size_t s = 0; s < config.samples_per_cell; ++s) {
-        Eigen::Vector4d sample = sample_near(cell.centroid, config.search_radius, rng);
-        const auto* nearest = find_nearest(sample, neighborhood);
-
-        if (nearest && nearest->id == composition_id) {
-            owned++;
-            Eigen::Vector4d offset = sample - cell.centroid;
-            owned_sum += offset;
-            owned_scatter += offset * offset.transpose();
-        } else if (nearest) {
-            // Sample belongs to a neighbor — this is near a boundary
-            double dist_to_boundary = geodesic(cell.centroid, sample);
-            boundary_distances.push_back(dist_to_boundary);
-            neighbor_counts[nearest->id]++;
-        }
+    size_t self = SIZE_MAX;
+    for (size_t i = 0; i < neighborhood.size(); ++i) {
+        if (neighborhood[i].id == composition_id) { self = i; break; }
     }
 
+    // Monte Carlo sampling
+    auto tally = sample_cell(hood, cell.centroid, self, config.samples_per_cell, config.search_radius,
+                             std::hash<std::string>{}(cell.text), true);
+    const size_t owned = tally.owned;
+
     // Compute metrics
     cell.approximate_volume = static_cast<double>(owned) / config.samples_per_cell;
-
-    if (!boundary_distances.empty()) {
-        cell.avg_boundary_distance = std::accumulate(
-            boundary_distances.begin(), boundary_distances.end(), 0.0
-        ) / boundary_distances.size();
-    } else {
-        cell.avg_boundary_distance = config.search_radius;
-    }
+    cell.avg_boundary_distance = tally.boundary > 0
+        ? tally.boundary_distance_sum / tally.boundary
+        : config.search_radius;
 
     // Eccentricity from scatter matrix eigenvalues
     if (owned > 10) {
-        Eigen::Matrix4d scatter_normalized = owned_scatter / owned;
-        Eigen::Vector4d mean = owned_sum / owned;
+        Eigen::Matrix4d scatter_normalized = tally.owned_scatter / owned;
+        Eigen::Vector4d mean = tally.owned_sum / owned;
         scatter_normalized -= mean * mean.transpose();
 
         Eigen::SelfAdjointEigenSolver<Eigen::Matrix4d> eigsolver(scatter_normalized);
@@ -219,25 +440,18 @@ VoronoiCell VoronoiAnalysis::analyze_cell(
     }
 
     // Boundary neighbors
-    std::vector<std::pair<BLAKE3Pipeline::Hash, size_t>> sorted_neighbors(
-        neighbor_counts.begin(), neighbor_counts.end());
+    std::vector<std::pair<uint32_t, size_t>> sorted_neighbors(
+        tally.neighbor_counts.begin(), tally.neighbor_counts.end());
     std::sort(sorted_neighbors.begin(), sorted_neighbors.end(),
-        [](const auto& a, const auto& b) { return a.second > b.second; });
+        [](const auto& a, const auto& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
 
     size_t total_boundary_samples = config.samples_per_cell - owned;
     for (size_t i = 0; i < sorted_neighbors.size() && i < config.max_neighbors; ++i) {
+        const auto& entry = neighborhood[sorted_neighbors[i].first];
         VoronoiCell::BoundaryNeighbor bn;
-        bn.id = sorted_neighbors[i].first;
-
-        // Find text for this neighbor
-        for (const auto& entry : neighborhood) {
-            if (entry.id == bn.id) {
-                bn.text = entry.text;
-                bn.boundary_distance = geodesic(cell.centroid, entry.position);
-                break;
-            }
-        }
-
+        bn.id = entry.id;
+        bn.text = entry.text;
+        bn.boundary_distance = geodesic(cell.centroid, entry.position);
         bn.boundary_fraction = total_boundary_samples > 0
             ? static_cast<double>(sorted_neighbors[i].second) / total_boundary_samples
             : 0.0;
@@ -282,68 +496,56 @@ std::vector<VoronoiCell> VoronoiAnalysis::analyze_neighborhood(
     if (!found) return cells;
 
     // Load all compositions in the neighborhood
-    auto neighborhood = load_neighborhood(center, radius);
-
-    // Analyze each composition's cell using the shared neighborhood
-    std::mt19937 rng(42);
-
-    for (const auto& entry : neighborhood) {
-        VoronoiCell cell;
+    auto entries = load_neighborhood(center, radius);
+    std::shared_ptr<const ExactNeighborhood> exact;
+    if (config.mode == VoronoiMode::Exact) exact = cache_exact(center, radius, entries);
+    auto hood = prepare_neighborhood(std::move(entries), radius);
+    const auto& neighborhood = hood.entries;
+
+    // Fewer samples per cell when analyzing many cells
+    const size_t samples = std::min(config.samples_per_cell, size_t(200));
+
+    // Every cell reads the shared neighborhood and draws from its own stream
+    cells.resize(neighborhood.size());
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < neighborhood.size(); ++c) {
+        const auto& entry = neighborhood[c];
+        VoronoiCell& cell = cells[c];
         cell.composition_id = entry.id;
         cell.text = entry.text;
         cell.centroid = entry.position;
 
-        size_t owned = 0;
-        std::unordered_map<BLAKE3Pipeline::Hash, size_t, HashHasher> neighbor_counts;
-        std::vector<double> boundary_distances;
-
-        VoronoiConfig local_config = config;
-        // Fewer samples per cell when analyzing many cells
-        local_config.samples_per_cell = std::min(config.samples_per_cell, size_t(200));
-
-        for (size_t s = 0; s < local_config.samples_per_cell; ++s) {
-            Eigen::Vector4d sample = sample_near(entry.position, local_config.search_radius, rng);
-            const auto* nearest = find_nearest(sample, neighborhood);
-
-            if (nearest && nearest->id == entry.id) {
-                owned++;
-            } else if (nearest) {
-                boundary_distances.push_back(geodesic(entry.position, sample));
-                neighbor_counts[nearest->id]++;
-            }
+        if (exact && exact->diagram.exact(static_cast<uint32_t>(c))) {
+            fill_exact(cell, *exact, static_cast<uint32_t>(c), 8, config.search_radius);
+            continue;
         }
 
-        cell.approximate_volume = static_cast<double>(owned) / local_config.samples_per_cell;
-        cell.avg_boundary_distance = boundary_distances.empty() ? local_config.search_radius :
-            std::accumulate(boundary_distances.begin(), boundary_distances.end(), 0.0) /
-            boundary_distances.size();
+        auto tally = sample_cell(hood, entry.position, c, samples, config.search_radius,
+                                 HashHasher{}(entry.id), false);
+
+        cell.approximate_volume = static_cast<double>(tally.owned) / samples;
+        cell.avg_boundary_distance = tally.boundary > 0
+            ? tally.boundary_distance_sum / tally.boundary
+            : config.search_radius;
         cell.eccentricity = 0.0; // Skip expensive eccentricity for batch analysis
 
         // Top boundary neighbors
-        std::vector<std::pair<BLAKE3Pipeline::Hash, size_t>> sorted_nb(
-            neighbor_counts.begin(), neighbor_counts.end());
+        std::vector<std::pair<uint32_t, size_t>> sorted_nb(
+            tally.neighbor_counts.begin(), tally.neighbor_counts.end());
         std::sort(sorted_nb.begin(), sorted_nb.end(),
-            [](const auto& a, const auto& b) { return a.second > b.second; });
+            [](const auto& a, const auto& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
 
-        size_t total_boundary = local_config.samples_per_cell - owned;
+        size_t total_boundary = samples - tally.owned;
         for (size_t i = 0; i < sorted_nb.size() && i < 8; ++i) {
+            const auto& e = neighborhood[sorted_nb[i].first];
             VoronoiCell::BoundaryNeighbor bn;
-            bn.id = sorted_nb[i].first;
-            for (const auto& e : neighborhood) {
-                if (e.id == bn.id) { bn.text = e.text; break; }
-            }
-            bn.boundary_distance = geodesic(entry.position,
-                [&]() -> Eigen::Vector4d {
-                    for (const auto& e : neighborhood)
-                        if (e.id == bn.id) return e.position;
-                    return entry.position;
-                }());
+            bn.id = e.id;
+            bn.text = e.text;
+            bn.boundary_distance = geodesic(entry.position, e.position);
             bn.boundary_fraction = total_boundary > 0
                 ? static_cast<double>(sorted_nb[i].second) / total_boundary : 0.0;
             cell.boundary_neighbors.push_back(bn);
         }
-
-        cells.push_back(cell);
     }
 
     return cells;
@@ -355,73 +557,111 @@ std::vector<VoronoiCell> VoronoiAnalysis::analyze_neighborhood(
 
 std::vector<VoronoiOverlap> VoronoiAnalysis::analyze_model_overlap(
     const std::vector<BLAKE3Pipeline::Hash>& composition_ids,
-    const VoronoiConfig& /*config*/)
+    const VoronoiConfig& config)
 {
-    std::vector<VoronoiOverlap> results;
-
-    for (const auto& comp_id : composition_ids) {
-        VoronoiOverlap overlap;
-        overlap.composition_id = comp_id;
-
-        std::string hex = BLAKE3Pipeline::to_hex(comp_id);
-
-        // Get composition text
-        db_.query(
-            "SELECT v.reconstructed_text FROM hartonomous.v_composition_text v "
-            "WHERE v.composition_id = $1",
-            {hex},
-            [&](const std::vector<std::string>& row) { overlap.text = row[0]; }
-        );
-
-        // Get all model projections for this composition
-        db_.query(
-            "SELECT mp.contentid, ST_X(mp.position), ST_Y(mp.position), "
-            "ST_Z(mp.position), ST_M(mp.position) "
-            "FROM hartonomous.modelprojection mp "
-            "WHERE mp.compositionid = $1",
-            {hex},
-            [&](const std::vector<std::string>& row) {
-                VoronoiOverlap::ModelCell mc;
-                mc.content_id = BLAKE3Pipeline::from_hex(row[0]);
-                mc.centroid = Eigen::Vector4d(
-                    std::stod(row[1]), std::stod(row[2]),
-                    std::stod(row[3]), std::stod(row[4])
-                );
-                mc.volume = 0.0; // Would need per-model Voronoi analysis
-                overlap.model_cells.push_back(mc);
-            }
-        );
-
-        // Compute disagreement metrics
-        if (overlap.model_cells.size() >= 2) {
-            double total_dist = 0.0;
-            double max_dist = 0.0;
-            int pairs = 0;
-
-            for (size_t i = 0; i < overlap.model_cells.size(); ++i) {
-                for (size_t j = i + 1; j < overlap.model_cells.size(); ++j) {
-                    double d = geodesic(
-                        overlap.model_cells[i].centroid,
-                        overlap.model_cells[j].centroid
-                    );
-                    total_dist += d;
-                    max_dist = std::max(max_dist, d);
-                    pairs++;
-                }
-            }
+    std::vector<VoronoiOverlap> results(composition_ids.size());
+    if (composition_ids.empty()) return results;
+
+    // Texts and every model projection of every composition in one round trip
+    std::string ids = "{";
+    for (size_t i = 0; i < composition_ids.size(); ++i) {
+        if (i > 0) ids += ",";
+        ids += BLAKE3Pipeline::to_hex(composition_ids[i]);
+        results[i].composition_id = composition_ids[i];
+    }
+    ids += "}";
 
-            overlap.centroid_spread = pairs > 0 ? total_dist / pairs : 0.0;
-            overlap.max_centroid_distance = max_dist;
+    db_.query(
+        "SELECT c.ord, v.reconstructed_text, mp.contentid, ST_X(mp.position), ST_Y(mp.position), "
+        "ST_Z(mp.position), ST_M(mp.position) "
+        "FROM unnest($1::uuid[]) WITH ORDINALITY AS c(id, ord) "
+        "LEFT JOIN hartonomous.v_composition_text v ON v.composition_id = c.id "
+        "LEFT JOIN hartonomous.modelprojection mp ON mp.compositionid = c.id "
+        "ORDER BY c.ord",
+        {ids},
+        [&](const std::vector<std::string>& row) {
+            VoronoiOverlap& overlap = results[std::stoull(row[0]) - 1];
+            overlap.text = row[1];
+            if (row[2].empty()) return; // No projections
+            VoronoiOverlap::ModelCell mc;
+            mc.content_id = BLAKE3Pipeline::from_hex(row[2]);
+            mc.centroid = Eigen::Vector4d(
+                std::stod(row[3]), std::stod(row[4]),
+                std::stod(row[5]), std::stod(row[6])
+            );
+            mc.volume = 0.0;
+            overlap.model_cells.push_back(mc);
+        }
+    );
 
-            // Volume variance (placeholder — would need per-model Voronoi)
-            overlap.volume_variance = 0.0;
-        } else {
-            overlap.centroid_spread = 0.0;
-            overlap.max_centroid_distance = 0.0;
-            overlap.volume_variance = 0.0;
+    // One partition per model, over its projections of the requested compositions
+    struct ModelSites {
+        std::vector<PositionEntry> entries;
+        std::vector<std::pair<size_t, size_t>> cells;  // (result, model cell) of each site
+        Neighborhood hood;
+    };
+    std::unordered_map<BLAKE3Pipeline::Hash, size_t, HashHasher> model_of;
+    std::vector<ModelSites> models;
+    for (size_t r = 0; r < results.size(); ++r) {
+        for (size_t m = 0; m < results[r].model_cells.size(); ++m) {
+            const auto& mc = results[r].model_cells[m];
+            auto [it, added] = model_of.try_emplace(mc.content_id, models.size());
+            if (added) models.emplace_back();
+            auto& sites = models[it->second];
+            sites.entries.push_back({results[r].composition_id, {}, mc.centroid});
+            sites.cells.emplace_back(r, m);
         }
+    }
+    std::vector<std::pair<size_t, size_t>> jobs;  // (model, site)
+    for (size_t m = 0; m < models.size(); ++m) {
+        models[m].hood = prepare_neighborhood(std::move(models[m].entries), config.search_radius);
+        for (size_t s = 0; s < models[m].cells.size(); ++s) jobs.emplace_back(m, s);
+    }
 
-        results.push_back(overlap);
+    // Every (concept, model) cell is sampled on its own stream; each writes only its own volume
+    const size_t samples = std::max<size_t>(config.samples_per_cell, 1);
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        const auto [m, s] = jobs[j];
+        const auto& sites = models[m];
+        const auto [r, c] = sites.cells[s];
+        auto& mc = results[r].model_cells[c];
+        auto tally = sample_cell(sites.hood, mc.centroid, s, samples, config.search_radius,
+                                 HashHasher{}(results[r].composition_id) ^ HashHasher{}(mc.content_id), false);
+        mc.volume = static_cast<double>(tally.owned) / samples;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t r = 0; r < results.size(); ++r) {
+        auto& overlap = results[r];
+        overlap.centroid_spread = 0.0;
+        overlap.max_centroid_distance = 0.0;
+        overlap.volume_variance = 0.0;
+        if (overlap.model_cells.size() < 2) continue;
+
+        // Disagreement metrics
+        double total_dist = 0.0;
+        double max_dist = 0.0;
+        int pairs = 0;
+        for (size_t i = 0; i < overlap.model_cells.size(); ++i) {
+            for (size_t j = i + 1; j < overlap.model_cells.size(); ++j) {
+                double d = geodesic(
+                    overlap.model_cells[i].centroid,
+                    overlap.model_cells[j].centroid
+                );
+                total_dist += d;
+                max_dist = std::max(max_dist, d);
+                pairs++;
+            }
+        }
+        overlap.centroid_spread = pairs > 0 ? total_dist / pairs : 0.0;
+        overlap.max_centroid_distance = max_dist;
+
+        double mean = 0.0;
+        for (const auto& mc : overlap.model_cells) mean += mc.volume;
+        mean /= overlap.model_cells.size();
+        for (const auto& mc : overlap.model_cells) overlap.volume_variance += (mc.volume - mean) * (mc.volume - mean);
+        overlap.volume_variance /= overlap.model_cells.size();
     }
 
     return results;
@@ -437,6 +677,7 @@ std::vector<VoronoiOverlap> VoronoiAnalysis::find_polysemous(
     std::vector<VoronoiOverlap> results;
 
     // Find compositions with multiple model projections that are spread apart
+    std::vector<BLAKE3Pipeline::Hash> candidates;
     db_.query(
         R"(WITH multi_proj AS (
             SELECT compositionid, COUNT(*) as proj_count
@@ -450,14 +691,14 @@ std::vector<VoronoiOverlap> VoronoiAnalysis::find_polysemous(
         LIMIT $1)",
         {std::to_string(limit * 3)}, // Over-fetch since we'll filter by spread
         [&](const std::vector<std::string>& row) {
-            auto comp_id = BLAKE3Pipeline::from_hex(row[0]);
-            auto overlaps = analyze_model_overlap({comp_id});
-            if (!overlaps.empty() && overlaps[0].centroid_spread >= min_spread) {
-                results.push_back(overlaps[0]);
-            }
+            candidates.push_back(BLAKE3Pipeline::from_hex(row[0]));
         }
     );
 
+    for (auto& overlap : analyze_model_overlap(candidates)) {
+        if (overlap.centroid_spread >= min_spread) results.push_back(std::move(overlap));
+    }
+
     // Sort by spread (highest disagreement first)
     std::sort(results.begin(), results.end(),
         [](const VoronoiOverlap& a, const VoronoiOverlap& b) {
@@ -494,9 +735,11 @@ std::vector<VoronoiCell> VoronoiAnalysis::find_boundary_concepts(
         }
     );
 
-    // Analyze each candidate
+    // Neighbor counts are Delaunay degrees; a candidate inside a neighborhood
+    // already triangulated for an earlier one is answered from the cache
     VoronoiConfig config;
-    config.samples_per_cell = 500; // Moderate for screening
+    config.mode = VoronoiMode::Exact;
+    config.samples_per_cell = 500; // Moderate for screening rim cells
 
     for (const auto& id : candidates) {
         auto cell = analyze_cell(id, config);
@@ -8,8 +8,14 @@
  */
 
 #include <cognitive/walk_engine.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <hashing/composition_interner.hpp>
+#include <utils/metrics.hpp>
+#include <utils/philox.hpp>
 #include <random>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
@@ -18,73 +24,35 @@
 
 namespace Hartonomous {
 
-// Tokens that are model artifacts, not semantic content
-static bool is_model_artifact(const std::string& text) {
-    if (text.empty()) return true;
-    if (text.size() >= 8 && text.substr(0, 7) == "[unused") return true;
-    if (text == "[PAD]" || text == "[CLS]" || text == "[SEP]" || text == "[MASK]") return true;
-    if (text == "[UNK]") return true;
-    if (text.size() >= 2 && text[0] == '#' && text[1] == '#') return true; // wordpiece subword
-    if (text.size() >= 2 && text[0] == '#' && !std::isalpha(text[1])) return true; // #17, #», etc.
-    return false;
-}
-
-// Function words — carry grammatical structure but low semantic content
-// Used for scoring deprioritization, NOT filtering from output
-static bool is_function_word(const std::string& text) {
-    if (text.empty()) return true;
-    // Punctuation is always structural
-    if (text.size() == 1 && !std::isalnum(static_cast<unsigned char>(text[0]))) return true;
-    static const std::unordered_set<std::string> funcs = {
-        "the", "a", "an", "of", "in", "to", "is", "and", "or", "but", "not",
-        "for", "on", "with", "at", "by", "from", "as", "that", "this", "it",
-        "was", "were", "be", "been", "being", "have", "has", "had", "do", "does",
-        "did", "will", "would", "could", "should", "may", "might", "shall", "can",
-        "are", "am", "its", "his", "her", "he", "she", "they", "them", "their",
-        "we", "our", "you", "your", "my", "me", "him", "us", "who", "whom",
-        "which", "what", "where", "when", "how", "why", "if", "so", "no",
-        "than", "then", "there", "here", "these", "those", "itself", "himself",
-        "herself", "themselves", "myself", "yourself"
-    };
-    std::string lower = text;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    return funcs.count(lower) > 0;
-}
+// Candidates a step samples from, best scored first
+static constexpr size_t SAMPLE_TOP_K = 32;
 
 WalkEngine::WalkEngine(PostgresConnection& db) : db_(db) {
     // Pre-cache composition text for fast lookup during walks
     preload_composition_text();
 }
 
+WalkEngine::WalkEngine(ConnectionPool& pool) : lease_(pool.acquire()), db_(*lease_) {
+    preload_composition_text();
+}
+
 void WalkEngine::preload_composition_text() {
-    db_.query(
-        "SELECT v.composition_id, v.reconstructed_text "
-        "FROM hartonomous.v_composition_text v",
-        {},
-        [&](const std::vector<std::string>& row) {
-            auto hash = BLAKE3Pipeline::from_hex(row[0]);
-            comp_text_cache_[hash] = row[1];
-        }
-    );
+    texts_ = CompositionTextStore::shared(db_);
 }
 
-std::string WalkEngine::lookup_text(const BLAKE3Pipeline::Hash& id) const {
-    auto it = comp_text_cache_.find(id);
-    if (it != comp_text_cache_.end()) return it->second;
-    return "";
+std::string_view WalkEngine::lookup_text(const BLAKE3Pipeline::Hash& id) const {
+    return texts_ ? texts_->lookup(id) : std::string_view{};
 }
 
 BLAKE3Pipeline::Hash WalkEngine::find_composition(const std::string& text) {
-    BLAKE3Pipeline::Hash result = {};
-    db_.query(
-        "SELECT v.composition_id FROM hartonomous.v_composition_text v "
-        "WHERE v.reconstructed_text = $1 LIMIT 1",
-        {text},
-        [&](const std::vector<std::string>& row) {
-            result = BLAKE3Pipeline::from_hex(row[0]);
-        }
-    );
-    return result;
+    return resolver_.resolve(text);
+}
+
+BLAKE3Pipeline::Hash WalkEngine::find_nearest_composition(const std::string& text) {
+    if (!centroids_) centroids_ = CentroidIndex::shared(db_);
+    if (!atoms_) atoms_ = std::make_unique<AtomLookup>(db_);
+    auto near = centroids_->nearest_text(*atoms_, text, 1);
+    return near.empty() ? BLAKE3Pipeline::Hash{} : near[0].id;
 }
 
 WalkState WalkEngine::init_walk(const BLAKE3Pipeline::Hash& start_id, double initial_energy) {
@@ -92,8 +60,11 @@ WalkState WalkEngine::init_walk(const BLAKE3Pipeline::Hash& start_id, double ini
     state.current_composition = start_id;
     state.current_energy = initial_energy;
     state.trajectory.push_back(start_id);
-    state.visit_counts[start_id] = 1;
-    state.recent.push_back(start_id);
+    uint32_t start_node = CompositionInterner::global().intern(start_id);
+    state.visit_counts[start_node] = 1;
+    state.recent.push_back(start_node);
+    std::random_device entropy;
+    state.rng_key = (uint64_t(entropy()) << 32) | entropy();
 
     std::string hex_id = BLAKE3Pipeline::to_hex(start_id);
     db_.query("SELECT ST_X(p.centroid), ST_Y(p.centroid), ST_Z(p.centroid), ST_M(p.centroid) "
@@ -110,7 +81,7 @@ WalkState WalkEngine::init_walk(const BLAKE3Pipeline::Hash& start_id, double ini
     return state;
 }
 
-WalkState WalkEngine::init_walk_from_prompt(const std::string& prompt, double initial_energy) {
+WalkEngine::PromptSeeds WalkEngine::seed_prompt(const std::string& prompt) {
     // Extract content words from prompt
     std::istringstream iss(prompt);
     std::string word;
@@ -119,37 +90,35 @@ WalkState WalkEngine::init_walk_from_prompt(const std::string& prompt, double in
     while (iss >> word) {
         // Strip punctuation
         word.erase(std::remove_if(word.begin(), word.end(), ::ispunct), word.end());
-        if (word.empty() || is_function_word(word)) continue;
+        if (word.empty() || (CompositionTextStore::classify(word) & CompositionTextStore::FUNCTION_WORD)) continue;
 
-        // Try exact match, then lowercase
+        // Exact match, else a case variant
         auto id = find_composition(word);
-        if (id == BLAKE3Pipeline::Hash{}) {
-            std::string lower = word;
-            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-            id = find_composition(lower);
-        }
+        // No exact composition: the one nearest the word's centroid
+        if (id == BLAKE3Pipeline::Hash{}) id = find_nearest_composition(word);
         if (id != BLAKE3Pipeline::Hash{}) {
             seeds.push_back(id);
         }
     }
 
+    PromptSeeds out;
     if (seeds.empty()) {
         // Fallback: use highest-rated composition
-        BLAKE3Pipeline::Hash fallback = {};
         db_.query(
             "SELECT rs.compositionid FROM hartonomous.relationsequence rs "
             "JOIN hartonomous.relationrating rr ON rs.relationid = rr.relationid "
             "ORDER BY rr.ratingvalue DESC LIMIT 1", {},
             [&](const std::vector<std::string>& row) {
-                fallback = BLAKE3Pipeline::from_hex(row[0]);
+                out.start = BLAKE3Pipeline::from_hex(row[0]);
             }
         );
-        return init_walk(fallback, initial_energy);
+        return out;
     }
+    out.found = true;
 
     // Multi-seed: Find the seed with the most relations to other seeds
     // This is the "center of the prompt" — the composition most connected to the query
-    BLAKE3Pipeline::Hash best_seed = seeds[0];
+    out.start = seeds[0];
     if (seeds.size() > 1) {
         size_t best_connections = 0;
         for (const auto& seed : seeds) {
@@ -168,41 +137,30 @@ WalkState WalkEngine::init_walk_from_prompt(const std::string& prompt, double in
             }
             if (connections > best_connections) {
                 best_connections = connections;
-                best_seed = seed;
+                out.start = seed;
             }
         }
-        // Store all seeds as context — boost candidates related to ANY seed
-        context_seeds_ = seeds;
+        // All seeds as context — boost candidates related to ANY seed
+        out.context = std::move(seeds);
     }
+    return out;
+}
 
-    return init_walk(best_seed, initial_energy);
+WalkState WalkEngine::init_walk_from_prompt(const std::string& prompt, double initial_energy) {
+    auto seeds = seed_prompt(prompt);
+    if (!seeds.context.empty()) context_seeds_ = std::move(seeds.context);
+    return init_walk(seeds.start, initial_energy);
 }
 
 void WalkEngine::set_goal(WalkState& state, const BLAKE3Pipeline::Hash& goal_id) {
     state.goal_composition = goal_id;
 }
 
-std::vector<WalkEngine::Candidate> WalkEngine::get_candidates(const WalkState& state) {
+std::vector<WalkEngine::Candidate> WalkEngine::get_candidates(const WalkState& state, const RelationGraph* graph,
+                                                             const std::vector<BLAKE3Pipeline::Hash>* context_seeds) {
     std::vector<Candidate> candidates;
     if (state.trajectory.empty()) return candidates;
 
-    std::string current_hex = BLAKE3Pipeline::to_hex(state.current_composition);
-
-    // Query ALL relations for this composition — we aggregate duplicates in C++
-    std::string sql = R"(
-        SELECT
-            rs2.compositionid,
-            uint64_to_double(rr.observations),
-            rr.ratingvalue
-        FROM hartonomous.relationsequence rs1
-        JOIN hartonomous.relationsequence rs2 
-            ON rs2.relationid = rs1.relationid 
-            AND rs2.compositionid != rs1.compositionid
-        JOIN hartonomous.relationrating rr 
-            ON rr.relationid = rs1.relationid
-        WHERE rs1.compositionid = $1
-    )";
-
     // Aggregate: same composition may appear via multiple relations
     // Merge them: sum observations, max ELO
     struct AggCandidate {
@@ -210,117 +168,169 @@ std::vector<WalkEngine::Candidate> WalkEngine::get_candidates(const WalkState& s
         double max_rating = 0.0;
         int relation_count = 0;
     };
-    std::unordered_map<BLAKE3Pipeline::Hash, AggCandidate, HashHasher> agg;
-
-    db_.query(sql, {current_hex}, [&](const std::vector<std::string>& row) {
-        auto id = BLAKE3Pipeline::from_hex(row[0]);
-        double obs = std::stod(row[1]);
-        double rating = std::stod(row[2]);
-        auto& ac = agg[id];
-        ac.total_obs += obs;
-        ac.max_rating = std::max(ac.max_rating, rating);
-        ac.relation_count++;
-    });
+    std::unordered_map<uint32_t, AggCandidate> agg;
+    auto& interner = CompositionInterner::global();
 
-    // Find max observations for normalization (across aggregated candidates)
+    // Normalization bounds; an unfiltered graph row has them precomputed
     double max_obs = 1.0;
     double max_elo = 0.0, min_elo = 1e9;
-    for (const auto& [id, ac] : agg) {
-        if (ac.total_obs > max_obs) max_obs = ac.total_obs;
-        if (ac.max_rating > max_elo) max_elo = ac.max_rating;
-        if (ac.max_rating < min_elo) min_elo = ac.max_rating;
+    bool bounded = false;
+
+    const RelationGraph::TenantMask view = RelationGraph::tenant_view(graph, tenant_);
+    uint32_t index = RelationGraph::NPOS;
+    std::span<const RelationGraph::Edge> row;
+    std::span<const uint32_t> hub;
+    auto add_edge = [&](const RelationGraph::Edge& e) {
+        auto& ac = agg[interner.intern(graph->id_of(e.target))];
+        ac.total_obs = e.total_obs;
+        ac.max_rating = std::max(0.0, e.max_elo);
+        ac.relation_count = static_cast<int>(e.relation_count);
+    };
+    if (graph && shards_ && !shards_->owns(state.current_composition)) {
+        // Another shard's row, cached here like a database one
+        if (tenant_) throw std::runtime_error("Tenant-restricted walk stepped onto a remote graph shard");
+        for (const auto& n : *shards_->neighbors(state.current_composition)) {
+            auto& ac = agg[n.node];
+            ac.total_obs = n.total_obs;
+            ac.max_rating = n.max_elo;
+            ac.relation_count = static_cast<int>(n.relation_count);
+        }
+    } else if (graph) {
+        // Snapshot edges are already aggregated per neighbor
+        index = graph->index_of(state.current_composition);
+        row = graph->neighbors(index);
+        const auto masks = graph->tenant_masks(index);
+        if (view == RelationGraph::ALL_TENANTS && !row.empty()) {
+            const auto& summary = graph->summary(index);
+            max_obs = std::max(1.0, summary.max_obs);
+            max_elo = std::max(0.0, summary.max_elo);
+            min_elo = std::max(0.0, summary.min_elo);
+            bounded = true;
+            hub = graph->hub_edges(index);
+        }
+        if (!hub.empty()) {
+            // A hub offers its best-ranked neighbors, plus any context seed among the rest
+            for (uint32_t at : hub) add_edge(row[at]);
+            if (context_seeds) {
+                for (const auto& seed : *context_seeds) {
+                    const uint32_t target = graph->index_of(seed);
+                    auto it = std::lower_bound(row.begin(), row.end(), target,
+                        [](const RelationGraph::Edge& e, uint32_t t) { return e.target < t; });
+                    if (it != row.end() && it->target == target) add_edge(*it);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < row.size(); ++i) {
+                if (view != RelationGraph::ALL_TENANTS && !(masks[i] & view)) continue;
+                add_edge(row[i]);
+            }
+        }
+    } else {
+        // Aggregated per neighbor by the shared cache, loaded on a miss
+        if (prefetch_) prefetch_->claim(state.current_composition);
+        auto list = NeighborCache::global().neighbors(db_, state.current_composition);
+        for (const auto& n : *list) {
+            auto& ac = agg[n.node];
+            ac.total_obs = n.total_obs;
+            ac.max_rating = n.max_elo;
+            ac.relation_count = static_cast<int>(n.relation_count);
+        }
+    }
+
+    // Find max observations for normalization (across aggregated candidates)
+    if (!bounded) {
+        for (const auto& [node, ac] : agg) {
+            if (ac.total_obs > max_obs) max_obs = ac.total_obs;
+            if (ac.max_rating > max_elo) max_elo = ac.max_rating;
+            if (ac.max_rating < min_elo) min_elo = ac.max_rating;
+        }
     }
     double elo_range = std::max(1.0, max_elo - min_elo);
 
-    for (const auto& [id, ac] : agg) {
-        std::string text = lookup_text(id);
+    auto emit = [&] {
+        for (const auto& [node, ac] : agg) {
+            const auto& id = interner.hash_of(node);
+            const uint32_t at = texts_ ? texts_->index_of(id) : CompositionTextStore::NPOS;
+            const uint8_t flags = at == CompositionTextStore::NPOS ? uint8_t(CompositionTextStore::ARTIFACT)
+                                                                   : texts_->flags_at(at);
 
-        // Filter model artifacts
-        if (is_model_artifact(text)) continue;
+            // Filter model artifacts (and compositions without text)
+            if (flags & CompositionTextStore::ARTIFACT) continue;
 
-        // Require minimum observations — single-obs model edges are noise
-        // Lowered to 1.0 for testing/sparse graphs
-        if (ac.total_obs < 1.0) continue;
+            // Require minimum observations — single-obs model edges are noise
+            // Lowered to 1.0 for testing/sparse graphs
+            if (ac.total_obs < 1.0) continue;
 
-        Candidate c;
-        c.id = id;
-        c.text = text;
+            Candidate c;
+            c.id = id;
+            c.node = node;
+            c.text = texts_->text_at(at);
 
-        // ELO normalized against THIS candidate set (local, not hardcoded)
-        c.elo_score = (ac.max_rating - min_elo) / elo_range;
+            // ELO normalized against THIS candidate set (local, not hardcoded)
+            c.elo_score = (ac.max_rating - min_elo) / elo_range;
 
-        // Observation ratio: how observed is this vs the most-observed neighbor?
-        c.obs_score = ac.total_obs / max_obs;
+            // Observation ratio: how observed is this vs the most-observed neighbor?
+            c.obs_score = ac.total_obs / max_obs;
 
-        // Raw for sigmoid gating
-        c.rel_strength = ac.total_obs;
+            // Raw for sigmoid gating
+            c.rel_strength = ac.total_obs;
 
-        // Stop word flag
-        c.is_stop_word = is_function_word(text);
+            // Stop word flag
+            c.is_stop_word = (flags & CompositionTextStore::STOP_WORD) != 0;
 
-        candidates.push_back(c);
+            candidates.push_back(c);
+        }
+    };
+    emit();
+
+    // Too few of a hub's best left after filtering to fill the sample: take the whole row
+    if (!hub.empty() && candidates.size() < SAMPLE_TOP_K) {
+        agg.clear();
+        candidates.clear();
+        for (const auto& e : row) add_edge(e);
+        emit();
     }
 
     if (candidates.empty()) {
-        std::cerr << "WARNING: No viable candidates for " << current_hex << std::endl;
+        std::cerr << "WARNING: No viable candidates for " << BLAKE3Pipeline::to_hex(state.current_composition) << std::endl;
     }
 
     return candidates;
 }
 
-double WalkEngine::score_candidate(const WalkState& state, const Candidate& c, const WalkParameters& params) {
-    double score = 0.0;
-
-    // Core signals from relation graph
-    score += params.w_model * c.elo_score;
-    score += params.w_text  * c.obs_score;
-    score += params.w_rel   * (1.0 / (1.0 + std::exp(-c.rel_strength / 50.0)));
-
-    // Stop word: hard cap — guarantees they never enter top-K
-    if (c.is_stop_word) {
-        score = std::min(score, 0.02);
-    } else {
-        score += 0.05; // Small consistent push for content words
-    }
-
-    // Context seed bonus — if this candidate relates to a prompt keyword, boost it
-    if (!context_seeds_.empty()) {
-        for (const auto& seed : context_seeds_) {
-            if (c.id == seed) {
-                score += 0.3;
-                break;
-            }
-        }
-    }
-
-    // Repetition penalty
-    auto it = state.visit_counts.find(c.id);
-    if (it != state.visit_counts.end()) {
-        score -= params.w_repeat * static_cast<double>(it->second);
-    }
+void WalkEngine::seed_walk(WalkState& state, uint64_t seed, uint64_t stream) {
+    state.rng_key = Philox::stream_key(seed, stream);
+    state.rng_step = 0;
+}
 
-    // Novelty penalty (recent window)
-    if (std::find(state.recent.begin(), state.recent.end(), c.id) != state.recent.end()) {
-        score -= params.w_novelty;
+size_t WalkEngine::select_index(const std::vector<Candidate>& candidates, const std::vector<double>& logits,
+                                WalkState& state) {
+    // argmax(logit + Gumbel noise) is a softmax draw without normalizing or
+    // a cumulative table: one independent block per candidate, keyed by
+    // (step, ID), which the loop computes with no dependency between them
+    const uint32_t step_lo = static_cast<uint32_t>(state.rng_step);
+    const uint32_t step_hi = static_cast<uint32_t>(state.rng_step >> 32);
+    ++state.rng_step;
+
+    size_t best = 0;
+    double best_key = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        uint32_t id[2];
+        std::memcpy(id, candidates[i].id.data(), sizeof(id));
+        const double u = Philox::uniform(Philox::block({step_lo, step_hi, id[0], id[1]}, state.rng_key));
+        const double key = logits[i] - std::log(-std::log(u));
+        if (key > best_key) { best_key = key; best = i; }
     }
-
-    // Energy-based exploration bonus
-    score += params.w_energy * state.current_energy;
-
-    // Pre-softmax sharpening: widen gaps between content words and noise
-    score = std::pow(std::max(0.0, score), 0.75);
-
-    return score;
+    return best;
 }
 
-size_t WalkEngine::select_index(const std::vector<double>& probs) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::discrete_distribution<> d(probs.begin(), probs.end());
-    return d(gen);
+WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params) {
+    if (live_) graph_ = live_->snapshot();
+    return step(state, params, {graph_.get(), &context_seeds_});
 }
 
-WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params) {
+WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params, const WalkContext& ctx) {
+    HARTONOMOUS_SPAN("walk_step");
     WalkStepResult result;
     result.terminated = false;
 
@@ -330,29 +340,28 @@ WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params)
         return result;
     }
 
-    auto candidates = get_candidates(state);
+    auto candidates = get_candidates(state, ctx.graph, ctx.context_seeds);
     if (candidates.empty()) {
         result.terminated = true;
         result.reason = "Trapped in manifold (no neighbors)";
         return result;
     }
 
-    // Score all candidates
-    for (auto& c : candidates) {
-        c.score = score_candidate(state, c, params);
-    }
-
-    // Top-K filtering: keep only the best candidates to sharpen the distribution
-    constexpr size_t TOP_K = 32;
-    if (candidates.size() > TOP_K) {
-        std::partial_sort(candidates.begin(), candidates.begin() + TOP_K, candidates.end(),
-            [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
-        candidates.resize(TOP_K);
-    }
-
-    // Energy-modulated temperature: high energy = exploratory, low energy = greedy
-    double temperature = params.base_temp - params.energy_alpha * state.current_energy;
-    temperature = std::clamp(temperature, params.min_temp, params.base_temp);
+    // Score all candidates in one pass over their signals as parallel arrays;
+    // inputs of terms the walk's weights switch off are left unfilled
+    std::optional<WalkScorer> step_scorer;
+    if (!ctx.scorer) step_scorer.emplace(params);
+    const WalkScorer& scorer = ctx.scorer ? *ctx.scorer : *step_scorer;
+
+    static thread_local WalkCandidates signals;
+    static thread_local std::vector<double> scored;
+    const size_t n = candidates.size();
+    signals.resize(n);
+    scored.resize(n);
+    fill_signals(candidates, state, ctx, scorer, signals, 0);
+    scorer.score(signals, state.current_energy, scored.data());
+    for (size_t i = 0; i < n; ++i) candidates[i].score = scored[i];
+    keep_top(candidates);
 
     // Softmax sampling over top-K
     std::vector<double> scores;
@@ -361,29 +370,15 @@ WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params)
         scores.push_back(c.score);
     }
 
-    double max_s = *std::max_element(scores.begin(), scores.end());
-    double sum = 0.0;
-    std::vector<double> probs(scores.size());
-    for (size_t i = 0; i < scores.size(); ++i) {
-        double logit = (scores[i] - max_s) / temperature;
-        probs[i] = std::exp(logit);
-        sum += probs[i];
-    }
-    for (auto& p : probs) p /= sum;
+    std::vector<double> logits(scores.size()), probs(scores.size());
+    scorer.softmax(scores.data(), scores.size(), temperature(params, state.current_energy), logits.data(),
+                   probs.data());
 
-    size_t chosen = select_index(probs);
+    size_t chosen = select_index(candidates, logits, state);
     auto& selected = candidates[chosen];
+    prefetch_likely(ctx.graph, candidates, probs, chosen);
 
-    // Update State
-    state.current_composition = selected.id;
-    state.current_energy -= params.energy_decay;
-    state.trajectory.push_back(selected.id);
-    state.visit_counts[selected.id]++;
-    
-    state.recent.push_back(selected.id);
-    if (state.recent.size() > params.recent_window) {
-        state.recent.pop_front();
-    }
+    advance(state, selected, params);
 
     result.next_composition = selected.id;
     result.probability = probs[chosen];
@@ -397,26 +392,264 @@ WalkStepResult WalkEngine::step(WalkState& state, const WalkParameters& params)
     return result;
 }
 
+void WalkEngine::fill_signals(const std::vector<Candidate>& candidates, const WalkState& state,
+                              const WalkContext& ctx, const WalkScorer& scorer, WalkCandidates& out, size_t offset) {
+    // Inputs of terms the walk's weights switch off are left unfilled
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& c = candidates[i];
+        const size_t at = offset + i;
+        out.elo[at] = c.elo_score;
+        out.obs[at] = c.obs_score;
+        uint8_t flags = c.is_stop_word ? uint8_t(WalkCandidates::STOP_WORD) : uint8_t(0);
+        if (ctx.context_seeds && std::find(ctx.context_seeds->begin(), ctx.context_seeds->end(), c.id) !=
+                                     ctx.context_seeds->end())
+            flags |= WalkCandidates::CONTEXT_SEED;
+        if (scorer.uses_relation()) out.rel[at] = c.rel_strength;
+        if (scorer.uses_repeat()) {
+            auto it = state.visit_counts.find(c.node);
+            out.visits[at] = it != state.visit_counts.end() ? static_cast<double>(it->second) : 0.0;
+        }
+        if (scorer.uses_novelty() && std::find(state.recent.begin(), state.recent.end(), c.node) != state.recent.end())
+            flags |= WalkCandidates::RECENT;
+        out.flags[at] = flags;
+    }
+}
+
+void WalkEngine::keep_top(std::vector<Candidate>& candidates) {
+    // Top-K filtering: keep only the best candidates to sharpen the distribution
+    if (candidates.size() > SAMPLE_TOP_K) {
+        std::partial_sort(candidates.begin(), candidates.begin() + SAMPLE_TOP_K, candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        candidates.resize(SAMPLE_TOP_K);
+    }
+}
+
+double WalkEngine::temperature(const WalkParameters& params, double energy) {
+    return std::clamp(params.base_temp - params.energy_alpha * energy, params.min_temp, params.base_temp);
+}
+
+void WalkEngine::advance(WalkState& state, const Candidate& next, const WalkParameters& params) {
+    state.current_composition = next.id;
+    state.current_energy -= params.energy_decay;
+    state.trajectory.push_back(next.id);
+    state.visit_counts[next.node]++;
+
+    state.recent.push_back(next.node);
+    if (state.recent.size() > params.recent_window) {
+        state.recent.pop_front();
+    }
+}
+
+void WalkEngine::beam_walk(WalkState& state, const WalkParameters& params, size_t max_steps,
+                           const WalkContext& ctx) {
+    HARTONOMOUS_SPAN("walk_beam");
+    struct Beam {
+        WalkState state;
+        double log_prob = 0.0;
+    };
+    // A head's candidate i, at cumulative log-probability log_prob
+    struct Expansion {
+        uint32_t head;
+        uint32_t candidate;
+        double log_prob;
+    };
+
+    std::optional<WalkScorer> own_scorer;
+    if (!ctx.scorer) own_scorer.emplace(params);
+    const WalkScorer& scorer = ctx.scorer ? *ctx.scorer : *own_scorer;
+
+    const size_t width = std::max<size_t>(params.beam_width, 1);
+    std::vector<Beam> beams;
+    beams.push_back({state, 0.0});
+    std::vector<Beam> finished;   // Out of energy, trapped or at the goal
+    std::vector<std::vector<Candidate>> fronts;
+    std::vector<Expansion> expansions;
+    static thread_local WalkCandidates signals;
+    static thread_local std::vector<double> scored;
+    std::vector<double> scores, logits, probs;
+
+    for (size_t step_index = 0; step_index < max_steps && !beams.empty(); ++step_index) {
+        // Heads step in lockstep, so every live one has the same energy
+        if (beams.front().state.current_energy <= 0) break;
+        const double energy = beams.front().state.current_energy;
+
+        // The whole frontier's rows in one round trip; get_candidates then hits the cache
+        if (!ctx.graph && NeighborCache::global().enabled()) {
+            std::vector<BLAKE3Pipeline::Hash> heads;
+            heads.reserve(beams.size());
+            for (const auto& b : beams) heads.push_back(b.state.current_composition);
+            NeighborCache::global().prefetch(db_, heads);
+        }
+        if (ctx.graph && shards_) {
+            // Heads on other shards: one request per shard for all of them
+            std::vector<BLAKE3Pipeline::Hash> remote;
+            for (const auto& b : beams) {
+                if (!shards_->owns(b.state.current_composition)) remote.push_back(b.state.current_composition);
+            }
+            if (!remote.empty()) shards_->prefetch(remote);
+        }
+        if (ctx.graph && ctx.graph->is_paged()) {
+            // Out of core: the heads' rows are read from disk side by side instead of one by one
+            std::vector<uint32_t> heads;
+            heads.reserve(beams.size());
+            for (const auto& b : beams) heads.push_back(ctx.graph->index_of(b.state.current_composition));
+            ctx.graph->prefetch(heads);
+        }
+        fronts.resize(beams.size());
+        size_t total = 0;
+        for (size_t h = 0; h < beams.size(); ++h) {
+            fronts[h] = get_candidates(beams[h].state, ctx.graph, ctx.context_seeds);
+            total += fronts[h].size();
+        }
+
+        // Every head's candidates in one scoring pass
+        signals.resize(total);
+        scored.resize(total);
+        for (size_t h = 0, at = 0; h < beams.size(); at += fronts[h].size(), ++h)
+            fill_signals(fronts[h], beams[h].state, ctx, scorer, signals, at);
+        scorer.score(signals, energy, scored.data());
+
+        expansions.clear();
+        const double temp = temperature(params, energy);
+        for (size_t h = 0, at = 0; h < beams.size(); ++h) {
+            auto& front = fronts[h];
+            for (size_t i = 0; i < front.size(); ++i) front[i].score = scored[at + i];
+            at += front.size();
+            if (front.empty()) {
+                finished.push_back(std::move(beams[h]));
+                continue;
+            }
+            keep_top(front);
+            scores.resize(front.size());
+            logits.resize(front.size());
+            probs.resize(front.size());
+            for (size_t i = 0; i < front.size(); ++i) scores[i] = front[i].score;
+            scorer.softmax(scores.data(), scores.size(), temp, logits.data(), probs.data());
+            for (size_t i = 0; i < front.size(); ++i)
+                expansions.push_back({static_cast<uint32_t>(h), static_cast<uint32_t>(i),
+                                      beams[h].log_prob + std::log(probs[i])});
+        }
+        if (expansions.empty()) {
+            beams.clear();
+            break;
+        }
+
+        // Prune back to the width; ties go to the earlier head and candidate
+        const size_t keep = std::min(width, expansions.size());
+        std::partial_sort(expansions.begin(), expansions.begin() + keep, expansions.end(),
+            [](const Expansion& a, const Expansion& b) {
+                if (a.log_prob != b.log_prob) return a.log_prob > b.log_prob;
+                return a.head != b.head ? a.head < b.head : a.candidate < b.candidate;
+            });
+        std::vector<Beam> next;
+        next.reserve(keep);
+        for (size_t e = 0; e < keep; ++e) {
+            const auto& x = expansions[e];
+            Beam b{beams[x.head].state, x.log_prob};
+            advance(b.state, fronts[x.head][x.candidate], params);
+            if (b.state.goal_composition && b.state.current_composition == *b.state.goal_composition)
+                finished.push_back(std::move(b));
+            else
+                next.push_back(std::move(b));
+        }
+        beams = std::move(next);
+    }
+
+    // Longer beams have added more log terms, so they are compared per step
+    const size_t start_len = state.trajectory.size();
+    const Beam* best = nullptr;
+    double best_mean = -std::numeric_limits<double>::infinity();
+    for (const auto* pool : {&beams, &finished}) {
+        for (const auto& b : *pool) {
+            const size_t steps = b.state.trajectory.size() - start_len;
+            const double mean = steps ? b.log_prob / static_cast<double>(steps) : -std::numeric_limits<double>::max();
+            if (!best || mean > best_mean) {
+                best = &b;
+                best_mean = mean;
+            }
+        }
+    }
+    if (best) state = best->state;
+}
+
+void WalkEngine::prefetch_likely(const RelationGraph* graph, const std::vector<Candidate>& candidates,
+                                 const std::vector<double>& probs, size_t chosen) {
+    if (prefetch_width_ == 0) return;
+    if (graph ? !graph->is_paged() : !NeighborCache::global().enabled()) return;
+
+    // The pick is needed by the next step, loaded while this one emits its word;
+    // the runners-up are the likeliest picks when a walk passes here again
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    const size_t width = std::min(prefetch_width_, order.size());
+    std::partial_sort(order.begin(), order.begin() + width, order.end(),
+                      [&](size_t a, size_t b) { return probs[a] > probs[b]; });
+
+    std::vector<BLAKE3Pipeline::Hash> ids{candidates[chosen].id};
+    for (size_t i = 0; i < width && ids.size() < prefetch_width_; ++i)
+        if (order[i] != chosen) ids.push_back(candidates[order[i]].id);
+
+    if (graph) {
+        // A paged snapshot reads the rows from its file instead of the database
+        std::vector<uint32_t> rows;
+        rows.reserve(ids.size());
+        for (const auto& id : ids) rows.push_back(graph->index_of(id));
+        graph->prefetch(rows);
+        return;
+    }
+    if (!prefetch_) prefetch_ = std::make_unique<NeighborPrefetcher>(db_.conninfo());
+    prefetch_->enqueue(ids);
+}
+
 std::string WalkEngine::generate(const std::string& prompt, const WalkParameters& params, size_t max_steps) {
     auto state = init_walk_from_prompt(prompt, 1.0);
-    
-    std::string seed_text = lookup_text(state.current_composition);
+    if (params.seed) seed_walk(state, *params.seed);
+    if (live_) graph_ = live_->snapshot();
+    const WalkScorer scorer(params);
+    return walk_text(state, params, max_steps, {graph_.get(), &context_seeds_, &scorer});
+}
+
+std::string WalkEngine::generate(const std::string& prompt, const WalkParameters& params, size_t max_steps,
+                                 const WordCallback& on_word) {
+    auto state = init_walk_from_prompt(prompt, 1.0);
+    if (params.seed) seed_walk(state, *params.seed);
+    if (live_) graph_ = live_->snapshot();
+    const WalkScorer scorer(params);
+    return walk_text(state, params, max_steps, {graph_.get(), &context_seeds_, &scorer}, &on_word);
+}
+
+std::string WalkEngine::walk_text(WalkState& state, const WalkParameters& params, size_t max_steps,
+                                  const WalkContext& ctx, const WordCallback* on_word) {
+    std::string seed_text(lookup_text(state.current_composition));
     std::vector<std::string> words;
+    bool stopped = false;
     if (!seed_text.empty()) {
         words.push_back(seed_text);
+        stopped = on_word && !(*on_word)(words.back());
     }
 
-    for (size_t i = 0; i < max_steps; ++i) {
-        auto result = step(state, params);
-        if (result.terminated) break;
-
-        std::string text = lookup_text(result.next_composition);
-        if (text.empty()) continue;
+    auto take = [&](const BLAKE3Pipeline::Hash& id) {
+        std::string_view text = lookup_text(id);
+        if (text.empty()) return;
 
         // Avoid consecutive duplicates
-        if (!words.empty() && words.back() == text) continue;
+        if (!words.empty() && words.back() == text) return;
+
+        words.emplace_back(text);
+        stopped = on_word && !(*on_word)(words.back());
+    };
 
-        words.push_back(text);
+    if (params.beam_width > 1) {
+        // The best beam is only known at the end; its words go out then
+        const size_t start = state.trajectory.size();
+        if (!stopped) beam_walk(state, params, max_steps, ctx);
+        for (size_t i = start; i < state.trajectory.size() && !stopped; ++i) take(state.trajectory[i]);
+    } else {
+        for (size_t i = 0; i < max_steps && !stopped; ++i) {
+            auto result = step(state, params, ctx);
+            if (result.terminated) break;
+            take(result.next_composition);
+        }
     }
 
     // Assemble into readable text
@@ -440,4 +673,61 @@ std::string WalkEngine::generate(const std::string& prompt, const WalkParameters
     return output;
 }
 
+std::vector<std::string> WalkEngine::generate_batch(const std::vector<std::string>& prompts,
+                                                    const WalkParameters& params, size_t max_steps,
+                                                    size_t n_samples, uint64_t seed) {
+    // Seed resolution talks to the database, so it stays on this thread
+    std::vector<WalkState> starts;
+    std::vector<std::vector<BLAKE3Pipeline::Hash>> contexts;
+    starts.reserve(prompts.size() * n_samples);
+    contexts.reserve(prompts.size() * n_samples);
+    for (const auto& prompt : prompts) {
+        auto seeds = seed_prompt(prompt);
+        WalkState start = init_walk(seeds.start, 1.0);
+        for (size_t s = 0; s < n_samples; ++s) {
+            starts.push_back(start);
+            contexts.push_back(seeds.context);
+        }
+    }
+    return run_batch(std::move(starts), contexts, params, max_steps, seed);
+}
+
+std::vector<std::string> WalkEngine::generate_batch(const std::vector<BLAKE3Pipeline::Hash>& starts,
+                                                    const WalkParameters& params, size_t max_steps,
+                                                    size_t n_samples, uint64_t seed) {
+    std::vector<WalkState> states;
+    states.reserve(starts.size() * n_samples);
+    for (const auto& id : starts) {
+        WalkState start = init_walk(id, 1.0);
+        for (size_t s = 0; s < n_samples; ++s) states.push_back(start);
+    }
+    std::vector<std::vector<BLAKE3Pipeline::Hash>> contexts(states.size());
+    return run_batch(std::move(states), contexts, params, max_steps, seed);
+}
+
+std::vector<std::string> WalkEngine::run_batch(std::vector<WalkState> starts,
+                                               const std::vector<std::vector<BLAKE3Pipeline::Hash>>& contexts,
+                                               const WalkParameters& params, size_t max_steps, uint64_t seed) {
+    // One epoch for the whole batch: every walk reads the same graph
+    std::shared_ptr<const RelationGraph> graph = live_ ? live_->snapshot() : graph_;
+    const size_t n = starts.size();
+    std::vector<std::string> out(n);
+    const WalkScorer scorer(params);
+
+    auto run_one = [&](size_t i) {
+        seed_walk(starts[i], seed, i);
+        out[i] = walk_text(starts[i], params, max_steps, {graph.get(), &contexts[i], &scorer});
+    };
+
+    if (graph) {
+        // Long and short walks mix, so hand them out one at a time
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < n; ++i) run_one(i);
+    } else {
+        // Per-step queries share this engine's one connection
+        for (size_t i = 0; i < n; ++i) run_one(i);
+    }
+    return out;
+}
+
 } // namespace Hartonomous
@@ -0,0 +1,171 @@
+/**
+ * @file walk_scorer.cpp
+ * @brief Walk scoring and softmax kernels: one body per term set, cloned per ISA with target attributes
+ */
+
+#include <cognitive/walk_scorer.hpp>
+#include <cognitive/walk_engine.hpp>
+#include <utils/cpu_dispatch.hpp>
+#include <bit>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(HARTONOMOUS_X86_KERNELS)
+#define WALK_SCORER_DISPATCH 1
+#define WALK_TARGET(isa) __attribute__((target(isa)))
+#else
+#define WALK_SCORER_DISPATCH 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WALK_INLINE inline __attribute__((always_inline))
+#else
+#define WALK_INLINE inline
+#endif
+
+namespace Hartonomous {
+
+namespace {
+
+// e^t for t <= 0: Cody-Waite reduction by ln 2, Taylor series through r^12
+// (relative error ~1e-16); t is clamped at -700, which keeps 2^n normal
+WALK_INLINE double exp_neg(double t) {
+    t = t < -700.0 ? -700.0 : t;
+    // Adding 1.5 * 2^52 rounds to nearest and leaves n in the low mantissa bits, so
+    // neither a round instruction nor a double-to-integer conversion is needed
+    const double shifted = t * 1.4426950408889634 + 6755399441055744.0;
+    const double n = shifted - 6755399441055744.0;
+    const double r = (t - n * 0.6931471803691238) - n * 1.9082149292705877e-10;
+    double p = 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    const double scale = std::bit_cast<double>((std::bit_cast<uint64_t>(shifted) + 1023) << 52);
+    return p * scale;
+}
+
+template <unsigned TERMS>
+WALK_INLINE void score_body(const WalkScorer::Weights& w, const WalkCandidates& c, double energy, double* out) {
+    constexpr bool REL = TERMS & 1, REPEAT = TERMS & 2, NOVELTY = TERMS & 4;
+    const size_t n = c.size();
+    const double* elo = c.elo.data();
+    const double* obs = c.obs.data();
+    const double* rel = c.rel.data();
+    const double* visits = c.visits.data();
+    const uint8_t* flags = c.flags.data();
+    const double w_model = w.model, w_text = w.text, w_rel = w.rel, w_repeat = w.repeat, w_novelty = w.novelty;
+    const double bonus = w.energy * energy;
+
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        double s = w_model * elo[i] + w_text * obs[i];
+        if constexpr (REL) s += w_rel / (1.0 + exp_neg(-rel[i] / 50.0));
+
+        // Stop word: hard cap, so they never enter top-K; a small push for content words
+        const unsigned f = flags[i];
+        const double capped = s < 0.02 ? s : 0.02;
+        s = (f & WalkCandidates::STOP_WORD) ? capped : s + 0.05;
+        s += (f & WalkCandidates::CONTEXT_SEED) ? 0.3 : 0.0;
+        if constexpr (REPEAT) s -= w_repeat * visits[i];
+        if constexpr (NOVELTY) s -= (f & WalkCandidates::RECENT) ? w_novelty : 0.0;
+        s += bonus;
+
+        // Pre-softmax sharpening, x^0.75: widen gaps between content words and noise
+        s = s > 0.0 ? s : 0.0;
+        out[i] = std::sqrt(s * std::sqrt(s));
+    }
+}
+
+WALK_INLINE void softmax_body(const double* scores, size_t n, double temperature, double* logits, double* probs) {
+    double max_s = scores[0];
+    #pragma omp simd reduction(max : max_s)
+    for (size_t i = 0; i < n; ++i) max_s = scores[i] > max_s ? scores[i] : max_s;
+
+    double sum = 0.0;
+    #pragma omp simd reduction(+ : sum)
+    for (size_t i = 0; i < n; ++i) {
+        const double l = (scores[i] - max_s) / temperature;
+        logits[i] = l;
+        probs[i] = exp_neg(l);
+        sum += probs[i];
+    }
+
+    const double inv = 1.0 / sum;
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) probs[i] *= inv;
+}
+
+struct KernelTable {
+    WalkScorer::ScoreKernel score[8];
+    WalkScorer::SoftmaxKernel softmax;
+};
+
+// One clone of every kernel per target; ATTR is empty for the baseline build
+#define WALK_SCORER_CLONES(SUFFIX, ATTR)                                                               \
+    template <unsigned TERMS>                                                                           \
+    ATTR void score_##SUFFIX(const WalkScorer::Weights& w, const WalkCandidates& c, double energy,     \
+                             double* out) noexcept { score_body<TERMS>(w, c, energy, out); }           \
+    ATTR void softmax_##SUFFIX(const double* scores, size_t n, double temperature, double* logits,     \
+                               double* probs) noexcept { softmax_body(scores, n, temperature, logits, probs); } \
+    constexpr KernelTable TABLE_##SUFFIX{                                                               \
+        {score_##SUFFIX<0>, score_##SUFFIX<1>, score_##SUFFIX<2>, score_##SUFFIX<3>,                    \
+         score_##SUFFIX<4>, score_##SUFFIX<5>, score_##SUFFIX<6>, score_##SUFFIX<7>},                   \
+        softmax_##SUFFIX};
+
+WALK_SCORER_CLONES(scalar, )
+#if WALK_SCORER_DISPATCH
+WALK_SCORER_CLONES(sse4, WALK_TARGET("sse4.1"))
+WALK_SCORER_CLONES(avx2, WALK_TARGET("avx2,fma"))
+// The flag bytes need AVX-512BW, which SimdLevel::Avx512 implies
+WALK_SCORER_CLONES(avx512, WALK_TARGET("avx512f,avx512bw,avx512dq,avx512vl,prefer-vector-width=512"))
+#endif
+#undef WALK_SCORER_CLONES
+
+const KernelTable& kernels() noexcept {
+#if WALK_SCORER_DISPATCH
+    switch (simd_level()) {
+        case SimdLevel::Avx512: return TABLE_avx512;
+        case SimdLevel::Avx2: return TABLE_avx2;
+        case SimdLevel::Sse4: return TABLE_sse4;
+        default: break;
+    }
+#endif
+    return TABLE_scalar;
+}
+
+} // namespace
+
+WalkScorer::WalkScorer(const WalkParameters& params) {
+    w_.model = params.w_model;
+    w_.text = params.w_text;
+    w_.rel = params.w_rel;
+    w_.repeat = params.w_repeat;
+    w_.novelty = params.w_novelty;
+    w_.energy = params.w_energy;
+    // w_geo and w_hilbert are reserved and never scored
+    if (w_.rel != 0.0) terms_ |= REL;
+    if (w_.repeat != 0.0) terms_ |= REPEAT;
+    if (w_.novelty != 0.0) terms_ |= NOVELTY;
+
+    const KernelTable& table = kernels();
+    score_ = table.score[terms_];
+    softmax_ = table.softmax;
+}
+
+void WalkScorer::score(const WalkCandidates& c, double energy, double* out) const {
+    score_(w_, c, energy, out);
+}
+
+void WalkScorer::softmax(const double* scores, size_t n, double temperature, double* logits, double* probs) const {
+    softmax_(scores, n, temperature, logits, probs);
+}
+
+} // namespace Hartonomous
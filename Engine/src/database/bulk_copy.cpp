@@ -1,16 +1,24 @@
 #include <database/bulk_copy.hpp>
+#include <utils/ingest_report.hpp>
+#include <utils/metrics.hpp>
 #include <stdexcept>
+#include <cstdlib>
 #include <utility>
 #include <cstring>
 #include <algorithm>
-#include <arpa/inet.h> // For network byte order (htobe32, htobe64)
 
 namespace Hartonomous {
 
-std::atomic<uint64_t> BulkCopy::s_counter_{0};
-
 BulkCopy::BulkCopy(PostgresConnection& db, bool use_temp_table) noexcept
-    : db_(db), use_temp_table_(use_temp_table) {}
+    : BulkCopy(db, use_temp_table ? CopyMode::Staged : CopyMode::TrustedUnique) {}
+
+BulkCopy::BulkCopy(PostgresConnection& db, CopyMode mode) noexcept
+    : db_(db), use_temp_table_(mode == CopyMode::Staged) {
+    if (const char* a = std::getenv("HARTONOMOUS_COPY_ASYNC")) async_send_ = std::strtol(a, nullptr, 10) != 0;
+    if (const char* kb = std::getenv("HARTONOMOUS_COPY_BUFFER_KB")) {
+        send_buffer_bytes_ = std::max<size_t>(MIN_SEND_BUFFER_BYTES, std::strtoull(kb, nullptr, 10) << 10);
+    }
+}
 
 BulkCopy::~BulkCopy() {
     try {
@@ -23,125 +31,45 @@ void BulkCopy::set_binary(bool binary) {
     binary_mode_ = binary;
 }
 
-// ============================================================================
-// BinaryRow Implementation
-// ============================================================================
-
-void BulkCopy::BinaryRow::add_uuid(const std::array<uint8_t, 16>& uuid) {
-    // 4 byte length
-    int32_t len = htonl(16);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    // 16 bytes data
-    buffer.insert(buffer.end(), uuid.begin(), uuid.end());
-    num_fields++;
+void BulkCopy::set_async_send(bool async) {
+    if (in_copy_) throw std::runtime_error("Cannot change send mode while COPY is active");
+    async_send_ = async;
 }
 
-void BulkCopy::BinaryRow::add_int32(int32_t val) {
-    int32_t len = htonl(4);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    
-    int32_t net_val = htonl(val);
-    uint8_t* v = reinterpret_cast<uint8_t*>(&net_val);
-    buffer.insert(buffer.end(), v, v + 4);
-    num_fields++;
-}
-
-void BulkCopy::BinaryRow::add_int64(int64_t val) {
-    int32_t len = htonl(8);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-
-    // split 64-bit for endianness if htobe64 not available, but assuming Linux/GCC here
-    // Postgres expects big-endian 64-bit
-    uint64_t net_val = __builtin_bswap64(static_cast<uint64_t>(val)); 
-    uint8_t* v = reinterpret_cast<uint8_t*>(&net_val);
-    buffer.insert(buffer.end(), v, v + 8);
-    num_fields++;
+void BulkCopy::set_send_buffer_bytes(size_t bytes) {
+    if (in_copy_) throw std::runtime_error("Cannot resize send buffer while COPY is active");
+    send_buffer_bytes_ = std::max(MIN_SEND_BUFFER_BYTES, bytes);
 }
 
-void BulkCopy::BinaryRow::add_double(double val) {
-    int32_t len = htonl(8);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-
-    // Standard IEEE 754 double, assume same format, just swap bytes
-    uint64_t raw;
-    std::memcpy(&raw, &val, 8);
-    uint64_t net_val = __builtin_bswap64(raw);
-    uint8_t* v = reinterpret_cast<uint8_t*>(&net_val);
-    buffer.insert(buffer.end(), v, v + 8);
-    num_fields++;
-}
-
-void BulkCopy::BinaryRow::add_text(const std::string& text) {
-    int32_t len = htonl(static_cast<int32_t>(text.size()));
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    
-    buffer.insert(buffer.end(), text.begin(), text.end());
-    num_fields++;
-}
-
-void BulkCopy::BinaryRow::add_bytes(const void* data, size_t len) {
-    int32_t net_len = htonl(static_cast<int32_t>(len));
-    uint8_t* p = reinterpret_cast<uint8_t*>(&net_len);
-    buffer.insert(buffer.end(), p, p + 4);
-    
-    const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
-    buffer.insert(buffer.end(), d, d + len);
-    num_fields++;
-}
+// ============================================================================
+// BinaryRow Implementation
+// ============================================================================
 
-void BulkCopy::BinaryRow::add_null() {
-    int32_t len = htonl(-1); // -1 indicates NULL
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    num_fields++;
-}
+namespace {
 
-void BulkCopy::BinaryRow::add_bool(bool val) {
-    int32_t len = htonl(1);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    uint8_t b = val ? 1 : 0;
-    buffer.push_back(b);
-    num_fields++;
+template <typename Field>
+void append_field(BulkCopy::BinaryRow& row, const typename Field::value_type& v) {
+    size_t off = row.buffer.size();
+    row.buffer.resize(off + Field::size(v));
+    Field::encode(row.buffer.data() + off, v);
+    row.num_fields++;
 }
 
-void BulkCopy::BinaryRow::add_uint16(uint16_t val) {
-    // Send as 2-byte big-endian bytea (matches PostgreSQL uint16 domain)
-    int32_t len = htonl(2);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    uint8_t bytes[2];
-    bytes[0] = static_cast<uint8_t>((val >> 8) & 0xFF);
-    bytes[1] = static_cast<uint8_t>(val & 0xFF);
-    buffer.insert(buffer.end(), bytes, bytes + 2);
-    num_fields++;
-}
+} // namespace
 
-void BulkCopy::BinaryRow::add_uint32(uint32_t val) {
-    // Send as 4-byte big-endian bytea (matches PostgreSQL uint32 domain)
-    int32_t len = htonl(4);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    uint32_t be = htonl(val);
-    uint8_t* v = reinterpret_cast<uint8_t*>(&be);
-    buffer.insert(buffer.end(), v, v + 4);
-    num_fields++;
-}
+void BulkCopy::BinaryRow::add_uuid(const std::array<uint8_t, 16>& uuid) { append_field<pgcopy::Uuid>(*this, uuid); }
+void BulkCopy::BinaryRow::add_int32(int32_t val) { append_field<pgcopy::Int32>(*this, val); }
+void BulkCopy::BinaryRow::add_int64(int64_t val) { append_field<pgcopy::Int64>(*this, val); }
+void BulkCopy::BinaryRow::add_double(double val) { append_field<pgcopy::Float8>(*this, val); }
+void BulkCopy::BinaryRow::add_text(const std::string& text) { append_field<pgcopy::Text>(*this, text); }
+void BulkCopy::BinaryRow::add_null() { append_field<pgcopy::Null>(*this, nullptr); }
+void BulkCopy::BinaryRow::add_bool(bool val) { append_field<pgcopy::Bool>(*this, val); }
+void BulkCopy::BinaryRow::add_uint16(uint16_t val) { append_field<pgcopy::UInt16>(*this, val); }
+void BulkCopy::BinaryRow::add_uint32(uint32_t val) { append_field<pgcopy::UInt32>(*this, val); }
+void BulkCopy::BinaryRow::add_uint64(uint64_t val) { append_field<pgcopy::UInt64>(*this, val); }
 
-void BulkCopy::BinaryRow::add_uint64(uint64_t val) {
-    // Send as 8-byte big-endian bytea (matches PostgreSQL uint64 domain)
-    int32_t len = htonl(8);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&len);
-    buffer.insert(buffer.end(), p, p + 4);
-    uint64_t be = __builtin_bswap64(val);
-    uint8_t* v = reinterpret_cast<uint8_t*>(&be);
-    buffer.insert(buffer.end(), v, v + 8);
-    num_fields++;
+void BulkCopy::BinaryRow::add_bytes(const void* data, size_t len) {
+    append_field<pgcopy::Bytes>(*this, {static_cast<const uint8_t*>(data), len});
 }
 
 // ============================================================================
@@ -164,22 +92,18 @@ void BulkCopy::begin_table(const std::string& table_name, const std::vector<std:
     
     // Reset buffers
     if (binary_mode_) {
-        bin_buffer_.clear();
+        bin_size_ = 0;
     } else {
         buffer_.str("");
         buffer_.clear();
     }
     
     in_copy_ = false;
-    
-    // Setup temp table name once
-    if (use_temp_table_) {
-        uint64_t id = ++s_counter_;
-        temp_table_name_ = "tmp_" + table_name_ + "_" + std::to_string(id);
-        temp_table_created_ = false;
-    } else {
-        temp_table_name_.clear();
-    }
+    staging_table_ = use_temp_table_ ? "stage_" + (schema_.empty() ? "" : schema_ + "_") + table_name_ : "";
+}
+
+std::string BulkCopy::staging_table_name() const {
+    return "pg_temp." + quote_identifier(staging_table_);
 }
 
 std::string BulkCopy::quote_identifier(const std::string& id) const {
@@ -215,19 +139,38 @@ void BulkCopy::escape_value_into_buffer(const std::string& value) {
 }
 
 void BulkCopy::write_binary_header() {
-    // PGCOPY\n\377\r\n\0
-    static const uint8_t header[] = {'P','G','C','O','P','Y','\n',0xFF,'\r','\n','\0'};
-    bin_buffer_.insert(bin_buffer_.end(), std::begin(header), std::end(header));
-    
-    // Flags (0) - network byte order
-    int32_t flags = 0;
-    uint8_t f[4];
-    int32_t net_flags = htonl(flags);
-    std::memcpy(f, &net_flags, 4);
-    bin_buffer_.insert(bin_buffer_.end(), f, f + 4);
-    
-    // Header Ext Length (0)
-    bin_buffer_.insert(bin_buffer_.end(), f, f + 4);
+    // PGCOPY\n\377\r\n\0, flags (0), header extension length (0)
+    static const uint8_t header[] = {'P','G','C','O','P','Y','\n',0xFF,'\r','\n','\0', 0,0,0,0, 0,0,0,0};
+    if (bin_buffer_.size() != send_buffer_bytes_) bin_buffer_.resize(send_buffer_bytes_);
+    std::memcpy(bin_buffer_.data(), header, sizeof(header));
+    bin_size_ = sizeof(header);
+}
+
+void BulkCopy::send(const char* data, size_t len) {
+    // libpq copies the bytes, so the buffer is free again on return; in async
+    // mode the transfer itself proceeds while the next buffer is encoded.
+    bytes_sent_ += len;
+    if (async_send_) db_.copy_data_async(data, static_cast<int>(len));
+    else db_.copy_data(data, static_cast<int>(len));
+}
+
+void BulkCopy::send_binary_buffer() {
+    if (bin_size_ == 0) return;
+    send(reinterpret_cast<const char*>(bin_buffer_.data()), bin_size_);
+    bin_size_ = 0;
+}
+
+void BulkCopy::send_text_buffer() {
+    std::string data = buffer_.str();
+    if (!data.empty()) send(data.data(), data.size());
+    buffer_.str("");
+    buffer_.clear();
+}
+
+void BulkCopy::make_room(size_t n) {
+    // Ship what is buffered; only grow for a single row larger than the buffer
+    send_binary_buffer();
+    if (n > bin_buffer_.size()) bin_buffer_.resize(n);
 }
 
 void BulkCopy::start_copy_if_needed() {
@@ -237,18 +180,18 @@ void BulkCopy::start_copy_if_needed() {
         throw std::runtime_error("BulkCopy: columns not set. Call begin_table() first.");
     }
 
-    std::string target_table = use_temp_table_ ? quote_identifier(temp_table_name_) : full_table_name();
+    std::string target_table = use_temp_table_ ? staging_table_name() : full_table_name();
 
     if (use_temp_table_) {
-        // Ensure temp table exists
-        std::ostringstream create_sql;
-        create_sql << "CREATE TEMP TABLE IF NOT EXISTS " << target_table
-                   << " (LIKE " << full_table_name() << " INCLUDING DEFAULTS) ON COMMIT PRESERVE ROWS";
-        db_.execute(create_sql.str());
-        
-        std::ostringstream truncate_sql;
-        truncate_sql << "TRUNCATE " << target_table;
-        db_.execute(truncate_sql.str());
+        // One staging table per connection and target, reused across batches
+        if (!db_.has_staging_table(staging_table_)) {
+            std::ostringstream create_sql;
+            create_sql << "CREATE TEMP TABLE IF NOT EXISTS " << quote_identifier(staging_table_)
+                       << " (LIKE " << full_table_name() << " INCLUDING DEFAULTS) ON COMMIT PRESERVE ROWS";
+            db_.execute(create_sql.str());
+            db_.add_staging_table(staging_table_);
+        }
+        db_.execute("TRUNCATE " + target_table);
     }
 
     std::ostringstream copy_sql;
@@ -265,6 +208,9 @@ void BulkCopy::start_copy_if_needed() {
     
     db_.execute(copy_sql.str());
     in_copy_ = true;
+    bytes_sent_ = 0;
+    copy_start_ = std::chrono::steady_clock::now();
+    if (async_send_) db_.set_nonblocking(true);
 
     if (binary_mode_) {
         write_binary_header();
@@ -287,61 +233,39 @@ void BulkCopy::add_row(const std::vector<std::string>& values) {
     buffer_ << '\n';
     ++row_count_;
 
-    if ((row_count_ % DEFAULT_FLUSH_ROWS) == 0) {
-        std::string data = buffer_.str();
-        if (!data.empty()) {
-            db_.copy_data(data.c_str(), static_cast<int>(data.size()));
-            buffer_.str("");
-            buffer_.clear();
-        }
-    }
+    if (static_cast<size_t>(buffer_.tellp()) >= send_buffer_bytes_) send_text_buffer();
 }
 
 void BulkCopy::add_row(const BinaryRow& row) {
-    if (!binary_mode_) throw std::runtime_error("Cannot add binary row in text mode");
-    start_copy_if_needed();
-
-    // 2 bytes field count
-    int16_t nf = htons(row.num_fields);
-    uint8_t* p = reinterpret_cast<uint8_t*>(&nf);
-    bin_buffer_.insert(bin_buffer_.end(), p, p + 2);
-    
-    // Field data
-    bin_buffer_.insert(bin_buffer_.end(), row.buffer.begin(), row.buffer.end());
-    
-    ++row_count_;
-
-    if ((row_count_ % DEFAULT_FLUSH_ROWS) == 0) {
-        if (!bin_buffer_.empty()) {
-            db_.copy_data(reinterpret_cast<const char*>(bin_buffer_.data()), static_cast<int>(bin_buffer_.size()));
-            bin_buffer_.clear();
-        }
-    }
+    size_t n = 2 + row.buffer.size();
+    uint8_t* p = reserve_row(n);
+    p = pgcopy::store_be16(p, static_cast<uint16_t>(row.num_fields));
+    std::memcpy(p, row.buffer.data(), row.buffer.size());
+    commit_row(n);
 }
 
 void BulkCopy::flush() {
     if (!in_copy_) return;
+    HARTONOMOUS_SPAN("copy_flush");
 
     if (binary_mode_) {
-        // Send remaining data + trailer
-        if (!bin_buffer_.empty()) {
-             db_.copy_data(reinterpret_cast<const char*>(bin_buffer_.data()), static_cast<int>(bin_buffer_.size()));
-             bin_buffer_.clear();
-        }
-        // Construct and send trailer separately to avoid messing up buffer if it was just cleared
-        std::vector<uint8_t> trailer;
-        int16_t t = htons(-1);
-        uint8_t* p = reinterpret_cast<uint8_t*>(&t);
-        trailer.insert(trailer.end(), p, p + 2);
-        db_.copy_data(reinterpret_cast<const char*>(trailer.data()), 2);
+        // Trailer (-1 field count) goes out with the remaining rows
+        if (bin_size_ + 2 > bin_buffer_.size()) send_binary_buffer();
+        pgcopy::store_be16(bin_buffer_.data() + bin_size_, 0xFFFF);
+        bin_size_ += 2;
+        send_binary_buffer();
     } else {
-        std::string data = buffer_.str();
-        if (!data.empty()) {
-            db_.copy_data(data.c_str(), static_cast<int>(data.size()));
-        }
+        send_text_buffer();
     }
 
-    db_.copy_end(nullptr);
+    try {
+        db_.copy_end(nullptr);
+    } catch (...) {
+        in_copy_ = false;
+        try { db_.set_nonblocking(false); } catch (...) {}
+        throw;
+    }
+    db_.set_nonblocking(false);
 
     if (use_temp_table_) {
         std::ostringstream sql;
@@ -353,7 +277,7 @@ void BulkCopy::flush() {
             cols_str += quote_identifier(columns_[i]);
         }
         
-        sql << " (" << cols_str << ") SELECT " << cols_str << " FROM " << quote_identifier(temp_table_name_);
+        sql << " (" << cols_str << ") SELECT " << cols_str << " FROM " << staging_table_name();
         
         if (!conflict_clause_.empty()) {
             sql << " " << conflict_clause_;
@@ -364,8 +288,15 @@ void BulkCopy::flush() {
         db_.execute(sql.str());
     }
 
+    const std::string table = schema_.empty() ? table_name_ : schema_ + "." + table_name_;
+    IngestReport::global().copied(table, row_count_, bytes_sent_,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - copy_start_).count());
+    auto& metrics = Metrics::global();
+    const std::string label = Metrics::label("table", table);
+    metrics.counter("hartonomous_copy_rows_total", label, "Rows written by COPY").add(row_count_);
+    metrics.counter("hartonomous_copy_bytes_total", label, "COPY payload bytes sent").add(bytes_sent_);
     in_copy_ = false;
-    if (binary_mode_) bin_buffer_.clear();
+    if (binary_mode_) bin_size_ = 0;
     else { buffer_.str(""); buffer_.clear(); }
     row_count_ = 0;
 }
@@ -0,0 +1,289 @@
+#include <database/bulk_load_session.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace Hartonomous {
+
+namespace {
+
+constexpr const char* STATE_TABLE = "hartonomous_internal.bulkloaddeferred";
+
+void ensure_state_table(PostgresConnection& db) {
+    db.execute("CREATE SCHEMA IF NOT EXISTS hartonomous_internal");
+    db.execute(std::string("CREATE TABLE IF NOT EXISTS ") + STATE_TABLE + " ("
+               "Kind CHAR(1) NOT NULL, TableName TEXT NOT NULL, Name TEXT NOT NULL, Definition TEXT NOT NULL, "
+               "DeferredAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP, "
+               "PRIMARY KEY (Kind, TableName, Name))");
+}
+
+std::string table_array() {
+    std::string out = "{";
+    for (const auto& t : BulkLoadSession::tables()) {
+        if (out.size() > 1) out += ',';
+        out += t;
+    }
+    return out + "}";
+}
+
+std::string quote_ident(const std::string& name) {
+    std::string out = "\"";
+    for (char c : name) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string qualified(const std::string& name) { return "hartonomous." + quote_ident(name); }
+
+// One statement sequence run on a worker connection; `name` is only for messages
+struct Task {
+    std::string name;
+    std::function<void(PostgresConnection&)> run;
+};
+
+/**
+ * @brief Run `tasks` from up to opts.jobs connections, in order of the list
+ *
+ * Failures are collected rather than stopping the others; the messages are returned.
+ */
+std::vector<std::string> run_parallel(std::vector<Task>& tasks, const BulkLoadOptions& opts) {
+    std::vector<std::string> errors;
+    if (tasks.empty()) return errors;
+    const size_t jobs = std::min(tasks.size(), opts.jobs);
+    std::atomic<size_t> next{0};
+    std::mutex mu;
+
+    auto worker = [&] {
+        std::unique_ptr<PostgresConnection> db;
+        for (size_t i; (i = next.fetch_add(1)) < tasks.size();) {
+            try {
+                if (!db) {
+                    db = std::make_unique<PostgresConnection>();
+                    db->execute("SET max_parallel_maintenance_workers = " + std::to_string(opts.maintenance_workers));
+                    if (!opts.maintenance_memory.empty())
+                        db->execute("SET maintenance_work_mem = '" + opts.maintenance_memory + "'");
+                }
+                tasks[i].run(*db);
+                std::lock_guard<std::mutex> lock(mu);
+                std::cout << "  Bulk load: restored " << tasks[i].name << std::endl;
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(mu);
+                errors.push_back(tasks[i].name + ": " + e.what());
+                db.reset();   // A failed connection is not reused
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t j = 0; j < jobs; ++j) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+    return errors;
+}
+
+void forget(PostgresConnection& db, char kind, const std::string& table, const std::string& name) {
+    db.execute(std::string("DELETE FROM ") + STATE_TABLE + " WHERE Kind = $1 AND TableName = $2 AND Name = $3",
+               {std::string(1, kind), table, name});
+}
+
+bool index_exists(PostgresConnection& db, const std::string& name) {
+    return db.query_single("SELECT to_regclass($1) IS NOT NULL", {qualified(name)}).value_or("f") == "t";
+}
+
+void throw_if(const std::vector<std::string>& errors, const char* phase) {
+    if (errors.empty()) return;
+    for (const auto& e : errors) std::cerr << "  Bulk load: " << e << std::endl;
+    throw std::runtime_error(std::string("bulk load ") + phase + ": " + std::to_string(errors.size()) +
+                             " failed, first: " + errors.front());
+}
+
+} // namespace
+
+BulkLoadOptions BulkLoadOptions::from_env() {
+    BulkLoadOptions o;
+    if (const char* v = std::getenv("HARTONOMOUS_BULK_LOAD")) o.enabled = std::strcmp(v, "0") != 0 && *v;
+    if (const char* v = std::getenv("HARTONOMOUS_BULK_LOAD_JOBS")) o.jobs = std::strtoull(v, nullptr, 10);
+    if (const char* v = std::getenv("HARTONOMOUS_BULK_LOAD_WORKERS")) o.maintenance_workers = std::strtoull(v, nullptr, 10);
+    if (const char* v = std::getenv("HARTONOMOUS_BULK_LOAD_MEMORY")) o.maintenance_memory = v;
+    if (o.jobs == 0) o.jobs = std::max(1u, std::thread::hardware_concurrency() / 4);
+    return o;
+}
+
+const std::vector<std::string>& BulkLoadSession::tables() {
+    static const std::vector<std::string> t = {
+        "physicality", "composition", "compositionsequence", "relation",
+        "relationsequence", "relationrating", "relationevidence",
+    };
+    return t;
+}
+
+BulkLoadSession::BulkLoadSession(PostgresConnection& db, BulkLoadOptions opts) : db_(db), opts_(std::move(opts)) {
+    if (opts_.enabled) {
+        const size_t n = begin(db_);
+        std::cout << "  Bulk load: " << n << " indexes and constraints deferred until the load finishes" << std::endl;
+    } else if (pending(db_) > 0) {
+        std::cout << "  Bulk load: restoring what an interrupted bulk load deferred" << std::endl;
+        finish(db_, opts_);
+    }
+}
+
+void BulkLoadSession::finish() { finish(db_, opts_); }
+
+size_t BulkLoadSession::pending(PostgresConnection& db) {
+    auto n = db.query_single(std::string("SELECT CASE WHEN to_regclass('") + STATE_TABLE + "') IS NULL THEN 0 "
+                             "ELSE (SELECT count(*) FROM " + STATE_TABLE + ") END");
+    return n ? std::stoull(*n) : 0;
+}
+
+size_t BulkLoadSession::begin(PostgresConnection& db) {
+    ensure_state_table(db);
+    PostgresConnection::Transaction txn(db);
+    const std::string tabs = table_array();
+
+    // Secondary indexes: not the primary key, not backing a UNIQUE or EXCLUDE
+    // constraint, and on partitioned tables only the parent (dropping it drops
+    // the partitions' indexes)
+    db.execute(std::string("INSERT INTO ") + STATE_TABLE + " (Kind, TableName, Name, Definition) "
+               "SELECT 'i', t.relname, i.relname, pg_get_indexdef(x.indexrelid) "
+               "FROM pg_index x "
+               "JOIN pg_class i ON i.oid = x.indexrelid "
+               "JOIN pg_class t ON t.oid = x.indrelid "
+               "JOIN pg_namespace n ON n.oid = t.relnamespace "
+               "WHERE n.nspname = 'hartonomous' AND t.relname = ANY($1::text[]) AND NOT t.relispartition "
+               "AND NOT x.indisprimary "
+               "AND NOT EXISTS (SELECT 1 FROM pg_constraint c WHERE c.conindid = x.indexrelid AND c.conrelid = t.oid) "
+               "ON CONFLICT DO NOTHING", {tabs});
+    db.execute(std::string("INSERT INTO ") + STATE_TABLE + " (Kind, TableName, Name, Definition) "
+               "SELECT 'c', t.relname, c.conname, pg_get_constraintdef(c.oid) "
+               "FROM pg_constraint c "
+               "JOIN pg_class t ON t.oid = c.conrelid "
+               "JOIN pg_namespace n ON n.oid = t.relnamespace "
+               "WHERE n.nspname = 'hartonomous' AND t.relname = ANY($1::text[]) AND c.contype = 'c' AND c.conislocal "
+               "ON CONFLICT DO NOTHING", {tabs});
+
+    // Drop what is listed and still there (an earlier session may have dropped it already)
+    std::vector<std::string> drops;
+    db.query(std::string("SELECT d.Kind, d.TableName, d.Name FROM ") + STATE_TABLE + " d "
+             "WHERE (d.Kind = 'i' AND to_regclass('hartonomous.' || quote_ident(d.Name)) IS NOT NULL) "
+             "OR (d.Kind = 'c' AND EXISTS (SELECT 1 FROM pg_constraint c "
+             "    WHERE c.conrelid = to_regclass('hartonomous.' || quote_ident(d.TableName)) AND c.conname = d.Name))",
+             [&](const std::vector<std::string>& row) {
+                 drops.push_back(row[0] == "i"
+                     ? "DROP INDEX " + qualified(row[2])
+                     : "ALTER TABLE " + qualified(row[1]) + " DROP CONSTRAINT " + quote_ident(row[2]));
+             });
+    for (const auto& sql : drops) db.execute(sql);
+    txn.commit();
+    return pending(db);
+}
+
+void BulkLoadSession::finish(PostgresConnection& db, const BulkLoadOptions& opts) {
+    if (pending(db) == 0) return;
+
+    struct Deferred { std::string table, name, definition; bool partitioned; };
+    std::vector<Deferred> indexes, checks;
+    // Largest tables first, so the longest builds do not start last
+    db.query(std::string("SELECT d.Kind, d.TableName, d.Name, d.Definition, t.relkind = 'p' FROM ") + STATE_TABLE + " d "
+             "JOIN pg_class t ON t.oid = to_regclass('hartonomous.' || quote_ident(d.TableName)) "
+             "ORDER BY (SELECT sum(pg_total_relation_size(p.relid)) FROM pg_partition_tree(t.oid) p) DESC, d.Name",
+             [&](const std::vector<std::string>& row) {
+                 (row[0] == "i" ? indexes : checks).push_back({row[1], row[2], row[3], row[4] == "t"});
+             });
+
+    // 1. Indexes. A partitioned table's index is created ON ONLY the parent,
+    //    built per partition as separate tasks, and attached afterwards
+    std::vector<Task> tasks;
+    struct Attach { Deferred parent; std::vector<std::string> children; };
+    std::vector<Attach> attaches;
+    for (const auto& d : indexes) {
+        const std::string on_only = " ON ONLY " + qualified(d.table) + " ";
+        const std::string head = "INDEX " + quote_ident(d.name) + on_only;
+        std::string def = d.definition;
+        // pg_get_indexdef leaves names quoted only where needed
+        std::string bare_head = "INDEX " + d.name + " ON ONLY hartonomous." + d.table + " ";
+        size_t at = def.find(bare_head);
+        size_t head_len = bare_head.size();
+        if (at == std::string::npos) { at = def.find(head); head_len = head.size(); }
+
+        if (!d.partitioned || at == std::string::npos) {
+            tasks.push_back({d.name, [d](PostgresConnection& c) {
+                PostgresConnection::Transaction txn(c);
+                if (!index_exists(c, d.name)) c.execute(d.definition);
+                forget(c, 'i', d.table, d.name);
+                txn.commit();
+            }});
+            continue;
+        }
+
+        if (!index_exists(db, d.name)) db.execute(def);
+        const std::string short_name = d.name.rfind("idx_", 0) == 0 ? d.name.substr(4) : d.name;
+        Attach a{d, {}};
+        db.query("SELECT c.relname FROM pg_inherits i JOIN pg_class c ON c.oid = i.inhrelid "
+                 "WHERE i.inhparent = to_regclass($1) ORDER BY pg_total_relation_size(c.oid) DESC",
+                 {qualified(d.table)},
+                 [&](const std::vector<std::string>& row) {
+                     const std::string part = row[0];
+                     const std::string child = (part + "_" + short_name).substr(0, 63);
+                     std::string cdef = def;
+                     cdef.replace(at, head_len, "INDEX " + quote_ident(child) + " ON " + qualified(part) + " ");
+                     a.children.push_back(child);
+                     tasks.push_back({child, [child, cdef](PostgresConnection& c) {
+                         if (!index_exists(c, child)) c.execute(cdef);
+                     }});
+                 });
+        attaches.push_back(std::move(a));
+    }
+    throw_if(run_parallel(tasks, opts), "index rebuild");
+
+    for (const auto& a : attaches) {
+        PostgresConnection::Transaction txn(db);
+        for (const auto& child : a.children) {
+            const bool attached = db.query_single("SELECT count(*) FROM pg_inherits WHERE inhrelid = to_regclass($1)",
+                                                  {qualified(child)}).value_or("0") != "0";
+            if (!attached) db.execute("ALTER INDEX " + qualified(a.parent.name) + " ATTACH PARTITION " + qualified(child));
+        }
+        forget(db, 'i', a.parent.table, a.parent.name);
+        txn.commit();
+    }
+
+    // 2. CHECKs: added NOT VALID (brief exclusive lock, no scan), then
+    //    validated under a lock that lets writes continue
+    tasks.clear();
+    for (const auto& d : checks) {
+        tasks.push_back({d.name, [d](PostgresConnection& c) {
+            std::string def = d.definition;
+            const std::string nv = " NOT VALID";
+            if (def.size() > nv.size() && def.compare(def.size() - nv.size(), nv.size(), nv) == 0)
+                def.resize(def.size() - nv.size());
+            const bool exists = c.query_single("SELECT count(*) FROM pg_constraint "
+                                               "WHERE conrelid = to_regclass($1) AND conname = $2",
+                                               {qualified(d.table), d.name}).value_or("0") != "0";
+            if (!exists)
+                c.execute("ALTER TABLE " + qualified(d.table) + " ADD CONSTRAINT " + quote_ident(d.name) + " " +
+                          def + " NOT VALID");
+            PostgresConnection::Transaction txn(c);
+            c.execute("ALTER TABLE " + qualified(d.table) + " VALIDATE CONSTRAINT " + quote_ident(d.name));
+            forget(c, 'c', d.table, d.name);
+            txn.commit();
+        }});
+    }
+    throw_if(run_parallel(tasks, opts), "constraint validation");
+
+    // 3. Planner statistics for the reloaded tables
+    tasks.clear();
+    for (const auto& t : tables())
+        tasks.push_back({"statistics of " + t, [t](PostgresConnection& c) {
+            if (c.query_single("SELECT to_regclass($1) IS NOT NULL", {qualified(t)}).value_or("f") == "t")
+                c.execute("ANALYZE " + qualified(t));
+        }});
+    throw_if(run_parallel(tasks, opts), "analyze");
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,156 @@
+/**
+ * @file connection_pool.cpp
+ * @brief Bounded connection pool with per-thread affinity
+ */
+
+#include <database/connection_pool.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace Hartonomous {
+
+// Slot this thread last leased from each pool
+static thread_local std::unordered_map<const void*, const void*> t_affinity;
+
+ConnectionPool::Options ConnectionPool::Options::from_env() {
+    Options opts;
+    if (const char* s = std::getenv("HARTONOMOUS_POOL_SIZE")) {
+        opts.max_size = std::max<long>(1, std::strtol(s, nullptr, 10));
+    }
+    if (const char* t = std::getenv("HARTONOMOUS_POOL_TIMEOUT_MS")) {
+        opts.acquire_timeout = std::chrono::milliseconds(std::max<long>(1, std::strtol(t, nullptr, 10)));
+    }
+    return opts;
+}
+
+ConnectionPool::ConnectionPool(Options opts) : opts_(std::move(opts)) {
+    if (opts_.max_size == 0) {
+        opts_.max_size = std::max<size_t>(4, std::thread::hardware_concurrency());
+    }
+    // Open one connection up front so a bad conninfo fails here, not on first use
+    auto first = std::make_unique<Slot>();
+    first->conn = open();
+    first->last_used = std::chrono::steady_clock::now();
+    slots_.push_back(std::move(first));
+}
+
+ConnectionPool::ConnectionPool(const std::string& conninfo)
+    : ConnectionPool([&] {
+          Options o = Options::from_env();
+          o.conninfo = conninfo;
+          return o;
+      }()) {}
+
+std::unique_ptr<PostgresConnection> ConnectionPool::open() const {
+    return opts_.conninfo.empty() ? std::make_unique<PostgresConnection>()
+                                  : std::make_unique<PostgresConnection>(opts_.conninfo);
+}
+
+bool ConnectionPool::probe(PostgresConnection& conn) noexcept {
+    if (!conn.is_connected()) return false;
+    try {
+        conn.execute("SELECT 1");
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    auto deadline = std::chrono::steady_clock::now() + opts_.acquire_timeout;
+    Slot* slot = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            // 1. The slot this thread used last
+            if (auto it = t_affinity.find(this); it != t_affinity.end()) {
+                for (auto& s : slots_) {
+                    if (s.get() == it->second && !s->busy) { slot = s.get(); break; }
+                }
+            }
+            // 2. Any idle slot, most recently used first (its caches are warmest)
+            if (!slot) {
+                for (auto& s : slots_) {
+                    if (!s->busy && (!slot || s->last_used > slot->last_used)) slot = s.get();
+                }
+            }
+            // 3. Grow
+            if (!slot && slots_.size() < opts_.max_size) {
+                slots_.push_back(std::make_unique<Slot>());
+                slot = slots_.back().get();
+            }
+            if (slot) break;
+            if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                throw std::runtime_error("ConnectionPool: no connection available within timeout (" +
+                                         std::to_string(opts_.max_size) + " in use)");
+            }
+        }
+        slot->busy = true;
+        t_affinity[this] = slot;
+    }
+
+    // Connect or health-check outside the lock
+    try {
+        bool stale = std::chrono::steady_clock::now() - slot->last_used > opts_.health_check_after;
+        if (slot->conn && (!slot->conn->is_connected() || (stale && !probe(*slot->conn)))) {
+            slot->conn.reset();
+        }
+        if (!slot->conn) slot->conn = open();
+    } catch (...) {
+        give_back(slot);
+        throw;
+    }
+    return Lease(this, slot);
+}
+
+void ConnectionPool::give_back(Slot* slot) noexcept {
+    if (slot->conn) {
+        // Never hand the next user a connection with an open transaction
+        if (!slot->conn->is_connected()) {
+            slot->conn.reset();
+        } else if (slot->conn->in_transaction()) {
+            try {
+                slot->conn->rollback();
+            } catch (...) {
+                slot->conn.reset();
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot->busy = false;
+        slot->last_used = std::chrono::steady_clock::now();
+    }
+    cv_.notify_one();
+}
+
+void ConnectionPool::Lease::release() noexcept {
+    if (pool_ && slot_) pool_->give_back(slot_);
+    pool_ = nullptr;
+    slot_ = nullptr;
+}
+
+bool ConnectionPool::healthy() {
+    try {
+        Lease lease = acquire();
+        return probe(*lease);
+    } catch (...) {
+        return false;
+    }
+}
+
+size_t ConnectionPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.size();
+}
+
+size_t ConnectionPool::in_use() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(std::count_if(slots_.begin(), slots_.end(),
+                                             [](const auto& s) { return s->busy; }));
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,190 @@
+/**
+ * @file connection_router.cpp
+ * @brief Primary / replica routing with lag and read-your-writes checks
+ */
+
+#include <database/connection_router.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+// Replay position and lag in one round trip. A server out of recovery (a
+// promoted replica, or a primary listed by mistake) reports its own WAL end
+// and no lag; a standby that has replayed everything it received is not
+// behind however old its last replayed transaction is.
+static constexpr const char* PROBE_SQL =
+    "SELECT (COALESCE(CASE WHEN pg_is_in_recovery() THEN pg_last_wal_replay_lsn() "
+    "ELSE pg_current_wal_lsn() END, '0/0'::pg_lsn) - '0/0'::pg_lsn)::text, "
+    "(CASE WHEN NOT pg_is_in_recovery() OR pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 "
+    "ELSE COALESCE(EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000, 0) END)::text";
+
+static constexpr size_t MAX_REPLICAS = 64;   // Eligibility is tracked as a bitmask
+
+struct ConnectionRouter::Replica {
+    std::string conninfo;
+    std::unique_ptr<PostgresConnection> probe;        // Under probe_mutex_
+    std::unique_ptr<ConnectionPool> owned;            // Opened on the first good probe
+    std::atomic<ConnectionPool*> pool{nullptr};
+    std::atomic<bool> reachable{false};
+    std::atomic<uint64_t> replay_lsn{0};
+    std::atomic<double> lag_ms{0.0};
+};
+
+ConnectionRouter::Options ConnectionRouter::Options::from_env() {
+    Options opts;
+    if (const char* p = std::getenv("HARTONOMOUS_PRIMARY_DSN")) opts.primary = p;
+    if (const char* r = std::getenv("HARTONOMOUS_REPLICA_DSNS")) {
+        std::stringstream ss(r);
+        std::string dsn;
+        while (std::getline(ss, dsn, ';')) {
+            dsn.erase(0, dsn.find_first_not_of(" \t"));
+            dsn.erase(dsn.find_last_not_of(" \t") + 1);
+            if (!dsn.empty()) opts.replicas.push_back(dsn);
+        }
+    }
+    if (const char* l = std::getenv("HARTONOMOUS_REPLICA_MAX_LAG_MS")) {
+        opts.max_lag = std::chrono::milliseconds(std::max<long>(0, std::strtol(l, nullptr, 10)));
+    }
+    if (const char* i = std::getenv("HARTONOMOUS_REPLICA_PROBE_MS")) {
+        opts.probe_interval = std::chrono::milliseconds(std::max<long>(1, std::strtol(i, nullptr, 10)));
+    }
+    return opts;
+}
+
+ConnectionRouter::ConnectionRouter(Options opts)
+    : opts_(std::move(opts)), primary_(opts_.primary) {
+    if (opts_.replicas.size() > MAX_REPLICAS) {
+        throw std::runtime_error("ConnectionRouter: at most " + std::to_string(MAX_REPLICAS) + " replicas");
+    }
+    for (const auto& dsn : opts_.replicas) {
+        auto r = std::make_unique<Replica>();
+        r->conninfo = dsn;
+        replicas_.push_back(std::move(r));
+    }
+    // An unreachable replica is not an error: reads stay on the primary until it answers
+    if (!replicas_.empty()) epoch();
+}
+
+ConnectionRouter::ConnectionRouter(const std::string& primary)
+    : ConnectionRouter([&] {
+          Options o = Options::from_env();
+          if (o.primary.empty()) o.primary = primary;
+          return o;
+      }()) {}
+
+ConnectionRouter::~ConnectionRouter() = default;
+
+uint64_t ConnectionRouter::current_lsn(PostgresConnection& conn) {
+    auto lsn = conn.query_single("SELECT (pg_current_wal_lsn() - '0/0'::pg_lsn)::text");
+    return lsn ? std::strtoull(lsn->c_str(), nullptr, 10) : 0;
+}
+
+void ConnectionRouter::note_write(uint64_t lsn) noexcept {
+    uint64_t seen = written_lsn_.load(std::memory_order_relaxed);
+    while (lsn > seen && !written_lsn_.compare_exchange_weak(seen, lsn, std::memory_order_release)) {}
+}
+
+void ConnectionRouter::note_primary_write() {
+    if (replicas_.empty()) return;
+    auto db = primary_.acquire();
+    note_write(current_lsn(*db));
+}
+
+bool ConnectionRouter::eligible(const Replica& r, uint64_t after) const noexcept {
+    const uint64_t need = std::max(after, written_lsn_.load(std::memory_order_acquire));
+    return r.pool.load(std::memory_order_acquire) && r.reachable.load(std::memory_order_relaxed) &&
+           r.lag_ms.load(std::memory_order_relaxed) <= static_cast<double>(opts_.max_lag.count()) &&
+           r.replay_lsn.load(std::memory_order_relaxed) >= need;
+}
+
+void ConnectionRouter::refresh_if_due() {
+    // Another thread probing means the figures are about to be fresh anyway
+    std::unique_lock<std::mutex> lock(probe_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= next_probe_) {
+        next_probe_ = now + opts_.probe_interval;
+        for (auto& r : replicas_) {
+            try {
+                if (!r->probe || !r->probe->is_connected()) r->probe = std::make_unique<PostgresConnection>(r->conninfo);
+                uint64_t lsn = 0;
+                double lag = 0.0;
+                r->probe->query(PROBE_SQL, [&](const std::vector<std::string>& row) {
+                    lsn = std::strtoull(row[0].c_str(), nullptr, 10);
+                    lag = std::strtod(row[1].c_str(), nullptr);
+                });
+                if (!r->owned) {
+                    auto pool_opts = ConnectionPool::Options::from_env();
+                    pool_opts.conninfo = r->conninfo;
+                    pool_opts.max_size = primary_.capacity();
+                    r->owned = std::make_unique<ConnectionPool>(pool_opts);
+                    r->pool.store(r->owned.get(), std::memory_order_release);
+                }
+                r->replay_lsn.store(lsn, std::memory_order_relaxed);
+                r->lag_ms.store(lag, std::memory_order_relaxed);
+                r->reachable.store(true, std::memory_order_relaxed);
+            } catch (const std::exception& e) {
+                if (r->reachable.exchange(false, std::memory_order_relaxed)) {
+                    std::cerr << "[ConnectionRouter] Replica unreachable, reading from the primary: " << e.what() << std::endl;
+                }
+                r->probe.reset();
+            }
+        }
+    }
+
+    // Recomputed on every call: a noted write can retire replicas between probes
+    uint64_t mask = 0;
+    for (size_t i = 0; i < replicas_.size(); ++i) {
+        if (eligible(*replicas_[i], 0)) mask |= uint64_t{1} << i;
+    }
+    if (mask != eligible_mask_) {
+        eligible_mask_ = mask;
+        epoch_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+ConnectionPool& ConnectionRouter::reader(uint64_t after) {
+    if (replicas_.empty()) return primary_;
+    refresh_if_due();
+
+    ConnectionPool* best = nullptr;
+    double best_load = 0.0;
+    for (const auto& r : replicas_) {
+        if (!eligible(*r, after)) continue;
+        ConnectionPool* pool = r->pool.load(std::memory_order_acquire);
+        const double load = static_cast<double>(pool->in_use()) / static_cast<double>(pool->capacity());
+        if (!best || load < best_load) {
+            best = pool;
+            best_load = load;
+        }
+    }
+    return best ? *best : primary_;
+}
+
+uint64_t ConnectionRouter::epoch() {
+    if (!replicas_.empty()) refresh_if_due();
+    return epoch_.load(std::memory_order_acquire);
+}
+
+std::vector<ConnectionRouter::ReplicaStatus> ConnectionRouter::status() {
+    if (!replicas_.empty()) refresh_if_due();
+    std::vector<ReplicaStatus> out;
+    out.reserve(replicas_.size());
+    for (const auto& r : replicas_) {
+        ReplicaStatus s;
+        s.conninfo = r->conninfo;
+        s.reachable = r->reachable.load(std::memory_order_relaxed);
+        s.replay_lsn = r->replay_lsn.load(std::memory_order_relaxed);
+        s.lag_ms = r->lag_ms.load(std::memory_order_relaxed);
+        s.eligible = eligible(*r, 0);
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+} // namespace Hartonomous
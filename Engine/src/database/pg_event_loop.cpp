@@ -0,0 +1,161 @@
+/**
+ * @file pg_event_loop.cpp
+ * @brief epoll workers that resume coroutines waiting on libpq sockets
+ */
+
+#include <database/pg_event_loop.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace Hartonomous {
+
+struct PgEventLoop::Worker {
+    explicit Worker(std::atomic<size_t>& waiting) : waiting(waiting) {}
+
+    int epoll_fd = -1;
+    int wake_fd = -1;                               // Registered with a null data.ptr
+    std::thread thread;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t>& waiting;
+
+    std::mutex mutex;
+    std::vector<std::coroutine_handle<>> posted;
+
+    void wake() noexcept {
+#if defined(__linux__)
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = ::write(wake_fd, &one, sizeof(one));
+#endif
+    }
+
+    void run();
+};
+
+#if defined(__linux__)
+
+void PgEventLoop::Worker::run() {
+    epoll_event events[64];
+    std::vector<std::coroutine_handle<>> batch;
+    while (!stop.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(epoll_fd, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                uint64_t count;
+                [[maybe_unused]] ssize_t r = ::read(wake_fd, &count, sizeof(count));
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    batch.swap(posted);
+                }
+                for (auto h : batch) h.resume();
+                batch.clear();
+                continue;
+            }
+            // Oneshot registration: drop it so the next wait on this fd can add it again
+            auto* waiter = static_cast<FdAwaiter*>(events[i].data.ptr);
+            std::coroutine_handle<> h = waiter->handle_;
+            ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, waiter->fd_, nullptr);
+            waiting.fetch_sub(1, std::memory_order_relaxed);
+            h.resume();  // May destroy *waiter
+        }
+    }
+}
+
+PgEventLoop::PgEventLoop(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    workers_.reserve(threads);
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            auto w = std::make_unique<Worker>(waiting_);
+            w->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            w->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (w->epoll_fd < 0 || w->wake_fd < 0) {
+                if (w->epoll_fd >= 0) ::close(w->epoll_fd);
+                if (w->wake_fd >= 0) ::close(w->wake_fd);
+                throw std::runtime_error("PgEventLoop: " + std::string(std::strerror(errno)));
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.ptr = nullptr;
+            ::epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->wake_fd, &ev);
+            Worker* raw = w.get();
+            workers_.push_back(std::move(w));
+            raw->thread = std::thread([raw] { raw->run(); });
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+}
+
+PgEventLoop::~PgEventLoop() { shutdown(); }
+
+void PgEventLoop::shutdown() noexcept {
+    for (auto& w : workers_) {
+        w->stop.store(true, std::memory_order_release);
+        w->wake();
+    }
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+        ::close(w->wake_fd);
+        ::close(w->epoll_fd);
+    }
+    workers_.clear();
+}
+
+void PgEventLoop::FdAwaiter::await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    epoll_event ev{};
+    ev.events = EPOLLONESHOT | EPOLLERR | EPOLLHUP;
+    if (events_ & EV_IN) ev.events |= EPOLLIN | EPOLLRDHUP;
+    if (events_ & EV_OUT) ev.events |= EPOLLOUT;
+    ev.data.ptr = this;
+    worker_.waiting.fetch_add(1, std::memory_order_relaxed);
+    // Once added, a loop thread may resume h before epoll_ctl even returns: touch nothing of *this
+    if (::epoll_ctl(worker_.epoll_fd, EPOLL_CTL_ADD, fd_, &ev) != 0) {
+        worker_.waiting.fetch_sub(1, std::memory_order_relaxed);
+        throw std::runtime_error("PgEventLoop: cannot watch fd " + std::to_string(fd_) + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+#else
+
+void PgEventLoop::Worker::run() {}
+
+PgEventLoop::PgEventLoop(size_t) {
+    throw std::runtime_error("PgEventLoop requires Linux (epoll)");
+}
+
+PgEventLoop::~PgEventLoop() = default;
+
+void PgEventLoop::shutdown() noexcept {}
+
+void PgEventLoop::FdAwaiter::await_suspend(std::coroutine_handle<>) {
+    throw std::runtime_error("PgEventLoop requires Linux (epoll)");
+}
+
+#endif
+
+void PgEventLoop::post(std::coroutine_handle<> h) {
+    Worker& w = *workers_[next_post_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.posted.push_back(h);
+    }
+    w.wake();
+}
+
+} // namespace Hartonomous
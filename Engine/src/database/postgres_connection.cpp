@@ -4,12 +4,31 @@
  */
 
 #include <database/postgres_connection.hpp>
+#include <database/query_trace.hpp>
+#include <utils/metrics.hpp>
+#include <poll.h>
+#include <atomic>
+#include <cerrno>
 #include <stdexcept>
 #include <cstdlib>
 #include <sstream>
 
 namespace Hartonomous {
 
+namespace {
+std::atomic<uint64_t> g_queries_sent{0};
+thread_local uint64_t t_queries_sent = 0;
+
+inline void count_query() noexcept {
+    g_queries_sent.fetch_add(1, std::memory_order_relaxed);
+    ++t_queries_sent;
+    HARTONOMOUS_COUNT("hartonomous_db_queries_total", 1);
+}
+} // namespace
+
+uint64_t PostgresConnection::queries_sent() noexcept { return g_queries_sent.load(std::memory_order_relaxed); }
+uint64_t PostgresConnection::thread_queries_sent() noexcept { return t_queries_sent; }
+
 PostgresConnection::PostgresConnection() {
     // Build connection string from environment
     std::ostringstream conninfo;
@@ -41,21 +60,29 @@ PostgresConnection::~PostgresConnection() {
 }
 
 PostgresConnection::PostgresConnection(PostgresConnection&& other) noexcept
-    : conn_(other.conn_), last_error_(std::move(other.last_error_)) {
+    : conn_(other.conn_), cancel_(other.cancel_), conninfo_(std::move(other.conninfo_)), last_error_(std::move(other.last_error_)),
+      staging_tables_(std::move(other.staging_tables_)), prepared_(std::move(other.prepared_)) {
     other.conn_ = nullptr;
+    other.cancel_ = nullptr;
 }
 
 PostgresConnection& PostgresConnection::operator=(PostgresConnection&& other) noexcept {
     if (this != &other) {
         disconnect();
         conn_ = other.conn_;
+        cancel_ = other.cancel_;
+        conninfo_ = std::move(other.conninfo_);
         last_error_ = std::move(other.last_error_);
+        staging_tables_ = std::move(other.staging_tables_);
+        prepared_ = std::move(other.prepared_);
         other.conn_ = nullptr;
+        other.cancel_ = nullptr;
     }
     return *this;
 }
 
 void PostgresConnection::connect(const std::string& conninfo) {
+    conninfo_ = conninfo;
     conn_ = PQconnectdb(conninfo.c_str());
 
     if (PQstatus(conn_) != CONNECTION_OK) {
@@ -67,13 +94,34 @@ void PostgresConnection::connect(const std::string& conninfo) {
 
     // Optimize for bulk loading - trade durability for speed
     PQexec(conn_, "SET synchronous_commit = off");
+
+    // Built once here so cancel() never touches conn_ from another thread
+    cancel_ = PQgetCancel(conn_);
 }
 
 void PostgresConnection::disconnect() {
+    if (cancel_) {
+        PQfreeCancel(cancel_);
+        cancel_ = nullptr;
+    }
     if (conn_) {
         PQfinish(conn_);
         conn_ = nullptr;
     }
+    staging_tables_.clear();
+    prepared_.clear();
+}
+
+bool PostgresConnection::in_transaction() const {
+    if (!conn_) return false;
+    PGTransactionStatusType s = PQtransactionStatus(conn_);
+    return s == PQTRANS_INTRANS || s == PQTRANS_INERROR || s == PQTRANS_ACTIVE;
+}
+
+bool PostgresConnection::cancel() {
+    if (!cancel_) return false;
+    char errbuf[256];
+    return PQcancel(cancel_, errbuf, sizeof(errbuf)) == 1;
 }
 
 bool PostgresConnection::is_connected() const {
@@ -96,7 +144,11 @@ void PostgresConnection::execute(const std::string& sql) {
         throw std::runtime_error("Not connected to database");
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexec(conn_, sql.c_str());
+    trace.done(result);
     check_result(result);
     PQclear(result);
 }
@@ -111,6 +163,9 @@ void PostgresConnection::execute(const std::string& sql, const std::vector<std::
         param_values.push_back(p.c_str());
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexecParams(
         conn_,
         sql.c_str(),
@@ -121,6 +176,7 @@ void PostgresConnection::execute(const std::string& sql, const std::vector<std::
         nullptr,
         0  // Text format
     );
+    trace.done(result);
 
     check_result(result);
     PQclear(result);
@@ -131,7 +187,11 @@ std::optional<std::string> PostgresConnection::query_single(const std::string& s
         throw std::runtime_error("Not connected to database");
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexec(conn_, sql.c_str());
+    trace.done(result);
     check_result(result);
 
     std::optional<std::string> value;
@@ -154,6 +214,9 @@ std::optional<std::string> PostgresConnection::query_single(const std::string& s
         param_values.push_back(p.c_str());
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexecParams(
         conn_,
         sql.c_str(),
@@ -164,6 +227,7 @@ std::optional<std::string> PostgresConnection::query_single(const std::string& s
         nullptr,
         0
     );
+    trace.done(result);
 
     check_result(result);
 
@@ -182,7 +246,11 @@ void PostgresConnection::query(const std::string& sql, std::function<void(const
         throw std::runtime_error("Not connected to database");
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexec(conn_, sql.c_str());
+    trace.done(result);
     check_result(result);
 
     int nrows = PQntuples(result);
@@ -213,6 +281,9 @@ void PostgresConnection::query(const std::string& sql, const std::vector<std::st
         param_values.push_back(p.c_str());
     }
 
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(sql);
     PGresult* result = PQexecParams(
         conn_,
         sql.c_str(),
@@ -223,6 +294,7 @@ void PostgresConnection::query(const std::string& sql, const std::vector<std::st
         nullptr,
         0
     );
+    trace.done(result);
 
     check_result(result);
 
@@ -243,9 +315,247 @@ void PostgresConnection::query(const std::string& sql, const std::vector<std::st
     PQclear(result);
 }
 
+const PostgresConnection::PreparedStatement& PostgresConnection::prepare(
+    const std::string& name, const std::string& sql, std::initializer_list<Oid> param_types) {
+    if (auto it = prepared_.find(name); it != prepared_.end()) return it->second;
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+
+    std::vector<Oid> types(param_types);
+    PGresult* result = PQprepare(conn_, name.c_str(), sql.c_str(), static_cast<int>(types.size()),
+                                 types.empty() ? nullptr : types.data());
+    check_result(result);
+    PQclear(result);
+
+    return prepared_.emplace(name, PreparedStatement{name, static_cast<int>(types.size()), sql}).first->second;
+}
+
+PgResult PostgresConnection::execute_prepared(const PreparedStatement& stmt, std::span<const PgParam> params) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+    if (static_cast<int>(params.size()) != stmt.param_count) {
+        throw std::invalid_argument("Prepared statement " + stmt.name + " expects " +
+                                    std::to_string(stmt.param_count) + " parameters");
+    }
+
+    constexpr size_t MAX_INLINE = 16;
+    const char* values_buf[MAX_INLINE];
+    int lengths_buf[MAX_INLINE];
+    int formats_buf[MAX_INLINE];
+    std::vector<const char*> values_vec;
+    std::vector<int> lengths_vec, formats_vec;
+    const char** values = values_buf;
+    int* lengths = lengths_buf;
+    int* formats = formats_buf;
+    if (params.size() > MAX_INLINE) {
+        values_vec.resize(params.size());
+        lengths_vec.resize(params.size());
+        formats_vec.resize(params.size());
+        values = values_vec.data();
+        lengths = lengths_vec.data();
+        formats = formats_vec.data();
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        values[i] = params[i].data();
+        lengths[i] = params[i].length();
+        formats[i] = 1;
+    }
+
+    HARTONOMOUS_SPAN("db_query");
+    count_query();
+    QueryTrace::Scope trace(stmt.sql);
+    PGresult* result = PQexecPrepared(conn_, stmt.name.c_str(), static_cast<int>(params.size()),
+                                      values, lengths, formats, 1 /* binary results */);
+    trace.done(result);
+    check_result(result);
+    return PgResult(result);
+}
+
+PgTask<PgResult> PostgresConnection::query_async(PgEventLoop& loop, std::string sql,
+                                                 std::vector<std::string> params) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& p : params) values.push_back(p.c_str());
+
+    set_nonblocking(true);
+    count_query();
+    int ok = PQsendQueryParams(conn_, sql.c_str(), static_cast<int>(params.size()), nullptr,
+                               values.data(), nullptr, nullptr, 0);
+    co_return co_await finish_async(loop, sql, ok == 1);
+}
+
+PgTask<PgResult> PostgresConnection::execute_prepared_async(PgEventLoop& loop, const PreparedStatement& stmt,
+                                                            std::vector<PgParam> params) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+    if (static_cast<int>(params.size()) != stmt.param_count) {
+        throw std::invalid_argument("Prepared statement " + stmt.name + " expects " +
+                                    std::to_string(stmt.param_count) + " parameters");
+    }
+
+    std::vector<const char*> values(params.size());
+    std::vector<int> lengths(params.size()), formats(params.size(), 1);
+    for (size_t i = 0; i < params.size(); ++i) {
+        values[i] = params[i].data();
+        lengths[i] = params[i].length();
+    }
+
+    set_nonblocking(true);
+    count_query();
+    int ok = PQsendQueryPrepared(conn_, stmt.name.c_str(), static_cast<int>(params.size()),
+                                 values.data(), lengths.data(), formats.data(), 1 /* binary results */);
+    co_return co_await finish_async(loop, stmt.sql, ok == 1);
+}
+
+// Flush the sent statement, then read until libpq reports the end of its results,
+// suspending on the loop wherever the blocking calls would wait on the socket
+PgTask<PgResult> PostgresConnection::finish_async(PgEventLoop& loop, std::string_view sql, bool sent) {
+    HARTONOMOUS_SPAN("db_query_async");
+    QueryTrace::Scope trace(sql);
+    struct RestoreBlocking {
+        PostgresConnection& conn;
+        ~RestoreBlocking() {
+            try { conn.set_nonblocking(false); } catch (...) {}
+        }
+    } restore{*this};
+
+    if (!sent) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("PostgreSQL async send failed: " + last_error_);
+    }
+
+    const int fd = PQsocket(conn_);
+    int pending;
+    while ((pending = PQflush(conn_)) == 1) {
+        // Read while waiting to write: the server may answer (or fail) before taking all the input
+        co_await loop.readable_or_writable(fd);
+        if (!PQconsumeInput(conn_)) { pending = -1; break; }
+    }
+    if (pending == -1) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("PostgreSQL async send failed: " + last_error_);
+    }
+
+    PGresult* first = nullptr;
+    try {
+        for (;;) {
+            while (PQisBusy(conn_)) {
+                co_await loop.readable(fd);
+                if (!PQconsumeInput(conn_)) {
+                    last_error_ = PQerrorMessage(conn_);
+                    throw std::runtime_error("PostgreSQL async read failed: " + last_error_);
+                }
+            }
+            PGresult* res = PQgetResult(conn_);
+            if (!res) break;
+            if (first) PQclear(res);  // One statement: anything after the first result is status only
+            else first = res;
+        }
+    } catch (...) {
+        if (first) PQclear(first);
+        throw;
+    }
+
+    trace.done(first);
+    if (!first) throw std::runtime_error("PostgreSQL async query returned no result");
+    check_result(first);
+    co_return PgResult(first);
+}
+
+PostgresConnection::Pipeline::Pipeline(PostgresConnection& conn) : conn_(conn) {
+    if (!conn_.is_connected()) throw std::runtime_error("Not connected to database");
+    if (PQenterPipelineMode(conn_.conn_) != 1) {
+        throw std::runtime_error("Failed to enter pipeline mode: " + std::string(PQerrorMessage(conn_.conn_)));
+    }
+}
+
+PostgresConnection::Pipeline::~Pipeline() {
+    try {
+        if (in_flight_ > 0) collect();
+    } catch (...) {}
+    PQexitPipelineMode(conn_.conn_);
+}
+
+void PostgresConnection::Pipeline::after_send(int ok) {
+    count_query();
+    if (ok != 1) {
+        conn_.last_error_ = PQerrorMessage(conn_.conn_);
+        throw std::runtime_error("Pipeline send failed: " + conn_.last_error_);
+    }
+    if (++in_flight_ >= MAX_IN_FLIGHT) collect();
+}
+
+size_t PostgresConnection::Pipeline::send(const std::string& sql, const std::vector<std::string>& params) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& p : params) values.push_back(p.c_str());
+    size_t index = results_.size() + in_flight_;
+    QueryTrace::global().record(sql, 0, 0, 0);  // Calls only: the wait is shared by the whole batch
+    after_send(PQsendQueryParams(conn_.conn_, sql.c_str(), static_cast<int>(params.size()), nullptr,
+                                 values.data(), nullptr, nullptr, 0));
+    return index;
+}
+
+size_t PostgresConnection::Pipeline::send(const PreparedStatement& stmt, std::span<const PgParam> params) {
+    if (static_cast<int>(params.size()) != stmt.param_count) {
+        throw std::invalid_argument("Prepared statement " + stmt.name + " expects " +
+                                    std::to_string(stmt.param_count) + " parameters");
+    }
+    std::vector<const char*> values(params.size());
+    std::vector<int> lengths(params.size()), formats(params.size(), 1);
+    for (size_t i = 0; i < params.size(); ++i) {
+        values[i] = params[i].data();
+        lengths[i] = params[i].length();
+    }
+    size_t index = results_.size() + in_flight_;
+    QueryTrace::global().record(stmt.sql, 0, 0, 0);
+    after_send(PQsendQueryPrepared(conn_.conn_, stmt.name.c_str(), static_cast<int>(params.size()),
+                                   values.data(), lengths.data(), formats.data(), 1));
+    return index;
+}
+
+// Sync point: one PGresult (then NULL) per queued query, then PIPELINE_SYNC
+void PostgresConnection::Pipeline::collect() {
+    PGconn* c = conn_.conn_;
+    if (PQpipelineSync(c) != 1) {
+        conn_.last_error_ = PQerrorMessage(c);
+        throw std::runtime_error("Pipeline sync failed: " + conn_.last_error_);
+    }
+    for (; in_flight_ > 0; --in_flight_) {
+        PGresult* res = PQgetResult(c);
+        if (!res) throw std::runtime_error("Pipeline ended early: " + std::string(PQerrorMessage(c)));
+        ExecStatusType st = PQresultStatus(res);
+        if (st != PGRES_TUPLES_OK && st != PGRES_COMMAND_OK && error_.empty()) {
+            error_ = st == PGRES_PIPELINE_ABORTED ? "pipeline aborted" : PQresultErrorMessage(res);
+        }
+        results_.emplace_back(res);
+        while ((res = PQgetResult(c)) != nullptr) PQclear(res);  // NULL terminates each query
+    }
+    PGresult* res = PQgetResult(c);
+    bool synced = res && PQresultStatus(res) == PGRES_PIPELINE_SYNC;
+    if (res) PQclear(res);
+    if (!synced) throw std::runtime_error("Pipeline lost sync: " + std::string(PQerrorMessage(c)));
+}
+
+std::vector<PgResult> PostgresConnection::Pipeline::sync() {
+    if (in_flight_ > 0) collect();
+    if (!error_.empty()) {
+        std::string err = std::move(error_);
+        error_.clear();
+        results_.clear();
+        conn_.last_error_ = err;
+        throw std::runtime_error("PostgreSQL pipeline query failed: " + err);
+    }
+    std::vector<PgResult> out = std::move(results_);
+    results_.clear();
+    return out;
+}
+
 void PostgresConnection::stream_query(const std::string& sql, std::function<void(const std::vector<std::string>&)> callback) {
     if (!is_connected()) throw std::runtime_error("Not connected to database");
 
+    HARTONOMOUS_SPAN("db_stream");
+    count_query();
+    QueryTrace::Scope trace(sql);
     if (PQsendQuery(conn_, sql.c_str()) == 0) {
         throw std::runtime_error("PQsendQuery failed: " + std::string(PQerrorMessage(conn_)));
     }
@@ -262,9 +572,12 @@ void PostgresConnection::stream_query(const std::string& sql, std::function<void
             int nfields = PQnfields(res);
             std::vector<std::string> row;
             row.reserve(nfields);
+            uint64_t bytes = 0;
             for (int i = 0; i < nfields; ++i) {
                 row.push_back(PQgetvalue(res, 0, i));
+                bytes += static_cast<uint64_t>(PQgetlength(res, 0, i));
             }
+            trace.add_row(bytes);
             callback(row);
         } else if (status != PGRES_TUPLES_OK) {
             // PGRES_TUPLES_OK marks the end of the result set
@@ -279,11 +592,50 @@ void PostgresConnection::stream_query(const std::string& sql, std::function<void
     }
 }
 
+void PostgresConnection::copy_out(const std::string& sql, std::function<void(const char*, int)> callback) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+
+    HARTONOMOUS_SPAN("db_stream");
+    count_query();
+    QueryTrace::Scope trace(sql);
+    PGresult* res = PQexec(conn_, sql.c_str());
+    check_result(res);
+    if (PQresultStatus(res) != PGRES_COPY_OUT) {
+        PQclear(res);
+        throw std::runtime_error("copy_out expects a COPY ... TO STDOUT statement");
+    }
+    PQclear(res);
+
+    char* buffer = nullptr;
+    int nbytes;
+    while ((nbytes = PQgetCopyData(conn_, &buffer, 0)) > 0) {
+        trace.add_row(static_cast<uint64_t>(nbytes));
+        try {
+            callback(buffer, nbytes);
+        } catch (...) {
+            PQfreemem(buffer);
+            throw;
+        }
+        PQfreemem(buffer);
+    }
+    if (nbytes == -2) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("COPY out failed: " + last_error_);
+    }
+
+    // Drain the final command status
+    while ((res = PQgetResult(conn_)) != nullptr) {
+        check_result(res);
+        PQclear(res);
+    }
+}
+
 void PostgresConnection::copy_data(const char* buffer, int nbytes) {
     if (!is_connected()) {
         throw std::runtime_error("Not connected to database");
     }
 
+    HARTONOMOUS_COUNT("hartonomous_db_copy_in_bytes_total", static_cast<uint64_t>(nbytes));
     int result = PQputCopyData(conn_, buffer, nbytes);
     if (result == -1) {
         last_error_ = PQerrorMessage(conn_);
@@ -296,11 +648,13 @@ void PostgresConnection::copy_end(const char* error_msg) {
         throw std::runtime_error("Not connected to database");
     }
 
-    int result = PQputCopyEnd(conn_, error_msg);
+    int result;
+    while ((result = PQputCopyEnd(conn_, error_msg)) == 0) drain_output();
     if (result == -1) {
         last_error_ = PQerrorMessage(conn_);
         throw std::runtime_error("COPY end failed: " + last_error_);
     }
+    if (PQisnonblocking(conn_)) drain_output();
 
     // After sending end, we must get the final result
     PGresult* res = PQgetResult(conn_);
@@ -308,6 +662,64 @@ void PostgresConnection::copy_end(const char* error_msg) {
     PQclear(res);
 }
 
+void PostgresConnection::set_nonblocking(bool on) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+    if (on == is_nonblocking()) return;
+    if (!on) drain_output();
+    if (PQsetnonblocking(conn_, on ? 1 : 0) != 0) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("Failed to change socket blocking mode: " + last_error_);
+    }
+}
+
+bool PostgresConnection::is_nonblocking() const {
+    return conn_ && PQisnonblocking(conn_);
+}
+
+void PostgresConnection::drain_output() {
+    int pending;
+    while ((pending = PQflush(conn_)) == 1) {
+        // Also watch for input: the server may report an error mid-COPY,
+        // and consuming it keeps its send side from stalling ours.
+        pollfd pfd{PQsocket(conn_), POLLOUT | POLLIN, 0};
+        if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            throw std::runtime_error("poll() failed while sending COPY data");
+        }
+        if ((pfd.revents & POLLIN) && !PQconsumeInput(conn_)) {
+            pending = -1;
+            break;
+        }
+    }
+    if (pending == -1) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("COPY send failed: " + last_error_);
+    }
+}
+
+bool PostgresConnection::copy_data_async(const char* buffer, int nbytes) {
+    if (!is_connected()) throw std::runtime_error("Not connected to database");
+    if (!PQisnonblocking(conn_)) throw std::runtime_error("copy_data_async requires non-blocking mode");
+
+    // Let the previous buffer finish before queueing this one
+    drain_output();
+    HARTONOMOUS_COUNT("hartonomous_db_copy_in_bytes_total", static_cast<uint64_t>(nbytes));
+
+    int result;
+    while ((result = PQputCopyData(conn_, buffer, nbytes)) == 0) drain_output();
+    if (result == -1) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("COPY data failed: " + last_error_);
+    }
+
+    // Hand the kernel whatever it takes now; the rest goes out while the caller encodes
+    int pending = PQflush(conn_);
+    if (pending == -1) {
+        last_error_ = PQerrorMessage(conn_);
+        throw std::runtime_error("COPY send failed: " + last_error_);
+    }
+    return pending == 1;
+}
+
 void PostgresConnection::begin() {
     execute("BEGIN");
 }
@@ -317,6 +729,7 @@ void PostgresConnection::commit() {
 }
 
 void PostgresConnection::rollback() {
+    staging_tables_.clear();
     execute("ROLLBACK");
 }
 
@@ -0,0 +1,206 @@
+/**
+ * @file query_trace.cpp
+ * @brief Statement fingerprinting and per-fingerprint round-trip aggregates
+ */
+
+#include <database/query_trace.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace Hartonomous {
+
+namespace {
+
+constexpr size_t STATEMENT_LABEL_MAX = 160;  // Enough to recognize the statement, short enough for a label
+constexpr size_t SLOW_LOG_SQL_MAX = 1000;
+
+inline bool ident_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+}
+
+// FNV-1a: stable across processes, so fingerprints can be compared between runs
+uint64_t fnv1a(std::string_view s) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+} // namespace
+
+QueryTrace& QueryTrace::global() {
+    static QueryTrace trace;
+    return trace;
+}
+
+std::string QueryTrace::fingerprint_hex(uint64_t fingerprint) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(fingerprint));
+    return buf;
+}
+
+QueryTrace::QueryTrace() {
+    if (const char* env = std::getenv("HARTONOMOUS_SLOW_QUERY_MS")) slow_ms_ = std::atof(env);
+}
+
+std::string QueryTrace::normalize(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool space = false;
+    auto emit = [&](std::string_view s) {
+        if (space && !out.empty()) out += ' ';
+        space = false;
+        out += s;
+    };
+
+    size_t i = 0;
+    const size_t n = sql.size();
+    while (i < n) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            ++i;
+        } else if (c == '-' && i + 1 < n && sql[i + 1] == '-') {
+            while (i < n && sql[i] != '\n') ++i;
+            space = true;
+        } else if (c == '\'') {
+            // '' inside a literal is an escaped quote, not the end
+            for (++i; i < n; ++i) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < n && sql[i + 1] == '\'') { ++i; continue; }
+                    ++i;
+                    break;
+                }
+            }
+            emit("?");
+        } else if (c == '"') {
+            size_t end = sql.find('"', i + 1);
+            end = end == std::string_view::npos ? n : end + 1;
+            emit(sql.substr(i, end - i));
+            i = end;
+        } else if (c == '$' && i + 1 < n && std::isdigit(static_cast<unsigned char>(sql[i + 1]))) {
+            size_t end = i + 1;
+            while (end < n && std::isdigit(static_cast<unsigned char>(sql[end]))) ++end;
+            emit(sql.substr(i, end - i));
+            i = end;
+        } else if (c == '$') {
+            // Dollar-quoted literal: $tag$ ... $tag$
+            size_t tag_end = i + 1;
+            while (tag_end < n && ident_char(sql[tag_end])) ++tag_end;
+            if (tag_end < n && sql[tag_end] == '$') {
+                std::string_view tag = sql.substr(i, tag_end - i + 1);
+                size_t close = sql.find(tag, tag_end + 1);
+                i = close == std::string_view::npos ? n : close + tag.size();
+                emit("?");
+            } else {
+                emit("$");
+                ++i;
+            }
+        } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                   (c == '.' && i + 1 < n && std::isdigit(static_cast<unsigned char>(sql[i + 1])))) {
+            // Digits and exponents; an identifier's trailing digits are consumed with it below
+            while (i < n && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '.' ||
+                             ((sql[i] == '+' || sql[i] == '-') && (sql[i - 1] == 'e' || sql[i - 1] == 'E')))) ++i;
+            emit("?");
+        } else if (ident_char(c)) {
+            size_t end = i;
+            while (end < n && (ident_char(sql[end]) || sql[end] == '$')) ++end;
+            emit(sql.substr(i, end - i));
+            i = end;
+        } else {
+            emit(sql.substr(i, 1));
+            ++i;
+        }
+    }
+    return out;
+}
+
+void QueryTrace::record(std::string_view sql, uint64_t ns, uint64_t rows, uint64_t bytes) {
+    std::string normalized = normalize(sql);
+    const uint64_t fp = fnv1a(normalized);
+
+    auto& shard = shards_[fp % SHARDS];
+    {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.entries.find(fp);
+        if (it == shard.entries.end()) {
+            std::string short_sql = normalized.size() > STATEMENT_LABEL_MAX
+                ? normalized.substr(0, STATEMENT_LABEL_MAX) + "..." : normalized;
+            std::string labels = Metrics::label("fingerprint", fingerprint_hex(fp)) + "," + Metrics::label("statement", short_sql);
+            auto& m = Metrics::global();
+            Entry e{Statement{fp, std::move(normalized)},
+                    &m.counter("hartonomous_db_statement_calls_total", labels, "Round trips per statement fingerprint"),
+                    &m.counter("hartonomous_db_statement_microseconds_total", labels, "Server time per statement fingerprint"),
+                    &m.counter("hartonomous_db_statement_rows_total", labels, "Rows returned per statement fingerprint"),
+                    &m.counter("hartonomous_db_statement_bytes_total", labels, "Result bytes per statement fingerprint")};
+            it = shard.entries.emplace(fp, std::move(e)).first;
+        }
+        auto& s = it->second.stats;
+        ++s.calls;
+        s.total_ns += ns;
+        s.max_ns = std::max(s.max_ns, ns);
+        s.rows += rows;
+        s.bytes += bytes;
+        it->second.calls->add();
+        it->second.micros->add(ns / 1000);
+        it->second.rows->add(rows);
+        it->second.bytes->add(bytes);
+    }
+
+    if (slow_ms_ > 0 && static_cast<double>(ns) >= slow_ms_ * 1e6) {
+        std::cerr << "[PostgresConnection] slow query " << fingerprint_hex(fp) << ": " << static_cast<double>(ns) / 1e6
+                  << " ms, " << rows << " rows, " << bytes << " bytes: " << sql.substr(0, SLOW_LOG_SQL_MAX)
+                  << (sql.size() > SLOW_LOG_SQL_MAX ? "..." : "") << "\n";
+    }
+}
+
+std::vector<QueryTrace::Statement> QueryTrace::top(size_t limit) const {
+    std::vector<Statement> all;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        for (const auto& [fp, e] : shard.entries) {
+            if (e.stats.calls > 0) all.push_back(e.stats);
+        }
+    }
+    const size_t k = std::min(limit, all.size());
+    std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(k), all.end(),
+                      [](const Statement& a, const Statement& b) { return a.total_ns > b.total_ns; });
+    all.resize(k);
+    return all;
+}
+
+// The Prometheus counters stay monotonic; only the top() aggregates restart
+void QueryTrace::reset() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        for (auto& [fp, e] : shard.entries) {
+            e.stats = Statement{fp, std::move(e.stats.sql)};
+        }
+    }
+}
+
+void QueryTrace::Scope::done(const PGresult* result) noexcept {
+    t1_ = std::chrono::steady_clock::now();
+    if (result) {
+        rows_ = static_cast<uint64_t>(std::max(PQntuples(result), 0));
+        bytes_ = PQresultMemorySize(result);
+    }
+}
+
+QueryTrace::Scope::~Scope() {
+#ifndef HARTONOMOUS_NO_METRICS
+    auto t1 = t1_ == std::chrono::steady_clock::time_point{} ? std::chrono::steady_clock::now() : t1_;
+    try {
+        QueryTrace::global().record(
+            sql_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0_).count()),
+            rows_, bytes_);
+    } catch (...) {}
+#endif
+}
+
+} // namespace Hartonomous
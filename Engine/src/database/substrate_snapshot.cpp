@@ -0,0 +1,623 @@
+#include <database/substrate_snapshot.hpp>
+#include <database/bulk_copy.hpp>
+#include <database/bulk_load_session.hpp>
+#include <database/copy_row.hpp>
+#include <hashing/blake3_pipeline.hpp>
+#include <utils/huge_pages.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Hartonomous {
+
+namespace {
+
+// Snapshot layout: fixed header, 64-byte-aligned blocks, then the directory.
+// Each block holds a header, one stream length per column and the streams;
+// a stream is a list of runs (varint count, varint length + 1 or 0 for NULL,
+// the value once). Integers in headers and directory are host-endian; field
+// values keep PostgreSQL's binary send format.
+constexpr char SNAPSHOT_MAGIC[8] = {'H', 'S', 'U', 'B', 'S', 'N', 'P', '1'};
+constexpr char BLOCK_MAGIC[4] = {'H', 'S', 'B', 'K'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_HEADER_BYTES = 64;
+constexpr size_t BLOCK_ALIGN = 64;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t table_count;
+    uint64_t directory_offset;
+    uint64_t directory_bytes;
+    uint8_t checksum[16];     // BLAKE3 of the directory
+};
+static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_HEADER_BYTES);
+
+struct BlockHeader {
+    char magic[4];
+    uint32_t table;
+    uint32_t rows;
+    uint32_t columns;
+    uint64_t body_bytes;      // Stream lengths and streams
+    uint8_t checksum[16];     // BLAKE3 of the body
+};
+
+constexpr const char COPY_SIGNATURE[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+
+size_t align_up(size_t n) { return (n + BLOCK_ALIGN - 1) / BLOCK_ALIGN * BLOCK_ALIGN; }
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& v) {
+    const auto* b = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+void put_string(std::vector<uint8_t>& out, const std::string& s) {
+    put(out, static_cast<uint32_t>(s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// Bounds-checked reads over the directory
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    template <typename T>
+    T get() {
+        if (static_cast<size_t>(end - p) < sizeof(T)) throw std::runtime_error("Truncated snapshot directory");
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    std::string get_string() {
+        const auto n = get<uint32_t>();
+        if (static_cast<size_t>(end - p) < n) throw std::runtime_error("Truncated snapshot directory");
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+void pwrite_all(int fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        const ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (n <= 0) throw std::runtime_error(std::string("Snapshot write failed: ") + std::strerror(errno));
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+std::string quote_ident(const std::string& name) {
+    std::string out = "\"";
+    for (char c : name) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string column_list(const std::vector<SubstrateSnapshot::Column>& columns) {
+    std::string out;
+    for (const auto& c : columns) {
+        if (!out.empty()) out += ", ";
+        out += quote_ident(c.name);
+    }
+    return out;
+}
+
+size_t default_jobs(const SubstrateSnapshot::Options& opts, size_t tasks, const ConnectionPool& pool) {
+    const size_t jobs = opts.jobs ? opts.jobs : std::max(1u, std::thread::hardware_concurrency() / 2);
+    // One pooled connection stays with the coordinator
+    const size_t free = pool.capacity() > 1 ? pool.capacity() - 1 : 1;
+    return std::max<size_t>(1, std::min({jobs, tasks, free}));
+}
+
+// Run fn(i) for i in [0, count) on `jobs` threads; the first exception stops the rest and is rethrown
+template <typename Fn>
+void run_workers(size_t jobs, size_t count, Fn fn) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mu;
+    std::vector<std::thread> threads;
+    for (size_t j = 0; j < jobs; ++j) {
+        threads.emplace_back([&] {
+            try {
+                fn([&](size_t& i) {
+                    if (failed.load(std::memory_order_relaxed)) return false;
+                    i = next.fetch_add(1);
+                    return i < count;
+                });
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mu);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace
+
+SubstrateSnapshot::Options SubstrateSnapshot::Options::from_env() {
+    Options o;
+    if (const char* v = std::getenv("HARTONOMOUS_SNAPSHOT_JOBS")) o.jobs = std::strtoull(v, nullptr, 10);
+    if (const char* v = std::getenv("HARTONOMOUS_SNAPSHOT_BLOCK_ROWS"))
+        o.block_rows = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+    return o;
+}
+
+const std::vector<std::string>& SubstrateSnapshot::default_tables() {
+    static const std::vector<std::string> t = {
+        "physicality", "atom", "composition", "compositionsequence",
+        "relation", "relationsequence", "relationrating",
+    };
+    return t;
+}
+
+int SubstrateSnapshot::Table::column_index(const std::string& column) const {
+    for (size_t i = 0; i < columns.size(); ++i)
+        if (columns[i].name == column) return static_cast<int>(i);
+    return -1;
+}
+
+// ----------------------------------------------------------------------------
+// Writer
+// ----------------------------------------------------------------------------
+
+void SubstrateSnapshot::Writer::Stream::ColumnEncoder::end_run() {
+    if (run == 0) return;
+    put_varint(out, run);
+    put_varint(out, last_null ? 0 : last.size() + 1);
+    out.insert(out.end(), last.begin(), last.end());
+    run = 0;
+}
+
+void SubstrateSnapshot::Writer::Stream::ColumnEncoder::add(const uint8_t* data, int32_t len) {
+    const bool null = len < 0;
+    if (run > 0 && null == last_null &&
+        (null || (last.size() == static_cast<size_t>(len) && std::memcmp(last.data(), data, last.size()) == 0))) {
+        ++run;
+        return;
+    }
+    end_run();
+    last_null = null;
+    if (null) last.clear();
+    else last.assign(data, data + len);
+    run = 1;
+}
+
+SubstrateSnapshot::Writer::Stream::Stream(Writer& writer, size_t table, size_t block_rows)
+    : writer_(writer), table_(table), block_rows_(std::max<size_t>(1, block_rows)) {
+    std::lock_guard<std::mutex> lock(writer_.mu_);
+    columns_.resize(writer_.tables_.at(table).columns.size());
+}
+
+void SubstrateSnapshot::Writer::Stream::add_message(const char* buf, size_t len) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(buf);
+    const uint8_t* end = p + len;
+    if (len >= 19 && std::memcmp(p, COPY_SIGNATURE, 11) == 0) {
+        uint32_t ext;
+        std::memcpy(&ext, p + 15, 4);
+        p += 19 + __builtin_bswap32(ext);
+    }
+
+    while (p + 2 <= end) {
+        uint16_t nfields;
+        std::memcpy(&nfields, p, 2);
+        nfields = __builtin_bswap16(nfields);
+        p += 2;
+        if (nfields == 0xFFFF) return;  // Trailer
+        if (nfields != columns_.size()) throw std::runtime_error("Unexpected field count in snapshot COPY stream");
+        for (auto& col : columns_) {
+            if (end - p < 4) throw std::runtime_error("Truncated snapshot COPY stream");
+            uint32_t raw;
+            std::memcpy(&raw, p, 4);
+            const auto flen = static_cast<int32_t>(__builtin_bswap32(raw));
+            p += 4;
+            if (flen > end - p) throw std::runtime_error("Truncated snapshot COPY stream");
+            col.add(p, flen);
+            if (flen > 0) p += flen;
+        }
+        if (++rows_ == block_rows_) write_block();
+    }
+}
+
+void SubstrateSnapshot::Writer::Stream::write_block() {
+    for (auto& col : columns_) col.end_run();
+    writer_.append_block(table_, static_cast<uint32_t>(rows_), columns_);
+    for (auto& col : columns_) {
+        col.out.clear();
+        col.last.clear();
+    }
+    rows_ = 0;
+}
+
+void SubstrateSnapshot::Writer::Stream::finish() {
+    if (rows_ > 0) write_block();
+}
+
+SubstrateSnapshot::Writer::Writer(const std::string& path) : path_(path), end_(SNAPSHOT_HEADER_BYTES) {
+    const std::string tmp = path_ + ".tmp";
+    fd_ = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) throw std::runtime_error("Cannot create snapshot: " + tmp);
+}
+
+SubstrateSnapshot::Writer::~Writer() {
+    if (fd_ >= 0) ::close(fd_);
+    if (!committed_) ::unlink((path_ + ".tmp").c_str());
+}
+
+size_t SubstrateSnapshot::Writer::add_table(std::string name, std::vector<Column> columns) {
+    std::lock_guard<std::mutex> lock(mu_);
+    tables_.push_back({std::move(name), std::move(columns), 0, {}});
+    return tables_.size() - 1;
+}
+
+uint64_t SubstrateSnapshot::Writer::rows() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    uint64_t n = 0;
+    for (const auto& t : tables_) n += t.rows;
+    return n;
+}
+
+void SubstrateSnapshot::Writer::append_block(size_t table, uint32_t rows,
+                                             std::span<const Stream::ColumnEncoder> columns) {
+    std::vector<uint8_t> buf(sizeof(BlockHeader));
+    for (const auto& col : columns) put(buf, static_cast<uint64_t>(col.out.size()));
+    for (const auto& col : columns) buf.insert(buf.end(), col.out.begin(), col.out.end());
+
+    BlockHeader hdr{};
+    std::memcpy(hdr.magic, BLOCK_MAGIC, 4);
+    hdr.table = static_cast<uint32_t>(table);
+    hdr.rows = rows;
+    hdr.columns = static_cast<uint32_t>(columns.size());
+    hdr.body_bytes = buf.size() - sizeof(BlockHeader);
+    auto sum = BLAKE3Pipeline::hash(buf.data() + sizeof(BlockHeader), hdr.body_bytes);
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        offset = end_;
+        end_ = align_up(end_ + buf.size());
+        tables_[table].blocks.push_back(offset);
+        tables_[table].rows += rows;
+    }
+    pwrite_all(fd_, buf.data(), buf.size(), offset);
+}
+
+void SubstrateSnapshot::Writer::commit() {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<uint8_t> dir;
+    for (const auto& t : tables_) {
+        put_string(dir, t.name);
+        put(dir, static_cast<uint32_t>(t.columns.size()));
+        for (const auto& c : t.columns) {
+            put_string(dir, c.name);
+            put_string(dir, c.type);
+        }
+        put(dir, t.rows);
+        put(dir, static_cast<uint64_t>(t.blocks.size()));
+        for (uint64_t off : t.blocks) put(dir, off);
+    }
+    pwrite_all(fd_, dir.data(), dir.size(), end_);
+
+    SnapshotHeader hdr{};
+    std::memcpy(hdr.magic, SNAPSHOT_MAGIC, 8);
+    hdr.version = SNAPSHOT_VERSION;
+    hdr.table_count = static_cast<uint32_t>(tables_.size());
+    hdr.directory_offset = end_;
+    hdr.directory_bytes = dir.size();
+    auto sum = BLAKE3Pipeline::hash(dir.data(), dir.size());
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::vector<uint8_t> head(SNAPSHOT_HEADER_BYTES, 0);
+    std::memcpy(head.data(), &hdr, sizeof(hdr));
+    pwrite_all(fd_, head.data(), head.size(), 0);
+
+    if (::fsync(fd_) != 0 || ::close(fd_) != 0) {
+        fd_ = -1;
+        throw std::runtime_error("Snapshot write failed: " + path_);
+    }
+    fd_ = -1;
+    if (std::rename((path_ + ".tmp").c_str(), path_.c_str()) != 0)
+        throw std::runtime_error("Cannot move snapshot into place: " + path_);
+    committed_ = true;
+}
+
+// ----------------------------------------------------------------------------
+// Reader
+// ----------------------------------------------------------------------------
+
+SubstrateSnapshot::~SubstrateSnapshot() {
+    if (map_addr_) ::munmap(map_addr_, map_size_);
+}
+
+std::unique_ptr<const SubstrateSnapshot> SubstrateSnapshot::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open snapshot: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < SNAPSHOT_HEADER_BYTES) {
+        ::close(fd);
+        throw std::runtime_error("Not a substrate snapshot: " + path);
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    size_t mapped = 0;
+    void* addr = map_file_readonly(fd, size, mapped);
+    ::close(fd);
+    if (addr == MAP_FAILED) throw std::runtime_error("Cannot map snapshot: " + path);
+
+    std::unique_ptr<SubstrateSnapshot> s(new SubstrateSnapshot());
+    s->map_addr_ = addr;
+    s->map_size_ = mapped;
+    s->base_ = static_cast<const uint8_t*>(addr);
+    s->size_ = size;
+
+    SnapshotHeader hdr;
+    std::memcpy(&hdr, s->base_, sizeof(hdr));
+    if (std::memcmp(hdr.magic, SNAPSHOT_MAGIC, 8) != 0 || hdr.version != SNAPSHOT_VERSION ||
+        hdr.directory_offset < SNAPSHOT_HEADER_BYTES || hdr.directory_offset > size ||
+        hdr.directory_bytes > size - hdr.directory_offset)
+        throw std::runtime_error("Not a substrate snapshot, or of another version: " + path);
+
+    const uint8_t* dir = s->base_ + hdr.directory_offset;
+    auto sum = BLAKE3Pipeline::hash(dir, hdr.directory_bytes);
+    if (std::memcmp(sum.data(), hdr.checksum, 16) != 0)
+        throw std::runtime_error("Snapshot directory checksum mismatch: " + path);
+    s->id_ = BLAKE3Pipeline::to_hex(sum);
+
+    Reader in{dir, dir + hdr.directory_bytes};
+    s->tables_.resize(hdr.table_count);
+    for (auto& t : s->tables_) {
+        t.name = in.get_string();
+        t.columns.resize(in.get<uint32_t>());
+        for (auto& c : t.columns) {
+            c.name = in.get_string();
+            c.type = in.get_string();
+        }
+        t.rows = in.get<uint64_t>();
+        t.blocks.resize(in.get<uint64_t>());
+        for (auto& off : t.blocks) off = in.get<uint64_t>();
+    }
+    return s;
+}
+
+const SubstrateSnapshot::Table* SubstrateSnapshot::table(const std::string& name) const {
+    for (const auto& t : tables_)
+        if (t.name == name) return &t;
+    return nullptr;
+}
+
+size_t SubstrateSnapshot::decode_block(const Table& table, size_t block,
+                                       std::vector<std::vector<Field>>& columns) const {
+    const uint64_t offset = table.blocks.at(block);
+    const auto fail = [&](const char* what) {
+        return std::runtime_error(std::string("Snapshot block ") + std::to_string(block) + " of " + table.name + ": " + what);
+    };
+    if (offset > size_ || size_ - offset < sizeof(BlockHeader)) throw fail("out of bounds");
+    BlockHeader hdr;
+    std::memcpy(&hdr, base_ + offset, sizeof(hdr));
+    const auto table_index = static_cast<uint32_t>(&table - tables_.data());
+    if (std::memcmp(hdr.magic, BLOCK_MAGIC, 4) != 0 || hdr.table != table_index ||
+        hdr.columns != table.columns.size() || hdr.body_bytes > size_ - offset - sizeof(BlockHeader) ||
+        hdr.body_bytes < 8 * uint64_t(hdr.columns))
+        throw fail("bad header");
+
+    const uint8_t* body = base_ + offset + sizeof(BlockHeader);
+    auto sum = BLAKE3Pipeline::hash(body, hdr.body_bytes);
+    if (std::memcmp(sum.data(), hdr.checksum, 16) != 0) throw fail("checksum mismatch");
+
+    columns.resize(hdr.columns);
+    const uint8_t* stream = body + 8 * size_t(hdr.columns);
+    const uint8_t* body_end = body + hdr.body_bytes;
+    for (uint32_t c = 0; c < hdr.columns; ++c) {
+        uint64_t len;
+        std::memcpy(&len, body + 8 * size_t(c), 8);
+        if (len > static_cast<uint64_t>(body_end - stream)) throw fail("stream out of bounds");
+        const uint8_t* p = stream;
+        const uint8_t* end = stream + len;
+        auto& out = columns[c];
+        out.clear();
+        out.reserve(hdr.rows);
+        while (p < end) {
+            uint64_t run, vlen;
+            if (!get_varint(p, end, run) || !get_varint(p, end, vlen)) throw fail("bad run");
+            if (run > hdr.rows - out.size()) throw fail("too many rows");
+            Field f;
+            if (vlen > 0) {
+                if (vlen - 1 > static_cast<uint64_t>(end - p)) throw fail("value out of bounds");
+                f.data = p;
+                f.size = static_cast<uint32_t>(vlen - 1);
+                p += vlen - 1;
+            }
+            out.insert(out.end(), run, f);
+        }
+        if (out.size() != hdr.rows) throw fail("row count mismatch");
+        stream = end;
+    }
+    return hdr.rows;
+}
+
+void SubstrateSnapshot::scan(const std::string& table, const std::vector<std::string>& columns,
+                             const std::function<void(std::span<const Field>)>& fn) const {
+    const Table* t = this->table(table);
+    if (!t) throw std::runtime_error("Snapshot has no table " + table);
+    std::vector<int> select;
+    for (const auto& c : columns) {
+        const int i = t->column_index(c);
+        if (i < 0) throw std::runtime_error("Snapshot table " + table + " has no column " + c);
+        select.push_back(i);
+    }
+
+    std::vector<std::vector<Field>> decoded;
+    std::vector<Field> row(select.size());
+    for (size_t b = 0; b < t->blocks.size(); ++b) {
+        const size_t rows = decode_block(*t, b, decoded);
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t k = 0; k < select.size(); ++k) row[k] = decoded[select[k]][r];
+            fn(row);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Export and import
+// ----------------------------------------------------------------------------
+
+uint64_t SubstrateSnapshot::write(ConnectionPool& pool, const std::string& path, const Options& opts) {
+    const auto& names = opts.tables.empty() ? default_tables() : opts.tables;
+    Writer writer(path);
+
+    // Every stream reads the coordinator's snapshot, so the tables agree with each other
+    auto db = pool.acquire();
+    db->execute("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+    const std::string exported = db->query_single("SELECT pg_export_snapshot()").value_or("");
+
+    struct Source { size_t table; std::string relation; uint64_t bytes; };
+    std::vector<Source> sources;
+    std::vector<std::vector<Column>> table_columns;
+    for (const auto& name : names) {
+        const std::string rel = "hartonomous." + quote_ident(name);
+        std::vector<Column> columns;
+        db->query("SELECT attname, format_type(atttypid, atttypmod) FROM pg_attribute "
+                  "WHERE attrelid = $1::regclass AND attnum > 0 AND NOT attisdropped AND attgenerated = '' "
+                  "ORDER BY attnum", {rel},
+                  [&](const std::vector<std::string>& row) { columns.push_back({row[0], row[1]}); });
+        if (columns.empty()) throw std::runtime_error("Snapshot: no table hartonomous." + name);
+        const size_t index = writer.add_table(name, columns);
+        table_columns.push_back(std::move(columns));
+
+        // Leaf partitions stream separately; a plain table is its own only leaf
+        db->query("SELECT relid::regclass::text, pg_relation_size(relid) FROM pg_partition_tree($1::regclass) "
+                  "WHERE isleaf", {rel},
+                  [&](const std::vector<std::string>& row) {
+                      sources.push_back({index, row[0], std::strtoull(row[1].c_str(), nullptr, 10)});
+                  });
+    }
+    // Largest first, so the last stream to finish is a short one
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.bytes > b.bytes; });
+
+    const size_t jobs = default_jobs(opts, sources.size(), pool);
+    std::cout << "  Snapshot: " << names.size() << " tables, " << sources.size() << " streams on " << jobs
+              << " connections" << std::endl;
+    run_workers(jobs, sources.size(), [&](auto next) {
+        auto conn = pool.acquire();
+        conn->execute("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+        conn->execute("SET TRANSACTION SNAPSHOT '" + exported + "'");
+        for (size_t i; next(i);) {
+            const Source& src = sources[i];
+            auto stream = writer.stream(src.table, opts.block_rows);
+            conn->copy_out("COPY " + src.relation + " (" + column_list(table_columns[src.table]) +
+                               ") TO STDOUT (FORMAT binary)",
+                           [&](const char* buf, int len) { stream.add_message(buf, static_cast<size_t>(len)); });
+            stream.finish();
+        }
+        conn->execute("COMMIT");
+    });
+    db->execute("COMMIT");
+
+    const uint64_t rows = writer.rows();
+    writer.commit();
+    return rows;
+}
+
+uint64_t SubstrateSnapshot::load(ConnectionPool& pool, const std::string& path, const Options& opts) {
+    auto snap = open(path);
+    const auto& tables = snap->tables();
+
+    // Empty tables take the blocks as they are; others merge past existing keys
+    auto db = pool.acquire();
+    std::vector<char> merge(tables.size());
+    for (size_t t = 0; t < tables.size(); ++t)
+        merge[t] = db->query_single("SELECT EXISTS (SELECT 1 FROM hartonomous." + quote_ident(tables[t].name) + ")")
+                       .value_or("f") == "t";
+    const size_t deferred = BulkLoadSession::begin(*db);
+
+    struct Item { size_t table; size_t block; };
+    std::vector<Item> items;
+    for (size_t t = 0; t < tables.size(); ++t)
+        for (size_t b = 0; b < tables[t].blocks.size(); ++b) items.push_back({t, b});
+
+    const size_t jobs = default_jobs(opts, items.size(), pool);
+    std::cout << "  Snapshot: loading " << items.size() << " blocks on " << jobs << " connections, "
+              << deferred << " indexes and constraints deferred" << std::endl;
+
+    std::atomic<uint64_t> sent{0};
+    run_workers(jobs, items.size(), [&](auto next) {
+        auto conn = pool.acquire();
+        conn->execute("SET session_replication_role = 'replica'");
+        std::unique_ptr<BulkCopy> copy;
+        size_t current = SIZE_MAX;
+        std::vector<std::vector<Field>> columns;
+        for (size_t i; next(i);) {
+            const Item& item = items[i];
+            const Table& table = tables[item.table];
+            // Consecutive blocks of one table share a COPY; merged ones are staged a block at a time
+            if (item.table != current || merge[item.table]) {
+                if (copy) copy->flush();
+                copy = std::make_unique<BulkCopy>(*conn, merge[item.table] ? CopyMode::Staged : CopyMode::TrustedUnique);
+                copy->set_binary(true);
+                if (merge[item.table]) copy->set_conflict_clause("ON CONFLICT DO NOTHING");
+                std::vector<std::string> names;
+                for (const auto& c : table.columns) names.push_back(c.name);
+                copy->begin_table("hartonomous." + table.name, names);
+                current = item.table;
+            }
+            const size_t rows = snap->decode_block(table, item.block, columns);
+            for (size_t r = 0; r < rows; ++r) {
+                size_t n = 2;
+                for (const auto& col : columns) n += 4 + col[r].size;
+                uint8_t* p = copy->reserve_row(n);
+                p = pgcopy::store_be16(p, static_cast<uint16_t>(columns.size()));
+                for (const auto& col : columns) {
+                    const Field& f = col[r];
+                    p = pgcopy::store_be32(p, f.is_null() ? 0xFFFFFFFFu : f.size);
+                    if (f.size) std::memcpy(p, f.data, f.size);
+                    p += f.size;
+                }
+                copy->commit_row(n);
+            }
+            sent.fetch_add(rows, std::memory_order_relaxed);
+        }
+        if (copy) copy->flush();
+        conn->execute("RESET session_replication_role");
+    });
+
+    BulkLoadSession::finish(*db, BulkLoadOptions::from_env());
+    return sent.load();
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,317 @@
+/**
+ * @file s3_batch.cpp
+ * @brief Batch S³ kernels: one loop body per kernel, cloned per ISA with target attributes
+ *
+ * The loops are plain enough for the vectorizer, so unlike the intrinsics
+ * kernels they need no per-ISA translation units; simd_level() picks the clone.
+ */
+
+#include "geometry/s3_batch.hpp"
+#include <utils/cpu_dispatch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(HARTONOMOUS_X86_KERNELS)
+#define S3_BATCH_DISPATCH 1
+#define S3_TARGET(isa) __attribute__((target(isa)))
+#else
+#define S3_BATCH_DISPATCH 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define S3_INLINE inline __attribute__((always_inline))
+#else
+#define S3_INLINE inline
+#endif
+
+namespace s3
+{
+    namespace
+    {
+        // Abramowitz & Stegun 4.4.46: acos(a) = sqrt(1 - a) * P(a) on [0, 1]
+        template <typename T>
+        S3_INLINE T acos_poly(T x)
+        {
+            x = x > T(1) ? T(1) : (x < T(-1) ? T(-1) : x);
+            const T a = x < T(0) ? -x : x;
+            T p = T(-0.0012624911);
+            p = p * a + T(0.0066700901);
+            p = p * a + T(-0.0170881256);
+            p = p * a + T(0.0308918810);
+            p = p * a + T(-0.0501743046);
+            p = p * a + T(0.0889789874);
+            p = p * a + T(-0.2145988016);
+            p = p * a + T(1.5707963050);
+            const T r = std::sqrt(T(1) - a) * p;
+            return x < T(0) ? T(3.141592653589793) - r : r;
+        }
+
+        // sin and cos of x: Cody-Waite reduction to [-π/4, π/4], then Taylor
+        // series through x^15 / x^16 (|error| ~ 1e-16 there)
+        S3_INLINE void sincos_poly(double x, double& s, double& c)
+        {
+            const double q = std::floor(x * 0.63661977236758134 + 0.5);
+            const double r = (x - q * 1.5707963267948966) - q * 6.123233995736766e-17;
+            const int32_t k = static_cast<int32_t>(q) & 3;
+            const double r2 = r * r;
+
+            double ps = -7.6471637318198165e-13;
+            ps = ps * r2 + 1.6059043836821613e-10;
+            ps = ps * r2 - 2.5052108385441720e-08;
+            ps = ps * r2 + 2.7557319223985890e-06;
+            ps = ps * r2 - 1.9841269841269841e-04;
+            ps = ps * r2 + 8.3333333333333333e-03;
+            ps = ps * r2 - 1.6666666666666667e-01;
+            const double sr = r + r * r2 * ps;
+
+            double pc = 4.7794773323873853e-14;
+            pc = pc * r2 - 1.1470745597729725e-11;
+            pc = pc * r2 + 2.0876756987868099e-09;
+            pc = pc * r2 - 2.7557319223985890e-07;
+            pc = pc * r2 + 2.4801587301587302e-05;
+            pc = pc * r2 - 1.3888888888888889e-03;
+            pc = pc * r2 + 4.1666666666666667e-02;
+            pc = pc * r2 - 0.5;
+            const double cr = 1.0 + r2 * pc;
+
+            // Quadrant k rotates (sin, cos) by k·π/2
+            s = (k & 1) ? cr : sr;
+            c = (k & 1) ? sr : cr;
+            s = (k & 2) ? -s : s;
+            c = ((k + 1) & 2) ? -c : c;
+        }
+
+        template <typename T>
+        S3_INLINE void dot_body(const Vec4& q, const T* x, const T* y, const T* z, const T* w,
+                                size_t n, T* out)
+        {
+            const T qx = T(q[0]), qy = T(q[1]), qz = T(q[2]), qw = T(q[3]);
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                out[i] = qx * x[i] + qy * y[i] + qz * z[i] + qw * w[i];
+        }
+
+        template <typename T>
+        S3_INLINE void geodesic_body(const Vec4& q, const T* x, const T* y, const T* z, const T* w,
+                                     size_t n, T* out)
+        {
+            const T qx = T(q[0]), qy = T(q[1]), qz = T(q[2]), qw = T(q[3]);
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                out[i] = acos_poly(qx * x[i] + qy * y[i] + qz * z[i] + qw * w[i]);
+        }
+
+        template <typename T>
+        S3_INLINE void normalize_body(T* x, T* y, T* z, T* w, size_t n)
+        {
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+            {
+                const T r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i] + w[i] * w[i];
+                const T inv = r2 > T(0) ? T(1) / std::sqrt(r2) : T(1);
+                x[i] *= inv;
+                y[i] *= inv;
+                z[i] *= inv;
+                w[i] *= inv;
+            }
+        }
+
+        // (z1, z2) = (x + iy, z + iw) -> (|z1|² - |z2|², 2 Re z1·conj(z2), 2 Im z1·conj(z2))
+        S3_INLINE void hopf_forward_body(const double* x, const double* y, const double* z, const double* w,
+                                         size_t n, double* sx, double* sy, double* sz)
+        {
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+            {
+                const double a = x[i], b = y[i], c = z[i], d = w[i];
+                sx[i] = (a * a + b * b) - (c * c + d * d);
+                sy[i] = 2.0 * (a * c + b * d);
+                sz[i] = 2.0 * (b * c - a * d);
+            }
+        }
+
+        // HopfFibration::inverse with e^{-i·atan2(sz, sy)} taken as (sy - i·sz) / |(sy, sz)|
+        template <bool HasAngle>
+        S3_INLINE void hopf_inverse_loop(const double* sx, const double* sy, const double* sz,
+                                         const double* fiber_angle, size_t n,
+                                         double* x, double* y, double* z, double* w)
+        {
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+            {
+                const double r1 = std::sqrt(std::max(0.0, (1.0 + sx[i]) / 2.0));
+                const double r2 = std::sqrt(std::max(0.0, (1.0 - sx[i]) / 2.0));
+                const double rho2 = sy[i] * sy[i] + sz[i] * sz[i];
+                const double inv = rho2 > 0.0 ? 1.0 / std::sqrt(rho2) : 0.0;
+                const double cos_p = rho2 > 0.0 ? sy[i] * inv : 1.0;
+                const double sin_p = sz[i] * inv;
+
+                double st = 0.0, ct = 1.0;
+                if constexpr (HasAngle) sincos_poly(fiber_angle[i], st, ct);
+
+                x[i] = r1 * ct;
+                y[i] = r1 * st;
+                z[i] = r2 * (ct * cos_p + st * sin_p);
+                w[i] = r2 * (st * cos_p - ct * sin_p);
+            }
+        }
+
+        S3_INLINE void hopf_inverse_body(const double* sx, const double* sy, const double* sz,
+                                         const double* fiber_angle, size_t n,
+                                         double* x, double* y, double* z, double* w)
+        {
+            if (fiber_angle)
+                hopf_inverse_loop<true>(sx, sy, sz, fiber_angle, n, x, y, z, w);
+            else
+                hopf_inverse_loop<false>(sx, sy, sz, fiber_angle, n, x, y, z, w);
+        }
+
+        // Lanes are the four components, so each sum is the scalar left-to-right sum
+        S3_INLINE void centroid_sums_body(const double* p, const size_t* counts, size_t groups, double* out)
+        {
+            for (size_t g = 0; g < groups; ++g)
+            {
+                double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                for (size_t i = 0; i < counts[g]; ++i, p += 4)
+                {
+                    s0 += p[0];
+                    s1 += p[1];
+                    s2 += p[2];
+                    s3 += p[3];
+                }
+                out[4 * g + 0] = s0;
+                out[4 * g + 1] = s1;
+                out[4 * g + 2] = s2;
+                out[4 * g + 3] = s3;
+            }
+        }
+
+        template <typename T>
+        struct Kernels
+        {
+            void (*dot)(const Vec4&, const T*, const T*, const T*, const T*, size_t, T*) noexcept;
+            void (*geodesic)(const Vec4&, const T*, const T*, const T*, const T*, size_t, T*) noexcept;
+            void (*normalize)(T*, T*, T*, T*, size_t) noexcept;
+        };
+
+        struct KernelTable
+        {
+            Kernels<double> f64;
+            Kernels<float> f32;
+            void (*centroid_sums)(const double*, const size_t*, size_t, double*) noexcept;
+            void (*hopf_forward)(const double*, const double*, const double*, const double*, size_t,
+                                 double*, double*, double*) noexcept;
+            void (*hopf_inverse)(const double*, const double*, const double*, const double*, size_t,
+                                 double*, double*, double*, double*) noexcept;
+        };
+
+        // One clone of every kernel per target; ATTR is empty for the baseline build
+#define S3_BATCH_CLONES(SUFFIX, ATTR)                                                              \
+        template <typename T>                                                                       \
+        ATTR void dot_##SUFFIX(const Vec4& q, const T* x, const T* y, const T* z, const T* w,       \
+                               size_t n, T* out) noexcept { dot_body(q, x, y, z, w, n, out); }      \
+        template <typename T>                                                                       \
+        ATTR void geodesic_##SUFFIX(const Vec4& q, const T* x, const T* y, const T* z, const T* w,  \
+                                    size_t n, T* out) noexcept { geodesic_body(q, x, y, z, w, n, out); } \
+        template <typename T>                                                                       \
+        ATTR void normalize_##SUFFIX(T* x, T* y, T* z, T* w, size_t n) noexcept                    \
+        { normalize_body(x, y, z, w, n); }                                                          \
+        ATTR void centroid_sums_##SUFFIX(const double* p, const size_t* counts, size_t groups,     \
+                                         double* out) noexcept { centroid_sums_body(p, counts, groups, out); } \
+        ATTR void hopf_forward_##SUFFIX(const double* x, const double* y, const double* z, const double* w, \
+                                        size_t n, double* sx, double* sy, double* sz) noexcept      \
+        { hopf_forward_body(x, y, z, w, n, sx, sy, sz); }                                          \
+        ATTR void hopf_inverse_##SUFFIX(const double* sx, const double* sy, const double* sz,       \
+                                        const double* fa, size_t n, double* x, double* y, double* z, \
+                                        double* w) noexcept                                         \
+        { hopf_inverse_body(sx, sy, sz, fa, n, x, y, z, w); }                                       \
+        constexpr KernelTable TABLE_##SUFFIX{                                                       \
+            {dot_##SUFFIX<double>, geodesic_##SUFFIX<double>, normalize_##SUFFIX<double>},          \
+            {dot_##SUFFIX<float>, geodesic_##SUFFIX<float>, normalize_##SUFFIX<float>},             \
+            centroid_sums_##SUFFIX, hopf_forward_##SUFFIX, hopf_inverse_##SUFFIX};
+
+        S3_BATCH_CLONES(scalar, )
+#if S3_BATCH_DISPATCH
+        S3_BATCH_CLONES(sse4, S3_TARGET("sse4.1"))
+        S3_BATCH_CLONES(avx2, S3_TARGET("avx2,fma"))
+        S3_BATCH_CLONES(avx512, S3_TARGET("avx512f,avx512dq,avx512vl,prefer-vector-width=512"))
+#endif
+#undef S3_BATCH_CLONES
+
+        const KernelTable& kernels() noexcept
+        {
+#if S3_BATCH_DISPATCH
+            switch (Hartonomous::simd_level())
+            {
+            case Hartonomous::SimdLevel::Avx512: return TABLE_avx512;
+            case Hartonomous::SimdLevel::Avx2: return TABLE_avx2;
+            case Hartonomous::SimdLevel::Sse4: return TABLE_sse4;
+            default: break;
+            }
+#endif
+            return TABLE_scalar;
+        }
+    }
+
+    void dot_many(const Vec4& q, const double* x, const double* y, const double* z,
+                  const double* w, size_t n, double* out) noexcept
+    {
+        kernels().f64.dot(q, x, y, z, w, n, out);
+    }
+
+    void dot_many(const Vec4& q, const float* x, const float* y, const float* z,
+                  const float* w, size_t n, float* out) noexcept
+    {
+        kernels().f32.dot(q, x, y, z, w, n, out);
+    }
+
+    void geodesic_many(const Vec4& q, const double* x, const double* y, const double* z,
+                       const double* w, size_t n, double* out) noexcept
+    {
+        kernels().f64.geodesic(q, x, y, z, w, n, out);
+    }
+
+    void geodesic_many(const Vec4& q, const float* x, const float* y, const float* z,
+                       const float* w, size_t n, float* out) noexcept
+    {
+        kernels().f32.geodesic(q, x, y, z, w, n, out);
+    }
+
+    void normalize_many(double* x, double* y, double* z, double* w, size_t n) noexcept
+    {
+        kernels().f64.normalize(x, y, z, w, n);
+    }
+
+    void normalize_many(float* x, float* y, float* z, float* w, size_t n) noexcept
+    {
+        kernels().f32.normalize(x, y, z, w, n);
+    }
+
+    void centroid_sums(const double* points_4d, const size_t* counts, size_t groups, double* out_4d) noexcept
+    {
+        kernels().centroid_sums(points_4d, counts, groups, out_4d);
+    }
+
+    void hopf_forward_many(const double* x, const double* y, const double* z, const double* w, size_t n,
+                           double* s2_x, double* s2_y, double* s2_z) noexcept
+    {
+        kernels().hopf_forward(x, y, z, w, n, s2_x, s2_y, s2_z);
+    }
+
+    void hopf_inverse_many(const double* s2_x, const double* s2_y, const double* s2_z, const double* fiber_angle,
+                           size_t n, double* x, double* y, double* z, double* w) noexcept
+    {
+        kernels().hopf_inverse(s2_x, s2_y, s2_z, fiber_angle, n, x, y, z, w);
+    }
+
+    double fast_acos(double x) noexcept
+    {
+        return acos_poly(x);
+    }
+
+    void fast_sincos(double x, double& s, double& c) noexcept
+    {
+        sincos_poly(x, s, c);
+    }
+}
@@ -0,0 +1,217 @@
+#include "geometry/s3_bbox_split.hpp"
+#include "spatial/hilbert_curve_4d.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace s3
+{
+    double bbox_volume(const BBox4& b) noexcept
+    {
+        double v = 1.0;
+        for (int i = 0; i < 4; ++i) v *= b.max[i] - b.min[i];
+        return v;
+    }
+
+    double bbox_margin(const BBox4& b) noexcept
+    {
+        double m = 0.0;
+        for (int i = 0; i < 4; ++i) m += b.max[i] - b.min[i];
+        return m;
+    }
+
+    double bbox_overlap(const BBox4& a, const BBox4& b) noexcept
+    {
+        double v = 1.0;
+        for (int i = 0; i < 4; ++i)
+        {
+            double lo = std::max(a.min[i], b.min[i]);
+            double hi = std::min(a.max[i], b.max[i]);
+            if (hi <= lo) return 0.0;
+            v *= hi - lo;
+        }
+        return v;
+    }
+
+    namespace
+    {
+        BBox4 union_of(const std::vector<BBox4>& boxes, const std::vector<int>& idx)
+        {
+            BBox4 acc = boxes[idx[0]];
+            for (size_t i = 1; i < idx.size(); ++i) acc = bbox_union(acc, boxes[idx[i]]);
+            return acc;
+        }
+
+        // The original gist_s3_picksplit
+        BBoxSplit midpoint_split(const std::vector<BBox4>& boxes)
+        {
+            double lo[4] = {1e300, 1e300, 1e300, 1e300};
+            double hi[4] = {-1e300, -1e300, -1e300, -1e300};
+            for (const auto& b : boxes)
+            {
+                for (int d = 0; d < 4; ++d)
+                {
+                    double c = (b.min[d] + b.max[d]) / 2.0;
+                    lo[d] = std::min(lo[d], c);
+                    hi[d] = std::max(hi[d], c);
+                }
+            }
+            int dim = 0;
+            for (int d = 1; d < 4; ++d)
+                if (hi[d] - lo[d] > hi[dim] - lo[dim]) dim = d;
+            double cut = (lo[dim] + hi[dim]) / 2.0;
+
+            BBoxSplit s;
+            for (int i = 0; i < static_cast<int>(boxes.size()); ++i)
+            {
+                double c = (boxes[i].min[dim] + boxes[i].max[dim]) / 2.0;
+                (c < cut ? s.left : s.right).push_back(i);
+            }
+            if (s.left.empty())
+            {
+                s.left.push_back(s.right.back());
+                s.right.pop_back();
+            }
+            if (s.right.empty())
+            {
+                s.right.push_back(s.left.back());
+                s.left.pop_back();
+            }
+            return s;
+        }
+
+        // Candidate splits of one ordering: entries [0, k) left, [k, n) right
+        // for k in [m, n - m], with both sides' boxes from prefix/suffix unions
+        template <typename Visit>
+        void sweep(const std::vector<BBox4>& boxes, const std::vector<int>& order, int m,
+                   std::vector<BBox4>& prefix, std::vector<BBox4>& suffix, Visit&& visit)
+        {
+            const int n = static_cast<int>(order.size());
+            prefix[0] = boxes[order[0]];
+            for (int i = 1; i < n; ++i) prefix[i] = bbox_union(prefix[i - 1], boxes[order[i]]);
+            suffix[n - 1] = boxes[order[n - 1]];
+            for (int i = n - 1; i-- > 0;) suffix[i] = bbox_union(suffix[i + 1], boxes[order[i]]);
+            for (int k = m; k <= n - m; ++k) visit(k, prefix[k - 1], suffix[k]);
+        }
+
+        void sort_on(const std::vector<BBox4>& boxes, std::vector<int>& order, int axis, bool by_max)
+        {
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                const BBox4& x = boxes[a];
+                const BBox4& y = boxes[b];
+                return by_max ? std::tie(x.max[axis], x.min[axis]) < std::tie(y.max[axis], y.min[axis])
+                              : std::tie(x.min[axis], x.max[axis]) < std::tie(y.min[axis], y.max[axis]);
+            });
+        }
+
+        // Least overlap, then area, then margin, then the most even (point
+        // entries overlap and enclose nothing, so the later keys decide)
+        struct Cut
+        {
+            std::tuple<double, double, double, int> cost{INFINITY, INFINITY, INFINITY, INT_MAX};
+            int k = 0;
+
+            BBoxSplit apply(const std::vector<int>& order) const
+            {
+                BBoxSplit s;
+                s.left.assign(order.begin(), order.begin() + k);
+                s.right.assign(order.begin() + k, order.end());
+                return s;
+            }
+        };
+
+        Cut best_cut(const std::vector<BBox4>& boxes, const std::vector<int>& order, int m,
+                     std::vector<BBox4>& prefix, std::vector<BBox4>& suffix)
+        {
+            const int n = static_cast<int>(order.size());
+            Cut best;
+            sweep(boxes, order, m, prefix, suffix, [&](int k, const BBox4& l, const BBox4& r) {
+                Cut c{{bbox_overlap(l, r), bbox_volume(l) + bbox_volume(r), bbox_margin(l) + bbox_margin(r),
+                       std::abs(2 * k - n)},
+                      k};
+                if (c.cost < best.cost) best = c;
+            });
+            return best;
+        }
+
+        int min_entries(int n, double min_fill)
+        {
+            return std::clamp(static_cast<int>(std::ceil(n * min_fill)), 1, n / 2);
+        }
+
+        BBoxSplit rstar_split(const std::vector<BBox4>& boxes, double min_fill)
+        {
+            const int n = static_cast<int>(boxes.size());
+            const int m = min_entries(n, min_fill);
+            std::vector<int> order(n);
+            std::vector<BBox4> prefix(n), suffix(n);
+
+            // Axis: least margin summed over all its candidate splits
+            int axis = 0;
+            double best_margin = INFINITY;
+            for (int a = 0; a < 4; ++a)
+            {
+                double margin = 0.0;
+                for (bool by_max : {false, true})
+                {
+                    sort_on(boxes, order, a, by_max);
+                    sweep(boxes, order, m, prefix, suffix, [&](int, const BBox4& l, const BBox4& r) {
+                        margin += bbox_margin(l) + bbox_margin(r);
+                    });
+                }
+                if (margin < best_margin)
+                {
+                    best_margin = margin;
+                    axis = a;
+                }
+            }
+
+            // Distribution: the better cut of either ordering on that axis
+            sort_on(boxes, order, axis, false);
+            Cut by_min = best_cut(boxes, order, m, prefix, suffix);
+            std::vector<int> by_max_order(n);
+            sort_on(boxes, by_max_order, axis, true);
+            Cut by_max = best_cut(boxes, by_max_order, m, prefix, suffix);
+            return by_max.cost < by_min.cost ? by_max.apply(by_max_order) : by_min.apply(order);
+        }
+
+        BBoxSplit hilbert_split(const std::vector<BBox4>& boxes, double min_fill)
+        {
+            using hartonomous::spatial::HilbertCurve4D;
+            const int n = static_cast<int>(boxes.size());
+            std::vector<double> centres(4 * n);
+            for (int i = 0; i < n; ++i)
+                for (int d = 0; d < 4; ++d)
+                    centres[4 * i + d] = ((boxes[i].min[d] + boxes[i].max[d]) / 2.0 + 1.0) / 2.0;
+            std::vector<HilbertCurve4D::HilbertIndex> keys(n);
+            HilbertCurve4D::encode_batch(centres.data(), n, keys.data());
+            std::vector<int> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                int c = std::memcmp(keys[a].data(), keys[b].data(), keys[a].size());
+                return c < 0 || (c == 0 && a < b);
+            });
+
+            std::vector<BBox4> prefix(n), suffix(n);
+            return best_cut(boxes, order, min_entries(n, min_fill), prefix, suffix).apply(order);
+        }
+    }
+
+    BBoxSplit split_bboxes(const std::vector<BBox4>& boxes, SplitMethod method, double min_fill)
+    {
+        BBoxSplit s;
+        switch (method)
+        {
+        case SplitMethod::Midpoint: s = midpoint_split(boxes); break;
+        case SplitMethod::RStar: s = rstar_split(boxes, min_fill); break;
+        case SplitMethod::Hilbert: s = hilbert_split(boxes, min_fill); break;
+        }
+        s.left_box = union_of(boxes, s.left);
+        s.right_box = union_of(boxes, s.right);
+        return s;
+    }
+}
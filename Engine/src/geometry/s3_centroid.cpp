@@ -4,8 +4,8 @@
  */
 
 #include <geometry/s3_centroid.hpp>
+#include <geometry/s3_batch.hpp>
 #include <Eigen/Dense>
-#include <vector>
 
 namespace Hartonomous::Geometry {
 
@@ -14,13 +14,8 @@ Eigen::Vector4d compute_s3_centroid(const double* points_4d, size_t count) {
         return Eigen::Vector4d(1, 0, 0, 0); // Default to a valid point on S3
     }
 
-    Eigen::Vector4d sum = Eigen::Vector4d::Zero();
-    for (size_t i = 0; i < count; ++i) {
-        sum[0] += points_4d[i * 4 + 0];
-        sum[1] += points_4d[i * 4 + 1];
-        sum[2] += points_4d[i * 4 + 2];
-        sum[3] += points_4d[i * 4 + 3];
-    }
+    Eigen::Vector4d sum;
+    s3::centroid_sums(points_4d, &count, 1, sum.data());
 
     double norm = sum.norm();
     if (norm > 1e-15) {
@@ -36,4 +31,15 @@ Eigen::Vector4d compute_s3_centroid(const double* points_4d, size_t count) {
     return sum;
 }
 
+Eigen::Vector4d compute_s3_mean(const double* points_4d, size_t count) {
+    if (count == 0) return Eigen::Vector4d(1, 0, 0, 0);
+
+    Eigen::Vector4d centroid;
+    s3::centroid_sums(points_4d, &count, 1, centroid.data());
+    centroid /= static_cast<double>(count);
+    double norm = centroid.norm();
+    if (norm > 1e-10) centroid /= norm; else centroid = Eigen::Vector4d(1, 0, 0, 0);
+    return centroid;
+}
+
 } // namespace Hartonomous::Geometry
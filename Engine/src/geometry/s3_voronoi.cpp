@@ -0,0 +1,455 @@
+/**
+ * @file s3_voronoi.cpp
+ * @brief Quickhull and the spherical Delaunay / Voronoi structure built on it
+ */
+
+#include <geometry/s3_voronoi.hpp>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+namespace Hartonomous::Geometry {
+
+// =============================================================================
+// Quickhull
+// =============================================================================
+
+namespace {
+
+template <int D>
+struct HullFacet {
+    std::array<uint32_t, D> v;
+    std::array<uint32_t, D> adj;
+    Eigen::Matrix<double, D, 1> normal;
+    double offset = 0.0;
+    std::vector<uint32_t> outside;  // Points beyond this facet, not yet on the hull
+    uint32_t visited = 0;
+    bool alive = true;
+};
+
+// Hyperplane through the facet's vertices, its normal pointing away from `inside`
+template <int D>
+void orient_facet(const std::vector<Eigen::Matrix<double, D, 1>>& pts, const Eigen::Matrix<double, D, 1>& inside,
+                  HullFacet<D>& f) {
+    Eigen::Matrix<double, D - 1, D> edges;
+    for (int k = 1; k < D; ++k) edges.row(k - 1) = (pts[f.v[k]] - pts[f.v[0]]).transpose();
+
+    // Generalized cross product: signed maximal minors
+    for (int j = 0; j < D; ++j) {
+        Eigen::Matrix<double, D - 1, D - 1> minor;
+        for (int c = 0, mc = 0; c < D; ++c) {
+            if (c == j) continue;
+            minor.col(mc++) = edges.col(c);
+        }
+        f.normal[j] = (j & 1 ? -1.0 : 1.0) * minor.determinant();
+    }
+    double norm = f.normal.norm();
+    if (norm == 0.0) throw std::runtime_error("ConvexHull: degenerate facet");
+    f.normal /= norm;
+    f.offset = f.normal.dot(pts[f.v[0]]);
+    if (f.normal.dot(inside) > f.offset) {
+        f.normal = -f.normal;
+        f.offset = -f.offset;
+    }
+}
+
+} // namespace
+
+template <int D>
+ConvexHull<D>::ConvexHull(const std::vector<Point>& pts, double eps) {
+    using Facet_ = HullFacet<D>;
+    using Ridge = std::array<uint32_t, D - 1>;
+    const uint32_t n = static_cast<uint32_t>(pts.size());
+    if (n < D + 1) throw std::runtime_error("ConvexHull: need at least D + 1 points");
+
+    // Initial simplex: each vertex farthest from the affine span of those before it
+    std::vector<uint32_t> simplex{0};
+    for (uint32_t i = 1; i < n; ++i)
+        if (pts[i][0] < pts[simplex[0]][0]) simplex[0] = i;
+    std::vector<Point> basis;
+    while (simplex.size() < D + 1) {
+        uint32_t best = 0;
+        double best_norm = -1.0;
+        Point best_r;
+        for (uint32_t i = 0; i < n; ++i) {
+            Point r = pts[i] - pts[simplex[0]];
+            for (const auto& b : basis) r -= r.dot(b) * b;
+            double rn = r.norm();
+            if (rn > best_norm) {
+                best_norm = rn;
+                best = i;
+                best_r = r;
+            }
+        }
+        if (best_norm <= eps) throw std::runtime_error("ConvexHull: points do not span the space");
+        basis.push_back(best_r / best_norm);
+        simplex.push_back(best);
+    }
+
+    Point inside = Point::Zero();
+    for (uint32_t s : simplex) inside += pts[s];
+    inside /= D + 1;
+
+    std::vector<Facet_> F;
+    auto ridge_of = [&](const Facet_& f, int k) {
+        Ridge r;
+        for (int i = 0, j = 0; i < D; ++i)
+            if (i != k) r[j++] = f.v[i];
+        std::sort(r.begin(), r.end());
+        return r;
+    };
+    // Pair up facets created together through the ridges they share
+    std::map<Ridge, std::pair<uint32_t, int>> open;
+    auto link = [&](uint32_t fi, int k) {
+        Ridge r = ridge_of(F[fi], k);
+        auto it = open.find(r);
+        if (it == open.end()) {
+            open.emplace(r, std::make_pair(fi, k));
+            return;
+        }
+        F[fi].adj[k] = it->second.first;
+        F[it->second.first].adj[it->second.second] = fi;
+        open.erase(it);
+    };
+
+    for (int skip = 0; skip <= D; ++skip) {
+        Facet_ f;
+        for (int i = 0, j = 0; i <= D; ++i)
+            if (i != skip) f.v[j++] = simplex[i];
+        orient_facet<D>(pts, inside, f);
+        F.push_back(std::move(f));
+    }
+    for (uint32_t fi = 0; fi <= D; ++fi)
+        for (int k = 0; k < D; ++k) link(fi, k);
+
+    // Each remaining point waits on the facet it is farthest beyond
+    auto assign = [&](uint32_t p, const std::vector<uint32_t>& candidates) {
+        uint32_t best = 0;
+        double best_d = eps;
+        bool found = false;
+        for (uint32_t fi : candidates) {
+            double d = F[fi].normal.dot(pts[p]) - F[fi].offset;
+            if (d > best_d) {
+                best_d = d;
+                best = fi;
+                found = true;
+            }
+        }
+        if (found) F[best].outside.push_back(p);
+    };
+    std::vector<uint32_t> initial(D + 1);
+    std::iota(initial.begin(), initial.end(), 0u);
+    for (uint32_t p = 0; p < n; ++p)
+        if (std::find(simplex.begin(), simplex.end(), p) == simplex.end()) assign(p, initial);
+
+    std::vector<uint32_t> pending;
+    for (uint32_t fi = 0; fi <= D; ++fi)
+        if (!F[fi].outside.empty()) pending.push_back(fi);
+
+    uint32_t stamp = 0;
+    std::vector<uint32_t> visible, created, orphans;
+    std::vector<std::pair<uint32_t, int>> horizon;
+    while (!pending.empty()) {
+        uint32_t fi = pending.back();
+        pending.pop_back();
+        if (!F[fi].alive || F[fi].outside.empty()) continue;
+
+        uint32_t apex = F[fi].outside[0];
+        double apex_d = -1.0;
+        for (uint32_t p : F[fi].outside) {
+            double d = F[fi].normal.dot(pts[p]) - F[fi].offset;
+            if (d > apex_d) {
+                apex_d = d;
+                apex = p;
+            }
+        }
+
+        // Facets the apex sees, and the ridges bounding them
+        ++stamp;
+        visible.assign(1, fi);
+        F[fi].visited = stamp;
+        horizon.clear();
+        for (size_t h = 0; h < visible.size(); ++h) {
+            const uint32_t vf = visible[h];
+            for (int k = 0; k < D; ++k) {
+                uint32_t nb = F[vf].adj[k];
+                if (F[nb].visited == stamp) continue;
+                if (F[nb].normal.dot(pts[apex]) - F[nb].offset > eps) {
+                    F[nb].visited = stamp;
+                    visible.push_back(nb);
+                } else {
+                    horizon.emplace_back(vf, k);
+                }
+            }
+        }
+
+        orphans.clear();
+        for (uint32_t vf : visible) {
+            F[vf].alive = false;
+            for (uint32_t p : F[vf].outside)
+                if (p != apex) orphans.push_back(p);
+            std::vector<uint32_t>().swap(F[vf].outside);
+        }
+
+        // Cone from the apex over the horizon
+        created.clear();
+        open.clear();
+        for (auto [vf, k] : horizon) {
+            Facet_ f;
+            f.v = F[vf].v;
+            f.v[k] = apex;
+            const uint32_t nb = F[vf].adj[k];
+            f.adj[k] = nb;
+            orient_facet<D>(pts, inside, f);
+            const uint32_t id = static_cast<uint32_t>(F.size());
+            F.push_back(std::move(f));
+            for (int m = 0; m < D; ++m)
+                if (F[nb].adj[m] == vf) F[nb].adj[m] = id;
+            for (int m = 0; m < D; ++m)
+                if (m != k) link(id, m);
+            created.push_back(id);
+        }
+        if (!open.empty()) throw std::runtime_error("ConvexHull: horizon is not closed");
+
+        for (uint32_t p : orphans) assign(p, created);
+        for (uint32_t id : created)
+            if (!F[id].outside.empty()) pending.push_back(id);
+    }
+
+    std::vector<uint32_t> remap(F.size(), 0);
+    for (uint32_t fi = 0, live = 0; fi < F.size(); ++fi)
+        if (F[fi].alive) remap[fi] = live++;
+    for (const auto& f : F) {
+        if (!f.alive) continue;
+        Facet out;
+        out.vertices = f.v;
+        for (int k = 0; k < D; ++k) out.neighbors[k] = remap[f.adj[k]];
+        out.normal = f.normal;
+        out.offset = f.offset;
+        facets_.push_back(out);
+    }
+}
+
+template class ConvexHull<3>;
+template class ConvexHull<4>;
+
+// =============================================================================
+// Spherical Delaunay triangulation
+// =============================================================================
+
+S3Delaunay::S3Delaunay(std::vector<Eigen::Vector4d> sites,
+                       std::optional<std::pair<Eigen::Vector4d, double>> region)
+    : sites_(std::move(sites))
+{
+    const uint32_t n = static_cast<uint32_t>(sites_.size());
+    state_.assign(n, EXACT);
+    adjacency_offsets_.assign(n + 1, 0);
+    star_offsets_.assign(n + 1, 0);
+
+    // Coincident sites would be dropped by the hull; keep the lowest index of each
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const auto& p = sites_[a];
+        const auto& q = sites_[b];
+        for (int k = 0; k < 4; ++k)
+            if (p[k] != q[k]) return p[k] < q[k];
+        return a < b;
+    });
+    std::vector<Eigen::Vector4d> points;
+    std::vector<uint32_t> site_of;  // Hull point -> site
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && (sites_[order[i]] - sites_[site_of.back()]).squaredNorm() < 1e-24) {
+            state_[order[i]] = DUPLICATE;
+            continue;
+        }
+        points.push_back(sites_[order[i]]);
+        site_of.push_back(order[i]);
+    }
+
+    // Sites in an open hemisphere leave the origin outside their hull
+    const uint32_t GUARD = static_cast<uint32_t>(points.size());
+    Eigen::Vector4d mean = Eigen::Vector4d::Zero();
+    for (const auto& p : points) mean += p;
+    if (mean.norm() > 1e-9) {
+        mean.normalize();
+        double lowest = 1.0;
+        for (const auto& p : points) lowest = std::min(lowest, p.dot(mean));
+        if (lowest > 1e-9) points.push_back(-mean);
+    }
+
+    std::vector<ConvexHull<4>::Facet> facets;
+    try {
+        facets = ConvexHull<4>(points).facets();
+    } catch (const std::runtime_error&) {
+        // Too few sites, or all on one great sphere: nothing is exact
+        std::fill(state_.begin(), state_.end(), NOT_EXACT);
+        return;
+    }
+
+    auto mark_not_exact = [&](const auto& vertices) {
+        for (uint32_t v : vertices)
+            if (v != GUARD) state_[site_of[v]] = NOT_EXACT;
+    };
+    std::vector<uint8_t> on_hull(n, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> edges, stars;
+    for (const auto& f : facets) {
+        bool guarded = false;
+        for (uint32_t v : f.vertices) {
+            if (v == GUARD) guarded = true;
+            else on_hull[site_of[v]] = 1;
+        }
+        for (int a = 0; a < 4; ++a) {
+            for (int b = a + 1; b < 4; ++b) {
+                if (f.vertices[a] == GUARD || f.vertices[b] == GUARD) continue;
+                uint32_t sa = site_of[f.vertices[a]], sb = site_of[f.vertices[b]];
+                edges.emplace_back(sa, sb);
+                edges.emplace_back(sb, sa);
+            }
+        }
+        if (guarded) {
+            mark_not_exact(f.vertices);
+            continue;
+        }
+
+        // Circumcap: centre is the outward normal, cos(radius) the offset
+        const Eigen::Vector4d& c = f.normal;
+        bool capped = f.offset > 1e-12;
+        if (capped && region) {
+            double reach = std::acos(std::clamp(c.dot(region->first), -1.0, 1.0)) +
+                           std::acos(std::clamp(f.offset, -1.0, 1.0));
+            capped = reach <= region->second;
+        }
+        if (!capped) mark_not_exact(f.vertices);
+
+        const uint32_t t = static_cast<uint32_t>(circumcenters_.size());
+        circumcenters_.push_back(c);
+        for (uint32_t v : f.vertices) stars.emplace_back(site_of[v], t);
+    }
+
+    // Cospherical sites can sit on a facet without becoming hull vertices;
+    // every cell whose circumsphere passes through one is suspect
+    for (uint32_t s = 0; s < n; ++s) {
+        if (state_[s] == DUPLICATE || on_hull[s]) continue;
+        state_[s] = NOT_EXACT;
+        uint32_t t = 0;
+        for (const auto& f : facets) {
+            bool guarded = std::find(f.vertices.begin(), f.vertices.end(), GUARD) != f.vertices.end();
+            if (guarded) continue;
+            if (circumcenters_[t].dot(sites_[s]) >= f.offset - 1e-12) mark_not_exact(f.vertices);
+            ++t;
+        }
+    }
+
+    auto to_csr = [n](std::vector<std::pair<uint32_t, uint32_t>>& pairs,
+                      std::vector<uint32_t>& offsets, std::vector<uint32_t>& values) {
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        values.reserve(pairs.size());
+        for (const auto& [from, to] : pairs) {
+            offsets[from + 1]++;
+            values.push_back(to);
+        }
+        for (uint32_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+    };
+    to_csr(edges, adjacency_offsets_, adjacency_);
+    to_csr(stars, star_offsets_, star_);
+}
+
+S3Cell S3Delaunay::cell(uint32_t i) const {
+    S3Cell out;
+    if (state_[i] == DUPLICATE) {
+        out.exact = true;
+        return out;
+    }
+    if (state_[i] == NOT_EXACT) return out;
+
+    // Gnomonic chart at p: y = Eᵀx / (p·x), E an orthonormal basis of p's tangent space
+    const Eigen::Vector4d& p = sites_[i];
+    Eigen::HouseholderQR<Eigen::Vector4d> qr(p);
+    const Eigen::Matrix4d Q = qr.householderQ();
+    const Eigen::Matrix<double, 4, 3> E = Q.rightCols<3>();
+
+    std::vector<Eigen::Vector3d> vertices;
+    for (uint32_t k = star_offsets_[i]; k < star_offsets_[i + 1]; ++k) {
+        const Eigen::Vector4d& c = circumcenters_[star_[k]];
+        double cp = c.dot(p);
+        if (cp <= 1e-9) return out;  // A Voronoi vertex a quarter turn away has no chart point
+        vertices.push_back(E.transpose() * c / cp);
+    }
+
+    std::vector<ConvexHull<3>::Facet> faces;
+    try {
+        faces = ConvexHull<3>(vertices).facets();
+    } catch (const std::runtime_error&) {
+        return out;
+    }
+
+    // Each neighbor's bisector in the chart: y · Eᵀq = 1 - p·q
+    auto nbrs = neighbors(i);
+    std::vector<Eigen::Vector3d> bisector(nbrs.size());
+    for (size_t j = 0; j < nbrs.size(); ++j) bisector[j] = (E.transpose() * sites_[nbrs[j]]).normalized();
+    std::vector<double> face_area(nbrs.size(), 0.0);
+
+    // Cones from the site over each boundary triangle; 4-point degree-2 rule
+    constexpr double ALPHA = 0.5854101966249685, BETA = 0.1381966011250105;
+    double mass = 0.0;
+    Eigen::Vector3d first = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d second = Eigen::Matrix3d::Zero();
+    for (const auto& f : faces) {
+        if (f.offset <= 0.0 || nbrs.empty()) return out;
+        const Eigen::Vector3d& a = vertices[f.vertices[0]];
+        const Eigen::Vector3d& b = vertices[f.vertices[1]];
+        const Eigen::Vector3d& c = vertices[f.vertices[2]];
+        double area = 0.5 * (b - a).cross(c - a).norm();
+
+        size_t owner = 0;
+        for (size_t j = 1; j < nbrs.size(); ++j)
+            if (f.normal.dot(bisector[j]) > f.normal.dot(bisector[owner])) owner = j;
+        face_area[owner] += area;
+
+        const double weight = f.offset * area / 12.0;  // Cone volume / 4 points
+        const Eigen::Vector3d base = BETA * (a + b + c);
+        const Eigen::Vector3d nodes[4] = {base, base + (ALPHA - BETA) * a, base + (ALPHA - BETA) * b,
+                                          base + (ALPHA - BETA) * c};
+        for (const auto& y : nodes) {
+            double s = 1.0 + y.squaredNorm();
+            double w = weight / (s * s);
+            mass += w;
+            first += w * y;
+            second += w * y * y.transpose();
+        }
+    }
+    if (mass <= 0.0) return out;
+
+    constexpr double S3_VOLUME = 19.739208802178716;  // 2π²
+    out.volume = mass / S3_VOLUME;
+
+    Eigen::Vector3d mu = first / mass;
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eig(second / mass - mu * mu.transpose());
+    if (eig.info() == Eigen::Success) {
+        double max_ev = eig.eigenvalues().maxCoeff();
+        double min_ev = std::max(eig.eigenvalues().minCoeff(), 0.0);
+        out.eccentricity = max_ev > 0.0 ? 1.0 - min_ev / max_ev : 0.0;
+    }
+
+    double total = std::accumulate(face_area.begin(), face_area.end(), 0.0);
+    if (total <= 0.0) return out;
+    double distance = 0.0;
+    for (size_t j = 0; j < nbrs.size(); ++j) {
+        if (face_area[j] <= 0.0) continue;
+        distance += face_area[j] * 0.5 * std::acos(std::clamp(p.dot(sites_[nbrs[j]]), -1.0, 1.0));
+        out.faces.push_back({nbrs[j], face_area[j] / total});
+    }
+    out.mean_boundary_distance = distance / total;
+    std::sort(out.faces.begin(), out.faces.end(), [](const S3Cell::Face& a, const S3Cell::Face& b) {
+        return a.area_fraction > b.area_fraction || (a.area_fraction == b.area_fraction && a.neighbor < b.neighbor);
+    });
+    out.exact = true;
+    return out;
+}
+
+} // namespace Hartonomous::Geometry
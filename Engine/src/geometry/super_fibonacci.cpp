@@ -4,6 +4,15 @@
 #include <cmath>
 #include <cstring>
 #include <limits>
+#include <utils/thread_config.hpp>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SF_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define SF_NOINLINE __declspec(noinline)
+#else
+#define SF_NOINLINE
+#endif
 
 namespace hartonomous::geometry {
 
@@ -11,11 +20,38 @@ namespace hartonomous::geometry {
 const double SuperFibonacci::PHI = 1.61803398874989484820; // (1 + sqrt(5)) / 2
 const double SuperFibonacci::PSI = 1.32471795724474602596; // Plastic Constant
 
-SuperFibonacci::Vec4 SuperFibonacci::point_on_s3(size_t i, size_t N) {
-    if (N == 0) return Vec4::Zero();
+namespace {
+
+// Batches below this run on the calling thread
+constexpr size_t PARALLEL_MIN = 1024;
+
+// The point kernels are out of line so batch loops make the same scalar libm
+// calls as single points: a vectorized sin/cos would change the low bits of
+// positions that are already stored and hashed. spiral_point also divides
+// by N itself, since a loop would otherwise hoist 1/N under -ffast-math.
+SF_NOINLINE SuperFibonacci::Vec4 spiral_point(size_t i, size_t N);
+SF_NOINLINE SuperFibonacci::Vec4 hash_point(double t);
+
+// hash_to_point's t: the 128-bit hash folded to 64 bits, scaled to [0, 1]
+double hash_fraction(const unsigned char* hash_bytes) {
+    // 1. Deterministic Seed Extraction
+    // Collapse 128-bit hash into a 64-bit integer index.
+    // We use a mixing step to ensure all-0 and all-1 hashes don't collide.
+    uint64_t part1, part2;
+    std::memcpy(&part1, hash_bytes, sizeof(uint64_t));
+    std::memcpy(&part2, hash_bytes + sizeof(uint64_t), sizeof(uint64_t));
+
+    // FNV-style mixing or just a simple bit rotation
+    uint64_t seed = part1 ^ (part2 + 0x9e3779b9 + (part1 << 6) + (part1 >> 2));
 
+    // 2. Normalize to t \in [0, 1)
+    constexpr double NORM = 1.0 / static_cast<double>(std::numeric_limits<uint64_t>::max());
+    return static_cast<double>(seed) * NORM;
+}
+
+SuperFibonacci::Vec4 spiral_point(size_t i, size_t N) {
     // 1. Calculate normalized index t \in (0, 1)
-    // Using (i + 0.5) applies the midpoint rule, avoiding poles and 
+    // Using (i + 0.5) applies the midpoint rule, avoiding poles and
     // improving integration error convergence.
     double t = (static_cast<double>(i) + 0.5) / static_cast<double>(N);
 
@@ -29,7 +65,7 @@ SuperFibonacci::Vec4 SuperFibonacci::point_on_s3(size_t i, size_t N) {
     double radius = std::sqrt(std::max(0.0, 1.0 - s2_y * s2_y));
 
     // Longitude on S² (Golden Angle increment)
-    double theta_s2 = 2.0 * M_PI * t * PHI;
+    double theta_s2 = 2.0 * M_PI * t * SuperFibonacci::PHI;
 
     double s2_x = radius * std::cos(theta_s2);
     double s2_z = radius * std::sin(theta_s2);
@@ -37,7 +73,7 @@ SuperFibonacci::Vec4 SuperFibonacci::point_on_s3(size_t i, size_t N) {
     // 3. Generate Fiber Phase on S¹
     // We use the Plastic Constant (PSI) to decouple this rotation from the
     // Golden Ratio used on the base sphere.
-    double fiber_angle = 2.0 * M_PI * t * PSI;
+    double fiber_angle = 2.0 * M_PI * t * SuperFibonacci::PSI;
 
     // 4. Lift to S³ using the Hopf Inverse
     // We create the S² vector and pass it to the HopfFibration utility.
@@ -46,30 +82,7 @@ SuperFibonacci::Vec4 SuperFibonacci::point_on_s3(size_t i, size_t N) {
     return HopfFibration::inverse(s2_point, fiber_angle);
 }
 
-std::vector<SuperFibonacci::Vec4> SuperFibonacci::generate_points(size_t N) {
-    std::vector<Vec4> points;
-    points.reserve(N); // Pre-allocate for performance
-    for (size_t i = 0; i < N; ++i) {
-        points.push_back(point_on_s3(i, N));
-    }
-    return points;
-}
-
-SuperFibonacci::Vec4 SuperFibonacci::hash_to_point(const unsigned char* hash_bytes) {
-    // 1. Deterministic Seed Extraction
-    // Collapse 128-bit hash into a 64-bit integer index.
-    // We use a mixing step to ensure all-0 and all-1 hashes don't collide.
-    uint64_t part1, part2;
-    std::memcpy(&part1, hash_bytes, sizeof(uint64_t));
-    std::memcpy(&part2, hash_bytes + sizeof(uint64_t), sizeof(uint64_t));
-    
-    // FNV-style mixing or just a simple bit rotation
-    uint64_t seed = part1 ^ (part2 + 0x9e3779b9 + (part1 << 6) + (part1 >> 2));
-
-    // 2. Normalize to t \in [0, 1)
-    constexpr double NORM = 1.0 / static_cast<double>(std::numeric_limits<uint64_t>::max());
-    double t = static_cast<double>(seed) * NORM;
-
+SuperFibonacci::Vec4 hash_point(double t) {
     // 3. Compute S² Coordinates
     // For single-point hashing, we compute phases directly from t.
     double s2_y = 1.0 - 2.0 * t;
@@ -78,17 +91,52 @@ SuperFibonacci::Vec4 SuperFibonacci::hash_to_point(const unsigned char* hash_byt
     // Use std::fmod to keep angles within [0, 2PI) to preserve precision
     // for large indices.
     // Angle = (t * Irrational) mod 1.0 * 2PI
-    double theta_s2 = std::fmod(t * PHI, 1.0) * 2.0 * M_PI;
+    double theta_s2 = std::fmod(t * SuperFibonacci::PHI, 1.0) * 2.0 * M_PI;
     
     double s2_x = radius * std::cos(theta_s2);
     double s2_z = radius * std::sin(theta_s2);
 
     // 4. Compute Fiber Phase
-    double fiber_angle = std::fmod(t * PSI, 1.0) * 2.0 * M_PI;
+    double fiber_angle = std::fmod(t * SuperFibonacci::PSI, 1.0) * 2.0 * M_PI;
 
     // 5. Lift
     HopfFibration::Vec3 s2_point(s2_x, s2_y, s2_z);
     return HopfFibration::inverse(s2_point, fiber_angle);
 }
 
+} // namespace
+
+SuperFibonacci::Vec4 SuperFibonacci::point_on_s3(size_t i, size_t N) {
+    if (N == 0) return Vec4::Zero();
+    return spiral_point(i, N);
+}
+
+std::vector<SuperFibonacci::Vec4> SuperFibonacci::generate_points(size_t N) {
+    std::vector<Vec4> points(N);
+    points_on_s3(0, N, N, points.empty() ? nullptr : points.front().data());
+    return points;
+}
+
+SuperFibonacci::Vec4 SuperFibonacci::hash_to_point(const unsigned char* hash_bytes) {
+    return hash_point(hash_fraction(hash_bytes));
+}
+
+void SuperFibonacci::points_on_s3(size_t first, size_t count, size_t N, double* out_4d) {
+    Hartonomous::apply_thread_config();
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN)
+    for (int64_t k = 0; k < static_cast<int64_t>(count); ++k) {
+        const Vec4 p = N == 0 ? Vec4::Zero() : spiral_point(first + static_cast<size_t>(k), N);
+        std::memcpy(out_4d + 4 * k, p.data(), 4 * sizeof(double));
+    }
+}
+
+void SuperFibonacci::hash_to_points(const unsigned char* hashes, size_t count, double* out_4d) {
+    Hartonomous::apply_thread_config();
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN)
+    for (int64_t k = 0; k < static_cast<int64_t>(count); ++k) {
+        const Vec4 p = hash_point(hash_fraction(hashes + 16 * k));
+        std::memcpy(out_4d + 4 * k, p.data(), 4 * sizeof(double));
+    }
+}
+
 } // namespace hartonomous::geometry
\ No newline at end of file
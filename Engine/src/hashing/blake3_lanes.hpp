@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file blake3_lanes.hpp
+ * @brief Multi-lane BLAKE3 for equal-length messages of at most one chunk
+ *
+ * Lane i of every state vector belongs to message i; the compression is the
+ * reference one, so digests match blake3_hasher bit for bit. The lane code
+ * is instantiated by blake3_lanes_avx2.cpp and blake3_lanes_avx512.cpp, each
+ * built with its own -m flags, and BLAKE3Pipeline::hash_many_fixed picks one
+ * from simd_level(). Everything below the entry points has internal linkage,
+ * so an instantiation built for one ISA can never be linked into another.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Hartonomous::blake3_lanes {
+
+constexpr size_t CHUNK_LEN = 1024;
+constexpr size_t DIGEST_LEN = 16;
+
+// 8 (AVX2) or 16 (AVX-512) messages `stride` bytes apart, each `len` <= CHUNK_LEN bytes
+void hash8_avx2(const uint8_t* inputs, size_t stride, size_t len, uint8_t* out);
+void hash16_avx512(const uint8_t* inputs, size_t stride, size_t len, uint8_t* out);
+
+namespace {
+
+constexpr size_t BLOCK_LEN = 64;
+constexpr uint32_t CHUNK_START = 1, CHUNK_END = 2, ROOT = 8;
+constexpr uint32_t IV[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                            0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+struct MessageSchedule {
+    uint8_t word[7][16];
+    constexpr MessageSchedule() : word{} {
+        constexpr uint8_t PERMUTATION[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+        for (int i = 0; i < 16; ++i) word[0][i] = static_cast<uint8_t>(i);
+        for (int r = 1; r < 7; ++r)
+            for (int i = 0; i < 16; ++i) word[r][i] = word[r - 1][PERMUTATION[i]];
+    }
+};
+constexpr MessageSchedule SCHEDULE;
+
+
+template <class Ops, class V>
+inline void g(V* v, int a, int b, int c, int d, V mx, V my) {
+    v[a] = Ops::add(Ops::add(v[a], v[b]), mx);
+    v[d] = Ops::rot16(Ops::xor_(v[d], v[a]));
+    v[c] = Ops::add(v[c], v[d]);
+    v[b] = Ops::rot12(Ops::xor_(v[b], v[c]));
+    v[a] = Ops::add(Ops::add(v[a], v[b]), my);
+    v[d] = Ops::rot8(Ops::xor_(v[d], v[a]));
+    v[c] = Ops::add(v[c], v[d]);
+    v[b] = Ops::rot7(Ops::xor_(v[b], v[c]));
+}
+
+template <class Ops, class V>
+inline void compress_rounds(V* v, const V* m) {
+    for (int r = 0; r < 7; ++r) {
+        const uint8_t* s = SCHEDULE.word[r];
+        g<Ops>(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+        g<Ops>(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+        g<Ops>(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+        g<Ops>(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+        g<Ops>(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+        g<Ops>(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        g<Ops>(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+        g<Ops>(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+}
+
+// Hash Ops::LANES messages `stride` bytes apart, each `len` <= CHUNK_LEN bytes,
+// into DIGEST_LEN-byte digests at `out`
+template <class Ops>
+void hash_lanes(const uint8_t* inputs, size_t stride, size_t len, uint8_t* out) {
+    constexpr size_t L = Ops::LANES;
+    using V = typename Ops::V;
+    V cv[8];
+    for (int i = 0; i < 8; ++i) cv[i] = Ops::set1(IV[i]);
+
+    alignas(64) uint32_t block[L][16];
+    size_t blocks = len == 0 ? 1 : (len + BLOCK_LEN - 1) / BLOCK_LEN;
+    for (size_t b = 0; b < blocks; ++b) {
+        size_t offset = b * BLOCK_LEN;
+        size_t block_len = len - offset < BLOCK_LEN ? len - offset : BLOCK_LEN;
+        for (size_t lane = 0; lane < L; ++lane) {
+            auto* dst = reinterpret_cast<uint8_t*>(block[lane]);
+            std::memcpy(dst, inputs + lane * stride + offset, block_len);
+            std::memset(dst + block_len, 0, BLOCK_LEN - block_len);
+        }
+        V m[16];
+        Ops::load_words(block, m);
+
+        uint32_t flags = (b == 0 ? CHUNK_START : 0) | (b + 1 == blocks ? CHUNK_END | ROOT : 0);
+        V v[16] = {cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                   Ops::set1(IV[0]), Ops::set1(IV[1]), Ops::set1(IV[2]), Ops::set1(IV[3]),
+                   Ops::set1(0), Ops::set1(0), Ops::set1(static_cast<uint32_t>(block_len)), Ops::set1(flags)};
+        compress_rounds<Ops>(v, m);
+        for (int i = 0; i < 8; ++i) cv[i] = Ops::xor_(v[i], v[i + 8]);
+    }
+
+    // The 16-byte digest is the first four output words, little-endian
+    alignas(64) uint32_t words[4][L];
+    for (int w = 0; w < 4; ++w) Ops::store(words[w], cv[w]);
+    for (size_t lane = 0; lane < L; ++lane)
+        for (int w = 0; w < 4; ++w) std::memcpy(out + DIGEST_LEN * lane + 4 * w, &words[w][lane], 4);
+}
+
+} // namespace
+
+} // namespace Hartonomous::blake3_lanes
@@ -0,0 +1,62 @@
+/**
+ * @file blake3_lanes_avx2.cpp
+ * @brief AVX2 lanes for BLAKE3Pipeline::hash_many_fixed (built with AVX2 flags)
+ */
+
+#include "hashing/blake3_lanes.hpp"
+#include <immintrin.h>
+
+namespace Hartonomous::blake3_lanes {
+
+namespace {
+
+struct Avx2 {
+    static constexpr size_t LANES = 8;
+    using V = __m256i;
+    static V set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static V xor_(V a, V b) { return _mm256_xor_si256(a, b); }
+    static V rot16(V x) {
+        return _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                                      13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+    }
+    static V rot12(V x) { return _mm256_or_si256(_mm256_srli_epi32(x, 12), _mm256_slli_epi32(x, 20)); }
+    static V rot8(V x) {
+        return _mm256_shuffle_epi8(x, _mm256_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+                                                      12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1));
+    }
+    static V rot7(V x) { return _mm256_or_si256(_mm256_srli_epi32(x, 7), _mm256_slli_epi32(x, 25)); }
+    static void store(uint32_t* dst, V x) { _mm256_store_si256(reinterpret_cast<V*>(dst), x); }
+
+    // 8x8 transpose of each half of the lanes' blocks: m[w] holds word w of every lane
+    static void load_words(const uint32_t (*block)[16], V* m) {
+        for (int half = 0; half < 2; ++half) {
+            V r[8];
+            for (int l = 0; l < 8; ++l) r[l] = _mm256_load_si256(reinterpret_cast<const V*>(block[l] + 8 * half));
+            V t[8], u[8];
+            for (int p = 0; p < 4; ++p) {
+                t[2 * p] = _mm256_unpacklo_epi32(r[2 * p], r[2 * p + 1]);
+                t[2 * p + 1] = _mm256_unpackhi_epi32(r[2 * p], r[2 * p + 1]);
+            }
+            for (int q = 0; q < 2; ++q) {
+                u[4 * q + 0] = _mm256_unpacklo_epi64(t[4 * q], t[4 * q + 2]);
+                u[4 * q + 1] = _mm256_unpackhi_epi64(t[4 * q], t[4 * q + 2]);
+                u[4 * q + 2] = _mm256_unpacklo_epi64(t[4 * q + 1], t[4 * q + 3]);
+                u[4 * q + 3] = _mm256_unpackhi_epi64(t[4 * q + 1], t[4 * q + 3]);
+            }
+            V* w = m + 8 * half;
+            for (int i = 0; i < 4; ++i) {
+                w[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+                w[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+            }
+        }
+    }
+};
+
+} // namespace
+
+void hash8_avx2(const uint8_t* inputs, size_t stride, size_t len, uint8_t* out) {
+    hash_lanes<Avx2>(inputs, stride, len, out);
+}
+
+} // namespace Hartonomous::blake3_lanes
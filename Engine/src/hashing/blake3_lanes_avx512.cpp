@@ -0,0 +1,38 @@
+/**
+ * @file blake3_lanes_avx512.cpp
+ * @brief AVX-512 lanes for BLAKE3Pipeline::hash_many_fixed (built with AVX-512 flags)
+ */
+
+#include "hashing/blake3_lanes.hpp"
+#include <immintrin.h>
+
+namespace Hartonomous::blake3_lanes {
+
+namespace {
+
+struct Avx512 {
+    static constexpr size_t LANES = 16;
+    using V = __m512i;
+    static V set1(uint32_t x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+    static V add(V a, V b) { return _mm512_add_epi32(a, b); }
+    static V xor_(V a, V b) { return _mm512_xor_si512(a, b); }
+    static V rot16(V x) { return _mm512_ror_epi32(x, 16); }
+    static V rot12(V x) { return _mm512_ror_epi32(x, 12); }
+    static V rot8(V x) { return _mm512_ror_epi32(x, 8); }
+    static V rot7(V x) { return _mm512_ror_epi32(x, 7); }
+    static void store(uint32_t* dst, V x) { _mm512_store_si512(dst, x); }
+
+    static void load_words(const uint32_t (*block)[16], V* m) {
+        const V lane_offsets = _mm512_set_epi32(240, 224, 208, 192, 176, 160, 144, 128,
+                                                112, 96, 80, 64, 48, 32, 16, 0);
+        for (int w = 0; w < 16; ++w) m[w] = _mm512_i32gather_epi32(lane_offsets, block[0] + w, 4);
+    }
+};
+
+} // namespace
+
+void hash16_avx512(const uint8_t* inputs, size_t stride, size_t len, uint8_t* out) {
+    hash_lanes<Avx512>(inputs, stride, len, out);
+}
+
+} // namespace Hartonomous::blake3_lanes
@@ -4,14 +4,19 @@
  */
 
 #include <hashing/blake3_pipeline.hpp>
+#include "hashing/blake3_lanes.hpp"
+#include <utils/cpu_dispatch.hpp>
+#include <utils/thread_config.hpp>
 #include <cstring>
 #include <sstream>
 #include <iomanip>
-#include <thread>
 #include <algorithm>
+#include <unordered_map>
 
 namespace Hartonomous {
 
+using blake3_lanes::CHUNK_LEN;
+
 BLAKE3Pipeline::Hash BLAKE3Pipeline::hash(const void* data, size_t len) {
     Hash result;
 
@@ -34,41 +39,64 @@ BLAKE3Pipeline::Hash BLAKE3Pipeline::hash_codepoint(char32_t codepoint) {
     return hash(bytes, 4);
 }
 
+void BLAKE3Pipeline::hash_many_fixed(const uint8_t* inputs, size_t stride, size_t len, size_t count, Hash* out) {
+    static_assert(sizeof(Hash) == blake3_lanes::DIGEST_LEN);
+    size_t i = 0;
+#if defined(HARTONOMOUS_X86_KERNELS)
+    if (len <= CHUNK_LEN) {
+        const SimdLevel level = simd_level();
+        auto* digests = reinterpret_cast<uint8_t*>(out);
+        if (level >= SimdLevel::Avx512)
+            for (; i + 16 <= count; i += 16)
+                blake3_lanes::hash16_avx512(inputs + i * stride, stride, len, digests + i * sizeof(Hash));
+        if (level >= SimdLevel::Avx2)
+            for (; i + 8 <= count; i += 8)
+                blake3_lanes::hash8_avx2(inputs + i * stride, stride, len, digests + i * sizeof(Hash));
+    }
+#endif
+    for (; i < count; ++i) out[i] = hash(inputs + i * stride, len);
+}
+
+// Inputs of one length are packed and hashed across lanes; the rest one at a time
+static void hash_slice(const std::vector<std::string>& inputs, size_t begin, size_t end,
+                       std::vector<BLAKE3Pipeline::Hash>& results) {
+    std::unordered_map<size_t, std::vector<size_t>> by_length;
+    for (size_t i = begin; i < end; ++i) by_length[inputs[i].size()].push_back(i);
+
+    std::vector<uint8_t> packed;
+    std::vector<BLAKE3Pipeline::Hash> hashed;
+    for (const auto& [len, idx] : by_length) {
+        if (idx.size() < 8 || len > CHUNK_LEN) {
+            for (size_t i : idx) results[i] = BLAKE3Pipeline::hash(inputs[i]);
+            continue;
+        }
+        size_t stride = std::max<size_t>(len, 1);
+        packed.resize(idx.size() * stride);
+        for (size_t k = 0; k < idx.size(); ++k) std::memcpy(packed.data() + k * stride, inputs[idx[k]].data(), len);
+        hashed.resize(idx.size());
+        BLAKE3Pipeline::hash_many_fixed(packed.data(), stride, len, idx.size(), hashed.data());
+        for (size_t k = 0; k < idx.size(); ++k) results[idx[k]] = hashed[k];
+    }
+}
+
 std::vector<BLAKE3Pipeline::Hash> BLAKE3Pipeline::hash_batch(const std::vector<std::string>& inputs) {
     std::vector<Hash> results(inputs.size());
 
-    // Simple parallel processing
-    const size_t num_threads = std::min(
-        (size_t)std::thread::hardware_concurrency(),
-        inputs.size()
-    );
-
-    if (num_threads <= 1 || inputs.size() < 100) {
+    if (inputs.size() < 100) {
         // Serial for small batches
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            results[i] = hash(inputs[i]);
-        }
-    } else {
-        // Parallel for large batches
-        std::vector<std::thread> threads;
-        size_t chunk_size = (inputs.size() + num_threads - 1) / num_threads;
-
-        for (size_t t = 0; t < num_threads; ++t) {
-            size_t start = t * chunk_size;
-            size_t end = std::min(start + chunk_size, inputs.size());
-
-            if (start >= inputs.size()) break;
-
-            threads.emplace_back([&, start, end]() {
-                for (size_t i = start; i < end; ++i) {
-                    results[i] = hash(inputs[i]);
-                }
-            });
-        }
+        hash_slice(inputs, 0, inputs.size(), results);
+        return results;
+    }
 
-        for (auto& thread : threads) {
-            thread.join();
-        }
+    // One slice per engine worker thread, each grouping its own inputs by length
+    apply_thread_config();
+    const int64_t slices = static_cast<int64_t>(std::min(worker_threads(), inputs.size()));
+    const size_t chunk_size = (inputs.size() + slices - 1) / slices;
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t t = 0; t < slices; ++t) {
+        const size_t start = std::min(inputs.size(), static_cast<size_t>(t) * chunk_size);
+        const size_t end = std::min(start + chunk_size, inputs.size());
+        hash_slice(inputs, start, end, results);
     }
 
     return results;
@@ -0,0 +1,60 @@
+/**
+ * @file composition_interner.cpp
+ * @brief Sharded composition ID interning
+ */
+
+#include <hashing/composition_interner.hpp>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+CompositionInterner& CompositionInterner::global() {
+    static CompositionInterner instance;
+    return instance;
+}
+
+CompositionInterner::CompositionInterner() : chunks_(new std::atomic<Hash*>[MAX_CHUNKS]) {
+    for (size_t i = 0; i < MAX_CHUNKS; ++i) chunks_[i].store(nullptr, std::memory_order_relaxed);
+}
+
+CompositionInterner::~CompositionInterner() {
+    for (size_t i = 0; i < MAX_CHUNKS; ++i) delete[] chunks_[i].load(std::memory_order_relaxed);
+}
+
+CompositionInterner::Hash* CompositionInterner::chunk_for(uint32_t dense) {
+    auto& slot = chunks_[dense >> CHUNK_BITS];
+    if (Hash* chunk = slot.load(std::memory_order_acquire)) return chunk;
+
+    std::lock_guard<std::mutex> lock(chunk_mu_);
+    Hash* chunk = slot.load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new Hash[size_t(1) << CHUNK_BITS];
+        slot.store(chunk, std::memory_order_release);
+    }
+    return chunk;
+}
+
+uint32_t CompositionInterner::intern(const Hash& id) {
+    auto& shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    if (const uint32_t* existing = shard.map.find(id)) return *existing;
+
+    uint32_t dense = next_.fetch_add(1, std::memory_order_relaxed);
+    if (dense == NPOS) {
+        next_.store(NPOS, std::memory_order_relaxed);
+        throw std::runtime_error("CompositionInterner: more than 2^32 - 1 compositions");
+    }
+    // Published under the shard lock: whoever learns `dense` from this shard sees the hash
+    chunk_for(dense)[dense & CHUNK_MASK] = id;
+    shard.map.try_emplace(id, dense);
+    return dense;
+}
+
+uint32_t CompositionInterner::find(const Hash& id) const {
+    auto& shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    const uint32_t* existing = shard.map.find(id);
+    return existing ? *existing : NPOS;
+}
+
+} // namespace Hartonomous
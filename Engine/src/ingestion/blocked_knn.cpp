@@ -0,0 +1,107 @@
+/**
+ * @file blocked_knn.cpp
+ * @brief Tiled SGEMM scoring with per-row top-k heaps
+ */
+
+#include <ingestion/blocked_knn.hpp>
+#include <unistd.h>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace Hartonomous {
+
+static constexpr size_t QUERY_TILE = 256;
+static constexpr size_t DEFAULT_L2_BYTES = 1ULL << 20;
+
+BlockedKnnTiles blocked_knn_tiles(size_t dim, size_t l2_bytes) {
+    if (l2_bytes == 0) {
+        long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        l2_bytes = l2 > 0 ? static_cast<size_t>(l2) : DEFAULT_L2_BYTES;
+    }
+    // Half of L2 for the working set: each key row brings `dim` floats in and
+    // one score per query row out; leave the rest for the query tile and heaps.
+    size_t per_key_row = (QUERY_TILE + std::max<size_t>(dim, 1)) * sizeof(float);
+    size_t key_rows = (l2_bytes / 2) / per_key_row;
+    key_rows = std::clamp<size_t>(key_rows & ~size_t(63), 64, 4096);
+    return {QUERY_TILE, key_rows};
+}
+
+BlockedKnnResult blocked_knn(const Eigen::Ref<const Eigen::MatrixXf>& Q,
+                             const Eigen::Ref<const Eigen::MatrixXf>& K,
+                             size_t k, float threshold, bool exclude_self,
+                             BlockedKnnTiles tiles) {
+    if (Q.cols() != K.cols()) throw std::runtime_error("blocked_knn: Q and K dimensions differ");
+    const size_t nq = static_cast<size_t>(Q.rows());
+    const size_t nk = static_cast<size_t>(K.rows());
+    if (tiles.query_rows == 0 || tiles.key_rows == 0) tiles = blocked_knn_tiles(static_cast<size_t>(Q.cols()));
+
+    BlockedKnnResult out;
+    out.k = k;
+    out.count.assign(nq, 0);
+    out.index.assign(nq * k, 0);
+    out.similarity.assign(nq * k, 0.0f);
+    if (k == 0 || nq == 0 || nk == 0) return out;
+
+    using Scored = std::pair<float, uint32_t>;
+    auto worse = [](const Scored& a, const Scored& b) { return a.first > b.first; };  // Min-heap on score
+    const size_t n_tasks = (nq + tiles.query_rows - 1) / tiles.query_rows;
+
+    #pragma omp parallel
+    {
+        // S holds key rows down, query rows across: each query's scores are one contiguous column
+        Eigen::MatrixXf S;
+        std::vector<Scored> heaps(tiles.query_rows * k);
+        std::vector<size_t> sizes(tiles.query_rows);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t task = 0; task < n_tasks; ++task) {
+            const size_t r0 = task * tiles.query_rows;
+            const size_t br = std::min(tiles.query_rows, nq - r0);
+            std::fill(sizes.begin(), sizes.end(), 0);
+
+            for (size_t c0 = 0; c0 < nk; c0 += tiles.key_rows) {
+                const size_t bc = std::min(tiles.key_rows, nk - c0);
+                S.noalias() = K.middleRows(c0, bc) * Q.middleRows(r0, br).transpose();
+
+                for (size_t j = 0; j < br; ++j) {
+                    const float* col = S.col(j).data();
+                    Scored* heap = heaps.data() + j * k;
+                    size_t& hs = sizes[j];
+                    const uint32_t self = static_cast<uint32_t>(r0 + j);
+                    float floor = hs == k ? std::max(threshold, heap[0].first) : threshold;
+
+                    for (size_t t = 0; t < bc; ++t) {
+                        float s = col[t];
+                        if (s < floor) continue;
+                        uint32_t id = static_cast<uint32_t>(c0 + t);
+                        if (exclude_self && id == self) continue;
+                        if (hs < k) {
+                            heap[hs++] = {s, id};
+                            std::push_heap(heap, heap + hs, worse);
+                        } else {
+                            std::pop_heap(heap, heap + k, worse);
+                            heap[k - 1] = {s, id};
+                            std::push_heap(heap, heap + k, worse);
+                        }
+                        if (hs == k) floor = std::max(threshold, heap[0].first);
+                    }
+                }
+            }
+
+            for (size_t j = 0; j < br; ++j) {
+                Scored* heap = heaps.data() + j * k;
+                std::sort_heap(heap, heap + sizes[j], worse);  // Descending score
+                size_t row = r0 + j;
+                out.count[row] = static_cast<uint32_t>(sizes[j]);
+                for (size_t m = 0; m < sizes[j]; ++m) {
+                    out.similarity[row * k + m] = heap[m].first;
+                    out.index[row * k + m] = heap[m].second;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace Hartonomous
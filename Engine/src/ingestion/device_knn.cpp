@@ -0,0 +1,124 @@
+/**
+ * @file device_knn.cpp
+ * @brief dlopen wrapper around a knn_device_abi.h plugin
+ */
+
+#include <ingestion/device_knn.hpp>
+#include <ingestion/knn_device_abi.h>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <iostream>
+#include <stdexcept>
+
+namespace Hartonomous {
+
+static constexpr size_t ERROR_LEN = 512;
+
+struct DeviceKnn::Api {
+    int (*abi_version)();
+    int (*device_count)();
+    int (*device_name)(char*, size_t);
+    size_t (*max_k)();
+    hartonomous_knn_index* (*create)(size_t, size_t, char*, size_t);
+    int (*set_keys)(hartonomous_knn_index*, const float*, size_t, size_t, char*, size_t);
+    int (*search)(const hartonomous_knn_index*, const float*, size_t, size_t, int, size_t, float,
+                  uint32_t*, float*, uint32_t*, char*, size_t);
+    void (*destroy)(hartonomous_knn_index*);
+};
+
+template <typename Fn>
+static bool resolve(void* library, const char* symbol, Fn& fn) {
+    fn = reinterpret_cast<Fn>(::dlsym(library, symbol));
+    return fn != nullptr;
+}
+
+const DeviceKnn* DeviceKnn::get() {
+    static const std::unique_ptr<DeviceKnn> device = []() -> std::unique_ptr<DeviceKnn> {
+        const char* env = std::getenv("HARTONOMOUS_KNN_DEVICE_LIB");
+        const std::string path = env && *env ? env : "libhartonomous_knn_cuda.so";
+        if (path == "off") return nullptr;
+
+        void* library = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!library) {
+            std::cerr << "[DeviceKnn] No device plugin (" << ::dlerror() << "), using CPU KNN" << std::endl;
+            return nullptr;
+        }
+        auto api = std::make_unique<Api>();
+        const bool complete =
+            resolve(library, "hartonomous_knn_abi_version", api->abi_version) &&
+            resolve(library, "hartonomous_knn_device_count", api->device_count) &&
+            resolve(library, "hartonomous_knn_device_name", api->device_name) &&
+            resolve(library, "hartonomous_knn_max_k", api->max_k) &&
+            resolve(library, "hartonomous_knn_create", api->create) &&
+            resolve(library, "hartonomous_knn_set_keys", api->set_keys) &&
+            resolve(library, "hartonomous_knn_search", api->search) &&
+            resolve(library, "hartonomous_knn_destroy", api->destroy);
+        if (!complete || api->abi_version() != HARTONOMOUS_KNN_ABI_VERSION) {
+            std::cerr << "[DeviceKnn] " << path << " is not a compatible KNN plugin, using CPU KNN" << std::endl;
+            ::dlclose(library);
+            return nullptr;
+        }
+        if (api->device_count() <= 0) {
+            std::cerr << "[DeviceKnn] No device visible to " << path << ", using CPU KNN" << std::endl;
+            ::dlclose(library);
+            return nullptr;
+        }
+
+        std::unique_ptr<DeviceKnn> d(new DeviceKnn());
+        d->library_ = library;
+        d->max_k_ = api->max_k();
+        char name[256] = {};
+        d->name_ = api->device_name(name, sizeof(name)) == 0 ? name : "device";
+        d->api_ = std::move(api);
+        std::cout << "[DeviceKnn] " << d->name_ << " via " << path << std::endl;
+        return d;
+    }();
+    return device.get();
+}
+
+DeviceKnn::~DeviceKnn() {
+    if (library_) ::dlclose(library_);
+}
+
+std::unique_ptr<DeviceKnn::Index> DeviceKnn::create(size_t rows, size_t dim) const {
+    char err[ERROR_LEN] = {};
+    hartonomous_knn_index* handle = api_->create(rows, dim, err, sizeof(err));
+    if (!handle) throw std::runtime_error(std::string("DeviceKnn: ") + err);
+    return std::unique_ptr<Index>(new Index(*this, handle));
+}
+
+DeviceKnn::Index::~Index() {
+    owner_.api_->destroy(handle_);
+}
+
+void DeviceKnn::Index::set_keys(const float* rows, size_t first, size_t count) {
+    char err[ERROR_LEN] = {};
+    if (owner_.api_->set_keys(handle_, rows, first, count, err, sizeof(err)) != 0) {
+        throw std::runtime_error(std::string("DeviceKnn: ") + err);
+    }
+}
+
+BlockedKnnResult DeviceKnn::Index::search(const float* queries, size_t count, size_t first, bool exclude_self,
+                                          size_t k, float threshold) const {
+    BlockedKnnResult out;
+    out.k = k;
+    out.index.resize(count * k);
+    out.similarity.resize(count * k);
+    out.count.resize(count);
+    if (count == 0 || k == 0) return out;
+    char err[ERROR_LEN] = {};
+    if (owner_.api_->search(handle_, queries, count, first, exclude_self ? 1 : 0, k, threshold,
+                            out.index.data(), out.similarity.data(), out.count.data(), err, sizeof(err)) != 0) {
+        throw std::runtime_error(std::string("DeviceKnn: ") + err);
+    }
+    return out;
+}
+
+BlockedKnnResult DeviceKnn::knn(const float* Q, size_t q_rows, const float* K, size_t k_rows, size_t dim,
+                                size_t k, float threshold, bool exclude_self) const {
+    auto index = create(k_rows, dim);
+    index->set_keys(K, 0, k_rows);
+    return index->search(Q, q_rows, 0, exclude_self, k, threshold);
+}
+
+} // namespace Hartonomous
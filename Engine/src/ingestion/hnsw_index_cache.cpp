@@ -0,0 +1,239 @@
+/**
+ * @file hnsw_index_cache.cpp
+ * @brief HNSW index reuse: in-memory sharing, saveIndex persistence, disk budget
+ */
+
+#include <ingestion/hnsw_index_cache.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Hartonomous {
+
+namespace fs = std::filesystem;
+
+// Rows sampled per digest; enough that two distinct projections of the same
+// vocabulary never agree on every sampled row
+static constexpr size_t DIGEST_SAMPLE_ROWS = 4096;
+
+// Bumped when what a cached file means changes (encoding, point layout)
+static constexpr uint8_t KEY_VERSION = 2;
+
+// Candidates fetched per wanted neighbor before a float re-rank
+static constexpr size_t RERANK_OVERSAMPLE = 3;
+
+// Level 0 (every point's vector and base links) is most of an index, and every
+// mining thread walks it at random: huge pages, spread over the nodes
+static void place_level0(const HnswIndexCache::Index& index) {
+    const size_t bytes = index.max_elements_ * index.size_data_per_element_;
+    advise_huge_pages(index.data_level0_memory_, bytes);
+    numa_interleave(index.data_level0_memory_, bytes);
+}
+
+HugePageUsage HnswIndexCache::Entry::huge_page_usage() const {
+    return Hartonomous::huge_page_usage(index->data_level0_memory_, index->max_elements_ * index->size_data_per_element_);
+}
+
+void HnswIndexCache::Entry::add_point(const float* v, size_t label) {
+    if (!quantized()) return index->addPoint(v, label);
+    thread_local std::vector<char> buf;
+    buf.resize(space->get_data_size());
+    space->encode(v, buf.data());
+    index->addPoint(buf.data(), label);
+}
+
+std::priority_queue<std::pair<float, size_t>> HnswIndexCache::Entry::search(const float* q, size_t k) const {
+    if (!quantized()) return index->searchKnn(q, k);
+    thread_local std::vector<char> buf;
+    buf.resize(space->get_data_size());
+    space->encode(q, buf.data());
+    return index->searchKnn(buf.data(), k);
+}
+
+void HnswIndexCache::Entry::neighbors(const float* q, size_t k, const float* keys,
+                                      std::vector<std::pair<size_t, float>>& out) const {
+    out.clear();
+    const bool rerank = keys && quantized();
+    auto result = search(q, rerank ? k * RERANK_OVERSAMPLE : k);
+    out.reserve(result.size());
+    const size_t dim = space->dim();
+    for (; !result.empty(); result.pop()) {
+        size_t j = result.top().second;
+        float sim = 1.0f - result.top().first;
+        if (rerank) {
+            const float* row = keys + j * dim;
+            sim = 0.0f;
+            for (size_t d = 0; d < dim; ++d) sim += q[d] * row[d];
+        }
+        out.emplace_back(j, sim);
+    }
+    if (rerank && out.size() > k) {
+        std::partial_sort(out.begin(), out.begin() + k, out.end(),
+                          [](const auto& a, const auto& b) { return a.second > b.second; });
+        out.resize(k);
+    }
+}
+
+HnswIndexCache::Options HnswIndexCache::Options::from_env() {
+    Options o;
+    if (const char* v = std::getenv("HARTONOMOUS_HNSW_CACHE"))
+        o.dir = (std::strcmp(v, "off") == 0) ? "" : v;
+    if (const char* v = std::getenv("HARTONOMOUS_HNSW_CACHE_GB"))
+        o.max_disk_bytes = static_cast<uint64_t>(std::max(0.0, std::strtod(v, nullptr)) * (1ULL << 30));
+    return o;
+}
+
+std::string HnswIndexCache::default_dir() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/hnsw";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/hnsw";
+    return "";
+}
+
+HnswIndexCache::HnswIndexCache(Options opts) : opts_(std::move(opts)) {}
+
+HnswIndexCache::Hash HnswIndexCache::digest(const float* data, size_t rows, size_t cols, const Hash& seed) {
+    size_t stride = std::max<size_t>(1, rows / DIGEST_SAMPLE_ROWS);
+    std::vector<float> buf;
+    buf.reserve((rows / stride + 1) * cols);
+    for (size_t r = 0; r < rows; r += stride)
+        for (size_t c = 0; c < cols; ++c) buf.push_back(data[r + c * rows]);
+
+    std::vector<uint8_t> bytes(seed.size() + 2 * sizeof(uint64_t) + buf.size() * sizeof(float));
+    uint64_t dims[2] = {rows, cols};
+    std::memcpy(bytes.data(), seed.data(), seed.size());
+    std::memcpy(bytes.data() + seed.size(), dims, sizeof(dims));
+    std::memcpy(bytes.data() + seed.size() + sizeof(dims), buf.data(), buf.size() * sizeof(float));
+    return BLAKE3Pipeline::hash(bytes);
+}
+
+HnswIndexCache::Hash HnswIndexCache::key_id(const Key& key) {
+    std::vector<uint8_t> bytes{KEY_VERSION, static_cast<uint8_t>(key.params.quantization)};
+    bytes.insert(bytes.end(), key.model_id.begin(), key.model_id.end());
+    bytes.insert(bytes.end(), key.tensor.begin(), key.tensor.end());
+    bytes.push_back(0);
+    uint64_t shape[4] = {key.params.M, key.params.ef_construction, key.rows, key.dim};
+    auto* p = reinterpret_cast<const uint8_t*>(shape);
+    bytes.insert(bytes.end(), p, p + sizeof(shape));
+    bytes.insert(bytes.end(), key.content.begin(), key.content.end());
+    return BLAKE3Pipeline::hash(bytes);
+}
+
+std::string HnswIndexCache::path_for(const Key& key) const {
+    if (opts_.dir.empty()) return "";
+    return opts_.dir + "/" + BLAKE3Pipeline::to_hex(key_id(key)) + ".hnsw";
+}
+
+std::shared_ptr<HnswIndexCache::Entry> HnswIndexCache::acquire(const Key& key,
+                                                               const std::function<void(Entry&)>& fill) {
+    Hash id = key_id(key);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = live_.find(id); it != live_.end()) {
+            if (auto hit = it->second.lock()) {
+                ++stats_.reused;
+                if (opts_.keep_resident) resident_ = hit;
+                return hit;
+            }
+        }
+        resident_.reset();
+        for (auto it = live_.begin(); it != live_.end();) {
+            if (it->second.expired()) it = live_.erase(it); else ++it;
+        }
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->space = std::make_unique<QuantizedIPSpace>(key.dim, key.params.quantization);
+
+    std::string path = path_for(key);
+    std::error_code ec;
+    if (!path.empty() && fs::exists(path, ec)) {
+        try {
+            entry->index = std::make_unique<Index>(entry->space.get(), path);
+            if (entry->index->getCurrentElementCount() != key.rows) entry->index.reset();
+        } catch (const std::exception& e) {
+            std::cerr << "    HNSW cache: ignoring unreadable " << path << ": " << e.what() << std::endl;
+            entry->index.reset();
+        }
+        if (entry->index) {
+            entry->from_disk = true;
+            place_level0(*entry->index);
+            fs::last_write_time(path, fs::file_time_type::clock::now(), ec);  // Recency for trim_disk
+        } else {
+            fs::remove(path, ec);
+        }
+    }
+
+    if (!entry->index) {
+        entry->index = std::make_unique<Index>(entry->space.get(), key.rows,
+                                               key.params.M, key.params.ef_construction);
+        place_level0(*entry->index);   // Before fill, so pages fault in already spread
+        fill(*entry);
+        if (!path.empty()) save(*entry->index, path);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++(entry->from_disk ? stats_.loaded : stats_.built);
+    live_[id] = entry;
+    if (opts_.keep_resident) resident_ = entry;
+    return entry;
+}
+
+void HnswIndexCache::release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    resident_.reset();
+}
+
+void HnswIndexCache::save(Index& index, const std::string& path) {
+    // Persistence is an optimization: a failed write costs a rebuild next run, never the ingest
+    std::error_code ec;
+    fs::create_directories(opts_.dir, ec);
+    // Per-thread temporary, in case two threads ever build the same key
+    std::ostringstream tmp_name;
+    tmp_name << path << "." << std::this_thread::get_id() << ".tmp";
+    std::string tmp = tmp_name.str();
+    try {
+        index.saveIndex(tmp);
+        fs::rename(tmp, path);
+    } catch (const std::exception& e) {
+        std::cerr << "    HNSW cache: could not save " << path << ": " << e.what() << std::endl;
+        fs::remove(tmp, ec);
+        return;
+    }
+    trim_disk();
+}
+
+void HnswIndexCache::trim_disk() {
+    struct File {
+        fs::path path;
+        fs::file_time_type mtime;
+        uint64_t bytes;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(opts_.dir, ec)) {
+        if (de.path().extension() != ".hnsw") continue;
+        File f{de.path(), de.last_write_time(ec), de.file_size(ec)};
+        if (ec) continue;
+        total += f.bytes;
+        files.push_back(std::move(f));
+    }
+    if (total <= opts_.max_disk_bytes) return;
+
+    // Oldest first; the file just written is newest, so it goes last (and only if alone over budget)
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.mtime < b.mtime; });
+    for (const auto& f : files) {
+        if (total <= opts_.max_disk_bytes) break;
+        if (fs::remove(f.path, ec)) total -= f.bytes;
+    }
+}
+
+} // namespace Hartonomous
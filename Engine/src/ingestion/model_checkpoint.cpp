@@ -0,0 +1,129 @@
+/**
+ * @file model_checkpoint.cpp
+ * @brief Model ingest manifest: load, promote flushed units, atomic rewrite
+ */
+
+#include <ingestion/model_checkpoint.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Hartonomous {
+
+namespace fs = std::filesystem;
+
+// Bumped when what a recorded unit means changes
+static constexpr int MANIFEST_VERSION = 1;
+
+ModelCheckpoint::Options ModelCheckpoint::Options::from_env() {
+    Options o;
+    if (const char* v = std::getenv("HARTONOMOUS_MODEL_CHECKPOINT"))
+        o.dir = (std::strcmp(v, "off") == 0) ? "" : v;
+    return o;
+}
+
+std::string ModelCheckpoint::default_dir() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/checkpoints";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/checkpoints";
+    return "";
+}
+
+void ModelCheckpoint::open(const Options& opts, const Hash& model, const Hash& fingerprint) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_.clear();
+    pending_.clear();
+    fingerprint_ = fingerprint;
+    path_ = opts.dir.empty() ? "" : opts.dir + "/" + BLAKE3Pipeline::to_hex(model) + ".json";
+    if (path_.empty() || !fs::exists(path_)) return;
+
+    // An unreadable or stale manifest only costs the work it would have skipped
+    try {
+        std::ifstream in(path_);
+        auto j = nlohmann::json::parse(in);
+        if (j.value("version", 0) != MANIFEST_VERSION ||
+            j.value("fingerprint", std::string()) != BLAKE3Pipeline::to_hex(fingerprint_)) {
+            std::cout << "  Checkpoint " << path_ << " is for a different package or settings; starting over"
+                      << std::endl;
+            return;
+        }
+        for (const auto& unit : j.at("done")) done_.insert(unit.get<std::string>());
+    } catch (const std::exception& e) {
+        std::cerr << "  [ModelCheckpoint] could not read " << path_ << ": " << e.what() << std::endl;
+        done_.clear();
+    }
+}
+
+bool ModelCheckpoint::done(const std::string& unit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return done_.count(unit) != 0;
+}
+
+size_t ModelCheckpoint::done_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return done_.size();
+}
+
+void ModelCheckpoint::complete(const std::string& unit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled() || !done_.insert(unit).second) return;
+    save();
+}
+
+void ModelCheckpoint::mined(const std::string& unit, uint64_t last_batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled()) pending_.emplace_back(unit, last_batch);
+}
+
+void ModelCheckpoint::flushed(uint64_t flushed_through) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::stable_partition(pending_.begin(), pending_.end(),
+                                    [&](const auto& p) { return p.second > flushed_through; });
+    if (it == pending_.end()) return;
+    for (auto p = it; p != pending_.end(); ++p) done_.insert(p->first);
+    pending_.erase(it, pending_.end());
+    save();
+}
+
+bool ModelCheckpoint::settled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.empty();
+}
+
+void ModelCheckpoint::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_.clear();
+    pending_.clear();
+    if (path_.empty()) return;
+    std::error_code ec;
+    fs::remove(path_, ec);
+}
+
+void ModelCheckpoint::save() {
+    // Checkpoints are an optimization: a failed write costs a longer resume, never the ingest
+    std::error_code ec;
+    fs::create_directories(fs::path(path_).parent_path(), ec);
+    nlohmann::json j;
+    j["version"] = MANIFEST_VERSION;
+    j["fingerprint"] = BLAKE3Pipeline::to_hex(fingerprint_);
+    j["done"] = done_;
+    const std::string tmp = path_ + ".tmp";
+    try {
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out << j.dump(1) << '\n';
+            if (!out) throw std::runtime_error("write failed");
+        }
+        fs::rename(tmp, path_);
+    } catch (const std::exception& e) {
+        std::cerr << "  [ModelCheckpoint] could not save " << path_ << ": " << e.what() << std::endl;
+        fs::remove(tmp, ec);
+    }
+}
+
+} // namespace Hartonomous
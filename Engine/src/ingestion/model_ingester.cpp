@@ -6,9 +6,17 @@
 #include <storage/composition_store.hpp>
 #include <storage/relation_store.hpp>
 #include <storage/relation_evidence_store.hpp>
+#include <storage/composition_adjacency.hpp>
 #include <storage/content_store.hpp>
+#include <ingestion/async_flusher.hpp>
+#include <ingestion/device_knn.hpp>
+#include <ingestion/relation_edge.hpp>
+#include <geometry/s3_centroid.hpp>
 #include <ml/model_extraction.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
+#include <utils/ingest_report.hpp>
+#include <utils/substrate_epoch.hpp>
+#include <utils/thread_config.hpp>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -17,6 +25,11 @@
 #include <numeric>
 #include <atomic>
 #include <chrono>
+#include <exception>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
 #include <omp.h>
 #include <hnswlib/hnswlib.h>
 
@@ -35,12 +48,36 @@ static double ms_since(Clock::time_point t0) {
 // Streaming threshold: use block-streaming when projected matrix exceeds this
 static constexpr size_t STREAMING_THRESHOLD_BYTES = 2ULL * 1024 * 1024 * 1024;
 static constexpr size_t STREAMING_BLOCK_SIZE = 8192;
-static constexpr size_t FLUSH_THRESHOLD = 500000;
+static constexpr size_t PROCEDURAL_K = 16;  // Neighbors searched per token in weight-projection passes
 
-static size_t count_pending_relations(const std::vector<ThreadLocalRecords>& records) {
-    size_t total = 0;
-    for (const auto& tl : records) total += tl.relations_created;
-    return total;
+// HNSW reads each point as `dim` contiguous floats, so vectors handed to an
+// index are kept in row-major matrices
+using RowMatrixXf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// The GPU of a KnnBackend::Device run, or nullptr: another backend, no device, or k past its limit
+static const DeviceKnn* mining_device(const ModelIngestionConfig& c, size_t k) {
+    if (c.knn_backend != KnnBackend::Device) return nullptr;
+    const DeviceKnn* device = DeviceKnn::get();
+    return device && k <= device->max_k() ? device : nullptr;
+}
+
+// Top-k of every row of Q among K on the device, never row i for row i;
+// false after a warning (device out of memory, say) so the caller uses HNSW
+static bool device_search(const DeviceKnn* device, const RowMatrixXf& Q, const RowMatrixXf& K, size_t k,
+                          float threshold, BlockedKnnResult& out) {
+    if (!device) return false;
+    try {
+        out = device->knn(Q.data(), Q.rows(), K.data(), K.rows(), K.cols(), k, threshold, true);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "\n    " << e.what() << "; falling back to HNSW" << std::endl;
+        return false;
+    }
+}
+
+// Half of each thread's worst case (every row keeping all k neighbors)
+static size_t expected_edges_per_thread(size_t n, size_t k, int num_threads) {
+    return (n + num_threads - 1) / num_threads * k / 2;
 }
 
 // Flush records to DB in a single transaction
@@ -49,10 +86,14 @@ static void flush_records(
     std::vector<ThreadLocalRecords>& locals,
     size_t& total_relations)
 {
-    size_t n_created = 0;
-    for (auto& tl : locals) n_created += tl.relations_created;
-    if (n_created == 0) {
-        std::cout << "    (no new relations)" << std::endl;
+    size_t n_created = 0, n_rated = 0;
+    for (auto& tl : locals) {
+        n_created += tl.relations_created;
+        n_rated += tl.rating.size();
+    }
+    // Relations another pass emitted still take this pass's ratings and evidence
+    if (n_rated == 0) {
+        std::cout << "    (no relations)" << std::endl;
         return;
     }
 
@@ -84,26 +125,196 @@ static void flush_records(
         for (auto& tl : locals) for (auto& r : tl.ev) store.store(r);
         store.flush();
     }
+    if (CompositionAdjacency::enabled(db)) {
+        std::vector<BLAKE3Pipeline::Hash> touched;
+        for (auto& tl : locals) for (auto& r : tl.rating) touched.push_back(r.relation_id);
+        CompositionAdjacency::refresh(db, touched);
+    }
 
     txn.commit();
+    SubstrateEpoch::advance();  // Cached answers predate these relations
     total_relations += n_created;
 
-    std::cout << "    Flushed " << n_created << " relations in "
+    std::cout << "    Flushed " << n_created << " new relations, " << n_rated << " ratings in "
               << std::fixed << std::setprecision(0) << ms_since(t0) << "ms" << std::endl;
 }
 
-// Helper to convert TensorData to Eigen Matrix
+// Helper to convert TensorData to Eigen Matrix (converts straight from the mapping)
 static Eigen::MatrixXf tensor_to_matrix(const TensorData* t) {
     if (!t || t->shape.size() != 2) return Eigen::MatrixXf(0, 0);
     size_t rows = t->shape[0];
     size_t cols = t->shape[1];
     Eigen::MatrixXf mat(rows, cols);
-    std::memcpy(mat.data(), t->data.data(), rows * cols * sizeof(float));
+    t->read_all(mat.data());
     return mat;
 }
 
+// Passes of attention layer i, each paired with its tensor one layer back
+static std::vector<ProjectionPass> attention_passes(const std::vector<AttentionLayer>& layers, size_t i,
+                                                    const ModelIngestionConfig& c) {
+    const auto& l = layers[i];
+    const AttentionLayer* prev = (i > 0) ? &layers[i - 1] : nullptr;
+    std::vector<ProjectionPass> passes;
+    // Q*K: "who attends to whom" (asymmetric)
+    if (l.q_weight && l.k_weight)
+        passes.push_back({l.k_weight, l.q_weight, prev ? prev->k_weight : nullptr, prev ? prev->q_weight : nullptr,
+                          "Q*K", "attention_qk", 1600.0, &c.hnsw_asymmetric, false});
+    // V: "what information each token offers when attended to" (self-sim)
+    if (l.v_weight)
+        passes.push_back({l.v_weight, nullptr, prev ? prev->v_weight : nullptr, nullptr,
+                          "V", "attention_value", 1650.0, &c.hnsw_self_sim, false});
+    // O: "how head outputs combine" (self-sim)
+    if (l.o_weight)
+        passes.push_back({l.o_weight, nullptr, prev ? prev->o_weight : nullptr, nullptr,
+                          "O", "attention_output", 1550.0, &c.hnsw_self_sim, false});
+    return passes;
+}
+
+static std::vector<ProjectionPass> ffn_passes(const std::vector<FFNLayer>& layers, size_t i,
+                                              const ModelIngestionConfig& c) {
+    const auto& l = layers[i];
+    const FFNLayer* prev = (i > 0) ? &layers[i - 1] : nullptr;
+    std::vector<ProjectionPass> passes;
+    // Gate: sigmoid activation - "which features pass through" (self-sim)
+    if (l.gate_weight)
+        passes.push_back({l.gate_weight, nullptr, prev ? prev->gate_weight : nullptr, nullptr,
+                          "gate", "ffn_gate", 1800.0, &c.hnsw_self_sim, true});
+    // Up: expansion - "what features get amplified" (self-sim)
+    if (l.up_weight)
+        passes.push_back({l.up_weight, nullptr, prev ? prev->up_weight : nullptr, nullptr,
+                          "up", "ffn_expand", 1750.0, &c.hnsw_self_sim, false});
+    // Down: compression - "what features survive projection back" (self-sim)
+    if (l.down_weight)
+        passes.push_back({l.down_weight, nullptr, prev ? prev->down_weight : nullptr, nullptr,
+                          "down", "ffn_compress", 1700.0, &c.hnsw_self_sim, false});
+    return passes;
+}
+
+// Bytes of the larger projection a pass materializes
+static size_t projection_bytes(const ProjectionPass& p, size_t n) {
+    size_t dim = p.weight->shape[0];
+    if (p.query_weight) dim = std::max(dim, p.query_weight->shape[0]);
+    return n * dim * sizeof(float);
+}
+
+// HNSW construction stops scaling at about this many threads, so one pass
+// never takes more; the rest of the cores mine other passes meanwhile
+static constexpr int MAX_PASS_THREADS = 16;
+static constexpr size_t PASS_ELEMENTS_PER_THREAD = 1ULL << 22;
+
+// Threads for a pass, in proportion to the projection it searches
+static int pass_threads(const ProjectionPass& p, size_t n, int max_threads) {
+    size_t work = projection_bytes(p, n) / sizeof(float);
+    size_t threads = (work + PASS_ELEMENTS_PER_THREAD - 1) / PASS_ELEMENTS_PER_THREAD;
+    return static_cast<int>(std::clamp<size_t>(threads, 1, std::min(MAX_PASS_THREADS, max_threads)));
+}
+
+// Three quarters of physical memory when no budget is configured
+static size_t default_memory_budget() {
+    long pages = ::sysconf(_SC_PHYS_PAGES);
+    long page = ::sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || page <= 0) return 16ULL << 30;
+    return static_cast<size_t>(pages) * static_cast<size_t>(page) / 4 * 3;
+}
+
+// Memory model for the layer scheduler. Estimates err high: a layer that
+// fits on paper must fit in practice.
+static constexpr size_t RECORD_BYTES_PER_EDGE = 512;   // Physicality, relation, sequence, evidence, rating, dedup sets
+static constexpr size_t QUEUED_RECORD_BYTES = 160;     // Average SubstrateBatch record waiting in the flusher
+static constexpr size_t TOKEN_STATE_BYTES = 192;       // token_to_comp and comp_centroids_ per token
+
+static size_t hnsw_graph_bytes(size_t n, size_t dim, const HnswParams& p) {
+    QuantizedIPSpace space(dim, p.quantization);
+    // Level-0 links (2M) and label, plus per-element lock, level and upper-layer links
+    return n * (space.get_data_size() + (2 * p.M + 1) * sizeof(uint32_t) + sizeof(size_t) + 64 + p.M * sizeof(uint32_t));
+}
+
+// Peak bytes while a pass runs: weights, projections and normalized copies
+// (or one streamed block), the graph, and the records it emits
+static size_t pass_peak_bytes(const ProjectionPass& p, size_t n, size_t in_dim, bool stream) {
+    size_t dim = p.weight->shape[0];
+    size_t bytes = dim * in_dim * sizeof(float) + hnsw_graph_bytes(n, dim, *p.params) +
+                   n * PROCEDURAL_K * RECORD_BYTES_PER_EDGE;
+    if (stream) return bytes + STREAMING_BLOCK_SIZE * dim * sizeof(float);
+    bytes += 2 * n * dim * sizeof(float);  // Projection and its row-major normalized copy
+    if (p.query_weight) {
+        size_t qdim = p.query_weight->shape[0];
+        bytes += qdim * in_dim * sizeof(float) + 2 * n * qdim * sizeof(float);
+    }
+    return bytes;
+}
+
+static std::unique_ptr<SubstrateBatch> to_batch(ThreadLocalRecords& tl) {
+    auto batch = std::make_unique<SubstrateBatch>();
+    batch->phys = std::move(tl.phys);
+    batch->rel = std::move(tl.rel);
+    batch->rel_seq = std::move(tl.rel_seq);
+    batch->rating = std::move(tl.rating);
+    batch->evidence = std::move(tl.ev);
+    return batch;
+}
+
+// Every pass indexes its own tensor and the scheduler budgets each graph to
+// the pass that built it, so none is kept resident after its pass
+static HnswIndexCache::Options cache_options(const ModelIngestionConfig& config) {
+    auto opts = config.hnsw_cache;
+    opts.keep_resident = false;
+    return opts;
+}
+
+// The settings that shape what a pass mines from its tensors
+static void mining_settings(std::ostream& key, const ModelIngestionConfig& c) {
+    key << c.embedding_similarity_threshold << ' ' << c.max_neighbors_per_token << ' '
+        << static_cast<int>(c.knn_backend);
+    for (const auto* p : {&c.hnsw_embedding, &c.hnsw_self_sim, &c.hnsw_asymmetric})
+        key << ' ' << p->M << ' ' << p->ef_construction << ' ' << p->ef_search << ' '
+            << static_cast<int>(p->quantization);
+}
+
+// Everything a checkpointed unit's output depends on besides the model ID:
+// the package files as they are on disk and the settings that shape mining
+static BLAKE3Pipeline::Hash package_fingerprint(const std::filesystem::path& dir, const ModelIngestionConfig& c) {
+    namespace fs = std::filesystem;
+    std::ostringstream key;
+    std::error_code ec;
+    key << fs::weakly_canonical(dir, ec).string() << '\n';
+    std::vector<fs::path> files;
+    for (const auto& e : fs::directory_iterator(dir, ec))
+        if (e.is_regular_file(ec)) files.push_back(e.path());
+    std::sort(files.begin(), files.end());
+    for (const auto& f : files)
+        key << f.filename().string() << ' ' << fs::file_size(f, ec) << ' '
+            << fs::last_write_time(f, ec).time_since_epoch().count() << '\n';
+    mining_settings(key, c);
+    return BLAKE3Pipeline::hash(key.str());
+}
+
+// What a layer pass's relations depend on besides its tensors: the vocab they
+// connect, the embeddings streamed projections go through and the settings.
+// Models that share these share mined tensors (tensor_dedup.hpp).
+static BLAKE3Pipeline::Hash mining_context(const std::vector<std::string>& vocab,
+                                           const BLAKE3Pipeline::Hash& embedding_digest,
+                                           const ModelIngestionConfig& c) {
+    std::string tokens;
+    for (const auto& t : vocab) {
+        tokens += t;
+        tokens += '\0';
+    }
+    const auto vocab_digest = BLAKE3Pipeline::hash(tokens);
+    std::ostringstream key;
+    key.write(reinterpret_cast<const char*>(vocab_digest.data()), vocab_digest.size());
+    key.write(reinterpret_cast<const char*>(embedding_digest.data()), embedding_digest.size());
+    mining_settings(key, c);
+    return BLAKE3Pipeline::hash(key.str());
+}
+
+// Checkpoint unit of a layer pass: the indexed tensor and what the pass mines from it
+static std::string pass_unit(const ProjectionPass& p) {
+    return p.weight->name + "#" + p.type_tag;
+}
+
 ModelIngester::ModelIngester(PostgresConnection& db, const ModelIngestionConfig& config)
-    : db_(db), config_(config) {
+    : db_(db), config_(config), hnsw_cache_(cache_options(config_)), dedup_(db_, config_.tensor_dedup) {
     std::vector<uint8_t> id_data;
     id_data.push_back(0x4D);
     id_data.insert(id_data.end(), config_.tenant_id.begin(), config_.tenant_id.end());
@@ -112,7 +323,9 @@ ModelIngester::ModelIngester(PostgresConnection& db, const ModelIngestionConfig&
 }
 
 ModelIngestionStats ModelIngester::ingest_package(const std::filesystem::path& package_dir) {
+    apply_thread_config();
     ModelIngestionStats stats;
+    relations_emitted_.clear();
     auto t_pipeline = Clock::now();
     try {
         SafetensorLoader loader(package_dir.string());
@@ -121,6 +334,10 @@ ModelIngestionStats ModelIngester::ingest_package(const std::filesystem::path& p
         std::cout << "Ingesting model: " << metadata.model_name << " (" << stats.vocab_tokens << " tokens)" << std::endl;
         std::cout << "  Content ID: " << hash_to_uuid(model_id_) << std::endl;
 
+        checkpoint_.open(config_.checkpoint, model_id_, package_fingerprint(package_dir, config_));
+        if (size_t done = checkpoint_.done_count())
+            std::cout << "  Resuming: " << done << " units already ingested (" << checkpoint_.path() << ")" << std::endl;
+
         // 1. Provenance
         try {
             PostgresConnection::Transaction txn(db_);
@@ -135,348 +352,59 @@ ModelIngestionStats ModelIngester::ingest_package(const std::filesystem::path& p
 
         // 2. Vocab -> Compositions
         auto t0 = Clock::now();
-        auto token_to_comp = ingest_vocab_as_text(metadata.vocab, stats);
+        size_t vocab_bytes = 0;
+        for (const auto& token : metadata.vocab) vocab_bytes += token.size();
+        if (progress_) progress_->phase("vocab", vocab_bytes);
+        auto token_to_comp = ingest_vocab_as_text(metadata.vocab, stats, !checkpoint_.done("vocab"));
+        checkpoint_.complete("vocab");
+        if (progress_) progress_->advance(vocab_bytes, stats.compositions_created);
+        IngestReport::global().phase("vocab", ms_since(t0));
         std::cout << "  Phase 1 (vocab): " << std::fixed << std::setprecision(0)
                   << ms_since(t0) << "ms | " << stats.compositions_created << " compositions" << std::endl;
 
         auto embeddings = loader.get_embeddings();
         if (embeddings.rows() == 0) {
             std::cerr << "  Error: No embeddings found in model. Aborting." << std::endl;
+            if (progress_) progress_->finish();
             return stats;
         }
         
         // Normalize embeddings once for all passes
         Eigen::MatrixXf norm_embeddings = embeddings.topRows(std::min(metadata.vocab.size(), (size_t)embeddings.rows()));
         norm_embeddings.rowwise().normalize();
+        embeddings.resize(0, 0);  // Only the normalized copy is used from here on
+        embedding_digest_ = HnswIndexCache::digest(norm_embeddings.data(), norm_embeddings.rows(), norm_embeddings.cols());
+        dedup_.load(mining_context(metadata.vocab, embedding_digest_, config_));
 
         // 3. Static Embedding Pass (Baseline Similarity)
         auto t1 = Clock::now();
-        extract_embedding_edges(metadata.vocab, norm_embeddings, token_to_comp, stats);
+        const size_t embedding_bytes = static_cast<size_t>(norm_embeddings.size()) * sizeof(float);
+        const size_t relations_before = stats.relations_created;
+        if (progress_) progress_->phase("embedding_knn", embedding_bytes);
+        if (checkpoint_.done("embedding")) {
+            std::cout << "    (embedding relations already ingested)" << std::endl;
+        } else {
+            extract_embedding_edges(metadata.vocab, norm_embeddings, token_to_comp, stats);
+            checkpoint_.complete("embedding");
+        }
+        if (progress_) progress_->advance(embedding_bytes, stats.relations_created - relations_before);
+        IngestReport::global().phase("embedding_knn", ms_since(t1));
         std::cout << "  Phase 2 (embedding KNN): " << ms_since(t1) << "ms" << std::endl;
 
-        // Batched record accumulator for all procedural passes
-        std::vector<ThreadLocalRecords> pending_records;
-        size_t pending_count = 0;
-
-        auto maybe_flush_pending = [&]() {
-            size_t cnt = count_pending_relations(pending_records);
-            if (cnt >= FLUSH_THRESHOLD) {
-                std::cout << "    [batch flush: " << cnt << " pending relations]" << std::endl;
-                flush_records(db_, pending_records, stats.relations_created);
-                pending_records.clear();
-                pending_count = 0;
-            } else {
-                pending_count = cnt;
-            }
-        };
-
-        // 4. Procedural Pass: Attention Mining (Functional Relationships)
+        // 4-5. Procedural Passes: Attention (functional) and FFN (logical categories) mining
         auto attn_layers = loader.get_attention_layers();
         auto ffn_layers = loader.get_ffn_layers();
-
-        // Pre-allocate projection workspaces based on max dims across all layers
-        size_t max_proj_dim = 0;
-        for (const auto& l : attn_layers) {
-            if (l.q_weight && l.q_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.q_weight->shape[0]);
-            if (l.k_weight && l.k_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.k_weight->shape[0]);
-            if (l.v_weight && l.v_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.v_weight->shape[0]);
-            if (l.o_weight && l.o_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.o_weight->shape[0]);
-        }
-        for (const auto& l : ffn_layers) {
-            if (l.gate_weight && l.gate_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.gate_weight->shape[0]);
-            if (l.up_weight && l.up_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.up_weight->shape[0]);
-            if (l.down_weight && l.down_weight->shape.size() == 2) max_proj_dim = std::max(max_proj_dim, l.down_weight->shape[0]);
-        }
-
-        size_t n_tokens = norm_embeddings.rows();
-        bool use_workspaces = (max_proj_dim > 0 &&
-            n_tokens * max_proj_dim * sizeof(float) <= STREAMING_THRESHOLD_BYTES);
-
-        if (use_workspaces && max_proj_dim > 0) {
-            proj_workspace_a_.resize(n_tokens, max_proj_dim);
-            proj_workspace_b_.resize(n_tokens, max_proj_dim);
-            std::cout << "  Pre-allocated workspaces: 2x(" << n_tokens << "x" << max_proj_dim
-                      << ") = " << (2 * n_tokens * max_proj_dim * sizeof(float) / (1024*1024)) << "MB" << std::endl;
-        }
-
         bool use_layer_sim = (attn_layers.size() >= 40 || ffn_layers.size() >= 40);
-
-        if (!attn_layers.empty()) {
-            int total_attn = static_cast<int>(attn_layers.size());
-            std::cout << "  Phase 3: Mining " << total_attn << " Attention layers (Q*K, V, O)..." << std::endl;
-            auto t2 = Clock::now();
-            for (size_t i = 0; i < attn_layers.size(); i++) {
-                const auto& layer = attn_layers[i];
-                std::cout << "    Attention Layer " << layer.layer_index << "/" << total_attn << "..." << std::flush;
-                auto t_layer = Clock::now();
-
-                // Q*K: "who attends to whom" (asymmetric)
-                if (layer.q_weight && layer.k_weight) {
-                    bool skip_qk = false;
-                    if (use_layer_sim && i > 0 && attn_layers[i-1].q_weight && attn_layers[i-1].k_weight) {
-                        double sim_q = weight_similarity(layer.q_weight, attn_layers[i-1].q_weight);
-                        double sim_k = weight_similarity(layer.k_weight, attn_layers[i-1].k_weight);
-                        if (sim_q > 0.98 && sim_k > 0.98) {
-                            std::cout << " (skip Q*K, 98%+ similar to L" << i-1 << ")" << std::flush;
-                            skip_qk = true;
-                        }
-                    }
-                    if (!skip_qk) {
-                        size_t qdim = layer.q_weight->shape[0];
-                        size_t kdim = layer.k_weight->shape[0];
-                        size_t proj_bytes = n_tokens * std::max(qdim, kdim) * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            // Too large for materialization - but Q*K is asymmetric, can't use single-matrix streaming
-                            // Fall back to materializing one at a time through workspace
-                            Eigen::MatrixXf WQ = tensor_to_matrix(layer.q_weight);
-                            Eigen::MatrixXf WK = tensor_to_matrix(layer.k_weight);
-                            Eigen::MatrixXf Q = norm_embeddings * WQ.transpose();
-                            Eigen::MatrixXf K = norm_embeddings * WK.transpose();
-                            extract_procedural_knn(metadata.vocab, Q, K, token_to_comp, stats,
-                                                   1600.0, "attention_qk", layer.layer_index, total_attn,
-                                                   config_.hnsw_asymmetric, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf WQ = tensor_to_matrix(layer.q_weight);
-                            Eigen::MatrixXf WK = tensor_to_matrix(layer.k_weight);
-                            proj_workspace_b_.leftCols(qdim).noalias() = norm_embeddings * WQ.transpose();
-                            proj_workspace_a_.leftCols(kdim).noalias() = norm_embeddings * WK.transpose();
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_b_.leftCols(qdim),
-                                proj_workspace_a_.leftCols(kdim),
-                                token_to_comp, stats,
-                                1600.0, "attention_qk", layer.layer_index, total_attn,
-                                config_.hnsw_asymmetric, &pending_records);
-                        } else {
-                            Eigen::MatrixXf WQ = tensor_to_matrix(layer.q_weight);
-                            Eigen::MatrixXf WK = tensor_to_matrix(layer.k_weight);
-                            Eigen::MatrixXf Q = norm_embeddings * WQ.transpose();
-                            Eigen::MatrixXf K = norm_embeddings * WK.transpose();
-                            extract_procedural_knn(metadata.vocab, Q, K, token_to_comp, stats,
-                                                   1600.0, "attention_qk", layer.layer_index, total_attn,
-                                                   config_.hnsw_asymmetric, &pending_records);
-                        }
-                    }
-                }
-
-                // V: "what information each token offers when attended to" (self-sim)
-                if (layer.v_weight) {
-                    bool skip_v = false;
-                    if (use_layer_sim && i > 0 && attn_layers[i-1].v_weight) {
-                        if (weight_similarity(layer.v_weight, attn_layers[i-1].v_weight) > 0.98) {
-                            std::cout << " (skip V)" << std::flush;
-                            skip_v = true;
-                        }
-                    }
-                    if (!skip_v) {
-                        size_t vdim = layer.v_weight->shape[0];
-                        size_t proj_bytes = n_tokens * vdim * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            Eigen::MatrixXf WV = tensor_to_matrix(layer.v_weight);
-                            extract_procedural_knn_streaming(metadata.vocab, norm_embeddings, WV,
-                                token_to_comp, stats, 1650.0, "attention_value",
-                                layer.layer_index, total_attn, config_.hnsw_self_sim, false, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf WV = tensor_to_matrix(layer.v_weight);
-                            proj_workspace_a_.leftCols(vdim).noalias() = norm_embeddings * WV.transpose();
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_a_.leftCols(vdim),
-                                proj_workspace_a_.leftCols(vdim),
-                                token_to_comp, stats,
-                                1650.0, "attention_value", layer.layer_index, total_attn,
-                                config_.hnsw_self_sim, &pending_records);
-                        } else {
-                            Eigen::MatrixXf WV = tensor_to_matrix(layer.v_weight);
-                            Eigen::MatrixXf V = norm_embeddings * WV.transpose();
-                            extract_procedural_knn(metadata.vocab, V, V, token_to_comp, stats,
-                                                   1650.0, "attention_value", layer.layer_index, total_attn,
-                                                   config_.hnsw_self_sim, &pending_records);
-                        }
-                    }
-                }
-
-                // O: "how head outputs combine" (self-sim)
-                if (layer.o_weight) {
-                    bool skip_o = false;
-                    if (use_layer_sim && i > 0 && attn_layers[i-1].o_weight) {
-                        if (weight_similarity(layer.o_weight, attn_layers[i-1].o_weight) > 0.98) {
-                            std::cout << " (skip O)" << std::flush;
-                            skip_o = true;
-                        }
-                    }
-                    if (!skip_o) {
-                        size_t odim = layer.o_weight->shape[0];
-                        size_t proj_bytes = n_tokens * odim * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            Eigen::MatrixXf WO = tensor_to_matrix(layer.o_weight);
-                            extract_procedural_knn_streaming(metadata.vocab, norm_embeddings, WO,
-                                token_to_comp, stats, 1550.0, "attention_output",
-                                layer.layer_index, total_attn, config_.hnsw_self_sim, false, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf WO = tensor_to_matrix(layer.o_weight);
-                            proj_workspace_a_.leftCols(odim).noalias() = norm_embeddings * WO.transpose();
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_a_.leftCols(odim),
-                                proj_workspace_a_.leftCols(odim),
-                                token_to_comp, stats,
-                                1550.0, "attention_output", layer.layer_index, total_attn,
-                                config_.hnsw_self_sim, &pending_records);
-                        } else {
-                            Eigen::MatrixXf WO = tensor_to_matrix(layer.o_weight);
-                            Eigen::MatrixXf O = norm_embeddings * WO.transpose();
-                            extract_procedural_knn(metadata.vocab, O, O, token_to_comp, stats,
-                                                   1550.0, "attention_output", layer.layer_index, total_attn,
-                                                   config_.hnsw_self_sim, &pending_records);
-                        }
-                    }
-                }
-
-                maybe_flush_pending();
-                std::cout << " (" << ms_since(t_layer) << "ms)" << std::endl;
-            }
-            std::cout << "  Attention Mining Complete (" << ms_since(t2) << "ms)" << std::endl;
+        {
+            IngestReport::Phase phase("layer_mining");
+            mine_layers(attn_layers, ffn_layers, metadata.vocab, norm_embeddings, token_to_comp, stats, use_layer_sim);
         }
 
-        // 5. Procedural Pass: FFN Mining (Logical Categories)
-        if (!ffn_layers.empty()) {
-            int total_ffn = static_cast<int>(ffn_layers.size());
-            std::cout << "  Phase 4: Mining " << total_ffn << " FFN layers (gate, up, down)..." << std::endl;
-            auto t3 = Clock::now();
-            for (size_t i = 0; i < ffn_layers.size(); i++) {
-                const auto& layer = ffn_layers[i];
-                std::cout << "    FFN Layer " << layer.layer_index << "/" << total_ffn << "..." << std::flush;
-                auto t_layer = Clock::now();
-
-                // Gate: sigmoid activation - "which features pass through" (self-sim)
-                if (layer.gate_weight) {
-                    bool skip_gate = false;
-                    if (use_layer_sim && i > 0 && ffn_layers[i-1].gate_weight) {
-                        if (weight_similarity(layer.gate_weight, ffn_layers[i-1].gate_weight) > 0.98) {
-                            std::cout << " (skip gate)" << std::flush;
-                            skip_gate = true;
-                        }
-                    }
-                    if (!skip_gate) {
-                        size_t gdim = layer.gate_weight->shape[0];
-                        size_t proj_bytes = n_tokens * gdim * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            Eigen::MatrixXf W_gate = tensor_to_matrix(layer.gate_weight);
-                            extract_procedural_knn_streaming(metadata.vocab, norm_embeddings, W_gate,
-                                token_to_comp, stats, 1800.0, "ffn_gate",
-                                layer.layer_index, total_ffn, config_.hnsw_self_sim, true, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf W_gate = tensor_to_matrix(layer.gate_weight);
-                            proj_workspace_a_.leftCols(gdim).noalias() = norm_embeddings * W_gate.transpose();
-                            proj_workspace_a_.leftCols(gdim) = proj_workspace_a_.leftCols(gdim).array() /
-                                (1.0f + (-proj_workspace_a_.leftCols(gdim).array()).exp());
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_a_.leftCols(gdim),
-                                proj_workspace_a_.leftCols(gdim),
-                                token_to_comp, stats,
-                                1800.0, "ffn_gate", layer.layer_index, total_ffn,
-                                config_.hnsw_self_sim, &pending_records);
-                        } else {
-                            Eigen::MatrixXf W_gate = tensor_to_matrix(layer.gate_weight);
-                            Eigen::MatrixXf G = norm_embeddings * W_gate.transpose();
-                            G = G.array() / (1.0f + (-G.array()).exp());
-                            extract_procedural_knn(metadata.vocab, G, G, token_to_comp, stats,
-                                                   1800.0, "ffn_gate", layer.layer_index, total_ffn,
-                                                   config_.hnsw_self_sim, &pending_records);
-                        }
-                    }
-                }
+        hnsw_cache_.release();
 
-                // Up: expansion - "what features get amplified" (self-sim)
-                if (layer.up_weight) {
-                    bool skip_up = false;
-                    if (use_layer_sim && i > 0 && ffn_layers[i-1].up_weight) {
-                        if (weight_similarity(layer.up_weight, ffn_layers[i-1].up_weight) > 0.98) {
-                            std::cout << " (skip up)" << std::flush;
-                            skip_up = true;
-                        }
-                    }
-                    if (!skip_up) {
-                        size_t udim = layer.up_weight->shape[0];
-                        size_t proj_bytes = n_tokens * udim * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            Eigen::MatrixXf W_up = tensor_to_matrix(layer.up_weight);
-                            extract_procedural_knn_streaming(metadata.vocab, norm_embeddings, W_up,
-                                token_to_comp, stats, 1750.0, "ffn_expand",
-                                layer.layer_index, total_ffn, config_.hnsw_self_sim, false, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf W_up = tensor_to_matrix(layer.up_weight);
-                            proj_workspace_a_.leftCols(udim).noalias() = norm_embeddings * W_up.transpose();
-                            // normalize is done inside extract_procedural_knn via bulk pre-normalization
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_a_.leftCols(udim),
-                                proj_workspace_a_.leftCols(udim),
-                                token_to_comp, stats,
-                                1750.0, "ffn_expand", layer.layer_index, total_ffn,
-                                config_.hnsw_self_sim, &pending_records);
-                        } else {
-                            Eigen::MatrixXf W_up = tensor_to_matrix(layer.up_weight);
-                            Eigen::MatrixXf U = norm_embeddings * W_up.transpose();
-                            extract_procedural_knn(metadata.vocab, U, U, token_to_comp, stats,
-                                                   1750.0, "ffn_expand", layer.layer_index, total_ffn,
-                                                   config_.hnsw_self_sim, &pending_records);
-                        }
-                    }
-                }
-
-                // Down: compression - "what features survive projection back" (self-sim)
-                if (layer.down_weight) {
-                    bool skip_down = false;
-                    if (use_layer_sim && i > 0 && ffn_layers[i-1].down_weight) {
-                        if (weight_similarity(layer.down_weight, ffn_layers[i-1].down_weight) > 0.98) {
-                            std::cout << " (skip down)" << std::flush;
-                            skip_down = true;
-                        }
-                    }
-                    if (!skip_down) {
-                        size_t ddim = layer.down_weight->shape[0];
-                        size_t proj_bytes = n_tokens * ddim * sizeof(float);
-                        if (proj_bytes > STREAMING_THRESHOLD_BYTES) {
-                            Eigen::MatrixXf W_down = tensor_to_matrix(layer.down_weight);
-                            extract_procedural_knn_streaming(metadata.vocab, norm_embeddings, W_down,
-                                token_to_comp, stats, 1700.0, "ffn_compress",
-                                layer.layer_index, total_ffn, config_.hnsw_self_sim, false, &pending_records);
-                        } else if (use_workspaces) {
-                            Eigen::MatrixXf W_down = tensor_to_matrix(layer.down_weight);
-                            proj_workspace_a_.leftCols(ddim).noalias() = norm_embeddings * W_down.transpose();
-                            extract_procedural_knn(metadata.vocab,
-                                proj_workspace_a_.leftCols(ddim),
-                                proj_workspace_a_.leftCols(ddim),
-                                token_to_comp, stats,
-                                1700.0, "ffn_compress", layer.layer_index, total_ffn,
-                                config_.hnsw_self_sim, &pending_records);
-                        } else {
-                            Eigen::MatrixXf W_down = tensor_to_matrix(layer.down_weight);
-                            Eigen::MatrixXf D = norm_embeddings * W_down.transpose();
-                            extract_procedural_knn(metadata.vocab, D, D, token_to_comp, stats,
-                                                   1700.0, "ffn_compress", layer.layer_index, total_ffn,
-                                                   config_.hnsw_self_sim, &pending_records);
-                        }
-                    }
-                }
-
-                maybe_flush_pending();
-                std::cout << " (" << ms_since(t_layer) << "ms)" << std::endl;
-            }
-            std::cout << "  FFN Mining Complete (" << ms_since(t3) << "ms)" << std::endl;
-        }
-
-        // Final flush of any remaining pending records
-        if (!pending_records.empty()) {
-            size_t remaining = count_pending_relations(pending_records);
-            if (remaining > 0) {
-                std::cout << "  Final batch flush: " << remaining << " remaining relations" << std::endl;
-                flush_records(db_, pending_records, stats.relations_created);
-            }
-            pending_records.clear();
-        }
-
-        // Release workspaces
-        proj_workspace_a_.resize(0, 0);
-        proj_workspace_b_.resize(0, 0);
+        auto hs = hnsw_cache_.stats();
+        std::cout << "  HNSW indices: " << hs.built << " built, " << hs.loaded << " loaded, "
+                  << hs.reused << " reused" << std::endl;
 
         double total_ms = ms_since(t_pipeline);
         std::cout << "\n  === Substrate Reinforcement Complete ===" << std::endl;
@@ -484,14 +412,18 @@ ModelIngestionStats ModelIngester::ingest_package(const std::filesystem::path& p
         std::cout << "  Relations:     " << stats.relations_created << std::endl;
         std::cout << "  Throughput:    " << (total_ms > 0 ? (stats.relations_created / (total_ms / 1000.0)) : 0) << " relations/sec" << std::endl;
 
+        // Every unit is in the database unless a flush failed; only then is there anything to resume
+        if (checkpoint_.settled()) checkpoint_.clear();
+
     } catch (const std::exception& e) {
         std::cerr << "Model ingestion failed: " << e.what() << std::endl;
     }
+    if (progress_) progress_->finish();
     return stats;
 }
 
 std::unordered_map<std::string, BLAKE3Pipeline::Hash>
-ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, ModelIngestionStats& stats) {
+ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, ModelIngestionStats& stats, bool store) {
     std::cout << "    Ingesting " << vocab.size() << " vocab tokens as compositions..." << std::endl;
     std::unordered_map<std::string, BLAKE3Pipeline::Hash> token_to_comp;
     token_to_comp.reserve(vocab.size());
@@ -524,7 +456,7 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
         std::vector<PhysicalityRecord> phys;
         std::vector<CompositionRecord> comp;
         std::vector<CompositionSequenceRecord> seq;
-        std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> phys_seen;
+        HashSet128 phys_seen;
         std::vector<TokenMapping> mappings;
         size_t created = 0;
     };
@@ -536,6 +468,8 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
         auto& tl = locals[omp_get_thread_num()];
         std::vector<BLAKE3Pipeline::Hash> atom_ids;
         std::vector<Eigen::Vector4d> positions;
+        std::vector<char32_t> cps;
+        bool packed = true;   // Every codepoint has an atom, so runs line up with the ordinals
 
         for (size_t k = 0; k < token.size(); ) {
             uint8_t c = token[k]; char32_t cp = 0; size_t len = 1;
@@ -551,6 +485,9 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
             if (it != atom_map.end()) {
                 atom_ids.push_back(it->second.id);
                 positions.push_back(it->second.position);
+                cps.push_back(cp);
+            } else {
+                packed = false;
             }
             k += len;
         }
@@ -560,11 +497,7 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
         for (const auto& aid : atom_ids) cdata.insert(cdata.end(), aid.begin(), aid.end());
         auto cid = BLAKE3Pipeline::hash(cdata);
 
-        Eigen::Vector4d centroid = Eigen::Vector4d::Zero();
-        for (const auto& p : positions) centroid += p;
-        centroid /= static_cast<double>(positions.size());
-        double nrm = centroid.norm();
-        if (nrm > 1e-10) centroid /= nrm; else centroid = Eigen::Vector4d(1, 0, 0, 0);
+        Eigen::Vector4d centroid = Geometry::compute_s3_mean(positions.front().data(), positions.size());
 
         tl.mappings.push_back({token, cid, centroid});
 
@@ -576,18 +509,20 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
                          reinterpret_cast<const uint8_t*>(p.data()) + sizeof(double) * 4);
         auto pid = BLAKE3Pipeline::hash(pdata);
 
-        if (tl.phys_seen.insert(pid).second) {
-            Eigen::Vector4d hc;
-            for (int k = 0; k < 4; ++k) hc[k] = (centroid[k] + 1.0) / 2.0;
-            tl.phys.push_back({pid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Composition), centroid, positions});
-        }
-        tl.comp.push_back({cid, pid});
+        if (tl.phys_seen.insert(pid).second) tl.phys.push_back({pid, {}, centroid, positions});
+        tl.comp.push_back({cid, pid, token, {}});
         tl.created++;
+        const bool rows = !packed || CompositionRuns::write_rows();
 
         for (size_t k = 0; k < atom_ids.size(); ) {
             uint32_t ord = static_cast<uint32_t>(k);
             uint32_t occ = 1;
             while (k + occ < atom_ids.size() && atom_ids[k + occ] == atom_ids[k]) ++occ;
+            if (packed) CompositionRuns::append(tl.comp.back().runs, cps[k], occ);
+            if (!rows) {
+                k += occ;
+                continue;
+            }
             std::vector<uint8_t> sdata = {0x53};
             sdata.insert(sdata.end(), cid.begin(), cid.end());
             sdata.insert(sdata.end(), atom_ids[k].begin(), atom_ids[k].end());
@@ -597,6 +532,11 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
         }
     }
 
+    // Hilbert indices in one batch per thread's records
+    #pragma omp parallel for schedule(static, 1)
+    for (size_t t = 0; t < locals.size(); ++t)
+        encode_hilbert_indices(locals[t].phys, 0, HilbertCurve4D::EntityType::Composition);
+
     for (auto& tl : locals) {
         for (auto& m : tl.mappings) {
             token_to_comp[m.token] = m.second;
@@ -604,6 +544,11 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
         }
         stats.compositions_created += tl.created;
     }
+    centroids_account_.update(MemoryGovernor::hash_map_bytes(comp_centroids_));
+    if (!store) {
+        std::cout << "    (compositions already stored)" << std::endl;
+        return token_to_comp;
+    }
 
     PostgresConnection::Transaction txn(db_);
     {
@@ -626,6 +571,52 @@ ModelIngester::ingest_vocab_as_text(const std::vector<std::string>& vocab, Model
     return token_to_comp;
 }
 
+size_t ModelIngester::emit_edges(ThreadLocalRecords& tl, const BLAKE3Pipeline::Hash& scid,
+                                const std::vector<std::pair<const BLAKE3Pipeline::Hash*, float>>& targets,
+                                double base_elo, double elo_range, std::string_view type_tag, int32_t layer) const {
+    thread_local std::vector<const BLAKE3Pipeline::Hash*> others;
+    thread_local std::vector<BLAKE3Pipeline::Hash> rids;
+    others.clear();
+    for (const auto& t : targets) others.push_back(t.first);
+    rids.resize(targets.size());
+    RelationEdge::relation_ids(scid, others.data(), others.size(), rids.data());
+
+    size_t created = 0;
+    size_t phys_from = tl.phys.size();
+    for (size_t e = 0; e < targets.size(); ++e) {
+        const auto& rid = rids[e];
+        const auto& tcid = *targets[e].first;
+        float sim = targets[e].second;
+        const RelationRatingRecord rating{rid, 1, base_elo + elo_range * static_cast<double>(sim), 32.0};
+        auto [slot, fresh] = tl.rel_rating.try_emplace(rid, static_cast<uint32_t>(tl.rating.size()));
+        if (!fresh) {
+            tl.rating[*slot].merge(rating);
+            continue;
+        }
+        tl.rating.push_back(rating);
+        // Physicality geometry and hashing only for a relation no thread has emitted yet
+        if (!relations_emitted_.insert_if_absent(rid)) continue;
+        auto it_sc = comp_centroids_.find(scid);
+        auto it_tc = comp_centroids_.find(tcid);
+        RelationEdge edge(rid, scid, tcid,
+                          it_sc != comp_centroids_.end() ? &it_sc->second : nullptr,
+                          it_tc != comp_centroids_.end() ? &it_tc->second : nullptr);
+        if (tl.phys_seen.insert(edge.physicality_id).second) tl.phys.push_back(edge.physicality(false));
+        tl.rel.push_back(edge.relation());
+        tl.rel_seq.push_back(edge.sequence(0));
+        tl.rel_seq.push_back(edge.sequence(1));
+
+        // Context-aware evidence: the same pair seen by another pass or layer is separate evidence
+        double clamped_sim = std::clamp(static_cast<double>(sim), 0.0, 1.0);
+        tl.ev.push_back({RelationEdge::evidence_id(model_id_, rid, type_tag, layer), model_id_, rid, true,
+                         base_elo + elo_range * clamped_sim, clamped_sim});
+        tl.relations_created++;
+        ++created;
+    }
+    encode_hilbert_indices(tl.phys, phys_from, HilbertCurve4D::EntityType::Relation);
+    return created;
+}
+
 void ModelIngester::extract_embedding_edges(
     const std::vector<std::string>& vocab, const Eigen::MatrixXf& norm_embeddings,
     const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
@@ -637,22 +628,40 @@ void ModelIngester::extract_embedding_edges(
     size_t k = std::min(config_.max_neighbors_per_token, n - 1);
     float threshold = static_cast<float>(config_.embedding_similarity_threshold);
 
-    std::cout << "    Building HNSW index for " << n << " tokens (dim=" << dim << ")..." << std::flush;
     auto t_start = Clock::now();
-
     const auto& hp = config_.hnsw_embedding;
-    hnswlib::InnerProductSpace space(dim);
-    hnswlib::HierarchicalNSW<float>* alg_hnsw = new hnswlib::HierarchicalNSW<float>(&space, n, hp.M, hp.ef_construction);
-
-    #pragma omp parallel for schedule(dynamic, 1024)
-    for (size_t i = 0; i < n; ++i) {
-        alg_hnsw->addPoint(norm_embeddings.row(i).data(), i);
+    bool exact = false;   // exact_knn holds every row's neighbors
+    std::shared_ptr<HnswIndexCache::Entry> cached;
+    BlockedKnnResult exact_knn;
+    RowMatrixXf rows;
+
+    if (const DeviceKnn* device = mining_device(config_, k)) {
+        std::cout << "    Exact KNN over " << n << " tokens (dim=" << dim << ", " << device->device_name() << ")..."
+                  << std::flush;
+        rows = norm_embeddings;
+        exact = device_search(device, rows, rows, k, threshold, exact_knn);
     }
-    alg_hnsw->setEf(hp.ef_search);  // Fix: override hnswlib default of 10
-    std::cout << " (" << ms_since(t_start) << "ms)" << std::endl;
+    if (!exact && config_.knn_backend == KnnBackend::BlockedGEMM) {
+        std::cout << "    Exact KNN over " << n << " tokens (dim=" << dim << ", blocked GEMM)..." << std::flush;
+        exact_knn = blocked_knn(norm_embeddings, norm_embeddings, k, threshold, true);
+        exact = true;
+    } else if (!exact) {
+        std::cout << "    Building HNSW index for " << n << " tokens (dim=" << dim << ")..." << std::flush;
+        rows = norm_embeddings;
+        cached = hnsw_cache_.acquire({model_id_, "token_embedding", hp, n, static_cast<size_t>(dim), embedding_digest_},
+            [&](HnswIndexCache::Entry& index) {
+                #pragma omp parallel for schedule(dynamic, 1024)
+                for (size_t i = 0; i < n; ++i) {
+                    index.add_point(rows.row(i).data(), i);
+                }
+            });
+        cached->index->setEf(hp.ef_search);  // Fix: override hnswlib default of 10
+    }
+    std::cout << (cached && cached->from_disk ? " (cached, " : " (") << ms_since(t_start) << "ms)" << std::endl;
 
-    std::cout << "    Extracting relations (k=" << k << ", threshold=" << threshold
-              << ", ef=" << hp.ef_search << ")..." << std::flush;
+    std::cout << "    Extracting relations (k=" << k << ", threshold=" << threshold;
+    if (!exact) std::cout << ", ef=" << hp.ef_search;
+    std::cout << ")..." << std::flush;
     t_start = Clock::now();
 
     double base_elo = 1000.0;
@@ -660,6 +669,7 @@ void ModelIngester::extract_embedding_edges(
     std::atomic<size_t> edges_found{0};
     int num_threads = omp_get_max_threads();
     std::vector<ThreadLocalRecords> locals(num_threads);
+    for (auto& tl : locals) tl.reserve(expected_edges_per_thread(n, k, num_threads));
 
     #pragma omp parallel for schedule(dynamic, 512)
     for (size_t i = 0; i < n; ++i) {
@@ -668,137 +678,90 @@ void ModelIngester::extract_embedding_edges(
         if (it_s == token_to_comp.end()) continue;
         const auto& scid = it_s->second;
 
-        auto result = alg_hnsw->searchKnn(norm_embeddings.row(i).data(), k + 1);
-        
-        while (!result.empty()) {
-            auto top = result.top();
-            result.pop();
-            if (top.second == i) continue;
+        // (row, similarity); the exact backend has already applied k, threshold and self-exclusion
+        thread_local std::vector<std::pair<size_t, float>> neighbors;
+        if (exact) {
+            neighbors.clear();
+            for (uint32_t m = 0; m < exact_knn.count[i]; ++m)
+                neighbors.emplace_back(exact_knn.index[i * k + m], exact_knn.similarity[i * k + m]);
+        } else {
+            cached->neighbors(rows.row(i).data(), k + 1, rows.data(), neighbors);
+        }
 
-            float sim = 1.0f - top.first;
+        // Accepted targets of this row, so their relation IDs hash together
+        thread_local std::vector<std::pair<const BLAKE3Pipeline::Hash*, float>> targets;
+        targets.clear();
+        for (const auto& [j, sim] : neighbors) {
+            if (j == i) continue;
             if (sim < threshold) continue;
 
-            auto it_t = token_to_comp.find(vocab[top.second]);
+            auto it_t = token_to_comp.find(vocab[j]);
             if (it_t == token_to_comp.end()) continue;
-            const auto& tcid = it_t->second;
-
-            const auto& lo = (std::memcmp(scid.data(), tcid.data(), 16) < 0) ? scid : tcid;
-            const auto& hi = (&lo == &scid) ? tcid : scid;
-
-            uint8_t rdata[33];
-            rdata[0] = 0x52;
-            std::memcpy(rdata + 1, lo.data(), 16);
-            std::memcpy(rdata + 17, hi.data(), 16);
-            auto rid = BLAKE3Pipeline::hash(rdata, 33);
-
-            if (tl.rel_seen.insert(rid).second) {
-                Eigen::Vector4d rel_centroid;
-                auto it_sc = comp_centroids_.find(scid);
-                auto it_tc = comp_centroids_.find(tcid);
-
-                if (it_sc != comp_centroids_.end() && it_tc != comp_centroids_.end()) {
-                    rel_centroid = (it_sc->second + it_tc->second) * 0.5;
-                    double nrm = rel_centroid.norm();
-                    if (nrm > 1e-10) rel_centroid /= nrm;
-                    else rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                } else {
-                    rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                }
-
-                std::vector<Eigen::Vector4d> traj;
-                if (it_sc != comp_centroids_.end()) traj.push_back(it_sc->second);
-                if (it_tc != comp_centroids_.end()) traj.push_back(it_tc->second);
-
-                size_t rel_phys_data_len = 1 + sizeof(double) * 4 + traj.size() * sizeof(double) * 4;
-                std::vector<uint8_t> pdata(rel_phys_data_len);
-                pdata[0] = 0x50;
-                std::memcpy(pdata.data() + 1, rel_centroid.data(), sizeof(double) * 4);
-                for (size_t pt_idx = 0; pt_idx < traj.size(); ++pt_idx)
-                    std::memcpy(pdata.data() + 1 + sizeof(double) * 4 + pt_idx * sizeof(double) * 4, traj[pt_idx].data(), sizeof(double) * 4);
-                auto prid = BLAKE3Pipeline::hash(pdata.data(), rel_phys_data_len);
-
-                if (tl.phys_seen.insert(prid).second) {
-                    Eigen::Vector4d hc;
-                    for (int d = 0; d < 4; ++d) hc[d] = (rel_centroid[d] + 1.0) / 2.0;
-                    tl.phys.push_back({prid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Relation), rel_centroid, traj});
-                }
-                tl.rel.push_back({rid, prid});
-
-                for (uint32_t ord = 0; ord < 2; ++ord) {
-                    const auto& cid = (ord == 0) ? scid : tcid;
-                    uint8_t sdata[37];
-                    sdata[0] = 0x54;
-                    std::memcpy(sdata + 1, rid.data(), 16);
-                    std::memcpy(sdata + 17, cid.data(), 16);
-                    std::memcpy(sdata + 33, &ord, 4);
-                    tl.rel_seq.push_back({BLAKE3Pipeline::hash(sdata, 37), rid, cid, ord, 1});
-                }
-
-                // Context-aware evidence hash: include type_tag ("embedding") and layer (0)
-                double clamped_sim = std::clamp(static_cast<double>(sim), 0.0, 1.0);
-                std::string embed_tag = "embedding";
-                int32_t embed_layer = 0;
-                std::vector<uint8_t> edata;
-                edata.insert(edata.end(), model_id_.begin(), model_id_.end());
-                edata.insert(edata.end(), rid.begin(), rid.end());
-                edata.insert(edata.end(), embed_tag.begin(), embed_tag.end());
-                edata.insert(edata.end(), reinterpret_cast<uint8_t*>(&embed_layer),
-                             reinterpret_cast<uint8_t*>(&embed_layer) + sizeof(embed_layer));
-                tl.ev.push_back({BLAKE3Pipeline::hash(edata.data(), edata.size()), model_id_, rid, true,
-                                 base_elo + elo_range * clamped_sim, clamped_sim});
-                tl.relations_created++;
-                edges_found.fetch_add(1, std::memory_order_relaxed);
-            }
-            tl.rating.push_back({rid, 1, base_elo + elo_range * static_cast<double>(sim), 32.0});
+            targets.emplace_back(&it_t->second, sim);
         }
+        edges_found.fetch_add(emit_edges(tl, scid, targets, base_elo, elo_range, "embedding", 0),
+                              std::memory_order_relaxed);
     }
 
-    delete alg_hnsw;
+    cached.reset();
     std::cout << " (" << ms_since(t_start) << "ms) | Edges: " << edges_found.load() << std::endl;
     flush_records(db_, locals, stats.relations_created);
 }
 
 void ModelIngester::extract_procedural_knn(
-    const std::vector<std::string>& vocab, const Eigen::MatrixXf& Q, const Eigen::MatrixXf& K,
+    const std::vector<std::string>& vocab,
+    const Eigen::Ref<const Eigen::MatrixXf>& Q, const Eigen::Ref<const Eigen::MatrixXf>& K,
+    const std::string& index_tensor,
     const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
     ModelIngestionStats& stats, double base_elo, const std::string& type_tag,
     int layer_index, int total_layers, const HnswParams& params,
     std::vector<ThreadLocalRecords>* out_records) {
 
     size_t n = static_cast<size_t>(Q.rows());
-    int dim = static_cast<int>(Q.cols());
-    size_t k = 16;
+    size_t k = PROCEDURAL_K;
     float threshold = 0.5f;
 
     // Cross-layer ELO scaling: deeper layers (semantic) get higher ELO
     double depth_ratio = (total_layers > 1) ? (double)layer_index / (double)(total_layers - 1) : 0.0;
     double layer_elo = base_elo + depth_ratio * 200.0;
 
-    // Bulk pre-normalization: one copy + vectorized SIMD normalize
+    // Bulk pre-normalization: one copy + vectorized SIMD normalize.
+    // Workspace columns bind through Ref without a copy, so a self-sim pass
+    // sees one matrix and builds (or reuses) a single index for both sides.
     bool is_self_sim = (Q.data() == K.data());
-    Eigen::MatrixXf K_norm = K;
+    RowMatrixXf K_norm = K;
     K_norm.rowwise().normalize();
 
-    hnswlib::InnerProductSpace space(dim);
-    hnswlib::HierarchicalNSW<float>* alg_hnsw = new hnswlib::HierarchicalNSW<float>(&space, n, params.M, params.ef_construction);
-
-    #pragma omp parallel for schedule(dynamic, 1024)
-    for (size_t i = 0; i < n; ++i) {
-        alg_hnsw->addPoint(K_norm.row(i).data(), i);
-    }
-    alg_hnsw->setEf(params.ef_search);
-
     // For self-similarity, reuse K_norm for queries; otherwise bulk-normalize Q
-    Eigen::MatrixXf Q_norm;
-    const Eigen::MatrixXf* q_src = &K_norm;
+    RowMatrixXf Q_norm;
+    const RowMatrixXf* q_src = &K_norm;
     if (!is_self_sim) {
         Q_norm = Q;
         Q_norm.rowwise().normalize();
         q_src = &Q_norm;
     }
 
+    // On a device every row's neighbors come back at once; otherwise an HNSW index over K
+    BlockedKnnResult listed;
+    const bool on_device = device_search(mining_device(config_, k), *q_src, K_norm, k, threshold, listed);
+    std::shared_ptr<HnswIndexCache::Entry> cached;
+    if (!on_device) {
+        // K's columns are n apart whether it is a workspace view or its own matrix
+        cached = hnsw_cache_.acquire(
+            {model_id_, index_tensor, params, n, static_cast<size_t>(K_norm.cols()),
+             HnswIndexCache::digest(K.data(), n, K.cols())},
+            [&](HnswIndexCache::Entry& index) {
+                #pragma omp parallel for schedule(dynamic, 1024)
+                for (size_t i = 0; i < n; ++i) {
+                    index.add_point(K_norm.row(i).data(), i);
+                }
+            });
+        cached->index->setEf(params.ef_search);
+    }
+
     int num_threads = omp_get_max_threads();
     std::vector<ThreadLocalRecords> locals(num_threads);
+    for (auto& tl : locals) tl.reserve(expected_edges_per_thread(n, k, num_threads));
 
     #pragma omp parallel for schedule(dynamic, 512)
     for (size_t i = 0; i < n; ++i) {
@@ -807,86 +770,29 @@ void ModelIngester::extract_procedural_knn(
         if (it_s == token_to_comp.end()) continue;
         const auto& scid = it_s->second;
 
-        auto result = alg_hnsw->searchKnn(q_src->row(i).data(), k + 1);
-
-        while (!result.empty()) {
-            auto top = result.top();
-            result.pop();
-            if (top.second == i) continue;
+        thread_local std::vector<std::pair<size_t, float>> neighbors;  // Reused across rows
+        if (on_device) {
+            neighbors.clear();
+            for (uint32_t m = 0; m < listed.count[i]; ++m)
+                neighbors.emplace_back(listed.index[i * k + m], listed.similarity[i * k + m]);
+        } else {
+            cached->neighbors(q_src->row(i).data(), k + 1, K_norm.data(), neighbors);
+        }
 
-            float sim = 1.0f - top.first;
+        thread_local std::vector<std::pair<const BLAKE3Pipeline::Hash*, float>> targets;
+        targets.clear();
+        for (const auto& [j, sim] : neighbors) {
+            if (j == i) continue;
             if (sim < threshold) continue;
 
-            auto it_t = token_to_comp.find(vocab[top.second]);
+            auto it_t = token_to_comp.find(vocab[j]);
             if (it_t == token_to_comp.end()) continue;
-            const auto& tcid = it_t->second;
-
-            const auto& lo = (std::memcmp(scid.data(), tcid.data(), 16) < 0) ? scid : tcid;
-            const auto& hi = (&lo == &scid) ? tcid : scid;
-
-            uint8_t rdata[33];
-            rdata[0] = 0x52;
-            std::memcpy(rdata + 1, lo.data(), 16);
-            std::memcpy(rdata + 17, hi.data(), 16);
-            auto rid = BLAKE3Pipeline::hash(rdata, 33);
-
-            if (tl.rel_seen.insert(rid).second) {
-                Eigen::Vector4d rel_centroid;
-                auto it_sc = comp_centroids_.find(scid);
-                auto it_tc = comp_centroids_.find(tcid);
-                if (it_sc != comp_centroids_.end() && it_tc != comp_centroids_.end()) {
-                    rel_centroid = (it_sc->second + it_tc->second) * 0.5;
-                    double nrm = rel_centroid.norm();
-                    if (nrm > 1e-10) rel_centroid /= nrm; else rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                } else {
-                    rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                }
-
-                std::vector<Eigen::Vector4d> traj;
-                if (it_sc != comp_centroids_.end()) traj.push_back(it_sc->second);
-                if (it_tc != comp_centroids_.end()) traj.push_back(it_tc->second);
-
-                size_t rel_phys_data_len = 1 + sizeof(double) * 4 + traj.size() * sizeof(double) * 4;
-                std::vector<uint8_t> pdata(rel_phys_data_len);
-                pdata[0] = 0x50;
-                std::memcpy(pdata.data() + 1, rel_centroid.data(), sizeof(double) * 4);
-                for (size_t pt_idx = 0; pt_idx < traj.size(); ++pt_idx)
-                    std::memcpy(pdata.data() + 1 + sizeof(double) * 4 + pt_idx * sizeof(double) * 4, traj[pt_idx].data(), sizeof(double) * 4);
-                auto prid = BLAKE3Pipeline::hash(pdata.data(), rel_phys_data_len);
-
-                if (tl.phys_seen.insert(prid).second) {
-                    Eigen::Vector4d hc;
-                    for (int d = 0; d < 4; ++d) hc[d] = (rel_centroid[d] + 1.0) / 2.0;
-                    tl.phys.push_back({prid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Relation), rel_centroid, traj});
-                }
-                tl.rel.push_back({rid, prid});
-
-                for (uint32_t ord = 0; ord < 2; ++ord) {
-                    const auto& cid = (ord == 0) ? scid : tcid;
-                    uint8_t sdata[37]; sdata[0] = 0x54;
-                    std::memcpy(sdata + 1, rid.data(), 16);
-                    std::memcpy(sdata + 17, cid.data(), 16);
-                    std::memcpy(sdata + 33, &ord, 4);
-                    tl.rel_seq.push_back({BLAKE3Pipeline::hash(sdata, 37), rid, cid, ord, 1});
-                }
-
-                double clamped_sim = std::clamp(static_cast<double>(sim), 0.0, 1.0);
-                int32_t li = layer_index;
-                std::vector<uint8_t> edata;
-                edata.insert(edata.end(), model_id_.begin(), model_id_.end());
-                edata.insert(edata.end(), rid.begin(), rid.end());
-                edata.insert(edata.end(), type_tag.begin(), type_tag.end());
-                edata.insert(edata.end(), reinterpret_cast<uint8_t*>(&li),
-                             reinterpret_cast<uint8_t*>(&li) + sizeof(li));
-                tl.ev.push_back({BLAKE3Pipeline::hash(edata.data(), edata.size()), model_id_, rid, true,
-                                 layer_elo + 200.0 * clamped_sim, clamped_sim});
-                tl.relations_created++;
-            }
-            tl.rating.push_back({rid, 1, layer_elo + 200.0 * static_cast<double>(sim), 32.0});
+            targets.emplace_back(&it_t->second, sim);
         }
+        emit_edges(tl, scid, targets, layer_elo, 200.0, type_tag, layer_index);
     }
 
-    delete alg_hnsw;
+    cached.reset();
 
     // Either accumulate for batched flushing or flush immediately
     if (out_records) {
@@ -902,6 +808,7 @@ void ModelIngester::extract_procedural_knn_streaming(
     const std::vector<std::string>& vocab,
     const Eigen::MatrixXf& norm_embeddings,
     const Eigen::MatrixXf& W,
+    const std::string& index_tensor,
     const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
     ModelIngestionStats& stats, double base_elo, const std::string& type_tag,
     int layer_index, int total_layers, const HnswParams& params,
@@ -910,22 +817,14 @@ void ModelIngester::extract_procedural_knn_streaming(
 
     size_t n = static_cast<size_t>(norm_embeddings.rows());
     size_t proj_dim = W.rows();
-    int dim = static_cast<int>(proj_dim);
-    size_t k = 16;
+    size_t k = PROCEDURAL_K;
     float threshold = 0.5f;
 
     double depth_ratio = (total_layers > 1) ? (double)layer_index / (double)(total_layers - 1) : 0.0;
     double layer_elo = base_elo + depth_ratio * 200.0;
 
-    // Build HNSW index in blocks
-    hnswlib::InnerProductSpace space(dim);
-    hnswlib::HierarchicalNSW<float>* alg_hnsw = new hnswlib::HierarchicalNSW<float>(&space, n, params.M, params.ef_construction);
-
-    Eigen::MatrixXf block_proj(STREAMING_BLOCK_SIZE, proj_dim);
-
-    // Phase 1: Build index in blocks
-    for (size_t start = 0; start < n; start += STREAMING_BLOCK_SIZE) {
-        size_t actual = std::min(STREAMING_BLOCK_SIZE, n - start);
+    RowMatrixXf block_proj(STREAMING_BLOCK_SIZE, proj_dim);
+    auto project = [&](size_t start, size_t actual) {
         block_proj.topRows(actual).noalias() =
             norm_embeddings.middleRows(start, actual) * W.transpose();
         if (apply_sigmoid) {
@@ -933,26 +832,58 @@ void ModelIngester::extract_procedural_knn_streaming(
                 (1.0f + (-block_proj.topRows(actual).array()).exp());
         }
         block_proj.topRows(actual).rowwise().normalize();
+    };
 
-        #pragma omp parallel for schedule(dynamic, 256)
-        for (size_t i = 0; i < actual; ++i)
-            alg_hnsw->addPoint(block_proj.row(i).data(), start + i);
+    // Phase 1 on a device: the projected keys go up block by block and stay
+    // there, so the host still never holds the whole projection
+    std::unique_ptr<DeviceKnn::Index> device_index;
+    if (const DeviceKnn* device = mining_device(config_, k)) {
+        try {
+            device_index = device->create(n, proj_dim);
+            for (size_t start = 0; start < n; start += STREAMING_BLOCK_SIZE) {
+                size_t actual = std::min(STREAMING_BLOCK_SIZE, n - start);
+                project(start, actual);
+                device_index->set_keys(block_proj.data(), start, actual);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "\n    " << e.what() << "; falling back to HNSW" << std::endl;
+            device_index.reset();
+        }
+    }
+
+    // Phase 1: Build index in blocks. The projection is never materialized,
+    // so the cache keys it by its inputs: the weights seeded with the embeddings.
+    // With no float rows to re-rank against, the index stays unquantized.
+    std::shared_ptr<HnswIndexCache::Entry> cached;
+    if (!device_index) {
+        HnswParams float_params = params;
+        float_params.quantization = HnswQuantization::Float32;
+        cached = hnsw_cache_.acquire(
+            {model_id_, index_tensor, float_params, n, proj_dim,
+             HnswIndexCache::digest(W.data(), W.rows(), W.cols(), embedding_digest_)},
+            [&](HnswIndexCache::Entry& index) {
+                for (size_t start = 0; start < n; start += STREAMING_BLOCK_SIZE) {
+                    size_t actual = std::min(STREAMING_BLOCK_SIZE, n - start);
+                    project(start, actual);
+
+                    #pragma omp parallel for schedule(dynamic, 256)
+                    for (size_t i = 0; i < actual; ++i)
+                        index.add_point(block_proj.row(i).data(), start + i);
+                }
+            });
+        cached->index->setEf(params.ef_search);
     }
-    alg_hnsw->setEf(params.ef_search);
 
     // Phase 2: Search in blocks (re-project for query vectors)
     int num_threads = omp_get_max_threads();
     std::vector<ThreadLocalRecords> locals(num_threads);
+    for (auto& tl : locals) tl.reserve(expected_edges_per_thread(n, k, num_threads));
 
     for (size_t start = 0; start < n; start += STREAMING_BLOCK_SIZE) {
         size_t actual = std::min(STREAMING_BLOCK_SIZE, n - start);
-        block_proj.topRows(actual).noalias() =
-            norm_embeddings.middleRows(start, actual) * W.transpose();
-        if (apply_sigmoid) {
-            block_proj.topRows(actual) = block_proj.topRows(actual).array() /
-                (1.0f + (-block_proj.topRows(actual).array()).exp());
-        }
-        block_proj.topRows(actual).rowwise().normalize();
+        project(start, actual);
+        BlockedKnnResult listed;
+        if (device_index) listed = device_index->search(block_proj.data(), actual, start, true, k, threshold);
 
         #pragma omp parallel for schedule(dynamic, 128)
         for (size_t i = 0; i < actual; ++i) {
@@ -962,87 +893,30 @@ void ModelIngester::extract_procedural_knn_streaming(
             if (it_s == token_to_comp.end()) continue;
             const auto& scid = it_s->second;
 
-            auto result = alg_hnsw->searchKnn(block_proj.row(i).data(), k + 1);
-
-            while (!result.empty()) {
-                auto top = result.top();
-                result.pop();
-                if (top.second == global_i) continue;
+            thread_local std::vector<std::pair<size_t, float>> neighbors;  // Reused across rows
+            if (device_index) {
+                neighbors.clear();
+                for (uint32_t m = 0; m < listed.count[i]; ++m)
+                    neighbors.emplace_back(listed.index[i * k + m], listed.similarity[i * k + m]);
+            } else {
+                cached->neighbors(block_proj.row(i).data(), k + 1, nullptr, neighbors);
+            }
 
-                float sim = 1.0f - top.first;
+            thread_local std::vector<std::pair<const BLAKE3Pipeline::Hash*, float>> targets;
+            targets.clear();
+            for (const auto& [j, sim] : neighbors) {
+                if (j == global_i) continue;
                 if (sim < threshold) continue;
 
-                auto it_t = token_to_comp.find(vocab[top.second]);
+                auto it_t = token_to_comp.find(vocab[j]);
                 if (it_t == token_to_comp.end()) continue;
-                const auto& tcid = it_t->second;
-
-                const auto& lo = (std::memcmp(scid.data(), tcid.data(), 16) < 0) ? scid : tcid;
-                const auto& hi = (&lo == &scid) ? tcid : scid;
-
-                uint8_t rdata[33];
-                rdata[0] = 0x52;
-                std::memcpy(rdata + 1, lo.data(), 16);
-                std::memcpy(rdata + 17, hi.data(), 16);
-                auto rid = BLAKE3Pipeline::hash(rdata, 33);
-
-                if (tl.rel_seen.insert(rid).second) {
-                    Eigen::Vector4d rel_centroid;
-                    auto it_sc = comp_centroids_.find(scid);
-                    auto it_tc = comp_centroids_.find(tcid);
-                    if (it_sc != comp_centroids_.end() && it_tc != comp_centroids_.end()) {
-                        rel_centroid = (it_sc->second + it_tc->second) * 0.5;
-                        double nrm = rel_centroid.norm();
-                        if (nrm > 1e-10) rel_centroid /= nrm; else rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                    } else {
-                        rel_centroid = Eigen::Vector4d(1, 0, 0, 0);
-                    }
-
-                    std::vector<Eigen::Vector4d> traj;
-                    if (it_sc != comp_centroids_.end()) traj.push_back(it_sc->second);
-                    if (it_tc != comp_centroids_.end()) traj.push_back(it_tc->second);
-
-                    size_t rel_phys_data_len = 1 + sizeof(double) * 4 + traj.size() * sizeof(double) * 4;
-                    std::vector<uint8_t> pdata(rel_phys_data_len);
-                    pdata[0] = 0x50;
-                    std::memcpy(pdata.data() + 1, rel_centroid.data(), sizeof(double) * 4);
-                    for (size_t pt_idx = 0; pt_idx < traj.size(); ++pt_idx)
-                        std::memcpy(pdata.data() + 1 + sizeof(double) * 4 + pt_idx * sizeof(double) * 4, traj[pt_idx].data(), sizeof(double) * 4);
-                    auto prid = BLAKE3Pipeline::hash(pdata.data(), rel_phys_data_len);
-
-                    if (tl.phys_seen.insert(prid).second) {
-                        Eigen::Vector4d hc;
-                        for (int d = 0; d < 4; ++d) hc[d] = (rel_centroid[d] + 1.0) / 2.0;
-                        tl.phys.push_back({prid, HilbertCurve4D::encode(hc, HilbertCurve4D::EntityType::Relation), rel_centroid, traj});
-                    }
-                    tl.rel.push_back({rid, prid});
-
-                    for (uint32_t ord = 0; ord < 2; ++ord) {
-                        const auto& cid = (ord == 0) ? scid : tcid;
-                        uint8_t sdata[37]; sdata[0] = 0x54;
-                        std::memcpy(sdata + 1, rid.data(), 16);
-                        std::memcpy(sdata + 17, cid.data(), 16);
-                        std::memcpy(sdata + 33, &ord, 4);
-                        tl.rel_seq.push_back({BLAKE3Pipeline::hash(sdata, 37), rid, cid, ord, 1});
-                    }
-
-                    double clamped_sim = std::clamp(static_cast<double>(sim), 0.0, 1.0);
-                    int32_t li = layer_index;
-                    std::vector<uint8_t> edata;
-                    edata.insert(edata.end(), model_id_.begin(), model_id_.end());
-                    edata.insert(edata.end(), rid.begin(), rid.end());
-                    edata.insert(edata.end(), type_tag.begin(), type_tag.end());
-                    edata.insert(edata.end(), reinterpret_cast<uint8_t*>(&li),
-                                 reinterpret_cast<uint8_t*>(&li) + sizeof(li));
-                    tl.ev.push_back({BLAKE3Pipeline::hash(edata.data(), edata.size()), model_id_, rid, true,
-                                     layer_elo + 200.0 * clamped_sim, clamped_sim});
-                    tl.relations_created++;
-                }
-                tl.rating.push_back({rid, 1, layer_elo + 200.0 * static_cast<double>(sim), 32.0});
+                targets.emplace_back(&it_t->second, sim);
             }
+            emit_edges(tl, scid, targets, layer_elo, 200.0, type_tag, layer_index);
         }
     }
 
-    delete alg_hnsw;
+    cached.reset();
 
     if (out_records) {
         out_records->insert(out_records->end(),
@@ -1053,20 +927,300 @@ void ModelIngester::extract_procedural_knn_streaming(
     }
 }
 
+bool ModelIngester::mine_pass(
+    const ProjectionPass& pass, const std::vector<std::string>& vocab, const Eigen::MatrixXf& norm_embeddings,
+    const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
+    ModelIngestionStats& stats, int layer_index, int total_layers, bool use_layer_sim, bool stream,
+    std::vector<ThreadLocalRecords>& out) {
+
+    if (use_layer_sim && pass.prev_weight &&
+        weight_similarity(pass.weight, pass.prev_weight) > 0.98 &&
+        (!pass.query_weight || weight_similarity(pass.query_weight, pass.prev_query) > 0.98)) {
+        return false;
+    }
+
+    const auto& params = *pass.params;
+    Eigen::MatrixXf W = tensor_to_matrix(pass.weight);
+
+    if (pass.query_weight) {
+        // Asymmetric, so there is no single-matrix streaming: Q and K are both materialized
+        Eigen::MatrixXf WQ = tensor_to_matrix(pass.query_weight);
+        Eigen::MatrixXf Q = norm_embeddings * WQ.transpose();
+        Eigen::MatrixXf K = norm_embeddings * W.transpose();
+        WQ.resize(0, 0);
+        W.resize(0, 0);
+        extract_procedural_knn(vocab, Q, K, pass.weight->name, token_to_comp, stats, pass.base_elo,
+                               pass.type_tag, layer_index, total_layers, params, &out);
+        return true;
+    }
+
+    if (stream) {
+        extract_procedural_knn_streaming(vocab, norm_embeddings, W, pass.weight->name, token_to_comp, stats,
+                                         pass.base_elo, pass.type_tag, layer_index, total_layers, params,
+                                         pass.sigmoid, &out);
+        return true;
+    }
+
+    Eigen::MatrixXf P = norm_embeddings * W.transpose();
+    W.resize(0, 0);
+    if (pass.sigmoid) P = P.array() / (1.0f + (-P.array()).exp());
+    extract_procedural_knn(vocab, P, P, pass.weight->name, token_to_comp, stats, pass.base_elo,
+                           pass.type_tag, layer_index, total_layers, params, &out);
+    return true;
+}
+
+void ModelIngester::mine_layers(
+    const std::vector<AttentionLayer>& attn_layers, const std::vector<FFNLayer>& ffn_layers,
+    const std::vector<std::string>& vocab, const Eigen::MatrixXf& norm_embeddings,
+    const std::unordered_map<std::string, BLAKE3Pipeline::Hash>& token_to_comp,
+    ModelIngestionStats& stats, bool use_layer_sim) {
+
+    const size_t budget = config_.memory_budget_bytes ? config_.memory_budget_bytes : default_memory_budget();
+    const size_t n = static_cast<size_t>(norm_embeddings.rows());
+    const size_t in_dim = static_cast<size_t>(norm_embeddings.cols());
+    const int max_threads = static_cast<int>(worker_threads());
+    auto t0 = Clock::now();
+
+    // The flush queue is bounded in records; it gets an eighth of the budget
+    AsyncFlusher::Options flush_opts = AsyncFlusher::Options::from_env();
+    flush_opts.max_queued_records = std::min(flush_opts.max_queued_records,
+                                             std::max<size_t>(100000, budget / 8 / QUEUED_RECORD_BYTES));
+
+    // Resident for the whole phase: normalized embeddings, token maps, the flush queue
+    size_t fixed = n * in_dim * sizeof(float) + n * TOKEN_STATE_BYTES +
+                   flush_opts.max_queued_records * QUEUED_RECORD_BYTES;
+    size_t avail = budget > fixed ? budget - fixed : 0;
+
+    // Progress is reported per layer, once its last pass lands
+    struct LayerProgress {
+        const char* kind;
+        int layer_index;
+        int total;
+        size_t remaining = 0;
+        size_t relations = 0;
+        std::string skipped;
+        Clock::time_point start{};
+    };
+    struct PassJob {
+        ProjectionPass pass;
+        std::string unit;      // Checkpoint unit
+        size_t layer;          // Into `layers`
+        bool stream;
+        int threads;
+        size_t peak_bytes;
+        size_t weight_bytes;   // Progress units: the tensors the pass projects
+        TensorDedup::Entry dedup;
+    };
+    struct PlannedLayer {
+        const char* kind;
+        int layer_index;
+        int total;
+        std::vector<ProjectionPass> passes;
+    };
+    std::vector<PlannedLayer> planned;
+    int total_attn = static_cast<int>(attn_layers.size());
+    for (size_t i = 0; i < attn_layers.size(); ++i)
+        planned.push_back({"Attention", attn_layers[i].layer_index, total_attn, attention_passes(attn_layers, i, config_)});
+    int total_ffn = static_cast<int>(ffn_layers.size());
+    for (size_t i = 0; i < ffn_layers.size(); ++i)
+        planned.push_back({"FFN", ffn_layers[i].layer_index, total_ffn, ffn_passes(ffn_layers, i, config_)});
+
+    // Digests and sketches of every pass, hashed in parallel before any is scheduled
+    std::vector<std::vector<TensorDedup::Entry>> described(planned.size());
+    if (dedup_.enabled()) {
+        std::vector<std::pair<size_t, size_t>> all;
+        for (size_t l = 0; l < planned.size(); ++l) {
+            described[l].resize(planned[l].passes.size());
+            for (size_t i = 0; i < planned[l].passes.size(); ++i) all.emplace_back(l, i);
+        }
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(max_threads)
+        for (size_t k = 0; k < all.size(); ++k) {
+            const auto [l, i] = all[k];
+            const auto& p = planned[l].passes[i];
+            try {
+                described[l][i] = dedup_.describe(*p.weight, p.query_weight, p.type_tag, planned[l].layer_index);
+            } catch (...) {}   // Left without a key: mined as usual
+            p.weight->release();
+            if (p.query_weight) p.query_weight->release();
+        }
+    }
+
+    std::vector<LayerProgress> layers;
+    std::vector<PassJob> jobs;
+    std::vector<TensorDedup::Entry> landed;   // Recorded once every batch is in
+    size_t resumed = 0, exact = 0, near = 0;
+
+    auto plan = [&](const PlannedLayer& planned_layer, std::vector<TensorDedup::Entry>& entries) {
+        LayerProgress layer;
+        layer.kind = planned_layer.kind;
+        layer.layer_index = planned_layer.layer_index;
+        layer.total = planned_layer.total;
+        for (size_t i = 0; i < planned_layer.passes.size(); ++i) {
+            const auto& p = planned_layer.passes[i];
+            TensorDedup::Entry entry = entries.empty() ? TensorDedup::Entry{} : std::move(entries[i]);
+            std::string unit = pass_unit(p);
+            if (checkpoint_.done(unit)) {
+                ++resumed;
+                landed.push_back(std::move(entry));
+                continue;
+            }
+            switch (dedup_.match(entry)) {
+            case TensorDedup::Match::Exact: ++exact; continue;
+            case TensorDedup::Match::Near: ++near; continue;
+            case TensorDedup::Match::None: break;
+            }
+            ++layer.remaining;
+            // Self-similarity passes stream their projection when materializing it would not fit
+            bool stream = !p.query_weight && (projection_bytes(p, n) > STREAMING_THRESHOLD_BYTES ||
+                                              pass_peak_bytes(p, n, in_dim, false) > avail);
+            // Touched tensor pages stay resident until the pass releases them
+            size_t mapped = 0;
+            for (auto* t : {p.weight, p.query_weight, use_layer_sim ? p.prev_weight : nullptr,
+                            use_layer_sim ? p.prev_query : nullptr}) {
+                if (t) mapped += t->raw_bytes;
+            }
+            size_t weight_bytes = p.weight->raw_bytes + (p.query_weight ? p.query_weight->raw_bytes : 0);
+            jobs.push_back({p, std::move(unit), layers.size(), stream, pass_threads(p, n, max_threads),
+                            pass_peak_bytes(p, n, in_dim, stream) + mapped, weight_bytes, std::move(entry)});
+        }
+        if (layer.remaining) layers.push_back(std::move(layer));
+    };
+    for (size_t l = 0; l < planned.size(); ++l) plan(planned[l], described[l]);
+    if (resumed) std::cout << "  Phase 3: " << resumed << " passes already ingested" << std::endl;
+    if (exact + near)
+        std::cout << "  Phase 3: " << (exact + near) << " passes match tensors already mined (" << exact
+                  << " exact, " << near << " near)" << std::endl;
+    if (jobs.empty()) {
+        dedup_.record(landed, model_id_);
+        return;
+    }
+
+    size_t peak = 0, weight_bytes = 0;
+    for (const auto& job : jobs) {
+        peak = std::max(peak, job.peak_bytes);
+        weight_bytes += job.weight_bytes;
+    }
+    if (progress_) progress_->phase("layer_mining", weight_bytes);
+    std::cout << "  Phase 3: Mining " << layers.size() << " layers (" << jobs.size() << " passes) on "
+              << max_threads << " threads within " << (budget >> 20) << "MB (~" << (peak >> 20)
+              << "MB largest pass, " << (fixed >> 20) << "MB resident)" << std::endl;
+    if (peak > avail) {
+        std::cerr << "  Warning: a pass needs ~" << ((fixed + peak) >> 20)
+                  << "MB, more than the memory budget" << std::endl;
+    }
+
+    // Jobs start in order as soon as their threads and bytes are free; a job
+    // that does not fit yet lets later, smaller ones start around it. One job
+    // always runs, even when it alone is over budget.
+    AsyncFlusher flusher(flush_opts);
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next = 0;
+    size_t running = 0;
+    int free_threads = max_threads;
+    size_t free_bytes = avail;
+    std::atomic<size_t> relations{0};
+    std::exception_ptr error;
+
+    auto worker = [&] {
+        // Nested regions stay serial; the share set below is this worker's whole team
+        apply_thread_config();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (next < jobs.size() && !error) {
+            const auto& job = jobs[next++];
+            cv.wait(lock, [&] {
+                return running == 0 || (job.threads <= free_threads && job.peak_bytes <= free_bytes);
+            });
+            int threads = std::min(job.threads, free_threads);
+            size_t bytes = std::min(job.peak_bytes, free_bytes);
+            free_threads -= threads;
+            free_bytes -= bytes;
+            ++running;
+            auto& layer = layers[job.layer];
+            if (layer.start == Clock::time_point{}) layer.start = Clock::now();
+            lock.unlock();
+
+            // OpenMP team sizes are per calling thread, so each job gets only its share of the cores
+            omp_set_num_threads(threads);
+            size_t pass_relations = 0;
+            bool mined = true;
+            try {
+                // Records are only held for the pass that found them; `stats` is untouched with an output vector
+                std::vector<ThreadLocalRecords> records;
+                mined = mine_pass(job.pass, vocab, norm_embeddings, token_to_comp, stats, layer.layer_index,
+                                  layer.total, use_layer_sim, job.stream, records);
+                uint64_t last_batch = 0;
+                for (auto& tl : records) {
+                    pass_relations += tl.relations_created;
+                    last_batch = std::max(last_batch, flusher.enqueue(to_batch(tl)));
+                }
+                // Done once its last batch lands; after any failed batch nothing more is trusted
+                checkpoint_.mined(job.unit, last_batch);
+                if (flusher.failed_batches() == 0) checkpoint_.flushed(flusher.flushed_through());
+            } catch (...) {
+                lock.lock();
+                if (!error) error = std::current_exception();
+                lock.unlock();
+            }
+            for (auto* t : {job.pass.weight, job.pass.query_weight, job.pass.prev_weight, job.pass.prev_query})
+                if (t) t->release();
+            relations += pass_relations;
+            if (progress_) progress_->advance(job.weight_bytes, pass_relations);
+
+            lock.lock();
+            free_threads += threads;
+            free_bytes += bytes;
+            --running;
+            layer.relations += pass_relations;
+            if (mined) landed.push_back(job.dedup);
+            if (!mined) layer.skipped += std::string(" (skip ") + job.pass.name + ")";
+            if (--layer.remaining == 0) {
+                std::cout << "    " << layer.kind << " Layer " << layer.layer_index << "/" << layer.total
+                          << layer.skipped << " (" << ms_since(layer.start) << "ms, " << layer.relations
+                          << " relations)" << std::endl;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t workers = std::min(jobs.size(), static_cast<size_t>(max_threads));
+    for (size_t t = 0; t < workers; ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+
+    flusher.wait_all();
+    if (flusher.failed_batches() == 0) checkpoint_.flushed(flusher.flushed_through());
+    flusher.print_metrics(std::cout);
+    stats.relations_created += relations.load();
+    if (size_t failed = flusher.failed_batches())
+        std::cerr << "  Warning: " << failed << " relation batches failed to flush" << std::endl;
+    if (error) std::rethrow_exception(error);
+    if (flusher.failed_batches() == 0) dedup_.record(landed, model_id_);
+    std::cout << "  Layer Mining Complete (" << ms_since(t0) << "ms)" << std::endl;
+}
+
 double ModelIngester::weight_similarity(const TensorData* a, const TensorData* b) {
     if (!a || !b || a->shape != b->shape || a->shape.size() != 2) return 0.0;
-    Eigen::Map<const Eigen::MatrixXf> ma(a->data.data(), a->shape[0], a->shape[1]);
-    Eigen::Map<const Eigen::MatrixXf> mb(b->data.data(), b->shape[0], b->shape[1]);
-    size_t stride = std::max(size_t(1), a->shape[0] / 512);
+    // Same sampling as a column-major view of the raw buffer, read element-wise
+    // from the tensors so nothing is materialized just to decide on a skip
+    size_t rows = a->shape[0];
+    size_t cols = a->shape[1];
+    size_t stride = std::max(size_t(1), rows / 512);
     double total = 0.0;
     int count = 0;
-    for (size_t i = 0; i < a->shape[0]; i += stride) {
-        auto ra = ma.row(i);
-        auto rb = mb.row(i);
-        float na = ra.norm();
-        float nb = rb.norm();
+    for (size_t i = 0; i < rows; i += stride) {
+        float dot = 0.0f, na2 = 0.0f, nb2 = 0.0f;
+        for (size_t j = 0; j < cols; ++j) {
+            float va = a->at(i + j * rows);
+            float vb = b->at(i + j * rows);
+            dot += va * vb;
+            na2 += va * va;
+            nb2 += vb * vb;
+        }
+        float na = std::sqrt(na2);
+        float nb = std::sqrt(nb2);
         if (na > 1e-8f && nb > 1e-8f) {
-            total += ra.dot(rb) / (na * nb);
+            total += dot / (na * nb);
             count++;
         }
     }
@@ -2,19 +2,26 @@
  * @file ngram_extractor.cpp
  * @brief Suffix array-based composition discovery
  *
- * Uses libdivsufsort for O(N log N) suffix array construction, Kasai's algorithm
- * for O(N) LCP array, then scans SA+LCP to discover all repeated substrings.
+ * Builds the suffix array by SA-IS over the codepoints and the LCP array by
+ * the parallel Φ method (suffix_array.hpp), then scans SA+LCP to discover all
+ * repeated substrings.
  * No arbitrary n-gram window. No co-occurrence computation.
- * Positions are stored so the caller can derive relations from adjacency.
+ * Positions are stored so the caller can derive relations from adjacency,
+ * gap-encoded or as references into the SA (PositionList).
  */
 
 #include <ingestion/ngram_extractor.hpp>
+#include <ingestion/suffix_array.hpp>
+#include <utils/metrics.hpp>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <chrono>
 #include <iostream>
 #include <iomanip>
-#include <divsufsort.h>
+#include <unordered_map>
+#include <vector>
 
 namespace Hartonomous {
 
@@ -23,24 +30,88 @@ static double ms_since(Clock::time_point t0) {
     return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
 }
 
+// ms_since(t0), also recorded as one observation of the phase's span
+static double ms_since(Clock::time_point t0, Metrics::Histogram& span) {
+    double ms = ms_since(t0);
+    span.observe_ms(ms);
+    return ms;
+}
+
 static BLAKE3Pipeline::Hash hash_codepoints(const char32_t* data, uint32_t len) {
     blake3_hasher hasher;
     blake3_hasher_init(&hasher);
-    for (uint32_t i = 0; i < len; ++i) {
-        char32_t cp = data[i];
-        uint8_t bytes[4] = {
-            static_cast<uint8_t>(cp & 0xFF),
-            static_cast<uint8_t>((cp >> 8) & 0xFF),
-            static_cast<uint8_t>((cp >> 16) & 0xFF),
-            static_cast<uint8_t>((cp >> 24) & 0xFF)
-        };
-        blake3_hasher_update(&hasher, bytes, 4);
+    if constexpr (std::endian::native == std::endian::little) {
+        // Codepoints already sit in memory as the little-endian bytes we hash
+        blake3_hasher_update(&hasher, data, size_t(len) * 4);
+    } else {
+        for (uint32_t i = 0; i < len; ++i) {
+            char32_t cp = data[i];
+            uint8_t bytes[4] = {
+                static_cast<uint8_t>(cp & 0xFF),
+                static_cast<uint8_t>((cp >> 8) & 0xFF),
+                static_cast<uint8_t>((cp >> 16) & 0xFF),
+                static_cast<uint8_t>((cp >> 24) & 0xFF)
+            };
+            blake3_hasher_update(&hasher, bytes, 4);
+        }
     }
     BLAKE3Pipeline::Hash hash;
     blake3_hasher_finalize(&hasher, hash.data(), BLAKE3Pipeline::HASH_SIZE);
     return hash;
 }
 
+static NGramExtractor::NGramId ngram_id(uint32_t n, uint32_t first) {
+    return (NGramExtractor::NGramId(n) << 32) | first;
+}
+
+// Codepoint counts around one group's sampled occurrences. At most ~128
+// occurrences are sampled per group, so a fixed open-addressing table at
+// half load holds them all; clearing touches only the slots used.
+class ContextCounter {
+public:
+    void add(char32_t cp) {
+        uint32_t h = (static_cast<uint32_t>(cp) * 2654435761u) >> (32 - BITS);
+        while (counts_[h] != 0 && keys_[h] != cp) h = (h + 1) & (SLOTS - 1);
+        if (counts_[h]++ == 0) {
+            keys_[h] = cp;
+            used_.push_back(static_cast<uint16_t>(h));
+        }
+    }
+    uint32_t distinct() const { return static_cast<uint32_t>(used_.size()); }
+    double entropy(uint32_t total) const {
+        if (total == 0) return 0.0;
+        double entropy = 0.0;
+        for (uint16_t h : used_) {
+            double p = static_cast<double>(counts_[h]) / total;
+            entropy -= p * std::log2(p);
+        }
+        return entropy;
+    }
+    void clear() {
+        for (uint16_t h : used_) counts_[h] = 0;
+        used_.clear();
+    }
+
+private:
+    static constexpr uint32_t BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << BITS;
+    std::array<char32_t, SLOTS> keys_{};
+    std::array<uint32_t, SLOTS> counts_{};
+    std::vector<uint16_t> used_;
+};
+
+// PMI of an n-gram's first codepoint against the rest
+static void set_pmi(NGram& ngram, uint32_t f_x, uint32_t f_y, uint64_t total) {
+    double p_xy = static_cast<double>(ngram.frequency) / total;
+    double p_x = static_cast<double>(f_x) / total;
+    double p_y = static_cast<double>(f_y) / total;
+    if (p_x > 0 && p_y > 0 && p_xy > 0) {
+        ngram.pmi = std::log2(p_xy / (p_x * p_y));
+        double log_pxy = -std::log2(p_xy);
+        ngram.npmi = (log_pxy > 0) ? ngram.pmi / log_pxy : 0.0;
+    }
+}
+
 std::string NGramExtractor::compute_pattern_signature(const std::u32string& text) {
     if (text.size() <= 1) return "";
     std::string sig;
@@ -60,73 +131,109 @@ std::string NGramExtractor::compute_pattern_signature(const std::u32string& text
     return sig;
 }
 
+const uint8_t* PositionStore::encode(const uint32_t* begin, const uint32_t* end) {
+    // A list lives in one block; blocks are filled up to their reserved
+    // capacity only, so earlier lists never move
+    constexpr size_t BLOCK_BYTES = size_t(1) << 20;
+    const size_t worst = size_t(end - begin) * 5;
+    if (blocks.empty() || blocks.back().capacity() - blocks.back().size() < worst) {
+        blocks.emplace_back();
+        blocks.back().reserve(std::max(BLOCK_BYTES, worst));
+    }
+    auto& block = blocks.back();
+    const size_t offset = block.size();
+    uint32_t prev = 0;
+    for (const uint32_t* p = begin; p != end; ++p) {
+        uint32_t gap = *p - prev;
+        prev = *p;
+        while (gap >= 0x80) {
+            block.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+        block.push_back(static_cast<uint8_t>(gap));
+    }
+    return block.data() + offset;
+}
+
 NGramExtractor::NGramExtractor(const NGramConfig& config) : config_(config) {}
 
 void NGramExtractor::extract(const std::u32string& text) {
+    clear();
     if (text.empty()) return;
     const uint32_t N = static_cast<uint32_t>(text.size());
     auto t_total = Clock::now();
+    static auto& span_sa = Metrics::global().span("ngram_suffix_array");
+    static auto& span_lcp = Metrics::global().span("ngram_lcp");
+    static auto& span_discover = Metrics::global().span("ngram_discovery");
+    static auto& span_hash = Metrics::global().span("ngram_hashes");
 
-    // === Phase 1: Serialize codepoints → big-endian bytes for divsufsort ===
+    // === Phase 1: Suffix array over the codepoints ===
     auto t0 = Clock::now();
-    const uint32_t byte_len = N * 4;
-    std::vector<uint8_t> bytes(byte_len);
-    for (uint32_t i = 0; i < N; ++i) {
-        char32_t cp = text[i];
-        bytes[i * 4 + 0] = static_cast<uint8_t>((cp >> 24) & 0xFF);
-        bytes[i * 4 + 1] = static_cast<uint8_t>((cp >> 16) & 0xFF);
-        bytes[i * 4 + 2] = static_cast<uint8_t>((cp >> 8) & 0xFF);
-        bytes[i * 4 + 3] = static_cast<uint8_t>(cp & 0xFF);
-    }
-    std::cout << "    [sa] serialize: " << std::fixed << std::setprecision(0)
-              << ms_since(t0) << "ms (" << N << " codepoints)" << std::endl;
+    auto store = std::make_shared<PositionStore>();
+    store->sa = build_suffix_array(text);
+    const std::vector<uint32_t>& cp_sa = store->sa;
+    std::cout << "    [sa] suffix array: " << std::fixed << std::setprecision(0)
+              << ms_since(t0, span_sa) << "ms (" << N << " codepoints)" << std::endl;
 
-    // === Phase 2: Build suffix array ===
+    // === Phase 2: LCP, capped at the longest composition we look for ===
     t0 = Clock::now();
-    std::vector<saidx_t> sa(byte_len);
-    if (divsufsort(bytes.data(), sa.data(), static_cast<saidx_t>(byte_len)) != 0) {
-        std::cerr << "    [sa] ERROR: divsufsort failed" << std::endl;
-        return;
-    }
-    std::cout << "    [sa] suffix array: " << ms_since(t0) << "ms" << std::endl;
+    std::vector<uint32_t> cp_lcp = build_lcp_array(text, cp_sa, config_.max_n);
+    std::cout << "    [sa] LCP: " << ms_since(t0, span_lcp) << "ms" << std::endl;
 
-    // === Phase 3: Build codepoint-aligned SA and LCP ===
-    t0 = Clock::now();
-
-    // Extract codepoint-aligned entries from byte SA
-    std::vector<uint32_t> cp_sa;
-    cp_sa.reserve(N);
-    for (int32_t i = 0; i < static_cast<int32_t>(byte_len); ++i) {
-        if (sa[i] % 4 == 0 && sa[i] + 4 <= static_cast<saidx_t>(byte_len)) {
-            cp_sa.push_back(static_cast<uint32_t>(sa[i] / 4));
-        }
-    }
-
-    // Free byte-level SA
-    { std::vector<uint8_t>().swap(bytes); }
-    { std::vector<saidx_t>().swap(sa); }
-
-    // Compute codepoint LCP between consecutive SA entries
-    std::vector<uint32_t> cp_lcp(cp_sa.size(), 0);
-    for (size_t i = 1; i < cp_sa.size(); ++i) {
-        uint32_t pos_a = cp_sa[i - 1];
-        uint32_t pos_b = cp_sa[i];
-        uint32_t max_cmp = std::min(N - pos_a, N - pos_b);
-        max_cmp = std::min(max_cmp, config_.max_n);
-        uint32_t l = 0;
-        while (l < max_cmp && text[pos_a + l] == text[pos_b + l]) ++l;
-        cp_lcp[i] = l;
-    }
-    std::cout << "    [sa] codepoint SA+LCP: " << ms_since(t0) << "ms ("
-              << cp_sa.size() << " entries)" << std::endl;
-
-    // === Phase 4: Discover compositions — all repeated substrings ===
+    // === Phase 3: Discover compositions — all repeated substrings ===
     // For each length n, scan through the SA. Groups of consecutive entries
     // with LCP >= n share the same n-length prefix = same composition.
     t0 = Clock::now();
     uint64_t total_discovered = 0;
     uint64_t total_promoted = 0;
 
+    // SA rank of each position, and the groups found at each length as
+    // (first SA index, frequency) in SA order: the group an n-gram's suffix
+    // belongs to is then a binary search, not a content lookup
+    std::vector<uint32_t> rank(N);
+    #pragma omp parallel for schedule(static)
+    for (int64_t r = 0; r < static_cast<int64_t>(N); ++r) rank[cp_sa[r]] = static_cast<uint32_t>(r);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> groups(config_.max_n + 1);
+    auto frequency_at = [&](uint32_t n, uint32_t pos) {
+        const auto& g = groups[n];
+        auto it = std::upper_bound(g.begin(), g.end(), rank[pos],
+                                   [](uint32_t r, const std::pair<uint32_t, uint32_t>& e) { return r < e.first; });
+        return it == g.begin() ? 0u : std::prev(it)->second;
+    };
+
+    // Entropy of the codepoints around a group's occurrences (sampled),
+    // while the group is at hand
+    auto set_context = [&](NGram& ngram, size_t i, size_t j, uint32_t n, ContextCounter& left, ContextCounter& right) {
+        left.clear();
+        right.clear();
+        uint32_t sample_step = std::max(1u, ngram.frequency / 64);
+        for (size_t k = i; k < j; k += sample_step) {
+            uint32_t p = cp_sa[k];
+            if (p > 0) left.add(text[p - 1]);
+            if (p + n < N) right.add(text[p + n]);
+        }
+        ngram.left_entropy = left.entropy(ngram.frequency);
+        ngram.right_entropy = right.entropy(ngram.frequency);
+        ngram.branching_factor = right.distinct();
+    };
+
+    // Occurrences of the group [i, j)
+    const bool interval = config_.position_storage == PositionStorage::Interval;
+    std::vector<uint32_t> scratch;
+    auto set_positions = [&](NGram& ngram, size_t i, size_t j) {
+        if (!config_.track_positions) return;
+        const auto freq = static_cast<uint32_t>(j - i);
+        if (interval) {
+            ngram.positions = PositionList(store, cp_sa.data() + i, freq);
+            return;
+        }
+        scratch.assign(cp_sa.begin() + i, cp_sa.begin() + j);
+        std::sort(scratch.begin(), scratch.end());
+        ngram.positions = PositionList(store, store->encode(scratch.data(), scratch.data() + freq), freq);
+    };
+
+    ContextCounter left, right;
+
     // Unigrams first — always included (every codepoint is an atom)
     for (size_t i = 0; i < cp_sa.size(); ) {
         uint32_t pos = cp_sa[i];
@@ -137,39 +244,30 @@ void NGramExtractor::extract(const std::u32string& text) {
         while (j < cp_sa.size() && cp_lcp[j] >= 1 && text[cp_sa[j]] == cp) ++j;
         
         uint32_t freq = static_cast<uint32_t>(j - i);
-        auto hash = hash_codepoints(&text[pos], 1);
+        const auto id = ngram_id(1, static_cast<uint32_t>(i));
+        groups[1].emplace_back(static_cast<uint32_t>(i), freq);
         
-        auto& ngram = ngrams_[hash];
-        if (ngram.frequency == 0) {
-            ngram.text = text.substr(pos, 1);
-            ngram.hash = hash;
-            ngram.n = 1;
-        }
+        auto& ngram = ngrams_[id];
+        ngram.text = text.substr(pos, 1);
+        ngram.n = 1;
         ngram.frequency = freq;
         total_unigrams_ += freq;
         
-        // Store positions for unigrams
-        if (config_.track_positions) {
-            ngram.positions.reserve(freq);
-            for (size_t k = i; k < j; ++k) ngram.positions.push_back(cp_sa[k]);
-            std::sort(ngram.positions.begin(), ngram.positions.end());
-        }
+        set_positions(ngram, i, j);
         
-        // Context for entropy
-        uint32_t sample_step = std::max(1u, freq / 64);
-        for (size_t k = i; k < j; k += sample_step) {
-            uint32_t p = cp_sa[k];
-            if (p > 0) left_context_[hash][text[p - 1]]++;
-            if (p + 1 < N) right_context_[hash][text[p + 1]]++;
-        }
+        set_context(ngram, i, j, 1, left, right);
         
         total_discovered++;
         i = j;
     }
 
-    // Multi-codepoint compositions: scan for repeated substrings of length 2..max_n
+    // Multi-codepoint compositions: scan for repeated substrings of length 2..max_n.
+    // The scan for groups is sequential; their metrics depend only on the
+    // group and the shorter lengths, so they are computed in parallel.
+    std::vector<std::pair<uint32_t, uint32_t>> found;  // [i, j) per group kept at this length
+    std::vector<NGram> batch;
     for (uint32_t n = 2; n <= config_.max_n; ++n) {
-        size_t groups_at_length = 0;
+        found.clear();
         size_t i = 0;
         while (i < cp_sa.size()) {
             if (cp_sa[i] + n > N) { ++i; continue; }
@@ -180,126 +278,120 @@ void NGramExtractor::extract(const std::u32string& text) {
 
             uint32_t freq = static_cast<uint32_t>(j - i);
             if (freq >= config_.min_frequency) {
-                uint32_t pos = cp_sa[i];
-                auto hash = hash_codepoints(text.data() + pos, n);
-
-                auto& ngram = ngrams_[hash];
-                if (ngram.frequency == 0) {
-                    ngram.text = text.substr(pos, n);
-                    ngram.hash = hash;
-                    ngram.n = n;
-                    
-                    // RLE detection
-                    bool all_same = true;
-                    for (uint32_t k = 1; k < n; ++k) {
-                        if (text[pos + k] != text[pos]) { all_same = false; break; }
-                    }
-                    ngram.is_rle = all_same;
-                    
-                    // Pattern signature
-                    if (n >= 2 && n <= 32) {
-                        ngram.pattern_signature = compute_pattern_signature(ngram.text);
-                    }
-                }
-                ngram.frequency = freq;
-
-                // Store positions
-                if (config_.track_positions) {
-                    ngram.positions.reserve(freq);
-                    for (size_t k = i; k < j; ++k) ngram.positions.push_back(cp_sa[k]);
-                    std::sort(ngram.positions.begin(), ngram.positions.end());
-                }
-
-                // Context for entropy (sampled)
-                uint32_t sample_step = std::max(1u, freq / 64);
-                for (size_t k = i; k < j; k += sample_step) {
-                    uint32_t p = cp_sa[k];
-                    if (p > 0) left_context_[hash][text[p - 1]]++;
-                    if (p + n < N) right_context_[hash][text[p + n]]++;
-                }
-
-                groups_at_length++;
-                total_promoted++;
+                groups[n].emplace_back(static_cast<uint32_t>(i), freq);
+                found.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(j));
             }
             total_discovered++;
             i = j;
         }
-        
+
         // Early termination: if no compositions found at this length, longer ones won't exist either
-        if (groups_at_length == 0) {
+        if (found.empty()) {
             std::cout << "    [sa] no compositions at length " << n << ", stopping" << std::endl;
             break;
         }
+
+        batch.assign(found.size(), NGram{});
+        #pragma omp parallel
+        {
+            ContextCounter thread_left, thread_right;
+            #pragma omp for schedule(dynamic, 256)
+            for (int64_t g = 0; g < static_cast<int64_t>(found.size()); ++g) {
+                const auto [gi, gj] = found[g];
+                const uint32_t pos = cp_sa[gi];
+                auto& ngram = batch[g];
+                ngram.text = text.substr(pos, n);
+                ngram.n = n;
+                ngram.frequency = gj - gi;
+
+                // RLE detection
+                bool all_same = true;
+                for (uint32_t k = 1; k < n; ++k) {
+                    if (text[pos + k] != text[pos]) { all_same = false; break; }
+                }
+                ngram.is_rle = all_same;
+
+                // Pattern signature
+                if (n <= 32) ngram.pattern_signature = compute_pattern_signature(ngram.text);
+
+                // The suffix occurs at least as often, so its group was kept at n - 1
+                set_pmi(ngram, frequency_at(1, pos), frequency_at(n - 1, pos + 1), N);
+
+                set_context(ngram, gi, gj, n, thread_left, thread_right);
+            }
+        }
+
+        for (size_t g = 0; g < found.size(); ++g) {
+            auto& ngram = ngrams_[ngram_id(n, found[g].first)];
+            ngram = std::move(batch[g]);
+            set_positions(ngram, found[g].first, found[g].second);
+        }
+        total_promoted += found.size();
     }
-    std::cout << "    [sa] composition discovery: " << ms_since(t0) << "ms ("
+    { std::vector<NGram>().swap(batch); }
+    std::cout << "    [sa] composition discovery: " << ms_since(t0, span_discover) << "ms ("
               << total_discovered << " scanned, " << total_promoted << " promoted, "
               << ngrams_.size() << " total stored)" << std::endl;
 
-    // Free SA/LCP
-    { std::vector<uint32_t>().swap(cp_sa); }
+    // Free SA/LCP; in Interval mode the n-grams keep the SA alive
+    { std::vector<uint32_t>().swap(scratch); }
+    if (!interval) std::vector<uint32_t>().swap(store->sa);
+    store.reset();
     { std::vector<uint32_t>().swap(cp_lcp); }
+    { std::vector<uint32_t>().swap(rank); }
 
-    // === Phase 5: Finalize metrics (PMI, entropy, branching factor) ===
+    // === Phase 4: Content hashes of the significant compositions ===
     t0 = Clock::now();
-    finalize_metrics();
-    std::cout << "    [sa] finalize metrics: " << ms_since(t0) << "ms" << std::endl;
+    hash_significant();
+    std::cout << "    [sa] content hashes: " << ms_since(t0, span_hash) << "ms" << std::endl;
 
     std::cout << "    [sa] TOTAL: " << ms_since(t_total) << "ms" << std::endl;
 }
 
-double NGramExtractor::calculate_entropy(const std::unordered_map<char32_t, uint32_t>& counts, uint32_t total) {
-    if (total == 0) return 0.0;
-    double entropy = 0.0;
-    for (const auto& [cp, count] : counts) {
-        double p = static_cast<double>(count) / total;
-        entropy -= p * std::log2(p);
+void NGramExtractor::hash_significant() {
+    // Content hashes only for what callers will store
+    if constexpr (std::endian::native != std::endian::little) {
+        for (auto& [id, ngram] : ngrams_)
+            if (is_significant(ngram)) ngram.hash = hash_codepoints(ngram.text.data(), ngram.n);
+        return;
     }
-    return entropy;
-}
 
-void NGramExtractor::finalize_metrics() {
-    if (total_unigrams_ == 0) return;
-
-    for (auto& [hash, ngram] : ngrams_) {
-        ngram.left_entropy = calculate_entropy(left_context_[hash], ngram.frequency);
-        ngram.right_entropy = calculate_entropy(right_context_[hash], ngram.frequency);
-        ngram.branching_factor = static_cast<uint32_t>(right_context_[hash].size());
-
-        if (ngram.n >= 2) {
-            auto hash_f = hash_codepoints(&ngram.text[0], 1);
-            auto hash_r = hash_codepoints(&ngram.text[1], ngram.n - 1);
-
-            auto it_f = ngrams_.find(hash_f);
-            auto it_r = ngrams_.find(hash_r);
-
-            if (it_f != ngrams_.end() && it_r != ngrams_.end()) {
-                double p_xy = static_cast<double>(ngram.frequency) / total_unigrams_;
-                double p_x = static_cast<double>(it_f->second.frequency) / total_unigrams_;
-                double p_y = static_cast<double>(it_r->second.frequency) / total_unigrams_;
-                if (p_x > 0 && p_y > 0 && p_xy > 0) {
-                    ngram.pmi = std::log2(p_xy / (p_x * p_y));
-                    double log_pxy = -std::log2(p_xy);
-                    ngram.npmi = (log_pxy > 0) ? ngram.pmi / log_pxy : 0.0;
-                }
-            }
+    // Equal lengths pack into one buffer and hash across SIMD lanes; the bytes
+    // are those hash_codepoints() feeds BLAKE3, so the hashes are the same
+    std::unordered_map<uint32_t, std::vector<NGram*>> by_length;
+    for (auto& [id, ngram] : ngrams_)
+        if (is_significant(ngram)) by_length[ngram.n].push_back(&ngram);
+
+    constexpr size_t BATCH = 256;
+    std::vector<char32_t> packed;
+    std::array<BLAKE3Pipeline::Hash, BATCH> hashes;
+    for (auto& [n, group] : by_length) {
+        for (size_t begin = 0; begin < group.size(); begin += BATCH) {
+            const size_t count = std::min(BATCH, group.size() - begin);
+            packed.resize(count * n);
+            for (size_t i = 0; i < count; ++i)
+                std::copy_n(group[begin + i]->text.data(), n, packed.data() + i * n);
+            BLAKE3Pipeline::hash_many_fixed(reinterpret_cast<const uint8_t*>(packed.data()), size_t(n) * 4,
+                                            size_t(n) * 4, count, hashes.data());
+            for (size_t i = 0; i < count; ++i) group[begin + i]->hash = hashes[i];
         }
     }
-    left_context_.clear();
-    right_context_.clear();
 }
 
-std::vector<const NGram*> NGramExtractor::significant_ngrams() const {
-    std::vector<const NGram*> result;
-    for (const auto& [hash, ngram] : ngrams_) {
-        if (ngram.n == 1) { result.push_back(&ngram); continue; }
+bool NGramExtractor::is_significant(const NGram& ngram) const {
+    if (ngram.n == 1) return true;
 
-        bool sig = ngram.frequency >= config_.min_frequency &&
-                   ngram.npmi >= config_.min_npmi &&
-                   (ngram.left_entropy >= config_.min_entropy || ngram.right_entropy >= config_.min_entropy) &&
-                   ngram.branching_factor <= config_.max_branching_factor;
+    bool sig = ngram.frequency >= config_.min_frequency &&
+               ngram.npmi >= config_.min_npmi &&
+               (ngram.left_entropy >= config_.min_entropy || ngram.right_entropy >= config_.min_entropy) &&
+               ngram.branching_factor <= config_.max_branching_factor;
+    return sig || ngram.is_rle;
+}
 
-        if (sig || ngram.is_rle) result.push_back(&ngram);
-    }
+std::vector<const NGram*> NGramExtractor::significant_ngrams() const {
+    std::vector<const NGram*> result;
+    for (const auto& [id, ngram] : ngrams_)
+        if (is_significant(ngram)) result.push_back(&ngram);
     std::sort(result.begin(), result.end(), [](const NGram* a, const NGram* b) {
         if (a->n != b->n) return a->n > b->n;  // Longer compositions first
         if (a->frequency != b->frequency) return a->frequency > b->frequency;
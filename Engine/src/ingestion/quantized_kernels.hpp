@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * @file quantized_kernels.hpp
+ * @brief Per-ISA inner-product kernels behind QuantizedIPSpace
+ *
+ * Same signature as hnswlib::DISTFUNC; param points at the padded element
+ * count, so no kernel handles a tail. quantized_space_avx2.cpp and
+ * quantized_space_avx512.cpp are built with their own -m flags and the
+ * space picks one from simd_level() when it is constructed.
+ */
+
+namespace Hartonomous::quantized_kernels {
+
+// FP16: needs F16C and FMA alongside AVX2
+float ip_distance_fp16_avx2(const void* a, const void* b, const void* param);
+float ip_distance_fp16_avx512(const void* a, const void* b, const void* param);
+
+// Int8 codes followed by the float scale
+float ip_distance_int8_avx2(const void* a, const void* b, const void* param);
+float ip_distance_int8_avx512(const void* a, const void* b, const void* param);
+float ip_distance_int8_avx512vnni(const void* a, const void* b, const void* param);
+
+} // namespace Hartonomous::quantized_kernels
@@ -0,0 +1,184 @@
+/**
+ * @file quantized_space.cpp
+ * @brief FP16 and int8 inner-product kernels and encoders
+ */
+
+#include <ingestion/quantized_space.hpp>
+#include "ingestion/quantized_kernels.hpp"
+#include <utils/cpu_dispatch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace Hartonomous {
+
+// Stored vectors are padded to these many elements so kernels need no tail
+static constexpr size_t FP16_PAD = 16;
+static constexpr size_t INT8_PAD = 64;
+
+static size_t round_up(size_t n, size_t w) { return (n + w - 1) / w * w; }
+
+// Portable kernels; the per-ISA ones are in quantized_space_avx2.cpp / _avx512.cpp
+static float ip_distance_fp16(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const uint16_t*>(a);
+    const auto* y = static_cast<const uint16_t*>(b);
+    float dot = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+        dot += QuantizedIPSpace::half_to_float(x[i]) * QuantizedIPSpace::half_to_float(y[i]);
+    return 1.0f - dot;
+}
+
+// Layout: n int8 codes, then the float scale
+static float ip_distance_int8(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const int8_t*>(a);
+    const auto* y = static_cast<const int8_t*>(b);
+    int32_t dot = 0;
+    for (size_t i = 0; i < n; ++i) dot += int32_t(x[i]) * int32_t(y[i]);
+    float sx, sy;
+    std::memcpy(&sx, x + n, sizeof(float));
+    std::memcpy(&sy, y + n, sizeof(float));
+    return 1.0f - sx * sy * static_cast<float>(dot);
+}
+
+static hnswlib::DISTFUNC<float> fp16_kernel() {
+#if defined(HARTONOMOUS_X86_KERNELS)
+    const SimdLevel simd = simd_level();
+    if (simd >= SimdLevel::Avx512) return quantized_kernels::ip_distance_fp16_avx512;
+    if (simd >= SimdLevel::Avx2) return quantized_kernels::ip_distance_fp16_avx2;
+#endif
+    return ip_distance_fp16;
+}
+
+static hnswlib::DISTFUNC<float> int8_kernel() {
+#if defined(HARTONOMOUS_X86_KERNELS)
+    const SimdLevel simd = simd_level();
+    if (simd >= SimdLevel::Avx512)
+        return CpuFeatures::host().avx512vnni ? quantized_kernels::ip_distance_int8_avx512vnni
+                                              : quantized_kernels::ip_distance_int8_avx512;
+    if (simd >= SimdLevel::Avx2) return quantized_kernels::ip_distance_int8_avx2;
+#endif
+    return ip_distance_int8;
+}
+
+QuantizedIPSpace::QuantizedIPSpace(size_t dim, HnswQuantization quantization)
+    : dim_(dim), quantization_(quantization) {
+    switch (quantization) {
+        case HnswQuantization::Float32:
+            float_space_ = std::make_unique<hnswlib::InnerProductSpace>(dim);
+            padded_ = dim;
+            data_size_ = float_space_->get_data_size();
+            dist_ = float_space_->get_dist_func();
+            break;
+        case HnswQuantization::FP16:
+            padded_ = round_up(dim, FP16_PAD);
+            data_size_ = padded_ * sizeof(uint16_t);
+            dist_ = fp16_kernel();
+            break;
+        case HnswQuantization::Int8:
+            padded_ = round_up(dim, INT8_PAD);
+            data_size_ = padded_ + sizeof(float);
+            dist_ = int8_kernel();
+            break;
+        default:
+            throw std::runtime_error("QuantizedIPSpace: unknown quantization");
+    }
+}
+
+void* QuantizedIPSpace::get_dist_func_param() {
+    return float_space_ ? float_space_->get_dist_func_param() : &padded_;
+}
+
+void QuantizedIPSpace::encode(const float* src, void* dst) const {
+    switch (quantization_) {
+        case HnswQuantization::Float32: {
+            auto* out = static_cast<float*>(dst);
+            for (size_t i = 0; i < dim_; ++i) out[i] = src[i];
+            break;
+        }
+        case HnswQuantization::FP16: {
+            auto* out = static_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < dim_; ++i) out[i] = float_to_half(src[i]);
+            std::fill(out + dim_, out + padded_, uint16_t(0));
+            break;
+        }
+        case HnswQuantization::Int8: {
+            // Symmetric per-vector scale: the largest magnitude maps to 127
+            float maxabs = 0.0f;
+            for (size_t i = 0; i < dim_; ++i) maxabs = std::max(maxabs, std::fabs(src[i]));
+            float scale = maxabs / 127.0f;
+            float inv = maxabs > 0.0f ? 127.0f / maxabs : 0.0f;
+            auto* out = static_cast<int8_t*>(dst);
+            for (size_t i = 0; i < dim_; ++i)
+                out[i] = static_cast<int8_t>(std::clamp(std::lrintf(src[i] * inv), -127L, 127L));
+            std::fill(out + dim_, out + padded_, int8_t(0));
+            std::memcpy(out + padded_, &scale, sizeof(float));
+            break;
+        }
+    }
+}
+
+uint16_t QuantizedIPSpace::float_to_half(float f) {
+#if defined(__F16C__)
+    return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t mant = x & 0x7FFFFF;
+    int32_t exp = static_cast<int32_t>((x >> 23) & 0xFF);
+    if (exp == 0xFF) return static_cast<uint16_t>(sign | 0x7C00 | (mant ? 0x200 : 0));
+
+    int32_t e = exp - 127 + 15;
+    if (e >= 0x1F) return static_cast<uint16_t>(sign | 0x7C00);
+    if (e <= 0) {
+        // Subnormal half: shift the full 24-bit significand into place, rounding to even
+        if (e < -10) return static_cast<uint16_t>(sign);
+        mant |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - e);
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (half & 1))) ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = sign | (static_cast<uint32_t>(e) << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) ++half;  // A carry rolls into the exponent
+    return static_cast<uint16_t>(half);
+#endif
+}
+
+float QuantizedIPSpace::half_to_float(uint16_t h) {
+#if defined(__F16C__)
+    return _cvtsh_ss(h);
+#else
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t bits;
+    if (exp == 0) {
+        if (mant == 0) {
+            bits = sign;
+        } else {
+            float f = std::ldexp(static_cast<float>(mant), -24);
+            return sign ? -f : f;
+        }
+    } else if (exp == 0x1F) {
+        bits = sign | 0x7F800000 | (mant << 13);
+    } else {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+#endif
+}
+
+} // namespace Hartonomous
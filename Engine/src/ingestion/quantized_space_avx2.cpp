@@ -0,0 +1,55 @@
+/**
+ * @file quantized_space_avx2.cpp
+ * @brief FP16 and int8 inner-product kernels (built with AVX2, FMA and F16C flags)
+ */
+
+#include "ingestion/quantized_kernels.hpp"
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Hartonomous::quantized_kernels {
+
+float ip_distance_fp16_avx2(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const uint16_t*>(a);
+    const auto* y = static_cast<const uint16_t*>(b);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (size_t i = 0; i < n; i += 16) {
+        __m256 x0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        __m256 y0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        __m256 x1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i + 8)));
+        __m256 y1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i + 8)));
+        acc0 = _mm256_fmadd_ps(x0, y0, acc0);
+        acc1 = _mm256_fmadd_ps(x1, y1, acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_hadd_ps(s, s);
+    s = _mm_hadd_ps(s, s);
+    return 1.0f - _mm_cvtss_f32(s);
+}
+
+float ip_distance_int8_avx2(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const int8_t*>(a);
+    const auto* y = static_cast<const int8_t*>(b);
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 16) {
+        __m256i xw = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        __m256i yw = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(xw, yw));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_hadd_epi32(s, s);
+    s = _mm_hadd_epi32(s, s);
+    const int32_t dot = _mm_cvtsi128_si32(s);
+    float sx, sy;
+    std::memcpy(&sx, x + n, sizeof(float));
+    std::memcpy(&sy, y + n, sizeof(float));
+    return 1.0f - sx * sy * static_cast<float>(dot);
+}
+
+} // namespace Hartonomous::quantized_kernels
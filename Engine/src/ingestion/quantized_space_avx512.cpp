@@ -0,0 +1,71 @@
+/**
+ * @file quantized_space_avx512.cpp
+ * @brief FP16 and int8 inner-product kernels (built with AVX-512 F/BW/DQ/VL flags)
+ *
+ * VNNI is not implied by the rest of AVX-512 (Skylake-SP lacks it), so the
+ * VNNI kernel carries its own target attribute and is only picked when
+ * CpuFeatures reports it.
+ */
+
+#include "ingestion/quantized_kernels.hpp"
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Hartonomous::quantized_kernels {
+
+namespace {
+
+inline float int8_distance(const int8_t* x, const int8_t* y, size_t n, int32_t dot) {
+    float sx, sy;
+    std::memcpy(&sx, x + n, sizeof(float));
+    std::memcpy(&sy, y + n, sizeof(float));
+    return 1.0f - sx * sy * static_cast<float>(dot);
+}
+
+} // namespace
+
+float ip_distance_fp16_avx512(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const uint16_t*>(a);
+    const auto* y = static_cast<const uint16_t*>(b);
+    __m512 acc = _mm512_setzero_ps();
+    for (size_t i = 0; i < n; i += 16) {
+        __m512 xv = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+        __m512 yv = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        acc = _mm512_fmadd_ps(xv, yv, acc);
+    }
+    return 1.0f - _mm512_reduce_add_ps(acc);
+}
+
+float ip_distance_int8_avx512(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const int8_t*>(a);
+    const auto* y = static_cast<const int8_t*>(b);
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < n; i += 32) {
+        __m512i xw = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+        __m512i yw = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(xw, yw));
+    }
+    return int8_distance(x, y, n, _mm512_reduce_add_epi32(acc));
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx512vnni")))
+#endif
+float ip_distance_int8_avx512vnni(const void* a, const void* b, const void* param) {
+    const size_t n = *static_cast<const size_t*>(param);
+    const auto* x = static_cast<const int8_t*>(a);
+    const auto* y = static_cast<const int8_t*>(b);
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < n; i += 32) {
+        __m512i xw = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+        __m512i yw = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        acc = _mm512_dpwssd_epi32(acc, xw, yw);
+    }
+    return int8_distance(x, y, n, _mm512_reduce_add_epi32(acc));
+}
+
+} // namespace Hartonomous::quantized_kernels
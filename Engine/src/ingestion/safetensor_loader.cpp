@@ -5,13 +5,24 @@
 
 #include <ingestion/safetensor_loader.hpp>
 #include <ingestion/text_ingester.hpp>
+#include "ingestion/tensor_convert_kernels.hpp"
+#include <utils/cpu_dispatch.hpp>
 #include <fstream>
 #include <sstream>
 #include <cstring>
 #include <set>
 #include <regex>
 #include <algorithm>
+#include <cerrno>
 #include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 using json = nlohmann::json;
 
@@ -19,11 +30,183 @@ namespace Hartonomous {
 
 using namespace std;
 
-SafetensorLoader::SafetensorLoader(const std::string& model_dir) : model_dir_(model_dir) {
+// Rows converted per block when a consumer reads a whole tensor
+static constexpr size_t CONVERT_BLOCK_BYTES = 4 * 1024 * 1024;
+
+static size_t dtype_size(const std::string& dtype) {
+    if (dtype == "F32" || dtype == "I32") return 4;
+    if (dtype == "F16" || dtype == "BF16") return 2;
+    if (dtype == "F64" || dtype == "I64") return 8;
+    return 0;
+}
+
+// FP16 to FP32 conversion (IEEE 754)
+static inline float half_to_float(uint16_t h) {
+    uint32_t s = (h >> 15) & 0x0001;
+    uint32_t e = (h >> 10) & 0x001F;
+    uint32_t m = h & 0x03FF;
+
+    if (e == 0) {
+        if (m == 0) {
+            // Zero
+            uint32_t val = s << 31;
+            float f;
+            std::memcpy(&f, &val, 4);
+            return f;
+        } else {
+            // Denormalized
+            return (s ? -1.0f : 1.0f) * std::ldexp((float)m, -24);
+        }
+    } else if (e == 31) {
+        // Inf or NaN
+        uint32_t val = (s << 31) | 0x7F800000 | (m << 13);
+        float f;
+        std::memcpy(&f, &val, 4);
+        return f;
+    } else {
+        // Normalized
+        uint32_t val = (s << 31) | ((e + 112) << 23) | (m << 13);
+        float f;
+        std::memcpy(&f, &val, 4);
+        return f;
+    }
+}
+
+static void f16_to_float(const uint8_t* src, size_t count, float* out) {
+    size_t i = 0;
+#if defined(HARTONOMOUS_X86_KERNELS)
+    const SimdLevel simd = simd_level();
+    if (simd >= SimdLevel::Avx512) return convert_kernels::f16_to_f32_avx512(src, count, out);
+    if (simd >= SimdLevel::Avx2) return convert_kernels::f16_to_f32_avx2(src, count, out);
+#elif defined(__aarch64__)
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t h = vld1q_u16(reinterpret_cast<const uint16_t*>(src + i * 2));
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(out + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+#endif
+    for (; i < count; ++i) {
+        uint16_t h;
+        std::memcpy(&h, src + i * 2, 2);
+        out[i] = half_to_float(h);
+    }
+}
+
+// Convert `count` elements of `dtype` starting at `src` into float32.
+// Source pointers into the mapping carry no alignment guarantee, so every
+// element is loaded with memcpy (or an unaligned vector load).
+static void convert_to_float(const std::string& dtype, const uint8_t* src, size_t count, float* out) {
+    if (dtype == "F32") {
+        std::memcpy(out, src, count * sizeof(float));
+    } else if (dtype == "F16") {
+        f16_to_float(src, count, out);
+    } else if (dtype == "BF16") {
+        // BF16: same exponent range as F32, just truncated mantissa.
+        // The portable loop vectorizes on aarch64 as it stands.
+#if defined(HARTONOMOUS_X86_KERNELS)
+        const SimdLevel simd = simd_level();
+        if (simd >= SimdLevel::Avx512) return convert_kernels::bf16_to_f32_avx512(src, count, out);
+        if (simd >= SimdLevel::Avx2) return convert_kernels::bf16_to_f32_avx2(src, count, out);
+#endif
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t b;
+            std::memcpy(&b, src + i * 2, 2);
+            uint32_t val = static_cast<uint32_t>(b) << 16;
+            std::memcpy(&out[i], &val, 4);
+        }
+    } else if (dtype == "F64") {
+        for (size_t i = 0; i < count; ++i) {
+            double d;
+            std::memcpy(&d, src + i * 8, 8);
+            out[i] = static_cast<float>(d);
+        }
+    } else if (dtype == "I32") {
+        for (size_t i = 0; i < count; ++i) {
+            int32_t v;
+            std::memcpy(&v, src + i * 4, 4);
+            out[i] = static_cast<float>(v);
+        }
+    } else if (dtype == "I64") {
+        for (size_t i = 0; i < count; ++i) {
+            int64_t v;
+            std::memcpy(&v, src + i * 8, 8);
+            out[i] = static_cast<float>(v);
+        }
+    } else {
+        // Unsupported dtype, fill with zeros
+        std::fill(out, out + count, 0.0f);
+    }
+}
+
+// convert_to_float in CONVERT_BLOCK_BYTES pieces across threads, unless the
+// caller already runs on a parallel team (per-layer mining, eager loading)
+static void convert_blocks(const std::string& dtype, const uint8_t* src, size_t count, float* out) {
+    const size_t elem = std::max<size_t>(1, dtype_size(dtype));
+    const size_t block = std::max<size_t>(1, CONVERT_BLOCK_BYTES / elem);
+    const auto blocks = static_cast<int64_t>((count + block - 1) / block);
+    if (blocks < 2 || omp_in_parallel()) {
+        convert_to_float(dtype, src, count, out);
+        return;
+    }
+    #pragma omp parallel for schedule(static)
+    for (int64_t b = 0; b < blocks; ++b) {
+        const size_t first = static_cast<size_t>(b) * block;
+        convert_to_float(dtype, src + first * elem, std::min(block, count - first), out + first);
+    }
+}
+
+void TensorData::read_rows(size_t row_begin, size_t row_count, float* out) const {
+    size_t row_len = row_elements();
+    size_t rows = shape.empty() ? 1 : shape[0];
+    if (row_begin + row_count > rows) {
+        throw std::out_of_range("Row range out of bounds for tensor " + name);
+    }
+    size_t offset = row_begin * row_len;
+    size_t count = row_count * row_len;
+
+    if (!is_mapped()) {
+        std::copy(data.begin() + offset, data.begin() + offset + count, out);
+        return;
+    }
+    convert_blocks(dtype, raw + offset * dtype_size(dtype), count, out);
+}
+
+void TensorData::read_all(float* out) const {
+    if (!is_mapped()) {
+        std::copy(data.begin(), data.end(), out);
+        return;
+    }
+    convert_blocks(dtype, raw, total_elements(), out);
+}
+
+float TensorData::at(size_t index) const {
+    if (!is_mapped()) return data[index];
+    float f;
+    convert_to_float(dtype, raw + index * dtype_size(dtype), 1, &f);
+    return f;
+}
+
+void TensorData::release() const {
+    if (!is_mapped() || raw_bytes == 0) return;
+    // Pages are clean and file-backed; they fault back in from the file if touched again
+    static const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(raw) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(raw) + raw_bytes;
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+}
+
+SafetensorLoader::SafetensorLoader(const std::string& model_dir, LoadMode mode)
+    : model_dir_(model_dir), mode_(mode) {
     load_metadata();
     load_safetensors();
 }
 
+SafetensorLoader::~SafetensorLoader() {
+    for (auto& m : mappings_) {
+        ::munmap(const_cast<uint8_t*>(m.base), m.size);
+    }
+}
+
 void SafetensorLoader::load_metadata() {
     // Load config.json
     std::string config_path = model_dir_ + "/config.json";
@@ -189,137 +372,211 @@ void SafetensorLoader::load_sharded_model(const std::string& index_path) {
         }
     }
 
-    // Load each shard
+    std::vector<std::string> paths;
     for (const auto& shard : shard_files) {
         std::string shard_path = model_dir_ + "/" + shard;
-        if (std::ifstream(shard_path).good()) {
-            load_safetensor_file(shard_path);
-        }
+        if (std::ifstream(shard_path).good()) paths.push_back(std::move(shard_path));
     }
+    load_shards(paths);
 }
 
 void SafetensorLoader::load_safetensor_file(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
+    load_shards({path});
+}
+
+// One file's parsed header: tensors with their file offsets, and the mapping
+// (Mapped) or the descriptor the reads go through (Eager)
+struct SafetensorLoader::Shard {
+    std::string path;
+    int fd = -1;
+    MappedFile mapping;
+    std::vector<TensorData> tensors;
+    std::vector<uint64_t> offsets;
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        if (mapping.base) ::munmap(const_cast<uint8_t*>(mapping.base), mapping.size);
+        fd = -1;
+        mapping = {};
+    }
+};
+
+// Exactly `len` bytes at `offset`, or throws
+static void pread_full(int fd, void* buf, size_t len, uint64_t offset, const std::string& path) {
+    auto* p = static_cast<uint8_t*>(buf);
+    while (len > 0) {
+        ssize_t n = ::pread(fd, p, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Failed to read safetensor file: " + path);
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+SafetensorLoader::Shard SafetensorLoader::open_shard(const std::string& path) const {
+    Shard shard;
+    shard.path = path;
+    shard.fd = ::open(path.c_str(), O_RDONLY);
+    if (shard.fd < 0) {
         throw std::runtime_error("Failed to open safetensor file: " + path);
     }
+    try {
+        struct stat st;
+        if (::fstat(shard.fd, &st) != 0 || st.st_size < 8) {
+            throw std::runtime_error("Invalid safetensor file: " + path);
+        }
+        size_t file_size = static_cast<size_t>(st.st_size);
 
-    // Read header size (first 8 bytes, little-endian uint64)
-    uint64_t header_size = 0;
-    file.read((char*)&header_size, 8);
+        // Read header size (first 8 bytes, little-endian uint64)
+        uint64_t header_size = 0;
+        pread_full(shard.fd, &header_size, 8, 0, path);
 
-    if (header_size > 100 * 1024 * 1024) {  // Sanity check: 100MB max header
-        throw std::runtime_error("Invalid safetensor header size");
-    }
+        if (header_size > 100 * 1024 * 1024 || 8 + header_size > file_size) {  // Sanity check: 100MB max header
+            throw std::runtime_error("Invalid safetensor header size");
+        }
 
-    // Read header (JSON)
-    std::vector<char> header_data(header_size);
-    file.read(header_data.data(), header_size);
+        std::string header_text(header_size, '\0');
+        pread_full(shard.fd, header_text.data(), header_size, 8, path);
+        json header = json::parse(header_text);
 
-    json header = json::parse(header_data.begin(), header_data.end());
+        const uint64_t data_offset = 8 + header_size;
+        size_t data_capacity = file_size - 8 - header_size;
 
-    // Helper for FP16 to FP32 conversion (IEEE 754)
-    auto half_to_float = [](uint16_t h) -> float {
-        uint32_t s = (h >> 15) & 0x0001;
-        uint32_t e = (h >> 10) & 0x001F;
-        uint32_t m = h & 0x03FF;
+        // Parse tensors
+        for (auto& [name, tensor_info] : header.items()) {
+            if (name == "__metadata__") continue;  // Skip metadata
 
-        if (e == 0) {
-            if (m == 0) {
-                // Zero
-                uint32_t val = s << 31;
-                float f;
-                std::memcpy(&f, &val, 4);
-                return f;
-            } else {
-                // Denormalized
-                return (s ? -1.0f : 1.0f) * std::ldexp((float)m, -24);
-            }
-        } else if (e == 31) {
-            // Inf or NaN
-            uint32_t val = (s << 31) | 0x7F800000 | (m << 13);
-            float f;
-            std::memcpy(&f, &val, 4);
-            return f;
-        } else {
-            // Normalized
-            uint32_t val = (s << 31) | ((e + 112) << 23) | (m << 13);
-            float f;
-            std::memcpy(&f, &val, 4);
-            return f;
-        }
-    };
+            TensorData tensor;
+            tensor.name = name;
 
-    // Parse tensors
-    for (auto& [name, tensor_info] : header.items()) {
-        if (name == "__metadata__") continue;  // Skip metadata
+            // Get dtype
+            if (tensor_info.contains("dtype")) {
+                tensor.dtype = tensor_info["dtype"];
+            }
 
-        TensorData tensor;
-        tensor.name = name;
+            // Get shape
+            if (tensor_info.contains("shape")) {
+                for (auto& dim : tensor_info["shape"]) {
+                    tensor.shape.push_back(dim);
+                }
+            }
 
-        // Get dtype
-        if (tensor_info.contains("dtype")) {
-            tensor.dtype = tensor_info["dtype"];
-        }
+            // Get data offset
+            size_t data_begin = tensor_info["data_offsets"][0];
+            size_t data_end = tensor_info["data_offsets"][1];
+            if (data_end < data_begin || data_end > data_capacity) {
+                throw std::runtime_error("Tensor " + name + " out of bounds in " + path);
+            }
 
-        // Get shape
-        if (tensor_info.contains("shape")) {
-            for (auto& dim : tensor_info["shape"]) {
-                tensor.shape.push_back(dim);
+            size_t elem_size = dtype_size(tensor.dtype);
+            if (elem_size != 0 && tensor.total_elements() * elem_size > data_end - data_begin) {
+                throw std::runtime_error("Tensor " + name + " shorter than its shape in " + path);
             }
+
+            tensor.raw_bytes = data_end - data_begin;
+            shard.offsets.push_back(data_offset + data_begin);
+            shard.tensors.push_back(std::move(tensor));
         }
 
-        // Get data offset
-        size_t data_begin = tensor_info["data_offsets"][0];
-        size_t data_end = tensor_info["data_offsets"][1];
-        size_t data_size = data_end - data_begin;
-
-        // Read tensor data
-        std::vector<uint8_t> raw_data(data_size);
-        file.seekg(8 + header_size + data_begin);
-        file.read((char*)raw_data.data(), data_size);
-
-        // Convert to float32
-        size_t num_elements = tensor.total_elements();
-        tensor.data.resize(num_elements);
-
-        if (tensor.dtype == "F32") {
-            std::memcpy(tensor.data.data(), raw_data.data(), data_size);
-        } else if (tensor.dtype == "F16") {
-            const uint16_t* half_data = (const uint16_t*)raw_data.data();
-            for (size_t i = 0; i < num_elements; ++i) {
-                tensor.data[i] = half_to_float(half_data[i]);
+        if (mode_ == LoadMode::Mapped) {
+            void* addr = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, shard.fd, 0);
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error("Failed to mmap safetensor file: " + path);
             }
-        } else if (tensor.dtype == "BF16") {
-            // BF16: same exponent range as F32, just truncated mantissa
-            const uint16_t* bf16_data = (const uint16_t*)raw_data.data();
-            for (size_t i = 0; i < num_elements; ++i) {
-                uint32_t val = static_cast<uint32_t>(bf16_data[i]) << 16;
-                float f;
-                std::memcpy(&f, &val, 4);
-                tensor.data[i] = f;
+            shard.mapping = {static_cast<const uint8_t*>(addr), file_size};
+            for (size_t i = 0; i < shard.tensors.size(); ++i) {
+                shard.tensors[i].raw = shard.mapping.base + shard.offsets[i];
             }
-        } else if (tensor.dtype == "F64") {
-            const double* f64_data = (const double*)raw_data.data();
-            for (size_t i = 0; i < num_elements; ++i) {
-                tensor.data[i] = static_cast<float>(f64_data[i]);
+            ::close(shard.fd);
+            shard.fd = -1;
+        }
+    } catch (...) {
+        shard.close();
+        throw;
+    }
+    return shard;
+}
+
+void SafetensorLoader::load_shards(const std::vector<std::string>& paths) {
+    // Exceptions cannot leave an OpenMP region: the first error is kept and
+    // rethrown once every shard is closed again
+    std::vector<Shard> shards(paths.size());
+    std::string error;
+    auto fail = [&](const std::exception& e) {
+        #pragma omp critical(safetensor_load_error)
+        if (error.empty()) error = e.what();
+    };
+    auto close_all = [&] {
+        for (auto& shard : shards) shard.close();
+    };
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t i = 0; i < static_cast<int64_t>(paths.size()); ++i) {
+        try {
+            shards[i] = open_shard(paths[i]);
+        } catch (const std::exception& e) {
+            fail(e);
+        }
+    }
+    if (!error.empty()) {
+        close_all();
+        throw std::runtime_error(error);
+    }
+
+    if (mode_ == LoadMode::Eager) {
+        // Every tensor of every shard cut into blocks of whole elements, read
+        // and converted in any order. Unsupported dtypes read nothing and are
+        // zero-filled by convert_to_float.
+        struct Block { TensorData* tensor; int fd; uint64_t offset; size_t first, count; const std::string* path; };
+        std::vector<Block> blocks;
+        std::vector<TensorData*> all;
+        for (auto& shard : shards) {
+            for (size_t i = 0; i < shard.tensors.size(); ++i) {
+                TensorData& t = shard.tensors[i];
+                all.push_back(&t);
+                const size_t elem = dtype_size(t.dtype);
+                const size_t total = t.total_elements();
+                const size_t per_block = std::max<size_t>(1, CONVERT_BLOCK_BYTES / std::max<size_t>(1, elem));
+                for (size_t first = 0; first < total; first += per_block) {
+                    blocks.push_back({&t, shard.fd, shard.offsets[i] + first * elem,
+                                      first, std::min(per_block, total - first), &shard.path});
+                }
             }
-        } else if (tensor.dtype == "I32") {
-            const int32_t* i32_data = (const int32_t*)raw_data.data();
-            for (size_t i = 0; i < num_elements; ++i) {
-                tensor.data[i] = static_cast<float>(i32_data[i]);
+        }
+
+        #pragma omp parallel
+        {
+            #pragma omp for schedule(dynamic, 1)
+            for (int64_t i = 0; i < static_cast<int64_t>(all.size()); ++i) {
+                all[i]->data.resize(all[i]->total_elements());
             }
-        } else if (tensor.dtype == "I64") {
-            const int64_t* i64_data = (const int64_t*)raw_data.data();
-            for (size_t i = 0; i < num_elements; ++i) {
-                tensor.data[i] = static_cast<float>(i64_data[i]);
+
+            std::vector<uint8_t> staging;
+            #pragma omp for schedule(dynamic, 1)
+            for (int64_t i = 0; i < static_cast<int64_t>(blocks.size()); ++i) {
+                const Block& b = blocks[i];
+                try {
+                    const size_t bytes = b.count * dtype_size(b.tensor->dtype);
+                    staging.resize(bytes);
+                    if (bytes > 0) pread_full(b.fd, staging.data(), bytes, b.offset, *b.path);
+                    convert_to_float(b.tensor->dtype, staging.data(), b.count, b.tensor->data.data() + b.first);
+                } catch (const std::exception& e) {
+                    fail(e);
+                }
             }
-        } else {
-            // Unsupported dtype, fill with zeros
-            std::fill(tensor.data.begin(), tensor.data.end(), 0.0f);
         }
+        close_all();
+        if (!error.empty()) throw std::runtime_error(error);
+        for (auto* t : all) t->raw_bytes = 0;
+    }
 
-        tensors_[name] = std::move(tensor);
+    for (auto& shard : shards) {
+        if (shard.mapping.base) mappings_.push_back(shard.mapping);
+        for (auto& tensor : shard.tensors) {
+            std::string name = tensor.name;
+            tensors_[name] = std::move(tensor);
+        }
     }
 }
 
@@ -336,6 +593,23 @@ std::vector<std::string> SafetensorLoader::tensor_names() const {
     return names;
 }
 
+// Row-major tensor -> Eigen matrix, converting one row block at a time
+static Eigen::MatrixXf tensor_rows_to_matrix(const TensorData& tensor) {
+    size_t rows = tensor.shape[0];
+    size_t cols = tensor.shape[1];
+    Eigen::MatrixXf out(rows, cols);
+
+    size_t block_rows = std::max<size_t>(1, CONVERT_BLOCK_BYTES / std::max<size_t>(1, cols * sizeof(float)));
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> block(std::min(block_rows, rows), cols);
+    for (size_t r = 0; r < rows; r += block_rows) {
+        size_t n = std::min(block_rows, rows - r);
+        tensor.read_rows(r, n, block.data());
+        out.middleRows(r, n) = block.topRows(n);
+    }
+    tensor.release();
+    return out;
+}
+
 Eigen::MatrixXf SafetensorLoader::get_embeddings() const {
     // Common embedding tensor names across architectures
     const char* embedding_names[] = {
@@ -372,18 +646,7 @@ Eigen::MatrixXf SafetensorLoader::get_embeddings() const {
     for (const char* name : embedding_names) {
         auto* tensor = get_tensor(name);
         if (tensor && tensor->shape.size() == 2) {
-            size_t vocab_size = tensor->shape[0];
-            size_t embed_dim = tensor->shape[1];
-
-            Eigen::MatrixXf embeddings(vocab_size, embed_dim);
-
-            for (size_t i = 0; i < vocab_size; ++i) {
-                for (size_t j = 0; j < embed_dim; ++j) {
-                    embeddings(i, j) = tensor->data[i * embed_dim + j];
-                }
-            }
-
-            return embeddings;
+            return tensor_rows_to_matrix(*tensor);
         }
     }
 
@@ -395,13 +658,7 @@ Eigen::MatrixXf SafetensorLoader::get_embeddings() const {
             size_t embed_dim = tensor.shape[1];
 
             if (vocab_size > 1000 && embed_dim >= 64) {  // Sanity check
-                Eigen::MatrixXf embeddings(vocab_size, embed_dim);
-                for (size_t i = 0; i < vocab_size; ++i) {
-                    for (size_t j = 0; j < embed_dim; ++j) {
-                        embeddings(i, j) = tensor.data[i * embed_dim + j];
-                    }
-                }
-                return embeddings;
+                return tensor_rows_to_matrix(tensor);
             }
         }
     }
@@ -0,0 +1,280 @@
+/**
+ * @file sequitur.cpp
+ * @brief Sequitur over pooled, index-linked symbols
+ *
+ * Follows Nevill-Manning & Witten's reference implementation step for step;
+ * only the storage differs.
+ */
+
+#include <ingestion/sequitur.hpp>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace Hartonomous {
+
+void Grammar::expand(uint32_t rule, std::u32string& out) const {
+    std::vector<std::pair<uint32_t, uint32_t>> stack{{offsets[rule], offsets[rule + 1]}};
+    while (!stack.empty()) {
+        auto& [pos, end] = stack.back();
+        if (pos == end) {
+            stack.pop_back();
+            continue;
+        }
+        const uint32_t s = symbols[pos++];
+        if (is_rule(s)) stack.emplace_back(offsets[rule_of(s)], offsets[rule_of(s) + 1]);
+        else out.push_back(static_cast<char32_t>(s));
+    }
+}
+
+Sequitur::Sequitur(size_t expected_length) {
+    // A text's grammar keeps a fraction of its symbols (a tenth to a third);
+    // the pool and the table grow past that if needed
+    syms_.reserve(expected_length / 4 + 16);
+    const size_t slots = std::bit_ceil(std::max<size_t>(1024, expected_length / 2));
+    table_keys_.assign(slots, 0);
+    table_syms_.assign(slots, EMPTY);
+    new_rule();  // The axiom
+}
+
+uint32_t Sequitur::new_symbol(uint32_t value) {
+    uint32_t s;
+    if (!free_syms_.empty()) {
+        s = free_syms_.back();
+        free_syms_.pop_back();
+    } else {
+        if (syms_.size() >= DELETED) throw std::length_error("Sequitur: symbol pool exhausted");
+        s = static_cast<uint32_t>(syms_.size());
+        syms_.emplace_back();
+    }
+    syms_[s] = {NONE, NONE, value};
+    if (value & RULE_BIT) rules_[value & ID_MASK].uses++;
+    return s;
+}
+
+uint32_t Sequitur::new_rule() {
+    if (rules_.size() >= ID_MASK) throw std::length_error("Sequitur: too many rules");
+    const auto r = static_cast<uint32_t>(rules_.size());
+    rules_.push_back({NONE, 0});
+    const uint32_t g = new_symbol(GUARD_BIT | r);
+    syms_[g].prev = syms_[g].next = g;
+    rules_[r].guard = g;
+    ++live_rules_;
+    return r;
+}
+
+void Sequitur::append(uint32_t terminal) {
+    if (terminal >= MAX_TERMINAL) throw std::invalid_argument("Sequitur: terminal out of range");
+    const uint32_t s = new_symbol(terminal);
+    insert_after(last(0), s);
+    check(syms_[s].prev);
+}
+
+// Links left -> right. A digram starting at left is about to change, so it
+// leaves the index; where that breaks up a run of three equal symbols, the
+// overlapping digram the run still contains goes back in.
+void Sequitur::join(uint32_t left, uint32_t right) {
+    if (syms_[left].next != NONE) {
+        delete_digram(left);
+        const uint32_t rp = syms_[right].prev, rn = syms_[right].next;
+        if (rp != NONE && rn != NONE && syms_[right].value == syms_[rp].value && syms_[right].value == syms_[rn].value)
+            set_digram(right);
+        const uint32_t lp = syms_[left].prev, ln = syms_[left].next;
+        if (lp != NONE && ln != NONE && syms_[left].value == syms_[ln].value && syms_[left].value == syms_[lp].value)
+            set_digram(lp);
+    }
+    syms_[left].next = right;
+    syms_[right].prev = left;
+}
+
+void Sequitur::insert_after(uint32_t s, uint32_t inserted) {
+    join(inserted, syms_[s].next);
+    join(s, inserted);
+}
+
+void Sequitur::delete_symbol(uint32_t s) {
+    join(syms_[s].prev, syms_[s].next);
+    if (!is_guard(s)) {
+        delete_digram(s);
+        if (is_nonterminal(s)) rules_[rule_of(s)].uses--;
+    }
+    free_syms_.push_back(s);
+}
+
+void Sequitur::delete_digram(uint32_t s) {
+    if (is_guard(s) || is_guard(syms_[s].next)) return;
+    const size_t slot = find_slot(digram_key(s));
+    if (table_syms_[slot] == s) table_syms_[slot] = DELETED;
+}
+
+// Enforces digram uniqueness for the digram starting at s; true if it was a repeat
+bool Sequitur::check(uint32_t s) {
+    if (is_guard(s) || is_guard(syms_[s].next)) return false;
+    const uint32_t x = table_syms_[find_slot(digram_key(s))];
+    if (x == EMPTY || x == DELETED) {
+        set_digram(s);
+        return false;
+    }
+    if (syms_[x].next != s) match(s, x);  // Overlapping occurrences (aaa) stay as they are
+    return true;
+}
+
+// s and m start equal digrams
+void Sequitur::match(uint32_t s, uint32_t m) {
+    uint32_t r;
+    if (is_guard(syms_[m].prev) && is_guard(syms_[syms_[m].next].next)) {
+        // m is a whole rule's body: reuse it
+        r = rule_of(syms_[m].prev);
+        substitute(s, r);
+    } else {
+        r = new_rule();
+        const uint32_t a = new_symbol(syms_[s].value);
+        insert_after(last(r), a);
+        const uint32_t b = new_symbol(syms_[syms_[s].next].value);
+        insert_after(last(r), b);
+        substitute(m, r);
+        substitute(s, r);
+        set_digram(first(r));
+    }
+    // Rule utility: the rule's first symbol may name a rule now used only here
+    const uint32_t f = first(r);
+    if (is_nonterminal(f) && rules_[rule_of(f)].uses == 1) expand(f);
+}
+
+// Replaces the digram starting at s by a use of rule
+void Sequitur::substitute(uint32_t s, uint32_t rule) {
+    const uint32_t q = syms_[s].prev;
+    delete_symbol(syms_[q].next);
+    delete_symbol(syms_[q].next);
+    insert_after(q, new_symbol(RULE_BIT | rule));
+    if (!check(q)) check(syms_[q].next);
+}
+
+// Replaces the nonterminal s, its rule's last use, by the rule's body
+void Sequitur::expand(uint32_t s) {
+    const uint32_t left = syms_[s].prev, right = syms_[s].next;
+    const uint32_t r = rule_of(s);
+    const uint32_t f = first(r), l = last(r);
+
+    delete_digram(s);
+    const uint32_t g = rules_[r].guard;
+    join(l, f);  // Unlinks the guard, as deleting it does in the reference
+    free_syms_.push_back(g);
+    rules_[r] = {NONE, 0};
+    --live_rules_;
+
+    join(left, right);
+    free_syms_.push_back(s);
+    join(left, f);
+    join(l, right);
+    set_digram(l);
+}
+
+size_t Sequitur::find_slot(uint64_t key) const {
+    const size_t mask = table_keys_.size() - 1;
+    // splitmix64 finalizer
+    uint64_t h = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    size_t i = (h ^ (h >> 31)) & mask;
+    size_t insert = SIZE_MAX;
+    for (;; i = (i + 1) & mask) {
+        const uint32_t s = table_syms_[i];
+        if (s == EMPTY) return insert == SIZE_MAX ? i : insert;
+        if (s == DELETED) {
+            if (insert == SIZE_MAX) insert = i;
+        } else if (table_keys_[i] == key) {
+            return i;
+        }
+    }
+}
+
+void Sequitur::set_digram(uint32_t s) {
+    const uint64_t key = digram_key(s);
+    const size_t slot = find_slot(key);
+    if (table_syms_[slot] == EMPTY) ++table_used_;
+    table_keys_[slot] = key;
+    table_syms_[slot] = s;
+    if (table_used_ * 2 > table_keys_.size()) grow_table();
+}
+
+// Rehashes the live entries, doubling only if tombstones were not the cause
+void Sequitur::grow_table() {
+    size_t live = 0;
+    for (uint32_t s : table_syms_) live += s != EMPTY && s != DELETED;
+    const size_t slots = live * 4 > table_keys_.size() ? table_keys_.size() * 2 : table_keys_.size();
+    std::vector<uint64_t> keys(slots, 0);
+    std::vector<uint32_t> syms(slots, EMPTY);
+    keys.swap(table_keys_);
+    syms.swap(table_syms_);
+    table_used_ = live;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (syms[i] == EMPTY || syms[i] == DELETED) continue;
+        const size_t slot = find_slot(keys[i]);
+        table_keys_[slot] = keys[i];
+        table_syms_[slot] = syms[i];
+    }
+}
+
+size_t Sequitur::memory_bytes() const {
+    return syms_.capacity() * sizeof(Symbol) + free_syms_.capacity() * sizeof(uint32_t) +
+           rules_.capacity() * sizeof(Rule) + table_keys_.size() * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+Grammar Sequitur::grammar() const {
+    Grammar g;
+    std::vector<uint32_t> dense(rules_.size(), NONE);
+    std::vector<uint32_t> live;
+    live.reserve(live_rules_);
+    for (uint32_t r = 0; r < rules_.size(); ++r) {
+        if (rules_[r].guard == NONE) continue;
+        dense[r] = static_cast<uint32_t>(live.size());
+        live.push_back(r);
+    }
+
+    g.offsets.reserve(live.size() + 1);
+    g.uses.reserve(live.size());
+    for (uint32_t r : live) {
+        g.offsets.push_back(static_cast<uint32_t>(g.symbols.size()));
+        g.uses.push_back(rules_[r].uses);
+        for (uint32_t s = first(r); !is_guard(s); s = syms_[s].next)
+            g.symbols.push_back(is_nonterminal(s) ? Grammar::RULE_BIT | dense[rule_of(s)] : syms_[s].value);
+    }
+    g.offsets.push_back(static_cast<uint32_t>(g.symbols.size()));
+
+    // Expansion lengths, children before parents
+    const size_t R = g.rule_count();
+    g.lengths.assign(R, 0);
+    std::vector<uint8_t> done(R, 0);
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < R; ++root) {
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const uint32_t r = stack.back();
+            if (done[r]) {
+                stack.pop_back();
+                continue;
+            }
+            bool ready = true;
+            uint64_t length = 0;
+            for (uint32_t i = g.offsets[r]; i < g.offsets[r + 1]; ++i) {
+                const uint32_t s = g.symbols[i];
+                if (!Grammar::is_rule(s)) {
+                    ++length;
+                } else if (done[Grammar::rule_of(s)]) {
+                    length += g.lengths[Grammar::rule_of(s)];
+                } else {
+                    stack.push_back(Grammar::rule_of(s));
+                    ready = false;
+                }
+            }
+            if (!ready) continue;
+            g.lengths[r] = length;
+            done[r] = 1;
+            stack.pop_back();
+        }
+    }
+    return g;
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,143 @@
+/**
+ * @file stream_checkpoint.cpp
+ * @brief Corpus ingest manifest: contiguous commit of flushed chunks, atomic rewrite
+ */
+
+#include <ingestion/stream_checkpoint.hpp>
+#include <ingestion/model_checkpoint.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace Hartonomous {
+
+namespace fs = std::filesystem;
+
+// Bumped when what a recorded position means changes
+static constexpr int MANIFEST_VERSION = 1;
+
+StreamCheckpoint::Options StreamCheckpoint::Options::from_env() {
+    Options o;
+    o.dir = ModelCheckpoint::default_dir();
+    if (const char* v = std::getenv("HARTONOMOUS_INGEST_CHECKPOINT"))
+        o.dir = (std::strcmp(v, "off") == 0) ? "" : v;
+    return o;
+}
+
+StreamCheckpoint::Hash StreamCheckpoint::fingerprint(const std::vector<std::string>& inputs) {
+    std::ostringstream key;
+    std::error_code ec;
+    auto add = [&](const fs::path& f) {
+        key << f.string() << ' ' << fs::file_size(f, ec) << ' '
+            << fs::last_write_time(f, ec).time_since_epoch().count() << '\n';
+    };
+    for (const auto& input : inputs) {
+        if (!fs::is_directory(input, ec)) {
+            add(input);
+            continue;
+        }
+        std::vector<fs::path> files;
+        for (const auto& e : fs::recursive_directory_iterator(input, ec))
+            if (e.is_regular_file(ec)) files.push_back(e.path());
+        std::sort(files.begin(), files.end());
+        for (const auto& f : files) add(f);
+    }
+    return BLAKE3Pipeline::hash(key.str());
+}
+
+void StreamCheckpoint::open(const Options& opts, const std::string& tool, const std::vector<std::string>& inputs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cursors_.clear();
+    path_.clear();
+    if (opts.dir.empty()) return;
+
+    std::string id = tool;
+    std::error_code ec;
+    for (const auto& input : inputs) id += "\n" + fs::weakly_canonical(input, ec).string();
+    path_ = opts.dir + "/" + tool + "-" + BLAKE3Pipeline::to_hex(BLAKE3Pipeline::hash(id)) + ".json";
+    fingerprint_ = fingerprint(inputs);
+    if (!fs::exists(path_)) return;
+
+    // An unreadable or stale manifest only costs the work it would have skipped
+    try {
+        std::ifstream in(path_);
+        auto j = nlohmann::json::parse(in);
+        if (j.value("version", 0) != MANIFEST_VERSION ||
+            j.value("fingerprint", std::string()) != BLAKE3Pipeline::to_hex(fingerprint_)) {
+            std::cout << "[CHECKPOINT] " << path_ << " is for different inputs; starting over" << std::endl;
+            return;
+        }
+        for (const auto& [name, pos] : j.at("positions").items())
+            cursors_[name].committed = pos.get<uint64_t>();
+        std::cout << "[CHECKPOINT] Resuming from " << path_ << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "[StreamCheckpoint] could not read " << path_ << ": " << e.what() << std::endl;
+        cursors_.clear();
+    }
+}
+
+uint64_t StreamCheckpoint::position(const std::string& cursor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cursors_.find(cursor);
+    return it == cursors_.end() ? 0 : it->second.committed;
+}
+
+void StreamCheckpoint::covered(const std::string& cursor, uint64_t begin, uint64_t end, uint64_t last_batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled() || end <= begin) return;
+    cursors_[cursor].pending[begin] = {end, last_batch};
+}
+
+void StreamCheckpoint::flushed(uint64_t flushed_through) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool moved = false;
+    for (auto& [name, c] : cursors_) {
+        auto it = c.pending.begin();
+        // Chunks wholly behind the committed position were re-covered after a resume
+        while (it != c.pending.end() && it->second.end <= c.committed) it = c.pending.erase(it);
+        while (it != c.pending.end() && it->first <= c.committed && it->second.last_batch <= flushed_through) {
+            c.committed = it->second.end;
+            it = c.pending.erase(it);
+            moved = true;
+        }
+    }
+    if (moved) save();
+}
+
+void StreamCheckpoint::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cursors_.clear();
+    if (path_.empty()) return;
+    std::error_code ec;
+    fs::remove(path_, ec);
+}
+
+void StreamCheckpoint::save() {
+    // Checkpoints are an optimization: a failed write costs a longer resume, never the ingest
+    std::error_code ec;
+    fs::create_directories(fs::path(path_).parent_path(), ec);
+    nlohmann::json j;
+    j["version"] = MANIFEST_VERSION;
+    j["fingerprint"] = BLAKE3Pipeline::to_hex(fingerprint_);
+    j["positions"] = nlohmann::json::object();
+    for (const auto& [name, c] : cursors_) j["positions"][name] = c.committed;
+    const std::string tmp = path_ + ".tmp";
+    try {
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out << j.dump(1) << '\n';
+            if (!out) throw std::runtime_error("write failed");
+        }
+        fs::rename(tmp, path_);
+    } catch (const std::exception& e) {
+        std::cerr << "[StreamCheckpoint] could not save " << path_ << ": " << e.what() << std::endl;
+        fs::remove(tmp, ec);
+    }
+}
+
+} // namespace Hartonomous
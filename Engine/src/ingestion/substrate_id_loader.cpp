@@ -0,0 +1,288 @@
+/**
+ * @file substrate_id_loader.cpp
+ * @brief Parallel binary-COPY ID loading and snapshot files
+ */
+
+#include <ingestion/substrate_id_loader.hpp>
+#include <storage/format_utils.hpp>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Hartonomous {
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'H', 'S', 'I', 'D', 'S', 'N', 'P', '1'};
+static constexpr size_t SINK_BATCH = 65536;
+static constexpr size_t RANGES_PER_WORKER = 4;
+
+// Binary COPY framing: 11-byte signature, int32 flags, int32 extension length
+static constexpr char COPY_SIGNATURE[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+
+PrePopulateOptions PrePopulateOptions::from_env() {
+    PrePopulateOptions opts;
+    if (const char* w = std::getenv("HARTONOMOUS_CACHE_WORKERS")) {
+        opts.workers = std::max<long>(1, std::strtol(w, nullptr, 10));
+    }
+    if (const char* p = std::getenv("HARTONOMOUS_CACHE_SNAPSHOT")) {
+        opts.snapshot_path = p;
+    }
+    return opts;
+}
+
+const char* SubstrateIdLoader::table_name(Table t) {
+    switch (t) {
+        case Physicality: return "hartonomous.physicality";
+        case Composition: return "hartonomous.composition";
+        case Relation:    return "hartonomous.relation";
+        default:          throw std::invalid_argument("Unknown substrate table");
+    }
+}
+
+size_t SubstrateIdLoader::estimate_rows(PostgresConnection& db, Table table) {
+    auto r = db.query_single(std::string("SELECT GREATEST(reltuples, 0)::bigint FROM pg_class WHERE oid = '") +
+                             table_name(table) + "'::regclass");
+    return r ? std::stoull(*r) : 0;
+}
+
+// Lower bound of keyspace slice `i` of `n`, split on the leading UUID byte
+static std::string range_bound(size_t i, size_t n) {
+    BLAKE3Pipeline::Hash bound{};
+    bound[0] = static_cast<uint8_t>(i * 256 / n);
+    return hash_to_uuid(bound);
+}
+
+// Parse one CopyData message of a single-uuid-column binary COPY
+static void parse_copy_message(const char* buf, int len, std::vector<BLAKE3Pipeline::Hash>& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+
+    if (len >= 19 && std::memcmp(p, COPY_SIGNATURE, 11) == 0) {
+        uint32_t ext;
+        std::memcpy(&ext, p + 15, 4);
+        p += 19 + ntohl(ext);
+    }
+
+    while (p + 2 <= end) {
+        uint16_t nfields;
+        std::memcpy(&nfields, p, 2);
+        nfields = ntohs(nfields);
+        p += 2;
+        if (nfields == 0xFFFF) return;  // Trailer
+        if (nfields != 1) throw std::runtime_error("Unexpected field count in ID COPY stream");
+
+        if (p + 4 > end) throw std::runtime_error("Truncated ID COPY row");
+        uint32_t flen;
+        std::memcpy(&flen, p, 4);
+        flen = ntohl(flen);
+        p += 4;
+        if (flen != 16 || p + 16 > end) throw std::runtime_error("Malformed UUID in ID COPY stream");
+
+        BLAKE3Pipeline::Hash id;
+        std::memcpy(id.data(), p, 16);
+        out.push_back(id);
+        p += 16;
+    }
+}
+
+size_t SubstrateIdLoader::load_table(PostgresConnection& db, Table table, size_t workers, const Sink& sink) {
+    workers = std::max<size_t>(1, workers);
+    size_t n_ranges = std::min<size_t>(256, workers * RANGES_PER_WORKER);
+    std::string name = table_name(table);
+
+    std::atomic<size_t> next_range{0};
+    std::atomic<size_t> total{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](PostgresConnection& conn) {
+        std::vector<BLAKE3Pipeline::Hash> batch;
+        batch.reserve(SINK_BATCH + 1024);
+        size_t r;
+        while ((r = next_range++) < n_ranges) {
+            std::string sql = "COPY (SELECT id FROM " + name + " WHERE id >= '" + range_bound(r, n_ranges) + "'";
+            if (r + 1 < n_ranges) sql += " AND id < '" + range_bound(r + 1, n_ranges) + "'";
+            sql += ") TO STDOUT (FORMAT binary)";
+
+            conn.copy_out(sql, [&](const char* buf, int len) {
+                parse_copy_message(buf, len, batch);
+                if (batch.size() >= SINK_BATCH) {
+                    sink(batch.data(), batch.size());
+                    total += batch.size();
+                    batch.clear();
+                }
+            });
+        }
+        if (!batch.empty()) {
+            sink(batch.data(), batch.size());
+            total += batch.size();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) {
+        threads.emplace_back([&]() {
+            try {
+                PostgresConnection conn(db.conninfo());
+                worker(conn);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                next_range = n_ranges;
+            }
+        });
+    }
+    // The caller's connection takes a share of the ranges too
+    try {
+        worker(db);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        next_range = n_ranges;
+    }
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+
+    return total.load();
+}
+
+std::string SubstrateIdLoader::fingerprint(PostgresConnection& db) {
+    // relid changes if a table is recreated; n_tup_ins/n_tup_del move on any write
+    auto fp = db.query_single(
+        "SELECT current_database() || '@' || COALESCE(inet_server_port()::text, 'local') || '|' || "
+        "COALESCE(string_agg(relid::text || ':' || n_tup_ins || ':' || n_tup_del, ',' ORDER BY relname), '') "
+        "FROM pg_stat_user_tables WHERE schemaname = 'hartonomous' "
+        "AND relname IN ('physicality', 'composition', 'relation')");
+    return fp.value_or("");
+}
+
+bool SubstrateIdLoader::load_snapshot(const std::string& path, const std::string& fingerprint,
+                                      const std::array<Sink, TABLE_COUNT>& sinks) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 12) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+
+    const uint8_t* base = static_cast<const uint8_t*>(addr);
+    const uint8_t* p = base;
+    const uint8_t* end = base + size;
+    bool ok = false;
+
+    do {
+        if (std::memcmp(p, SNAPSHOT_MAGIC, 8) != 0) break;
+        p += 8;
+        uint32_t fp_len;
+        std::memcpy(&fp_len, p, 4);
+        p += 4;
+        if (p + fp_len > end) break;
+        if (std::string(reinterpret_cast<const char*>(p), fp_len) != fingerprint) break;
+        p += fp_len;
+
+        // Validate every section before feeding any sink
+        const uint8_t* sections[TABLE_COUNT];
+        uint64_t counts[TABLE_COUNT];
+        const uint8_t* q = p;
+        bool valid = true;
+        for (size_t t = 0; t < TABLE_COUNT && valid; ++t) {
+            if (q + 8 > end) { valid = false; break; }
+            std::memcpy(&counts[t], q, 8);
+            q += 8;
+            if (counts[t] > static_cast<uint64_t>(end - q) / 16) { valid = false; break; }
+            sections[t] = q;
+            q += counts[t] * 16;
+        }
+        if (!valid || q != end) break;
+
+        for (size_t t = 0; t < TABLE_COUNT; ++t) {
+            // Hash is a byte array, so IDs are read in place from the mapping
+            const auto* ids = reinterpret_cast<const BLAKE3Pipeline::Hash*>(sections[t]);
+            for (uint64_t off = 0; off < counts[t]; off += SINK_BATCH) {
+                sinks[t](ids + off, std::min<uint64_t>(SINK_BATCH, counts[t] - off));
+            }
+        }
+        ok = true;
+    } while (false);
+
+    ::munmap(addr, size);
+    return ok;
+}
+
+void SubstrateIdLoader::populate(PostgresConnection& db, const PrePopulateOptions& opts,
+                                 const std::array<Sink, TABLE_COUNT>& sinks,
+                                 const std::function<void(Table, size_t)>& reserve) {
+    for (size_t t = 0; t < TABLE_COUNT; ++t) {
+        reserve(static_cast<Table>(t), estimate_rows(db, static_cast<Table>(t)));
+    }
+
+    if (!opts.snapshot_path.empty() &&
+        load_snapshot(opts.snapshot_path, fingerprint(db), sinks)) {
+        std::cout << " [snapshot " << opts.snapshot_path << "]" << std::flush;
+        return;
+    }
+
+    for (size_t t = 0; t < TABLE_COUNT; ++t) {
+        load_table(db, static_cast<Table>(t), opts.workers, sinks[t]);
+    }
+}
+
+SubstrateIdLoader::SnapshotWriter::SnapshotWriter(const std::string& path, const std::string& fingerprint)
+    : path_(path), tmp_path_(path + ".tmp") {
+    file_ = std::fopen(tmp_path_.c_str(), "wb");
+    if (!file_) throw std::runtime_error("Failed to create snapshot: " + tmp_path_);
+
+    uint32_t fp_len = static_cast<uint32_t>(fingerprint.size());
+    std::fwrite(SNAPSHOT_MAGIC, 1, 8, file_);
+    std::fwrite(&fp_len, 4, 1, file_);
+    std::fwrite(fingerprint.data(), 1, fingerprint.size(), file_);
+}
+
+SubstrateIdLoader::SnapshotWriter::~SnapshotWriter() {
+    if (file_) std::fclose(file_);
+    if (!committed_) std::remove(tmp_path_.c_str());
+}
+
+void SubstrateIdLoader::SnapshotWriter::begin_table(Table, size_t count) {
+    if (written_ != expected_) throw std::runtime_error("Snapshot table section incomplete");
+    uint64_t c = count;
+    std::fwrite(&c, 8, 1, file_);
+    expected_ = count;
+    written_ = 0;
+}
+
+void SubstrateIdLoader::SnapshotWriter::write(const BLAKE3Pipeline::Hash& id) {
+    std::fwrite(id.data(), 1, 16, file_);
+    written_++;
+}
+
+void SubstrateIdLoader::SnapshotWriter::commit() {
+    if (written_ != expected_) throw std::runtime_error("Snapshot table section incomplete");
+    bool ok = std::fflush(file_) == 0 && !std::ferror(file_);
+    std::fclose(file_);
+    file_ = nullptr;
+    if (!ok || std::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("Failed to write snapshot: " + path_);
+    }
+    committed_ = true;
+}
+
+} // namespace Hartonomous
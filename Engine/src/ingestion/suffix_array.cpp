@@ -0,0 +1,176 @@
+/**
+ * @file suffix_array.cpp
+ * @brief SA-IS over an integer alphabet and parallel Φ-based LCP
+ */
+
+#include <ingestion/suffix_array.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace Hartonomous {
+
+static constexpr uint32_t EMPTY = UINT32_MAX;
+
+// Bucket heads (end = false) or one-past-tails (end = true) per character
+static void get_buckets(const uint32_t* s, uint32_t n, uint32_t K, std::vector<uint32_t>& bkt, bool end) {
+    std::fill(bkt.begin(), bkt.begin() + K, 0u);
+    for (uint32_t i = 0; i < n; ++i) bkt[s[i]]++;
+    uint32_t sum = 0;
+    for (uint32_t c = 0; c < K; ++c) {
+        uint32_t count = bkt[c];
+        sum += count;
+        bkt[c] = end ? sum : sum - count;
+    }
+}
+
+static void induce(const uint32_t* s, uint32_t* sa, uint32_t n, uint32_t K,
+                   const std::vector<bool>& stype, std::vector<uint32_t>& bkt) {
+    // L-type suffixes left to right from bucket heads
+    get_buckets(s, n, K, bkt, false);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t j = sa[i];
+        if (j == EMPTY || j == 0) continue;
+        if (!stype[j - 1]) sa[bkt[s[j - 1]]++] = j - 1;
+    }
+    // S-type suffixes right to left from bucket tails
+    get_buckets(s, n, K, bkt, true);
+    for (uint32_t i = n; i-- > 0;) {
+        uint32_t j = sa[i];
+        if (j == EMPTY || j == 0) continue;
+        if (stype[j - 1]) sa[--bkt[s[j - 1]]] = j - 1;
+    }
+}
+
+// Suffix array of s[0..n) over [0, K); s[n - 1] == 0 is the unique smallest character
+static void sais(const uint32_t* s, uint32_t* sa, uint32_t n, uint32_t K) {
+    std::vector<bool> stype(n);
+    stype[n - 1] = true;
+    for (uint32_t i = n - 1; i-- > 0;)
+        stype[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && stype[i + 1]);
+    auto is_lms = [&](uint32_t i) { return i > 0 && stype[i] && !stype[i - 1]; };
+
+    // Sort LMS substrings by one induction pass from their bucket tails
+    std::vector<uint32_t> bkt(K);
+    get_buckets(s, n, K, bkt, true);
+    std::fill(sa, sa + n, EMPTY);
+    for (uint32_t i = 1; i < n; ++i)
+        if (is_lms(i)) sa[--bkt[s[i]]] = i;
+    induce(s, sa, n, K, stype, bkt);
+
+    uint32_t n1 = 0;
+    for (uint32_t i = 0; i < n; ++i)
+        if (is_lms(sa[i])) sa[n1++] = sa[i];
+
+    // Name LMS substrings; equal substrings share a name. Two LMS positions
+    // are at least two apart, so pos / 2 slots never collide.
+    std::fill(sa + n1, sa + n, EMPTY);
+    uint32_t names = 0, prev = EMPTY;
+    for (uint32_t i = 0; i < n1; ++i) {
+        const uint32_t pos = sa[i];
+        bool differ = prev == EMPTY;
+        for (uint32_t d = 0; !differ; ++d) {
+            if (s[pos + d] != s[prev + d] || stype[pos + d] != stype[prev + d]) differ = true;
+            else if (d > 0 && (is_lms(pos + d) || is_lms(prev + d))) break;
+        }
+        if (differ) {
+            ++names;
+            prev = pos;
+        }
+        sa[n1 + pos / 2] = names - 1;
+    }
+    for (uint32_t i = n, j = n; i-- > n1;)
+        if (sa[i] != EMPTY) sa[--j] = sa[i];
+
+    // Reduced string (LMS names in text order) sits at the tail of sa
+    uint32_t* s1 = sa + n - n1;
+    uint32_t* sa1 = sa;
+    if (names < n1) {
+        sais(s1, sa1, n1, names);
+    } else {
+        for (uint32_t i = 0; i < n1; ++i) sa1[s1[i]] = i;
+    }
+
+    // Sorted LMS suffixes back into their bucket tails, then induce the rest
+    for (uint32_t i = 1, j = 0; i < n; ++i)
+        if (is_lms(i)) s1[j++] = i;
+    for (uint32_t i = 0; i < n1; ++i) sa1[i] = s1[sa1[i]];
+    std::fill(sa + n1, sa + n, EMPTY);
+    get_buckets(s, n, K, bkt, true);
+    for (uint32_t i = n1; i-- > 0;) {
+        uint32_t j = sa[i];
+        sa[i] = EMPTY;
+        sa[--bkt[s[j]]] = j;
+    }
+    induce(s, sa, n, K, stype, bkt);
+}
+
+std::vector<uint32_t> build_suffix_array(const std::u32string& text) {
+    if (text.size() >= EMPTY - 1) throw std::length_error("build_suffix_array: text too long");
+    const uint32_t N = static_cast<uint32_t>(text.size());
+    if (N == 0) return {};
+
+    // Ranks 1..K of the distinct codepoints, 0 for the sentinel
+    std::vector<uint32_t> s(N + 1);
+    uint32_t K;
+    char32_t max_cp = *std::max_element(text.begin(), text.end());
+    if (max_cp <= 0x10FFFF) {
+        std::vector<uint32_t> rank(static_cast<size_t>(max_cp) + 1, 0);
+        for (char32_t c : text) rank[c] = 1;
+        K = 0;
+        for (auto& r : rank) r = r ? ++K : 0;
+        for (uint32_t i = 0; i < N; ++i) s[i] = rank[text[i]];
+    } else {
+        std::vector<char32_t> alphabet(text.begin(), text.end());
+        std::sort(alphabet.begin(), alphabet.end());
+        alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+        K = static_cast<uint32_t>(alphabet.size());
+        for (uint32_t i = 0; i < N; ++i)
+            s[i] = static_cast<uint32_t>(std::lower_bound(alphabet.begin(), alphabet.end(), text[i]) - alphabet.begin()) + 1;
+    }
+    s[N] = 0;
+
+    std::vector<uint32_t> sa(N + 1);
+    sais(s.data(), sa.data(), N + 1, K + 1);
+    sa.erase(sa.begin());  // The sentinel suffix sorts first
+    return sa;
+}
+
+std::vector<uint32_t> build_lcp_array(const std::u32string& text, const std::vector<uint32_t>& sa,
+                                      uint32_t max_lcp) {
+    const uint32_t N = static_cast<uint32_t>(sa.size());
+    std::vector<uint32_t> lcp(N, 0);
+    if (N < 2) return lcp;
+
+    // Φ[i]: suffix preceding i in SA order; then overwritten in place by PLCP[i]
+    std::vector<uint32_t> plcp(N);
+    plcp[sa[0]] = EMPTY;
+    #pragma omp parallel for schedule(static)
+    for (int64_t r = 1; r < static_cast<int64_t>(N); ++r) plcp[sa[r]] = sa[r - 1];
+
+    #pragma omp parallel
+    {
+        const uint32_t threads = static_cast<uint32_t>(omp_get_num_threads());
+        const uint32_t t = static_cast<uint32_t>(omp_get_thread_num());
+        const uint32_t begin = static_cast<uint32_t>(uint64_t(N) * t / threads);
+        const uint32_t end = static_cast<uint32_t>(uint64_t(N) * (t + 1) / threads);
+        uint32_t l = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t j = plcp[i];
+            if (j == EMPTY) {
+                plcp[i] = l = 0;
+                continue;
+            }
+            const uint32_t limit = std::min(max_lcp, N - std::max(i, j));
+            while (l < limit && text[i + l] == text[j + l]) ++l;
+            plcp[i] = l;
+            if (l > 0) --l;
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t r = 1; r < static_cast<int64_t>(N); ++r) lcp[r] = plcp[sa[r]];
+    return lcp;
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,45 @@
+/**
+ * @file tensor_convert_avx2.cpp
+ * @brief FP16 and BF16 to float32 conversion (built with AVX2, FMA and F16C flags)
+ */
+
+#include "ingestion/tensor_convert_kernels.hpp"
+#include <immintrin.h>
+#include <cstring>
+
+namespace Hartonomous::convert_kernels {
+
+void f16_to_f32_avx2(const uint8_t* src, size_t n, float* out) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i h0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 16));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h0));
+        _mm256_storeu_ps(out + i + 8, _mm256_cvtph_ps(h1));
+    }
+    for (; i < n; ++i) {
+        uint16_t h;
+        std::memcpy(&h, src + i * 2, 2);
+        out[i] = _cvtsh_ss(h);
+    }
+}
+
+void bf16_to_f32_avx2(const uint8_t* src, size_t n, float* out) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        // Zero-extend to 32 bits and move into the high half: the F32 with that mantissa prefix
+        __m256i lo = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(b)), 16);
+        __m256i hi = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(b, 1)), 16);
+        _mm256_storeu_ps(out + i, _mm256_castsi256_ps(lo));
+        _mm256_storeu_ps(out + i + 8, _mm256_castsi256_ps(hi));
+    }
+    for (; i < n; ++i) {
+        uint16_t b;
+        std::memcpy(&b, src + i * 2, 2);
+        const uint32_t bits = static_cast<uint32_t>(b) << 16;
+        std::memcpy(out + i, &bits, 4);
+    }
+}
+
+} // namespace Hartonomous::convert_kernels
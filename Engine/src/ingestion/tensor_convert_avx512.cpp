@@ -0,0 +1,35 @@
+/**
+ * @file tensor_convert_avx512.cpp
+ * @brief FP16 and BF16 to float32 conversion (built with AVX-512 F/BW/DQ/VL flags)
+ */
+
+#include "ingestion/tensor_convert_kernels.hpp"
+#include <immintrin.h>
+
+namespace Hartonomous::convert_kernels {
+
+void f16_to_f32_avx512(const uint8_t* src, size_t n, float* out) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i h0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i h1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2 + 32));
+        _mm512_storeu_ps(out + i, _mm512_cvtph_ps(h0));
+        _mm512_storeu_ps(out + i + 16, _mm512_cvtph_ps(h1));
+    }
+    for (; i < n; i += 16) {
+        const __mmask16 m = static_cast<__mmask16>(n - i >= 16 ? 0xFFFF : (1u << (n - i)) - 1);
+        __m256i h = _mm256_maskz_loadu_epi16(m, src + i * 2);
+        _mm512_mask_storeu_ps(out + i, m, _mm512_cvtph_ps(h));
+    }
+}
+
+void bf16_to_f32_avx512(const uint8_t* src, size_t n, float* out) {
+    for (size_t i = 0; i < n; i += 16) {
+        const __mmask16 m = static_cast<__mmask16>(n - i >= 16 ? 0xFFFF : (1u << (n - i)) - 1);
+        __m256i b = _mm256_maskz_loadu_epi16(m, src + i * 2);
+        __m512i f = _mm512_slli_epi32(_mm512_cvtepu16_epi32(b), 16);
+        _mm512_mask_storeu_ps(out + i, m, _mm512_castsi512_ps(f));
+    }
+}
+
+} // namespace Hartonomous::convert_kernels
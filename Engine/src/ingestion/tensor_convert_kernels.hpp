@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @file tensor_convert_kernels.hpp
+ * @brief Per-ISA FP16 / BF16 to float32 conversion behind the safetensor loader
+ *
+ * src is unaligned tensor bytes straight from the file, n the element count;
+ * each kernel converts its own tail. tensor_convert_avx2.cpp and
+ * tensor_convert_avx512.cpp are built with their own -m flags and
+ * convert_to_float picks one from simd_level() on every call.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Hartonomous::convert_kernels {
+
+// F16C alongside AVX2
+void f16_to_f32_avx2(const uint8_t* src, size_t n, float* out);
+void bf16_to_f32_avx2(const uint8_t* src, size_t n, float* out);
+
+// AVX-512 F/BW/VL: masked tails
+void f16_to_f32_avx512(const uint8_t* src, size_t n, float* out);
+void bf16_to_f32_avx512(const uint8_t* src, size_t n, float* out);
+
+} // namespace Hartonomous::convert_kernels
@@ -0,0 +1,176 @@
+/**
+ * @file tensor_dedup.cpp
+ * @brief Mining keys, sketches and the MinedTensor table
+ */
+
+#include <ingestion/tensor_dedup.hpp>
+#include <utils/philox.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace Hartonomous {
+
+namespace {
+
+// Fixed for good: recorded sketches are only comparable under the same signs
+constexpr uint64_t SKETCH_KEY = 0x7E5D5E7C4A11B0B5ull;
+
+} // namespace
+
+TensorDedup::Options TensorDedup::Options::from_env() {
+    Options o;
+    if (const char* v = std::getenv("HARTONOMOUS_TENSOR_DEDUP")) o.enabled = std::strtol(v, nullptr, 10) != 0;
+    if (const char* v = std::getenv("HARTONOMOUS_TENSOR_DEDUP_NEAR")) o.near_threshold = std::strtod(v, nullptr);
+    return o;
+}
+
+TensorDedup::TensorDedup(PostgresConnection& db, const Options& opts) : db_(db), opts_(opts) {}
+
+void TensorDedup::load(const Hash& context) {
+    context_ = context;
+    keys_.clear();
+    known_.clear();
+    if (!opts_.enabled) return;
+    try {
+        const auto& stmt = db_.prepare("tensor_dedup_load", R"(
+            SELECT MiningKey, TypeTag, Rows, Cols, Sketch, QueryDigest IS NOT NULL
+            FROM hartonomous_internal.MinedTensor
+            WHERE Context = $1
+        )", {PgType::Uuid});
+        PgResult rows = db_.execute_prepared(stmt, {PgParam::uuid(context)});
+        known_.reserve(rows.size());
+        for (int i = 0; i < rows.size(); ++i) {
+            auto row = rows[i];
+            Entry e;
+            e.mining_key = row.get_uuid(0);
+            e.type_tag = std::string(row.get_text(1));
+            e.shape = {static_cast<size_t>(row.get_int8(2)), static_cast<size_t>(row.get_int8(3))};
+            auto bytes = row.get_bytes(4);
+            e.sketch.resize(bytes.size() / sizeof(float));
+            std::memcpy(e.sketch.data(), bytes.data(), e.sketch.size() * sizeof(float));
+            if (row.get_bool(5)) e.query_digest[0] = 1;  // Only its presence matters here
+            keys_.insert(e.mining_key);
+            known_.push_back(std::move(e));
+        }
+    } catch (const std::exception& e) {
+        // Older schemas have no MinedTensor table: mine everything
+        std::cerr << "  Warning: no tensor dedup (" << e.what() << ")" << std::endl;
+    }
+}
+
+TensorDedup::Entry TensorDedup::describe(const TensorData& weight, const TensorData* query,
+                                         const std::string& type_tag, int32_t layer) const {
+    Entry e;
+    e.type_tag = type_tag;
+    e.tensor_name = weight.name;
+    e.layer = layer;
+    e.shape = weight.shape;
+    e.tensor_digest = digest(weight);
+    e.sketch = sketch(weight);
+    if (query) {
+        e.query_digest = digest(*query);
+        auto qs = sketch(*query);
+        e.sketch.insert(e.sketch.end(), qs.begin(), qs.end());
+    }
+
+    std::string key;
+    key.reserve(3 * sizeof(Hash) + type_tag.size());
+    key.append(reinterpret_cast<const char*>(context_.data()), context_.size());
+    key.append(reinterpret_cast<const char*>(e.tensor_digest.data()), e.tensor_digest.size());
+    key.append(reinterpret_cast<const char*>(e.query_digest.data()), e.query_digest.size());
+    key.append(type_tag);
+    e.mining_key = BLAKE3Pipeline::hash(key);
+    return e;
+}
+
+TensorDedup::Match TensorDedup::match(const Entry& e, double* similarity) const {
+    if (!opts_.enabled || e.mining_key == Hash{}) return Match::None;
+    if (keys_.count(e.mining_key)) {
+        if (similarity) *similarity = 1.0;
+        return Match::Exact;
+    }
+    if (opts_.near_threshold > 1.0 || e.shape.size() != 2 || e.sketch.empty()) return Match::None;
+
+    const bool has_query = e.query_digest != Hash{};
+    double best = -1.0;
+    for (const auto& k : known_) {
+        if (k.type_tag != e.type_tag || k.shape != e.shape || (k.query_digest != Hash{}) != has_query) continue;
+        best = std::max(best, sketch_similarity(e.sketch, k.sketch));
+    }
+    if (similarity) *similarity = best;
+    return best >= opts_.near_threshold ? Match::Near : Match::None;
+}
+
+void TensorDedup::record(const std::vector<Entry>& mined, const Hash& content_id) {
+    if (!opts_.enabled || mined.empty()) return;
+    try {
+        const auto& stmt = db_.prepare("tensor_dedup_record", R"(
+            INSERT INTO hartonomous_internal.MinedTensor
+                (MiningKey, Context, TypeTag, Layer, TensorName, TensorDigest, QueryDigest, Rows, Cols, Sketch, ContentId)
+            VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11)
+            ON CONFLICT (MiningKey) DO NOTHING
+        )", {PgType::Uuid, PgType::Uuid, PgType::Text, PgType::Int4, PgType::Text, PgType::Uuid, PgType::Uuid,
+             PgType::Int8, PgType::Int8, PgType::Bytea, PgType::Uuid});
+        PostgresConnection::Transaction txn(db_);
+        for (const auto& e : mined) {
+            if (e.mining_key == Hash{} || e.shape.size() != 2) continue;
+            db_.execute_prepared(stmt, {
+                PgParam::uuid(e.mining_key), PgParam::uuid(context_), PgParam::text(e.type_tag),
+                PgParam::int4(e.layer), PgParam::text(e.tensor_name), PgParam::uuid(e.tensor_digest),
+                e.query_digest == Hash{} ? PgParam::null() : PgParam::uuid(e.query_digest),
+                PgParam::int8(static_cast<int64_t>(e.shape[0])), PgParam::int8(static_cast<int64_t>(e.shape[1])),
+                PgParam::bytes(e.sketch.data(), e.sketch.size() * sizeof(float)), PgParam::uuid(content_id)});
+            keys_.insert(e.mining_key);
+        }
+        txn.commit();
+    } catch (const std::exception& e) {
+        std::cerr << "  Warning: mined tensors not recorded (" << e.what() << ")" << std::endl;
+    }
+}
+
+TensorDedup::Hash TensorDedup::digest(const TensorData& t) {
+    const Hash bytes = t.is_mapped() ? BLAKE3Pipeline::hash(t.raw, t.raw_bytes)
+                                     : BLAKE3Pipeline::hash(t.data.data(), t.data.size() * sizeof(float));
+    // Mapped and eager copies of one tensor differ in bytes, so the dtype says which was hashed
+    std::string header = t.is_mapped() ? t.dtype : std::string("F32");
+    for (size_t d : t.shape) header += ' ' + std::to_string(d);
+    header.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return BLAKE3Pipeline::hash(header);
+}
+
+std::vector<float> TensorDedup::sketch(const TensorData& t) {
+    if (t.shape.size() != 2 || t.shape[0] == 0 || t.shape[1] == 0) return {};
+    const size_t rows = t.shape[0];
+    const size_t cols = t.shape[1];
+
+    // Sign bit d of column j's block is entry (j, d) of the projection
+    std::vector<uint16_t> signs(cols);
+    for (size_t j = 0; j < cols; ++j)
+        signs[j] = static_cast<uint16_t>(Philox::block({static_cast<uint32_t>(j), static_cast<uint32_t>(j >> 32), 0, 0},
+                                                       SKETCH_KEY)[0]);
+
+    std::vector<float> out(SKETCH_ROWS * SKETCH_DIMS, 0.0f);
+    std::vector<float> row(cols);
+    for (size_t i = 0; i < SKETCH_ROWS; ++i) {
+        t.read_rows(i * rows / SKETCH_ROWS, 1, row.data());
+        float* s = out.data() + i * SKETCH_DIMS;
+        for (size_t j = 0; j < cols; ++j)
+            for (size_t d = 0; d < SKETCH_DIMS; ++d) s[d] += (signs[j] >> d & 1) ? row[j] : -row[j];
+    }
+    return out;
+}
+
+double TensorDedup::sketch_similarity(const std::vector<float>& a, const std::vector<float>& b) {
+    if (a.size() != b.size() || a.empty()) return 0.0;
+    double dot = 0.0, na = 0.0, nb = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        dot += double(a[i]) * b[i];
+        na += double(a[i]) * a[i];
+        nb += double(b[i]) * b[i];
+    }
+    return (na > 0.0 && nb > 0.0) ? dot / std::sqrt(na * nb) : 0.0;
+}
+
+} // namespace Hartonomous
@@ -4,20 +4,38 @@
  */
 
 #include <ingestion/text_ingester.hpp>
+#include <cognitive/neighbor_cache.hpp>
 #include <storage/composition_store.hpp>
 #include <storage/relation_store.hpp>
 #include <storage/content_store.hpp>
 #include <storage/relation_evidence_store.hpp>
+#include <storage/composition_adjacency.hpp>
 #include <storage/physicality_store.hpp>
 #include <storage/format_utils.hpp>
+#include <ingestion/async_flusher.hpp>
+#include <ingestion/count_min_sketch.hpp>
+#include <ingestion/ingest_pipeline.hpp>
+#include <ingestion/sequitur.hpp>
+#include <ingestion/substrate_cache.hpp>
+#include <query/centroid_index.hpp>
+#include <utils/thread_config.hpp>
 #include <utils/time.hpp>
 #include <utils/unicode.hpp>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
+#include <optional>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omp.h>
 
 namespace Hartonomous {
 
@@ -33,119 +51,361 @@ void TextIngester::preload_atoms() {
     }
 }
 
-BLAKE3Pipeline::Hash TextIngester::create_content_record(const std::string& text, BLAKE3Pipeline::Hash* content_hash) {
-    auto computed_hash = BLAKE3Pipeline::hash(text);
-    if (content_hash) *content_hash = computed_hash;
+BLAKE3Pipeline::Hash TextIngester::content_id_of(const BLAKE3Pipeline::Hash& content_hash) const {
     std::vector<uint8_t> data = {0x43};
-    data.insert(data.end(), computed_hash.begin(), computed_hash.end());
+    data.insert(data.end(), content_hash.begin(), content_hash.end());
     data.insert(data.end(), config_.tenant_id.begin(), config_.tenant_id.end());
     data.insert(data.end(), config_.user_id.begin(), config_.user_id.end());
     return BLAKE3Pipeline::hash(data.data(), data.size());
 }
 
-IngestionStats TextIngester::ingest(const std::string& text) {
-    Timer total_timer;
-    IngestionStats stats;
-    stats.original_bytes = text.size();
+ContentRecord TextIngester::content_record(const BLAKE3Pipeline::Hash& content_hash, size_t bytes) const {
+    return {content_id_of(content_hash), config_.tenant_id, config_.user_id, config_.content_type, content_hash,
+            bytes, config_.mime_type, config_.language, config_.source, config_.encoding};
+}
 
-    auto content_hash = BLAKE3Pipeline::hash(text);
-    if (db_.query_single("SELECT id FROM hartonomous.content WHERE contenthash = $1", {hash_to_bytea_hex(content_hash)}).has_value()) {
-        std::cout << "  Content already ingested, skipping." << std::endl;
-        return stats;
-    }
+namespace {
 
-    preload_atoms();
+struct AdjPair { BLAKE3Pipeline::Hash comp_a, comp_b; };
+struct AdjPairHash { size_t operator()(const AdjPair& p) const { size_t h = HashHasher{}(p.comp_a); return h ^ (HashHasher{}(p.comp_b) + 0x9e3779b9 + (h << 6) + (h >> 2)); } };
+struct AdjPairEq { bool operator()(const AdjPair& a, const AdjPair& b) const { return a.comp_a == b.comp_a && a.comp_b == b.comp_b; } };
+struct AdjStats { uint32_t count = 0; double total_dist = 0.0; };
 
-    std::u32string utf32 = utf8_to_utf32(text);
-    NGramConfig ng_config;
-    ng_config.min_n = config_.min_ngram_size;
-    ng_config.max_n = config_.max_ngram_size;
-    ng_config.min_frequency = config_.min_frequency;
-    extractor_ = NGramExtractor(ng_config);
-    extractor_.extract(utf32);
+// Compositions of one text and the adjacency counts of its tiling by them.
+// min_pairs and sketch_bits are set before tiling.
+struct TextTiling {
+    std::unordered_map<BLAKE3Pipeline::Hash, Service::ComputedComp, HashHasher> comp_map;
+    std::unordered_map<AdjPair, AdjStats, AdjPairHash, AdjPairEq> adj_pairs;
+    uint32_t min_pairs = 1;       // Pairs seen fewer times are not kept
+    uint32_t sketch_bits = 22;    // Upper bound on the prepass sketch's width
+};
 
-    auto sig_ngrams = extractor_.significant_ngrams();
-    stats.ngrams_extracted = extractor_.total_ngrams();
-    stats.ngrams_significant = sig_ngrams.size();
+struct TileEntry { BLAKE3Pipeline::Hash comp_id; uint32_t position; uint32_t length; };
 
-    std::unordered_map<BLAKE3Pipeline::Hash, Service::ComputedComp, HashHasher> comp_map;
-    std::unordered_map<BLAKE3Pipeline::Hash, BLAKE3Pipeline::Hash, HashHasher> ngram_to_comp;
+AdjPair adj_pair(const TileEntry& a, const TileEntry& b) {
+    const bool a_first = std::memcmp(a.comp_id.data(), b.comp_id.data(), 16) < 0;
+    return a_first ? AdjPair{a.comp_id, b.comp_id} : AdjPair{b.comp_id, a.comp_id};
+}
+
+// Counts the adjacent composition pairs of a tiling whose first tile starts
+// at or after pairs_from, on per-thread maps merged at the end.
+//
+// With min_pairs above one a Count-Min pass over the tiling comes first and
+// only pairs it has seen min_pairs times get an exact entry, so the singletons
+// that dominate a large text never reach the maps. Estimates only err upward:
+// no frequent pair is missed, and the few collisions admitted are dropped
+// once their exact counts are in.
+void count_adjacencies(const std::vector<TileEntry>& tiling, uint32_t pairs_from, TextTiling& out) {
+    const int64_t n = static_cast<int64_t>(tiling.size()) - 1;
+    auto counted = [&](int64_t i) { return tiling[i].position >= pairs_from && tiling[i].comp_id != tiling[i+1].comp_id; };
+
+    std::optional<CountMinSketch> gate;
+    if (out.min_pairs > 1 && n > 0) {
+        // Twice as many counters per row as there are pairs, within sketch_bits
+        const auto bits = std::clamp<uint32_t>(static_cast<uint32_t>(std::bit_width(static_cast<uint64_t>(n))) + 1, 10,
+                                               std::max<uint32_t>(out.sketch_bits, 10));
+        gate.emplace(bits);
+        for (int64_t i = 0; i < n; ++i)
+            if (counted(i)) gate->add(AdjPairHash{}(adj_pair(tiling[i], tiling[i+1])));
+    }
 
-    for (const auto* ng : sig_ngrams) {
-        auto cc = Service::compute_comp(utf32_to_utf8(ng->text), atom_lookup_);
+    #pragma omp parallel
+    {
+        std::unordered_map<AdjPair, AdjStats, AdjPairHash, AdjPairEq> local;
+        #pragma omp for schedule(static) nowait
+        for (int64_t i = 0; i < n; ++i) {
+            if (!counted(i)) continue;
+            const auto& a = tiling[i], & b = tiling[i+1];
+            const AdjPair pair = adj_pair(a, b);
+            if (gate && gate->estimate(AdjPairHash{}(pair)) < out.min_pairs) continue;
+            auto& adj = local[pair];
+            adj.count++;
+            adj.total_dist += (b.position >= a.position + a.length) ? (b.position - a.position - a.length) : 0;
+        }
+        #pragma omp critical(text_ingester_adjacency)
+        for (const auto& [pair, adj] : local) {
+            auto& total = out.adj_pairs[pair];
+            total.count += adj.count;
+            total.total_dist += adj.total_dist;
+        }
+    }
+    if (gate) std::erase_if(out.adj_pairs, [&](const auto& kv) { return kv.second.count < out.min_pairs; });
+}
+
+// Tiles utf32 greedily by the longest significant n-gram at each position
+// and counts the adjacent composition pairs whose first tile starts at or
+// after pairs_from.
+//
+// Every codepoint's unigram is among the significant n-grams, so a position
+// no composition starts at is one whose atom has no composition either and
+// is skipped.
+void tile_text(const std::u32string& utf32, const std::vector<const NGram*>& sig_ngrams,
+               AtomLookup& atoms, uint32_t pairs_from, TextTiling& out) {
+    std::vector<std::string> ngram_texts;
+    ngram_texts.reserve(sig_ngrams.size());
+    for (const auto* ng : sig_ngrams) ngram_texts.push_back(utf32_to_utf8(ng->text));
+    std::vector<Service::ComputedComp> ngram_comps;
+    Service::compute_comps(ngram_texts, atoms, ngram_comps);
+    std::vector<BLAKE3Pipeline::Hash> comp_of(sig_ngrams.size());
+    std::vector<uint8_t> has_comp(sig_ngrams.size(), 0);
+    for (size_t i = 0; i < sig_ngrams.size(); ++i) {
+        auto& cc = ngram_comps[i];
         if (!cc.valid) continue;
-        ngram_to_comp[ng->hash] = cc.cache_entry.comp_id;
-        comp_map[cc.cache_entry.comp_id] = cc;
+        comp_of[i] = cc.cache_entry.comp_id;
+        has_comp[i] = 1;
+        out.comp_map[cc.cache_entry.comp_id] = std::move(cc);
+    }
+
+    // Longest significant n-gram starting at each position, as an index into
+    // sig_ngrams. They are sorted longest first, so that is the smallest index.
+    const auto N = static_cast<uint32_t>(utf32.size());
+    constexpr uint32_t NO_NGRAM = UINT32_MAX;
+    std::vector<uint32_t> best_at_pos(N, NO_NGRAM);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int64_t k = 0; k < static_cast<int64_t>(sig_ngrams.size()); ++k) {
+        if (!has_comp[k]) continue;
+        for (uint32_t pos : sig_ngrams[k]->positions) {
+            std::atomic_ref<uint32_t> best(best_at_pos[pos]);
+            uint32_t cur = best.load(std::memory_order_relaxed);
+            while (static_cast<uint32_t>(k) < cur && !best.compare_exchange_weak(cur, static_cast<uint32_t>(k), std::memory_order_relaxed)) {}
+        }
+    }
+
+    // Tiles from pos while it is below stop; returns where the last one ends
+    auto tile_from = [&](uint32_t pos, uint32_t stop, std::vector<TileEntry>& tiles) {
+        while (pos < stop) {
+            uint32_t k = best_at_pos[pos];
+            if (k == NO_NGRAM) { ++pos; continue; }
+            tiles.push_back({comp_of[k], pos, sig_ngrams[k]->n});
+            pos += sig_ngrams[k]->n;
+        }
+        return pos;
+    };
+
+    // Chunks are tiled in parallel from their own start. Where the previous
+    // chunk's last tile runs past that start, the chunk is re-tiled from
+    // there until it lands on a position its own tiling also reached; from
+    // that point on both tilings agree.
+    const uint32_t chunks = N < (1u << 16) ? 1u : static_cast<uint32_t>(std::max(1, omp_get_max_threads()));
+    std::vector<std::vector<TileEntry>> chunk_tiles(chunks);
+    std::vector<uint32_t> chunk_reach(chunks);
+    auto chunk_begin = [&](uint32_t c) { return static_cast<uint32_t>(uint64_t(N) * c / chunks); };
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < static_cast<int64_t>(chunks); ++c)
+        chunk_reach[c] = tile_from(chunk_begin(c), chunk_begin(c + 1), chunk_tiles[c]);
+
+    for (uint32_t c = 1; c < chunks; ++c) {
+        const uint32_t reach = chunk_reach[c - 1];
+        if (reach == chunk_begin(c)) continue;
+        auto& tiles = chunk_tiles[c];
+        // Its own tiling visited pos unless pos lies inside one of its tiles
+        auto visited = [&](uint32_t pos) {
+            auto it = std::upper_bound(tiles.begin(), tiles.end(), pos,
+                                       [](uint32_t p, const TileEntry& t) { return p < t.position; });
+            return it == tiles.begin() || std::prev(it)->position == pos ||
+                   std::prev(it)->position + std::prev(it)->length <= pos;
+        };
+        std::vector<TileEntry> fixed;
+        uint32_t pos = reach;
+        const uint32_t stop = chunk_begin(c + 1);
+        while (pos < stop && !visited(pos)) pos = tile_from(pos, pos + 1, fixed);
+        if (pos >= stop) {
+            chunk_reach[c] = pos;
+            tiles = std::move(fixed);
+        } else {
+            auto keep = std::lower_bound(tiles.begin(), tiles.end(), pos,
+                                         [](const TileEntry& t, uint32_t p) { return t.position < p; });
+            fixed.insert(fixed.end(), keep, tiles.end());
+            tiles = std::move(fixed);
+        }
+    }
+
+    std::vector<TileEntry> tiling;
+    size_t total_tiles = 0;
+    for (const auto& t : chunk_tiles) total_tiles += t.size();
+    tiling.reserve(total_tiles);
+    for (auto& t : chunk_tiles) {
+        tiling.insert(tiling.end(), t.begin(), t.end());
+        std::vector<TileEntry>().swap(t);
+    }
+    std::vector<uint32_t>().swap(best_at_pos);
+    count_adjacencies(tiling, pairs_from, out);
+}
+
+// Tiles utf32 by the rules of its Sequitur grammar: the axiom's symbols in
+// order, each rule longer than max_length replaced by its body, recursively.
+// A tile is a terminal or a rule of at most max_length codepoints.
+void tile_grammar(const std::u32string& utf32, AtomLookup& atoms, uint32_t max_length,
+                  IngestionStats& stats, TextTiling& out) {
+    Grammar g;
+    {
+        Sequitur seq(utf32.size());
+        seq.append(utf32);
+        g = seq.grammar();
     }
 
-    struct PosComp { BLAKE3Pipeline::Hash ngram_hash; uint32_t length; };
-    std::unordered_map<uint32_t, PosComp> best_at_pos;
-    for (const auto* ng : sig_ngrams) {
-        if (ngram_to_comp.find(ng->hash) == ngram_to_comp.end()) continue;
-        for (uint32_t pos : ng->positions) {
-            auto it = best_at_pos.find(pos);
-            if (it == best_at_pos.end() || ng->n > it->second.length) best_at_pos[pos] = {ng->hash, ng->n};
+    // Distinct tile symbols, and the tiling as indices into them
+    struct GrammarTile { uint32_t unit, position, length; };
+    std::unordered_map<uint32_t, uint32_t> unit_of;
+    std::vector<uint32_t> units;
+    std::vector<GrammarTile> tiles;
+    std::vector<std::pair<uint32_t, uint32_t>> stack{{g.offsets[0], g.offsets[1]}};
+    uint32_t position = 0;
+    while (!stack.empty()) {
+        auto& [i, end] = stack.back();
+        if (i == end) {
+            stack.pop_back();
+            continue;
         }
+        const uint32_t s = g.symbols[i++];
+        const bool rule = Grammar::is_rule(s);
+        const auto length = static_cast<uint32_t>(rule ? g.lengths[Grammar::rule_of(s)] : 1);
+        if (length > max_length) {
+            stack.emplace_back(g.offsets[Grammar::rule_of(s)], g.offsets[Grammar::rule_of(s) + 1]);
+            continue;
+        }
+        auto [it, added] = unit_of.try_emplace(s, static_cast<uint32_t>(units.size()));
+        if (added) units.push_back(s);
+        tiles.push_back({it->second, position, length});
+        position += length;
+    }
+    stats.ngrams_extracted = g.rule_count() - 1;
+    stats.ngrams_significant = units.size();
+
+    std::vector<std::string> unit_texts;
+    unit_texts.reserve(units.size());
+    std::u32string expansion;
+    for (uint32_t s : units) {
+        expansion.clear();
+        if (Grammar::is_rule(s)) g.expand(Grammar::rule_of(s), expansion);
+        else expansion.push_back(static_cast<char32_t>(s));
+        unit_texts.push_back(utf32_to_utf8(expansion));
     }
+    std::vector<Service::ComputedComp> unit_comps;
+    Service::compute_comps(unit_texts, atoms, unit_comps);
 
-    struct TileEntry { BLAKE3Pipeline::Hash comp_id; uint32_t position; uint32_t length; };
     std::vector<TileEntry> tiling;
-    uint32_t pos = 0;
-    while (pos < utf32.size()) {
-        auto it = best_at_pos.find(pos);
-        if (it != best_at_pos.end()) {
-            auto comp_it = ngram_to_comp.find(it->second.ngram_hash);
-            if (comp_it != ngram_to_comp.end()) {
-                tiling.push_back({comp_it->second, pos, it->second.length});
-                pos += it->second.length;
-                continue;
+    tiling.reserve(tiles.size());
+    for (const auto& t : tiles) {
+        const auto& cc = unit_comps[t.unit];
+        if (cc.valid) tiling.push_back({cc.cache_entry.comp_id, t.position, t.length});
+    }
+    for (auto& cc : unit_comps)
+        if (cc.valid) out.comp_map[cc.cache_entry.comp_id] = std::move(cc);
+    count_adjacencies(tiling, 0, out);
+}
+
+NGramConfig ngram_config(const IngestionConfig& config) {
+    NGramConfig ng_config;
+    ng_config.min_n = config.min_ngram_size;
+    ng_config.max_n = config.max_ngram_size;
+    ng_config.min_frequency = config.min_frequency;
+    // Tiling only needs each occurrence once and in no particular order
+    ng_config.position_storage = PositionStorage::Interval;
+    return ng_config;
+}
+
+// Read-only private mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Open failed: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Stat failed: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to mmap: " + path);
             }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
         }
-        char32_t cp = utf32[pos];
-        auto hash = BLAKE3Pipeline::hash(&cp, 4);
-        auto ng_it = ngram_to_comp.find(hash);
-        if (ng_it != ngram_to_comp.end()) tiling.push_back({ng_it->second, pos, 1});
-        pos++;
+        ::close(fd);
     }
+    ~MappedFile() { if (data_) ::munmap(const_cast<char*>(data_), size_); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-    struct AdjPair { BLAKE3Pipeline::Hash comp_a, comp_b; };
-    struct AdjPairHash { size_t operator()(const AdjPair& p) const { size_t h = HashHasher{}(p.comp_a); return h ^ (HashHasher{}(p.comp_b) + 0x9e3779b9 + (h << 6) + (h >> 2)); } };
-    struct AdjPairEq { bool operator()(const AdjPair& a, const AdjPair& b) const { return a.comp_a == b.comp_a && a.comp_b == b.comp_b; } };
-    struct AdjStats { uint32_t count = 0; double total_dist = 0.0; };
-    std::unordered_map<AdjPair, AdjStats, AdjPairHash, AdjPairEq> adj_pairs;
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
 
-    for (size_t i = 0; i + 1 < tiling.size(); ++i) {
-        const auto& a = tiling[i], & b = tiling[i+1];
-        if (a.comp_id == b.comp_id) continue;
-        bool a_first = std::memcmp(a.comp_id.data(), b.comp_id.data(), 16) < 0;
-        AdjPair key = a_first ? AdjPair{a.comp_id, b.comp_id} : AdjPair{b.comp_id, a.comp_id};
-        adj_pairs[key].count++;
-        adj_pairs[key].total_dist += (b.position >= a.position + a.length) ? (b.position - a.position - a.length) : 0;
+bool utf8_continuation(char c) { return (static_cast<uint8_t>(c) & 0xC0) == 0x80; }
+
+// End of the window starting at begin: the last line or sentence break in
+// its final eighth, else the last UTF-8 boundary before begin + window
+size_t window_end(std::string_view data, size_t begin, size_t window) {
+    if (data.size() - begin <= window) return data.size();
+    size_t end = begin + window;
+    for (size_t i = end - 1, stop = end - window / 8; i > stop; --i) {
+        char c = data[i - 1];
+        if (c == '\n' || ((c == '.' || c == '!' || c == '?') && data[i] == ' ')) return i;
     }
+    while (end > begin + 1 && utf8_continuation(data[end])) --end;
+    return end;
+}
 
-    BLAKE3Pipeline::Hash content_id = create_content_record(text, &content_hash);
+// Extraction half of ingest(): the compositions of `text` and their adjacency counts
+void extract_text(std::string_view text, AtomLookup& atoms, const IngestionConfig& config, IngestionStats& stats,
+                  TextTiling& tiled) {
+    std::u32string utf32;
+    utf8_to_utf32(text, utf32);
+    if (config.sketch_adjacency) {
+        tiled.min_pairs = config.min_cooccurrence;
+        tiled.sketch_bits = config.sketch_width_bits;
+    }
+    if (config.discovery == CompositionDiscovery::Sequitur) {
+        tile_grammar(utf32, atoms, config.max_ngram_size, stats, tiled);
+    } else {
+        NGramExtractor extractor(ngram_config(config));
+        extractor.extract(utf32);
 
-    PostgresConnection::Transaction txn(db_);
-    ContentStore(db_).store({content_id, config_.tenant_id, config_.user_id, config_.content_type, content_hash, stats.original_bytes, config_.mime_type, config_.language, config_.source, config_.encoding});
+        auto sig_ngrams = extractor.significant_ngrams();
+        stats.ngrams_extracted = extractor.total_ngrams();
+        stats.ngrams_significant = sig_ngrams.size();
+        tile_text(utf32, sig_ngrams, atoms, 0, tiled);
+    }
+}
+
+// Storage half of ingest(): the content record and the tiling's compositions
+// and relations in one transaction, then the in-memory caches that follow them
+void store_text(PostgresConnection& db, const ContentRecord& content, TextTiling& tiled, IngestionStats& stats,
+                ProgressReporter* progress) {
+    const BLAKE3Pipeline::Hash& content_id = content.id;
+    auto& comp_map = tiled.comp_map;
+    auto& adj_pairs = tiled.adj_pairs;
+
+    PostgresConnection::Transaction txn(db);
+    ContentStore(db).store(content);
 
     // Store compositions (physicality first, then composition, then sequences)
     {
-        PhysicalityStore ps(db_);
+        PhysicalityStore ps(db);
         for (auto& [id, cc] : comp_map) {
             ps.store(cc.phys);
         }
         ps.flush();
     }
     {
-        CompositionStore cs(db_);
+        CompositionStore cs(db);
         for (auto& [id, cc] : comp_map) {
             cs.store(cc.comp);
             stats.compositions_total++;
         }
         cs.flush();
+        if (progress) progress->advance(0, 2 * comp_map.size());  // Physicality and composition rows
     }
     {
-        CompositionSequenceStore css(db_);
+        CompositionSequenceStore css(db);
         for (auto& [id, cc] : comp_map) {
             for (const auto& s : cc.seq) {
                 css.store(s);
@@ -157,11 +417,12 @@ IngestionStats TextIngester::ingest(const std::string& text) {
     // Compute and store relations from adjacency pairs
     stats.cooccurrences_found = adj_pairs.size();
     {
-        PhysicalityStore ps(db_);
-        RelationStore rs(db_);
-        RelationSequenceStore rss(db_);
-        RelationRatingStore rrs(db_);
-        RelationEvidenceStore es(db_);
+        PhysicalityStore ps(db);
+        RelationStore rs(db);
+        RelationSequenceStore rss(db);
+        RelationRatingStore rrs(db);
+        RelationEvidenceStore es(db);
+        std::vector<BLAKE3Pipeline::Hash> touched;
 
         for (auto& [pair, adj] : adj_pairs) {
             auto it_a = comp_map.find(pair.comp_a);
@@ -177,6 +438,7 @@ IngestionStats TextIngester::ingest(const std::string& text) {
             cr.rating.observations = adj.count;
             rrs.store(cr.rating);
             es.store(cr.evidence);
+            touched.push_back(cr.rel.id);
 
             stats.relations_total++;
             stats.evidence_count++;
@@ -187,6 +449,8 @@ IngestionStats TextIngester::ingest(const std::string& text) {
         rss.flush();
         rrs.flush();
         es.flush();
+        CompositionAdjacency::refresh(db, touched);
+        if (progress) progress->advance(0, stats.relations_total);
     }
 
     stats.compositions_new = stats.compositions_total;
@@ -194,14 +458,345 @@ IngestionStats TextIngester::ingest(const std::string& text) {
     if (stats.original_bytes > 0) stats.compression_ratio = 1.0;
 
     txn.commit();
+
+    // Keep a live centroid index current; one not yet loaded reads them itself
+    if (auto centroids = CentroidIndex::loaded()) {
+        std::vector<std::pair<BLAKE3Pipeline::Hash, Eigen::Vector4d>> added;
+        added.reserve(comp_map.size());
+        for (const auto& [id, cc] : comp_map) added.emplace_back(id, cc.phys.centroid);
+        centroids->add(added);
+    }
+
+    // Relations of every composition in the text may have changed
+    auto& neighbors = NeighborCache::global();
+    for (const auto& [id, cc] : comp_map) neighbors.invalidate(id);
+}
+
+// One new file of ingest_files() between extraction and storage
+struct FileText {
+    size_t index = 0;
+    TextTiling tiled;
+    IngestionStats stats;
+};
+
+// Content hashes per probe query; a few MB of uuid[] parameter
+constexpr size_t CONTENT_PROBE_BATCH = size_t(1) << 18;
+
+} // namespace
+
+IngestionStats TextIngester::ingest(const std::string& text) {
+    apply_thread_config();
+    Timer total_timer;
+    IngestionStats stats;
+    stats.original_bytes = text.size();
+
+    auto content_hash = BLAKE3Pipeline::hash(text);
+    if (db_.query_single("SELECT id FROM hartonomous.content WHERE contenthash = $1", {hash_to_bytea_hex(content_hash)}).has_value()) {
+        std::cout << "  Content already ingested, skipping." << std::endl;
+        if (progress_) progress_->finish();
+        return stats;
+    }
+
+    preload_atoms();
+    if (progress_) progress_->phase("extract", text.size());
+
+    TextTiling tiled;
+    extract_text(text, atom_lookup_, config_, stats, tiled);
+    if (progress_) {
+        progress_->advance(text.size());
+        progress_->phase("store");
+    }
+
+    store_text(db_, content_record(content_hash, stats.original_bytes), tiled, stats, progress_);
+
+    if (progress_) progress_->finish();
     std::cout << "  Text ingested in " << total_timer.elapsed_sec() << "s" << std::endl;
     return stats;
 }
 
+IngestionStats TextIngester::ingest_stream(const std::string& path) {
+    apply_thread_config();
+    Timer total_timer;
+    IngestionStats stats;
+    config_.source = path;
+
+    MappedFile file(path);
+    const std::string_view data = file.view();
+    stats.original_bytes = data.size();
+
+    auto content_hash = BLAKE3Pipeline::hash(data.data(), data.size());
+    if (db_.query_single("SELECT id FROM hartonomous.content WHERE contenthash = $1", {hash_to_bytea_hex(content_hash)}).has_value()) {
+        std::cout << "  Content already ingested, skipping." << std::endl;
+        if (progress_) progress_->finish();
+        return stats;
+    }
+    const BLAKE3Pipeline::Hash content_id = content_id_of(content_hash);
+
+    preload_atoms();
+    SubstrateCache cache;
+    cache.pre_populate(db_);
+    HashSet128 evidence_seen;
+    CountMinSketch sketch(config_.sketch_width_bits);
+    std::optional<CountMinSketch> pair_sketch;
+    if (config_.sketch_adjacency) pair_sketch.emplace(config_.sketch_width_bits);
+    AsyncFlusher flusher;
+
+    // Windows repeat n-grams locally; the sketch decides if they are frequent
+    NGramConfig ng_config = ngram_config(config_);
+    ng_config.min_frequency = std::min<uint32_t>(config_.min_frequency, 2);
+    const size_t window = std::max<size_t>(config_.stream_window_bytes, 4096);
+    const size_t overlap = std::max<size_t>(config_.stream_overlap_bytes, size_t(4) * config_.max_ngram_size);
+
+    std::u32string utf32, own;
+    size_t windows = 0;
+    if (progress_) progress_->phase("stream", data.size());
+    for (size_t begin = 0; begin < data.size(); ++windows) {
+        const size_t end = window_end(data, begin, window);
+        size_t context = begin - std::min(overlap, begin);
+        while (context < begin && utf8_continuation(data[context])) ++context;
+
+        utf8_to_utf32(data.substr(context, begin - context), utf32);
+        const auto pairs_from = static_cast<uint32_t>(utf32.size());
+        utf8_to_utf32(data.substr(begin, end - begin), own);
+        utf32 += own;
+
+        extractor_ = NGramExtractor(ng_config);
+        extractor_.extract(utf32);
+        stats.ngrams_extracted += extractor_.total_ngrams();
+
+        // The overlap is counted by both windows it lies in; at its size
+        // relative to a window that is noise against min_frequency
+        std::unordered_set<const NGram*> frequent;
+        for (const auto& [id, ng] : extractor_.ngrams()) {
+            if (ng.n < 2) continue;
+            auto key = std::hash<std::u32string_view>{}(ng.text);
+            if (sketch.add(key, ng.frequency) >= config_.min_frequency) frequent.insert(&ng);
+        }
+        auto sig_ngrams = extractor_.significant_ngrams();
+        std::erase_if(sig_ngrams, [&](const NGram* ng) { return ng->n >= 2 && !frequent.count(ng); });
+        stats.ngrams_significant += sig_ngrams.size();
+
+        TextTiling tiled;
+        tile_text(utf32, sig_ngrams, atom_lookup_, pairs_from, tiled);
+        extractor_.clear();
+
+        auto batch = std::make_unique<SubstrateBatch>();
+        std::vector<std::pair<BLAKE3Pipeline::Hash, Eigen::Vector4d>> added;
+        for (auto& [id, cc] : tiled.comp_map) {
+            if (cache.exists_comp(cc.comp.id)) continue;
+            cache.add_comp(cc.comp.id);
+            if (!cache.exists_phys(cc.comp.physicality_id)) {
+                cache.add_phys(cc.comp.physicality_id);
+                batch->phys.push_back(cc.phys);
+            }
+            batch->comp.push_back(cc.comp);
+            batch->seq.insert(batch->seq.end(), cc.seq.begin(), cc.seq.end());
+            added.emplace_back(id, cc.phys.centroid);
+            stats.compositions_new++;
+        }
+        stats.compositions_total += tiled.comp_map.size();
+
+        stats.cooccurrences_found += tiled.adj_pairs.size();
+        for (auto& [pair, adj] : tiled.adj_pairs) {
+            auto it_a = tiled.comp_map.find(pair.comp_a);
+            auto it_b = tiled.comp_map.find(pair.comp_b);
+            if (it_a == tiled.comp_map.end() || it_b == tiled.comp_map.end()) continue;
+
+            // A window's counts are exact but a pair's total spans windows: the
+            // sketch holds back pairs until min_cooccurrence, and the window that
+            // crosses it reports the earlier ones too (an estimate, so at most
+            // slightly high)
+            uint32_t observations = adj.count;
+            if (pair_sketch) {
+                const uint32_t seen = pair_sketch->add(AdjPairHash{}(pair), adj.count);
+                if (seen < config_.min_cooccurrence) continue;
+                if (seen - adj.count < config_.min_cooccurrence) observations = seen;
+            }
+
+            // Geometry only for relations not stored yet: most adjacencies of a
+            // long stream repeat relations an earlier window already emitted
+            const auto& ca = it_a->second.cache_entry;
+            const auto& cb = it_b->second.cache_entry;
+            auto cr = Service::identify_relation(ca, cb, content_id);
+            if (!cr.valid) continue;
+            if (!cache.exists_rel(cr.rel.id)) {
+                cache.add_rel(cr.rel.id);
+                Service::add_relation_geometry(ca, cb, cr);
+                if (!cache.exists_phys(cr.rel.physicality_id)) {
+                    cache.add_phys(cr.rel.physicality_id);
+                    batch->phys.push_back(cr.phys);
+                }
+                batch->rel.push_back(cr.rel);
+                batch->rel_seq.insert(batch->rel_seq.end(), cr.seq.begin(), cr.seq.end());
+                stats.relations_new++;
+            }
+            // Ratings of the same relation from several windows aggregate in the flusher
+            cr.rating.observations = observations;
+            batch->rating.push_back(cr.rating);
+            if (evidence_seen.insert(cr.evidence.id).second) {
+                batch->evidence.push_back(cr.evidence);
+                stats.evidence_count++;
+            }
+            stats.relations_total++;
+        }
+        const size_t records = batch->record_count();
+        flusher.enqueue(std::move(batch));
+        if (progress_) progress_->advance(end - begin, records);
+
+        if (auto centroids = CentroidIndex::loaded(); centroids && !added.empty()) centroids->add(added);
+        auto& neighbors = NeighborCache::global();
+        for (const auto& [id, cc] : tiled.comp_map) neighbors.invalidate(id);
+
+        std::cout << "  [stream] window " << windows + 1 << ": bytes " << begin << "-" << end << " of "
+                  << data.size() << ", " << sig_ngrams.size() << " compositions, "
+                  << tiled.adj_pairs.size() << " adjacencies" << std::endl;
+        begin = end;
+    }
+
+    flusher.wait_all();
+    flusher.print_metrics(std::cout);
+    if (size_t failed = flusher.failed_batches())
+        throw std::runtime_error("ingest_stream: " + std::to_string(failed) + " batches failed to flush for " + path);
+
+    // Last, so an interrupted ingest is not mistaken for a finished one
+    PostgresConnection::Transaction txn(db_);
+    ContentStore(db_).store(content_record(content_hash, stats.original_bytes));
+    txn.commit();
+
+    stats.stored_bytes = stats.original_bytes;
+    if (stats.original_bytes > 0) stats.compression_ratio = 1.0;
+    if (progress_) progress_->finish();
+    std::cout << "  Streamed " << windows << " windows in " << total_timer.elapsed_sec() << "s" << std::endl;
+    return stats;
+}
+
 IngestionStats TextIngester::ingest_file(const std::string& path) {
+    struct stat st;
+    if (config_.discovery == CompositionDiscovery::SuffixArray && config_.stream_window_bytes > 0 && ::stat(path.c_str(), &st) == 0 &&
+        static_cast<size_t>(st.st_size) > config_.stream_window_bytes)
+        return ingest_stream(path);
     std::ifstream file(path); if (!file) throw std::runtime_error("Open failed: " + path);
     std::ostringstream b; b << file.rdbuf(); config_.source = path;
     return ingest(b.str());
 }
 
+IngestionStats TextIngester::ingest_files(const std::vector<std::string>& paths) {
+    apply_thread_config();
+    Timer total_timer;
+    IngestionStats stats;
+    if (paths.empty()) return stats;
+
+    // Hash every file first; one that cannot be read fails the batch before anything is stored
+    const auto n = static_cast<ptrdiff_t>(paths.size());
+    std::vector<BLAKE3Pipeline::Hash> hashes(paths.size());
+    std::vector<size_t> sizes(paths.size());
+    std::vector<std::string> errors(paths.size());
+    if (progress_) progress_->phase("hash");
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        try {
+            MappedFile file(paths[i]);
+            const std::string_view data = file.view();
+            hashes[i] = BLAKE3Pipeline::hash(data.data(), data.size());
+            sizes[i] = data.size();
+            if (progress_) progress_->advance(data.size());
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    }
+    for (const auto& e : errors)
+        if (!e.empty()) throw std::runtime_error("ingest_files: " + e);
+
+    // Content hashes the substrate already holds, in as few round trips as the batch allows
+    std::vector<BLAKE3Pipeline::Hash> probe(hashes);
+    std::sort(probe.begin(), probe.end());
+    probe.erase(std::unique(probe.begin(), probe.end()), probe.end());
+    const auto& stmt = db_.prepare("text_ingester_content_probe", R"(
+        SELECT contenthash FROM hartonomous.content
+        WHERE contenthash IN (SELECT uuid_send(h) FROM unnest($1::uuid[]) h)
+    )", {PgType::UuidArray});
+    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> seen;
+    for (size_t at = 0; at < probe.size(); at += CONTENT_PROBE_BATCH) {
+        const size_t count = std::min(CONTENT_PROBE_BATCH, probe.size() - at);
+        const std::string array = pg_uuid_array(std::span(probe).subspan(at, count));
+        PgResult rows = db_.execute_prepared(stmt, {PgParam::bytes(array.data(), array.size())});
+        for (int r = 0; r < rows.size(); ++r) seen.insert(rows[r].get_uuid(0));
+    }
+
+    // New files in path order, the first of any repeated content winning
+    const bool may_stream = config_.discovery == CompositionDiscovery::SuffixArray && config_.stream_window_bytes > 0;
+    std::vector<size_t> small, large;
+    uint64_t small_bytes = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!seen.insert(hashes[i]).second) {
+            stats.files_skipped++;
+            continue;
+        }
+        if (may_stream && sizes[i] > config_.stream_window_bytes) {
+            large.push_back(i);
+        } else {
+            small.push_back(i);
+            small_bytes += sizes[i];
+        }
+    }
+    std::cout << "  " << paths.size() << " files hashed, " << stats.files_skipped << " already ingested, "
+              << small.size() + large.size() << " new" << std::endl;
+
+    if (!small.empty()) {
+        preload_atoms();
+        if (progress_) progress_->phase("ingest", small_bytes);
+
+        // Extraction only reads the preloaded atoms, so it fans out; one
+        // writer keeps files that share compositions from deadlocking
+        const size_t extractors = std::max<size_t>(1, std::min(worker_threads() - 1, small.size()));
+        IngestPipeline pipeline;
+        auto& pending = pipeline.make_queue<size_t>("files", 4 * extractors);
+        auto& extracted = pipeline.make_queue<std::unique_ptr<FileText>>("extracted", 2 * extractors);
+
+        pipeline.add_source("list", pending, [&](Emitter<size_t>& emit) {
+            for (size_t i : small)
+                if (!emit(i)) return;
+        });
+        pipeline.add_stage("extract", extractors, pending, extracted,
+            [&](size_t& i, Emitter<std::unique_ptr<FileText>>& emit) {
+                apply_thread_config();
+                omp_set_num_threads(static_cast<int>(std::max<size_t>(1, worker_threads() / extractors)));
+                auto item = std::make_unique<FileText>();
+                item->index = i;
+                MappedFile file(paths[i]);
+                item->stats.original_bytes = file.view().size();
+                extract_text(file.view(), atom_lookup_, config_, item->stats, item->tiled);
+                emit(std::move(item));
+            });
+        pipeline.add_sink("store", 1, extracted, [&](std::unique_ptr<FileText>& item) {
+            ContentRecord content = content_record(hashes[item->index], item->stats.original_bytes);
+            content.source = paths[item->index];
+            store_text(db_, content, item->tiled, item->stats, progress_);
+            item->stats.files_ingested = 1;
+            stats += item->stats;
+            if (progress_) progress_->advance(item->stats.original_bytes);
+        });
+        pipeline.run(0);
+    }
+
+    for (size_t i : large) {
+        IngestionStats file_stats = ingest_stream(paths[i]);
+        file_stats.files_ingested = 1;
+        stats += file_stats;
+    }
+
+    if (progress_) progress_->finish();
+    std::cout << "  " << stats.files_ingested << " files ingested in " << total_timer.elapsed_sec() << "s" << std::endl;
+    return stats;
+}
+
+IngestionStats TextIngester::ingest_directory(const std::string& dir) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied))
+        if (entry.is_regular_file()) paths.push_back(entry.path().string());
+    std::sort(paths.begin(), paths.end());
+    return ingest_files(paths);
+}
+
 } // namespace Hartonomous
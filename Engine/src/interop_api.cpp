@@ -2,16 +2,32 @@
 #include <cognitive/godel_engine.hpp>
 #include <cognitive/walk_engine.hpp>
 #include <cognitive/reasoning_engine.hpp>
+#include <cognitive/astar_search.hpp>
+#include <cognitive/neighbor_cache.hpp>
 #include <query/semantic_query.hpp>
+#include <query/centroid_index.hpp>
 #include <ingestion/universal_ingester.hpp>
-#include <database/postgres_connection.hpp>
+#include <database/connection_pool.hpp>
+#include <database/connection_router.hpp>
+#include <database/query_trace.hpp>
+#include <cognitive/live_relation_graph.hpp>
+#include <utils/instance_pool.hpp>
+#include <utils/memory_governor.hpp>
+#include <utils/metrics.hpp>
+#include <utils/token_ring.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <nlohmann/json.hpp>
 #include <unicode/codepoint_projection.hpp>
 #include <spatial/hilbert_curve_4d.hpp>
 #include <geometry/s3_centroid.hpp>
+#include <geometry/s3_batch.hpp>
+#include <storage/atom_lookup.hpp>
 #include <stdexcept>
+#include <filesystem>
 #include <cstring>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <endian.h>
 #include <sstream>
 
@@ -59,23 +75,129 @@ char* strdup_safe(const std::string& str) {
 //  Database Connection
 // =============================================================================
 
+// A database handle is a connection router plus what the engines made from it
+// share. Engine instances lease one connection each for their lifetime;
+// one-shot calls lease per call. Concurrent API requests therefore run on
+// separate connections instead of sharing one.
+// Pool size: HARTONOMOUS_POOL_SIZE (default: hardware threads).
+// Ingestion, feedback and the live relation graph use the primary; the
+// read-only engines and lookups go to a replica when HARTONOMOUS_REPLICA_DSNS
+// names one that is current enough (database/connection_router.hpp).
+struct DbContext {
+    explicit DbContext(const std::string& conninfo) : router(conninfo) {}
+
+    Hartonomous::ConnectionRouter router;
+    mutable std::mutex graph_mutex;
+    std::shared_ptr<const Hartonomous::LiveRelationGraph> graph;  // hartonomous_db_share_relation_graph
+
+    std::shared_ptr<const Hartonomous::LiveRelationGraph> shared_graph() const {
+        std::lock_guard<std::mutex> lock(graph_mutex);
+        return graph;
+    }
+};
+
+static DbContext& context_of(h_db_connection_t handle) {
+    if (!handle) throw std::runtime_error("Invalid database handle");
+    return *static_cast<DbContext*>(handle);
+}
+
+static Hartonomous::ConnectionPool& pool_of(h_db_connection_t handle) {
+    return context_of(handle).router.primary();
+}
+
+static Hartonomous::ConnectionPool& reader_of(h_db_connection_t handle) {
+    return context_of(handle).router.reader();
+}
+
 h_db_connection_t hartonomous_db_create(const char* connection_string) {
     INTEROP_TRY_CATCH_PTR({
-        auto* db = new Hartonomous::PostgresConnection(connection_string);
-        return static_cast<h_db_connection_t>(db);
+        auto* ctx = new DbContext(std::string(connection_string ? connection_string : ""));
+        return static_cast<h_db_connection_t>(ctx);
     })
 }
 
 void hartonomous_db_destroy(h_db_connection_t handle) {
     if (handle) {
-        delete static_cast<Hartonomous::PostgresConnection*>(handle);
+        delete static_cast<DbContext*>(handle);
     }
 }
 
 bool hartonomous_db_is_connected(h_db_connection_t handle) {
     if (!handle) return false;
-    auto* db = static_cast<Hartonomous::PostgresConnection*>(handle);
-    return db->is_connected(); 
+    return static_cast<DbContext*>(handle)->router.primary().healthy();
+}
+
+bool hartonomous_db_share_relation_graph(h_db_connection_t handle) {
+    INTEROP_TRY_CATCH({
+        auto& ctx = context_of(handle);
+        std::lock_guard<std::mutex> lock(ctx.graph_mutex);
+        if (!ctx.graph) {
+            auto live = std::make_shared<Hartonomous::LiveRelationGraph>(ctx.router.primary());
+            live->start();
+            ctx.graph = std::move(live);
+        }
+        return true;
+    })
+}
+
+bool hartonomous_preload_shared_caches(const char* atom_image, const char* relation_graph) {
+    INTEROP_TRY_CATCH({
+        auto pin = [](const char* given, const std::string& fallback, bool (*load)(const std::string&),
+                      const char* what) {
+            const bool named = given && *given;
+            const std::string path = named ? given : fallback;
+            if (path.empty() || (!named && !std::filesystem::exists(path))) return;
+            if (!load(path)) throw std::runtime_error(std::string("Cannot map ") + what + ": " + path);
+        };
+        pin(atom_image, Hartonomous::AtomLookup::default_image_path(), &Hartonomous::AtomLookup::pin_image,
+            "atom image");
+        pin(relation_graph, Hartonomous::RelationGraph::default_path(), &Hartonomous::RelationGraph::pin_file,
+            "relation graph");
+        return true;
+    })
+}
+
+// Walk, query, Godel and reasoning handles: a pool of interchangeable engines
+// over one database handle. Every call checks one out, so a single handle
+// serves concurrent callers; instances beyond the first cost a connection
+// lease and no reload, since the caches behind them are process-wide.
+// Instances are built on the router's current reader; when the eligible
+// replicas change they are retired, so later calls move with the routing.
+template <typename Engine>
+struct EngineHandle {
+    EngineHandle(DbContext& ctx)
+        : db(ctx), epoch(ctx.router.epoch()),
+          instances([&ctx] { return std::make_unique<Engine>(ctx.router.reader()); }) {}
+
+    DbContext& db;
+    std::atomic<uint64_t> epoch;
+    Hartonomous::InstancePool<Engine> instances;
+};
+
+template <typename Engine>
+static typename Hartonomous::InstancePool<Engine>::Lease lease_engine(void* handle) {
+    if (!handle) throw std::runtime_error("Invalid engine handle");
+    auto& h = *static_cast<EngineHandle<Engine>*>(handle);
+    const uint64_t epoch = h.db.router.epoch();
+    if (h.epoch.exchange(epoch, std::memory_order_acq_rel) != epoch) h.instances.retire();
+    auto engine = h.instances.acquire();
+    if constexpr (requires { engine->follow_relation_graph(h.db.shared_graph()); }) {
+        if (!engine->has_relation_graph())
+            if (auto graph = h.db.shared_graph()) engine->follow_relation_graph(std::move(graph));
+    }
+    return engine;
+}
+
+template <typename Engine>
+static void* create_engine(h_db_connection_t db_handle) {
+    INTEROP_TRY_CATCH_PTR({
+        return static_cast<void*>(new EngineHandle<Engine>(context_of(db_handle)));
+    })
+}
+
+template <typename Engine>
+static void destroy_engine(void* handle) {
+    delete static_cast<EngineHandle<Engine>*>(handle);
 }
 
 // =============================================================================
@@ -94,8 +216,7 @@ void hartonomous_blake3_hash_codepoint(uint32_t codepoint, uint8_t* out_16b) {
 
 bool hartonomous_codepoint_to_s3(uint32_t codepoint, double* out_4d) {
     INTEROP_TRY_CATCH({
-        auto proj = hartonomous::unicode::CodepointProjection::project(static_cast<char32_t>(codepoint));
-        std::memcpy(out_4d, proj.s3_position.data(), 4 * sizeof(double));
+        hartonomous::unicode::CodepointProjection::s3_positions(&codepoint, 1, out_4d);
         return true;
     })
 }
@@ -119,30 +240,67 @@ void hartonomous_s3_compute_centroid(const double* points_4d, size_t count, doub
     std::memcpy(out_4d, centroid.data(), 4 * sizeof(double));
 }
 
+bool hartonomous_codepoints_to_s3(const uint32_t* codepoints, size_t count, double* out_4d) {
+    INTEROP_TRY_CATCH({
+        hartonomous::unicode::CodepointProjection::s3_positions(codepoints, count, out_4d);
+        return true;
+    })
+}
+
+void hartonomous_s3_compute_centroids(const double* points_4d, const size_t* counts, size_t groups, double* out_4d) {
+    for (size_t g = 0, offset = 0; g < groups; offset += counts[g++]) {
+        auto centroid = Hartonomous::Geometry::compute_s3_centroid(points_4d + 4 * offset, counts[g]);
+        std::memcpy(out_4d + 4 * g, centroid.data(), 4 * sizeof(double));
+    }
+}
+
+void hartonomous_hopf_forward_batch(const double* x, const double* y, const double* z, const double* w, size_t count,
+                                    double* out_x, double* out_y, double* out_z) {
+    s3::hopf_forward_many(x, y, z, w, count, out_x, out_y, out_z);
+}
+
+void hartonomous_hopf_inverse_batch(const double* x, const double* y, const double* z, const double* fiber_angle, size_t count,
+                                    double* out_x, double* out_y, double* out_z, double* out_w) {
+    s3::hopf_inverse_many(x, y, z, fiber_angle, count, out_x, out_y, out_z, out_w);
+}
+
 // =============================================================================
 //  Ingestion Service
 // =============================================================================
 
+// Ingesters write to the primary and note the WAL position after each call,
+// so replica reads that follow see what was just ingested
+struct IngesterHandle {
+    explicit IngesterHandle(DbContext& ctx) : db(ctx), ingester(ctx.router.primary()) {}
+
+    DbContext& db;
+    Hartonomous::UniversalIngester ingester;
+};
+
+static IngesterHandle& ingester_of(h_ingester_t handle) {
+    if (!handle) throw std::runtime_error("Invalid ingester handle");
+    return *static_cast<IngesterHandle*>(handle);
+}
+
 h_ingester_t hartonomous_ingester_create(h_db_connection_t db_handle) {
     INTEROP_TRY_CATCH_PTR({
-        if (!db_handle) throw std::runtime_error("Invalid database handle");
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
-        auto* ingester = new Hartonomous::UniversalIngester(*db);
+        auto* ingester = new IngesterHandle(context_of(db_handle));
         return static_cast<h_ingester_t>(ingester);
     })
 }
 
 void hartonomous_ingester_destroy(h_ingester_t handle) {
     if (handle) {
-        delete static_cast<Hartonomous::UniversalIngester*>(handle);
+        delete static_cast<IngesterHandle*>(handle);
     }
 }
 
 bool hartonomous_ingest_text(h_ingester_t handle, const char* text, HIngestionStats* out_stats) {
     INTEROP_TRY_CATCH({
         if (!handle || !text || !out_stats) throw std::runtime_error("Invalid parameters");
-        auto* ingester = static_cast<Hartonomous::UniversalIngester*>(handle);
-        auto stats = ingester->ingest_text(text);
+        auto& h = ingester_of(handle);
+        auto stats = h.ingester.ingest_text(text);
+        h.db.router.note_primary_write();
         
         out_stats->atoms_total = stats.atoms_total;
         out_stats->atoms_new = stats.atoms_new;
@@ -166,8 +324,9 @@ bool hartonomous_ingest_text(h_ingester_t handle, const char* text, HIngestionSt
 bool hartonomous_ingest_file(h_ingester_t handle, const char* file_path, HIngestionStats* out_stats) {
     INTEROP_TRY_CATCH({
         if (!handle || !file_path || !out_stats) throw std::runtime_error("Invalid parameters");
-        auto* ingester = static_cast<Hartonomous::UniversalIngester*>(handle);
-        auto stats = ingester->ingest_path(file_path);
+        auto& h = ingester_of(handle);
+        auto stats = h.ingester.ingest_path(file_path);
+        h.db.router.note_primary_write();
 
         out_stats->atoms_total = stats.atoms_total;
         out_stats->atoms_new = stats.atoms_new;
@@ -187,32 +346,64 @@ bool hartonomous_ingest_file(h_ingester_t handle, const char* file_path, HIngest
         return true;
     })
 }
+namespace {
+void to_c(const Hartonomous::IngestProgress& p, HIngestProgress* out) {
+    std::memset(out, 0, sizeof(*out));
+    std::strncpy(out->phase, p.phase.c_str(), sizeof(out->phase) - 1);
+    out->bytes_done = p.bytes_done;
+    out->bytes_total = p.bytes_total;
+    out->records = p.records;
+    out->elapsed_sec = p.elapsed_sec;
+    out->bytes_per_sec = p.bytes_per_sec;
+    out->records_per_sec = p.records_per_sec;
+    out->eta_sec = p.eta_sec;
+    out->finished = p.finished;
+}
+
+Hartonomous::IngestProgressCallback wrap_progress(HIngestProgressCallback callback, void* user_data) {
+    if (!callback) return {};
+    return [callback, user_data](const Hartonomous::IngestProgress& p) {
+        HIngestProgress c;
+        to_c(p, &c);
+        callback(&c, user_data);
+    };
+}
+} // namespace
+
+bool hartonomous_ingester_set_progress(h_ingester_t handle, HIngestProgressCallback callback,
+                                       void* user_data, uint32_t interval_ms) {
+    INTEROP_TRY_CATCH({
+        if (!handle) throw std::runtime_error("Invalid parameters");
+        ingester_of(handle).ingester.progress().set_callback(wrap_progress(callback, user_data),
+                                          std::chrono::milliseconds(interval_ms));
+        return true;
+    })
+}
+
+bool hartonomous_ingester_get_progress(h_ingester_t handle, HIngestProgress* out_progress) {
+    INTEROP_TRY_CATCH({
+        if (!handle || !out_progress) throw std::runtime_error("Invalid parameters");
+        to_c(ingester_of(handle).ingester.progress().snapshot(), out_progress);
+        return true;
+    })
+}
+
 // =============================================================================
 //  Walk Engine
 // =============================================================================
 
 h_walk_engine_t hartonomous_walk_create(h_db_connection_t db_handle) {
-    try {
-        if (!db_handle) throw std::runtime_error("Invalid database handle");
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
-        auto* engine = new Hartonomous::WalkEngine(*db);
-        return static_cast<h_walk_engine_t>(engine);
-    } catch (const std::exception& e) {
-        set_error(e);
-        return nullptr;
-    }
+    return create_engine<Hartonomous::WalkEngine>(db_handle);
 }
 
 void hartonomous_walk_destroy(h_walk_engine_t handle) {
-    if (handle) {
-        delete static_cast<Hartonomous::WalkEngine*>(handle);
-    }
+    destroy_engine<Hartonomous::WalkEngine>(handle);
 }
 
 bool hartonomous_walk_init(h_walk_engine_t handle, const uint8_t* start_id, double initial_energy, HWalkState* out_state) {
     try {
         if (!handle || !start_id || !out_state) return false;
-        auto* engine = static_cast<Hartonomous::WalkEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::WalkEngine>(handle);
         
         Hartonomous::BLAKE3Pipeline::Hash id;
         std::memcpy(id.data(), start_id, 16);
@@ -225,6 +416,8 @@ bool hartonomous_walk_init(h_walk_engine_t handle, const uint8_t* start_id, doub
         out_state->current_position[2] = state.current_position[2];
         out_state->current_position[3] = state.current_position[3];
         out_state->current_energy = state.current_energy;
+        out_state->rng_key = state.rng_key;
+        out_state->rng_step = state.rng_step;
         
         return true;
     } catch (const std::exception& e) {
@@ -236,7 +429,7 @@ bool hartonomous_walk_init(h_walk_engine_t handle, const uint8_t* start_id, doub
 bool hartonomous_walk_step(h_walk_engine_t handle, HWalkState* in_out_state, const HWalkParameters* params, HWalkStepResult* out_result) {
     try {
         if (!handle || !in_out_state || !params || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::WalkEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::WalkEngine>(handle);
         
         // Reconstruct C++ state from C struct
         Hartonomous::WalkState state;
@@ -248,6 +441,8 @@ bool hartonomous_walk_step(h_walk_engine_t handle, HWalkState* in_out_state, con
             in_out_state->current_position[3]
         );
         state.current_energy = in_out_state->current_energy;
+        state.rng_key = in_out_state->rng_key;
+        state.rng_step = in_out_state->rng_step;
         
         Hartonomous::WalkParameters p;
         p.w_model = params->w_model;
@@ -281,6 +476,7 @@ bool hartonomous_walk_step(h_walk_engine_t handle, HWalkState* in_out_state, con
         in_out_state->current_position[2] = state.current_position[2];
         in_out_state->current_position[3] = state.current_position[3];
         in_out_state->current_energy = state.current_energy;
+        in_out_state->rng_step = state.rng_step;
 
         return true;
     } catch (const std::exception& e) {
@@ -292,7 +488,7 @@ bool hartonomous_walk_step(h_walk_engine_t handle, HWalkState* in_out_state, con
 bool hartonomous_walk_set_goal(h_walk_engine_t handle, HWalkState* in_out_state, const uint8_t* goal_id) {
     try {
         if (!handle || !in_out_state || !goal_id) return false;
-        auto* engine = static_cast<Hartonomous::WalkEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::WalkEngine>(handle);
         
         // Reconstruct state
         Hartonomous::WalkState state;
@@ -310,32 +506,30 @@ bool hartonomous_walk_set_goal(h_walk_engine_t handle, HWalkState* in_out_state,
     }
 }
 
+void hartonomous_walk_seed(HWalkState* in_out_state, uint64_t seed, uint64_t stream) {
+    if (!in_out_state) return;
+    Hartonomous::WalkState state;
+    Hartonomous::WalkEngine::seed_walk(state, seed, stream);
+    in_out_state->rng_key = state.rng_key;
+    in_out_state->rng_step = state.rng_step;
+}
+
 // =============================================================================
 //  Godel Engine
 // =============================================================================
 
 h_godel_t hartonomous_godel_create(h_db_connection_t db_handle) {
-    try {
-        if (!db_handle) throw std::runtime_error("Invalid database handle");
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
-        auto* godel = new Hartonomous::GodelEngine(*db);
-        return static_cast<h_godel_t>(godel);
-    } catch (const std::exception& e) {
-        set_error(e);
-        return nullptr;
-    }
+    return create_engine<Hartonomous::GodelEngine>(db_handle);
 }
 
 void hartonomous_godel_destroy(h_godel_t handle) {
-    if (handle) {
-        delete static_cast<Hartonomous::GodelEngine*>(handle);
-    }
+    destroy_engine<Hartonomous::GodelEngine>(handle);
 }
 
 bool hartonomous_godel_analyze(h_godel_t handle, const char* problem, HResearchPlan* out_plan) {
     try {
         if (!handle || !problem || !out_plan) return false;
-        auto* godel = static_cast<Hartonomous::GodelEngine*>(handle);
+        auto godel = lease_engine<Hartonomous::GodelEngine>(handle);
         auto plan = godel->analyze_problem(problem);
         
         out_plan->original_problem = strdup_safe(plan.original_problem);
@@ -420,7 +614,7 @@ static std::string resolve_composition_text(Hartonomous::PostgresConnection& db,
 char* hartonomous_composition_text(h_db_connection_t db_handle, const uint8_t* hash_16b) {
     try {
         if (!db_handle || !hash_16b) return nullptr;
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
+        auto db = reader_of(db_handle).acquire();
         Hartonomous::BLAKE3Pipeline::Hash hash;
         std::memcpy(hash.data(), hash_16b, 16);
         auto text = resolve_composition_text(*db, hash);
@@ -434,7 +628,7 @@ char* hartonomous_composition_text(h_db_connection_t db_handle, const uint8_t* h
 bool hartonomous_composition_position(h_db_connection_t db_handle, const uint8_t* hash_16b, double* out_4d) {
     try {
         if (!db_handle || !hash_16b || !out_4d) return false;
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
+        auto db = reader_of(db_handle).acquire();
         Hartonomous::BLAKE3Pipeline::Hash hash;
         std::memcpy(hash.data(), hash_16b, 16);
         std::string hex_id = Hartonomous::BLAKE3Pipeline::to_hex(hash);
@@ -460,6 +654,41 @@ bool hartonomous_composition_position(h_db_connection_t db_handle, const uint8_t
     }
 }
 
+bool hartonomous_composition_nearest(h_db_connection_t db_handle, const double* in_4d, size_t k,
+                                     uint8_t* out_ids_16b, double* out_distances, size_t* out_count) {
+    try {
+        if (!db_handle || !in_4d || !out_count || (k > 0 && (!out_ids_16b || !out_distances))) return false;
+        auto index = Hartonomous::CentroidIndex::loaded();
+        if (!index) {
+            auto db = reader_of(db_handle).acquire();
+            index = Hartonomous::CentroidIndex::shared(*db);
+        }
+        auto hits = index->nearest(Eigen::Vector4d(in_4d[0], in_4d[1], in_4d[2], in_4d[3]), k);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            std::memcpy(out_ids_16b + 16 * i, hits[i].id.data(), 16);
+            out_distances[i] = hits[i].distance;
+        }
+        *out_count = hits.size();
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+bool hartonomous_centroid_index_refresh(h_db_connection_t db_handle, size_t* out_added) {
+    try {
+        if (!db_handle) return false;
+        auto db = reader_of(db_handle).acquire();
+        size_t added = Hartonomous::CentroidIndex::shared(*db)->refresh(*db);
+        if (out_added) *out_added = added;
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
 void hartonomous_free_string(char* str) {
     if (str) free(str);
 }
@@ -494,6 +723,7 @@ static Hartonomous::WalkParameters map_generate_params(const HGenerateParams* pa
     Hartonomous::WalkParameters wp;
     if (params->temperature > 0.0) wp.base_temp = params->temperature;
     if (params->energy_decay > 0.0) wp.energy_decay = params->energy_decay;
+    if (params->seed != 0) wp.seed = params->seed;
     return wp;
 }
 
@@ -502,7 +732,7 @@ bool hartonomous_generate(h_walk_engine_t walk_handle, h_db_connection_t db_hand
                           HGenerateResult* out_result) {
     try {
         if (!walk_handle || !db_handle || !prompt || !params || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::WalkEngine*>(walk_handle);
+        auto engine = lease_engine<Hartonomous::WalkEngine>(walk_handle);
 
         auto wp = map_generate_params(params);
         size_t max_steps = (params->max_tokens > 0) ? params->max_tokens : 50;
@@ -520,52 +750,63 @@ bool hartonomous_generate(h_walk_engine_t walk_handle, h_db_connection_t db_hand
     }
 }
 
-bool hartonomous_generate_stream(h_walk_engine_t walk_handle, h_db_connection_t db_handle,
-                                  const char* prompt, const HGenerateParams* params,
-                                  HGenerateCallback callback, void* user_data,
-                                  HGenerateResult* out_result) {
-    try {
-        if (!walk_handle || !db_handle || !prompt || !params || !callback || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::WalkEngine*>(walk_handle);
+// Walk text one fragment at a time, handing each to emit(token, step, energy); false from emit stops the walk
+template <typename Emit>
+static bool generate_fragments(h_walk_engine_t walk_handle, const char* prompt, const HGenerateParams* params,
+                               Emit&& emit, HGenerateResult* out_result) {
+    auto engine = lease_engine<Hartonomous::WalkEngine>(walk_handle);
 
-        auto wp = map_generate_params(params);
-        size_t max_steps = (params->max_tokens > 0) ? params->max_tokens : 50;
+    auto wp = map_generate_params(params);
+    size_t max_steps = (params->max_tokens > 0) ? params->max_tokens : 50;
 
-        auto state = engine->init_walk_from_prompt(prompt, 1.0);
+    auto state = engine->init_walk_from_prompt(prompt, 1.0);
+    if (wp.seed) Hartonomous::WalkEngine::seed_walk(state, *wp.seed);
 
-        std::ostringstream full_output;
-        size_t steps = 0;
-        std::string prev_text;
+    std::ostringstream full_output;
+    size_t steps = 0;
+    std::string prev_text;
 
-        while (steps < max_steps) {
-            auto result = engine->step(state, wp);
-            if (result.terminated) {
-                std::strncpy(out_result->finish_reason, result.reason.c_str(), 63);
-                out_result->finish_reason[63] = '\0';
-                break;
-            }
+    while (steps < max_steps) {
+        auto result = engine->step(state, wp);
+        if (result.terminated) {
+            std::strncpy(out_result->finish_reason, result.reason.c_str(), 63);
+            out_result->finish_reason[63] = '\0';
+            break;
+        }
 
-            auto text = engine->lookup_text(result.next_composition);
-            if (!text.empty() && text != prev_text) {
-                std::string token = (full_output.tellp() == 0) ? text : (" " + text);
-                full_output << token;
-                if (!callback(token.c_str(), steps, result.energy_remaining, user_data)) {
-                    std::strncpy(out_result->finish_reason, "stop", 63);
-                    break;
-                }
-                prev_text = text;
+        std::string text(engine->lookup_text(result.next_composition));
+        if (!text.empty() && text != prev_text) {
+            std::string token = (full_output.tellp() == 0) ? text : (" " + text);
+            full_output << token;
+            if (!emit(token, steps, result.energy_remaining)) {
+                std::strncpy(out_result->finish_reason, "stop", 63);
+                break;
             }
-            ++steps;
+            prev_text = text;
         }
+        ++steps;
+    }
 
-        if (out_result->finish_reason[0] == '\0') {
-            std::strncpy(out_result->finish_reason, "length", 63);
-        }
+    if (out_result->finish_reason[0] == '\0') {
+        std::strncpy(out_result->finish_reason, "length", 63);
+    }
 
-        out_result->text = strdup_safe(full_output.str());
-        out_result->steps = steps;
-        out_result->total_energy_used = 1.0 - state.current_energy;
-        return true;
+    out_result->text = strdup_safe(full_output.str());
+    out_result->steps = steps;
+    out_result->total_energy_used = 1.0 - state.current_energy;
+    return true;
+}
+
+bool hartonomous_generate_stream(h_walk_engine_t walk_handle, h_db_connection_t db_handle,
+                                  const char* prompt, const HGenerateParams* params,
+                                  HGenerateCallback callback, void* user_data,
+                                  HGenerateResult* out_result) {
+    try {
+        if (!walk_handle || !db_handle || !prompt || !params || !callback || !out_result) return false;
+        return generate_fragments(walk_handle, prompt, params,
+            [&](const std::string& token, size_t step, double energy) {
+                return callback(token.c_str(), step, energy, user_data);
+            }, out_result);
     } catch (const std::exception& e) {
         set_error(e);
         return false;
@@ -577,28 +818,18 @@ bool hartonomous_generate_stream(h_walk_engine_t walk_handle, h_db_connection_t
 // =============================================================================
 
 h_query_t hartonomous_query_create(h_db_connection_t db_handle) {
-    try {
-        if (!db_handle) throw std::runtime_error("Invalid database handle");
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
-        auto* query = new Hartonomous::SemanticQuery(*db);
-        return static_cast<h_query_t>(query);
-    } catch (const std::exception& e) {
-        set_error(e);
-        return nullptr;
-    }
+    return create_engine<Hartonomous::SemanticQuery>(db_handle);
 }
 
 void hartonomous_query_destroy(h_query_t handle) {
-    if (handle) {
-        delete static_cast<Hartonomous::SemanticQuery*>(handle);
-    }
+    destroy_engine<Hartonomous::SemanticQuery>(handle);
 }
 
 bool hartonomous_query_related(h_query_t handle, const char* text, size_t limit,
                                HQueryResult** out_results, size_t* out_count) {
     try {
         if (!handle || !text || !out_results || !out_count) return false;
-        auto* query = static_cast<Hartonomous::SemanticQuery*>(handle);
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
         auto results = query->find_related(text, limit);
 
         *out_count = results.size();
@@ -616,11 +847,33 @@ bool hartonomous_query_related(h_query_t handle, const char* text, size_t limit,
     }
 }
 
+bool hartonomous_query_nearest(h_query_t handle, const char* text, size_t limit,
+                               HQueryResult** out_results, size_t* out_count) {
+    try {
+        if (!handle || !text || !out_results || !out_count) return false;
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
+        auto results = query->find_nearest(text, limit);
+
+        *out_count = results.size();
+        if (results.empty()) { *out_results = nullptr; return true; }
+
+        *out_results = new HQueryResult[results.size()];
+        for (size_t i = 0; i < results.size(); ++i) {
+            (*out_results)[i].text = strdup_safe(results[i].text);
+            (*out_results)[i].confidence = results[i].confidence;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
 bool hartonomous_query_truth(h_query_t handle, const char* text, double min_elo,
                               size_t limit, HQueryResult** out_results, size_t* out_count) {
     try {
         if (!handle || !text || !out_results || !out_count) return false;
-        auto* query = static_cast<Hartonomous::SemanticQuery*>(handle);
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
         auto results = query->find_gravitational_truth(text, min_elo, limit);
 
         *out_count = results.size();
@@ -641,7 +894,7 @@ bool hartonomous_query_truth(h_query_t handle, const char* text, double min_elo,
 bool hartonomous_query_answer(h_query_t handle, const char* question, HQueryResult* out_result) {
     try {
         if (!handle || !question || !out_result) return false;
-        auto* query = static_cast<Hartonomous::SemanticQuery*>(handle);
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
         auto result = query->answer_question(question);
 
         if (!result) {
@@ -667,26 +920,141 @@ void hartonomous_query_free_results(HQueryResult* results, size_t count) {
     delete[] results;
 }
 
-// =============================================================================
-//  Reasoning Engine
-// =============================================================================
+static_assert(sizeof(HResultSet) % alignof(double) == 0, "arrays follow the header unpadded");
 
-h_reasoning_t hartonomous_reasoning_create(h_db_connection_t db_handle) {
+// One malloc'd block: the header, then query offsets, confidences, text offsets and the text
+static HResultSet* pack_result_set(const std::vector<std::vector<Hartonomous::QueryResult>>& per_query) {
+    const size_t nq = per_query.size();
+    size_t count = 0, text_bytes = 0;
+    for (const auto& results : per_query) {
+        count += results.size();
+        for (const auto& r : results) text_bytes += r.text.size() + 1;
+    }
+
+    const size_t bytes = sizeof(HResultSet) + (nq + 1) * sizeof(uint64_t) + count * sizeof(double)
+                       + (count + 1) * sizeof(uint64_t) + text_bytes;
+    auto* block = static_cast<uint8_t*>(std::malloc(bytes));
+    if (!block) throw std::bad_alloc();
+    auto* query_offsets = reinterpret_cast<uint64_t*>(block + sizeof(HResultSet));
+    auto* confidences = reinterpret_cast<double*>(query_offsets + nq + 1);
+    auto* text_offsets = reinterpret_cast<uint64_t*>(confidences + count);
+    auto* text = reinterpret_cast<char*>(text_offsets + count + 1);
+
+    size_t i = 0;
+    uint64_t off = 0;
+    for (size_t q = 0; q < nq; ++q) {
+        query_offsets[q] = i;
+        for (const auto& r : per_query[q]) {
+            confidences[i] = r.confidence;
+            text_offsets[i++] = off;
+            std::memcpy(text + off, r.text.data(), r.text.size());
+            off += r.text.size();
+            text[off++] = '\0';
+        }
+    }
+    query_offsets[nq] = i;
+    text_offsets[count] = off;
+
+    auto* set = reinterpret_cast<HResultSet*>(block);
+    *set = {nq, count, query_offsets, confidences, text_offsets, text};
+    return set;
+}
+
+// run(query, text) for every text (NULL entries get no results), packed into *out_set
+template <typename Run>
+static bool query_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                        HResultSet** out_set, Run run) {
+    if (out_set) *out_set = nullptr;
     try {
-        if (!db_handle) throw std::runtime_error("Invalid database handle");
-        auto* db = static_cast<Hartonomous::PostgresConnection*>(db_handle);
-        auto* engine = new Hartonomous::ReasoningEngine(*db);
-        return static_cast<h_reasoning_t>(engine);
+        if (!handle || !out_set || (query_count > 0 && !texts)) return false;
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
+        std::vector<std::vector<Hartonomous::QueryResult>> per_query(query_count);
+        for (size_t q = 0; q < query_count; ++q)
+            if (texts[q]) per_query[q] = run(*query, texts[q]);
+        *out_set = pack_result_set(per_query);
+        return true;
     } catch (const std::exception& e) {
         set_error(e);
-        return nullptr;
+        return false;
     }
 }
 
-void hartonomous_reasoning_destroy(h_reasoning_t handle) {
-    if (handle) {
-        delete static_cast<Hartonomous::ReasoningEngine*>(handle);
+// The non-NULL entries of texts, and where each came from
+static std::vector<std::string> present_texts(const char* const* texts, size_t count, std::vector<size_t>& from) {
+    std::vector<std::string> out;
+    for (size_t q = 0; q < count; ++q) {
+        if (!texts[q]) continue;
+        out.emplace_back(texts[q]);
+        from.push_back(q);
     }
+    return out;
+}
+
+bool hartonomous_query_related_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                     size_t limit, HResultSet** out_set) {
+    if (out_set) *out_set = nullptr;
+    try {
+        if (!handle || !out_set || (query_count > 0 && !texts)) return false;
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
+        std::vector<size_t> from;
+        auto related = query->find_related_batch(present_texts(texts, query_count, from), limit);
+        std::vector<std::vector<Hartonomous::QueryResult>> per_query(query_count);
+        for (size_t k = 0; k < from.size(); ++k) per_query[from[k]] = std::move(related[k]);
+        *out_set = pack_result_set(per_query);
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+bool hartonomous_query_answer_batch(h_query_t handle, const char* const* questions, size_t question_count,
+                                    HResultSet** out_set) {
+    if (out_set) *out_set = nullptr;
+    try {
+        if (!handle || !out_set || (question_count > 0 && !questions)) return false;
+        auto query = lease_engine<Hartonomous::SemanticQuery>(handle);
+        std::vector<size_t> from;
+        auto answers = query->answer_question_batch(present_texts(questions, question_count, from));
+        std::vector<std::vector<Hartonomous::QueryResult>> per_query(question_count);
+        for (size_t k = 0; k < from.size(); ++k)
+            if (answers[k]) per_query[from[k]].push_back(std::move(*answers[k]));
+        *out_set = pack_result_set(per_query);
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+bool hartonomous_query_nearest_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                     size_t limit, HResultSet** out_set) {
+    return query_batch(handle, texts, query_count, out_set,
+        [&](Hartonomous::SemanticQuery& q, const char* text) { return q.find_nearest(text, limit); });
+}
+
+bool hartonomous_query_truth_batch(h_query_t handle, const char* const* texts, size_t query_count,
+                                   double min_elo, size_t limit, HResultSet** out_set) {
+    return query_batch(handle, texts, query_count, out_set,
+        [&](Hartonomous::SemanticQuery& q, const char* text) {
+            return q.find_gravitational_truth(text, min_elo, limit);
+        });
+}
+
+void hartonomous_result_set_free(HResultSet* set) {
+    std::free(set);
+}
+
+// =============================================================================
+//  Reasoning Engine
+// =============================================================================
+
+h_reasoning_t hartonomous_reasoning_create(h_db_connection_t db_handle) {
+    return create_engine<Hartonomous::ReasoningEngine>(db_handle);
+}
+
+void hartonomous_reasoning_destroy(h_reasoning_t handle) {
+    destroy_engine<Hartonomous::ReasoningEngine>(handle);
 }
 
 static Hartonomous::ReasoningConfig map_reasoning_config(const HReasoningConfig* c) {
@@ -700,6 +1068,8 @@ static Hartonomous::ReasoningConfig map_reasoning_config(const HReasoningConfig*
         if (c->max_reflexion_rounds > 0) config.max_reflexion_rounds = c->max_reflexion_rounds;
         config.include_reasoning_trace = c->include_trace;
         if (c->system_prompt) config.system_prompt = c->system_prompt;
+        config.deadline = std::chrono::milliseconds(c->deadline_ms);
+        config.max_tokens = c->max_tokens;
     }
     return config;
 }
@@ -711,6 +1081,8 @@ static void fill_reasoning_result(const Hartonomous::ReasoningResult& src, HReas
     dst->intentions_total = src.intentions_total;
     dst->reflexion_rounds = src.reflexion_rounds;
     dst->nodes_expanded = src.nodes_expanded;
+    std::strncpy(dst->finish_reason, src.finish_reason.c_str(), 63);
+    dst->finish_reason[63] = '\0';
 
     if (!src.reasoning_trace.empty()) {
         dst->trace_count = src.reasoning_trace.size();
@@ -729,7 +1101,7 @@ bool hartonomous_reason(h_reasoning_t handle, const char* prompt,
                          HReasoningResult* out_result) {
     try {
         if (!handle || !prompt || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::ReasoningEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
         auto cfg = map_reasoning_config(config);
         auto result = engine->reason(prompt, cfg);
         fill_reasoning_result(result, out_result);
@@ -740,20 +1112,82 @@ bool hartonomous_reason(h_reasoning_t handle, const char* prompt,
     }
 }
 
+// Back-to-back turns of one conversation may arrive on different threads
+struct ReasoningSessionHandle {
+    std::mutex turn;
+    Hartonomous::ReasoningSession session;
+};
+
+h_reasoning_session_t hartonomous_reasoning_session_create(void) {
+    try {
+        return static_cast<h_reasoning_session_t>(new ReasoningSessionHandle());
+    } catch (const std::exception& e) {
+        set_error(e);
+        return nullptr;
+    }
+}
+
+void hartonomous_reasoning_session_destroy(h_reasoning_session_t session) {
+    delete static_cast<ReasoningSessionHandle*>(session);
+}
+
+bool hartonomous_reason_turn(h_reasoning_t handle, h_reasoning_session_t session,
+                             const char* prompt, const HReasoningConfig* config,
+                             HReasoningResult* out_result) {
+    try {
+        if (!handle || !session || !prompt || !out_result) return false;
+        auto& s = *static_cast<ReasoningSessionHandle*>(session);
+        auto cfg = map_reasoning_config(config);
+        std::lock_guard<std::mutex> lock(s.turn);
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
+        auto result = engine->reason(s.session, prompt, cfg);
+        fill_reasoning_result(result, out_result);
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+// The handle owns a shared_ptr so a stream keeps its token alive whatever the caller does
+using CancelHandle = std::shared_ptr<Hartonomous::CancellationToken>;
+
+h_cancel_t hartonomous_cancel_create(void) {
+    try {
+        return static_cast<h_cancel_t>(new CancelHandle(std::make_shared<Hartonomous::CancellationToken>()));
+    } catch (const std::exception& e) {
+        set_error(e);
+        return nullptr;
+    }
+}
+
+void hartonomous_cancel(h_cancel_t handle) {
+    if (handle) (*static_cast<CancelHandle*>(handle))->cancel();
+}
+
+bool hartonomous_cancel_requested(h_cancel_t handle) {
+    return handle && (*static_cast<CancelHandle*>(handle))->cancelled();
+}
+
+void hartonomous_cancel_destroy(h_cancel_t handle) {
+    delete static_cast<CancelHandle*>(handle);
+}
+
 bool hartonomous_reason_stream(h_reasoning_t handle, const char* prompt,
                                 const HReasoningConfig* config,
                                 HReasoningStreamCallback callback,
                                 void* user_data,
+                                h_cancel_t cancel,
                                 HReasoningResult* out_result) {
     try {
         if (!handle || !prompt || !callback || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::ReasoningEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
         auto cfg = map_reasoning_config(config);
 
         auto result = engine->reason_stream(prompt,
             [&](const std::string& token, size_t step) -> bool {
                 return callback(token.c_str(), step, user_data);
-            }, cfg);
+            }, cfg, cancel ? *static_cast<CancelHandle*>(cancel) : nullptr);
 
         fill_reasoning_result(result, out_result);
         return true;
@@ -767,7 +1201,7 @@ bool hartonomous_quick_answer(h_reasoning_t handle, const char* prompt,
                                HReasoningResult* out_result) {
     try {
         if (!handle || !prompt || !out_result) return false;
-        auto* engine = static_cast<Hartonomous::ReasoningEngine*>(handle);
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
         auto result = engine->quick_answer(prompt);
         fill_reasoning_result(result, out_result);
         return true;
@@ -777,6 +1211,26 @@ bool hartonomous_quick_answer(h_reasoning_t handle, const char* prompt,
     }
 }
 
+bool hartonomous_quick_answer_batch(h_reasoning_t handle, const char* const* prompts, size_t prompt_count,
+                                    HReasoningResult* out_results) {
+    try {
+        if (!handle || (prompt_count > 0 && (!prompts || !out_results))) return false;
+        std::vector<std::string> texts;
+        texts.reserve(prompt_count);
+        for (size_t i = 0; i < prompt_count; ++i) {
+            if (!prompts[i]) return false;
+            texts.emplace_back(prompts[i]);
+        }
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
+        auto results = engine->quick_answer_batch(texts);
+        for (size_t i = 0; i < prompt_count; ++i) fill_reasoning_result(results[i], &out_results[i]);
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
 void hartonomous_reasoning_free_result(HReasoningResult* result) {
     if (!result) return;
     if (result->response) free(result->response);
@@ -789,3 +1243,198 @@ void hartonomous_reasoning_free_result(HReasoningResult* result) {
     result->response = nullptr;
     result->reasoning_trace = nullptr;
 }
+
+// =============================================================================
+//  Token Streams
+// =============================================================================
+
+// Shared so a stream destroyed mid-call stays alive until its call returns
+using TokenStreamHandle = std::shared_ptr<Hartonomous::TokenRing>;
+
+// Ends the stream when the producing call returns, however it returns
+struct CloseStreamOnExit {
+    Hartonomous::TokenRing& ring;
+    ~CloseStreamOnExit() { ring.close(); }
+};
+
+h_token_stream_t hartonomous_token_stream_create(size_t capacity_bytes) {
+    try {
+        return static_cast<h_token_stream_t>(new TokenStreamHandle(std::make_shared<Hartonomous::TokenRing>(capacity_bytes)));
+    } catch (const std::exception& e) {
+        set_error(e);
+        return nullptr;
+    }
+}
+
+void hartonomous_token_stream_destroy(h_token_stream_t handle) {
+    if (!handle) return;
+    auto* stream = static_cast<TokenStreamHandle*>(handle);
+    (*stream)->cancel();
+    delete stream;
+}
+
+size_t hartonomous_token_stream_read(h_token_stream_t handle, void* buffer, size_t capacity) {
+    if (!handle || !buffer) return 0;
+    return (*static_cast<TokenStreamHandle*>(handle))->drain(buffer, capacity);
+}
+
+bool hartonomous_token_stream_wait(h_token_stream_t handle, int timeout_ms) {
+    return handle && (*static_cast<TokenStreamHandle*>(handle))->wait(timeout_ms);
+}
+
+bool hartonomous_token_stream_finished(h_token_stream_t handle) {
+    return !handle || (*static_cast<TokenStreamHandle*>(handle))->finished();
+}
+
+void hartonomous_token_stream_cancel(h_token_stream_t handle) {
+    if (handle) (*static_cast<TokenStreamHandle*>(handle))->cancel();
+}
+
+int hartonomous_token_stream_event_fd(h_token_stream_t handle) {
+    return handle ? (*static_cast<TokenStreamHandle*>(handle))->event_fd() : -1;
+}
+
+bool hartonomous_generate_stream_ring(h_walk_engine_t walk_handle, h_db_connection_t db_handle,
+                                       const char* prompt, const HGenerateParams* params,
+                                       h_token_stream_t stream, HGenerateResult* out_result) {
+    if (!stream) return false;
+    TokenStreamHandle ring = *static_cast<TokenStreamHandle*>(stream);
+    CloseStreamOnExit close{*ring};
+    try {
+        if (!walk_handle || !db_handle || !prompt || !params || !out_result) return false;
+        return generate_fragments(walk_handle, prompt, params,
+            [&](const std::string& token, size_t step, double energy) {
+                return ring->push(token, static_cast<uint32_t>(step), energy);
+            }, out_result);
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+bool hartonomous_reason_stream_ring(h_reasoning_t handle, const char* prompt,
+                                     const HReasoningConfig* config,
+                                     h_token_stream_t stream,
+                                     h_cancel_t cancel,
+                                     HReasoningResult* out_result) {
+    if (!stream) return false;
+    TokenStreamHandle ring = *static_cast<TokenStreamHandle*>(stream);
+    CloseStreamOnExit close{*ring};
+    try {
+        if (!handle || !prompt || !out_result) return false;
+        auto engine = lease_engine<Hartonomous::ReasoningEngine>(handle);
+        auto cfg = map_reasoning_config(config);
+
+        auto result = engine->reason_stream(prompt,
+            [&](const std::string& token, size_t step) -> bool {
+                return ring->push(token, static_cast<uint32_t>(step), 0.0);
+            }, cfg, cancel ? *static_cast<CancelHandle*>(cancel) : nullptr);
+
+        fill_reasoning_result(result, out_result);
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+// =============================================================================
+//  A* Path Search
+// =============================================================================
+
+h_astar_t hartonomous_astar_create(h_db_connection_t db_handle) {
+    return create_engine<Hartonomous::AStarSearch>(db_handle);
+}
+
+void hartonomous_astar_destroy(h_astar_t handle) {
+    destroy_engine<Hartonomous::AStarSearch>(handle);
+}
+
+bool hartonomous_astar_search_text(h_astar_t handle, const char* start_text, const char* goal_text,
+                                   size_t max_expansions, HPathResult* out_result) {
+    try {
+        if (!handle || !start_text || !goal_text || !out_result) return false;
+        auto engine = lease_engine<Hartonomous::AStarSearch>(handle);
+        Hartonomous::AStarConfig config;
+        if (max_expansions > 0) config.max_expansions = max_expansions;
+        auto path = engine->search_text(start_text, goal_text, config);
+
+        std::string joined;
+        for (const auto& t : path.texts) {
+            if (!joined.empty()) joined += " -> ";
+            joined += t;
+        }
+        out_result->path = strdup_safe(joined);
+        out_result->length = path.nodes.size();
+        out_result->nodes_expanded = path.nodes_expanded;
+        out_result->total_cost = path.total_cost;
+        out_result->avg_elo = path.avg_elo;
+        out_result->found = path.found;
+        return true;
+    } catch (const std::exception& e) {
+        set_error(e);
+        return false;
+    }
+}
+
+// =============================================================================
+//  Engine Statistics
+// =============================================================================
+
+void hartonomous_engine_stats(HEngineStats* out_stats) {
+    if (!out_stats) return;
+    auto neighbors = Hartonomous::NeighborCache::global().stats();
+    auto quick = Hartonomous::ReasoningEngine::quick_answer_cache_stats();
+    auto answers = Hartonomous::SemanticQuery::answer_cache_stats();
+    out_stats->db_queries = Hartonomous::PostgresConnection::queries_sent();
+    out_stats->db_queries_thread = Hartonomous::PostgresConnection::thread_queries_sent();
+    out_stats->neighbor_cache_hits = neighbors.hits;
+    out_stats->neighbor_cache_misses = neighbors.misses;
+    out_stats->answer_cache_hits = quick.hits + answers.hits;
+    out_stats->answer_cache_misses = quick.misses + answers.misses;
+}
+
+char* hartonomous_metrics_prometheus(void) {
+    INTEROP_TRY_CATCH_PTR({
+        return strdup_safe(Hartonomous::Metrics::global().prometheus());
+    })
+}
+
+char* hartonomous_db_statements_json(size_t limit) {
+    INTEROP_TRY_CATCH_PTR({
+        nlohmann::json out = nlohmann::json::array();
+        for (const auto& st : Hartonomous::QueryTrace::global().top(limit)) {
+            out.push_back({{"fingerprint", Hartonomous::QueryTrace::fingerprint_hex(st.fingerprint)},
+                           {"statement", st.sql},
+                           {"calls", st.calls},
+                           {"total_ms", static_cast<double>(st.total_ns) / 1e6},
+                           {"mean_ms", st.calls ? static_cast<double>(st.total_ns) / 1e6 / static_cast<double>(st.calls) : 0.0},
+                           {"max_ms", static_cast<double>(st.max_ns) / 1e6},
+                           {"rows", st.rows},
+                           {"bytes", st.bytes}});
+        }
+        return strdup_safe(out.dump());
+    })
+}
+
+void hartonomous_db_statements_reset(void) {
+    Hartonomous::QueryTrace::global().reset();
+}
+
+void hartonomous_memory_set_budget(uint64_t bytes) {
+    Hartonomous::MemoryGovernor::global().set_budget(static_cast<size_t>(bytes));
+}
+
+char* hartonomous_memory_usage_json(void) {
+    static constexpr const char* PRIORITIES[] = {"low", "normal", "high", "pinned"};
+    INTEROP_TRY_CATCH_PTR({
+        nlohmann::json out = nlohmann::json::array();
+        for (const auto& u : Hartonomous::MemoryGovernor::global().usage_by_cache()) {
+            out.push_back({{"cache", u.name},
+                           {"priority", PRIORITIES[static_cast<size_t>(u.priority)]},
+                           {"bytes", u.bytes},
+                           {"instances", u.instances}});
+        }
+        return strdup_safe(out.dump());
+    })
+}
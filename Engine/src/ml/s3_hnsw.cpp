@@ -1,18 +1,20 @@
 #include "ml/s3_hnsw.hpp"
 #include <hnswlib/hnswlib.h>
+#include <algorithm>
 #include <vector>
 #include <mutex>
 
 namespace s3::ann
 {
     struct HnswIndexHandle {
-        hnswlib::L2Space* space;
+        hnswlib::InnerProductSpace* space;
         hnswlib::HierarchicalNSW<float>* index;
         int dim;
 
-        HnswIndexHandle(int d, size_t max_elements) : dim(d) {
-            space = new hnswlib::L2Space(d);
-            index = new hnswlib::HierarchicalNSW<float>(space, max_elements, 16, 200);
+        HnswIndexHandle(int d, size_t max_elements, size_t M, size_t ef_construction, size_t ef_search) : dim(d) {
+            space = new hnswlib::InnerProductSpace(d);
+            index = new hnswlib::HierarchicalNSW<float>(space, max_elements, M, ef_construction);
+            index->setEf(ef_search);  // hnswlib defaults to 10
         }
 
         ~HnswIndexHandle() {
@@ -21,12 +23,12 @@ namespace s3::ann
         }
     };
 
-    HnswIndexHandle* build_index(const std::vector<Vec4>& points)
+    HnswIndexHandle* build_index(const std::vector<Vec4>& points, size_t M, size_t ef_construction, size_t ef_search)
     {
         if (points.empty()) return nullptr;
 
         size_t n = points.size();
-        HnswIndexHandle* h = new HnswIndexHandle(4, n);
+        HnswIndexHandle* h = new HnswIndexHandle(4, n, M, ef_construction, ef_search);
 
         #pragma omp parallel for schedule(dynamic, 1024)
         for (size_t i = 0; i < n; ++i) {
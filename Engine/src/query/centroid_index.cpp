@@ -0,0 +1,194 @@
+/**
+ * @file centroid_index.cpp
+ * @brief Composition centroid HNSW: database load, incremental adds, search
+ */
+
+#include <query/centroid_index.hpp>
+#include <storage/atom_lookup.hpp>
+#include <utils/unicode.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace Hartonomous {
+
+static constexpr size_t INITIAL_CAPACITY = 1024;
+
+static std::string read_watermark(PostgresConnection& db, const std::string& since) {
+    std::string floor = since.empty() ? "'-infinity'::timestamptz" : "'" + since + "'::timestamptz";
+    auto mark = db.query_single("SELECT COALESCE(max(createdat), " + floor + ")::text "
+                                "FROM hartonomous.composition WHERE createdat >= " + floor);
+    return mark.value_or(since);
+}
+
+static std::vector<std::pair<CentroidIndex::Hash, CentroidIndex::Vec4>> read_centroids(PostgresConnection& db,
+                                                                                       const std::string& where) {
+    std::vector<std::pair<CentroidIndex::Hash, CentroidIndex::Vec4>> rows;
+    db.query("SELECT c.id, ST_X(p.centroid), ST_Y(p.centroid), ST_Z(p.centroid), ST_M(p.centroid) "
+             "FROM hartonomous.composition c "
+             "JOIN hartonomous.physicality p ON p.id = c.physicalityid " + where,
+             [&](const std::vector<std::string>& row) {
+                 rows.emplace_back(BLAKE3Pipeline::from_hex(row[0]),
+                                   CentroidIndex::Vec4(std::stod(row[1]), std::stod(row[2]),
+                                                       std::stod(row[3]), std::stod(row[4])));
+             });
+    return rows;
+}
+
+CentroidIndex::CentroidIndex(const Params& params)
+    : params_(params),
+      index_(std::make_unique<hnswlib::HierarchicalNSW<float>>(&space_, INITIAL_CAPACITY, params.M,
+                                                               params.ef_construction)) {
+    index_->setEf(params.ef_search);
+}
+
+std::shared_ptr<CentroidIndex> CentroidIndex::load_from_db(PostgresConnection& db, const Params& params) {
+    auto index = std::make_shared<CentroidIndex>(params);
+
+    // Taken before the load: anything created later is re-read by refresh()
+    index->watermark_ = read_watermark(db, "");
+    index->add(read_centroids(db, ""));
+    return index;
+}
+
+static std::mutex g_shared_mutex;
+static std::shared_ptr<CentroidIndex> g_shared;
+
+std::shared_ptr<CentroidIndex> CentroidIndex::shared(PostgresConnection& db) {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    if (!g_shared) g_shared = load_from_db(db);
+    return g_shared;
+}
+
+std::shared_ptr<CentroidIndex> CentroidIndex::loaded() {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    return g_shared;
+}
+
+size_t CentroidIndex::add(const std::vector<std::pair<Hash, Vec4>>& entries) {
+    std::unique_lock lock(mutex_);
+    return add_locked(entries);
+}
+
+bool CentroidIndex::add(const Hash& id, const Vec4& centroid) {
+    return add(std::vector<std::pair<Hash, Vec4>>{{id, centroid}}) == 1;
+}
+
+size_t CentroidIndex::add_locked(const std::vector<std::pair<Hash, Vec4>>& entries) {
+    const size_t first = ids_.size();
+    for (const auto& [id, centroid] : entries) {
+        if (!labels_.emplace(id, ids_.size()).second) continue;
+        ids_.push_back(id);
+        centroids_.push_back(centroid.normalized());
+    }
+    const size_t n = ids_.size() - first;
+    if (n == 0) return 0;
+
+    if (ids_.size() > index_->getMaxElements())
+        index_->resizeIndex(std::max(ids_.size(), 2 * index_->getMaxElements()));
+
+    // hnswlib inserts are safe against each other; searches are held off by the lock
+    #pragma omp parallel for schedule(dynamic, 1024) if (n >= 4096)
+    for (size_t i = first; i < ids_.size(); ++i) {
+        float v[4];
+        for (int k = 0; k < 4; ++k) v[k] = static_cast<float>(centroids_[i][k]);
+        index_->addPoint(v, i);
+    }
+    return n;
+}
+
+size_t CentroidIndex::refresh(PostgresConnection& db) {
+    std::string since;
+    {
+        std::shared_lock lock(mutex_);
+        since = watermark_;
+    }
+
+    // Watermark and rows from one snapshot, so neither sees rows the other missed
+    std::string next;
+    std::vector<std::pair<Hash, Vec4>> rows;
+    db.execute("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+    try {
+        next = read_watermark(db, since);
+        rows = read_centroids(db, since.empty() ? "" :
+            "WHERE c.createdat >= '" + since + "'::timestamptz - interval '" +
+            std::to_string(params_.overlap.count()) + " seconds'");
+        db.commit();
+    } catch (...) {
+        db.rollback();
+        throw;
+    }
+
+    std::unique_lock lock(mutex_);
+    size_t added = add_locked(rows);
+    watermark_ = next;
+    return added;
+}
+
+std::vector<CentroidIndex::Neighbor> CentroidIndex::nearest(const Vec4& point, size_t k) const {
+    std::vector<Neighbor> out;
+    if (k == 0) return out;
+    Vec4 q = point.normalized();
+    float v[4];
+    for (int i = 0; i < 4; ++i) v[i] = static_cast<float>(q[i]);
+
+    std::shared_lock lock(mutex_);
+    if (ids_.empty()) return out;
+    auto heap = index_->searchKnn(v, std::min(k, ids_.size()));
+    out.reserve(heap.size());
+    for (; !heap.empty(); heap.pop()) {
+        size_t label = heap.top().second;
+        out.push_back({ids_[label], std::acos(std::clamp(q.dot(centroids_[label]), -1.0, 1.0))});
+    }
+    lock.unlock();
+
+    // Float graph distances can tie or misorder close hits; rank by the exact ones
+    std::sort(out.begin(), out.end(), [](const Neighbor& a, const Neighbor& b) { return a.distance < b.distance; });
+    return out;
+}
+
+std::optional<CentroidIndex::Vec4> CentroidIndex::text_centroid(AtomLookup& atoms, std::string_view text) {
+    thread_local std::u32string utf32;
+    thread_local std::vector<Hash> ids;
+    thread_local std::vector<Vec4> positions;
+    utf8_to_utf32(text, utf32);
+    if (ids.size() < utf32.size()) {
+        ids.resize(utf32.size());
+        positions.resize(utf32.size());
+    }
+    size_t n = atoms.lookup_codepoints(utf32, ids, positions);
+    if (n == 0) return std::nullopt;
+
+    // As SubstrateService::compute_comp places a composition
+    Vec4 centroid = Vec4::Zero();
+    for (size_t i = 0; i < n; ++i) centroid += positions[i];
+    centroid /= static_cast<double>(n);
+    double norm = centroid.norm();
+    if (norm > 1e-10) return Vec4(centroid / norm);
+    return Vec4(1, 0, 0, 0);
+}
+
+std::vector<CentroidIndex::Neighbor> CentroidIndex::nearest_text(AtomLookup& atoms, std::string_view text,
+                                                                  size_t k) const {
+    auto centroid = text_centroid(atoms, text);
+    return centroid ? nearest(*centroid, k) : std::vector<Neighbor>{};
+}
+
+size_t CentroidIndex::size() const {
+    std::shared_lock lock(mutex_);
+    return ids_.size();
+}
+
+bool CentroidIndex::contains(const Hash& id) const {
+    std::shared_lock lock(mutex_);
+    return labels_.count(id) > 0;
+}
+
+std::optional<CentroidIndex::Vec4> CentroidIndex::centroid(const Hash& id) const {
+    std::shared_lock lock(mutex_);
+    auto it = labels_.find(id);
+    if (it == labels_.end()) return std::nullopt;
+    return centroids_[it->second];
+}
+
+} // namespace Hartonomous
@@ -0,0 +1,157 @@
+/**
+ * @file composition_resolver.cpp
+ * @brief Content-addressed text lookup: variant hashing, PK probe, hot-term cache
+ */
+
+#include <query/composition_resolver.hpp>
+#include <ingestion/substrate_service.hpp>
+#include <utils/unicode.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace Hartonomous {
+
+static constexpr size_t DEFAULT_CACHE_TERMS = size_t(1) << 16;
+
+// Texts already resolved to a stored composition, shared by every resolver.
+// Misses are not kept: an ingest may create the composition at any time.
+namespace {
+struct HotTerms {
+    std::mutex mu;
+    std::unordered_map<std::string, BLAKE3Pipeline::Hash> ids;
+    size_t capacity = [] {
+        if (const char* s = std::getenv("HARTONOMOUS_RESOLVER_CACHE"))
+            return static_cast<size_t>(std::strtoull(s, nullptr, 10));
+        return DEFAULT_CACHE_TERMS;
+    }();
+};
+}
+
+static HotTerms& hot_terms() {
+    static HotTerms terms;
+    return terms;
+}
+
+CompositionResolver::CompositionResolver(PostgresConnection& db) : db_(db) {}
+
+CompositionResolver::Hash CompositionResolver::composition_id(std::string_view text) {
+    if (!atoms_) {
+        atoms_ = std::make_unique<AtomLookup>(db_);
+        const std::string path = AtomLookup::default_image_path();
+        if (!path.empty()) atoms_->load_image(path);
+    }
+    std::u32string cps;
+    utf8_to_utf32(text, cps);
+    if (cps.empty()) return {};
+    std::vector<Hash> ids(cps.size());
+    std::vector<Eigen::Vector4d> positions(cps.size());
+    size_t n = atoms_->lookup_codepoints(cps, ids, positions);
+    return n ? SubstrateService::composition_id(ids.data(), n) : Hash{};
+}
+
+static std::string ascii_lower(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+static std::string ascii_upper(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return s;
+}
+
+static std::string ascii_capitalized(std::string s) {
+    s = ascii_lower(std::move(s));
+    if (!s.empty()) s[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(s[0])));
+    return s;
+}
+
+// Surrounding whitespace and punctuation dropped, inner whitespace runs made one space
+static std::string normalized(std::string_view text) {
+    auto trim = [](unsigned char c) { return std::isspace(c) || std::ispunct(c); };
+    size_t b = 0, e = text.size();
+    while (b < e && trim(static_cast<unsigned char>(text[b]))) ++b;
+    while (e > b && trim(static_cast<unsigned char>(text[e - 1]))) --e;
+
+    std::string out;
+    out.reserve(e - b);
+    for (size_t i = b; i < e; ++i) {
+        if (std::isspace(static_cast<unsigned char>(text[i]))) {
+            if (out.back() != ' ') out.push_back(' ');
+        } else {
+            out.push_back(text[i]);
+        }
+    }
+    return out;
+}
+
+std::vector<std::string> CompositionResolver::variants(std::string_view text) {
+    std::vector<std::string> out;
+    auto add = [&](std::string v) {
+        if (!v.empty() && std::find(out.begin(), out.end(), v) == out.end()) out.push_back(std::move(v));
+    };
+    for (std::string base : {std::string(text), normalized(text)}) {
+        add(base);
+        add(ascii_lower(base));
+        add(ascii_capitalized(base));
+        add(ascii_upper(base));
+    }
+    return out;
+}
+
+CompositionResolver::Hash CompositionResolver::resolve(const std::string& text) {
+    return resolve_many({text})[0];
+}
+
+std::vector<CompositionResolver::Hash> CompositionResolver::resolve_many(const std::vector<std::string>& texts) {
+    std::vector<Hash> out(texts.size(), Hash{});
+    auto& hot = hot_terms();
+
+    // Candidate IDs of every text not already known, in preference order
+    std::vector<std::vector<Hash>> candidates(texts.size());
+    std::vector<Hash> probe;
+    {
+        std::lock_guard<std::mutex> lock(hot.mu);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            auto it = hot.ids.find(texts[i]);
+            if (it != hot.ids.end()) out[i] = it->second;
+        }
+    }
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (out[i] != Hash{}) continue;
+        for (const auto& v : variants(texts[i])) {
+            Hash id = composition_id(v);
+            if (id == Hash{}) continue;
+            candidates[i].push_back(id);
+            probe.push_back(id);
+        }
+    }
+    if (probe.empty()) return out;
+
+    std::sort(probe.begin(), probe.end());
+    probe.erase(std::unique(probe.begin(), probe.end()), probe.end());
+    const std::string array = pg_uuid_array(probe);
+    const auto& stmt = db_.prepare("composition_resolver_probe",
+        "SELECT id FROM hartonomous.composition WHERE id = ANY($1)", {PgType::UuidArray});
+    PgResult rows = db_.execute_prepared(stmt, {PgParam::bytes(array.data(), array.size())});
+    std::vector<Hash> stored;
+    stored.reserve(rows.size());
+    for (int r = 0; r < rows.size(); ++r) stored.push_back(rows[r].get_uuid(0));
+    std::sort(stored.begin(), stored.end());
+
+    std::lock_guard<std::mutex> lock(hot.mu);
+    for (size_t i = 0; i < texts.size(); ++i) {
+        for (const Hash& id : candidates[i]) {
+            if (!std::binary_search(stored.begin(), stored.end(), id)) continue;
+            out[i] = id;
+            if (hot.ids.size() >= hot.capacity) hot.ids.clear();
+            if (hot.capacity) hot.ids.emplace(texts[i], id);
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace Hartonomous
@@ -4,147 +4,409 @@
  */
 
 #include <query/semantic_query.hpp>
+#include <cognitive/neighbor_cache.hpp>
+#include <hashing/composition_interner.hpp>
+#include <query/response_cache.hpp>
+#include <storage/composition_text_store.hpp>
+#include <utils/thread_config.hpp>
 #include <algorithm>
 #include <cctype>
+#include <functional>
+#include <iomanip>
+#include <queue>
 #include <sstream>
 #include <map>
 #include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Hartonomous {
 
 SemanticQuery::SemanticQuery(PostgresConnection& db) : db_(db) {}
 
+SemanticQuery::SemanticQuery(ConnectionPool& pool) : lease_(pool.acquire()), db_(*lease_) {}
+
 std::optional<std::string> SemanticQuery::find_composition(const std::string& text) {
-    auto result = db_.query_single(
-        "SELECT v.composition_id::text FROM hartonomous.v_composition_text v "
-        "WHERE LOWER(v.reconstructed_text) = LOWER($1) LIMIT 1",
-        {text}
+    auto id = resolver_.resolve(text);
+    if (id == BLAKE3Pipeline::Hash{}) return std::nullopt;
+    return BLAKE3Pipeline::to_hex(id);
+}
+
+std::optional<SemanticQuery::CompositionInfo> SemanticQuery::get_composition_info(const std::string& text) {
+    auto id = resolver_.resolve(text);
+    if (id == BLAKE3Pipeline::Hash{}) return std::nullopt;
+
+    // The stored spelling, which may differ from text in case or spacing
+    CompositionInfo info{BLAKE3Pipeline::to_hex(id), {}};
+    bool found = false;
+    db_.query(
+        "SELECT reconstructed_text FROM hartonomous.v_composition_text WHERE composition_id = $1",
+        {info.hash},
+        [&](const std::vector<std::string>& row) { info.text = row[0]; found = true; }
     );
+    if (!found) return std::nullopt;
+    return info;
+}
 
-    return result;
+std::vector<CentroidIndex::Neighbor> SemanticQuery::nearest_to_text(const std::string& text, size_t k) {
+    if (!centroids_) centroids_ = CentroidIndex::shared(db_);
+    if (!atoms_) atoms_ = std::make_unique<AtomLookup>(db_);
+    return centroids_->nearest_text(*atoms_, text, k);
 }
 
-std::optional<SemanticQuery::CompositionInfo> SemanticQuery::get_composition_info(const std::string& text) {
-    std::optional<CompositionInfo> info;
+// Round-trips: std::to_string keeps only six decimals
+static std::string exact_double(double x) {
+    std::ostringstream out;
+    out << std::setprecision(17) << x;
+    return out.str();
+}
 
+std::vector<CentroidIndex::Neighbor> SemanticQuery::nearest_compositions(const Eigen::Vector4d& pos, size_t k) {
+    std::vector<CentroidIndex::Neighbor> neighbors;
+    neighbors.reserve(k);
     db_.query(
-        "SELECT v.composition_id, v.reconstructed_text "
-        "FROM hartonomous.v_composition_text v "
-        "WHERE LOWER(v.reconstructed_text) = LOWER($1) LIMIT 1",
-        {text},
+        "WITH q AS (SELECT ST_MakePoint($1::float8, $2::float8, $3::float8, $4::float8) AS pos) "
+        "SELECT c.id, p.centroid OPERATOR(hartonomous.<@>) q.pos "
+        "FROM q, hartonomous.physicality p "
+        "JOIN hartonomous.composition c ON c.physicalityid = p.id "
+        "ORDER BY p.centroid OPERATOR(hartonomous.<@>) q.pos "
+        "LIMIT $5",
+        {exact_double(pos[0]), exact_double(pos[1]), exact_double(pos[2]), exact_double(pos[3]), std::to_string(k)},
         [&](const std::vector<std::string>& row) {
-            CompositionInfo comp;
-            comp.hash = row[0];
-            comp.text = row[1];
-            info = comp;
-        }
-    );
+            neighbors.push_back({BLAKE3Pipeline::from_hex(row[0]), std::stod(row[1])});
+        });
+    return neighbors;
+}
+
+std::optional<SemanticQuery::CompositionInfo> SemanticQuery::resolve_composition(const std::string& text) {
+    if (auto info = get_composition_info(text)) return info;
 
+    auto near = nearest_to_text(text, 1);
+    if (near.empty()) return std::nullopt;
+    CompositionInfo info;
+    info.hash = BLAKE3Pipeline::to_hex(near[0].id);
+    info.text = CompositionTextStore::shared(db_)->lookup(near[0].id);
     return info;
 }
 
-std::vector<QueryResult> SemanticQuery::find_related(const std::string& query_text, size_t limit) {
+std::vector<QueryResult> SemanticQuery::find_nearest(const std::string& text, size_t limit) {
     std::vector<QueryResult> results;
+    auto texts = CompositionTextStore::shared(db_);
+    for (const auto& n : nearest_to_text(text, limit)) {
+        QueryResult result;
+        result.text = texts->lookup(n.id);
+        result.confidence = 1.0 - n.distance / M_PI;
+        results.push_back(std::move(result));
+    }
+    return results;
+}
 
-    auto query_comp = get_composition_info(query_text);
-    if (!query_comp) {
-        return results;
+SemanticQuery::Candidates SemanticQuery::gather(const BLAKE3Pipeline::Hash& id, const TopKOptions& opts) {
+    Candidates out;
+
+    const auto graph = live_ ? live_->snapshot() : graph_;
+    const RelationGraph::TenantMask view = RelationGraph::tenant_view(graph.get(), tenant_);
+    if (graph) {
+        uint32_t index = graph->index_of(id);
+        if (index == RelationGraph::NPOS) return out;
+        const auto row = graph->neighbors(index);
+        const auto masks = graph->tenant_masks(index);
+        for (size_t i = 0; i < row.size(); ++i) {
+            if (view != RelationGraph::ALL_TENANTS && !(masks[i] & view)) continue;
+            const auto& e = row[i];
+            out.list.push_back({graph->id_of(e.target), double(e.relation_count), e.max_elo, e.total_obs, 0});
+        }
+        return out;
+    }
+
+    if (!opts.approximate) {
+        auto& interner = CompositionInterner::global();
+        for (const auto& n : *NeighborCache::global().neighbors(db_, id))
+            out.list.push_back({interner.hash_of(n.node), double(n.relation_count), n.max_elo, n.total_obs, 0});
+        return out;
+    }
+
+    // Double the sample while the next round (about twice this one) still fits the budget
+    const auto began = std::chrono::steady_clock::now();
+    size_t m = std::max<size_t>(opts.sample, 3);
+    for (;;) {
+        const auto round_began = std::chrono::steady_clock::now();
+        out = sample_relations(id, m);
+        if (!out.sampled) break;  // Every relation was read
+        const auto now = std::chrono::steady_clock::now();
+        if ((now - began) + 2 * (now - round_began) > opts.budget) break;
+        m *= 2;
     }
+    return out;
+}
 
-    std::string sql = R"(
-        WITH query_relations AS (
-            SELECT DISTINCT rs.relationid
-            FROM hartonomous.relationsequence rs
-            WHERE rs.compositionid = $1
-        ),
-        cooccurring AS (
-            SELECT
-                c.id,
-                COUNT(DISTINCT qr.relationid) AS co_occurrence_count
-            FROM query_relations qr
-            JOIN hartonomous.relationsequence rs ON rs.relationid = qr.relationid
-            JOIN hartonomous.composition c ON c.id = rs.compositionid
-            WHERE c.id != $1
-            GROUP BY c.id
-            ORDER BY co_occurrence_count DESC
+SemanticQuery::Candidates SemanticQuery::sample_relations(const BLAKE3Pipeline::Hash& id, size_t m) {
+    // One row per (sampled relation, other member); relations without other members still count
+    const auto& stmt = db_.prepare("semantic_query_sample_relations", R"(
+        WITH sample AS (
+            SELECT DISTINCT relationid
+            FROM hartonomous.relationsequence
+            WHERE compositionid = $1
+            ORDER BY relationid
             LIMIT $2
         )
-        SELECT v.reconstructed_text, co.co_occurrence_count
-        FROM cooccurring co
-        JOIN hartonomous.v_composition_text v ON v.composition_id = co.id
-    )";
+        SELECT DISTINCT
+            s.relationid,
+            rs.compositionid,
+            COALESCE(rr.ratingvalue, 0)::float8,
+            COALESCE(uint64_to_double(rr.observations), 0)::float8
+        FROM sample s
+        LEFT JOIN hartonomous.relationsequence rs
+            ON rs.relationid = s.relationid
+            AND rs.compositionid != $1
+        LEFT JOIN hartonomous.relationrating rr
+            ON rr.relationid = s.relationid
+    )", {PgType::Uuid, PgType::Int8});
+    PgResult rows = db_.execute_prepared(stmt, {PgParam::uuid(id), PgParam::int8(static_cast<int64_t>(m))});
+
+    Candidates out;
+    std::unordered_map<BLAKE3Pipeline::Hash, size_t, HashHasher> slot;
+    std::unordered_set<BLAKE3Pipeline::Hash, HashHasher> relations;
+    BLAKE3Pipeline::Hash last{};
+    for (int i = 0; i < rows.size(); ++i) {
+        auto row = rows[i];
+        const auto rel = row.get_uuid(0);
+        relations.insert(rel);
+        last = std::max(last, rel);
+        if (row.is_null(1)) continue;
+
+        auto [it, fresh] = slot.emplace(row.get_uuid(1), out.list.size());
+        if (fresh) out.list.push_back({it->first, 0.0, 0.0, 0.0, 0});
+        auto& c = out.list[it->second];
+        c.max_elo = std::max(c.max_elo, row.get_float8(2));
+        c.total_obs += row.get_float8(3);
+        c.hits++;
+    }
 
-    db_.query(
-        sql,
-        {query_comp->hash, std::to_string(limit)},
-        [&](const std::vector<std::string>& row) {
-            QueryResult result;
-            result.text = row[0];
-            result.confidence = std::stod(row[1]);
-            results.push_back(result);
-        }
-    );
+    // Fewer than asked for: that was all of them
+    double scale = 1.0;
+    if (relations.size() >= m) {
+        // The m-th smallest of R uniform hashes sits near m / R of the way through the space
+        uint64_t top = 0;
+        for (int b = 0; b < 8; ++b) top = (top << 8) | last[b];
+        const double u = (double(top) + 1.0) / 18446744073709551616.0;
+        scale = std::max(1.0, (double(m) - 1.0) / u / double(m));
+        out.sampled = m;
+    }
+    for (auto& c : out.list) {
+        c.relations = c.hits * scale;
+        c.total_obs *= scale;
+    }
+    return out;
+}
+
+std::vector<std::optional<Eigen::Vector4d>> SemanticQuery::centroids_of(const std::vector<Candidate>& list) {
+    std::vector<std::optional<Eigen::Vector4d>> out(list.size());
+    if (list.empty()) return out;
+
+    if (auto index = centroids_ ? centroids_ : CentroidIndex::loaded()) {
+        for (size_t i = 0; i < list.size(); ++i) out[i] = index->centroid(list[i].id);
+        return out;
+    }
+
+    std::vector<BLAKE3Pipeline::Hash> ids;
+    std::unordered_map<BLAKE3Pipeline::Hash, size_t, HashHasher> slot;
+    ids.reserve(list.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+        ids.push_back(list[i].id);
+        slot.emplace(list[i].id, i);
+    }
+    const std::string array = pg_uuid_array(ids);
+    const auto& stmt = db_.prepare("semantic_query_centroids", R"(
+        SELECT c.id, ST_X(p.centroid), ST_Y(p.centroid), ST_Z(p.centroid), ST_M(p.centroid)
+        FROM hartonomous.composition c
+        JOIN hartonomous.physicality p ON p.id = c.physicalityid
+        WHERE c.id = ANY($1)
+    )", {PgType::UuidArray});
+    PgResult rows = db_.execute_prepared(stmt, {PgParam::bytes(array.data(), array.size())});
+    for (int i = 0; i < rows.size(); ++i) {
+        auto row = rows[i];
+        auto it = slot.find(row.get_uuid(0));
+        if (it == slot.end()) continue;
+        out[it->second] = Eigen::Vector4d(row.get_float8(1), row.get_float8(2), row.get_float8(3), row.get_float8(4));
+    }
+    return out;
+}
+
+// Indices of the k highest-scoring items that pass keep(), best first.
+// keep() runs only for items that would enter the heap.
+template <typename Score, typename Keep>
+static std::vector<size_t> top_k(size_t n, size_t k, Score&& score, Keep&& keep) {
+    using Entry = std::pair<double, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;  // Weakest on top
+    if (k == 0) return {};
+    for (size_t i = 0; i < n; ++i) {
+        const double s = score(i);
+        if (heap.size() == k && s <= heap.top().first) continue;
+        if (!keep(i)) continue;
+        if (heap.size() == k) heap.pop();
+        heap.emplace(s, i);
+    }
+    std::vector<size_t> out(heap.size());
+    for (size_t i = out.size(); i-- > 0; heap.pop()) out[i] = heap.top().second;
+    return out;
+}
+
+// Half-width of the interval on a value scaled up from `hits` of `sampled` relations:
+// binomial error of the share plus the error of the relation count estimate
+static double sample_margin(double value, size_t hits, size_t sampled, double z) {
+    if (!sampled || !hits) return 0.0;
+    const double p = double(hits) / double(sampled);
+    const double rel = std::sqrt((1.0 - p) / double(hits) + 1.0 / double(sampled > 2 ? sampled - 2 : 1));
+    return z * value * rel;
+}
+
+std::vector<QueryResult> SemanticQuery::find_related(const std::string& query_text, size_t limit,
+                                                     const TopKOptions& opts) {
+    std::vector<QueryResult> results;
+
+    auto query_comp = resolve_composition(query_text);
+    if (!query_comp) {
+        return results;
+    }
+    const auto query_id = BLAKE3Pipeline::from_hex(query_comp->hash);
+
+    return rank_related(*CompositionTextStore::shared(db_), query_id, gather(query_id, opts), limit, opts);
+}
+
+std::vector<QueryResult> SemanticQuery::rank_related(const CompositionTextStore& texts,
+                                                     const BLAKE3Pipeline::Hash& query_id, const Candidates& c,
+                                                     size_t limit, const TopKOptions& opts) {
+    std::vector<QueryResult> results;
+    const auto top = top_k(c.list.size(), limit,
+        [&](size_t i) { return c.list[i].relations; },
+        [&](size_t i) { return c.list[i].id != query_id && !texts.lookup(c.list[i].id).empty(); });
+
+    for (size_t i : top) {
+        const auto& cand = c.list[i];
+        QueryResult result;
+        result.text = texts.lookup(cand.id);
+        result.confidence = cand.relations;
+        result.margin = sample_margin(cand.relations, cand.hits, c.sampled, opts.z);
+        results.push_back(std::move(result));
+    }
 
     return results;
 }
 
-std::vector<QueryResult> SemanticQuery::find_gravitational_truth(const std::string& query_text, double min_elo, size_t limit) {
+std::vector<std::vector<QueryResult>> SemanticQuery::find_related_batch(const std::vector<std::string>& texts,
+                                                                        size_t limit, const TopKOptions& opts) {
+    // Each distinct text once
+    std::vector<std::string> distinct;
+    std::vector<size_t> slot(texts.size());
+    {
+        std::unordered_map<std::string, size_t> seen;
+        for (size_t i = 0; i < texts.size(); ++i) {
+            auto [it, fresh] = seen.emplace(texts[i], distinct.size());
+            if (fresh) distinct.push_back(texts[i]);
+            slot[i] = it->second;
+        }
+    }
+
+    // One probe for every exact spelling; a stored composition always has its text, so the
+    // single-text check of v_composition_text is skipped. The rest take the nearest centroid.
+    auto ids = resolver_.resolve_many(distinct);
+    std::vector<BLAKE3Pipeline::Hash> known;
+    for (size_t i = 0; i < distinct.size(); ++i) {
+        if (ids[i] == BLAKE3Pipeline::Hash{}) {
+            auto near = nearest_to_text(distinct[i], 1);
+            if (!near.empty()) ids[i] = near[0].id;
+        }
+        if (ids[i] != BLAKE3Pipeline::Hash{}) known.push_back(ids[i]);
+    }
+
+    const bool snapshot = has_relation_graph();
+    if (!snapshot && !opts.approximate && NeighborCache::global().enabled()) {
+        NeighborCache::global().prefetch(db_, known);
+    }
+
+    // Database reads share this engine's one connection, so they stay on this thread
+    std::vector<Candidates> gathered(distinct.size());
+    auto gather_one = [&](size_t i) {
+        if (ids[i] != BLAKE3Pipeline::Hash{}) gathered[i] = gather(ids[i], opts);
+    };
+    const auto texts_store = CompositionTextStore::shared(db_);
+    std::vector<std::vector<QueryResult>> ranked(distinct.size());
+    if (snapshot) {
+        for_each_task(distinct.size(), true, 0, [&](size_t i) {
+            gather_one(i);
+            ranked[i] = rank_related(*texts_store, ids[i], gathered[i], limit, opts);
+        });
+    } else {
+        for (size_t i = 0; i < distinct.size(); ++i) gather_one(i);
+        for_each_task(distinct.size(), true, 0, [&](size_t i) {
+            ranked[i] = rank_related(*texts_store, ids[i], gathered[i], limit, opts);
+        });
+    }
+
+    std::vector<std::vector<QueryResult>> out(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i) out[i] = ranked[slot[i]];
+    return out;
+}
+
+std::vector<QueryResult> SemanticQuery::find_gravitational_truth(const std::string& query_text, double min_elo,
+                                                                 size_t limit, const TopKOptions& opts) {
     std::vector<QueryResult> results;
 
-    auto query_comp = get_composition_info(query_text);
-    if (!query_comp) return results;
+    const auto query_id = resolver_.resolve(query_text);
+    if (query_id == BLAKE3Pipeline::Hash{}) return results;
 
     // Truths Cluster, Lies Scatter.
     // 4D Gravitational Consensus:
     // - High ELO (Individual Quality)
     // - High Observations (Social Consensus)
     // - Geometric Proximity (Topological Consensus)
-    std::string sql = R"(
-        WITH candidates AS (
-            SELECT 
-                rs2.compositionid as target_id,
-                rr.ratingvalue as elo,
-                uint64_to_double(rr.observations) as observations,
-                p.centroid
-            FROM hartonomous.relationsequence rs1
-            JOIN hartonomous.relationsequence rs2 ON rs2.relationid = rs1.relationid
-            JOIN hartonomous.relationrating rr ON rr.relationid = rs1.relationid
-            JOIN hartonomous.composition c ON c.id = rs2.compositionid
-            JOIN hartonomous.physicality p ON p.id = c.physicalityid
-            WHERE rs1.compositionid = $1 AND rs2.compositionid != $1
-              AND rr.ratingvalue >= $2
-        ),
-        clusters AS (
-            SELECT 
-                c1.target_id,
-                c1.elo,
-                c1.observations,
-                (
-                    SELECT COUNT(*) 
-                    FROM candidates c2 
-                    WHERE ST_3DDistance(c1.centroid, c2.centroid) < 0.05
-                ) as cluster_density
-            FROM candidates c1
-        )
-        SELECT 
-            v.reconstructed_text, 
-            (cl.elo * LOG(cl.observations + 1) * cl.cluster_density) as gravitational_mass
-        FROM clusters cl
-        JOIN hartonomous.v_composition_text v ON v.composition_id = cl.target_id
-        ORDER BY gravitational_mass DESC
-        LIMIT $3
-    )";
+    Candidates c = gather(query_id, opts);
+    std::erase_if(c.list, [&](const Candidate& x) { return x.max_elo < min_elo || x.id == query_id; });
+    const auto centroids = centroids_of(c.list);
+
+    // Cluster density: candidates (itself included) within RADIUS in x, y, z, found
+    // through a grid of RADIUS-sized cells instead of comparing every pair
+    constexpr double RADIUS = 0.05;
+    auto cell_key = [](int64_t x, int64_t y, int64_t z) {
+        return (uint64_t(x & 0x1FFFFF) << 42) | (uint64_t(y & 0x1FFFFF) << 21) | uint64_t(z & 0x1FFFFF);
+    };
+    auto cell_of = [](double v) { return static_cast<int64_t>(std::floor(v / RADIUS)); };
+    std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+    for (size_t i = 0; i < c.list.size(); ++i) {
+        if (!centroids[i]) continue;
+        const auto& p = *centroids[i];
+        grid[cell_key(cell_of(p[0]), cell_of(p[1]), cell_of(p[2]))].push_back(static_cast<uint32_t>(i));
+    }
+    std::vector<double> mass(c.list.size(), 0.0);
+    for (size_t i = 0; i < c.list.size(); ++i) {
+        if (!centroids[i]) continue;
+        const auto p = centroids[i]->head<3>();
+        const int64_t cx = cell_of(p[0]), cy = cell_of(p[1]), cz = cell_of(p[2]);
+        size_t density = 0;
+        for (int64_t dx = -1; dx <= 1; ++dx)
+            for (int64_t dy = -1; dy <= 1; ++dy)
+                for (int64_t dz = -1; dz <= 1; ++dz) {
+                    auto it = grid.find(cell_key(cx + dx, cy + dy, cz + dz));
+                    if (it == grid.end()) continue;
+                    for (uint32_t j : it->second)
+                        if ((centroids[j]->head<3>() - p).norm() < RADIUS) ++density;
+                }
+        mass[i] = c.list[i].max_elo * std::log(c.list[i].total_obs + 1.0) * double(density);
+    }
 
-    db_.query(
-        sql,
-        {query_comp->hash, std::to_string(min_elo), std::to_string(limit)},
-        [&](const std::vector<std::string>& row) {
-            QueryResult result;
-            result.text = row[0];
-            result.confidence = std::stod(row[1]) / 10000.0; 
-            results.push_back(result);
-        }
-    );
+    auto texts = CompositionTextStore::shared(db_);
+    const auto top = top_k(c.list.size(), limit,
+        [&](size_t i) { return mass[i]; },
+        [&](size_t i) { return centroids[i] && !texts->lookup(c.list[i].id).empty(); });
+
+    for (size_t i : top) {
+        QueryResult result;
+        result.text = texts->lookup(c.list[i].id);
+        result.confidence = mass[i] / 10000.0;
+        result.margin = sample_margin(result.confidence, c.list[i].hits, c.sampled, opts.z);
+        results.push_back(std::move(result));
+    }
 
     return results;
 }
@@ -187,20 +449,97 @@ std::vector<std::string> SemanticQuery::extract_keywords(const std::string& text
     return keywords;
 }
 
-bool SemanticQuery::is_proper_noun(const std::string& text) {
+bool SemanticQuery::is_proper_noun(const std::string& text) const {
     if (text.empty()) return false;
     return std::isupper(text[0]);
 }
 
+static ResponseCache<std::optional<QueryResult>>& answer_cache() {
+    static ResponseCache<std::optional<QueryResult>> cache;
+    return cache;
+}
+
+ResponseCacheStats SemanticQuery::answer_cache_stats() { return answer_cache().stats(); }
+
 std::optional<QueryResult> SemanticQuery::answer_question(const std::string& question) {
-    auto keywords = extract_keywords(question);
-    if (keywords.empty()) return std::nullopt;
+    auto& cache = answer_cache();
+    const uint64_t epoch = SubstrateEpoch::current();
+    std::string key;
+    if (cache.enabled()) {
+        key = answer_key(tenant_, question);
+        if (auto hit = cache.get(key)) return *hit;
+    }
+
+    auto answer = rank_answer(question);
+    if (cache.enabled()) cache.put(key, answer, epoch);
+    return answer;
+}
+
+std::string SemanticQuery::answer_key(const std::optional<BLAKE3Pipeline::Hash>& tenant, const std::string& question) {
+    return (tenant ? BLAKE3Pipeline::to_hex(*tenant) : std::string()) + '\0' + normalized_prompt(question);
+}
+
+std::vector<std::optional<QueryResult>> SemanticQuery::answer_question_batch(const std::vector<std::string>& questions) {
+    auto& cache = answer_cache();
+    const uint64_t epoch = SubstrateEpoch::current();
+    std::vector<std::optional<QueryResult>> out(questions.size());
+    std::vector<std::string> keys(questions.size());
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < questions.size(); ++i) {
+        if (cache.enabled()) {
+            keys[i] = answer_key(tenant_, questions[i]);
+            if (auto hit = cache.get(keys[i])) {
+                out[i] = std::move(*hit);
+                continue;
+            }
+        }
+        pending.push_back(i);
+    }
+    if (pending.empty()) return out;
+
+    // Every keyword of the batch ranked once
+    std::vector<std::vector<std::string>> keywords(pending.size());
+    std::vector<std::string> terms;
+    std::unordered_map<std::string, size_t> term_index;
+    for (size_t k = 0; k < pending.size(); ++k) {
+        keywords[k] = extract_keywords(questions[pending[k]]);
+        for (const auto& kw : keywords[k]) {
+            if (term_index.emplace(kw, terms.size()).second) terms.push_back(kw);
+        }
+    }
+    const auto related = find_related_batch(terms, 20);
+
+    for_each_task(pending.size(), true, 0, [&](size_t k) {
+        std::vector<const std::vector<QueryResult>*> per_keyword;
+        per_keyword.reserve(keywords[k].size());
+        for (const auto& kw : keywords[k]) per_keyword.push_back(&related[term_index.at(kw)]);
+        out[pending[k]] = best_answer(per_keyword);
+    });
+
+    if (cache.enabled()) {
+        for (size_t i : pending) cache.put(keys[i], out[i], epoch);
+    }
+    return out;
+}
+
+std::optional<QueryResult> SemanticQuery::rank_answer(const std::string& question) {
+    const auto keywords = extract_keywords(question);
+    std::vector<std::vector<QueryResult>> related;
+    related.reserve(keywords.size());
+    for (const auto& keyword : keywords) related.push_back(find_related(keyword, 20));
+
+    std::vector<const std::vector<QueryResult>*> per_keyword;
+    for (const auto& r : related) per_keyword.push_back(&r);
+    return best_answer(per_keyword);
+}
+
+std::optional<QueryResult> SemanticQuery::best_answer(const std::vector<const std::vector<QueryResult>*>& related) const {
+    if (related.empty()) return std::nullopt;
 
     std::map<std::string, double> composition_scores;
 
-    for (const auto& keyword : keywords) {
-        auto related = find_related(keyword, 20);
-        for (const auto& result : related) {
+    for (const auto* results : related) {
+        for (const auto& result : *results) {
             double score = result.confidence;
             if (is_proper_noun(result.text)) score *= 2.0;
             composition_scores[result.text] += score;
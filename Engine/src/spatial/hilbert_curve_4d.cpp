@@ -0,0 +1,221 @@
+/**
+ * @file hilbert_curve_4d.cpp
+ * @brief Batch Hilbert encode/decode: Skilling's transform across SIMD lanes
+ *
+ * Skilling's AxesToTranspose/TransposeToAxes (the algorithm hilbert.hpp
+ * implements) is branchy per point but the same branch structure for every
+ * point, so eight (AVX2) or sixteen (AVX-512) points run side by side with
+ * the branches turned into masks, in per-ISA units picked at runtime. The
+ * transposed form is then interleaved into the 128-bit index with
+ * magic-number bit spreading instead of a per-bit loop.
+ */
+
+#include <spatial/hilbert_curve_4d.hpp>
+#include "spatial/hilbert_lanes.hpp"
+#include <utils/cpu_dispatch.hpp>
+#include <cstring>
+
+namespace hartonomous::spatial {
+
+using Hartonomous::SimdLevel;
+using Hartonomous::simd_level;
+
+namespace {
+
+constexpr double MAX_VAL = static_cast<double>((1ULL << HilbertCurve4D::BITS_PER_DIMENSION) - 1);
+
+inline uint32_t discretize(double v) {
+    return static_cast<uint32_t>(std::clamp(v, 0.0, 1.0) * MAX_VAL);
+}
+
+// Centre of cell x, so discretize() maps it back to x despite rounding
+inline double cell_centre(uint32_t x) {
+    return std::min((static_cast<double>(x) + 0.5) / MAX_VAL, 1.0);
+}
+
+// 16 bits to bits 0, 4, 8, ... of a 64-bit word, and back
+inline uint64_t spread16(uint64_t x) {
+    x &= 0xFFFF;
+    x = (x | (x << 24)) & 0x000000FF000000FFULL;
+    x = (x | (x << 12)) & 0x000F000F000F000FULL;
+    x = (x | (x << 6)) & 0x0303030303030303ULL;
+    x = (x | (x << 3)) & 0x1111111111111111ULL;
+    return x;
+}
+
+inline uint64_t compact16(uint64_t x) {
+    x &= 0x1111111111111111ULL;
+    x = (x | (x >> 3)) & 0x0303030303030303ULL;
+    x = (x | (x >> 6)) & 0x000F000F000F000FULL;
+    x = (x | (x >> 12)) & 0x000000FF000000FFULL;
+    x = (x | (x >> 24)) & 0xFFFF;
+    return x;
+}
+
+// Transposed form to index bytes: index bit 4k + 3 - i is bit k of X[i], so
+// the top bits of X[0..3] lead. Big-endian, type in the last 2 bits.
+inline void pack(const uint32_t X[4], uint8_t type, HilbertCurve4D::HilbertIndex& out) {
+    uint64_t lo = 0, hi = 0;
+    for (int i = 0; i < 4; ++i) {
+        lo |= spread16(X[i]) << (3 - i);
+        hi |= spread16(X[i] >> 16) << (3 - i);
+    }
+    lo = (lo & ~uint64_t(3)) | type;
+    uint64_t be_hi = __builtin_bswap64(hi);
+    uint64_t be_lo = __builtin_bswap64(lo);
+    std::memcpy(out.data(), &be_hi, 8);
+    std::memcpy(out.data() + 8, &be_lo, 8);
+}
+
+inline void unpack(const HilbertCurve4D::HilbertIndex& in, uint32_t X[4]) {
+    uint64_t hi, lo;
+    std::memcpy(&hi, in.data(), 8);
+    std::memcpy(&lo, in.data() + 8, 8);
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+    for (int i = 0; i < 4; ++i)
+        X[i] = static_cast<uint32_t>(compact16(lo >> (3 - i)) | (compact16(hi >> (3 - i)) << 16));
+}
+
+// Parity of bits above each bit of x: Skilling's Gray-code correction term
+inline uint32_t upper_parity(uint32_t x) {
+    x ^= x >> 1;
+    x ^= x >> 2;
+    x ^= x >> 4;
+    x ^= x >> 8;
+    x ^= x >> 16;
+    return x >> 1;
+}
+
+void axes_to_transpose(uint32_t X[4]) {
+    for (uint32_t Q = 1u << 31; Q > 1; Q >>= 1) {
+        uint32_t P = Q - 1;
+        for (int i = 0; i < 4; ++i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    for (int i = 1; i < 4; ++i) X[i] ^= X[i - 1];
+    uint32_t t = upper_parity(X[3]);
+    for (int i = 0; i < 4; ++i) X[i] ^= t;
+}
+
+// Only the top `level` bits of each axis are exact: rounds below them would
+// only rewrite the bits under them
+void transpose_to_axes(uint32_t X[4], uint32_t level) {
+    uint32_t t = X[3] >> 1;
+    for (int i = 3; i > 0; --i) X[i] ^= X[i - 1];
+    X[0] ^= t;
+    for (uint64_t Q = 2ULL << (32 - level); Q < (1ULL << 32); Q <<= 1) {
+        uint32_t P = static_cast<uint32_t>(Q - 1);
+        for (int i = 3; i >= 0; --i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+}
+
+// Points of one SIMD group through a per-ISA kernel: lanes[d][l] is coordinate d of point l
+template <size_t W, typename Kernel>
+void encode_lanes(const double* xyzw, uint8_t tbits, HilbertCurve4D::HilbertIndex* out, Kernel kernel) {
+    uint32_t lanes[4][W];
+    for (size_t l = 0; l < W; ++l)
+        for (int d = 0; d < 4; ++d) lanes[d][l] = discretize(xyzw[l * 4 + d]);
+    kernel(lanes);
+    for (size_t l = 0; l < W; ++l) {
+        uint32_t T[4] = {lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]};
+        pack(T, tbits, out[l]);
+    }
+}
+
+template <size_t W, typename Kernel, typename Sink>
+void decode_lanes(const HilbertCurve4D::HilbertIndex* in, size_t first, uint32_t level, Kernel kernel, Sink& sink) {
+    uint32_t lanes[4][W];
+    for (size_t l = 0; l < W; ++l) {
+        uint32_t T[4];
+        unpack(in[first + l], T);
+        for (int d = 0; d < 4; ++d) lanes[d][l] = T[d];
+    }
+    kernel(lanes, level);
+    for (size_t l = 0; l < W; ++l) {
+        uint32_t T[4] = {lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]};
+        sink(first + l, T);
+    }
+}
+
+} // namespace
+
+void HilbertCurve4D::encode_batch(const double* xyzw, size_t n, HilbertIndex* out, EntityType type) {
+    const uint8_t tbits = static_cast<uint8_t>(type);
+    size_t i = 0;
+#if defined(HARTONOMOUS_X86_KERNELS)
+    using namespace hilbert_lanes;
+    const SimdLevel simd = simd_level();
+    if (simd >= SimdLevel::Avx512)
+        for (; i + AVX512_LANES <= n; i += AVX512_LANES)
+            encode_lanes<AVX512_LANES>(xyzw + i * 4, tbits, out + i, axes_to_transpose_avx512);
+    if (simd >= SimdLevel::Avx2)
+        for (; i + AVX2_LANES <= n; i += AVX2_LANES)
+            encode_lanes<AVX2_LANES>(xyzw + i * 4, tbits, out + i, axes_to_transpose_avx2);
+#endif
+    for (; i < n; ++i) {
+        uint32_t X[4];
+        for (int d = 0; d < 4; ++d) X[d] = discretize(xyzw[i * 4 + d]);
+        axes_to_transpose(X);
+        pack(X, tbits, out[i]);
+    }
+}
+
+HilbertCurve4D::Vec4 HilbertCurve4D::decode(const HilbertIndex& index) {
+    Vec4 v;
+    decode_batch(&index, 1, v.data());
+    return v;
+}
+
+// Grid coordinates of each index, exact in their top `level` bits, to sink(i, X)
+template <typename Sink>
+static void decode_grid(const HilbertCurve4D::HilbertIndex* in, size_t n, uint32_t level, Sink sink) {
+    size_t i = 0;
+#if defined(HARTONOMOUS_X86_KERNELS)
+    using namespace hilbert_lanes;
+    const SimdLevel simd = simd_level();
+    if (simd >= SimdLevel::Avx512)
+        for (; i + AVX512_LANES <= n; i += AVX512_LANES)
+            decode_lanes<AVX512_LANES>(in, i, level, transpose_to_axes_avx512, sink);
+    if (simd >= SimdLevel::Avx2)
+        for (; i + AVX2_LANES <= n; i += AVX2_LANES)
+            decode_lanes<AVX2_LANES>(in, i, level, transpose_to_axes_avx2, sink);
+#endif
+    for (; i < n; ++i) {
+        uint32_t X[4];
+        unpack(in[i], X);
+        transpose_to_axes(X, level);
+        sink(i, X);
+    }
+}
+
+void HilbertCurve4D::decode_batch(const HilbertIndex* in, size_t n, double* xyzw) {
+    decode_grid(in, n, BITS_PER_DIMENSION, [&](size_t i, const uint32_t X[4]) {
+        for (int d = 0; d < 4; ++d) xyzw[i * 4 + d] = cell_centre(X[d]);
+    });
+}
+
+void HilbertCurve4D::decode_cells(const HilbertIndex* in, size_t n, uint32_t level, uint32_t* corners) {
+    level = std::min(level, BITS_PER_DIMENSION);
+    const uint32_t mask = level == 0 ? 0u : ~uint32_t(0) << (BITS_PER_DIMENSION - level);
+    decode_grid(in, n, level, [&](size_t i, const uint32_t X[4]) {
+        for (int d = 0; d < 4; ++d) corners[i * 4 + d] = X[d] & mask;
+    });
+}
+
+} // namespace hartonomous::spatial
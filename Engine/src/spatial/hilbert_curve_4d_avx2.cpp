@@ -0,0 +1,70 @@
+/**
+ * @file hilbert_curve_4d_avx2.cpp
+ * @brief Eight-lane Skilling transform (built with AVX2 flags)
+ *
+ * The scalar loops in hilbert_curve_4d.cpp with X[i] holding one coordinate
+ * of eight points and each branch turned into a mask.
+ */
+
+#include "spatial/hilbert_lanes.hpp"
+#include <immintrin.h>
+
+namespace hartonomous::spatial::hilbert_lanes {
+
+namespace {
+
+inline __m256i vxor(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+
+// Branch of one (Q, i) step: X[i] & Q set flips X[0] low bits, else swaps them with X[i]'s
+inline void exchange(__m256i& x0, __m256i& xi, __m256i q, __m256i p) {
+    __m256i set = _mm256_cmpeq_epi32(_mm256_and_si256(xi, q), q);
+    __m256i t = _mm256_andnot_si256(set, _mm256_and_si256(vxor(x0, xi), p));
+    x0 = vxor(x0, _mm256_or_si256(_mm256_and_si256(set, p), t));
+    xi = vxor(xi, t);
+}
+
+inline void load(uint32_t (*lanes)[AVX2_LANES], __m256i X[4]) {
+    for (int d = 0; d < 4; ++d) X[d] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes[d]));
+}
+
+inline void store(uint32_t (*lanes)[AVX2_LANES], const __m256i X[4]) {
+    for (int d = 0; d < 4; ++d) _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[d]), X[d]);
+}
+
+} // namespace
+
+void axes_to_transpose_avx2(uint32_t (*lanes)[AVX2_LANES]) {
+    __m256i X[4];
+    load(lanes, X);
+    for (uint32_t Q = 1u << 31; Q > 1; Q >>= 1) {
+        __m256i q = _mm256_set1_epi32(static_cast<int>(Q));
+        __m256i p = _mm256_set1_epi32(static_cast<int>(Q - 1));
+        __m256i set0 = _mm256_cmpeq_epi32(_mm256_and_si256(X[0], q), q);
+        X[0] = vxor(X[0], _mm256_and_si256(set0, p));
+        for (int i = 1; i < 4; ++i) exchange(X[0], X[i], q, p);
+    }
+    for (int i = 1; i < 4; ++i) X[i] = vxor(X[i], X[i - 1]);
+    __m256i t = X[3];
+    for (int s = 1; s < 32; s <<= 1) t = vxor(t, _mm256_srli_epi32(t, s));
+    t = _mm256_srli_epi32(t, 1);
+    for (int i = 0; i < 4; ++i) X[i] = vxor(X[i], t);
+    store(lanes, X);
+}
+
+void transpose_to_axes_avx2(uint32_t (*lanes)[AVX2_LANES], uint32_t level) {
+    __m256i X[4];
+    load(lanes, X);
+    __m256i t = _mm256_srli_epi32(X[3], 1);
+    for (int i = 3; i > 0; --i) X[i] = vxor(X[i], X[i - 1]);
+    X[0] = vxor(X[0], t);
+    for (uint64_t Q = 2ULL << (32 - level); Q < (1ULL << 32); Q <<= 1) {
+        __m256i q = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(Q)));
+        __m256i p = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(Q - 1)));
+        for (int i = 3; i > 0; --i) exchange(X[0], X[i], q, p);
+        __m256i set0 = _mm256_cmpeq_epi32(_mm256_and_si256(X[0], q), q);
+        X[0] = vxor(X[0], _mm256_and_si256(set0, p));
+    }
+    store(lanes, X);
+}
+
+} // namespace hartonomous::spatial::hilbert_lanes
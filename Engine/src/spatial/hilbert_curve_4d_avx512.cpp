@@ -0,0 +1,70 @@
+/**
+ * @file hilbert_curve_4d_avx512.cpp
+ * @brief Sixteen-lane Skilling transform (built with AVX-512 flags)
+ *
+ * The AVX2 lanes with the branch masks in mask registers: a set Q bit
+ * selects P outright and the swap term is zeroed under the same mask.
+ */
+
+#include "spatial/hilbert_lanes.hpp"
+#include <immintrin.h>
+
+namespace hartonomous::spatial::hilbert_lanes {
+
+namespace {
+
+inline __m512i vxor(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+
+inline __mmask16 has(__m512i x, __m512i q) { return _mm512_test_epi32_mask(x, q); }
+
+// Branch of one (Q, i) step: X[i] & Q set flips X[0] low bits, else swaps them with X[i]'s
+inline void exchange(__m512i& x0, __m512i& xi, __m512i q, __m512i p) {
+    const __mmask16 set = has(xi, q);
+    const __m512i t = _mm512_maskz_and_epi32(static_cast<__mmask16>(~set), vxor(x0, xi), p);
+    x0 = vxor(x0, _mm512_mask_mov_epi32(t, set, p));
+    xi = vxor(xi, t);
+}
+
+inline void load(uint32_t (*lanes)[AVX512_LANES], __m512i X[4]) {
+    for (int d = 0; d < 4; ++d) X[d] = _mm512_loadu_si512(lanes[d]);
+}
+
+inline void store(uint32_t (*lanes)[AVX512_LANES], const __m512i X[4]) {
+    for (int d = 0; d < 4; ++d) _mm512_storeu_si512(lanes[d], X[d]);
+}
+
+} // namespace
+
+void axes_to_transpose_avx512(uint32_t (*lanes)[AVX512_LANES]) {
+    __m512i X[4];
+    load(lanes, X);
+    for (uint32_t Q = 1u << 31; Q > 1; Q >>= 1) {
+        __m512i q = _mm512_set1_epi32(static_cast<int>(Q));
+        __m512i p = _mm512_set1_epi32(static_cast<int>(Q - 1));
+        X[0] = _mm512_mask_xor_epi32(X[0], has(X[0], q), X[0], p);
+        for (int i = 1; i < 4; ++i) exchange(X[0], X[i], q, p);
+    }
+    for (int i = 1; i < 4; ++i) X[i] = vxor(X[i], X[i - 1]);
+    __m512i t = X[3];
+    for (int s = 1; s < 32; s <<= 1) t = vxor(t, _mm512_srli_epi32(t, s));
+    t = _mm512_srli_epi32(t, 1);
+    for (int i = 0; i < 4; ++i) X[i] = vxor(X[i], t);
+    store(lanes, X);
+}
+
+void transpose_to_axes_avx512(uint32_t (*lanes)[AVX512_LANES], uint32_t level) {
+    __m512i X[4];
+    load(lanes, X);
+    __m512i t = _mm512_srli_epi32(X[3], 1);
+    for (int i = 3; i > 0; --i) X[i] = vxor(X[i], X[i - 1]);
+    X[0] = vxor(X[0], t);
+    for (uint64_t Q = 2ULL << (32 - level); Q < (1ULL << 32); Q <<= 1) {
+        __m512i q = _mm512_set1_epi32(static_cast<int>(static_cast<uint32_t>(Q)));
+        __m512i p = _mm512_set1_epi32(static_cast<int>(static_cast<uint32_t>(Q - 1)));
+        for (int i = 3; i > 0; --i) exchange(X[0], X[i], q, p);
+        X[0] = _mm512_mask_xor_epi32(X[0], has(X[0], q), X[0], p);
+    }
+    store(lanes, X);
+}
+
+} // namespace hartonomous::spatial::hilbert_lanes
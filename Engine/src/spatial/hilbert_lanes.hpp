@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @file hilbert_lanes.hpp
+ * @brief Skilling's transform across SIMD lanes, built per ISA
+ *
+ * lanes[d][l] is coordinate d of point l: axes in, transposed form out, or
+ * back. hilbert_curve_4d_avx2.cpp and hilbert_curve_4d_avx512.cpp are built
+ * with their own -m flags; HilbertCurve4D's batch calls pick one from
+ * simd_level() and finish the tail with the scalar loops.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hartonomous::spatial::hilbert_lanes {
+
+constexpr size_t AVX2_LANES = 8;
+constexpr size_t AVX512_LANES = 16;
+
+void axes_to_transpose_avx2(uint32_t (*lanes)[AVX2_LANES]);
+void transpose_to_axes_avx2(uint32_t (*lanes)[AVX2_LANES], uint32_t level);
+
+void axes_to_transpose_avx512(uint32_t (*lanes)[AVX512_LANES]);
+void transpose_to_axes_avx512(uint32_t (*lanes)[AVX512_LANES], uint32_t level);
+
+} // namespace hartonomous::spatial::hilbert_lanes
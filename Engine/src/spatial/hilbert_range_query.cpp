@@ -0,0 +1,255 @@
+/**
+ * @file hilbert_range_query.cpp
+ * @brief Hilbert cell-tree decomposition of S³ balls and boxes, and sorted-key scans
+ */
+
+#include <spatial/hilbert_range_query.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace hartonomous::spatial {
+
+namespace {
+
+using Key = HilbertRangeQuery::Key;
+using Vec4 = Eigen::Vector4d;
+
+constexpr Key KEY_MAX = ~Key(0);
+constexpr uint32_t DEEPEST_LEVEL = 30;  // Below this a cell's key range is only type bits and rounding
+constexpr double MAX_VAL = static_cast<double>((1ULL << HilbertCurve4D::BITS_PER_DIMENSION) - 1);
+constexpr double CELL_SLACK = 1e-12;    // Keeps points on a cell face inside both neighbors
+
+enum class Cover { Outside, Partial, Inside };
+
+struct Range {
+    Key lo, hi;
+};
+
+// Keys of the level-`level` cell with this prefix
+Range cell_range(Key prefix, uint32_t level) {
+    if (level == 0) return {0, KEY_MAX};
+    uint32_t shift = 128 - 4 * level;
+    return {prefix << shift, (prefix << shift) | ((Key(1) << shift) - 1)};
+}
+
+// S³-coordinate bounds of a level-`level` cell from its grid corner
+void cell_bounds(const uint32_t corner[4], uint32_t level, Vec4& a, Vec4& b) {
+    const uint64_t side = 1ULL << (HilbertCurve4D::BITS_PER_DIMENSION - level);
+    for (int k = 0; k < 4; ++k) {
+        double lo = static_cast<double>(corner[k]) / MAX_VAL;
+        double hi = std::min(static_cast<double>(corner[k] + side) / MAX_VAL, 1.0);
+        a[k] = 2.0 * lo - 1.0 - CELL_SLACK;
+        b[k] = 2.0 * hi - 1.0 + CELL_SLACK;
+    }
+}
+
+// Whether the box [a, b] can hold a unit vector
+bool meets_sphere(const Vec4& a, const Vec4& b) {
+    double nmin = 0.0, nmax = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        double a2 = a[k] * a[k], b2 = b[k] * b[k];
+        if (a[k] > 0.0 || b[k] < 0.0) nmin += std::min(a2, b2);
+        nmax += std::max(a2, b2);
+    }
+    return nmin <= 1.0 + CELL_SLACK && nmax >= 1.0 - CELL_SLACK;
+}
+
+// Sorted, coalesced ranges, then the smallest gaps closed until at most max_intervals remain
+std::vector<HilbertRangeQuery::Interval> finish(std::vector<Range> ranges, size_t max_intervals) {
+    std::sort(ranges.begin(), ranges.end(), [](const Range& x, const Range& y) { return x.lo < y.lo; });
+    std::vector<Range> merged;
+    for (const auto& r : ranges) {
+        if (!merged.empty() && (merged.back().hi == KEY_MAX || r.lo <= merged.back().hi + 1))
+            merged.back().hi = std::max(merged.back().hi, r.hi);
+        else
+            merged.push_back(r);
+    }
+
+    max_intervals = std::max<size_t>(max_intervals, 1);
+    if (merged.size() > max_intervals) {
+        std::vector<size_t> gaps(merged.size() - 1);
+        std::iota(gaps.begin(), gaps.end(), 0);
+        size_t close = merged.size() - max_intervals;
+        std::nth_element(gaps.begin(), gaps.begin() + (close - 1), gaps.end(), [&](size_t x, size_t y) {
+            return merged[x + 1].lo - merged[x].hi < merged[y + 1].lo - merged[y].hi;
+        });
+        std::vector<bool> joined(merged.size() - 1, false);
+        for (size_t g = 0; g < close; ++g) joined[gaps[g]] = true;
+
+        std::vector<Range> fitted;
+        for (size_t i = 0; i < merged.size(); ++i) {
+            if (i > 0 && joined[i - 1]) fitted.back().hi = merged[i].hi;
+            else fitted.push_back(merged[i]);
+        }
+        merged.swap(fitted);
+    }
+
+    std::vector<HilbertRangeQuery::Interval> out;
+    out.reserve(merged.size());
+    for (const auto& r : merged) out.push_back({HilbertRangeQuery::to_index(r.lo), HilbertRangeQuery::to_index(r.hi)});
+    return out;
+}
+
+// Breadth-first split of boundary cells while a level's boundary cells fit
+// the cell budget; the many fine ranges are then merged down across the
+// smallest key gaps, which keeps them tight around the region
+template <typename Classify>
+std::vector<HilbertRangeQuery::Interval> cover(Classify classify, const HilbertRangeQuery::Options& options) {
+    const uint32_t max_level = std::min(options.max_level, DEEPEST_LEVEL);
+    std::vector<Range> ranges;
+    std::vector<Key> partial = {0};
+    std::vector<Key> next;
+    uint32_t level = 0;
+    HilbertCurve4D::HilbertIndex starts[16];
+    uint32_t corners[16 * 4];
+    Vec4 a, b;
+    while (!partial.empty() && level < max_level && partial.size() <= options.max_cells) {
+        next.clear();
+        for (Key p : partial) {
+            for (Key c = 0; c < 16; ++c) starts[c] = HilbertRangeQuery::to_index(cell_range((p << 4) | c, level + 1).lo);
+            HilbertCurve4D::decode_cells(starts, 16, level + 1, corners);
+            for (Key c = 0; c < 16; ++c) {
+                Key child = (p << 4) | c;
+                cell_bounds(corners + 4 * c, level + 1, a, b);
+                Cover cls = meets_sphere(a, b) ? classify(a, b) : Cover::Outside;
+                if (cls == Cover::Inside) ranges.push_back(cell_range(child, level + 1));
+                else if (cls == Cover::Partial) next.push_back(child);
+            }
+        }
+        partial.swap(next);
+        ++level;
+    }
+    for (Key p : partial) ranges.push_back(cell_range(p, level));
+    return finish(std::move(ranges), options.max_intervals);
+}
+
+} // namespace
+
+std::vector<HilbertRangeQuery::Interval> HilbertRangeQuery::ball(const Vec4& center, double radius,
+                                                                 const Options& options) {
+    if (radius >= M_PI) return {{to_index(0), to_index(KEY_MAX)}};
+    if (radius < 0.0) return {};
+    const double cos_r = std::cos(radius);
+    const double chord = 2.0 * std::sin(radius / 2.0);
+    // The cap is the sphere's part of the half-space center . x >= cos r, and
+    // lies within chord distance of the center
+    return cover([&](const Vec4& a, const Vec4& b) {
+        double dmin = 0.0, dmax = 0.0, gap2 = 0.0;
+        for (int k = 0; k < 4; ++k) {
+            double p = center[k] * a[k], q = center[k] * b[k];
+            dmin += std::min(p, q);
+            dmax += std::max(p, q);
+            double g = std::max({a[k] - center[k], center[k] - b[k], 0.0});
+            gap2 += g * g;
+        }
+        if (dmax < cos_r || gap2 > chord * chord) return Cover::Outside;
+        return dmin >= cos_r ? Cover::Inside : Cover::Partial;
+    }, options);
+}
+
+std::vector<HilbertRangeQuery::Interval> HilbertRangeQuery::box(const Vec4& lo, const Vec4& hi,
+                                                                const Options& options) {
+    for (int k = 0; k < 4; ++k)
+        if (hi[k] < lo[k]) return {};
+    return cover([&](const Vec4& a, const Vec4& b) {
+        bool inside = true;
+        for (int k = 0; k < 4; ++k) {
+            if (b[k] < lo[k] || a[k] > hi[k]) return Cover::Outside;
+            inside = inside && lo[k] <= a[k] && b[k] <= hi[k];
+        }
+        return inside ? Cover::Inside : Cover::Partial;
+    }, options);
+}
+
+HilbertRangeQuery::Key HilbertRangeQuery::key(const Vec4& point) {
+    Vec4 u = (point.array() + 1.0) / 2.0;
+    HilbertIndex index;
+    HilbertCurve4D::encode_batch(u.data(), 1, &index);
+    return to_key(index);
+}
+
+HilbertRangeQuery::Key HilbertRangeQuery::to_key(const HilbertIndex& index) {
+    Key k = 0;
+    for (uint8_t byte : index) k = (k << 8) | byte;
+    return k;
+}
+
+HilbertRangeQuery::HilbertIndex HilbertRangeQuery::to_index(Key key) {
+    HilbertIndex index;
+    for (int i = 15; i >= 0; --i, key >>= 8) index[i] = static_cast<uint8_t>(key);
+    return index;
+}
+
+double HilbertRangeQuery::geodesic(const Vec4& a, const Vec4& b) {
+    return std::acos(std::clamp(a.dot(b), -1.0, 1.0));
+}
+
+// =============================================================================
+// HilbertPointIndex
+// =============================================================================
+
+HilbertPointIndex::HilbertPointIndex(const std::vector<Eigen::Vector4d>& points) {
+    const size_t n = points.size();
+    std::vector<double> coords(4 * n);
+    for (size_t i = 0; i < n; ++i)
+        for (int k = 0; k < 4; ++k) coords[4 * i + k] = (points[i][k] + 1.0) / 2.0;
+    std::vector<HilbertCurve4D::HilbertIndex> indices(n);
+    HilbertCurve4D::encode_batch(coords.data(), n, indices.data());
+
+    original_.resize(n);
+    std::iota(original_.begin(), original_.end(), 0);
+    std::vector<HilbertRangeQuery::Key> keys(n);
+    for (size_t i = 0; i < n; ++i) keys[i] = HilbertRangeQuery::to_key(indices[i]);
+    std::sort(original_.begin(), original_.end(), [&](size_t x, size_t y) { return keys[x] < keys[y]; });
+
+    keys_.reserve(n);
+    points_.reserve(n);
+    for (size_t i : original_) {
+        keys_.push_back(keys[i]);
+        points_.push_back(points[i]);
+    }
+}
+
+std::vector<HilbertPointIndex::Hit> HilbertPointIndex::within(const Eigen::Vector4d& center, double radius,
+                                                              const HilbertRangeQuery::Options& options) const {
+    std::vector<Hit> hits;
+    for (const auto& iv : HilbertRangeQuery::ball(center, radius, options)) {
+        auto lo = HilbertRangeQuery::to_key(iv.lo);
+        auto hi = HilbertRangeQuery::to_key(iv.hi);
+        for (size_t i = std::lower_bound(keys_.begin(), keys_.end(), lo) - keys_.begin();
+             i < keys_.size() && keys_[i] <= hi; ++i) {
+            double d = HilbertRangeQuery::geodesic(center, points_[i]);
+            if (d <= radius) hits.push_back({original_[i], d});
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const Hit& x, const Hit& y) { return x.distance < y.distance; });
+    return hits;
+}
+
+std::vector<HilbertPointIndex::Hit> HilbertPointIndex::nearest(const Eigen::Vector4d& point, size_t k,
+                                                               double initial_radius) const {
+    const size_t n = keys_.size();
+    k = std::min(k, n);
+    if (k == 0) return {};
+
+    // A cap of radius r covers 2 r^3 / (3 pi) of S³
+    double r = initial_radius > 0.0 ? initial_radius
+                                    : std::cbrt(3.0 * M_PI * static_cast<double>(k) / (2.0 * static_cast<double>(n)));
+    for (; r < M_PI; r *= 2.0) {
+        auto hits = within(point, r);
+        if (hits.size() >= k) {
+            hits.resize(k);
+            return hits;
+        }
+    }
+
+    std::vector<Hit> hits(n);
+    for (size_t i = 0; i < n; ++i) hits[i] = {original_[i], HilbertRangeQuery::geodesic(point, points_[i])};
+    std::partial_sort(hits.begin(), hits.begin() + k, hits.end(),
+                      [](const Hit& x, const Hit& y) { return x.distance < y.distance; });
+    hits.resize(k);
+    return hits;
+}
+
+} // namespace hartonomous::spatial
@@ -1,43 +1,324 @@
 #include <storage/atom_lookup.hpp>
+#include <utils/huge_pages.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace Hartonomous {
 
-AtomLookup::AtomLookup(PostgresConnection& db) : db_(db) {}
+// Atom image layout: fixed header, then one 64-byte-aligned section per
+// field, each a dense array of `count` entries indexed by codepoint.
+// The checksum is BLAKE3 over everything after the header.
+static constexpr char IMAGE_MAGIC[8] = {'H', 'A', 'T', 'O', 'M', 'I', 'M', 'G'};
+static constexpr uint32_t IMAGE_VERSION = 1;
+static constexpr size_t IMAGE_HEADER_BYTES = 128;
+static constexpr size_t IMAGE_ALIGN = 64;
+
+enum ImageSection : size_t { SecPresent, SecIds, SecPhysIds, SecPositions, SecHilbert, SECTION_COUNT };
+
+static constexpr size_t SECTION_STRIDE[SECTION_COUNT] = {1, 16, 16, 4 * sizeof(double), 16};
+
+struct ImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t file_size;
+    uint64_t offsets[SECTION_COUNT];
+    uint8_t checksum[16];
+};
+static_assert(sizeof(ImageHeader) <= IMAGE_HEADER_BYTES);
+
+static size_t align_up(size_t v) { return (v + IMAGE_ALIGN - 1) & ~(IMAGE_ALIGN - 1); }
+
+// Section offsets for `count` entries; returns total file size
+static size_t layout_image(uint32_t count, uint64_t offsets[SECTION_COUNT]) {
+    size_t off = IMAGE_HEADER_BYTES;
+    for (size_t s = 0; s < SECTION_COUNT; ++s) {
+        offsets[s] = off;
+        off = align_up(off + static_cast<size_t>(count) * SECTION_STRIDE[s]);
+    }
+    return off;
+}
+
+// A verified image mapping, shared by every AtomLookup that loads the same file
+struct AtomLookup::Image {
+    void* addr = nullptr;
+    size_t mapped = 0;
+    ImageHeader header{};
+    // Identity of the file mapped, so a rewritten image is mapped afresh
+    dev_t dev = 0;
+    ino_t ino = 0;
+    off_t size = 0;
+    int64_t mtime_ns = 0;
+
+    ~Image() { if (addr) ::munmap(addr, mapped); }
+    const uint8_t* base() const { return static_cast<const uint8_t*>(addr); }
+};
+
+AtomLookup::AtomLookup(PostgresConnection& db)
+    : db_(db),
+      cache_account_(MemoryGovernor::global().enroll("atom_lookup", MemoryGovernor::Priority::Normal)),
+      dense_account_(MemoryGovernor::global().enroll("atom_table", MemoryGovernor::Priority::Pinned)) {}
+
+AtomLookup::~AtomLookup() { reset_dense(); }
+
+std::string AtomLookup::default_image_path() {
+    if (const char* p = std::getenv("HARTONOMOUS_ATOM_IMAGE")) return p;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/atoms.img";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/atoms.img";
+    return "";
+}
+
+void AtomLookup::account_cache() {
+    if (cache_account_.shrink_requested()) {
+        std::unordered_map<uint32_t, AtomInfo>().swap(cache_);
+        cache_account_.shrunk(0);
+        return;
+    }
+    cache_account_.update(MemoryGovernor::hash_map_bytes(cache_));
+}
+
+void AtomLookup::reset_dense() {
+    image_.reset();
+    owned_ = DenseStorage{};
+    dense_account_.update(0);
+    dense_count_ = 0;
+    dense_present_ = nullptr;
+    dense_ids_ = nullptr;
+    dense_phys_ids_ = nullptr;
+    dense_positions_ = nullptr;
+    dense_hilbert_ = nullptr;
+}
+
+HugePageUsage AtomLookup::huge_page_usage() const {
+    if (image_) return Hartonomous::huge_page_usage(image_->addr, image_->mapped);
+    HugePageUsage usage = array_huge_page_usage(owned_.present);
+    usage += array_huge_page_usage(owned_.ids);
+    usage += array_huge_page_usage(owned_.phys_ids);
+    usage += array_huge_page_usage(owned_.positions);
+    usage += array_huge_page_usage(owned_.hilbert);
+    return usage;
+}
+
+std::optional<AtomLookup::AtomInfo> AtomLookup::dense_lookup(uint32_t codepoint) const {
+    if (codepoint >= dense_count_ || !dense_present_[codepoint]) return std::nullopt;
+    AtomInfo info;
+    info.id = dense_ids_[codepoint];
+    info.physicality_id = dense_phys_ids_[codepoint];
+    info.position = Eigen::Map<const Vec4>(dense_positions_ + 4 * static_cast<size_t>(codepoint));
+    info.hilbert_index = dense_hilbert_[codepoint];
+    info.codepoint = codepoint;
+    return info;
+}
+
+size_t AtomLookup::lookup_codepoints(std::u32string_view text, std::span<Hash> ids, std::span<Vec4> positions) {
+    if (ids.size() < text.size() || positions.size() < text.size())
+        throw std::invalid_argument("lookup_codepoints: output spans smaller than input");
+
+    size_t n = 0;
+    if (!is_dense()) {
+        for (char32_t cp : text) {
+            if (auto info = lookup(static_cast<uint32_t>(cp))) {
+                ids[n] = info->id;
+                positions[n] = info->position;
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    for (char32_t c : text) {
+        uint32_t cp = static_cast<uint32_t>(c);
+        if (cp >= dense_count_ || !dense_present_[cp]) continue;
+        ids[n] = dense_ids_[cp];
+        positions[n] = Eigen::Map<const Eigen::Matrix<double, 4, 1>, Eigen::Aligned32>(
+            dense_positions_ + 4 * static_cast<size_t>(cp));
+        ++n;
+    }
+    return n;
+}
+
+std::shared_ptr<const AtomLookup::Image> AtomLookup::shared_image(const std::string& path, bool pin) {
+    // Pinned images, each served from its one mapping while the file is unchanged
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const Image>> registry;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < IMAGE_HEADER_BYTES) {
+        ::close(fd);
+        return nullptr;
+    }
+    const int64_t mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto it = registry.find(path); it != registry.end()) {
+        const auto& image = it->second;
+        if (image->dev == st.st_dev && image->ino == st.st_ino && image->size == st.st_size &&
+            image->mtime_ns == mtime_ns) {
+            ::close(fd);
+            return image;
+        }
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    size_t mapped = 0;
+    void* addr = map_file_readonly(fd, size, mapped);
+    ::close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    numa_first_touch(addr, size);   // Before the checksum faults it all in from this thread
+
+    auto image = std::make_shared<Image>();
+    image->addr = addr;
+    image->mapped = mapped;
+    image->dev = st.st_dev;
+    image->ino = st.st_ino;
+    image->size = st.st_size;
+    image->mtime_ns = mtime_ns;
+
+    const uint8_t* base = image->base();
+    ImageHeader& hdr = image->header;
+    std::memcpy(&hdr, base, sizeof(hdr));
+
+    uint64_t expected[SECTION_COUNT];
+    bool ok = std::memcmp(hdr.magic, IMAGE_MAGIC, 8) == 0 &&
+              hdr.version == IMAGE_VERSION &&
+              hdr.count <= 0x110000 &&
+              hdr.file_size == size &&
+              layout_image(hdr.count, expected) == size &&
+              std::equal(expected, expected + SECTION_COUNT, hdr.offsets);
+    if (ok) {
+        auto sum = BLAKE3Pipeline::hash(base + IMAGE_HEADER_BYTES, size - IMAGE_HEADER_BYTES);
+        ok = std::memcmp(sum.data(), hdr.checksum, 16) == 0;
+    }
+    if (!ok) return nullptr;
+
+    if (pin) registry[path] = image;
+    return image;
+}
+
+bool AtomLookup::pin_image(const std::string& path) {
+    return shared_image(path, true) != nullptr;
+}
+
+bool AtomLookup::load_image(const std::string& path) {
+    auto image = shared_image(path, false);
+    if (!image) return false;
+
+    reset_dense();
+    cache_.clear();
+    account_cache();
+    const uint8_t* base = image->base();
+    const ImageHeader& hdr = image->header;
+    image_ = std::move(image);
+    dense_count_ = hdr.count;
+    // Hash, HilbertIndex and double are read in place; sections are 64-byte aligned
+    dense_present_ = base + hdr.offsets[SecPresent];
+    dense_ids_ = reinterpret_cast<const Hash*>(base + hdr.offsets[SecIds]);
+    dense_phys_ids_ = reinterpret_cast<const Hash*>(base + hdr.offsets[SecPhysIds]);
+    dense_positions_ = reinterpret_cast<const double*>(base + hdr.offsets[SecPositions]);
+    dense_hilbert_ = reinterpret_cast<const HilbertIndex*>(base + hdr.offsets[SecHilbert]);
+    preloaded_ = true;
+    return true;
+}
+
+void AtomLookup::write_image(const std::string& path) {
+    if (!preloaded_) preload_from_db();
+
+    uint32_t count = dense_count_;
+
+    uint64_t offsets[SECTION_COUNT];
+    size_t size = layout_image(count, offsets);
+    std::vector<uint8_t> buf(size, 0);
+
+    auto put = [&](const AtomInfo& info) {
+        size_t cp = info.codepoint;
+        buf[offsets[SecPresent] + cp] = 1;
+        std::memcpy(&buf[offsets[SecIds] + cp * 16], info.id.data(), 16);
+        std::memcpy(&buf[offsets[SecPhysIds] + cp * 16], info.physicality_id.data(), 16);
+        std::memcpy(&buf[offsets[SecPositions] + cp * 4 * sizeof(double)], info.position.data(), 4 * sizeof(double));
+        std::memcpy(&buf[offsets[SecHilbert] + cp * 16], info.hilbert_index.data(), 16);
+    };
+    for (uint32_t cp = 0; cp < count; ++cp)
+        if (auto info = dense_lookup(cp)) put(*info);
+
+    ImageHeader hdr{};
+    std::memcpy(hdr.magic, IMAGE_MAGIC, 8);
+    hdr.version = IMAGE_VERSION;
+    hdr.count = count;
+    hdr.file_size = size;
+    std::memcpy(hdr.offsets, offsets, sizeof(offsets));
+    auto sum = BLAKE3Pipeline::hash(buf.data() + IMAGE_HEADER_BYTES, size - IMAGE_HEADER_BYTES);
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path());
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) throw std::runtime_error("Failed to create atom image: " + tmp);
+    bool ok = std::fwrite(buf.data(), 1, size, f) == size;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to write atom image: " + path);
+    }
+}
 
 std::optional<AtomLookup::AtomInfo> AtomLookup::lookup(uint32_t codepoint) {
+    if (is_dense()) return dense_lookup(codepoint);
+    if (cache_account_.shrink_requested()) account_cache();
     if (auto it = cache_.find(codepoint); it != cache_.end()) return it->second;
 
-    std::string sql = R"(
-        SELECT a.id, a.codepoint, p.id as phys_id,
-               ST_X(p.centroid), ST_Y(p.centroid), ST_Z(p.centroid), ST_M(p.centroid),
+    const auto& stmt = db_.prepare("atom_lookup", R"(
+        SELECT a.id, a.codepoint::int4, p.id as phys_id,
+               ST_X(p.centroid)::float8, ST_Y(p.centroid)::float8, ST_Z(p.centroid)::float8, ST_M(p.centroid)::float8,
                p.hilbert
         FROM hartonomous.atom a
         JOIN hartonomous.physicality p ON a.physicalityid = p.id
         WHERE a.codepoint = $1
-    )";
+    )", {PgType::Int4});
 
-    std::optional<AtomInfo> result;
-    db_.query(sql, {std::to_string(codepoint)}, [&](const std::vector<std::string>& row) {
-        if (row.size() >= 8) {
-            AtomInfo info;
-            info.id = BLAKE3Pipeline::from_hex(row[0]);
-            info.codepoint = static_cast<uint32_t>(std::stoul(row[1]));
-            info.physicality_id = BLAKE3Pipeline::from_hex(row[2]);
-            for (int i=0; i<4; ++i) info.position[i] = std::stod(row[3+i]);
-            info.hilbert_index = BLAKE3Pipeline::from_hex(row[7]);
-            cache_[codepoint] = info;
-            result = info;
-        }
-    });
-    return result;
+    PgResult rows = db_.execute_prepared(stmt, {PgParam::int4(static_cast<int32_t>(codepoint))});
+    if (rows.empty()) return std::nullopt;
+
+    auto row = rows[0];
+    AtomInfo info;
+    info.id = row.get_uuid(0);
+    info.codepoint = static_cast<uint32_t>(row.get_int4(1));
+    info.physicality_id = row.get_uuid(2);
+    for (int i = 0; i < 4; ++i) info.position[i] = row.get_float8(3 + i);
+    info.hilbert_index = row.get_uuid(7);
+    cache_[codepoint] = info;
+    account_cache();
+    return info;
 }
 
 std::unordered_map<uint32_t, AtomLookup::AtomInfo> AtomLookup::lookup_batch(const std::vector<uint32_t>& codepoints) {
     std::unordered_map<uint32_t, AtomInfo> results;
+    if (is_dense()) {
+        for (uint32_t cp : codepoints)
+            if (auto info = dense_lookup(cp)) results[cp] = *info;
+        return results;
+    }
+    if (cache_account_.shrink_requested()) account_cache();
     std::vector<uint32_t> missing;
     for (uint32_t cp : codepoints) {
         if (auto it = cache_.find(cp); it != cache_.end()) results[cp] = it->second;
@@ -69,13 +350,28 @@ std::unordered_map<uint32_t, AtomLookup::AtomInfo> AtomLookup::lookup_batch(cons
             results[info.codepoint] = info;
         }
     });
+    account_cache();
     return results;
 }
 
 void AtomLookup::preload_all() {
     if (preloaded_) return;
+    std::string path = default_image_path();
+    if (!path.empty() && load_image(path)) return;
+    preload_from_db();
+}
+
+void AtomLookup::preload_from_db() {
+    reset_dense();
     cache_.clear();
-    cache_.reserve(1114112);
+
+    static constexpr uint32_t CODESPACE = 0x110000;
+    owned_.present.assign(CODESPACE, 0);
+    owned_.ids.resize(CODESPACE);
+    owned_.phys_ids.resize(CODESPACE);
+    owned_.positions.resize(CODESPACE);
+    owned_.hilbert.resize(CODESPACE);
+    uint32_t count = 0;
 
     std::string sql = R"(
         SELECT a.id, a.codepoint, p.id as phys_id,
@@ -87,16 +383,34 @@ void AtomLookup::preload_all() {
 
     db_.stream_query(sql, [&](const std::vector<std::string>& row) {
         if (row.size() >= 8) {
-            AtomInfo info;
-            info.id = BLAKE3Pipeline::from_hex(row[0]);
-            info.codepoint = static_cast<uint32_t>(std::stoul(row[1]));
-            info.physicality_id = BLAKE3Pipeline::from_hex(row[2]);
-            for (int i=0; i<4; ++i) info.position[i] = std::stod(row[3+i]);
-            info.hilbert_index = BLAKE3Pipeline::from_hex(row[7]);
-            cache_[info.codepoint] = info;
+            uint32_t cp = static_cast<uint32_t>(std::stoul(row[1]));
+            if (cp >= CODESPACE) return;
+            owned_.present[cp] = 1;
+            owned_.ids[cp] = BLAKE3Pipeline::from_hex(row[0]);
+            owned_.phys_ids[cp] = BLAKE3Pipeline::from_hex(row[2]);
+            for (int i=0; i<4; ++i) owned_.positions[cp].v[i] = std::stod(row[3+i]);
+            owned_.hilbert[cp] = BLAKE3Pipeline::from_hex(row[7]);
+            count = std::max(count, cp + 1);
         }
     });
+
+    place_array(owned_.present);
+    place_array(owned_.ids);
+    place_array(owned_.phys_ids);
+    place_array(owned_.positions);
+    place_array(owned_.hilbert);
+
+    dense_count_ = count;
+    dense_present_ = owned_.present.data();
+    dense_ids_ = owned_.ids.data();
+    dense_phys_ids_ = owned_.phys_ids.data();
+    dense_positions_ = owned_.positions.data()->v;
+    dense_hilbert_ = owned_.hilbert.data();
     preloaded_ = true;
+    account_cache();
+    dense_account_.update(owned_.present.capacity() + owned_.ids.capacity() * sizeof(Hash) +
+                          owned_.phys_ids.capacity() * sizeof(Hash) + owned_.positions.capacity() * sizeof(PackedVec4) +
+                          owned_.hilbert.capacity() * sizeof(HilbertIndex));
 }
 
 } // namespace Hartonomous
@@ -10,11 +10,8 @@ void AtomStore::store(const AtomRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.physicality_id);
-        row.add_int32(static_cast<int32_t>(rec.codepoint));
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Int32>;
+        copy_.write_row<Row>(rec.id, rec.physicality_id, static_cast<int32_t>(rec.codepoint));
     } else {
         copy_.add_row({
             hash_to_uuid(rec.id),
@@ -0,0 +1,58 @@
+#include <storage/composition_adjacency.hpp>
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <string>
+
+namespace Hartonomous {
+
+// Relations per statement, keeping the uuid[] parameter to about 1 MB
+static constexpr size_t REFRESH_CHUNK = 50000;
+
+bool CompositionAdjacency::enabled(PostgresConnection& db) {
+    static std::atomic<int> state{-1};
+    int s = state.load(std::memory_order_relaxed);
+    if (s < 0) {
+        s = 0;
+        db.query("SELECT to_regclass('hartonomous.compositionadjacency') IS NOT NULL",
+                 [&](const std::vector<std::string>& row) { s = row[0] == "t"; });
+        state.store(s, std::memory_order_relaxed);
+    }
+    return s != 0;
+}
+
+void CompositionAdjacency::refresh(PostgresConnection& db, const std::vector<Hash>& relation_ids) {
+    if (relation_ids.empty() || !enabled(db)) return;
+
+    // Relation-major order, across chunks too, so transactions refreshing
+    // overlapping relations lock the shared rows in the same order
+    const auto& stmt = db.prepare("composition_adjacency_refresh", R"(
+        INSERT INTO hartonomous.compositionadjacency
+            (compositionid, neighborid, relationid, ratingvalue, observations)
+        SELECT DISTINCT rs1.compositionid, rs2.compositionid, rs1.relationid,
+               COALESCE(rr.ratingvalue, 1000), COALESCE(rr.observations, '\x0000000000000001')
+        FROM hartonomous.relationsequence rs1
+        JOIN hartonomous.relationsequence rs2
+            ON rs2.relationid = rs1.relationid
+            AND rs2.compositionid != rs1.compositionid
+        LEFT JOIN hartonomous.relationrating rr
+            ON rr.relationid = rs1.relationid
+        WHERE rs1.relationid = ANY($1)
+        ORDER BY 3, 1, 2
+        ON CONFLICT (compositionid, neighborid, relationid) DO UPDATE SET
+            ratingvalue = EXCLUDED.ratingvalue,
+            observations = EXCLUDED.observations
+    )", {PgType::UuidArray});
+
+    std::vector<Hash> ids(relation_ids);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    for (size_t i = 0; i < ids.size(); i += REFRESH_CHUNK) {
+        std::span<const Hash> chunk(ids.data() + i, std::min(REFRESH_CHUNK, ids.size() - i));
+        std::string array = pg_uuid_array(chunk);
+        db.execute_prepared(stmt, {PgParam::bytes(array.data(), array.size())});
+    }
+}
+
+} // namespace Hartonomous
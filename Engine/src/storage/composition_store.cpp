@@ -8,18 +8,29 @@ namespace Hartonomous {
 // ============================================================================
 
 CompositionStore::CompositionStore(PostgresConnection& db, bool use_temp_table, bool use_binary)
-    : SubstrateStore(db, "hartonomous.composition", {"id", "physicalityid"}, use_temp_table, use_binary) {}
+    : SubstrateStore(db, "hartonomous.composition", {"id", "physicalityid", "text", "runs"},
+                     use_temp_table, use_binary) {}
+
+// {1,2,3}; empty runs become NULL through add_row
+static std::string int4_array_literal(const std::vector<int32_t>& v) {
+    if (v.empty()) return "";
+    std::string out = "{";
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i) out += ',';
+        out += std::to_string(v[i]);
+    }
+    out += '}';
+    return out;
+}
 
 void CompositionStore::store(const CompositionRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.physicality_id);
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Text, pgcopy::Int4Array>;
+        copy_.write_row<Row>(rec.id, rec.physicality_id, rec.text, rec.runs);
     } else {
-        copy_.add_row({hash_to_uuid(rec.id), hash_to_uuid(rec.physicality_id)});
+        copy_.add_row({hash_to_uuid(rec.id), hash_to_uuid(rec.physicality_id), rec.text, int4_array_literal(rec.runs)});
     }
 }
 
@@ -38,13 +49,8 @@ void CompositionSequenceStore::store(const CompositionSequenceRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.composition_id);
-        row.add_uuid(rec.atom_id);
-        row.add_uint32(rec.ordinal);
-        row.add_uint32(rec.occurrences);
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Uuid, pgcopy::UInt32, pgcopy::UInt32>;
+        copy_.write_row<Row>(rec.id, rec.composition_id, rec.atom_id, rec.ordinal, rec.occurrences);
     } else {
         copy_.add_row({
             hash_to_uuid(rec.id),
@@ -0,0 +1,367 @@
+/**
+ * @file composition_text_store.cpp
+ * @brief Composition text blob: database load, snapshot files
+ */
+
+#include <storage/composition_text_store.hpp>
+#include <utils/huge_pages.hpp>
+#include <utils/memory_governor.hpp>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace Hartonomous {
+
+// Snapshot layout: fixed header, fingerprint bytes, then 64-byte-aligned
+// sections for sorted ids (16 B each), offsets (8 B each + 1), flags (1 B
+// each) and the blob.
+// The checksum is BLAKE3 over everything after the header.
+static constexpr char TEXT_MAGIC[8] = {'H', 'C', 'T', 'X', 'T', 'S', 'T', '1'};
+static constexpr uint32_t TEXT_VERSION = 2;
+static constexpr size_t TEXT_HEADER_BYTES = 128;
+static constexpr size_t TEXT_ALIGN = 64;
+
+struct TextHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fingerprint_len;
+    uint64_t count;
+    uint64_t blob_bytes;
+    uint64_t file_size;
+    uint64_t ids_offset;
+    uint64_t offsets_offset;
+    uint64_t flags_offset;
+    uint64_t blob_offset;
+    uint8_t checksum[16];
+};
+static_assert(sizeof(TextHeader) <= TEXT_HEADER_BYTES);
+
+static size_t align_up(size_t v) { return (v + TEXT_ALIGN - 1) & ~(TEXT_ALIGN - 1); }
+
+// Fills section offsets; returns total file size
+static size_t layout_text(size_t fp_len, size_t count, size_t blob_bytes, TextHeader& hdr) {
+    size_t off = align_up(TEXT_HEADER_BYTES + fp_len);
+    hdr.ids_offset = off;
+    off = align_up(off + count * sizeof(BLAKE3Pipeline::Hash));
+    hdr.offsets_offset = off;
+    off = align_up(off + (count + 1) * sizeof(uint64_t));
+    hdr.flags_offset = off;
+    off = align_up(off + count);
+    hdr.blob_offset = off;
+    return off + blob_bytes;
+}
+
+// Binary COPY framing: 11-byte signature, int32 flags, int32 extension length
+static constexpr char COPY_SIGNATURE[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+
+// Parse one CopyData message of (uuid, text) rows
+static void parse_text_message(const char* buf, int len,
+                               std::vector<std::pair<BLAKE3Pipeline::Hash, std::string>>& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+
+    if (len >= 19 && std::memcmp(p, COPY_SIGNATURE, 11) == 0) {
+        uint32_t ext;
+        std::memcpy(&ext, p + 15, 4);
+        p += 19 + ntohl(ext);
+    }
+
+    auto field_len = [&]() {
+        if (p + 4 > end) throw std::runtime_error("Truncated composition text COPY row");
+        uint32_t flen;
+        std::memcpy(&flen, p, 4);
+        p += 4;
+        return static_cast<int32_t>(ntohl(flen));
+    };
+
+    while (p + 2 <= end) {
+        uint16_t nfields;
+        std::memcpy(&nfields, p, 2);
+        nfields = ntohs(nfields);
+        p += 2;
+        if (nfields == 0xFFFF) return;  // Trailer
+        if (nfields != 2) throw std::runtime_error("Unexpected field count in composition text COPY stream");
+
+        auto& entry = out.emplace_back();
+        if (field_len() != 16 || p + 16 > end) throw std::runtime_error("Malformed UUID in composition text COPY stream");
+        std::memcpy(entry.first.data(), p, 16);
+        p += 16;
+
+        int32_t tlen = field_len();
+        if (tlen < 0) continue;  // NULL text
+        if (p + tlen > end) throw std::runtime_error("Truncated text in composition text COPY stream");
+        entry.second.assign(p, static_cast<size_t>(tlen));
+        p += tlen;
+    }
+}
+
+CompositionTextStore::~CompositionTextStore() {
+    if (map_addr_) ::munmap(map_addr_, map_size_);
+}
+
+std::string CompositionTextStore::default_path() {
+    if (const char* p = std::getenv("HARTONOMOUS_TEXT_STORE")) return p;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/hartonomous/composition_text.bin";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/hartonomous/composition_text.bin";
+    return "";
+}
+
+std::string CompositionTextStore::database_fingerprint(PostgresConnection& db) {
+    // relid changes if a table is recreated; n_tup_* move on any write
+    auto fp = db.query_single(
+        "SELECT current_database() || '@' || COALESCE(inet_server_port()::text, 'local') || '|' || "
+        "COALESCE(string_agg(relid::text || ':' || n_tup_ins || ':' || n_tup_upd || ':' || n_tup_del, "
+        "',' ORDER BY relname), '') "
+        "FROM pg_stat_user_tables WHERE schemaname = 'hartonomous' "
+        "AND relname IN ('composition', 'compositionsequence', 'atom')");
+    return fp.value_or("");
+}
+
+uint8_t CompositionTextStore::classify(std::string_view text) {
+    auto upper = [](char c) { return c >= 'A' && c <= 'Z'; };
+    auto alnum = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0; };
+
+    if (text.empty()) return ARTIFACT;
+    if (text.size() >= 8 && text.substr(0, 7) == "[unused") return ARTIFACT;
+    if (text == "[PAD]" || text == "[CLS]" || text == "[SEP]" || text == "[MASK]" || text == "[UNK]") return ARTIFACT;
+    if (text.size() >= 2 && text[0] == '#' && text[1] == '#') return ARTIFACT;  // Wordpiece subword
+    if (text.size() >= 2 && text[0] == '#' && !std::isalpha(static_cast<unsigned char>(text[1])))
+        return ARTIFACT;  // #17, #», etc.
+    if (text.size() == 1 && !alnum(text[0])) return PUNCTUATION;
+
+    static const std::unordered_set<std::string_view> funcs = {
+        "the", "a", "an", "of", "in", "to", "is", "and", "or", "but", "not",
+        "for", "on", "with", "at", "by", "from", "as", "that", "this", "it",
+        "was", "were", "be", "been", "being", "have", "has", "had", "do", "does",
+        "did", "will", "would", "could", "should", "may", "might", "shall", "can",
+        "are", "am", "its", "his", "her", "he", "she", "they", "them", "their",
+        "we", "our", "you", "your", "my", "me", "him", "us", "who", "whom",
+        "which", "what", "where", "when", "how", "why", "if", "so", "no",
+        "than", "then", "there", "here", "these", "those", "itself", "himself",
+        "herself", "themselves", "myself", "yourself"
+    };
+    constexpr size_t LONGEST_FUNCTION_WORD = 10;
+    if (text.size() <= LONGEST_FUNCTION_WORD) {
+        char lower[LONGEST_FUNCTION_WORD];
+        for (size_t i = 0; i < text.size(); ++i)
+            lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+        if (funcs.count(std::string_view(lower, text.size()))) return FUNCTION_WORD;
+    }
+
+    // "Paris", "McCartney"; not "NASA" or "USS" runs of capitals alone
+    if (upper(text[0]) && std::any_of(text.begin() + 1, text.end(), [](char c) { return c >= 'a' && c <= 'z'; }))
+        return PROPER_NOUN;
+    return 0;
+}
+
+HugePageUsage CompositionTextStore::huge_page_usage() const {
+    if (map_addr_) return Hartonomous::huge_page_usage(map_addr_, map_size_);
+    HugePageUsage usage = array_huge_page_usage(owned_ids_);
+    usage += array_huge_page_usage(owned_offsets_);
+    usage += array_huge_page_usage(owned_flags_);
+    usage += array_huge_page_usage(owned_blob_);
+    return usage;
+}
+
+uint32_t CompositionTextStore::index_of(const Hash& id) const {
+    const Hash* it = std::lower_bound(ids_, ids_ + count_, id);
+    return (it != ids_ + count_ && *it == id) ? static_cast<uint32_t>(it - ids_) : NPOS;
+}
+
+std::shared_ptr<CompositionTextStore> CompositionTextStore::build(std::vector<std::pair<Hash, std::string>>& entries,
+                                                                  std::string fingerprint) {
+    if (entries.size() >= NPOS) throw std::runtime_error("Composition text store exceeds 2^32 entries");
+
+    std::vector<uint32_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return entries[a].first < entries[b].first; });
+
+    std::shared_ptr<CompositionTextStore> s(new CompositionTextStore());
+    s->fingerprint_ = std::move(fingerprint);
+    size_t bytes = 0;
+    for (const auto& e : entries) bytes += e.second.size();
+    s->owned_blob_.reserve(bytes);
+    s->owned_ids_.reserve(entries.size());
+    s->owned_offsets_.reserve(entries.size() + 1);
+    s->owned_flags_.reserve(entries.size());
+    place_array(s->owned_blob_);
+    place_array(s->owned_ids_);
+    place_array(s->owned_offsets_);
+    place_array(s->owned_flags_);
+    for (uint32_t i : order) {
+        if (!s->owned_ids_.empty() && s->owned_ids_.back() == entries[i].first) continue;
+        s->owned_ids_.push_back(entries[i].first);
+        s->owned_offsets_.push_back(s->owned_blob_.size());
+        s->owned_flags_.push_back(classify(entries[i].second));
+        s->owned_blob_ += entries[i].second;
+    }
+    s->owned_offsets_.push_back(s->owned_blob_.size());
+
+    s->count_ = s->owned_ids_.size();
+    s->ids_ = s->owned_ids_.data();
+    s->offsets_ = s->owned_offsets_.data();
+    s->flags_ = s->owned_flags_.data();
+    s->blob_ = s->owned_blob_.data();
+    return s;
+}
+
+std::shared_ptr<const CompositionTextStore> CompositionTextStore::from_entries(
+    std::vector<std::pair<Hash, std::string>> entries, std::string fingerprint) {
+    return build(entries, std::move(fingerprint));
+}
+
+std::shared_ptr<const CompositionTextStore> CompositionTextStore::load_from_db(PostgresConnection& db) {
+    std::string fp = database_fingerprint(db);
+
+    std::vector<std::pair<Hash, std::string>> entries;
+    db.copy_out("COPY (SELECT composition_id, reconstructed_text FROM hartonomous.v_composition_text) "
+                "TO STDOUT (FORMAT binary)",
+                [&](const char* buf, int len) { parse_text_message(buf, len, entries); });
+
+    return build(entries, std::move(fp));
+}
+
+std::shared_ptr<const CompositionTextStore> CompositionTextStore::load_file(const std::string& path,
+                                                                            const std::string& fingerprint) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < TEXT_HEADER_BYTES) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    size_t mapped = 0;
+    void* addr = map_file_readonly(fd, size, mapped);
+    ::close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    numa_first_touch(addr, size);   // Before the checksum faults it all in from this thread
+
+    const uint8_t* base = static_cast<const uint8_t*>(addr);
+    TextHeader hdr;
+    std::memcpy(&hdr, base, sizeof(hdr));
+
+    TextHeader expected{};
+    bool ok = std::memcmp(hdr.magic, TEXT_MAGIC, 8) == 0 &&
+              hdr.version == TEXT_VERSION &&
+              hdr.file_size == size &&
+              hdr.count < NPOS &&
+              TEXT_HEADER_BYTES + hdr.fingerprint_len <= size &&
+              layout_text(hdr.fingerprint_len, hdr.count, hdr.blob_bytes, expected) == size &&
+              expected.ids_offset == hdr.ids_offset &&
+              expected.offsets_offset == hdr.offsets_offset &&
+              expected.flags_offset == hdr.flags_offset &&
+              expected.blob_offset == hdr.blob_offset;
+    std::string stored_fp;
+    if (ok) {
+        stored_fp.assign(reinterpret_cast<const char*>(base + TEXT_HEADER_BYTES), hdr.fingerprint_len);
+        ok = fingerprint.empty() || stored_fp == fingerprint;
+    }
+    if (ok) {
+        auto sum = BLAKE3Pipeline::hash(base + TEXT_HEADER_BYTES, size - TEXT_HEADER_BYTES);
+        ok = std::memcmp(sum.data(), hdr.checksum, 16) == 0;
+    }
+    if (ok) {
+        // text_at() trusts the offsets, so check they stay inside the blob
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + hdr.offsets_offset);
+        ok = offsets[0] == 0 && offsets[hdr.count] == hdr.blob_bytes;
+        for (size_t i = 0; ok && i < hdr.count; ++i) ok = offsets[i] <= offsets[i + 1];
+    }
+    if (!ok) {
+        ::munmap(addr, mapped);
+        return nullptr;
+    }
+
+    std::shared_ptr<CompositionTextStore> s(new CompositionTextStore());
+    s->map_addr_ = addr;
+    s->map_size_ = mapped;
+    s->fingerprint_ = std::move(stored_fp);
+    s->count_ = hdr.count;
+    s->ids_ = reinterpret_cast<const Hash*>(base + hdr.ids_offset);
+    s->offsets_ = reinterpret_cast<const uint64_t*>(base + hdr.offsets_offset);
+    s->flags_ = base + hdr.flags_offset;
+    s->blob_ = reinterpret_cast<const char*>(base + hdr.blob_offset);
+    return s;
+}
+
+void CompositionTextStore::write_file(const std::string& path) const {
+    TextHeader hdr{};
+    std::memcpy(hdr.magic, TEXT_MAGIC, 8);
+    hdr.version = TEXT_VERSION;
+    hdr.fingerprint_len = static_cast<uint32_t>(fingerprint_.size());
+    hdr.count = count_;
+    hdr.blob_bytes = text_bytes();
+    size_t size = layout_text(fingerprint_.size(), count_, hdr.blob_bytes, hdr);
+    hdr.file_size = size;
+
+    std::vector<uint8_t> buf(size, 0);
+    std::memcpy(buf.data() + TEXT_HEADER_BYTES, fingerprint_.data(), fingerprint_.size());
+    if (count_) {
+        std::memcpy(buf.data() + hdr.ids_offset, ids_, count_ * sizeof(Hash));
+        std::memcpy(buf.data() + hdr.offsets_offset, offsets_, (count_ + 1) * sizeof(uint64_t));
+        std::memcpy(buf.data() + hdr.flags_offset, flags_, count_);
+        std::memcpy(buf.data() + hdr.blob_offset, blob_, hdr.blob_bytes);
+    }
+    auto sum = BLAKE3Pipeline::hash(buf.data() + TEXT_HEADER_BYTES, size - TEXT_HEADER_BYTES);
+    std::memcpy(hdr.checksum, sum.data(), 16);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path());
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) throw std::runtime_error("Failed to create composition text store: " + tmp);
+    bool ok = std::fwrite(buf.data(), 1, size, f) == size;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to write composition text store: " + path);
+    }
+}
+
+std::shared_ptr<const CompositionTextStore> CompositionTextStore::load(PostgresConnection& db, const std::string& path) {
+    std::string fp = database_fingerprint(db);
+    if (!path.empty()) {
+        if (auto s = load_file(path, fp)) return s;
+    }
+    auto s = load_from_db(db);
+    if (!path.empty()) {
+        // A cache that cannot be written is not fatal; the store is still usable
+        try {
+            s->write_file(path);
+        } catch (const std::exception&) {
+        }
+    }
+    return s;
+}
+
+std::shared_ptr<const CompositionTextStore> CompositionTextStore::shared(PostgresConnection& db) {
+    static std::mutex mutex;
+    static std::shared_ptr<const CompositionTextStore> instance;
+    static MemoryGovernor::Account account =
+        MemoryGovernor::global().enroll("composition_text", MemoryGovernor::Priority::Pinned);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!instance) {
+        instance = load(db);
+        account.update(instance->heap_bytes());
+    }
+    return instance;
+}
+
+} // namespace Hartonomous
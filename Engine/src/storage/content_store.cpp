@@ -12,18 +12,11 @@ void ContentStore::store(const ContentRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.tenant_id);
-        row.add_uuid(rec.user_id);
-        row.add_uint16(rec.content_type);
-        row.add_bytes(rec.content_hash.data(), rec.content_hash.size());
-        row.add_uint64(rec.content_size);
-        row.add_text(rec.mime_type);
-        row.add_text(rec.language);
-        row.add_text(rec.source);
-        row.add_text(rec.encoding);
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Uuid, pgcopy::UInt16, pgcopy::Bytes,
+                                   pgcopy::UInt64, pgcopy::Text, pgcopy::Text, pgcopy::Text, pgcopy::Text>;
+        copy_.write_row<Row>(rec.id, rec.tenant_id, rec.user_id, rec.content_type,
+                             std::span<const uint8_t>(rec.content_hash.data(), rec.content_hash.size()),
+                             rec.content_size, rec.mime_type, rec.language, rec.source, rec.encoding);
     } else {
         copy_.add_row({
             hash_to_uuid(rec.id),
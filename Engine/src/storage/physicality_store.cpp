@@ -1,81 +1,126 @@
 #include <storage/physicality_store.hpp>
 #include <storage/format_utils.hpp>
-#include <endian.h>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <cstdio>
+#include <span>
+#include <sstream>
+#include <vector>
 
 namespace Hartonomous {
 
+namespace {
+
+// Little-endian ISO WKB, written in place into the COPY buffer
+struct PointZM : pgcopy::FixedField<37> {
+    using value_type = Eigen::Vector4d;
+    static constexpr size_t size(const value_type&) { return encoded; }
+    static uint8_t* encode(uint8_t* p, const value_type& pt) {
+        p = pgcopy::store_be32(p, 37);
+        *p++ = 0x01;
+        p = pgcopy::store_le32(p, 0xC0000001u);  // POINTZM
+        for (int i = 0; i < 4; ++i) p = pgcopy::store_le_double(p, pt[i]);
+        return p;
+    }
+};
+
+struct LineStringZM {
+    using value_type = std::span<const Eigen::Vector4d>;
+    static size_t size(const value_type& pts) { return 4 + 9 + 32 * pts.size(); }
+    static uint8_t* encode(uint8_t* p, const value_type& pts) {
+        p = pgcopy::store_be32(p, static_cast<uint32_t>(9 + 32 * pts.size()));
+        *p++ = 0x01;
+        p = pgcopy::store_le32(p, 0xC0000002u);  // LINESTRINGZM
+        p = pgcopy::store_le32(p, static_cast<uint32_t>(pts.size()));
+        for (const auto& pt : pts)
+            for (int i = 0; i < 4; ++i) p = pgcopy::store_le_double(p, pt[i]);
+        return p;
+    }
+};
+
+std::string linestring_wkt(std::span<const Eigen::Vector4d> pts) {
+    std::ostringstream ss; ss << "LINESTRINGZM(";
+    for (size_t i = 0; i < pts.size(); ++i) {
+        if (i > 0) ss << ",";
+        const auto& p = pts[i];
+        ss << std::fixed << std::setprecision(10) << p[0] << " " << p[1] << " " << p[2] << " " << p[3];
+    }
+    ss << ")";
+    return ss.str();
+}
+
+} // namespace
+
+void encode_hilbert_indices(std::vector<PhysicalityRecord>& recs, size_t from,
+                            hartonomous::spatial::HilbertCurve4D::EntityType type) {
+    if (from >= recs.size()) return;
+    size_t n = recs.size() - from;
+    thread_local std::vector<double> coords;
+    thread_local std::vector<HilbertIndex> indices;
+    coords.resize(4 * n);
+    indices.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        for (int k = 0; k < 4; ++k) coords[4 * i + k] = (recs[from + i].centroid[k] + 1.0) / 2.0;
+    hartonomous::spatial::HilbertCurve4D::encode_batch(coords.data(), n, indices.data(), type);
+    for (size_t i = 0; i < n; ++i) recs[from + i].hilbert_index = indices[i];
+}
+
 PhysicalityStore::PhysicalityStore(PostgresConnection& db, bool use_temp_table, bool use_binary)
-    : SubstrateStore(db, "hartonomous.physicality", {"id", "hilbert", "centroid", "trajectory"}, use_temp_table, use_binary) {}
+    : SubstrateStore(db, "hartonomous.physicality", {"id", "hilbert", "centroid", "trajectory", "trajectorypacked"},
+                     use_temp_table, use_binary) {}
 
 void PhysicalityStore::store(const PhysicalityRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
+    // Packed: the points go to trajectorypacked, trajectory keeps their bounding box as a diagonal.
+    // A two-point line is the same size as that diagonal, so it stays as it is
+    const bool packed = rec.trajectory.size() > 2 && trajectory_storage() != TrajectoryStorage::Geometry;
+    Eigen::Vector4d box[2];
+    if (packed) {
+        PackedTrajectory::encode(rec.trajectory, packed_);
+        PackedTrajectory::bounds(rec.trajectory, box[0], box[1]);
+    }
+
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.hilbert_index);
-        
-        // POINTZM Centroid
-        uint8_t wkb[37];
-        wkb[0] = 0x01;
-        uint32_t type_le = htole32(0xC0000001u);
-        std::memcpy(wkb + 1, &type_le, 4);
-        for (int i = 0; i < 4; ++i) {
-            double coord = rec.centroid[i];
-            uint64_t u; std::memcpy(&u, &coord, 8);
-            u = htole64(u); std::memcpy(wkb + 5 + i * 8, &u, 8);
-        }
-        row.add_bytes(wkb, 37);
-        
-        // Trajectory
+        // Trajectory: NULL when empty, the centroid point for a single atom
         if (rec.trajectory.empty()) {
-            row.add_null();
+            using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, PointZM, pgcopy::Null, pgcopy::Null>;
+            copy_.write_row<Row>(rec.id, rec.hilbert_index, rec.centroid, nullptr, nullptr);
         } else if (rec.trajectory.size() == 1) {
-            row.add_bytes(wkb, 37); // POINTZM
+            using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, PointZM, PointZM, pgcopy::Null>;
+            copy_.write_row<Row>(rec.id, rec.hilbert_index, rec.centroid, rec.centroid, nullptr);
+        } else if (packed) {
+            using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, PointZM, LineStringZM, pgcopy::Bytes>;
+            copy_.write_row<Row>(rec.id, rec.hilbert_index, rec.centroid, box, packed_);
         } else {
-            size_t size = 9 + (32 * rec.trajectory.size());
-            std::vector<uint8_t> traj_wkb(size);
-            traj_wkb[0] = 0x01;
-            uint32_t type = htole32(0xC0000002u); // LINESTRINGZM
-            std::memcpy(traj_wkb.data() + 1, &type, 4);
-            uint32_t num = htole32(static_cast<uint32_t>(rec.trajectory.size()));
-            std::memcpy(traj_wkb.data() + 5, &num, 4);
-            uint8_t* ptr = traj_wkb.data() + 9;
-            for (const auto& pt : rec.trajectory) {
-                for (int i=0; i<4; ++i) {
-                    double v = pt[i];
-                    uint64_t u; std::memcpy(&u, &v, 8);
-                    u = htole64(u); std::memcpy(ptr, &u, 8); ptr += 8;
-                }
-            }
-            row.add_bytes(traj_wkb.data(), size);
+            using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, PointZM, LineStringZM, pgcopy::Null>;
+            copy_.write_row<Row>(rec.id, rec.hilbert_index, rec.centroid, rec.trajectory, nullptr);
         }
-        copy_.add_row(row);
     } else {
         char centroid_wkt[128];
         snprintf(centroid_wkt, sizeof(centroid_wkt), "POINTZM(%.10f %.10f %.10f %.10f)",
             rec.centroid[0], rec.centroid[1], rec.centroid[2], rec.centroid[3]);
         
-        std::string traj_wkt;
-        if (rec.trajectory.size() > 1) {
-            std::ostringstream ss; ss << "LINESTRINGZM(";
-            for (size_t i = 0; i < rec.trajectory.size(); ++i) {
-                if (i > 0) ss << ",";
-                const auto& p = rec.trajectory[i];
-                ss << std::fixed << std::setprecision(10) << p[0] << " " << p[1] << " " << p[2] << " " << p[3];
+        std::string traj_wkt, packed_hex;
+        if (packed) {
+            traj_wkt = linestring_wkt(box);
+            static constexpr char HEX[] = "0123456789abcdef";
+            packed_hex = "\\x";
+            for (uint8_t b : packed_) {
+                packed_hex += HEX[b >> 4];
+                packed_hex += HEX[b & 0xF];
             }
-            ss << ")"; traj_wkt = ss.str();
+        } else if (rec.trajectory.size() > 1) {
+            traj_wkt = linestring_wkt(rec.trajectory);
         }
 
         copy_.add_row({
             hash_to_uuid(rec.id),
             hash_to_uuid(rec.hilbert_index),
             centroid_wkt,
-            traj_wkt.empty() ? (rec.trajectory.size() == 1 ? centroid_wkt : "\\N") : traj_wkt
+            traj_wkt.empty() ? (rec.trajectory.size() == 1 ? centroid_wkt : "\\N") : traj_wkt,
+            packed_hex
         });
     }
 }
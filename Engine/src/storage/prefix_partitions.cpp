@@ -0,0 +1,28 @@
+#include <storage/prefix_partitions.hpp>
+#include <bit>
+#include <mutex>
+#include <unordered_map>
+
+namespace Hartonomous {
+
+unsigned PrefixPartitions::bits(PostgresConnection& db, const std::string& table) {
+    static std::mutex mu;
+    static std::unordered_map<std::string, unsigned> known;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = known.find(table);
+        if (it != known.end()) return it->second;
+    }
+
+    // Only the layout create_prefix_partitions() builds counts: 2^N children
+    size_t children = 0;
+    db.query("SELECT count(*) FROM pg_inherits WHERE inhparent = to_regclass('hartonomous." + table + "')",
+             [&](const std::vector<std::string>& row) { children = std::stoull(row[0]); });
+    unsigned b = (children > 1 && children <= 256 && std::has_single_bit(children))
+        ? static_cast<unsigned>(std::countr_zero(children)) : 0;
+
+    std::lock_guard<std::mutex> lock(mu);
+    return known.emplace(table, b).first->second;
+}
+
+} // namespace Hartonomous
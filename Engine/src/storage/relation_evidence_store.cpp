@@ -12,14 +12,9 @@ void RelationEvidenceStore::store(const RelationEvidenceRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.content_id);
-        row.add_uuid(rec.relation_id);
-        row.add_bool(rec.is_valid);
-        row.add_double(rec.source_rating);
-        row.add_double(rec.signal_strength);
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Uuid, pgcopy::Bool, pgcopy::Float8, pgcopy::Float8>;
+        copy_.write_row<Row>(rec.id, rec.content_id, rec.relation_id, rec.is_valid,
+                             rec.source_rating, rec.signal_strength);
     } else {
         copy_.add_row({
             hash_to_uuid(rec.id),
@@ -14,10 +14,7 @@ void RelationStore::store(const RelationRecord& rec) {
     if (is_duplicate(rec.id)) return;
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.physicality_id);
-        copy_.add_row(row);
+        copy_.write_row<pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid>>(rec.id, rec.physicality_id);
     } else {
         copy_.add_row({hash_to_uuid(rec.id), hash_to_uuid(rec.physicality_id)});
     }
@@ -41,13 +38,8 @@ void RelationSequenceStore::store(const RelationSequenceRecord& rec) {
     seen_seq_.insert(key);
 
     if (use_binary_) {
-        BulkCopy::BinaryRow row;
-        row.add_uuid(rec.id);
-        row.add_uuid(rec.relation_id);
-        row.add_uuid(rec.composition_id);
-        row.add_uint32(rec.ordinal);
-        row.add_uint32(rec.occurrences);
-        copy_.add_row(row);
+        using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::Uuid, pgcopy::Uuid, pgcopy::UInt32, pgcopy::UInt32>;
+        copy_.write_row<Row>(rec.id, rec.relation_id, rec.composition_id, rec.ordinal, rec.occurrences);
     } else {
         copy_.add_row({
             hash_to_uuid(rec.id),
@@ -68,7 +60,8 @@ RelationRatingStore::RelationRatingStore(PostgresConnection& db, bool use_binary
                      {"relationid", "observations", "ratingvalue", "kfactor"}, 
                      true, use_binary) 
 {
-    // Ratings use temp table by default for ON CONFLICT aggregation
+    // Ratings use temp table by default for ON CONFLICT aggregation; keep in
+    // step with RelationRatingRecord::merge, which store() applies first
     copy_.set_conflict_clause(
         "ON CONFLICT (relationid) DO UPDATE SET "
         "observations = hartonomous.relationrating.observations + EXCLUDED.observations, "
@@ -76,25 +69,18 @@ RelationRatingStore::RelationRatingStore(PostgresConnection& db, bool use_binary
         "modifiedat = NOW()");
 }
 
+// Each relation reaches the COPY once per flush, so the upsert never meets a
+// relation twice in one statement
 void RelationRatingStore::store(const RelationRatingRecord& rec) {
-    auto it = pending_.find(rec.relation_id);
-    if (it == pending_.end()) {
-        pending_[rec.relation_id] = rec;
-    } else {
-        it->second.observations += rec.observations;
-        it->second.rating_value = rec.rating_value;
-    }
+    auto [r, inserted] = pending_.try_emplace(rec.relation_id, rec);
+    if (!inserted) r->merge(rec);
 }
 
 void RelationRatingStore::emit_pending() {
-    for (const auto& [id, r] : pending_) {
+    pending_.for_each([&](const BLAKE3Pipeline::Hash&, const RelationRatingRecord& r) {
         if (use_binary_) {
-            BulkCopy::BinaryRow row;
-            row.add_uuid(r.relation_id);
-            row.add_uint64(r.observations);
-            row.add_double(r.rating_value);
-            row.add_double(r.k_factor);
-            copy_.add_row(row);
+            using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::UInt64, pgcopy::Float8, pgcopy::Float8>;
+            copy_.write_row<Row>(r.relation_id, r.observations, r.rating_value, r.k_factor);
         } else {
             copy_.add_row({
                 hash_to_uuid(r.relation_id),
@@ -103,7 +89,7 @@ void RelationRatingStore::emit_pending() {
                 std::to_string(r.k_factor)
             });
         }
-    }
+    });
     pending_.clear();
 }
 
@@ -9,7 +9,6 @@
 #include <iostream>
 #include <algorithm>
 #include <thread>
-#include <bitset> // Added missing header
 #include <cstring>
 #include <nlohmann/json.hpp>
 
@@ -17,6 +16,51 @@ using json = nlohmann::json;
 
 namespace Hartonomous::unicode {
 
+namespace {
+
+struct AtomSeed {
+    uint32_t codepoint;
+    Eigen::Vector4d position;
+    BLAKE3Pipeline::Hash phys_hash;
+    BLAKE3Pipeline::Hash atom_hash;
+    std::array<uint8_t, 16> hidx;
+};
+
+// IDs and Hilbert indices of seeds[begin, end) from their positions. Both
+// IDs hash fixed-size messages (the position's 32 bytes, the codepoint's 4),
+// so they go through BLAKE3 a SIMD batch at a time.
+void finish_seeds(std::vector<AtomSeed>& seeds, size_t begin, size_t end) {
+    const size_t n = end - begin;
+    thread_local std::vector<uint8_t> bytes;
+    thread_local std::vector<BLAKE3Pipeline::Hash> hashes;
+    thread_local std::vector<double> coords;
+    thread_local std::vector<hartonomous::spatial::HilbertCurve4D::HilbertIndex> hidx;
+    bytes.resize(n * 32);
+    hashes.resize(n);
+    coords.resize(n * 4);
+    hidx.resize(n);
+
+    for (size_t i = 0; i < n; ++i) std::memcpy(bytes.data() + 32 * i, seeds[begin + i].position.data(), 32);
+    BLAKE3Pipeline::hash_many_fixed(bytes.data(), 32, 32, n, hashes.data());
+    for (size_t i = 0; i < n; ++i) seeds[begin + i].phys_hash = hashes[i];
+
+    // Little-endian, as hash_codepoint hashes it
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t cp = seeds[begin + i].codepoint;
+        for (int k = 0; k < 4; ++k) bytes[4 * i + k] = static_cast<uint8_t>(cp >> (8 * k));
+    }
+    BLAKE3Pipeline::hash_many_fixed(bytes.data(), 4, 4, n, hashes.data());
+    for (size_t i = 0; i < n; ++i) seeds[begin + i].atom_hash = hashes[i];
+
+    for (size_t i = 0; i < n; ++i)
+        for (int k = 0; k < 4; ++k) coords[i * 4 + k] = (seeds[begin + i].position[k] + 1.0) / 2.0;
+    hartonomous::spatial::HilbertCurve4D::encode_batch(coords.data(), n, hidx.data(),
+                                                      hartonomous::spatial::HilbertCurve4D::EntityType::Atom);
+    for (size_t i = 0; i < n; ++i) seeds[begin + i].hidx = hidx[i];
+}
+
+} // namespace
+
 UCDProcessor::UCDProcessor(const std::string& data_dir, PostgresConnection& db)
     : parser_(data_dir), db_(db) {}
 
@@ -50,8 +94,7 @@ void UCDProcessor::process_and_ingest() {
 
     std::cout << "[5/5] Finalizing Atoms + Physicality..." << std::flush;
     t.reset();
-    ingest_assigned_codepoints();
-    ingest_unassigned_codepoints();
+    ingest_atoms();
     std::cout << " (" << t.elapsed_sec() << "s)" << std::endl;
     
     std::cout << "✓ Unicode seeding complete in " << pipeline_timer.elapsed_sec() << "s." << std::endl;
@@ -97,116 +140,77 @@ void UCDProcessor::ingest_metadata() {
     txn.commit();
 }
 
-void UCDProcessor::ingest_assigned_codepoints() {
-    PostgresConnection::Transaction txn(db_);
-    
-    struct Record {
-        uint32_t codepoint;
-        Eigen::Vector4d position;
-        BLAKE3Pipeline::Hash phys_hash;
-        BLAKE3Pipeline::Hash atom_hash;
-        std::array<uint8_t, 16> hidx;
-    };
-    std::vector<Record> records;
-    records.reserve(sorted_codepoints_.size());
+void UCDProcessor::ingest_atoms() {
+    constexpr uint32_t CODESPACE = NodeGenerator::UNICODE_TOTAL;
+    constexpr size_t BLOCK = 4096;
 
+    // Sequence order: assigned codepoints as sequenced, then the unassigned ascending
+    std::vector<AtomSeed> seeds(CODESPACE);
+    std::vector<uint8_t> assigned(CODESPACE, 0);
+    size_t n = 0;
     for (auto* meta : sorted_codepoints_) {
-        std::vector<uint8_t> pdata(sizeof(double) * 4);
-        std::memcpy(pdata.data(), meta->position.data(), sizeof(double) * 4);
-        auto phys_hash = BLAKE3Pipeline::hash(pdata.data(), pdata.size());
-        auto atom_hash = BLAKE3Pipeline::hash_codepoint(meta->codepoint);
-
-        Eigen::Vector4d hc = (meta->position.array() + 1.0) / 2.0;
-        auto hidx = hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Atom);
-        
-        records.push_back({meta->codepoint, meta->position, phys_hash, atom_hash, hidx});
+        assigned[meta->codepoint] = 1;
+        seeds[n].codepoint = meta->codepoint;
+        seeds[n++].position = meta->position;
+    }
+    const size_t n_assigned = n;
+    for (uint32_t cp = 0; cp < CODESPACE; ++cp)
+        if (!assigned[cp]) seeds[n++].codepoint = cp;
+
+    const auto blocks = static_cast<int64_t>((CODESPACE + BLOCK - 1) / BLOCK);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t b = 0; b < blocks; ++b) {
+        const size_t begin = static_cast<size_t>(b) * BLOCK;
+        const size_t end = std::min<size_t>(begin + BLOCK, CODESPACE);
+        for (size_t i = std::max(begin, n_assigned); i < end; ++i)
+            seeds[i].position = NodeGenerator::generate_node(i, NodeGenerator::UNICODE_TOTAL);
+        finish_seeds(seeds, begin, end);
+    }
+
+    // An empty substrate is loaded by binary COPY straight into the tables,
+    // with their secondary indexes dropped for the load and rebuilt in the
+    // same transaction. A partial earlier seed goes through staging and
+    // ON CONFLICT instead.
+    const bool fresh = db_.query_single(
+        "SELECT NOT EXISTS (SELECT 1 FROM hartonomous.atom) AND NOT EXISTS (SELECT 1 FROM hartonomous.physicality)") == "t";
+
+    PostgresConnection::Transaction txn(db_);
+    std::vector<std::string> index_defs;
+    if (fresh) {
+        db_.execute("SET LOCAL synchronous_commit = off");
+        db_.execute("SET LOCAL maintenance_work_mem = '1GB'");
+        std::vector<std::string> index_names;
+        db_.query("SELECT i.indexrelid::regclass::text, pg_get_indexdef(i.indexrelid) "
+                  "FROM pg_index i JOIN pg_class c ON c.oid = i.indrelid "
+                  "JOIN pg_namespace ns ON ns.oid = c.relnamespace "
+                  "WHERE ns.nspname = 'hartonomous' AND c.relname IN ('atom', 'physicality') "
+                  "AND NOT EXISTS (SELECT 1 FROM pg_constraint k WHERE k.conindid = i.indexrelid)",
+                  [&](const std::vector<std::string>& row) {
+                      index_names.push_back(row[0]);
+                      index_defs.push_back(row[1]);
+                  });
+        for (const auto& name : index_names) db_.execute("DROP INDEX " + name);
     }
 
     {
-        PhysicalityStore phys_store(db_, true, true);
-        for (const auto& rec : records) {
-             phys_store.store({rec.phys_hash, rec.hidx, rec.position, {rec.position}});
-        }
+        PhysicalityStore phys_store(db_, !fresh, true);
+        for (const auto& seed : seeds)
+            phys_store.store({seed.phys_hash, seed.hidx, seed.position, {seed.position}});
         phys_store.flush();
     }
-
     {
-        AtomStore atom_store(db_, false, true);
-        for (const auto& rec : records) {
-            atom_store.store({rec.atom_hash, rec.phys_hash, rec.codepoint});
-        }
+        AtomStore atom_store(db_, !fresh, true);
+        for (const auto& seed : seeds)
+            atom_store.store({seed.atom_hash, seed.phys_hash, seed.codepoint});
         atom_store.flush();
     }
 
+    for (const auto& def : index_defs) db_.execute(def);
     txn.commit();
-}
 
-void UCDProcessor::ingest_unassigned_codepoints() {
-    constexpr uint32_t MAX_CP = 0x10FFFF;
-    constexpr size_t BATCH = 100000;
-    std::bitset<MAX_CP + 1> assigned;
-    for (auto* meta : sorted_codepoints_) assigned.set(meta->codepoint);
-
-    size_t total_unassigned = (MAX_CP + 1) - sorted_codepoints_.size();
-    uint32_t base_seq = static_cast<uint32_t>(sorted_codepoints_.size());
-    size_t total_processed = 0;
-
-    struct Record {
-        uint32_t codepoint;
-        Eigen::Vector4d position;
-        BLAKE3Pipeline::Hash phys_hash;
-        BLAKE3Pipeline::Hash atom_hash;
-        std::array<uint8_t, 16> hidx;
-    };
-    std::vector<Record> batch_records;
-    batch_records.reserve(BATCH);
-
-    for (uint32_t cp_start = 0; cp_start <= MAX_CP; cp_start += BATCH) {
-        batch_records.clear();
-
-        for (uint32_t cp = cp_start; cp < std::min(cp_start + (uint32_t)BATCH, MAX_CP + 1); ++cp) {
-            if (assigned.test(cp)) continue;
-
-            uint32_t seq = base_seq + (uint32_t)total_processed++;
-            Eigen::Vector4d pos = NodeGenerator::generate_node(seq, NodeGenerator::UNICODE_TOTAL);
-
-            std::vector<uint8_t> pdata(sizeof(double) * 4);
-            std::memcpy(pdata.data(), pos.data(), sizeof(double) * 4);
-            auto phys_hash = BLAKE3Pipeline::hash(pdata.data(), pdata.size());
-            auto atom_hash = BLAKE3Pipeline::hash_codepoint(cp);
-
-            Eigen::Vector4d hc = (pos.array() + 1.0) / 2.0;
-            auto hidx = hartonomous::spatial::HilbertCurve4D::encode(hc, hartonomous::spatial::HilbertCurve4D::EntityType::Atom);
-
-            batch_records.push_back({cp, pos, phys_hash, atom_hash, hidx});
-        }
-
-        if (batch_records.empty()) continue;
-
-        PostgresConnection::Transaction txn(db_);
-
-        {
-            PhysicalityStore phys_store(db_, true, true);
-            for (const auto& rec : batch_records) {
-                phys_store.store({rec.phys_hash, rec.hidx, rec.position, {rec.position}});
-            }
-            phys_store.flush();
-        }
-
-        {
-            AtomStore atom_store(db_, false, true);
-            for (const auto& rec : batch_records) {
-                atom_store.store({rec.atom_hash, rec.phys_hash, rec.codepoint});
-            }
-            atom_store.flush();
-        }
-
-        txn.commit();
-
-        size_t pct = (total_processed * 100) / total_unassigned;
-        std::cout << "\r  Progress: " << pct << "% (" << total_processed << "/" << total_unassigned << ")" << std::flush;
-    }
-    std::cout << "\r  Inserted " << total_processed << " unassigned codepoints.        " << std::endl;
+    std::cout << "\n  Inserted " << n_assigned << " assigned and " << CODESPACE - n_assigned << " unassigned codepoints"
+              << (fresh ? " (direct COPY, " + std::to_string(index_defs.size()) + " indexes rebuilt)" : " (staged)")
+              << std::flush;
 }
 
 } // namespace Hartonomous::unicode
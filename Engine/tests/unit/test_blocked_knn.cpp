@@ -0,0 +1,61 @@
+/**
+ * @file test_blocked_knn.cpp
+ * @brief Blocked GEMM top-k against a brute-force reference
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/blocked_knn.hpp>
+#include <algorithm>
+#include <random>
+
+using namespace Hartonomous;
+
+static Eigen::MatrixXf random_unit_rows(size_t rows, size_t dim, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> g;
+    Eigen::MatrixXf X(rows, dim);
+    for (Eigen::Index i = 0; i < X.size(); ++i) X.data()[i] = g(rng);
+    X.rowwise().normalize();
+    return X;
+}
+
+TEST(BlockedKnnTest, MatchesBruteForceAcrossTileEdges) {
+    const size_t n = 700, dim = 24, k = 5;
+    const float threshold = 0.2f;
+    auto X = random_unit_rows(n, dim, 7);
+    Eigen::MatrixXf S = X * X.transpose();
+
+    // Tiles that do not divide n, to cover the ragged last tile on both axes
+    auto knn = blocked_knn(X, X, k, threshold, true, {96, 128});
+    ASSERT_EQ(knn.rows(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<std::pair<float, uint32_t>> ref;
+        for (size_t j = 0; j < n; ++j)
+            if (j != i && S(i, j) >= threshold) ref.push_back({S(i, j), static_cast<uint32_t>(j)});
+        std::sort(ref.begin(), ref.end(), [](auto& a, auto& b) { return a.first > b.first; });
+        ref.resize(std::min(ref.size(), k));
+
+        ASSERT_EQ(knn.count[i], ref.size()) << "row " << i;
+        for (size_t m = 0; m < ref.size(); ++m) {
+            EXPECT_NEAR(knn.similarity[i * k + m], ref[m].first, 1e-5f);
+            if (m > 0) EXPECT_GE(knn.similarity[i * k + m - 1], knn.similarity[i * k + m]);
+        }
+    }
+}
+
+TEST(BlockedKnnTest, AsymmetricKeepsSelfAndChecksDims) {
+    auto Q = random_unit_rows(50, 8, 1);
+    auto knn = blocked_knn(Q, Q, 1, -1.0f, false);
+    for (size_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(knn.count[i], 1u);
+        EXPECT_EQ(knn.index[i], i);  // A unit vector's best match is itself
+    }
+
+    auto K = random_unit_rows(10, 9, 2);
+    EXPECT_THROW(blocked_knn(Q, K, 3, 0.0f, false), std::runtime_error);
+
+    auto tiles = blocked_knn_tiles(4096, 2u << 20);
+    EXPECT_GE(tiles.key_rows, 64u);
+    EXPECT_EQ(tiles.key_rows % 64, 0u);
+}
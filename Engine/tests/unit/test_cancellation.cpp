@@ -0,0 +1,43 @@
+/**
+ * @file test_cancellation.cpp
+ * @brief CancellationToken hooks across threads
+ */
+
+#include <gtest/gtest.h>
+#include <utils/cancellation.hpp>
+#include <atomic>
+#include <thread>
+
+using namespace Hartonomous;
+
+TEST(CancellationTest, HooksRunOnceAndAfterCancel) {
+    CancellationToken token;
+    int runs = 0, removed = 0;
+    token.add_hook([&] { ++runs; });
+    size_t id = token.add_hook([&] { ++removed; });
+    token.remove_hook(id);
+    EXPECT_FALSE(token.cancelled());
+    EXPECT_NO_THROW(token.throw_if_cancelled());
+
+    token.cancel();
+    token.cancel();
+    EXPECT_TRUE(token.cancelled());
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(removed, 0);
+    EXPECT_THROW(token.throw_if_cancelled(), OperationCancelled);
+
+    // Registered too late: runs right away
+    token.add_hook([&] { ++runs; });
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(CancellationTest, CancelFromAnotherThread) {
+    auto token = std::make_shared<CancellationToken>();
+    std::atomic<int> hooked{0};
+    token->add_hook([&] { hooked++; });
+
+    std::thread canceller([token] { token->cancel(); });
+    while (!token->cancelled()) std::this_thread::yield();
+    canceller.join();
+    EXPECT_EQ(hooked.load(), 1);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file test_centroid_index.cpp
+ * @brief Incremental centroid HNSW against brute-force nearest neighbors
+ */
+
+#include <gtest/gtest.h>
+#include <query/centroid_index.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace Hartonomous;
+using Vec4 = Eigen::Vector4d;
+
+static Vec4 random_unit(std::mt19937& rng) {
+    std::normal_distribution<double> g;
+    return Vec4(g(rng), g(rng), g(rng), g(rng)).normalized();
+}
+
+static BLAKE3Pipeline::Hash id_of(size_t i) {
+    BLAKE3Pipeline::Hash h{};
+    std::memcpy(h.data(), &i, sizeof(i));
+    return h;
+}
+
+TEST(CentroidIndexTest, IncrementalAddsMatchBruteForce) {
+    std::mt19937 rng(21);
+    std::vector<Vec4> points(3000);
+    for (auto& p : points) p = random_unit(rng);
+
+    // Two batches and single adds, growing past the initial capacity
+    CentroidIndex index;
+    std::vector<std::pair<BLAKE3Pipeline::Hash, Vec4>> batch;
+    for (size_t i = 0; i < 1500; ++i) batch.emplace_back(id_of(i), points[i]);
+    EXPECT_EQ(index.add(batch), 1500u);
+    EXPECT_EQ(index.add(batch), 0u);
+    batch.clear();
+    for (size_t i = 1500; i < 2900; ++i) batch.emplace_back(id_of(i), points[i]);
+    EXPECT_EQ(index.add(batch), 1400u);
+    for (size_t i = 2900; i < points.size(); ++i) EXPECT_TRUE(index.add(id_of(i), points[i]));
+    EXPECT_FALSE(index.add(id_of(0), points[0]));
+    ASSERT_EQ(index.size(), points.size());
+    EXPECT_TRUE(index.contains(id_of(2999)));
+    EXPECT_FALSE(index.contains(id_of(points.size())));
+
+    size_t exact = 0;
+    const int queries = 200;
+    for (int q = 0; q < queries; ++q) {
+        Vec4 c = random_unit(rng);
+        size_t best = 0;
+        for (size_t i = 1; i < points.size(); ++i)
+            if (c.dot(points[i]) > c.dot(points[best])) best = i;
+
+        auto hits = index.nearest(c, 3);
+        ASSERT_EQ(hits.size(), 3u);
+        EXPECT_LE(hits[0].distance, hits[1].distance);
+        EXPECT_LE(hits[1].distance, hits[2].distance);
+        if (hits[0].id == id_of(best)) {
+            ++exact;
+            EXPECT_NEAR(hits[0].distance, std::acos(std::clamp(c.dot(points[best]), -1.0, 1.0)), 1e-12);
+        }
+    }
+    EXPECT_GE(exact, static_cast<size_t>(queries * 0.98));
+}
+
+TEST(CentroidIndexTest, EmptyIndex) {
+    CentroidIndex index;
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_TRUE(index.nearest(Vec4(1, 0, 0, 0), 5).empty());
+}
@@ -0,0 +1,64 @@
+/**
+ * @file test_codepoint_batch.cpp
+ * @brief Batch S³ projection and grouped centroids behind the SQL array functions
+ */
+
+#include <gtest/gtest.h>
+#include <interop_api.h>
+#include <unicode/codepoint_projection.hpp>
+#include <geometry/s3_centroid.hpp>
+#include <vector>
+
+using hartonomous::unicode::CodepointProjection;
+
+TEST(CodepointBatchTest, S3PositionsMatchProject) {
+    std::vector<uint32_t> cps = {'a', 'Z', 0x4F60, 0x10FFFF, 0};
+    std::vector<double> coords(4 * cps.size());
+    CodepointProjection::s3_positions(cps.data(), cps.size(), coords.data());
+    for (size_t i = 0; i < cps.size(); ++i) {
+        auto p = CodepointProjection::project(cps[i]);
+        for (int k = 0; k < 4; ++k) EXPECT_EQ(coords[4 * i + k], p.s3_position[k]);
+    }
+}
+
+TEST(CodepointBatchTest, PrecomputedTableMatchesProject) {
+    const double* table = CodepointProjection::precompute_s3_table();
+    for (uint32_t cp : {0u, 0x61u, 0xD800u, 0x4F60u, 0xFFFFFu, 0x10FFFFu}) {
+        auto p = CodepointProjection::project(cp);
+        for (int k = 0; k < 4; ++k) EXPECT_EQ(table[4 * cp + k], p.s3_position[k]) << cp;
+    }
+
+    // Both entry points now read the table
+    const uint32_t cp = 0x1F600;
+    double batch[4], single[4];
+    CodepointProjection::s3_positions(&cp, 1, batch);
+    ASSERT_TRUE(hartonomous_codepoint_to_s3(cp, single));
+    for (int k = 0; k < 4; ++k) {
+        EXPECT_EQ(batch[k], table[4 * cp + k]);
+        EXPECT_EQ(single[k], table[4 * cp + k]);
+    }
+}
+
+TEST(CodepointBatchTest, InvalidCodepointFailsWholeBatch) {
+    std::vector<uint32_t> cps = {'a', 0x110000};
+    std::vector<double> coords(4 * cps.size());
+    EXPECT_THROW(CodepointProjection::s3_positions(cps.data(), cps.size(), coords.data()), std::invalid_argument);
+    EXPECT_FALSE(hartonomous_codepoints_to_s3(cps.data(), cps.size(), coords.data()));
+}
+
+TEST(CodepointBatchTest, GroupedCentroidsMatchSingle) {
+    std::vector<uint32_t> cps = {'h', 'e', 'l', 'l', 'o', 'w', 'o', 'r', 'l', 'd'};
+    std::vector<double> points(4 * cps.size());
+    ASSERT_TRUE(hartonomous_codepoints_to_s3(cps.data(), cps.size(), points.data()));
+
+    std::vector<size_t> counts = {5, 0, 5};
+    std::vector<double> centroids(4 * counts.size());
+    hartonomous_s3_compute_centroids(points.data(), counts.data(), counts.size(), centroids.data());
+
+    auto first = Hartonomous::Geometry::compute_s3_centroid(points.data(), 5);
+    auto last = Hartonomous::Geometry::compute_s3_centroid(points.data() + 20, 5);
+    for (int k = 0; k < 4; ++k) {
+        EXPECT_EQ(centroids[k], first[k]);
+        EXPECT_EQ(centroids[8 + k], last[k]);
+    }
+}
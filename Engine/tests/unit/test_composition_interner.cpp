@@ -0,0 +1,82 @@
+/**
+ * @file test_composition_interner.cpp
+ * @brief Unit tests for CompositionInterner and SearchArena
+ */
+
+#include <gtest/gtest.h>
+#include <hashing/composition_interner.hpp>
+#include <cognitive/search_arena.hpp>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+static BLAKE3Pipeline::Hash key(uint32_t i) {
+    BLAKE3Pipeline::Hash h{};
+    std::memcpy(h.data(), &i, 4);
+    return h;
+}
+
+TEST(CompositionInternerTest, DenseStableIds) {
+    CompositionInterner interner;
+    EXPECT_EQ(interner.find(key(7)), CompositionInterner::NPOS);
+
+    uint32_t a = interner.intern(key(7));
+    uint32_t b = interner.intern(key(8));
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 1u);
+    EXPECT_EQ(interner.intern(key(7)), a);
+    EXPECT_EQ(interner.find(key(8)), b);
+    EXPECT_EQ(interner.hash_of(a), key(7));
+    EXPECT_EQ(interner.size(), 2u);
+}
+
+TEST(CompositionInternerTest, ConcurrentInternAgrees) {
+    CompositionInterner interner;
+    constexpr uint32_t N = 200000;  // Spans several reverse-table chunks
+    constexpr int THREADS = 4;
+
+    std::vector<std::vector<uint32_t>> ids(THREADS, std::vector<uint32_t>(N));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (uint32_t i = 0; i < N; ++i) ids[t][i] = interner.intern(key(i));
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(interner.size(), N);
+    for (uint32_t i = 0; i < N; ++i) {
+        for (int t = 1; t < THREADS; ++t) ASSERT_EQ(ids[t][i], ids[0][i]);
+        ASSERT_EQ(interner.hash_of(ids[0][i]), key(i));
+    }
+}
+
+TEST(SearchArenaTest, SlotsAndHeap) {
+    SearchArena arena;
+    for (int round = 0; round < 2; ++round) {  // Second round reuses the storage
+        arena.reset();
+        EXPECT_EQ(arena.find(42), SearchArena::NONE);
+
+        for (uint32_t id = 0; id < 5000; ++id) {
+            auto [slot, inserted] = arena.touch(id * 7919u);
+            ASSERT_TRUE(inserted);
+            ASSERT_EQ(slot, id);
+            arena.push(static_cast<double>((id * 37) % 101), slot);
+        }
+        EXPECT_FALSE(arena.touch(7919u).second);
+        EXPECT_EQ(arena.find(7919u * 3), 3u);
+        EXPECT_EQ(arena.parent[3], SearchArena::NONE);
+
+        double last = -1.0;
+        size_t popped = 0;
+        while (!arena.open_empty()) {
+            auto e = arena.pop();
+            ASSERT_GE(e.f, last);
+            last = e.f;
+            ++popped;
+        }
+        EXPECT_EQ(popped, 5000u);
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * @file test_composition_resolver.cpp
+ * @brief Unit tests for the spellings CompositionResolver probes
+ *
+ * The probe itself needs a database; this checks the variant order that
+ * decides which stored spelling wins.
+ */
+
+#include <gtest/gtest.h>
+#include <query/composition_resolver.hpp>
+
+using namespace Hartonomous;
+
+TEST(CompositionResolverTest, ExactSpellingComesFirst) {
+    auto v = CompositionResolver::variants("Whale");
+    ASSERT_FALSE(v.empty());
+    EXPECT_EQ(v[0], "Whale");
+    EXPECT_EQ(v, (std::vector<std::string>{"Whale", "whale", "WHALE"}));
+}
+
+TEST(CompositionResolverTest, CaseVariantsBeforeTrimmedForms) {
+    auto v = CompositionResolver::variants("  ahab's,  ship! ");
+    EXPECT_EQ(v, (std::vector<std::string>{
+        "  ahab's,  ship! ", "  AHAB'S,  SHIP! ",
+        "ahab's, ship", "Ahab's, ship", "AHAB'S, SHIP"}));
+}
+
+TEST(CompositionResolverTest, NonAsciiBytesKept) {
+    auto v = CompositionResolver::variants("\xC3\xA9t\xC3\xA9");  // "été"
+    EXPECT_EQ(v, (std::vector<std::string>{"\xC3\xA9t\xC3\xA9", "\xC3\xA9T\xC3\xA9"}));
+}
+
+TEST(CompositionResolverTest, PunctuationOnlyHasNoTrimmedForm) {
+    EXPECT_EQ(CompositionResolver::variants("..."), (std::vector<std::string>{"..."}));
+    EXPECT_TRUE(CompositionResolver::variants("").empty());
+}
@@ -0,0 +1,80 @@
+/**
+ * @file test_composition_text_store.cpp
+ * @brief Unit tests for the composition text blob store
+ *
+ * Builds stores from in-memory entries and round-trips them through
+ * snapshot files. No database needed.
+ */
+
+#include <gtest/gtest.h>
+#include <storage/composition_text_store.hpp>
+#include <cstdio>
+#include <filesystem>
+
+using namespace Hartonomous;
+
+static BLAKE3Pipeline::Hash H(const char* s) { return BLAKE3Pipeline::hash(std::string_view(s)); }
+
+TEST(CompositionTextStoreTest, LookupByIdIsSortedAndDeduplicated) {
+    auto store = CompositionTextStore::from_entries({
+        {H("whale"), "whale"},
+        {H("sea"), "sea"},
+        {H("empty"), ""},
+        {H("whale"), "duplicate"},
+        {H("naïve"), "naïve"},
+    });
+    EXPECT_EQ(store->size(), 4u);
+    EXPECT_EQ(store->text_bytes(), 5u + 3u + 6u);
+
+    EXPECT_EQ(store->lookup(H("whale")), "whale");
+    EXPECT_EQ(store->lookup(H("naïve")), "naïve");
+    EXPECT_EQ(store->lookup(H("empty")), "");
+    EXPECT_NE(store->index_of(H("empty")), CompositionTextStore::NPOS);
+    EXPECT_EQ(store->index_of(H("missing")), CompositionTextStore::NPOS);
+    EXPECT_TRUE(store->lookup(H("missing")).empty());
+
+    for (uint32_t i = 1; i < store->size(); ++i) EXPECT_LT(store->id_at(i - 1), store->id_at(i));
+}
+
+TEST(CompositionTextStoreTest, FileRoundTrip) {
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_text_store.bin").string();
+    auto store = CompositionTextStore::from_entries({{H("a"), "alpha"}, {H("b"), "beta"}}, "fp-1");
+    store->write_file(path);
+
+    EXPECT_EQ(CompositionTextStore::load_file(path, "fp-2"), nullptr);
+
+    auto mapped = CompositionTextStore::load_file(path, "fp-1");
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_TRUE(mapped->is_mapped());
+    EXPECT_EQ(mapped->size(), 2u);
+    EXPECT_EQ(mapped->lookup(H("a")), "alpha");
+    EXPECT_EQ(mapped->lookup(H("b")), "beta");
+    std::remove(path.c_str());
+}
+
+TEST(CompositionTextStoreTest, ClassifiesTextOnce) {
+    using S = CompositionTextStore;
+    EXPECT_EQ(S::classify(""), S::ARTIFACT);
+    EXPECT_EQ(S::classify("[PAD]"), S::ARTIFACT);
+    EXPECT_EQ(S::classify("[unused42]"), S::ARTIFACT);
+    EXPECT_EQ(S::classify("##ing"), S::ARTIFACT);
+    EXPECT_EQ(S::classify("#17"), S::ARTIFACT);
+    EXPECT_EQ(S::classify("The"), S::FUNCTION_WORD);
+    EXPECT_EQ(S::classify("themselves"), S::FUNCTION_WORD);
+    EXPECT_EQ(S::classify(","), S::PUNCTUATION);
+    EXPECT_EQ(S::classify("Ahab"), S::PROPER_NOUN);
+    EXPECT_EQ(S::classify("NASA"), 0);
+    EXPECT_EQ(S::classify("whale"), 0);
+
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_text_flags.bin").string();
+    auto store = S::from_entries({{H("ahab"), "Ahab"}, {H("of"), "of"}, {H("pad"), "[PAD]"}});
+    store->write_file(path);
+    auto mapped = S::load_file(path);
+    ASSERT_NE(mapped, nullptr);
+    for (auto* s : {store.get(), mapped.get()}) {
+        EXPECT_EQ(s->flags_at(s->index_of(H("ahab"))), S::PROPER_NOUN);
+        EXPECT_EQ(s->flags_at(s->index_of(H("of"))), S::FUNCTION_WORD);
+        EXPECT_EQ(s->flags_at(s->index_of(H("pad"))), S::ARTIFACT);
+    }
+    std::remove(path.c_str());
+}
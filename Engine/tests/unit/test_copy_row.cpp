@@ -0,0 +1,132 @@
+/**
+ * @file test_copy_row.cpp
+ * @brief Unit tests for binary COPY field codecs and row schemas
+ *
+ * Checks the exact wire bytes produced by pgcopy::Schema and that
+ * BulkCopy::BinaryRow encodes identically. No database needed.
+ */
+
+#include <gtest/gtest.h>
+#include <database/bulk_copy.hpp>
+#include <storage/composition_store.hpp>
+#include <storage/physicality_store.hpp>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(CopyRowTest, FixedWidthSchemaBytes) {
+    using Row = pgcopy::Schema<pgcopy::Int32, pgcopy::UInt16, pgcopy::Bool, pgcopy::Null>;
+    static_assert(Row::field_count == 4);
+    EXPECT_EQ(Row::size(-2, 0x1234, true, nullptr), 2u + 8 + 6 + 5 + 4);
+
+    std::vector<uint8_t> buf(Row::size(-2, 0x1234, true, nullptr));
+    uint8_t* end = Row::encode(buf.data(), -2, 0x1234, true, nullptr);
+    ASSERT_EQ(end, buf.data() + buf.size());
+
+    std::vector<uint8_t> expected = {
+        0x00, 0x04,                                      // field count
+        0x00, 0x00, 0x00, 0x04, 0xFF, 0xFF, 0xFF, 0xFE,  // int32 -2
+        0x00, 0x00, 0x00, 0x02, 0x12, 0x34,              // uint16 bytea
+        0x00, 0x00, 0x00, 0x01, 0x01,                    // bool
+        0xFF, 0xFF, 0xFF, 0xFF                           // NULL
+    };
+    EXPECT_EQ(buf, expected);
+}
+
+TEST(CopyRowTest, Float8AndUInt64AreBigEndian) {
+    using Row = pgcopy::Schema<pgcopy::Float8, pgcopy::UInt64>;
+    std::vector<uint8_t> buf(Row::size(1.0, 0x0102030405060708ull));
+    Row::encode(buf.data(), 1.0, 0x0102030405060708ull);
+
+    std::vector<uint8_t> expected = {
+        0x00, 0x02,
+        0x00, 0x00, 0x00, 0x08, 0x3F, 0xF0, 0, 0, 0, 0, 0, 0,
+        0x00, 0x00, 0x00, 0x08, 1, 2, 3, 4, 5, 6, 7, 8
+    };
+    EXPECT_EQ(buf, expected);
+}
+
+TEST(CopyRowTest, BinaryRowMatchesSchema) {
+    std::array<uint8_t, 16> id{};
+    for (int i = 0; i < 16; ++i) id[i] = static_cast<uint8_t>(i * 11);
+
+    BulkCopy::BinaryRow row;
+    row.add_uuid(id);
+    row.add_uint32(7);
+    row.add_double(-0.5);
+    row.add_text("abc");
+
+    using Row = pgcopy::Schema<pgcopy::Uuid, pgcopy::UInt32, pgcopy::Float8, pgcopy::Text>;
+    std::vector<uint8_t> buf(Row::size(id, 7, -0.5, "abc"));
+    Row::encode(buf.data(), id, 7, -0.5, "abc");
+
+    ASSERT_EQ(row.num_fields, Row::field_count);
+    EXPECT_EQ(std::vector<uint8_t>(buf.begin() + 2, buf.end()), row.buffer);
+}
+
+TEST(CopyRowTest, Int4ArrayIsOneDimensionalArrayRecv) {
+    using Row = pgcopy::Schema<pgcopy::Int4Array>;
+    const std::vector<int32_t> v = {1, -1};
+    std::vector<uint8_t> buf(Row::size(v));
+    Row::encode(buf.data(), v);
+
+    std::vector<uint8_t> expected = {
+        0x00, 0x01,
+        0x00, 0x00, 0x00, 0x24,                          // 20 header bytes + 2 elements
+        0x00, 0x00, 0x00, 0x01,                          // ndim
+        0x00, 0x00, 0x00, 0x00,                          // no NULLs
+        0x00, 0x00, 0x00, 0x17,                          // int4
+        0x00, 0x00, 0x00, 0x02,                          // dimension
+        0x00, 0x00, 0x00, 0x01,                          // lower bound
+        0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x04, 0xFF, 0xFF, 0xFF, 0xFF
+    };
+    EXPECT_EQ(buf, expected);
+
+    std::vector<uint8_t> null(Row::size({}));
+    Row::encode(null.data(), {});
+    EXPECT_EQ(null, (std::vector<uint8_t>{0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF}));
+}
+
+TEST(CopyRowTest, CompositionRunsRoundTrip) {
+    std::vector<int32_t> runs;
+    CompositionRuns::append(runs, U'a', 1);
+    CompositionRuns::append(runs, 0x10FFFF, 3);
+    CompositionRuns::append(runs, U'z', CompositionRuns::MAX_RUN + 5);
+    ASSERT_EQ(runs.size(), 4u);
+    EXPECT_EQ(runs[0], 'a');
+    EXPECT_EQ(CompositionRuns::codepoint(runs[1]), U'\U0010FFFF');
+    EXPECT_EQ(CompositionRuns::length(runs[1]), 3u);
+    EXPECT_EQ(CompositionRuns::length(runs[2]), CompositionRuns::MAX_RUN);
+    EXPECT_GT(runs[2], 0);
+    EXPECT_EQ(CompositionRuns::length(runs[3]), 5u);
+
+    std::u32string expected = U"a\U0010FFFF\U0010FFFF\U0010FFFF" + std::u32string(CompositionRuns::MAX_RUN + 5, U'z');
+    EXPECT_EQ(CompositionRuns::expand(runs), expected);
+}
+
+TEST(CopyRowTest, PackedTrajectoryRoundTrip) {
+    std::vector<Eigen::Vector4d> pts;
+    for (int i = 0; i < 16; ++i) {
+        Eigen::Vector4d p(1.0, 0.01 * i, -0.02 * i, 0.003 * i * i);
+        pts.push_back(p.normalized());
+    }
+    pts.push_back(Eigen::Vector4d(0, 0, 0, -1));   // A far jump still round-trips
+
+    std::vector<uint8_t> packed;
+    PackedTrajectory::encode(pts, packed);
+    EXPECT_LT(packed.size(), 8 * pts.size());
+
+    auto back = PackedTrajectory::decode(packed);
+    ASSERT_EQ(back.size(), pts.size());
+    for (size_t i = 0; i < pts.size(); ++i)
+        for (int k = 0; k < 4; ++k) EXPECT_NEAR(back[i][k], pts[i][k], 0.5 / PackedTrajectory::SCALE) << i;
+
+    packed.pop_back();
+    EXPECT_TRUE(PackedTrajectory::decode(packed).empty());
+
+    Eigen::Vector4d lo, hi;
+    PackedTrajectory::bounds(pts, lo, hi);
+    EXPECT_EQ(lo[3], -1.0);
+    EXPECT_EQ(hi[0], pts[0][0]);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file test_count_min_sketch.cpp
+ * @brief Count-Min sketch estimates against exact counts
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/count_min_sketch.hpp>
+#include <random>
+#include <unordered_map>
+
+using namespace Hartonomous;
+
+TEST(CountMinSketchTest, NeverUnderestimates) {
+    CountMinSketch sketch(10);  // 1024 columns for 5000 keys: heavy collisions
+    std::unordered_map<uint64_t, uint32_t> exact;
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t key = rng() % 5000;
+        uint32_t count = 1 + rng() % 3;
+        sketch.add(key, count);
+        exact[key] += count;
+    }
+    for (const auto& [key, count] : exact) EXPECT_GE(sketch.estimate(key), count);
+}
+
+TEST(CountMinSketchTest, ExactWithoutCollisions) {
+    CountMinSketch sketch(20);
+    for (uint64_t key = 0; key < 100; ++key)
+        for (uint64_t k = 0; k <= key; ++k) sketch.add(key);
+    for (uint64_t key = 0; key < 100; ++key) EXPECT_EQ(sketch.estimate(key), key + 1);
+    EXPECT_EQ(sketch.estimate(12345), 0u);
+    EXPECT_EQ(sketch.add(7, 10), 18u);
+}
+
+TEST(CountMinSketchTest, SharedAddsFromThreadsAreNotLost) {
+    CountMinSketch sketch(12);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < 80000; ++i) sketch.add_shared(static_cast<uint64_t>(i % 40));
+    for (uint64_t key = 0; key < 40; ++key) EXPECT_GE(sketch.estimate(key), 2000u);
+    EXPECT_GE(sketch.add_shared(3, 5), 2005u);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_cpu_dispatch.cpp
+ * @brief The per-ISA kernels agree with the portable ones at every SIMD level this CPU supports
+ */
+
+#include <gtest/gtest.h>
+#include <hashing/blake3_pipeline.hpp>
+#include <ingestion/quantized_space.hpp>
+#include <spatial/hilbert_curve_4d.hpp>
+#include <utils/cpu_dispatch.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Hartonomous;
+using hartonomous::spatial::HilbertCurve4D;
+
+namespace {
+
+constexpr SimdLevel ALL_LEVELS[] = {SimdLevel::Scalar, SimdLevel::Sse4, SimdLevel::Avx2, SimdLevel::Avx512};
+
+// Levels above the host's are clamped to it, so those runs repeat the widest path
+class CpuDispatchTest : public ::testing::Test {
+protected:
+    void TearDown() override { limit_simd(SimdLevel::Avx512); }
+};
+
+} // namespace
+
+TEST_F(CpuDispatchTest, DetectionIsConsistent) {
+    const CpuFeatures& cpu = CpuFeatures::host();
+    if (cpu.level() >= SimdLevel::Avx2) EXPECT_TRUE(cpu.avx2 && cpu.fma && cpu.f16c);
+    if (cpu.level() == SimdLevel::Avx512) EXPECT_TRUE(cpu.avx512f && cpu.avx512bw);
+    EXPECT_EQ(limit_simd(SimdLevel::Scalar), SimdLevel::Scalar);
+    EXPECT_EQ(limit_simd(SimdLevel::Avx512), cpu.level());
+}
+
+TEST_F(CpuDispatchTest, HilbertBatchMatchesSinglePoint) {
+    // 37 points: a full 16- and 8-lane group on every path plus a tail
+    const size_t n = 37;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<double> xyzw(4 * n);
+    for (auto& v : xyzw) v = u(rng);
+
+    std::vector<HilbertCurve4D::HilbertIndex> expected(n);
+    for (size_t i = 0; i < n; ++i)
+        expected[i] = HilbertCurve4D::encode({xyzw[4 * i], xyzw[4 * i + 1], xyzw[4 * i + 2], xyzw[4 * i + 3]});
+
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(simd_level_name(limit_simd(level)));
+        std::vector<HilbertCurve4D::HilbertIndex> idx(n);
+        HilbertCurve4D::encode_batch(xyzw.data(), n, idx.data());
+        EXPECT_EQ(idx, expected);
+
+        std::vector<double> decoded(4 * n);
+        HilbertCurve4D::decode_batch(expected.data(), n, decoded.data());
+        for (size_t i = 0; i < n; ++i) {
+            const auto p = HilbertCurve4D::decode(expected[i]);
+            for (int k = 0; k < 4; ++k) EXPECT_EQ(decoded[4 * i + k], p[k]) << i;
+        }
+    }
+}
+
+TEST_F(CpuDispatchTest, HashManyFixedMatchesHashOnEveryLevel) {
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(simd_level_name(limit_simd(level)));
+        for (size_t len : {0, 33, 64, 1024}) {
+            const size_t count = 37;
+            const size_t stride = len + 5;
+            std::vector<uint8_t> buf(count * stride);
+            for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<uint8_t>(i * 97 + 3);
+
+            std::vector<BLAKE3Pipeline::Hash> out(count);
+            BLAKE3Pipeline::hash_many_fixed(buf.data(), stride, len, count, out.data());
+            for (size_t i = 0; i < count; ++i)
+                EXPECT_EQ(out[i], BLAKE3Pipeline::hash(buf.data() + i * stride, len)) << "len " << len << " #" << i;
+        }
+    }
+}
+
+TEST_F(CpuDispatchTest, QuantizedDistancesAgreeAcrossLevels) {
+    const size_t dim = 77;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> g;
+    std::vector<float> a(dim), b(dim);
+    for (auto& v : a) v = g(rng);
+    for (auto& v : b) v = g(rng);
+
+    for (auto quant : {HnswQuantization::FP16, HnswQuantization::Int8}) {
+        limit_simd(SimdLevel::Scalar);
+        QuantizedIPSpace reference(dim, quant);
+        std::vector<char> ea(reference.get_data_size()), eb(reference.get_data_size());
+        reference.encode(a.data(), ea.data());
+        reference.encode(b.data(), eb.data());
+        const float expected = reference.get_dist_func()(ea.data(), eb.data(), reference.get_dist_func_param());
+
+        // The kernel is chosen when the space is built
+        for (SimdLevel level : ALL_LEVELS) {
+            SCOPED_TRACE(simd_level_name(limit_simd(level)));
+            QuantizedIPSpace space(dim, quant);
+            const float d = space.get_dist_func()(ea.data(), eb.data(), space.get_dist_func_param());
+            if (quant == HnswQuantization::Int8)
+                EXPECT_EQ(d, expected);   // integer dot product, one final float multiply
+            else
+                EXPECT_NEAR(d, expected, 1e-4f * std::abs(expected) + 1e-4f);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file test_embedding_projection.cpp
+ * @brief Laplacian eigenmap projection to S3 with both eigen solvers
+ */
+
+#include <gtest/gtest.h>
+#include <ml/embedding_projection.hpp>
+#include <cmath>
+#include <random>
+
+using namespace hartonomous::ml;
+
+namespace {
+
+// Rows [0, n/2) around +3·e0, the rest around -3·e0, in 8D
+Eigen::MatrixXd two_clusters(int n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> g;
+    Eigen::MatrixXd x(n, 8);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < 8; ++j) x(i, j) = 0.3 * g(rng) + (j == 0 ? (i < n / 2 ? 3.0 : -3.0) : 0.0);
+    return x;
+}
+
+} // namespace
+
+TEST(EmbeddingProjectionTest, SolversSeparateClustersOnS3) {
+    const int n = 200;
+    const Eigen::MatrixXd x = two_clusters(n, 5);
+
+    for (auto solver : {EmbeddingProjection::EigenSolver::ShiftInvert, EmbeddingProjection::EigenSolver::Lanczos}) {
+        for (bool normalized : {true, false}) {
+            EmbeddingProjection::Config config;
+            config.solver = solver;
+            config.use_normalized_laplacian = normalized;
+            const auto p = EmbeddingProjection(config).project_to_4d(x);
+            ASSERT_EQ(p.rows(), n);
+            ASSERT_EQ(p.cols(), 4);
+
+            double intra = 0.0, inter = 0.0;
+            int n_intra = 0, n_inter = 0;
+            for (int i = 0; i < n; ++i) {
+                EXPECT_NEAR(p.row(i).norm(), 1.0, 1e-12);
+                for (int j = i + 1; j < n; ++j) {
+                    const bool same = (i < n / 2) == (j < n / 2);
+                    (same ? intra : inter) += p.row(i).dot(p.row(j));
+                    ++(same ? n_intra : n_inter);
+                }
+            }
+            EXPECT_GT(intra / n_intra, inter / n_inter + 0.1) << int(solver) << " normalized=" << normalized;
+        }
+    }
+}
+
+TEST(EmbeddingProjectionTest, OutOfSampleRowsLandNextToTheirTrainingRows) {
+    // One connected anisotropic blob; the new rows are slightly perturbed training rows
+    const int n = 300, m = 50;
+    std::mt19937 rng(2);
+    std::normal_distribution<double> g;
+    Eigen::MatrixXd x(n, 8);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < 8; ++j) x(i, j) = g(rng) * (j < 2 ? 2.0 : 0.5);
+    Eigen::MatrixXd y = x.topRows(m);
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < 8; ++j) y(i, j) += 0.05 * g(rng);
+
+    for (bool normalized : {true, false}) {
+        EmbeddingProjection::Config config;
+        config.sigma = 2.0;
+        config.use_normalized_laplacian = normalized;
+        EmbeddingProjection projection(config);
+        EXPECT_THROW(projection.project_out_of_sample(y), std::runtime_error);
+
+        const auto trained = projection.project_to_4d(x);
+        const auto added = projection.project_out_of_sample(y, true);
+        ASSERT_EQ(added.rows(), m);
+        double mean = 0.0;
+        for (int i = 0; i < m; ++i) {
+            EXPECT_NEAR(added.row(i).norm(), 1.0, 1e-12);
+            EXPECT_GT(added.row(i).dot(trained.row(i)), 0.8) << i;
+            mean += added.row(i).dot(trained.row(i)) / m;
+        }
+        EXPECT_GT(mean, 0.98) << "normalized=" << normalized;
+        EXPECT_EQ(projection.model_size(), n + m);
+        EXPECT_THROW(projection.project_out_of_sample(Eigen::MatrixXd::Zero(1, 3)), std::runtime_error);
+    }
+}
+
+TEST(EmbeddingProjectionTest, RejectsTooFewSamples) {
+    EXPECT_THROW(EmbeddingProjection().project_to_4d(Eigen::MatrixXd::Random(5, 3)), std::runtime_error);
+}
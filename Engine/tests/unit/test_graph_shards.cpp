@@ -0,0 +1,173 @@
+/**
+ * @file test_graph_shards.cpp
+ * @brief Hash partitioning of the relation graph and fetching rows from a shard over loopback
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/graph_shards.hpp>
+#include <hashing/composition_interner.hpp>
+#include <set>
+#include <string>
+
+using namespace Hartonomous;
+
+namespace {
+
+BLAKE3Pipeline::Hash H(const std::string& s) { return BLAKE3Pipeline::hash(std::string_view(s)); }
+
+// A chain of nodes, each linked to the next three
+std::vector<RelationGraph::EdgeRecord> chain_edges(size_t n) {
+    std::vector<RelationGraph::EdgeRecord> edges;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 1; k <= 3; ++k) {
+            edges.push_back({H("n" + std::to_string(i)), H("n" + std::to_string((i + k) % n)),
+                             1000.0 + double(k), double(i + k), 1});
+        }
+    }
+    return edges;
+}
+
+// First node of the chain that shard `shard` of 2 owns
+BLAKE3Pipeline::Hash owned_by(uint32_t shard, size_t skip = 0) {
+    for (size_t i = 0;; ++i) {
+        auto id = H("n" + std::to_string(i));
+        if (GraphShards::owner_of(id, 2) == shard && skip-- == 0) return id;
+    }
+}
+
+GraphShards::Options two_shards(uint16_t remote_port) {
+    GraphShards::Options opts;
+    opts.shards = {{"127.0.0.1", 1}, {"127.0.0.1", remote_port}};
+    opts.self = 0;
+    return opts;
+}
+
+} // namespace
+
+TEST(GraphShardsTest, PartitionSplitsRowsByOwner) {
+    auto graph = RelationGraph::from_edges(chain_edges(200), "chain");
+    auto s0 = GraphShards::partition(*graph, 2, 0);
+    auto s1 = GraphShards::partition(*graph, 2, 1);
+    EXPECT_EQ(s0->edge_count() + s1->edge_count(), graph->edge_count());
+    EXPECT_EQ(s1->fingerprint(), "chain|shard 1/2");
+
+    // Both halves get a fair share of 200 random-looking IDs
+    EXPECT_GT(s0->edge_count(), graph->edge_count() / 4);
+    EXPECT_GT(s1->edge_count(), graph->edge_count() / 4);
+
+    for (size_t i = 0; i < 200; ++i) {
+        auto id = H("n" + std::to_string(i));
+        const auto& mine = GraphShards::owner_of(id, 2) == 0 ? *s0 : *s1;
+        const auto& other = GraphShards::owner_of(id, 2) == 0 ? *s1 : *s0;
+        EXPECT_EQ(mine.neighbors(id).size(), 3u);
+        EXPECT_TRUE(other.neighbors(id).empty());
+    }
+    EXPECT_THROW(GraphShards::partition(*graph, 2, 2), std::invalid_argument);
+}
+
+TEST(GraphShardsTest, ClientFetchesRowsInOrder) {
+    auto graph = RelationGraph::from_edges(chain_edges(50));
+    GraphShardServer server(graph, 0, "127.0.0.1");
+    GraphShardClient client("127.0.0.1", server.port());
+
+    const std::vector<BLAKE3Pipeline::Hash> ids = {H("n7"), H("missing"), H("n0")};
+    auto rows = client.fetch(ids);
+    ASSERT_EQ(rows.size(), 3u);
+    ASSERT_EQ(rows[0].size(), 3u);
+    EXPECT_TRUE(rows[1].empty());
+    ASSERT_EQ(rows[2].size(), 3u);
+
+    std::set<BLAKE3Pipeline::Hash> targets;
+    for (const auto& e : rows[0]) {
+        EXPECT_EQ(e.source, H("n7"));
+        targets.insert(e.target);
+    }
+    EXPECT_EQ(targets, (std::set<BLAKE3Pipeline::Hash>{H("n8"), H("n9"), H("n10")}));
+    EXPECT_EQ(server.rows_served(), 3u);
+
+    // The connection is reused
+    EXPECT_EQ(client.fetch(ids).size(), 3u);
+    EXPECT_EQ(server.rows_served(), 6u);
+}
+
+TEST(GraphShardsTest, RemoteRowsAreFetchedOnceAndCached) {
+    NeighborCache::global().clear();
+    auto graph = RelationGraph::from_edges(chain_edges(100));
+    GraphShardServer server(GraphShards::partition(*graph, 2, 1), 0, "127.0.0.1");
+    GraphShards shards(two_shards(server.port()));
+
+    const auto remote = owned_by(1);
+    EXPECT_FALSE(shards.owns(remote));
+    EXPECT_TRUE(shards.owns(owned_by(0)));
+
+    auto list = shards.neighbors(remote);
+    ASSERT_EQ(list->size(), 3u);
+    std::set<BLAKE3Pipeline::Hash> expected, got;
+    for (const auto& e : graph->neighbors(remote)) expected.insert(graph->id_of(e.target));
+    for (const auto& n : *list) got.insert(CompositionInterner::global().hash_of(n.node));
+    EXPECT_EQ(got, expected);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+
+    shards.neighbors(remote);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+    EXPECT_EQ(server.rows_served(), 1u);
+}
+
+TEST(GraphShardsTest, PrefetchSendsOneRequestPerShard) {
+    NeighborCache::global().clear();
+    auto graph = RelationGraph::from_edges(chain_edges(100));
+    GraphShardServer server(GraphShards::partition(*graph, 2, 1), 0, "127.0.0.1");
+    GraphShards shards(two_shards(server.port()));
+
+    // Local IDs are skipped, duplicates asked for once
+    std::vector<BLAKE3Pipeline::Hash> frontier = {owned_by(1, 0), owned_by(1, 1), owned_by(0), owned_by(1, 2),
+                                                  owned_by(1, 0)};
+    shards.prefetch(frontier);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+    EXPECT_EQ(server.rows_served(), 3u);
+
+    for (size_t k = 0; k < 3; ++k) EXPECT_EQ(shards.neighbors(owned_by(1, k))->size(), 3u);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+
+    // Everything held already: no request at all
+    shards.prefetch(frontier);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+}
+
+TEST(GraphShardsTest, HubRowsAreKeptOutsideTheCache) {
+    NeighborCache::global().clear();
+    const auto hub = owned_by(1);
+    std::vector<RelationGraph::EdgeRecord> edges;
+    for (uint32_t i = 0; i < RelationGraph::HUB_DEGREE + 10; ++i) {
+        edges.push_back({hub, H("leaf" + std::to_string(i)), 1000.0, 1.0, 1});
+    }
+    auto graph = RelationGraph::from_edges(std::move(edges));
+    GraphShardServer server(graph, 0, "127.0.0.1");
+    GraphShards shards(two_shards(server.port()));
+
+    EXPECT_EQ(shards.neighbors(hub)->size(), RelationGraph::HUB_DEGREE + 10);
+    EXPECT_EQ(shards.stats().hub_rows, 1u);
+    EXPECT_FALSE(NeighborCache::global().contains(hub));
+
+    // Still held after the cache is emptied
+    NeighborCache::global().clear();
+    shards.neighbors(hub);
+    EXPECT_EQ(shards.stats().remote_requests, 1u);
+    EXPECT_EQ(shards.stats().hub_hits, 1u);
+}
+
+TEST(GraphShardsTest, OptionsParseShardList) {
+    ::setenv("HARTONOMOUS_GRAPH_SHARDS", " a.example:7001 ; b.example:7002;", 1);
+    ::setenv("HARTONOMOUS_GRAPH_SHARD_SELF", "1", 1);
+    auto opts = GraphShards::Options::from_env();
+    ::unsetenv("HARTONOMOUS_GRAPH_SHARDS");
+    ::unsetenv("HARTONOMOUS_GRAPH_SHARD_SELF");
+
+    ASSERT_EQ(opts.shards.size(), 2u);
+    EXPECT_EQ(opts.shards[0].host, "a.example");
+    EXPECT_EQ(opts.shards[1].port, 7002);
+    EXPECT_EQ(opts.self, 1u);
+
+    opts.self = 2;
+    EXPECT_THROW(GraphShards{opts}, std::invalid_argument);
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_hash_table_128.cpp
+ * @brief Unit tests for the flat 128-bit ID set/map
+ *
+ * Tests HashSet128/HashMap128 insert/find semantics, growth across rehash,
+ * and the lock-striped ShardedSet built on top of them.
+ * No database needed — pure in-memory logic.
+ */
+
+#include <gtest/gtest.h>
+#include <hashing/hash_table_128.hpp>
+#include <ingestion/substrate_cache.hpp>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace Hartonomous;
+
+// Helper: deterministic ID with the counter spread over both halves
+static Hash128 make_id(uint64_t i) {
+    Hash128 id{};
+    uint64_t lo = i * 0x9E3779B97F4A7C15ULL;
+    std::memcpy(id.data(), &lo, 8);
+    std::memcpy(id.data() + 8, &i, 8);
+    return id;
+}
+
+TEST(HashSet128Test, InsertReportsNewKeys) {
+    HashSet128 set;
+    EXPECT_TRUE(set.insert(make_id(1)).second);
+    EXPECT_FALSE(set.insert(make_id(1)).second);
+    EXPECT_TRUE(set.contains(make_id(1)));
+    EXPECT_FALSE(set.contains(make_id(2)));
+    EXPECT_EQ(set.size(), 1u);
+}
+
+TEST(HashSet128Test, GrowsAcrossRehash) {
+    HashSet128 set;
+    for (uint64_t i = 0; i < 100000; ++i) ASSERT_TRUE(set.insert(make_id(i)).second);
+    EXPECT_EQ(set.size(), 100000u);
+    for (uint64_t i = 0; i < 100000; ++i) ASSERT_TRUE(set.contains(make_id(i)));
+    EXPECT_FALSE(set.contains(make_id(100000)));
+
+    size_t visited = 0;
+    set.for_each([&](const Hash128&) { visited++; });
+    EXPECT_EQ(visited, 100000u);
+}
+
+TEST(HashSet128Test, KeysDifferingOnlyInHighHalf) {
+    HashSet128 set;
+    for (uint8_t b = 0; b < 200; ++b) {
+        Hash128 id{};
+        id[15] = b;
+        ASSERT_TRUE(set.insert(id).second);
+    }
+    EXPECT_EQ(set.size(), 200u);
+}
+
+TEST(HashSet128Test, ReserveAvoidsRehash) {
+    HashSet128 set(1000);
+    size_t cap = set.capacity();
+    for (uint64_t i = 0; i < 1000; ++i) set.insert(make_id(i));
+    EXPECT_EQ(set.capacity(), cap);
+    // Flat storage: well under the ~50 bytes/entry of a node-based set
+    EXPECT_LT(set.memory_bytes() / set.size(), 40u);
+}
+
+TEST(HashMap128Test, TryEmplaceKeepsFirstValue) {
+    HashMap128<int> map;
+    auto [v1, ins1] = map.try_emplace(make_id(7), 1);
+    EXPECT_TRUE(ins1);
+    auto [v2, ins2] = map.try_emplace(make_id(7), 2);
+    EXPECT_FALSE(ins2);
+    EXPECT_EQ(*v2, 1);
+    EXPECT_EQ(v1, v2);
+
+    map[make_id(8)] += 5;
+    ASSERT_NE(map.find(make_id(8)), nullptr);
+    EXPECT_EQ(*map.find(make_id(8)), 5);
+    EXPECT_EQ(map.find(make_id(9)), nullptr);
+}
+
+TEST(HashMap128Test, ValuesSurviveRehash) {
+    HashMap128<uint64_t> map;
+    for (uint64_t i = 0; i < 50000; ++i) map[make_id(i)] = i * 3;
+    for (uint64_t i = 0; i < 50000; ++i) {
+        auto* v = map.find(make_id(i));
+        ASSERT_NE(v, nullptr);
+        ASSERT_EQ(*v, i * 3);
+    }
+}
+
+TEST(ShardedSetTest, InsertIfAbsentClaimsOncePerKey) {
+    ShardedSet<Hash128, HashHasher, 6, HashSet128> set;
+    constexpr uint64_t N = 20000;
+    std::atomic<size_t> claimed{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < N; ++i)
+                if (set.insert_if_absent(make_id(i))) claimed++;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(claimed.load(), N);
+    EXPECT_EQ(set.size(), N);
+    EXPECT_TRUE(set.contains(make_id(N - 1)));
+}
@@ -54,3 +54,26 @@ TEST(HashingTest, BatchHashing) {
     EXPECT_EQ(hashes[1], BLAKE3Pipeline::hash("b"));
     EXPECT_EQ(hashes[2], BLAKE3Pipeline::hash("c"));
 }
+
+TEST(HashingTest, HashManyFixedMatchesHash) {
+    EXPECT_EQ(BLAKE3Pipeline::to_hex(BLAKE3Pipeline::hash("abc")), "6437b3ac38465133ffb63b75273a8db5");
+
+    // Lane-group sizes, leftovers, single- and multi-block lengths, and past one chunk
+    for (size_t len : {0, 1, 32, 33, 37, 64, 65, 1024, 1500}) {
+        const size_t count = 37;
+        const size_t stride = len + 3;
+        std::vector<uint8_t> buf(count * stride);
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<uint8_t>(i * 131 + 7);
+
+        std::vector<BLAKE3Pipeline::Hash> out(count);
+        BLAKE3Pipeline::hash_many_fixed(buf.data(), stride, len, count, out.data());
+        for (size_t i = 0; i < count; ++i)
+            EXPECT_EQ(out[i], BLAKE3Pipeline::hash(buf.data() + i * stride, len)) << "len " << len << " #" << i;
+    }
+
+    std::vector<std::string> inputs(40, "same-length");
+    for (size_t i = 0; i < inputs.size(); ++i) inputs[i][0] = static_cast<char>('a' + i % 26);
+    inputs.push_back("odd one");
+    auto hashes = BLAKE3Pipeline::hash_batch(inputs);
+    for (size_t i = 0; i < inputs.size(); ++i) EXPECT_EQ(hashes[i], BLAKE3Pipeline::hash(inputs[i]));
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_hilbert_range_query.cpp
+ * @brief Hilbert range decomposition of S³ regions and sorted-key point queries
+ */
+
+#include <gtest/gtest.h>
+#include <spatial/hilbert_range_query.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace hartonomous::spatial;
+using Vec4 = Eigen::Vector4d;
+
+static Vec4 random_unit(std::mt19937& rng) {
+    std::normal_distribution<double> g;
+    Vec4 v(g(rng), g(rng), g(rng), g(rng));
+    return v.normalized();
+}
+
+static bool covered(const std::vector<HilbertRangeQuery::Interval>& ivs, const Vec4& p) {
+    auto k = HilbertRangeQuery::key(p);
+    for (const auto& iv : ivs)
+        if (HilbertRangeQuery::to_key(iv.lo) <= k && k <= HilbertRangeQuery::to_key(iv.hi)) return true;
+    return false;
+}
+
+TEST(HilbertRangeQueryTest, BallCoversEveryPointInside) {
+    std::mt19937 rng(7);
+    HilbertRangeQuery::Options opts;
+    for (double radius : {0.02, 0.3, 1.2, 2.8}) {
+        for (int trial = 0; trial < 5; ++trial) {
+            Vec4 c = random_unit(rng);
+            auto ivs = HilbertRangeQuery::ball(c, radius, opts);
+            ASSERT_FALSE(ivs.empty());
+            EXPECT_LE(ivs.size(), opts.max_intervals);
+            for (size_t i = 1; i < ivs.size(); ++i)
+                EXPECT_LT(HilbertRangeQuery::to_key(ivs[i - 1].hi), HilbertRangeQuery::to_key(ivs[i].lo));
+
+            for (int s = 0; s < 2000; ++s) {
+                // Points spread over the ball and its rim
+                Vec4 t = random_unit(rng);
+                t -= t.dot(c) * c;
+                double angle = std::uniform_real_distribution<double>(0.0, radius)(rng);
+                Vec4 p = (std::cos(angle) * c + std::sin(angle) * t.normalized()).normalized();
+                if (HilbertRangeQuery::geodesic(c, p) <= radius) {
+                    EXPECT_TRUE(covered(ivs, p)) << radius;
+                }
+            }
+        }
+    }
+}
+
+TEST(HilbertRangeQueryTest, BoxCoversEveryPointInside) {
+    std::mt19937 rng(9);
+    Vec4 lo(0.1, -0.6, -0.2, -0.9), hi(0.7, 0.1, 0.5, 0.2);
+    auto ivs = HilbertRangeQuery::box(lo, hi);
+    size_t inside = 0;
+    for (int s = 0; s < 50000; ++s) {
+        Vec4 p = random_unit(rng);
+        if ((p.array() >= lo.array()).all() && (p.array() <= hi.array()).all()) {
+            ++inside;
+            EXPECT_TRUE(covered(ivs, p));
+        }
+    }
+    EXPECT_GT(inside, 100u);
+    EXPECT_TRUE(HilbertRangeQuery::box(hi, lo).empty());
+}
+
+TEST(HilbertRangeQueryTest, PointIndexMatchesBruteForce) {
+    std::mt19937 rng(13);
+    std::vector<Vec4> points(3000);
+    for (auto& p : points) p = random_unit(rng);
+    HilbertPointIndex index(points);
+    ASSERT_EQ(index.size(), points.size());
+
+    for (int q = 0; q < 40; ++q) {
+        Vec4 c = random_unit(rng);
+        std::vector<std::pair<double, size_t>> truth;
+        for (size_t i = 0; i < points.size(); ++i) truth.emplace_back(HilbertRangeQuery::geodesic(c, points[i]), i);
+        std::sort(truth.begin(), truth.end());
+
+        auto near = index.nearest(c, 5);
+        ASSERT_EQ(near.size(), 5u);
+        for (size_t j = 0; j < 5; ++j) EXPECT_EQ(near[j].point, truth[j].second);
+
+        auto hits = index.within(c, 0.4);
+        size_t expected = std::count_if(truth.begin(), truth.end(), [](const auto& t) { return t.first <= 0.4; });
+        ASSERT_EQ(hits.size(), expected);
+        for (size_t j = 0; j < hits.size(); ++j) EXPECT_EQ(hits[j].point, truth[j].second);
+    }
+
+    EXPECT_EQ(index.nearest(points[0], points.size() + 10).size(), points.size());
+    EXPECT_TRUE(HilbertPointIndex({}).nearest(points[0], 3).empty());
+}
@@ -0,0 +1,88 @@
+/**
+ * @file test_hnsw_index_cache.cpp
+ * @brief Unit tests for HNSW index keying and in-memory reuse
+ *
+ * Persistence is disabled (empty directory) so nothing touches disk.
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/hnsw_index_cache.hpp>
+#include <hnswlib/hnswlib.h>
+#include <vector>
+
+using namespace Hartonomous;
+
+static HnswIndexCache::Options memory_only() {
+    HnswIndexCache::Options o;
+    o.dir = "";
+    return o;
+}
+
+TEST(HnswIndexCacheTest, DigestTracksContentAndShape) {
+    std::vector<float> a(64 * 8, 0.5f);
+    std::vector<float> b = a;
+    EXPECT_EQ(HnswIndexCache::digest(a.data(), 64, 8), HnswIndexCache::digest(b.data(), 64, 8));
+
+    b[3] = 0.25f;
+    EXPECT_NE(HnswIndexCache::digest(a.data(), 64, 8), HnswIndexCache::digest(b.data(), 64, 8));
+    EXPECT_NE(HnswIndexCache::digest(a.data(), 64, 8), HnswIndexCache::digest(a.data(), 32, 16));
+
+    auto seed = HnswIndexCache::digest(b.data(), 64, 8);
+    EXPECT_NE(HnswIndexCache::digest(a.data(), 64, 8), HnswIndexCache::digest(a.data(), 64, 8, seed));
+}
+
+TEST(HnswIndexCacheTest, SameKeySharesOneIndex) {
+    HnswIndexCache cache(memory_only());
+    EXPECT_TRUE(cache.path_for({}).empty());
+
+    std::vector<float> v(16 * 4, 1.0f);
+    HnswIndexCache::Key key{BLAKE3Pipeline::hash("model"), "layers.0.v_proj", {8, 50, 16}, 16, 4,
+                            HnswIndexCache::digest(v.data(), 16, 4)};
+    int fills = 0;
+    auto fill = [&](HnswIndexCache::Entry& entry) {
+        ++fills;
+        for (size_t i = 0; i < 16; ++i) entry.add_point(v.data() + i * 4, i);
+    };
+
+    auto first = cache.acquire(key, fill);
+    first.reset();  // Still resident
+    auto second = cache.acquire(key, fill);
+    EXPECT_EQ(fills, 1);
+
+    auto other = key;
+    other.tensor = "layers.0.o_proj";
+    auto third = cache.acquire(other, fill);
+    EXPECT_EQ(fills, 2);
+    EXPECT_NE(second.get(), third.get());
+
+    // `second` is still held, so its index is shared rather than rebuilt
+    auto again = cache.acquire(key, fill);
+    EXPECT_EQ(again.get(), second.get());
+    EXPECT_EQ(fills, 2);
+
+    auto s = cache.stats();
+    EXPECT_EQ(s.built, 2u);
+    EXPECT_EQ(s.reused, 2u);
+    EXPECT_EQ(s.loaded, 0u);
+}
+
+TEST(HnswIndexCacheTest, NoResidentEntryWhenDisabled) {
+    auto opts = memory_only();
+    opts.keep_resident = false;
+    HnswIndexCache cache(opts);
+
+    std::vector<float> v(16 * 4, 1.0f);
+    HnswIndexCache::Key key{BLAKE3Pipeline::hash("model"), "layers.0.up_proj", {8, 50, 16}, 16, 4,
+                            HnswIndexCache::digest(v.data(), 16, 4)};
+    int fills = 0;
+    auto fill = [&](HnswIndexCache::Entry& entry) {
+        ++fills;
+        for (size_t i = 0; i < 16; ++i) entry.add_point(v.data() + i * 4, i);
+    };
+
+    auto held = cache.acquire(key, fill);
+    EXPECT_EQ(cache.acquire(key, fill).get(), held.get());
+    held.reset();  // Nothing else keeps it alive
+    cache.acquire(key, fill);
+    EXPECT_EQ(fills, 2);
+}
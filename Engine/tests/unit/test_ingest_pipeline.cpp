@@ -0,0 +1,132 @@
+/**
+ * @file test_ingest_pipeline.cpp
+ * @brief Unit tests for the staged ingestion pipeline
+ *
+ * Tests BoundedQueue ordering/close semantics and that IngestPipeline
+ * delivers every item exactly once, runs finish hooks, and surfaces errors.
+ * No database needed — pure in-memory logic.
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/ingest_pipeline.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(BoundedQueueTest, FifoAndCapacity) {
+    BoundedQueue<int> q("q", 3);  // Rounded up to a power of two
+    EXPECT_EQ(q.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int v = i;
+        ASSERT_TRUE(q.try_push(v));
+    }
+    int extra = 99;
+    EXPECT_FALSE(q.try_push(extra));
+    EXPECT_EQ(extra, 99);  // Not moved from on failure
+
+    int out;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(q.try_pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_FALSE(q.try_pop(out));
+}
+
+TEST(BoundedQueueTest, CloseDrainsThenFails) {
+    BoundedQueue<int> q("q", 8);
+    q.push(1);
+    q.push(2);
+    q.close();
+    EXPECT_FALSE(q.push(3));
+
+    int out;
+    EXPECT_TRUE(q.pop(out));
+    EXPECT_TRUE(q.pop(out));
+    EXPECT_EQ(out, 2);
+    EXPECT_FALSE(q.pop(out));
+}
+
+TEST(BoundedQueueTest, ConcurrentProducersConsumers) {
+    BoundedQueue<uint64_t> q("q", 16);
+    constexpr uint64_t PER_PRODUCER = 20000;
+    std::atomic<uint64_t> sum{0};
+    std::atomic<int> producers_left{4};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 1; i <= PER_PRODUCER; ++i) q.push(i);
+            if (--producers_left == 0) q.close();
+        });
+    }
+    for (int c = 0; c < 3; ++c) {
+        threads.emplace_back([&]() {
+            uint64_t v;
+            while (q.pop(v)) sum += v;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(sum.load(), 4 * PER_PRODUCER * (PER_PRODUCER + 1) / 2);
+}
+
+TEST(IngestPipelineTest, EveryItemFlowsThroughOnce) {
+    IngestPipeline pipeline;
+    auto& nums = pipeline.make_queue<int>("nums", 8);
+    auto& squares = pipeline.make_queue<long>("squares", 8);
+    std::atomic<long> sum{0};
+
+    pipeline.add_source("gen", nums, [](Emitter<int>& emit) {
+        for (int i = 0; i < 10000; ++i) emit(i);
+    });
+    pipeline.add_stage("square", 4, nums, squares, [](int& v, Emitter<long>& emit) {
+        emit(static_cast<long>(v) * v);
+    });
+    pipeline.add_sink("sum", 2, squares, [&](long& v) { sum += v; });
+    pipeline.run(0);
+
+    long expected = 0;
+    for (long i = 0; i < 10000; ++i) expected += i * i;
+    EXPECT_EQ(sum.load(), expected);
+    EXPECT_EQ(pipeline.stages()[1]->items_in.load(), 10000u);
+    EXPECT_EQ(pipeline.stages()[2]->items_in.load(), 10000u);
+}
+
+TEST(IngestPipelineTest, FinishEmitsRemainder) {
+    IngestPipeline pipeline;
+    auto& in = pipeline.make_queue<int>("in", 4);
+    auto& groups = pipeline.make_queue<std::vector<int>>("groups", 4);
+    std::vector<size_t> sizes;
+
+    pipeline.add_source("gen", in, [](Emitter<int>& emit) {
+        for (int i = 0; i < 10; ++i) emit(i);
+    });
+    std::vector<int> pending;
+    pipeline.add_stage("group", 1, in, groups, [&](int& v, Emitter<std::vector<int>>& emit) {
+        pending.push_back(v);
+        if (pending.size() == 4) emit(std::move(pending)), pending.clear();
+    }, [&](Emitter<std::vector<int>>& emit) {
+        if (!pending.empty()) emit(std::move(pending));
+    });
+    pipeline.add_sink("collect", 1, groups, [&](std::vector<int>& g) { sizes.push_back(g.size()); });
+    pipeline.run(0);
+
+    EXPECT_EQ(sizes, (std::vector<size_t>{4, 4, 2}));
+}
+
+TEST(IngestPipelineTest, StageErrorIsRethrown) {
+    IngestPipeline pipeline;
+    auto& in = pipeline.make_queue<int>("in", 4);
+
+    pipeline.add_source("gen", in, [](Emitter<int>& emit) {
+        for (int i = 0; i < 1000000; ++i)
+            if (!emit(i)) return;  // Queue closed after the failure
+    });
+    pipeline.add_sink("fail", 1, in, [](int& v) {
+        if (v == 100) throw std::runtime_error("boom");
+    });
+    EXPECT_THROW(pipeline.run(0), std::runtime_error);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file test_ingest_progress.cpp
+ * @brief Unit tests for ingestion progress reporting: throttling, phases, ETA
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/ingest_progress.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(IngestProgressTest, ThrottlesAdvanceButAlwaysReportsPhasesAndFinish) {
+    ProgressReporter progress;
+    std::vector<IngestProgress> seen;
+    progress.set_callback([&](const IngestProgress& p) { seen.push_back(p); }, std::chrono::hours(1));
+
+    progress.phase("extract", 1000);
+    for (int i = 0; i < 100; ++i) progress.advance(10, 1);
+    progress.finish();
+
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0].phase, "extract");
+    EXPECT_EQ(seen[0].bytes_done, 0u);
+    EXPECT_TRUE(seen[1].finished);
+    EXPECT_EQ(seen[1].bytes_done, 1000u);
+    EXPECT_EQ(seen[1].records, 100u);
+    EXPECT_EQ(seen[1].eta_sec, 0.0);
+}
+
+TEST(IngestProgressTest, PhaseResetsBytesAndFinishedRunResetsRecords) {
+    ProgressReporter progress;
+    progress.phase("vocab", 100);
+    progress.advance(100, 7);
+    progress.phase("layer_mining", 500);
+
+    auto p = progress.snapshot();
+    EXPECT_EQ(p.phase, "layer_mining");
+    EXPECT_EQ(p.bytes_done, 0u);
+    EXPECT_EQ(p.bytes_total, 500u);
+    EXPECT_EQ(p.records, 7u);
+
+    progress.finish();
+    progress.phase("stream");
+    p = progress.snapshot();
+    EXPECT_EQ(p.records, 0u);
+    EXPECT_FALSE(p.finished);
+    EXPECT_EQ(p.eta_sec, -1.0);
+}
+
+TEST(IngestProgressTest, EstimatesRemainingTimeFromPhaseRate) {
+    ProgressReporter progress;
+    progress.phase("stream", 4000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    progress.advance(1000);
+
+    const auto p = progress.snapshot();
+    ASSERT_GT(p.bytes_per_sec, 0.0);
+    // Three quarters left at the observed rate: about three times the elapsed time
+    EXPECT_NEAR(p.eta_sec, 3.0 * p.elapsed_sec, 0.5 * p.elapsed_sec);
+    EXPECT_NE(describe(p).find("25.0% of"), std::string::npos);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file test_instance_pool.cpp
+ * @brief Unit tests for InstancePool checkout and reuse
+ */
+
+#include <gtest/gtest.h>
+#include <utils/instance_pool.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+namespace {
+
+struct Counted {
+    static inline std::atomic<int> live{0};
+    std::atomic<int> users{0};
+    Counted() { ++live; }
+    ~Counted() { --live; }
+};
+
+} // namespace
+
+TEST(InstancePoolTest, ReusesIdleInstance) {
+    int built = 0;
+    InstancePool<Counted> pool([&] { ++built; return std::make_unique<Counted>(); });
+    EXPECT_EQ(built, 1);
+
+    Counted* first;
+    { auto a = pool.acquire(); first = a.get(); }
+    { auto b = pool.acquire(); EXPECT_EQ(b.get(), first); }
+    EXPECT_EQ(built, 1);
+}
+
+TEST(InstancePoolTest, BuildsAnotherWhenAllBusy) {
+    int built = 0;
+    InstancePool<Counted> pool([&] { ++built; return std::make_unique<Counted>(); });
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    EXPECT_NE(a.get(), b.get());
+    EXPECT_EQ(built, 2);
+}
+
+TEST(InstancePoolTest, KeepsAtMostMaxIdle) {
+    Counted::live = 0;
+    {
+        InstancePool<Counted> pool([] { return std::make_unique<Counted>(); }, 2);
+        {
+            auto a = pool.acquire();
+            auto b = pool.acquire();
+            auto c = pool.acquire();
+            EXPECT_EQ(Counted::live, 3);
+        }
+        EXPECT_EQ(Counted::live, 2);
+    }
+    EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(InstancePoolTest, NoInstanceSharedBetweenThreads) {
+    InstancePool<Counted> pool([] { return std::make_unique<Counted>(); });
+    std::atomic<bool> shared{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                auto e = pool.acquire();
+                if (e->users.fetch_add(1) != 0) shared = true;
+                e->users.fetch_sub(1);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_FALSE(shared);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_landmark_table.cpp
+ * @brief ALT landmark bounds against exact shortest paths, and table files
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/landmark_table.hpp>
+#include <cognitive/astar_search.hpp>
+#include <filesystem>
+#include <limits>
+#include <queue>
+#include <random>
+
+using namespace Hartonomous;
+
+static BLAKE3Pipeline::Hash H(uint32_t i) { return BLAKE3Pipeline::hash(std::to_string(i)); }
+
+// Random symmetric graph over n nodes plus one isolated pair
+static std::shared_ptr<const RelationGraph> sample_graph(uint32_t n, std::string fingerprint = "") {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> elo(800.0, 2000.0);
+    std::vector<RelationGraph::EdgeRecord> edges;
+    auto link = [&](uint32_t a, uint32_t b) {
+        double e = elo(rng), obs = 1.0 + rng() % 50;
+        edges.push_back({H(a), H(b), e, obs, 1});
+        edges.push_back({H(b), H(a), e, obs, 1});
+    };
+    for (uint32_t i = 1; i < n; ++i) link(i, rng() % i);  // Spanning tree keeps it connected
+    for (uint32_t i = 0; i < 2 * n; ++i) {
+        uint32_t a = rng() % n, b = rng() % n;
+        if (a != b) link(a, b);
+    }
+    link(n, n + 1);
+    return RelationGraph::from_edges(std::move(edges), std::move(fingerprint));
+}
+
+static std::vector<double> shortest_from(const RelationGraph& g, uint32_t source) {
+    std::vector<double> dist(g.node_count(), std::numeric_limits<double>::infinity());
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    dist[source] = 0.0;
+    open.push({0.0, source});
+    while (!open.empty()) {
+        auto [d, v] = open.top();
+        open.pop();
+        if (d > dist[v]) continue;
+        for (const auto& e : g.neighbors(v)) {
+            double nd = d + AStarSearch::edge_cost(e.max_elo, e.total_obs);
+            if (nd < dist[e.target]) {
+                dist[e.target] = nd;
+                open.push({nd, e.target});
+            }
+        }
+    }
+    return dist;
+}
+
+TEST(LandmarkTableTest, BoundsAreAdmissible) {
+    auto g = sample_graph(500);
+    auto t = LandmarkTable::build(*g, {8});
+    ASSERT_EQ(t->node_count(), g->node_count());
+    ASSERT_EQ(t->landmark_count(), 8u);
+
+    std::mt19937 rng(3);
+    double bound_sum = 0, exact_sum = 0;
+    for (int q = 0; q < 20; ++q) {
+        uint32_t s = g->index_of(H(rng() % 500));
+        auto exact = shortest_from(*g, s);
+        for (uint32_t v = 0; v < g->node_count(); ++v) {
+            double lb = t->lower_bound(s, v);
+            if (std::isinf(exact[v])) {
+                EXPECT_TRUE(std::isinf(lb));
+                continue;
+            }
+            EXPECT_LE(lb, exact[v] + 1e-9);
+            bound_sum += lb;
+            exact_sum += exact[v];
+        }
+    }
+    // Landmarks should recover a good share of the true distance
+    EXPECT_GT(bound_sum, 0.3 * exact_sum);
+}
+
+TEST(LandmarkTableTest, FileRoundTrip) {
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_landmarks.bin").string();
+    auto g = sample_graph(200, "fp-1");
+    auto t = LandmarkTable::load(*g, path, {4});
+    ASSERT_EQ(t->landmark_count(), 4u);
+
+    EXPECT_EQ(LandmarkTable::load_file(path, "fp-2"), nullptr);
+    auto m = LandmarkTable::load_file(path, LandmarkTable::table_fingerprint(*g, {4}));
+    ASSERT_NE(m, nullptr);
+    ASSERT_EQ(m->node_count(), t->node_count());
+    ASSERT_EQ(m->landmark_count(), t->landmark_count());
+    for (size_t l = 0; l < t->landmark_count(); ++l) EXPECT_EQ(m->landmark(l), t->landmark(l));
+    for (uint32_t i = 0; i < t->node_count(); ++i) {
+        EXPECT_EQ(m->id_of(i), t->id_of(i));
+        for (size_t l = 0; l < t->landmark_count(); ++l) EXPECT_EQ(m->row(i)[l], t->row(i)[l]);
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file test_memory_governor.cpp
+ * @brief Budget enforcement order, deferred shrink requests and usage reporting of the memory governor
+ */
+
+#include <gtest/gtest.h>
+#include <utils/memory_governor.hpp>
+#include <string>
+#include <vector>
+
+using namespace Hartonomous;
+
+using Priority = MemoryGovernor::Priority;
+
+TEST(MemoryGovernorTest, ParsesByteSizes) {
+    EXPECT_EQ(MemoryGovernor::parse_bytes("4096"), 4096u);
+    EXPECT_EQ(MemoryGovernor::parse_bytes("512K"), 512u << 10);
+    EXPECT_EQ(MemoryGovernor::parse_bytes("64m"), 64u << 20);
+    EXPECT_EQ(MemoryGovernor::parse_bytes("8G"), size_t(8) << 30);
+    EXPECT_EQ(MemoryGovernor::parse_bytes("lots"), 0u);
+    EXPECT_EQ(MemoryGovernor::parse_bytes("12X"), 0u);
+}
+
+TEST(MemoryGovernorTest, TracksUsageAndReleases) {
+    MemoryGovernor gov;
+    auto a = gov.enroll("a", Priority::Normal);
+    {
+        auto b = gov.enroll("a", Priority::Normal);
+        a.update(100);
+        b.update(50);
+        EXPECT_EQ(gov.used(), 150u);
+        auto usage = gov.usage_by_cache();
+        ASSERT_EQ(usage.size(), 1u);
+        EXPECT_EQ(usage[0].bytes, 150u);
+        EXPECT_EQ(usage[0].instances, 2u);
+    }
+    EXPECT_EQ(gov.used(), 100u);
+    a.update(40);
+    EXPECT_EQ(gov.used(), 40u);
+
+    // Unlimited: growth never asks for anything
+    a.update(1u << 30);
+    EXPECT_FALSE(a.shrink_requested());
+    EXPECT_EQ(gov.shrinks(), 0u);
+}
+
+TEST(MemoryGovernorTest, ShrinksLowestPriorityFirstAndSparesPinned) {
+    MemoryGovernor gov(1000);
+    std::vector<std::string> order;
+    MemoryGovernor::Account low, normal;
+    low = gov.enroll("low", Priority::Low, [&](size_t target) {
+        order.push_back("low");
+        low.update(target);
+    });
+    normal = gov.enroll("normal", Priority::Normal, [&](size_t target) {
+        order.push_back("normal");
+        normal.update(target);
+    });
+    auto pinned = gov.enroll("pinned", Priority::Pinned);
+
+    pinned.update(600);
+    normal.update(300);
+    EXPECT_TRUE(order.empty());
+
+    // 1100 held: back under 7/8 of the budget (875) takes 225, all 200 of the low cache first
+    low.update(200);
+    ASSERT_EQ(order, (std::vector<std::string>{"low", "normal"}));
+    EXPECT_EQ(low.bytes(), 0u);
+    EXPECT_EQ(normal.bytes(), 275u);
+    EXPECT_EQ(pinned.bytes(), 600u);
+    EXPECT_LE(gov.used(), 875u);
+    EXPECT_EQ(gov.shrinks(), 2u);
+}
+
+TEST(MemoryGovernorTest, CachesWithoutCallbacksTrimWhenAsked) {
+    MemoryGovernor gov(1000);
+    auto owned = gov.enroll("owned", Priority::Normal);
+    owned.update(1200);
+    ASSERT_TRUE(owned.shrink_requested());
+    EXPECT_EQ(owned.target(), 875u);
+
+    // A pending request is not repeated
+    owned.update(1300);
+    EXPECT_EQ(gov.shrinks(), 1u);
+
+    owned.shrunk(800);
+    EXPECT_FALSE(owned.shrink_requested());
+    EXPECT_EQ(gov.used(), 800u);
+}
+
+TEST(MemoryGovernorTest, LoweringTheBudgetEnforcesIt) {
+    MemoryGovernor gov;
+    auto cache = gov.enroll("cache", Priority::Normal, {});
+    cache.update(1000);
+    gov.set_budget(400);
+    EXPECT_TRUE(cache.shrink_requested());
+    EXPECT_EQ(cache.target(), 350u);
+}
+
+TEST(MemoryGovernorTest, PublishesGauges) {
+    MemoryGovernor gov(1u << 20);
+    auto cache = gov.enroll("test_governor_cache", Priority::Normal);
+    cache.update(4096);
+    gov.publish(Metrics::global());
+    const std::string text = Metrics::global().prometheus();
+    EXPECT_NE(text.find("# TYPE hartonomous_memory_cache_bytes gauge"), std::string::npos);
+    EXPECT_NE(text.find("hartonomous_memory_cache_bytes{cache=\"test_governor_cache\"} 4096\n"), std::string::npos);
+}
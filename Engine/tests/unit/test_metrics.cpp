@@ -0,0 +1,59 @@
+/**
+ * @file test_metrics.cpp
+ * @brief Unit tests for the sharded counters, histograms and Prometheus rendering
+ */
+
+#include <gtest/gtest.h>
+#include <utils/metrics.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(MetricsTest, CounterSumsAcrossThreads) {
+    auto& c = Metrics::global().counter("test_metrics_adds_total");
+    const uint64_t before = c.value();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&] { for (int i = 0; i < 10000; ++i) c.add(); });
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(c.value() - before, 80000u);
+    EXPECT_EQ(&c, &Metrics::global().counter("test_metrics_adds_total"));
+}
+
+TEST(MetricsTest, BucketsDoubleFromOneMicrosecond) {
+    EXPECT_EQ(Metrics::Histogram::bucket(0), 0u);
+    EXPECT_EQ(Metrics::Histogram::bucket(1000), 0u);     // le 1 µs
+    EXPECT_EQ(Metrics::Histogram::bucket(1001), 1u);     // le 2 µs
+    EXPECT_EQ(Metrics::Histogram::bucket(4000), 2u);     // le 4 µs
+    EXPECT_EQ(Metrics::Histogram::bucket(4001), 3u);
+    EXPECT_EQ(Metrics::Histogram::bucket(~uint64_t(0)), Metrics::BUCKETS);
+}
+
+TEST(MetricsTest, RendersCumulativeBuckets) {
+    auto& h = Metrics::global().histogram("test_metrics_seconds", Metrics::label("kind", "a\"b"));
+    h.observe_ns(500);
+    h.observe_ns(3000);
+    h.observe_ms(1.0);
+
+    const std::string text = Metrics::global().prometheus();
+    EXPECT_NE(text.find("# TYPE test_metrics_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("test_metrics_seconds_bucket{kind=\"a\\\"b\",le=\"1e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("test_metrics_seconds_bucket{kind=\"a\\\"b\",le=\"4e-06\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("test_metrics_seconds_bucket{kind=\"a\\\"b\",le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("test_metrics_seconds_count{kind=\"a\\\"b\"} 3\n"), std::string::npos);
+}
+
+TEST(MetricsTest, SpanTimesItsScope) {
+    auto& h = Metrics::global().span("test_scope");
+    const uint64_t before = h.snapshot().count;
+    {
+        HARTONOMOUS_SPAN("test_scope");
+    }
+#ifndef HARTONOMOUS_NO_METRICS
+    EXPECT_EQ(h.snapshot().count, before + 1);
+#else
+    EXPECT_EQ(h.snapshot().count, before);
+#endif
+}
@@ -0,0 +1,86 @@
+/**
+ * @file test_model_checkpoint.cpp
+ * @brief Unit tests for the resumable model ingest manifest
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/model_checkpoint.hpp>
+#include <filesystem>
+#include <string>
+
+using namespace Hartonomous;
+namespace fs = std::filesystem;
+
+class ModelCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        opts.dir = (fs::temp_directory_path() /
+                    ("hartonomous_checkpoint_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed())))
+                       .string();
+        fs::remove_all(opts.dir);
+    }
+    void TearDown() override { fs::remove_all(opts.dir); }
+
+    ModelCheckpoint::Options opts;
+    BLAKE3Pipeline::Hash model = BLAKE3Pipeline::hash("model");
+    BLAKE3Pipeline::Hash fingerprint = BLAKE3Pipeline::hash("package v1");
+};
+
+TEST_F(ModelCheckpointTest, ResumesFinishedUnits) {
+    {
+        ModelCheckpoint cp;
+        cp.open(opts, model, fingerprint);
+        EXPECT_TRUE(cp.enabled());
+        cp.complete("vocab");
+        cp.complete("embedding");
+    }
+    ModelCheckpoint cp;
+    cp.open(opts, model, fingerprint);
+    EXPECT_EQ(cp.done_count(), 2u);
+    EXPECT_TRUE(cp.done("vocab"));
+    EXPECT_FALSE(cp.done("layers.0.v_proj.weight#attention_value"));
+
+    cp.clear();
+    EXPECT_FALSE(fs::exists(cp.path()));
+}
+
+TEST_F(ModelCheckpointTest, MinedUnitsWaitForTheirBatches) {
+    ModelCheckpoint cp;
+    cp.open(opts, model, fingerprint);
+    cp.mined("a", 5);
+    cp.mined("b", 9);
+    cp.mined("skipped", 0);
+    EXPECT_FALSE(cp.settled());
+
+    cp.flushed(6);
+    EXPECT_TRUE(cp.done("a"));
+    EXPECT_TRUE(cp.done("skipped"));
+    EXPECT_FALSE(cp.done("b"));
+
+    ModelCheckpoint reopened;
+    reopened.open(opts, model, fingerprint);
+    EXPECT_EQ(reopened.done_count(), 2u);
+
+    cp.flushed(9);
+    EXPECT_TRUE(cp.settled());
+    EXPECT_TRUE(cp.done("b"));
+}
+
+TEST_F(ModelCheckpointTest, ChangedFingerprintStartsOver) {
+    {
+        ModelCheckpoint cp;
+        cp.open(opts, model, fingerprint);
+        cp.complete("vocab");
+    }
+    ModelCheckpoint cp;
+    cp.open(opts, model, BLAKE3Pipeline::hash("package v2"));
+    EXPECT_EQ(cp.done_count(), 0u);
+
+    ModelCheckpoint::Options off;
+    off.dir = "";
+    ModelCheckpoint disabled;
+    disabled.open(off, model, fingerprint);
+    EXPECT_FALSE(disabled.enabled());
+    disabled.complete("vocab");
+    EXPECT_FALSE(disabled.done("vocab"));
+}
@@ -0,0 +1,117 @@
+/**
+ * @file test_model_extraction.cpp
+ * @brief Streaming and materializing extractors find the same edges as a dense scan
+ */
+
+#include <gtest/gtest.h>
+#include <ml/model_extraction.hpp>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+using namespace hartonomous::ml;
+
+namespace {
+
+using Key = std::tuple<int32_t, int32_t, uint64_t, uint64_t, std::string, std::string, double>;
+
+std::vector<Key> keys(const std::vector<SemanticEdge>& edges) {
+    std::vector<Key> k;
+    for (const auto& e : edges)
+        k.emplace_back(e.layer_index, e.head_index, e.source_id, e.target_id, e.source_token, e.target_token, e.weight);
+    std::sort(k.begin(), k.end());
+    return k;
+}
+
+// Mostly below threshold, with whole 64-row blocks empty
+std::vector<Eigen::MatrixXd> sparse_heads(size_t heads, int n) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Eigen::MatrixXd> out;
+    for (size_t h = 0; h < heads; ++h) {
+        Eigen::MatrixXd m(n, n);
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i) m(i, j) = (i / 64 == 1 || u(rng) < 0.9) ? 0.001 : u(rng);
+        out.push_back(m);
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(ModelExtractionTest, TransformerStreamMatchesDenseScan) {
+    const int n = 150;
+    auto heads = sparse_heads(11, n);
+    std::vector<uint64_t> tokens(n);
+    for (int i = 0; i < n; ++i) tokens[i] = 1000 + i;
+
+    std::vector<SemanticEdge> expected;
+    for (size_t h = 0; h < heads.size(); ++h)
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                if (heads[h](i, j) >= 0.01) {
+                    SemanticEdge e;
+                    e.source_id = tokens[i];
+                    e.target_id = tokens[j];
+                    e.weight = heads[h](i, j);
+                    e.layer_index = static_cast<int32_t>(h / 8);
+                    e.head_index = static_cast<int32_t>(h % 8);
+                    expected.push_back(e);
+                }
+
+    EXPECT_EQ(keys(TransformerExtractor::extract(heads, tokens).edges), keys(expected));
+
+    std::vector<SemanticEdge> streamed;
+    size_t calls = 0;
+    const size_t emitted = TransformerExtractor::stream(heads, tokens, [&](std::vector<SemanticEdge>&& chunk) {
+        EXPECT_LE(chunk.size(), 100u);
+        ++calls;
+        streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+    }, 0.01, 100);
+    EXPECT_EQ(emitted, expected.size());
+    EXPECT_GE(calls, expected.size() / 100);
+    EXPECT_EQ(keys(streamed), keys(expected));
+}
+
+TEST(ModelExtractionTest, CnnStreamMatchesDenseScan) {
+    Eigen::Tensor<float, 4> filters(70, 3, 3, 2);
+    std::mt19937 rng(5);
+    std::normal_distribution<float> g(0.0f, 0.1f);
+    for (Eigen::Index k = 0; k < filters.size(); ++k) filters.data()[k] = g(rng);
+
+    std::vector<SemanticEdge> expected;
+    for (int oc = 0; oc < 70; ++oc)
+        for (int ic = 0; ic < 3; ++ic)
+            for (int y = 0; y < 3; ++y)
+                for (int x = 0; x < 2; ++x) {
+                    const float w = filters(oc, ic, y, x);
+                    if (std::abs(w) < 0.1) continue;
+                    SemanticEdge e;
+                    e.source_token = "feature:in:" + std::to_string(ic);
+                    e.target_token = "feature:out:" + std::to_string(oc) + ":pos:" + std::to_string(y) + "," + std::to_string(x);
+                    e.weight = std::tanh(std::abs(w));
+                    e.layer_index = 4;
+                    expected.push_back(e);
+                }
+    ASSERT_FALSE(expected.empty());
+
+    EXPECT_EQ(keys(CNNExtractor::extract(filters, 4).edges), keys(expected));
+
+    std::vector<SemanticEdge> streamed;
+    CNNExtractor::stream(filters, 4, [&](std::vector<SemanticEdge>&& chunk) {
+        streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+    }, 0.1, 16);
+    EXPECT_EQ(keys(streamed), keys(expected));
+}
+
+TEST(ModelExtractionTest, SinkFailureStopsTheStream) {
+    auto heads = sparse_heads(16, 80);
+    std::vector<uint64_t> tokens(80, 7);
+    size_t calls = 0;
+    EXPECT_THROW(TransformerExtractor::stream(heads, tokens, [&](std::vector<SemanticEdge>&&) {
+        ++calls;
+        throw std::runtime_error("sink full");
+    }, 0.01, 10), std::runtime_error);
+    EXPECT_EQ(calls, 1u);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file test_neighbor_cache.cpp
+ * @brief LRU eviction, budget and invalidation of the neighbor cache
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/neighbor_cache.hpp>
+#include <cstring>
+
+using namespace Hartonomous;
+
+// Low bytes only: every ID lands in the same shard
+static BLAKE3Pipeline::Hash id_of(uint32_t i) {
+    BLAKE3Pipeline::Hash h{};
+    std::memcpy(h.data(), &i, sizeof(i));
+    return h;
+}
+
+static std::vector<NeighborCache::Neighbor> list_of(size_t n) {
+    std::vector<NeighborCache::Neighbor> list;
+    for (size_t i = 0; i < n; ++i) list.push_back({static_cast<uint32_t>(i), 1, 1500.0, 2.0});
+    return list;
+}
+
+TEST(NeighborCacheTest, EvictsLeastRecentlyUsed) {
+    NeighborCache cache(64 * 10);  // 10 neighbors per shard
+    cache.put(id_of(1), list_of(4));
+    cache.put(id_of(2), list_of(4));
+    ASSERT_NE(cache.find(id_of(1)), nullptr);  // 2 is now least recent
+
+    cache.put(id_of(3), list_of(4));
+    EXPECT_EQ(cache.find(id_of(2)), nullptr);
+    auto one = cache.find(id_of(1));
+    ASSERT_NE(one, nullptr);
+    EXPECT_EQ(one->size(), 4u);
+    EXPECT_NE(cache.find(id_of(3)), nullptr);
+
+    auto st = cache.stats();
+    EXPECT_EQ(st.hits, 3u);
+    EXPECT_EQ(st.misses, 1u);
+    EXPECT_EQ(st.evictions, 1u);
+    EXPECT_EQ(st.lists, 2u);
+    EXPECT_EQ(st.neighbors, 8u);
+}
+
+TEST(NeighborCacheTest, OversizedAndReplacedLists) {
+    NeighborCache cache(64 * 10);
+    cache.put(id_of(1), list_of(11));
+    EXPECT_EQ(cache.find(id_of(1)), nullptr);
+
+    cache.put(id_of(2), list_of(3));
+    cache.put(id_of(2), list_of(5));
+    EXPECT_EQ(cache.find(id_of(2))->size(), 5u);
+    EXPECT_EQ(cache.stats().neighbors, 5u);
+}
+
+TEST(NeighborCacheTest, InvalidateKeepsHeldLists) {
+    NeighborCache cache(64 * 10);
+    cache.put(id_of(1), list_of(2));
+    cache.put(id_of(2), list_of(2));
+    auto held = cache.find(id_of(1));
+
+    cache.invalidate(id_of(1));
+    cache.invalidate(id_of(9));
+    EXPECT_EQ(cache.find(id_of(1)), nullptr);
+    ASSERT_NE(held, nullptr);
+    EXPECT_EQ(held->size(), 2u);
+
+    cache.clear();
+    EXPECT_EQ(cache.find(id_of(2)), nullptr);
+    auto st = cache.stats();
+    EXPECT_EQ(st.invalidations, 2u);
+    EXPECT_EQ(st.lists, 0u);
+    EXPECT_EQ(st.neighbors, 0u);
+}
+
+TEST(NeighborCacheTest, ZeroBudgetDisables) {
+    NeighborCache cache(0);
+    cache.put(id_of(1), {});
+    EXPECT_EQ(cache.find(id_of(1)), nullptr);
+}
+
+TEST(NeighborCacheTest, TrimEvictsOldestToTheByteTarget) {
+    NeighborCache cache(64 * 100);
+    cache.put(id_of(1), list_of(4));
+    cache.put(id_of(2), list_of(4));
+    cache.put(id_of(3), list_of(4));
+    const size_t per_list = cache.memory_bytes() / 3;
+    EXPECT_GT(per_list, 4 * sizeof(NeighborCache::Neighbor));
+
+    // Room for two lists in the one shard these IDs share
+    cache.trim(64 * 2 * per_list);
+    EXPECT_EQ(cache.find(id_of(1)), nullptr);
+    EXPECT_NE(cache.find(id_of(3)), nullptr);
+    EXPECT_EQ(cache.memory_bytes(), 2 * per_list);
+
+    cache.clear();
+    EXPECT_EQ(cache.memory_bytes(), 0u);
+}
@@ -147,8 +147,33 @@ TEST(NGramExtractorTest, PositionsAreSorted) {
     ASSERT_NE(ab, nullptr);
     EXPECT_EQ(ab->positions.size(), 2u);
     EXPECT_TRUE(std::is_sorted(ab->positions.begin(), ab->positions.end()));
-    EXPECT_EQ(ab->positions[0], 0u);
-    EXPECT_EQ(ab->positions[1], 2u);
+    EXPECT_EQ(ab->positions.to_vector(), (std::vector<uint32_t>{0, 2}));
+}
+
+TEST(NGramExtractorTest, IntervalPositionsMatchEncoded) {
+    // Gaps past one varint byte, and an n-gram at the very end of the text
+    std::u32string text;
+    for (int i = 0; i < 50; ++i) text += to_u32("xyz") + std::u32string(i * 37 % 300, U'.');
+    NGramConfig config;
+    config.min_frequency = 2;
+    NGramExtractor encoded(config);
+    encoded.extract(text);
+    config.position_storage = PositionStorage::Interval;
+    NGramExtractor interval(config);
+    interval.extract(text);
+
+    ASSERT_EQ(encoded.ngrams().size(), interval.ngrams().size());
+    for (const auto& [id, ng] : interval.ngrams()) {
+        auto it = encoded.ngrams().find(id);
+        ASSERT_NE(it, encoded.ngrams().end());
+        auto positions = ng.positions.to_vector();
+        std::sort(positions.begin(), positions.end());
+        EXPECT_EQ(positions, it->second.positions.to_vector());
+        EXPECT_EQ(positions.size(), ng.frequency);
+    }
+    auto* xyz = find_ngram(encoded, to_u32("xyz"));
+    ASSERT_NE(xyz, nullptr);
+    EXPECT_EQ(xyz->positions.size(), 50u);
 }
 
 // ============================================================================
@@ -312,3 +337,20 @@ TEST(NGramExtractorTest, HashDeterminism) {
     ASSERT_NE(hw2, nullptr);
     EXPECT_EQ(hw1->hash, hw2->hash);
 }
+
+TEST(NGramExtractorTest, SignificantNGramsCarryContentHash) {
+    NGramConfig config;
+    config.min_frequency = 2;
+    NGramExtractor ex(config);
+    ex.extract(to_u32("the cat sat on the mat; the cat sat on the hat"));
+
+    auto sig = ex.significant_ngrams();
+    ASSERT_FALSE(sig.empty());
+    for (const auto* ng : sig) {
+        // BLAKE3 over the little-endian codepoints
+        std::vector<uint8_t> bytes;
+        for (char32_t cp : ng->text)
+            for (int k = 0; k < 4; ++k) bytes.push_back(static_cast<uint8_t>(cp >> (8 * k)));
+        EXPECT_EQ(ng->hash, BLAKE3Pipeline::hash(bytes.data(), bytes.size()));
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file test_pg_event_loop.cpp
+ * @brief PgTask chains results and exceptions; PgEventLoop resumes coroutines when their fds become ready
+ */
+
+#include <gtest/gtest.h>
+#include <database/pg_event_loop.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace Hartonomous;
+
+namespace {
+
+PgTask<int> twice(int v) { co_return v * 2; }
+
+PgTask<int> chained(int v) {
+    int a = co_await twice(v);
+    int b = co_await twice(a);
+    co_return a + b;
+}
+
+PgTask<void> fails() {
+    throw std::runtime_error("boom");
+    co_return;
+}
+
+// Suspend until the pipe has a byte, then read it: what a query does with its socket
+PgTask<char> read_one(PgEventLoop& loop, int fd) {
+    co_await loop.readable(fd);
+    char c = 0;
+    if (::read(fd, &c, 1) != 1) throw std::runtime_error("short read");
+    co_return c;
+}
+
+PgTask<std::thread::id> on_loop(PgEventLoop& loop) {
+    co_await loop.schedule();
+    co_return std::this_thread::get_id();
+}
+
+struct Pipe {
+    int fds[2] = {-1, -1};
+    Pipe() { EXPECT_EQ(::pipe(fds), 0); }
+    ~Pipe() { ::close(fds[0]); ::close(fds[1]); }
+};
+
+} // namespace
+
+TEST(PgEventLoopTest, TasksChainValuesAndExceptions) {
+    PgEventLoop loop(1);
+    EXPECT_EQ(loop.block_on(chained(3)), 6 + 12);
+    EXPECT_THROW(loop.block_on(fails()), std::runtime_error);
+}
+
+TEST(PgEventLoopTest, ScheduleRunsOnALoopThread) {
+    PgEventLoop loop(2);
+    EXPECT_NE(loop.block_on(on_loop(loop)), std::this_thread::get_id());
+}
+
+TEST(PgEventLoopTest, ResumesWhenTheFdIsReadable) {
+    PgEventLoop loop(1);
+    Pipe p;
+    auto f = loop.spawn(read_one(loop, p.fds[0]));
+
+    // Nothing to read yet: the task stays parked in the loop
+    EXPECT_NE(f.wait_for(std::chrono::milliseconds(50)), std::future_status::ready);
+    EXPECT_EQ(loop.waiting(), 1u);
+
+    ASSERT_EQ(::write(p.fds[1], "x", 1), 1);
+    EXPECT_EQ(f.get(), 'x');
+    EXPECT_EQ(loop.waiting(), 0u);
+}
+
+TEST(PgEventLoopTest, ManyWaitersShareFewThreads) {
+    PgEventLoop loop(2);
+    const size_t n = 200;
+    std::vector<Pipe> pipes(n);
+    std::vector<std::future<char>> results;
+    for (size_t i = 0; i < n; ++i) results.push_back(loop.spawn(read_one(loop, pipes[i].fds[0])));
+
+    // Wake them in reverse order; each gets its own byte back
+    for (size_t i = n; i-- > 0;) {
+        char c = static_cast<char>('a' + i % 26);
+        ASSERT_EQ(::write(pipes[i].fds[1], &c, 1), 1);
+    }
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(results[i].get(), static_cast<char>('a' + i % 26));
+}
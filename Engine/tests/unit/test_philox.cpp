@@ -0,0 +1,54 @@
+/**
+ * @file test_philox.cpp
+ * @brief Unit tests for the counter-based walk RNG
+ */
+
+#include <gtest/gtest.h>
+#include <utils/philox.hpp>
+#include <cmath>
+#include <set>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(PhiloxTest, MatchesReferenceVectors) {
+    // Known-answer tests of Random123's philox4x32_10
+    EXPECT_EQ(Philox::block({0, 0, 0, 0}, 0), (Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, 0xffffffffffffffffull),
+              (Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+}
+
+TEST(PhiloxTest, StreamsGetDistinctKeys) {
+    std::set<uint64_t> keys;
+    for (uint64_t s = 0; s < 1000; ++s) keys.insert(Philox::stream_key(7, s));
+    EXPECT_EQ(keys.size(), 1000u);
+    EXPECT_EQ(Philox::stream_key(7, 3), Philox::stream_key(7, 3));
+    EXPECT_NE(Philox::stream_key(7, 3), Philox::stream_key(8, 3));
+}
+
+TEST(PhiloxTest, UniformStaysInsideOpenInterval) {
+    EXPECT_GT(Philox::uniform({0, 0, 0, 0}), 0.0);
+    EXPECT_LT(Philox::uniform({0xffffffff, 0xffffffff, 0, 0}), 1.0);
+}
+
+TEST(PhiloxTest, GumbelMaxFollowsSoftmax) {
+    // The walk's sampler: argmax of logit + Gumbel noise from one block per (step, candidate)
+    const std::vector<double> logits{0.0, -0.5, -1.0, -2.0};
+    std::vector<double> expected(logits.size());
+    double sum = 0.0;
+    for (size_t i = 0; i < logits.size(); ++i) sum += expected[i] = std::exp(logits[i]);
+
+    constexpr uint32_t DRAWS = 200000;
+    std::vector<uint32_t> counts(logits.size(), 0);
+    for (uint32_t step = 0; step < DRAWS; ++step) {
+        size_t best = 0;
+        double best_key = -INFINITY;
+        for (uint32_t i = 0; i < logits.size(); ++i) {
+            double key = logits[i] - std::log(-std::log(Philox::uniform(Philox::block({step, 0, i, 0}, 42))));
+            if (key > best_key) { best_key = key; best = i; }
+        }
+        ++counts[best];
+    }
+    for (size_t i = 0; i < logits.size(); ++i)
+        EXPECT_NEAR(counts[i] / double(DRAWS), expected[i] / sum, 0.005) << "candidate " << i;
+}
@@ -65,3 +65,24 @@ TEST(ProjectionTest, DistributionStability) {
     EXPECT_NEAR(p1.norm(), 1.0, 1e-12);
     EXPECT_NEAR(p2.norm(), 1.0, 1e-12);
 }
+
+
+TEST(ProjectionTest, BatchPointsMatchSinglePoints) {
+    // Past the threading threshold, so the parallel path runs too
+    const size_t N = 5000, first = 17, count = 3000;
+    std::vector<double> spiral(4 * count);
+    SuperFibonacci::points_on_s3(first, count, N, spiral.data());
+    for (size_t i = 0; i < count; ++i) {
+        auto p = SuperFibonacci::point_on_s3(first + i, N);
+        for (int k = 0; k < 4; ++k) EXPECT_EQ(spiral[4 * i + k], p[k]) << i;
+    }
+
+    std::vector<unsigned char> hashes(16 * count);
+    for (size_t i = 0; i < hashes.size(); ++i) hashes[i] = static_cast<unsigned char>(i * 131 + 7);
+    std::vector<double> hashed(4 * count);
+    SuperFibonacci::hash_to_points(hashes.data(), count, hashed.data());
+    for (size_t i = 0; i < count; ++i) {
+        auto p = SuperFibonacci::hash_to_point(hashes.data() + 16 * i);
+        for (int k = 0; k < 4; ++k) EXPECT_EQ(hashed[4 * i + k], p[k]) << i;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_quantized_space.cpp
+ * @brief FP16/int8 HNSW space encodings and distance kernels
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/quantized_space.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(QuantizedSpaceTest, HalfConversionRoundTrips) {
+    for (float f : {0.0f, -0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 6.103515625e-05f, 5.9604645e-08f}) {
+        EXPECT_EQ(QuantizedIPSpace::half_to_float(QuantizedIPSpace::float_to_half(f)), f) << f;
+    }
+    EXPECT_TRUE(std::isinf(QuantizedIPSpace::half_to_float(QuantizedIPSpace::float_to_half(1e6f))));
+    EXPECT_NEAR(QuantizedIPSpace::half_to_float(QuantizedIPSpace::float_to_half(0.1f)), 0.1f, 1e-4f);
+}
+
+TEST(QuantizedSpaceTest, DistancesTrackFloat) {
+    // Odd dimension exercises the zero padding to the kernel width
+    const size_t dim = 77;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> g;
+    auto unit = [&] {
+        std::vector<float> v(dim);
+        float n2 = 0.0f;
+        for (auto& x : v) { x = g(rng); n2 += x * x; }
+        for (auto& x : v) x /= std::sqrt(n2);
+        return v;
+    };
+
+    EXPECT_EQ(QuantizedIPSpace(4096, HnswQuantization::Float32).get_data_size(), 4096u * 4);
+    EXPECT_EQ(QuantizedIPSpace(4096, HnswQuantization::FP16).get_data_size(), 4096u * 2);
+    EXPECT_EQ(QuantizedIPSpace(4096, HnswQuantization::Int8).get_data_size(), 4096u + 4);
+
+    for (auto [quant, tol] : {std::pair{HnswQuantization::FP16, 2e-3f}, std::pair{HnswQuantization::Int8, 3e-2f}}) {
+        QuantizedIPSpace space(dim, quant);
+        auto dist = space.get_dist_func();
+        std::vector<char> ea(space.get_data_size()), eb(space.get_data_size());
+        for (int trial = 0; trial < 50; ++trial) {
+            auto a = unit();
+            auto b = unit();
+            float dot = 0.0f;
+            for (size_t i = 0; i < dim; ++i) dot += a[i] * b[i];
+            space.encode(a.data(), ea.data());
+            space.encode(b.data(), eb.data());
+            EXPECT_NEAR(dist(ea.data(), eb.data(), space.get_dist_func_param()), 1.0f - dot, tol);
+            EXPECT_NEAR(dist(ea.data(), ea.data(), space.get_dist_func_param()), 0.0f, tol);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file test_query_trace.cpp
+ * @brief Unit tests for statement normalization and per-fingerprint aggregates
+ */
+
+#include <gtest/gtest.h>
+#include <database/query_trace.hpp>
+#include <string>
+
+using namespace Hartonomous;
+
+TEST(QueryTraceTest, NormalizesLiteralsAndWhitespace) {
+    EXPECT_EQ(QueryTrace::normalize("SELECT  text\n  FROM hartonomous.composition WHERE id = '0a1b'::uuid LIMIT 10"),
+              "SELECT text FROM hartonomous.composition WHERE id = ?::uuid LIMIT ?");
+    EXPECT_EQ(QueryTrace::normalize("SELECT 'it''s', 1.5e-3, $$body$$, $tag$x$tag$ -- note\n"), "SELECT ?, ?, ?, ?");
+}
+
+TEST(QueryTraceTest, KeepsPlaceholdersAndIdentifiers) {
+    EXPECT_EQ(QueryTrace::normalize("SELECT col2 FROM t1 WHERE a = $1 AND \"Weird 9\" = $12"),
+              "SELECT col2 FROM t1 WHERE a = $1 AND \"Weird 9\" = $12");
+}
+
+TEST(QueryTraceTest, GroupsByFingerprint) {
+    auto& trace = QueryTrace::global();
+    trace.reset();
+    trace.record("SELECT * FROM test_trace WHERE id = 1", 2000000, 1, 100);
+    trace.record("SELECT * FROM test_trace WHERE id = 2", 1000000, 0, 50);
+    trace.record("SELECT count(*) FROM test_trace_other", 500000, 1, 10);
+
+    auto top = trace.top(10);
+    ASSERT_GE(top.size(), 2u);
+    EXPECT_EQ(top[0].sql, "SELECT * FROM test_trace WHERE id = ?");
+    EXPECT_EQ(top[0].calls, 2u);
+    EXPECT_EQ(top[0].total_ns, 3000000u);
+    EXPECT_EQ(top[0].max_ns, 2000000u);
+    EXPECT_EQ(top[0].rows, 1u);
+    EXPECT_EQ(top[0].bytes, 150u);
+    EXPECT_EQ(top[1].calls, 1u);
+
+    const std::string fp = QueryTrace::fingerprint_hex(top[0].fingerprint);
+    EXPECT_EQ(fp.size(), 16u);
+    EXPECT_NE(Metrics::global().prometheus().find("hartonomous_db_statement_calls_total{fingerprint=\"" + fp + "\""),
+              std::string::npos);
+
+    trace.reset();
+    EXPECT_TRUE(trace.top(10).empty());
+}
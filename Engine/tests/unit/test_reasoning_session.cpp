@@ -0,0 +1,131 @@
+/**
+ * @file test_reasoning_session.cpp
+ * @brief ReasoningSession keeps a window of turns and memos that last until the scope or epoch moves
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/reasoning_session.hpp>
+#include <string>
+
+using namespace Hartonomous;
+
+namespace {
+
+BLAKE3Pipeline::Hash H(const std::string& s) { return BLAKE3Pipeline::hash(std::string_view(s)); }
+
+AStarPath path_to(const std::string& goal) {
+    AStarPath p{};
+    p.nodes = {H("start"), H(goal)};
+    p.texts = {"start", goal};
+    p.found = true;
+    return p;
+}
+
+} // namespace
+
+TEST(ReasoningSessionTest, KeepsTheLastTurnsOnly) {
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    for (int i = 0; i < 5; ++i) session.add_turn("user", "turn " + std::to_string(i), {"k" + std::to_string(i)});
+
+    ASSERT_EQ(session.context().size(), ReasoningSession::CONTEXT_TURNS);
+    EXPECT_EQ(session.context().front().content, "turn 2");
+    EXPECT_EQ(session.context().back().keywords, std::vector<std::string>{"k4"});
+    EXPECT_EQ(session.stats().turns, 5u);
+}
+
+TEST(ReasoningSessionTest, MemoizesTermsIncludingMisses) {
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    session.begin_turn("scope", 1);
+
+    EXPECT_FALSE(session.find_term("cat").has_value());
+    session.put_term("cat", H("cat"));
+    session.put_term("zzz", std::nullopt);
+
+    auto cat = session.find_term("cat");
+    ASSERT_TRUE(cat.has_value());
+    EXPECT_EQ(*cat, H("cat"));
+    auto zzz = session.find_term("zzz");
+    ASSERT_TRUE(zzz.has_value());
+    EXPECT_FALSE(zzz->has_value());
+
+    auto s = session.stats();
+    EXPECT_EQ(s.term_hits, 2u);
+    EXPECT_EQ(s.term_misses, 1u);
+}
+
+TEST(ReasoningSessionTest, PathsLastAcrossTurnsInOneScope) {
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    session.begin_turn("scope", 1);
+    session.put_path(H("start"), H("dog"), path_to("dog"));
+    session.put_facts("dog", {"dogs bark"});
+    session.add_turn("user", "tell me about dogs", {"dogs"});
+
+    session.begin_turn("scope", 1);
+    auto p = session.find_path(H("start"), H("dog"));
+    ASSERT_TRUE(p.has_value());
+    EXPECT_EQ(p->texts.back(), "dog");
+    EXPECT_FALSE(session.find_path(H("dog"), H("start")).has_value());
+    EXPECT_EQ(*session.find_facts("dog"), std::vector<std::string>{"dogs bark"});
+}
+
+TEST(ReasoningSessionTest, ScopeOrEpochChangeDropsMemosButNotTurns) {
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    session.begin_turn("tenant a", 1);
+    session.put_term("cat", H("cat"));
+    session.add_turn("user", "cats", {"cats"});
+
+    session.begin_turn("tenant b", 1);
+    EXPECT_FALSE(session.find_term("cat").has_value());
+    EXPECT_EQ(session.context().size(), 1u);
+
+    session.put_term("cat", H("cat"));
+    session.begin_turn("tenant b", 2);
+    EXPECT_FALSE(session.find_term("cat").has_value());
+}
+
+TEST(ReasoningSessionTest, AccountedAndShrunkAtTheNextTurn) {
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    session.begin_turn("scope", 1);
+    for (int i = 0; i < 100; ++i) session.put_path(H("start"), H("g" + std::to_string(i)), path_to("goal"));
+    session.add_turn("user", "a prompt", {"prompt"});
+    const size_t held = session.stats().bytes;
+    EXPECT_GT(held, 100 * sizeof(AStarPath));
+    EXPECT_EQ(governor.used(), held);
+
+    // Over budget: a Low account with no callback is asked, and trims when its owner next runs
+    governor.set_budget(held / 2);
+    session.begin_turn("scope", 1);
+    EXPECT_FALSE(session.find_path(H("start"), H("g0")).has_value());
+    EXPECT_LT(session.stats().bytes, held / 2);
+    EXPECT_EQ(session.context().size(), 1u);
+}
+
+TEST(ReasoningSessionTest, HeldNeighborListsAreRestoredAfterEviction) {
+    auto& cache = NeighborCache::global();
+    if (!cache.enabled()) GTEST_SKIP() << "neighbor cache disabled";
+    cache.clear();
+    MemoryGovernor governor;
+    ReasoningSession session(governor);
+    session.begin_turn("scope", SubstrateEpoch::current());
+
+    const auto seed = H("seed");
+    cache.put(seed, {{1, 2, 1500.0, 3.0}});
+    session.hold_neighbors({seed, H("never cached")});
+
+    cache.clear();
+    session.hold_neighbors({seed});
+    ASSERT_TRUE(cache.contains(seed));
+    EXPECT_EQ(cache.find(seed)->size(), 1u);
+    EXPECT_EQ(session.stats().restores, 1u);
+
+    // Released once no longer a seed
+    session.hold_neighbors({});
+    cache.clear();
+    session.hold_neighbors({seed});
+    EXPECT_FALSE(cache.contains(seed));
+}
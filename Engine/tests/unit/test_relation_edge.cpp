@@ -0,0 +1,94 @@
+/**
+ * @file test_relation_edge.cpp
+ * @brief RelationEdge IDs against their documented byte layouts
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/relation_edge.hpp>
+#include <ingestion/substrate_service.hpp>
+#include <vector>
+
+using namespace Hartonomous;
+using Hash = BLAKE3Pipeline::Hash;
+
+static std::vector<uint8_t> bytes_of(uint8_t tag, std::initializer_list<std::pair<const void*, size_t>> parts) {
+    std::vector<uint8_t> out{tag};
+    for (auto [p, n] : parts) out.insert(out.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    return out;
+}
+
+TEST(RelationEdgeTest, IdsMatchByteLayouts) {
+    Hash a = BLAKE3Pipeline::hash("alpha");
+    Hash b = BLAKE3Pipeline::hash("beta");
+    const Hash& lo = std::memcmp(a.data(), b.data(), 16) < 0 ? a : b;
+    const Hash& hi = (&lo == &a) ? b : a;
+
+    Hash rid = RelationEdge::relation_id(a, b);
+    EXPECT_EQ(rid, RelationEdge::relation_id(b, a));
+    EXPECT_EQ(rid, BLAKE3Pipeline::hash(bytes_of(0x52, {{lo.data(), 16}, {hi.data(), 16}})));
+
+    Eigen::Vector4d ca(0.5, 0.5, 0.5, 0.5), cb(1, 0, 0, 0);
+    RelationEdge edge(rid, a, b, &ca, &cb);
+    Eigen::Vector4d mid = ((ca + cb) * 0.5).normalized();
+    EXPECT_TRUE(edge.centroid.isApprox(mid));
+    EXPECT_EQ(edge.physicality_id, BLAKE3Pipeline::hash(bytes_of(0x50, {{mid.data(), 32}, {ca.data(), 32}, {cb.data(), 32}})));
+
+    auto phys = edge.physicality();
+    ASSERT_EQ(phys.trajectory.size(), 2u);
+    EXPECT_EQ(phys.trajectory[0], ca);
+
+    for (uint32_t ord = 0; ord < 2; ++ord) {
+        const Hash& cid = ord == 0 ? a : b;
+        auto seq = edge.sequence(ord);
+        EXPECT_EQ(seq.composition_id, cid);
+        EXPECT_EQ(seq.id, BLAKE3Pipeline::hash(bytes_of(0x54, {{rid.data(), 16}, {cid.data(), 16}, {&ord, 4}})));
+    }
+
+    // Sorted sequences follow ID order whatever the argument order
+    RelationEdge sorted(rid, hi, lo, &cb, &ca, true);
+    EXPECT_EQ(sorted.sequence(0).composition_id, lo);
+
+    std::string tag = "attention_qk";
+    int32_t layer = 7;
+    std::vector<uint8_t> ev(a.begin(), a.end());
+    ev.insert(ev.end(), rid.begin(), rid.end());
+    ev.insert(ev.end(), tag.begin(), tag.end());
+    ev.insert(ev.end(), reinterpret_cast<uint8_t*>(&layer), reinterpret_cast<uint8_t*>(&layer) + 4);
+    EXPECT_EQ(RelationEdge::evidence_id(a, rid, tag, layer), BLAKE3Pipeline::hash(ev));
+    ev.resize(32);
+    EXPECT_EQ(RelationEdge::evidence_id(a, rid), BLAKE3Pipeline::hash(ev));
+}
+
+TEST(RelationEdgeTest, MissingCentroidFallsBack) {
+    Hash a = BLAKE3Pipeline::hash("x");
+    Hash b = BLAKE3Pipeline::hash("y");
+    Eigen::Vector4d cb(0, 1, 0, 0);
+    RelationEdge edge(RelationEdge::relation_id(a, b), a, b, nullptr, &cb);
+    EXPECT_EQ(edge.centroid, Eigen::Vector4d(1, 0, 0, 0));
+    ASSERT_EQ(edge.trajectory_size, 1u);
+    EXPECT_EQ(edge.physicality().trajectory[0], cb);
+}
+
+TEST(RelationEdgeTest, IdentityFirstMatchesComputeRelation) {
+    using Service = SubstrateService;
+    Service::CachedComp a{BLAKE3Pipeline::hash("left"), {}, Eigen::Vector4d(0.5, 0.5, 0.5, 0.5), true};
+    Service::CachedComp b{BLAKE3Pipeline::hash("right"), {}, Eigen::Vector4d(0, 0, 1, 0), true};
+    Hash content = BLAKE3Pipeline::hash("content");
+
+    auto full = Service::compute_relation(a, b, content);
+    auto split = Service::identify_relation(a, b, content);
+    ASSERT_TRUE(split.valid);
+    EXPECT_EQ(split.rel.id, full.rel.id);
+    EXPECT_EQ(split.evidence.id, full.evidence.id);
+    EXPECT_EQ(split.rating.relation_id, full.rel.id);
+    EXPECT_TRUE(split.seq.empty());
+
+    Service::add_relation_geometry(a, b, split);
+    EXPECT_EQ(split.rel.physicality_id, full.rel.physicality_id);
+    EXPECT_EQ(split.phys.id, full.phys.id);
+    ASSERT_EQ(split.seq.size(), 2u);
+    EXPECT_EQ(split.seq[0].id, full.seq[0].id);
+    EXPECT_EQ(split.seq[1].id, full.seq[1].id);
+
+    EXPECT_FALSE(Service::identify_relation(a, a, content).valid);
+}
@@ -0,0 +1,385 @@
+/**
+ * @file test_relation_graph.cpp
+ * @brief Unit tests for the CSR relation graph snapshot
+ *
+ * Builds graphs from in-memory edge lists and round-trips them through
+ * snapshot files. No database needed.
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/relation_graph.hpp>
+#include <utils/numa.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+
+using namespace Hartonomous;
+
+static BLAKE3Pipeline::Hash H(const char* s) { return BLAKE3Pipeline::hash(std::string_view(s)); }
+
+static std::vector<RelationGraph::EdgeRecord> sample_edges() {
+    return {
+        {H("a"), H("b"), 1500.0, 3.0, 1},
+        {H("a"), H("c"), 1200.0, 1.0, 1},
+        {H("b"), H("a"), 1500.0, 3.0, 1},
+        {H("a"), H("b"), 1700.0, 2.0, 2},  // Second relation between a and b
+    };
+}
+
+TEST(RelationGraphTest, MergesDuplicatePairs) {
+    auto g = RelationGraph::from_edges(sample_edges());
+    EXPECT_EQ(g->node_count(), 3u);
+    EXPECT_EQ(g->edge_count(), 3u);
+
+    auto a = g->neighbors(H("a"));
+    ASSERT_EQ(a.size(), 2u);
+    const RelationGraph::Edge* ab = nullptr;
+    for (const auto& e : a)
+        if (g->id_of(e.target) == H("b")) ab = &e;
+    ASSERT_NE(ab, nullptr);
+    EXPECT_DOUBLE_EQ(ab->max_elo, 1700.0);
+    EXPECT_DOUBLE_EQ(ab->total_obs, 5.0);
+    EXPECT_EQ(ab->relation_count, 3u);
+
+    // c only appears as a target: indexed, with an empty row
+    EXPECT_NE(g->index_of(H("c")), RelationGraph::NPOS);
+    EXPECT_TRUE(g->neighbors(H("c")).empty());
+    EXPECT_EQ(g->index_of(H("missing")), RelationGraph::NPOS);
+    EXPECT_TRUE(g->neighbors(H("missing")).empty());
+}
+
+TEST(RelationGraphTest, OverlayReplacesRowsAndCompacts) {
+    auto base = RelationGraph::from_edges(sample_edges());
+    uint32_t a = base->index_of(H("a"));
+
+    // New rating for a->c, a brand-new neighbor d; a->b dropped from a's row
+    auto next = RelationGraph::with_rows(base, {
+        {H("a"), H("c"), 1800.0, 4.0, 1},
+        {H("a"), H("d"), 1100.0, 1.0, 1},
+    });
+    EXPECT_EQ(next->node_count(), 4u);
+    EXPECT_EQ(next->index_of(H("a")), a);
+    EXPECT_EQ(next->overlay_rows(), 1u);
+    EXPECT_EQ(next->edge_count(), 3u);
+
+    auto row = next->neighbors(a);
+    ASSERT_EQ(row.size(), 2u);
+    EXPECT_EQ(next->id_of(row[0].target), H("c"));
+    EXPECT_DOUBLE_EQ(row[0].max_elo, 1800.0);
+    EXPECT_EQ(next->id_of(row[1].target), H("d"));
+
+    // Earlier epochs are untouched
+    EXPECT_EQ(base->neighbors(a).size(), 2u);
+    EXPECT_EQ(base->node_count(), 3u);
+
+    auto flat = next->compact();
+    EXPECT_EQ(flat->overlay_rows(), 0u);
+    EXPECT_EQ(flat->node_count(), 4u);
+    EXPECT_EQ(flat->edge_count(), 3u);
+    EXPECT_EQ(flat->index_of(H("d")), next->index_of(H("d")));
+    ASSERT_EQ(flat->neighbors(a).size(), 2u);
+    EXPECT_EQ(flat->neighbors(H("b")).size(), 1u);
+}
+
+TEST(RelationGraphTest, ReplicaOnNodeLayersLikeTheOriginal) {
+    auto base = RelationGraph::from_edges(sample_edges());
+    const std::vector<RelationGraph::EdgeRecord> rows = {{H("a"), H("d"), 1100.0, 1.0, 1}};
+    auto next = RelationGraph::with_rows(base, rows);
+
+    auto replica = run_on_node(numa_node_count() - 1, [&] { return next->replicate(); });
+    ASSERT_EQ(replica->node_count(), next->node_count());
+    for (uint32_t i = 0; i < next->node_count(); ++i) {
+        EXPECT_EQ(replica->id_of(i), next->id_of(i));
+        EXPECT_EQ(replica->neighbors(i).size(), next->neighbors(i).size());
+    }
+
+    // LiveRelationGraph layers each refresh over every node's copy
+    const std::vector<RelationGraph::EdgeRecord> more = {{H("b"), H("e"), 1300.0, 1.0, 1}};
+    auto layered = RelationGraph::with_rows(replica, more);
+    auto expected = RelationGraph::with_rows(next, more);
+    ASSERT_EQ(layered->node_count(), expected->node_count());
+    for (uint32_t i = 0; i < expected->node_count(); ++i) {
+        EXPECT_EQ(layered->id_of(i), expected->id_of(i));
+        EXPECT_EQ(layered->neighbors(i).size(), expected->neighbors(i).size());
+    }
+}
+
+TEST(RelationGraphTest, FileRoundTrip) {
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph.bin").string();
+    auto g = RelationGraph::from_edges(sample_edges(), "fp-1");
+    g->write_file(path);
+
+    EXPECT_EQ(RelationGraph::load_file(path, "fp-2"), nullptr);
+
+    auto m = RelationGraph::load_file(path, "fp-1");
+    ASSERT_NE(m, nullptr);
+    EXPECT_TRUE(m->is_mapped());
+    EXPECT_EQ(m->fingerprint(), "fp-1");
+    const auto usage = m->huge_page_usage();
+    EXPECT_GE(usage.bytes, std::filesystem::file_size(path));
+    EXPECT_LE(usage.huge_bytes, usage.bytes);
+    ASSERT_EQ(m->node_count(), g->node_count());
+    ASSERT_EQ(m->edge_count(), g->edge_count());
+    for (uint32_t i = 0; i < g->node_count(); ++i) {
+        EXPECT_EQ(m->id_of(i), g->id_of(i));
+        EXPECT_EQ(m->index_of(g->id_of(i)), i);
+        auto x = g->neighbors(i);
+        auto y = m->neighbors(i);
+        ASSERT_EQ(x.size(), y.size());
+        for (size_t k = 0; k < x.size(); ++k) {
+            EXPECT_EQ(x[k].target, y[k].target);
+            EXPECT_DOUBLE_EQ(x[k].max_elo, y[k].max_elo);
+            EXPECT_DOUBLE_EQ(x[k].total_obs, y[k].total_obs);
+        }
+    }
+
+    // A flipped byte invalidates the checksum
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(-1, std::ios::end);
+        f.put('\x7f');
+    }
+    EXPECT_EQ(RelationGraph::load_file(path), nullptr);
+    std::remove(path.c_str());
+}
+
+TEST(RelationGraphTest, PinnedFileIsSharedUntilReplaced) {
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph_pinned.bin").string();
+    RelationGraph::from_edges(sample_edges(), "fp-pin")->write_file(path);
+    ASSERT_TRUE(RelationGraph::pin_file(path));
+
+    auto a = RelationGraph::load_file(path, "fp-pin");
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(RelationGraph::load_file(path), a);
+    EXPECT_EQ(RelationGraph::load_file(path, "fp-other"), nullptr);
+
+    // write_file renames a new file into place, which is mapped afresh
+    RelationGraph::from_edges(sample_edges(), "fp-new")->write_file(path);
+    auto b = RelationGraph::load_file(path, "fp-new");
+    ASSERT_NE(b, nullptr);
+    EXPECT_NE(b, a);
+    EXPECT_EQ(a->fingerprint(), "fp-pin");
+    std::remove(path.c_str());
+}
+
+TEST(RelationGraphTest, PagedFileServesRowsAndPinsHubs) {
+    const uint32_t degree = RelationGraph::HUB_DEGREE + 10;
+    std::vector<RelationGraph::EdgeRecord> edges = sample_edges();
+    for (uint32_t i = 0; i < degree; ++i) {
+        const std::string name = "p" + std::to_string(i);
+        edges.push_back({H("hub"), H(name.c_str()), 1000.0 + i, 1.0, 1});
+    }
+    auto g = RelationGraph::from_edges(edges, "fp-paged");
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph_paged.bin").string();
+    g->write_file(path);
+
+    EXPECT_EQ(RelationGraph::load_paged(path, "fp-other"), nullptr);
+    auto m = RelationGraph::load_paged(path, "fp-paged", size_t(64) << 20);
+    ASSERT_NE(m, nullptr);
+    EXPECT_TRUE(m->is_paged());
+    EXPECT_TRUE(m->is_mapped());
+    EXPECT_FALSE(g->is_paged());
+    EXPECT_LE(m->resident_bytes(), std::filesystem::file_size(path) + 4096);
+
+    std::vector<uint32_t> all(g->node_count());
+    for (uint32_t i = 0; i < all.size(); ++i) all[i] = i;
+    m->prefetch(all);
+    g->prefetch(all);   // No-op off a paged mapping
+    for (uint32_t i = 0; i < g->node_count(); ++i) {
+        auto x = g->neighbors(i);
+        auto y = m->neighbors(i);
+        ASSERT_EQ(x.size(), y.size());
+        for (size_t k = 0; k < x.size(); ++k) EXPECT_EQ(x[k].target, y[k].target);
+    }
+
+    // With no budget nothing is locked; the hub row still reads back
+    auto cold = RelationGraph::load_paged(path, "fp-paged", 0);
+    ASSERT_NE(cold, nullptr);
+    EXPECT_EQ(cold->pinned_bytes(), 0u);
+    EXPECT_EQ(cold->neighbors(H("hub")).size(), degree);
+    EXPECT_EQ(cold->hub_edges(cold->index_of(H("hub"))).size(), RelationGraph::HUB_TOP);
+    EXPECT_LE(m->pinned_bytes(), size_t(64) << 20);
+    std::remove(path.c_str());
+}
+
+TEST(RelationGraphTest, HubRowsKeepSummaryAndBestEdges) {
+    const uint32_t degree = RelationGraph::HUB_DEGREE + 10;
+    std::vector<RelationGraph::EdgeRecord> edges;
+    for (uint32_t i = 0; i < degree; ++i) {
+        const std::string name = "n" + std::to_string(i);
+        edges.push_back({H("hub"), H(name.c_str()), 1000.0 + i, 1.0 + (i % 7), 1});
+        edges.push_back({H(name.c_str()), H("hub"), 1000.0 + i, 1.0 + (i % 7), 1});
+    }
+    auto g = RelationGraph::from_edges(edges, "fp-hub");
+    const uint32_t hub = g->index_of(H("hub"));
+
+    const auto& s = g->summary(hub);
+    EXPECT_EQ(s.degree, degree);
+    EXPECT_DOUBLE_EQ(s.min_elo, 1000.0);
+    EXPECT_DOUBLE_EQ(s.max_elo, 1000.0 + degree - 1);
+    EXPECT_DOUBLE_EQ(s.max_obs, 7.0);
+    EXPECT_EQ(g->summary(g->index_of(H("n0"))).hub_count, 0u);
+    EXPECT_EQ(g->summary(RelationGraph::NPOS).degree, 0u);
+
+    // Best first, and no edge left out ranks above the last one kept
+    auto row = g->neighbors(hub);
+    auto best = g->hub_edges(hub);
+    ASSERT_EQ(best.size(), RelationGraph::HUB_TOP);
+    for (size_t i = 1; i < best.size(); ++i)
+        EXPECT_GE(RelationGraph::hub_rank(row[best[i - 1]], s), RelationGraph::hub_rank(row[best[i]], s));
+    std::vector<bool> kept(row.size());
+    for (uint32_t at : best) kept[at] = true;
+    const double cutoff = RelationGraph::hub_rank(row[best.back()], s);
+    for (size_t i = 0; i < row.size(); ++i)
+        if (!kept[i]) EXPECT_LE(RelationGraph::hub_rank(row[i], s), cutoff);
+
+    // Stored in the file
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph_hub.bin").string();
+    g->write_file(path);
+    auto m = RelationGraph::load_file(path, "fp-hub");
+    ASSERT_NE(m, nullptr);
+    EXPECT_EQ(m->summary(hub).degree, degree);
+    ASSERT_EQ(m->hub_edges(hub).size(), best.size());
+    EXPECT_TRUE(std::equal(best.begin(), best.end(), m->hub_edges(hub).begin()));
+    std::remove(path.c_str());
+
+    // A replaced row is summarized again: no longer a hub
+    auto next = RelationGraph::with_rows(m, {{H("hub"), H("n1"), 1900.0, 2.0, 1}});
+    EXPECT_EQ(next->summary(hub).degree, 1u);
+    EXPECT_DOUBLE_EQ(next->summary(hub).min_elo, 1900.0);
+    EXPECT_TRUE(next->hub_edges(hub).empty());
+    EXPECT_EQ(next->compact()->summary(hub).degree, 1u);
+    EXPECT_EQ(next->summary(g->index_of(H("n5"))).degree, 1u);
+}
+
+TEST(RelationGraphTest, PackedRowsMatchFlatWithinQuantization) {
+    // Whole small counts in most rows, fractional and huge ones in a few, and a hub
+    std::vector<RelationGraph::EdgeRecord> edges;
+    uint64_t seed = 7;
+    auto next = [&] { return seed = seed * 6364136223846793005ull + 1442695040888963407ull, seed >> 33; };
+    for (int s = 0; s < 200; ++s) {
+        const std::string src = "p" + std::to_string(s);
+        const int degree = s == 0 ? int(RelationGraph::HUB_DEGREE) + 50 : int(next() % 40);
+        for (int k = 0; k < degree; ++k) {
+            const std::string dst = s == 0 ? "h" + std::to_string(k) : "p" + std::to_string(next() % 300);
+            double obs = double(next() % 200);
+            if (s % 17 == 0) obs = obs * 1e9 + 0.25;
+            edges.push_back({H(src.c_str()), H(dst.c_str()), 800.0 + double(next() % 1600), obs,
+                             uint32_t(1 + next() % 3), uint64_t(1 + next() % 3)});
+        }
+    }
+    auto flat = RelationGraph::from_edges(edges, "fp-pack", {H("t0"), H("t1")});
+    auto packed = flat->pack();
+    ASSERT_TRUE(packed->is_packed());
+    EXPECT_FALSE(flat->is_packed());
+    EXPECT_LT(packed->edge_bytes() * 2, flat->edge_bytes());
+    ASSERT_EQ(packed->node_count(), flat->node_count());
+    ASSERT_EQ(packed->edge_count(), flat->edge_count());
+
+    const double elo_step = 1600.0 / 65535.0;
+    std::vector<RelationGraph::Edge> scratch;
+    for (uint32_t i = 0; i < flat->node_count(); ++i) {
+        auto x = flat->neighbors(i);
+        auto y = packed->neighbors(i, scratch);
+        ASSERT_EQ(x.size(), y.size());
+        for (size_t k = 0; k < x.size(); ++k) {
+            EXPECT_EQ(x[k].target, y[k].target);
+            EXPECT_EQ(x[k].relation_count, y[k].relation_count);
+            EXPECT_NEAR(x[k].max_elo, y[k].max_elo, elo_step);
+            EXPECT_NEAR(x[k].total_obs, y[k].total_obs, (1.0 + x[k].total_obs) * 4e-4);
+        }
+        auto mx = flat->tenant_masks(i);
+        auto my = packed->tenant_masks(i);
+        EXPECT_TRUE(std::equal(mx.begin(), mx.end(), my.begin(), my.end()));
+        EXPECT_EQ(packed->summary(i).degree, flat->summary(i).degree);
+    }
+    const uint32_t hub = packed->index_of(H("p0"));
+    EXPECT_EQ(packed->hub_edges(hub).size(), RelationGraph::HUB_TOP);
+
+    // The file keeps the packed form; an overlay over it compacts back to packed
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph_packed.bin").string();
+    packed->write_file(path);
+    auto m = RelationGraph::load_file(path, "fp-pack");
+    ASSERT_NE(m, nullptr);
+    EXPECT_TRUE(m->is_packed());
+    for (uint32_t i = 0; i < packed->node_count(); ++i) {
+        auto x = packed->neighbors(i, scratch);
+        auto y = m->neighbors(i);
+        ASSERT_EQ(x.size(), y.size());
+        for (size_t k = 0; k < x.size(); ++k) {
+            EXPECT_EQ(x[k].target, y[k].target);
+            EXPECT_DOUBLE_EQ(x[k].max_elo, y[k].max_elo);
+            EXPECT_DOUBLE_EQ(x[k].total_obs, y[k].total_obs);
+        }
+    }
+    std::remove(path.c_str());
+
+    auto layered = RelationGraph::with_rows(m, {{H("p1"), H("p2"), 1234.0, 9.0, 1, 1}});
+    ASSERT_EQ(layered->neighbors(H("p1")).size(), 1u);
+    auto compacted = layered->compact();
+    EXPECT_TRUE(compacted->is_packed());
+    auto row = compacted->neighbors(H("p1"));
+    ASSERT_EQ(row.size(), 1u);
+    EXPECT_EQ(compacted->id_of(row[0].target), H("p2"));
+    EXPECT_DOUBLE_EQ(row[0].total_obs, 9.0);
+    EXPECT_EQ(compacted->neighbors(hub).size(), packed->neighbors(hub).size());
+}
+
+// Edge a->b backed by tenants 0 and 1, a->c by tenant 1 only
+static std::shared_ptr<const RelationGraph> tenant_graph() {
+    std::vector<RelationGraph::EdgeRecord> edges = {
+        {H("a"), H("b"), 1500.0, 3.0, 1, 0b01},
+        {H("a"), H("b"), 1700.0, 2.0, 1, 0b10},
+        {H("a"), H("c"), 1200.0, 1.0, 1, 0b10},
+        {H("b"), H("a"), 1500.0, 3.0, 1, 0b01},
+    };
+    return RelationGraph::from_edges(std::move(edges), "fp-t", {H("t0"), H("t1")});
+}
+
+static size_t visible(const RelationGraph& g, const char* node, const char* tenant) {
+    const uint64_t view = RelationGraph::tenant_view(&g, H(tenant));
+    size_t n = 0;
+    for (uint64_t m : g.tenant_masks(H(node))) n += (m & view) != 0;
+    return n;
+}
+
+TEST(RelationGraphTest, TenantMasksMergeAndFilter) {
+    auto g = tenant_graph();
+    ASSERT_TRUE(g->has_tenant_masks());
+    EXPECT_EQ(g->tenant_masks(H("a")).size(), g->neighbors(H("a")).size());
+    EXPECT_EQ(visible(*g, "a", "t0"), 1u);
+    EXPECT_EQ(visible(*g, "a", "t1"), 2u);
+    EXPECT_EQ(visible(*g, "a", "unknown"), 0u);
+    EXPECT_EQ(RelationGraph::tenant_view(g.get(), std::nullopt), RelationGraph::ALL_TENANTS);
+
+    // Graphs without masks refuse a tenant view instead of showing everything
+    auto plain = RelationGraph::from_edges(sample_edges());
+    EXPECT_FALSE(plain->has_tenant_masks());
+    EXPECT_TRUE(plain->tenant_masks(H("a")).empty());
+    EXPECT_THROW(RelationGraph::tenant_view(plain.get(), H("t0")), std::runtime_error);
+    EXPECT_THROW(RelationGraph::tenant_view(nullptr, H("t0")), std::runtime_error);
+}
+
+TEST(RelationGraphTest, TenantMasksSurviveOverlayCompactAndFile) {
+    auto g = tenant_graph();
+    auto next = RelationGraph::with_rows(g, {{H("a"), H("d"), 1100.0, 1.0, 1, 0b01}});
+    EXPECT_EQ(visible(*next, "a", "t0"), 1u);
+    EXPECT_EQ(visible(*next, "a", "t1"), 0u);
+    EXPECT_EQ(visible(*next, "b", "t0"), 1u);
+
+    auto flat = next->compact();
+    EXPECT_TRUE(flat->has_tenant_masks());
+    EXPECT_EQ(visible(*flat, "a", "t0"), 1u);
+    EXPECT_EQ(visible(*flat, "b", "t1"), 0u);
+
+    auto path = (std::filesystem::temp_directory_path() / "hartonomous_test_relation_graph_tenants.bin").string();
+    g->write_file(path);
+    auto m = RelationGraph::load_file(path, "fp-t");
+    ASSERT_NE(m, nullptr);
+    EXPECT_TRUE(m->has_tenant_masks());
+    EXPECT_EQ(m->tenants(), g->tenants());
+    EXPECT_EQ(visible(*m, "a", "t0"), 1u);
+    EXPECT_EQ(visible(*m, "a", "t1"), 2u);
+    std::remove(path.c_str());
+}
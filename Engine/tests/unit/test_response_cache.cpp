@@ -0,0 +1,73 @@
+/**
+ * @file test_response_cache.cpp
+ * @brief Unit tests for the epoch-stamped answer cache
+ */
+
+#include <gtest/gtest.h>
+#include <query/response_cache.hpp>
+#include <thread>
+
+using namespace Hartonomous;
+
+static ResponseCacheOptions options(size_t capacity, std::chrono::seconds ttl = std::chrono::seconds(0)) {
+    ResponseCacheOptions o;
+    o.capacity = capacity;
+    o.ttl = ttl;
+    return o;
+}
+
+TEST(ResponseCacheTest, NormalizesWhitespaceOnly) {
+    EXPECT_EQ(normalized_prompt("  What is\t the   captain's name? \n"), "What is the captain's name?");
+    EXPECT_EQ(normalized_prompt(" \t "), "");
+}
+
+TEST(ResponseCacheTest, HitsWithinEpoch) {
+    ResponseCache<int> cache(options(8));
+    EXPECT_FALSE(cache.get("q"));
+    cache.put("q", 42, SubstrateEpoch::current());
+    ASSERT_TRUE(cache.get("q"));
+    EXPECT_EQ(*cache.get("q"), 42);
+    EXPECT_EQ(cache.stats().hits, 2u);
+}
+
+TEST(ResponseCacheTest, EpochAdvanceRetiresEntries) {
+    ResponseCache<int> cache(options(8));
+    cache.put("q", 1, SubstrateEpoch::current());
+    SubstrateEpoch::advance();
+    EXPECT_FALSE(cache.get("q"));
+    EXPECT_EQ(cache.stats().stale, 1u);
+
+    // Computed before a write landed: not stored at all
+    const uint64_t before = SubstrateEpoch::current();
+    SubstrateEpoch::advance();
+    cache.put("q", 2, before);
+    EXPECT_FALSE(cache.get("q"));
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsed) {
+    ResponseCache<int> cache(options(2));
+    const uint64_t e = SubstrateEpoch::current();
+    cache.put("a", 1, e);
+    cache.put("b", 2, e);
+    EXPECT_TRUE(cache.get("a"));  // b is now the oldest
+    cache.put("c", 3, e);
+    EXPECT_TRUE(cache.get("a"));
+    EXPECT_FALSE(cache.get("b"));
+    EXPECT_TRUE(cache.get("c"));
+    EXPECT_EQ(cache.stats().entries, 2u);
+}
+
+TEST(ResponseCacheTest, ExpiresAfterTtl) {
+    ResponseCache<int> cache(options(8, std::chrono::seconds(1)));
+    cache.put("q", 1, SubstrateEpoch::current());
+    EXPECT_TRUE(cache.get("q"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_FALSE(cache.get("q"));
+}
+
+TEST(ResponseCacheTest, ZeroCapacityDisables) {
+    ResponseCache<int> cache(options(0));
+    EXPECT_FALSE(cache.enabled());
+    cache.put("q", 1, SubstrateEpoch::current());
+    EXPECT_FALSE(cache.get("q"));
+}
@@ -0,0 +1,161 @@
+/**
+ * @file test_s3_batch.cpp
+ * @brief Unit tests for the batch S3 kernels at every SIMD level this CPU supports
+ */
+
+#include <gtest/gtest.h>
+#include <geometry/s3_batch.hpp>
+#include <geometry/s3_centroid.hpp>
+#include <geometry/s3_distance.hpp>
+#include <geometry/hopf_fibration.hpp>
+#include <utils/cpu_dispatch.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace s3;
+
+namespace {
+
+using Hartonomous::SimdLevel;
+
+constexpr SimdLevel ALL_LEVELS[] = {SimdLevel::Scalar, SimdLevel::Sse4, SimdLevel::Avx2, SimdLevel::Avx512};
+
+// 37 points: not a multiple of any vector width, so every path runs a tail
+struct Columns {
+    std::vector<double> x, y, z, w;
+    explicit Columns(size_t n) : x(n), y(n), z(n), w(n) {
+        std::mt19937_64 rng(42);
+        std::normal_distribution<double> g;
+        for (size_t i = 0; i < n; ++i) {
+            Vec4 p = {g(rng), g(rng), g(rng), g(rng)};
+            normalize(p);
+            x[i] = p[0]; y[i] = p[1]; z[i] = p[2]; w[i] = p[3];
+        }
+    }
+    Vec4 at(size_t i) const { return {x[i], y[i], z[i], w[i]}; }
+};
+
+// Levels above the host's are clamped to it, so those runs repeat the widest path
+class S3BatchTest : public ::testing::Test {
+protected:
+    void TearDown() override { Hartonomous::limit_simd(SimdLevel::Avx512); }
+};
+
+} // namespace
+
+TEST_F(S3BatchTest, GeodesicMatchesScalarOnEveryLevel) {
+    const size_t n = 37;
+    Columns c(n);
+    const Vec4 q = c.at(0);
+    std::vector<float> fx(c.x.begin(), c.x.end()), fy(c.y.begin(), c.y.end());
+    std::vector<float> fz(c.z.begin(), c.z.end()), fw(c.w.begin(), c.w.end());
+
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(Hartonomous::simd_level_name(Hartonomous::limit_simd(level)));
+        std::vector<double> dot(n), dist(n);
+        std::vector<float> fdist(n);
+        dot_many(q, c.x.data(), c.y.data(), c.z.data(), c.w.data(), n, dot.data());
+        geodesic_many(q, c.x.data(), c.y.data(), c.z.data(), c.w.data(), n, dist.data());
+        geodesic_many(q, fx.data(), fy.data(), fz.data(), fw.data(), n, fdist.data());
+        for (size_t i = 0; i < n; ++i) {
+            const double exact = geodesic_distance(q, c.at(i));
+            EXPECT_NEAR(dot[i], s3::dot(q, c.at(i)), 1e-15);
+            EXPECT_NEAR(dist[i], exact, 5e-8);
+            EXPECT_NEAR(fdist[i], exact, 2e-3);   // acos' slope near 0 amplifies float rounding
+        }
+    }
+}
+
+TEST_F(S3BatchTest, FastAcosCoversTheClampedRange) {
+    for (double x = -1.0; x <= 1.0; x += 1.0 / 64)
+        EXPECT_NEAR(fast_acos(x), std::acos(x), 5e-8) << x;
+    EXPECT_NEAR(fast_acos(1.5), 0.0, 1e-8);
+    EXPECT_NEAR(fast_acos(-1.5), M_PI, 1e-8);
+}
+
+TEST_F(S3BatchTest, NormalizeLeavesZeroVectors) {
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(Hartonomous::simd_level_name(Hartonomous::limit_simd(level)));
+        std::vector<double> x = {3, 0, 1}, y = {0, 0, 1}, z = {4, 0, 1}, w = {0, 0, 1};
+        normalize_many(x.data(), y.data(), z.data(), w.data(), x.size());
+        EXPECT_NEAR(x[0], 0.6, 1e-15);
+        EXPECT_NEAR(z[0], 0.8, 1e-15);
+        EXPECT_EQ(x[1], 0.0);
+        EXPECT_EQ(w[1], 0.0);
+        EXPECT_NEAR(x[2] * x[2] + y[2] * y[2] + z[2] * z[2] + w[2] * w[2], 1.0, 1e-15);
+    }
+}
+
+TEST_F(S3BatchTest, CentroidSumsAreBitIdenticalAcrossLevels) {
+    const size_t n = 37;
+    Columns c(n);
+    std::vector<double> points(4 * n);
+    for (size_t i = 0; i < n; ++i)
+        for (int k = 0; k < 4; ++k) points[4 * i + k] = c.at(i)[k];
+    const std::vector<size_t> counts = {1, 0, 17, 19};
+
+    // The reference is the plain left-to-right sum the centroid hash was defined on
+    std::vector<double> expected(4 * counts.size(), 0.0);
+    for (size_t g = 0, i = 0; g < counts.size(); ++g)
+        for (size_t j = 0; j < counts[g]; ++j, ++i)
+            for (int k = 0; k < 4; ++k) expected[4 * g + k] += points[4 * i + k];
+
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(Hartonomous::simd_level_name(Hartonomous::limit_simd(level)));
+        std::vector<double> sums(4 * counts.size());
+        centroid_sums(points.data(), counts.data(), counts.size(), sums.data());
+        EXPECT_EQ(sums, expected);
+
+        Eigen::Vector4d ref(expected[8], expected[9], expected[10], expected[11]);
+        ref /= 17.0;
+        ref /= ref.norm();
+        EXPECT_TRUE(Hartonomous::Geometry::compute_s3_mean(points.data() + 4, 17) == ref);
+    }
+}
+
+TEST_F(S3BatchTest, FastSincosMatchesLibm) {
+    for (double x = -40.0; x <= 40.0; x += 0.0137) {
+        double s, c;
+        fast_sincos(x, s, c);
+        // Range reduction loses bits in proportion to |x|
+        const double tol = 1e-15 * std::max(1.0, std::abs(x) / 4);
+        EXPECT_NEAR(s, std::sin(x), tol) << x;
+        EXPECT_NEAR(c, std::cos(x), tol) << x;
+    }
+}
+
+TEST_F(S3BatchTest, HopfBatchMatchesScalarOnEveryLevel) {
+    using hartonomous::geometry::HopfFibration;
+    const size_t n = 37;
+    Columns c(n);
+    std::vector<double> angle(n);
+    for (size_t i = 0; i < n; ++i) angle[i] = 0.37 * static_cast<double>(i) - 3.0;
+    // A pole of S², where the phase is undefined and inverse() takes it as 0
+    c.x[5] = 0.0; c.y[5] = 0.0; c.z[5] = 1.0; c.w[5] = 0.0;
+
+    for (SimdLevel level : ALL_LEVELS) {
+        SCOPED_TRACE(Hartonomous::simd_level_name(Hartonomous::limit_simd(level)));
+        std::vector<double> sx(n), sy(n), sz(n);
+        HopfFibration::forward_batch(c.x.data(), c.y.data(), c.z.data(), c.w.data(), n, sx.data(), sy.data(), sz.data());
+
+        std::vector<double> x(n), y(n), z(n), w(n), x0(n), y0(n), z0(n), w0(n);
+        HopfFibration::inverse_batch(sx.data(), sy.data(), sz.data(), angle.data(), n, x.data(), y.data(), z.data(), w.data());
+        HopfFibration::inverse_batch(sx.data(), sy.data(), sz.data(), nullptr, n, x0.data(), y0.data(), z0.data(), w0.data());
+
+        for (size_t i = 0; i < n; ++i) {
+            const auto s2 = HopfFibration::forward(Eigen::Vector4d(c.x[i], c.y[i], c.z[i], c.w[i]));
+            EXPECT_NEAR(sx[i], s2[0], 1e-15);
+            EXPECT_NEAR(sy[i], s2[1], 1e-15);
+            EXPECT_NEAR(sz[i], s2[2], 1e-15);
+
+            const auto lifted = HopfFibration::inverse(s2, angle[i]);
+            const auto lifted0 = HopfFibration::inverse(s2);
+            const double got[4] = {x[i], y[i], z[i], w[i]}, got0[4] = {x0[i], y0[i], z0[i], w0[i]};
+            for (int k = 0; k < 4; ++k) {
+                EXPECT_NEAR(got[k], lifted[k], 1e-14) << i;
+                EXPECT_NEAR(got0[k], lifted0[k], 1e-14) << i;
+            }
+        }
+    }
+}
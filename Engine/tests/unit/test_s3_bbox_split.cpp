@@ -0,0 +1,90 @@
+/**
+ * @file test_s3_bbox_split.cpp
+ * @brief R-tree node splits used by the gist_s3_ops picksplit
+ */
+
+#include <gtest/gtest.h>
+#include <geometry/s3_bbox_split.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace s3;
+
+static std::vector<BBox4> random_points(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> g;
+    std::vector<BBox4> boxes(n);
+    for (auto& b : boxes) {
+        Vec4 p{g(rng), g(rng), g(rng), g(rng)};
+        double norm = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + p[3] * p[3]);
+        for (auto& x : p) x /= norm;
+        b = bbox_from_point(p);
+    }
+    return boxes;
+}
+
+static void expect_partition(const std::vector<BBox4>& boxes, const BBoxSplit& s) {
+    ASSERT_FALSE(s.left.empty());
+    ASSERT_FALSE(s.right.empty());
+    std::vector<int> all(s.left);
+    all.insert(all.end(), s.right.begin(), s.right.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), boxes.size());
+    for (size_t i = 0; i < all.size(); ++i) ASSERT_EQ(all[i], static_cast<int>(i));
+
+    for (int i : s.left)
+        for (int d = 0; d < 4; ++d) {
+            EXPECT_LE(s.left_box.min[d], boxes[i].min[d]);
+            EXPECT_GE(s.left_box.max[d], boxes[i].max[d]);
+        }
+    for (int i : s.right)
+        for (int d = 0; d < 4; ++d) {
+            EXPECT_LE(s.right_box.min[d], boxes[i].min[d]);
+            EXPECT_GE(s.right_box.max[d], boxes[i].max[d]);
+        }
+}
+
+TEST(S3BBoxSplitTest, EveryMethodPartitions) {
+    for (size_t n : {2, 3, 17, 100, 257}) {
+        auto boxes = random_points(n, n);
+        for (auto m : {SplitMethod::Midpoint, SplitMethod::RStar, SplitMethod::Hilbert})
+            expect_partition(boxes, split_bboxes(boxes, m));
+    }
+}
+
+TEST(S3BBoxSplitTest, RStarKeepsMinimumFill) {
+    auto boxes = random_points(100, 3);
+    // A few far outliers would tempt an unconstrained split into 3 / 97
+    for (int i = 0; i < 3; ++i) boxes[i] = bbox_from_point({5.0 + i, 5.0, 5.0, 5.0});
+    auto s = split_bboxes(boxes, SplitMethod::RStar, 0.4);
+    expect_partition(boxes, s);
+    EXPECT_GE(s.left.size(), 40u);
+    EXPECT_GE(s.right.size(), 40u);
+}
+
+TEST(S3BBoxSplitTest, RStarSeparatesClusters) {
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> u(-0.05, 0.05);
+    std::vector<BBox4> boxes;
+    for (int i = 0; i < 60; ++i) {
+        double c = i % 2 ? 0.7 : -0.7;
+        boxes.push_back(bbox_from_point({c + u(rng), c + u(rng), u(rng), u(rng)}));
+    }
+    auto s = split_bboxes(boxes, SplitMethod::RStar);
+    expect_partition(boxes, s);
+    EXPECT_EQ(bbox_overlap(s.left_box, s.right_box), 0.0);
+    for (int i : s.left) EXPECT_EQ(i % 2, s.left[0] % 2);
+    for (int i : s.right) EXPECT_EQ(i % 2, s.right[0] % 2);
+}
+
+TEST(S3BBoxSplitTest, IdenticalEntriesSplitEvenly) {
+    std::vector<BBox4> boxes(50, bbox_from_point({0.5, 0.5, 0.5, 0.5}));
+    for (auto m : {SplitMethod::Midpoint, SplitMethod::RStar, SplitMethod::Hilbert}) {
+        auto s = split_bboxes(boxes, m);
+        expect_partition(boxes, s);
+    }
+    auto s = split_bboxes(boxes, SplitMethod::RStar);
+    EXPECT_EQ(s.left.size(), 25u);
+    EXPECT_EQ(s.right.size(), 25u);
+}
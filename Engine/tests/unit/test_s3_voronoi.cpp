@@ -0,0 +1,97 @@
+/**
+ * @file test_s3_voronoi.cpp
+ * @brief Exact S³ Delaunay triangulation and Voronoi cell measures
+ */
+
+#include <gtest/gtest.h>
+#include <geometry/s3_voronoi.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Hartonomous::Geometry;
+
+static std::vector<Eigen::Vector4d> random_sites(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> g;
+    std::vector<Eigen::Vector4d> sites(n);
+    for (auto& p : sites) p = Eigen::Vector4d(g(rng), g(rng), g(rng), g(rng)).normalized();
+    return sites;
+}
+
+TEST(S3VoronoiTest, CellsPartitionTheSphere) {
+    auto sites = random_sites(500, 7);
+    S3Delaunay diagram(sites);
+
+    double total = 0.0;
+    for (uint32_t i = 0; i < sites.size(); ++i) {
+        auto cell = diagram.cell(i);
+        ASSERT_TRUE(cell.exact);
+        total += cell.volume;
+
+        double fractions = 0.0;
+        for (const auto& f : cell.faces) fractions += f.area_fraction;
+        EXPECT_NEAR(fractions, 1.0, 1e-9);
+        EXPECT_EQ(cell.faces.size(), diagram.neighbors(i).size());
+        EXPECT_GE(cell.eccentricity, 0.0);
+        EXPECT_LE(cell.eccentricity, 1.0);
+    }
+    EXPECT_NEAR(total, 1.0, 1e-3);
+}
+
+TEST(S3VoronoiTest, RegularPolytopeCellsAreEqual) {
+    // Vertices of the 24-cell: every cell is 1/24 of S³, whatever the
+    // triangulation picked for its cospherical vertices
+    std::vector<Eigen::Vector4d> sites;
+    for (int axis = 0; axis < 4; ++axis) {
+        for (double sign : {-1.0, 1.0}) {
+            Eigen::Vector4d p = Eigen::Vector4d::Zero();
+            p[axis] = sign;
+            sites.push_back(p);
+        }
+    }
+    for (int m = 0; m < 16; ++m) {
+        Eigen::Vector4d p;
+        for (int k = 0; k < 4; ++k) p[k] = (m >> k & 1) ? 0.5 : -0.5;
+        sites.push_back(p);
+    }
+    sites.push_back(sites[3]);  // Coincident copy owns nothing
+
+    S3Delaunay diagram(sites);
+    for (uint32_t i = 0; i < 24; ++i) {
+        auto cell = diagram.cell(i);
+        ASSERT_TRUE(cell.exact);
+        EXPECT_NEAR(cell.volume, 1.0 / 24.0, 2e-4);
+    }
+    auto copy = diagram.cell(24);
+    EXPECT_TRUE(copy.exact);
+    EXPECT_EQ(copy.volume, 0.0);
+}
+
+TEST(S3VoronoiTest, CapInteriorMatchesWholeSphere) {
+    auto sites = random_sites(4000, 11);
+    S3Delaunay whole(sites);
+
+    const Eigen::Vector4d center(1, 0, 0, 0);
+    const double radius = 0.8;
+    std::vector<Eigen::Vector4d> cap;
+    std::vector<uint32_t> original;
+    for (uint32_t i = 0; i < sites.size(); ++i) {
+        if (std::acos(std::clamp(sites[i].dot(center), -1.0, 1.0)) <= radius) {
+            cap.push_back(sites[i]);
+            original.push_back(i);
+        }
+    }
+    S3Delaunay local(cap, std::make_pair(center, radius));
+
+    size_t exact = 0;
+    for (uint32_t i = 0; i < cap.size(); ++i) {
+        if (!local.exact(i)) continue;
+        ++exact;
+        EXPECT_NEAR(local.cell(i).volume, whole.cell(original[i]).volume, 1e-12);
+        ASSERT_EQ(local.neighbors(i).size(), whole.neighbors(original[i]).size());
+    }
+    // Rim cells are flagged, interior ones kept
+    EXPECT_GT(exact, 0u);
+    EXPECT_LT(exact, cap.size());
+}
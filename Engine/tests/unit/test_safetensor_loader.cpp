@@ -0,0 +1,212 @@
+/**
+ * @file test_safetensor_loader.cpp
+ * @brief Unit tests for the memory-mapped safetensor loader
+ *
+ * Writes a tiny safetensor file to a temp directory and checks that mapped
+ * tensors convert lazily to the same float32 values eager loading produces.
+ * No database needed — pure file I/O.
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/safetensor_loader.hpp>
+#include <utils/cpu_dispatch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace Hartonomous;
+
+namespace fs = std::filesystem;
+
+// Helper: write a model.safetensors with one F32 (3x4) and one BF16 (2x3) tensor
+static fs::path write_test_model() {
+    fs::path dir = fs::temp_directory_path() / ("hartonomous_st_" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+
+    std::vector<float> f32(12);
+    for (size_t i = 0; i < f32.size(); ++i) f32[i] = static_cast<float>(i) * 0.5f;
+
+    std::vector<uint16_t> bf16;
+    for (float v : {1.0f, -2.0f, 0.25f, 3.0f, -0.5f, 8.0f}) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, 4);
+        bf16.push_back(static_cast<uint16_t>(bits >> 16));
+    }
+
+    size_t f32_bytes = f32.size() * sizeof(float);
+    size_t bf16_bytes = bf16.size() * sizeof(uint16_t);
+    std::string header =
+        "{\"a\":{\"dtype\":\"F32\",\"shape\":[3,4],\"data_offsets\":[0," + std::to_string(f32_bytes) + "]},"
+        "\"b\":{\"dtype\":\"BF16\",\"shape\":[2,3],\"data_offsets\":[" + std::to_string(f32_bytes) + "," +
+        std::to_string(f32_bytes + bf16_bytes) + "]}}";
+    // Odd-length padding keeps tensor data unaligned, as real files may be
+    header += std::string(3, ' ');
+
+    std::ofstream out(dir / "model.safetensors", std::ios::binary);
+    uint64_t header_size = header.size();
+    out.write(reinterpret_cast<const char*>(&header_size), 8);
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(f32.data()), f32_bytes);
+    out.write(reinterpret_cast<const char*>(bf16.data()), bf16_bytes);
+    return dir;
+}
+
+class SafetensorLoaderTest : public ::testing::Test {
+protected:
+    void SetUp() override { dir_ = write_test_model(); }
+    void TearDown() override { fs::remove_all(dir_); }
+    fs::path dir_;
+};
+
+TEST_F(SafetensorLoaderTest, MappedTensorsAreViews) {
+    SafetensorLoader loader(dir_.string());
+    const TensorData* a = loader.get_tensor("a");
+    ASSERT_NE(a, nullptr);
+    EXPECT_TRUE(a->is_mapped());
+    EXPECT_TRUE(a->data.empty());
+    EXPECT_EQ(a->shape, (std::vector<size_t>{3, 4}));
+    EXPECT_EQ(a->row_elements(), 4u);
+}
+
+TEST_F(SafetensorLoaderTest, ReadRowsConvertsBlock) {
+    SafetensorLoader loader(dir_.string());
+    const TensorData* a = loader.get_tensor("a");
+    ASSERT_NE(a, nullptr);
+
+    float row[4];
+    a->read_rows(1, 1, row);
+    for (size_t j = 0; j < 4; ++j) EXPECT_FLOAT_EQ(row[j], (4 + j) * 0.5f);
+
+    EXPECT_THROW(a->read_rows(2, 2, row), std::out_of_range);
+}
+
+TEST_F(SafetensorLoaderTest, Bf16ConvertsLazily) {
+    SafetensorLoader loader(dir_.string());
+    const TensorData* b = loader.get_tensor("b");
+    ASSERT_NE(b, nullptr);
+
+    std::vector<float> all(b->total_elements());
+    b->read_all(all.data());
+    EXPECT_EQ(all, (std::vector<float>{1.0f, -2.0f, 0.25f, 3.0f, -0.5f, 8.0f}));
+    EXPECT_FLOAT_EQ(b->at(5), 8.0f);
+}
+
+TEST_F(SafetensorLoaderTest, EagerModeMatchesMapped) {
+    SafetensorLoader mapped(dir_.string());
+    SafetensorLoader eager(dir_.string(), SafetensorLoader::LoadMode::Eager);
+
+    for (const char* name : {"a", "b"}) {
+        const TensorData* m = mapped.get_tensor(name);
+        const TensorData* e = eager.get_tensor(name);
+        ASSERT_NE(m, nullptr);
+        ASSERT_NE(e, nullptr);
+        EXPECT_FALSE(e->is_mapped());
+
+        std::vector<float> mv(m->total_elements());
+        m->read_all(mv.data());
+        EXPECT_EQ(mv, e->data);
+    }
+}
+
+TEST_F(SafetensorLoaderTest, ReleaseKeepsDataReadable) {
+    SafetensorLoader loader(dir_.string());
+    const TensorData* a = loader.get_tensor("a");
+    ASSERT_NE(a, nullptr);
+    a->release();
+    EXPECT_FLOAT_EQ(a->at(11), 5.5f);
+}
+
+// Two shards with an index: F16 (5x9, normals, a denormal, signed zero) in
+// the first and BF16 (3x13) in the second. Lengths leave tails after every
+// kernel width.
+static fs::path write_sharded_model(std::vector<float>& f16_expected, std::vector<float>& bf16_expected) {
+    fs::path dir = fs::temp_directory_path() / ("hartonomous_st_sharded_" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+
+    std::vector<uint16_t> f16;
+    for (int i = 0; i < 45; ++i) {
+        // Sign, exponent 10..24 and a mantissa walk; every few a special value
+        uint16_t h = static_cast<uint16_t>(((i & 1) << 15) | ((10 + i % 15) << 10) | ((i * 37) & 0x3FF));
+        if (i == 7) h = 0x0001;    // Smallest denormal: 2^-24
+        if (i == 20) h = 0x8000;   // -0
+        f16.push_back(h);
+        const uint32_t e = (h >> 10) & 0x1F, m = h & 0x3FF;
+        float v = e == 0 ? std::ldexp(static_cast<float>(m), -24) : std::ldexp(1.0f + m / 1024.0f, static_cast<int>(e) - 15);
+        f16_expected.push_back((h & 0x8000) ? -v : v);
+    }
+    std::vector<uint16_t> bf16;
+    for (int i = 0; i < 39; ++i) {
+        const float v = (i % 2 ? -1.0f : 1.0f) * std::ldexp(1.0f + (i % 8) / 8.0f, i % 11 - 5);
+        uint32_t bits;
+        std::memcpy(&bits, &v, 4);
+        bf16.push_back(static_cast<uint16_t>(bits >> 16));
+        bf16_expected.push_back(v);
+    }
+
+    auto write_shard = [&](const std::string& file, const std::string& name, const char* dtype, const char* shape,
+                           const std::vector<uint16_t>& values) {
+        const size_t bytes = values.size() * 2;
+        std::string header = "{\"" + name + "\":{\"dtype\":\"" + dtype + "\",\"shape\":" + shape +
+                             ",\"data_offsets\":[0," + std::to_string(bytes) + "]}} ";
+        std::ofstream out(dir / file, std::ios::binary);
+        uint64_t header_size = header.size();
+        out.write(reinterpret_cast<const char*>(&header_size), 8);
+        out.write(header.data(), header.size());
+        out.write(reinterpret_cast<const char*>(values.data()), bytes);
+    };
+    write_shard("model-00001-of-00002.safetensors", "h", "F16", "[5,9]", f16);
+    write_shard("model-00002-of-00002.safetensors", "b", "BF16", "[3,13]", bf16);
+    std::ofstream(dir / "model.safetensors.index.json")
+        << "{\"weight_map\":{\"h\":\"model-00001-of-00002.safetensors\",\"b\":\"model-00002-of-00002.safetensors\"}}";
+    return dir;
+}
+
+TEST(SafetensorShardTest, ShardsConvertAlikeAtEverySimdLevel) {
+    std::vector<float> f16_expected, bf16_expected;
+    const fs::path dir = write_sharded_model(f16_expected, bf16_expected);
+    const SimdLevel before = simd_level();
+
+    for (SimdLevel cap : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        limit_simd(cap);
+        for (auto mode : {SafetensorLoader::LoadMode::Mapped, SafetensorLoader::LoadMode::Eager}) {
+            SafetensorLoader loader(dir.string(), mode);
+            const TensorData* h = loader.get_tensor("h");
+            const TensorData* b = loader.get_tensor("b");
+            ASSERT_NE(h, nullptr);
+            ASSERT_NE(b, nullptr);
+            EXPECT_EQ(h->is_mapped(), mode == SafetensorLoader::LoadMode::Mapped);
+
+            std::vector<float> hv(h->total_elements()), bv(b->total_elements());
+            h->read_all(hv.data());
+            b->read_all(bv.data());
+            EXPECT_EQ(hv, f16_expected) << simd_level_name(simd_level());
+            EXPECT_EQ(bv, bf16_expected) << simd_level_name(simd_level());
+            EXPECT_TRUE(std::signbit(hv[20]));
+
+            float row[13];
+            b->read_rows(2, 1, row);
+            EXPECT_EQ(row[12], bf16_expected[38]);
+        }
+    }
+    limit_simd(before);
+    fs::remove_all(dir);
+}
+
+TEST(SafetensorShardTest, BadShardFailsTheLoad) {
+    std::vector<float> f16_expected, bf16_expected;
+    const fs::path dir = write_sharded_model(f16_expected, bf16_expected);
+    {
+        // Header size pointing past the end of the file
+        std::fstream f(dir / "model-00002-of-00002.safetensors", std::ios::in | std::ios::out | std::ios::binary);
+        const uint64_t bogus = 1 << 20;
+        f.write(reinterpret_cast<const char*>(&bogus), 8);
+    }
+    for (auto mode : {SafetensorLoader::LoadMode::Mapped, SafetensorLoader::LoadMode::Eager}) {
+        EXPECT_THROW(SafetensorLoader(dir.string(), mode), std::runtime_error);
+    }
+    fs::remove_all(dir);
+}
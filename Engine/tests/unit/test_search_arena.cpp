@@ -0,0 +1,68 @@
+/**
+ * @file test_search_arena.cpp
+ * @brief Unit tests for the per-thread search arena and its indexed open list
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/search_arena.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(SearchArenaTest, PushMovesAnOpenSlotInsteadOfAddingOne) {
+    SearchArena arena;
+    const uint32_t a = arena.touch(10).first;
+    const uint32_t b = arena.touch(20).first;
+    EXPECT_EQ(arena.touch(10).first, a);
+
+    arena.push(5.0, a);
+    arena.push(3.0, b);
+    arena.push(1.0, a);   // Decrease
+    EXPECT_EQ(arena.open_size(), 2u);
+    EXPECT_EQ(arena.top().slot, a);
+    arena.push(4.0, a);   // Increase
+    EXPECT_EQ(arena.open_size(), 2u);
+
+    auto first = arena.pop();
+    EXPECT_EQ(first.slot, b);
+    EXPECT_DOUBLE_EQ(first.f, 3.0);
+    EXPECT_FALSE(arena.is_open(b));
+    EXPECT_TRUE(arena.is_open(a));
+
+    // A closed slot can be opened again
+    arena.push(2.0, b);
+    EXPECT_EQ(arena.pop().slot, b);
+    EXPECT_EQ(arena.pop().slot, a);
+    EXPECT_TRUE(arena.open_empty());
+}
+
+TEST(SearchArenaTest, PopsInPriorityOrderUnderRandomUpdates) {
+    SearchArena arena;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> cost(0.0, 100.0);
+    std::vector<double> latest(500, -1.0);
+    for (uint32_t id = 0; id < latest.size(); ++id) arena.touch(id * 7 + 1);
+    for (int step = 0; step < 5000; ++step) {
+        const uint32_t slot = rng() % latest.size();
+        latest[slot] = cost(rng);
+        arena.push(latest[slot], slot);
+    }
+
+    std::vector<double> expected;
+    for (double f : latest)
+        if (f >= 0.0) expected.push_back(f);
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(arena.open_size(), expected.size());
+    for (double f : expected) {
+        auto e = arena.pop();
+        EXPECT_DOUBLE_EQ(e.f, f);
+        EXPECT_DOUBLE_EQ(latest[e.slot], f);
+    }
+    EXPECT_TRUE(arena.open_empty());
+
+    arena.reset();
+    EXPECT_EQ(arena.size(), 0u);
+    EXPECT_TRUE(arena.open_empty());
+}
@@ -0,0 +1,75 @@
+/**
+ * @file test_sequitur.cpp
+ * @brief Sequitur grammars reproduce their input and keep both invariants
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/sequitur.hpp>
+#include <map>
+#include <random>
+
+using namespace Hartonomous;
+
+static Grammar induce(const std::u32string& text) {
+    Sequitur seq(text.size());
+    seq.append(text);
+    Grammar g = seq.grammar();
+    EXPECT_EQ(g.rule_count(), seq.rule_count());
+    return g;
+}
+
+// Expansion, lengths, use counts, digram uniqueness and rule utility
+static void expect_valid(const std::u32string& text) {
+    Grammar g = induce(text);
+    std::u32string out;
+    g.expand(0, out);
+    ASSERT_EQ(out, text);
+
+    std::vector<uint32_t> uses(g.rule_count(), 0);
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> digrams;
+    for (uint32_t r = 0; r < g.rule_count(); ++r) {
+        std::u32string expansion;
+        g.expand(r, expansion);
+        EXPECT_EQ(g.lengths[r], expansion.size());
+        if (r > 0) {
+            EXPECT_GE(g.offsets[r + 1] - g.offsets[r], 2u);
+        }
+        for (uint32_t i = g.offsets[r]; i < g.offsets[r + 1]; ++i) {
+            if (Grammar::is_rule(g.symbols[i])) uses[Grammar::rule_of(g.symbols[i])]++;
+            if (i + 1 == g.offsets[r + 1]) continue;
+            // A run of three equal symbols holds the same digram twice, overlapping
+            const bool overlaps = i > g.offsets[r] && g.symbols[i - 1] == g.symbols[i] && g.symbols[i] == g.symbols[i + 1];
+            if (!overlaps) {
+                EXPECT_EQ(++digrams[std::make_pair(g.symbols[i], g.symbols[i + 1])], 1u) << "rule " << r << " at " << i;
+            }
+        }
+    }
+    for (uint32_t r = 1; r < g.rule_count(); ++r) {
+        EXPECT_EQ(uses[r], g.uses[r]);
+        EXPECT_GE(uses[r], 2u) << "rule " << r;
+    }
+}
+
+TEST(SequiturTest, SmallTexts) {
+    expect_valid(U"");
+    expect_valid(U"a");
+    expect_valid(U"aaaaaaaaaaa");
+    expect_valid(U"abcdbcabcd");
+    expect_valid(U"the cat sat on the mat, the cat sat on the hat");
+
+    Grammar g = induce(U"abab");
+    ASSERT_EQ(g.rule_count(), 2u);
+    EXPECT_EQ(g.offsets[1] - g.offsets[0], 2u);
+    EXPECT_EQ(g.lengths[1], 2u);
+}
+
+TEST(SequiturTest, RandomTexts) {
+    std::mt19937 rng(49);
+    for (int trial = 0; trial < 200; ++trial) {
+        const size_t n = rng() % 2000;
+        const uint32_t sigma = 2 + rng() % 5;
+        std::u32string text(n, U'a');
+        for (auto& c : text) c = U'a' + rng() % sigma;
+        expect_valid(text);
+    }
+}
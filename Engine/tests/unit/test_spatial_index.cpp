@@ -8,7 +8,9 @@
 #include <ml/s3_hnsw.hpp>
 #include <vector>
 #include <Eigen/Core>
+#include <cmath>
 #include <cstring>
+#include <random>
 
 using namespace hartonomous::spatial;
 using namespace s3::ann;
@@ -62,6 +64,55 @@ TEST(SpatialIndexTest, HilbertLocality) {
 
 // HilbertStringConversion test removed - HilbertIndex is now binary UUID
 
+TEST(SpatialIndexTest, HilbertBatchMatchesEncode) {
+    // 37 points: full SIMD groups plus a scalar tail, including out-of-range coordinates
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> u(-0.1, 1.1);
+    std::vector<double> xyzw(37 * 4);
+    for (auto& c : xyzw) c = u(rng);
+    for (int d = 0; d < 4; ++d) { xyzw[d] = 0.0; xyzw[4 + d] = 1.0; }
+
+    for (auto type : {HilbertCurve4D::EntityType::Composition, HilbertCurve4D::EntityType::Relation}) {
+        std::vector<HilbertCurve4D::HilbertIndex> batch(37);
+        HilbertCurve4D::encode_batch(xyzw.data(), 37, batch.data(), type);
+        for (size_t i = 0; i < 37; ++i) {
+            Eigen::Vector4d p(xyzw[i * 4], xyzw[i * 4 + 1], xyzw[i * 4 + 2], xyzw[i * 4 + 3]);
+            EXPECT_EQ(batch[i], HilbertCurve4D::encode(p, type)) << i;
+        }
+    }
+}
+
+TEST(SpatialIndexTest, HilbertDecodeInvertsEncode) {
+    const double max_val = static_cast<double>((1ULL << HilbertCurve4D::BITS_PER_DIMENSION) - 1);
+    auto cell = [&](double c) { return static_cast<int64_t>(c * max_val); };
+
+    std::mt19937_64 rng(5);
+    std::vector<HilbertCurve4D::HilbertIndex> idx(21);
+    for (auto& h : idx)
+        for (auto& b : h) b = static_cast<uint8_t>(rng());
+    std::vector<double> xyzw(idx.size() * 4);
+    HilbertCurve4D::decode_batch(idx.data(), idx.size(), xyzw.data());
+
+    for (size_t i = 0; i < idx.size(); ++i) {
+        // Exact round trip once the type bits are carried over
+        auto type = static_cast<HilbertCurve4D::EntityType>(idx[i][15] & 3);
+        HilbertCurve4D::HilbertIndex again;
+        HilbertCurve4D::encode_batch(xyzw.data() + i * 4, 1, &again, type);
+        EXPECT_EQ(again, idx[i]) << i;
+
+        Eigen::Vector4d single = HilbertCurve4D::decode(idx[i]);
+        for (int d = 0; d < 4; ++d) EXPECT_EQ(single[d], xyzw[i * 4 + d]);
+
+        // Consecutive indices are neighboring cells: one coordinate, one step
+        auto next = idx[i];
+        for (int b = 15; b >= 0 && ++next[b] == 0; --b) {}
+        Eigen::Vector4d q = HilbertCurve4D::decode(next);
+        int64_t moved = 0;
+        for (int d = 0; d < 4; ++d) moved += std::llabs(cell(q[d]) - cell(single[d]));
+        EXPECT_EQ(moved, 1) << i;
+    }
+}
+
 TEST(SpatialIndexTest, HNSWIndexPlaceholder) {
     // Current implementation is a placeholder, test basic lifecycle
     std::vector<s3::Vec4> points = {
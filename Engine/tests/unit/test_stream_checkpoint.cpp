@@ -0,0 +1,75 @@
+/**
+ * @file test_stream_checkpoint.cpp
+ * @brief Unit tests for resumable corpus positions
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/stream_checkpoint.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Hartonomous;
+namespace fs = std::filesystem;
+
+class StreamCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = fs::temp_directory_path() /
+               ("hartonomous_stream_checkpoint_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        fs::remove_all(root);
+        fs::create_directories(root);
+        opts.dir = (root / "checkpoints").string();
+        input = (root / "corpus.tsv").string();
+        std::ofstream(input) << "1\tfirst\n2\tsecond\n";
+    }
+    void TearDown() override { fs::remove_all(root); }
+
+    fs::path root;
+    std::string input;
+    StreamCheckpoint::Options opts;
+};
+
+TEST_F(StreamCheckpointTest, CommitsOnlyTheFlushedContiguousPrefix) {
+    StreamCheckpoint cp;
+    cp.open(opts, "test", {input});
+    ASSERT_TRUE(cp.enabled());
+
+    // Chunks finish out of order; [10, 20) waits for [0, 10)
+    cp.covered("lines", 10, 20, 2);
+    cp.flushed(5);
+    EXPECT_EQ(cp.position("lines"), 0u);
+
+    cp.covered("lines", 0, 10, 1);
+    cp.covered("lines", 20, 30, 7);
+    cp.flushed(5);
+    EXPECT_EQ(cp.position("lines"), 20u);
+
+    StreamCheckpoint resumed;
+    resumed.open(opts, "test", {input});
+    EXPECT_EQ(resumed.position("lines"), 20u);
+    EXPECT_EQ(resumed.position("other"), 0u);
+
+    cp.clear();
+    EXPECT_FALSE(fs::exists(cp.path()));
+}
+
+TEST_F(StreamCheckpointTest, ChangedInputStartsOver) {
+    {
+        StreamCheckpoint cp;
+        cp.open(opts, "test", {input});
+        cp.covered("lines", 0, 8, 0);
+        cp.flushed(0);
+        EXPECT_EQ(cp.position("lines"), 8u);
+    }
+    std::ofstream(input, std::ios::app) << "3\tthird\n";
+
+    StreamCheckpoint cp;
+    cp.open(opts, "test", {input});
+    EXPECT_EQ(cp.position("lines"), 0u);
+
+    StreamCheckpoint::Options off;
+    StreamCheckpoint disabled;
+    disabled.open(off, "test", {input});
+    EXPECT_FALSE(disabled.enabled());
+}
@@ -0,0 +1,276 @@
+/**
+ * @file test_substrate_snapshot.cpp
+ * @brief Unit tests for the substrate snapshot file format
+ *
+ * Snapshots are built from hand-encoded binary COPY messages through
+ * SubstrateSnapshot::Writer, then mapped and scanned. No database needed.
+ */
+
+#include <gtest/gtest.h>
+#include <cognitive/relation_graph.hpp>
+#include <database/copy_row.hpp>
+#include <database/substrate_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Hartonomous;
+
+namespace {
+
+// Binary COPY stream builder: header, then rows, then the trailer
+struct CopyMessage {
+    std::vector<uint8_t> bytes;
+
+    CopyMessage() {
+        const char sig[11] = {'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0'};
+        bytes.insert(bytes.end(), sig, sig + 11);
+        bytes.resize(bytes.size() + 8, 0);   // Flags and header extension length
+    }
+    void row(uint16_t fields) { be16(fields); }
+    void field(const void* data, uint32_t len) {
+        be32(len);
+        const auto* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + len);
+    }
+    void text(const std::string& s) { field(s.data(), static_cast<uint32_t>(s.size())); }
+    void null() { be32(0xFFFFFFFFu); }
+    void int4(int32_t v) {
+        uint8_t b[4];
+        pgcopy::store_be32(b, static_cast<uint32_t>(v));
+        field(b, 4);
+    }
+    void float8(double v) {
+        uint64_t raw;
+        std::memcpy(&raw, &v, 8);
+        uint8_t b[8];
+        pgcopy::store_be64(b, raw);
+        field(b, 8);
+    }
+    void uint64(uint64_t v) {
+        uint8_t b[8];
+        pgcopy::store_be64(b, v);
+        field(b, 8);
+    }
+    void uuid(uint8_t tag) {
+        std::array<uint8_t, 16> id{};
+        id[0] = tag;
+        field(id.data(), 16);
+    }
+    void trailer() { be16(0xFFFF); }
+
+private:
+    void be16(uint16_t v) {
+        uint8_t b[2];
+        pgcopy::store_be16(b, v);
+        bytes.insert(bytes.end(), b, b + 2);
+    }
+    void be32(uint32_t v) {
+        uint8_t b[4];
+        pgcopy::store_be32(b, v);
+        bytes.insert(bytes.end(), b, b + 4);
+    }
+};
+
+std::string temp_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+int32_t be_int4(const SubstrateSnapshot::Field& f) {
+    uint32_t raw;
+    std::memcpy(&raw, f.data, 4);
+    return static_cast<int32_t>(__builtin_bswap32(raw));
+}
+
+} // namespace
+
+TEST(SubstrateSnapshotTest, RowsRoundTripAcrossBlocks) {
+    const auto path = temp_path("hartonomous_test_snapshot.bin");
+    {
+        SubstrateSnapshot::Writer writer(path);
+        const size_t t = writer.add_table("sample", {{"id", "integer"}, {"kind", "text"}, {"note", "text"}});
+        auto stream = writer.stream(t, 3);
+
+        // Split over two messages, as a server sends them
+        CopyMessage first, second;
+        for (int i = 0; i < 10; ++i) {
+            CopyMessage& m = i < 4 ? first : second;
+            m.row(3);
+            m.int4(i);
+            m.text("constant");
+            if (i % 3 == 0) m.null();
+            else m.text(i == 5 ? "" : "note " + std::to_string(i));
+        }
+        second.trailer();
+        stream.add_message(reinterpret_cast<const char*>(first.bytes.data()), first.bytes.size());
+        stream.add_message(reinterpret_cast<const char*>(second.bytes.data()), second.bytes.size());
+        stream.finish();
+        EXPECT_EQ(writer.rows(), 10u);
+        writer.commit();
+    }
+
+    auto snap = SubstrateSnapshot::open(path);
+    ASSERT_EQ(snap->tables().size(), 1u);
+    const auto* table = snap->table("sample");
+    ASSERT_NE(table, nullptr);
+    EXPECT_EQ(table->rows, 10u);
+    EXPECT_EQ(table->blocks.size(), 4u);   // 3 + 3 + 3 + 1
+    EXPECT_EQ(table->columns[1].type, "text");
+    EXPECT_EQ(snap->id().size(), 32u);
+
+    int expected = 0;
+    snap->scan("sample", {"note", "id", "kind"}, [&](std::span<const SubstrateSnapshot::Field> row) {
+        EXPECT_EQ(be_int4(row[1]), expected);
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(row[2].data), row[2].size), "constant");
+        if (expected % 3 == 0) {
+            EXPECT_TRUE(row[0].is_null());
+        } else {
+            ASSERT_FALSE(row[0].is_null());
+            const std::string note(reinterpret_cast<const char*>(row[0].data), row[0].size);
+            EXPECT_EQ(note, expected == 5 ? "" : "note " + std::to_string(expected));
+        }
+        ++expected;
+    });
+    EXPECT_EQ(expected, 10);
+    EXPECT_THROW(snap->scan("sample", {"missing"}, [](auto) {}), std::runtime_error);
+    EXPECT_THROW(snap->scan("missing", {"id"}, [](auto) {}), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(SubstrateSnapshotTest, RepeatedValuesAreStoredOnce) {
+    const auto path = temp_path("hartonomous_test_snapshot_rle.bin");
+    const std::string value(200, 'x');
+    {
+        SubstrateSnapshot::Writer writer(path);
+        auto stream = writer.stream(writer.add_table("wide", {{"v", "text"}}));
+        CopyMessage m;
+        for (int i = 0; i < 1000; ++i) {
+            m.row(1);
+            m.text(value);
+        }
+        m.trailer();
+        stream.add_message(reinterpret_cast<const char*>(m.bytes.data()), m.bytes.size());
+        stream.finish();
+        writer.commit();
+    }
+    EXPECT_LT(std::filesystem::file_size(path), 1024u);
+
+    auto snap = SubstrateSnapshot::open(path);
+    size_t rows = 0;
+    snap->scan("wide", {"v"}, [&](std::span<const SubstrateSnapshot::Field> row) {
+        EXPECT_EQ(row[0].size, value.size());
+        ++rows;
+    });
+    EXPECT_EQ(rows, 1000u);
+    std::filesystem::remove(path);
+}
+
+TEST(SubstrateSnapshotTest, CorruptBlockOrDirectoryIsRejected) {
+    const auto path = temp_path("hartonomous_test_snapshot_corrupt.bin");
+    {
+        SubstrateSnapshot::Writer writer(path);
+        auto stream = writer.stream(writer.add_table("t", {{"id", "integer"}}));
+        CopyMessage m;
+        for (int i = 0; i < 5; ++i) {
+            m.row(1);
+            m.int4(i * 7919);
+        }
+        stream.add_message(reinterpret_cast<const char*>(m.bytes.data()), m.bytes.size());
+        stream.finish();
+        writer.commit();
+    }
+    const auto size = std::filesystem::file_size(path);
+
+    // Flip a byte inside the first block's body
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(64 + 48);
+        f.put('\x5a');
+    }
+    auto snap = SubstrateSnapshot::open(path);
+    EXPECT_THROW(snap->scan("t", {"id"}, [](auto) {}), std::runtime_error);
+    snap.reset();
+
+    // And the last byte of the directory
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(static_cast<std::streamoff>(size) - 1);
+        const char c = static_cast<char>(f.get());
+        f.seekp(static_cast<std::streamoff>(size) - 1);
+        f.put(static_cast<char>(c ^ 1));
+    }
+    EXPECT_THROW(SubstrateSnapshot::open(path), std::runtime_error);
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(SubstrateSnapshot::open(path), std::runtime_error);
+}
+
+TEST(SubstrateSnapshotTest, UncommittedWriterLeavesNoFile) {
+    const auto path = temp_path("hartonomous_test_snapshot_abandoned.bin");
+    std::filesystem::remove(path);
+    {
+        SubstrateSnapshot::Writer writer(path);
+        writer.add_table("t", {{"id", "integer"}});
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+}
+
+TEST(SubstrateSnapshotTest, RelationGraphFromSnapshotMatchesJoin) {
+    const auto path = temp_path("hartonomous_test_snapshot_graph.bin");
+    {
+        SubstrateSnapshot::Writer writer(path);
+        const size_t rr = writer.add_table("relationrating",
+            {{"relationid", "uuid"}, {"observations", "uint64"}, {"ratingvalue", "double precision"}});
+        const size_t rs = writer.add_table("relationsequence",
+            {{"id", "uuid"}, {"relationid", "uuid"}, {"compositionid", "uuid"}});
+
+        // Relation 1 joins compositions 10 and 11 with rating 1200 ×3; relation 2
+        // joins 10 and 11 again (1100 ×2) and relation 3 has no rating
+        CopyMessage ratings;
+        const std::pair<uint8_t, std::pair<uint64_t, double>> rated[] = {{1, {3, 1200.0}}, {2, {2, 1100.0}}};
+        for (const auto& [rel, r] : rated) {
+            ratings.row(3);
+            ratings.uuid(rel);
+            ratings.uint64(r.first);
+            ratings.float8(r.second);
+        }
+        ratings.trailer();
+        auto rating_stream = writer.stream(rr);
+        rating_stream.add_message(reinterpret_cast<const char*>(ratings.bytes.data()), ratings.bytes.size());
+        rating_stream.finish();
+
+        CopyMessage members;
+        const std::pair<uint8_t, uint8_t> rows[] = {{1, 10}, {1, 11}, {2, 11}, {2, 10}, {3, 10}, {3, 12}};
+        uint8_t id = 100;
+        for (const auto& [rel, comp] : rows) {
+            members.row(3);
+            members.uuid(id++);
+            members.uuid(rel);
+            members.uuid(comp);
+        }
+        members.trailer();
+        auto member_stream = writer.stream(rs);
+        member_stream.add_message(reinterpret_cast<const char*>(members.bytes.data()), members.bytes.size());
+        member_stream.finish();
+        writer.commit();
+    }
+
+    auto snap = SubstrateSnapshot::open(path);
+    auto graph = RelationGraph::from_snapshot(*snap);
+    EXPECT_EQ(graph->fingerprint(), "snapshot:" + snap->id());
+    EXPECT_EQ(graph->node_count(), 2u);
+    EXPECT_EQ(graph->edge_count(), 2u);
+
+    BLAKE3Pipeline::Hash a{}, b{};
+    a[0] = 10;
+    b[0] = 11;
+    auto edges = graph->neighbors(a);
+    ASSERT_EQ(edges.size(), 1u);
+    EXPECT_EQ(graph->id_of(edges[0].target), b);
+    EXPECT_EQ(edges[0].relation_count, 2u);
+    EXPECT_DOUBLE_EQ(edges[0].max_elo, 1200.0);
+    EXPECT_DOUBLE_EQ(edges[0].total_obs, 5.0);
+    std::filesystem::remove(path);
+}
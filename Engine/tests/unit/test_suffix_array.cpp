@@ -0,0 +1,68 @@
+/**
+ * @file test_suffix_array.cpp
+ * @brief SA-IS suffix array and Φ-based LCP against brute force
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/suffix_array.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace Hartonomous;
+
+static std::vector<uint32_t> naive_sa(const std::u32string& text) {
+    std::vector<uint32_t> sa(text.size());
+    std::iota(sa.begin(), sa.end(), 0u);
+    std::sort(sa.begin(), sa.end(), [&](uint32_t a, uint32_t b) {
+        return text.compare(a, std::u32string::npos, text, b, std::u32string::npos) < 0;
+    });
+    return sa;
+}
+
+static uint32_t naive_lcp(const std::u32string& text, uint32_t a, uint32_t b) {
+    uint32_t l = 0;
+    while (a + l < text.size() && b + l < text.size() && text[a + l] == text[b + l]) ++l;
+    return l;
+}
+
+static void expect_matches(const std::u32string& text, uint32_t cap = UINT32_MAX) {
+    auto sa = build_suffix_array(text);
+    ASSERT_EQ(sa, naive_sa(text));
+    auto lcp = build_lcp_array(text, sa, cap);
+    ASSERT_EQ(lcp.size(), sa.size());
+    if (!lcp.empty()) EXPECT_EQ(lcp[0], 0u);
+    for (size_t i = 1; i < sa.size(); ++i)
+        ASSERT_EQ(lcp[i], std::min(cap, naive_lcp(text, sa[i - 1], sa[i]))) << "at " << i;
+}
+
+TEST(SuffixArrayTest, SmallAndRepetitiveTexts) {
+    expect_matches(U"");
+    expect_matches(U"a");
+    expect_matches(U"banana");
+    expect_matches(U"mississippi");
+    expect_matches(std::u32string(500, U'x'));
+    expect_matches(U"abababababababababab", 3);
+}
+
+TEST(SuffixArrayTest, WideAlphabet) {
+    // Codepoints across planes, plus values beyond Unicode
+    std::mt19937 rng(5);
+    const char32_t alphabet[] = {U'a', U'é', U'中', U'\U0001F600', U'\U0010FFFF', char32_t(0x7FFFFFFF)};
+    for (int round = 0; round < 20; ++round) {
+        std::u32string text(1 + rng() % 400, U'a');
+        size_t used = 2 + rng() % 5;
+        for (auto& c : text) c = alphabet[rng() % used];
+        expect_matches(text, round % 2 ? 8 : UINT32_MAX);
+    }
+}
+
+TEST(SuffixArrayTest, RandomTexts) {
+    std::mt19937 rng(17);
+    for (int round = 0; round < 50; ++round) {
+        std::u32string text(rng() % 2000, U'a');
+        uint32_t sigma = 1 + rng() % 4;
+        for (auto& c : text) c = U'a' + rng() % sigma;
+        expect_matches(text);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file test_tensor_dedup.cpp
+ * @brief Tensor digests follow the bytes exactly and sketches separate small deltas from different weights
+ */
+
+#include <gtest/gtest.h>
+#include <ingestion/tensor_dedup.hpp>
+#include <random>
+
+using namespace Hartonomous;
+
+namespace {
+
+TensorData random_tensor(size_t rows, size_t cols, uint32_t seed) {
+    TensorData t;
+    t.name = "model.layers.0.self_attn.v_proj.weight";
+    t.shape = {rows, cols};
+    t.dtype = "F32";
+    t.data.resize(rows * cols);
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal(0.0f, 0.02f);
+    for (auto& v : t.data) v = normal(rng);
+    return t;
+}
+
+} // namespace
+
+TEST(TensorDedupTest, DigestTracksEveryByteAndTheShape) {
+    auto a = random_tensor(96, 48, 1);
+    auto b = a;
+    EXPECT_EQ(TensorDedup::digest(a), TensorDedup::digest(b));
+
+    b.data[1234] = std::nextafter(b.data[1234], 1.0f);
+    EXPECT_NE(TensorDedup::digest(a), TensorDedup::digest(b));
+
+    auto c = a;
+    c.shape = {48, 96};
+    EXPECT_NE(TensorDedup::digest(a), TensorDedup::digest(c));
+}
+
+TEST(TensorDedupTest, SketchSeparatesFineTuneDeltasFromOtherWeights) {
+    const auto base = random_tensor(512, 256, 2);
+    const auto sketch = TensorDedup::sketch(base);
+    ASSERT_EQ(sketch.size(), TensorDedup::SKETCH_ROWS * TensorDedup::SKETCH_DIMS);
+    EXPECT_DOUBLE_EQ(TensorDedup::sketch_similarity(sketch, TensorDedup::sketch(base)), 1.0);
+
+    // A 2% delta, about what a light fine-tune leaves on most layers
+    auto tuned = base;
+    const auto noise = random_tensor(512, 256, 3);
+    for (size_t i = 0; i < tuned.data.size(); ++i) tuned.data[i] += 0.02f * noise.data[i];
+    EXPECT_GT(TensorDedup::sketch_similarity(sketch, TensorDedup::sketch(tuned)), 0.995);
+
+    // A 30% delta, and an unrelated tensor, both have to be mined
+    auto moved = base;
+    for (size_t i = 0; i < moved.data.size(); ++i) moved.data[i] += 0.3f * noise.data[i];
+    EXPECT_LT(TensorDedup::sketch_similarity(sketch, TensorDedup::sketch(moved)), 0.99);
+    EXPECT_LT(TensorDedup::sketch_similarity(sketch, TensorDedup::sketch(noise)), 0.5);
+
+    EXPECT_TRUE(TensorDedup::sketch(TensorData{"bias", {256}, "F32", std::vector<float>(256, 1.0f)}).empty());
+}
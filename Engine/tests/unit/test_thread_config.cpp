@@ -0,0 +1,70 @@
+/**
+ * @file test_thread_config.cpp
+ * @brief CPU list parsing, NUMA pin orders, node-bound threads, the nested-region cap and for_each_task
+ */
+
+#include <gtest/gtest.h>
+#include <utils/numa.hpp>
+#include <utils/thread_config.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace Hartonomous;
+
+TEST(ThreadConfigTest, ParsesSysfsCpuLists) {
+    EXPECT_EQ(detail::parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(detail::parse_cpu_list("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(detail::parse_cpu_list("").empty());
+}
+
+TEST(ThreadConfigTest, PinOrdersFillOrDealNodes) {
+    const std::vector<std::vector<int>> nodes = {{0, 1, 2}, {8, 9}};
+    EXPECT_EQ(detail::pin_order(nodes, PinPolicy::Compact), (std::vector<int>{0, 1, 2, 8, 9}));
+    EXPECT_EQ(detail::pin_order(nodes, PinPolicy::Spread), (std::vector<int>{0, 8, 1, 9, 2}));
+    EXPECT_TRUE(detail::pin_order(nodes, PinPolicy::None).empty());
+}
+
+TEST(ThreadConfigTest, NestedRegionsDoNotAddThreads) {
+    apply_thread_config();
+    EXPECT_GE(worker_threads(), 1u);
+#if defined(_OPENMP)
+    std::atomic<int> inner_max{0};
+    #pragma omp parallel num_threads(2)
+    {
+        #pragma omp parallel num_threads(4)
+        {
+            int n = omp_get_num_threads();
+            int seen = inner_max.load();
+            while (n > seen && !inner_max.compare_exchange_weak(seen, n)) {}
+        }
+    }
+    EXPECT_EQ(inner_max.load(), 1);
+#endif
+}
+
+TEST(ThreadConfigTest, RunOnNodeStaysOnTheNode) {
+    const size_t last = numa_node_count() - 1;
+    EXPECT_EQ(run_on_node(last, [] { return current_numa_node(); }), last);
+    EXPECT_THROW(run_on_node(0, []() -> int { throw std::runtime_error("x"); }), std::runtime_error);
+
+    // Advisory placement never fails the caller
+    std::vector<double> v(1 << 16, 1.0);
+    numa_interleave(v.data(), v.size() * sizeof(double));
+    numa_first_touch(v.data(), v.size() * sizeof(double));
+    EXPECT_EQ(v.back(), 1.0);
+}
+
+TEST(ThreadConfigTest, ForEachTaskRunsEveryIndexAndRethrows) {
+    std::vector<std::atomic<int>> hits(100);
+    for_each_task(hits.size(), true, 4, [&](size_t i) { hits[i].fetch_add(1); });
+    for (const auto& h : hits) EXPECT_EQ(h.load(), 1);
+
+    // Every task still runs; the first failure surfaces on the caller
+    std::atomic<int> ran{0};
+    EXPECT_THROW(for_each_task(10, true, 4, [&](size_t i) {
+        ran.fetch_add(1);
+        if (i % 3 == 0) throw std::runtime_error("task");
+    }), std::runtime_error);
+    EXPECT_EQ(ran.load(), 10);
+}
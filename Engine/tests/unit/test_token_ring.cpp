@@ -0,0 +1,114 @@
+/**
+ * @file test_token_ring.cpp
+ * @brief TokenRing hands every fragment across threads in order, throttles a full ring and stops on cancel
+ */
+
+#include <gtest/gtest.h>
+#include <utils/token_ring.hpp>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Hartonomous;
+
+namespace {
+
+struct Fragment {
+    std::string text;
+    uint32_t step;
+    double energy;
+};
+
+// Parse the frames drain() copied out
+void parse(const uint8_t* data, size_t bytes, std::vector<Fragment>& out) {
+    size_t at = 0;
+    while (at < bytes) {
+        TokenFrame frame;
+        std::memcpy(&frame, data + at, sizeof(frame));
+        out.push_back({std::string(reinterpret_cast<const char*>(data + at + sizeof(frame)), frame.length),
+                       frame.step, frame.energy_remaining});
+        at += sizeof(frame) + ((frame.length + 7) & ~size_t(7));
+    }
+    EXPECT_EQ(at, bytes);
+}
+
+} // namespace
+
+TEST(TokenRingTest, FragmentsCrossInOrderThroughAFullRing) {
+    // Far more than the 4 KiB ring holds, so the producer waits and frames wrap
+    TokenRing ring(1);
+    ASSERT_EQ(ring.capacity(), TokenRing::MIN_CAPACITY);
+    const size_t n = 5000;
+    auto text_of = [](size_t i) { return std::string(i % 23, 'a' + static_cast<char>(i % 26)) + std::to_string(i); };
+
+    std::thread producer([&] {
+        for (size_t i = 0; i < n; ++i) ASSERT_TRUE(ring.push(text_of(i), static_cast<uint32_t>(i), 1.0 / (i + 1)));
+        ring.close();
+    });
+
+    std::vector<Fragment> got;
+    std::vector<uint8_t> buffer(ring.capacity());
+    while (!ring.finished()) {
+        while (size_t bytes = ring.drain(buffer.data(), buffer.size())) parse(buffer.data(), bytes, got);
+        ring.wait(100);
+    }
+    producer.join();
+
+    ASSERT_EQ(got.size(), n);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(got[i].text, text_of(i));
+        EXPECT_EQ(got[i].step, i);
+        EXPECT_EQ(got[i].energy, 1.0 / (i + 1));
+    }
+}
+
+TEST(TokenRingTest, DrainCopiesWholeFramesOnly) {
+    TokenRing ring(4096);
+    ASSERT_TRUE(ring.push("alpha", 0, 0.5));   // 16 + 8 bytes
+    ASSERT_TRUE(ring.push("beta", 1, 0.25));   // 16 + 8 bytes
+
+    std::vector<uint8_t> buffer(40);
+    EXPECT_EQ(ring.drain(buffer.data(), buffer.size()), 24u);
+    EXPECT_EQ(ring.drain(buffer.data(), 8), 0u);
+    EXPECT_EQ(ring.drain(buffer.data(), buffer.size()), 24u);
+    EXPECT_EQ(ring.drain(buffer.data(), buffer.size()), 0u);
+    EXPECT_FALSE(ring.finished());
+    ring.close();
+    EXPECT_TRUE(ring.finished());
+    EXPECT_TRUE(ring.wait(0));
+}
+
+TEST(TokenRingTest, CancelReleasesABlockedProducer) {
+    TokenRing ring(4096);
+    std::thread producer([&] {
+        size_t pushed = 0;
+        while (ring.push(std::string(100, 'x'), 0, 0.0)) ++pushed;
+        EXPECT_GT(pushed, 0u);
+    });
+    // Nothing drains, so the producer ends up waiting for space until the cancel
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ring.cancel();
+    producer.join();
+    EXPECT_TRUE(ring.finished());
+    EXPECT_THROW(ring.push(std::string(ring.capacity(), 'x'), 0, 0.0), std::length_error);
+}
+
+#if defined(__linux__)
+TEST(TokenRingTest, EventFdSignalsFirstFrameAndEnd) {
+    TokenRing ring(4096);
+    ASSERT_GE(ring.event_fd(), 0);
+    uint64_t count = 0;
+    EXPECT_LT(::read(ring.event_fd(), &count, sizeof(count)), 0);   // Nothing yet
+
+    ring.push("one", 0, 0.0);
+    ring.push("two", 1, 0.0);
+    EXPECT_EQ(::read(ring.event_fd(), &count, sizeof(count)), ssize_t(sizeof(count)));
+    EXPECT_EQ(count, 1u);   // Only the frame that landed in the empty ring
+
+    std::vector<uint8_t> buffer(4096);
+    EXPECT_GT(ring.drain(buffer.data(), buffer.size()), 0u);
+    ring.close();
+    EXPECT_EQ(::read(ring.event_fd(), &count, sizeof(count)), ssize_t(sizeof(count)));
+}
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file test_unicode.cpp
+ * @brief Vectorized UTF-8 / UTF-32 transcoding against a byte-at-a-time reference
+ */
+
+#include <gtest/gtest.h>
+#include <utils/unicode.hpp>
+#include <random>
+
+using namespace Hartonomous;
+
+// The scalar decoder the vectorized one must match byte for byte, malformed input included
+static std::u32string reference_decode(std::string_view s) {
+    std::u32string out;
+    for (size_t i = 0; i < s.size(); ) {
+        uint8_t c = static_cast<uint8_t>(s[i]);
+        char32_t cp = 0;
+        size_t len = 0;
+        if (c < 0x80) { cp = c; len = 1; }
+        else if ((c >> 5) == 0x6) { cp = c & 0x1F; len = 2; }
+        else if ((c >> 4) == 0xE) { cp = c & 0x0F; len = 3; }
+        else if ((c >> 3) == 0x1E) { cp = c & 0x07; len = 4; }
+        else { ++i; continue; }
+        for (size_t j = 1; j < len && i + j < s.size(); ++j) {
+            uint8_t cc = static_cast<uint8_t>(s[i + j]);
+            if ((cc >> 6) != 0x2) { len = 1; break; }
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        out.push_back(cp);
+        i += len;
+    }
+    return out;
+}
+
+// Mostly ASCII with bursts of CJK and the odd 2- and 4-byte character
+static std::u32string random_text(std::mt19937& rng, size_t n) {
+    std::u32string text;
+    while (text.size() < n) {
+        switch (rng() % 10) {
+            case 0: for (int k = 0; k < 5; ++k) text += char32_t(0x4E00 + rng() % 0x5000); break;
+            case 1: text += char32_t(0xC0 + rng() % 0x700); break;
+            case 2: text += char32_t(0x1F600 + rng() % 0x50); break;
+            default: for (int k = 0; k < 40; ++k) text += char32_t(0x20 + rng() % 0x5F); break;
+        }
+    }
+    return text;
+}
+
+TEST(UnicodeTest, RoundTripsMixedText) {
+    std::mt19937 rng(11);
+    for (int trial = 0; trial < 50; ++trial) {
+        std::u32string text = random_text(rng, 1 + rng() % 2000);
+        std::string utf8 = utf32_to_utf8(text);
+        EXPECT_EQ(utf8.size(), utf8_length(text));
+        EXPECT_TRUE(utf8_validate(utf8));
+        EXPECT_EQ(utf8_to_utf32(utf8), text);
+        EXPECT_EQ(utf8_to_utf32(utf8), reference_decode(utf8));
+    }
+}
+
+TEST(UnicodeTest, MalformedInputMatchesReference) {
+    std::mt19937 rng(12);
+    for (int trial = 0; trial < 200; ++trial) {
+        std::string bytes = utf32_to_utf8(random_text(rng, 200));
+        // Corrupt a few bytes and cut the tail mid-sequence
+        for (int k = 0; k < 4; ++k) bytes[rng() % bytes.size()] = static_cast<char>(rng());
+        bytes.resize(bytes.size() - rng() % 3);
+        EXPECT_EQ(utf8_to_utf32(bytes), reference_decode(bytes));
+    }
+}
+
+TEST(UnicodeTest, ValidateRejectsMalformedSequences) {
+    EXPECT_TRUE(utf8_validate(""));
+    EXPECT_TRUE(utf8_validate(std::string(100, 'a') + "\xE4\xB8\xAD" + std::string(40, 'b')));
+    EXPECT_FALSE(utf8_validate(std::string(64, 'a') + "\xC0\xAF"));   // Overlong '/'
+    EXPECT_FALSE(utf8_validate("\xED\xA0\x80"));                       // Surrogate
+    EXPECT_FALSE(utf8_validate("\xF4\x90\x80\x80"));                   // Past U+10FFFF
+    EXPECT_FALSE(utf8_validate("\xE4\xB8"));                           // Truncated
+    EXPECT_FALSE(utf8_validate("\x80"));                               // Lone continuation
+}
@@ -0,0 +1,15 @@
+/**
+ * @file alloc_profile_conf.cpp
+ * @brief jemalloc startup options for HARTONOMOUS_ALLOC_PROFILE builds
+ *
+ * Linked into every tool when the option is on. The sampler exists from
+ * the first allocation but stays inactive until IngestReport::start() sees
+ * HARTONOMOUS_ALLOC_PROFILE=1, so an unprofiled run pays almost nothing.
+ * prof_accum keeps cumulative counts, which is what jeprof --alloc_objects
+ * ranks call sites by; one sample per 128 KiB allocated on average.
+ * MALLOC_CONF in the environment still overrides any of these.
+ */
+
+extern "C" {
+const char* malloc_conf = "prof:true,prof_active:false,prof_accum:true,lg_prof_sample:17";
+}
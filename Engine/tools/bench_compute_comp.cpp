@@ -0,0 +1,97 @@
+/**
+ * @file bench_compute_comp.cpp
+ * @brief Throughput and allocation count of SubstrateService::compute_comp
+ *
+ * Compares the value-returning API with the scratch/caller-storage overload
+ * on a word list. Usage: bench_compute_comp [words.txt] [rounds]
+ */
+
+#include <ingestion/substrate_service.hpp>
+#include <database/postgres_connection.hpp>
+#include <storage/atom_lookup.hpp>
+#include <utils/time.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+using namespace Hartonomous;
+
+static std::atomic<size_t> g_allocs{0};
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static std::vector<std::string> default_words() {
+    std::vector<std::string> words;
+    const char* base[] = {"the", "whale", "ocean", "swimming", "Ünïcödé", "naïve", "東京", "Straße",
+                          "internationalization", "a", "characteristically", "ἀλήθεια"};
+    for (int r = 0; r < 1000; ++r)
+        for (const char* w : base) words.push_back(std::string(w) + (r % 7 ? "" : std::to_string(r)));
+    return words;
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::vector<std::string> words;
+        if (argc > 1) {
+            std::ifstream in(argv[1]);
+            if (!in) throw std::runtime_error(std::string("Cannot open ") + argv[1]);
+            for (std::string line; std::getline(in, line);)
+                if (!line.empty()) words.push_back(line);
+        } else {
+            words = default_words();
+        }
+        size_t rounds = argc > 2 ? std::stoul(argv[2]) : 20;
+
+        PostgresConnection db;
+        AtomLookup lookup(db);
+        lookup.preload_all();
+        std::cout << "Atoms " << (lookup.is_image_mapped() ? "mapped from image" : "loaded from database")
+                  << ", " << words.size() << " words x " << rounds << " rounds\n";
+
+        size_t total = words.size() * rounds;
+        size_t sink = 0;
+
+        // Value-returning API
+        {
+            size_t a0 = g_allocs.load();
+            Timer t;
+            for (size_t r = 0; r < rounds; ++r)
+                for (const auto& w : words) sink += SubstrateService::compute_comp(w, lookup).seq.size();
+            double sec = t.elapsed_sec();
+            std::cout << "compute_comp(text)         : " << (sec * 1e9 / total) << " ns/word, "
+                      << double(g_allocs.load() - a0) / total << " allocs/word\n";
+        }
+
+        // Scratch + reused output
+        {
+            SubstrateService::ComputeScratch scratch;
+            SubstrateService::ComputedComp out;
+            for (const auto& w : words) SubstrateService::compute_comp(w, lookup, scratch, out);  // warm buffers
+
+            size_t a0 = g_allocs.load();
+            Timer t;
+            for (size_t r = 0; r < rounds; ++r)
+                for (const auto& w : words) {
+                    SubstrateService::compute_comp(w, lookup, scratch, out);
+                    sink += out.seq.size();
+                }
+            double sec = t.elapsed_sec();
+            std::cout << "compute_comp(text, scratch): " << (sec * 1e9 / total) << " ns/word, "
+                      << double(g_allocs.load() - a0) / total << " allocs/word\n";
+        }
+
+        std::cout << "(checksum " << sink << ")\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "FATAL ERROR: " << e.what() << "\n";
+        return 1;
+    }
+}
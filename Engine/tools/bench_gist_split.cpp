@@ -0,0 +1,175 @@
+/**
+ * @file bench_gist_split.cpp
+ * @brief Pages a KNN scan reads under each gist_s3_ops split method
+ *
+ * Builds an in-memory R-tree the way GiST inserts into gist_s3_ops: one
+ * entry at a time, descending by the opclass penalty (volume enlargement,
+ * ties broken at random) and splitting overfull pages with split_bboxes.
+ * Then runs best-first KNN, the ordered GiST scan, and counts the pages it
+ * reads. No database needed.
+ *
+ * Usage: bench_gist_split [points] [page_capacity] [k]
+ */
+
+#include <geometry/s3_bbox_split.hpp>
+#include <utils/time.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+
+using namespace s3;
+
+namespace {
+
+struct Node {
+    bool leaf = true;
+    std::vector<BBox4> boxes;
+    std::vector<std::unique_ptr<Node>> children;  // Parallel to boxes unless leaf
+};
+
+class Tree {
+public:
+    Tree(SplitMethod method, size_t capacity) : method_(method), capacity_(capacity), root_(new Node) {}
+
+    void insert(const BBox4& b) {
+        if (auto sibling = insert(root_.get(), b)) {
+            auto root = std::make_unique<Node>();
+            root->leaf = false;
+            root->boxes = {cover(*root_), cover(*sibling)};
+            root->children.push_back(std::move(root_));
+            root->children.push_back(std::move(sibling));
+            root_ = std::move(root);
+        }
+    }
+
+    // Pages read until the k nearest entries to q are known
+    size_t knn_pages(const Vec4& q, size_t k) const {
+        using Item = std::pair<double, const Node*>;  // Node null: an entry
+        std::priority_queue<Item, std::vector<Item>, std::greater<>> frontier;
+        frontier.emplace(0.0, root_.get());
+        size_t pages = 0, found = 0;
+        while (!frontier.empty() && found < k) {
+            const Node* n = frontier.top().second;
+            frontier.pop();
+            if (!n) { ++found; continue; }
+            ++pages;
+            for (size_t i = 0; i < n->boxes.size(); ++i)
+                frontier.emplace(distance_point_bbox(q, n->boxes[i]), n->leaf ? nullptr : n->children[i].get());
+        }
+        return pages;
+    }
+
+    size_t height() const {
+        size_t h = 1;
+        for (const Node* n = root_.get(); !n->leaf; n = n->children[0].get()) ++h;
+        return h;
+    }
+
+private:
+    static BBox4 cover(const Node& n) {
+        BBox4 b = n.boxes[0];
+        for (const auto& x : n.boxes) b = bbox_union(b, x);
+        return b;
+    }
+
+    // Returns the new right sibling if n split
+    std::unique_ptr<Node> insert(Node* n, const BBox4& b) {
+        if (n->leaf) {
+            n->boxes.push_back(b);
+        } else {
+            size_t best = 0, ties = 0;
+            float best_penalty = INFINITY;
+            for (size_t i = 0; i < n->boxes.size(); ++i) {
+                float p = static_cast<float>(
+                    std::max(0.0, bbox_volume(bbox_union(n->boxes[i], b)) - bbox_volume(n->boxes[i])));
+                if (p < best_penalty) { best_penalty = p; best = i; ties = 1; }
+                else if (p == best_penalty && rng_() % ++ties == 0) best = i;
+            }
+            n->boxes[best] = bbox_union(n->boxes[best], b);
+            if (auto sibling = insert(n->children[best].get(), b)) {
+                n->boxes[best] = cover(*n->children[best]);
+                n->boxes.push_back(cover(*sibling));
+                n->children.push_back(std::move(sibling));
+            }
+        }
+        if (n->boxes.size() <= capacity_) return nullptr;
+
+        BBoxSplit split = split_bboxes(n->boxes, method_);
+        auto right = std::make_unique<Node>();
+        right->leaf = n->leaf;
+        std::vector<BBox4> left_boxes;
+        std::vector<std::unique_ptr<Node>> left_children;
+        for (int i : split.left) {
+            left_boxes.push_back(n->boxes[i]);
+            if (!n->leaf) left_children.push_back(std::move(n->children[i]));
+        }
+        for (int i : split.right) {
+            right->boxes.push_back(n->boxes[i]);
+            if (!n->leaf) right->children.push_back(std::move(n->children[i]));
+        }
+        n->boxes = std::move(left_boxes);
+        n->children = std::move(left_children);
+        return right;
+    }
+
+    SplitMethod method_;
+    size_t capacity_;
+    std::unique_ptr<Node> root_;
+    std::mt19937 rng_{7};
+};
+
+// Points on S³ around a few hundred centres, like word centroids around their
+// senses; half the centres are knots of near-identical centroids
+std::vector<Vec4> clustered_points(size_t n) {
+    std::mt19937_64 rng(52);
+    std::normal_distribution<double> g;
+    auto unit = [](Vec4 p) {
+        double norm = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + p[3] * p[3]);
+        for (auto& x : p) x /= norm;
+        return p;
+    };
+    std::vector<Vec4> centres(std::max<size_t>(1, n / 500));
+    for (auto& c : centres) c = unit({g(rng), g(rng), g(rng), g(rng)});
+    std::vector<Vec4> points(n);
+    for (auto& p : points) {
+        // Every other centre is a knot of near-identical ones
+        const size_t i = rng() % centres.size();
+        const Vec4& c = centres[i];
+        const double spread = i % 2 ? 1e-5 : 0.05;
+        p = unit({c[0] + spread * g(rng), c[1] + spread * g(rng), c[2] + spread * g(rng), c[3] + spread * g(rng)});
+    }
+    return points;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t capacity = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    const size_t k = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10;
+
+    std::vector<Vec4> points = clustered_points(n);
+    std::vector<Vec4> queries(points.begin(), points.begin() + std::min<size_t>(n, 2000));
+
+    std::cout << n << " points, " << capacity << " entries per page, k = " << k << "\n";
+    std::cout << std::left << std::setw(10) << "split" << std::setw(10) << "build s" << std::setw(8) << "height"
+              << "pages per query\n";
+    for (auto [name, method] : {std::pair{"midpoint", SplitMethod::Midpoint},
+                                std::pair{"rstar", SplitMethod::RStar},
+                                std::pair{"hilbert", SplitMethod::Hilbert}}) {
+        Tree tree(method, capacity);
+        Hartonomous::Timer timer;
+        for (const auto& p : points) tree.insert(bbox_from_point(p));
+        const double build = timer.elapsed_sec();
+
+        size_t pages = 0;
+        for (const auto& q : queries) pages += tree.knn_pages(q, k);
+        std::cout << std::setw(10) << name << std::setw(10) << std::setprecision(3) << build << std::setw(8)
+                  << tree.height() << double(pages) / queries.size() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,351 @@
+/**
+ * @file bench_inference.cpp
+ * @brief Latency under load of generate, A* search, reason and quick_answer
+ *
+ * Replays a prompt set through the C API (interop_api.h), as the app layer
+ * calls it, with a fixed number of concurrent callers on one database and
+ * one engine handle per mode. Per mode it reports the latency distribution
+ * and histogram, statements sent per request (on the calling thread, and
+ * for the whole process including background work), and neighbor-cache and
+ * response-cache hit rates over the measured requests, and the statements
+ * with the most server time (by fingerprint) during them. Run it against a
+ * substrate that does not change between runs, or the numbers do not compare.
+ *
+ * Prompt file: one prompt per line; blank lines and lines starting with '#'
+ * are skipped. A* takes "start<TAB>goal" lines, and pairs each other prompt
+ * with the next one.
+ *
+ * Usage: bench_inference <prompts.txt> [--mode walk|astar|reason|quick|all]
+ *            [--concurrency N] [--requests N] [--warmup N] [--max-tokens N]
+ *            [--seed S] [--graph] [--top N] [--json <file>]
+ * --graph expands from a shared relation graph snapshot instead of per-step
+ * queries. The pool size comes from HARTONOMOUS_POOL_SIZE as in the app.
+ */
+
+#include <interop_api.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string prompts_file;
+    std::vector<std::string> modes{"walk", "astar", "reason", "quick"};
+    size_t concurrency = 4;
+    size_t requests = 200;
+    size_t warmup = 20;
+    size_t max_tokens = 32;
+    uint64_t seed = 42;
+    bool graph = false;
+    size_t top = 5;
+    std::string json_file;
+};
+
+struct Sample {
+    double ms;
+    uint64_t queries;   // Sent on the calling thread
+    bool ok;
+};
+
+std::vector<std::string> load_prompts(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    std::vector<std::string> prompts;
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        prompts.push_back(line);
+    }
+    if (prompts.empty()) throw std::runtime_error(path + " has no prompts");
+    return prompts;
+}
+
+uint64_t thread_queries() {
+    HEngineStats s{};
+    hartonomous_engine_stats(&s);
+    return s.db_queries_thread;
+}
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t rank = static_cast<size_t>(std::ceil(p * v.size()));
+    return v[std::clamp<size_t>(rank, 1, v.size()) - 1];
+}
+
+double rate(uint64_t hits, uint64_t misses) {
+    return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+}
+
+/**
+ * @brief One mode's engine handle and request
+ *
+ * run(i) serves prompt i (modulo the set) and returns false on an API error.
+ */
+class Workload {
+public:
+    Workload(const std::string& mode, h_db_connection_t db, const std::vector<std::string>& prompts, const Options& opts)
+        : mode_(mode), db_(db), prompts_(prompts), opts_(opts) {
+        if (mode == "walk") handle_ = hartonomous_walk_create(db);
+        else if (mode == "astar") handle_ = hartonomous_astar_create(db);
+        else if (mode == "reason" || mode == "quick") handle_ = hartonomous_reasoning_create(db);
+        else throw std::runtime_error("Unknown mode: " + mode);
+        if (!handle_) throw std::runtime_error(mode + ": " + hartonomous_get_last_error());
+    }
+
+    Workload(const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+
+    ~Workload() {
+        if (mode_ == "walk") hartonomous_walk_destroy(handle_);
+        else if (mode_ == "astar") hartonomous_astar_destroy(handle_);
+        else hartonomous_reasoning_destroy(handle_);
+    }
+
+    bool run(size_t i) const {
+        const size_t p = i % prompts_.size();
+        const std::string& prompt = prompts_[p];
+        if (mode_ == "walk") {
+            HGenerateParams params{};
+            params.max_tokens = opts_.max_tokens;
+            params.n = 1;
+            params.seed = opts_.seed ? opts_.seed + p : 0;  // The same prompt walks the same way
+            HGenerateResult result{};
+            if (!hartonomous_generate(handle_, db_, prompt.c_str(), &params, &result)) return false;
+            hartonomous_free_string(result.text);
+            return true;
+        }
+        if (mode_ == "astar") {
+            std::string start = prompt, goal = prompts_[(p + 1) % prompts_.size()];
+            if (auto tab = prompt.find('\t'); tab != std::string::npos) {
+                start = prompt.substr(0, tab);
+                goal = prompt.substr(tab + 1);
+            }
+            HPathResult result{};
+            if (!hartonomous_astar_search_text(handle_, start.c_str(), goal.c_str(), 0, &result)) return false;
+            hartonomous_free_string(result.path);
+            return true;
+        }
+        HReasoningResult result{};
+        bool ok;
+        if (mode_ == "quick") {
+            ok = hartonomous_quick_answer(handle_, prompt.c_str(), &result);
+        } else {
+            HReasoningConfig config{};
+            config.max_tokens = opts_.max_tokens;
+            ok = hartonomous_reason(handle_, prompt.c_str(), &config, &result);
+        }
+        if (ok) hartonomous_reasoning_free_result(&result);
+        return ok;
+    }
+
+private:
+    std::string mode_;
+    h_db_connection_t db_;
+    const std::vector<std::string>& prompts_;
+    const Options& opts_;
+    void* handle_ = nullptr;
+};
+
+// `count` requests from `concurrency` threads pulling the next index
+std::vector<Sample> drive(const Workload& w, size_t first, size_t count, size_t concurrency) {
+    std::vector<Sample> samples(count);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::max<size_t>(1, concurrency); ++t) {
+        threads.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1)) < count;) {
+                const uint64_t q0 = thread_queries();
+                const auto t0 = std::chrono::steady_clock::now();
+                bool ok = w.run(first + i);
+                const auto t1 = std::chrono::steady_clock::now();
+                samples[i] = {std::chrono::duration<double, std::milli>(t1 - t0).count(), thread_queries() - q0, ok};
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return samples;
+}
+
+nlohmann::json run_mode(const std::string& mode, h_db_connection_t db,
+                        const std::vector<std::string>& prompts, const Options& opts) {
+    Workload w(mode, db, prompts, opts);
+    if (opts.warmup > 0) drive(w, 0, opts.warmup, opts.concurrency);
+
+    HEngineStats before{}, after{};
+    hartonomous_engine_stats(&before);
+    hartonomous_db_statements_reset();
+    const auto t0 = std::chrono::steady_clock::now();
+    auto samples = drive(w, opts.warmup, opts.requests, opts.concurrency);
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    hartonomous_engine_stats(&after);
+    nlohmann::json statements = nlohmann::json::array();
+    if (opts.top > 0) {
+        char* text = hartonomous_db_statements_json(opts.top);
+        if (text) {
+            statements = nlohmann::json::parse(text);
+            hartonomous_free_string(text);
+        }
+    }
+
+    std::vector<double> ms, queries;
+    size_t errors = 0;
+    for (const auto& s : samples) {
+        if (!s.ok) { ++errors; continue; }
+        ms.push_back(s.ms);
+        queries.push_back(static_cast<double>(s.queries));
+    }
+
+    // Buckets double from 1 ms; the first holds everything faster
+    std::vector<size_t> histogram;
+    for (double v : ms) {
+        size_t b = v < 1.0 ? 0 : static_cast<size_t>(std::log2(v)) + 1;
+        if (histogram.size() <= b) histogram.resize(b + 1, 0);
+        ++histogram[b];
+    }
+
+    const double ok_count = static_cast<double>(ms.size());
+    nlohmann::json j;
+    j["mode"] = mode;
+    j["requests"] = samples.size();
+    j["errors"] = errors;
+    j["concurrency"] = opts.concurrency;
+    j["wall_sec"] = wall;
+    j["requests_per_sec"] = wall > 0 ? samples.size() / wall : 0.0;
+    j["latency_ms"] = {{"mean", ms.empty() ? 0.0 : [&] { double s = 0; for (double v : ms) s += v; return s / ok_count; }()},
+                       {"p50", percentile(ms, 0.50)}, {"p90", percentile(ms, 0.90)},
+                       {"p99", percentile(ms, 0.99)}, {"max", percentile(ms, 1.0)}};
+    j["histogram_ms"] = nlohmann::json::array();
+    for (size_t b = 0; b < histogram.size(); ++b)
+        j["histogram_ms"].push_back({{"below", std::ldexp(1.0, static_cast<int>(b))}, {"count", histogram[b]}});
+    j["queries_per_request"] = {
+        {"mean", ok_count > 0 ? [&] { double s = 0; for (double v : queries) s += v; return s / ok_count; }() : 0.0},
+        {"p99", percentile(queries, 0.99)},
+        {"process", samples.empty() ? 0.0 : static_cast<double>(after.db_queries - before.db_queries) / samples.size()}};
+    j["neighbor_cache_hit_rate"] = rate(after.neighbor_cache_hits - before.neighbor_cache_hits,
+                                        after.neighbor_cache_misses - before.neighbor_cache_misses);
+    j["answer_cache_hit_rate"] = rate(after.answer_cache_hits - before.answer_cache_hits,
+                                      after.answer_cache_misses - before.answer_cache_misses);
+    j["top_statements"] = std::move(statements);
+    return j;
+}
+
+void print_mode(const nlohmann::json& j) {
+    const auto& lat = j["latency_ms"];
+    std::cout << "\n=== " << j["mode"].get<std::string>() << " ===\n" << std::fixed << std::setprecision(2)
+              << "  requests " << j["requests"] << " (" << j["errors"] << " errors), "
+              << j["requests_per_sec"].get<double>() << " req/s at concurrency " << j["concurrency"] << "\n"
+              << "  latency ms  mean " << lat["mean"].get<double>() << "  p50 " << lat["p50"].get<double>()
+              << "  p90 " << lat["p90"].get<double>() << "  p99 " << lat["p99"].get<double>()
+              << "  max " << lat["max"].get<double>() << "\n"
+              << "  queries/request  " << j["queries_per_request"]["mean"].get<double>() << " (p99 "
+              << j["queries_per_request"]["p99"].get<double>() << ", process "
+              << j["queries_per_request"]["process"].get<double>() << ")\n"
+              << "  hit rate  neighbors " << 100.0 * j["neighbor_cache_hit_rate"].get<double>()
+              << "%  answers " << 100.0 * j["answer_cache_hit_rate"].get<double>() << "%\n";
+
+    size_t peak = 1;
+    for (const auto& b : j["histogram_ms"]) peak = std::max(peak, b["count"].get<size_t>());
+    for (const auto& b : j["histogram_ms"]) {
+        size_t count = b["count"].get<size_t>();
+        std::cout << "  < " << std::setw(8) << std::setprecision(0) << b["below"].get<double>() << " ms "
+                  << std::setw(6) << count << " " << std::string(count * 40 / peak, '#') << "\n";
+    }
+
+    if (!j["top_statements"].empty()) std::cout << "  top statements by server time\n";
+    for (const auto& st : j["top_statements"]) {
+        std::string sql = st["statement"].get<std::string>();
+        if (sql.size() > 80) sql = sql.substr(0, 77) + "...";
+        std::cout << "  " << std::setprecision(1) << std::setw(9) << st["total_ms"].get<double>() << " ms "
+                  << std::setw(7) << st["calls"].get<uint64_t>() << " calls " << std::setprecision(2)
+                  << std::setw(8) << st["mean_ms"].get<double>() << " ms/call  " << sql << "\n";
+    }
+}
+
+Options parse(int argc, char** argv) {
+    if (argc < 2) throw std::runtime_error("missing prompt file");
+    Options o;
+    o.prompts_file = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error(a + " needs a value");
+            return argv[++i];
+        };
+        if (a == "--mode") {
+            std::string m = value();
+            if (m != "all") o.modes = {m};
+        } else if (a == "--concurrency") o.concurrency = std::stoul(value());
+        else if (a == "--requests") o.requests = std::stoul(value());
+        else if (a == "--warmup") o.warmup = std::stoul(value());
+        else if (a == "--max-tokens") o.max_tokens = std::stoul(value());
+        else if (a == "--seed") o.seed = std::stoull(value());
+        else if (a == "--graph") o.graph = true;
+        else if (a == "--top") o.top = std::stoul(value());
+        else if (a == "--json") o.json_file = value();
+        else throw std::runtime_error("Unknown option: " + a);
+    }
+    return o;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        opts = parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: " << argv[0] << " <prompts.txt> [--mode walk|astar|reason|quick|all]\n"
+                  << "           [--concurrency N] [--requests N] [--warmup N] [--max-tokens N]\n"
+                  << "           [--seed S] [--graph] [--top N] [--json <file>]\n";
+        return 1;
+    }
+
+    h_db_connection_t db = nullptr;
+    try {
+        auto prompts = load_prompts(opts.prompts_file);
+        db = hartonomous_db_create("");
+        if (!db || !hartonomous_db_is_connected(db))
+            throw std::runtime_error(std::string("Database: ") + hartonomous_get_last_error());
+        if (opts.graph && !hartonomous_db_share_relation_graph(db))
+            throw std::runtime_error(std::string("Relation graph: ") + hartonomous_get_last_error());
+
+        std::cout << prompts.size() << " prompts, " << opts.requests << " requests per mode after "
+                  << opts.warmup << " warmup, concurrency " << opts.concurrency
+                  << (opts.graph ? ", relation graph snapshot" : ", per-step queries") << "\n";
+
+        nlohmann::json report;
+        report["prompts"] = prompts.size();
+        report["graph"] = opts.graph;
+        report["modes"] = nlohmann::json::array();
+        for (const auto& mode : opts.modes) {
+            auto j = run_mode(mode, db, prompts, opts);
+            print_mode(j);
+            report["modes"].push_back(std::move(j));
+        }
+
+        if (!opts.json_file.empty()) {
+            std::ofstream out(opts.json_file);
+            out << report.dump(2) << "\n";
+            if (!out) throw std::runtime_error("Writing " + opts.json_file + " failed");
+        }
+        hartonomous_db_destroy(db);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        hartonomous_db_destroy(db);
+        return 1;
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * @file bench_knn.cpp
+ * @brief Recall and time of the embedding-pass KNN backends
+ *
+ * Runs blocked-GEMM exact KNN (the ground truth) and HNSW with the
+ * ModelIngestionConfig embedding preset (float32, FP16 and int8 vectors,
+ * the quantized ones re-ranked in float) over the same normalized rows, and
+ * reports HNSW recall of the exact above-threshold edges. No database needed.
+ * With a device KNN plugin loaded (ingestion/device_knn.hpp) its exact search
+ * is timed too and checked against blocked GEMM.
+ *
+ * Usage: bench_knn <model_directory> [k] [threshold]
+ *        bench_knn --synthetic <rows> <dim> [k] [threshold]
+ */
+
+#include <ingestion/blocked_knn.hpp>
+#include <ingestion/device_knn.hpp>
+#include <ingestion/model_ingester.hpp>
+#include <ingestion/safetensor_loader.hpp>
+#include <utils/time.hpp>
+#include <omp.h>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+using namespace Hartonomous;
+
+// Clustered unit vectors, so thresholded neighborhoods are non-trivial
+static Eigen::MatrixXf synthetic(size_t rows, size_t dim) {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> g(0.0f, 1.0f);
+    size_t centers = std::max<size_t>(1, rows / 64);
+    Eigen::MatrixXf C(centers, dim);
+    for (Eigen::Index i = 0; i < C.size(); ++i) C.data()[i] = g(rng);
+    Eigen::MatrixXf X(rows, dim);
+    for (size_t i = 0; i < rows; ++i) {
+        size_t c = rng() % centers;
+        for (size_t d = 0; d < dim; ++d) X(i, d) = C(c, d) + 0.6f * g(rng);
+    }
+    return X;
+}
+
+int main(int argc, char** argv) {
+    try {
+        if (argc < 2) {
+            std::cerr << "Usage: " << argv[0] << " <model_directory> [k] [threshold]\n"
+                      << "       " << argv[0] << " --synthetic <rows> <dim> [k] [threshold]\n";
+            return 1;
+        }
+
+        ModelIngestionConfig config;
+        Eigen::MatrixXf X;
+        int arg = 2;
+        if (std::string(argv[1]) == "--synthetic") {
+            if (argc < 4) throw std::runtime_error("--synthetic needs <rows> <dim>");
+            X = synthetic(std::stoul(argv[2]), std::stoul(argv[3]));
+            arg = 4;
+        } else {
+            SafetensorLoader loader(argv[1]);
+            X = loader.get_embeddings();
+            size_t vocab = loader.metadata().vocab.size();
+            if (vocab > 0 && vocab < static_cast<size_t>(X.rows())) X.conservativeResize(vocab, Eigen::NoChange);
+        }
+        size_t k = argc > arg ? std::stoul(argv[arg]) : config.max_neighbors_per_token;
+        float threshold = argc > arg + 1 ? std::stof(argv[arg + 1]) : static_cast<float>(config.embedding_similarity_threshold);
+
+        X.rowwise().normalize();
+        const size_t n = X.rows();
+        const size_t dim = X.cols();
+        k = std::min(k, n - 1);
+        auto tiles = blocked_knn_tiles(dim);
+        std::cout << n << " rows x " << dim << " dims, k=" << k << ", threshold=" << threshold
+                  << ", " << omp_get_max_threads() << " threads, tiles " << tiles.query_rows
+                  << "x" << tiles.key_rows << "\n";
+
+        Timer t;
+        auto exact = blocked_knn(X, X, k, threshold, true, tiles);
+        double gemm_ms = t.elapsed_ms();
+        size_t exact_edges = 0;
+        for (auto c : exact.count) exact_edges += c;
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << "BlockedGEMM: " << gemm_ms << " ms, " << exact_edges << " edges (exact)\n";
+
+        // HNSW reads each point as `dim` contiguous floats
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> R = X;
+
+        if (const DeviceKnn* device = DeviceKnn::get(); device && k <= device->max_k()) {
+            t.reset();
+            auto listed = device->knn(R.data(), n, R.data(), n, dim, k, threshold, true);
+            double device_ms = t.elapsed_ms();
+            size_t device_edges = 0, found = 0;
+            for (size_t i = 0; i < n; ++i) {
+                std::unordered_set<uint32_t> truth(exact.index.begin() + i * k,
+                                                   exact.index.begin() + i * k + exact.count[i]);
+                device_edges += listed.count[i];
+                for (uint32_t m = 0; m < listed.count[i]; ++m) found += truth.count(listed.index[i * k + m]);
+            }
+            std::cout << std::setprecision(0) << "Device:      " << device_ms << " ms, " << device_edges
+                      << " edges, agreement " << std::setprecision(4)
+                      << (exact_edges ? double(found) / exact_edges : 1.0) << " (" << device->device_name() << ")\n";
+        }
+        const auto& hp = config.hnsw_embedding;
+        const std::pair<HnswQuantization, const char*> variants[] = {
+            {HnswQuantization::Float32, "HNSW f32: "},
+            {HnswQuantization::FP16, "HNSW fp16:"},
+            {HnswQuantization::Int8, "HNSW int8:"},
+        };
+        for (const auto& [quant, label] : variants) {
+            HnswIndexCache::Entry entry;
+            entry.space = std::make_unique<QuantizedIPSpace>(dim, quant);
+            entry.index = std::make_unique<HnswIndexCache::Index>(entry.space.get(), n, hp.M, hp.ef_construction);
+
+            t.reset();
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (size_t i = 0; i < n; ++i) entry.add_point(R.row(i).data(), i);
+            double build_ms = t.elapsed_ms();
+
+            entry.index->setEf(hp.ef_search);
+            size_t found = 0, hnsw_edges = 0;
+            t.reset();
+            #pragma omp parallel for schedule(dynamic, 512) reduction(+:found, hnsw_edges)
+            for (size_t i = 0; i < n; ++i) {
+                std::unordered_set<uint32_t> truth(exact.index.begin() + i * k,
+                                                   exact.index.begin() + i * k + exact.count[i]);
+                std::vector<std::pair<size_t, float>> neighbors;
+                entry.neighbors(R.row(i).data(), k + 1, R.data(), neighbors);
+                for (const auto& [j, sim] : neighbors) {
+                    if (j == i || sim < threshold) continue;
+                    ++hnsw_edges;
+                    found += truth.count(static_cast<uint32_t>(j));
+                }
+            }
+            double search_ms = t.elapsed_ms();
+
+            std::cout << std::setprecision(0) << label << " " << (build_ms + search_ms) << " ms (build "
+                      << build_ms << ", search " << search_ms << ", ef=" << hp.ef_search << "), "
+                      << hnsw_edges << " edges, vectors " << (n * entry.space->get_data_size() >> 20)
+                      << " MB, recall " << std::setprecision(4)
+                      << (exact_edges ? double(found) / exact_edges : 1.0) << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "FATAL ERROR: " << e.what() << "\n";
+        return 1;
+    }
+}
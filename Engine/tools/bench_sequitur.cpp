@@ -0,0 +1,83 @@
+/**
+ * @file bench_sequitur.cpp
+ * @brief Sequitur grammar induction throughput and memory on a corpus
+ *
+ * Usage: bench_sequitur [corpus.txt] [megabytes]
+ * Without a corpus, generates Zipf-distributed words (100 MB by default).
+ * A corpus is read in full unless megabytes caps it.
+ */
+
+#include <ingestion/sequitur.hpp>
+#include <utils/time.hpp>
+#include <utils/unicode.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace Hartonomous;
+
+static std::string synthetic_corpus(size_t bytes) {
+    std::mt19937_64 rng(49);
+    std::vector<std::string> vocab(50000);
+    for (auto& w : vocab) {
+        const size_t len = 2 + rng() % 9;
+        for (size_t i = 0; i < len; ++i) w.push_back(static_cast<char>('a' + rng() % 26));
+    }
+    // Zipf(1) over the vocabulary by inverting its CDF
+    std::vector<double> cdf(vocab.size());
+    double sum = 0;
+    for (size_t i = 0; i < vocab.size(); ++i) cdf[i] = sum += 1.0 / double(i + 1);
+    std::uniform_real_distribution<double> u(0, sum);
+
+    std::string text;
+    text.reserve(bytes + 16);
+    size_t sentence = 0;
+    while (text.size() < bytes) {
+        text += vocab[std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin()];
+        text += ++sentence % 12 ? ' ' : '\n';
+    }
+    text.resize(bytes);
+    return text;
+}
+
+int main(int argc, char** argv) {
+    const size_t megabytes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    std::string text;
+    if (argc > 1) {
+        std::ifstream f(argv[1], std::ios::binary);
+        if (!f) { std::cerr << "Cannot open " << argv[1] << std::endl; return 1; }
+        std::ostringstream b; b << f.rdbuf();
+        text = b.str();
+        if (megabytes) text.resize(std::min(text.size(), megabytes << 20));
+    } else {
+        text = synthetic_corpus((megabytes ? megabytes : 100) << 20);
+    }
+
+    std::u32string utf32 = utf8_to_utf32(text);
+    std::cout << "Corpus: " << text.size() / 1048576.0 << " MB, " << utf32.size() << " codepoints" << std::endl;
+
+    Timer timer;
+    Sequitur seq(utf32.size());
+    seq.append(utf32);
+    const double build = timer.elapsed_sec();
+
+    Timer read_timer;
+    Grammar g = seq.grammar();
+    const double read_out = read_timer.elapsed_sec();
+
+    std::cout << "Build:   " << build << " s (" << text.size() / 1048576.0 / build << " MB/s)\n"
+              << "Grammar: " << g.rule_count() << " rules, " << g.symbols.size() << " symbols ("
+              << 100.0 * g.symbols.size() / std::max<size_t>(utf32.size(), 1) << "% of input), read out in "
+              << read_out << " s\n"
+              << "Memory:  " << seq.memory_bytes() / 1048576.0 << " MB pooled symbols, rules and digram table"
+              << std::endl;
+
+    std::u32string check;
+    check.reserve(utf32.size());
+    g.expand(0, check);
+    if (check != utf32) { std::cerr << "Grammar does not expand to the input" << std::endl; return 1; }
+    return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file build_landmarks.cpp
+ * @brief Offline ALT preprocessing: landmark selection and distance table
+ *
+ * Usage: build_landmarks [landmark_count] [output_path]
+ */
+
+#include <cognitive/landmark_table.hpp>
+#include <cognitive/relation_graph.hpp>
+#include <database/postgres_connection.hpp>
+#include <utils/time.hpp>
+#include <iostream>
+#include <string>
+
+using namespace Hartonomous;
+
+int main(int argc, char** argv) {
+    try {
+        LandmarkOptions options;
+        if (argc > 1) options.count = std::stoul(argv[1]);
+        std::string path = (argc > 2) ? argv[2] : LandmarkTable::default_path();
+        if (path.empty()) {
+            std::cerr << "No output path: pass one or set HARTONOMOUS_LANDMARKS" << std::endl;
+            return 1;
+        }
+
+        PostgresConnection db;
+        Timer timer;
+        auto graph = RelationGraph::load(db);
+        std::cout << "Relation graph: " << graph->node_count() << " nodes, "
+                  << graph->edge_count() << " edges (" << timer.elapsed_sec() << "s)" << std::endl;
+
+        timer.reset();
+        auto table = LandmarkTable::build(*graph, options);
+        std::cout << "Landmarks: " << table->landmark_count() << " (" << timer.elapsed_sec() << "s)" << std::endl;
+
+        table->write_file(path);
+        std::cout << "Written to " << path << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
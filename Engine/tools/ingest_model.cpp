@@ -3,12 +3,26 @@
  * @brief CLI tool to ingest AI model packages into Hartonomous substrate
  *
  * Usage: ingest_model <model_directory>
+ * Set HARTONOMOUS_KNN_BACKEND=gemm for exact embedding KNN instead of HNSW,
+ * HARTONOMOUS_KNN_BACKEND=device to mine every pass on a GPU when a device KNN
+ * plugin finds one (HNSW otherwise; see ingestion/device_knn.hpp), and
+ * HARTONOMOUS_HNSW_QUANT=fp16|int8 to store HNSW vectors quantized.
+ * HARTONOMOUS_INGEST_MEMORY_GB caps the memory concurrent layer mining may
+ * use (default: three quarters of physical memory).
+ * A run that dies part-way resumes from its checkpoint on the next start;
+ * HARTONOMOUS_MODEL_CHECKPOINT sets where it is kept ("off" to disable).
+ * HARTONOMOUS_BULK_LOAD=1 drops secondary indexes and CHECKs for the load and
+ * rebuilds them in parallel at the end (database/bulk_load_session.hpp).
  */
 
 #include <ingestion/model_ingester.hpp>
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <hashing/blake3_pipeline.hpp>
+#include <utils/ingest_report.hpp>
 #include <utils/time.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <iomanip>
 #include <filesystem>
@@ -21,6 +35,7 @@ int main(int argc, char** argv) {
         std::cerr << "Usage: " << argv[0] << " <model_directory>\n";
         return 1;
     }
+    IngestReport::global().start(argc, argv);
 
     fs::path model_dir(argv[1]);
     if (!fs::exists(model_dir) || !fs::is_directory(model_dir)) {
@@ -34,16 +49,35 @@ int main(int argc, char** argv) {
             std::cerr << "Failed to connect to database. Check PG environment variables.\n";
             return 1;
         }
+        BulkLoadSession bulk(db);
 
         ModelIngestionConfig config;
         config.tenant_id = BLAKE3Pipeline::hash("default-tenant");
         config.user_id = BLAKE3Pipeline::hash("default-user");
+        if (const char* v = std::getenv("HARTONOMOUS_KNN_BACKEND")) {
+            if (std::string(v) == "gemm") config.knn_backend = KnnBackend::BlockedGEMM;
+            else if (std::string(v) == "device") config.knn_backend = KnnBackend::Device;
+        }
+        if (const char* v = std::getenv("HARTONOMOUS_HNSW_QUANT")) {
+            std::string q(v);
+            auto quant = q == "int8" ? HnswQuantization::Int8
+                       : q == "fp16" ? HnswQuantization::FP16 : HnswQuantization::Float32;
+            for (auto* p : {&config.hnsw_embedding, &config.hnsw_self_sim, &config.hnsw_asymmetric})
+                p->quantization = quant;
+        }
+        if (const char* v = std::getenv("HARTONOMOUS_INGEST_MEMORY_GB"))
+            config.memory_budget_bytes = static_cast<size_t>(std::max(0.0, std::strtod(v, nullptr)) * (1ULL << 30));
 
         ModelIngester ingester(db, config);
+        ProgressReporter progress;
+        progress.set_callback([](const IngestProgress& p) { std::cout << "  " << describe(p) << std::endl; },
+                              std::chrono::seconds(10));
+        ingester.set_progress(&progress);
 
         Timer timer;
         auto stats = ingester.ingest_package(model_dir);
         double seconds = timer.elapsed_sec();
+        bulk.finish();
 
         std::cout << "\n✓ Model ingestion complete!\n";
         std::cout << "  Duration:          " << std::fixed << std::setprecision(2) << seconds << "s\n";
@@ -5,13 +5,25 @@
 //   - Adjacency relations capture word order (grammar patterns)
 //   - Translation links create cross-lingual word co-occurrence relations
 //   - CJK characters tokenized individually (they ARE semantic units)
-
+// Resumable: byte offsets of flushed sentence and link chunks are checkpointed
+// (stream_checkpoint.hpp). Sentences are always decomposed, since Phase 2
+// needs every sentence's words, but committed chunks are not re-sent; links
+// seek past their committed offset.
+// HARTONOMOUS_ADJACENCY_MIN=N (N > 1): a word-order relation is emitted only
+// once a Count-Min sketch has seen its pair N times, so the singletons of the
+// corpus cost neither geometry nor rows.
+
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <storage/atom_lookup.hpp>
 #include <storage/content_store.hpp>
 #include <ingestion/substrate_service.hpp>
 #include <ingestion/substrate_cache.hpp>
 #include <ingestion/async_flusher.hpp>
+#include <ingestion/count_min_sketch.hpp>
+#include <ingestion/ingest_pipeline.hpp>
+#include <ingestion/stream_checkpoint.hpp>
+#include <utils/ingest_report.hpp>
 #include <utils/time.hpp>
 #include <utils/unicode.hpp>
 
@@ -28,16 +40,25 @@
 #include <cstring>
 #include <omp.h>
 #include <atomic>
+#include <memory>
+#include <utility>
 
 namespace Hartonomous {
 
 using Service = SubstrateService;
 
+// Progress total for a phase; 0 (no ETA) if the size is unknown
+static uint64_t file_bytes(const std::string& path) {
+    std::error_code ec;
+    auto n = std::filesystem::file_size(path, ec);
+    return ec ? 0 : n;
+}
+
 // ─────────────────────────────────────────────
 // Global Caches
 // ─────────────────────────────────────────────
 
-SubstrateCache g_cache;
+ConcurrentSubstrateCache g_cache;
 
 struct EvidenceKey {
     BLAKE3Pipeline::Hash content_id;
@@ -52,7 +73,7 @@ struct EvidenceKeyHasher {
     }
 };
 
-std::unordered_set<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
+ShardedSet<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
 
 // Per-sentence: store the word compositions for translation link processing
 struct SentenceWords {
@@ -62,44 +83,57 @@ std::unordered_map<uint32_t, SentenceWords> g_id_to_words;
 
 std::atomic<size_t> g_comp_count{0};
 std::atomic<size_t> g_rel_count{0};
+std::atomic<size_t> g_adjacency_held{0};
+
+// Adjacency gate (HARTONOMOUS_ADJACENCY_MIN); null: every adjacency is related
+std::unique_ptr<CountMinSketch> g_adjacency_sketch;
+uint32_t g_adjacency_min = 1;
 
 // ─────────────────────────────────────────────
-// Merge Helper
+// Merge Helper (thread-safe: dedup is claimed atomically in g_cache,
+// records land in the caller's thread-local batch)
 // ─────────────────────────────────────────────
 
 void merge_comp(const Service::ComputedComp& cc, SubstrateBatch& batch) {
     if (!cc.valid) return;
-    if (!g_cache.exists_comp(cc.comp.id)) {
-        if (!g_cache.exists_phys(cc.comp.physicality_id)) {
+    if (g_cache.insert_comp_if_absent(cc.comp.id)) {
+        if (g_cache.insert_phys_if_absent(cc.comp.physicality_id))
             batch.phys.push_back(cc.phys);
-            g_cache.add_phys(cc.comp.physicality_id);
-        }
         batch.comp.push_back(cc.comp);
         batch.seq.insert(batch.seq.end(), cc.seq.begin(), cc.seq.end());
-        g_cache.add_comp(cc.comp.id);
         g_comp_count++;
     }
 }
 
-void merge_relation(const Service::ComputedRelation& cr, const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch) {
+// Geometry is computed only for the thread that claims the relation
+void merge_relation(const Service::CachedComp& a, const Service::CachedComp& b, double base_rating,
+                    const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch, bool gated = false) {
+    auto cr = Service::identify_relation(a, b, content_id, base_rating);
     if (!cr.valid) return;
-    if (!g_cache.exists_rel(cr.rel.id)) {
-        if (!g_cache.exists_phys(cr.rel.physicality_id)) {
-            batch.phys.push_back(cr.phys);
-            g_cache.add_phys(cr.rel.physicality_id);
+    if (gated && g_adjacency_sketch) {
+        uint64_t key;
+        std::memcpy(&key, cr.rel.id.data(), sizeof(key));
+        const uint32_t seen = g_adjacency_sketch->add_shared(key);
+        if (seen < g_adjacency_min) {
+            g_adjacency_held++;
+            return;
         }
+        // The occurrences held back until now count toward the first rating
+        if (seen == g_adjacency_min) cr.rating.observations = seen;
+    }
+    if (g_cache.insert_rel_if_absent(cr.rel.id)) {
+        Service::add_relation_geometry(a, b, cr);
+        if (g_cache.insert_phys_if_absent(cr.rel.physicality_id))
+            batch.phys.push_back(cr.phys);
         batch.rel.push_back(cr.rel);
         batch.rel_seq.insert(batch.rel_seq.end(), cr.seq.begin(), cr.seq.end());
-        g_cache.add_rel(cr.rel.id);
         g_rel_count++;
     }
     // Always push rating — accumulates observations for repeated word pairs
     batch.rating.push_back(cr.rating);
     EvidenceKey ev_key{content_id, cr.rel.id};
-    if (g_evidence_cache.find(ev_key) == g_evidence_cache.end()) {
+    if (g_evidence_cache.insert_if_absent(ev_key))
         batch.evidence.push_back(cr.evidence);
-        g_evidence_cache.insert(ev_key);
-    }
 }
 
 } // namespace Hartonomous
@@ -107,6 +141,7 @@ void merge_relation(const Service::ComputedRelation& cr, const BLAKE3Pipeline::H
 int main(int argc, char** argv) {
     if (argc < 3) { std::cerr << "Usage: " << argv[0] << " <sentences.csv> <links.csv>" << std::endl; return 1; }
     using namespace Hartonomous;
+    IngestReport::global().start(argc, argv);
     std::string sentences_file = argv[1], links_file = argv[2];
     Timer total_timer;
 
@@ -115,6 +150,7 @@ int main(int argc, char** argv) {
         db.execute("SET synchronous_commit = off");
         db.execute("SET work_mem = '512MB'");
         db.execute("SET maintenance_work_mem = '2GB'");
+        BulkLoadSession bulk(db);
 
         AtomLookup lookup(db);
         std::cout << "[Phase 0] Preloading atoms..." << std::flush;
@@ -122,6 +158,14 @@ int main(int argc, char** argv) {
         std::cout << " (" << t0.elapsed_ms() << "ms)" << std::endl;
 
         g_cache.pre_populate(db);
+        IngestReport::global().phase("preload", t0.elapsed_ms());
+
+        if (const char* v = std::getenv("HARTONOMOUS_ADJACENCY_MIN"); v && std::strtol(v, nullptr, 10) > 1) {
+            g_adjacency_min = static_cast<uint32_t>(std::strtol(v, nullptr, 10));
+            g_adjacency_sketch = std::make_unique<CountMinSketch>(24);
+            std::cout << "  Adjacency gate: pairs seen " << g_adjacency_min << "+ times ("
+                      << (g_adjacency_sketch->memory_bytes() >> 20) << " MB sketch)" << std::endl;
+        }
 
         BLAKE3Pipeline::Hash tatoeba_content_id = BLAKE3Pipeline::hash("source:tatoeba");
         {
@@ -131,141 +175,235 @@ int main(int argc, char** argv) {
         }
 
         AsyncFlusher flusher;
+        StreamCheckpoint checkpoint;
+        checkpoint.open(StreamCheckpoint::Options::from_env(), "tatoeba", {sentences_file, links_file});
+        const uint64_t sentences_done = checkpoint.position("sentences");
+        const uint64_t links_done = checkpoint.position("links");
+        ProgressReporter progress;
+        progress.set_callback([](const IngestProgress& p) { std::cout << "  " << describe(p) << std::endl; },
+                              std::chrono::seconds(10));
+
+        // The decompose/relate stages get every core; reading and collecting are single-threaded
+        const size_t workers = std::max(1, omp_get_max_threads());
 
         // Phase 1: Decompose sentences into word-level compositions + adjacency relations
-        std::cout << "[Phase 1] Decomposing Tatoeba sentences (word-level, parallel)..." << std::endl;
-        std::ifstream sin(sentences_file); std::string line;
-        static constexpr size_t CHUNK_SIZE = 200000;
+        // read → decompose (parallel) → collect (word map, flusher) overlap via bounded queues.
+        std::cout << "[Phase 1] Decomposing Tatoeba sentences (word-level, pipelined)..." << std::endl;
+        Timer t1;
+        static constexpr size_t SENTENCE_CHUNK = 4096;
+        static constexpr size_t LINK_CHUNK = 16384;
         g_id_to_words.reserve(14000000);
 
         struct SentenceEntry { uint32_t sid; std::string text; };
-        std::vector<SentenceEntry> chunk;
-        chunk.reserve(CHUNK_SIZE);
+        struct SentenceChunk {
+            std::vector<SentenceEntry> entries;
+            uint64_t begin = 0, end = 0;   // Byte range of the file it was read from
+        };
+        struct DecomposedChunk {
+            std::unique_ptr<SubstrateBatch> batch;
+            std::vector<std::pair<uint32_t, SentenceWords>> words;
+            size_t sentences = 0;
+            uint64_t begin = 0, end = 0;
+        };
         size_t total_sentences = 0;
-
-        auto process_chunk = [&]() {
-            // Parallel: decompose each sentence into words
-            std::vector<Service::SentenceDecomposition> decomps(chunk.size());
-            #pragma omp parallel for schedule(dynamic, 64)
-            for (size_t i = 0; i < chunk.size(); ++i)
-                decomps[i] = Service::decompose_sentence(chunk[i].text, lookup);
-
-            // Serial: merge word compositions + adjacency relations
-            auto batch = std::make_unique<SubstrateBatch>();
-            for (size_t i = 0; i < chunk.size(); ++i) {
-                auto& d = decomps[i];
-
-                // Store word CachedComps for Phase 2 translation links
-                SentenceWords sw;
-                for (const auto& wc : d.word_comps) {
-                    merge_comp(wc, *batch);
-                    if (wc.valid) sw.words.push_back(wc.cache_entry);
+        {
+            IngestPipeline pipeline;
+            auto& raw = pipeline.make_queue<SentenceChunk>("raw", workers * 4);
+            auto& decomposed = pipeline.make_queue<DecomposedChunk>("decomposed", workers * 2);
+
+            progress.phase("sentences", file_bytes(sentences_file));
+            pipeline.add_source("read", raw, [&](Emitter<SentenceChunk>& emit) {
+                std::ifstream sin(sentences_file); std::string line;
+                SentenceChunk chunk;
+                chunk.entries.reserve(SENTENCE_CHUNK);
+                while (std::getline(sin, line)) {
+                    chunk.end += line.size() + 1;
+                    if (line.empty()) continue;
+                    const char* p = line.c_str();
+                    char* end;
+                    uint32_t sid = static_cast<uint32_t>(std::strtoul(p, &end, 10));
+                    if (*end != '\t') continue;
+                    const char* t2 = std::strchr(end + 1, '\t');
+                    if (!t2) continue;
+                    chunk.entries.push_back({sid, std::string(t2 + 1)});
+
+                    if (chunk.entries.size() >= SENTENCE_CHUNK) {
+                        const uint64_t next = chunk.end;
+                        progress.advance(chunk.end - chunk.begin);
+                        if (!emit(std::move(chunk))) return;
+                        chunk = {};
+                        chunk.begin = chunk.end = next;
+                        chunk.entries.reserve(SENTENCE_CHUNK);
+                    }
                 }
-                if (!sw.words.empty()) g_id_to_words[chunk[i].sid] = std::move(sw);
-
-                // Adjacency relations (word order patterns, ELO 1500)
-                for (const auto& [ai, bi] : d.adjacency) {
-                    merge_relation(Service::compute_relation(
-                        d.word_comps[ai].cache_entry,
-                        d.word_comps[bi].cache_entry,
-                        tatoeba_content_id, 1500.0), tatoeba_content_id, *batch);
+                progress.advance(chunk.end - chunk.begin);
+                if (!chunk.entries.empty()) emit(std::move(chunk));
+            });
+
+            // Decompose each sentence into words and dedup in place; g_cache claims IDs atomically
+            pipeline.add_stage("decompose", workers, raw, decomposed,
+                [&](SentenceChunk& chunk, Emitter<DecomposedChunk>& emit) {
+                    DecomposedChunk out;
+                    out.batch = std::make_unique<SubstrateBatch>();
+                    out.sentences = chunk.entries.size();
+                    out.begin = chunk.begin;
+                    out.end = chunk.end;
+                    for (const auto& entry : chunk.entries) {
+                        auto d = Service::decompose_sentence(entry.text, lookup);
+
+                        // Store word CachedComps for Phase 2 translation links
+                        SentenceWords sw;
+                        for (const auto& wc : d.word_comps) {
+                            merge_comp(wc, *out.batch);
+                            if (wc.valid) sw.words.push_back(wc.cache_entry);
+                        }
+                        if (!sw.words.empty()) out.words.emplace_back(entry.sid, std::move(sw));
+
+                        // Adjacency relations (word order patterns, ELO 1500)
+                        for (const auto& [ai, bi] : d.adjacency) {
+                            merge_relation(d.word_comps[ai].cache_entry, d.word_comps[bi].cache_entry, 1500.0,
+                                           tatoeba_content_id, *out.batch, true);
+                        }
+                    }
+                    emit(std::move(out));
+                });
+
+            // Single consumer owns g_id_to_words, so the map needs no locking.
+            // Chunks a previous run committed only contribute their words.
+            size_t next_report = 500000;
+            pipeline.add_sink("collect", 1, decomposed, [&](DecomposedChunk& chunk) {
+                for (auto& [sid, sw] : chunk.words) g_id_to_words[sid] = std::move(sw);
+                if (chunk.end > sentences_done) {
+                    uint64_t last_batch = 0;
+                    if (chunk.batch && !chunk.batch->empty()) {
+                        progress.advance(0, chunk.batch->record_count());
+                        last_batch = flusher.enqueue(std::move(chunk.batch));
+                    }
+                    checkpoint.covered("sentences", chunk.begin, chunk.end, last_batch);
+                    if (flusher.failed_batches() == 0) checkpoint.flushed(flusher.flushed_through());
                 }
-            }
-            flusher.enqueue(std::move(batch));
-            total_sentences += chunk.size();
-            if (total_sentences % 500000 == 0)
-                std::cout << "  Processed " << total_sentences << " sentences (" << g_comp_count << " comps, " << g_rel_count << " rels)" << std::endl;
-            chunk.clear();
-        };
+                total_sentences += chunk.sentences;
+                if (total_sentences >= next_report) {
+                    std::cout << "  Processed " << total_sentences << " sentences (" << g_comp_count << " comps, " << g_rel_count << " rels)" << std::endl;
+                    next_report += 500000;
+                }
+            });
 
-        while (std::getline(sin, line)) {
-            if (line.empty()) continue;
-            const char* p = line.c_str();
-            char* end;
-            uint32_t sid = static_cast<uint32_t>(std::strtoul(p, &end, 10));
-            if (*end != '\t') continue;
-            const char* t2 = std::strchr(end + 1, '\t');
-            if (!t2) continue;
-            chunk.push_back({sid, std::string(t2 + 1)});
-
-            if (chunk.size() >= CHUNK_SIZE) process_chunk();
+            pipeline.run();
         }
-        if (!chunk.empty()) process_chunk();
         flusher.wait_all();
+        if (flusher.failed_batches() == 0) checkpoint.flushed(flusher.flushed_through());
+        IngestReport::global().phase("sentences", t1.elapsed_ms());
         std::cout << "  Phase 1 complete: " << total_sentences << " sentences → "
                   << g_comp_count << " compositions, " << g_rel_count << " relations" << std::endl;
+        if (g_adjacency_sketch)
+            std::cout << "  " << g_adjacency_held << " adjacencies held below " << g_adjacency_min << " occurrences" << std::endl;
 
         // Phase 2: Translation links → cross-lingual word relations
         // For each translation pair, create relations between overlapping word compositions.
         // Uses "representative words" approach: relate first content word of each sentence.
-        std::cout << "[Phase 2] Processing Tatoeba translation links..." << std::endl;
-        std::ifstream lin(links_file);
-        std::vector<std::pair<uint32_t, uint32_t>> link_chunk;
-        link_chunk.reserve(CHUNK_SIZE);
-        size_t total_links = 0, valid_links = 0;
-
-        auto process_links = [&]() {
-            // Parallel: compute relations between representative words of each pair
-            struct LinkResult { Service::ComputedRelation rel; bool valid = false; };
-            std::vector<LinkResult> results(link_chunk.size());
-
-            #pragma omp parallel for schedule(dynamic, 256)
-            for (size_t i = 0; i < link_chunk.size(); ++i) {
-                auto it1 = g_id_to_words.find(link_chunk[i].first);
-                auto it2 = g_id_to_words.find(link_chunk[i].second);
-                if (it1 == g_id_to_words.end() || it2 == g_id_to_words.end()) continue;
-                if (it1->second.words.empty() || it2->second.words.empty()) continue;
-
-                // Create cross-lingual relations between each word pair up to a budget
-                // This captures the translation signal at word level
-                const auto& w1 = it1->second.words;
-                const auto& w2 = it2->second.words;
-                size_t budget = std::min(size_t(4), std::min(w1.size(), w2.size()));
-                // Just mark the first pair for the parallel result; rest done in serial
-                results[i].rel = Service::compute_relation(w1[0], w2[0], tatoeba_content_id, 1400.0);
-                results[i].valid = true;
-            }
-
-            auto batch = std::make_unique<SubstrateBatch>();
-            for (size_t i = 0; i < link_chunk.size(); ++i) {
-                if (!results[i].valid) continue;
-                merge_relation(results[i].rel, tatoeba_content_id, *batch);
-
-                // Additional cross-lingual word pairs (serial, small budget)
-                auto it1 = g_id_to_words.find(link_chunk[i].first);
-                auto it2 = g_id_to_words.find(link_chunk[i].second);
-                if (it1 == g_id_to_words.end() || it2 == g_id_to_words.end()) continue;
-                const auto& w1 = it1->second.words;
-                const auto& w2 = it2->second.words;
-                size_t budget = std::min(size_t(4), std::min(w1.size(), w2.size()));
-                for (size_t j = 1; j < budget; ++j) {
-                    merge_relation(Service::compute_relation(w1[j], w2[j], tatoeba_content_id, 1300.0),
-                                   tatoeba_content_id, *batch);
+        // g_id_to_words is read-only during this phase.
+        std::cout << "[Phase 2] Processing Tatoeba translation links (pipelined)..." << std::endl;
+        std::atomic<size_t> total_links{0}, valid_links{0};
+        Timer t2;
+        {
+            struct LinkChunk {
+                std::vector<std::pair<uint32_t, uint32_t>> pairs;
+                uint64_t begin = 0, end = 0;
+            };
+            struct LinkBatch {
+                std::unique_ptr<SubstrateBatch> batch;
+                uint64_t begin = 0, end = 0;
+            };
+            IngestPipeline pipeline;
+            auto& links = pipeline.make_queue<LinkChunk>("links", workers * 4);
+            auto& batches = pipeline.make_queue<LinkBatch>("batches", workers * 2);
+
+            const uint64_t links_bytes = file_bytes(links_file);
+            progress.phase("links", links_bytes > links_done ? links_bytes - links_done : 0);
+            if (links_done) std::cout << "  Skipping " << (links_done >> 20) << " MB of links already ingested" << std::endl;
+            pipeline.add_source("read", links, [&](Emitter<LinkChunk>& emit) {
+                std::ifstream lin(links_file); std::string line;
+                if (links_done) lin.seekg(static_cast<std::streamoff>(links_done));
+                LinkChunk chunk;
+                chunk.begin = chunk.end = links_done;
+                chunk.pairs.reserve(LINK_CHUNK);
+                while (std::getline(lin, line)) {
+                    chunk.end += line.size() + 1;
+                    if (line.empty()) continue;
+                    const char* p = line.c_str();
+                    char* end;
+                    uint32_t id1 = static_cast<uint32_t>(std::strtoul(p, &end, 10));
+                    if (*end != '\t') continue;
+                    uint32_t id2 = static_cast<uint32_t>(std::strtoul(end + 1, &end, 10));
+                    chunk.pairs.emplace_back(id1, id2);
+
+                    if (chunk.pairs.size() >= LINK_CHUNK) {
+                        const uint64_t next = chunk.end;
+                        progress.advance(chunk.end - chunk.begin);
+                        if (!emit(std::move(chunk))) return;
+                        chunk = {};
+                        chunk.begin = chunk.end = next;
+                        chunk.pairs.reserve(LINK_CHUNK);
+                    }
                 }
-                valid_links++;
-            }
-            flusher.enqueue(std::move(batch));
-            total_links += link_chunk.size();
-            if (total_links % 2000000 == 0)
-                std::cout << "  Processed " << total_links << " links (" << valid_links << " valid)" << std::endl;
-            link_chunk.clear();
-        };
-
-        while (std::getline(lin, line)) {
-            if (line.empty()) continue;
-            const char* p = line.c_str();
-            char* end;
-            uint32_t id1 = static_cast<uint32_t>(std::strtoul(p, &end, 10));
-            if (*end != '\t') continue;
-            uint32_t id2 = static_cast<uint32_t>(std::strtoul(end + 1, &end, 10));
-            link_chunk.emplace_back(id1, id2);
-
-            if (link_chunk.size() >= CHUNK_SIZE) process_links();
+                progress.advance(chunk.end - chunk.begin);
+                if (!chunk.pairs.empty()) emit(std::move(chunk));
+            });
+
+            pipeline.add_stage("relate", workers, links, batches,
+                [&](LinkChunk& chunk, Emitter<LinkBatch>& emit) {
+                    auto batch = std::make_unique<SubstrateBatch>();
+                    size_t local_valid = 0;
+                    for (const auto& [id1, id2] : chunk.pairs) {
+                        auto it1 = g_id_to_words.find(id1);
+                        auto it2 = g_id_to_words.find(id2);
+                        if (it1 == g_id_to_words.end() || it2 == g_id_to_words.end()) continue;
+                        if (it1->second.words.empty() || it2->second.words.empty()) continue;
+
+                        // Create cross-lingual relations between each word pair up to a budget
+                        // This captures the translation signal at word level
+                        const auto& w1 = it1->second.words;
+                        const auto& w2 = it2->second.words;
+                        size_t budget = std::min(size_t(4), std::min(w1.size(), w2.size()));
+                        merge_relation(w1[0], w2[0], 1400.0, tatoeba_content_id, *batch);
+                        for (size_t j = 1; j < budget; ++j) {
+                            merge_relation(w1[j], w2[j], 1300.0, tatoeba_content_id, *batch);
+                        }
+                        local_valid++;
+                    }
+                    valid_links += local_valid;
+                    size_t before = total_links.fetch_add(chunk.pairs.size());
+                    if ((before + chunk.pairs.size()) / 2000000 != before / 2000000)
+                        std::cout << "  Processed " << before + chunk.pairs.size() << " links (" << valid_links << " valid)" << std::endl;
+                    emit({std::move(batch), chunk.begin, chunk.end});
+                });
+
+            // add_flush_stage, plus the checkpoint of each chunk's byte range
+            pipeline.add_sink("flush", 1, batches, [&](LinkBatch& lb) {
+                uint64_t last_batch = 0;
+                if (lb.batch && !lb.batch->empty()) {
+                    progress.advance(0, lb.batch->record_count());
+                    last_batch = flusher.enqueue(std::move(lb.batch));
+                }
+                checkpoint.covered("links", lb.begin, lb.end, last_batch);
+                if (flusher.failed_batches() == 0) checkpoint.flushed(flusher.flushed_through());
+            });
+            pipeline.run();
         }
-        if (!link_chunk.empty()) process_links();
         flusher.wait_all();
+        IngestReport::global().phase("links", t2.elapsed_ms());
+        progress.finish();
         std::cout << "  Phase 2 complete: " << valid_links << " valid translation links → " << g_rel_count << " total relations" << std::endl;
 
+        // Only a fully flushed run leaves the cache equal to the substrate, and nothing to resume
+        if (flusher.failed_batches() == 0) {
+            g_cache.save_snapshot(db);
+            checkpoint.clear();
+        }
+
+        bulk.finish();
+        flusher.print_metrics(std::cout);
         std::cout << "[SUCCESS] Tatoeba complete in " << total_timer.elapsed_sec() << "s" << std::endl;
         std::cout << "  Total compositions: " << g_comp_count << " | Total relations: " << g_rel_count << std::endl;
 
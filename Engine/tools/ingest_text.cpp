@@ -1,9 +1,20 @@
+/**
+ * @file ingest_text.cpp
+ * @brief CLI tool to ingest a text or a file
+ *
+ * HARTONOMOUS_ADJACENCY_MIN=N (N > 1) keeps only adjacent pairs seen N times,
+ * filtered through a Count-Min sketch (IngestionConfig::sketch_adjacency).
+ */
+
 #include <ingestion/text_ingester.hpp>
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <hashing/blake3_pipeline.hpp>
 #include <ingestion/async_flusher.hpp>
 #include <ingestion/substrate_cache.hpp>
+#include <utils/ingest_report.hpp>
 #include <utils/time.hpp>
+#include <cstdlib>
 #include <iostream>
 
 using namespace Hartonomous;
@@ -13,10 +24,12 @@ int main(int argc, char** argv) {
         std::cerr << "Usage: " << argv[0] << " <text|file> [path]\n";
         return 1;
     }
+    IngestReport::global().start(argc, argv);
 
     try {
         PostgresConnection db;
         if (!db.is_connected()) return 1;
+        BulkLoadSession bulk(db);
 
         SubstrateCache cache;
         cache.pre_populate(db);
@@ -24,8 +37,19 @@ int main(int argc, char** argv) {
         IngestionConfig config;
         config.tenant_id = BLAKE3Pipeline::hash("default-tenant");
         config.user_id = BLAKE3Pipeline::hash("default-user");
+        if (const char* v = std::getenv("HARTONOMOUS_ADJACENCY_MIN")) {
+            const long n = std::strtol(v, nullptr, 10);
+            if (n > 1) {
+                config.min_cooccurrence = static_cast<uint32_t>(n);
+                config.sketch_adjacency = true;
+            }
+        }
 
         TextIngester ingester(db, config);
+        ProgressReporter progress;
+        progress.set_callback([](const IngestProgress& p) { std::cout << "  " << describe(p) << std::endl; },
+                              std::chrono::seconds(10));
+        ingester.set_progress(&progress);
         Timer timer;
 
         IngestionStats stats;
@@ -34,6 +58,7 @@ int main(int argc, char** argv) {
         } else {
             stats = ingester.ingest(argv[1]);
         }
+        bulk.finish();
 
         std::cout << "\n✓ Ingestion complete in " << timer.elapsed_sec() << "s\n";
         return 0;
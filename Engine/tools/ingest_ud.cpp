@@ -4,28 +4,42 @@
 //   - Each lemma becomes a word-level composition
 //   - Dependency relations capture syntactic structure (head→dependent, ELO 1800)
 //   - Adjacency relations capture word order (consecutive tokens, ELO 1500)
+//
+// Every .conllu file is mmapped and cut at blank-line sentence boundaries
+// into CHUNK_BYTES chunks; chunks of several treebanks are parsed and merged
+// on all cores at once, largest file first, with dedup claimed atomically in
+// one shared cache.
 
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <storage/atom_lookup.hpp>
 #include <storage/content_store.hpp>
 #include <ingestion/substrate_service.hpp>
 #include <ingestion/substrate_cache.hpp>
 #include <ingestion/async_flusher.hpp>
+#include <ingestion/ingest_pipeline.hpp>
 #include <utils/time.hpp>
 #include <utils/unicode.hpp>
 
 #include <iostream>
 #include <iomanip>
-#include <fstream>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 #include <filesystem>
 #include <algorithm>
+#include <charconv>
+#include <functional>
+#include <cstring>
 #include <omp.h>
 #include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Hartonomous {
 
@@ -35,7 +49,7 @@ using Service = SubstrateService;
 // Global Caches
 // ─────────────────────────────────────────────
 
-SubstrateCache g_cache;
+ConcurrentSubstrateCache g_cache;
 
 struct EvidenceKey {
     BLAKE3Pipeline::Hash content_id;
@@ -50,68 +64,146 @@ struct EvidenceKeyHasher {
     }
 };
 
-std::unordered_set<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
+ShardedSet<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
 
 std::atomic<size_t> g_comp_count{0};
 std::atomic<size_t> g_rel_count{0};
 
 // ─────────────────────────────────────────────
-// Merge Helper
+// Merge Helper (thread-safe: dedup is claimed atomically in g_cache,
+// records land in the caller's chunk batch)
 // ─────────────────────────────────────────────
 
 void merge_comp(const Service::ComputedComp& cc, SubstrateBatch& batch) {
     if (!cc.valid) return;
-    if (!g_cache.exists_comp(cc.comp.id)) {
-        if (!g_cache.exists_phys(cc.comp.physicality_id)) {
+    if (g_cache.insert_comp_if_absent(cc.comp.id)) {
+        if (g_cache.insert_phys_if_absent(cc.comp.physicality_id))
             batch.phys.push_back(cc.phys);
-            g_cache.add_phys(cc.comp.physicality_id);
-        }
         batch.comp.push_back(cc.comp);
         batch.seq.insert(batch.seq.end(), cc.seq.begin(), cc.seq.end());
-        g_cache.add_comp(cc.comp.id);
         g_comp_count++;
     }
 }
 
-void merge_relation(const Service::ComputedRelation& cr, const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch) {
+// Geometry is computed only for the thread that claims the relation
+void merge_relation(const Service::CachedComp& a, const Service::CachedComp& b, double base_rating,
+                    const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch) {
+    auto cr = Service::identify_relation(a, b, content_id, base_rating);
     if (!cr.valid) return;
-    if (!g_cache.exists_rel(cr.rel.id)) {
-        if (!g_cache.exists_phys(cr.rel.physicality_id)) {
+    if (g_cache.insert_rel_if_absent(cr.rel.id)) {
+        Service::add_relation_geometry(a, b, cr);
+        if (g_cache.insert_phys_if_absent(cr.rel.physicality_id))
             batch.phys.push_back(cr.phys);
-            g_cache.add_phys(cr.rel.physicality_id);
-        }
         batch.rel.push_back(cr.rel);
         batch.rel_seq.insert(batch.rel_seq.end(), cr.seq.begin(), cr.seq.end());
-        g_cache.add_rel(cr.rel.id);
         g_rel_count++;
     }
     // Always push rating — accumulates observations for repeated word pairs
     batch.rating.push_back(cr.rating);
-    EvidenceKey ev_key{content_id, cr.rel.id};
-    if (g_evidence_cache.find(ev_key) == g_evidence_cache.end()) {
+    if (g_evidence_cache.insert_if_absent(EvidenceKey{content_id, cr.rel.id}))
         batch.evidence.push_back(cr.evidence);
-        g_evidence_cache.insert(ev_key);
-    }
 }
 
 // ─────────────────────────────────────────────
 // Parser
 // ─────────────────────────────────────────────
 
-struct Token { uint32_t id; std::string lemma; uint32_t head; };
+// Read-only private mapping of one treebank file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Open failed: " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Stat failed: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to mmap: " + path);
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+    }
+    ~MappedFile() { if (data_) ::munmap(const_cast<char*>(data_), size_); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// A file stays mapped until its last chunk is merged
+struct Treebank {
+    std::unique_ptr<MappedFile> map;
+    std::atomic<size_t> chunks_left{0};
+};
+
+struct Chunk {
+    std::shared_ptr<Treebank> file;
+    size_t begin = 0, end = 0;
+};
+
+static constexpr size_t CHUNK_BYTES = 4u << 20;
+
+// Offset just past the first blank line at or after `from` (LF or CRLF), else `size`
+size_t next_sentence_break(const char* data, size_t from, size_t size) {
+    const char* p = data + from;
+    const char* end = data + size;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!nl) return size;
+        const char* line = nl + 1;
+        if (line < end && *line == '\n') return static_cast<size_t>(line + 1 - data);
+        if (line + 1 < end && line[0] == '\r' && line[1] == '\n') return static_cast<size_t>(line + 2 - data);
+        p = line;
+    }
+    return size;
+}
 
-void parse_conllu(const std::string& path, std::vector<std::vector<Token>>& sentences) {
-    std::ifstream in(path); if (!in) return;
-    std::string line; std::vector<Token> current;
-    while (std::getline(in, line)) {
-        if (line.empty()) { if (!current.empty()) { sentences.push_back(std::move(current)); current.clear(); } continue; }
+struct Token { uint32_t id; std::string_view lemma; uint32_t head; };
+
+// Sentences of [p, end) into `tokens`, `starts` marking where each begins.
+// Token lines are ten tab-separated fields; multiword ranges (1-2) and empty
+// nodes (1.1) are skipped.
+void parse_conllu(const char* p, const char* end, std::vector<Token>& tokens, std::vector<size_t>& starts) {
+    bool open = false;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* eol = nl ? nl : end;
+        std::string_view line(p, static_cast<size_t>(eol - p));
+        p = nl ? nl + 1 : end;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) { open = false; continue; }
         if (line[0] == '#') continue;
-        std::istringstream iss(line); std::string id_s, form, lemma, upos, xpos, feats, head_s, deprel, deps, misc;
-        if (!(iss >> id_s >> form >> lemma >> upos >> xpos >> feats >> head_s >> deprel >> deps >> misc)) continue;
-        if (id_s.find('.') != std::string::npos || id_s.find('-') != std::string::npos) continue;
-        try { uint32_t id = std::stoul(id_s), head = (head_s == "0") ? 0 : std::stoul(head_s); current.push_back({id, lemma, head}); } catch (...) { continue; }
+
+        std::string_view fields[10];
+        size_t n = 0;
+        for (size_t pos = 0; n < 10; ++n) {
+            size_t tab = line.find('\t', pos);
+            fields[n] = line.substr(pos, tab == std::string_view::npos ? std::string_view::npos : tab - pos);
+            if (tab == std::string_view::npos) { ++n; break; }
+            pos = tab + 1;
+        }
+        if (n < 10) continue;
+        uint32_t id = 0, head = 0;
+        const auto& id_s = fields[0];
+        if (std::from_chars(id_s.data(), id_s.data() + id_s.size(), id).ptr != id_s.data() + id_s.size()) continue;
+        const auto& head_s = fields[6];
+        if (std::from_chars(head_s.data(), head_s.data() + head_s.size(), head).ptr != head_s.data() + head_s.size()) continue;
+        if (!open) { starts.push_back(tokens.size()); open = true; }
+        tokens.push_back({id, fields[2], head});
     }
-    if (!current.empty()) sentences.push_back(std::move(current));
 }
 
 } // namespace Hartonomous
@@ -127,6 +219,7 @@ int main(int argc, char** argv) {
         db.execute("SET synchronous_commit = off");
         db.execute("SET work_mem = '512MB'");
         db.execute("SET maintenance_work_mem = '2GB'");
+        BulkLoadSession bulk(db);
 
         AtomLookup lookup(db); lookup.preload_all();
         g_cache.pre_populate(db);
@@ -139,65 +232,108 @@ int main(int argc, char** argv) {
         for (const auto& entry : std::filesystem::recursive_directory_iterator(ud_dir))
             if (entry.is_regular_file() && entry.path().extension() == ".conllu") files.push_back(entry.path().string());
 
-        std::cout << "[Phase 1] Processing " << files.size() << " CoNLL-U files (parallel)..." << std::endl;
-        size_t processed = 0; static constexpr size_t CHUNK_SIZE = 100;
-
-        for (size_t f_start = 0; f_start < files.size(); f_start += CHUNK_SIZE) {
-            size_t f_end = std::min(f_start + CHUNK_SIZE, files.size());
-            struct FileResult { std::vector<std::vector<Token>> sents; std::vector<std::vector<Service::ComputedComp>> c_comps; };
-            std::vector<FileResult> results(f_end - f_start);
-
-            #pragma omp parallel for schedule(dynamic)
-            for (size_t i = f_start; i < f_end; ++i) {
-                parse_conllu(files[i], results[i - f_start].sents);
-                for (const auto& sent : results[i - f_start].sents) {
-                    std::vector<Service::ComputedComp> sc;
-                    for (const auto& tok : sent)
-                        sc.push_back(Service::compute_comp(tok.lemma, lookup));
-                    results[i - f_start].c_comps.push_back(std::move(sc));
+        // Largest treebanks first, so the long tail is small files
+        std::vector<std::pair<uintmax_t, std::string>> by_size;
+        for (const auto& f : files) by_size.emplace_back(std::filesystem::file_size(f), f);
+        std::sort(by_size.begin(), by_size.end(), std::greater<>());
+
+        std::cout << "[Phase 1] Processing " << files.size() << " CoNLL-U files (mmapped, pipelined)..." << std::endl;
+        const size_t workers = std::max(1, omp_get_max_threads());
+
+        // files → chunks (map + cut) → parse (parallel: CoNLL-U, compute_comp, claim + merge) → flush
+        using BatchPtr = std::unique_ptr<SubstrateBatch>;
+        IngestPipeline pipeline;
+        auto& chunks = pipeline.make_queue<Chunk>("chunks", workers * 4);
+        auto& batches = pipeline.make_queue<BatchPtr>("batches", workers * 2);
+
+        pipeline.add_source("chunks", chunks, [&](Emitter<Chunk>& emit) {
+            for (const auto& [bytes, path] : by_size) {
+                auto file = std::make_shared<Treebank>();
+                try {
+                    file->map = std::make_unique<MappedFile>(path);
+                } catch (const std::exception& e) {
+                    std::cerr << "  [WARN] " << e.what() << std::endl;
+                    continue;
+                }
+                const size_t size = file->map->size();
+                std::vector<std::pair<size_t, size_t>> ranges;
+                for (size_t at = 0; at < size;) {
+                    size_t cut = at + CHUNK_BYTES >= size ? size : next_sentence_break(file->map->data(), at + CHUNK_BYTES, size);
+                    ranges.emplace_back(at, cut);
+                    at = cut;
                 }
+                if (ranges.empty()) continue;
+                file->chunks_left = ranges.size();
+                for (const auto& [b, e] : ranges)
+                    if (!emit(Chunk{file, b, e})) return;
             }
+        });
+
+        std::atomic<size_t> files_done{0};
+        pipeline.add_stage("parse", workers, chunks, batches, [&](Chunk& chunk, Emitter<BatchPtr>& emit) {
+            thread_local std::vector<Token> tokens;
+            thread_local std::vector<size_t> starts;
+            thread_local std::vector<Service::ComputedComp> c_comps;
+            thread_local Service::ComputeScratch scratch;
+            tokens.clear();
+            starts.clear();
+            const char* data = chunk.file->map->data();
+            parse_conllu(data + chunk.begin, data + chunk.end, tokens, starts);
+
+            if (c_comps.size() < tokens.size()) c_comps.resize(tokens.size());
+            for (size_t t = 0; t < tokens.size(); ++t)
+                Service::compute_comp(tokens[t].lemma, lookup, scratch, c_comps[t], false);
+            Service::encode_hilbert_indices(c_comps.data(), tokens.size());
 
             auto batch = std::make_unique<SubstrateBatch>();
-            for (size_t i = 0; i < results.size(); ++i) {
-                for (size_t si = 0; si < results[i].sents.size(); ++si) {
-                    const auto& sent = results[i].sents[si];
-                    const auto& c_comps = results[i].c_comps[si];
-
-                    // Merge word compositions + build token map for dependency relations
-                    std::unordered_map<uint32_t, Service::CachedComp> token_comps;
-                    for (size_t ti = 0; ti < sent.size(); ++ti) {
-                        merge_comp(c_comps[ti], *batch);
-                        if (c_comps[ti].valid)
-                            token_comps[sent[ti].id] = c_comps[ti].cache_entry;
-                    }
+            std::unordered_map<uint32_t, Service::CachedComp> token_comps;
+            starts.push_back(tokens.size());
+            for (size_t si = 0; si + 1 < starts.size(); ++si) {
+                const size_t first = starts[si], last = starts[si + 1];
+
+                // Merge word compositions + build token map for dependency relations
+                token_comps.clear();
+                for (size_t ti = first; ti < last; ++ti) {
+                    merge_comp(c_comps[ti], *batch);
+                    if (c_comps[ti].valid)
+                        token_comps[tokens[ti].id] = c_comps[ti].cache_entry;
+                }
 
-                    // Dependency relations (syntactic structure, ELO 1800)
-                    for (const auto& tok : sent) {
-                        if (tok.head != 0) {
-                            auto head_it = token_comps.find(tok.head), dep_it = token_comps.find(tok.id);
-                            if (head_it != token_comps.end() && dep_it != token_comps.end())
-                                merge_relation(Service::compute_relation(head_it->second, dep_it->second, ud_content_id, 1800.0), ud_content_id, *batch);
-                        }
+                // Dependency relations (syntactic structure, ELO 1800)
+                for (size_t ti = first; ti < last; ++ti) {
+                    const auto& tok = tokens[ti];
+                    if (tok.head != 0) {
+                        auto head_it = token_comps.find(tok.head), dep_it = token_comps.find(tok.id);
+                        if (head_it != token_comps.end() && dep_it != token_comps.end())
+                            merge_relation(head_it->second, dep_it->second, 1800.0, ud_content_id, *batch);
                     }
+                }
 
-                    // Adjacency relations (word order, ELO 1500)
-                    for (size_t ti = 0; ti + 1 < c_comps.size(); ++ti) {
-                        if (c_comps[ti].valid && c_comps[ti + 1].valid &&
-                            c_comps[ti].comp.id != c_comps[ti + 1].comp.id) {
-                            merge_relation(Service::compute_relation(
-                                c_comps[ti].cache_entry, c_comps[ti + 1].cache_entry,
-                                ud_content_id, 1500.0), ud_content_id, *batch);
-                        }
+                // Adjacency relations (word order, ELO 1500)
+                for (size_t ti = first; ti + 1 < last; ++ti) {
+                    if (c_comps[ti].valid && c_comps[ti + 1].valid &&
+                        c_comps[ti].comp.id != c_comps[ti + 1].comp.id) {
+                        merge_relation(c_comps[ti].cache_entry, c_comps[ti + 1].cache_entry,
+                                       1500.0, ud_content_id, *batch);
                     }
                 }
             }
-            flusher.enqueue(std::move(batch));
-            processed += (f_end - f_start);
-            if (processed % 500 == 0)
-                std::cout << "  Processed " << processed << " files (" << g_comp_count << " comps, " << g_rel_count << " rels)" << std::endl;
-        }
+            if (!batch->empty() || !batch->rating.empty()) emit(std::move(batch));
+
+            if (--chunk.file->chunks_left == 0) {
+                chunk.file->map.reset();
+                if (++files_done % 50 == 0)
+                    std::cout << "  Processed " << files_done << " files (" << g_comp_count << " comps, " << g_rel_count << " rels)" << std::endl;
+            }
+        });
+
+        add_flush_stage(pipeline, batches, flusher);
+        pipeline.run();
         flusher.wait_all();
+        // Only a fully flushed run leaves the cache equal to the substrate
+        if (flusher.failed_batches() == 0) g_cache.save_snapshot(db);
+        bulk.finish();
+        flusher.print_metrics(std::cout);
         std::cout << "[SUCCESS] UD complete in " << total_timer.elapsed_sec() << "s" << std::endl;
         std::cout << "  Total compositions: " << g_comp_count << " | Total relations: " << g_rel_count << std::endl;
     } catch (const std::exception& ex) { std::cerr << "[FATAL] " << ex.what() << std::endl; return 1; }
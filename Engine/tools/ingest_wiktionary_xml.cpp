@@ -6,13 +6,25 @@
 //   - Definitions are decomposed into word-level compositions with:
 //     - Each definition word relates to title word (ELO per relation type)
 //     - Adjacency relations between consecutive definition words (ELO 1500)
-
+// Resumable: the byte offset of the last flushed chunk of pages is checkpointed
+// (stream_checkpoint.hpp), and a restart seeks past it.
+//
+// Usage: ingest_wiktionary_xml [--stream] <xml>
+// The decompressed dump is mmapped and each window of it is cut at <page>
+// boundaries found with memchr, so page extraction runs on every core.
+// --stream reads line by line instead, for pipes:
+//   lbzip2 -dc enwiktionary-pages-articles.xml.bz2 | ingest_wiktionary_xml --stream /dev/stdin
+// (lbzip2 / pbzip2 decompress multistream dumps in parallel.)
+
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <storage/atom_lookup.hpp>
 #include <storage/content_store.hpp>
 #include <ingestion/substrate_service.hpp>
 #include <ingestion/substrate_cache.hpp>
 #include <ingestion/async_flusher.hpp>
+#include <ingestion/stream_checkpoint.hpp>
+#include <utils/ingest_report.hpp>
 #include <utils/time.hpp>
 #include <utils/unicode.hpp>
 
@@ -27,8 +39,14 @@
 #include <regex>
 #include <algorithm>
 #include <cstring>
+#include <filesystem>
 #include <omp.h>
 #include <atomic>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Hartonomous {
 
@@ -38,7 +56,7 @@ using Service = SubstrateService;
 // Global Caches
 // ─────────────────────────────────────────────
 
-SubstrateCache g_cache;
+ConcurrentSubstrateCache g_cache;
 
 struct EvidenceKey {
     BLAKE3Pipeline::Hash content_id;
@@ -53,48 +71,41 @@ struct EvidenceKeyHasher {
     }
 };
 
-std::unordered_set<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
+ShardedSet<EvidenceKey, EvidenceKeyHasher> g_evidence_cache;
 
 std::atomic<size_t> g_comp_count{0};
 std::atomic<size_t> g_rel_count{0};
 
 // ─────────────────────────────────────────────
-// Merge Helper
+// Merge Helper (thread-safe: dedup is claimed atomically in g_cache,
+// records land in the caller's thread-local batch)
 // ─────────────────────────────────────────────
 
 void merge_comp(const Service::ComputedComp& cc, SubstrateBatch& batch) {
     if (!cc.valid) return;
-    if (!g_cache.exists_comp(cc.comp.id)) {
-        if (!g_cache.exists_phys(cc.comp.physicality_id)) {
+    if (g_cache.insert_comp_if_absent(cc.comp.id)) {
+        if (g_cache.insert_phys_if_absent(cc.comp.physicality_id))
             batch.phys.push_back(cc.phys);
-            g_cache.add_phys(cc.comp.physicality_id);
-        }
         batch.comp.push_back(cc.comp);
         batch.seq.insert(batch.seq.end(), cc.seq.begin(), cc.seq.end());
-        g_cache.add_comp(cc.comp.id);
         g_comp_count++;
     }
 }
 
 void merge_relation(const Service::ComputedRelation& cr, const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch) {
     if (!cr.valid) return;
-    if (!g_cache.exists_rel(cr.rel.id)) {
-        if (!g_cache.exists_phys(cr.rel.physicality_id)) {
+    if (g_cache.insert_rel_if_absent(cr.rel.id)) {
+        if (g_cache.insert_phys_if_absent(cr.rel.physicality_id))
             batch.phys.push_back(cr.phys);
-            g_cache.add_phys(cr.rel.physicality_id);
-        }
         batch.rel.push_back(cr.rel);
         batch.rel_seq.insert(batch.rel_seq.end(), cr.seq.begin(), cr.seq.end());
-        g_cache.add_rel(cr.rel.id);
         g_rel_count++;
     }
     // Always push rating — accumulates observations for repeated word pairs
     batch.rating.push_back(cr.rating);
     EvidenceKey ev_key{content_id, cr.rel.id};
-    if (g_evidence_cache.find(ev_key) == g_evidence_cache.end()) {
+    if (g_evidence_cache.insert_if_absent(ev_key))
         batch.evidence.push_back(cr.evidence);
-        g_evidence_cache.insert(ev_key);
-    }
 }
 
 // ─────────────────────────────────────────────
@@ -219,6 +230,116 @@ ProcessedPage process_page_compute(const Page& page, AtomLookup& lookup) {
     return res;
 }
 
+// ─────────────────────────────────────────────
+// Parallel Page Extraction (mmap mode)
+// ─────────────────────────────────────────────
+
+// Read-only private mapping of the whole dump
+class MappedDump {
+public:
+    explicit MappedDump(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Open failed: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            throw std::runtime_error("Not a regular file (use --stream for pipes): " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to mmap: " + path);
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+    }
+    ~MappedDump() { if (data_) ::munmap(const_cast<char*>(data_), size_); }
+    MappedDump(const MappedDump&) = delete;
+    MappedDump& operator=(const MappedDump&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Consumed pages are clean and file-backed; drop them so a 10GB+ dump does not crowd the page cache
+    void release(size_t begin, size_t end) const {
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        begin &= ~(page - 1);
+        end &= ~(page - 1);
+        if (end > begin) ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// First `tag` in [p, end), else end. memchr (vectorized in glibc) skips to each candidate '<'
+static const char* find_tag(const char* p, const char* end, std::string_view tag) {
+    while (p < end) {
+        p = static_cast<const char*>(std::memchr(p, tag[0], static_cast<size_t>(end - p)));
+        if (!p) return end;
+        if (static_cast<size_t>(end - p) >= tag.size() && std::memcmp(p, tag.data(), tag.size()) == 0) return p;
+        ++p;
+    }
+    return end;
+}
+
+// One <page> element [b, e) into `out`; false for namespaces that are not ingested
+static bool parse_page(const char* b, const char* e, Page& out) {
+    const char* title = find_tag(b, e, "<title>");
+    if (title == e) return false;
+    title += 7;
+    const char* title_end = find_tag(title, e, "</title>");
+    const char* ns = find_tag(title_end, e, "<ns>");
+    int ns_id = ns == e ? -1 : static_cast<int>(std::strtol(ns + 4, nullptr, 10));
+    if (ns_id != 0 && ns_id != 14 && ns_id != 110) return false;
+
+    const char* text = find_tag(title_end, e, "<text");
+    if (text == e) return false;
+    const char* open_end = static_cast<const char*>(std::memchr(text, '>', static_cast<size_t>(e - text)));
+    if (!open_end) return false;
+    out.title.assign(title, title_end);
+    if (open_end[-1] == '/') {   // <text ... /> : empty revision
+        out.text.clear();
+    } else {
+        const char* body = open_end + 1;
+        out.text.assign(body, find_tag(body, e, "</text>"));
+    }
+    return true;
+}
+
+// Pages starting in [begin, window_end) of the dump, extracted on all threads.
+// Each thread owns the pages that start in its slice; a page may run past the
+// slice (or window) end. Returns the offset of the first page at or after window_end.
+static size_t parse_window(const MappedDump& dump, size_t begin, size_t window_end, std::vector<Page>& out) {
+    const char* base = dump.data();
+    const char* end = base + dump.size();
+    const int threads = std::max(1, omp_get_max_threads());
+    std::vector<std::vector<Page>> parts(threads);
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int t = 0; t < threads; ++t) {
+        const size_t slice_begin = begin + (window_end - begin) * t / threads;
+        const size_t slice_end = begin + (window_end - begin) * (t + 1) / threads;
+        const char* page = find_tag(base + slice_begin, end, "<page>");
+        while (page < base + slice_end) {
+            const char* close = find_tag(page + 6, end, "</page>");
+            Page p;
+            if (parse_page(page, close, p)) parts[t].push_back(std::move(p));
+            page = find_tag(close, end, "<page>");
+        }
+    }
+
+    for (auto& part : parts)
+        out.insert(out.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    return window_end >= dump.size() ? dump.size()
+                                     : static_cast<size_t>(find_tag(base + window_end, end, "<page>") - base);
+}
+
 void merge_page(const ProcessedPage& pr, const BLAKE3Pipeline::Hash& content_id, SubstrateBatch& batch) {
     if (!pr.title_comp.valid) return;
 
@@ -255,68 +376,121 @@ void merge_page(const ProcessedPage& pr, const BLAKE3Pipeline::Hash& content_id,
 } // namespace Hartonomous
 
 int main(int argc, char** argv) {
-    if (argc < 2) { std::cerr << "Usage: " << argv[0] << " <xml>" << std::endl; return 1; }
     using namespace Hartonomous;
-    std::string xml_path = argv[1]; Timer total_timer;
+    std::string xml_path;
+    bool stream = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stream") == 0) stream = true;
+        else xml_path = argv[i];
+    }
+    if (xml_path.empty()) { std::cerr << "Usage: " << argv[0] << " [--stream] <xml>" << std::endl; return 1; }
+    IngestReport::global().start(argc, argv);
+    Timer total_timer;
 
     try {
         PostgresConnection db;
         db.execute("SET synchronous_commit = off");
         db.execute("SET work_mem = '512MB'");
         db.execute("SET maintenance_work_mem = '2GB'");
+        BulkLoadSession bulk(db);
 
+        Timer t0;
         AtomLookup lookup(db); lookup.preload_all();
         g_cache.pre_populate(db);
+        IngestReport::global().phase("preload", t0.elapsed_ms());
 
         BLAKE3Pipeline::Hash content_id = BLAKE3Pipeline::hash("source:wiktionary");
         { ContentStore cs(db, false, false); cs.store({content_id, BLAKE3Pipeline::hash("t:sys"), BLAKE3Pipeline::hash("u:cur"), 5, BLAKE3Pipeline::hash("wkt-w"), 0, "text/xml", "en", "Wiktionary", "utf-8"}); cs.flush(); }
 
         AsyncFlusher flusher;
-        std::ifstream in(xml_path, std::ios::binary); if (!in) return 1;
-        std::string line, cur_title, cur_text; int cur_ns = -1; bool in_text = false;
         std::vector<Page> chunk;
         size_t page_count = 0; static constexpr size_t CHUNK_SIZE = 10000;
-
-        std::cout << "[Phase 1] Streaming Wiktionary (word-level decomposition, parallel)..." << std::endl;
-
-        auto flush_chunk = [&]() {
-            std::vector<ProcessedPage> results(chunk.size());
-            #pragma omp parallel for schedule(dynamic, 16)
-            for (size_t i = 0; i < chunk.size(); ++i)
-                results[i] = process_page_compute(chunk[i], lookup);
-
-            auto batch = std::make_unique<SubstrateBatch>();
-            for (size_t i = 0; i < chunk.size(); ++i)
-                merge_page(results[i], content_id, *batch);
-
-            flusher.enqueue(std::move(batch));
+        // About CHUNK_SIZE pages of a typical dump per mmap window
+        static constexpr size_t WINDOW_BYTES = 64ULL << 20;
+
+        // Chunks end between pages (after a </text> line, or at a <page>), so
+        // either reader can resume from the other's checkpoint. A pipe cannot seek, so it keeps none.
+        StreamCheckpoint checkpoint;
+        checkpoint.open(std::filesystem::is_regular_file(xml_path) ? StreamCheckpoint::Options::from_env()
+                                                                   : StreamCheckpoint::Options{},
+                        "wiktionary", {xml_path});
+        uint64_t chunk_begin = checkpoint.position("pages");
+        if (chunk_begin) std::cout << "  Skipping " << (chunk_begin >> 20) << " MB already ingested" << std::endl;
+
+        std::cout << "[Phase 1] " << (stream ? "Streaming" : "Mapping") << " Wiktionary "
+                  << "(word-level decomposition, parallel)..." << std::endl;
+        Timer t1;
+
+        auto flush_chunk = [&](uint64_t chunk_end) {
+            // Parallel compute + in-place dedup into per-thread batches
+            uint64_t last_batch = 0;
+            #pragma omp parallel
+            {
+                auto batch = std::make_unique<SubstrateBatch>();
+
+                #pragma omp for schedule(dynamic, 16) nowait
+                for (size_t i = 0; i < chunk.size(); ++i)
+                    merge_page(process_page_compute(chunk[i], lookup), content_id, *batch);
+
+                #pragma omp critical(wiktionary_enqueue)
+                {
+                    if (!batch->empty()) last_batch = std::max(last_batch, flusher.enqueue(std::move(batch)));
+                }
+            }
+            checkpoint.covered("pages", chunk_begin, chunk_end, last_batch);
+            if (flusher.failed_batches() == 0) checkpoint.flushed(flusher.flushed_through());
+            chunk_begin = chunk_end;
             page_count += chunk.size();
-            if (page_count % 50000 == 0)
+            if (page_count / 50000 != (page_count - chunk.size()) / 50000)
                 std::cout << "  Processed " << page_count << " pages (" << g_comp_count << " comps, " << g_rel_count << " rels)" << std::endl;
             chunk.clear();
         };
 
-        while (std::getline(in, line)) {
-            if (line.find("<title>") != std::string::npos) {
-                size_t s = line.find("<title>") + 7, e = line.find("</title>");
-                cur_title = line.substr(s, e - s); cur_text.clear(); cur_ns = -1;
-            } else if (line.find("<ns>") != std::string::npos) {
-                size_t s = line.find("<ns>") + 4, e = line.find("</ns>");
-                try { cur_ns = std::stoi(line.substr(s, e - s)); } catch (...) { cur_ns = -1; }
-            } else if (line.find("<text") != std::string::npos) {
-                if (cur_ns != 0 && cur_ns != 14 && cur_ns != 110) { in_text = false; continue; }
-                in_text = true; size_t s = line.find('>') + 1; cur_text = line.substr(s);
-                if (line.find("</text>") != std::string::npos) { in_text = false; cur_text.erase(cur_text.find("</text>")); chunk.push_back({cur_title, cur_text}); }
-            } else if (in_text) {
-                if (line.find("</text>") != std::string::npos) { in_text = false; cur_text += line.substr(0, line.find("</text>")); chunk.push_back({cur_title, cur_text}); }
-                else { cur_text += line + "\n"; }
+        if (!stream) {
+            MappedDump dump(xml_path);
+            size_t pos = std::min<size_t>(chunk_begin, dump.size());
+            while (pos < dump.size()) {
+                size_t next = parse_window(dump, pos, std::min(dump.size(), pos + WINDOW_BYTES), chunk);
+                flush_chunk(next);
+                dump.release(pos, next);
+                pos = next;
             }
+        } else {
+            std::ifstream in(xml_path, std::ios::binary); if (!in) return 1;
+            if (chunk_begin) in.seekg(static_cast<std::streamoff>(chunk_begin));
+            std::string line, cur_title, cur_text; int cur_ns = -1; bool in_text = false;
+            uint64_t consumed = chunk_begin;   // Pipes have no tellg()
+            while (std::getline(in, line)) {
+                consumed += line.size() + 1;
+                if (line.find("<title>") != std::string::npos) {
+                    size_t s = line.find("<title>") + 7, e = line.find("</title>");
+                    cur_title = line.substr(s, e - s); cur_text.clear(); cur_ns = -1;
+                } else if (line.find("<ns>") != std::string::npos) {
+                    size_t s = line.find("<ns>") + 4, e = line.find("</ns>");
+                    try { cur_ns = std::stoi(line.substr(s, e - s)); } catch (...) { cur_ns = -1; }
+                } else if (line.find("<text") != std::string::npos) {
+                    if (cur_ns != 0 && cur_ns != 14 && cur_ns != 110) { in_text = false; continue; }
+                    in_text = true; size_t s = line.find('>') + 1; cur_text = line.substr(s);
+                    if (line.find("</text>") != std::string::npos) { in_text = false; cur_text.erase(cur_text.find("</text>")); chunk.push_back({cur_title, cur_text}); }
+                } else if (in_text) {
+                    if (line.find("</text>") != std::string::npos) { in_text = false; cur_text += line.substr(0, line.find("</text>")); chunk.push_back({cur_title, cur_text}); }
+                    else { cur_text += line + "\n"; }
+                }
 
-            if (chunk.size() >= CHUNK_SIZE) flush_chunk();
+                if (chunk.size() >= CHUNK_SIZE) flush_chunk(consumed);
+            }
+            if (!chunk.empty()) flush_chunk(consumed);
         }
-        if (!chunk.empty()) flush_chunk();
 
         flusher.wait_all();
+        IngestReport::global().phase("pages", t1.elapsed_ms());
+        // Only a fully flushed run leaves the cache equal to the substrate, and nothing to resume
+        if (flusher.failed_batches() == 0) {
+            g_cache.save_snapshot(db);
+            checkpoint.clear();
+        }
+        bulk.finish();
+        flusher.print_metrics(std::cout);
         std::cout << "[SUCCESS] Wiktionary complete in " << total_timer.elapsed_sec() << "s" << std::endl;
         std::cout << "  Total compositions: " << g_comp_count << " | Total relations: " << g_rel_count << std::endl;
     } catch (const std::exception& ex) { std::cerr << "[FATAL] " << ex.what() << std::endl; return 1; }
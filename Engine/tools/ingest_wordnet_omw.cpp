@@ -5,13 +5,18 @@
 //   - Primary lemma serves as the synset hub
 //   - Glosses decomposed into word-level compositions with adjacency chains
 //   - All relations connect real words, not codes
+// Resumable: flushed chunks of each phase are checkpointed by record index
+// (stream_checkpoint.hpp). A restart re-parses the (small) inputs, recomputes
+// only the synset hubs of committed chunks and sends nothing for them.
 
+#include <database/bulk_load_session.hpp>
 #include <database/postgres_connection.hpp>
 #include <storage/atom_lookup.hpp>
 #include <storage/content_store.hpp>
 #include <ingestion/substrate_service.hpp>
 #include <ingestion/substrate_cache.hpp>
 #include <ingestion/async_flusher.hpp>
+#include <ingestion/stream_checkpoint.hpp>
 #include <utils/time.hpp>
 #include <utils/unicode.hpp>
 
@@ -158,6 +163,7 @@ int main(int argc, char** argv) {
         db.execute("SET synchronous_commit = off");
         db.execute("SET work_mem = '512MB'");
         db.execute("SET maintenance_work_mem = '2GB'");
+        BulkLoadSession bulk(db);
 
         AtomLookup lookup(db); lookup.preload_all();
         g_cache.pre_populate(db);
@@ -172,6 +178,13 @@ int main(int argc, char** argv) {
         }
 
         AsyncFlusher flusher;
+        StreamCheckpoint checkpoint;
+        checkpoint.open(StreamCheckpoint::Options::from_env(), "wordnet_omw", {wordnet_dir, omw_data_dir});
+        // Positions are indices into the parsed synsets / OMW entries, which parse deterministically
+        auto commit = [&](const char* cursor, size_t begin, size_t end, uint64_t last_batch) {
+            checkpoint.covered(cursor, begin, end, last_batch);
+            if (flusher.failed_batches() == 0) checkpoint.flushed(flusher.flushed_through());
+        };
 
         std::cout << "[Phase 1] Parsing WordNet..." << std::flush;
         Timer t1; std::vector<Synset> synsets;
@@ -186,9 +199,13 @@ int main(int argc, char** argv) {
         std::cout << "[Phase 2] Building WordNet compositions (word-level decomposition)..." << std::endl;
         static constexpr size_t CHUNK_SIZE = 25000;
         g_synset_to_primary.reserve(synsets.size());
+        const size_t synsets_done = checkpoint.position("synsets");
+        if (synsets_done) std::cout << "  Resuming: " << synsets_done << " synsets already ingested" << std::endl;
 
         for (size_t chunk_start = 0; chunk_start < synsets.size(); chunk_start += CHUNK_SIZE) {
             size_t chunk_end = std::min(chunk_start + CHUNK_SIZE, synsets.size());
+            // Committed chunks only rebuild their hubs for Phases 3 and 5
+            const bool resumed = chunk_end <= synsets_done;
 
             // Parallel: compute lemma compositions + gloss decompositions
             struct SynResult {
@@ -204,7 +221,7 @@ int main(int argc, char** argv) {
                 r.lemma_comps.reserve(syn.lemmas.size());
                 for (const auto& lemma : syn.lemmas)
                     r.lemma_comps.push_back(Service::compute_comp(lemma, lookup));
-                if (!syn.gloss.empty())
+                if (!syn.gloss.empty() && !resumed)
                     r.gloss_decomp = Service::decompose_sentence(syn.gloss, lookup);
             }
 
@@ -217,6 +234,12 @@ int main(int argc, char** argv) {
 
                 // Merge lemma compositions; first valid lemma = primary hub
                 Service::CachedComp primary_cache{};
+                if (resumed) {
+                    for (const auto& lc : r.lemma_comps) {
+                        if (lc.valid) { g_synset_to_primary[key] = lc.cache_entry; break; }
+                    }
+                    continue;
+                }
                 for (size_t li = 0; li < r.lemma_comps.size(); ++li) {
                     merge_comp(r.lemma_comps[li], *batch);
                     if (r.lemma_comps[li].valid) {
@@ -253,7 +276,8 @@ int main(int argc, char** argv) {
                         wn_content_id, 1500.0), wn_content_id, *batch);
                 }
             }
-            flusher.enqueue(std::move(batch));
+            if (resumed) continue;
+            commit("synsets", chunk_start, chunk_end, flusher.enqueue(std::move(batch)));
             std::cout << "  Processed " << chunk_end << "/" << synsets.size() << " synsets" << std::endl;
         }
         flusher.wait_all();
@@ -262,8 +286,10 @@ int main(int argc, char** argv) {
         // Phase 3: Pointer relations (primary_lemma_A ↔ primary_lemma_B)
         std::cout << "[Phase 3] Linking WordNet pointer relations..." << std::endl;
         size_t pointer_rels = 0;
+        const size_t pointers_done = checkpoint.position("pointers");
         for (size_t chunk_start = 0; chunk_start < synsets.size(); chunk_start += CHUNK_SIZE) {
             size_t chunk_end = std::min(chunk_start + CHUNK_SIZE, synsets.size());
+            if (chunk_end <= pointers_done) continue;
             auto batch = std::make_unique<SubstrateBatch>();
             for (size_t i = chunk_start; i < chunk_end; ++i) {
                 const auto& syn = synsets[i];
@@ -279,7 +305,7 @@ int main(int argc, char** argv) {
                     }
                 }
             }
-            flusher.enqueue(std::move(batch));
+            commit("pointers", chunk_start, chunk_end, flusher.enqueue(std::move(batch)));
         }
         flusher.wait_all();
         std::cout << "  Pointer relations: " << pointer_rels << std::endl;
@@ -313,11 +339,17 @@ int main(int argc, char** argv) {
 
         // Phase 5: OMW — foreign_lemma ↔ primary_lemma (cross-lingual, ELO 1600)
         std::cout << "[Phase 5] Ingesting OMW (parallel compute)..." << std::endl;
+        const size_t omw_done = checkpoint.position("omw");
         for (size_t chunk_start = 0; chunk_start < omw_entries.size(); chunk_start += CHUNK_SIZE) {
             size_t chunk_end = std::min(chunk_start + CHUNK_SIZE, omw_entries.size());
+            if (chunk_end <= omw_done) continue;
             std::vector<Service::ComputedComp> l_comps(chunk_end - chunk_start);
             #pragma omp parallel for schedule(dynamic, 64)
-            for (size_t i = chunk_start; i < chunk_end; ++i) l_comps[i - chunk_start] = Service::compute_comp(omw_entries[i].lemma, lookup);
+            for (size_t i = chunk_start; i < chunk_end; ++i) {
+                thread_local Service::ComputeScratch scratch;
+                Service::compute_comp(omw_entries[i].lemma, lookup, scratch, l_comps[i - chunk_start], false);
+            }
+            Service::encode_hilbert_indices(l_comps.data(), l_comps.size());
             auto batch = std::make_unique<SubstrateBatch>();
             for (size_t i = chunk_start; i < chunk_end; ++i) {
                 const auto& entry = omw_entries[i];
@@ -328,10 +360,18 @@ int main(int argc, char** argv) {
                 if (lc.valid)
                     merge_relation(Service::compute_relation(lc.cache_entry, sit->second, omw_content_id, 1600.0), omw_content_id, *batch);
             }
-            flusher.enqueue(std::move(batch));
+            commit("omw", chunk_start, chunk_end, flusher.enqueue(std::move(batch)));
         }
         flusher.wait_all();
 
+        // Only a fully flushed run leaves the cache equal to the substrate, and nothing to resume
+        if (flusher.failed_batches() == 0) {
+            g_cache.save_snapshot(db);
+            checkpoint.clear();
+        }
+
+        bulk.finish();
+        flusher.print_metrics(std::cout);
         std::cout << "\n[SUCCESS] WordNet/OMW complete in " << total_timer.elapsed_sec() << "s" << std::endl;
         std::cout << "  Total compositions: " << g_comp_count << " | Total relations: " << g_rel_count << std::endl;
 
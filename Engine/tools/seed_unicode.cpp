@@ -8,6 +8,7 @@
 
 #include <unicode/ingestor/ucd_processor.hpp>
 #include <database/postgres_connection.hpp>
+#include <storage/atom_lookup.hpp>
 #include <utils/time.hpp>
 #include <iostream>
 
@@ -20,6 +21,7 @@ int main(int argc, char** argv) {
         if (argc > 1) {
             data_dir = argv[1];
         }
+        std::string image_path = argc > 2 ? argv[2] : AtomLookup::default_image_path();
 
         std::cout << "=== Hartonomous Unicode Seeding Tool ===\n";
         std::cout << "Data Directory: " << data_dir << "\n";
@@ -40,14 +42,27 @@ int main(int argc, char** argv) {
         auto count_str = db.query_single("SELECT count(*) FROM hartonomous.atom");
         size_t atom_count = count_str ? std::stoul(*count_str) : 0;
 
+        bool seeded = false;
         if (atom_count >= 1114112) {
             std::cout << "✓ Atoms already seeded (" << atom_count << "). Skipping.\n";
-            return 0;
         } else {
             processor.process_and_ingest();
+            seeded = true;
         }
 
-        std::cout << "\n✓ DONE. Unicode universe seeded in " << timer.elapsed_sec() << "s.\n";
+        // 4. Emit the atom image that AtomLookup maps instead of querying
+        if (!image_path.empty()) {
+            AtomLookup lookup(db);
+            if (seeded || !lookup.load_image(image_path)) {
+                Timer t;
+                lookup.write_image(image_path);
+                std::cout << "✓ Atom image written to " << image_path << " in " << t.elapsed_sec() << "s.\n";
+            } else {
+                std::cout << "✓ Atom image up to date: " << image_path << "\n";
+            }
+        }
+
+        if (seeded) std::cout << "\n✓ DONE. Unicode universe seeded in " << timer.elapsed_sec() << "s.\n";
         return 0;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,76 @@
+/**
+ * @file substrate_snapshot.cpp
+ * @brief Export, import and inspect native substrate snapshots
+ *
+ * Usage:
+ *   substrate_snapshot export <file> [table...]   tables default to SubstrateSnapshot::default_tables()
+ *   substrate_snapshot import <file>
+ *   substrate_snapshot info <file>
+ *   substrate_snapshot graph <file> [output_path] relation graph file for walk servers, no database needed
+ *
+ * The database comes from the PG* environment variables; see
+ * database/substrate_snapshot.hpp for HARTONOMOUS_SNAPSHOT_*.
+ */
+
+#include <cognitive/relation_graph.hpp>
+#include <database/connection_pool.hpp>
+#include <database/substrate_snapshot.hpp>
+#include <utils/time.hpp>
+#include <iostream>
+#include <string>
+
+using namespace Hartonomous;
+
+static int usage() {
+    std::cerr << "Usage: substrate_snapshot export <file> [table...]\n"
+              << "       substrate_snapshot import <file>\n"
+              << "       substrate_snapshot info <file>\n"
+              << "       substrate_snapshot graph <file> [output_path]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    const std::string command = argv[1];
+    const std::string path = argv[2];
+
+    try {
+        Timer timer;
+        if (command == "export") {
+            auto opts = SubstrateSnapshot::Options::from_env();
+            for (int i = 3; i < argc; ++i) opts.tables.push_back(argv[i]);
+            ConnectionPool pool;
+            const uint64_t rows = SubstrateSnapshot::write(pool, path, opts);
+            std::cout << "Exported " << rows << " rows to " << path << " (" << timer.elapsed_sec() << "s)" << std::endl;
+        } else if (command == "import") {
+            ConnectionPool pool;
+            const uint64_t rows = SubstrateSnapshot::load(pool, path);
+            std::cout << "Imported " << rows << " rows from " << path << " (" << timer.elapsed_sec() << "s)" << std::endl;
+        } else if (command == "info") {
+            auto snap = SubstrateSnapshot::open(path);
+            std::cout << path << ": " << snap->file_bytes() << " bytes, id " << snap->id() << std::endl;
+            for (const auto& t : snap->tables()) {
+                std::cout << "  " << t.name << ": " << t.rows << " rows in " << t.blocks.size() << " blocks" << std::endl;
+                for (const auto& c : t.columns) std::cout << "    " << c.name << " " << c.type << std::endl;
+            }
+        } else if (command == "graph") {
+            const std::string out = argc > 3 ? argv[3] : RelationGraph::default_path();
+            if (out.empty()) {
+                std::cerr << "No output path: pass one or set HARTONOMOUS_RELATION_GRAPH" << std::endl;
+                return 1;
+            }
+            auto snap = SubstrateSnapshot::open(path);
+            auto graph = RelationGraph::from_snapshot(*snap);
+            if (RelationGraph::packed_by_default()) graph = graph->pack();
+            graph->write_file(out);
+            std::cout << "Relation graph: " << graph->node_count() << " nodes, " << graph->edge_count()
+                      << " edges written to " << out << " (" << timer.elapsed_sec() << "s)" << std::endl;
+        } else {
+            return usage();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -35,7 +35,7 @@ int main(int argc, char** argv) {
         std::cout << "=== Step-by-Step Walk ===" << std::endl;
         auto state = engine.init_walk_from_prompt(prompt, 1.0);
         
-        std::string seed_text = engine.lookup_text(state.current_composition);
+        std::string_view seed_text = engine.lookup_text(state.current_composition);
         std::cout << "Seed: " << seed_text << " [" << BLAKE3Pipeline::to_hex(state.current_composition).substr(0, 8) << "]" << std::endl;
 
         for (size_t i = 0; i < max_steps; ++i) {
@@ -45,7 +45,7 @@ int main(int argc, char** argv) {
                 break;
             }
 
-            std::string text = engine.lookup_text(result.next_composition);
+            std::string_view text = engine.lookup_text(result.next_composition);
             std::cout << "  " << std::setw(2) << (i+1) << ": " 
                       << std::setw(20) << std::left << text
                       << " p=" << std::fixed << std::setprecision(3) << result.probability
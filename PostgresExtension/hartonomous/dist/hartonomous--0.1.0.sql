@@ -23,12 +23,56 @@ CREATE OR REPLACE FUNCTION codepoint_to_hilbert(int)
 RETURNS bytea AS 'MODULE_PATHNAME', 'codepoint_to_hilbert'
 LANGUAGE C IMMUTABLE STRICT;
 
+-- Batch projection, returning PostGIS geometries built from EWKB. Created
+-- only when PostGIS is installed before this extension.
+DO $do$
+DECLARE
+    geom text;
+BEGIN
+    SELECT format('%I.geometry', n.nspname) INTO geom
+    FROM pg_type t JOIN pg_namespace n ON n.oid = t.typnamespace
+    WHERE t.typname = 'geometry' AND t.typtype = 'b';
+    IF geom IS NULL THEN
+        RAISE NOTICE 'PostGIS not installed: codepoints_to_s3 and codepoints_centroid not created';
+        RETURN;
+    END IF;
+
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION codepoints_to_s3(int[])
+        RETURNS %s[] AS 'MODULE_PATHNAME', 'codepoints_to_s3'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION codepoints_centroid(int[])
+        RETURNS %s AS 'MODULE_PATHNAME', 'codepoints_centroid'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+END
+$do$;
 -- Including functions/analysis.sql
 -- Analysis
 CREATE OR REPLACE FUNCTION compute_centroid(float8[][])
 RETURNS text AS 'MODULE_PATHNAME', 'compute_centroid'
 LANGUAGE C IMMUTABLE STRICT;
 
+-- Centroids of many point groups: points are the groups' flat 4D coordinates
+-- back to back, counts the points per group. Needs PostGIS, like codepoints_to_s3.
+DO $do$
+DECLARE
+    geom text;
+BEGIN
+    SELECT format('%I.geometry', n.nspname) INTO geom
+    FROM pg_type t JOIN pg_namespace n ON n.oid = t.typnamespace
+    WHERE t.typname = 'geometry' AND t.typtype = 'b';
+    IF geom IS NULL THEN
+        RAISE NOTICE 'PostGIS not installed: compute_centroids not created';
+        RETURN;
+    END IF;
+
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION compute_centroids(points float8[], counts int[])
+        RETURNS %s[] AS 'MODULE_PATHNAME', 'compute_centroids'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+END
+$do$;
 -- Including functions/ingestion.sql
 -- Ingestion Shim
 CREATE TYPE ingestion_stats_result AS (
@@ -44,28 +88,218 @@ CREATE OR REPLACE FUNCTION ingest_text(text)
 RETURNS ingestion_stats_result AS 'MODULE_PATHNAME', 'ingest_text'
 LANGUAGE C VOLATILE STRICT;
 
+-- Including functions/ingest_queue.sql
+-- Background ingestion queue, drained by the hartonomous.ingest_workers
+-- background workers (shared_preload_libraries = 'hartonomous')
+CREATE TABLE ingest_queue (
+    id bigserial PRIMARY KEY,
+    kind text NOT NULL CHECK (kind IN ('text', 'file')),
+    payload text NOT NULL,
+    status text NOT NULL DEFAULT 'queued' CHECK (status IN ('queued', 'running', 'done', 'failed')),
+    enqueued_at timestamptz NOT NULL DEFAULT now(),
+    started_at timestamptz,
+    finished_at timestamptz,
+    worker_pid int4,
+    atoms_new bigint,
+    compositions_new bigint,
+    relations_new bigint,
+    original_bytes bigint,
+    stored_bytes bigint,
+    error text
+);
+
+-- Workers claim the oldest queued job
+CREATE INDEX ingest_queue_queued ON ingest_queue (id) WHERE status = 'queued';
+
+SELECT pg_catalog.pg_extension_config_dump('ingest_queue', '');
+SELECT pg_catalog.pg_extension_config_dump('ingest_queue_id_seq', '');
+
+CREATE OR REPLACE FUNCTION enqueue_ingest(content text)
+RETURNS bigint
+LANGUAGE SQL VOLATILE STRICT SECURITY DEFINER
+SET search_path FROM CURRENT
+AS $$
+    INSERT INTO ingest_queue (kind, payload) VALUES ('text', content) RETURNING id;
+$$;
+
+-- The path is read by the server's OS user, so this stays superuser-only unless granted
+CREATE OR REPLACE FUNCTION enqueue_ingest_file(path text)
+RETURNS bigint
+LANGUAGE SQL VOLATILE STRICT SECURITY DEFINER
+SET search_path FROM CURRENT
+AS $$
+    INSERT INTO ingest_queue (kind, payload) VALUES ('file', path) RETURNING id;
+$$;
+
+REVOKE ALL ON FUNCTION enqueue_ingest_file(text) FROM PUBLIC;
+
+CREATE VIEW ingest_status AS
+SELECT
+    id,
+    kind,
+    CASE kind WHEN 'file' THEN payload ELSE left(payload, 80) END AS source,
+    CASE kind WHEN 'text' THEN octet_length(payload) END AS text_bytes,
+    status,
+    enqueued_at,
+    started_at,
+    finished_at,
+    COALESCE(finished_at, now()) - started_at AS elapsed,
+    worker_pid,
+    atoms_new,
+    compositions_new,
+    relations_new,
+    original_bytes,
+    stored_bytes,
+    error
+FROM ingest_queue;
+
+-- Including functions/neighbors.sql
+-- Relation neighbors, aggregated per neighbor (max rating, summed observations)
+CREATE OR REPLACE FUNCTION neighbors(
+    composition uuid,
+    min_elo float8 DEFAULT '-Infinity',
+    min_obs float8 DEFAULT 0,
+    max_results int4 DEFAULT 0,
+    OUT neighbor uuid,
+    OUT max_elo float8,
+    OUT total_obs float8,
+    OUT relation_count int4)
+RETURNS SETOF record AS 'MODULE_PATHNAME', 'hartonomous_neighbors'
+LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+COMMENT ON FUNCTION neighbors(uuid, float8, float8, int4) IS
+    'Compositions sharing a relation with the given one, strongest first; max_results 0 returns all';
+
+-- Frontier expansion: the neighbors of every composition in one call
+CREATE OR REPLACE FUNCTION neighbors(
+    compositions uuid[],
+    min_elo float8 DEFAULT '-Infinity',
+    min_obs float8 DEFAULT 0,
+    max_results int4 DEFAULT 0,
+    OUT composition uuid,
+    OUT neighbor uuid,
+    OUT max_elo float8,
+    OUT total_obs float8,
+    OUT relation_count int4)
+RETURNS SETOF record AS 'MODULE_PATHNAME', 'hartonomous_neighbors_batch'
+LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+COMMENT ON FUNCTION neighbors(uuid[], float8, float8, int4) IS
+    'neighbors() for each of the given compositions; max_results applies per composition';
+
 
 -- Versioning
 CREATE OR REPLACE FUNCTION hartonomous_version()
 RETURNS text AS 'MODULE_PATHNAME', 'hartonomous_version'
 LANGUAGE C IMMUTABLE STRICT;
 
--- UINT64 native arithmetic (operates directly on raw bytes, full unsigned range)
-CREATE OR REPLACE FUNCTION uint64_add(uint64, uint64)
-RETURNS uint64 AS 'MODULE_PATHNAME', 'uint64_add'
-LANGUAGE C IMMUTABLE STRICT;
+-- Including uint64_ops.sql
+-- ==============================================================================
+-- UINT64: native fixed 8-byte unsigned integer
+-- ==============================================================================
 
-CREATE OR REPLACE FUNCTION uint64_to_double(uint64)
-RETURNS float8 AS 'MODULE_PATHNAME', 'uint64_to_double'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE uint64;
+
+CREATE OR REPLACE FUNCTION uint64_in(cstring) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint64_out(uint64) RETURNS cstring
+AS 'MODULE_PATHNAME', 'uint64_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint64_recv(internal) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
-CREATE OPERATOR + (
-    LEFTARG = uint64,
-    RIGHTARG = uint64,
-    PROCEDURE = uint64_add
+CREATE OR REPLACE FUNCTION uint64_send(uint64) RETURNS bytea
+AS 'MODULE_PATHNAME', 'uint64_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE uint64 (
+    INPUT = uint64_in,
+    OUTPUT = uint64_out,
+    RECEIVE = uint64_recv,
+    SEND = uint64_send,
+    INTERNALLENGTH = 8,
+    ALIGNMENT = double,
+    STORAGE = plain
 );
 
--- Weighted ELO update using native uint64 observation counts
+COMMENT ON TYPE uint64 IS 'Fixed 8-byte unsigned integer (0 to 2^64-1) - used for large counts';
+
+-- Comparison
+CREATE OR REPLACE FUNCTION uint64_eq(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_eq' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_ne(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_ne' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_lt(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_lt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_le(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_gt(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_gt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_ge(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_ge' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_cmp(uint64, uint64) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint64_cmp' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_hash(uint64) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint64_hash' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_hash_extended(uint64, int8) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint64_hash_extended' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES);
+CREATE OPERATOR <> (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel);
+CREATE OPERATOR < (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR <= (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR > (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR >= (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel);
+
+CREATE OPERATOR CLASS uint64_ops
+DEFAULT FOR TYPE uint64 USING btree AS
+    OPERATOR 1 <,
+    OPERATOR 2 <=,
+    OPERATOR 3 =,
+    OPERATOR 4 >=,
+    OPERATOR 5 >,
+    FUNCTION 1 uint64_cmp(uint64, uint64);
+
+CREATE OPERATOR CLASS uint64_hash_ops
+DEFAULT FOR TYPE uint64 USING hash AS
+    OPERATOR 1 =,
+    FUNCTION 1 uint64_hash(uint64),
+    FUNCTION 2 uint64_hash_extended(uint64, int8);
+
+-- Arithmetic (out-of-range results are errors)
+CREATE OR REPLACE FUNCTION uint64_add(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_add' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_sub(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_sub' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_mul(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_mul' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR + (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_add, COMMUTATOR = +);
+CREATE OPERATOR - (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_sub);
+CREATE OPERATOR * (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_mul, COMMUTATOR = *);
+
+-- Conversions
+CREATE OR REPLACE FUNCTION uint64_to_double(uint64) RETURNS float8
+AS 'MODULE_PATHNAME', 'uint64_to_double' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_to_bigint(uint64) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint64_to_bigint' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_from_bigint(int8) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_from_bigint' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_from_int(int4) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_from_int' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (uint64 AS float8) WITH FUNCTION uint64_to_double(uint64) AS IMPLICIT;
+CREATE CAST (uint64 AS int8) WITH FUNCTION uint64_to_bigint(uint64);
+CREATE CAST (int8 AS uint64) WITH FUNCTION uint64_from_bigint(int8) AS ASSIGNMENT;
+CREATE CAST (int4 AS uint64) WITH FUNCTION uint64_from_int(int4) AS ASSIGNMENT;
+
+-- Weighted average using native types
 CREATE OR REPLACE FUNCTION weighted_elo_update(
     old_elo DOUBLE PRECISION,
     old_obs uint64,
@@ -78,15 +312,98 @@ LANGUAGE SQL IMMUTABLE AS $$
            (uint64_to_double(old_obs) + uint64_to_double(new_obs));
 $$;
 
--- UINT128 operations
-CREATE OR REPLACE FUNCTION uint128_from_parts(bigint, bigint)
-RETURNS uint128 AS 'MODULE_PATHNAME', 'uint128_from_parts'
-LANGUAGE C IMMUTABLE STRICT;
+-- Including uint128_ops.sql
+-- ==============================================================================
+-- UINT128: native fixed 16-byte unsigned integer
+-- ==============================================================================
 
-CREATE OR REPLACE FUNCTION uint128_hi(uint128)
-RETURNS bigint AS 'MODULE_PATHNAME', 'uint128_hi'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE uint128;
 
-CREATE OR REPLACE FUNCTION uint128_lo(uint128)
-RETURNS bigint AS 'MODULE_PATHNAME', 'uint128_lo'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE OR REPLACE FUNCTION uint128_in(cstring) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint128_out(uint128) RETURNS cstring
+AS 'MODULE_PATHNAME', 'uint128_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint128_recv(internal) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint128_send(uint128) RETURNS bytea
+AS 'MODULE_PATHNAME', 'uint128_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE uint128 (
+    INPUT = uint128_in,
+    OUTPUT = uint128_out,
+    RECEIVE = uint128_recv,
+    SEND = uint128_send,
+    INTERNALLENGTH = 16,
+    ALIGNMENT = double,
+    STORAGE = plain
+);
+
+COMMENT ON TYPE uint128 IS 'Fixed 16-byte unsigned integer (0 to 2^128-1) - Hilbert curve spatial index';
+
+-- Comparison
+CREATE OR REPLACE FUNCTION uint128_eq(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_eq' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_ne(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_ne' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_lt(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_lt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_le(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_gt(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_gt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_ge(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_ge' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_cmp(uint128, uint128) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint128_cmp' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_hash(uint128) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint128_hash' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_hash_extended(uint128, int8) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint128_hash_extended' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES);
+CREATE OPERATOR <> (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel);
+CREATE OPERATOR < (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR <= (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR > (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR >= (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel);
+
+CREATE OPERATOR CLASS uint128_ops
+DEFAULT FOR TYPE uint128 USING btree AS
+    OPERATOR 1 <,
+    OPERATOR 2 <=,
+    OPERATOR 3 =,
+    OPERATOR 4 >=,
+    OPERATOR 5 >,
+    FUNCTION 1 uint128_cmp(uint128, uint128);
+
+CREATE OPERATOR CLASS uint128_hash_ops
+DEFAULT FOR TYPE uint128 USING hash AS
+    OPERATOR 1 =,
+    FUNCTION 1 uint128_hash(uint128),
+    FUNCTION 2 uint128_hash_extended(uint128, int8);
+
+-- Arithmetic (out-of-range results are errors)
+CREATE OR REPLACE FUNCTION uint128_add(uint128, uint128) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_add' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_sub(uint128, uint128) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_sub' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR + (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_add, COMMUTATOR = +);
+CREATE OPERATOR - (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_sub);
+
+-- Halves, as bigint bit patterns
+CREATE OR REPLACE FUNCTION uint128_from_parts(hi BIGINT, lo BIGINT) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_from_parts' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_hi(uint128) RETURNS BIGINT
+AS 'MODULE_PATHNAME', 'uint128_hi' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_lo(uint128) RETURNS BIGINT
+AS 'MODULE_PATHNAME', 'uint128_lo' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
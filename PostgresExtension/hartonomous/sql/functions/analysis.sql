@@ -2,3 +2,24 @@
 CREATE OR REPLACE FUNCTION compute_centroid(float8[][])
 RETURNS text AS 'MODULE_PATHNAME', 'compute_centroid'
 LANGUAGE C IMMUTABLE STRICT;
+
+-- Centroids of many point groups: points are the groups' flat 4D coordinates
+-- back to back, counts the points per group. Needs PostGIS, like codepoints_to_s3.
+DO $do$
+DECLARE
+    geom text;
+BEGIN
+    SELECT format('%I.geometry', n.nspname) INTO geom
+    FROM pg_type t JOIN pg_namespace n ON n.oid = t.typnamespace
+    WHERE t.typname = 'geometry' AND t.typtype = 'b';
+    IF geom IS NULL THEN
+        RAISE NOTICE 'PostGIS not installed: compute_centroids not created';
+        RETURN;
+    END IF;
+
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION compute_centroids(points float8[], counts int[])
+        RETURNS %s[] AS 'MODULE_PATHNAME', 'compute_centroids'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+END
+$do$;
@@ -0,0 +1,63 @@
+-- Background ingestion queue, drained by the hartonomous.ingest_workers
+-- background workers (shared_preload_libraries = 'hartonomous')
+CREATE TABLE ingest_queue (
+    id bigserial PRIMARY KEY,
+    kind text NOT NULL CHECK (kind IN ('text', 'file')),
+    payload text NOT NULL,
+    status text NOT NULL DEFAULT 'queued' CHECK (status IN ('queued', 'running', 'done', 'failed')),
+    enqueued_at timestamptz NOT NULL DEFAULT now(),
+    started_at timestamptz,
+    finished_at timestamptz,
+    worker_pid int4,
+    atoms_new bigint,
+    compositions_new bigint,
+    relations_new bigint,
+    original_bytes bigint,
+    stored_bytes bigint,
+    error text
+);
+
+-- Workers claim the oldest queued job
+CREATE INDEX ingest_queue_queued ON ingest_queue (id) WHERE status = 'queued';
+
+SELECT pg_catalog.pg_extension_config_dump('ingest_queue', '');
+SELECT pg_catalog.pg_extension_config_dump('ingest_queue_id_seq', '');
+
+CREATE OR REPLACE FUNCTION enqueue_ingest(content text)
+RETURNS bigint
+LANGUAGE SQL VOLATILE STRICT SECURITY DEFINER
+SET search_path FROM CURRENT
+AS $$
+    INSERT INTO ingest_queue (kind, payload) VALUES ('text', content) RETURNING id;
+$$;
+
+-- The path is read by the server's OS user, so this stays superuser-only unless granted
+CREATE OR REPLACE FUNCTION enqueue_ingest_file(path text)
+RETURNS bigint
+LANGUAGE SQL VOLATILE STRICT SECURITY DEFINER
+SET search_path FROM CURRENT
+AS $$
+    INSERT INTO ingest_queue (kind, payload) VALUES ('file', path) RETURNING id;
+$$;
+
+REVOKE ALL ON FUNCTION enqueue_ingest_file(text) FROM PUBLIC;
+
+CREATE VIEW ingest_status AS
+SELECT
+    id,
+    kind,
+    CASE kind WHEN 'file' THEN payload ELSE left(payload, 80) END AS source,
+    CASE kind WHEN 'text' THEN octet_length(payload) END AS text_bytes,
+    status,
+    enqueued_at,
+    started_at,
+    finished_at,
+    COALESCE(finished_at, now()) - started_at AS elapsed,
+    worker_pid,
+    atoms_new,
+    compositions_new,
+    relations_new,
+    original_bytes,
+    stored_bytes,
+    error
+FROM ingest_queue;
@@ -0,0 +1,32 @@
+-- Relation neighbors, aggregated per neighbor (max rating, summed observations)
+CREATE OR REPLACE FUNCTION neighbors(
+    composition uuid,
+    min_elo float8 DEFAULT '-Infinity',
+    min_obs float8 DEFAULT 0,
+    max_results int4 DEFAULT 0,
+    OUT neighbor uuid,
+    OUT max_elo float8,
+    OUT total_obs float8,
+    OUT relation_count int4)
+RETURNS SETOF record AS 'MODULE_PATHNAME', 'hartonomous_neighbors'
+LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+COMMENT ON FUNCTION neighbors(uuid, float8, float8, int4) IS
+    'Compositions sharing a relation with the given one, strongest first; max_results 0 returns all';
+
+-- Frontier expansion: the neighbors of every composition in one call
+CREATE OR REPLACE FUNCTION neighbors(
+    compositions uuid[],
+    min_elo float8 DEFAULT '-Infinity',
+    min_obs float8 DEFAULT 0,
+    max_results int4 DEFAULT 0,
+    OUT composition uuid,
+    OUT neighbor uuid,
+    OUT max_elo float8,
+    OUT total_obs float8,
+    OUT relation_count int4)
+RETURNS SETOF record AS 'MODULE_PATHNAME', 'hartonomous_neighbors_batch'
+LANGUAGE C STABLE STRICT PARALLEL RESTRICTED;
+
+COMMENT ON FUNCTION neighbors(uuid[], float8, float8, int4) IS
+    'neighbors() for each of the given compositions; max_results applies per composition';
@@ -6,3 +6,28 @@ LANGUAGE C IMMUTABLE STRICT;
 CREATE OR REPLACE FUNCTION codepoint_to_hilbert(int)
 RETURNS bytea AS 'MODULE_PATHNAME', 'codepoint_to_hilbert'
 LANGUAGE C IMMUTABLE STRICT;
+
+-- Batch projection, returning PostGIS geometries built from EWKB. Created
+-- only when PostGIS is installed before this extension.
+DO $do$
+DECLARE
+    geom text;
+BEGIN
+    SELECT format('%I.geometry', n.nspname) INTO geom
+    FROM pg_type t JOIN pg_namespace n ON n.oid = t.typnamespace
+    WHERE t.typname = 'geometry' AND t.typtype = 'b';
+    IF geom IS NULL THEN
+        RAISE NOTICE 'PostGIS not installed: codepoints_to_s3 and codepoints_centroid not created';
+        RETURN;
+    END IF;
+
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION codepoints_to_s3(int[])
+        RETURNS %s[] AS 'MODULE_PATHNAME', 'codepoints_to_s3'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+    EXECUTE format($f$
+        CREATE OR REPLACE FUNCTION codepoints_centroid(int[])
+        RETURNS %s AS 'MODULE_PATHNAME', 'codepoints_centroid'
+        LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE$f$, geom);
+END
+$do$;
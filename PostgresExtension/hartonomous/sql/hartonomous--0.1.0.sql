@@ -6,6 +6,8 @@
 \i 'functions/projection.sql'
 \i 'functions/analysis.sql'
 \i 'functions/ingestion.sql'
+\i 'functions/ingest_queue.sql'
+\i 'functions/neighbors.sql'
 
 -- Native unsigned integer operators
 \i 'uint64_ops.sql'
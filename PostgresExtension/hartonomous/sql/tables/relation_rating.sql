@@ -24,5 +24,6 @@ CREATE TABLE IF NOT EXISTS hartonomous.RelationRating (
 
 CREATE INDEX IF NOT EXISTS idx_RelationRating_Consensus ON hartonomous.RelationRating(ConsensusElo);
 CREATE INDEX IF NOT EXISTS idx_RelationRating_Base ON hartonomous.RelationRating(BaseElo);
+CREATE INDEX IF NOT EXISTS idx_RelationRating_ModifiedAt ON hartonomous.RelationRating(ModifiedAt);
 
 COMMENT ON TABLE hartonomous.RelationRating IS 'Stores the Dual-ELO rating representing the quality (Base) and consensus (Consensus) of a Relation.';
\ No newline at end of file
@@ -1,19 +1,94 @@
--- uint128_ops.sql
 -- ==============================================================================
--- UINT128 Native Operators
+-- UINT128: native fixed 16-byte unsigned integer
 -- ==============================================================================
 
-CREATE OR REPLACE FUNCTION uint128_from_parts(hi BIGINT, lo BIGINT)
-RETURNS hartonomous.UINT128
-AS 'MODULE_PATHNAME', 'uint128_from_parts'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE uint128;
 
-CREATE OR REPLACE FUNCTION uint128_hi(hartonomous.UINT128)
-RETURNS BIGINT
-AS 'MODULE_PATHNAME', 'uint128_hi'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE OR REPLACE FUNCTION uint128_in(cstring) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
-CREATE OR REPLACE FUNCTION uint128_lo(hartonomous.UINT128)
-RETURNS BIGINT
-AS 'MODULE_PATHNAME', 'uint128_lo'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE OR REPLACE FUNCTION uint128_out(uint128) RETURNS cstring
+AS 'MODULE_PATHNAME', 'uint128_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint128_recv(internal) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint128_send(uint128) RETURNS bytea
+AS 'MODULE_PATHNAME', 'uint128_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE uint128 (
+    INPUT = uint128_in,
+    OUTPUT = uint128_out,
+    RECEIVE = uint128_recv,
+    SEND = uint128_send,
+    INTERNALLENGTH = 16,
+    ALIGNMENT = double,
+    STORAGE = plain
+);
+
+COMMENT ON TYPE uint128 IS 'Fixed 16-byte unsigned integer (0 to 2^128-1) - Hilbert curve spatial index';
+
+-- Comparison
+CREATE OR REPLACE FUNCTION uint128_eq(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_eq' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_ne(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_ne' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_lt(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_lt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_le(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_gt(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_gt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_ge(uint128, uint128) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint128_ge' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_cmp(uint128, uint128) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint128_cmp' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_hash(uint128) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint128_hash' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint128_hash_extended(uint128, int8) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint128_hash_extended' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES);
+CREATE OPERATOR <> (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel);
+CREATE OPERATOR < (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR <= (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR > (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR >= (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel);
+
+CREATE OPERATOR CLASS uint128_ops
+DEFAULT FOR TYPE uint128 USING btree AS
+    OPERATOR 1 <,
+    OPERATOR 2 <=,
+    OPERATOR 3 =,
+    OPERATOR 4 >=,
+    OPERATOR 5 >,
+    FUNCTION 1 uint128_cmp(uint128, uint128);
+
+CREATE OPERATOR CLASS uint128_hash_ops
+DEFAULT FOR TYPE uint128 USING hash AS
+    OPERATOR 1 =,
+    FUNCTION 1 uint128_hash(uint128),
+    FUNCTION 2 uint128_hash_extended(uint128, int8);
+
+-- Arithmetic (out-of-range results are errors)
+CREATE OR REPLACE FUNCTION uint128_add(uint128, uint128) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_add' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_sub(uint128, uint128) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_sub' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR + (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_add, COMMUTATOR = +);
+CREATE OPERATOR - (LEFTARG = uint128, RIGHTARG = uint128, PROCEDURE = uint128_sub);
+
+-- Halves, as bigint bit patterns
+CREATE OR REPLACE FUNCTION uint128_from_parts(hi BIGINT, lo BIGINT) RETURNS uint128
+AS 'MODULE_PATHNAME', 'uint128_from_parts' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_hi(uint128) RETURNS BIGINT
+AS 'MODULE_PATHNAME', 'uint128_hi' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint128_lo(uint128) RETURNS BIGINT
+AS 'MODULE_PATHNAME', 'uint128_lo' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
@@ -1,32 +1,117 @@
 -- ==============================================================================
--- UINT64 Native Operators
+-- UINT64: native fixed 8-byte unsigned integer
 -- ==============================================================================
 
-CREATE OR REPLACE FUNCTION uint64_add(hartonomous.uint64, hartonomous.uint64)
-RETURNS hartonomous.uint64
-AS 'MODULE_PATHNAME', 'uint64_add'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE uint64;
 
-CREATE OR REPLACE FUNCTION uint64_to_double(hartonomous.uint64)
-RETURNS DOUBLE PRECISION
-AS 'MODULE_PATHNAME', 'uint64_to_double'
-LANGUAGE C IMMUTABLE STRICT;
+CREATE OR REPLACE FUNCTION uint64_in(cstring) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_in' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint64_out(uint64) RETURNS cstring
+AS 'MODULE_PATHNAME', 'uint64_out' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint64_recv(internal) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_recv' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OR REPLACE FUNCTION uint64_send(uint64) RETURNS bytea
+AS 'MODULE_PATHNAME', 'uint64_send' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
-CREATE OPERATOR + (
-    LEFTARG = hartonomous.uint64,
-    RIGHTARG = hartonomous.uint64,
-    PROCEDURE = uint64_add
+CREATE TYPE uint64 (
+    INPUT = uint64_in,
+    OUTPUT = uint64_out,
+    RECEIVE = uint64_recv,
+    SEND = uint64_send,
+    INTERNALLENGTH = 8,
+    ALIGNMENT = double,
+    STORAGE = plain
 );
 
+COMMENT ON TYPE uint64 IS 'Fixed 8-byte unsigned integer (0 to 2^64-1) - used for large counts';
+
+-- Comparison
+CREATE OR REPLACE FUNCTION uint64_eq(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_eq' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_ne(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_ne' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_lt(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_lt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_le(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_le' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_gt(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_gt' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_ge(uint64, uint64) RETURNS bool
+AS 'MODULE_PATHNAME', 'uint64_ge' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_cmp(uint64, uint64) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint64_cmp' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_hash(uint64) RETURNS int4
+AS 'MODULE_PATHNAME', 'uint64_hash' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE OR REPLACE FUNCTION uint64_hash_extended(uint64, int8) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint64_hash_extended' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES);
+CREATE OPERATOR <> (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel);
+CREATE OPERATOR < (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR <= (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR > (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR >= (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel);
+
+CREATE OPERATOR CLASS uint64_ops
+DEFAULT FOR TYPE uint64 USING btree AS
+    OPERATOR 1 <,
+    OPERATOR 2 <=,
+    OPERATOR 3 =,
+    OPERATOR 4 >=,
+    OPERATOR 5 >,
+    FUNCTION 1 uint64_cmp(uint64, uint64);
+
+CREATE OPERATOR CLASS uint64_hash_ops
+DEFAULT FOR TYPE uint64 USING hash AS
+    OPERATOR 1 =,
+    FUNCTION 1 uint64_hash(uint64),
+    FUNCTION 2 uint64_hash_extended(uint64, int8);
+
+-- Arithmetic (out-of-range results are errors)
+CREATE OR REPLACE FUNCTION uint64_add(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_add' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_sub(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_sub' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_mul(uint64, uint64) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_mul' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR + (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_add, COMMUTATOR = +);
+CREATE OPERATOR - (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_sub);
+CREATE OPERATOR * (LEFTARG = uint64, RIGHTARG = uint64, PROCEDURE = uint64_mul, COMMUTATOR = *);
+
+-- Conversions
+CREATE OR REPLACE FUNCTION uint64_to_double(uint64) RETURNS float8
+AS 'MODULE_PATHNAME', 'uint64_to_double' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_to_bigint(uint64) RETURNS int8
+AS 'MODULE_PATHNAME', 'uint64_to_bigint' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_from_bigint(int8) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_from_bigint' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION uint64_from_int(int4) RETURNS uint64
+AS 'MODULE_PATHNAME', 'uint64_from_int' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (uint64 AS float8) WITH FUNCTION uint64_to_double(uint64) AS IMPLICIT;
+CREATE CAST (uint64 AS int8) WITH FUNCTION uint64_to_bigint(uint64);
+CREATE CAST (int8 AS uint64) WITH FUNCTION uint64_from_bigint(int8) AS ASSIGNMENT;
+CREATE CAST (int4 AS uint64) WITH FUNCTION uint64_from_int(int4) AS ASSIGNMENT;
+
 -- Weighted average using native types
-CREATE OR REPLACE FUNCTION hartonomous.weighted_elo_update(
-    old_elo DOUBLE PRECISION, 
-    old_obs hartonomous.uint64, 
-    new_elo DOUBLE PRECISION, 
-    new_obs hartonomous.uint64
+CREATE OR REPLACE FUNCTION weighted_elo_update(
+    old_elo DOUBLE PRECISION,
+    old_obs uint64,
+    new_elo DOUBLE PRECISION,
+    new_obs uint64
 )
 RETURNS DOUBLE PRECISION
 LANGUAGE SQL IMMUTABLE AS $$
-    SELECT (old_elo * uint64_to_double(old_obs) + new_elo * uint64_to_double(new_obs)) / 
+    SELECT (old_elo * uint64_to_double(old_obs) + new_elo * uint64_to_double(new_obs)) /
            (uint64_to_double(old_obs) + uint64_to_double(new_obs));
 $$;
@@ -10,10 +10,19 @@
 #include "varatt.h"
 #include "funcapi.h"
 #include "interop_api.h"
+#include "ingest_worker.h"
+#include "shared_cache.h"
 #include <string.h>
 
 PG_MODULE_MAGIC;
 
+void _PG_init(void);
+
+void _PG_init(void) {
+    hartonomous_shared_cache_init();
+    hartonomous_ingest_init();
+}
+
 // =============================================================================
 //  Version Info
 // =============================================================================
@@ -0,0 +1,313 @@
+#include "postgres.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "executor/spi.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/latch.h"
+#include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+#include "utils/wait_event.h"
+#include "interop_api.h"
+#include "ingest_worker.h"
+
+/*
+ * INGEST WORKERS: background workers draining the ingest_queue table.
+ *
+ * enqueue_ingest() and enqueue_ingest_file() insert queued jobs. Each worker
+ * claims the oldest one with FOR UPDATE SKIP LOCKED, so workers never wait on
+ * each other's claims, commits the claim, runs the engine ingester outside
+ * any transaction and records the outcome. The ingester writes through its
+ * own pooled connections with binary COPY, exactly as ingest_text() does;
+ * the backends running the worker only claim and report.
+ *
+ * A job left 'running' by a worker that died is requeued when a worker
+ * starts. Workers are only started when the library is in
+ * shared_preload_libraries and hartonomous.ingest_workers > 0.
+ */
+
+static int ingest_workers = 0;
+static int ingest_naptime_ms = 1000;
+static char *ingest_database = NULL;
+static char *ingest_conninfo = NULL;
+
+typedef struct IngestJob
+{
+    int64 id;
+    bool is_file;
+    char *payload;
+} IngestJob;
+
+/* Engine handles, kept for the life of the worker */
+static h_db_connection_t worker_db = NULL;
+static h_ingester_t worker_ingester = NULL;
+
+PGDLLEXPORT void hartonomous_ingest_worker_main(Datum main_arg);
+
+void
+hartonomous_ingest_init(void)
+{
+    DefineCustomIntVariable("hartonomous.ingest_workers",
+                            "Number of background workers draining the ingest queue.",
+                            NULL, &ingest_workers, 0, 0, 64,
+                            PGC_POSTMASTER, 0, NULL, NULL, NULL);
+    DefineCustomIntVariable("hartonomous.ingest_naptime",
+                            "How long an idle ingest worker sleeps between queue polls.",
+                            NULL, &ingest_naptime_ms, 1000, 10, 3600 * 1000,
+                            PGC_SIGHUP, GUC_UNIT_MS, NULL, NULL, NULL);
+    DefineCustomStringVariable("hartonomous.ingest_database",
+                               "Database whose ingest queue the workers drain.",
+                               NULL, &ingest_database, "hypercube",
+                               PGC_POSTMASTER, 0, NULL, NULL, NULL);
+    DefineCustomStringVariable("hartonomous.ingest_conninfo",
+                               "Connection string the engine ingester writes through (empty: PG* environment).",
+                               NULL, &ingest_conninfo, "",
+                               PGC_SIGHUP, 0, NULL, NULL, NULL);
+    MarkGUCPrefixReserved("hartonomous");
+
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+    for (int i = 0; i < ingest_workers; i++)
+    {
+        BackgroundWorker worker;
+
+        memset(&worker, 0, sizeof(worker));
+        worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+        worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+        worker.bgw_restart_time = 10;
+        snprintf(worker.bgw_library_name, BGW_MAXLEN, "hartonomous");
+        snprintf(worker.bgw_function_name, BGW_MAXLEN, "hartonomous_ingest_worker_main");
+        snprintf(worker.bgw_name, BGW_MAXLEN, "hartonomous ingest worker %d", i);
+        snprintf(worker.bgw_type, BGW_MAXLEN, "hartonomous ingest worker");
+        worker.bgw_main_arg = Int32GetDatum(i);
+        RegisterBackgroundWorker(&worker);
+    }
+}
+
+/* Quoted schema of the installed extension, or NULL; caller is inside SPI */
+static char *
+queue_schema(void)
+{
+    const char *sql =
+        "SELECT n.nspname FROM pg_catalog.pg_extension e "
+        "JOIN pg_catalog.pg_namespace n ON n.oid = e.extnamespace "
+        "WHERE e.extname = 'hartonomous'";
+
+    if (SPI_execute(sql, true, 1) != SPI_OK_SELECT || SPI_processed == 0)
+        return NULL;
+    return pstrdup(quote_identifier(SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1)));
+}
+
+static void
+begin_queue_txn(const char *activity)
+{
+    SetCurrentStatementStartTimestamp();
+    StartTransactionCommand();
+    if (SPI_connect() != SPI_OK_CONNECT)
+        elog(ERROR, "ingest worker: SPI_connect failed");
+    PushActiveSnapshot(GetTransactionSnapshot());
+    pgstat_report_activity(STATE_RUNNING, activity);
+}
+
+static void
+end_queue_txn(void)
+{
+    SPI_finish();
+    PopActiveSnapshot();
+    CommitTransactionCommand();
+    pgstat_report_stat(true);
+    pgstat_report_activity(STATE_IDLE, NULL);
+}
+
+/* Requeue jobs whose worker is gone */
+static void
+requeue_orphans(void)
+{
+    char *schema;
+
+    begin_queue_txn("requeueing orphaned ingest jobs");
+    schema = queue_schema();
+    if (schema != NULL)
+    {
+        char *sql = psprintf(
+            "UPDATE %s.ingest_queue q "
+            "SET status = 'queued', started_at = NULL, worker_pid = NULL "
+            "WHERE q.status = 'running' "
+            "AND NOT EXISTS (SELECT 1 FROM pg_catalog.pg_stat_activity a WHERE a.pid = q.worker_pid)",
+            schema);
+
+        if (SPI_execute(sql, false, 0) != SPI_OK_UPDATE)
+            elog(ERROR, "ingest worker: requeueing orphaned jobs failed");
+        if (SPI_processed > 0)
+            elog(LOG, "hartonomous ingest worker requeued " UINT64_FORMAT " orphaned jobs", SPI_processed);
+    }
+    end_queue_txn();
+}
+
+/* Claim the oldest queued job; false if there is none */
+static bool
+claim_job(IngestJob *job)
+{
+    char *schema;
+    bool claimed = false;
+
+    begin_queue_txn("claiming ingest job");
+    schema = queue_schema();
+    if (schema != NULL)
+    {
+        char *sql = psprintf(
+            "UPDATE %s.ingest_queue q "
+            "SET status = 'running', started_at = now(), worker_pid = pg_backend_pid() "
+            "WHERE q.id = (SELECT id FROM %s.ingest_queue WHERE status = 'queued' "
+            "              ORDER BY id FOR UPDATE SKIP LOCKED LIMIT 1) "
+            "RETURNING q.id, q.kind = 'file', q.payload",
+            schema, schema);
+
+        if (SPI_execute(sql, false, 0) != SPI_OK_UPDATE_RETURNING)
+            elog(ERROR, "ingest worker: claiming a job failed");
+        if (SPI_processed > 0)
+        {
+            HeapTuple tup = SPI_tuptable->vals[0];
+            TupleDesc desc = SPI_tuptable->tupdesc;
+            bool isnull;
+
+            job->id = DatumGetInt64(SPI_getbinval(tup, desc, 1, &isnull));
+            job->is_file = DatumGetBool(SPI_getbinval(tup, desc, 2, &isnull));
+            /* Outlives the transaction; freed after the job */
+            job->payload = MemoryContextStrdup(TopMemoryContext, SPI_getvalue(tup, desc, 3));
+            claimed = true;
+        }
+    }
+    end_queue_txn();
+    return claimed;
+}
+
+static void
+finish_job(const IngestJob *job, const HIngestionStats *stats, const char *error)
+{
+    char *schema;
+
+    begin_queue_txn("recording ingest job result");
+    schema = queue_schema();
+    if (schema != NULL)
+    {
+        Oid types[8] = {INT8OID, TEXTOID, INT8OID, INT8OID, INT8OID, INT8OID, INT8OID, TEXTOID};
+        Datum values[8];
+        char nulls[8] = {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+        char *sql = psprintf(
+            "UPDATE %s.ingest_queue SET status = $2, finished_at = now(), "
+            "atoms_new = $3, compositions_new = $4, relations_new = $5, "
+            "original_bytes = $6, stored_bytes = $7, error = $8 "
+            "WHERE id = $1",
+            schema);
+
+        values[0] = Int64GetDatum(job->id);
+        values[1] = CStringGetTextDatum(error ? "failed" : "done");
+        values[2] = Int64GetDatum((int64) stats->atoms_new);
+        values[3] = Int64GetDatum((int64) stats->compositions_new);
+        values[4] = Int64GetDatum((int64) stats->relations_new);
+        values[5] = Int64GetDatum((int64) stats->original_bytes);
+        values[6] = Int64GetDatum((int64) stats->stored_bytes);
+        if (error)
+            values[7] = CStringGetTextDatum(error);
+        else
+        {
+            values[7] = (Datum) 0;
+            nulls[7] = 'n';
+        }
+        for (int i = 2; error && i < 7; i++)
+            nulls[i] = 'n';
+
+        if (SPI_execute_with_args(sql, 8, types, values, nulls, false, 0) != SPI_OK_UPDATE)
+            elog(ERROR, "ingest worker: recording job %lld failed", (long long) job->id);
+    }
+    end_queue_txn();
+}
+
+/* Run one job through the engine; NULL on success, else the error */
+static const char *
+run_job(const IngestJob *job, HIngestionStats *stats)
+{
+    bool ok;
+
+    if (worker_db == NULL)
+    {
+        worker_db = hartonomous_db_create(ingest_conninfo[0] ? ingest_conninfo : NULL);
+        if (worker_db == NULL)
+            return pstrdup(hartonomous_get_last_error());
+    }
+    if (worker_ingester == NULL)
+    {
+        worker_ingester = hartonomous_ingester_create(worker_db);
+        if (worker_ingester == NULL)
+            return pstrdup(hartonomous_get_last_error());
+    }
+
+    pgstat_report_activity(STATE_RUNNING, job->is_file ? "ingesting file" : "ingesting text");
+    ok = job->is_file ? hartonomous_ingest_file(worker_ingester, job->payload, stats)
+                      : hartonomous_ingest_text(worker_ingester, job->payload, stats);
+    pgstat_report_activity(STATE_IDLE, NULL);
+    if (ok)
+        return NULL;
+
+    /* Start the next job from a fresh ingester */
+    {
+        char *error = pstrdup(hartonomous_get_last_error());
+
+        hartonomous_ingester_destroy(worker_ingester);
+        worker_ingester = NULL;
+        return error;
+    }
+}
+
+void
+hartonomous_ingest_worker_main(Datum main_arg)
+{
+    pqsignal(SIGHUP, SignalHandlerForConfigReload);
+    pqsignal(SIGTERM, die);
+    BackgroundWorkerUnblockSignals();
+
+    BackgroundWorkerInitializeConnection(ingest_database, NULL, 0);
+    pgstat_report_appname("hartonomous ingest worker");
+
+    requeue_orphans();
+
+    for (;;)
+    {
+        IngestJob job;
+
+        CHECK_FOR_INTERRUPTS();
+        if (ConfigReloadPending)
+        {
+            ConfigReloadPending = false;
+            ProcessConfigFile(PGC_SIGHUP);
+        }
+
+        if (claim_job(&job))
+        {
+            HIngestionStats stats;
+            const char *error;
+
+            memset(&stats, 0, sizeof(stats));
+            error = run_job(&job, &stats);
+            if (error)
+                elog(WARNING, "hartonomous ingest job %lld failed: %s", (long long) job.id, error);
+            finish_job(&job, &stats, error);
+            pfree(job.payload);
+            if (error)
+                pfree((char *) error);
+            continue;
+        }
+
+        (void) WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+                         ingest_naptime_ms, PG_WAIT_EXTENSION);
+        ResetLatch(MyLatch);
+    }
+}
@@ -0,0 +1,7 @@
+#ifndef HARTONOMOUS_INGEST_WORKER_H
+#define HARTONOMOUS_INGEST_WORKER_H
+
+/* Define the hartonomous.ingest_* GUCs and, when preloaded, register the workers */
+extern void hartonomous_ingest_init(void);
+
+#endif
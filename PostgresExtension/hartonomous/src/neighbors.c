@@ -0,0 +1,228 @@
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_type.h"
+#include "executor/spi.h"
+#include "utils/array.h"
+#include "utils/hsearch.h"
+#include "utils/lsyscache.h"
+#include "utils/uuid.h"
+#include <math.h>
+#include <string.h>
+
+/*
+ * NEIGHBORS: relation neighbors of compositions, aggregated in the backend.
+ *
+ * Two compositions are neighbors when they appear in the same relation. One
+ * pair can share many relations; each is reported once with the highest
+ * rating and the summed observations over the shared relations, the same
+ * aggregate the engine's walk, A* and Godel lookups build client-side. The
+ * join runs through a cached SPI plan on the compositionid index and rows are
+ * fetched in chunks and folded into a hash table, so the backend holds one
+ * entry per neighbor and only one row per neighbor leaves the server.
+ *
+ * When the denormalized hartonomous.compositionadjacency table exists the
+ * plan reads it instead: one primary-key range scan per composition.
+ */
+
+typedef struct NeighborKey
+{
+    pg_uuid_t source;
+    pg_uuid_t neighbor;
+} NeighborKey;
+
+typedef struct NeighborEntry
+{
+    NeighborKey key;            /* must be first */
+    double max_elo;
+    double total_obs;
+    int32 relation_count;
+} NeighborEntry;
+
+#define NEIGHBORS_FETCH_ROWS 10000
+
+static SPIPlanPtr neighbors_plan = NULL;
+
+static SPIPlanPtr
+get_neighbors_plan(void)
+{
+    if (neighbors_plan == NULL)
+    {
+        Oid argtypes[1] = {UUIDARRAYOID};
+        Oid nsp = get_namespace_oid("hartonomous", true);
+        bool adjacency = OidIsValid(nsp) && OidIsValid(get_relname_relid("compositionadjacency", nsp));
+        SPIPlanPtr plan;
+
+        if (adjacency)
+            plan = SPI_prepare(
+                "SELECT compositionid, neighborid, "
+                "       ratingvalue::float8, uint64_to_double(observations) "
+                "FROM hartonomous.compositionadjacency "
+                "WHERE compositionid = ANY($1)",
+                1, argtypes);
+        else
+            plan = SPI_prepare(
+                "SELECT rs1.compositionid, rs2.compositionid, "
+                "       rr.ratingvalue::float8, uint64_to_double(rr.observations) "
+                "FROM hartonomous.relationsequence rs1 "
+                "JOIN hartonomous.relationsequence rs2 "
+                "    ON rs2.relationid = rs1.relationid "
+                "    AND rs2.compositionid != rs1.compositionid "
+                "JOIN hartonomous.relationrating rr "
+                "    ON rr.relationid = rs1.relationid "
+                "WHERE rs1.compositionid = ANY($1)",
+                1, argtypes);
+
+        if (plan == NULL)
+            elog(ERROR, "neighbors: SPI_prepare failed: %s", SPI_result_code_string(SPI_result));
+        SPI_keepplan(plan);
+        neighbors_plan = plan;
+    }
+    return neighbors_plan;
+}
+
+/* Sources in byte order, then strongest neighbor first */
+static int
+neighbor_entry_cmp(const void *a, const void *b)
+{
+    const NeighborEntry *x = *(NeighborEntry *const *) a;
+    const NeighborEntry *y = *(NeighborEntry *const *) b;
+    int c = memcmp(&x->key.source, &y->key.source, sizeof(pg_uuid_t));
+
+    if (c != 0)
+        return c;
+    if (x->max_elo != y->max_elo)
+        return x->max_elo > y->max_elo ? -1 : 1;
+    if (x->total_obs != y->total_obs)
+        return x->total_obs > y->total_obs ? -1 : 1;
+    return memcmp(&x->key.neighbor, &y->key.neighbor, sizeof(pg_uuid_t));
+}
+
+/*
+ * Aggregate the neighbors of every composition in `sources` and emit those
+ * rated at least min_elo with at least min_obs observations, at most
+ * max_results per source (0: all). with_source adds the source as column 0.
+ */
+static void
+emit_neighbors(FunctionCallInfo fcinfo, Datum sources, double min_elo, double min_obs,
+               int32 max_results, bool with_source)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    HASHCTL ctl;
+    HTAB *agg;
+    HASH_SEQ_STATUS seq;
+    NeighborEntry *e;
+    NeighborEntry **sorted;
+    long n = 0;
+    Datum args[1] = {sources};
+    Portal portal;
+
+    if (max_results < 0)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("max_results must not be negative")));
+
+    InitMaterializedSRF(fcinfo, 0);
+
+    if (SPI_connect() != SPI_OK_CONNECT)
+        elog(ERROR, "neighbors: SPI_connect failed");
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(NeighborKey);
+    ctl.entrysize = sizeof(NeighborEntry);
+    ctl.hcxt = CurrentMemoryContext;
+    agg = hash_create("hartonomous neighbors", 1024, &ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    portal = SPI_cursor_open(NULL, get_neighbors_plan(), args, NULL, true);
+    for (;;)
+    {
+        SPI_cursor_fetch(portal, true, NEIGHBORS_FETCH_ROWS);
+        if (SPI_processed == 0)
+            break;
+
+        for (uint64 i = 0; i < SPI_processed; i++)
+        {
+            HeapTuple tup = SPI_tuptable->vals[i];
+            TupleDesc desc = SPI_tuptable->tupdesc;
+            NeighborKey key;
+            bool isnull[4];
+            Datum source = SPI_getbinval(tup, desc, 1, &isnull[0]);
+            Datum neighbor = SPI_getbinval(tup, desc, 2, &isnull[1]);
+            Datum elo = SPI_getbinval(tup, desc, 3, &isnull[2]);
+            Datum obs = SPI_getbinval(tup, desc, 4, &isnull[3]);
+            bool found;
+
+            if (isnull[0] || isnull[1] || isnull[2] || isnull[3])
+                continue;
+
+            memcpy(&key.source, DatumGetUUIDP(source), sizeof(pg_uuid_t));
+            memcpy(&key.neighbor, DatumGetUUIDP(neighbor), sizeof(pg_uuid_t));
+            e = (NeighborEntry *) hash_search(agg, &key, HASH_ENTER, &found);
+            if (!found)
+            {
+                e->max_elo = -INFINITY;
+                e->total_obs = 0.0;
+                e->relation_count = 0;
+            }
+            e->max_elo = Max(e->max_elo, DatumGetFloat8(elo));
+            e->total_obs += DatumGetFloat8(obs);
+            e->relation_count++;
+        }
+        SPI_freetuptable(SPI_tuptable);
+    }
+    SPI_cursor_close(portal);
+
+    sorted = (NeighborEntry **) palloc(sizeof(NeighborEntry *) * Max(hash_get_num_entries(agg), 1));
+    hash_seq_init(&seq, agg);
+    while ((e = (NeighborEntry *) hash_seq_search(&seq)) != NULL)
+    {
+        if (e->max_elo >= min_elo && e->total_obs >= min_obs)
+            sorted[n++] = e;
+    }
+    qsort(sorted, n, sizeof(NeighborEntry *), neighbor_entry_cmp);
+
+    for (long i = 0, taken = 0; i < n; i++)
+    {
+        Datum values[5];
+        bool nulls[5] = {false, false, false, false, false};
+        int c = 0;
+
+        if (i == 0 || memcmp(&sorted[i]->key.source, &sorted[i - 1]->key.source, sizeof(pg_uuid_t)) != 0)
+            taken = 0;
+        if (max_results > 0 && taken >= max_results)
+            continue;
+        taken++;
+
+        /* Tuplestore copies the values, so they may live in SPI memory */
+        if (with_source)
+            values[c++] = UUIDPGetDatum(&sorted[i]->key.source);
+        values[c++] = UUIDPGetDatum(&sorted[i]->key.neighbor);
+        values[c++] = Float8GetDatum(sorted[i]->max_elo);
+        values[c++] = Float8GetDatum(sorted[i]->total_obs);
+        values[c++] = Int32GetDatum(sorted[i]->relation_count);
+        tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+    }
+
+    SPI_finish();
+}
+
+PG_FUNCTION_INFO_V1(hartonomous_neighbors);
+Datum
+hartonomous_neighbors(PG_FUNCTION_ARGS)
+{
+    Datum id = PG_GETARG_DATUM(0);
+    ArrayType *sources = construct_array(&id, 1, UUIDOID, UUID_LEN, false, TYPALIGN_CHAR);
+
+    emit_neighbors(fcinfo, PointerGetDatum(sources), PG_GETARG_FLOAT8(1), PG_GETARG_FLOAT8(2),
+                   PG_GETARG_INT32(3), false);
+    return (Datum) 0;
+}
+
+PG_FUNCTION_INFO_V1(hartonomous_neighbors_batch);
+Datum
+hartonomous_neighbors_batch(PG_FUNCTION_ARGS)
+{
+    emit_neighbors(fcinfo, PG_GETARG_DATUM(0), PG_GETARG_FLOAT8(1), PG_GETARG_FLOAT8(2),
+                   PG_GETARG_INT32(3), true);
+    return (Datum) 0;
+}
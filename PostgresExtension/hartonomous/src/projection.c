@@ -0,0 +1,240 @@
+#include "postgres.h"
+#include "fmgr.h"
+#include "catalog/pg_type.h"
+#include "lib/stringinfo.h"
+#include "utils/array.h"
+#include "utils/lsyscache.h"
+#include "interop_api.h"
+#include <string.h>
+
+/*
+ * BATCH PROJECTION: whole arrays of codepoints or points per call.
+ *
+ * codepoint_to_s3() and compute_centroid() take one value per call and return
+ * WKT text that PostGIS parses again. These take and return arrays and build
+ * each geometry as EWKB handed straight to the geometry type's binary receive
+ * function, the same path binary COPY takes, so no text is formatted or
+ * parsed. The geometry type is found through the function's declared result,
+ * so nothing here depends on which schema PostGIS lives in.
+ */
+
+#define POINTZM_WKB_SIZE 37
+
+typedef struct GeometryOutput
+{
+    Oid typid;
+    int16 typlen;
+    bool typbyval;
+    char typalign;
+    Oid typioparam;
+    FmgrInfo recv;
+} GeometryOutput;
+
+/* Receive info for the geometry (element) type this function returns, cached per call site */
+static GeometryOutput *
+geometry_output(FunctionCallInfo fcinfo)
+{
+    GeometryOutput *out = (GeometryOutput *) fcinfo->flinfo->fn_extra;
+
+    if (out == NULL)
+    {
+        Oid rettype = get_func_rettype(fcinfo->flinfo->fn_oid);
+        Oid elemtype = get_element_type(rettype);
+        Oid recv;
+
+        out = (GeometryOutput *) MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(GeometryOutput));
+        out->typid = OidIsValid(elemtype) ? elemtype : rettype;
+        get_typlenbyvalalign(out->typid, &out->typlen, &out->typbyval, &out->typalign);
+        getTypeBinaryInputInfo(out->typid, &recv, &out->typioparam);
+        fmgr_info_cxt(recv, &out->recv, fcinfo->flinfo->fn_mcxt);
+        fcinfo->flinfo->fn_extra = out;
+    }
+    return out;
+}
+
+static char *
+store_le(char *p, uint64 v, int bytes)
+{
+    for (int b = 0; b < bytes; b++)
+        *p++ = (char) (v >> (8 * b));
+    return p;
+}
+
+/* Little-endian EWKB POINT ZM, SRID 0 */
+static void
+pointzm_wkb(char *p, const double coords[4])
+{
+    *p++ = 0x01;
+    p = store_le(p, 0xC0000001, 4);
+    for (int i = 0; i < 4; i++)
+    {
+        uint64 bits;
+
+        memcpy(&bits, &coords[i], sizeof(bits));
+        p = store_le(p, bits, 8);
+    }
+}
+
+static Datum
+point_datum(GeometryOutput *out, const double coords[4])
+{
+    char wkb[POINTZM_WKB_SIZE + 1];
+    StringInfoData buf;
+
+    pointzm_wkb(wkb, coords);
+    wkb[POINTZM_WKB_SIZE] = '\0';
+    buf.data = wkb;
+    buf.len = POINTZM_WKB_SIZE;
+    buf.maxlen = POINTZM_WKB_SIZE + 1;
+    buf.cursor = 0;
+    return ReceiveFunctionCall(&out->recv, &buf, out->typioparam, -1);
+}
+
+/* Codepoints of an int4[]; NULL elements are flagged and projected as 0 */
+static uint32_t *
+array_codepoints(ArrayType *arr, bool **nulls_out, int *n_out)
+{
+    Datum *elems;
+    bool *nulls;
+    int n;
+    uint32_t *cps;
+
+    deconstruct_array_builtin(arr, INT4OID, &elems, &nulls, &n);
+    cps = (uint32_t *) palloc(sizeof(uint32_t) * Max(n, 1));
+    for (int i = 0; i < n; i++)
+    {
+        int32 cp = nulls[i] ? 0 : DatumGetInt32(elems[i]);
+
+        if (cp < 0 || cp > 0x10FFFF)
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                            errmsg("invalid codepoint %d", cp)));
+        cps[i] = (uint32_t) cp;
+    }
+    pfree(elems);
+    *nulls_out = nulls;
+    *n_out = n;
+    return cps;
+}
+
+static double *
+project_codepoints(const uint32_t *cps, int n)
+{
+    double *coords = (double *) palloc(sizeof(double) * 4 * Max(n, 1));
+
+    if (n > 0 && !hartonomous_codepoints_to_s3(cps, (size_t) n, coords))
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("codepoint projection failed: %s", hartonomous_get_last_error())));
+    return coords;
+}
+
+/* One-dimensional array of geometries; nulls may be NULL */
+static Datum
+geometry_array(GeometryOutput *out, const double *coords, const bool *nulls, int n)
+{
+    Datum *values = (Datum *) palloc(sizeof(Datum) * Max(n, 1));
+    int dims[1] = {n};
+    int lbs[1] = {1};
+    ArrayType *res;
+
+    for (int i = 0; i < n; i++)
+        values[i] = (nulls && nulls[i]) ? (Datum) 0 : point_datum(out, coords + 4 * i);
+    res = construct_md_array(values, (bool *) nulls, n > 0 ? 1 : 0, dims, lbs,
+                             out->typid, out->typlen, out->typbyval, out->typalign);
+    return PointerGetDatum(res);
+}
+
+/* codepoints_to_s3(int4[]) -> geometry[]: S3 position of every codepoint */
+PG_FUNCTION_INFO_V1(codepoints_to_s3);
+Datum
+codepoints_to_s3(PG_FUNCTION_ARGS)
+{
+    GeometryOutput *out = geometry_output(fcinfo);
+    bool *nulls;
+    int n;
+    uint32_t *cps = array_codepoints(PG_GETARG_ARRAYTYPE_P(0), &nulls, &n);
+    double *coords = project_codepoints(cps, n);
+    bool any_null = false;
+
+    for (int i = 0; i < n; i++)
+        any_null |= nulls[i];
+    PG_RETURN_DATUM(geometry_array(out, coords, any_null ? nulls : NULL, n));
+}
+
+/* codepoints_centroid(int4[]) -> geometry: S3 centroid of the non-NULL codepoints */
+PG_FUNCTION_INFO_V1(codepoints_centroid);
+Datum
+codepoints_centroid(PG_FUNCTION_ARGS)
+{
+    GeometryOutput *out = geometry_output(fcinfo);
+    bool *nulls;
+    int n;
+    int kept = 0;
+    uint32_t *cps = array_codepoints(PG_GETARG_ARRAYTYPE_P(0), &nulls, &n);
+    double *coords;
+    double centroid[4];
+
+    for (int i = 0; i < n; i++)
+        if (!nulls[i])
+            cps[kept++] = cps[i];
+    if (kept == 0)
+        PG_RETURN_NULL();
+
+    coords = project_codepoints(cps, kept);
+    hartonomous_s3_compute_centroid(coords, (size_t) kept, centroid);
+    PG_RETURN_DATUM(point_datum(out, centroid));
+}
+
+/*
+ * compute_centroids(points float8[], counts int4[]) -> geometry[]: points is
+ * the flat 4-coordinate points of every group back to back, counts[g] the
+ * number of points in group g; one centroid per group (NULL for empty ones).
+ */
+PG_FUNCTION_INFO_V1(compute_centroids);
+Datum
+compute_centroids(PG_FUNCTION_ARGS)
+{
+    GeometryOutput *out = geometry_output(fcinfo);
+    ArrayType *points_arr = PG_GETARG_ARRAYTYPE_P(0);
+    ArrayType *counts_arr = PG_GETARG_ARRAYTYPE_P(1);
+    Datum *count_elems;
+    bool *count_nulls;
+    int groups;
+    int n_coords;
+    size_t *counts;
+    bool *empty;
+    bool any_empty = false;
+    int64 total = 0;
+    double *centroids;
+
+    if (ARR_HASNULL(points_arr) || ARR_HASNULL(counts_arr))
+        ereport(ERROR, (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                        errmsg("compute_centroids arrays must not contain NULLs")));
+
+    deconstruct_array_builtin(counts_arr, INT4OID, &count_elems, &count_nulls, &groups);
+    counts = (size_t *) palloc(sizeof(size_t) * Max(groups, 1));
+    empty = (bool *) palloc(sizeof(bool) * Max(groups, 1));
+    for (int g = 0; g < groups; g++)
+    {
+        int32 c = DatumGetInt32(count_elems[g]);
+
+        if (c < 0)
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                            errmsg("point counts must not be negative")));
+        counts[g] = (size_t) c;
+        empty[g] = c == 0;
+        any_empty |= empty[g];
+        total += c;
+    }
+
+    n_coords = ArrayGetNItems(ARR_NDIM(points_arr), ARR_DIMS(points_arr));
+    if ((int64) n_coords != total * 4)
+        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("points holds %d coordinates but counts sum to " INT64_FORMAT " points",
+                               n_coords, total)));
+
+    /* float8 arrays without NULLs are a packed C array */
+    centroids = (double *) palloc(sizeof(double) * 4 * Max(groups, 1));
+    hartonomous_s3_compute_centroids((const double *) ARR_DATA_PTR(points_arr), counts,
+                                     (size_t) groups, centroids);
+    PG_RETURN_DATUM(geometry_array(out, centroids, any_empty ? empty : NULL, groups));
+}
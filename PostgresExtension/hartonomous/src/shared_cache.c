@@ -0,0 +1,48 @@
+#include "postgres.h"
+#include "miscadmin.h"
+#include "utils/guc.h"
+#include "interop_api.h"
+#include "shared_cache.h"
+
+/*
+ * SHARED ENGINE CACHES: the atom image and the relation graph snapshot,
+ * mapped once in the postmaster.
+ *
+ * With the library in shared_preload_libraries, _PG_init runs in the
+ * postmaster before any backend is forked, and the engine maps and verifies
+ * both files there. Each backend and background worker inherits the
+ * read-only mappings, so all of them share one copy of the pages, and
+ * every AtomLookup or relation graph the engine builds for an unchanged
+ * file reuses the mapping instead of reading and checksumming it again.
+ * Without preloading, every engine object maps the files for itself.
+ *
+ * The engine's structures point into the mapped files, which is why these
+ * are inherited file mappings rather than a DSM segment: a DSM segment can
+ * attach at a different address in each backend.
+ */
+
+static char *atom_image_path = NULL;
+static char *relation_graph_path = NULL;
+
+void
+hartonomous_shared_cache_init(void)
+{
+    DefineCustomStringVariable("hartonomous.atom_image",
+                               "Atom image mapped once for all backends (empty: HARTONOMOUS_ATOM_IMAGE or the user cache).",
+                               NULL, &atom_image_path, "",
+                               PGC_POSTMASTER, 0, NULL, NULL, NULL);
+    DefineCustomStringVariable("hartonomous.relation_graph",
+                               "Relation graph snapshot mapped once for all backends (empty: HARTONOMOUS_RELATION_GRAPH).",
+                               NULL, &relation_graph_path, "",
+                               PGC_POSTMASTER, 0, NULL, NULL, NULL);
+
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+    /* A missing cache only costs each backend its own load; never refuse to start */
+    if (hartonomous_preload_shared_caches(atom_image_path, relation_graph_path))
+        ereport(LOG, (errmsg("hartonomous: atom image and relation graph mapped for all backends where present")));
+    else
+        ereport(WARNING, (errmsg("hartonomous: engine caches not preloaded: %s",
+                                 hartonomous_get_last_error())));
+}
@@ -0,0 +1,7 @@
+#ifndef HARTONOMOUS_SHARED_CACHE_H
+#define HARTONOMOUS_SHARED_CACHE_H
+
+/* Define the hartonomous.atom_image / relation_graph GUCs and, when preloaded, map both */
+extern void hartonomous_shared_cache_init(void);
+
+#endif
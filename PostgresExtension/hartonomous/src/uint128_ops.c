@@ -1,53 +1,299 @@
 #include "postgres.h"
 #include "fmgr.h"
-#include "varatt.h"
-#include "utils/bytea.h"
+#include "common/hashfn.h"
+#include "libpq/pqformat.h"
 #include <stdint.h>
-#include <endian.h>
+#include <string.h>
 
 /*
- * UINT128 operators using standard PostgreSQL macros
+ * UINT128: fixed 16-byte unsigned integer base type (passed by reference),
+ * used for Hilbert indices.
+ *
+ * Text form is decimal. Input also accepts '\x' followed by 32 hex digits,
+ * big-endian, the text form of the bytea domain this type replaces. Binary
+ * form is the 16 bytes big-endian, as COPY BINARY writers sent the domain.
  */
 
-PG_FUNCTION_INFO_V1(uint128_from_parts);
+typedef struct UInt128
+{
+    uint64_t hi;
+    uint64_t lo;
+} UInt128;
+
+#define UINT128_ARG(n) ((const UInt128 *) PG_GETARG_POINTER(n))
+
+static Datum
+uint128_datum(uint64_t hi, uint64_t lo)
+{
+    UInt128 *res = (UInt128 *) palloc(sizeof(UInt128));
+
+    res->hi = hi;
+    res->lo = lo;
+    return PointerGetDatum(res);
+}
+
+static int
+uint128_compare(const UInt128 *a, const UInt128 *b)
+{
+    if (a->hi != b->hi)
+        return a->hi < b->hi ? -1 : 1;
+    if (a->lo != b->lo)
+        return a->lo < b->lo ? -1 : 1;
+    return 0;
+}
+
+/* Decimal conversion works on 32-bit limbs, least significant first */
+static void
+to_limbs(const UInt128 *v, uint32_t limbs[4])
+{
+    limbs[0] = (uint32_t) v->lo;
+    limbs[1] = (uint32_t) (v->lo >> 32);
+    limbs[2] = (uint32_t) v->hi;
+    limbs[3] = (uint32_t) (v->hi >> 32);
+}
+
+static void
+from_limbs(const uint32_t limbs[4], UInt128 *v)
+{
+    v->lo = (uint64_t) limbs[1] << 32 | limbs[0];
+    v->hi = (uint64_t) limbs[3] << 32 | limbs[2];
+}
+
+/* limbs = limbs * 10 + digit; false on overflow */
+static bool
+limbs_mul10_add(uint32_t limbs[4], uint32_t digit)
+{
+    uint64_t carry = digit;
+
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t x = (uint64_t) limbs[i] * 10 + carry;
+
+        limbs[i] = (uint32_t) x;
+        carry = x >> 32;
+    }
+    return carry == 0;
+}
+
+/* limbs /= 10, returning the remainder */
+static uint32_t
+limbs_div10(uint32_t limbs[4])
+{
+    uint64_t rem = 0;
+
+    for (int i = 3; i >= 0; i--)
+    {
+        uint64_t x = rem << 32 | limbs[i];
+
+        limbs[i] = (uint32_t) (x / 10);
+        rem = x % 10;
+    }
+    return (uint32_t) rem;
+}
+
+static int
+hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+PG_FUNCTION_INFO_V1(uint128_in);
 Datum
-uint128_from_parts(PG_FUNCTION_ARGS)
+uint128_in(PG_FUNCTION_ARGS)
 {
-    uint64_t hi = htobe64((uint64_t)PG_GETARG_INT64(0));
-    uint64_t lo = htobe64((uint64_t)PG_GETARG_INT64(1));
-    bytea *res = (bytea *) palloc(16 + VARHDRSZ);
+    const char *str = PG_GETARG_CSTRING(0);
+    const char *p = str;
+    UInt128 val = {0, 0};
+
+    while (*p == ' ') p++;
+
+    if (p[0] == '\\' && p[1] == 'x')
+    {
+        int i;
+
+        p += 2;
+        for (i = 0; i < 32; i++)
+        {
+            int d = hex_digit(p[i]);
+
+            if (d < 0)
+                break;
+            val.hi = (val.hi << 4) | (val.lo >> 60);
+            val.lo = (val.lo << 4) | (uint64_t) d;
+        }
+        if (i != 32 || p[32] != '\0')
+            ereturn(fcinfo->context, (Datum) 0,
+                    (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                     errmsg("invalid input syntax for type %s: \"%s\"", "uint128", str)));
+        PG_RETURN_DATUM(uint128_datum(val.hi, val.lo));
+    }
+
+    if (*p < '0' || *p > '9')
+        ereturn(fcinfo->context, (Datum) 0,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid input syntax for type %s: \"%s\"", "uint128", str)));
+    {
+        uint32_t limbs[4] = {0, 0, 0, 0};
 
-    SET_VARSIZE(res, 16 + VARHDRSZ);
-    memcpy(VARDATA(res), &hi, 8);
-    memcpy(VARDATA(res) + 8, &lo, 8);
+        for (; *p >= '0' && *p <= '9'; p++)
+        {
+            if (!limbs_mul10_add(limbs, (uint32_t) (*p - '0')))
+                ereturn(fcinfo->context, (Datum) 0,
+                        (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+                         errmsg("value \"%s\" is out of range for type %s", str, "uint128")));
+        }
+        from_limbs(limbs, &val);
+    }
+    while (*p == ' ') p++;
+    if (*p != '\0')
+        ereturn(fcinfo->context, (Datum) 0,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid input syntax for type %s: \"%s\"", "uint128", str)));
 
-    PG_RETURN_BYTEA_P(res);
+    PG_RETURN_DATUM(uint128_datum(val.hi, val.lo));
 }
 
-PG_FUNCTION_INFO_V1(uint128_hi);
+PG_FUNCTION_INFO_V1(uint128_out);
 Datum
-uint128_hi(PG_FUNCTION_ARGS)
+uint128_out(PG_FUNCTION_ARGS)
 {
-    bytea *a = PG_GETARG_BYTEA_PP(0);
-    uint64_t val;
+    uint32_t limbs[4];
+    char digits[40];
+    int n = 0;
+    char *buf;
 
-    if (VARSIZE_ANY_EXHDR(a) != 16)
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("UINT128 must be 16 bytes")));
+    to_limbs(UINT128_ARG(0), limbs);
+    do
+    {
+        digits[n++] = (char) ('0' + limbs_div10(limbs));
+    } while (limbs[0] | limbs[1] | limbs[2] | limbs[3]);
 
-    memcpy(&val, VARDATA_ANY(a), 8);
-    PG_RETURN_INT64((int64_t)be64toh(val));
+    buf = (char *) palloc(n + 1);
+    for (int i = 0; i < n; i++)
+        buf[i] = digits[n - 1 - i];
+    buf[n] = '\0';
+    PG_RETURN_CSTRING(buf);
 }
 
-PG_FUNCTION_INFO_V1(uint128_lo);
+PG_FUNCTION_INFO_V1(uint128_recv);
 Datum
-uint128_lo(PG_FUNCTION_ARGS)
+uint128_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+    uint64_t hi = (uint64_t) pq_getmsgint64(buf);
+    uint64_t lo = (uint64_t) pq_getmsgint64(buf);
+
+    PG_RETURN_DATUM(uint128_datum(hi, lo));
+}
+
+PG_FUNCTION_INFO_V1(uint128_send);
+Datum
+uint128_send(PG_FUNCTION_ARGS)
 {
-    bytea *a = PG_GETARG_BYTEA_PP(0);
-    uint64_t val;
+    const UInt128 *v = UINT128_ARG(0);
+    StringInfoData buf;
 
-    if (VARSIZE_ANY_EXHDR(a) != 16)
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("UINT128 must be 16 bytes")));
+    pq_begintypsend(&buf);
+    pq_sendint64(&buf, (int64) v->hi);
+    pq_sendint64(&buf, (int64) v->lo);
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
 
-    memcpy(&val, VARDATA_ANY(a) + 8, 8);
-    PG_RETURN_INT64((int64_t)be64toh(val));
+/*
+ * Comparison, btree and hash support
+ */
+
+PG_FUNCTION_INFO_V1(uint128_cmp);
+Datum
+uint128_cmp(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(uint128_compare(UINT128_ARG(0), UINT128_ARG(1)));
+}
+
+#define UINT128_COMPARISON(name, op) \
+    PG_FUNCTION_INFO_V1(name); \
+    Datum \
+    name(PG_FUNCTION_ARGS) \
+    { \
+        PG_RETURN_BOOL(uint128_compare(UINT128_ARG(0), UINT128_ARG(1)) op 0); \
+    }
+
+UINT128_COMPARISON(uint128_eq, ==)
+UINT128_COMPARISON(uint128_ne, !=)
+UINT128_COMPARISON(uint128_lt, <)
+UINT128_COMPARISON(uint128_le, <=)
+UINT128_COMPARISON(uint128_gt, >)
+UINT128_COMPARISON(uint128_ge, >=)
+
+PG_FUNCTION_INFO_V1(uint128_hash);
+Datum
+uint128_hash(PG_FUNCTION_ARGS)
+{
+    return hash_any((const unsigned char *) UINT128_ARG(0), sizeof(UInt128));
+}
+
+PG_FUNCTION_INFO_V1(uint128_hash_extended);
+Datum
+uint128_hash_extended(PG_FUNCTION_ARGS)
+{
+    return hash_any_extended((const unsigned char *) UINT128_ARG(0), sizeof(UInt128), PG_GETARG_INT64(1));
+}
+
+/*
+ * Arithmetic; results outside [0, 2^128) are errors
+ */
+
+PG_FUNCTION_INFO_V1(uint128_add);
+Datum
+uint128_add(PG_FUNCTION_ARGS)
+{
+    const UInt128 *a = UINT128_ARG(0);
+    const UInt128 *b = UINT128_ARG(1);
+    uint64_t lo = a->lo + b->lo;
+    uint64_t carry = lo < a->lo;
+    uint64_t hi = a->hi + b->hi + carry;
+
+    if (hi < a->hi || (hi == a->hi && (b->hi | carry) != 0))
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint128 out of range")));
+    PG_RETURN_DATUM(uint128_datum(hi, lo));
+}
+
+PG_FUNCTION_INFO_V1(uint128_sub);
+Datum
+uint128_sub(PG_FUNCTION_ARGS)
+{
+    const UInt128 *a = UINT128_ARG(0);
+    const UInt128 *b = UINT128_ARG(1);
+
+    if (uint128_compare(a, b) < 0)
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint128 out of range")));
+    PG_RETURN_DATUM(uint128_datum(a->hi - b->hi - (a->lo < b->lo), a->lo - b->lo));
+}
+
+/*
+ * Halves, as bigint bit patterns
+ */
+
+PG_FUNCTION_INFO_V1(uint128_from_parts);
+Datum
+uint128_from_parts(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_DATUM(uint128_datum((uint64_t) PG_GETARG_INT64(0), (uint64_t) PG_GETARG_INT64(1)));
+}
+
+PG_FUNCTION_INFO_V1(uint128_hi);
+Datum
+uint128_hi(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64((int64) UINT128_ARG(0)->hi);
+}
+
+PG_FUNCTION_INFO_V1(uint128_lo);
+Datum
+uint128_lo(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64((int64) UINT128_ARG(0)->lo);
 }
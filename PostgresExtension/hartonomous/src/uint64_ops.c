@@ -1,48 +1,245 @@
 #include "postgres.h"
 #include "fmgr.h"
-#include "varatt.h"
-#include "utils/bytea.h"
+#include "common/hashfn.h"
+#include "common/int.h"
+#include "libpq/pqformat.h"
 #include <stdint.h>
-#include <endian.h>
+#include <stdio.h>
+#include <inttypes.h>
 
 /*
- * UINT64 operators using standard PostgreSQL macros
+ * UINT64: fixed 8-byte unsigned integer base type (passed by reference).
+ *
+ * Text form is decimal. Input also accepts '\x' followed by 16 hex digits,
+ * big-endian: the text form of the bytea domain this type replaces, which
+ * text COPY writers still send. Binary form is the 8 bytes big-endian, the
+ * same bytes COPY BINARY writers sent the domain.
+ */
+
+#define UINT64_ARG(n) (*(const uint64_t *) PG_GETARG_POINTER(n))
+
+static Datum
+uint64_datum(uint64_t v)
+{
+    uint64_t *res = (uint64_t *) palloc(sizeof(uint64_t));
+
+    *res = v;
+    return PointerGetDatum(res);
+}
+
+static int
+hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+PG_FUNCTION_INFO_V1(uint64_in);
+Datum
+uint64_in(PG_FUNCTION_ARGS)
+{
+    const char *str = PG_GETARG_CSTRING(0);
+    const char *p = str;
+    uint64_t val = 0;
+
+    while (*p == ' ') p++;
+
+    if (p[0] == '\\' && p[1] == 'x')
+    {
+        int i;
+
+        p += 2;
+        for (i = 0; i < 16; i++)
+        {
+            int d = hex_digit(p[i]);
+
+            if (d < 0)
+                break;
+            val = (val << 4) | (uint64_t) d;
+        }
+        if (i != 16 || p[16] != '\0')
+            ereturn(fcinfo->context, (Datum) 0,
+                    (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                     errmsg("invalid input syntax for type %s: \"%s\"", "uint64", str)));
+        PG_RETURN_DATUM(uint64_datum(val));
+    }
+
+    if (*p < '0' || *p > '9')
+        ereturn(fcinfo->context, (Datum) 0,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid input syntax for type %s: \"%s\"", "uint64", str)));
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        if (pg_mul_u64_overflow(val, 10, &val) || pg_add_u64_overflow(val, (uint64_t) (*p - '0'), &val))
+            ereturn(fcinfo->context, (Datum) 0,
+                    (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+                     errmsg("value \"%s\" is out of range for type %s", str, "uint64")));
+    }
+    while (*p == ' ') p++;
+    if (*p != '\0')
+        ereturn(fcinfo->context, (Datum) 0,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid input syntax for type %s: \"%s\"", "uint64", str)));
+
+    PG_RETURN_DATUM(uint64_datum(val));
+}
+
+PG_FUNCTION_INFO_V1(uint64_out);
+Datum
+uint64_out(PG_FUNCTION_ARGS)
+{
+    char *buf = (char *) palloc(21);
+
+    snprintf(buf, 21, "%" PRIu64, UINT64_ARG(0));
+    PG_RETURN_CSTRING(buf);
+}
+
+PG_FUNCTION_INFO_V1(uint64_recv);
+Datum
+uint64_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+
+    PG_RETURN_DATUM(uint64_datum((uint64_t) pq_getmsgint64(buf)));
+}
+
+PG_FUNCTION_INFO_V1(uint64_send);
+Datum
+uint64_send(PG_FUNCTION_ARGS)
+{
+    StringInfoData buf;
+
+    pq_begintypsend(&buf);
+    pq_sendint64(&buf, (int64) UINT64_ARG(0));
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * Comparison, btree and hash support
+ */
+
+PG_FUNCTION_INFO_V1(uint64_cmp);
+Datum
+uint64_cmp(PG_FUNCTION_ARGS)
+{
+    uint64_t a = UINT64_ARG(0);
+    uint64_t b = UINT64_ARG(1);
+
+    PG_RETURN_INT32((a > b) - (a < b));
+}
+
+#define UINT64_COMPARISON(name, op) \
+    PG_FUNCTION_INFO_V1(name); \
+    Datum \
+    name(PG_FUNCTION_ARGS) \
+    { \
+        PG_RETURN_BOOL(UINT64_ARG(0) op UINT64_ARG(1)); \
+    }
+
+UINT64_COMPARISON(uint64_eq, ==)
+UINT64_COMPARISON(uint64_ne, !=)
+UINT64_COMPARISON(uint64_lt, <)
+UINT64_COMPARISON(uint64_le, <=)
+UINT64_COMPARISON(uint64_gt, >)
+UINT64_COMPARISON(uint64_ge, >=)
+
+PG_FUNCTION_INFO_V1(uint64_hash);
+Datum
+uint64_hash(PG_FUNCTION_ARGS)
+{
+    uint64_t v = UINT64_ARG(0);
+
+    return hash_any((const unsigned char *) &v, sizeof(v));
+}
+
+PG_FUNCTION_INFO_V1(uint64_hash_extended);
+Datum
+uint64_hash_extended(PG_FUNCTION_ARGS)
+{
+    uint64_t v = UINT64_ARG(0);
+
+    return hash_any_extended((const unsigned char *) &v, sizeof(v), PG_GETARG_INT64(1));
+}
+
+/*
+ * Arithmetic; results outside [0, 2^64) are errors, as for int8
  */
 
 PG_FUNCTION_INFO_V1(uint64_add);
 Datum
 uint64_add(PG_FUNCTION_ARGS)
 {
-    bytea *a = PG_GETARG_BYTEA_PP(0);
-    bytea *b = PG_GETARG_BYTEA_PP(1);
-    uint64_t val_a, val_b, res_val;
-    bytea *res;
+    uint64_t res;
 
-    if (VARSIZE_ANY_EXHDR(a) != 8 || VARSIZE_ANY_EXHDR(b) != 8)
-        ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("UINT64 must be 8 bytes")));
+    if (pg_add_u64_overflow(UINT64_ARG(0), UINT64_ARG(1), &res))
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint64 out of range")));
+    PG_RETURN_DATUM(uint64_datum(res));
+}
 
-    memcpy(&val_a, VARDATA_ANY(a), 8);
-    memcpy(&val_b, VARDATA_ANY(b), 8);
+PG_FUNCTION_INFO_V1(uint64_sub);
+Datum
+uint64_sub(PG_FUNCTION_ARGS)
+{
+    uint64_t res;
 
-    res_val = htobe64(be64toh(val_a) + be64toh(val_b));
+    if (pg_sub_u64_overflow(UINT64_ARG(0), UINT64_ARG(1), &res))
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint64 out of range")));
+    PG_RETURN_DATUM(uint64_datum(res));
+}
 
-    res = (bytea *) palloc(8 + VARHDRSZ);
-    SET_VARSIZE(res, 8 + VARHDRSZ);
-    memcpy(VARDATA(res), &res_val, 8);
+PG_FUNCTION_INFO_V1(uint64_mul);
+Datum
+uint64_mul(PG_FUNCTION_ARGS)
+{
+    uint64_t res;
 
-    PG_RETURN_BYTEA_P(res);
+    if (pg_mul_u64_overflow(UINT64_ARG(0), UINT64_ARG(1), &res))
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint64 out of range")));
+    PG_RETURN_DATUM(uint64_datum(res));
 }
 
+/*
+ * Conversions
+ */
+
 PG_FUNCTION_INFO_V1(uint64_to_double);
 Datum
 uint64_to_double(PG_FUNCTION_ARGS)
 {
-    bytea *a = PG_GETARG_BYTEA_PP(0);
-    uint64_t val;
-    
-    if (VARSIZE_ANY_EXHDR(a) != 8)
-        PG_RETURN_FLOAT8(0.0);
+    PG_RETURN_FLOAT8((double) UINT64_ARG(0));
+}
+
+PG_FUNCTION_INFO_V1(uint64_to_bigint);
+Datum
+uint64_to_bigint(PG_FUNCTION_ARGS)
+{
+    uint64_t v = UINT64_ARG(0);
+
+    if (v > (uint64_t) PG_INT64_MAX)
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("bigint out of range")));
+    PG_RETURN_INT64((int64) v);
+}
+
+PG_FUNCTION_INFO_V1(uint64_from_bigint);
+Datum
+uint64_from_bigint(PG_FUNCTION_ARGS)
+{
+    int64 v = PG_GETARG_INT64(0);
+
+    if (v < 0)
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint64 out of range")));
+    PG_RETURN_DATUM(uint64_datum((uint64_t) v));
+}
+
+PG_FUNCTION_INFO_V1(uint64_from_int);
+Datum
+uint64_from_int(PG_FUNCTION_ARGS)
+{
+    int32 v = PG_GETARG_INT32(0);
 
-    memcpy(&val, VARDATA_ANY(a), 8);
-    PG_RETURN_FLOAT8((double)be64toh(val));
-}
\ No newline at end of file
+    if (v < 0)
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), errmsg("uint64 out of range")));
+    PG_RETURN_DATUM(uint64_datum((uint64_t) v));
+}
@@ -292,6 +292,12 @@ RETURNS float8
 LANGUAGE C IMMUTABLE STRICT
 AS 's3', 'gist_s3_distance';
 
+-- Sorted GiST build order (PostgreSQL 14+)
+CREATE OR REPLACE FUNCTION hartonomous.gist_s3_sortsupport(internal)
+RETURNS void
+LANGUAGE C IMMUTABLE STRICT
+AS 's3', 'gist_s3_sortsupport';
+
 
 -- Operators
 -- Including operators/operator_geodesic_distance_s3.sql
@@ -304,6 +310,17 @@ CREATE OPERATOR hartonomous.<=> (
 
 COMMENT ON OPERATOR hartonomous.<=> (geometry, geometry) IS
 'Geodesic distance operator for POINTZM geometries on S³.';
+-- Including operators/operator_geodesic_knn_s3.sql
+DROP OPERATOR IF EXISTS hartonomous.<@> (geometry, geometry);
+CREATE OPERATOR hartonomous.<@> (
+    LEFTARG = geometry,
+    RIGHTARG = geometry,
+    PROCEDURE = hartonomous.geodesic_distance_s3,
+    COMMUTATOR = OPERATOR(hartonomous.<@>)
+);
+
+COMMENT ON OPERATOR hartonomous.<@> (geometry, geometry) IS
+'Geodesic distance on S³ for KNN: ORDER BY centroid <@> point is an index-ordered gist_s3_ops scan.';
 -- Including operators/operator_geodesic_distance_s3_fast.sql
 DROP OPERATOR IF EXISTS hartonomous.<~> (geometry, geometry);
 CREATE OPERATOR hartonomous.<~> (
@@ -330,6 +347,7 @@ COMMENT ON OPERATOR hartonomous.<#> (geometry, geometry) IS
 CREATE OPERATOR CLASS hartonomous.gist_s3_ops
 FOR TYPE geometry USING gist AS
     OPERATOR 1 hartonomous.<=> (geometry, geometry) FOR ORDER BY pg_catalog.float_ops,
+    OPERATOR 2 hartonomous.<@> (geometry, geometry) FOR ORDER BY pg_catalog.float_ops,
     FUNCTION 1 hartonomous.gist_s3_consistent (internal, geometry, int4),
     FUNCTION 2 hartonomous.gist_s3_union (internal, internal),
     FUNCTION 3 hartonomous.gist_s3_compress (internal),
@@ -337,4 +355,5 @@ FOR TYPE geometry USING gist AS
     FUNCTION 5 hartonomous.gist_s3_penalty (internal, internal, internal),
     FUNCTION 6 hartonomous.gist_s3_picksplit (internal, internal),
     FUNCTION 7 hartonomous.gist_s3_same (internal, internal, internal),
-    FUNCTION 8 hartonomous.gist_s3_distance (internal, geometry, int4);
+    FUNCTION 8 hartonomous.gist_s3_distance (internal, geometry, int4),
+    FUNCTION 11 hartonomous.gist_s3_sortsupport (internal);
@@ -37,3 +37,9 @@ CREATE OR REPLACE FUNCTION hartonomous.gist_s3_distance(internal, geometry, int4
 RETURNS float8
 LANGUAGE C IMMUTABLE STRICT
 AS 's3', 'gist_s3_distance';
+
+-- Sorted GiST build order (PostgreSQL 14+)
+CREATE OR REPLACE FUNCTION hartonomous.gist_s3_sortsupport(internal)
+RETURNS void
+LANGUAGE C IMMUTABLE STRICT
+AS 's3', 'gist_s3_sortsupport';
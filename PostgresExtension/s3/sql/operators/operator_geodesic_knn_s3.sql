@@ -0,0 +1,10 @@
+DROP OPERATOR IF EXISTS hartonomous.<@> (geometry, geometry);
+CREATE OPERATOR hartonomous.<@> (
+    LEFTARG = geometry,
+    RIGHTARG = geometry,
+    PROCEDURE = hartonomous.geodesic_distance_s3,
+    COMMUTATOR = OPERATOR(hartonomous.<@>)
+);
+
+COMMENT ON OPERATOR hartonomous.<@> (geometry, geometry) IS
+'Geodesic distance on S³ for KNN: ORDER BY centroid <@> point is an index-ordered gist_s3_ops scan.';
\ No newline at end of file
@@ -18,6 +18,7 @@
 
 -- Operators
 \i 'operators/operator_geodesic_distance_s3.sql'
+\i 'operators/operator_geodesic_knn_s3.sql'
 \i 'operators/operator_geodesic_distance_s3_fast.sql'
 \i 'operators/operator_euclidean_distance_4d.sql'
 
@@ -4,14 +4,27 @@ extern "C" {
 #include "access/gist.h"
 #include "access/skey.h"
 #include "catalog/pg_type.h"
+#include "utils/guc.h"
+#include "utils/sortsupport.h"
 #include "utils/varlena.h"
 #include "lwgeom_pg.h"
 }
 
 #include "s3_pg_gist.hpp"
+#include "geometry/s3_bbox_split.hpp"
+#include "spatial/hilbert_curve_4d.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 extern "C" {
 
+/*
+ * In-memory key: what decompress hands the support functions, and what
+ * union and picksplit return to be compressed.
+ */
 typedef struct S3GistBBox
 {
     int32 vl_len_;   /* varlena header (required by PG) */
@@ -19,6 +32,28 @@ typedef struct S3GistBBox
     double max[4];
 } S3GistBBox;
 
+/*
+ * On-page key: float4 bounds, half the size. A box keeps min[4] then
+ * max[4], rounded outward so it still contains what it covers. A degenerate
+ * box (every leaf key) is stored as its point alone, rounded to nearest,
+ * and decompresses to the box one float4 ulp around it. Neither form is
+ * exact, so leaf matches are always rechecked against the heap tuple.
+ */
+#define S3_GIST_POINT_KEY_SIZE (VARHDRSZ + 4 * sizeof(float4))
+#define S3_GIST_BOX_KEY_SIZE   (VARHDRSZ + 8 * sizeof(float4))
+
+static float4 float4_down(double x)
+{
+    float4 f = static_cast<float4>(x);
+    return f > x ? std::nextafter(f, -INFINITY) : f;
+}
+
+static float4 float4_up(double x)
+{
+    float4 f = static_cast<float4>(x);
+    return f < x ? std::nextafter(f, INFINITY) : f;
+}
+
 static S3GistBBox* bbox_from_vec(const s3::BBox4& b)
 {
     S3GistBBox* box = reinterpret_cast<S3GistBBox*>(palloc(sizeof(S3GistBBox)));
@@ -43,38 +78,105 @@ static s3::BBox4 bbox_to_vec(const S3GistBBox* box)
     return b;
 }
 
-PG_FUNCTION_INFO_V1(gist_s3_compress);
-Datum gist_s3_compress(PG_FUNCTION_ARGS)
+static struct varlena* key_from_bbox(const s3::BBox4& b)
 {
-    GISTENTRY* entry = reinterpret_cast<GISTENTRY*>(PG_GETARG_POINTER(0));
+    bool point = true;
+    for (int i = 0; i < 4; ++i)
+        point = point && b.min[i] == b.max[i];
 
-    if (entry->leafkey)
+    float4 bounds[8];
+    Size size;
+    if (point)
     {
-        s3::Vec4 p = s3_pg::datum_to_vec4(entry->key);
-        s3::BBox4 bb = s3::bbox_from_point(p);
-        S3GistBBox* box = bbox_from_vec(bb);
-
-        GISTENTRY* retval = reinterpret_cast<GISTENTRY*>(palloc(sizeof(GISTENTRY)));
-        gistentryinit(*retval,
-                      PointerGetDatum(box),
-                      entry->rel,
-                      entry->page,
-                      entry->offset,
-                      false);
-
-        PG_RETURN_POINTER(retval);
+        for (int i = 0; i < 4; ++i)
+            bounds[i] = static_cast<float4>(b.min[i]);
+        size = S3_GIST_POINT_KEY_SIZE;
     }
     else
     {
-        PG_RETURN_POINTER(entry);
+        for (int i = 0; i < 4; ++i)
+        {
+            bounds[i] = float4_down(b.min[i]);
+            bounds[4 + i] = float4_up(b.max[i]);
+        }
+        size = S3_GIST_BOX_KEY_SIZE;
     }
+
+    struct varlena* key = reinterpret_cast<struct varlena*>(palloc(size));
+    SET_VARSIZE(key, size);
+    std::memcpy(VARDATA(key), bounds, size - VARHDRSZ);
+    return key;
+}
+
+/*
+ * Keys read off a page may carry a short varlena header, so they are read
+ * through VARDATA_ANY.
+ */
+static s3::BBox4 bbox_from_key(Datum datum)
+{
+    struct varlena* key = pg_detoast_datum_packed(reinterpret_cast<struct varlena*>(DatumGetPointer(datum)));
+    float4 bounds[8];
+    Size size = VARSIZE_ANY_EXHDR(key);
+    std::memcpy(bounds, VARDATA_ANY(key), size);
+    if (reinterpret_cast<Pointer>(key) != DatumGetPointer(datum))
+        pfree(key);
+
+    s3::BBox4 b;
+    if (size == S3_GIST_POINT_KEY_SIZE - VARHDRSZ)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            b.min[i] = std::nextafter(bounds[i], -INFINITY);
+            b.max[i] = std::nextafter(bounds[i], INFINITY);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            b.min[i] = bounds[i];
+            b.max[i] = bounds[4 + i];
+        }
+    }
+    return b;
+}
+
+PG_FUNCTION_INFO_V1(gist_s3_compress);
+Datum gist_s3_compress(PG_FUNCTION_ARGS)
+{
+    GISTENTRY* entry = reinterpret_cast<GISTENTRY*>(PG_GETARG_POINTER(0));
+
+    s3::BBox4 bb;
+    if (entry->leafkey)
+        bb = s3::bbox_from_point(s3_pg::datum_to_vec4(entry->key));
+    else
+        bb = bbox_to_vec(reinterpret_cast<S3GistBBox*>(DatumGetPointer(entry->key)));
+
+    GISTENTRY* retval = reinterpret_cast<GISTENTRY*>(palloc(sizeof(GISTENTRY)));
+    gistentryinit(*retval,
+                  PointerGetDatum(key_from_bbox(bb)),
+                  entry->rel,
+                  entry->page,
+                  entry->offset,
+                  false);
+
+    PG_RETURN_POINTER(retval);
 }
 
 PG_FUNCTION_INFO_V1(gist_s3_decompress);
 Datum gist_s3_decompress(PG_FUNCTION_ARGS)
 {
     GISTENTRY* entry = reinterpret_cast<GISTENTRY*>(PG_GETARG_POINTER(0));
-    PG_RETURN_POINTER(entry);
+
+    GISTENTRY* retval = reinterpret_cast<GISTENTRY*>(palloc(sizeof(GISTENTRY)));
+    gistentryinit(*retval,
+                  PointerGetDatum(bbox_from_vec(bbox_from_key(entry->key))),
+                  entry->rel,
+                  entry->page,
+                  entry->offset,
+                  false);
+
+    PG_RETURN_POINTER(retval);
 }
 
 PG_FUNCTION_INFO_V1(gist_s3_consistent);
@@ -85,7 +187,7 @@ Datum gist_s3_consistent(PG_FUNCTION_ARGS)
     StrategyNumber strategy = static_cast<StrategyNumber>(PG_GETARG_UINT16(2));
     bool* recheck = reinterpret_cast<bool*>(PG_GETARG_POINTER(4));
 
-    *recheck = true;
+    *recheck = true;  /* Leaf keys are float4-rounded */
 
     S3GistBBox* box = reinterpret_cast<S3GistBBox*>(DatumGetPointer(entry->key));
     s3::BBox4 bb = bbox_to_vec(box);
@@ -163,105 +265,63 @@ Datum gist_s3_penalty(PG_FUNCTION_ARGS)
     PG_RETURN_VOID();
 }
 
+/*
+ * s3.gist_split: how overfull pages split. rstar (the default) balances
+ * the halves and keeps their boxes apart, which is what KNN scans pay
+ * for; midpoint is the original split.
+ */
+static int s3_gist_split = static_cast<int>(s3::SplitMethod::RStar);
+
+static const struct config_enum_entry s3_gist_split_options[] = {
+    {"midpoint", static_cast<int>(s3::SplitMethod::Midpoint), false},
+    {"rstar", static_cast<int>(s3::SplitMethod::RStar), false},
+    {"hilbert", static_cast<int>(s3::SplitMethod::Hilbert), false},
+    {nullptr, 0, false}
+};
+
+void s3_gist_define_gucs(void)
+{
+    DefineCustomEnumVariable("s3.gist_split",
+                             "Node split algorithm for gist_s3_ops.",
+                             "midpoint, rstar (R*-tree) or hilbert.",
+                             &s3_gist_split,
+                             static_cast<int>(s3::SplitMethod::RStar),
+                             s3_gist_split_options,
+                             PGC_USERSET,
+                             0,
+                             nullptr, nullptr, nullptr);
+}
+
 PG_FUNCTION_INFO_V1(gist_s3_picksplit);
 Datum gist_s3_picksplit(PG_FUNCTION_ARGS)
 {
     GistEntryVector* entryvec = reinterpret_cast<GistEntryVector*>(PG_GETARG_POINTER(0));
     GIST_SPLITVEC* v          = reinterpret_cast<GIST_SPLITVEC*>(PG_GETARG_POINTER(1));
 
-    int n = entryvec->n;
-
-    double min_vals[4] = {1e300, 1e300, 1e300, 1e300};
-    double max_vals[4] = {-1e300, -1e300, -1e300, -1e300};
+    /* Entries are vector[FirstOffsetNumber .. n - 1] */
+    OffsetNumber maxoff = entryvec->n - 1;
+    int n = maxoff;
 
-    for (int i = FirstOffsetNumber; i <= n; ++i)
+    std::vector<s3::BBox4> boxes;
+    boxes.reserve(n);
+    for (OffsetNumber i = FirstOffsetNumber; i <= maxoff; ++i)
     {
-        GISTENTRY* e = &entryvec->vector[i - 1];
-        S3GistBBox* box = reinterpret_cast<S3GistBBox*>(DatumGetPointer(e->key));
-
-        for (int d = 0; d < 4; ++d)
-        {
-            double center = (box->min[d] + box->max[d]) / 2.0;
-            if (center < min_vals[d]) min_vals[d] = center;
-            if (center > max_vals[d]) max_vals[d] = center;
-        }
-    }
-
-    int split_dim = 0;
-    double max_spread = 0.0;
-    for (int d = 0; d < 4; ++d)
-    {
-        double spread = max_vals[d] - min_vals[d];
-        if (spread > max_spread)
-        {
-            max_spread = spread;
-            split_dim = d;
-        }
+        GISTENTRY* e = &entryvec->vector[i];
+        boxes.push_back(bbox_to_vec(reinterpret_cast<S3GistBBox*>(DatumGetPointer(e->key))));
     }
 
-    double split_val = (min_vals[split_dim] + max_vals[split_dim]) / 2.0;
+    s3::BBoxSplit split = s3::split_bboxes(boxes, static_cast<s3::SplitMethod>(s3_gist_split));
 
     v->spl_left  = reinterpret_cast<OffsetNumber*>(palloc(n * sizeof(OffsetNumber)));
     v->spl_right = reinterpret_cast<OffsetNumber*>(palloc(n * sizeof(OffsetNumber)));
     v->spl_nleft = 0;
     v->spl_nright = 0;
 
-    s3::BBox4 left_union, right_union;
-    bool left_first = true, right_first = true;
+    for (int i : split.left) v->spl_left[v->spl_nleft++] = i + FirstOffsetNumber;
+    for (int i : split.right) v->spl_right[v->spl_nright++] = i + FirstOffsetNumber;
 
-    for (int i = FirstOffsetNumber; i <= n; ++i)
-    {
-        GISTENTRY* e = &entryvec->vector[i - 1];
-        S3GistBBox* box = reinterpret_cast<S3GistBBox*>(DatumGetPointer(e->key));
-        s3::BBox4 bb = bbox_to_vec(box);
-
-        double center = (box->min[split_dim] + box->max[split_dim]) / 2.0;
-
-        if (center < split_val)
-        {
-            v->spl_left[v->spl_nleft++] = i;
-            if (left_first)
-            {
-                left_union = bb;
-                left_first = false;
-            }
-            else
-            {
-                left_union = s3::bbox_union(left_union, bb);
-            }
-        }
-        else
-        {
-            v->spl_right[v->spl_nright++] = i;
-            if (right_first)
-            {
-                right_union = bb;
-                right_first = false;
-            }
-            else
-            {
-                right_union = s3::bbox_union(right_union, bb);
-            }
-        }
-    }
-
-    if (v->spl_nleft == 0)
-    {
-        v->spl_left[v->spl_nleft++] = v->spl_right[--v->spl_nright];
-        S3GistBBox* box = reinterpret_cast<S3GistBBox*>(
-            DatumGetPointer(entryvec->vector[v->spl_left[0] - 1].key));
-        left_union = bbox_to_vec(box);
-    }
-    if (v->spl_nright == 0)
-    {
-        v->spl_right[v->spl_nright++] = v->spl_left[--v->spl_nleft];
-        S3GistBBox* box = reinterpret_cast<S3GistBBox*>(
-            DatumGetPointer(entryvec->vector[v->spl_right[0] - 1].key));
-        right_union = bbox_to_vec(box);
-    }
-
-    v->spl_ldatum = PointerGetDatum(bbox_from_vec(left_union));
-    v->spl_rdatum = PointerGetDatum(bbox_from_vec(right_union));
+    v->spl_ldatum = PointerGetDatum(bbox_from_vec(split.left_box));
+    v->spl_rdatum = PointerGetDatum(bbox_from_vec(split.right_box));
 
     PG_RETURN_POINTER(v);
 }
@@ -286,6 +346,12 @@ Datum gist_s3_same(PG_FUNCTION_ARGS)
     PG_RETURN_VOID();
 }
 
+/*
+ * ORDER BY support for <=> and <@>, both geodesic. A unit point p inside
+ * the box is at least the box's chord distance d from the unit query, and
+ * chord d subtends the arc 2 asin(d / 2): a lower bound on the geodesic
+ * distance to anything the entry covers, as KNN scans require.
+ */
 PG_FUNCTION_INFO_V1(gist_s3_distance);
 Datum gist_s3_distance(PG_FUNCTION_ARGS)
 {
@@ -293,16 +359,85 @@ Datum gist_s3_distance(PG_FUNCTION_ARGS)
     Datum query      = PG_GETARG_DATUM(1);
     bool* recheck    = reinterpret_cast<bool*>(PG_GETARG_POINTER(4));
 
-    *recheck = true;
+    *recheck = true;  /* Leaf keys are float4-rounded */
 
     S3GistBBox* box = reinterpret_cast<S3GistBBox*>(DatumGetPointer(entry->key));
     s3::BBox4 bb = bbox_to_vec(box);
 
     s3::Vec4 qp = s3_pg::datum_to_vec4(query);
 
-    double d = s3::distance_point_bbox(qp, bb);
+    double chord = s3::distance_point_bbox(qp, bb);
+
+    PG_RETURN_FLOAT8(2.0 * std::asin(std::min(1.0, chord / 2.0)));
+}
+
+/*
+ * Sorted build (PostgreSQL 14+): leaf keys are sorted by the Hilbert index
+ * of their box centre and packed into pages bottom-up, instead of each
+ * being inserted by penalty-driven descent. Hilbert order keeps neighbours
+ * on S3 in the same and adjacent pages.
+ *
+ * The comparator sees compressed keys as stored in index tuples.
+ */
+static hartonomous::spatial::HilbertCurve4D::HilbertIndex bbox_hilbert(Datum key)
+{
+    s3::BBox4 b = bbox_from_key(key);
 
-    PG_RETURN_FLOAT8(d);
+    /* Box centre, from [-1, 1] to the unit hypercube */
+    hartonomous::spatial::HilbertCurve4D::Vec4 c;
+    for (int d = 0; d < 4; ++d)
+        c[d] = ((b.min[d] + b.max[d]) / 2.0 + 1.0) / 2.0;
+    return hartonomous::spatial::HilbertCurve4D::encode(c);
+}
+
+static int gist_s3_cmp_full(Datum a, Datum b, SortSupport ssup)
+{
+    auto ha = bbox_hilbert(a);
+    auto hb = bbox_hilbert(b);
+    /* Big-endian, so byte order is numeric order */
+    int c = std::memcmp(ha.data(), hb.data(), ha.size());
+    return (c > 0) - (c < 0);
+}
+
+/* Abbreviated key: the index's high 64 bits */
+static Datum gist_s3_abbrev_convert(Datum original, SortSupport ssup)
+{
+    auto h = bbox_hilbert(original);
+    uint64 hi = 0;
+    for (int i = 0; i < 8; ++i)
+        hi = (hi << 8) | h[i];
+    return static_cast<Datum>(hi);
+}
+
+static int gist_s3_cmp_abbrev(Datum a, Datum b, SortSupport ssup)
+{
+    uint64 x = static_cast<uint64>(a);
+    uint64 y = static_cast<uint64>(b);
+    return (x > y) - (x < y);
+}
+
+static bool gist_s3_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+    return false;
+}
+
+PG_FUNCTION_INFO_V1(gist_s3_sortsupport);
+Datum gist_s3_sortsupport(PG_FUNCTION_ARGS)
+{
+    SortSupport ssup = reinterpret_cast<SortSupport>(PG_GETARG_POINTER(0));
+
+    if (ssup->abbreviate && sizeof(Datum) >= sizeof(uint64))
+    {
+        ssup->comparator = gist_s3_cmp_abbrev;
+        ssup->abbrev_converter = gist_s3_abbrev_convert;
+        ssup->abbrev_abort = gist_s3_abbrev_abort;
+        ssup->abbrev_full_comparator = gist_s3_cmp_full;
+    }
+    else
+    {
+        ssup->comparator = gist_s3_cmp_full;
+    }
+    PG_RETURN_VOID();
 }
 
 }
@@ -20,5 +20,9 @@ PGDLLEXPORT Datum gist_s3_penalty(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum gist_s3_picksplit(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum gist_s3_same(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum gist_s3_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum gist_s3_sortsupport(PG_FUNCTION_ARGS);
+
+/* Registers s3.gist_split; called from _PG_init */
+void s3_gist_define_gucs(void);
 
 }
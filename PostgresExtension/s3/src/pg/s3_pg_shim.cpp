@@ -6,11 +6,18 @@ extern "C" {
 
 #include "geometry/s3_distance.hpp"
 #include "s3_pg_geom.hpp"
+#include "s3_pg_gist.hpp"
 
 extern "C" {
 
 PG_MODULE_MAGIC;
 
+PGDLLEXPORT void _PG_init(void);
+void _PG_init(void)
+{
+    s3_gist_define_gucs();
+}
+
 PG_FUNCTION_INFO_V1(geodesic_distance_s3_c);
 Datum geodesic_distance_s3_c(PG_FUNCTION_ARGS)
 {
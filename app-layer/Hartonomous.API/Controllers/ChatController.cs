@@ -43,6 +43,7 @@ public class ChatController : ControllerBase
         var temperature = request.Temperature ?? 0.7;
         var maxTokens = request.MaxTokens ?? 200;
         var stopText = request.Stop is string s ? s : null;
+        var seed = request.Seed ?? 0;
         var requestId = $"hart-{Guid.NewGuid():N}";
 
         // Extract system prompt context for goal-directed walks
@@ -53,17 +54,17 @@ public class ChatController : ControllerBase
         }
 
         if (request.Stream)
-            return await StreamCompletion(requestId, prompt, temperature, maxTokens, stopText);
+            return await StreamCompletion(requestId, prompt, temperature, maxTokens, stopText, seed);
 
-        return NonStreamCompletion(requestId, prompt, temperature, maxTokens, stopText);
+        return NonStreamCompletion(requestId, prompt, temperature, maxTokens, stopText, seed);
     }
 
     private IActionResult NonStreamCompletion(string requestId, string prompt,
-        double temperature, int maxTokens, string? stopText)
+        double temperature, int maxTokens, string? stopText, ulong seed)
     {
         try
         {
-            var output = _walk.Generate(prompt, temperature, maxTokens, stopText: stopText);
+            var output = _walk.Generate(prompt, temperature, maxTokens, stopText: stopText, seed: seed);
 
             var response = new ChatCompletionResponse
             {
@@ -95,7 +96,7 @@ public class ChatController : ControllerBase
     }
 
     private async Task<IActionResult> StreamCompletion(string requestId, string prompt,
-        double temperature, int maxTokens, string? stopText)
+        double temperature, int maxTokens, string? stopText, ulong seed)
     {
         Response.ContentType = "text/event-stream";
         Response.Headers.CacheControl = "no-cache";
@@ -135,7 +136,7 @@ public class ChatController : ControllerBase
                             }
                         ],
                     };
-                    // Sync write — the callback is called from C++ thread via P/Invoke
+                    // Sync write — fragments are drained and dispatched on this request thread
                     var json = JsonSerializer.Serialize(chunk, s_jsonOptions);
                     var bytes = Encoding.UTF8.GetBytes($"data: {json}\n\n");
                     Response.Body.Write(bytes);
@@ -143,7 +144,8 @@ public class ChatController : ControllerBase
                 },
                 temperature: temperature,
                 maxTokens: maxTokens,
-                stopText: stopText);
+                stopText: stopText,
+                seed: seed);
 
             lastFinishReason = MapFinishReason(output.FinishReason);
 
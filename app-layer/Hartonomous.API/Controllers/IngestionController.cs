@@ -52,4 +52,18 @@ public class IngestionController : ControllerBase
             return StatusCode(500, new { error = ex.Message });
         }
     }
+
+    [HttpGet("progress")]
+    public IActionResult Progress()
+    {
+        try
+        {
+            return Ok(_ingestion.Progress());
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Progress query failed");
+            return StatusCode(500, new { error = ex.Message });
+        }
+    }
 }
@@ -0,0 +1,18 @@
+using Hartonomous.Core.Services;
+using Microsoft.AspNetCore.Mvc;
+
+namespace Hartonomous.API.Controllers;
+
+/// <summary>
+/// Native engine metrics for Prometheus (or an OpenTelemetry collector's Prometheus receiver).
+/// </summary>
+[ApiController]
+[Route("metrics")]
+public class MetricsController : ControllerBase
+{
+    [HttpGet("engine")]
+    public IActionResult Engine()
+    {
+        return Content(EngineService.MetricsText(), "text/plain; version=0.0.4; charset=utf-8");
+    }
+}
@@ -14,13 +14,19 @@ public class Program
         var connString = builder.Configuration.GetConnectionString("DefaultConnection")
             ?? throw new InvalidOperationException("ConnectionStrings:DefaultConnection is required.");
 
+        var shareGraph = builder.Configuration.GetValue<bool>("Engine:ShareRelationGraph");
         builder.Services.AddSingleton(sp =>
-            new EngineService(connString, sp.GetRequiredService<ILogger<EngineService>>()));
+        {
+            var engine = new EngineService(connString, sp.GetRequiredService<ILogger<EngineService>>());
+            if (shareGraph) engine.ShareRelationGraph();
+            return engine;
+        });
             
         // Domain services
         builder.Services.AddSingleton<IDomainRegistry, StaticDomainRegistry>();
 
-        // Walk, Query, Ingestion services — singleton (they hold native handles)
+        // Walk, Query, Ingestion services — singleton; walk and query handles serve
+        // concurrent requests (each call checks out its own native engine instance)
         builder.Services.AddSingleton(sp =>
             new WalkService(sp.GetRequiredService<EngineService>(), sp.GetRequiredService<ILogger<WalkService>>()));
         builder.Services.AddSingleton(sp =>
@@ -23,8 +23,36 @@ public sealed class EngineService : NativeHandle
 
     public bool IsConnected => NativeMethods.DbIsConnected(RawHandle);
 
+    /// <summary>
+    /// Load one live relation graph that every walk and reasoning call reads.
+    /// </summary>
+    public void ShareRelationGraph()
+    {
+        if (!NativeMethods.DbShareRelationGraph(RawHandle))
+            throw new InvalidOperationException($"Relation graph load failed: {GetNativeError()}");
+        _logger.LogInformation("Relation graph shared by all engine handles");
+    }
+
     public static string GetLastError() => GetNativeError();
 
+    /// <summary>
+    /// Engine counters, histograms and spans in Prometheus text format.
+    /// </summary>
+    public static string MetricsText()
+    {
+        var ptr = NativeMethods.MetricsPrometheus();
+        if (ptr == IntPtr.Zero)
+            throw new InvalidOperationException($"Metrics failed: {GetNativeError()}");
+        try
+        {
+            return System.Runtime.InteropServices.Marshal.PtrToStringUTF8(ptr) ?? string.Empty;
+        }
+        finally
+        {
+            NativeMethods.FreeString(ptr);
+        }
+    }
+
     protected override void DestroyNative(IntPtr handle)
     {
         NativeMethods.DbDestroy(handle);
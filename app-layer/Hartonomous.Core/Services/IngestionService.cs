@@ -34,6 +34,28 @@ public sealed class IngestionService : NativeService
         return MapStats(stats);
     }
 
+    /// <summary>
+    /// Progress of the running (or last) ingestion; may be called while one is in flight.
+    /// </summary>
+    public IngestionProgressOutput Progress()
+    {
+        var p = InvokeNative((IntPtr h, out IngestProgress s) =>
+            NativeMethods.IngesterGetProgress(h, out s), "Progress query failed");
+
+        return new IngestionProgressOutput
+        {
+            Phase = p.Phase ?? string.Empty,
+            BytesDone = (long)p.BytesDone,
+            BytesTotal = (long)p.BytesTotal,
+            Records = (long)p.Records,
+            ElapsedSec = p.ElapsedSec,
+            BytesPerSec = p.BytesPerSec,
+            RecordsPerSec = p.RecordsPerSec,
+            EtaSec = p.EtaSec >= 0 ? p.EtaSec : null,
+            Finished = p.Finished,
+        };
+    }
+
     private static IngestionOutput MapStats(IngestionStats stats) => new()
     {
         AtomsTotal = (long)stats.AtomsTotal,
@@ -75,3 +97,16 @@ public sealed class IngestionOutput
     public long CooccurrencesFound { get; init; }
     public long CooccurrencesSignificant { get; init; }
 }
+
+public sealed class IngestionProgressOutput
+{
+    public string Phase { get; init; } = string.Empty;
+    public long BytesDone { get; init; }
+    public long BytesTotal { get; init; }
+    public long Records { get; init; }
+    public double ElapsedSec { get; init; }
+    public double BytesPerSec { get; init; }
+    public double RecordsPerSec { get; init; }
+    public double? EtaSec { get; init; }
+    public bool Finished { get; init; }
+}
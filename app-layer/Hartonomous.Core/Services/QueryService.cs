@@ -1,4 +1,5 @@
 using System.Runtime.InteropServices;
+using System.Text;
 using Hartonomous.Marshal;
 using Microsoft.Extensions.Logging;
 
@@ -8,7 +9,7 @@ namespace Hartonomous.Core.Services;
 /// Wraps SemanticQuery — gravitational truth, co-occurrence, Q&A.
 /// All heavy lifting in C++.
 /// </summary>
-public sealed class QueryService : NativeService
+public sealed unsafe class QueryService : NativeService
 {
     private readonly EngineService _engine;
     private readonly ILogger<QueryService> _logger;
@@ -20,20 +21,36 @@ public sealed class QueryService : NativeService
         _logger = logger;
     }
 
-    public List<QueryOutput> FindRelated(string text, int limit = 10)
+    public List<QueryOutput> FindRelated(string text, int limit = 10) => FindRelatedBatch([text], limit)[0];
+
+    public List<QueryOutput> FindGravitationalTruth(string text, double minElo = 1500.0, int limit = 10)
+        => FindGravitationalTruthBatch([text], minElo, limit)[0];
+
+    public List<QueryOutput> FindNearest(string text, int limit = 10) => FindNearestBatch([text], limit)[0];
+
+    /// <summary>FindRelated of every text in one native call; results in input order.</summary>
+    public List<List<QueryOutput>> FindRelatedBatch(string[] texts, int limit = 10)
     {
-        if (!NativeMethods.QueryRelated(RawHandle, text, (nuint)limit, out var resultsPtr, out var count))
+        if (!NativeMethods.QueryRelatedBatch(RawHandle, texts, (nuint)texts.Length, (nuint)limit, out var set))
             throw new InvalidOperationException($"Query failed: {GetNativeError()}");
 
-        return MarshalResults(resultsPtr, count);
+        return ReadResultSet(set);
     }
 
-    public List<QueryOutput> FindGravitationalTruth(string text, double minElo = 1500.0, int limit = 10)
+    public List<List<QueryOutput>> FindNearestBatch(string[] texts, int limit = 10)
     {
-        if (!NativeMethods.QueryTruth(RawHandle, text, minElo, (nuint)limit, out var resultsPtr, out var count))
+        if (!NativeMethods.QueryNearestBatch(RawHandle, texts, (nuint)texts.Length, (nuint)limit, out var set))
+            throw new InvalidOperationException($"Nearest query failed: {GetNativeError()}");
+
+        return ReadResultSet(set);
+    }
+
+    public List<List<QueryOutput>> FindGravitationalTruthBatch(string[] texts, double minElo = 1500.0, int limit = 10)
+    {
+        if (!NativeMethods.QueryTruthBatch(RawHandle, texts, (nuint)texts.Length, minElo, (nuint)limit, out var set))
             throw new InvalidOperationException($"Truth query failed: {GetNativeError()}");
 
-        return MarshalResults(resultsPtr, count);
+        return ReadResultSet(set);
     }
 
     public QueryOutput? AnswerQuestion(string question)
@@ -48,29 +65,35 @@ public sealed class QueryService : NativeService
         return new QueryOutput { Text = text, Confidence = result.Confidence };
     }
 
-    private static List<QueryOutput> MarshalResults(IntPtr resultsPtr, nuint count)
+    // Decodes straight from the native block, then frees it with one call
+    private static List<List<QueryOutput>> ReadResultSet(ResultSet* set)
     {
-        var outputs = new List<QueryOutput>((int)count);
-        if (resultsPtr == IntPtr.Zero || count == 0) return outputs;
-
         try
         {
-            var size = System.Runtime.InteropServices.Marshal.SizeOf<QueryResult>();
-            for (var i = 0; i < (int)count; i++)
+            var queries = new List<List<QueryOutput>>((int)set->QueryCount);
+            for (var q = 0; q < (int)set->QueryCount; q++)
             {
-                var r = System.Runtime.InteropServices.Marshal.PtrToStructure<QueryResult>(resultsPtr + i * size);
-                var text = r.Text != IntPtr.Zero
-                    ? System.Runtime.InteropServices.Marshal.PtrToStringAnsi(r.Text) ?? ""
-                    : "";
-                outputs.Add(new QueryOutput { Text = text, Confidence = r.Confidence });
+                var begin = (int)set->QueryOffsets[q];
+                var end = (int)set->QueryOffsets[q + 1];
+                var outputs = new List<QueryOutput>(end - begin);
+                for (var i = begin; i < end; i++)
+                {
+                    var off = set->TextOffsets[i];
+                    var len = (int)(set->TextOffsets[i + 1] - off - 1);
+                    outputs.Add(new QueryOutput
+                    {
+                        Text = Encoding.UTF8.GetString(set->Text + off, len),
+                        Confidence = set->Confidences[i]
+                    });
+                }
+                queries.Add(outputs);
             }
+            return queries;
         }
         finally
         {
-            NativeMethods.QueryFreeResults(resultsPtr, count);
+            NativeMethods.ResultSetFree(set);
         }
-
-        return outputs;
     }
 
     protected override void DestroyNative(IntPtr handle)
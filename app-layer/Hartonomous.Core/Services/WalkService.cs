@@ -1,3 +1,4 @@
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 using System.Text;
 using Hartonomous.Marshal;
@@ -22,7 +23,7 @@ public sealed class WalkService : NativeService
     }
 
     public unsafe GenerationOutput Generate(string prompt, double temperature = 0.7,
-        int maxTokens = 200, double energyDecay = 0.05, string? stopText = null)
+        int maxTokens = 200, double energyDecay = 0.05, string? stopText = null, ulong seed = 0)
     {
         var gp = new GenerateParams
         {
@@ -31,6 +32,7 @@ public sealed class WalkService : NativeService
             EnergyDecay = energyDecay,
             TopP = 1.0,
             N = 1,
+            Seed = seed,
         };
 
         if (stopText != null)
@@ -69,10 +71,11 @@ public sealed class WalkService : NativeService
     }
 
     /// <summary>
-    /// Streaming generation — calls onFragment for each walk step.
+    /// Streaming generation — calls onFragment for each walk step, on the calling thread.
     /// </summary>
     public unsafe GenerationOutput GenerateStream(string prompt, Action<string, int, double> onFragment,
-        double temperature = 0.7, int maxTokens = 200, double energyDecay = 0.05, string? stopText = null)
+        double temperature = 0.7, int maxTokens = 200, double energyDecay = 0.05, string? stopText = null,
+        ulong seed = 0)
     {
         var gp = new GenerateParams
         {
@@ -81,6 +84,7 @@ public sealed class WalkService : NativeService
             EnergyDecay = energyDecay,
             TopP = 1.0,
             N = 1,
+            Seed = seed,
         };
 
         if (stopText != null)
@@ -91,39 +95,85 @@ public sealed class WalkService : NativeService
             gp.StopText[len] = 0;
         }
 
-        // Pin the callback delegate to prevent GC
-        NativeMethods.GenerateCallback callback = (fragment, step, energy, _) =>
+        // The walk runs on its own thread and writes fragments into a token ring;
+        // this thread drains whole frames in bulk, with no call back from native code
+        var stream = NativeMethods.TokenStreamCreate(StreamBytes);
+        if (stream == IntPtr.Zero)
+            throw new InvalidOperationException($"Token stream creation failed: {GetNativeError()}");
+
+        GenerateResult result = default;
+        string? error = null;
+        var walk = Task.Factory.StartNew(() =>
         {
-            onFragment(fragment, (int)step, energy);
-            return true;
-        };
+            if (!NativeMethods.GenerateStreamRing(RawHandle, _engine.DbHandle, prompt, ref gp, stream, out result))
+                error = GetNativeError();
+        }, TaskCreationOptions.LongRunning);
+
+        var buffer = new byte[StreamBytes];
+        try
+        {
+            fixed (byte* frames = buffer)
+            {
+                while (true)
+                {
+                    nuint bytes;
+                    while ((bytes = NativeMethods.TokenStreamRead(stream, frames, (nuint)buffer.Length)) != 0)
+                        DispatchFrames(buffer.AsSpan(0, (int)bytes), onFragment);
+                    if (NativeMethods.TokenStreamFinished(stream)) break;
+                    NativeMethods.TokenStreamWait(stream, 100);
+                }
+            }
+        }
+        finally
+        {
+            // A throwing onFragment (client gone) stops the walk at its next fragment
+            NativeMethods.TokenStreamCancel(stream);
+            walk.Wait();
+            NativeMethods.TokenStreamDestroy(stream);
+        }
 
-        if (!NativeMethods.GenerateStream(RawHandle, _engine.DbHandle, prompt, ref gp,
-                callback, IntPtr.Zero, out var result))
-            throw new InvalidOperationException($"Streaming generation failed: {GetNativeError()}");
+        if (error != null)
+            throw new InvalidOperationException($"Streaming generation failed: {error}");
 
+        // A local copy: the closure's field cannot be addressed without pinning
+        var done = result;
         try
         {
             var finishReason = System.Runtime.InteropServices.Marshal.PtrToStringAnsi(
-                (IntPtr)result.FinishReason) ?? "unknown";
+                (IntPtr)done.FinishReason) ?? "unknown";
 
-            var text = result.Text != IntPtr.Zero
-                ? System.Runtime.InteropServices.Marshal.PtrToStringAnsi(result.Text) ?? ""
+            var text = done.Text != IntPtr.Zero
+                ? System.Runtime.InteropServices.Marshal.PtrToStringAnsi(done.Text) ?? ""
                 : "";
 
             return new GenerationOutput
             {
                 Text = text,
-                Steps = (int)result.Steps,
-                TotalEnergyUsed = result.TotalEnergyUsed,
+                Steps = (int)done.Steps,
+                TotalEnergyUsed = done.TotalEnergyUsed,
                 FinishReason = finishReason,
             };
         }
         finally
         {
-            if (result.Text != IntPtr.Zero)
-                NativeMethods.FreeString(result.Text);
-            GC.KeepAlive(callback);
+            if (done.Text != IntPtr.Zero)
+                NativeMethods.FreeString(done.Text);
+        }
+    }
+
+    // Token ring and drain buffer size: a few hundred words in flight per stream
+    private const int StreamBytes = 16 * 1024;
+
+    private static void DispatchFrames(ReadOnlySpan<byte> frames, Action<string, int, double> onFragment)
+    {
+        var headerSize = Unsafe.SizeOf<TokenFrame>();
+        while (!frames.IsEmpty)
+        {
+            var frame = MemoryMarshal.Read<TokenFrame>(frames);
+            var length = (int)frame.Length;
+            onFragment(Encoding.UTF8.GetString(frames.Slice(headerSize, length)), (int)frame.Step,
+                frame.EnergyRemaining);
+            frames = frames[(headerSize + ((length + 7) & ~7))..];
         }
     }
 
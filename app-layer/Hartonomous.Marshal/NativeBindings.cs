@@ -28,6 +28,10 @@ public static unsafe class NativeMethods
     [return: MarshalAs(UnmanagedType.I1)]
     public static extern bool DbIsConnected(IntPtr handle);
 
+    [DllImport(LibName, EntryPoint = "hartonomous_db_share_relation_graph", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool DbShareRelationGraph(IntPtr handle);
+
     // =========================================================================
     //  Core Primitives (Hashing & Projection)
     // =========================================================================
@@ -51,6 +55,22 @@ public static unsafe class NativeMethods
     [DllImport(LibName, EntryPoint = "hartonomous_s3_compute_centroid", CallingConvention = CallingConvention.Cdecl)]
     public static extern void S3ComputeCentroid(double* points4d, nuint count, double* out4d);
 
+    [DllImport(LibName, EntryPoint = "hartonomous_codepoints_to_s3", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool CodepointsToS3(uint* codepoints, nuint count, double* out4d);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_s3_compute_centroids", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void S3ComputeCentroids(double* points4d, nuint* counts, nuint groups, double* out4d);
+
+    // Column arrays, one entry per point; fiberAngle may be null (angle 0)
+    [DllImport(LibName, EntryPoint = "hartonomous_hopf_forward_batch", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void HopfForwardBatch(double* x, double* y, double* z, double* w, nuint count,
+                                               double* outX, double* outY, double* outZ);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_hopf_inverse_batch", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void HopfInverseBatch(double* x, double* y, double* z, double* fiberAngle, nuint count,
+                                               double* outX, double* outY, double* outZ, double* outW);
+
     // =========================================================================
     //  Ingestion Service
     // =========================================================================
@@ -69,6 +89,11 @@ public static unsafe class NativeMethods
     [return: MarshalAs(UnmanagedType.I1)]
     public static extern bool IngestFile(IntPtr handle, [MarshalAs(UnmanagedType.LPStr)] string filePath, out IngestionStats stats);
 
+    // Safe to poll from another thread while an ingestion runs on the handle
+    [DllImport(LibName, EntryPoint = "hartonomous_ingester_get_progress", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool IngesterGetProgress(IntPtr handle, out IngestProgress progress);
+
     // =========================================================================
     //  Godel Engine
     // =========================================================================
@@ -108,6 +133,9 @@ public static unsafe class NativeMethods
     [return: MarshalAs(UnmanagedType.I1)]
     public static extern bool WalkSetGoal(IntPtr handle, ref WalkState state, byte* goalId);
 
+    [DllImport(LibName, EntryPoint = "hartonomous_walk_seed", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void WalkSeed(ref WalkState state, ulong seed, ulong stream);
+
     // =========================================================================
     //  Text Generation
     // =========================================================================
@@ -130,6 +158,40 @@ public static unsafe class NativeMethods
         [MarshalAs(UnmanagedType.LPStr)] string prompt, ref GenerateParams params_,
         GenerateCallback callback, IntPtr userData, out GenerateResult result);
 
+    // Writes fragments into a token stream instead of calling back; blocks until the walk ends
+    [DllImport(LibName, EntryPoint = "hartonomous_generate_stream_ring", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GenerateStreamRing(IntPtr walkHandle, IntPtr dbHandle,
+        [MarshalAs(UnmanagedType.LPStr)] string prompt, ref GenerateParams params_,
+        IntPtr stream, out GenerateResult result);
+
+    // =========================================================================
+    //  Token Streams (frames: TokenFrame, then Length UTF-8 bytes padded to 8)
+    // =========================================================================
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_create", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr TokenStreamCreate(nuint capacityBytes);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_destroy", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void TokenStreamDestroy(IntPtr handle);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_read", CallingConvention = CallingConvention.Cdecl)]
+    public static extern nuint TokenStreamRead(IntPtr handle, byte* buffer, nuint capacity);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_wait", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool TokenStreamWait(IntPtr handle, int timeoutMs);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_finished", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool TokenStreamFinished(IntPtr handle);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_cancel", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void TokenStreamCancel(IntPtr handle);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_token_stream_event_fd", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int TokenStreamEventFd(IntPtr handle);
+
     [DllImport(LibName, EntryPoint = "hartonomous_free_string", CallingConvention = CallingConvention.Cdecl)]
     public static extern void FreeString(IntPtr str);
 
@@ -149,6 +211,12 @@ public static unsafe class NativeMethods
         [MarshalAs(UnmanagedType.LPStr)] string text, nuint limit,
         out IntPtr results, out nuint count);
 
+    [DllImport(LibName, EntryPoint = "hartonomous_query_nearest", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool QueryNearest(IntPtr handle,
+        [MarshalAs(UnmanagedType.LPStr)] string text, nuint limit,
+        out IntPtr results, out nuint count);
+
     [DllImport(LibName, EntryPoint = "hartonomous_query_truth", CallingConvention = CallingConvention.Cdecl)]
     [return: MarshalAs(UnmanagedType.I1)]
     public static extern bool QueryTruth(IntPtr handle,
@@ -163,6 +231,29 @@ public static unsafe class NativeMethods
     [DllImport(LibName, EntryPoint = "hartonomous_query_free_results", CallingConvention = CallingConvention.Cdecl)]
     public static extern void QueryFreeResults(IntPtr results, nuint count);
 
+    // Batched queries: one transition per batch, results in one ResultSet block
+
+    [DllImport(LibName, EntryPoint = "hartonomous_query_related_batch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool QueryRelatedBatch(IntPtr handle,
+        [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string[] texts,
+        nuint queryCount, nuint limit, out ResultSet* set);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_query_nearest_batch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool QueryNearestBatch(IntPtr handle,
+        [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string[] texts,
+        nuint queryCount, nuint limit, out ResultSet* set);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_query_truth_batch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool QueryTruthBatch(IntPtr handle,
+        [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string[] texts,
+        nuint queryCount, double minElo, nuint limit, out ResultSet* set);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_result_set_free", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ResultSetFree(ResultSet* set);
+
     // =========================================================================
     //  Composition Lookup
     // =========================================================================
@@ -173,6 +264,23 @@ public static unsafe class NativeMethods
     [DllImport(LibName, EntryPoint = "hartonomous_composition_position", CallingConvention = CallingConvention.Cdecl)]
     [return: MarshalAs(UnmanagedType.I1)]
     public static extern bool CompositionPosition(IntPtr dbHandle, byte* hash16b, double* out4d);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_composition_nearest", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool CompositionNearest(IntPtr dbHandle, double* in4d, nuint k,
+        byte* outIds16b, double* outDistances, out nuint count);
+
+    [DllImport(LibName, EntryPoint = "hartonomous_centroid_index_refresh", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool CentroidIndexRefresh(IntPtr dbHandle, out nuint added);
+
+    // =========================================================================
+    //  Metrics
+    // =========================================================================
+
+    // Prometheus text; free with FreeString
+    [DllImport(LibName, EntryPoint = "hartonomous_metrics_prometheus", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr MetricsPrometheus();
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -194,6 +302,22 @@ public struct IngestionStats
     public nuint CooccurrencesSignificant;
 }
 
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+public struct IngestProgress
+{
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)]
+    public string Phase;
+    public ulong BytesDone;
+    public ulong BytesTotal;
+    public ulong Records;
+    public double ElapsedSec;
+    public double BytesPerSec;
+    public double RecordsPerSec;
+    public double EtaSec;
+    [MarshalAs(UnmanagedType.I1)]
+    public bool Finished;
+}
+
 [StructLayout(LayoutKind.Sequential)]
 public struct WalkParameters
 {
@@ -218,6 +342,8 @@ public unsafe struct WalkState
     public fixed byte CurrentComposition[16];
     public fixed double CurrentPosition[4];
     public double CurrentEnergy;
+    public ulong RngKey;
+    public ulong RngStep;
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -276,6 +402,15 @@ public unsafe struct GenerateParams
     public double TopP;
     public nuint N;
     public fixed byte StopText[256];
+    public ulong Seed;          // 0 draws a fresh seed
+}
+
+[StructLayout(LayoutKind.Sequential)]
+public struct TokenFrame
+{
+    public uint Length;           // UTF-8 bytes after the header
+    public uint Step;
+    public double EnergyRemaining;
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -293,3 +428,17 @@ public struct QueryResult
     public IntPtr Text;         // Allocated by C++, free with QueryFreeResults
     public double Confidence;
 }
+
+// One block owned by C++, free with ResultSetFree. Results of query q are
+// [QueryOffsets[q], QueryOffsets[q + 1]); text i is the UTF-8 bytes
+// [TextOffsets[i], TextOffsets[i + 1] - 1) of Text (each is NUL-terminated).
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct ResultSet
+{
+    public nuint QueryCount;
+    public nuint Count;
+    public ulong* QueryOffsets;
+    public double* Confidences;
+    public ulong* TextOffsets;
+    public byte* Text;
+}
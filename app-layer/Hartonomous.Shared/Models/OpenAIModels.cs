@@ -33,6 +33,10 @@ public sealed class ChatCompletionRequest
     [JsonPropertyName("stop")]
     public object? Stop { get; set; }
 
+    // Same seed and prompt, same completion (unset: a fresh walk each time)
+    [JsonPropertyName("seed")]
+    public ulong? Seed { get; set; }
+
     [JsonPropertyName("user")]
     public string? User { get; set; }
 }
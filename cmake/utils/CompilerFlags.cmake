@@ -16,6 +16,21 @@ function(apply_hartonomous_compiler_flags target)
         CXX_EXTENSIONS OFF
     )
 
+    # Instruction set: the build host's, or a portable baseline for binaries that
+    # ship to mixed fleets. Per-ISA kernel units (utils/cpu_dispatch.hpp) carry
+    # their own flags and are picked at runtime either way.
+    if(MSVC)
+        set(arch_flags $<$<BOOL:${HARTONOMOUS_ENABLE_NATIVE_ARCH}>:/arch:AVX2>)
+    elseif(NOT HARTONOMOUS_ENABLE_NATIVE_ARCH AND CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$")
+        set(arch_flags -march=x86-64-v2 -mtune=generic)   # SSE4.2 + POPCNT: every x86-64 server since 2009
+    elseif(NOT HARTONOMOUS_ENABLE_NATIVE_ARCH AND CMAKE_SYSTEM_PROCESSOR MATCHES "^(aarch64|arm64|ARM64)$")
+        set(arch_flags -march=armv8-a -mtune=generic)     # NEON is part of the base ISA
+    elseif(NOT HARTONOMOUS_ENABLE_NATIVE_ARCH)
+        set(arch_flags "")
+    else()
+        set(arch_flags -march=native $<$<CONFIG:Release>:-mtune=native>)
+    endif()
+
     # Platform-specific flags
     if(MSVC)
         target_compile_options(${target} PRIVATE
@@ -27,7 +42,7 @@ function(apply_hartonomous_compiler_flags target)
                 /Ot                      # Favor fast code
                 /GL                      # Whole program optimization
                 /fp:fast                 # Fast floating point
-                /arch:AVX2               # AVX2 (use AVX512 on 14900KS)
+                ${arch_flags}            # AVX2 when native (use AVX512 on 14900KS)
             >
         )
         target_link_options(${target} PRIVATE
@@ -37,10 +52,9 @@ function(apply_hartonomous_compiler_flags target)
         # GCC/Clang flags — -march=native auto-detects SIMD (AVX2+FMA on 6850K, AVX-512 on 14900KS)
         target_compile_options(${target} PRIVATE
             -Wall -Wextra -Wpedantic
-            -march=native                # Auto-detect: AVX2+FMA on Broadwell, AVX-512 on Raptor Lake
+            ${arch_flags}                # -march=native, or the portable baseline above
             $<$<CONFIG:Release>:
                 -O3                      # Maximum optimization
-                -mtune=native            # Tune scheduling for this CPU
                 -ffast-math              # FMA fusion, reciprocal approx, reordering
                 -funroll-loops           # Unroll tight BLAKE3/Eigen loops
                 -fomit-frame-pointer     # Free up RBP for general use
@@ -13,6 +13,7 @@ DB_USER="${DB_USER:-postgres}"
 DB_HOST="${DB_HOST:-localhost}"
 DB_PORT="${DB_PORT:-5432}"
 DROP_EXISTING=false
+PARTITION_BITS="${PARTITION_BITS:-0}"
 
 # Colors
 RED='\033[0;31m'
@@ -38,12 +39,15 @@ Options:
   -h, --host <host>     Database host (default: localhost)
   -p, --port <port>     Database port (default: 5432)
   -d, --drop            Drop existing database if it exists
+  --partition-bits <n>  Range-partition physicality, relation and relationevidence
+                        into 2^n partitions by leading ID bits (1-8; default 0: off)
   --help                Show this help message
 
 Examples:
   ./03-setup-database.sh                 # Create hartonomous database
   ./03-setup-database.sh --drop          # Drop and recreate
   ./03-setup-database.sh --name test_db  # Use custom database name
+  ./03-setup-database.sh --partition-bits 4  # 16 partitions per large table
 
 EOF
     exit 0
@@ -57,6 +61,7 @@ while [[ $# -gt 0 ]]; do
         -h|--host) DB_HOST="$2"; shift 2 ;;
         -p|--port) DB_PORT="$2"; shift 2 ;;
         -d|--drop) DROP_EXISTING=true; shift ;;
+        --partition-bits) PARTITION_BITS="$2"; shift 2 ;;
         --help) show_help ;;
         *) echo "Unknown option: $1"; show_help ;;
     esac
@@ -146,7 +151,7 @@ fi
 
 # Step 3: Core Tables
 print_info "  [3/4] Loading core tables..."
-if psql -U "$DB_USER" -h "$DB_HOST" -p "$DB_PORT" -d "$DB_NAME" -f "01-core-tables.sql"; then
+if psql -U "$DB_USER" -h "$DB_HOST" -p "$DB_PORT" -d "$DB_NAME" -v partition_bits="$PARTITION_BITS" -f "01-core-tables.sql"; then
     print_success "    ✓ Core tables loaded"
 else
     print_error "    ✗ Core tables failed"
@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# backfill-composition-text.sh
+# Fill composition.text for rows ingested before the column existed.
+
+set -e
+DB_NAME="${DB_NAME:-hartonomous}"
+PSQL="psql -q -v ON_ERROR_STOP=1 -d $DB_NAME"
+JOBS="${JOBS:-$(nproc)}"
+
+# backfill_slice <hex byte>
+# One UPDATE per leading ID byte: 256 slices of about equal size, each
+# reassembling only its own compositions, run by up to $JOBS sessions.
+backfill_slice() {
+    local lo="$1" hi
+    hi=$(printf '%02x' $((16#$lo + 1)))
+    local range="cs.compositionid >= '${lo}000000-0000-0000-0000-000000000000'"
+    [ "$lo" != "ff" ] && range="$range AND cs.compositionid < '${hi}000000-0000-0000-0000-000000000000'"
+    $PSQL <<EOF
+UPDATE hartonomous.composition c
+SET text = r.text
+FROM (
+    SELECT cs.compositionid,
+           STRING_AGG(REPEAT(chr(a.codepoint), hartonomous.uint32_to_int(cs.occurrences)), '' ORDER BY cs.ordinal) AS text
+    FROM hartonomous.compositionsequence cs
+    JOIN hartonomous.atom a ON a.id = cs.atomid
+    WHERE $range
+    GROUP BY cs.compositionid
+) r
+WHERE c.id = r.compositionid AND c.text IS NULL;
+EOF
+}
+export -f backfill_slice
+export PSQL
+
+echo "[BACKFILL] Storing composition text ($JOBS parallel sessions)..."
+for i in $(seq 0 255); do printf '%02x\n' "$i"; done | xargs -P "$JOBS" -I{} bash -c 'backfill_slice {}'
+
+$PSQL <<EOF
+VACUUM ANALYZE hartonomous.composition;
+SELECT COUNT(*) FILTER (WHERE text IS NULL) AS still_without_text FROM hartonomous.composition;
+EOF
+
+echo "[BACKFILL] Composition text stored."
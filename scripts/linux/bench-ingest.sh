@@ -0,0 +1,178 @@
+#!/usr/bin/env bash
+# bench-ingest.sh
+# End-to-end ingest throughput on fixed corpus slices, into a scratch database.
+#
+# Each corpus is cut to the chosen size at a record boundary (a line, a
+# </page>), so the same source always yields the same slice; the slices'
+# sha256 sums go into the report, and a mismatch against the baseline means
+# the numbers are not comparable. Every tool writes its IngestReport
+# (COPY rows and bytes per table, phase timings, peak RSS) through
+# HARTONOMOUS_INGEST_REPORT; the reports are merged into one JSON file.
+#
+# --alloc adds allocation profiling (tools must link jemalloc): allocations
+# per phase and per COPY row land in each report, and jeprof's top
+# allocating call sites for each tool in <tool>.alloc-sites.txt.
+#
+# Usage: bench-ingest.sh [--size 1mb|100mb|1gb] [--db <name>] [--out <dir>]
+#                        [--baseline <report.json>] [--keep-db] [--alloc]
+#        bench-ingest.sh --diff <baseline.json> <report.json>
+
+source "$(dirname "$0")/00_env.sh"
+set -e
+
+SIZE="1mb"
+BENCH_DB="${BENCH_DB:-hartonomous_bench}"
+OUT_DIR="$PROJECT_ROOT/build/bench-ingest"
+BASELINE=""
+KEEP_DB=false
+ALLOC=false
+
+TATOEBA_DIR="${TATOEBA_DIR:-/data/models/tatoeba}"
+WIKTIONARY_XML="${WIKTIONARY_XML:-/data/models/wiktionary/en/enwiktionary-latest-pages-articles.xml}"
+TEXT_FILE="${TEXT_FILE:-$PROJECT_ROOT/test-data/moby_dick.txt}"
+MODEL_ROOT="${MODEL_ROOT:-$PROJECT_ROOT/test-data/embedding_models/models--sentence-transformers--all-MiniLM-L6-v2/snapshots}"
+TOOLS="$PROJECT_ROOT/$BUILD_DIR/Engine/tools"
+
+# diff_reports <baseline> <report>
+# Per tool: wall time, peak RSS and rows/sec per table, relative to the baseline.
+diff_reports() {
+    jq -n -r --slurpfile a "$1" --slurpfile b "$2" '
+        def pct(x; y): if x == 0 then "n/a" else (((y - x) / x * 100 * 10 | round) / 10 | tostring) + "%" end;
+        ($a[0]) as $base | ($b[0]) as $cur |
+        (if $base.corpus.sha256 != $cur.corpus.sha256 then "WARNING: corpus checksums differ; numbers are not comparable" else empty end),
+        ($cur.runs[] as $r | ($base.runs[] | select(.tool == $r.tool)) as $o |
+            "\($r.tool)",
+            "  wall_sec        \($o.wall_sec | . * 100 | round / 100) -> \($r.wall_sec | . * 100 | round / 100) (\(pct($o.wall_sec; $r.wall_sec)))",
+            "  peak_rss_bytes  \($o.peak_rss_bytes) -> \($r.peak_rss_bytes) (\(pct($o.peak_rss_bytes; $r.peak_rss_bytes)))",
+            "  copy_bytes      \($o.copy_bytes) -> \($r.copy_bytes) (\(pct($o.copy_bytes; $r.copy_bytes)))",
+            (if $o.alloc and $r.alloc then
+                "  allocs/row      \($o.alloc.allocs_per_row | . * 100 | round / 100) -> \($r.alloc.allocs_per_row | . * 100 | round / 100) (\(pct($o.alloc.allocs_per_row; $r.alloc.allocs_per_row)))"
+             else empty end),
+            ($r.tables | to_entries[] | select($o.tables[.key] != null) |
+                "  \(.key) rows/sec  \($o.tables[.key].rows_per_sec | round) -> \(.value.rows_per_sec | round) (\(pct($o.tables[.key].rows_per_sec; .value.rows_per_sec)))"))'
+}
+
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        --size) SIZE="$2"; shift 2 ;;
+        --db) BENCH_DB="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --baseline) BASELINE="$2"; shift 2 ;;
+        --keep-db) KEEP_DB=true; shift ;;
+        --alloc) ALLOC=true; shift ;;
+        --diff) diff_reports "$2" "$3"; exit 0 ;;
+        *) error "Unknown option: $1"; exit 1 ;;
+    esac
+done
+
+case $SIZE in
+    1mb) BYTES=$((1 << 20)) ;;
+    100mb) BYTES=$((100 << 20)) ;;
+    1gb) BYTES=$((1 << 30)) ;;
+    *) error "Unknown size: $SIZE (1mb, 100mb or 1gb)"; exit 1 ;;
+esac
+
+command -v jq > /dev/null || { error "jq is required"; exit 1; }
+[ "$BENCH_DB" = "hartonomous" ] && { error "Refusing to benchmark into the main database"; exit 1; }
+
+if [ "$ALLOC" = true ]; then
+    # Same options a HARTONOMOUS_ALLOC_PROFILE build compiles in, for tools built without it
+    export HARTONOMOUS_ALLOC_PROFILE=1
+    export MALLOC_CONF="${MALLOC_CONF:-prof:true,prof_active:false,prof_accum:true,lg_prof_sample:17}"
+    command -v jeprof > /dev/null || warn "jeprof not found; reports get allocation counts but no call sites"
+fi
+
+CORPUS="$OUT_DIR/corpus-$SIZE"
+RUN="$OUT_DIR/run-$SIZE-$(date +%Y%m%d-%H%M%S)"
+mkdir -p "$CORPUS" "$RUN"
+
+# ------------------------------------------------------------------------------
+# Corpus slices (built once per size, reused while their sources are unchanged)
+# ------------------------------------------------------------------------------
+if [ ! -f "$CORPUS/sha256sums" ] || ! (cd "$CORPUS" && sha256sum --quiet -c sha256sums 2> /dev/null); then
+    info "Slicing corpora to $SIZE into $CORPUS..."
+    rm -f "$CORPUS"/*
+
+    if [ -f "$TATOEBA_DIR/sentences.csv" ] && [ -f "$TATOEBA_DIR/links.csv" ]; then
+        # Whole lines only; links keep just the pairs whose sentences are both in the slice
+        head -c "$BYTES" "$TATOEBA_DIR/sentences.csv" | sed '$d' > "$CORPUS/sentences.csv"
+        awk -F'\t' 'NR == FNR { ids[$1]; next } ($1 in ids) && ($2 in ids)' \
+            "$CORPUS/sentences.csv" "$TATOEBA_DIR/links.csv" > "$CORPUS/links.csv"
+    else
+        warn "Tatoeba not found at $TATOEBA_DIR; skipping"
+    fi
+
+    if [ -f "$WIKTIONARY_XML" ]; then
+        # Through the last complete page, then close the document
+        head -c "$BYTES" "$WIKTIONARY_XML" | awk '{ buf = buf $0 "\n" } /<\/page>/ { printf "%s", buf; buf = "" } END { print "</mediawiki>" }' \
+            > "$CORPUS/wiktionary.xml"
+    else
+        warn "Wiktionary not found at $WIKTIONARY_XML; skipping"
+    fi
+
+    if [ -f "$TEXT_FILE" ]; then
+        # Repeated up to the slice size; the text ingester dedups, so this measures the cached path too
+        while [ "$(stat -c %s "$CORPUS/text.txt" 2> /dev/null || echo 0)" -lt "$BYTES" ]; do cat "$TEXT_FILE" >> "$CORPUS/text.txt"; done
+        head -c "$BYTES" "$CORPUS/text.txt" | sed '$d' > "$CORPUS/text.tmp" && mv "$CORPUS/text.tmp" "$CORPUS/text.txt"
+    else
+        warn "Text not found at $TEXT_FILE; skipping"
+    fi
+
+    (cd "$CORPUS" && sha256sum -- * > sha256sums)
+fi
+success "Corpus: $(wc -l < "$CORPUS/sha256sums") files, checksums in $CORPUS/sha256sums"
+
+MODEL_DIR=""
+[ -d "$MODEL_ROOT" ] && MODEL_DIR="$MODEL_ROOT/$(ls "$MODEL_ROOT" | head -1)"
+
+# ------------------------------------------------------------------------------
+# Scratch database: schema and Unicode atoms, then one tool at a time
+# ------------------------------------------------------------------------------
+info "Creating scratch database $BENCH_DB..."
+DB_NAME="$BENCH_DB" "$SCRIPT_DIR/03-setup-database.sh" --name "$BENCH_DB" --drop > "$RUN/setup.log" 2>&1
+UCD_DB_NAME="$BENCH_DB" "$SCRIPT_DIR/05-seed-unicode.sh" > "$RUN/seed.log" 2>&1
+export PGDATABASE="$BENCH_DB"
+
+# run_tool <name> <args...>
+run_tool() {
+    local name="$1"; shift
+    info "Running $name..."
+    HARTONOMOUS_INGEST_REPORT="$RUN/$name.json" "$TOOLS/$name" "$@" > "$RUN/$name.log" 2>&1 \
+        || { error "$name failed; see $RUN/$name.log"; exit 1; }
+    success "$name: $(jq -r '"\(.wall_sec | . * 100 | round / 100)s, \(.copy_rows) rows, \(.copy_bytes) COPY bytes"' "$RUN/$name.json")"
+
+    if [ "$ALLOC" = true ]; then
+        jq -r '.alloc // empty | "  \(.allocs) allocations, \(.allocs_per_row | . * 100 | round / 100) per row"' "$RUN/$name.json"
+        jq -r '.phases[] | select(.allocs != null) | "    \(.name): \(.allocs) allocs, \(.allocs_per_row | . * 100 | round / 100) per row"' "$RUN/$name.json"
+        if [ -f "$RUN/$name.json.heap" ] && command -v jeprof > /dev/null; then
+            jeprof --text --alloc_objects "$TOOLS/$name" "$RUN/$name.json.heap" 2> /dev/null | head -n 30 > "$RUN/$name.alloc-sites.txt"
+            info "Top allocating call sites ($RUN/$name.alloc-sites.txt):"
+            head -n 12 "$RUN/$name.alloc-sites.txt"
+        fi
+    fi
+}
+
+[ -f "$CORPUS/sentences.csv" ] && run_tool ingest_tatoeba "$CORPUS/sentences.csv" "$CORPUS/links.csv"
+[ -f "$CORPUS/wiktionary.xml" ] && run_tool ingest_wiktionary_xml "$CORPUS/wiktionary.xml"
+[ -f "$CORPUS/text.txt" ] && run_tool ingest_text file "$CORPUS/text.txt"
+[ -n "$MODEL_DIR" ] && run_tool ingest_model "$MODEL_DIR"
+
+TABLE_BYTES=$(psql -q -t -A -d "$BENCH_DB" -c "
+    SELECT json_object_agg(relname, pg_total_relation_size(c.oid))
+    FROM pg_class c JOIN pg_namespace n ON n.oid = c.relnamespace
+    WHERE n.nspname = 'hartonomous' AND c.relkind IN ('r', 'p')")
+
+REPORT="$RUN/report.json"
+jq -s --arg size "$SIZE" --arg host "$(hostname)" --arg commit "$(git -C "$PROJECT_ROOT" rev-parse --short HEAD 2> /dev/null)" \
+      --rawfile sums "$CORPUS/sha256sums" --argjson table_bytes "${TABLE_BYTES:-null}" '
+    { commit: $commit, host: $host,
+      corpus: { size: $size, sha256: ($sums | split("\n") | map(select(length > 0) | split("  ") | { (.[1]): .[0] }) | add) },
+      table_bytes: $table_bytes,
+      runs: . }' "$RUN"/ingest_*.json > "$REPORT"
+success "Report: $REPORT"
+
+[ -n "$BASELINE" ] && diff_reports "$BASELINE" "$REPORT"
+
+if [ "$KEEP_DB" = false ]; then
+    psql -q -d postgres -c "DROP DATABASE IF EXISTS $BENCH_DB;"
+fi
@@ -22,6 +22,8 @@ DROP INDEX IF EXISTS hartonomous.idx_composition_physicality;
 DROP INDEX IF EXISTS hartonomous.idx_composition_createdat;
 DROP INDEX IF EXISTS hartonomous.idx_composition_modifiedat;
 DROP INDEX IF EXISTS hartonomous.idx_composition_validatedat;
+DROP INDEX IF EXISTS hartonomous.idx_composition_text;
+DROP INDEX IF EXISTS hartonomous.idx_composition_text_trgm;
 
 -- CompositionSequence
 DROP INDEX IF EXISTS hartonomous.uq_compositionsequence_compositionid_ordinal;
@@ -46,6 +48,7 @@ DROP INDEX IF EXISTS hartonomous.idx_relationsequence_validatedat;
 
 -- RelationRating
 DROP INDEX IF EXISTS hartonomous.idx_relationrating_ratingvalue;
+DROP INDEX IF EXISTS hartonomous.idx_relationrating_modifiedat;
 
 -- RelationEvidence
 DROP INDEX IF EXISTS hartonomous.idx_relationevidence_sourcerating;
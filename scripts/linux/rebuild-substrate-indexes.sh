@@ -5,14 +5,39 @@
 set -e
 DB_NAME="hartonomous"
 PSQL="psql -q -v ON_ERROR_STOP=1 -d $DB_NAME"
+JOBS="${JOBS:-$(nproc)}"
+
+# build_index <table> <index> <spec>
+# On a prefix-partitioned table the parent index is created ON ONLY the
+# parent, each partition's index is built by up to $JOBS parallel sessions,
+# and the partition indexes are then attached, which makes the parent valid.
+build_index() {
+    local table="$1" index="$2" spec="$3"
+    local parts
+    parts=$($PSQL -At -c "SELECT c.relname FROM pg_inherits i JOIN pg_class c ON c.oid = i.inhrelid
+                          WHERE i.inhparent = 'hartonomous.$table'::regclass ORDER BY 1")
+    if [ -z "$parts" ]; then
+        $PSQL -c "CREATE INDEX $index ON hartonomous.$table $spec;"
+        return
+    fi
+    $PSQL -c "CREATE INDEX $index ON ONLY hartonomous.$table $spec;"
+    echo "$parts" | xargs -P "$JOBS" -I{} $PSQL -c "CREATE INDEX {}_${index#idx_} ON hartonomous.{} $spec;"
+    for p in $parts; do
+        $PSQL -c "ALTER INDEX hartonomous.$index ATTACH PARTITION hartonomous.${p}_${index#idx_};"
+    done
+}
 
 echo "[OPTIMIZE] Rebuilding substrate indexes (this may take several minutes)..."
 
+# Physicality, Relation, RelationEvidence (partition-parallel when partitioned)
+build_index physicality idx_physicality_hilbert "(hilbert)"
+build_index physicality idx_physicality_centroid "USING GIST(centroid gist_geometry_ops_nd)"
+build_index physicality idx_physicality_trajectory "USING GIST(trajectory gist_geometry_ops_nd)"
+build_index relation idx_relation_physicality "(physicalityid)"
+build_index relationevidence idx_relationevidence_sourcerating "(sourcerating)"
+
 $PSQL <<EOF
 -- Physicality
-CREATE INDEX idx_physicality_hilbert ON hartonomous.physicality(hilbert);
-CREATE INDEX idx_physicality_centroid ON hartonomous.physicality USING GIST(centroid gist_geometry_ops_nd);
-CREATE INDEX idx_physicality_trajectory ON hartonomous.physicality USING GIST(trajectory gist_geometry_ops_nd);
 ALTER TABLE hartonomous.physicality ADD CONSTRAINT physicality_centroid_normalized 
 CHECK (ABS(ST_X(centroid)*ST_X(centroid) + ST_Y(centroid)*ST_Y(centroid) + ST_Z(centroid)*ST_Z(centroid) + ST_M(centroid)*ST_M(centroid) - 1.0) < 0.0001) NOT VALID;
 
@@ -21,6 +46,8 @@ CREATE INDEX idx_composition_physicality ON hartonomous.composition(physicalityi
 CREATE INDEX idx_composition_createdat ON hartonomous.composition(createdat);
 CREATE INDEX idx_composition_modifiedat ON hartonomous.composition(modifiedat);
 CREATE INDEX idx_composition_validatedat ON hartonomous.composition(validatedat);
+CREATE INDEX idx_composition_text ON hartonomous.composition(LEFT(text, 512) text_pattern_ops);
+CREATE INDEX idx_composition_text_trgm ON hartonomous.composition USING GIN(text gin_trgm_ops);
 
 -- CompositionSequence
 CREATE UNIQUE INDEX uq_compositionsequence_compositionid_ordinal ON hartonomous.compositionsequence(compositionid, ordinal);
@@ -32,9 +59,6 @@ CREATE INDEX idx_compositionsequence_createdat ON hartonomous.compositionsequenc
 CREATE INDEX idx_compositionsequence_modifiedat ON hartonomous.compositionsequence(modifiedat);
 CREATE INDEX idx_compositionsequence_validatedat ON hartonomous.compositionsequence(validatedat);
 
--- Relation
-CREATE INDEX idx_relation_physicality ON hartonomous.relation(physicalityid);
-
 -- RelationSequence
 CREATE UNIQUE INDEX uq_relationsequence_relationid_ordinal ON hartonomous.relationsequence(relationid, ordinal);
 CREATE INDEX idx_relationsequence_relationid ON hartonomous.relationsequence(relationid, ordinal ASC, occurrences);
@@ -45,15 +69,14 @@ CREATE INDEX idx_relationsequence_validatedat ON hartonomous.relationsequence(va
 
 -- RelationRating
 CREATE INDEX idx_relationrating_ratingvalue ON hartonomous.relationrating(ratingvalue);
-
--- RelationEvidence
-CREATE INDEX idx_relationevidence_sourcerating ON hartonomous.relationevidence(sourcerating);
+CREATE INDEX idx_relationrating_modifiedat ON hartonomous.relationrating(modifiedat);
 
 -- Finalize
 SET session_replication_role = 'origin';
 ANALYZE hartonomous.physicality;
 ANALYZE hartonomous.composition;
 ANALYZE hartonomous.relation;
+ANALYZE hartonomous.relationevidence;
 EOF
 
 echo "[OPTIMIZE] Substrate indices rebuilt and statistics updated."
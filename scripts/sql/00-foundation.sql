@@ -29,16 +29,6 @@ CREATE SCHEMA IF NOT EXISTS hartonomous_internal;
 -- Set search path (public for all tables, hartonomous_internal for metadata)
 SET search_path TO public, hartonomous_internal;
 
--- Domains MUST be created BEFORE the hartonomous extension,
--- because the extension SQL references uint64 and uint128 types.
-\i domains/uint16.sql
-\i domains/uint32.sql
-\i domains/uint64.sql
-\i domains/uint128.sql
-
--- Helper function needed by views (loaded early so views in core-tables can use it)
-\i functions/uint32_to_int.sql
-
 -- Try to enable Hartonomous extension (BLAKE3, S³ projection, uint64 ops, etc.)
 -- This is optional - core functionality works without it
 DO $$
@@ -50,6 +40,16 @@ EXCEPTION WHEN OTHERS THEN
     RAISE WARNING 'Details: %', SQLERRM;
 END $$;
 
+-- The extension provides uint64 and uint128 as native base types; without it
+-- they fall back to the bytea domains below, which skip any type that exists.
+\i domains/uint16.sql
+\i domains/uint32.sql
+\i domains/uint64.sql
+\i domains/uint128.sql
+
+-- Helper function needed by views (loaded early so views in core-tables can use it)
+\i functions/uint32_to_int.sql
+
 -- Try to enable S3 extension (geodesic distance, GIST operator class, etc.)
 DO $$
 BEGIN
@@ -64,6 +64,10 @@ END $$;
 \i types/query_results.sql
 
 \i tables/hartonomous_internal/schema_version.sql
+\i tables/hartonomous_internal/bulk_load_deferred.sql
+\i tables/hartonomous_internal/clustering_quality.sql
+\i tables/hartonomous_internal/mined_tensor.sql
+\i tables/hartonomous_internal/evidence_summary.sql
 
 -- Record this schema version
 INSERT INTO hartonomous_internal.schema_version (version, description)
@@ -1,5 +1,6 @@
 \i types/00-custom_types.sql
 \i tables/00-UCD-Metadata.sql
+\i tables/hartonomous_internal/prefix_partitions.sql
 \i tables/01-Tenant.sql
 \i tables/02-Tenant-User.sql
 \i tables/03-Content.sql
@@ -4,6 +4,9 @@
 
 SET search_path TO hartonomous, public;
 
+-- Optional: psql -v partition_bits=N partitions Physicality, Relation and RelationEvidence
+\i tables/hartonomous_internal/prefix_partitions.sql
+
 \i tables/01-Tenant.sql
 \i tables/02-Tenant-User.sql
 \i tables/03-Content.sql
@@ -16,9 +19,11 @@ SET search_path TO hartonomous, public;
 \i tables/10-RelationRating.sql
 \i tables/11-RelationEvidence.sql
 \i tables/12-ModelProjection.sql
+\i tables/13-CompositionAdjacency.sql
 
 \i views/v_composition_text.sql
 \i views/v_composition_details.sql
+\i views/v_relation_trajectory.sql
 
 -- Record schema version
 INSERT INTO hartonomous_internal.schema_version (version, description)
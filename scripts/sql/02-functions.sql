@@ -6,7 +6,10 @@ SET search_path TO hartonomous, public;
 
 \i functions/uint32_to_int.sql
 \i functions/uint64_to_bigint.sql
+\i functions/composition_runs.sql
+\i functions/physicality_trajectory.sql
 
+\i functions/hartonomous/cluster_substrate.sql
 \i functions/hartonomous/find_composition.sql
 \i functions/hartonomous/find_related_compositions.sql
 \i functions/hartonomous/reindex_all.sql
@@ -52,4 +55,5 @@ BEGIN
     RAISE NOTICE '  - hartonomous.repair_inconsistencies()';
     RAISE NOTICE '  - hartonomous.vacuum_analyze()';
     RAISE NOTICE '  - hartonomous.reindex_all()';
+    RAISE NOTICE '  - CALL hartonomous.cluster_substrate(piece_bits, skip_above, sample_rows)';
 END $$;
@@ -0,0 +1,24 @@
+-- ==============================================================================
+-- Helper Function: Expand Composition.Runs into sequence rows
+-- ==============================================================================
+
+-- The rows CompositionSequence holds for a composition (ordinal of the run's
+-- first atom, its codepoint, the run length), for compositions ingested with
+-- HARTONOMOUS_COMPOSITION_SEQUENCE=packed. A run longer than 1024 atoms spans
+-- several elements and comes back as several rows, as ingest would have
+-- split it.
+CREATE OR REPLACE FUNCTION composition_runs_unpack(runs INTEGER[])
+RETURNS TABLE(ordinal INTEGER, codepoint INTEGER, occurrences INTEGER)
+LANGUAGE SQL
+IMMUTABLE
+PARALLEL SAFE
+AS $$
+    SELECT
+        (COALESCE(SUM((run >> 21) + 1) OVER (ORDER BY k ROWS BETWEEN UNBOUNDED PRECEDING AND 1 PRECEDING), 0))::INTEGER,
+        run & 2097151,
+        (run >> 21) + 1
+    FROM unnest(runs) WITH ORDINALITY AS u(run, k)
+    ORDER BY k;
+$$;
+
+COMMENT ON FUNCTION composition_runs_unpack(INTEGER[]) IS 'Expands a packed Composition.Runs array into (ordinal, codepoint, occurrences) rows';
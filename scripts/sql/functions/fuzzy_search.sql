@@ -14,16 +14,16 @@ RETURNS TABLE (
 LANGUAGE sql STABLE
 AS $$
     SELECT
-        v.composition_id,
-        v.reconstructed_text,
-        similarity(v.reconstructed_text, query_text) AS similarity
+        c.Id,
+        c.Text,
+        similarity(c.Text, query_text) AS similarity
     FROM
-        v_composition_text v
+        Composition c
     WHERE
-        v.reconstructed_text % query_text
+        c.Text % query_text
     ORDER BY
         similarity DESC
     LIMIT max_results;
 $$;
 
-COMMENT ON FUNCTION fuzzy_search IS 'Search compositions by fuzzy string matching (using reconstructed text)';
\ No newline at end of file
+COMMENT ON FUNCTION fuzzy_search IS 'Search compositions by fuzzy string matching (trigram index on Composition.Text)';
\ No newline at end of file
@@ -0,0 +1,193 @@
+-- ==============================================================================
+-- Hilbert-ordered physical clustering of the substrate tables
+-- ==============================================================================
+-- Physicality, Composition and Relation are written in ingest order, so rows
+-- that are close on the Hilbert curve are scattered over the heap and a
+-- spatial range or neighbourhood walk reads one page per row. These rewrite
+-- one piece at a time in Hilbert order: Physicality by its own Hilbert index,
+-- Composition and Relation by the Hilbert index of their Physicality.
+--
+-- A piece is a range of the leading bits of Id, never wider than a prefix
+-- partition. Its rows are deleted and reinserted in key order in one
+-- transaction, with foreign-key triggers off (session_replication_role, so
+-- superuser) because every row comes back unchanged. Readers keep seeing the
+-- old versions until the piece commits; CLUSTER would lock the whole table and
+-- needs an index on the key, which Composition and Relation do not have.
+--
+-- The reinserted rows go to the end of the heap; VACUUM afterwards returns
+-- the space they left (VACUUM FULL also compacts, keeping the new order).
+
+-- Sort key of each clusterable table, as an expression over alias t
+CREATE OR REPLACE FUNCTION hartonomous_internal.cluster_sort_key(tbl REGCLASS)
+RETURNS TEXT
+LANGUAGE plpgsql
+STABLE
+AS $$
+BEGIN
+    CASE lower((SELECT relname FROM pg_class WHERE oid = tbl))
+        WHEN 'physicality' THEN
+            RETURN 't.Hilbert';
+        WHEN 'composition', 'relation' THEN
+            RETURN '(SELECT p.Hilbert FROM Physicality p WHERE p.Id = t.PhysicalityId)';
+        ELSE
+            RAISE EXCEPTION '% has no clustering order (Physicality, Composition or Relation)', tbl;
+    END CASE;
+END;
+$$;
+
+-- Prefix bits of `tbl`'s partitions (0 when it is a plain heap)
+CREATE OR REPLACE FUNCTION hartonomous_internal.partition_bits(tbl REGCLASS)
+RETURNS INTEGER
+LANGUAGE sql
+STABLE
+AS $$
+    SELECT COALESCE(ceil(log(2, NULLIF(count(*), 0)::NUMERIC))::INTEGER, 0)
+    FROM pg_inherits WHERE inhparent = tbl;
+$$;
+
+-- Correlation of heap order with sort order over a sample of `piece_filter`
+CREATE OR REPLACE FUNCTION hartonomous_internal.cluster_correlation(
+    tbl REGCLASS,
+    piece_filter TEXT,
+    sample_percent DOUBLE PRECISION
+)
+RETURNS DOUBLE PRECISION
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    result DOUBLE PRECISION;
+BEGIN
+    EXECUTE format(
+        'SELECT corr(heap_rank, key_rank) FROM ('
+        '  SELECT row_number() OVER (ORDER BY c)::DOUBLE PRECISION AS heap_rank,'
+        '         row_number() OVER (ORDER BY k)::DOUBLE PRECISION AS key_rank'
+        '  FROM (SELECT t.ctid AS c, %s AS k FROM %s t TABLESAMPLE SYSTEM (%s) WHERE %s) s'
+        ') r',
+        hartonomous_internal.cluster_sort_key(tbl), tbl, sample_percent, piece_filter)
+    INTO result;
+    RETURN result;
+END;
+$$;
+
+-- Rewrite one piece of `tbl` in Hilbert order. Pieces are numbered 0 .. 2^piece_bits - 1
+-- over the leading bits of Id; a piece already correlated at least `skip_above` is left alone.
+CREATE OR REPLACE FUNCTION hartonomous.cluster_piece(
+    tbl REGCLASS,
+    piece INTEGER,
+    piece_bits INTEGER,
+    skip_above DOUBLE PRECISION DEFAULT 0.9,
+    sample_rows INTEGER DEFAULT 10000
+)
+RETURNS hartonomous_internal.ClusteringQuality
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    sort_key TEXT := hartonomous_internal.cluster_sort_key(tbl);
+    shift INTEGER := 16 - piece_bits;
+    lo UUID;
+    hi UUID;
+    piece_filter TEXT;
+    total_rows DOUBLE PRECISION;
+    sample_percent DOUBLE PRECISION;
+    moved BIGINT;
+    result hartonomous_internal.ClusteringQuality;
+BEGIN
+    IF piece_bits < 0 OR piece_bits > 16 THEN
+        RAISE EXCEPTION 'piece_bits must be between 0 and 16, got %', piece_bits;
+    END IF;
+    IF piece_bits < hartonomous_internal.partition_bits(tbl) THEN
+        RAISE EXCEPTION '% is partitioned by % bits; pieces of % bits would span partitions',
+            tbl, hartonomous_internal.partition_bits(tbl), piece_bits;
+    END IF;
+    IF piece < 0 OR piece >= (1 << piece_bits) THEN
+        RAISE EXCEPTION 'piece must be between 0 and %, got %', (1 << piece_bits) - 1, piece;
+    END IF;
+
+    lo := (lpad(to_hex(piece << shift), 4, '0') || '0000-0000-0000-0000-000000000000')::UUID;
+    IF piece < (1 << piece_bits) - 1 THEN
+        hi := (lpad(to_hex((piece + 1) << shift), 4, '0') || '0000-0000-0000-0000-000000000000')::UUID;
+    END IF;
+    piece_filter := format('t.Id >= %L', lo) || CASE WHEN hi IS NULL THEN '' ELSE format(' AND t.Id < %L', hi) END;
+
+    -- Sample about sample_rows rows of the piece; pages are sampled table-wide
+    SELECT sum(greatest(c.reltuples, 0)) INTO total_rows
+    FROM pg_class c
+    WHERE c.oid = tbl OR c.oid IN (SELECT inhrelid FROM pg_inherits WHERE inhparent = tbl);
+    sample_percent := CASE WHEN COALESCE(total_rows, 0) = 0 THEN 100
+                           ELSE least(100, greatest(0.001, 100.0 * sample_rows * (1 << piece_bits) / total_rows)) END;
+
+    result.TableName := (SELECT relname FROM pg_class WHERE oid = tbl);
+    result.PieceBits := piece_bits;
+    result.Piece := piece;
+    result.RowsMoved := 0;
+    result.CorrelationBefore := hartonomous_internal.cluster_correlation(tbl, piece_filter, sample_percent);
+    result.CorrelationAfter := result.CorrelationBefore;
+    result.ClusteredAt := CURRENT_TIMESTAMP;
+
+    IF result.CorrelationBefore IS NULL OR result.CorrelationBefore < skip_above THEN
+        SET LOCAL session_replication_role = replica;
+
+        DROP TABLE IF EXISTS pg_temp.cluster_piece_rows;
+        EXECUTE format('CREATE TEMP TABLE cluster_piece_rows ON COMMIT DROP AS SELECT t AS r, %s AS k FROM %s t WHERE %s',
+                       sort_key, tbl, piece_filter);
+        EXECUTE format('DELETE FROM %s t WHERE %s', tbl, piece_filter);
+        EXECUTE format('INSERT INTO %s SELECT (r).* FROM cluster_piece_rows ORDER BY k', tbl);
+        GET DIAGNOSTICS moved = ROW_COUNT;
+        result.RowsMoved := moved;
+        DROP TABLE cluster_piece_rows;
+
+        SET LOCAL session_replication_role = origin;
+        result.CorrelationAfter := hartonomous_internal.cluster_correlation(tbl, piece_filter, sample_percent);
+    END IF;
+
+    INSERT INTO hartonomous_internal.ClusteringQuality
+        (TableName, PieceBits, Piece, RowsMoved, CorrelationBefore, CorrelationAfter, ClusteredAt)
+    VALUES (result.TableName, result.PieceBits, result.Piece, result.RowsMoved,
+            result.CorrelationBefore, result.CorrelationAfter, result.ClusteredAt)
+    ON CONFLICT ON CONSTRAINT ClusteringQuality_pkey DO UPDATE
+    SET RowsMoved = EXCLUDED.RowsMoved,
+        CorrelationBefore = EXCLUDED.CorrelationBefore,
+        CorrelationAfter = EXCLUDED.CorrelationAfter,
+        ClusteredAt = EXCLUDED.ClusteredAt;
+
+    RETURN result;
+END;
+$$;
+
+-- Cluster every piece of Physicality, Composition and Relation, committing after
+-- each piece. piece_bits defaults to the partition bits, and at least 6.
+CREATE OR REPLACE PROCEDURE hartonomous.cluster_substrate(
+    piece_bits INTEGER DEFAULT NULL,
+    skip_above DOUBLE PRECISION DEFAULT 0.9,
+    sample_rows INTEGER DEFAULT 10000
+)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    tbl REGCLASS;
+    bits INTEGER;
+    moved BIGINT;
+    skipped INTEGER;
+    piece_result hartonomous_internal.ClusteringQuality;
+BEGIN
+    FOREACH tbl IN ARRAY ARRAY['Physicality', 'Composition', 'Relation']::REGCLASS[] LOOP
+        bits := COALESCE(piece_bits, greatest(hartonomous_internal.partition_bits(tbl), 6));
+        moved := 0;
+        skipped := 0;
+        FOR piece IN 0 .. (1 << bits) - 1 LOOP
+            piece_result := hartonomous.cluster_piece(tbl, piece, bits, skip_above, sample_rows);
+            moved := moved + piece_result.RowsMoved;
+            IF piece_result.RowsMoved = 0 THEN
+                skipped := skipped + 1;
+            END IF;
+            COMMIT;
+        END LOOP;
+        RAISE NOTICE '%: % rows reordered, % of % pieces left as they were', tbl, moved, skipped, 1 << bits;
+    END LOOP;
+
+    RAISE NOTICE 'Clustering complete; run VACUUM on the clustered tables to reclaim the old row versions';
+END;
+$$;
+
+COMMENT ON FUNCTION hartonomous.cluster_piece(REGCLASS, INTEGER, INTEGER, DOUBLE PRECISION, INTEGER) IS 'Rewrites one Id-prefix piece of Physicality, Composition or Relation in Hilbert order and records its correlation before and after';
+COMMENT ON PROCEDURE hartonomous.cluster_substrate(INTEGER, DOUBLE PRECISION, INTEGER) IS 'Clusters Physicality, Composition and Relation in Hilbert order, one committed piece at a time';
@@ -14,20 +14,19 @@ BEGIN
     RETURN QUERY
     SELECT
         c.Id,
-        v.reconstructed_text,
+        c.Text,
         ST_X(p.Centroid),
         ST_Y(p.Centroid),
         ST_Z(p.Centroid),
         ST_M(p.Centroid)
     FROM
-        v_composition_text v
-    JOIN
-        Composition c ON v.composition_id = c.Id
+        Composition c
     JOIN
         Physicality p ON c.PhysicalityId = p.Id
     WHERE
-        v.reconstructed_text = search_text;
+        LEFT(c.Text, 512) = LEFT(search_text, 512)
+        AND c.Text = search_text;
 END;
 $$;
 
-COMMENT ON FUNCTION hartonomous.find_composition IS 'Find composition by exact text match (using view)';
\ No newline at end of file
+COMMENT ON FUNCTION hartonomous.find_composition IS 'Find composition by exact text match (idx_Composition_Text)';
\ No newline at end of file
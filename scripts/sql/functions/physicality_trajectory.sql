@@ -0,0 +1,59 @@
+-- ==============================================================================
+-- Helper Function: Physicality trajectory, stored or decoded from its packed form
+-- ==============================================================================
+
+-- TrajectoryPacked is a varint point count, then per point four zigzag varint
+-- deltas of the coordinates in steps of 1/32767 (PackedTrajectory in the
+-- engine). Where it is NULL the stored Trajectory is the trajectory itself.
+CREATE OR REPLACE FUNCTION physicality_trajectory(trajectory GEOMETRY, packed BYTEA)
+RETURNS GEOMETRY
+LANGUAGE plpgsql
+IMMUTABLE
+PARALLEL SAFE
+AS $$
+DECLARE
+    pos INTEGER := 0;
+    len INTEGER;
+    v BIGINT;
+    shift INTEGER;
+    b INTEGER;
+    n BIGINT;
+    q BIGINT[] := ARRAY[0, 0, 0, 0];
+    pts GEOMETRY[] := '{}';
+BEGIN
+    IF packed IS NULL THEN
+        RETURN trajectory;
+    END IF;
+    len := length(packed);
+
+    FOR i IN 0 .. 4 * 1024 * 1024 LOOP
+        -- One varint per pass: the count first, then 4 coordinates a point
+        v := 0;
+        shift := 0;
+        LOOP
+            IF pos >= len THEN
+                RETURN NULL;
+            END IF;
+            b := get_byte(packed, pos);
+            pos := pos + 1;
+            v := v | ((b & 127)::BIGINT << shift);
+            EXIT WHEN b < 128;
+            shift := shift + 7;
+        END LOOP;
+
+        IF i = 0 THEN
+            n := v;
+        ELSE
+            q[(i - 1) % 4 + 1] := q[(i - 1) % 4 + 1] + CASE WHEN v & 1 = 1 THEN -((v + 1) >> 1) ELSE v >> 1 END;
+            IF (i - 1) % 4 = 3 THEN
+                pts := pts || ST_MakePoint(q[1] / 32767.0, q[2] / 32767.0, q[3] / 32767.0, q[4] / 32767.0);
+            END IF;
+        END IF;
+        EXIT WHEN i = 4 * n;
+    END LOOP;
+
+    RETURN ST_MakeLine(pts);
+END;
+$$;
+
+COMMENT ON FUNCTION physicality_trajectory(GEOMETRY, BYTEA) IS 'Physicality trajectory: decoded from TrajectoryPacked when set, else the stored Trajectory';
@@ -2,13 +2,20 @@
 -- Helper Function: Convert UINT64 (bytea) to BIGINT
 -- ==============================================================================
 
-CREATE OR REPLACE FUNCTION uint64_to_bigint(val uint64)
-RETURNS BIGINT
-LANGUAGE SQL
-IMMUTABLE
-PARALLEL SAFE
-AS $$
-    SELECT ('x' || encode(val, 'hex'))::bit(64)::bigint;
-$$;
+-- Only for the bytea domain fallback; the hartonomous extension's native
+-- uint64 type ships its own C uint64_to_bigint.
+DO $$
+BEGIN
+    IF EXISTS (SELECT 1 FROM pg_type WHERE typname = 'uint64' AND typtype = 'd') THEN
+        CREATE OR REPLACE FUNCTION uint64_to_bigint(val uint64)
+        RETURNS BIGINT
+        LANGUAGE SQL
+        IMMUTABLE
+        PARALLEL SAFE
+        AS $body$
+            SELECT ('x' || encode(val, 'hex'))::bit(64)::bigint;
+        $body$;
 
-COMMENT ON FUNCTION uint64_to_bigint(uint64) IS 'Converts UINT64 domain (8-byte bytea) to BIGINT for use in standard PostgreSQL functions';
+        COMMENT ON FUNCTION uint64_to_bigint(uint64) IS 'Converts UINT64 domain (8-byte bytea) to BIGINT for use in standard PostgreSQL functions';
+    END IF;
+END $$;
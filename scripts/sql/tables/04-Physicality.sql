@@ -14,20 +14,35 @@ CREATE TABLE IF NOT EXISTS Physicality (
     -- 4D path through space - POINTZM for static objects, LINESTRINGZM for dynamic objects
     Trajectory GEOMETRY(GEOMETRYZM, 0),
 
+    -- The trajectory quantized and delta-encoded when ingest packs it; Trajectory
+    -- then only holds the diagonal of its bounding box
+    TrajectoryPacked BYTEA,
+
     -- Metadata
     CreatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
 
     -- Ensure centroid is on S³ (Normalized magnitude = 1.0)
     CONSTRAINT Physicality_Centroid_Normalized CHECK (ABS(ST_X(Centroid) * ST_X(Centroid) + ST_Y(Centroid) * ST_Y(Centroid) + ST_Z(Centroid) * ST_Z(Centroid) + ST_M(Centroid) * ST_M(Centroid) - 1.0) < 0.0001)
-);
+) :partition_by;
+
+SELECT hartonomous_internal.create_prefix_partitions('Physicality', :partition_bits);
+
+-- Installs that predate the column
+ALTER TABLE Physicality ADD COLUMN IF NOT EXISTS TrajectoryPacked BYTEA;
 
 -- Indexes for fast spatial queries
 CREATE INDEX idx_Physicality_hilbert ON Physicality(Hilbert);
 
 -- Spatial indicies using GIST with N-Dimensional support
--- TODO: Re-enable after s3 extension GiST fix
--- CREATE INDEX IF NOT EXISTS idx_Physicality_Centroid ON Physicality USING GIST(Centroid gist_s3_ops);
 CREATE INDEX IF NOT EXISTS idx_Physicality_Centroid ON Physicality USING GIST(Centroid gist_geometry_ops_nd);
+
+-- Geodesic KNN (ORDER BY Centroid OPERATOR(hartonomous.<@>) point) when the s3 extension is installed
+DO $$
+BEGIN
+    IF EXISTS (SELECT 1 FROM pg_opclass WHERE opcname = 'gist_s3_ops') THEN
+        CREATE INDEX IF NOT EXISTS idx_Physicality_Centroid_S3 ON Physicality USING GIST(Centroid hartonomous.gist_s3_ops);
+    END IF;
+END $$;
 CREATE INDEX IF NOT EXISTS idx_Physicality_Trajectory ON Physicality USING GIST(Trajectory gist_geometry_ops_nd);
 
 -- Comment
@@ -36,5 +51,6 @@ COMMENT ON COLUMN Physicality.Id IS 'BLAKE3 hash of physicality metadata (conten
 COMMENT ON COLUMN Physicality.Hilbert IS 'Hilbert space-filling curve index for spatial queries';
 COMMENT ON COLUMN Physicality.Centroid IS '4D POINTZM representing the Physicality''s position on the 3-sphere (S³)';
 COMMENT ON COLUMN Physicality.Trajectory IS '4D GEOMETRYZM representing the Physicality''s trajectory through S³';
+COMMENT ON COLUMN Physicality.TrajectoryPacked IS 'Trajectory in 16-bit steps per axis, zigzag varint deltas (HARTONOMOUS_TRAJECTORY=packed); physicality_trajectory() decodes it';
 COMMENT ON COLUMN Physicality.CreatedAt IS 'Timestamp of first insertion into the Physicality table';
 COMMENT ON CONSTRAINT Physicality_Centroid_Normalized ON Physicality IS 'Ensures that the Centroid lies on the surface of the 3-sphere (S³)';
\ No newline at end of file
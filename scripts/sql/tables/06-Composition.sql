@@ -8,20 +8,37 @@ CREATE TABLE IF NOT EXISTS Composition (
     -- The physicality record containing the 4d geometric data
     PhysicalityId UUID NOT NULL REFERENCES Physicality(Id) ON DELETE CASCADE,
 
+    -- The text the atoms spell, written at ingest; NULL until backfilled on older rows
+    Text TEXT,
+
+    -- The atom sequence packed one int4 per run: codepoint | (length - 1) << 21
+    Runs INTEGER[],
+
     -- Metadata
     CreatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     ModifiedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     ValidatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
 );
 
+-- Installs that predate the column
+ALTER TABLE Composition ADD COLUMN IF NOT EXISTS Text TEXT;
+ALTER TABLE Composition ADD COLUMN IF NOT EXISTS Runs INTEGER[];
+
 CREATE INDEX IF NOT EXISTS idx_Composition_Physicality ON Composition(PhysicalityId);
 CREATE INDEX IF NOT EXISTS idx_Composition_CreatedAt ON Composition(CreatedAt);
 CREATE INDEX IF NOT EXISTS idx_Composition_ModifiedAt ON Composition(ModifiedAt);
 CREATE INDEX IF NOT EXISTS idx_Composition_ValidatedAt ON Composition(ValidatedAt);
 
+-- Equality and prefix lookups on the leading 512 characters (at most 2 KiB,
+-- inside the btree row limit however long the text); trigram for fuzzy search
+CREATE INDEX IF NOT EXISTS idx_Composition_Text ON Composition(LEFT(Text, 512) text_pattern_ops);
+CREATE INDEX IF NOT EXISTS idx_Composition_Text_Trgm ON Composition USING GIN(Text gin_trgm_ops);
+
 COMMENT ON TABLE Composition IS 'n-grams of Atoms forming higher-level structures';
 COMMENT ON COLUMN Composition.Id IS 'BLAKE3 hash of Composition content + context (content-addressable key)';
 COMMENT ON COLUMN Composition.PhysicalityId IS 'Reference to the Physicality record containing 4D geometric data';
+COMMENT ON COLUMN Composition.Text IS 'Text of the atom sequence, stored at ingest (v_composition_text reconstructs it where NULL)';
+COMMENT ON COLUMN Composition.Runs IS 'Packed atom sequence, one element per run (codepoint in the low 21 bits, run length - 1 above); NULL when some codepoint had no atom. With HARTONOMOUS_COMPOSITION_SEQUENCE=packed it replaces the CompositionSequence rows';
 COMMENT ON COLUMN Composition.CreatedAt IS 'Timestamp of first insertion into the Composition table';
 COMMENT ON COLUMN Composition.ModifiedAt IS 'Timestamp of last modification to the Composition record';
 COMMENT ON COLUMN Composition.ValidatedAt IS 'Timestamp of last validation of the Composition record';
\ No newline at end of file
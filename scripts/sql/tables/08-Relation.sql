@@ -10,7 +10,9 @@ CREATE TABLE IF NOT EXISTS Relation (
 
     -- Metadata
     CreatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
-);
+) :partition_by;
+
+SELECT hartonomous_internal.create_prefix_partitions('Relation', :partition_bits);
 
 -- Indexes for fast queries
 CREATE INDEX IF NOT EXISTS idx_Relation_Physicality ON Relation(PhysicalityId);
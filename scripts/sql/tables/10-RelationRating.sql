@@ -5,7 +5,7 @@
 CREATE TABLE IF NOT EXISTS RelationRating (
     RelationId UUID PRIMARY KEY REFERENCES Relation(Id) ON DELETE CASCADE,
 
-    Observations UINT64 DEFAULT '\x0000000000000001'::bytea NOT NULL,
+    Observations UINT64 DEFAULT '\x0000000000000001' NOT NULL,
     
     RatingValue DOUBLE PRECISION NOT NULL DEFAULT 1000,
     KFactor DOUBLE PRECISION DEFAULT 1.0 NOT NULL,
@@ -16,6 +16,7 @@ CREATE TABLE IF NOT EXISTS RelationRating (
 );
 
 CREATE INDEX IF NOT EXISTS idx_RelationRating_RatingValue ON RelationRating(RatingValue);
+CREATE INDEX IF NOT EXISTS idx_RelationRating_ModifiedAt ON RelationRating(ModifiedAt);
 
 COMMENT ON TABLE RelationRating IS 'Stores the ELO rating of a Relation based on various factors including ingestion quality, user feedback, and system evaluations.';
 COMMENT ON COLUMN RelationRating.RelationId IS 'The unique identifier of the Relation being rated.';
@@ -26,9 +26,13 @@ CREATE TABLE IF NOT EXISTS RelationEvidence (
     CreatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     ModifiedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     ValidatedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
-);
+) :partition_by;
+
+SELECT hartonomous_internal.create_prefix_partitions('RelationEvidence', :partition_bits);
 
 CREATE INDEX IF NOT EXISTS idx_RelationEvidence_SourceRating ON RelationEvidence(SourceRating);
+-- The OODA loop reads evidence validated since its watermark
+CREATE INDEX IF NOT EXISTS idx_RelationEvidence_ValidatedAt ON RelationEvidence(ValidatedAt);
 
 COMMENT ON TABLE RelationEvidence IS 'ELO Evidence of a Relation based on ingestion, user feedback, and system evaluations';
 COMMENT ON COLUMN RelationEvidence.Id IS 'BLAKE3 hash of Evidence metadata (content-addressable key)';
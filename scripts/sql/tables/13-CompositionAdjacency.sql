@@ -0,0 +1,48 @@
+-- ==============================================================================
+-- CompositionAdjacency: Denormalized relation neighbors, one row per (composition, neighbor, relation)
+-- ==============================================================================
+
+-- Optional: the engine maintains it at ingest and rating updates when present,
+-- and reads neighbors from it instead of joining RelationSequence with itself
+-- and RelationRating. Dropping the table turns both off.
+CREATE TABLE IF NOT EXISTS CompositionAdjacency (
+    CompositionId UUID NOT NULL,
+    NeighborId UUID NOT NULL,
+    RelationId UUID NOT NULL REFERENCES Relation(Id) ON DELETE CASCADE,
+
+    RatingValue DOUBLE PRECISION NOT NULL DEFAULT 1000,
+    Observations UINT64 DEFAULT '\x0000000000000001' NOT NULL,
+
+    -- One composition's neighbors are one contiguous range of the index
+    CONSTRAINT pk_CompositionAdjacency PRIMARY KEY (CompositionId, NeighborId, RelationId)
+        INCLUDE (RatingValue, Observations)
+);
+
+-- Rating updates and cascades address rows by relation
+CREATE INDEX IF NOT EXISTS idx_CompositionAdjacency_RelationId ON CompositionAdjacency(RelationId);
+
+-- CLUSTER CompositionAdjacency keeps each composition's rows on contiguous heap pages
+ALTER TABLE CompositionAdjacency CLUSTER ON pk_CompositionAdjacency;
+
+-- Backfill once, when created over existing relations
+DO $$
+BEGIN
+    IF NOT EXISTS (SELECT 1 FROM CompositionAdjacency) THEN
+        INSERT INTO CompositionAdjacency (CompositionId, NeighborId, RelationId, RatingValue, Observations)
+        SELECT DISTINCT rs1.CompositionId, rs2.CompositionId, rs1.RelationId,
+               COALESCE(rr.RatingValue, 1000), COALESCE(rr.Observations, '\x0000000000000001')
+        FROM RelationSequence rs1
+        JOIN RelationSequence rs2
+            ON rs2.RelationId = rs1.RelationId
+            AND rs2.CompositionId != rs1.CompositionId
+        LEFT JOIN RelationRating rr ON rr.RelationId = rs1.RelationId
+        ORDER BY 3, 1, 2;
+    END IF;
+END $$;
+
+COMMENT ON TABLE CompositionAdjacency IS 'Relation neighbors of each Composition with the Relation rating copied in, for single-index-scan neighbor lookup';
+COMMENT ON COLUMN CompositionAdjacency.CompositionId IS 'The Composition whose neighbors these are';
+COMMENT ON COLUMN CompositionAdjacency.NeighborId IS 'Another Composition of the same Relation';
+COMMENT ON COLUMN CompositionAdjacency.RelationId IS 'The Relation both Compositions belong to';
+COMMENT ON COLUMN CompositionAdjacency.RatingValue IS 'Copy of RelationRating.RatingValue';
+COMMENT ON COLUMN CompositionAdjacency.Observations IS 'Copy of RelationRating.Observations';
\ No newline at end of file
@@ -0,0 +1,11 @@
+-- Indexes and CHECK constraints a bulk load session dropped and has not yet
+-- restored (Engine BulkLoadSession); a row goes away in the transaction that
+-- rebuilds or revalidates its object
+CREATE TABLE IF NOT EXISTS hartonomous_internal.BulkLoadDeferred (
+    Kind CHAR(1) NOT NULL,          -- 'i' index, 'c' CHECK constraint
+    TableName TEXT NOT NULL,
+    Name TEXT NOT NULL,
+    Definition TEXT NOT NULL,       -- pg_get_indexdef / pg_get_constraintdef
+    DeferredAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (Kind, TableName, Name)
+);
@@ -0,0 +1,14 @@
+-- How closely each piece of a clustered substrate table follows its sort order
+-- (hartonomous.cluster_piece); one row per table and piece, replaced per run.
+-- Correlation is heap position against sort rank over a page sample: 1 when
+-- the piece reads sequentially in that order, near 0 for insert order.
+CREATE TABLE IF NOT EXISTS hartonomous_internal.ClusteringQuality (
+    TableName TEXT NOT NULL,
+    PieceBits INTEGER NOT NULL,
+    Piece INTEGER NOT NULL,
+    RowsMoved BIGINT NOT NULL,
+    CorrelationBefore DOUBLE PRECISION,
+    CorrelationAfter DOUBLE PRECISION,
+    ClusteredAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (TableName, PieceBits, Piece)
+);
@@ -0,0 +1,19 @@
+-- Running per-relation totals of the RelationEvidence the OODA loop has consumed
+-- (cognitive/ooda_loop.hpp). StrengthSum adds 2 * SignalStrength - 1 per row, so
+-- its mean is the relation's net signal; AppliedElo is what the loop has added to
+-- RelationRating on its behalf, so the next delta is the new target minus it.
+CREATE TABLE IF NOT EXISTS hartonomous_internal.EvidenceSummary (
+    RelationId UUID PRIMARY KEY,
+    Observations BIGINT NOT NULL DEFAULT 0,
+    StrengthSum DOUBLE PRECISION NOT NULL DEFAULT 0,
+    AppliedElo BIGINT NOT NULL DEFAULT 0,
+    ModifiedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Evidence validated at or before ValidatedThrough is in EvidenceSummary; one
+-- row per consumer, advanced in the transaction that applies its deltas
+CREATE TABLE IF NOT EXISTS hartonomous_internal.EvidenceWatermark (
+    Consumer TEXT PRIMARY KEY,
+    ValidatedThrough TIMESTAMP WITH TIME ZONE NOT NULL,
+    ModifiedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
+);
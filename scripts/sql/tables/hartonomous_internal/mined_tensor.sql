@@ -0,0 +1,22 @@
+-- Weight tensors whose layer passes have landed (ingestion/tensor_dedup.hpp); a
+-- model ingest skips a pass whose MiningKey is here, or whose Sketch is close
+-- enough to one recorded for the same Context, TypeTag and shape. MiningKey is
+-- BLAKE3 over the tensor bytes, the type tag and the Context: the embeddings,
+-- vocab and mining settings the relations were mined under. Sketch is
+-- 64 x 16 float32, little-endian.
+CREATE TABLE IF NOT EXISTS hartonomous_internal.MinedTensor (
+    MiningKey UUID PRIMARY KEY,
+    Context UUID NOT NULL,
+    TypeTag TEXT NOT NULL,
+    Layer INTEGER NOT NULL,
+    TensorName TEXT NOT NULL,
+    TensorDigest UUID NOT NULL,
+    QueryDigest UUID,
+    Rows BIGINT NOT NULL,
+    Cols BIGINT NOT NULL,
+    Sketch BYTEA NOT NULL,
+    ContentId UUID NOT NULL,
+    MinedAt TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE INDEX IF NOT EXISTS idx_MinedTensor_Context ON hartonomous_internal.MinedTensor (Context, TypeTag);
@@ -0,0 +1,66 @@
+-- ==============================================================================
+-- Prefix partitioning: optional range partitions by the leading bits of an ID
+-- ==============================================================================
+-- Physicality, Relation and RelationEvidence are keyed by BLAKE3 hashes, so
+-- ranges of the leading bits split them evenly. Partitioning is chosen when the
+-- tables are created, with psql -v partition_bits=N (1..8, 2^N partitions);
+-- without it the tables are plain heaps. The primary keys are the partition
+-- keys, so the foreign keys referencing these tables are unchanged.
+
+\if :{?partition_bits}
+\else
+\set partition_bits 0
+\endif
+SELECT :partition_bits > 0 AS partitioned \gset
+\if :partitioned
+\set partition_by 'PARTITION BY RANGE (Id)'
+\else
+\set partition_by ''
+\endif
+
+-- Create the 2^bits partitions of `parent` that do not exist yet; returns how many were created
+CREATE OR REPLACE FUNCTION hartonomous_internal.create_prefix_partitions(parent REGCLASS, bits INTEGER)
+RETURNS INTEGER
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    n INTEGER := 1 << bits;
+    shift INTEGER := 8 - bits;
+    created INTEGER := 0;
+    nsp TEXT;
+    rel TEXT;
+    child TEXT;
+    lo TEXT;
+    hi TEXT;
+BEGIN
+    IF bits = 0 THEN
+        RETURN 0;
+    END IF;
+    IF bits < 0 OR bits > 8 THEN
+        RAISE EXCEPTION 'partition_bits must be between 0 and 8, got %', bits;
+    END IF;
+    IF NOT EXISTS (SELECT 1 FROM pg_partitioned_table WHERE partrelid = parent) THEN
+        RAISE WARNING '% already exists unpartitioned; partition_bits ignored', parent;
+        RETURN 0;
+    END IF;
+
+    SELECT ns.nspname, c.relname INTO nsp, rel
+    FROM pg_class c JOIN pg_namespace ns ON ns.oid = c.relnamespace
+    WHERE c.oid = parent;
+
+    FOR i IN 0 .. n - 1 LOOP
+        child := rel || '_p' || lpad(to_hex(i), 2, '0');
+        lo := CASE WHEN i = 0 THEN 'MINVALUE'
+                   ELSE quote_literal(lpad(to_hex(i << shift), 2, '0') || '000000-0000-0000-0000-000000000000') END;
+        hi := CASE WHEN i = n - 1 THEN 'MAXVALUE'
+                   ELSE quote_literal(lpad(to_hex((i + 1) << shift), 2, '0') || '000000-0000-0000-0000-000000000000') END;
+        IF to_regclass(format('%I.%I', nsp, child)) IS NULL THEN
+            EXECUTE format('CREATE TABLE %I.%I PARTITION OF %s FOR VALUES FROM (%s) TO (%s)', nsp, child, parent, lo, hi);
+            created := created + 1;
+        END IF;
+    END LOOP;
+    RETURN created;
+END;
+$$;
+
+COMMENT ON FUNCTION hartonomous_internal.create_prefix_partitions(REGCLASS, INTEGER) IS 'Creates the range partitions <table>_pNN of a table partitioned by the leading bits of its UUID key';
\ No newline at end of file
@@ -1,24 +1,43 @@
 -- ==============================================================================
--- View: Reconstruct text from Atoms for debugging/display
+-- View: Composition text, stored or reconstructed from Atoms
 -- ==============================================================================
 
+-- Composition.Text when ingest wrote it (a heap fetch); else the packed Runs
+-- of the same row; rows from before both columns still reassemble their atom
+-- sequence until backfilled
 CREATE OR REPLACE VIEW v_composition_text AS
 SELECT
     c.Id AS composition_id,
-    STRING_AGG(
-        REPEAT(
-            chr(a.Codepoint), 
-            uint32_to_int(cs.Occurrences)
-        ),
-        '' ORDER BY cs.Ordinal
-    ) AS reconstructed_text
+    COALESCE(c.Text, p.packed_text, r.reconstructed_text) AS reconstructed_text
 FROM
     Composition c
-JOIN
-    CompositionSequence cs ON c.Id = cs.CompositionId
-JOIN
-    Atom a ON cs.AtomId = a.Id
-GROUP BY
-    c.Id;
+LEFT JOIN LATERAL (
+    SELECT
+        STRING_AGG(REPEAT(chr(run & 2097151), (run >> 21) + 1), '' ORDER BY k) AS packed_text
+    FROM
+        unnest(c.Runs) WITH ORDINALITY AS u(run, k)
+    WHERE
+        c.Text IS NULL
+) p ON TRUE
+LEFT JOIN LATERAL (
+    SELECT
+        STRING_AGG(
+            REPEAT(
+                chr(a.Codepoint),
+                uint32_to_int(cs.Occurrences)
+            ),
+            '' ORDER BY cs.Ordinal
+        ) AS reconstructed_text
+    FROM
+        CompositionSequence cs
+    JOIN
+        Atom a ON cs.AtomId = a.Id
+    WHERE
+        cs.CompositionId = c.Id
+        AND c.Text IS NULL
+        AND c.Runs IS NULL
+) r ON TRUE
+WHERE
+    c.Text IS NOT NULL OR p.packed_text IS NOT NULL OR r.reconstructed_text IS NOT NULL;
 
-COMMENT ON VIEW v_composition_text IS 'Reconstructs composition text from atom sequence (on-demand)';
\ No newline at end of file
+COMMENT ON VIEW v_composition_text IS 'Composition text: the stored Composition.Text, else decoded from Composition.Runs, else reconstructed from the atom sequence';
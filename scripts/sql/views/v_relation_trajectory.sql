@@ -0,0 +1,30 @@
+-- ==============================================================================
+-- View: Relation trajectories, stored or rebuilt from the related compositions
+-- ==============================================================================
+
+-- A relation's trajectory is the centroids of its compositions. Ingest with
+-- HARTONOMOUS_TRAJECTORY=referenced leaves it out of Physicality, and it is
+-- rebuilt here in sequence order from the compositions' own Physicality rows
+CREATE OR REPLACE VIEW v_relation_trajectory AS
+SELECT
+    r.Id AS relation_id,
+    COALESCE(p.Trajectory, s.trajectory) AS trajectory
+FROM
+    Relation r
+JOIN
+    Physicality p ON p.Id = r.PhysicalityId
+LEFT JOIN LATERAL (
+    SELECT
+        ST_MakeLine(cp.Centroid ORDER BY rs.Ordinal) AS trajectory
+    FROM
+        RelationSequence rs
+    JOIN
+        Composition c ON c.Id = rs.CompositionId
+    JOIN
+        Physicality cp ON cp.Id = c.PhysicalityId
+    WHERE
+        rs.RelationId = r.Id
+        AND p.Trajectory IS NULL
+) s ON TRUE;
+
+COMMENT ON VIEW v_relation_trajectory IS 'Relation trajectory: the stored Physicality.Trajectory, else the related compositions'' centroids in sequence order';